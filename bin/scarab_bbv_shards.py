@@ -0,0 +1,159 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Extracts the BBVs of one memtrace (drmemtrace) trace with several
+scarab processes and merges them. Shard s runs --mode trace_bbv on the
+instructions [s * shard_segments * segment_size + 1,
+(s + 1) * shard_segments * segment_size] through --memtrace_roi_begin/end, so
+the trace reader skips the chunks before its range, and keys its dimensions by
+basic block start pc (--trace_bbv_key_by_pc). The last shard runs to the end of
+the trace. The merge concatenates the segments of all shards in order and
+renumbers the basic blocks 1, 2, ... in order of first appearance, like the
+ids of a single --mode trace_bbv run.
+
+Segments are counted in all instructions (--use_fetched_count 0), because the
+shard boundaries are instruction ordinals. A basic block that straddles a
+shard boundary is counted as two blocks.
+
+Example:
+  python bin/scarab_bbv_shards.py --segment_size 100000000 --shard_segments 50 --shards 20 \\
+      --decode_args "--frontend memtrace --cbp_trace_r0 trace.zip --memtrace_modules_log bin" --output trace.bbv
+"""
+
+from __future__ import print_function
+import argparse
+import multiprocessing
+import os
+import shutil
+import sys
+import time
+
+from scarab_globals import *
+
+parser = argparse.ArgumentParser(description="Extract the BBVs of a memtrace with several scarab processes")
+parser.add_argument('--segment_size', type=int, required=True, help="Instructions per BBV segment (SEGMENT_INSTR_COUNT).")
+parser.add_argument('--shard_segments', type=int, required=True, help="Segments per shard.")
+parser.add_argument('--shards', type=int, required=True, help="Number of shards; the last one runs to the end of the trace.")
+parser.add_argument('--decode_args', default="", help="Scarab arguments selecting the trace, e.g. "
+                    "\"--frontend memtrace --cbp_trace_r0 trace.zip --memtrace_modules_log bin\".")
+parser.add_argument('--params', default=None, help="Path to the PARAMS file shared by all shards.")
+parser.add_argument('--output', required=True, help="Merged BBV file.")
+parser.add_argument('--simdir', default=os.getcwd(), help="Directory with one subdirectory per shard.")
+parser.add_argument('--jobs', type=int, default=multiprocessing.cpu_count(), help="Shards to run at once. Defaults to the number of host cores.")
+parser.add_argument('--scarab', default=scarab_paths.scarab_bin, help="Path to the scarab binary. Defaults to src/scarab.")
+
+args = parser.parse_args()
+
+def shard_command(shard):
+  name = "shard{}".format(shard)
+  run_dir = os.path.join(args.simdir, name)
+  os.makedirs(run_dir, exist_ok=True)
+  if args.params:
+    shutil.copy2(args.params, os.path.join(run_dir, "PARAMS.in"))
+  bbv_path = os.path.join(run_dir, "shard.bbv")
+  if os.path.exists(bbv_path):
+    os.remove(bbv_path)  # the BBVs are appended
+
+  shard_insts = args.shard_segments * args.segment_size
+  begin = shard * shard_insts + 1
+  end = 0 if shard == args.shards - 1 else (shard + 1) * shard_insts
+  cmd_str = ("{scarab} --mode trace_bbv --trace_bbv_key_by_pc 1 --use_fetched_count 0 --segment_instr_count {size} "
+             "--trace_bbv_output {bbv} --memtrace_roi_begin {begin} --memtrace_roi_end {end} {decode_args}").format(
+    scarab=args.scarab, size=args.segment_size, bbv=bbv_path, begin=begin, end=end, decode_args=args.decode_args)
+  cmd = command.Command(cmd_str, name=name, run_dir=run_dir, results_dir=run_dir, stdout="scarab.out", stderr="scarab.err")
+  cmd.bbv_path = bbv_path
+  return cmd
+
+def run_shards(cmds):
+  """
+  Keep up to --jobs shards running. Returns the names of the failed shards.
+  """
+  pending = list(cmds)
+  running = []
+  failed = []
+
+  while pending or running:
+    while pending and len(running) < args.jobs:
+      cmd = pending.pop(0)
+      print('Launching {}:\n{}\n'.format(cmd.name, cmd.cmd))
+      cmd.run_in_background()
+      running.append(cmd)
+
+    time.sleep(1)
+    for cmd in list(running):
+      cmd.poll()
+      if cmd.returncode is not None:
+        running.remove(cmd)
+        print("RETURN CODE {}: {}".format(cmd.returncode, cmd.name))
+        if cmd.returncode != 0 or not os.path.exists(cmd.bbv_path):
+          failed.append(cmd.name)
+
+  return failed
+
+def merge(bbv_paths, out_path):
+  """
+  Concatenate the segments of the shards, renumbering the pcs to dense ids.
+  Returns the number of segments and of distinct basic blocks.
+  """
+  ids = {}
+  num_segments = 0
+  with open(out_path, 'w') as out:
+    for path in bbv_paths:
+      with open(path, 'r') as f:
+        for line in f:
+          line = line.strip()
+          if not line.startswith('T'):
+            continue
+          dims = []
+          for field in line[1:].split():
+            _, pc, count = field.split(':')
+            dim = ids.setdefault(int(pc), len(ids) + 1)
+            dims.append((dim, count))
+          dims.sort()
+          out.write("T" + "".join(":{}:{} ".format(dim, count) for dim, count in dims) + "\n")
+          num_segments += 1
+  return num_segments, len(ids)
+
+def main():
+  if args.shards < 1 or args.shard_segments < 1 or args.segment_size < 1:
+    print("Error: --shards, --shard_segments and --segment_size must be positive")
+    sys.exit(1)
+  os.makedirs(args.simdir, exist_ok=True)
+  args.simdir = os.path.abspath(args.simdir)
+
+  cmds = [shard_command(shard) for shard in range(args.shards)]
+  failed = []
+  try:
+    failed = run_shards(cmds)
+  finally:
+    progress.notify("Scarab BBV shards finished, {} of {} shards failed".format(len(failed), args.shards))
+
+  if failed:
+    print("Error: failed shards: " + " ".join(failed))
+    sys.exit(1)
+  num_segments, num_blocks = merge([cmd.bbv_path for cmd in cmds], args.output)
+  print("Merged {} segments with {} basic blocks into {}".format(num_segments, num_blocks, args.output))
+
+if __name__ == "__main__":
+  main()
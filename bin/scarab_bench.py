@@ -0,0 +1,150 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Simulator throughput benchmark (make bench in src/). Runs every
+trace against every PARAMS.* config with --host_prof 1 and reports host KIPS,
+peak RSS and the host time of each simulator region (the --host_prof
+breakdown) as JSON. A run that is slower than in a --baseline report by more
+than --threshold percent is reported as a regression, and the script exits
+with status 1.
+
+Examples:
+  python bin/scarab_bench.py --scarab src/scarab --output bench.json \\
+      src/test/simple_loop.trace.bz2 bench/*.trace.bz2
+  python bin/scarab_bench.py --baseline old.json --threshold 5 bench/*.trace.bz2
+"""
+
+from __future__ import print_function
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+SRC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src")
+DEFAULT_PARAMS = ["sunny_cove", "golden_cove", "kaby_lake"]
+
+# host_prof_done() in src/debug/host_prof.c
+TOTAL_RE = re.compile(r"\*\* Host profile: ([\d.]+) s\s+(\d+) cycles\s+(\d+) insts")
+REGION_RE = re.compile(r"^\s+(\S+)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)%$")
+
+def run_one(scarab, trace, params, extra_args):
+  simdir = tempfile.mkdtemp(prefix="scarab_bench_")
+  try:
+    shutil.copy2(params, os.path.join(simdir, "PARAMS.in"))
+    cmd = [os.path.abspath(scarab), "--frontend", "trace", "--cbp_trace_r0", os.path.abspath(trace),
+           "--fetch_off_path_ops", "0", "--host_prof", "1"] + extra_args
+    start = time.time()
+    with open(os.path.join(simdir, "scarab.out"), "w") as out:
+      proc = subprocess.Popen(cmd, cwd=simdir, stdout=out, stderr=subprocess.STDOUT)
+      # wait4 gives the peak RSS of this run alone
+      _, status, rusage = os.wait4(proc.pid, 0)
+    wall = time.time() - start
+    with open(os.path.join(simdir, "scarab.out")) as out:
+      output = out.read()
+  finally:
+    shutil.rmtree(simdir, ignore_errors=True)
+
+  if status != 0:
+    sys.exit("%s failed on %s:\n%s" % (" ".join(cmd), trace, output[-2000:]))
+  total = TOTAL_RE.search(output)
+  if not total:
+    sys.exit("No host profile in the output for %s" % trace)
+  insts = int(total.group(3))
+  regions = {}
+  for line in output[total.end():].splitlines():
+    region = REGION_RE.match(line)
+    if region:
+      regions[region.group(1)] = {"ns_per_cycle": float(region.group(2)), "ns_per_inst": float(region.group(3)),
+                                  "percent": float(region.group(4))}
+  return {"insts": insts, "cycles": int(total.group(2)), "wall_secs": wall,
+          "kips": insts / wall / 1000.0 if wall else 0.0, "peak_rss_kb": rusage.ru_maxrss, "regions": regions}
+
+def git_rev():
+  try:
+    return subprocess.check_output(["git", "rev-parse", "--short", "HEAD"], cwd=SRC_DIR).decode().strip()
+  except (OSError, subprocess.CalledProcessError):
+    return None
+
+def find_regressions(report, baseline, threshold):
+  old = dict(((run["trace"], run["params"]), run) for run in baseline["runs"])
+  regressions = []
+  for run in report["runs"]:
+    prev = old.get((run["trace"], run["params"]))
+    if prev and prev["kips"] and run["kips"] < prev["kips"] * (1 - threshold / 100.0):
+      regressions.append("%s on %s: %.1f KIPS, was %.1f" % (run["trace"], run["params"], run["kips"], prev["kips"]))
+  return regressions
+
+def main():
+  parser = argparse.ArgumentParser(description="Scarab throughput benchmark")
+  parser.add_argument("traces", nargs="+", help="PIN traces to simulate")
+  parser.add_argument("--scarab", default=os.path.join(SRC_DIR, "scarab"), help="Scarab binary (default src/scarab)")
+  parser.add_argument("--params", nargs="+", default=DEFAULT_PARAMS,
+                      help="Configs: names of src/PARAMS.<name> or paths (default %s)" % " ".join(DEFAULT_PARAMS))
+  parser.add_argument("--repeat", type=int, default=1, help="Runs of each pair; the fastest one is kept")
+  parser.add_argument("--scarab_args", default="", help="Extra arguments for every run, e.g. --inst_limit")
+  parser.add_argument("--output", default=None, help="Write the JSON report here instead of stdout")
+  parser.add_argument("--baseline", default=None, help="JSON report of an earlier run to compare against")
+  parser.add_argument("--threshold", type=float, default=10.0, help="KIPS drop in percent that is a regression")
+  args = parser.parse_args()
+
+  report = {"scarab_rev": git_rev(), "host": os.uname()[1], "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+            "runs": []}
+  for trace in args.traces:
+    for params in args.params:
+      path = params if os.path.exists(params) else os.path.join(SRC_DIR, "PARAMS." + params)
+      best = None
+      for _ in range(max(args.repeat, 1)):
+        result = run_one(args.scarab, trace, path, args.scarab_args.split())
+        if best is None or result["wall_secs"] < best["wall_secs"]:
+          best = result
+      best["trace"] = os.path.basename(trace)
+      best["params"] = os.path.basename(path).replace("PARAMS.", "")
+      print("%-24s %-12s %8.1f KIPS  %8d KB" % (best["trace"], best["params"], best["kips"], best["peak_rss_kb"]),
+            file=sys.stderr)
+      report["runs"].append(best)
+
+  text = json.dumps(report, indent=2, sort_keys=True)
+  if args.output:
+    with open(args.output, "w") as out:
+      out.write(text + "\n")
+  else:
+    print(text)
+
+  if args.baseline:
+    with open(args.baseline) as baseline:
+      regressions = find_regressions(report, json.load(baseline), args.threshold)
+    for regression in regressions:
+      print("Regression: " + regression, file=sys.stderr)
+    if regressions:
+      sys.exit(1)
+
+if __name__ == "__main__":
+  main()
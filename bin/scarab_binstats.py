@@ -0,0 +1,150 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Reads the stats<proc_id>.bin files written with
+--stats_format binary (or both). Each dump of the run is one row; every stat
+has a <name>_count column for the dump interval and a <name>_total_count
+column since the start of the run (FLOAT stats: <name>_value and
+<name>_total_value). The per-row columns period_id, cycles, instructions,
+period_cycles, period_instructions, flags (bit 0: warmup, bit 1: roi) and
+roi_id describe the dump.
+
+Examples:
+  python bin/scarab_binstats.py stats0.bin --list
+  python bin/scarab_binstats.py stats0.bin --stat DCACHE_MISS --stat DCACHE_HIT
+  python bin/scarab_binstats.py stats0.bin --export_csv stats0.csv
+
+As a module, read_binstats() returns the per-stat metadata and a numpy
+structured array with one record per dump.
+"""
+
+from __future__ import print_function
+import argparse
+import struct
+import sys
+
+import numpy as np
+
+MAGIC = b"SCARSTAT"
+VERSION = 1
+
+# Must match Stat_Type in src/statistics.h
+FLOAT_TYPE_STAT = 1
+LINE_TYPE_STAT = 9
+
+# Must match Stat_Bin_Row_Field in src/statistics.c
+ROW_FIELDS = ["period_id", "cycles", "instructions", "period_cycles", "period_instructions", "flags", "roi_id"]
+
+class StatInfo:
+  def __init__(self, name, type, ratio_stat, file_name):
+    self.name = name
+    self.type = type
+    self.ratio_stat = ratio_stat
+    self.file_name = file_name
+
+  def is_float(self):
+    return self.type == FLOAT_TYPE_STAT
+
+def read_binstats(path):
+  with open(path, 'rb') as f:
+    data = f.read()
+
+  if data[:8] != MAGIC:
+    raise ValueError("{} is not a scarab binary stats file".format(path))
+  version, proc_id, num_stats, num_row_fields = struct.unpack_from("=4I", data, 8)
+  if version != VERSION:
+    raise ValueError("{}: unsupported version {} (expected {})".format(path, version, VERSION))
+  if num_row_fields < len(ROW_FIELDS):
+    raise ValueError("{}: {} row fields, expected at least {}".format(path, num_row_fields, len(ROW_FIELDS)))
+
+  pos = 24
+  def read_str():
+    nonlocal pos
+    length, = struct.unpack_from("=I", data, pos)
+    s = data[pos + 4:pos + 4 + length].decode()
+    pos += 4 + length
+    return s
+
+  stats = []
+  for _ in range(num_stats):
+    type, ratio_stat = struct.unpack_from("=2I", data, pos)
+    pos += 8
+    name = read_str()
+    file_name = read_str()
+    stats.append(StatInfo(name, type, ratio_stat, file_name))
+
+  # Rows are fixed size; a trailing partial row (run killed mid-write) is dropped
+  fields = [(n, '=u8') for n in ROW_FIELDS] + [("_row_pad{}".format(i), '=u8') for i in range(num_row_fields - len(ROW_FIELDS))]
+  for suffix in ["count", "total_count"]:
+    for s in stats:
+      if s.is_float():
+        fields.append(("{}_{}".format(s.name, suffix.replace("count", "value")), '=f8'))
+      else:
+        fields.append(("{}_{}".format(s.name, suffix), '=u8'))
+  dtype = np.dtype(fields)
+  num_rows = (len(data) - pos) // dtype.itemsize
+  rows = np.frombuffer(data, dtype=dtype, count=num_rows, offset=pos)
+  return proc_id, stats, rows
+
+def stat_columns(stat, total=False):
+  kind = "value" if stat.is_float() else "count"
+  return "{}_{}{}".format(stat.name, "total_" if total else "", kind)
+
+def main():
+  parser = argparse.ArgumentParser(description="Read Scarab binary stats (--stats_format binary)")
+  parser.add_argument('file', help="Path to a stats<proc_id>.bin file.")
+  parser.add_argument('--list', action='store_true', help="List the stats in the file.")
+  parser.add_argument('--stat', action='append', default=None, help="Print the per-dump values of this stat.")
+  parser.add_argument('--total', action='store_true', help="With --stat, print the running totals instead of the per-dump values.")
+  parser.add_argument('--export_csv', default=None, help="Write all rows to this csv file, one column per stat.")
+  args = parser.parse_args()
+
+  proc_id, stats, rows = read_binstats(args.file)
+  by_name = {s.name: s for s in stats}
+  print("Core {}: {} stats, {} dumps".format(proc_id, len(stats), len(rows)))
+
+  if args.list:
+    for s in stats:
+      if s.type != LINE_TYPE_STAT:
+        print("  {:<48} {}".format(s.name, s.file_name))
+
+  if args.stat:
+    for name in args.stat:
+      if name not in by_name:
+        print("Unknown stat {}".format(name))
+        sys.exit(1)
+    columns = [stat_columns(by_name[name], args.total) for name in args.stat]
+    print(" ".join(["{:>20}".format(c) for c in ["instructions"] + args.stat]))
+    for row in rows:
+      print(" ".join(["{:>20}".format(row[c]) for c in ["instructions"] + columns]))
+
+  if args.export_csv:
+    names = [n for n in rows.dtype.names if not n.startswith("_row_pad")]
+    with open(args.export_csv, 'w') as f:
+      f.write(",".join(names) + "\n")
+      for row in rows:
+        f.write(",".join([str(row[n]) for n in names]) + "\n")
+
+if __name__ == "__main__":
+  main()
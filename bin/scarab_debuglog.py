@@ -0,0 +1,186 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Formats the binary debug log written with --debug_log_file into
+the text the debug macros print without it. The format strings are printf
+format strings, so the arguments are re-applied with the equivalent Python
+conversions.
+
+Examples:
+  python bin/scarab_debuglog.py debug.log > debug.txt
+  python bin/scarab_debuglog.py debug.log --flag DEBUG_MEMORY --start 1000000 --end 1100000
+"""
+
+from __future__ import print_function
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b"SCARDBG\0"
+VERSION = 1
+SITE_TAG = 1
+EVENT_TAG = 2
+
+# Must match src/debug/debug_log.c
+RECORD_HEADER = struct.Struct("=BH")
+SITE_HEADER = struct.Struct("=IIB")
+EVENT_HEADER = struct.Struct("=II3Q")
+CONVERSION = re.compile(r"%([-+ #0']*)(\*|\d+)?(?:\.(\*|\d*))?([hlLqjzt]*)([diouxXeEfFgGaAcspn%])")
+SIGNED = "di"
+FLOATS = "aAeEfFgG"
+
+class Site(object):
+  def __init__(self, line, lean, file, flag, fmt):
+    self.line = line
+    self.lean = lean
+    self.file = file
+    self.flag = flag
+    self.fmt = fmt
+    self.pieces = split_format(fmt)
+
+def split_format(fmt):
+  """Splits a printf format string into literal text and conversion specs."""
+  pieces = []
+  pos = 0
+  for match in CONVERSION.finditer(fmt):
+    if match.start() > pos:
+      pieces.append(fmt[pos:match.start()])
+    pieces.append(match)
+    pos = match.end()
+  pieces.append(fmt[pos:])
+  return pieces
+
+def read_string(data, pos):
+  length, = struct.unpack_from("=H", data, pos)
+  return data[pos + 2:pos + 2 + length].decode(errors="replace"), pos + 2 + length
+
+class Args(object):
+  """The raw arguments of one event, consumed in format string order."""
+  def __init__(self, data, pos, end):
+    self.data = data
+    self.pos = pos
+    self.end = end
+
+  def value(self, conv):
+    if conv == 's':
+      if self.pos + 2 > self.end:
+        return None
+      value, self.pos = read_string(self.data, self.pos)
+      return value
+    if self.pos + 8 > self.end:
+      return None
+    fmt = "=d" if conv in FLOATS else "=q" if conv in SIGNED else "=Q"
+    value, = struct.unpack_from(fmt, self.data, self.pos)
+    self.pos += 8
+    return value
+
+def format_conversion(match, args):
+  flags, width, precision, _, conv = match.groups()
+  if conv == '%':
+    return '%'
+  if conv == 'n':
+    return ''
+  if width == '*':
+    width = args.value('d')
+    width = '?' if width is None else str(width)
+  if precision == '*':
+    precision = args.value('d')
+    precision = '?' if precision is None else str(precision)
+  value = args.value(conv)
+  if value is None or '?' in (width, precision):
+    return '?'
+  flags = flags.replace("'", "")
+  spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+  if conv == 'p':
+    return (spec + 's') % ("0x{:x}".format(value) if value else "(nil)")
+  if conv == 'c':
+    return (spec + 'c') % chr(value & 0xff)
+  if conv in "iu":
+    conv = 'd'
+  elif conv in "aA":
+    conv = 'e'
+  elif conv == 'F':
+    conv = 'f'
+  return (spec + conv) % value
+
+def format_event(site, args):
+  return "".join(p if isinstance(p, str) else format_conversion(p, args) for p in site.pieces)
+
+def read_log(path):
+  """Yields (site, proc_id, op, inst, cycle, message) for every event of the log."""
+  with open(path, 'rb') as f:
+    data = f.read()
+  if data[:8] != MAGIC:
+    raise ValueError("{} is not a scarab binary debug log".format(path))
+  version, = struct.unpack_from("=I", data, 8)
+  if version != VERSION:
+    raise ValueError("{}: unsupported version {}".format(path, version))
+
+  sites = {}
+  pos = 12
+  while pos + RECORD_HEADER.size <= len(data):
+    tag, size = RECORD_HEADER.unpack_from(data, pos)
+    pos += RECORD_HEADER.size
+    end = pos + size
+    if end > len(data):
+      break  # the run died while writing the record
+    if tag == SITE_TAG:
+      site_id, line, lean = SITE_HEADER.unpack_from(data, pos)
+      file, p = read_string(data, pos + SITE_HEADER.size)
+      flag, p = read_string(data, p)
+      fmt, p = read_string(data, p)
+      sites[site_id] = Site(line, lean, file, flag, fmt)
+    elif tag == EVENT_TAG:
+      site_id, proc_id, op, inst, cycle = EVENT_HEADER.unpack_from(data, pos)
+      site = sites[site_id]
+      message = format_event(site, Args(data, pos + EVENT_HEADER.size, end))
+      yield site, proc_id, op, inst, cycle, message
+    pos = end
+
+def main():
+  parser = argparse.ArgumentParser(description="Format a Scarab binary debug log")
+  parser.add_argument('file', help="Path to the --debug_log_file output.")
+  parser.add_argument('--output', default=None, help="Write the text to this file instead of stdout.")
+  parser.add_argument('--flag', action='append', default=None, help="Only print messages of this debug flag.")
+  parser.add_argument('--start', type=int, default=0, help="Only print messages at or after this cycle.")
+  parser.add_argument('--end', type=int, default=None, help="Only print messages before this cycle.")
+  args = parser.parse_args()
+
+  out = open(args.output, 'w') if args.output else sys.stdout
+  for site, proc_id, op, inst, cycle, message in read_log(args.file):
+    if args.flag and site.flag not in args.flag:
+      continue
+    if cycle < args.start or (args.end is not None and cycle >= args.end):
+      continue
+    if not site.lean:
+      out.write("{}:{}: {} (P={} O={}  I={}  C={}):  ".format(site.file, site.line, site.flag, proc_id, op, inst,
+                                                             cycle))
+    out.write(message)
+  if args.output:
+    out.close()
+
+if __name__ == "__main__":
+  main()
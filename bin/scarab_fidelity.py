@@ -0,0 +1,114 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+"""
+Author: HPS Research Group
+Date: 10/15/2026
+Description: Fidelity profile check (make fidelity in src/). Runs every trace
+against every PARAMS.* config once per --fidelity profile and reports, for
+each profile, the host speedup and the IPC error relative to the accurate
+profile, as JSON. A profile whose IPC is off by more than --max_error percent
+on any run is reported, and the script exits with status 1.
+
+Examples:
+  python bin/scarab_fidelity.py --scarab src/scarab src/test/simple_loop.trace.bz2
+  python bin/scarab_fidelity.py --profiles accurate balanced fast,dram=ramulator \\
+      --max_error 10 bench/*.trace.bz2
+"""
+
+from __future__ import print_function
+import argparse
+import json
+import os
+import sys
+import time
+
+from scarab_bench import DEFAULT_PARAMS, SRC_DIR, git_rev, run_one
+
+REFERENCE = "accurate"
+
+def main():
+  parser = argparse.ArgumentParser(description="Scarab fidelity profile check")
+  parser.add_argument("traces", nargs="+", help="PIN traces to simulate")
+  parser.add_argument("--scarab", default=os.path.join(SRC_DIR, "scarab"), help="Scarab binary (default src/scarab)")
+  parser.add_argument("--params", nargs="+", default=DEFAULT_PARAMS,
+                      help="Configs: names of src/PARAMS.<name> or paths (default %s)" % " ".join(DEFAULT_PARAMS))
+  parser.add_argument("--profiles", nargs="+", default=["balanced", "fast"],
+                      help="--fidelity specs to compare with the accurate profile (default balanced fast)")
+  parser.add_argument("--scarab_args", default="", help="Extra arguments for every run, e.g. --inst_limit")
+  parser.add_argument("--output", default=None, help="Write the JSON report here instead of stdout")
+  parser.add_argument("--max_error", type=float, default=None, help="IPC error in percent that fails a profile")
+  args = parser.parse_args()
+
+  report = {"scarab_rev": git_rev(), "host": os.uname()[1], "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+            "runs": [], "profiles": {}}
+  profiles = [REFERENCE] + [profile for profile in args.profiles if profile != REFERENCE]
+  failures = []
+  for trace in args.traces:
+    for params in args.params:
+      path = params if os.path.exists(params) else os.path.join(SRC_DIR, "PARAMS." + params)
+      ref = None
+      for profile in profiles:
+        result = run_one(args.scarab, trace, path, ["--fidelity", profile] + args.scarab_args.split())
+        result["ipc"] = float(result["insts"]) / result["cycles"] if result["cycles"] else 0.0
+        if ref is None:
+          ref = result
+        result["speedup"] = result["kips"] / ref["kips"] if ref["kips"] else 0.0
+        result["ipc_error"] = 100.0 * (result["ipc"] - ref["ipc"]) / ref["ipc"] if ref["ipc"] else 0.0
+        result["trace"] = os.path.basename(trace)
+        result["params"] = os.path.basename(path).replace("PARAMS.", "")
+        result["profile"] = profile
+        del result["regions"]
+        print("%-24s %-12s %-20s %8.1f KIPS  %5.2fx  IPC %6.3f (%+6.2f%%)" %
+              (result["trace"], result["params"], profile, result["kips"], result["speedup"], result["ipc"],
+               result["ipc_error"]), file=sys.stderr)
+        report["runs"].append(result)
+        if args.max_error is not None and abs(result["ipc_error"]) > args.max_error:
+          failures.append("%s on %s with %s: IPC off by %+.2f%%" %
+                          (result["trace"], result["params"], profile, result["ipc_error"]))
+
+  # geometric mean speedup and mean absolute IPC error of every profile
+  for profile in profiles:
+    runs = [run for run in report["runs"] if run["profile"] == profile]
+    speedup = 1.0
+    for run in runs:
+      speedup *= max(run["speedup"], 1e-9)
+    report["profiles"][profile] = {"speedup": speedup ** (1.0 / len(runs)),
+                                   "mean_abs_ipc_error": sum(abs(run["ipc_error"]) for run in runs) / len(runs)}
+    print("%-20s %5.2fx  mean |IPC error| %5.2f%%" % (profile, report["profiles"][profile]["speedup"],
+                                                     report["profiles"][profile]["mean_abs_ipc_error"]),
+          file=sys.stderr)
+
+  text = json.dumps(report, indent=2, sort_keys=True)
+  if args.output:
+    with open(args.output, "w") as out:
+      out.write(text + "\n")
+  else:
+    print(text)
+
+  for failure in failures:
+    print("Accuracy: " + failure, file=sys.stderr)
+  if failures:
+    sys.exit(1)
+
+if __name__ == "__main__":
+  main()
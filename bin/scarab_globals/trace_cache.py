@@ -0,0 +1,85 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Client side of the node-local trace cache (see bin/scarab_trace_cache.py).
+
+request_sct() asks the cache daemon of this node for the pre-decoded .sct of a
+trace and returns the path of the shared copy. The daemon decodes each trace
+once; every later request for it gets the same file, which the sct frontend then
+maps read-only.
+"""
+
+import hashlib
+import json
+import os
+import shlex
+import socket
+
+default_cache_dir = "/dev/shm/scarab_trace_cache"
+
+def socket_path(cache_dir):
+  return os.path.join(cache_dir, "server.sock")
+
+def absolute_decode_args(decode_args):
+  """
+  Make every argument that names an existing file absolute, so the daemon can
+  decode from its own directory and the key does not depend on the client's.
+  """
+  tokens = shlex.split(decode_args)
+  return [os.path.abspath(t) if os.path.exists(t) else t for t in tokens]
+
+def trace_key(scarab, decode_tokens, params_text):
+  """
+  Name of the cache entry of a trace: the decoder, its arguments and PARAMS
+  file, and the size and modification time of every file the arguments name.
+  """
+  h = hashlib.sha1()
+  h.update(os.path.realpath(scarab).encode())
+  h.update(params_text.encode())
+  for token in decode_tokens:
+    h.update(b"\0" + token.encode())
+    if os.path.isfile(token):
+      st = os.stat(token)
+      h.update("{}:{}".format(st.st_size, int(st.st_mtime)).encode())
+  return h.hexdigest()[:20]
+
+def request_sct(decode_args, params=None, cache_dir=default_cache_dir):
+  """
+  Returns the path of the shared .sct of the trace named by decode_args (the
+  scarab arguments of a --mode trace_sct run). Blocks while the daemon decodes
+  it. Raises RuntimeError if the decode fails or no daemon is running.
+  """
+  request = {"decode_args": absolute_decode_args(decode_args)}
+  if params:
+    request["params"] = os.path.abspath(params)
+
+  sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+  try:
+    sock.connect(socket_path(cache_dir))
+  except OSError as e:
+    raise RuntimeError("No trace cache daemon at {}: {}".format(socket_path(cache_dir), e))
+  with sock, sock.makefile("rw") as stream:
+    stream.write(json.dumps(request) + "\n")
+    stream.flush()
+    reply = json.loads(stream.readline() or "{}")
+  if "sct" not in reply:
+    raise RuntimeError("Trace cache: {}".format(reply.get("error", "no reply from the daemon")))
+  return reply["sct"]
@@ -0,0 +1,115 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Polls the live_stats page of a running simulation
+(--live_stats 1) and prints one line per core every interval: instructions,
+IPC, ROB and memory request buffer occupancy and the per-kilo-instruction
+rate (MPKI) of every stat in --live_stats_stats, plus the simulation speed.
+Reading the page never blocks the simulation.
+
+Examples:
+  python bin/scarab_live.py live_stats
+  python bin/scarab_live.py results/live_stats --interval 10 --once
+
+As a module, read_live_stats() returns one consistent snapshot of the page
+as a dict.
+"""
+
+from __future__ import print_function
+import argparse
+import mmap
+import struct
+import sys
+import time
+
+MAGIC = b"SCARLIV\0"
+VERSION = 1
+NAME_LENGTH = 64
+STATE_DONE = 2
+
+# Must match Live_Stats_Header in src/debug/live_stats.c
+HEADER = struct.Struct("=8sIIIIQQdQdd")
+SEQ_OFFSET = 24
+CORE_FIELDS = ["insts", "uops", "rob_ops", "mem_reqs"]
+
+def read_live_stats(page):
+  while True:
+    magic, version, num_cores, num_stats, state, seq, updates, wall_secs, cycles, kips, interval_kips = \
+        HEADER.unpack_from(page, 0)
+    if magic != MAGIC:
+      raise ValueError("not a live stats page")
+    if version != VERSION:
+      raise ValueError("live stats page has version %d, expected %d" % (version, VERSION))
+    if seq & 1:
+      time.sleep(0.001)
+      continue
+    pos = HEADER.size
+    names = []
+    for _ in range(num_stats):
+      names.append(page[pos:pos + NAME_LENGTH].split(b"\0", 1)[0].decode())
+      pos += NAME_LENGTH
+    cores = []
+    core = struct.Struct("=4Qd" + "Qd" * num_stats)
+    for _ in range(num_cores):
+      values = core.unpack_from(page, pos)
+      pos += core.size
+      info = dict(zip(CORE_FIELDS, values[:4]))
+      info["ipc"] = values[4]
+      info["stats"] = dict((names[ii], (values[5 + 2 * ii], values[6 + 2 * ii])) for ii in range(num_stats))
+      cores.append(info)
+    if struct.unpack_from("=Q", page, SEQ_OFFSET)[0] != seq:
+      continue
+    return {"done": state == STATE_DONE, "updates": updates, "wall_secs": wall_secs, "cycles": cycles,
+            "kips": kips, "interval_kips": interval_kips, "stats": names, "cores": cores}
+
+def print_snapshot(snap, out):
+  print("%8.0fs  cycles %-14d  %.2f KIPS (%.2f KIPS)%s" % (snap["wall_secs"], snap["cycles"], snap["interval_kips"],
+        snap["kips"], "  done" if snap["done"] else ""), file=out)
+  for proc_id, core in enumerate(snap["cores"]):
+    line = "  core %-2d insts %-14d IPC %.3f  ROB %-4d reqs %-4d" % (
+        proc_id, core["insts"], core["ipc"], core["rob_ops"], core["mem_reqs"])
+    for name in snap["stats"]:
+      line += "  %s %.2f" % (name, core["stats"][name][1])
+    print(line, file=out)
+  out.flush()
+
+def main():
+  parser = argparse.ArgumentParser(description="Poll the live stats of a running Scarab simulation")
+  parser.add_argument("page", help="live_stats file")
+  parser.add_argument("--interval", type=float, default=5.0, help="seconds between prints")
+  parser.add_argument("--once", action="store_true", help="print one snapshot and exit")
+  args = parser.parse_args()
+
+  with open(args.page, "rb") as f:
+    page = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    while True:
+      snap = read_live_stats(page)
+      print_snapshot(snap, sys.stdout)
+      if args.once or snap["done"]:
+        break
+      time.sleep(args.interval)
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,129 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Converts the binary pipeview files written with
+--pipeview 1 --pipeview_binary 1 (<pipeview_file>.<proc_id>.bin) to the
+O3PipeView text format of the text pipeview, or to a Chrome trace that
+chrome://tracing and ui.perfetto.dev can open. In the Chrome trace every op is
+a row of pipeline stage slices, one microsecond per cycle.
+
+Examples:
+  python bin/scarab_pipeview.py pipeview.0.bin --text pipeview.0.trace
+  python bin/scarab_pipeview.py pipeview.0.bin --chrome pipeview.0.json --start 1000000 --end 1100000
+"""
+
+from __future__ import print_function
+import argparse
+import json
+import struct
+
+MAGIC = b"SCARPVW\0"
+VERSION = 1
+
+# Must match Pipeview_Record in src/debug/pipeview.c
+RECORD = struct.Struct("=12QIBB2x48s")
+FIELDS = ["unique_num", "addr", "fetch", "map", "issue", "rdy", "sched", "exec", "dcache", "done", "retire", "free",
+          "proc_id", "off_path", "srcs_rdy", "disasm"]
+PREFIX = "O3PipeView"
+
+def read_records(path):
+  with open(path, 'rb') as f:
+    data = f.read()
+  if data[:8] != MAGIC:
+    raise ValueError("{} is not a scarab binary pipeview file".format(path))
+  version, record_size, decode_cycles, map_cycles = struct.unpack_from("=4I", data, 8)
+  if version != VERSION or record_size != RECORD.size:
+    raise ValueError("{}: unsupported version {} / record size {}".format(path, version, record_size))
+
+  records = []
+  for pos in range(24, len(data) - RECORD.size + 1, RECORD.size):
+    rec = dict(zip(FIELDS, RECORD.unpack_from(data, pos)))
+    rec["disasm"] = rec["disasm"].split(b"\0", 1)[0].decode(errors="replace")
+    records.append(rec)
+  return decode_cycles, map_cycles, records
+
+def op_events(rec, decode_cycles, map_cycles):
+  """The events of one op in the order the text pipeview prints them."""
+  events = [("fetch_offpath" if rec["off_path"] else "fetch", rec["fetch"]),
+            ("decode", rec["fetch"] + 1),
+            ("decode_done", rec["fetch"] + 1 + decode_cycles),
+            ("map", rec["map"]),
+            ("map_done", rec["map"] + map_cycles),
+            ("issue", rec["issue"]),
+            ("issue_done", rec["issue"] + 1)]
+  if rec["srcs_rdy"]:
+    events.append(("ready", max(rec["rdy"], rec["issue"] + 1)))
+  events += [("sched", rec["sched"]), ("exec", rec["exec"]), ("dcache", rec["dcache"]), ("done", rec["done"])]
+  if rec["off_path"]:
+    events += [("flush", rec["free"]), ("end", rec["free"])]
+  else:
+    events += [("retire", rec["retire"]), ("end", rec["retire"])]
+  # flushed ops may not have all cycles set and non mem ops have no dcache cycle
+  return [(name, cycle) for name, cycle in events if rec["fetch"] <= cycle <= rec["free"]]
+
+def write_text(path, records, decode_cycles, map_cycles):
+  with open(path, 'w') as f:
+    for rec in records:
+      f.write("{}:new:{}:{:x}:0:{}:{}\n".format(PREFIX, rec["fetch"], rec["addr"], rec["unique_num"], rec["disasm"]))
+      for name, cycle in op_events(rec, decode_cycles, map_cycles):
+        f.write("{}:{}:{}\n".format(PREFIX, name, cycle))
+
+def write_chrome(path, records, decode_cycles, map_cycles, lanes):
+  trace = []
+  for rec in records:
+    events = []
+    for name, cycle in op_events(rec, decode_cycles, map_cycles):
+      # stages that were skipped (e.g. dcache of a non mem op) would go back in time
+      if not name.endswith("_done") and (not events or cycle >= events[-1][1]):
+        events.append((name, cycle))
+    args = {"uid": rec["unique_num"], "pc": "{:x}".format(rec["addr"]), "disasm": rec["disasm"],
+            "off_path": bool(rec["off_path"])}
+    for (name, start), (_, end) in zip(events, events[1:]):
+      trace.append({"name": name, "ph": "X", "ts": start, "dur": max(end - start, 1), "pid": rec["proc_id"],
+                    "tid": rec["unique_num"] % lanes, "args": args})
+  with open(path, 'w') as f:
+    json.dump({"traceEvents": trace, "displayTimeUnit": "ns"}, f)
+
+def main():
+  parser = argparse.ArgumentParser(description="Convert Scarab binary pipeview traces")
+  parser.add_argument('file', help="Path to a <pipeview_file>.<proc_id>.bin file.")
+  parser.add_argument('--text', default=None, help="Write the O3PipeView text format to this file.")
+  parser.add_argument('--chrome', default=None, help="Write a Chrome/Perfetto trace (json) to this file.")
+  parser.add_argument('--start', type=int, default=0, help="Only convert ops fetched at or after this cycle.")
+  parser.add_argument('--end', type=int, default=None, help="Only convert ops fetched before this cycle.")
+  parser.add_argument('--lanes', type=int, default=256, help="Rows used for the ops of one core in the Chrome trace.")
+  args = parser.parse_args()
+
+  decode_cycles, map_cycles, records = read_records(args.file)
+  records = [r for r in records if r["fetch"] >= args.start and (args.end is None or r["fetch"] < args.end)]
+  print("{}: {} ops".format(args.file, len(records)))
+  if not args.text and not args.chrome:
+    print("Usage: supply --text and/or --chrome.")
+  if args.text:
+    write_text(args.text, records, decode_cycles, map_cycles)
+  if args.chrome:
+    write_chrome(args.chrome, records, decode_cycles, map_cycles, args.lanes)
+
+if __name__ == "__main__":
+  main()
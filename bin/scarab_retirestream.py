@@ -0,0 +1,123 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+"""
+Author: HPS Research Group
+Date: 10/15/2026
+Description: Reads the <retire_stream_file>.<proc_id>.bin files written with
+--retire_stream_file and prints one tab-separated row per retired op. The
+cycle columns are absolute (the file stores them relative to the retire
+cycle); -1 marks a stage the op never went through. --summary prints the
+op, branch and miss level counts instead.
+
+Examples:
+  python bin/scarab_retirestream.py retire.0.bin | head
+  python bin/scarab_retirestream.py retire.0.bin --summary
+
+As a module, read_retirestream() yields one dict per retired op.
+"""
+
+from __future__ import print_function
+import argparse
+import collections
+import struct
+import sys
+
+MAGIC = b"SCARRET\0"
+VERSION = 1
+
+# Must match Retire_Stream_Record in src/retire_stream.h
+RECORD = struct.Struct("=QQQIIIBBH")
+NO_CYCLE = 0xffffffff
+FLAG_DIR = 0x1
+FLAG_PRED = 0x2
+FLAG_MISPRED = 0x4
+FLAG_MISFETCH = 0x8
+FLAG_BOM = 0x10
+FLAG_EOM = 0x20
+MISS_SHIFT = 6
+MEM_SHIFT = 8
+MISS_LEVELS = ["hit", "dcache_miss", "mlc_miss", "l1_miss"]
+MEM_TYPES = ["", "ld", "st", "pf", "wh", "evict"]
+
+COLUMNS = ["pc", "addr", "op_type", "cf_type", "mem_type", "dir", "pred", "mispred", "misfetch", "bom", "eom",
+           "miss_level", "fetch_cycle", "sched_cycle", "done_cycle", "retire_cycle"]
+
+def read_retirestream(filename):
+  with open(filename, "rb") as f:
+    header = f.read(20)
+    if header[:8] != MAGIC:
+      raise ValueError("%s is not a retire stream" % filename)
+    version, _, record_size = struct.unpack_from("=III", header, 8)
+    if version != VERSION or record_size != RECORD.size:
+      raise ValueError("%s has version %d and %d-byte records, expected %d and %d" %
+                       (filename, version, record_size, VERSION, RECORD.size))
+    while True:
+      data = f.read(RECORD.size * 4096)
+      if not data:
+        return
+      for pos in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        pc, addr, retire, fetch_lat, sched_lat, done_lat, op_type, cf_type, flags = RECORD.unpack_from(data, pos)
+        yield {
+          "pc": pc, "addr": addr, "op_type": op_type, "cf_type": cf_type,
+          "mem_type": MEM_TYPES[(flags >> MEM_SHIFT) & 0x7],
+          "dir": int(bool(flags & FLAG_DIR)), "pred": int(bool(flags & FLAG_PRED)),
+          "mispred": int(bool(flags & FLAG_MISPRED)), "misfetch": int(bool(flags & FLAG_MISFETCH)),
+          "bom": int(bool(flags & FLAG_BOM)), "eom": int(bool(flags & FLAG_EOM)),
+          "miss_level": MISS_LEVELS[(flags >> MISS_SHIFT) & 0x3],
+          "fetch_cycle": -1 if fetch_lat == NO_CYCLE else retire - fetch_lat,
+          "sched_cycle": -1 if sched_lat == NO_CYCLE else retire - sched_lat,
+          "done_cycle": -1 if done_lat == NO_CYCLE else retire - done_lat,
+          "retire_cycle": retire,
+        }
+
+def main():
+  parser = argparse.ArgumentParser(description="Print a binary Scarab retire stream")
+  parser.add_argument("stream", help="<retire_stream_file>.<proc_id>.bin file")
+  parser.add_argument("--summary", action="store_true", help="print counts instead of one row per op")
+  parser.add_argument("--output", help="output file (default: stdout)")
+  args = parser.parse_args()
+
+  out = open(args.output, "w") if args.output else sys.stdout
+  if args.summary:
+    counts = collections.Counter()
+    for op in read_retirestream(args.stream):
+      counts["ops"] += 1
+      counts["insts"] += op["eom"]
+      if op["cf_type"]:
+        counts["branches"] += 1
+        counts["mispreds"] += op["mispred"]
+        counts["misfetches"] += op["misfetch"]
+      if op["mem_type"]:
+        counts["mem_" + op["mem_type"]] += 1
+        counts[op["miss_level"]] += 1
+    for name in sorted(counts):
+      print("%s\t%d" % (name, counts[name]), file=out)
+  else:
+    print("\t".join(COLUMNS), file=out)
+    for op in read_retirestream(args.stream):
+      print("\t".join(("0x%x" % op[c]) if c in ("pc", "addr") else str(op[c]) for c in COLUMNS), file=out)
+  if args.output:
+    out.close()
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,191 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Simulates the SimPoint regions of one trace in parallel and writes
+their weighted stats. The trace is decoded once into a .sct file, whose index
+lets every region start with --fast_forward_trace_ins without decoding the
+instructions before it. Region r covers the fetched instructions
+[r * segment_size, (r + 1) * segment_size), as in the BBVs written by
+--mode trace_bbv with --segment_instr_count segment_size.
+
+Simpoints file: one '<region> <cluster>' per line (SimPoint's -saveSimpoints).
+Weights file: one '<weight> <cluster>' per line (SimPoint's -saveSimpointWeights).
+"""
+
+from __future__ import print_function
+import argparse
+import multiprocessing
+import os
+import shutil
+import sys
+import time
+
+from scarab_globals import *
+
+parser = argparse.ArgumentParser(description="Simulate the SimPoint regions of one pre-decoded trace in parallel")
+parser.add_argument('simpoints', help="Path to the simpoints file (one '<region> <cluster>' per line).")
+parser.add_argument('weights', help="Path to the weights file (one '<weight> <cluster>' per line).")
+parser.add_argument('--segment_size', type=int, required=True, help="Fetched instructions per region, the SEGMENT_INSTR_COUNT of the BBVs.")
+parser.add_argument('--warmup', type=int, default=0, help="Instructions before each region used to warm the caches and predictors.")
+parser.add_argument('--sct', default=None, help="Path to an existing .sct trace. Skips the decode step.")
+parser.add_argument('--decode_args', default="", help="Scarab arguments selecting the trace to decode, e.g. "
+                    "\"--frontend memtrace --cbp_trace_r0 trace.zip --memtrace_modules_log bin\".")
+parser.add_argument('--params', default=None, help="Path to the PARAMS file shared by all regions.")
+parser.add_argument('--scarab_args', default="", help="Arguments passed to every simulation.")
+parser.add_argument('--simdir', default=os.getcwd(), help="Directory for the .sct trace, one subdirectory per region and the weighted stats.")
+parser.add_argument('--jobs', type=int, default=multiprocessing.cpu_count(), help="Simulations to run at once. Defaults to the number of host cores.")
+parser.add_argument('--scarab', default=scarab_paths.scarab_bin, help="Path to the scarab binary. Defaults to src/scarab.")
+
+args = parser.parse_args()
+
+def read_pairs(path, convert):
+  """
+  Parse '<value> <cluster>' lines into {cluster: value}.
+  """
+  pairs = {}
+  with open(path, 'r') as f:
+    for line in f:
+      fields = line.split()
+      if not fields or fields[0].startswith('#'):
+        continue
+      assert len(fields) == 2, "Error: malformed line in {}: {}".format(path, line.strip())
+      pairs[int(fields[1])] = convert(fields[0])
+  return pairs
+
+def copy_params_file(run_dir):
+  if args.params:
+    shutil.copy2(args.params, os.path.join(run_dir, "PARAMS.in"))
+
+def decode_trace():
+  """
+  Decode the trace once. The decode run writes decode.out in simdir.
+  """
+  if args.sct:
+    return os.path.abspath(args.sct)
+
+  sct_path = os.path.join(args.simdir, "trace.sct")
+  if os.path.exists(sct_path):
+    scarab_utils.warn("Reusing existing decoded trace {}".format(sct_path))
+    return sct_path
+
+  copy_params_file(args.simdir)
+  cmd_str = "{scarab} --mode trace_sct --sct_output {sct} {decode_args}".format(
+    scarab=args.scarab, sct=sct_path, decode_args=args.decode_args)
+  print('\nDecoding trace:\n' + cmd_str + '\n')
+  cmd = command.Command(cmd_str, run_dir=args.simdir, results_dir=args.simdir, stdout="decode.out", stderr="decode.out")
+  if cmd.run() != 0 or not os.path.exists(sct_path):
+    print("Error: decoding the trace failed, see {}".format(os.path.join(args.simdir, "decode.out")))
+    sys.exit(1)
+  return sct_path
+
+def region_command(cluster, region, sct_path):
+  """
+  Region start is counted in fetched instructions (--use_fetched_count), like
+  the BBV segments. The warmup, if any, is taken from the end of the previous
+  regions.
+  """
+  name = "cluster{}".format(cluster)
+  run_dir = os.path.join(args.simdir, name)
+  os.makedirs(run_dir, exist_ok=True)
+  copy_params_file(run_dir)
+
+  start = region * args.segment_size
+  warmup = min(args.warmup, start)
+  region_args = "--use_fetched_count 1 --inst_limit {}".format(args.segment_size)
+  if start - warmup:
+    region_args += " --fast_forward 1 --fast_forward_trace_ins {}".format(start - warmup)
+  if warmup:
+    region_args += " --warmup {}".format(warmup)
+
+  cmd_str = "{scarab} --frontend sct --cbp_trace_r0 {sct} --bindir {bin_dir} {region_args} {common_args}".format(
+    scarab=args.scarab, sct=sct_path, bin_dir=scarab_paths.bin_dir, region_args=region_args, common_args=args.scarab_args)
+  return command.Command(cmd_str, name=name, run_dir=run_dir, results_dir=run_dir, stdout="scarab.out", stderr="scarab.err")
+
+def run_regions(simpoints, sct_path):
+  """
+  Keep up to --jobs simulations running. A failing region is reported and does
+  not stop the others.
+  """
+  pending = [region_command(cluster, region, sct_path) for cluster, region in sorted(simpoints.items())]
+  running = []
+  failed = []
+
+  while pending or running:
+    while pending and len(running) < args.jobs:
+      cmd = pending.pop(0)
+      print('Launching {}:\n{}\n'.format(cmd.name, cmd.cmd))
+      cmd.run_in_background()
+      running.append(cmd)
+
+    time.sleep(1)
+    for cmd in list(running):
+      cmd.poll()
+      if cmd.returncode is not None:
+        running.remove(cmd)
+        print("RETURN CODE {}: {}".format(cmd.returncode, cmd.name))
+        if cmd.returncode != 0:
+          failed.append(cmd.name)
+
+  return failed
+
+def write_weighted_stats(simpoints, weights):
+  """
+  Weighted mean of the stats of all regions, as scarab_batch does for the
+  checkpoints of a benchmark. Written to simdir/simpoints.stat.csv.
+  """
+  collection = scarab_stats.StatCollection("simpoints")
+  for cluster in sorted(simpoints):
+    run_dir = os.path.join(args.simdir, "cluster{}".format(cluster))
+    collection.append(scarab_stats.StatFrame("cluster{}".format(cluster), run_dir, weight=weights[cluster]))
+  stat_frame = collection.apply_weight(1.0).accumulate().normalize()
+
+  out_path = os.path.join(args.simdir, "simpoints.stat.csv")
+  stat_frame.stat_df.to_csv(out_path)
+  print("Weighted stats written to {}".format(out_path))
+
+def main():
+  simpoints = read_pairs(args.simpoints, int)
+  weights = read_pairs(args.weights, float)
+  if not simpoints:
+    print("Usage: the simpoints file {} has no regions".format(args.simpoints))
+    sys.exit(-1)
+  missing = [c for c in simpoints if c not in weights]
+  assert not missing, "Error: clusters {} have no weight in {}".format(missing, args.weights)
+
+  os.makedirs(args.simdir, exist_ok=True)
+  args.simdir = os.path.abspath(args.simdir)
+  sct_path = decode_trace()
+
+  failed = []
+  try:
+    failed = run_regions(simpoints, sct_path)
+  finally:
+    progress.notify("Scarab simpoints finished, {} of {} regions failed".format(len(failed), len(simpoints)))
+
+  if failed:
+    print("Error: failed regions: " + " ".join(failed))
+    sys.exit(1)
+  write_weighted_stats(simpoints, weights)
+
+if __name__ == "__main__":
+  main()
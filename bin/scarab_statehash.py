@@ -0,0 +1,86 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+"""
+Author: HPS Research Group
+Date: 10/15/2026
+Description: Compares the state_hash.out files of two runs written with
+--state_hash_interval and reports the first interval where they diverge and
+which sections (retired ops, retire timing, a cache, a branch predictor,
+queues or stats of a core) differ in it. Both runs must use the same
+interval. Exits with status 1 if the runs diverge.
+
+Examples:
+  python bin/scarab_statehash.py run_a/state_hash.out run_b/state_hash.out
+
+As a module, read_statehash() returns a list of (cycle, {section: hash}) per
+interval and first_divergence() compares two such lists.
+"""
+
+from __future__ import print_function
+import argparse
+import sys
+
+def read_statehash(filename):
+  intervals = []
+  with open(filename) as f:
+    for line in f:
+      if line.startswith("#"):
+        continue
+      interval, cycle, section, hash = line.split()
+      interval = int(interval)
+      while len(intervals) <= interval:
+        intervals.append((int(cycle), {}))
+      intervals[interval][1][section] = hash
+  return intervals
+
+# Returns (interval, cycle, sections) of the first interval that differs, or None.
+# Sections missing in one run count as different.
+def first_divergence(a, b):
+  for ii in range(min(len(a), len(b))):
+    (cycle_a, hashes_a), (_, hashes_b) = a[ii], b[ii]
+    sections = [s for s in hashes_a if hashes_b.get(s) != hashes_a[s]]
+    sections += [s for s in hashes_b if s not in hashes_a]
+    if sections:
+      return ii, cycle_a, sections
+  if len(a) != len(b):
+    ii = min(len(a), len(b))
+    return ii, (a if len(a) > ii else b)[ii][0], ["<end of run>"]
+  return None
+
+def main():
+  parser = argparse.ArgumentParser(description="Find where two Scarab runs diverge")
+  parser.add_argument("a", help="state_hash.out of the first run")
+  parser.add_argument("b", help="state_hash.out of the second run")
+  args = parser.parse_args()
+
+  divergence = first_divergence(read_statehash(args.a), read_statehash(args.b))
+  if not divergence:
+    print("Runs match")
+    return
+  interval, cycle, sections = divergence
+  print("Runs diverge in interval %d (ending at cycle %d of %s):" % (interval, cycle, args.a))
+  for section in sections:
+    print("  %s" % section)
+  sys.exit(1)
+
+if __name__ == "__main__":
+  main()
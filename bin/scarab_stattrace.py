@@ -0,0 +1,123 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Converts the stats.trace.bin file written with --stats_to_trace
+and --stat_trace_binary 1 to the tab-separated format of the text trace:
+one row per interval with the instruction count of core 0 and the interval
+count of every traced stat on every core. --cycles adds a Cycles column.
+
+Examples:
+  python bin/scarab_stattrace.py stats.trace.bin > stats.trace
+  python bin/scarab_stattrace.py stats.trace.bin --cycles --output stats.trace
+
+As a module, read_stattrace() returns the column names and the list of rows.
+"""
+
+from __future__ import print_function
+import argparse
+import struct
+import sys
+
+MAGIC = b"SCARSTR\0"
+VERSION = 1
+
+# Must match Stat_Type in src/statistics.h
+FLOAT_TYPE_STAT = 1
+
+def read_varint(data, pos):
+  result = 0
+  shift = 0
+  while True:
+    byte = data[pos]
+    pos += 1
+    result |= (byte & 0x7f) << shift
+    if byte < 0x80:
+      return result, pos
+    shift += 7
+
+def unzigzag(x):
+  return (x >> 1) ^ -(x & 1)
+
+def read_stattrace(filename):
+  with open(filename, "rb") as f:
+    data = bytearray(f.read())
+  if bytes(data[:8]) != MAGIC:
+    raise ValueError("%s is not a binary stat trace" % filename)
+  version, num_cores, num_stats = struct.unpack_from("=III", data, 8)
+  if version != VERSION:
+    raise ValueError("%s has version %d, expected %d" % (filename, version, VERSION))
+  pos = 20
+  stats = []
+  for _ in range(num_stats):
+    type, name_len = struct.unpack_from("=II", data, pos)
+    pos += 8
+    stats.append((bytes(data[pos:pos + name_len]).decode(), type))
+    pos += name_len
+
+  columns = ["Instructions", "Cycles"]
+  for name, _ in stats:
+    columns += ["%s[%d]" % (name, proc_id) for proc_id in range(num_cores)]
+
+  rows = []
+  inst = cycles = 0
+  last = [0] * (num_stats * num_cores)
+  while pos < len(data):
+    delta, pos = read_varint(data, pos)
+    inst += delta
+    delta, pos = read_varint(data, pos)
+    cycles += delta
+    row = [inst, cycles]
+    ii = 0
+    for _, type in stats:
+      for _ in range(num_cores):
+        x, pos = read_varint(data, pos)
+        if type == FLOAT_TYPE_STAT:
+          last[ii] ^= x
+          row.append(struct.unpack("=d", struct.pack("=Q", last[ii]))[0])
+        else:
+          last[ii] += unzigzag(x)
+          row.append(last[ii])
+        ii += 1
+    rows.append(row)
+  return columns, rows
+
+def main():
+  parser = argparse.ArgumentParser(description="Convert a binary Scarab stat trace to text")
+  parser.add_argument("trace", help="stats.trace.bin file")
+  parser.add_argument("--cycles", action="store_true", help="add the cycle count of every interval")
+  parser.add_argument("--output", help="output file (default: stdout)")
+  args = parser.parse_args()
+
+  columns, rows = read_stattrace(args.trace)
+  out = open(args.output, "w") if args.output else sys.stdout
+  keep = [ii for ii in range(len(columns)) if args.cycles or columns[ii] != "Cycles"]
+  print("\t".join(columns[ii] for ii in keep), file=out)
+  for row in rows:
+    print("\t".join(("%e" % row[ii]) if isinstance(row[ii], float) else str(row[ii]) for ii in keep), file=out)
+  if args.output:
+    out.close()
+
+if __name__ == "__main__":
+  main()
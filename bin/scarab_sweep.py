@@ -0,0 +1,164 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Runs a parameter sweep over one trace. The trace is decoded once
+into a .sct file (--mode trace_sct), and every configuration of the sweep then
+replays that file with --frontend sct. The .sct reader maps the file read-only,
+so all concurrent simulations share one copy of it in the page cache instead
+of each re-reading and re-decoding the original trace.
+
+Sweep file: one configuration per line, a name followed by the scarab
+arguments that override the PARAMS file for it, e.g.
+  rob_256   --node_table_size 256
+  rob_512   --node_table_size 512 --rs_sizes 128
+Blank lines and lines starting with '#' are ignored.
+"""
+
+from __future__ import print_function
+import argparse
+import multiprocessing
+import os
+import shutil
+import sys
+import time
+
+from scarab_globals import *
+
+parser = argparse.ArgumentParser(description="Run a Scarab parameter sweep over one shared, pre-decoded trace")
+parser.add_argument('sweep', help="Path to the sweep file (one '<name> <scarab args>' configuration per line).")
+parser.add_argument('--sct', default=None, help="Path to an existing .sct trace. Skips the decode step.")
+parser.add_argument('--trace_cache', nargs='?', const=trace_cache.default_cache_dir, default=None,
+                    help="Get the .sct from the trace cache daemon of this node (bin/scarab_trace_cache.py) instead of "
+                    "decoding it in simdir. Takes the cache directory, defaults to " + trace_cache.default_cache_dir + ".")
+parser.add_argument('--decode_args', default="", help="Scarab arguments selecting the trace to decode, e.g. "
+                    "\"--frontend memtrace --cbp_trace_r0 trace.zip --memtrace_modules_log bin\".")
+parser.add_argument('--params', default=None, help="Path to the PARAMS file shared by all configurations.")
+parser.add_argument('--scarab_args', default="", help="Arguments passed to every simulation.")
+parser.add_argument('--simdir', default=os.getcwd(), help="Directory for the .sct trace and one subdirectory per configuration.")
+parser.add_argument('--jobs', type=int, default=multiprocessing.cpu_count(), help="Simulations to run at once. Defaults to the number of host cores.")
+parser.add_argument('--scarab', default=scarab_paths.scarab_bin, help="Path to the scarab binary. Defaults to src/scarab.")
+
+args = parser.parse_args()
+
+def read_sweep(path):
+  configs = []
+  with open(path, 'r') as f:
+    for line in f:
+      line = line.strip()
+      if not line or line.startswith('#'):
+        continue
+      name, _, overrides = line.partition(' ')
+      assert name not in [c[0] for c in configs], "Error: configuration {} appears twice in {}".format(name, path)
+      configs.append((name, overrides.strip()))
+  return configs
+
+def copy_params_file(run_dir):
+  if args.params:
+    shutil.copy2(args.params, os.path.join(run_dir, "PARAMS.in"))
+
+def decode_trace():
+  """
+  Decode the trace once. The decode run writes decode.out in simdir.
+  """
+  if args.sct:
+    return os.path.abspath(args.sct)
+
+  if args.trace_cache:
+    try:
+      return trace_cache.request_sct(args.decode_args, args.params, args.trace_cache)
+    except RuntimeError as e:
+      print("Error: {}".format(e))
+      sys.exit(1)
+
+  sct_path = os.path.join(args.simdir, "trace.sct")
+  if os.path.exists(sct_path):
+    scarab_utils.warn("Reusing existing decoded trace {}".format(sct_path))
+    return sct_path
+
+  copy_params_file(args.simdir)
+  cmd_str = "{scarab} --mode trace_sct --sct_output {sct} {decode_args}".format(
+    scarab=args.scarab, sct=sct_path, decode_args=args.decode_args)
+  print('\nDecoding trace:\n' + cmd_str + '\n')
+  cmd = command.Command(cmd_str, run_dir=args.simdir, results_dir=args.simdir, stdout="decode.out", stderr="decode.out")
+  if cmd.run() != 0 or not os.path.exists(sct_path):
+    print("Error: decoding the trace failed, see {}".format(os.path.join(args.simdir, "decode.out")))
+    sys.exit(1)
+  return sct_path
+
+def sim_command(name, overrides, sct_path):
+  run_dir = os.path.join(args.simdir, name)
+  os.makedirs(run_dir, exist_ok=True)
+  copy_params_file(run_dir)
+  cmd_str = "{scarab} --frontend sct --cbp_trace_r0 {sct} --bindir {bin_dir} {common_args} {overrides}".format(
+    scarab=args.scarab, sct=sct_path, bin_dir=scarab_paths.bin_dir, common_args=args.scarab_args, overrides=overrides)
+  return command.Command(cmd_str, name=name, run_dir=run_dir, results_dir=run_dir, stdout="scarab.out", stderr="scarab.err")
+
+def run_sweep(configs, sct_path):
+  """
+  Keep up to --jobs simulations running. A failing configuration is reported
+  and does not stop the others.
+  """
+  pending = [sim_command(name, overrides, sct_path) for name, overrides in configs]
+  running = []
+  failed = []
+
+  while pending or running:
+    while pending and len(running) < args.jobs:
+      cmd = pending.pop(0)
+      print('Launching {}:\n{}\n'.format(cmd.name, cmd.cmd))
+      cmd.run_in_background()
+      running.append(cmd)
+
+    time.sleep(1)
+    for cmd in list(running):
+      cmd.poll()
+      if cmd.returncode is not None:
+        running.remove(cmd)
+        print("RETURN CODE {}: {}".format(cmd.returncode, cmd.name))
+        if cmd.returncode != 0:
+          failed.append(cmd.name)
+
+  return failed
+
+def main():
+  configs = read_sweep(args.sweep)
+  if not configs:
+    print("Usage: the sweep file {} has no configurations".format(args.sweep))
+    sys.exit(-1)
+
+  os.makedirs(args.simdir, exist_ok=True)
+  args.simdir = os.path.abspath(args.simdir)
+  sct_path = decode_trace()
+
+  failed = []
+  try:
+    failed = run_sweep(configs, sct_path)
+  finally:
+    progress.notify("Scarab sweep finished, {} of {} configurations failed".format(len(failed), len(configs)))
+
+  if failed:
+    print("Error: failed configurations: " + " ".join(failed))
+  sys.exit(1 if failed else 0)
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,91 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Converts the per-interval top-down files written with
+--topdown_interval N (<topdown_file>.<proc_id>.bin) to CSV, one row per
+interval. The categories are fractions of the issue slots of the interval,
+as the TOPDOWN_*_BOUND stats are for the whole run.
+
+Examples:
+  python bin/scarab_topdown.py topdown.0.bin
+  python bin/scarab_topdown.py topdown.0.bin --csv topdown.0.csv
+"""
+
+from __future__ import print_function
+import argparse
+import struct
+import sys
+
+MAGIC = b"SCARTDN\0"
+VERSION = 1
+SCALE = 10000.0
+
+# Must match Topdown_Record in src/topdown.c; categories in core.stat.def order
+CATEGORIES = ["frontend_bound", "backend_bound", "bad_spec_bound", "retiring_bound", "fetch_latency_bound",
+              "fetch_bandwidth_bound", "mem_bound", "core_bound", "br_mispredicts_bound", "machine_clears_bound"]
+HEADER = struct.Struct("=4I")
+
+def read_records(path):
+  with open(path, 'rb') as f:
+    data = f.read()
+  if data[:8] != MAGIC:
+    raise ValueError("{} is not a scarab top-down interval file".format(path))
+  version, proc_id, issue_width, num_categories = HEADER.unpack_from(data, 8)
+  if version != VERSION or num_categories != len(CATEGORIES):
+    raise ValueError("{}: unsupported version {} / {} categories".format(path, version, num_categories))
+
+  record = struct.Struct("=3Q{}i".format(num_categories))
+  records = []
+  start = 8 + HEADER.size
+  for pos in range(start, len(data) - record.size + 1, record.size):
+    fields = record.unpack_from(data, pos)
+    rec = {"cycle": fields[0], "insts": fields[1], "slots": fields[2]}
+    rec.update(zip(CATEGORIES, (v / SCALE for v in fields[3:])))
+    records.append(rec)
+  return proc_id, issue_width, records
+
+def write_csv(out, records):
+  cols = ["cycle", "insts", "slots"] + CATEGORIES
+  out.write(",".join(cols) + "\n")
+  for rec in records:
+    out.write(",".join(str(rec[c]) if c in ("cycle", "insts", "slots") else "{:.4f}".format(rec[c]) for c in cols))
+    out.write("\n")
+
+def main():
+  parser = argparse.ArgumentParser(description="Convert Scarab per-interval top-down files to CSV")
+  parser.add_argument('file', help="Path to a <topdown_file>.<proc_id>.bin file.")
+  parser.add_argument('--csv', default=None, help="Write the CSV to this file instead of stdout.")
+  args = parser.parse_args()
+
+  proc_id, issue_width, records = read_records(args.file)
+  print("{}: core {}, issue width {}, {} intervals".format(args.file, proc_id, issue_width, len(records)),
+        file=sys.stderr)
+  if args.csv:
+    with open(args.csv, 'w') as f:
+      write_csv(f, records)
+  else:
+    write_csv(sys.stdout, records)
+
+if __name__ == "__main__":
+  main()
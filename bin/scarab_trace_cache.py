@@ -0,0 +1,202 @@
+#  Copyright 2020 HPS/SAFARI Research Groups
+#
+#  Permission is hereby granted, free of charge, to any person obtaining a copy of
+#  this software and associated documentation files (the "Software"), to deal in
+#  the Software without restriction, including without limitation the rights to
+#  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+#  of the Software, and to permit persons to whom the Software is furnished to do
+#  so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+"""
+Author: HPS Research Group
+Date: 10/14/2026
+Description: Node-local trace cache daemon. Concurrent simulations on one host
+often replay the same memtrace or PT trace, and each of them would decompress
+and decode it on its own. The daemon decodes each trace once into a .sct file
+(--mode trace_sct) in a shared-memory directory, by default
+/dev/shm/scarab_trace_cache, and hands its path to every simulation that asks
+for it. The sct frontend maps the file read-only, so all of them share the same
+pages.
+
+Start one daemon per node:
+  scarab_trace_cache.py serve [--cache_dir DIR] [--max_gb N] [--jobs N]
+and get the .sct of a trace (scarab_sweep.py --trace_cache does this):
+  scarab_trace_cache.py get --decode_args "--frontend memtrace --cbp_trace_r0 trace.zip ..."
+
+Requests are one JSON line on <cache_dir>/server.sock,
+  {"decode_args": [...], "params": "/abs/PARAMS.in"}
+answered by {"sct": path} or {"error": message}. Entries over --max_gb are evicted
+least recently requested first. Evicting is safe while simulations still use an
+entry: the file is only unlinked, and their mappings keep the pages.
+"""
+
+from __future__ import print_function
+import argparse
+import json
+import os
+import shlex
+import shutil
+import socketserver
+import sys
+import threading
+import time
+
+from scarab_globals import *
+
+parser = argparse.ArgumentParser(description="Node-local cache of pre-decoded Scarab traces")
+subparsers = parser.add_subparsers(dest='command')
+serve_parser = subparsers.add_parser('serve', help="Run the daemon.")
+serve_parser.add_argument('--cache_dir', default=trace_cache.default_cache_dir, help="Shared-memory directory of the cache.")
+serve_parser.add_argument('--max_gb', type=float, default=0, help="Evict entries beyond this many GB. 0 never evicts.")
+serve_parser.add_argument('--jobs', type=int, default=2, help="Traces decoded at once.")
+serve_parser.add_argument('--scarab', default=scarab_paths.scarab_bin, help="Path to the scarab binary. Defaults to src/scarab.")
+get_parser = subparsers.add_parser('get', help="Print the path of the shared .sct of a trace.")
+get_parser.add_argument('--cache_dir', default=trace_cache.default_cache_dir, help="Shared-memory directory of the cache.")
+get_parser.add_argument('--decode_args', required=True, help="Scarab arguments selecting the trace to decode.")
+get_parser.add_argument('--params', default=None, help="PARAMS file of the decode run.")
+
+class Entry:
+  def __init__(self, key):
+    self.key = key
+    self.done = threading.Event()
+    self.sct = None
+    self.error = None
+    self.size = 0
+    self.last_use = time.time()
+
+class TraceCache:
+  """
+  One Entry per trace key. The first request for a key decodes it; the others
+  wait on its done event.
+  """
+  def __init__(self, args):
+    self.args = args
+    self.lock = threading.Lock()
+    self.entries = {}
+    self.decode_slots = threading.Semaphore(args.jobs)
+    self.load_existing()
+
+  def load_existing(self):
+    """
+    Keep the traces a previous daemon decoded. A file only gets its final name
+    once its decode finished.
+    """
+    for name in os.listdir(self.args.cache_dir):
+      if name.endswith(".sct"):
+        entry = Entry(name[:-4])
+        entry.sct = os.path.join(self.args.cache_dir, name)
+        entry.size = os.path.getsize(entry.sct)
+        entry.done.set()
+        self.entries[entry.key] = entry
+
+  def get(self, decode_args, params):
+    params_text = ""
+    if params:
+      with open(params, 'r') as f:
+        params_text = f.read()
+    key = trace_cache.trace_key(self.args.scarab, decode_args, params_text)
+
+    with self.lock:
+      entry = self.entries.get(key)
+      owner = entry is None or (entry.done.is_set() and entry.sct is None)
+      if owner:
+        entry = Entry(key)
+        self.entries[key] = entry
+      entry.last_use = time.time()
+
+    if owner:
+      with self.decode_slots:
+        self.decode(entry, decode_args, params)
+      entry.done.set()
+      self.evict()
+    entry.done.wait()
+    return entry
+
+  def decode(self, entry, decode_args, params):
+    work_dir = os.path.join(self.args.cache_dir, entry.key + ".work")
+    os.makedirs(work_dir, exist_ok=True)
+    if params:
+      shutil.copy2(params, os.path.join(work_dir, "PARAMS.in"))
+    tmp_path = os.path.join(work_dir, "trace.sct")
+    cmd_str = "{scarab} --mode trace_sct --sct_output {sct} {decode_args}".format(
+      scarab=self.args.scarab, sct=tmp_path, decode_args=" ".join(shlex.quote(t) for t in decode_args))
+    print("Decoding {}:\n{}\n".format(entry.key, cmd_str))
+    sys.stdout.flush()
+    cmd = command.Command(cmd_str, run_dir=work_dir, results_dir=work_dir, stdout="decode.out", stderr="decode.out")
+    if cmd.run() != 0 or not os.path.exists(tmp_path):
+      entry.error = "decoding failed, see {}".format(os.path.join(work_dir, "decode.out"))
+      return
+    sct_path = os.path.join(self.args.cache_dir, entry.key + ".sct")
+    os.rename(tmp_path, sct_path)
+    shutil.rmtree(work_dir, ignore_errors=True)
+    entry.size = os.path.getsize(sct_path)
+    entry.sct = sct_path
+
+  def evict(self):
+    if not self.args.max_gb:
+      return
+    limit = self.args.max_gb * (1 << 30)
+    with self.lock:
+      ready = sorted([e for e in self.entries.values() if e.done.is_set() and e.sct], key=lambda e: e.last_use)
+      total = sum(e.size for e in ready)
+      for entry in ready[:-1]:
+        if total <= limit:
+          break
+        print("Evicting {}".format(entry.key))
+        os.unlink(entry.sct)
+        total -= entry.size
+        del self.entries[entry.key]
+
+class RequestHandler(socketserver.StreamRequestHandler):
+  def handle(self):
+    try:
+      request = json.loads(self.rfile.readline())
+      entry = self.server.cache.get(request["decode_args"], request.get("params"))
+      reply = {"sct": entry.sct} if entry.sct else {"error": entry.error}
+    except Exception as e:
+      reply = {"error": str(e)}
+    self.wfile.write((json.dumps(reply) + "\n").encode())
+
+class Server(socketserver.ThreadingMixIn, socketserver.UnixStreamServer):
+  daemon_threads = True
+
+def serve(args):
+  os.makedirs(args.cache_dir, exist_ok=True)
+  sock_path = trace_cache.socket_path(args.cache_dir)
+  if os.path.exists(sock_path):
+    os.unlink(sock_path)
+  server = Server(sock_path, RequestHandler)
+  server.cache = TraceCache(args)
+  progress.notify("Trace cache serving {} from {}".format(sock_path, args.cache_dir))
+  try:
+    server.serve_forever()
+  finally:
+    os.unlink(sock_path)
+
+def main():
+  args = parser.parse_args()
+  if args.command == 'serve':
+    serve(args)
+  elif args.command == 'get':
+    try:
+      print(trace_cache.request_sct(args.decode_args, args.params, args.cache_dir))
+    except RuntimeError as e:
+      print("Error: {}".format(e))
+      sys.exit(1)
+  else:
+    parser.print_help()
+    sys.exit(-1)
+
+if __name__ == "__main__":
+  main()
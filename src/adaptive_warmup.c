@@ -0,0 +1,184 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : adaptive_warmup.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Ends warmup once the warmed structures have converged
+ ***************************************************************************************/
+
+#include "adaptive_warmup.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "general.param.h"
+
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Every ADAPTIVE_WARMUP_INTERVAL instructions of core 0, warmup compares each
+   signal's miss rate over the interval with the one of the previous interval, and
+   the fraction of the lines of the icaches, dcaches and L1 that are valid with its
+   value at the previous check.  An interval is stable when none of them moved by
+   more than ADAPTIVE_WARMUP_TOLERANCE.  Signals with no events in the interval
+   count as stable.  WARMUP stays the limit. */
+
+#define NUM_WARMUP_LINE_SIGNALS (WARMUP_SIGNAL_L1 + 1)
+#define NUM_WARMUP_CHECKS (NUM_WARMUP_SIGNALS + NUM_WARMUP_LINE_SIGNALS)
+
+typedef struct Warmup_Cache_struct {
+  Warmup_Signal signal;
+  Cache* cache;
+} Warmup_Cache;
+
+Warmup_Counts warmup_counts[MAX_NUM_PROCS];
+
+static Warmup_Cache* watched;
+static uns num_watched;
+static Counter last_check; /* inst_count of core 0 at the last check */
+static uns stable_intervals;
+static Flag converged;
+static Flag checked;
+static Counter last_events[NUM_WARMUP_SIGNALS];
+static Counter last_misses[NUM_WARMUP_SIGNALS];
+static double last_value[NUM_WARMUP_CHECKS];
+static Flag has_value[NUM_WARMUP_CHECKS];
+static Flag unstable[NUM_WARMUP_CHECKS];
+
+static const char* const check_names[NUM_WARMUP_CHECKS] = {
+    "icache miss rate", "dcache miss rate", "L1 miss rate", "mispredict rate", "misfetch rate",
+    "icache lines",     "dcache lines",     "L1 lines",
+};
+
+/**************************************************************************************/
+/* adaptive_warmup_watch_cache: */
+
+void adaptive_warmup_watch_cache(Warmup_Signal signal, Cache* cache) {
+  ASSERT(0, signal < NUM_WARMUP_LINE_SIGNALS);
+  for (uns ii = 0; ii < num_watched; ii++) {
+    if (watched[ii].cache == cache)
+      return;
+  }
+  watched = (Warmup_Cache*)realloc(watched, sizeof(Warmup_Cache) * (num_watched + 1));
+  watched[num_watched].signal = signal;
+  watched[num_watched].cache = cache;
+  num_watched++;
+}
+
+/**************************************************************************************/
+/* adaptive_warmup_check: one check's new value; TRUE if it is stable */
+
+static Flag adaptive_warmup_check(uns check, Flag valid, double value) {
+  Flag stable;
+
+  if (!valid)
+    return TRUE;
+  stable = has_value[check] && fabs(value - last_value[check]) <= ADAPTIVE_WARMUP_TOLERANCE;
+  last_value[check] = value;
+  has_value[check] = TRUE;
+  return stable;
+}
+
+/**************************************************************************************/
+/* adaptive_warmup_next_end: */
+
+Counter adaptive_warmup_next_end(void) {
+  if (!ADAPTIVE_WARMUP_INTERVAL)
+    return WARMUP;
+  return MIN2(WARMUP, last_check + ADAPTIVE_WARMUP_INTERVAL);
+}
+
+/**************************************************************************************/
+/* adaptive_warmup_converged: */
+
+Flag adaptive_warmup_converged(void) {
+  Counter lines[NUM_WARMUP_LINE_SIGNALS] = {0};
+  Counter valid_lines[NUM_WARMUP_LINE_SIGNALS] = {0};
+  Flag stable = TRUE;
+
+  if (!ADAPTIVE_WARMUP_INTERVAL || inst_count[0] - last_check < ADAPTIVE_WARMUP_INTERVAL)
+    return converged;
+  last_check = inst_count[0];
+  checked = TRUE;
+
+  for (uns signal = 0; signal < NUM_WARMUP_SIGNALS; signal++) {
+    Counter events = 0;
+    Counter misses = 0;
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      events += warmup_counts[proc_id].events[signal];
+      misses += warmup_counts[proc_id].misses[signal];
+    }
+    Counter interval_events = events - last_events[signal];
+    Counter interval_misses = misses - last_misses[signal];
+    unstable[signal] = !adaptive_warmup_check(signal, interval_events > 0,
+                                              interval_events ? (double)interval_misses / interval_events : 0.0);
+    stable &= !unstable[signal];
+    last_events[signal] = events;
+    last_misses[signal] = misses;
+  }
+
+  for (uns ii = 0; ii < num_watched; ii++) {
+    Cache* cache = watched[ii].cache;
+    for (uns set = 0; set < cache->num_sets; set++) {
+      for (uns way = 0; way < cache->assoc; way++)
+        valid_lines[watched[ii].signal] += cache->entries[set][way].valid;
+    }
+    lines[watched[ii].signal] += cache->num_lines;
+  }
+  for (uns signal = 0; signal < NUM_WARMUP_LINE_SIGNALS; signal++) {
+    uns check = NUM_WARMUP_SIGNALS + signal;
+    unstable[check] = !adaptive_warmup_check(check, lines[signal] > 0, (double)valid_lines[signal] / lines[signal]);
+    stable &= !unstable[check];
+  }
+
+  stable_intervals = stable ? stable_intervals + 1 : 0;
+  converged = stable_intervals >= ADAPTIVE_WARMUP_STABLE_INTERVALS;
+  return converged;
+}
+
+/**************************************************************************************/
+/* adaptive_warmup_end: */
+
+void adaptive_warmup_end(void) {
+  INC_STAT_EVENT(0, NORESET_WARMUP_INSTS, inst_count[0]);
+  if (converged) {
+    STAT_EVENT(0, NORESET_WARMUP_END_CONVERGED);
+    fprintf(mystdout, "** Adaptive warmup converged after %llu instructions\n", inst_count[0]);
+    return;
+  }
+
+  STAT_EVENT(0, NORESET_WARMUP_END_LIMIT);
+  fprintf(mystdout, "** Adaptive warmup reached WARMUP (%llu instructions), still changing:", inst_count[0]);
+  for (uns check = 0; check < NUM_WARMUP_CHECKS; check++) {
+    if (unstable[check] || !checked) {
+      STAT_EVENT(0, NORESET_WARMUP_UNSTABLE_ICACHE_MISS + check);
+      fprintf(mystdout, " %s", check_names[check]);
+    }
+  }
+  fprintf(mystdout, "\n");
+}
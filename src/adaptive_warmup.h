@@ -0,0 +1,86 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : adaptive_warmup.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Ends warmup once the warmed structures have converged
+ ***************************************************************************************/
+
+#ifndef __ADAPTIVE_WARMUP_H__
+#define __ADAPTIVE_WARMUP_H__
+
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+#include "libs/cache_lib.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* the events warmup counts; each has a miss rate per interval */
+typedef enum Warmup_Signal_enum {
+  WARMUP_SIGNAL_ICACHE,
+  WARMUP_SIGNAL_DCACHE,
+  WARMUP_SIGNAL_L1,
+  WARMUP_SIGNAL_MISPRED,  /* mispredicted branches, where TAGE allocates */
+  WARMUP_SIGNAL_MISFETCH, /* branches with an unknown target, where the BTB allocates */
+  NUM_WARMUP_SIGNALS
+} Warmup_Signal;
+
+/* one cache line per core, so that parallel warmup threads do not share them */
+typedef struct Warmup_Counts_struct {
+  Counter events[NUM_WARMUP_SIGNALS];
+  Counter misses[NUM_WARMUP_SIGNALS];
+} __attribute__((aligned(64))) Warmup_Counts;
+
+/**************************************************************************************/
+/* External variables */
+
+extern Warmup_Counts warmup_counts[MAX_NUM_PROCS];
+
+/**************************************************************************************/
+/* Prototypes */
+
+static inline void adaptive_warmup_event(uns proc_id, Warmup_Signal signal, Flag miss) {
+  warmup_counts[proc_id].events[signal]++;
+  warmup_counts[proc_id].misses[signal] += miss;
+}
+
+/* adds a cache to the footprint of its signal (ICACHE, DCACHE or L1) */
+void adaptive_warmup_watch_cache(Warmup_Signal signal, Cache* cache);
+
+/* the instruction count of core 0 at which warmup can end next, so that the warmup
+   batches of the frontend do not read past it */
+Counter adaptive_warmup_next_end(void);
+
+/* called between warmup rounds: TRUE once every signal has been stable for
+   ADAPTIVE_WARMUP_STABLE_INTERVALS intervals of core 0 */
+Flag adaptive_warmup_converged(void);
+
+/* records why warmup ended in the stats */
+void adaptive_warmup_end(void);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __ADAPTIVE_WARMUP_H__ */
@@ -60,11 +60,11 @@ Addr addr_translate(Addr virt_addr) {
    * (i.e., all 0s or all 1s). */
   uns num_page_offset_bits = LOG2(VA_PAGE_SIZE_BYTES);
   Addr page_index = virt_addr >> num_page_offset_bits;
-  // we already use the 6 highest bits to store the proc_id.
+  // we already use the CMP_ADDR_PROC_ID_BITS highest bits to store the proc_id.
   // NUM_ADDR_NON_SIGN_EXTEND_BITS tells us how many bits we actually need to
   // keep, and the bits that are left are used to store the original bits after
   // scrambling
-  uns num_bits_to_scramble = 58 - NUM_ADDR_NON_SIGN_EXTEND_BITS;
+  uns num_bits_to_scramble = CMP_ADDR_PROC_ID_SHIFT - NUM_ADDR_NON_SIGN_EXTEND_BITS;
   uns32 orig_bits = page_index & N_BIT_MASK(num_bits_to_scramble);
   Addr hash_source;
 
@@ -37,12 +37,14 @@
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/pc_prof.h"
 
 #include "bp/bp.param.h"
 #include "core.param.h"
 #include "prefetcher/pref.param.h"
 
 #include "bp//bp_conf.h"
+#include "bp/bp_shadow.h"
 #include "bp/bp_targ_mech.h"
 #include "bp/cbp_to_scarab.h"
 #include "bp/gshare.h"
@@ -62,6 +64,7 @@
 #include "statistics.h"
 #include "thread.h"
 #include "uop_cache.h"
+#include "warm_state.h"
 
 /******************************************************************************/
 /* include the table of possible branch predictors */
@@ -82,8 +85,8 @@ extern void tc_do_stat(Op*, Flag);
 /******************************************************************************/
 /* Global Variables */
 
-Bp_Recovery_Info* bp_recovery_info = NULL;
-Bp_Data* g_bp_data = NULL;
+CORE_LOCAL Bp_Recovery_Info* bp_recovery_info = NULL;
+CORE_LOCAL Bp_Data* g_bp_data = NULL;
 Flag USE_LATE_BP = FALSE;
 extern List op_buf;
 extern uns operating_mode;
@@ -134,11 +137,11 @@ void bp_sched_recovery(Bp_Recovery_Info* bp_recovery_info, Op* op, Counter cycle
   ASSERT(op->proc_id, bp_recovery_info->proc_id == op->proc_id);
   ASSERT(0, !op->off_path);
   if (op->oracle_info.recover_at_exec) {
-    INC_STAT_EVENT(0, SCHEDULED_EXEC_LAT, cycle_count - op->recovery_info.predict_cycle);
-    STAT_EVENT(0, SCHEDULED_EXEC_RECOVERIES);
+    INC_STAT_EVENT(op->proc_id, SCHEDULED_EXEC_LAT, cycle_count - op->recovery_info.predict_cycle);
+    STAT_EVENT(op->proc_id, SCHEDULED_EXEC_RECOVERIES);
   } else if (op->oracle_info.recover_at_decode) {
-    INC_STAT_EVENT(0, SCHEDULED_DECODE_LAT, cycle_count - op->recovery_info.predict_cycle);
-    STAT_EVENT(0, SCHEDULED_DECODE_RECOVERIES);
+    INC_STAT_EVENT(op->proc_id, SCHEDULED_DECODE_LAT, cycle_count - op->recovery_info.predict_cycle);
+    STAT_EVENT(op->proc_id, SCHEDULED_DECODE_RECOVERIES);
   }
 
   if (bp_recovery_info->recovery_cycle == MAX_CTR || op->op_num <= bp_recovery_info->recovery_op_num) {
@@ -263,10 +266,14 @@ void init_bp_data(uns8 proc_id, Bp_Data* bp_data) {
   } else {
     bp_data->late_bp = NULL;
   }
+  bp_shadow_init(bp_data);
 
   /* init btb structure */
   bp_data->bp_btb = &bp_btb_table[BTB_MECH];
   bp_data->bp_btb->init_func(bp_data);
+  bp_data->btb_ready_cycle = 0;
+  if (BTB_PREFETCH)
+    bp_btb_prefetch_init(bp_data);
 
   /* init call-return stack */
   bp_data->crs.entries = (Crs_Entry*)malloc(sizeof(Crs_Entry) * CRS_ENTRIES * 2);
@@ -341,6 +348,7 @@ Addr bp_predict_op(Bp_Data* bp_data, Op* op, uns br_num, Addr fetch_addr) {
   if (USE_LATE_BP) {
     bp_data->late_bp->timestamp_func(op);
   }
+  bp_shadow_timestamp(op);
 
   if (BP_HASH_TOS || IBTB_HASH_TOS) {
     Addr tos_addr;
@@ -383,6 +391,7 @@ Addr bp_predict_op(Bp_Data* bp_data, Op* op, uns br_num, Addr fetch_addr) {
     if (USE_LATE_BP) {
       bp_data->late_bp->spec_update_func(op);
     }
+    bp_shadow_spec_update(op);
     return op->oracle_info.npc;
   } else
     ASSERT(0, !(op->table_info->bar_type & BAR_FETCH));
@@ -485,6 +494,7 @@ Addr bp_predict_op(Bp_Data* bp_data, Op* op, uns br_num, Addr fetch_addr) {
           op->oracle_info.late_pred = bp_data->late_bp->pred_func(op);
         }
       }
+      bp_shadow_pred(op);
       // Update history used by the rest of Scarab.
       bp_data->global_hist = (bp_data->global_hist >> 1) | (op->oracle_info.pred << 31);
 
@@ -787,6 +797,7 @@ Addr bp_predict_op(Bp_Data* bp_data, Op* op, uns br_num, Addr fetch_addr) {
   if (USE_LATE_BP) {
     bp_data->late_bp->spec_update_func(op);
   }
+  bp_shadow_spec_update(op);
 
   DEBUG(bp_data->proc_id,
         "BP:  op_num:%s  off_path:%d  cf_type:%s  addr:%s  p_npc:%s  "
@@ -891,6 +902,9 @@ void bp_target_known_op(Bp_Data* bp_data, Op* op) {
   ASSERT(bp_data->proc_id, bp_data->proc_id == op->proc_id);
   ASSERT(bp_data->proc_id, op->table_info->cf_type);
 
+  if (BTB_PREFETCH && op->oracle_info.dir == TAKEN)
+    bp_btb_prefetch_record(bp_data, op);
+
   // if it was a btb miss, it is time to write it into the btb
   if (op->oracle_info.btb_miss && op->oracle_info.dir == TAKEN) {
     bp_data->bp_btb->update_func(bp_data, op);
@@ -899,7 +913,9 @@ void bp_target_known_op(Bp_Data* bp_data, Op* op) {
     // or For indirects we want to update the BTB if the target changes, even on btb hit
     // The detection relies on the target stored in the btb
     Addr line_addr;
-    Addr* btb_entry = (Addr*)cache_access(&bp_data->btb, op->oracle_info.pred_addr, &line_addr, FALSE);
+    Addr* btb_entry = BTB_MECH == BLOCK_BTB ? bp_btb_block_peek(bp_data, op)
+                                            : (Addr*)cache_access(&bp_data->btb, op->oracle_info.pred_addr,
+                                                                  &line_addr, FALSE);
     // The following assertion can fail (due to eviction?)
     // ASSERT(bp_data->proc_id, btb_entry);
     if (btb_entry && *btb_entry != op->oracle_info.target) {
@@ -934,6 +950,9 @@ void bp_resolve_op(Bp_Data* bp_data, Op* op) {
   if (USE_LATE_BP) {
     bp_data->late_bp->update_func(op);
   }
+  bp_shadow_update(op);
+  if (PC_PROF && !op->off_path)
+    pc_prof_branch(op->proc_id, op->inst_info->addr, op->oracle_info.mispred, op->oracle_info.misfetch);
 
   if (ENABLE_BP_CONF && IS_CONF_CF(op)) {
     bp_data->br_conf->update_func(op);
@@ -952,6 +971,7 @@ void bp_retire_op(Bp_Data* bp_data, Op* op) {
   if (USE_LATE_BP) {
     bp_data->late_bp->retire_func(op);
   }
+  bp_shadow_retire(op);
 }
 
 /******************************************************************************/
@@ -981,6 +1001,7 @@ void bp_recover_op(Bp_Data* bp_data, Cf_Type cf_type, Recovery_Info* info) {
   if (USE_LATE_BP) {
     bp_data->late_bp->recover_func(info);
   }
+  bp_shadow_recover(info);
 
   /* always recover the call return stack */
   CRS_REALISTIC ? bp_crs_realistic_recover(bp_data, info) : bp_crs_recover(bp_data);
@@ -991,3 +1012,126 @@ void bp_recover_op(Bp_Data* bp_data, Cf_Type cf_type, Recovery_Info* info) {
   if (FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE)
     increment_branch_mispredictions(info->PC);
 }
+
+/******************************************************************************/
+/* Warm state: the direction predictors (through their save_func and
+ * load_func), the BTB, the indirect target predictor, and the global and
+ * target history with the call-return stack.
+ */
+
+typedef struct Bp_Warm_Hist_struct {
+  uns32 global_hist;
+  uns32 targ_hist;
+  uns32 targ_index;
+  uns crs_depth;
+  uns crs_head;
+  uns crs_tail;
+  uns crs_tail_save;
+  uns crs_depth_save;
+  uns crs_tos;
+  uns crs_next;
+} Bp_Warm_Hist;
+
+static void bp_save_warm_predictor(Bp_Data* bp_data, Bp* bp) {
+  ASSERTM(bp_data->proc_id, bp->save_func, "Branch predictor %s cannot save its warm state\n", bp->name);
+  warm_state_begin("bp%u.%s", bp_data->proc_id, bp->name);
+  bp->save_func(bp_data->proc_id);
+  warm_state_end();
+}
+
+static void bp_load_warm_predictor(Bp_Data* bp_data, Bp* bp) {
+  uns64 size;
+  const void* data = warm_state_find(&size, "bp%u.%s", bp_data->proc_id, bp->name);
+
+  ASSERTM(bp_data->proc_id, bp->load_func, "Branch predictor %s cannot load a warm state\n", bp->name);
+  if (!data)
+    FATAL_ERROR(bp_data->proc_id, "Warm state file has no state for branch predictor %s\n", bp->name);
+  if (!bp->load_func(bp_data->proc_id, data, size))
+    FATAL_ERROR(bp_data->proc_id, "Warm state of branch predictor %s does not match its configuration\n", bp->name);
+}
+
+/* when both predictors are the same mechanism they share one table */
+static Flag bp_late_bp_has_own_state(Bp_Data* bp_data) {
+  return bp_data->late_bp && bp_data->late_bp->save_func != bp_data->bp->save_func;
+}
+
+void bp_save_warm_state(Bp_Data* bp_data) {
+  uns proc_id = bp_data->proc_id;
+  Bp_Warm_Hist hist;
+
+  bp_save_warm_predictor(bp_data, bp_data->bp);
+  if (bp_late_bp_has_own_state(bp_data))
+    bp_save_warm_predictor(bp_data, bp_data->late_bp);
+
+  warm_state_save_cache(&bp_data->btb, "bp%u.btb", proc_id);
+  if (IBTB_MECH == TC_TAGGED_IBTB || IBTB_MECH == TC_HYBRID_IBTB)
+    warm_state_save_cache(&bp_data->tc_tagged, "bp%u.tc_tagged", proc_id);
+  if (IBTB_MECH == TC_TAGLESS_IBTB || IBTB_MECH == TC_HYBRID_IBTB) {
+    warm_state_begin("bp%u.tc_tagless", proc_id);
+    warm_state_write(bp_data->tc_tagless, sizeof(Addr) * (0x1 << IBTB_HIST_LENGTH));
+    if (IBTB_MECH == TC_HYBRID_IBTB)
+      warm_state_write(bp_data->tc_selector, sizeof(uns8) * (0x1 << IBTB_HIST_LENGTH));
+    warm_state_end();
+  }
+
+  memset(&hist, 0, sizeof(hist));
+  hist.global_hist = bp_data->global_hist;
+  hist.targ_hist = bp_data->targ_hist;
+  hist.targ_index = bp_data->targ_index;
+  hist.crs_depth = bp_data->crs.depth;
+  hist.crs_head = bp_data->crs.head;
+  hist.crs_tail = bp_data->crs.tail;
+  hist.crs_tail_save = bp_data->crs.tail_save;
+  hist.crs_depth_save = bp_data->crs.depth_save;
+  hist.crs_tos = bp_data->crs.tos;
+  hist.crs_next = bp_data->crs.next;
+  warm_state_begin("bp%u.hist", proc_id);
+  warm_state_write(&hist, sizeof(hist));
+  warm_state_write(bp_data->crs.entries, sizeof(Crs_Entry) * CRS_ENTRIES * 2);
+  warm_state_write(bp_data->crs.off_path, sizeof(Flag) * CRS_ENTRIES);
+  warm_state_end();
+}
+
+void bp_load_warm_state(Bp_Data* bp_data) {
+  uns proc_id = bp_data->proc_id;
+  uns64 tagless_size = sizeof(Addr) * (0x1 << IBTB_HIST_LENGTH);
+  uns64 crs_size = sizeof(Crs_Entry) * CRS_ENTRIES * 2;
+  const uns8* data;
+  Bp_Warm_Hist hist;
+  uns64 size;
+
+  bp_load_warm_predictor(bp_data, bp_data->bp);
+  if (bp_late_bp_has_own_state(bp_data))
+    bp_load_warm_predictor(bp_data, bp_data->late_bp);
+
+  warm_state_load_cache(&bp_data->btb, "bp%u.btb", proc_id);
+  bp_data->btb_block_valid = FALSE;
+  if (IBTB_MECH == TC_TAGGED_IBTB || IBTB_MECH == TC_HYBRID_IBTB)
+    warm_state_load_cache(&bp_data->tc_tagged, "bp%u.tc_tagged", proc_id);
+  if (IBTB_MECH == TC_TAGLESS_IBTB || IBTB_MECH == TC_HYBRID_IBTB) {
+    uns64 selector_size = IBTB_MECH == TC_HYBRID_IBTB ? sizeof(uns8) * (0x1 << IBTB_HIST_LENGTH) : 0;
+    data = (const uns8*)warm_state_find(&size, "bp%u.tc_tagless", proc_id);
+    if (!data || size != tagless_size + selector_size)
+      FATAL_ERROR(proc_id, "Warm state of the indirect target predictor is missing or does not match\n");
+    memcpy(bp_data->tc_tagless, data, tagless_size);
+    if (selector_size)
+      memcpy(bp_data->tc_selector, data + tagless_size, selector_size);
+  }
+
+  data = (const uns8*)warm_state_find(&size, "bp%u.hist", proc_id);
+  if (!data || size != sizeof(hist) + crs_size + sizeof(Flag) * CRS_ENTRIES)
+    FATAL_ERROR(proc_id, "Warm state of the branch history is missing or does not match CRS_ENTRIES\n");
+  memcpy(&hist, data, sizeof(hist));
+  bp_data->global_hist = hist.global_hist;
+  bp_data->targ_hist = hist.targ_hist;
+  bp_data->targ_index = hist.targ_index;
+  bp_data->crs.depth = hist.crs_depth;
+  bp_data->crs.head = hist.crs_head;
+  bp_data->crs.tail = hist.crs_tail;
+  bp_data->crs.tail_save = hist.crs_tail_save;
+  bp_data->crs.depth_save = hist.crs_depth_save;
+  bp_data->crs.tos = hist.crs_tos;
+  bp_data->crs.next = hist.crs_next;
+  memcpy(bp_data->crs.entries, data + sizeof(hist), crs_size);
+  memcpy(bp_data->crs.off_path, data + sizeof(hist) + crs_size, sizeof(Flag) * CRS_ENTRIES);
+}
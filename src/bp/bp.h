@@ -138,6 +138,15 @@ typedef struct Bp_Data_struct {
 
   uns32 global_hist;
   Cache btb;
+  /* block BTB: the last block read, reused by the following branches of the same block */
+  Flag btb_block_valid;
+  Addr btb_block_addr;
+  void* btb_block;
+  /* two-level BTB */
+  Cache btb_l2;
+  Counter btb_ready_cycle; /* no new prediction before this cycle (BTB latency) */
+  /* BTB prefetch: the direct taken branches of each code line, standing in for predecoding the line */
+  Cache btb_predecode;
 
   struct {
     Crs_Entry* entries;
@@ -184,6 +193,8 @@ typedef enum Bp_Id_enum {
 
 typedef enum Btb_Id_enum {
   GENERIC_BTB,
+  BLOCK_BTB,
+  TWO_LEVEL_BTB,
   NUM_BTB,
 } Btb_Id;
 
@@ -213,6 +224,8 @@ typedef struct Bp_struct {
                                          * updated after retirement*/
   void (*recover_func)(Recovery_Info*); /* called to recover the bp when a misprediction is realized */
   uns8 (*full_func)(uns);
+  void (*save_func)(uns); /* called to write the predictor state into the open warm state section (may be NULL) */
+  Flag (*load_func)(uns, const void*, uns64); /* called to restore what save_func wrote; FALSE if it does not fit */
 } Bp;
 
 typedef struct Bp_Btb_struct {
@@ -251,8 +264,8 @@ typedef struct Br_Conf_struct {
 extern Bp bp_table[];
 extern Bp_Btb bp_btb_table[];
 extern Bp_Ibtb bp_ibtb_table[];
-extern Bp_Data* g_bp_data;
-extern Bp_Recovery_Info* bp_recovery_info;
+extern CORE_LOCAL Bp_Data* g_bp_data;
+extern CORE_LOCAL Bp_Recovery_Info* bp_recovery_info;
 extern Br_Conf br_conf_table[];
 
 /**************************************************************************************/
@@ -273,6 +286,8 @@ void bp_target_known_op(Bp_Data*, Op*);
 void bp_resolve_op(Bp_Data*, Op*);
 void bp_retire_op(Bp_Data*, Op*);
 void bp_recover_op(Bp_Data*, Cf_Type, Recovery_Info*);
+void bp_save_warm_state(Bp_Data*);
+void bp_load_warm_state(Bp_Data*);
 
 void inc_bstat_fetched(Op* op);
 void inc_bstat_miss(Op* op);
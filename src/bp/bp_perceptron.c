@@ -19,6 +19,11 @@
 #include "bp/bp_perceptron.h"
 #include "bp.param.h"
 #include "op.h"
+#include "warm_state.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /***************************************************************************
  * Global State
@@ -58,6 +63,97 @@ static inline Bp_Perceptron_Weight saturate_weight(int32 val) {
     return (Bp_Perceptron_Weight)val;
 }
 
+/* Byte masks of each history byte: byte j of hist_byte_masks[b] is 0xff if bit j of b is set.
+ * Weights are stored contiguously after the bias, so the history weights can be combined with
+ * the expanded history 16 at a time (see bp_perceptron_dot and bp_perceptron_adjust). */
+static uns64 hist_byte_masks[256];
+
+static void init_hist_byte_masks(void) {
+    uns32 b, j;
+    for (b = 0; b < 256; b++) {
+        hist_byte_masks[b] = 0;
+        for (j = 0; j < 8; j++) {
+            if (b & (1 << j))
+                hist_byte_masks[b] |= 0xffULL << (8 * j);
+        }
+    }
+}
+
+/* History bits that have a weight */
+static inline uns64 hist_valid_bits(void) {
+    return bp_perceptron.hist_len == 64 ? ~0ULL : (1ULL << bp_perceptron.hist_len) - 1;
+}
+
+#ifdef __SSE2__
+/* Byte masks of 16 history bits starting at bit 16*chunk */
+static inline __m128i hist_chunk_mask(uns64 hist, uns32 chunk) {
+    uns32 bits = (uns32)(hist >> (16 * chunk));
+    return _mm_set_epi64x((long long)hist_byte_masks[(bits >> 8) & 0xff], (long long)hist_byte_masks[bits & 0xff]);
+}
+#endif
+
+/* sum over i in [1, hist_len] of (bit i-1 of hist ? w[i] : -w[i]) */
+static inline int32 bp_perceptron_dot(const Bp_Perceptron_Entry* p, uns64 hist) {
+#ifdef __SSE2__
+    /* With u = w + 128, the result is 2 * (sum of u over set bits) - (sum of u over all bits)
+     * - 128 * (2 * set bits - hist_len). Lanes past hist_len are masked out of both sums. */
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    const __m128i zero = _mm_setzero_si128();
+    uns64 valid = hist_valid_bits();
+    __m128i set_sum = zero;
+    __m128i all_sum = zero;
+    uns32 chunk;
+
+    hist &= valid;
+    for (chunk = 0; chunk < 4; chunk++) {
+        __m128i u = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&p->weights[1 + 16 * chunk]), bias);
+        u = _mm_and_si128(u, hist_chunk_mask(valid, chunk));
+        set_sum = _mm_add_epi64(set_sum, _mm_sad_epu8(_mm_and_si128(u, hist_chunk_mask(hist, chunk)), zero));
+        all_sum = _mm_add_epi64(all_sum, _mm_sad_epu8(u, zero));
+    }
+    int32 set = _mm_cvtsi128_si32(set_sum) + _mm_cvtsi128_si32(_mm_srli_si128(set_sum, 8));
+    int32 all = _mm_cvtsi128_si32(all_sum) + _mm_cvtsi128_si32(_mm_srli_si128(all_sum, 8));
+    int32 num_set = __builtin_popcountll(hist);
+    return 2 * set - all - 128 * (2 * num_set - (int32)bp_perceptron.hist_len);
+#else
+    int32 y = 0;
+    uns32 i;
+    for (i = 1; i <= bp_perceptron.hist_len; i++) {
+        int8 xi = to_bipolar(hist & 1);
+        y += xi * p->weights[i];
+        hist >>= 1;
+    }
+    return y;
+#endif
+}
+
+/* w[i] += (bit i-1 of hist == taken ? 1 : -1) for i in [1, hist_len], saturating */
+static inline void bp_perceptron_adjust(Bp_Perceptron_Entry* p, uns64 hist, uns8 taken) {
+#ifdef __SSE2__
+    /* The signed saturating add clamps to exactly [BP_PERCEPTRON_WEIGHT_MIN, BP_PERCEPTRON_WEIGHT_MAX] */
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    uns64 valid = hist_valid_bits();
+    uns64 agree = (taken ? hist : ~hist) & valid;
+    uns32 chunk;
+
+    for (chunk = 0; chunk < 4; chunk++) {
+        __m128i* w = (__m128i*)&p->weights[1 + 16 * chunk];
+        __m128i step = _mm_sub_epi8(_mm_and_si128(hist_chunk_mask(agree, chunk), two), one);
+        step = _mm_and_si128(step, hist_chunk_mask(valid, chunk));
+        _mm_storeu_si128(w, _mm_adds_epi8(_mm_loadu_si128(w), step));
+    }
+#else
+    int8 t = taken ? 1 : -1;
+    uns32 i;
+    for (i = 1; i <= bp_perceptron.hist_len; i++) {
+        int8 xi = to_bipolar(hist & 1);
+        p->weights[i] = saturate_weight(p->weights[i] + t * xi);
+        hist >>= 1;
+    }
+#endif
+}
+
 /***************************************************************************
  * Initialization
  ***************************************************************************/
@@ -87,6 +183,8 @@ void bp_perceptron_init(void) {
         }
     }
     
+    init_hist_byte_masks();
+
     /* Initialize statistics */
     stat_predictions = 0;
     stat_mispredictions = 0;
@@ -107,22 +205,13 @@ static uns8 bp_perceptron_predict(uns64 pc, int32* y_out, uns64* saved_ghist, un
     uns32 index;
     Bp_Perceptron_Entry* p;
     int32 y;
-    uns32 i;
-    uns64 hist;
     
     /* Compute table index */
     index = compute_index(pc);
     p = &bp_perceptron.table[index];
     
     /* Compute perceptron output: y = w0 + sum(xi * wi) */
-    y = p->weights[0];  /* Start with bias weight */
-    hist = bp_perceptron.ghist;
-    
-    for (i = 1; i <= bp_perceptron.hist_len; i++) {
-        int8 xi = to_bipolar(hist & 1);
-        y += xi * p->weights[i];
-        hist >>= 1;
-    }
+    y = p->weights[0] + bp_perceptron_dot(p, bp_perceptron.ghist);
     
     /* Save state for update */
     *y_out = y;
@@ -143,8 +232,6 @@ static void bp_perceptron_train(uns8 taken, int32 y_out, uns64 saved_ghist, uns3
     Bp_Perceptron_Entry* p;
     int8 t;
     int8 predicted;
-    uns32 i;
-    uns64 hist;
     Flag do_update;
     
     p = &bp_perceptron.table[saved_index];
@@ -164,12 +251,7 @@ static void bp_perceptron_train(uns8 taken, int32 y_out, uns64 saved_ghist, uns3
         p->weights[0] = saturate_weight(p->weights[0] + t);
         
         /* Update history weights */
-        hist = saved_ghist;
-        for (i = 1; i <= bp_perceptron.hist_len; i++) {
-            int8 xi = to_bipolar(hist & 1);
-            p->weights[i] = saturate_weight(p->weights[i] + t * xi);
-            hist >>= 1;
-        }
+        bp_perceptron_adjust(p, saved_ghist, taken);
         
         stat_updates++;
         
@@ -236,4 +318,26 @@ void bp_perceptron_recover_op(Recovery_Info* info) {
 uns8 bp_perceptron_full(uns proc_id) {
     (void)proc_id;
     return FALSE;
-}
\ No newline at end of file
+}
+
+/***************************************************************************
+ * Warm State
+ ***************************************************************************/
+
+/* The perceptron table is shared by all cores, so every core saves the same
+ * image. */
+void bp_perceptron_save_state(uns proc_id) {
+    (void)proc_id;
+    warm_state_write(&bp_perceptron.ghist, sizeof(bp_perceptron.ghist));
+    warm_state_write(bp_perceptron.table, sizeof(Bp_Perceptron_Entry) * bp_perceptron.num_entries);
+}
+
+Flag bp_perceptron_load_state(uns proc_id, const void* data, uns64 size) {
+    (void)proc_id;
+    if (size != sizeof(bp_perceptron.ghist) + sizeof(Bp_Perceptron_Entry) * bp_perceptron.num_entries)
+        return FALSE;
+    memcpy(&bp_perceptron.ghist, data, sizeof(bp_perceptron.ghist));
+    memcpy(bp_perceptron.table, (const uns8*)data + sizeof(bp_perceptron.ghist),
+           sizeof(Bp_Perceptron_Entry) * bp_perceptron.num_entries);
+    return TRUE;
+}
@@ -58,5 +58,7 @@ void bp_perceptron_update_op(Op* op);
 void bp_perceptron_retire(Op* op);
 void bp_perceptron_recover_op(Recovery_Info* info);
 uns8 bp_perceptron_full(uns proc_id);
+void bp_perceptron_save_state(uns proc_id);
+Flag bp_perceptron_load_state(uns proc_id, const void* data, uns64 size);
 
 #endif /* __BP_PERCEPTRON_H__ */
\ No newline at end of file
@@ -0,0 +1,218 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : bp/bp_shadow.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Shadow branch predictors (see bp_shadow.h). Each shadow keeps its
+ *                own branch id and prediction in the op; they are swapped into the
+ *                fields the bp_table interface uses around every call, so predictors
+ *                need no changes to run as a shadow.
+ ***************************************************************************************/
+
+#include "bp/bp_shadow.h"
+
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "bp/bp.param.h"
+#include "core.param.h"
+
+#include "op.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Bp* shadow_bps[MAX_SHADOW_BPS];
+static uns num_shadow_bps = 0;
+static Flag shadow_bps_parsed = FALSE;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static void bp_shadow_parse(void);
+static Flag bp_shadow_shares_state(Bp* bp, Bp* other);
+
+/**************************************************************************************/
+/* bp_shadow_shares_state: two table entries backed by the same functions (e.g.
+ * tagescl and tagescl80) share one predictor state and cannot run side by side */
+
+static Flag bp_shadow_shares_state(Bp* bp, Bp* other) {
+  return other && bp->init_func == other->init_func;
+}
+
+/**************************************************************************************/
+/* bp_shadow_parse: SHADOW_BP_MECHS is a comma separated list of bp_table names */
+
+static void bp_shadow_parse(void) {
+  char list[MAX_STR_LENGTH + 1];
+  char* name;
+  uns ii, jj;
+
+  shadow_bps_parsed = TRUE;
+  if (!SHADOW_BP_MECHS)
+    return;
+  strncpy(list, SHADOW_BP_MECHS, MAX_STR_LENGTH);
+  list[MAX_STR_LENGTH] = '\0';
+
+  for (name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+    for (ii = 0; bp_table[ii].name; ii++)
+      if (strcmp(name, bp_table[ii].name) == 0)
+        break;
+    if (!bp_table[ii].name)
+      FATAL_ERROR(0, "Invalid shadow branch predictor '%s' in SHADOW_BP_MECHS\n", name);
+    ASSERTM(0, num_shadow_bps < MAX_SHADOW_BPS, "SHADOW_BP_MECHS lists more than %d predictors\n", MAX_SHADOW_BPS);
+    ASSERTM(0, !bp_shadow_shares_state(&bp_table[ii], &bp_table[BP_MECH]),
+            "Shadow branch predictor '%s' shares its state with BP_MECH\n", name);
+    ASSERTM(0, LATE_BP_MECH == NUM_BP || !bp_shadow_shares_state(&bp_table[ii], &bp_table[LATE_BP_MECH]),
+            "Shadow branch predictor '%s' shares its state with LATE_BP_MECH\n", name);
+    for (jj = 0; jj < num_shadow_bps; jj++)
+      ASSERTM(0, !bp_shadow_shares_state(&bp_table[ii], shadow_bps[jj]),
+              "Shadow branch predictor '%s' is listed twice or shares its state with another shadow\n", name);
+    shadow_bps[num_shadow_bps++] = &bp_table[ii];
+  }
+}
+
+/**************************************************************************************/
+/* bp_shadow_init: called with init_bp_data for every core */
+
+void bp_shadow_init(Bp_Data* bp_data) {
+  uns ii;
+
+  if (!shadow_bps_parsed)
+    bp_shadow_parse();
+  for (ii = 0; ii < num_shadow_bps; ii++)
+    shadow_bps[ii]->init_func();
+}
+
+/**************************************************************************************/
+/* bp_shadow_timestamp: */
+
+void bp_shadow_timestamp(Op* op) {
+  int64 branch_id = op->recovery_info.branch_id;
+  uns ii;
+
+  for (ii = 0; ii < num_shadow_bps; ii++) {
+    op->recovery_info.branch_id = 0;
+    shadow_bps[ii]->timestamp_func(op);
+    op->recovery_info.shadow_branch_id[ii] = op->recovery_info.branch_id;
+  }
+  op->recovery_info.branch_id = branch_id;
+}
+
+/**************************************************************************************/
+/* bp_shadow_pred: called for conditional branches once the primary prediction
+ * is known; on-path accuracy is counted for the primary and every shadow */
+
+void bp_shadow_pred(Op* op) {
+  int64 branch_id = op->recovery_info.branch_id;
+  int bp_confidence = op->bp_confidence;
+  uns ii;
+
+  if (!num_shadow_bps)
+    return;
+  if (!op->off_path)
+    STAT_EVENT(op->proc_id, SHADOW_BP_PRIMARY_CORRECT + (op->oracle_info.pred != op->oracle_info.dir));
+  for (ii = 0; ii < num_shadow_bps; ii++) {
+    op->recovery_info.branch_id = op->recovery_info.shadow_branch_id[ii];
+    op->oracle_info.shadow_pred[ii] = shadow_bps[ii]->pred_func(op);
+    if (!op->off_path)
+      STAT_EVENT(op->proc_id, SHADOW_BP_0_CORRECT + 2 * ii + (op->oracle_info.shadow_pred[ii] != op->oracle_info.dir));
+  }
+  op->recovery_info.branch_id = branch_id;
+  op->bp_confidence = bp_confidence;
+}
+
+/**************************************************************************************/
+/* Shadow versions of the remaining stages: the shadow's branch id, and for
+ * conditional branches its prediction, stand in for the primary's */
+
+#define BP_SHADOW_CALL(op, func)                                                \
+  do {                                                                          \
+    int64 branch_id = (op)->recovery_info.branch_id;                            \
+    uns8 pred = (op)->oracle_info.pred;                                         \
+    Flag cbr = (op)->table_info->cf_type == CF_CBR;                             \
+    for (uns ii = 0; ii < num_shadow_bps; ii++) {                               \
+      (op)->recovery_info.branch_id = (op)->recovery_info.shadow_branch_id[ii]; \
+      if (cbr)                                                                  \
+        (op)->oracle_info.pred = (op)->oracle_info.shadow_pred[ii];             \
+      shadow_bps[ii]->func(op);                                                 \
+    }                                                                           \
+    (op)->recovery_info.branch_id = branch_id;                                  \
+    (op)->oracle_info.pred = pred;                                              \
+  } while (0)
+
+void bp_shadow_spec_update(Op* op) {
+  BP_SHADOW_CALL(op, spec_update_func);
+}
+
+void bp_shadow_update(Op* op) {
+  BP_SHADOW_CALL(op, update_func);
+}
+
+void bp_shadow_retire(Op* op) {
+  BP_SHADOW_CALL(op, retire_func);
+}
+
+/**************************************************************************************/
+/* bp_shadow_recover: */
+
+void bp_shadow_recover(Recovery_Info* info) {
+  int64 branch_id = info->branch_id;
+  uns ii;
+
+  for (ii = 0; ii < num_shadow_bps; ii++) {
+    info->branch_id = info->shadow_branch_id[ii];
+    shadow_bps[ii]->recover_func(info);
+  }
+  info->branch_id = branch_id;
+}
+
+/**************************************************************************************/
+/* bp_shadow_done: prints the on-path conditional branch MPKI and accuracy of
+ * the primary and every shadow predictor */
+
+void bp_shadow_done(void) {
+  uns proc_id, ii;
+
+  if (!num_shadow_bps)
+    return;
+  for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    fprintf(mystdout, "** Core %u shadow branch predictors (on-path conditional branches)\n", proc_id);
+    fprintf(mystdout, "   %-12s %10s %10s\n", "predictor", "MPKI", "accuracy");
+    for (ii = 0; ii <= num_shadow_bps; ii++) {
+      Stat_Enum correct_stat = ii ? SHADOW_BP_0_CORRECT + 2 * (ii - 1) : SHADOW_BP_PRIMARY_CORRECT;
+      Counter correct = GET_TOTAL_STAT_EVENT(proc_id, correct_stat);
+      Counter mispred = GET_TOTAL_STAT_EVENT(proc_id, correct_stat + 1);
+      fprintf(mystdout, "   %-12s %10.3f %9.2f%%\n", ii ? shadow_bps[ii - 1]->name : bp_table[BP_MECH].name,
+              inst_count[proc_id] ? 1000.0 * mispred / inst_count[proc_id] : 0.0,
+              correct + mispred ? 100.0 * correct / (correct + mispred) : 0.0);
+    }
+  }
+}
@@ -0,0 +1,53 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : bp/bp_shadow.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Shadow branch predictors: extra bp_table predictors that see the
+ *                same predict/update/retire/recover stream as the primary one and
+ *                only report their accuracy. Their predictions never steer fetch.
+ ***************************************************************************************/
+
+#ifndef __BP_SHADOW_H__
+#define __BP_SHADOW_H__
+
+#include "globals/global_types.h"
+
+#include "bp/bp.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+void bp_shadow_init(Bp_Data* bp_data);
+void bp_shadow_timestamp(Op* op);
+void bp_shadow_pred(Op* op);
+void bp_shadow_spec_update(Op* op);
+void bp_shadow_update(Op* op);
+void bp_shadow_retire(Op* op);
+void bp_shadow_recover(Recovery_Info* info);
+void bp_shadow_done(void);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __BP_SHADOW_H__ */
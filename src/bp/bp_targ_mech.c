@@ -40,6 +40,7 @@
 
 #include "bp/bp.param.h"
 #include "core.param.h"
+#include "memory/memory.param.h"
 
 #include "bp/bp.h"
 #include "isa/isa_macros.h"
@@ -290,6 +291,278 @@ void bp_btb_gen_update(Bp_Data* bp_data, Op* op) {
   }
 }
 
+/**************************************************************************************/
+/* block BTB: one entry per BTB_BLOCK_SIZE-aligned fetch block holding up to
+ * BTB_BLOCK_BRANCHES branches, so the fetch-target builder reads the BTB once per
+ * block instead of once per branch. The last block read is kept in bp_data and
+ * reused while consecutive branches fall into it; any other access or insert
+ * drops it, which keeps the replacement state identical to a per-branch read. */
+
+typedef struct Btb_Block_Slot_struct {
+  Addr target;
+  Counter write_cycle; /* slots are replaced oldest write first */
+  uns16 offset;        /* byte offset of the branch in the block */
+  uns8 cf_type;
+  Flag valid;
+} Btb_Block_Slot;
+
+static Btb_Block_Slot* bp_btb_block_read(Bp_Data* bp_data, Addr addr, Flag update_repl) {
+  Addr block_addr = ROUND_DOWN(addr, BTB_BLOCK_SIZE);
+  Addr line_addr;
+
+  if (!update_repl)
+    return (Btb_Block_Slot*)cache_access(&bp_data->btb, addr, &line_addr, FALSE);
+  if (bp_data->btb_block_valid && bp_data->btb_block_addr == block_addr) {
+    STAT_EVENT(bp_data->proc_id, BTB_BLOCK_REUSED);
+    return (Btb_Block_Slot*)bp_data->btb_block;
+  }
+
+  STAT_EVENT(bp_data->proc_id, BTB_BLOCK_READ);
+  bp_data->btb_block = cache_access(&bp_data->btb, addr, &line_addr, TRUE);
+  bp_data->btb_block_addr = block_addr;
+  bp_data->btb_block_valid = TRUE;
+  return (Btb_Block_Slot*)bp_data->btb_block;
+}
+
+static Btb_Block_Slot* bp_btb_block_find(Btb_Block_Slot* block, Addr addr) {
+  uns16 offset = addr & (BTB_BLOCK_SIZE - 1);
+  uns ii;
+
+  if (!block)
+    return NULL;
+  for (ii = 0; ii < BTB_BLOCK_BRANCHES; ii++) {
+    if (block[ii].valid && block[ii].offset == offset)
+      return &block[ii];
+  }
+  return NULL;
+}
+
+/**************************************************************************************/
+/* bp_btb_block_init: */
+
+void bp_btb_block_init(Bp_Data* bp_data) {
+  ASSERTM(bp_data->proc_id, BTB_BLOCK_SIZE && !(BTB_BLOCK_SIZE & (BTB_BLOCK_SIZE - 1)),
+          "BTB_BLOCK_SIZE must be a power of 2\n");
+  ASSERTM(bp_data->proc_id, BTB_BLOCK_BRANCHES && BTB_ENTRIES % (BTB_BLOCK_BRANCHES * BTB_ASSOC) == 0,
+          "BTB_ENTRIES must be a multiple of BTB_BLOCK_BRANCHES * BTB_ASSOC\n");
+  init_cache(&bp_data->btb, "BTB", BTB_ENTRIES / BTB_BLOCK_BRANCHES * BTB_BLOCK_SIZE, BTB_ASSOC, BTB_BLOCK_SIZE,
+             sizeof(Btb_Block_Slot) * BTB_BLOCK_BRANCHES, REPL_TRUE_LRU);
+  bp_data->btb_block_valid = FALSE;
+}
+
+/**************************************************************************************/
+/* bp_btb_block_pred: */
+
+Addr* bp_btb_block_pred(Bp_Data* bp_data, Op* op) {
+  Btb_Block_Slot* slot;
+
+  if (PERFECT_BTB)
+    return &op->oracle_info.target;
+  slot = bp_btb_block_find(bp_btb_block_read(bp_data, op->oracle_info.pred_addr, TRUE), op->oracle_info.pred_addr);
+  return slot ? &slot->target : NULL;
+}
+
+/**************************************************************************************/
+/* bp_btb_block_peek: reads the target of op's branch without touching the
+ * replacement state */
+
+Addr* bp_btb_block_peek(Bp_Data* bp_data, Op* op) {
+  Btb_Block_Slot* slot =
+      bp_btb_block_find(bp_btb_block_read(bp_data, op->oracle_info.pred_addr, FALSE), op->oracle_info.pred_addr);
+  return slot ? &slot->target : NULL;
+}
+
+/**************************************************************************************/
+/* bp_btb_block_update: */
+
+void bp_btb_block_update(Bp_Data* bp_data, Op* op) {
+  Addr fetch_addr = op->oracle_info.pred_addr;
+  Addr btb_line_addr, repl_line_addr;
+  Btb_Block_Slot *block, *slot;
+  uns ii;
+
+  ASSERT(bp_data->proc_id, bp_data->proc_id == op->proc_id);
+  if (!BTB_OFF_PATH_WRITES && op->off_path)
+    return;
+  DEBUG_BTB(bp_data->proc_id, "Writing BTB block  addr:0x%s  target:0x%s\n", hexstr64s(fetch_addr),
+            hexstr64s(op->oracle_info.target));
+  STAT_EVENT(op->proc_id, BTB_ON_PATH_WRITE + op->off_path);
+
+  bp_data->btb_block_valid = FALSE;
+  block = (Btb_Block_Slot*)cache_access(&bp_data->btb, fetch_addr, &btb_line_addr, TRUE);
+  if (!block) {
+    block = (Btb_Block_Slot*)cache_insert(&bp_data->btb, bp_data->proc_id, fetch_addr, &btb_line_addr,
+                                          &repl_line_addr);
+    memset(block, 0, sizeof(Btb_Block_Slot) * BTB_BLOCK_BRANCHES);
+  }
+
+  slot = bp_btb_block_find(block, fetch_addr);
+  if (!slot) {
+    slot = &block[0];
+    for (ii = 1; ii < BTB_BLOCK_BRANCHES && slot->valid; ii++) {
+      if (!block[ii].valid || block[ii].write_cycle < slot->write_cycle)
+        slot = &block[ii];
+    }
+    if (slot->valid)
+      STAT_EVENT(op->proc_id, BTB_BLOCK_EVICT_BRANCH);
+    slot->valid = TRUE;
+    slot->offset = fetch_addr & (BTB_BLOCK_SIZE - 1);
+  }
+  slot->target = op->oracle_info.target;
+  slot->cf_type = op->table_info->cf_type;
+  slot->write_cycle = cycle_count;
+}
+
+/**************************************************************************************/
+/* two-level BTB: BTB_ENTRIES one-branch entries backed by a larger L2. The L2 is
+ * written along with the L1, so it holds every branch the L1 does; an L1 miss that
+ * hits in the L2 copies the entry into the L1 and holds off the next prediction
+ * for BTB_L2_LATENCY cycles. */
+
+/**************************************************************************************/
+/* bp_btb_2level_init: */
+
+void bp_btb_2level_init(Bp_Data* bp_data) {
+  init_cache(&bp_data->btb, "BTB", BTB_ENTRIES, BTB_ASSOC, 1, sizeof(Addr), REPL_TRUE_LRU);
+  init_cache(&bp_data->btb_l2, "BTB_L2", BTB_L2_ENTRIES, BTB_L2_ASSOC, 1, sizeof(Addr), REPL_TRUE_LRU);
+}
+
+/**************************************************************************************/
+/* bp_btb_2level_pred: */
+
+Addr* bp_btb_2level_pred(Bp_Data* bp_data, Op* op) {
+  Addr fetch_addr = op->oracle_info.pred_addr;
+  Addr line_addr, repl_line_addr;
+  Addr *target, *l2_target;
+
+  if (PERFECT_BTB)
+    return &op->oracle_info.target;
+
+  target = (Addr*)cache_access(&bp_data->btb, fetch_addr, &line_addr, TRUE);
+  if (target) {
+    STAT_EVENT(op->proc_id, BTB_L1_HIT);
+    return target;
+  }
+  l2_target = (Addr*)cache_access(&bp_data->btb_l2, fetch_addr, &line_addr, TRUE);
+  if (!l2_target) {
+    STAT_EVENT(op->proc_id, BTB_L2_MISS);
+    return NULL;
+  }
+
+  STAT_EVENT(op->proc_id, BTB_L2_HIT);
+  DEBUG_BTB(bp_data->proc_id, "L2 BTB hit  addr:0x%s  target:0x%s\n", hexstr64s(fetch_addr), hexstr64s(*l2_target));
+  bp_data->btb_ready_cycle = MAX2(bp_data->btb_ready_cycle, cycle_count + BTB_L2_LATENCY);
+  target = (Addr*)cache_insert(&bp_data->btb, bp_data->proc_id, fetch_addr, &line_addr, &repl_line_addr);
+  *target = *l2_target;
+  return target;
+}
+
+/**************************************************************************************/
+/* bp_btb_2level_update: */
+
+void bp_btb_2level_update(Bp_Data* bp_data, Op* op) {
+  Addr fetch_addr = op->oracle_info.pred_addr;
+  Addr *btb_line, btb_line_addr, repl_line_addr;
+
+  bp_btb_gen_update(bp_data, op);
+  if (!BTB_OFF_PATH_WRITES && op->off_path)
+    return;
+
+  btb_line = (Addr*)cache_access(&bp_data->btb_l2, fetch_addr, &btb_line_addr, TRUE);
+  if (!btb_line) {
+    btb_line = (Addr*)cache_insert(&bp_data->btb_l2, bp_data->proc_id, fetch_addr, &btb_line_addr, &repl_line_addr);
+  }
+  *btb_line = op->oracle_info.target;
+}
+
+/**************************************************************************************/
+/* BTB prefetch (Shotgun/Confluence style): when a prefetch brings a code line into
+ * the icache, the direct branches of the line are written into the BTB before the
+ * frontend reaches them. Each line of btb_predecode holds the last
+ * BTB_PREFETCH_LINE_BRANCHES direct branches seen taken in that code line. */
+
+typedef struct Btb_Predecode_Slot_struct {
+  Addr target;
+  Counter write_cycle; /* slots are replaced oldest write first */
+  uns16 offset;        /* byte offset of the branch in the line */
+  Flag valid;
+} Btb_Predecode_Slot;
+
+/**************************************************************************************/
+/* bp_btb_prefetch_init: */
+
+void bp_btb_prefetch_init(Bp_Data* bp_data) {
+  ASSERTM(bp_data->proc_id, BTB_MECH != BLOCK_BTB, "BTB_PREFETCH does not support the block BTB\n");
+  init_cache(&bp_data->btb_predecode, "BTB_PREDECODE", BTB_PREFETCH_LINES * ICACHE_LINE_SIZE, 8, ICACHE_LINE_SIZE,
+             sizeof(Btb_Predecode_Slot) * BTB_PREFETCH_LINE_BRANCHES, REPL_TRUE_LRU);
+}
+
+/**************************************************************************************/
+/* bp_btb_prefetch_record: called on resolved taken branches */
+
+void bp_btb_prefetch_record(Bp_Data* bp_data, Op* op) {
+  Addr addr = op->oracle_info.pred_addr;
+  uns16 offset = addr & (ICACHE_LINE_SIZE - 1);
+  Addr line_addr, repl_line_addr;
+  Btb_Predecode_Slot *line, *slot = NULL;
+  uns ii;
+
+  // only the targets of direct branches can be predecoded
+  if (op->off_path || (op->table_info->cf_type != CF_BR && op->table_info->cf_type != CF_CBR &&
+                       op->table_info->cf_type != CF_CALL))
+    return;
+
+  line = (Btb_Predecode_Slot*)cache_access(&bp_data->btb_predecode, addr, &line_addr, TRUE);
+  if (!line) {
+    line = (Btb_Predecode_Slot*)cache_insert(&bp_data->btb_predecode, bp_data->proc_id, addr, &line_addr,
+                                             &repl_line_addr);
+    memset(line, 0, sizeof(Btb_Predecode_Slot) * BTB_PREFETCH_LINE_BRANCHES);
+  }
+  for (ii = 0; ii < BTB_PREFETCH_LINE_BRANCHES && !slot; ii++) {
+    if (line[ii].valid && line[ii].offset == offset)
+      slot = &line[ii];
+  }
+  if (!slot) {
+    slot = &line[0];
+    for (ii = 1; ii < BTB_PREFETCH_LINE_BRANCHES && slot->valid; ii++) {
+      if (!line[ii].valid || line[ii].write_cycle < slot->write_cycle)
+        slot = &line[ii];
+    }
+  }
+  slot->valid = TRUE;
+  slot->offset = offset;
+  slot->target = op->oracle_info.target;
+  slot->write_cycle = cycle_count;
+}
+
+/**************************************************************************************/
+/* bp_btb_prefetch_line: called when a prefetch fills the icache line at addr */
+
+void bp_btb_prefetch_line(Bp_Data* bp_data, Addr addr) {
+  Cache* btb = BTB_MECH == TWO_LEVEL_BTB ? &bp_data->btb_l2 : &bp_data->btb;
+  Addr line_addr, btb_line_addr, repl_line_addr;
+  Btb_Predecode_Slot* line;
+  uns ii;
+
+  line = (Btb_Predecode_Slot*)cache_access(&bp_data->btb_predecode, addr, &line_addr, FALSE);
+  STAT_EVENT(bp_data->proc_id, line ? BTB_PREFETCH_LINE_PREDECODED : BTB_PREFETCH_LINE_UNKNOWN);
+  if (!line)
+    return;
+
+  for (ii = 0; ii < BTB_PREFETCH_LINE_BRANCHES; ii++) {
+    Addr branch_addr = line_addr + line[ii].offset;
+    Addr* target;
+    if (!line[ii].valid || cache_access(&bp_data->btb, branch_addr, &btb_line_addr, FALSE))
+      continue;
+    target = (Addr*)cache_access(btb, branch_addr, &btb_line_addr, FALSE);
+    if (!target) {
+      target = (Addr*)cache_insert(btb, bp_data->proc_id, branch_addr, &btb_line_addr, &repl_line_addr);
+      STAT_EVENT(bp_data->proc_id, BTB_PREFETCH_FILL);
+    }
+    *target = line[ii].target;
+  }
+}
+
 /**************************************************************************************/
 /* bp_tc_tagged_init: */
 
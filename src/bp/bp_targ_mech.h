@@ -46,6 +46,19 @@ void bp_btb_gen_init(Bp_Data*);
 Addr* bp_btb_gen_pred(Bp_Data*, Op*);
 void bp_btb_gen_update(Bp_Data*, Op*);
 
+void bp_btb_block_init(Bp_Data*);
+Addr* bp_btb_block_pred(Bp_Data*, Op*);
+void bp_btb_block_update(Bp_Data*, Op*);
+Addr* bp_btb_block_peek(Bp_Data*, Op*);
+
+void bp_btb_2level_init(Bp_Data*);
+Addr* bp_btb_2level_pred(Bp_Data*, Op*);
+void bp_btb_2level_update(Bp_Data*, Op*);
+
+void bp_btb_prefetch_init(Bp_Data*);
+void bp_btb_prefetch_record(Bp_Data*, Op*);
+void bp_btb_prefetch_line(Bp_Data*, Addr);
+
 void bp_ibtb_tc_tagged_init(Bp_Data*);
 Addr bp_ibtb_tc_tagged_pred(Bp_Data*, Op*);
 void bp_ibtb_tc_tagged_update(Bp_Data*, Op*);
@@ -21,13 +21,68 @@
  * interact with scarab.
  */
 
+#include <type_traits>
+#include <vector>
+
 #include "bp/bp.param.h"
 
 #include "cbp_to_scarab.h"
 
+/**
+ * @brief Predictors that expose a History type (the global and path history
+ * registers), SaveHistory(), RestoreHistory() and SpecHistoryUpdate() get
+ * wrong-path history updates and recovery from the interface below. Everything
+ * else in the predictor is still only updated on the correct path.
+ */
+struct CBP_No_History {};
+
+template <typename CBP_CLASS, typename = void>
+struct CBP_History_Of {
+  typedef CBP_No_History type;
+  static constexpr bool value = false;
+};
+
+template <typename CBP_CLASS>
+struct CBP_History_Of<CBP_CLASS, std::void_t<typename CBP_CLASS::History>> {
+  typedef typename CBP_CLASS::History type;
+  static constexpr bool value = true;
+};
+
+/**
+ * @brief Ring of history snapshots keyed by branch_id. Ids are handed out in
+ * fetch order, so a branch's slot is only reused once CBP_CHECKPOINT_ENTRIES
+ * younger branches have been predicted; the stored key catches that case.
+ */
+template <typename HISTORY>
+class CBP_History_Checkpoints {
+  std::vector<HISTORY> histories;
+  std::vector<Counter> keys;
+
+ public:
+  void init(uns entries) {
+    histories.resize(entries);
+    keys.assign(entries, 0);
+  }
+
+  HISTORY& take(Counter key) {
+    uns slot = key & (keys.size() - 1);
+    keys[slot] = key;
+    return histories[slot];
+  }
+
+  const HISTORY* find(Counter key) const {
+    uns slot = key & (keys.size() - 1);
+    return keys[slot] == key ? &histories[slot] : NULL;
+  }
+};
+
 template <typename CBP_CLASS>
 class CBP_To_Scarab_Intf {
+  typedef CBP_History_Of<CBP_CLASS> History_Of;
+
   std::vector<CBP_CLASS> cbp_predictors;
+  std::vector<CBP_History_Checkpoints<typename History_Of::type>> checkpoints;
+  std::vector<Counter> branch_ids;
 
  public:
   void init() {
@@ -36,30 +91,59 @@ class CBP_To_Scarab_Intf {
       for (uns i = 0; i < NUM_CORES; ++i) {
         cbp_predictors.emplace_back();
       }
+      if (History_Of::value) {
+        ASSERTM(0, CBP_CHECKPOINT_ENTRIES && !(CBP_CHECKPOINT_ENTRIES & (CBP_CHECKPOINT_ENTRIES - 1)),
+                "CBP_CHECKPOINT_ENTRIES must be a power of 2\n");
+        checkpoints.resize(NUM_CORES);
+        for (uns i = 0; i < NUM_CORES; ++i) {
+          checkpoints[i].init(CBP_CHECKPOINT_ENTRIES);
+        }
+        branch_ids.assign(NUM_CORES, 0);
+      }
     }
     ASSERTM(0, cbp_predictors.size() == NUM_CORES, "cbp_predictors not initialized correctly");
   }
 
   void timestamp(Op* op) {
-    /* CBP Interface does not support speculative updates */
-    op->recovery_info.branch_id = 0;
+    /* branch_id 0 means the predictor keeps no checkpoints */
+    if (History_Of::value && SPEC_LEVEL > BP_PRED_ON)
+      op->recovery_info.branch_id = ++branch_ids.at(op->proc_id);
+    else
+      op->recovery_info.branch_id = 0;
   }
 
   uns8 pred(Op* op) {
     uns proc_id = op->proc_id;
     if (op->off_path)
-      return op->oracle_info.dir;
+      if (!History_Of::value || SPEC_LEVEL < BP_PRED_ONOFF_SPEC_UPDATE_S_ONOFF_N_ON)
+        return op->oracle_info.dir;
     return cbp_predictors.at(proc_id).GetPrediction(op->inst_info->addr, &op->bp_confidence);
   }
 
   void spec_update(Op* op) {
-    /* CBP Interface does not support speculative updates */
-    if (op->off_path)
-      return;
-
     uns proc_id = op->proc_id;
     OpType optype = scarab_to_cbp_optype(op->table_info->cf_type);
 
+    if constexpr (History_Of::value) {
+      if (SPEC_LEVEL > BP_PRED_ON) {
+        /* snapshot before the update so a recovery can re-apply the resolved direction */
+        cbp_predictors.at(proc_id).SaveHistory(checkpoints.at(proc_id).take(op->recovery_info.branch_id));
+        if (op->off_path) {
+          if (SPEC_LEVEL >= BP_PRED_ON_SPEC_UPDATE_S_ONOFF_N_ON) {
+            Flag pred_dir = (SPEC_LEVEL < BP_PRED_ONOFF_SPEC_UPDATE_S_ONOFF_UPDATE_N_ON) ? op->oracle_info.dir
+                                                                                          : op->oracle_info.pred;
+            cbp_predictors.at(proc_id).SpecHistoryUpdate(
+                op->inst_info->addr, is_conditional_branch(op->table_info->cf_type), pred_dir, op->oracle_info.target);
+          }
+          return;
+        }
+      }
+    }
+
+    /* tables are only trained on the correct path, at speculative update time */
+    if (op->off_path)
+      return;
+
     if (is_conditional_branch(op->table_info->cf_type)) {
       cbp_predictors.at(proc_id).UpdatePredictor(op->inst_info->addr, optype, op->oracle_info.dir, op->oracle_info.pred,
                                                  op->oracle_info.target);
@@ -73,7 +157,19 @@ class CBP_To_Scarab_Intf {
 
   void retire(Op* op) { /* CBP Interface updates predictor at speculative update time */ }
 
-  void recover(Recovery_Info*) { /* CBP Interface does not support speculative updates */ }
+  void recover(Recovery_Info* recovery_info) {
+    if constexpr (History_Of::value) {
+      if (SPEC_LEVEL == BP_PRED_ON)
+        return;
+      uns proc_id = recovery_info->proc_id;
+      const typename History_Of::type* history = checkpoints.at(proc_id).find(recovery_info->branch_id);
+      ASSERTM(proc_id, history, "CBP history checkpoint %lld was overwritten, increase CBP_CHECKPOINT_ENTRIES\n",
+              recovery_info->branch_id);
+      cbp_predictors.at(proc_id).RestoreHistory(*history);
+      cbp_predictors.at(proc_id).SpecHistoryUpdate(recovery_info->PC, is_conditional_branch(recovery_info->cf_type),
+                                                   recovery_info->oracle_dir, recovery_info->branchTarget);
+    }
+  }
 
   Flag full(uns proc_id) { return cbp_predictors.at(proc_id).IsFull(); }
 };
@@ -30,6 +30,7 @@ extern "C" {
 #include "core.param.h"
 
 #include "statistics.h"
+#include "warm_state.h"
 }
 
 #define PHT_INIT_VALUE (0x1 << (PHT_CTR_BITS - 1)) /* weakly taken */
@@ -117,3 +118,16 @@ void bp_gshare_update(Op* op) {
   DEBUG(proc_id, "Updating addr:%s  pht:%u  ent:%u  dir:%d\n", hexstr64s(addr), pht_index, gshare_state.pht[pht_index],
         op->oracle_info.dir);
 }
+
+void bp_gshare_save_state(uns proc_id) {
+  const auto& pht = gshare_state_all_cores.at(proc_id).pht;
+  warm_state_write(pht.data(), pht.size());
+}
+
+Flag bp_gshare_load_state(uns proc_id, const void* data, uns64 size) {
+  auto& pht = gshare_state_all_cores.at(proc_id).pht;
+  if (size != pht.size())
+    return FALSE;
+  memcpy(pht.data(), data, size);
+  return TRUE;
+}
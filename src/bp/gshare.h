@@ -37,6 +37,8 @@ void bp_gshare_update(Op*);
 void bp_gshare_retire(Op*);
 void bp_gshare_recover(Recovery_Info*);
 uns8 bp_gshare_full(uns);
+void bp_gshare_save_state(uns);
+Flag bp_gshare_load_state(uns, const void*, uns64);
 
 #ifdef __cplusplus
 }
@@ -16,6 +16,7 @@
 #include "mtage_unlimited.h"
 
 #include "bp/bp.param.h"
+#include "libs/table_alloc.h"
 
 // for my personal statistics
 int XX, YY, ZZ, TT;
@@ -531,10 +532,12 @@ int& bftable::getfreq(uint64_t pc) {
   return freq[i];
 }
 
-void subpath::init(int ng, int hist[], int logg, int tagbits, int pathbits, int hp) {
+void subpath::init(int ng, int hist[], int logg, int tagbits, int pathbits, int hp, int slack) {
   MTAGE_ASSERT(ng > 0);
   numg = ng;
-  ph.init(hist[numg - 1] + 1);
+  // slack entries past the longest history absorb wrong-path inserts, so
+  // restoring ptr from a checkpoint is enough to recover the register
+  ph.init(hist[numg - 1] + 1 + slack);
   chg = new compressed_history[numg];
   chgg = new compressed_history[numg];
   cht = new compressed_history[numg];
@@ -549,12 +552,12 @@ void subpath::init(int ng, int hist[], int logg, int tagbits, int pathbits, int
   }
 }
 
-void subpath::init(int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp) {
+void subpath::init(int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp, int slack) {
   int* h = new int[ng];
   for (int i = 0; i < ng; i++) {
     h[i] = minhist * pow((double)maxhist / minhist, (double)i / (ng - 1));
   }
-  init(ng, h, logg, tagbits, pathbits, hp);
+  init(ng, h, logg, tagbits, pathbits, hp, slack);
 }
 
 void subpath::update(uint64_t targetpc, bool taken) {
@@ -592,11 +595,12 @@ spectrum::spectrum() {
   p = NULL;
 }
 
-void spectrum::init(int sz, int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp) {
+void spectrum::init(int sz, int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp,
+                    int slack) {
   size = sz;
   p = new subpath[size];
   for (int i = 0; i < size; i++) {
-    p[i].init(ng, minhist, maxhist, logg, tagbits, pathbits, hp);
+    p[i].init(ng, minhist, maxhist, logg, tagbits, pathbits, hp, slack);
   }
 }
 
@@ -636,9 +640,81 @@ gentry::gentry() {
   u = 0;
 }
 
+sparse_gtable::sparse_gtable() {
+  slots = NULL;
+  mask = 0;
+  count = 0;
+}
+
+void sparse_gtable::init() {
+  mask = 1023;
+  count = 0;
+  slots = (slot*)table_alloc("mtage", sizeof(slot) * (mask + 1));
+  for (uint32_t i = 0; i <= mask; i++) {
+    slots[i].idx = EMPTY;
+  }
+}
+
+uint32_t sparse_gtable::home(uint32_t idx) const {
+  // folded indices are not uniform in their low bits, so scramble them first
+  return (uint32_t)(((uint64_t)idx * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+}
+
+const gentry* sparse_gtable::find(uint32_t idx) const {
+  for (uint32_t s = home(idx);; s = (s + 1) & mask) {
+    if (slots[s].idx == idx)
+      return &slots[s].e;
+    if (slots[s].idx == EMPTY)
+      return NULL;
+  }
+}
+
+gentry& sparse_gtable::get(uint32_t idx) {
+  uint32_t s = home(idx);
+  for (; slots[s].idx != EMPTY; s = (s + 1) & mask) {
+    if (slots[s].idx == idx)
+      return slots[s].e;
+  }
+  if (4 * (count + 1) > 3 * (mask + 1)) {
+    grow();
+    return get(idx);
+  }
+  slots[s].idx = idx;
+  slots[s].e = gentry();
+  count++;
+  return slots[s].e;
+}
+
+void sparse_gtable::grow() {
+  slot* old = slots;
+  uint32_t old_size = mask + 1;
+  mask = 2 * old_size - 1;
+  slots = (slot*)table_alloc("mtage", sizeof(slot) * (mask + 1));
+  for (uint32_t i = 0; i <= mask; i++) {
+    slots[i].idx = EMPTY;
+  }
+  for (uint32_t i = 0; i < old_size; i++) {
+    if (old[i].idx == EMPTY)
+      continue;
+    uint32_t s = home(old[i].idx);
+    while (slots[s].idx != EMPTY)
+      s = (s + 1) & mask;
+    slots[s] = old[i];
+  }
+  table_free("mtage", old, sizeof(slot) * old_size);
+}
+
+void sparse_gtable::uclear() {
+  for (uint32_t i = 0; i <= mask; i++) {
+    if (slots[i].idx != EMPTY && slots[i].e.u)
+      slots[i].e.u--;
+  }
+}
+
 tage::tage() {
   b = NULL;
   g = NULL;
+  sg = NULL;
   gi = NULL;
   postp = NULL;
   nmisp = 0;
@@ -701,9 +777,17 @@ void tage::init(const char* nm, int ng, int logb, int logg, int tagb, int ctrb,
   for (int i = 0; i < bsize; i++) {
     b[i] = 0;
   }
-  g = new gentry*[numg];
-  for (int i = 0; i < numg; i++) {
-    g[i] = new gentry[gsize];
+  if (MTAGE_SPARSE_TABLES) {
+    sg = new sparse_gtable[numg];
+    for (int i = 0; i < numg; i++) {
+      sg[i].init();
+    }
+  } else {
+    g = new gentry*[numg];
+    for (int i = 0; i < numg; i++) {
+      // a zeroed gentry is a default-constructed one
+      g[i] = (gentry*)table_alloc("mtage", sizeof(gentry) * gsize);
+    }
   }
   gi = new int[numg];
   postp = new int8_t[postpsize];
@@ -748,15 +832,26 @@ int tage::postp_index() {
 
 gentry& tage::getg(int i) {
   MTAGE_ASSERT((i >= 0) && (i < numg));
+  if (sg)
+    return sg[i].get(gi[i]);
   return g[i][gi[i]];
 }
 
+int tage::gettag(int i) {
+  // lookups must not allocate sparse entries, only updates do
+  if (sg) {
+    const gentry* e = sg[i].find(gi[i]);
+    return e ? e->tag : gentry().tag;
+  }
+  return g[i][gi[i]].tag;
+}
+
 bool tage::condbr_predict(uint64_t pc, subpath& p) {
   hit.clear();
   bi = bindex(pc);
   for (int i = 0; i < numg; i++) {
     gi[i] = gindex(pc, p, i);
-    if (g[i][gi[i]].tag == gtag(pc, p, i)) {
+    if (gettag(i) == gtag(pc, p, i)) {
       hit.push_back(i);
     }
   }
@@ -770,6 +865,12 @@ bool tage::condbr_predict(uint64_t pc, subpath& p) {
 }
 
 void tage::uclear() {
+  if (sg) {
+    for (int i = 0; i < numg; i++) {
+      sg[i].uclear();
+    }
+    return;
+  }
   for (int i = 0; i < numg; i++) {
     for (int j = 0; j < gsize; j++) {
       if (g[i][j].u)
@@ -970,12 +1071,15 @@ MTAGE::MTAGE(void) {
     TAGBITS = 12;
   }
 
-  sp[0].init(P0_SPSIZE, P0_NUMG, P0_MINHIST, P0_MAXHIST, P0_LOGG, TAGBITS, PATHBITS, P0_HASHPARAM);
+  // the global paths are the only ones updated on the wrong path
+  sp[0].init(P0_SPSIZE, P0_NUMG, P0_MINHIST, P0_MAXHIST, P0_LOGG, TAGBITS, PATHBITS, P0_HASHPARAM,
+             CBP_CHECKPOINT_ENTRIES);
   sp[1].init(P1_SPSIZE, P1_NUMG, P1_MINHIST, P1_MAXHIST, P1_LOGG, TAGBITS, PATHBITS, P1_HASHPARAM);
   sp[2].init(P2_SPSIZE, P2_NUMG, P2_MINHIST, P2_MAXHIST, P2_LOGG, TAGBITS, PATHBITS, P2_HASHPARAM);
   sp[3].init(P3_SPSIZE, P3_NUMG, P3_MINHIST, P3_MAXHIST, P3_LOGG, TAGBITS, PATHBITS, P3_HASHPARAM);
   sp[4].init(P4_SPSIZE, P4_NUMG, P4_MINHIST, P4_MAXHIST, P4_LOGG, TAGBITS, PATHBITS, P4_HASHPARAM);
-  sp[5].init(P5_SPSIZE, P5_NUMG, P5_MINHIST, P5_MAXHIST, P5_LOGG, TAGBITS, PATHBITS, P5_HASHPARAM);
+  sp[5].init(P5_SPSIZE, P5_NUMG, P5_MINHIST, P5_MAXHIST, P5_LOGG, TAGBITS, PATHBITS, P5_HASHPARAM,
+             CBP_CHECKPOINT_ENTRIES);
 
   pred[0].init("G", P0_NUMG, P0_LOGB, P0_LOGG, TAGBITS, CTRBITS, POSTPBITS, P0_RAMPUP, CAPHIST);
   pred[1].init("A", P1_NUMG, P1_LOGB, P1_LOGG, TAGBITS, CTRBITS, POSTPBITS, P1_RAMPUP, CAPHIST);
@@ -1141,6 +1245,88 @@ uns8 MTAGE::IsFull(void) {
   return 0;
 }
 
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+void MTAGE::SaveHistory(History& h) {
+  subpath* gp[2] = {&sp[0].p[0], &sp[NPRED - 1].p[0]};
+  h.comp.clear();
+  for (int k = 0; k < 2; k++) {
+    h.ptr[k] = gp[k]->ph.ptr;
+    for (int i = 0; i < gp[k]->numg; i++) {
+      h.comp.push_back(gp[k]->chg[i].comp);
+      h.comp.push_back(gp[k]->chgg[i].comp);
+      h.comp.push_back(gp[k]->cht[i].comp);
+      h.comp.push_back(gp[k]->chtt[i].comp);
+    }
+  }
+  for (int i = 1; i <= NGEHL; i++)
+    h.comp.push_back(chgehl_i[i].comp);
+  for (int i = 1; i <= NRHSP; i++)
+    h.comp.push_back(chrhsp_i[i].comp);
+
+  h.ptghist = ptghist;
+  h.GHIST = GHIST;
+  h.P_phist = P_phist;
+  h.BHIST = BHIST;
+  h.RHIST = RHIST;
+  h.CHIST = CHIST;
+  h.YHA = YHA;
+  h.IMLIcount = IMLIcount;
+  h.lastaddr = lastaddr;
+  memcpy(h.LastBR, LastBR, sizeof(LastBR));
+}
+
+void MTAGE::RestoreHistory(const History& h) {
+  subpath* gp[2] = {&sp[0].p[0], &sp[NPRED - 1].p[0]};
+  unsigned n = 0;
+  for (int k = 0; k < 2; k++) {
+    gp[k]->ph.ptr = h.ptr[k];
+    for (int i = 0; i < gp[k]->numg; i++) {
+      gp[k]->chg[i].comp = h.comp[n++];
+      gp[k]->chgg[i].comp = h.comp[n++];
+      gp[k]->cht[i].comp = h.comp[n++];
+      gp[k]->chtt[i].comp = h.comp[n++];
+    }
+  }
+  for (int i = 1; i <= NGEHL; i++)
+    chgehl_i[i].comp = h.comp[n++];
+  for (int i = 1; i <= NRHSP; i++)
+    chrhsp_i[i].comp = h.comp[n++];
+  MTAGE_ASSERT(n == h.comp.size());
+
+  ptghist = h.ptghist;
+  GHIST = h.GHIST;
+  P_phist = h.P_phist;
+  BHIST = h.BHIST;
+  RHIST = h.RHIST;
+  CHIST = h.CHIST;
+  YHA = h.YHA;
+  IMLIcount = h.IMLIcount;
+  lastaddr = h.lastaddr;
+  memcpy(LastBR, h.LastBR, sizeof(LastBR));
+}
+
+// Updates only the registers covered by History, the same way UpdatePredictor
+// and TrackOtherInst do. Tables and the per-address, per-set and frequency
+// subpaths are left alone: they are only ever updated on the correct path.
+void MTAGE::SpecHistoryUpdate(uint64_t PC, bool is_conditional, bool taken, uint64_t branchTarget) {
+  if (is_conditional) {
+    uint64_t ForUpdate = (taken) ? (branchTarget << 1) ^ PC : PC;
+    sp[0].p[0].update(ForUpdate, taken);
+    if (npred != 1 && branchTarget < PC)
+      sp[NPRED - 1].p[0].update(ForUpdate, taken);
+    HistoryUpdate(PC, 1, taken, branchTarget, ptghist, chgehl_i, chrhsp_i, true);
+  } else {
+    uint64_t PC0 = (PC ^ (PC >> 2));
+    uint64_t branchTarget0 = (branchTarget ^ (branchTarget >> 2));
+    uint64_t ForUpdate = (branchTarget0 << 1) ^ PC0;
+    sp[0].p[0].update(ForUpdate, true);
+    sp[NPRED - 1].p[0].update(ForUpdate, true);
+    HistoryUpdate(PC, 0, true, branchTarget, ptghist, chgehl_i, chrhsp_i, true);
+  }
+}
+
 void MTAGE::initSC() {
   NRHSP = 80;
   NGEHL = 209;
@@ -1378,7 +1564,7 @@ void MTAGE::initSC() {
 
 void MTAGE::HistoryUpdate(uint64_t PC, uint8_t brtype, bool taken, uint64_t target, int& Y, folded_history* K,
 
-                          folded_history* L) {
+                          folded_history* L, bool spec) {
 #define OPTYPE_BRANCH_COND 1
   // History skeleton
   bool V = false;
@@ -1397,9 +1583,11 @@ void MTAGE::HistoryUpdate(uint64_t PC, uint8_t brtype, bool taken, uint64_t targ
 
   // Path history
   P_phist = (P_phist << 1) ^ (taken ^ ((PC >> 5) & 1));
-  IMLIhist[INDIMLI] = (IMLIhist[INDIMLI] << 1) ^ (taken ^ ((PC >> 5) & 1));
+  // local and IMLI tables are not checkpointed: a speculative update leaves them alone
+  if (!spec)
+    IMLIhist[INDIMLI] = (IMLIhist[INDIMLI] << 1) ^ (taken ^ ((PC >> 5) & 1));
 
-  if (brtype == OPTYPE_BRANCH_COND) {
+  if (brtype == OPTYPE_BRANCH_COND && !spec) {
     // local history
     L_shist[INDLOCAL] = (L_shist[INDLOCAL] << 1) + (taken);
     Q_slhist[INDQLOCAL] = (Q_slhist[INDQLOCAL] << 1) + (taken);
@@ -1407,6 +1595,9 @@ void MTAGE::HistoryUpdate(uint64_t PC, uint8_t brtype, bool taken, uint64_t targ
     S_slhist[INDSLOCAL] ^= ((PC >> LOGSECLOCAL) & 15);
     T_slhist[INDTLOCAL] = (T_slhist[INDTLOCAL] << 1) + (taken);
     T_slhist[INDTLOCAL] ^= ((PC >> LOGTLOCAL) & 15);
+  }
+
+  if (brtype == OPTYPE_BRANCH_COND) {
     // global branch history
     GHIST = (GHIST << 1) + taken;
 
@@ -1438,7 +1629,7 @@ void MTAGE::HistoryUpdate(uint64_t PC, uint8_t brtype, bool taken, uint64_t targ
 
 #define SHIFTFUTURE 9
   // IMLI OH history, see IMLI paper at Micro 2015
-  if (brtype == OPTYPE_BRANCH_COND) {
+  if (brtype == OPTYPE_BRANCH_COND && !spec) {
     if (target >= PC) {
       PAST[PC & 63] = histtable[(((PC ^ (PC >> 2)) << SHIFTFUTURE) + IMLIcount) & (HISTTABLESIZE - 1)];
       histtable[(((PC ^ (PC >> 2)) << SHIFTFUTURE) + IMLIcount) & (HISTTABLESIZE - 1)] = taken;
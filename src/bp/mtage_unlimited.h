@@ -212,8 +212,8 @@ class subpath {
   compressed_history* cht;
   compressed_history* chtt;
 
-  void init(int ng, int hist[], int logg, int tagbits, int pathbits, int hp);
-  void init(int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp);
+  void init(int ng, int hist[], int logg, int tagbits, int pathbits, int hp, int slack = 0);
+  void init(int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp, int slack = 0);
   void update(uint64_t targetpc, bool taken);
   unsigned cg(int bank);
   unsigned cgg(int bank);
@@ -228,7 +228,7 @@ class spectrum {
   subpath* p;
 
   spectrum();
-  void init(int sz, int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp);
+  void init(int sz, int ng, int minhist, int maxhist, int logg, int tagbits, int pathbits, int hp, int slack = 0);
 };
 
 class freqbins {
@@ -251,6 +251,31 @@ class gentry {
   gentry();
 };
 
+class sparse_gtable {
+  // hash-backed tagged table for limit studies: only the entries that were
+  // written are stored, so host memory follows the number of distinct branch
+  // contexts instead of the nominal table size. Missing entries read as a
+  // default gentry, which keeps predictions identical to the dense table.
+ public:
+  struct slot {
+    uint32_t idx;  // table index, EMPTY if the slot is free
+    gentry e;
+  };
+  static const uint32_t EMPTY = 0xffffffffu;
+
+  slot* slots;
+  uint32_t mask;   // number of slots - 1
+  uint32_t count;  // occupied slots
+
+  sparse_gtable();
+  void init();
+  uint32_t home(uint32_t idx) const;
+  const gentry* find(uint32_t idx) const;
+  gentry& get(uint32_t idx);
+  void grow();
+  void uclear();
+};
+
 class tage {
   // cf. TAGE (Seznec & Michaud JILP 2006, Seznec MICRO 2011)
  public:
@@ -258,6 +283,7 @@ class tage {
 
   int8_t* b;   // tagless (bimodal) table
   gentry** g;  // tagged tables
+  sparse_gtable* sg;  // tagged tables in sparse mode (MTAGE_SPARSE_TABLES)
   int bi;
   int* gi;
   vector<int> hit;
@@ -288,6 +314,7 @@ class tage {
   int gtag(uint64_t pc, subpath& p, int bank);
   int postp_index();
   gentry& getg(int i);
+  int gettag(int i);
   bool condbr_predict(uint64_t pc, subpath& p);
   void uclear();
   void galloc(int i, uint64_t pc, bool taken, subpath& p);
@@ -313,6 +340,24 @@ class folded_history {
   void update(uint8_t* h, int PT);
 };
 
+class mtage_history {
+  // global and path history registers, checkpointed by cbp_to_scarab so that
+  // wrong-path updates can be undone on a recovery
+ public:
+  int ptr[2];                  // global and backward path history pointers
+  std::vector<unsigned> comp;  // their compressed histories, then the GEHL and RHSP ones
+  int ptghist;
+  long long GHIST;
+  long long P_phist;
+  long long BHIST;
+  long long RHIST;
+  long long CHIST;
+  long long YHA;
+  long long IMLIcount;
+  uint64_t lastaddr;
+  int LastBR[8];
+};
+
 class MTAGE {
  private:
   bftable bft;
@@ -331,9 +376,15 @@ class MTAGE {
   void TrackOtherInst(uint64_t PC, OpType opType, bool taken, uint64_t branchTarget);
   uns8 IsFull(void);
 
+  // speculative history support, see CBP_To_Scarab_Intf
+  typedef mtage_history History;
+  void SaveHistory(History& h);
+  void RestoreHistory(const History& h);
+  void SpecHistoryUpdate(uint64_t PC, bool is_conditional, bool taken, uint64_t branchTarget);
+
   void initSC();
   void HistoryUpdate(uint64_t PC, uint8_t brtype, bool taken, uint64_t target, int& Y, folded_history* K,
-                     folded_history* L);
+                     folded_history* L, bool spec = false);
 
   void UpdateFinalSC(uint64_t PC, bool taken);
   void UpdateSC(uint64_t PC, bool taken, bool PRED);
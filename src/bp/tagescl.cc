@@ -31,6 +31,7 @@ extern "C" {
 #include "core.param.h"
 
 #include "table_info.h"
+#include "warm_state.h"
 }
 
 #include "bp/template_lib/tagescl.h"
@@ -124,3 +125,12 @@ void bp_tagescl_recover(Recovery_Info* recovery_info) {
 uns8 bp_tagescl_full(uns proc_id) {
   return tagescl_predictors.at(proc_id)->is_full();
 }
+
+void bp_tagescl_save_state(uns proc_id) {
+  std::vector<uint8_t> state = tagescl_predictors.at(proc_id)->save_state();
+  warm_state_write(state.data(), state.size());
+}
+
+Flag bp_tagescl_load_state(uns proc_id, const void* data, uns64 size) {
+  return tagescl_predictors.at(proc_id)->load_state(data, size);
+}
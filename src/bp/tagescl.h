@@ -37,6 +37,8 @@ void bp_tagescl_update(Op* op);
 void bp_tagescl_retire(Op* op);
 void bp_tagescl_recover(Recovery_Info*);
 uns8 bp_tagescl_full(uns proc_id);
+void bp_tagescl_save_state(uns proc_id);
+Flag bp_tagescl_load_state(uns proc_id, const void* data, uns64 size);
 
 #ifdef __cplusplus
 }
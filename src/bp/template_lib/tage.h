@@ -23,26 +23,33 @@
 #define __TAGE_H_
 
 #include <cmath>
+#include <type_traits>
 #include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TAGE_AVX2 true
+#else
+#define TAGE_AVX2 false
+#endif
 
 #include "utils.h"
 
 /* The main history register suitable for very large history. The history is
- * implemented as a circular buffer for efficiency. The API only allows
- * insertions of bits into the most recent position of the history and provides
- * an accessor for random access of individual bits. It also provides an API for
- * rewinding the history to support recovery from mispeculation */
+ * implemented as a circular buffer of 64-bit words for efficiency. The API only
+ * allows insertions of bits into the most recent position of the history and
+ * provides an accessor for random access of individual bits. It also provides
+ * an API for rewinding the history to support recovery from mispeculation */
 template <int history_size>
 class Long_History_Register {
  public:
   // Buffer_size needs to be a power of 2. (buffer_size - history_size) should
   // be large enough to cover speculative branches that are not yet retired.
-  Long_History_Register(int max_in_flight_branches) : history_bits_() {
+  Long_History_Register(int max_in_flight_branches) : history_words_() {
     int log_buffer_size = get_min_num_bits_to_represent(history_size + max_in_flight_branches);
     buffer_size_ = 1 << log_buffer_size;
     buffer_access_mask_ = (1 << log_buffer_size) - 1;
     max_num_speculative_bits_ = buffer_size_ - history_size;
-    history_bits_.resize(buffer_size_);
+    history_words_.resize((buffer_size_ + 63) / 64);
   }
 
   // Pushes one bit into the history at the head. Increments
@@ -52,12 +59,22 @@ class Long_History_Register {
     // TODO: it will be cleaner to mask head_ with (size_ - 1) now. But I
     // want to keep it compatible with Seznec.
     head_ -= 1;
-    history_bits_[head_ & buffer_access_mask_] = bit;
+    int64_t pos = head_ & buffer_access_mask_;
+    uint64_t& word = history_words_[pos >> 6];
+    word = (word & ~(uint64_t(1) << (pos & 63))) | (uint64_t(bit) << (pos & 63));
 
     num_speculative_bits_ += 1;
     assert(num_speculative_bits_ <= max_num_speculative_bits_);
   }
 
+  // Pushes the num_bits low bits of bits, bit 0 first.
+  void push_bits(uint64_t bits, int num_bits) {
+    for (int i = 0; i < num_bits; ++i) {
+      push_bit(bits & 1);
+      bits >>= 1;
+    }
+  }
+
   // Rewinds num_rewind_bits branches out of the history.
   void rewind(int num_rewind_bits) {
     assert(num_rewind_bits > 0 && num_rewind_bits <= num_speculative_bits_);
@@ -73,74 +90,212 @@ class Long_History_Register {
 
   // Random access interface, i=0 is the most recent branch (head).
   bool operator[](size_t i) const {
-    return history_bits_[(head_ + i) & buffer_access_mask_];
+    int64_t pos = (head_ + i) & buffer_access_mask_;
+    return (history_words_[pos >> 6] >> (pos & 63)) & 1;
   }
 
   int64_t head_idx() const {
     return head_;
   }
 
+  // Bit i of the history is bit (i & 63) of word (i >> 6), for
+  // i = (head_idx() + age) & access_mask().
+  const uint64_t* words() const {
+    return history_words_.data();
+  }
+
+  int64_t access_mask() const {
+    return buffer_access_mask_;
+  }
+
+  template <class Archive>
+  void serialize(Archive& ar) {
+    ar.io(num_speculative_bits_);
+    ar.io(history_words_);
+    ar.io(head_);
+  }
+
  private:
   int num_speculative_bits_ = 0;  // keeps track of how many bits can be
                                   // discarded during a rewind without losing
                                   // bits in the most significant position.
-  std::vector<bool> history_bits_;
+  std::vector<uint64_t> history_words_;
   int64_t head_ = 0;
   int64_t buffer_size_;
   int64_t buffer_access_mask_;
   int64_t max_num_speculative_bits_;
 };
 
-/* Computes the a folded history of a large history, as bits are shifted into
- * the history. The caller should update the folded history everytime  */
-template <int history_size>
-class Folded_History {
+/* Computes the folded histories of a large history, as bits are shifted into
+ * the history. There are num_folds folds of each of num_histories history
+ * lengths (TAGE folds each length once for the index and twice for the tag).
+ * The caller should update the folded histories everytime bits are pushed into
+ * the history register. The folds are kept in arrays of lanes, padded to a
+ * multiple of 4, so that the AVX2 build updates four of them at a time. The
+ * padding lanes always stay 0. */
+template <int history_size, int num_histories, int num_folds>
+class Folded_Histories {
  public:
-  Folded_History(int original_length, int compressed_length)
-      : current_value_(0),
-        original_length_(original_length),
-        compressed_length_(compressed_length),
-        outpoint_(original_length % compressed_length) {}
+  static constexpr int NUM_LANES = (num_histories + 3) / 4 * 4;
 
-  int64_t get_value() const {
-    return current_value_;
+  Folded_Histories() : value_(), original_length_(), outpoint_(), compressed_length_(), mask_() {
+    for (int f = 0; f < num_folds; ++f) {
+      for (int h = 0; h < NUM_LANES; ++h) {
+        compressed_length_[f][h] = 1;
+      }
+    }
   }
 
-  void update(const Long_History_Register<history_size>& history_register) {
-    // Shift in the most recent GHR bit.
-    current_value_ = (current_value_ << 1) ^ history_register[0];
-
-    // Shift out the least recent GHR bit.
-    current_value_ ^= history_register[original_length_] << outpoint_;
-
-    // Fold shifted-out bit in.
-    current_value_ ^= current_value_ >> compressed_length_;
+  void init(int fold, int history, int original_length, int compressed_length) {
+    original_length_[history] = original_length;
+    outpoint_[fold][history] = original_length % compressed_length;
+    compressed_length_[fold][history] = compressed_length;
+    mask_[fold][history] = (int64_t(1) << compressed_length) - 1;
+  }
 
-    // Mask out the unused bits.
-    current_value_ &= (1 << compressed_length_) - 1;
+  int64_t get_value(int fold, int history) const {
+    return value_[fold][history];
   }
 
-  void update_reverse(const Long_History_Register<history_size>& history_register) {
-    // Fold out the most recent GHR bit.
-    current_value_ ^= history_register[0];
+  // All NUM_LANES lanes of one fold.
+  const int64_t* values(int fold) const {
+    return value_[fold];
+  }
 
-    // Fold out the least recent GHR bit.
-    current_value_ ^= history_register[original_length_] << outpoint_;
+  // Shifts in the num_bits most recent bits of the history, oldest first.
+  void update(const Long_History_Register<history_size>& history_register, int num_bits) {
+    if constexpr (TAGE_AVX2) {
+      update_vector(history_register, num_bits);
+      return;
+    }
+    for (int b = num_bits - 1; b >= 0; --b) {
+      int64_t new_bit = history_register[b];
+      for (int h = 0; h < num_histories; ++h) {
+        int64_t old_bit = history_register[original_length_[h] + b];
+        for (int f = 0; f < num_folds; ++f) {
+          // Shift in the new GHR bit, shift out the GHR bit that leaves the
+          // original length and fold the shifted-out bit in.
+          int64_t value = (value_[f][h] << 1) ^ new_bit;
+          value ^= old_bit << outpoint_[f][h];
+          value ^= value >> compressed_length_[f][h];
+          value_[f][h] = value & mask_[f][h];
+        }
+      }
+    }
+  }
 
-    // Rotate the low bit around to high bit.
-    current_value_ = ((current_value_ & 1) << (compressed_length_ - 1)) | (current_value_ >> 1);
+  // Undoes update() for the num_bits most recent bits of the history. Called
+  // before they are rewound out of the history register.
+  void update_reverse(const Long_History_Register<history_size>& history_register, int num_bits) {
+    if constexpr (TAGE_AVX2) {
+      update_reverse_vector(history_register, num_bits);
+      return;
+    }
+    for (int b = 0; b < num_bits; ++b) {
+      int64_t new_bit = history_register[b];
+      for (int h = 0; h < num_histories; ++h) {
+        int64_t old_bit = history_register[original_length_[h] + b];
+        for (int f = 0; f < num_folds; ++f) {
+          // Fold out the two GHR bits and rotate the low bit around to the
+          // high bit.
+          int64_t value = value_[f][h] ^ new_bit ^ (old_bit << outpoint_[f][h]);
+          value = ((value & 1) << (compressed_length_[f][h] - 1)) | (value >> 1);
+          value_[f][h] = value & mask_[f][h];
+        }
+      }
+    }
+  }
 
-    // Mask out the unused bits.
-    current_value_ &= (1 << compressed_length_) - 1;
+  template <class Archive>
+  void serialize(Archive& ar) {
+    for (int h = 0; h < num_histories; ++h) {
+      for (int f = 0; f < num_folds; ++f) {
+        ar.io(value_[f][h]);
+      }
+    }
   }
 
  private:
-  int64_t current_value_;
-  int original_length_;
-  int compressed_length_;
-  int outpoint_;
+  void update_vector(const Long_History_Register<history_size>& history_register, int num_bits);
+  void update_reverse_vector(const Long_History_Register<history_size>& history_register, int num_bits);
+
+  alignas(32) int64_t value_[num_folds][NUM_LANES];
+  alignas(32) int64_t original_length_[NUM_LANES];
+  alignas(32) int64_t outpoint_[num_folds][NUM_LANES];
+  alignas(32) int64_t compressed_length_[num_folds][NUM_LANES];
+  alignas(32) int64_t mask_[num_folds][NUM_LANES];
 };
 
+#if defined(__AVX2__)
+/* Bit age + original_length of the history register in every lane of a group
+ * of four histories, from a gather of the words that hold them. */
+template <int history_size>
+inline __m256i tage_gather_history_bits(const Long_History_Register<history_size>& history_register,
+                                        __m256i original_length, int age) {
+  __m256i pos = _mm256_add_epi64(_mm256_set1_epi64x(history_register.head_idx() + age), original_length);
+  pos = _mm256_and_si256(pos, _mm256_set1_epi64x(history_register.access_mask()));
+  __m256i words = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(history_register.words()),
+                                         _mm256_srli_epi64(pos, 6), 8);
+  __m256i bits = _mm256_srlv_epi64(words, _mm256_and_si256(pos, _mm256_set1_epi64x(63)));
+  return _mm256_and_si256(bits, _mm256_set1_epi64x(1));
+}
+
+template <int history_size, int num_histories, int num_folds>
+void Folded_Histories<history_size, num_histories, num_folds>::update_vector(
+    const Long_History_Register<history_size>& history_register, int num_bits) {
+  auto load = [](const int64_t* arr) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(arr)); };
+  for (int h = 0; h < NUM_LANES; h += 4) {
+    const __m256i original_length = load(&original_length_[h]);
+    __m256i value[num_folds];
+    for (int f = 0; f < num_folds; ++f) {
+      value[f] = load(&value_[f][h]);
+    }
+    for (int b = num_bits - 1; b >= 0; --b) {
+      const __m256i new_bit = _mm256_set1_epi64x(history_register[b]);
+      const __m256i old_bit = tage_gather_history_bits(history_register, original_length, b);
+      for (int f = 0; f < num_folds; ++f) {
+        __m256i v = _mm256_xor_si256(_mm256_slli_epi64(value[f], 1), new_bit);
+        v = _mm256_xor_si256(v, _mm256_sllv_epi64(old_bit, load(&outpoint_[f][h])));
+        v = _mm256_xor_si256(v, _mm256_srlv_epi64(v, load(&compressed_length_[f][h])));
+        value[f] = _mm256_and_si256(v, load(&mask_[f][h]));
+      }
+    }
+    for (int f = 0; f < num_folds; ++f) {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(&value_[f][h]), value[f]);
+    }
+  }
+}
+
+template <int history_size, int num_histories, int num_folds>
+void Folded_Histories<history_size, num_histories, num_folds>::update_reverse_vector(
+    const Long_History_Register<history_size>& history_register, int num_bits) {
+  auto load = [](const int64_t* arr) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(arr)); };
+  const __m256i one = _mm256_set1_epi64x(1);
+  for (int h = 0; h < NUM_LANES; h += 4) {
+    const __m256i original_length = load(&original_length_[h]);
+    __m256i value[num_folds];
+    for (int f = 0; f < num_folds; ++f) {
+      value[f] = load(&value_[f][h]);
+    }
+    for (int b = 0; b < num_bits; ++b) {
+      const __m256i new_bit = _mm256_set1_epi64x(history_register[b]);
+      const __m256i old_bit = tage_gather_history_bits(history_register, original_length, b);
+      for (int f = 0; f < num_folds; ++f) {
+        __m256i v = _mm256_xor_si256(value[f], new_bit);
+        v = _mm256_xor_si256(v, _mm256_sllv_epi64(old_bit, load(&outpoint_[f][h])));
+        __m256i high = _mm256_sllv_epi64(_mm256_and_si256(v, one),
+                                         _mm256_sub_epi64(load(&compressed_length_[f][h]), one));
+        v = _mm256_or_si256(high, _mm256_srli_epi64(v, 1));
+        value[f] = _mm256_and_si256(v, load(&mask_[f][h]));
+      }
+    }
+    for (int f = 0; f < num_folds; ++f) {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(&value_[f][h]), value[f]);
+    }
+  }
+}
+#endif
+
 template <class TAGE_CONFIG>
 struct Tage_History_Sizes {
   static constexpr int N = TAGE_CONFIG::NUM_HISTORIES;
@@ -196,6 +351,58 @@ struct Tage_Tag_Bits {
   int arr[N];
 };
 
+/* A config selects the SIMD lookup of the tagged tables (used when built with
+ * AVX2) with: static constexpr bool VECTOR_LOOKUP = true; */
+template <class TAGE_CONFIG, class = void>
+struct Tage_Vector_Lookup : std::false_type {};
+
+template <class TAGE_CONFIG>
+struct Tage_Vector_Lookup<TAGE_CONFIG, std::void_t<decltype(TAGE_CONFIG::VECTOR_LOOKUP)>>
+    : std::integral_constant<bool, TAGE_CONFIG::VECTOR_LOOKUP> {};
+
+/* Per-lane constants of the SIMD lookup. History lanes (4 per vector) hold what
+ * fill_table_indices_tags() derives from the history length and bank of table
+ * 2 * lane + 1; table lanes (8 per vector) are indexed by table number, with
+ * lane 0 and the padding lanes never enabled. */
+template <class TAGE_CONFIG>
+struct Tage_Lookup_Lanes {
+  static constexpr int N = TAGE_CONFIG::NUM_HISTORIES;
+  static constexpr int LOG = TAGE_CONFIG::LOG_ENTRIES_PER_BANK;
+  static constexpr int NUM_HISTORY_LANES = (N + 3) / 4 * 4;
+  static constexpr int NUM_TABLE_LANES = (2 * N + 1 + 7) / 8 * 8;
+  static_assert(NUM_TABLE_LANES <= 64, "enabled_tables is a 64-bit mask");
+
+  constexpr Tage_Lookup_Lanes()
+      : path_mask(), bank(), unbank(), rotate(), pc_shift(), tag_mask(), enabled_tables(0) {
+    constexpr Tage_History_Sizes<TAGE_CONFIG> history_sizes{};
+    constexpr Tage_Tag_Bits<TAGE_CONFIG> tag_bits{};
+    constexpr Tage_Tables_Enabled<TAGE_CONFIG> tables_enabled{};
+    for (int h = 0; h < N; ++h) {
+      int i = 2 * h + 1;
+      int max_path_width = history_sizes.arr[h] > TAGE_CONFIG::PATH_HISTORY_WIDTH ? TAGE_CONFIG::PATH_HISTORY_WIDTH
+                                                                                   : history_sizes.arr[h];
+      path_mask[h] = (1 << max_path_width) - 1;
+      bank[h] = i;
+      unbank[h] = i < LOG ? LOG - i : 0;
+      rotate[h] = i < LOG ? -1 : 0;
+      pc_shift[h] = (LOG > i ? LOG - i : i - LOG) + 1;
+      tag_mask[h] = (1 << tag_bits.arr[h]) - 1;
+    }
+    for (int i = 1; i <= 2 * N; ++i) {
+      if (tables_enabled.arr[i])
+        enabled_tables |= uint64_t(1) << i;
+    }
+  }
+
+  alignas(32) int64_t path_mask[NUM_HISTORY_LANES];
+  alignas(32) int64_t bank[NUM_HISTORY_LANES];
+  alignas(32) int64_t unbank[NUM_HISTORY_LANES];  // LOG - bank where the hash rotates
+  alignas(32) int64_t rotate[NUM_HISTORY_LANES];  // all ones where bank < LOG
+  alignas(32) int64_t pc_shift[NUM_HISTORY_LANES];
+  alignas(32) int64_t tag_mask[NUM_HISTORY_LANES];
+  uint64_t enabled_tables;
+};
+
 struct Bimodal_Output {
   bool prediction;
   bool confidence;
@@ -221,9 +428,10 @@ struct Tage_Prediction_Info {
   int hit_bank;
   int alt_bank;
 
-  // Extra information needed for updates.
-  int indices[2 * TAGE_CONFIG::NUM_HISTORIES + 1];
-  int tags[2 * TAGE_CONFIG::NUM_HISTORIES + 1];
+  // Extra information needed for updates. Padded past table
+  // 2 * NUM_HISTORIES for the vector lookup.
+  alignas(32) int indices[Tage_Lookup_Lanes<TAGE_CONFIG>::NUM_TABLE_LANES];
+  alignas(32) int tags[Tage_Lookup_Lanes<TAGE_CONFIG>::NUM_TABLE_LANES];
   int num_global_history_bits;
   int64_t global_history_head_checkpoint_;
   int64_t path_history_checkpoint;
@@ -257,24 +465,26 @@ class Tage_Histories {
     prediction_info->global_history_head_checkpoint_ = history_register_.head_idx();
 
     for (int i = 0; i < num_bit_inserts; ++i) {
-      history_register_.push_bit(pc_dir_hash & 1);
-      pc_dir_hash >>= 1;
-
       path_history_ = (path_history_ << 1) ^ (path_hash & 127);
       path_hash >>= 1;
-
-      for (int j = 0; j < TAGE_CONFIG::NUM_HISTORIES; ++j) {
-        folded_histories_for_indices_[j].update(history_register_);
-        folded_histories_for_tags_0_[j].update(history_register_);
-        folded_histories_for_tags_1_[j].update(history_register_);
-      }
     }
+    history_register_.push_bits(pc_dir_hash, num_bit_inserts);
+    folded_histories_.update(history_register_, num_bit_inserts);
 
     path_history_ = path_history_ & ((1 << TAGE_CONFIG::PATH_HISTORY_WIDTH) - 1);
   }
 
   void intialize_folded_history(void);
 
+  template <class Archive>
+  void serialize(Archive& ar) {
+    history_register_.serialize(ar);
+    folded_histories_.serialize(ar);
+    ar.io(path_history_);
+    ar.io(head_old_);
+    ar.io(path_history_old_);
+  }
+
   // Hash function for the path history used in creating table indices.
   int64_t compute_path_hash(int64_t path_history, int max_width, int bank, int index_size) const;
 
@@ -285,9 +495,11 @@ class Tage_Histories {
 
   // Predictor State
   Long_History_Register<TAGE_CONFIG::MAX_HISTORY_SIZE> history_register_;
-  std::vector<Folded_History<TAGE_CONFIG::MAX_HISTORY_SIZE>> folded_histories_for_indices_;
-  std::vector<Folded_History<TAGE_CONFIG::MAX_HISTORY_SIZE>> folded_histories_for_tags_0_;
-  std::vector<Folded_History<TAGE_CONFIG::MAX_HISTORY_SIZE>> folded_histories_for_tags_1_;
+  // Folds of every history length: one for the index and two for the tag.
+  static constexpr int INDEX_FOLD = 0;
+  static constexpr int TAG_0_FOLD = 1;
+  static constexpr int TAG_1_FOLD = 2;
+  Folded_Histories<TAGE_CONFIG::MAX_HISTORY_SIZE, TAGE_CONFIG::NUM_HISTORIES, 3> folded_histories_;
 
   int64_t path_history_;
   int64_t head_old_;
@@ -536,13 +748,9 @@ class Tage {
   void global_recover_speculative_state(const Tage_Prediction_Info<TAGE_CONFIG>& prediction_info) {
     int64_t num_flushed_bits =
         (prediction_info.global_history_head_checkpoint_ - tage_histories_.history_register_.head_idx());
-    for (int i = 0; i < num_flushed_bits; ++i) {
-      for (int j = 0; j < TAGE_CONFIG::NUM_HISTORIES; ++j) {
-        tage_histories_.folded_histories_for_indices_[j].update_reverse(tage_histories_.history_register_);
-        tage_histories_.folded_histories_for_tags_0_[j].update_reverse(tage_histories_.history_register_);
-        tage_histories_.folded_histories_for_tags_1_[j].update_reverse(tage_histories_.history_register_);
-      }
-      tage_histories_.history_register_.rewind(1);
+    if (num_flushed_bits > 0) {
+      tage_histories_.folded_histories_.update_reverse(tage_histories_.history_register_, num_flushed_bits);
+      tage_histories_.history_register_.rewind(num_flushed_bits);
     }
     tage_histories_.path_history_ = prediction_info.path_history_checkpoint;
   }
@@ -553,6 +761,16 @@ class Tage {
     *prediction_info = {};
   }
 
+  template <class Archive>
+  void serialize(Archive& ar) {
+    tage_histories_.serialize(ar);
+    ar.io(bimodal_table_);
+    ar.io(low_history_tagged_table_);
+    ar.io(high_history_tagged_table_);
+    ar.io(alt_selector_table_);
+    ar.io(tick_);
+  }
+
  private:
   struct Bimodal_Entry {
     int8_t hysteresis = 1;
@@ -573,6 +791,7 @@ class Tage {
 
   // Produce indices and tags for all Tagged table look-ups.
   void fill_table_indices_tags(uint64_t br_pc, Tage_Prediction_Info<TAGE_CONFIG>* tage_output) const;
+  void fill_table_indices_tags_vector(uint64_t br_pc, Tage_Prediction_Info<TAGE_CONFIG>* tage_output) const;
 
   // Get the prediction and confidence of the bimodal table.
   Bimodal_Output get_bimodal_prediction_confidence(uint64_t br_pc) const;
@@ -582,13 +801,19 @@ class Tage {
   // Get the banks IDs of matching tables with longest histories.
   // A bank of 0 means a match was not found.
   Matched_Table_Banks get_two_longest_matching_tables(int indices[], int tags[]) const;
+  Matched_Table_Banks get_two_longest_matching_tables_vector(const int indices[], const int tags[]) const;
 
   void shift_tage_useful_bits(Tagged_Entry* table, int size);
 
   // Derived constants
   static constexpr Tage_Tables_Enabled<TAGE_CONFIG> tables_enabled_ = {};
+  static constexpr bool vector_lookup_ = TAGE_AVX2 && Tage_Vector_Lookup<TAGE_CONFIG>::value;
+  static constexpr Tage_Lookup_Lanes<TAGE_CONFIG> lanes_ = {};
 
   Tagged_Entry* tagged_table_ptrs_[Tage_Histories<TAGE_CONFIG>::twice_num_histories_ + 1];
+  // Byte offset from this of the tag of entry 0 of every table lane, for the
+  // gathers of the vector lookup.
+  alignas(32) int table_tag_offsets_[Tage_Lookup_Lanes<TAGE_CONFIG>::NUM_TABLE_LANES];
 
   // Predictor State
   Tage_Histories<TAGE_CONFIG> tage_histories_;
@@ -614,6 +839,9 @@ constexpr Tage_Tables_Enabled<TAGE_CONFIG> Tage<TAGE_CONFIG>::tables_enabled_;
 template <class TAGE_CONFIG>
 constexpr Tage_Tag_Bits<TAGE_CONFIG> Tage_Histories<TAGE_CONFIG>::tag_bits_;
 
+template <class TAGE_CONFIG>
+constexpr Tage_Lookup_Lanes<TAGE_CONFIG> Tage<TAGE_CONFIG>::lanes_;
+
 template <class TAGE_CONFIG>
 void Tage<TAGE_CONFIG>::initialize_table_sizes(void) {
   for (int i = 1; i < TAGE_CONFIG::FIRST_LONG_HISTORY_TABLE; ++i) {
@@ -622,6 +850,12 @@ void Tage<TAGE_CONFIG>::initialize_table_sizes(void) {
   for (int i = TAGE_CONFIG::FIRST_LONG_HISTORY_TABLE; i <= Tage_Histories<TAGE_CONFIG>::twice_num_histories_; ++i) {
     tagged_table_ptrs_[i] = high_history_tagged_table_;
   }
+  for (int i = 0; i < Tage_Lookup_Lanes<TAGE_CONFIG>::NUM_TABLE_LANES; ++i) {
+    bool is_table = i >= 1 && i <= Tage_Histories<TAGE_CONFIG>::twice_num_histories_;
+    const Tagged_Entry* table = is_table ? tagged_table_ptrs_[i] : low_history_tagged_table_;
+    table_tag_offsets_[i] =
+        static_cast<int>(reinterpret_cast<const char*>(&table[0].tag) - reinterpret_cast<const char*>(this));
+  }
 }
 
 template <class TAGE_CONFIG>
@@ -633,9 +867,9 @@ void Tage_Histories<TAGE_CONFIG>::intialize_folded_history(void) {
     // REVISIT: since I got rid of LOG_ENTRIES_PER_BANK as a constant, this
     // should be fine now.
     const int LOG_ENTRIES_PER_BANK2 = TAGE_CONFIG::LOG_ENTRIES_PER_BANK;
-    folded_histories_for_indices_.emplace_back(history_sizes_.arr[i], LOG_ENTRIES_PER_BANK2);
-    folded_histories_for_tags_0_.emplace_back(history_sizes_.arr[i], tag_bits_.arr[i]);
-    folded_histories_for_tags_1_.emplace_back(history_sizes_.arr[i], tag_bits_.arr[i] - 1);
+    folded_histories_.init(INDEX_FOLD, i, history_sizes_.arr[i], LOG_ENTRIES_PER_BANK2);
+    folded_histories_.init(TAG_0_FOLD, i, history_sizes_.arr[i], tag_bits_.arr[i]);
+    folded_histories_.init(TAG_1_FOLD, i, history_sizes_.arr[i], tag_bits_.arr[i] - 1);
   }
 }
 
@@ -675,26 +909,31 @@ int64_t Tage_Histories<TAGE_CONFIG>::compute_path_hash(int64_t path_history, int
 template <class TAGE_CONFIG>
 void Tage<TAGE_CONFIG>::fill_table_indices_tags(uint64_t br_pc, Tage_Prediction_Info<TAGE_CONFIG>* output) const {
   // Generate tags and indices, ignore bank bits for now.
-  for (int i = 1; i <= Tage_Histories<TAGE_CONFIG>::twice_num_histories_; i += 2) {
-    if (tables_enabled_.arr[i] || tables_enabled_.arr[i + 1]) {
-      int max_path_width = (tage_histories_.history_sizes_.arr[(i - 1) / 2] > TAGE_CONFIG::PATH_HISTORY_WIDTH)
-                               ? TAGE_CONFIG::PATH_HISTORY_WIDTH
-                               : tage_histories_.history_sizes_.arr[(i - 1) / 2];
-      int64_t path_hash = tage_histories_.compute_path_hash(tage_histories_.path_history_, max_path_width, i,
-                                                            TAGE_CONFIG::LOG_ENTRIES_PER_BANK);
-      int64_t index = br_pc;
-      index ^= br_pc >> (std::abs(TAGE_CONFIG::LOG_ENTRIES_PER_BANK - i) + 1);
-      index ^= tage_histories_.folded_histories_for_indices_[(i - 1) / 2].get_value();
-      index ^= path_hash;
-      output->indices[i] = index & ((1 << TAGE_CONFIG::LOG_ENTRIES_PER_BANK) - 1);
-
-      int64_t tag = br_pc;
-      tag ^= tage_histories_.folded_histories_for_tags_0_[(i - 1) / 2].get_value();
-      tag ^= tage_histories_.folded_histories_for_tags_1_[(i - 1) / 2].get_value() << 1;
-      output->tags[i] = tag & ((1 << tage_histories_.tag_bits_.arr[(i - 1) / 2]) - 1);
-
-      output->tags[i + 1] = output->tags[i];
-      output->indices[i + 1] = output->indices[i] ^ (output->tags[i] & ((1 << TAGE_CONFIG::LOG_ENTRIES_PER_BANK) - 1));
+  if constexpr (vector_lookup_) {
+    fill_table_indices_tags_vector(br_pc, output);
+  } else {
+    for (int i = 1; i <= Tage_Histories<TAGE_CONFIG>::twice_num_histories_; i += 2) {
+      if (tables_enabled_.arr[i] || tables_enabled_.arr[i + 1]) {
+        int max_path_width = (tage_histories_.history_sizes_.arr[(i - 1) / 2] > TAGE_CONFIG::PATH_HISTORY_WIDTH)
+                                 ? TAGE_CONFIG::PATH_HISTORY_WIDTH
+                                 : tage_histories_.history_sizes_.arr[(i - 1) / 2];
+        int64_t path_hash = tage_histories_.compute_path_hash(tage_histories_.path_history_, max_path_width, i,
+                                                              TAGE_CONFIG::LOG_ENTRIES_PER_BANK);
+        int64_t index = br_pc;
+        index ^= br_pc >> (std::abs(TAGE_CONFIG::LOG_ENTRIES_PER_BANK - i) + 1);
+        index ^= tage_histories_.folded_histories_.get_value(Tage_Histories<TAGE_CONFIG>::INDEX_FOLD, (i - 1) / 2);
+        index ^= path_hash;
+        output->indices[i] = index & ((1 << TAGE_CONFIG::LOG_ENTRIES_PER_BANK) - 1);
+
+        int64_t tag = br_pc;
+        tag ^= tage_histories_.folded_histories_.get_value(Tage_Histories<TAGE_CONFIG>::TAG_0_FOLD, (i - 1) / 2);
+        tag ^= tage_histories_.folded_histories_.get_value(Tage_Histories<TAGE_CONFIG>::TAG_1_FOLD, (i - 1) / 2) << 1;
+        output->tags[i] = tag & ((1 << tage_histories_.tag_bits_.arr[(i - 1) / 2]) - 1);
+
+        output->tags[i + 1] = output->tags[i];
+        output->indices[i + 1] =
+            output->indices[i] ^ (output->tags[i] & ((1 << TAGE_CONFIG::LOG_ENTRIES_PER_BANK) - 1));
+      }
     }
   }
 
@@ -752,6 +991,9 @@ void Tage<TAGE_CONFIG>::update_bimodal(uint64_t br_pc, bool resolve_dir) {
 
 template <class TAGE_CONFIG>
 Matched_Table_Banks Tage<TAGE_CONFIG>::get_two_longest_matching_tables(int indices[], int tags[]) const {
+  if constexpr (vector_lookup_) {
+    return get_two_longest_matching_tables_vector(indices, tags);
+  }
   int first_match = 0;
   int second_match = 0;
   for (int i = 2 * TAGE_CONFIG::NUM_HISTORIES; i > 0; --i) {
@@ -776,4 +1018,97 @@ void Tage<TAGE_CONFIG>::shift_tage_useful_bits(Tagged_Entry* table, int size) {
   }
 }
 
+#if defined(__AVX2__)
+/* Same indices and tags as the scalar loop of fill_table_indices_tags, four
+ * histories per 256-bit vector. Unlike the scalar loop it also fills the
+ * entries of disabled tables and zeroes the padding lanes, so that every lane
+ * of the gathers in get_two_longest_matching_tables_vector reads a valid
+ * entry. */
+template <class TAGE_CONFIG>
+void Tage<TAGE_CONFIG>::fill_table_indices_tags_vector(uint64_t br_pc,
+                                                       Tage_Prediction_Info<TAGE_CONFIG>* output) const {
+  using Lanes = Tage_Lookup_Lanes<TAGE_CONFIG>;
+  constexpr int LOG = TAGE_CONFIG::LOG_ENTRIES_PER_BANK;
+
+  // The folded histories are already in lanes, zero past NUM_HISTORIES.
+  const int64_t* fold_index = tage_histories_.folded_histories_.values(Tage_Histories<TAGE_CONFIG>::INDEX_FOLD);
+  const int64_t* fold_tag_0 = tage_histories_.folded_histories_.values(Tage_Histories<TAGE_CONFIG>::TAG_0_FOLD);
+  const int64_t* fold_tag_1 = tage_histories_.folded_histories_.values(Tage_Histories<TAGE_CONFIG>::TAG_1_FOLD);
+
+  const __m256i pc = _mm256_set1_epi64x(br_pc);
+  const __m256i path = _mm256_set1_epi64x(tage_histories_.path_history_);
+  const __m256i entry_mask = _mm256_set1_epi64x((1 << LOG) - 1);
+  alignas(32) int64_t index[Lanes::NUM_HISTORY_LANES];
+  alignas(32) int64_t tag[Lanes::NUM_HISTORY_LANES];
+  for (int h = 0; h < Lanes::NUM_HISTORY_LANES; h += 4) {
+    auto load = [h](const int64_t* arr) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(&arr[h])); };
+    const __m256i bank = load(lanes_.bank);
+    const __m256i unbank = load(lanes_.unbank);
+    const __m256i rotate = load(lanes_.rotate);
+    auto rotate_left = [&](__m256i x) {
+      __m256i rotated = _mm256_add_epi64(_mm256_and_si256(_mm256_sllv_epi64(x, bank), entry_mask),
+                                         _mm256_srlv_epi64(x, unbank));
+      return _mm256_blendv_epi8(x, rotated, rotate);
+    };
+
+    // compute_path_hash
+    __m256i path_hash = _mm256_and_si256(path, load(lanes_.path_mask));
+    __m256i high = rotate_left(_mm256_srli_epi64(path_hash, LOG));
+    path_hash = rotate_left(_mm256_xor_si256(_mm256_and_si256(path_hash, entry_mask), high));
+
+    __m256i idx = _mm256_xor_si256(pc, _mm256_srlv_epi64(pc, load(lanes_.pc_shift)));
+    idx = _mm256_xor_si256(idx, load(fold_index));
+    idx = _mm256_and_si256(_mm256_xor_si256(idx, path_hash), entry_mask);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&index[h]), idx);
+
+    __m256i tg = _mm256_xor_si256(pc, load(fold_tag_0));
+    tg = _mm256_xor_si256(tg, _mm256_slli_epi64(load(fold_tag_1), 1));
+    tg = _mm256_and_si256(tg, load(lanes_.tag_mask));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&tag[h]), tg);
+  }
+
+  for (int h = 0; h < TAGE_CONFIG::NUM_HISTORIES; ++h) {
+    int i = 2 * h + 1;
+    output->indices[i] = index[h];
+    output->tags[i] = tag[h];
+    output->tags[i + 1] = tag[h];
+    output->indices[i + 1] = index[h] ^ (tag[h] & ((1 << LOG) - 1));
+  }
+  output->indices[0] = 0;
+  output->tags[0] = 0;
+  for (int i = 2 * TAGE_CONFIG::NUM_HISTORIES + 1; i < Lanes::NUM_TABLE_LANES; ++i) {
+    output->indices[i] = 0;
+    output->tags[i] = 0;
+  }
+}
+
+/* Gathers the tags of all tables, eight per vector, and picks the two longest
+ * matching enabled tables from the mask of the compares. */
+template <class TAGE_CONFIG>
+Matched_Table_Banks Tage<TAGE_CONFIG>::get_two_longest_matching_tables_vector(const int indices[],
+                                                                              const int tags[]) const {
+  using Lanes = Tage_Lookup_Lanes<TAGE_CONFIG>;
+  const char* base = reinterpret_cast<const char*>(this);
+  const __m256i entry_size = _mm256_set1_epi32(sizeof(Tagged_Entry));
+
+  uint64_t match = 0;
+  for (int i = 0; i < Lanes::NUM_TABLE_LANES; i += 8) {
+    __m256i idx = _mm256_load_si256(reinterpret_cast<const __m256i*>(&indices[i]));
+    __m256i offset = _mm256_load_si256(reinterpret_cast<const __m256i*>(&table_tag_offsets_[i]));
+    offset = _mm256_add_epi32(offset, _mm256_mullo_epi32(idx, entry_size));
+    __m256i entry_tags = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), offset, 1);
+    __m256i eq = _mm256_cmpeq_epi32(entry_tags, _mm256_load_si256(reinterpret_cast<const __m256i*>(&tags[i])));
+    match |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eq))) << i;
+  }
+  match &= lanes_.enabled_tables;
+
+  if (!match)
+    return Matched_Table_Banks{0, 0};
+  int first_match = 63 - __builtin_clzll(match);
+  match &= ~(uint64_t(1) << first_match);
+  int second_match = match ? 63 - __builtin_clzll(match) : 0;
+  return Matched_Table_Banks{first_match, second_match};
+}
+#endif
+
 #endif  // __TAGE_H_
@@ -19,6 +19,8 @@
  * SOFTWARE.
  */
 
+#include "libs/table_alloc.h"
+
 #include "statistical_corrector.h"
 #include "tage.h"
 #include "tagescl_configs.h"
@@ -36,6 +38,11 @@ struct Tage_SC_L_Prediction_Info {
 
 class Tage_SC_L_Base {
  public:
+  // The tables are members of the predictor, so whole predictors come from table_alloc.
+  static void* operator new(size_t size) { return table_alloc("tagescl", size); }
+  static void operator delete(void* ptr, size_t size) { table_free("tagescl", ptr, size); }
+  virtual ~Tage_SC_L_Base() {}
+
   virtual int64_t get_new_branch_id() = 0;
   virtual bool get_prediction(int64_t branch_id, uint64_t br_pc) = 0;
   virtual void update_speculative_state(int64_t branch_id, uint64_t br_pc, Branch_Type br_type, bool branch_dir,
@@ -46,6 +53,10 @@ class Tage_SC_L_Base {
   virtual void flush_branch_and_repair_state(int64_t branch_id, uint64_t br_pc, Branch_Type br_type, bool resolve_dir,
                                              uint64_t br_target) = 0;
   virtual bool is_full() = 0;
+
+  // Warm state checkpoints of the whole predictor (see State_Writer).
+  virtual std::vector<uint8_t> save_state() = 0;
+  virtual bool load_state(const void* data, uint64_t size) = 0;
 };
 
 /* Interface functions:
@@ -84,6 +95,18 @@ class Tage_SC_L : public Tage_SC_L_Base {
     return prediction_info_buffer_.is_full();
   }
 
+  std::vector<uint8_t> save_state() override {
+    State_Writer writer;
+    serialize(writer);
+    return writer.bytes();
+  }
+
+  bool load_state(const void* data, uint64_t size) override {
+    State_Reader reader(data, size);
+    serialize(reader);
+    return reader.ok();
+  }
+
   // It uses the speculative state of the predictor to generate a prediction.
   // Should be called before update_speculative_state.
   bool get_prediction(int64_t branch_id, uint64_t br_pc) override;
@@ -118,6 +141,16 @@ class Tage_SC_L : public Tage_SC_L_Base {
                                      uint64_t br_target) override;
 
  private:
+  template <class Archive>
+  void serialize(Archive& ar) {
+    ar.io(random_number_gen_.seed_);
+    tage_.serialize(ar);
+    statistical_corrector_.serialize(ar);
+    loop_predictor_.serialize(ar);
+    ar.io(loop_predictor_beneficial_);
+    prediction_info_buffer_.serialize(ar);
+  }
+
   Random_Number_Generator random_number_gen_;
   Tage<typename CONFIG::TAGE> tage_;
   Statistical_Corrector<CONFIG> statistical_corrector_;
@@ -48,6 +48,7 @@ struct TAGE_SC_L_CONFIG_64KB {
     static constexpr int ALT_SELECTOR_ENTRY_WIDTH = 5;
     static constexpr int BIMODAL_HYSTERESIS_SHIFT = 2;
     static constexpr int BIMODAL_LOG_TABLES_SIZE = 13;
+    static constexpr bool VECTOR_LOOKUP = true;
   };
 
   struct LOOP {
@@ -156,6 +157,7 @@ struct TAGE_SC_L_CONFIG_80KB {
     static constexpr int ALT_SELECTOR_ENTRY_WIDTH = 5;
     static constexpr int BIMODAL_HYSTERESIS_SHIFT = 2;
     static constexpr int BIMODAL_LOG_TABLES_SIZE = 13;
+    static constexpr bool VECTOR_LOOKUP = true;
   };
 
   struct LOOP {
@@ -23,6 +23,9 @@
 #define __TAGE_SC_L_LIB_H_
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
 inline int get_min_num_bits_to_represent(int x) {
   assert(x > 0);
@@ -141,6 +144,99 @@ class Random_Number_Generator {
   int64_t* ptghist_ptr_;
 };
 
+/* Warm state checkpoints: each class holding predictor state has a
+ * serialize(Archive&) member template that passes its state members to
+ * Archive::io() (or to their own serialize()). Members fixed at construction,
+ * such as sizes, masks and pointers between components, are left out. The
+ * same serialize() both saves (State_Writer) and restores (State_Reader). */
+class State_Writer {
+ public:
+  template <typename T>
+  void io(const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    bytes_.insert(bytes_.end(), bytes, bytes + sizeof(T));
+  }
+
+  template <typename T>
+  void io(const std::vector<T>& values) {
+    io(static_cast<uint64_t>(values.size()));
+    for (const T& value : values) {
+      io(value);
+    }
+  }
+
+  void io(const std::vector<bool>& values) {
+    io(static_cast<uint64_t>(values.size()));
+    for (bool value : values) {
+      io(static_cast<uint8_t>(value));
+    }
+  }
+
+  const std::vector<uint8_t>& bytes() const {
+    return bytes_;
+  }
+
+ private:
+  std::vector<uint8_t> bytes_;
+};
+
+class State_Reader {
+ public:
+  State_Reader(const void* data, uint64_t size)
+      : cur_(static_cast<const uint8_t*>(data)), end_(cur_ + size), ok_(true) {}
+
+  template <typename T>
+  void io(T& value) {
+    if (!take(sizeof(T))) return;
+    memcpy(&value, cur_ - sizeof(T), sizeof(T));
+  }
+
+  // Vectors are sized by the configuration, so a different size is a
+  // mismatch rather than something to resize to.
+  template <typename T>
+  void io(std::vector<T>& values) {
+    if (!check_size(values.size())) return;
+    for (T& value : values) {
+      io(value);
+    }
+  }
+
+  void io(std::vector<bool>& values) {
+    if (!check_size(values.size())) return;
+    for (size_t i = 0; i < values.size(); ++i) {
+      uint8_t value = 0;
+      io(value);
+      values[i] = value;
+    }
+  }
+
+  // True if the state was read completely and matched the configuration.
+  bool ok() const {
+    return ok_ && cur_ == end_;
+  }
+
+ private:
+  bool take(uint64_t size) {
+    if (!ok_ || static_cast<uint64_t>(end_ - cur_) < size) {
+      ok_ = false;
+      return false;
+    }
+    cur_ += size;
+    return true;
+  }
+
+  bool check_size(uint64_t expected) {
+    uint64_t size = 0;
+    io(size);
+    if (size != expected) ok_ = false;
+    return ok_;
+  }
+
+  const uint8_t* cur_;
+  const uint8_t* end_;
+  bool ok_;
+};
+
 struct Branch_Type {
   bool is_conditional;
   bool is_indirect;
@@ -193,6 +289,14 @@ class Circular_Buffer {
     return false;
   }
 
+  // Only the ids are saved; a checkpoint is taken with no entries in flight.
+  template <class Archive>
+  void serialize(Archive& ar) {
+    ar.io(back_);
+    ar.io(front_);
+    ar.io(size_);
+  }
+
  private:
   std::vector<T> buffer_;
   int64_t buffer_size_;
@@ -0,0 +1,218 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : bp_only_model.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Model that streams the on-path control-flow ops straight into the
+ *                branch predictor (no pipeline, cache or memory modeling)
+ ***************************************************************************************/
+
+#include "bp_only_model.h"
+
+#include <time.h>
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "bp/bp.param.h"
+#include "core.param.h"
+#include "general.param.h"
+#include "prefetcher/pref.param.h"
+
+#include "frontend/frontend.h"
+
+#include "freq.h"
+#include "model.h"
+#include "sim.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Global variables */
+
+Bp_Only_Model bp_only_model;
+
+/* the ops never outlive one call to bp_only_process_op, so a single op is reused */
+static Op bp_only_op;
+static Table_Info bp_only_table_info;
+static Inst_Info bp_only_inst_info;
+static struct timespec bp_only_start_time;
+
+/**************************************************************************************/
+/* bp_only_process_op: runs a control-flow op through prediction, resolution,
+ * recovery and retirement back to back, in the order the cmp model's warmup uses. */
+
+static void bp_only_process_op(Bp_Data* bp_data, Op* op) {
+  if (op->table_info->cf_type == NOT_CF)
+    return;
+
+  bp_predict_op(bp_data, op, 1, op->inst_info->addr);
+  bp_target_known_op(bp_data, op);
+  bp_resolve_op(bp_data, op);
+  if (op->oracle_info.mispred || op->oracle_info.misfetch)
+    bp_recover_op(bp_data, op->table_info->cf_type, &op->recovery_info);
+  bp_retire_op(bp_data, op);
+
+  STAT_EVENT(op->proc_id, BP_ONLY_CORRECT + op->oracle_info.mispred + 2 * op->oracle_info.misfetch);
+}
+
+/**************************************************************************************/
+/* bp_only_init */
+
+void bp_only_init(uns mode) {
+  if (mode == SIMULATION_MODE) {
+    clock_gettime(CLOCK_MONOTONIC, &bp_only_start_time);
+    return;
+  }
+
+  /* as in the cmp model, the real initialization is done in warmup */
+  ASSERT(0, mode == WARMUP_MODE);
+  ASSERTM(0, !DUMB_CORE_ON, "The bp_only model cannot run next to a dumb core\n");
+  ASSERTM(0, !CONFIDENCE_ENABLE && !FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE,
+          "The bp_only model has no decoupled frontend for CONFIDENCE_ENABLE or FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE\n");
+  ASSERTM(0, BP_ONLY_INSTS_PER_CYCLE > 0, "BP_ONLY_INSTS_PER_CYCLE must be positive\n");
+
+  freq_init();
+
+  bp_only_model.bp_recovery_info = (Bp_Recovery_Info*)calloc(NUM_CORES, sizeof(Bp_Recovery_Info));
+  bp_only_model.bp_data = (Bp_Data*)calloc(NUM_CORES, sizeof(Bp_Data));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    init_bp_recovery_info(proc_id, &bp_only_model.bp_recovery_info[proc_id]);
+    init_bp_data(proc_id, &bp_only_model.bp_data[proc_id]);
+  }
+
+  bp_only_op.table_info = &bp_only_table_info;
+  bp_only_op.inst_info = &bp_only_inst_info;
+  bp_only_op.mbp7_info = NULL;
+}
+
+/**************************************************************************************/
+/* bp_only_reset: the model keeps no state besides the branch predictor */
+
+void bp_only_reset(void) {
+}
+
+/**************************************************************************************/
+/* bp_only_cycle: streams up to BP_ONLY_INSTS_PER_CYCLE instructions of each core
+ * through its branch predictor. The ops are retired right after they are fetched,
+ * so a "cycle" only paces the main loop and its cycle count means nothing. */
+
+void bp_only_cycle(void) {
+  Op* op = &bp_only_op;
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (retired_exit[proc_id] || sim_done[proc_id])
+      continue;
+
+    Bp_Data* bp_data = &bp_only_model.bp_data[proc_id];
+    set_bp_data(bp_data);
+    set_bp_recovery_info(&bp_only_model.bp_recovery_info[proc_id]);
+
+    for (uns insts = 0; insts < BP_ONLY_INSTS_PER_CYCLE && !retired_exit[proc_id];) {
+      frontend_fetch_op(proc_id, op);
+      op_count[proc_id]++;
+      uop_count[proc_id]++;
+      STAT_EVENT(proc_id, NODE_UOP_COUNT);
+
+      bp_only_process_op(bp_data, op);
+
+      if (op->exit)
+        retired_exit[proc_id] = TRUE;
+      if (op->eom) {
+        inst_count[proc_id]++;
+        inst_count_fetched[proc_id]++;
+        STAT_EVENT(proc_id, NODE_INST_COUNT);
+        frontend_retire(proc_id, op->inst_uid);
+        insts++;
+        /* stop exactly at the limit so that the stats match the cmp model's */
+        if (INST_LIMIT && inst_count[proc_id] >= inst_limit[proc_id])
+          break;
+      }
+    }
+  }
+}
+
+/**************************************************************************************/
+/* bp_only_debug: nothing is in flight between cycles */
+
+void bp_only_debug(void) {
+}
+
+/**************************************************************************************/
+/* bp_only_per_core_done: */
+
+void bp_only_per_core_done(uns8 proc_id) {
+  Counter correct = GET_TOTAL_STAT_EVENT(proc_id, BP_ONLY_CORRECT);
+  Counter mispred = GET_TOTAL_STAT_EVENT(proc_id, BP_ONLY_MISPREDICT);
+  Counter misfetch = GET_TOTAL_STAT_EVENT(proc_id, BP_ONLY_MISFETCH);
+  Counter cfs = correct + mispred + misfetch;
+
+  fprintf(mystdout, "** Core %u bp_only: %llu insts, %llu control-flow ops, %.3f mispredict MPKI, %.3f misfetch MPKI\n",
+          proc_id, inst_count[proc_id], cfs, inst_count[proc_id] ? 1000.0 * mispred / inst_count[proc_id] : 0.0,
+          inst_count[proc_id] ? 1000.0 * misfetch / inst_count[proc_id] : 0.0);
+}
+
+/**************************************************************************************/
+/* bp_only_done: reports the simulation speed, the figure of merit of this model */
+
+void bp_only_done(void) {
+  struct timespec now;
+  Counter insts = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double secs = (now.tv_sec - bp_only_start_time.tv_sec) + (now.tv_nsec - bp_only_start_time.tv_nsec) / 1e9;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    insts += inst_count[proc_id];
+  fprintf(mystdout, "** bp_only: %llu insts in %.2f seconds (%.2f MIPS)\n", insts, secs,
+          secs > 0 ? insts / secs / 1e6 : 0.0);
+}
+
+/**************************************************************************************/
+/* bp_only_warmup: warms up the branch predictor exactly like the simulation does */
+
+void bp_only_warmup(Op* op) {
+  set_bp_data(&bp_only_model.bp_data[op->proc_id]);
+  set_bp_recovery_info(&bp_only_model.bp_recovery_info[op->proc_id]);
+  bp_only_process_op(&bp_only_model.bp_data[op->proc_id], op);
+}
+
+/**************************************************************************************/
+/* bp_only_save_warm_state: */
+
+void bp_only_save_warm_state(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    bp_save_warm_state(&bp_only_model.bp_data[proc_id]);
+}
+
+/**************************************************************************************/
+/* bp_only_load_warm_state: */
+
+void bp_only_load_warm_state(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    bp_load_warm_state(&bp_only_model.bp_data[proc_id]);
+}
@@ -0,0 +1,64 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : bp_only_model.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Model that streams the on-path control-flow ops straight into the
+ *                branch predictor (no pipeline, cache or memory modeling)
+ ***************************************************************************************/
+
+#ifndef __BP_ONLY_MODEL_H__
+#define __BP_ONLY_MODEL_H__
+
+#include "bp/bp.h"
+
+/**************************************************************************************/
+/* bp only model data  */
+
+typedef struct Bp_Only_Model_struct {
+  Bp_Recovery_Info* bp_recovery_info;
+  Bp_Data* bp_data;
+} Bp_Only_Model;
+
+/**************************************************************************************/
+/* Global vars */
+
+extern Bp_Only_Model bp_only_model;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void bp_only_init(uns mode);
+void bp_only_reset(void);
+void bp_only_cycle(void);
+void bp_only_debug(void);
+void bp_only_per_core_done(uns8);
+void bp_only_done(void);
+void bp_only_warmup(Op*);
+void bp_only_save_warm_state(void);
+void bp_only_load_warm_state(void);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __BP_ONLY_MODEL_H__ */
@@ -30,11 +30,15 @@
 
 #include "cmp_model.h"
 
+#include <pthread.h>
+
 #include "globals/assert.h"
 
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/host_prof.h"
+#include "debug/sim_probe.h"
 
 #include "bp/bp.param.h"
 #include "core.param.h"
@@ -46,23 +50,35 @@
 #include "dvfs/dvfs.h"
 #include "dvfs/perf_pred.h"
 #include "memory/cache_part.h"
-#include "prefetcher/D_JOLT.h"
-#include "prefetcher/FNL+MMA.h"
-#include "prefetcher/eip.h"
 #include "prefetcher/fdip.h"
+#include "prefetcher/iprefetch.h"
 #include "prefetcher/pref_common.h"
 
+#include "frontend/frontend.h"
+#include "frontend/frontend_intf.h"
+
+#include "adaptive_warmup.h"
+#include "crit_path.h"
 #include "decoupled_frontend.h"
+#include "fork_sweep.h"
+#include "host_placement.h"
 #include "freq.h"
 #include "ft.h"
 #include "idq_stage.h"
 #include "lsq.h"
 #include "map_rename.h"
+#include "mem_replay_model.h"
+#include "node_issue_queue.h"
 #include "op_pool.h"
+#include "optimizer2.h"
+#include "retire_stream.h"
 #include "sim.h"
+#include "smt.h"
 #include "statistics.h"
+#include "tlb.h"
 #include "topdown.h"
 #include "uop_queue_stage.h"
+#include "warm_state.h"
 
 /**************************************************************************************/
 /* Global vars */
@@ -78,7 +94,130 @@ static void cmp_redirect(void);
 static void cmp_measure_chip_util(void);
 static void cmp_istreams(void);
 static void cmp_cores(void);
-static void warmup_uncore(uns proc_id, Addr addr, Flag write);
+static void cmp_core_cycle(uns proc_id);
+static void cmp_parallel_init(void);
+static void cmp_parallel_done(void);
+static void cmp_parallel_cores(void);
+static void* cmp_parallel_worker(void* arg);
+static void cmp_slack_cores(void);
+static void* cmp_slack_worker(void* arg);
+static void cmp_istream(uns proc_id);
+static void cmp_ordered_begin(uns proc_id);
+static void cmp_ordered_end(uns proc_id);
+static void cmp_ordered_finish(uns proc_id);
+static void cmp_skip_init(void);
+static Flag cmp_skip_cycle(Core_Context* ctx);
+static void cmp_skip_probe_begin(Core_Context* ctx);
+static void cmp_skip_probe_end(Core_Context* ctx);
+static void cmp_watch_warmup_caches(void);
+
+/**************************************************************************************/
+/* Parallel core simulation (PARALLEL_CORES)
+ *
+ * Every core's pipeline is run by its own worker thread, while the uncore
+ * (update_memory) and the recovery/redirect pass stay on the main thread and
+ * separate the cycles with a barrier.  Stages that touch state shared between
+ * cores (memory system, frontends, uop queue) are run inside ordered
+ * sections: the k-th section of core i is entered only after every
+ * lower-numbered core has left its k-th section and every higher-numbered
+ * core has left its (k-1)-th section, or has finished the cycle.  The order of
+ * shared accesses is therefore a function of the simulated state only, which
+ * keeps parallel runs deterministic.  Core-private stages run concurrently.
+ *
+ * With PARALLEL_SLACK = S the cores are not kept in lockstep.  The main thread
+ * runs the uncore, and while it waits for every core to finish its cycle of the
+ * current time, each worker may run its core up to S cycles further.  A worker
+ * running ahead sees the time of its own cycle (freq_set_local_cycle), so the
+ * memory requests it sends are timestamped with that time and the uncore
+ * starts them in timestamp order.  Fills, on the other hand, reach a core that
+ * is ahead late, and the ordered sections become a plain mutex, so slack runs
+ * are not deterministic.  SLACK_AHEAD_CYCLES and SLACK_LATE_FILL_CYCLES measure
+ * the skew.
+ */
+
+#define CMP_ORDERED_BEGIN(proc_id) \
+  do {                             \
+    if (PARALLEL_CORES)            \
+      cmp_ordered_begin(proc_id);  \
+  } while (0)
+
+#define CMP_ORDERED_END(proc_id) \
+  do {                           \
+    if (PARALLEL_CORES)          \
+      cmp_ordered_end(proc_id);  \
+  } while (0)
+
+typedef struct Cmp_Parallel_struct {
+  pthread_t* workers;
+  pthread_barrier_t cycle_start;
+  pthread_barrier_t cycle_end;
+  pthread_mutex_t lock;
+  pthread_cond_t turn_changed;
+
+  Flag* ready;          /* core simulates this cycle */
+  Flag* active;         /* core simulates this cycle and has not finished */
+  Counter* core_cycle;  /* cycle_count of each ready core */
+  Counter sim_time;     /* sim_time of this cycle */
+  uns* section;         /* index of the next ordered section of each core */
+  uns turn_proc_id;     /* core that may enter an ordered section next */
+  uns turn_section;     /* ...and the section index it has to enter */
+  Flag shutdown;
+
+  /* PARALLEL_SLACK: the workers sleep on slack_go while they may not run a cycle,
+     and the main thread on slack_progress until all cores reached the uncore time */
+  pthread_mutex_t shared_lock; /* replaces the ordered sections */
+  pthread_cond_t slack_go;
+  pthread_cond_t slack_progress;
+  Counter* next_cycle;  /* next cycle of each core to simulate */
+  Counter* limit_cycle; /* last cycle of each core that may be simulated now */
+  Counter* uncore_cycle; /* cycle of each core at the uncore time of the last step */
+  Flag window_open;     /* the main thread waits, so the workers may run */
+  uns busy;             /* workers in the middle of a cycle */
+} Cmp_Parallel;
+
+static Cmp_Parallel cmp_parallel;
+
+/**************************************************************************************/
+/* Stalled-cycle skipping (SKIP_STALLED_CYCLES)
+ *
+ * A core whose last cycle changed nothing (no fetch, issue or retire), whose
+ * ROB only holds ops waiting on the memory system or on other ops, and that has
+ * no recovery, redirect or op completion scheduled keeps repeating the same
+ * cycle until the memory system hands it something.  Such a core runs one more
+ * cycle with its stats snapshotted (the probe) and is then skipped: each
+ * skipped cycle adds the stat increments of the probe cycle instead of running
+ * the stages.  The core resumes as soon as a request enters or leaves the
+ * memory system (Memory.event_count) or the earliest scheduled event is due.
+ * Failed probes back off exponentially so busy cores pay almost nothing.
+ */
+
+#define CMP_SKIP_SIG_SIZE 8
+#define CMP_SKIP_MAX_BACKOFF 1024
+
+typedef struct Cmp_Skip_struct {
+  Counter sig[CMP_SKIP_SIG_SIZE]; /* progress signature at the end of the last cycle */
+  Flag stalled;                    /* the last cycle left the signature unchanged */
+  Flag probing;                    /* the current cycle is a probe */
+  Flag skipping;
+  Counter skip_until;  /* core cycle of the earliest scheduled event */
+  Counter mem_events;  /* Memory.event_count at the start of the probe */
+  Counter probe_until; /* no new probe before this cycle */
+  uns backoff;
+
+  Stat_Value* snapshot; /* stats of the core before the probe */
+  uns* delta_stat;      /* stats changed by the probe... */
+  Counter* delta_count; /* ...and by how much */
+  double* delta_value;  /* (FLOAT_TYPE_STAT) */
+  uns num_deltas;
+
+  uns ret_stall_length; /* node stage stall counters before the probe... */
+  uns mem_block_length;
+  uns ret_stall_delta; /* ...and their per-cycle increments */
+  uns mem_block_delta;
+} Cmp_Skip;
+
+static Cmp_Skip* cmp_skip;
+static Counter cmp_skip_mem_events; /* Memory.event_count after update_memory */
 
 /**************************************************************************************/
 /* cmp_init */
@@ -91,6 +230,23 @@ void cmp_init(uns mode) {
       ASSERT(0, cmp_model.memory.uncores[0].l1->cache.repl_policy == REPL_PARTITION);
       cmp_model.memory.uncores[0].l1->cache.repl_policy = REPL_TRUE_LRU;
     }
+    /* a FORK_SWEEP child may have resized the back end: it is empty after warmup,
+       so it is rebuilt, while the warmed caches and predictors are kept */
+    if (fork_sweep_child) {
+      POWER_NUM_ALUS = POWER_NUM_MULS_AND_DIVS = POWER_NUM_FPUS = 0; /* counted again by init_exec_ports */
+      for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+        cmp_set_all_stages(proc_id);
+        cmp_init_thread_data(proc_id);
+        init_map_stage(proc_id, "MAP");
+        init_node_stage(proc_id, "NODE");
+        init_lsq(proc_id, "LSQ");
+        init_exec_stage(proc_id, "EXEC");
+        init_exec_ports(proc_id, "EXEC_PORTS");
+      }
+      cmp_model.window_size = NODE_TABLE_SIZE;
+    }
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      mem_l1_lines_changed(proc_id);
     return;
   }
 
@@ -100,7 +256,7 @@ void cmp_init(uns mode) {
    */
   ASSERT(0, mode == WARMUP_MODE);
 
-  uns8 proc_id;
+  uns proc_id;
 
   freq_init();
   cmp_init_cmp_model();
@@ -121,6 +277,10 @@ void cmp_init(uns mode) {
     init_exec_stage(proc_id, "EXEC");
     init_exec_ports(proc_id, "EXEC_PORTS");
     init_dcache_stage(proc_id, "DCACHE");
+    init_tlb(proc_id);
+    topdown_init(proc_id);
+    if (CRIT_PATH)
+      crit_path_init(proc_id);
 
     /* initialize the common data structures */
     init_bp_recovery_info(proc_id, &cmp_model.bp_recovery_info[proc_id]);
@@ -128,10 +288,7 @@ void cmp_init(uns mode) {
 
     init_decoupled_fe(proc_id, "DCFE");
 
-    init_fdip(proc_id);
-    init_eip(proc_id);
-    init_djolt(proc_id);
-    init_fnlmma(proc_id);
+    init_iprefetch(proc_id);
   }
 
   cmp_model.window_size = NODE_TABLE_SIZE;
@@ -149,13 +306,36 @@ void cmp_init(uns mode) {
   ASSERTM(0, !USE_LATE_BP || LATE_BP_LATENCY < (DECODE_CYCLES + MAP_CYCLES),
           "Late branch prediction latency should be less than the total "
           "latency of the frontend stages of the pipeline (decode + map)");
+
+  if (PARALLEL_CORES)
+    cmp_parallel_init();
+  if (SKIP_STALLED_CYCLES)
+    cmp_skip_init();
+  if (SMT_THREADS > 1)
+    smt_init();
+  if (ADAPTIVE_WARMUP_INTERVAL)
+    cmp_watch_warmup_caches();
+}
+
+/**************************************************************************************/
+/* cmp_watch_warmup_caches: the caches cmp_warmup fills, for ADAPTIVE_WARMUP_INTERVAL */
+
+static void cmp_watch_warmup_caches(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    adaptive_warmup_watch_cache(WARMUP_SIGNAL_ICACHE, &cmp_model.icache_stage[proc_id].icache);
+    adaptive_warmup_watch_cache(WARMUP_SIGNAL_DCACHE, &cmp_model.dcache_stage[proc_id].dcache);
+    if (L1_SLICES == 1)
+      adaptive_warmup_watch_cache(WARMUP_SIGNAL_L1, &cmp_model.memory.uncores[proc_id].l1->cache);
+  }
+  for (uns slice = 0; L1_SLICES > 1 && slice < L1_SLICES; slice++)
+    adaptive_warmup_watch_cache(WARMUP_SIGNAL_L1, &cmp_model.memory.l1_slices[slice]->cache);
 }
 
 /**************************************************************************************/
 /* cmp_reset: */
 
 void cmp_reset() {
-  uns8 proc_id;
+  uns proc_id;
 
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     cmp_set_all_stages(proc_id);
@@ -169,96 +349,182 @@ void cmp_reset() {
     reset_dcache_stage();
   }
   reset_memory();
+
+  if (SKIP_STALLED_CYCLES) {
+    for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      cmp_skip[proc_id].stalled = FALSE;
+      cmp_skip[proc_id].skipping = FALSE;
+    }
+  }
 }
 
 /**************************************************************************************/
 /* cmp_cycle: */
 
 void cmp_cycle() {
+  SIM_PROBE1(cycle_begin, cycle_count);
+  host_prof_cycle();
   cmp_istreams();
 
   /* Frequency domain checking is inside this function, since it
    * handles both shared cache and memory */
+  uns64 prof_t = host_prof_now();
   update_memory();
+  prof_t = host_prof_lap(HOST_PROF_UNCORE_ROW, HOST_PROF_MEMORY, prof_t);
+  cmp_skip_mem_events = cmp_model.memory.event_count;
 
+  if (SMT_THREADS > 1)
+    smt_cycle();
   cmp_cores();
 
+  prof_t = host_prof_now();
   if (DVFS_ON)
     dvfs_cycle();
   cache_part_update();
+  opt2_client_cycle();
+  host_prof_lap(HOST_PROF_UNCORE_ROW, HOST_PROF_UNCORE, prof_t);
+  SIM_PROBE1(cycle_end, cycle_count);
 }
 
 void cmp_istreams(void) {
+  // slack workers recover and redirect their cores at the start of each of their cycles
+  if (PARALLEL_CORES && PARALLEL_SLACK)
+    return;
+
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     if (DUMB_CORE_ON && DUMB_CORE == proc_id)
       continue;
 
     if (freq_is_ready(FREQ_DOMAIN_CORES[proc_id])) {
       cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
-
-      set_bp_recovery_info(&cmp_model.bp_recovery_info[proc_id]);
-      if (cycle_count >= bp_recovery_info->recovery_cycle) {
-        set_bp_data(&cmp_model.bp_data[proc_id]);
-        cmp_set_all_stages(proc_id);
-        cmp_recover();
-      }
-      if (cycle_count >= bp_recovery_info->redirect_cycle) {
-        set_icache_stage(&cmp_model.icache_stage[proc_id]);
-        ASSERT(proc_id, proc_id == bp_recovery_info->redirect_op->proc_id);
-        ASSERT_PROC_ID_IN_ADDR(proc_id, bp_recovery_info->redirect_op->oracle_info.pred_npc);
-        cmp_redirect();
-      }
+      cmp_istream(proc_id);
     }
   }
 }
 
+/* Recovers and redirects a core whose recovery or redirect is due at cycle_count */
+static void cmp_istream(uns proc_id) {
+  set_bp_recovery_info(&cmp_model.bp_recovery_info[proc_id]);
+  if (cycle_count >= bp_recovery_info->recovery_cycle) {
+    uns64 prof_t = host_prof_now();
+    set_bp_data(&cmp_model.bp_data[proc_id]);
+    cmp_set_all_stages(proc_id);
+    cmp_recover();
+    host_prof_lap(proc_id, HOST_PROF_RECOVER, prof_t);
+  }
+  if (cycle_count >= bp_recovery_info->redirect_cycle) {
+    uns64 prof_t = host_prof_now();
+    set_icache_stage(&cmp_model.core_context[proc_id]);
+    ASSERT(proc_id, proc_id == bp_recovery_info->redirect_op->proc_id);
+    ASSERT_PROC_ID_IN_ADDR(proc_id, bp_recovery_info->redirect_op->oracle_info.pred_npc);
+    cmp_redirect();
+    host_prof_lap(proc_id, HOST_PROF_REDIRECT, prof_t);
+  }
+}
+
 void cmp_cores(void) {
+  if (PARALLEL_CORES) {
+    if (PARALLEL_SLACK)
+      cmp_slack_cores();
+    else
+      cmp_parallel_cores();
+    return;
+  }
+
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     if (DUMB_CORE_ON && DUMB_CORE == proc_id)
       continue;
 
     if (freq_is_ready(FREQ_DOMAIN_CORES[proc_id])) {
       cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+      cmp_core_cycle(proc_id);
+    }
+  }
+}
 
-      set_bp_data(&cmp_model.bp_data[proc_id]);
-      set_bp_recovery_info(&cmp_model.bp_recovery_info[proc_id]);
-      cmp_set_all_stages(proc_id);
-
-      /* Back-end pipeline */
-      update_dcache_stage(&exec->sd);
-      update_exec_stage(&node->sd);
-      update_node_stage(map->last_sd);
-      update_map_stage(idq_stage_get_stage_data());
-
-      if (UOP_CACHE_ENABLE) {
-        /* IDQ stage that bridges the front-end and back-end */
-        /* This stage can get uops from the uc->sd, cache queue, or decoder. */
-        update_idq_stage(dec->last_sd, &uc->sd, uop_queue_stage_get_latest_sd());
-
-        /* Front-end pipiline */
-        update_uop_queue_stage(&uc->sd);
-      } else {
-        update_idq_stage(dec->last_sd, NULL, NULL);
-        update_uop_queue_stage(NULL);
-      }
-      update_decode_stage(&ic->sd);
-      update_icache_stage();
-
-      /* Decoupled branch prediction and prefetching */
-      update_decoupled_fe();
-      update_fdip();
-      update_eip();
+/* Runs one cycle of the pipeline of a core.  In parallel mode this is called
+ * from the worker thread of the core. */
+static void cmp_core_cycle(uns proc_id) {
+  Core_Context* ctx = &cmp_model.core_context[proc_id];
+  cmp_set_core_context(ctx);
+
+  /* a finished core only replays its memory requests (cmp_init_bogus_replay) */
+  if (BOGUS_REPLAY && bogus_replay_active(proc_id)) {
+    CMP_ORDERED_BEGIN(proc_id);
+    bogus_replay_cycle(proc_id);
+    CMP_ORDERED_END(proc_id);
+    return;
+  }
 
+  if (SKIP_STALLED_CYCLES) {
+    if (cmp_skip_cycle(ctx)) {
+      CMP_ORDERED_BEGIN(proc_id);
       cmp_measure_chip_util();
+      CMP_ORDERED_END(proc_id);
+      return;
     }
+    cmp_skip_probe_begin(ctx);
+  }
+
+  /* Back-end pipeline */
+  SIM_PROBE2(core_cycle_begin, proc_id, cycle_count);
+  uns64 prof_t = host_prof_now();
+  CMP_ORDERED_BEGIN(proc_id);
+  update_dcache_stage(ctx, &ctx->exec->sd);
+  CMP_ORDERED_END(proc_id);
+  prof_t = host_prof_lap(proc_id, HOST_PROF_DCACHE, prof_t);
+  update_exec_stage(ctx, &ctx->node->sd);
+  prof_t = host_prof_lap(proc_id, HOST_PROF_EXEC, prof_t);
+  CMP_ORDERED_BEGIN(proc_id);
+  update_node_stage(ctx, ctx->map->last_sd);
+  CMP_ORDERED_END(proc_id);
+  prof_t = host_prof_lap(proc_id, HOST_PROF_NODE, prof_t);
+  update_map_stage(ctx, idq_stage_get_stage_data());
+  prof_t = host_prof_lap(proc_id, HOST_PROF_MAP, prof_t);
+
+  if (UOP_CACHE_ENABLE) {
+    /* IDQ stage that bridges the front-end and back-end */
+    /* This stage can get uops from the uc->sd, cache queue, or decoder. */
+    /* The uop queue is shared by all cores, so both stages are ordered. */
+    CMP_ORDERED_BEGIN(proc_id);
+    update_idq_stage(ctx, ctx->dec->last_sd, &ctx->uc->sd, uop_queue_stage_get_latest_sd());
+    prof_t = host_prof_lap(proc_id, HOST_PROF_IDQ, prof_t);
+
+    /* Front-end pipiline */
+    update_uop_queue_stage(ctx, &ctx->uc->sd);
+    CMP_ORDERED_END(proc_id);
+  } else {
+    update_idq_stage(ctx, ctx->dec->last_sd, NULL, NULL);
+    prof_t = host_prof_lap(proc_id, HOST_PROF_IDQ, prof_t);
+    CMP_ORDERED_BEGIN(proc_id);
+    update_uop_queue_stage(ctx, NULL);
+    CMP_ORDERED_END(proc_id);
   }
+  prof_t = host_prof_lap(proc_id, HOST_PROF_UOP_QUEUE, prof_t);
+  update_decode_stage(ctx, &ctx->ic->sd);
+  prof_t = host_prof_lap(proc_id, HOST_PROF_DECODE, prof_t);
+
+  CMP_ORDERED_BEGIN(proc_id);
+  update_icache_stage(ctx);
+  prof_t = host_prof_lap(proc_id, HOST_PROF_ICACHE, prof_t);
+
+  /* Decoupled branch prediction and prefetching */
+  update_decoupled_fe(ctx);
+  prof_t = host_prof_lap(proc_id, HOST_PROF_DECOUPLED_FE, prof_t);
+  update_iprefetch(ctx, prof_t);
+
+  cmp_measure_chip_util();
+  CMP_ORDERED_END(proc_id);
+
+  if (SKIP_STALLED_CYCLES)
+    cmp_skip_probe_end(ctx);
 }
 
 /**************************************************************************************/
 /* cmp_debug: */
 
 void cmp_debug() {
-  uns8 proc_id;
+  uns proc_id;
 
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
@@ -285,8 +551,11 @@ void cmp_debug() {
 /* cmp_done: */
 
 void cmp_done() {
+  if (PARALLEL_CORES)
+    cmp_parallel_done();
   if (PREF_FRAMEWORK_ON)
     pref_done();
+  opt2_client_done();
   if (DVFS_ON)
     dvfs_done();
 
@@ -307,6 +576,7 @@ void cmp_done() {
 
 void cmp_per_core_done(uns8 proc_id) {
   topdown_done(proc_id);
+  crit_path_done(proc_id);
   stats_per_core_collect(proc_id);
   if (PREF_FRAMEWORK_ON)
     pref_per_core_done(proc_id);
@@ -318,7 +588,7 @@ void cmp_wake(Op* src_op, Op* dep_op, uns8 rdy_bit) {
   /* Make the op independent, if it is dependent on a BOGUS op */
 
   // cmp: since this function use node, we need to set node properly
-  set_node_stage(&cmp_model.node_stage[src_op->proc_id]);
+  set_node_stage(&cmp_model.core_context[src_op->proc_id]);
 
   ASSERTM(src_op->proc_id, src_op->proc_id == dep_op->proc_id, "src id: %i, dep id: %i\n", src_op->proc_id,
           dep_op->proc_id);
@@ -337,9 +607,7 @@ void cmp_wake(Op* src_op, Op* dep_op, uns8 rdy_bit) {
 
   if (dep_op->srcs_not_rdy_vector == 0x0 && cycle_count >= dep_op->issue_cycle && !dep_op->in_rdy_list) {
     _DEBUG(dep_op->proc_id, DEBUG_NODE_STAGE, "Adding to ready list  op_num:%s\n", unsstr64(dep_op->op_num));
-    dep_op->next_rdy = node->rdy_head;
-    node->rdy_head = dep_op;
-    dep_op->in_rdy_list = TRUE;
+    node_issue_queue_add_ready(dep_op);
   }
 }
 
@@ -408,6 +676,7 @@ void cmp_redirect() {
 // cmp_retire_hook:  Called right before the op retires
 
 void cmp_retire_hook(Op* op) {
+  retire_stream_op(op);
   ft_free_op(op);
 }
 
@@ -415,8 +684,9 @@ void warmup_uncore(uns proc_id, Addr addr, Flag write) {
   Addr dummy_line_addr;
   ASSERTM(0, !MLC_PRESENT, "Warmup for MLC not implemented\n");
 
-  Cache* l1_cache = &(cmp_model.memory.uncores[proc_id].l1->cache);
+  Cache* l1_cache = &mem_l1(proc_id, addr)->cache;
   L1_Data* l1_data = cache_access(l1_cache, addr, &dummy_line_addr, TRUE);
+  adaptive_warmup_event(proc_id, WARMUP_SIGNAL_L1, l1_data == NULL);
   if (l1_data) {  // hit
     if (write)
       l1_data->dirty = TRUE;
@@ -430,7 +700,12 @@ void warmup_uncore(uns proc_id, Addr addr, Flag write) {
       uns repl_proc_id = get_proc_id_from_cmp_addr(repl_line_addr);
       STAT_EVENT(repl_proc_id, NORESET_L1_EVICT);
       STAT_EVENT(repl_proc_id, NORESET_L1_EVICT_NONPREF);
+      if (operating_mode == SIMULATION_MODE)
+        mem_l1_lines_changed(repl_proc_id);
     }
+    /* warmup threads may run in parallel: cmp_init(SIMULATION_MODE) catches up instead */
+    if (operating_mode == SIMULATION_MODE)
+      mem_l1_lines_changed(proc_id);
     l1_data = (L1_Data*)cache_insert(l1_cache, proc_id, addr, &dummy_line_addr, &repl_line_addr);
     l1_data->proc_id = proc_id;
     l1_data->dirty = write;
@@ -443,24 +718,81 @@ void warmup_uncore(uns proc_id, Addr addr, Flag write) {
 /* Warm up select microarchitectural structures: BP, icache, dcache,
  * and L1. No wrong path warmup. */
 
-void cmp_warmup(Op* op) {
-  uns proc_id = op->proc_id;
-  Addr ia = op->inst_info->addr;
-  Addr va = op->oracle_info.va;
+/* Parallel warmup (PARALLEL_WARMUP): worker threads warm the private caches and the
+   predictor of their core over a chunk of rounds (one instruction per core per
+   round), each with its own copy of sim_time. Their L1 accesses are buffered and
+   replayed by the main thread in the order of the sequential warmup: by round, then
+   by core. Nothing in the private structures depends on the L1 during warmup, so the
+   result is the same as warming the cores one instruction at a time. */
+
+typedef struct Cmp_Warmup_L1_struct {
+  uns round; /* round of the chunk that made the access */
+  Addr addr;
+  Flag write;
+} Cmp_Warmup_L1;
+
+typedef struct Cmp_Warmup_Parallel_struct {
+  pthread_t* workers;
+  pthread_barrier_t chunk_start;
+  pthread_barrier_t chunk_end;
+
+  Warmup_Inst* const* insts; /* [NUM_CORES] instructions of the chunk, NULL for idle cores */
+  uns num_rounds;
+  const Counter* round_time; /* [num_rounds] sim_time of each round */
+  uns* round;                /* [NUM_CORES] round each worker is in */
+  Cmp_Warmup_L1** l1;        /* [NUM_CORES] buffered L1 accesses of the chunk */
+  uns* num_l1;
+  uns* max_l1;
+  Flag active;
+  Flag shutdown;
+} Cmp_Warmup_Parallel;
+
+static Cmp_Warmup_Parallel cmp_warmup_par;
+
+static void cmp_warmup_l1(uns proc_id, Addr addr, Flag write) {
+  if (!cmp_warmup_par.active) {
+    warmup_uncore(proc_id, addr, write);
+    return;
+  }
+  if (cmp_warmup_par.num_l1[proc_id] == cmp_warmup_par.max_l1[proc_id]) {
+    uns max = cmp_warmup_par.max_l1[proc_id] *= 2;
+    cmp_warmup_par.l1[proc_id] = (Cmp_Warmup_L1*)realloc(cmp_warmup_par.l1[proc_id], sizeof(Cmp_Warmup_L1) * max);
+  }
+  Cmp_Warmup_L1* access = &cmp_warmup_par.l1[proc_id][cmp_warmup_par.num_l1[proc_id]++];
+  access->round = cmp_warmup_par.round[proc_id];
+  access->addr = addr;
+  access->write = write;
+}
+
+/* cmp_warmup_fdip_miss: FRONTEND_WARMUP trains FDIP on a warmup icache miss like on a
+   demand miss that no prefetch covered (see log_stats_mshr_hit) */
+static void cmp_warmup_fdip_miss(uns proc_id, Addr line_addr) {
+  uns64 hashed_addr = FDIP_GHIST_HASHING ? fdip_hash_addr_ghist(line_addr, g_bp_data->global_hist) : line_addr;
+  inc_cnt_useful(proc_id, hashed_addr, TRUE);
+  inc_cnt_useful_signed(hashed_addr);
+  inc_useful_lines_uc(hashed_addr);
+  update_useful_lines_uc(hashed_addr);
+  update_useful_lines_bloom_filter(hashed_addr);
+}
+
+static void cmp_warmup_icache(uns proc_id, Addr ia) {
   Addr dummy_line_addr;
   Addr dummy_line_addr2;
   Icache_Data* line_info = NULL;
 
-  // Warmup caches for instructions
   Icache_Stage* ic = &(cmp_model.icache_stage[proc_id]);
   Cache* icache = &(ic->icache);
   Inst_Info** ic_data = (Inst_Info**)cache_access(icache, ia, &dummy_line_addr, TRUE);
+  adaptive_warmup_event(proc_id, WARMUP_SIGNAL_ICACHE, ic_data == NULL);
   if (WP_COLLECT_STATS)
     line_info = (Icache_Data*)cache_access(&ic->icache_line_info, ia, &dummy_line_addr2, TRUE);
 
   if (ic_data == NULL) {
-    warmup_uncore(proc_id, ia, FALSE);
+    cmp_warmup_l1(proc_id, ia, FALSE);
+    if (FRONTEND_WARMUP && FDIP_ENABLE)
+      cmp_warmup_fdip_miss(proc_id, dummy_line_addr);
     Addr repl_line_addr;
+    icache_line_buffer_flush(ic);
     ic_data = (Inst_Info**)cache_insert(icache, proc_id, ia, &dummy_line_addr, &repl_line_addr);
     if (WP_COLLECT_STATS) {
       Addr repl_line_addr2;
@@ -476,42 +808,238 @@ void cmp_warmup(Op* op) {
       line_info->read_count[0] += 1;
     }
   }
+}
+
+static void cmp_warmup_dcache(uns proc_id, Addr va, Flag is_store) {
+  Addr dummy_line_addr;
+  Flag is_load = !is_store;
+  Cache* dcache = &(cmp_model.dcache_stage[proc_id].dcache);
+  Dcache_Data* dc_data = cache_access(dcache, va, &dummy_line_addr, TRUE);
+  adaptive_warmup_event(proc_id, WARMUP_SIGNAL_DCACHE, dc_data == NULL);
+  if (dc_data) {
+    // set some fields to meet expectations of the simulation mode
+    if (is_store)
+      dc_data->dirty = TRUE;
+    dc_data->read_count[0] += is_load;
+    dc_data->write_count[0] += is_store;
+  } else {
+    cmp_warmup_l1(proc_id, va, FALSE);
+    Addr repl_line_addr;
+    dc_data = (Dcache_Data*)cache_insert(dcache, proc_id, va, &dummy_line_addr, &repl_line_addr);
+    if (dc_data->dirty)
+      cmp_warmup_l1(proc_id, repl_line_addr, TRUE);
+    dc_data->dirty = is_store;
+    dc_data->read_count[0] = is_load;
+    dc_data->write_count[0] = is_store;
+  }
+}
+
+static void cmp_warmup_bp(Op* op) {
+  Bp_Data* bp_data = &(cmp_model.bp_data[op->proc_id]);
+  bp_predict_op(bp_data, op, 1, op->inst_info->addr);
+  bp_target_known_op(bp_data, op);
+  bp_resolve_op(bp_data, op);
+  adaptive_warmup_event(op->proc_id, WARMUP_SIGNAL_MISPRED, op->oracle_info.mispred);
+  adaptive_warmup_event(op->proc_id, WARMUP_SIGNAL_MISFETCH, op->oracle_info.misfetch);
+  if (op->oracle_info.mispred || op->oracle_info.misfetch) {
+    bp_recover_op(bp_data, op->table_info->cf_type, &op->recovery_info);
+  }
+  bp_data->bp->retire_func(op);
+}
+
+void cmp_warmup(Op* op) {
+  uns proc_id = op->proc_id;
+
+  // The frontend structures are reached through the current core
+  if (FRONTEND_WARMUP)
+    cmp_set_core_context(&cmp_model.core_context[proc_id]);
+
+  // Warmup caches for instructions
+  cmp_warmup_icache(proc_id, op->inst_info->addr);
 
   // Warmup caches for data
   Flag is_load = op->table_info->mem_type == MEM_LD;
   Flag is_store = op->table_info->mem_type == MEM_ST;
-  if (is_load || is_store) {
-    Cache* dcache = &(cmp_model.dcache_stage[proc_id].dcache);
-    Dcache_Data* dc_data = cache_access(dcache, va, &dummy_line_addr, TRUE);
-    if (dc_data) {
-      // set some fields to meet expectations of the simulation mode
-      if (is_store)
-        dc_data->dirty = TRUE;
-      dc_data->read_count[0] += is_load;
-      dc_data->write_count[0] += is_store;
-    } else {
-      warmup_uncore(proc_id, va, FALSE);
-      Addr repl_line_addr;
-      dc_data = (Dcache_Data*)cache_insert(dcache, proc_id, va, &dummy_line_addr, &repl_line_addr);
-      if (dc_data->dirty)
-        warmup_uncore(proc_id, repl_line_addr, TRUE);
-      dc_data->dirty = is_store;
-      dc_data->read_count[0] = is_load;
-      dc_data->write_count[0] = is_store;
+  if (is_load || is_store)
+    cmp_warmup_dcache(proc_id, op->oracle_info.va, is_store);
+
+  // Warmup BP for CF instructions
+  if (op->table_info->cf_type != NOT_CF)
+    cmp_warmup_bp(op);
+
+  // Warmup the uop cache with the FTs of the decoupled frontend
+  if (FRONTEND_WARMUP)
+    uop_cache_warmup_op(op);
+}
+
+/* cmp_warmup_inst: cmp_warmup for one instruction of the frontend warmup fast path.
+   The icache is only looked up when the instruction is on another line than the last
+   one (nothing else touches the icache during warmup), and branches train the
+   predictor through a minimal op. */
+void cmp_warmup_inst(uns proc_id, const Warmup_Inst* inst) {
+  static Addr last_iline[MAX_NUM_PROCS];
+  static Op ops[MAX_NUM_PROCS];
+  static Table_Info table_infos[MAX_NUM_PROCS];
+  static Inst_Info inst_infos[MAX_NUM_PROCS];
+
+  Addr iline = inst->pc & ~cmp_model.icache_stage[proc_id].icache.offset_mask;
+  if (iline != last_iline[proc_id] || WP_COLLECT_STATS) {
+    cmp_warmup_icache(proc_id, inst->pc);
+    last_iline[proc_id] = iline;
+  }
+
+  for (uns ii = 0; ii < inst->num_ld; ii++)
+    cmp_warmup_dcache(proc_id, inst->ld_addr[ii], FALSE);
+  for (uns ii = 0; ii < inst->num_st; ii++)
+    cmp_warmup_dcache(proc_id, inst->st_addr[ii], TRUE);
+
+  if (inst->cf_type != NOT_CF) {
+    Op* op = &ops[proc_id];
+    op->table_info = &table_infos[proc_id];
+    op->inst_info = &inst_infos[proc_id];
+    op->proc_id = proc_id;
+    op->op_num = op_count[proc_id];
+    op->inst_uid = inst->inst_uid;
+    op->bom = op->eom = TRUE;
+    op->table_info->cf_type = inst->cf_type;
+    op->inst_info->addr = inst->pc;
+    op->oracle_info.dir = inst->taken;
+    op->oracle_info.target = inst->target;
+    op->oracle_info.npc = inst->npc;
+    cmp_warmup_bp(op);
+  }
+}
+
+static void* cmp_warmup_parallel_worker(void* arg) {
+  uns proc_id = (uns)(uintptr_t)arg;
+
+  host_placement_pin_core(proc_id);
+
+  while (TRUE) {
+    pthread_barrier_wait(&cmp_warmup_par.chunk_start);
+    if (cmp_warmup_par.shutdown)
+      break;
+
+    const Warmup_Inst* insts = cmp_warmup_par.insts[proc_id];
+    for (uns ii = 0; insts && ii < cmp_warmup_par.num_rounds; ii++) {
+      sim_time = cmp_warmup_par.round_time[ii];
+      cmp_warmup_par.round[proc_id] = ii;
+      cmp_warmup_inst(proc_id, &insts[ii]);
     }
+    pthread_barrier_wait(&cmp_warmup_par.chunk_end);
   }
+  return NULL;
+}
 
-  // Warmup BP for CF instructions
-  if (op->table_info->cf_type != NOT_CF) {
-    Bp_Data* bp_data = &(cmp_model.bp_data[proc_id]);
-    bp_predict_op(bp_data, op, 1, ia);
-    bp_target_known_op(bp_data, op);
-    bp_resolve_op(bp_data, op);
-    if (op->oracle_info.mispred || op->oracle_info.misfetch) {
-      bp_recover_op(bp_data, op->table_info->cf_type, &op->recovery_info);
+/**************************************************************************************/
+/* cmp_warmup_parallel_init: starts one warmup worker thread per core */
+
+void cmp_warmup_parallel_init(void) {
+  ASSERTM(0, !WP_COLLECT_STATS, "PARALLEL_WARMUP does not support WP_COLLECT_STATS\n");
+
+  cmp_warmup_par.workers = (pthread_t*)malloc(sizeof(pthread_t) * NUM_CORES);
+  cmp_warmup_par.round = (uns*)calloc(NUM_CORES, sizeof(uns));
+  cmp_warmup_par.l1 = (Cmp_Warmup_L1**)malloc(sizeof(Cmp_Warmup_L1*) * NUM_CORES);
+  cmp_warmup_par.num_l1 = (uns*)calloc(NUM_CORES, sizeof(uns));
+  cmp_warmup_par.max_l1 = (uns*)malloc(sizeof(uns) * NUM_CORES);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    cmp_warmup_par.max_l1[proc_id] = 1024;
+    cmp_warmup_par.l1[proc_id] = (Cmp_Warmup_L1*)malloc(sizeof(Cmp_Warmup_L1) * cmp_warmup_par.max_l1[proc_id]);
+  }
+  cmp_warmup_par.shutdown = FALSE;
+
+  pthread_barrier_init(&cmp_warmup_par.chunk_start, NULL, NUM_CORES + 1);
+  pthread_barrier_init(&cmp_warmup_par.chunk_end, NULL, NUM_CORES + 1);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    int err = pthread_create(&cmp_warmup_par.workers[proc_id], NULL, cmp_warmup_parallel_worker,
+                             (void*)(uintptr_t)proc_id);
+    ASSERTM(proc_id, err == 0, "Could not create the warmup thread of core %u\n", proc_id);
+  }
+}
+
+/**************************************************************************************/
+/* cmp_warmup_parallel: warms all cores over num_rounds rounds. insts[proc_id] holds
+   num_rounds instructions of the core (NULL if it does not run) and round_time the
+   sim_time of every round. */
+
+void cmp_warmup_parallel(Warmup_Inst* const* insts, uns num_rounds, const Counter* round_time) {
+  cmp_warmup_par.insts = insts;
+  cmp_warmup_par.num_rounds = num_rounds;
+  cmp_warmup_par.round_time = round_time;
+  cmp_warmup_par.active = TRUE;
+  pthread_barrier_wait(&cmp_warmup_par.chunk_start);
+  pthread_barrier_wait(&cmp_warmup_par.chunk_end);
+  cmp_warmup_par.active = FALSE;
+
+  /* replay the L1 accesses in the order of the sequential warmup */
+  uns next[MAX_NUM_PROCS] = {0};
+  for (uns ii = 0; ii < num_rounds; ii++) {
+    sim_time = round_time[ii];
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      Cmp_Warmup_L1* l1 = cmp_warmup_par.l1[proc_id];
+      for (; next[proc_id] < cmp_warmup_par.num_l1[proc_id] && l1[next[proc_id]].round == ii; next[proc_id]++)
+        warmup_uncore(proc_id, l1[next[proc_id]].addr, l1[next[proc_id]].write);
     }
-    bp_data->bp->retire_func(op);
   }
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    cmp_warmup_par.num_l1[proc_id] = 0;
+}
+
+/**************************************************************************************/
+/* cmp_warmup_parallel_done: stops the warmup worker threads */
+
+void cmp_warmup_parallel_done(void) {
+  cmp_warmup_par.shutdown = TRUE;
+  pthread_barrier_wait(&cmp_warmup_par.chunk_start);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    pthread_join(cmp_warmup_par.workers[proc_id], NULL);
+    free(cmp_warmup_par.l1[proc_id]);
+  }
+  pthread_barrier_destroy(&cmp_warmup_par.chunk_start);
+  pthread_barrier_destroy(&cmp_warmup_par.chunk_end);
+  free(cmp_warmup_par.workers);
+  free(cmp_warmup_par.round);
+  free(cmp_warmup_par.l1);
+  free(cmp_warmup_par.num_l1);
+  free(cmp_warmup_par.max_l1);
+}
+
+/**************************************************************************************/
+/* cmp_save_warm_state: writes what cmp_warmup trains (icache, dcache, L1 and the
+ * branch predictor) into the warm state file. */
+
+void cmp_save_warm_state(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Icache_Stage* ic = &cmp_model.icache_stage[proc_id];
+    warm_state_save_cache(&ic->icache, "icache%u", proc_id);
+    if (WP_COLLECT_STATS)
+      warm_state_save_cache(&ic->icache_line_info, "icache_line_info%u", proc_id);
+    warm_state_save_cache(&cmp_model.dcache_stage[proc_id].dcache, "dcache%u", proc_id);
+    if (L1_SLICES == 1 && (PRIVATE_L1 || proc_id == 0))
+      warm_state_save_cache(&cmp_model.memory.uncores[proc_id].l1->cache, "l1_%u", proc_id);
+    bp_save_warm_state(&cmp_model.bp_data[proc_id]);
+  }
+  for (uns slice = 0; L1_SLICES > 1 && slice < L1_SLICES; slice++)
+    warm_state_save_cache(&cmp_model.memory.l1_slices[slice]->cache, "l1_slice_%u", slice);
+}
+
+/**************************************************************************************/
+/* cmp_load_warm_state: */
+
+void cmp_load_warm_state(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Icache_Stage* ic = &cmp_model.icache_stage[proc_id];
+    warm_state_load_cache(&ic->icache, "icache%u", proc_id);
+    icache_line_buffer_flush(ic);
+    if (WP_COLLECT_STATS)
+      warm_state_load_cache(&ic->icache_line_info, "icache_line_info%u", proc_id);
+    warm_state_load_cache(&cmp_model.dcache_stage[proc_id].dcache, "dcache%u", proc_id);
+    if (L1_SLICES == 1 && (PRIVATE_L1 || proc_id == 0))
+      warm_state_load_cache(&cmp_model.memory.uncores[proc_id].l1->cache, "l1_%u", proc_id);
+    bp_load_warm_state(&cmp_model.bp_data[proc_id]);
+  }
+  for (uns slice = 0; L1_SLICES > 1 && slice < L1_SLICES; slice++)
+    warm_state_load_cache(&cmp_model.memory.l1_slices[slice]->cache, "l1_slice_%u", slice);
 }
 
 static void cmp_measure_chip_util() {
@@ -519,3 +1047,429 @@ static void cmp_measure_chip_util() {
       exec->fus_busy || mem->uncores[exec->proc_id].num_outstanding_l1_accesses > 0 || dc->idle_cycle > cycle_count;
   perf_pred_core_busy(exec->proc_id, chip_busy);
 }
+
+/**************************************************************************************/
+/* cmp_parallel_init: starts one worker thread per core */
+
+static void cmp_parallel_init(void) {
+  ASSERTM(0, !PIPEVIEW && !MEMVIEW, "PARALLEL_CORES does not support pipeview/memview\n");
+  ASSERTM(0, !FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE,
+          "PARALLEL_CORES does not support the shared branch misprediction table\n");
+
+  cmp_parallel.workers = (pthread_t*)malloc(sizeof(pthread_t) * NUM_CORES);
+  cmp_parallel.ready = (Flag*)calloc(NUM_CORES, sizeof(Flag));
+  cmp_parallel.active = (Flag*)calloc(NUM_CORES, sizeof(Flag));
+  cmp_parallel.core_cycle = (Counter*)calloc(NUM_CORES, sizeof(Counter));
+  cmp_parallel.section = (uns*)calloc(NUM_CORES, sizeof(uns));
+  cmp_parallel.shutdown = FALSE;
+
+  pthread_barrier_init(&cmp_parallel.cycle_start, NULL, NUM_CORES + 1);
+  pthread_barrier_init(&cmp_parallel.cycle_end, NULL, NUM_CORES + 1);
+  pthread_mutex_init(&cmp_parallel.lock, NULL);
+  pthread_cond_init(&cmp_parallel.turn_changed, NULL);
+
+  if (PARALLEL_SLACK) {
+    ASSERTM(0, FRONTEND == FE_TRACE, "PARALLEL_SLACK works only with the trace frontend\n");
+    ASSERTM(0, !DVFS_ON, "PARALLEL_SLACK does not support DVFS\n");
+    cmp_parallel.next_cycle = (Counter*)calloc(NUM_CORES, sizeof(Counter));
+    cmp_parallel.limit_cycle = (Counter*)calloc(NUM_CORES, sizeof(Counter));
+    cmp_parallel.uncore_cycle = (Counter*)calloc(NUM_CORES, sizeof(Counter));
+    cmp_parallel.window_open = FALSE;
+    cmp_parallel.busy = 0;
+    pthread_mutex_init(&cmp_parallel.shared_lock, NULL);
+    pthread_cond_init(&cmp_parallel.slack_go, NULL);
+    pthread_cond_init(&cmp_parallel.slack_progress, NULL);
+  }
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    void* (*worker)(void*) = PARALLEL_SLACK ? cmp_slack_worker : cmp_parallel_worker;
+    int err = pthread_create(&cmp_parallel.workers[proc_id], NULL, worker, (void*)(uintptr_t)proc_id);
+    ASSERTM(proc_id, err == 0, "Could not create the worker thread of core %u\n", proc_id);
+  }
+}
+
+/**************************************************************************************/
+/* cmp_parallel_done: stops the worker threads */
+
+static void cmp_parallel_done(void) {
+  if (PARALLEL_SLACK) {
+    pthread_mutex_lock(&cmp_parallel.lock);
+    cmp_parallel.shutdown = TRUE;
+    pthread_cond_broadcast(&cmp_parallel.slack_go);
+    pthread_mutex_unlock(&cmp_parallel.lock);
+  } else {
+    cmp_parallel.shutdown = TRUE;
+    pthread_barrier_wait(&cmp_parallel.cycle_start);
+  }
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    pthread_join(cmp_parallel.workers[proc_id], NULL);
+
+  if (PARALLEL_SLACK) {
+    pthread_mutex_destroy(&cmp_parallel.shared_lock);
+    pthread_cond_destroy(&cmp_parallel.slack_go);
+    pthread_cond_destroy(&cmp_parallel.slack_progress);
+    free(cmp_parallel.next_cycle);
+    free(cmp_parallel.limit_cycle);
+    free(cmp_parallel.uncore_cycle);
+  }
+
+  pthread_barrier_destroy(&cmp_parallel.cycle_start);
+  pthread_barrier_destroy(&cmp_parallel.cycle_end);
+  pthread_mutex_destroy(&cmp_parallel.lock);
+  pthread_cond_destroy(&cmp_parallel.turn_changed);
+  free(cmp_parallel.workers);
+  free(cmp_parallel.ready);
+  free(cmp_parallel.active);
+  free(cmp_parallel.core_cycle);
+  free(cmp_parallel.section);
+}
+
+/**************************************************************************************/
+/* cmp_parallel_cores: runs one cycle of all ready cores on the worker threads */
+
+static void cmp_parallel_cores(void) {
+  Flag any_ready = FALSE;
+  uns last_ready = 0;
+
+  cmp_parallel.turn_proc_id = NUM_CORES;
+  cmp_parallel.turn_section = 0;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Flag ready = !(DUMB_CORE_ON && DUMB_CORE == proc_id) && freq_is_ready(FREQ_DOMAIN_CORES[proc_id]);
+    cmp_parallel.ready[proc_id] = ready;
+    cmp_parallel.active[proc_id] = ready;
+    cmp_parallel.section[proc_id] = 0;
+    if (ready) {
+      cmp_parallel.core_cycle[proc_id] = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+      if (!any_ready)
+        cmp_parallel.turn_proc_id = proc_id;
+      any_ready = TRUE;
+      last_ready = proc_id;
+    }
+  }
+  if (!any_ready)
+    return;
+
+  cmp_parallel.sim_time = sim_time;
+  pthread_barrier_wait(&cmp_parallel.cycle_start);
+  pthread_barrier_wait(&cmp_parallel.cycle_end);
+
+  /* leave cycle_count as the sequential loop would */
+  cycle_count = cmp_parallel.core_cycle[last_ready];
+}
+
+static void* cmp_parallel_worker(void* arg) {
+  uns proc_id = (uns)(uintptr_t)arg;
+
+  host_placement_pin_core(proc_id);
+
+  while (TRUE) {
+    pthread_barrier_wait(&cmp_parallel.cycle_start);
+    if (cmp_parallel.shutdown)
+      break;
+
+    if (cmp_parallel.ready[proc_id]) {
+      cycle_count = cmp_parallel.core_cycle[proc_id];
+      sim_time = cmp_parallel.sim_time;
+      cmp_core_cycle(proc_id);
+      cmp_ordered_finish(proc_id);
+    }
+    pthread_barrier_wait(&cmp_parallel.cycle_end);
+  }
+  return NULL;
+}
+
+/**************************************************************************************/
+/* cmp_slack_cores: lets the workers run until every core has simulated its cycle of
+   the current time, and each at most PARALLEL_SLACK cycles past it */
+
+static void cmp_slack_cores(void) {
+  uns last_ready = NUM_CORES;
+
+  pthread_mutex_lock(&cmp_parallel.lock);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Counter now = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+    // the cycle counts restart when the simulation starts
+    if (now < cmp_parallel.uncore_cycle[proc_id])
+      cmp_parallel.next_cycle[proc_id] = now;
+    cmp_parallel.uncore_cycle[proc_id] = now;
+    cmp_parallel.limit_cycle[proc_id] = now + PARALLEL_SLACK;
+    if (!(DUMB_CORE_ON && DUMB_CORE == proc_id) && freq_is_ready(FREQ_DOMAIN_CORES[proc_id]))
+      last_ready = proc_id;
+  }
+
+  cmp_parallel.window_open = TRUE;
+  pthread_cond_broadcast(&cmp_parallel.slack_go);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (DUMB_CORE_ON && DUMB_CORE == proc_id)
+      continue;
+    while (cmp_parallel.next_cycle[proc_id] <= cmp_parallel.uncore_cycle[proc_id])
+      pthread_cond_wait(&cmp_parallel.slack_progress, &cmp_parallel.lock);
+  }
+  cmp_parallel.window_open = FALSE;
+  while (cmp_parallel.busy)
+    pthread_cond_wait(&cmp_parallel.slack_progress, &cmp_parallel.lock);
+  pthread_mutex_unlock(&cmp_parallel.lock);
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (DUMB_CORE_ON && DUMB_CORE == proc_id)
+      continue;
+    STAT_EVENT(proc_id, SLACK_UNCORE_STEPS);
+    INC_STAT_EVENT(proc_id, SLACK_AHEAD_CYCLES,
+                   cmp_parallel.next_cycle[proc_id] - 1 - cmp_parallel.uncore_cycle[proc_id]);
+  }
+
+  /* leave cycle_count as the sequential loop would */
+  if (last_ready < NUM_CORES)
+    cycle_count = cmp_parallel.uncore_cycle[last_ready];
+}
+
+static void* cmp_slack_worker(void* arg) {
+  uns proc_id = (uns)(uintptr_t)arg;
+
+  host_placement_pin_core(proc_id);
+
+  pthread_mutex_lock(&cmp_parallel.lock);
+  while (TRUE) {
+    while (!cmp_parallel.shutdown &&
+           !(cmp_parallel.window_open && cmp_parallel.next_cycle[proc_id] <= cmp_parallel.limit_cycle[proc_id]))
+      pthread_cond_wait(&cmp_parallel.slack_go, &cmp_parallel.lock);
+    if (cmp_parallel.shutdown)
+      break;
+    cmp_parallel.busy++;
+    pthread_mutex_unlock(&cmp_parallel.lock);
+
+    cycle_count = cmp_parallel.next_cycle[proc_id];
+    freq_set_local_cycle(FREQ_DOMAIN_CORES[proc_id], cycle_count);
+    sim_time = freq_time();
+    pthread_mutex_lock(&cmp_parallel.shared_lock);
+    cmp_istream(proc_id);
+    pthread_mutex_unlock(&cmp_parallel.shared_lock);
+    cmp_core_cycle(proc_id);
+
+    pthread_mutex_lock(&cmp_parallel.lock);
+    cmp_parallel.next_cycle[proc_id]++;
+    cmp_parallel.busy--;
+    pthread_cond_signal(&cmp_parallel.slack_progress);
+  }
+  pthread_mutex_unlock(&cmp_parallel.lock);
+  return NULL;
+}
+
+/* cmp_slack_late_fill: counts a fill that reaches a core running ahead of the uncore */
+void cmp_slack_late_fill(uns proc_id) {
+  SCounter now = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+  SCounter ahead = (SCounter)cmp_parallel.next_cycle[proc_id] - 1 - now;
+  if (ahead > 0) {
+    STAT_EVENT(proc_id, SLACK_LATE_FILLS);
+    INC_STAT_EVENT(proc_id, SLACK_LATE_FILL_CYCLES, ahead);
+  }
+}
+
+/**************************************************************************************/
+/* Ordered sections. Must be called with cmp_parallel.lock held. */
+
+static void cmp_ordered_advance_turn(void) {
+  uns proc_id = cmp_parallel.turn_proc_id;
+
+  for (uns ii = 0; ii < NUM_CORES; ii++) {
+    proc_id++;
+    if (proc_id == NUM_CORES) {
+      proc_id = 0;
+      cmp_parallel.turn_section++;
+    }
+    if (cmp_parallel.active[proc_id]) {
+      cmp_parallel.turn_proc_id = proc_id;
+      pthread_cond_broadcast(&cmp_parallel.turn_changed);
+      return;
+    }
+  }
+  cmp_parallel.turn_proc_id = NUM_CORES;
+}
+
+static void cmp_ordered_begin(uns proc_id) {
+  if (PARALLEL_SLACK) {
+    pthread_mutex_lock(&cmp_parallel.shared_lock);
+    return;
+  }
+  pthread_mutex_lock(&cmp_parallel.lock);
+  while (cmp_parallel.turn_proc_id != proc_id || cmp_parallel.turn_section != cmp_parallel.section[proc_id])
+    pthread_cond_wait(&cmp_parallel.turn_changed, &cmp_parallel.lock);
+  pthread_mutex_unlock(&cmp_parallel.lock);
+}
+
+static void cmp_ordered_end(uns proc_id) {
+  if (PARALLEL_SLACK) {
+    pthread_mutex_unlock(&cmp_parallel.shared_lock);
+    return;
+  }
+  pthread_mutex_lock(&cmp_parallel.lock);
+  cmp_parallel.section[proc_id]++;
+  cmp_ordered_advance_turn();
+  pthread_mutex_unlock(&cmp_parallel.lock);
+}
+
+static void cmp_ordered_finish(uns proc_id) {
+  pthread_mutex_lock(&cmp_parallel.lock);
+  cmp_parallel.active[proc_id] = FALSE;
+  if (cmp_parallel.turn_proc_id == proc_id)
+    cmp_ordered_advance_turn();
+  pthread_mutex_unlock(&cmp_parallel.lock);
+}
+
+/**************************************************************************************/
+/* cmp_skip_init: */
+
+static void cmp_skip_init(void) {
+  cmp_skip = (Cmp_Skip*)calloc(NUM_CORES, sizeof(Cmp_Skip));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Cmp_Skip* skip = &cmp_skip[proc_id];
+    skip->backoff = 1;
+    skip->snapshot = (Stat_Value*)malloc(sizeof(Stat_Value) * NUM_GLOBAL_STATS);
+    skip->delta_stat = (uns*)malloc(sizeof(uns) * NUM_GLOBAL_STATS);
+    skip->delta_count = (Counter*)malloc(sizeof(Counter) * NUM_GLOBAL_STATS);
+    skip->delta_value = (double*)malloc(sizeof(double) * NUM_GLOBAL_STATS);
+  }
+}
+
+/**************************************************************************************/
+/* cmp_skip_signature: state that changes whenever the pipeline of the core
+ * makes progress */
+
+static void cmp_skip_signature(Core_Context* ctx, Counter* sig) {
+  uns proc_id = ctx->proc_id;
+
+  sig[0] = inst_count[proc_id];
+  sig[1] = op_count[proc_id];
+  sig[2] = uop_count[proc_id];
+  sig[3] = unique_count_per_core[proc_id];
+  sig[4] = ctx->node->node_count;
+  sig[5] = ctx->node->ret_op;
+  sig[6] = (Counter)(uintptr_t)ctx->node->next_op_into_rs;
+  sig[7] = decoupled_fe_ftq_num_ops();
+}
+
+/**************************************************************************************/
+/* cmp_skip_waiting: returns TRUE if every op in the ROB is waiting on the
+ * memory system or on another op, and sets next_event to the earliest cycle
+ * at which an op, a recovery or a redirect is scheduled to do something */
+
+static Flag cmp_skip_waiting(Core_Context* ctx, Counter* next_event) {
+  Node_Stage* node_stage = ctx->node;
+  Counter next = MIN2(ctx->bp_recovery_info->recovery_cycle, ctx->bp_recovery_info->redirect_cycle);
+
+  if (node_issue_queue_has_ready(node_stage))
+    return FALSE;
+
+  for (Op* op = node_stage->node_head; op; op = op->next_node) {
+    switch (op->state) {
+      case OS_IN_ROB:
+      case OS_IN_RS:
+      case OS_MISS:
+      case OS_WAIT_MEM:
+      case OS_DONE:
+        break;
+      default:
+        return FALSE;
+    }
+
+    Counter op_cycles[] = {op->issue_cycle, op->rdy_cycle,  op->sched_cycle, op->exec_cycle,
+                           op->dcache_cycle, op->done_cycle, op->wake_cycle,  op->replay_cycle};
+    for (uns ii = 0; ii < sizeof(op_cycles) / sizeof(op_cycles[0]); ii++) {
+      if (op_cycles[ii] > cycle_count && op_cycles[ii] < next)
+        next = op_cycles[ii];
+    }
+  }
+
+  *next_event = next;
+  return next > cycle_count + 1;
+}
+
+/**************************************************************************************/
+/* cmp_skip_cycle: returns TRUE if the current cycle of the core is skipped */
+
+static Flag cmp_skip_cycle(Core_Context* ctx) {
+  Cmp_Skip* skip = &cmp_skip[ctx->proc_id];
+
+  if (!skip->skipping)
+    return FALSE;
+
+  if (cycle_count >= skip->skip_until || cmp_skip_mem_events != skip->mem_events) {
+    skip->skipping = FALSE;
+    skip->stalled = FALSE;
+    return FALSE;
+  }
+
+  Stat* stats = global_stat_array[ctx->proc_id];
+  Stat_Value* values = global_stat_values[ctx->proc_id];
+  for (uns ii = 0; ii < skip->num_deltas; ii++) {
+    uns stat = skip->delta_stat[ii];
+    if (stats[stat].type == FLOAT_TYPE_STAT)
+      values[stat].value += skip->delta_value[ii];
+    else
+      values[stat].count += skip->delta_count[ii];
+  }
+  ctx->node->ret_stall_length += skip->ret_stall_delta;
+  ctx->node->mem_block_length += skip->mem_block_delta;
+
+  STAT_EVENT(ctx->proc_id, NODE_CYCLE_SKIPPED);
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* cmp_skip_probe_begin: snapshots the core if this cycle may be the last one
+ * simulated before a skip */
+
+static void cmp_skip_probe_begin(Core_Context* ctx) {
+  Cmp_Skip* skip = &cmp_skip[ctx->proc_id];
+  Counter next_event;
+
+  skip->probing = skip->stalled && cycle_count >= skip->probe_until && cmp_skip_waiting(ctx, &next_event);
+  if (!skip->probing)
+    return;
+
+  memcpy(skip->snapshot, global_stat_values[ctx->proc_id], sizeof(Stat_Value) * NUM_GLOBAL_STATS);
+  skip->mem_events = cmp_skip_mem_events;
+  skip->ret_stall_length = ctx->node->ret_stall_length;
+  skip->mem_block_length = ctx->node->mem_block_length;
+}
+
+/**************************************************************************************/
+/* cmp_skip_probe_end: updates the progress signature and, after a probe that
+ * changed nothing, starts skipping */
+
+static void cmp_skip_probe_end(Core_Context* ctx) {
+  Cmp_Skip* skip = &cmp_skip[ctx->proc_id];
+  Counter sig[CMP_SKIP_SIG_SIZE];
+  Counter next_event;
+
+  cmp_skip_signature(ctx, sig);
+  Flag stalled = memcmp(sig, skip->sig, sizeof(sig)) == 0;
+  memcpy(skip->sig, sig, sizeof(sig));
+  skip->stalled = stalled;
+
+  if (!skip->probing)
+    return;
+  skip->probing = FALSE;
+
+  if (stalled && ctx->node->ret_stall_length >= skip->ret_stall_length &&
+      ctx->node->mem_block_length >= skip->mem_block_length && cmp_skip_waiting(ctx, &next_event)) {
+    Stat_Value* values = global_stat_values[ctx->proc_id];
+    skip->num_deltas = 0;
+    for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
+      if (values[ii].count == skip->snapshot[ii].count)
+        continue;
+      skip->delta_stat[skip->num_deltas] = ii;
+      skip->delta_count[skip->num_deltas] = values[ii].count - skip->snapshot[ii].count;
+      skip->delta_value[skip->num_deltas] = values[ii].value - skip->snapshot[ii].value;
+      skip->num_deltas++;
+    }
+    skip->ret_stall_delta = ctx->node->ret_stall_length - skip->ret_stall_length;
+    skip->mem_block_delta = ctx->node->mem_block_length - skip->mem_block_length;
+    skip->skip_until = next_event;
+    skip->skipping = TRUE;
+    skip->backoff = 1;
+  } else {
+    skip->probe_until = cycle_count + skip->backoff;
+    skip->backoff = MIN2(2 * skip->backoff, CMP_SKIP_MAX_BACKOFF);
+  }
+}
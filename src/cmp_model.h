@@ -33,6 +33,7 @@
 #include "memory/memory.h"
 
 #include "cmp_model_support.h"
+#include "core_context.h"
 #include "dcache_stage.h"
 #include "decode_stage.h"
 #include "decoupled_frontend.h"
@@ -67,6 +68,9 @@ typedef struct Cmp_Model_struct {
   Exec_Stage* exec_stage;
   Dcache_Stage* dcache_stage;
 
+  /* per-core pointers into the arrays above, handed to the stages */
+  Core_Context* core_context;
+
   uns window_size;
 
 } Cmp_Model;
@@ -88,6 +92,19 @@ void cmp_done(void);
 void cmp_wake(Op*, Op*, uns8);
 void cmp_retire_hook(Op*);
 void cmp_warmup(Op*);
+struct Warmup_Inst_struct;
+void cmp_warmup_inst(uns, const struct Warmup_Inst_struct*);
+void cmp_warmup_parallel_init(void);
+void cmp_warmup_parallel(struct Warmup_Inst_struct* const*, uns, const Counter*);
+void cmp_warmup_parallel_done(void);
+void cmp_save_warm_state(void);
+void cmp_load_warm_state(void);
+
+/* Counts a fill that reaches a core running ahead of the uncore (PARALLEL_SLACK) */
+void cmp_slack_late_fill(uns proc_id);
+
+/* Warm up the L1 with an access by core proc_id (also used by the interval model) */
+void warmup_uncore(uns proc_id, Addr addr, Flag write);
 
 /**************************************************************************************/
 
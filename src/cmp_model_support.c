@@ -35,15 +35,25 @@
 #include "general.param.h"
 
 #include "frontend/pin_trace_fe.h"
-#include "prefetcher/D_JOLT.h"
-#include "prefetcher/FNL+MMA.h"
-#include "prefetcher/eip.h"
-#include "prefetcher/fdip.h"
+#include "prefetcher/iprefetch.h"
 
 #include "cmp_model.h"
+#include "core_context.h"
 #include "lsq.h"
+#include "mem_replay_model.h"
+#include "op_pool.h"
 #include "statistics.h"
 
+/**************************************************************************************/
+/* Global vars */
+
+CORE_LOCAL Core_Context* core_ctx = NULL;
+
+/**************************************************************************************/
+/* Static prototypes */
+
+static void cmp_flush_core(void);
+
 /**************************************************************************************/
 /* cmp_init_cmp_model  */
 void cmp_init_cmp_model() {
@@ -62,11 +72,23 @@ void cmp_init_cmp_model() {
   cmp_model.node_stage = (Node_Stage*)malloc(sizeof(Node_Stage) * NUM_CORES);
   cmp_model.exec_stage = (Exec_Stage*)malloc(sizeof(Exec_Stage) * NUM_CORES);
   cmp_model.dcache_stage = (Dcache_Stage*)malloc(sizeof(Dcache_Stage) * NUM_CORES);
+  cmp_model.core_context = (Core_Context*)malloc(sizeof(Core_Context) * NUM_CORES);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Core_Context* ctx = &cmp_model.core_context[proc_id];
+    ctx->proc_id = proc_id;
+    ctx->td = &cmp_model.thread_data[proc_id];
+    ctx->bp_data = &cmp_model.bp_data[proc_id];
+    ctx->bp_recovery_info = &cmp_model.bp_recovery_info[proc_id];
+    ctx->ic = &cmp_model.icache_stage[proc_id];
+    ctx->dec = &cmp_model.decode_stage[proc_id];
+    ctx->uc = &cmp_model.uop_cache_stage[proc_id];
+    ctx->map = &cmp_model.map_stage[proc_id];
+    ctx->node = &cmp_model.node_stage[proc_id];
+    ctx->exec = &cmp_model.exec_stage[proc_id];
+    ctx->dc = &cmp_model.dcache_stage[proc_id];
+  }
   alloc_mem_decoupled_fe(NUM_CORES);
-  alloc_mem_fdip(NUM_CORES);
-  alloc_mem_eip(NUM_CORES);
-  alloc_mem_djolt(NUM_CORES);
-  alloc_mem_fnlmma(NUM_CORES);
+  alloc_mem_iprefetch(NUM_CORES);
   alloc_mem_uop_cache(NUM_CORES);
   alloc_mem_idq_stage(NUM_CORES);
   alloc_mem_lsq(NUM_CORES);
@@ -75,29 +97,36 @@ void cmp_init_cmp_model() {
 void cmp_init_thread_data(uns8 proc_id) {
   td->proc_id = proc_id;
   init_map(proc_id);
-  init_list(&td->seq_op_list, "SEQ_OP_LIST", sizeof(Op*), TRUE);
+  init_ring(&td->seq_op_list, "SEQ_OP_LIST", sizeof(Op*), 256);
+  td->seq_op_squash_count = 0;
 }
 
 /**************************************************************************************/
 /* cmp_set_all_stages  */
 void cmp_set_all_stages(uns8 proc_id) {
-  set_thread_data(&cmp_model.thread_data[proc_id]);
+  cmp_set_core_context(&cmp_model.core_context[proc_id]);
+}
+
+/**************************************************************************************/
+/* cmp_set_core_context: makes ctx the current core of this host thread */
+void cmp_set_core_context(Core_Context* ctx) {
+  core_ctx = ctx;
+  set_bp_data(ctx->bp_data);
+  set_bp_recovery_info(ctx->bp_recovery_info);
+  set_thread_data(ctx->td);
   set_map_data(&td->map_data);
 
-  set_eip(proc_id);
-  set_djolt(proc_id);
-  set_fnlmma(proc_id);
-  set_fdip(proc_id, &cmp_model.icache_stage[proc_id]);
-  set_decoupled_fe(proc_id);
-  set_icache_stage(&cmp_model.icache_stage[proc_id]);
-  set_decode_stage(&cmp_model.decode_stage[proc_id]);
-  set_uop_cache_stage(&cmp_model.uop_cache_stage[proc_id]);
-  set_idq_stage(proc_id);
-  set_map_stage(&cmp_model.map_stage[proc_id]);
-  set_node_stage(&cmp_model.node_stage[proc_id]);
-  set_lsq(proc_id);
-  set_exec_stage(&cmp_model.exec_stage[proc_id]);
-  set_dcache_stage(&cmp_model.dcache_stage[proc_id]);
+  set_iprefetch(ctx);
+  set_decoupled_fe(ctx);
+  set_icache_stage(ctx);
+  set_decode_stage(ctx);
+  set_uop_cache_stage(ctx);
+  set_idq_stage(ctx);
+  set_map_stage(ctx);
+  set_node_stage(ctx);
+  set_lsq(ctx);
+  set_exec_stage(ctx);
+  set_dcache_stage(ctx);
 }
 
 /**************************************************************************************/
@@ -116,12 +145,39 @@ void cmp_init_bogus_sim(uns8 proc_id) {
 
   cmp_set_all_stages(proc_id);
 
-  trace_close_trace_file(proc_id);
-
   op_count[proc_id] = uop_count[proc_id] + 1;
 
-  trace_setup(proc_id);
+  trace_restart(proc_id);
+
+  cmp_flush_core();
+}
+
+/**************************************************************************************/
+/* cmp_init_bogus_replay:
+ *  Like cmp_init_bogus_sim, but the finished process is not restarted: its pipeline
+ *  is emptied and no longer simulated, and the memory requests it sent are replayed
+ *  in a loop instead (BOGUS_REPLAY, see mem_replay_model.c). Falls back to bogus
+ *  simulation if the process sent no request.
+ */
+void cmp_init_bogus_replay(uns8 proc_id) {
+  if (!bogus_replay_start(proc_id)) {
+    cmp_init_bogus_sim(proc_id);
+    return;
+  }
+
+  reached_exit[proc_id] = FALSE;
+  retired_exit[proc_id] = FALSE;
+
+  cmp_set_all_stages(proc_id);
+  cmp_flush_core();
+  /* the core is not simulated anymore, so a pending recovery or redirect never happens */
+  bp_recovery_info->recovery_cycle = MAX_CTR;
+  bp_recovery_info->redirect_cycle = MAX_CTR;
+}
 
+/**************************************************************************************/
+/* cmp_flush_core: drops every op of the current core from its pipeline */
+static void cmp_flush_core(void) {
   reset_seq_op_list(td);
   reset_map();
 
@@ -133,3 +189,29 @@ void cmp_init_bogus_sim(uns8 proc_id) {
   reset_exec_stage();
   reset_dcache_stage();
 }
+
+/**************************************************************************************/
+/* cmp_is_core_drained:
+ *  Like cmp_is_drained, but only looks at the ops of proc_id, so it works with
+ *  several cores. Every op fetched past the FTQ must have retired, so it is only
+ *  exact for frontends without wrong-path ops, such as the trace frontend.
+ */
+Flag cmp_is_core_drained(uns8 proc_id) {
+  Bp_Recovery_Info* info = &cmp_model.bp_recovery_info[proc_id];
+  return decoupled_fe_is_idle(proc_id) && cmp_model.icache_stage[proc_id].sd.op_count == 0 &&
+         op_count[proc_id] == uop_count[proc_id] + 1 && info->recovery_cycle == MAX_CTR &&
+         info->redirect_cycle == MAX_CTR;
+}
+
+/**************************************************************************************/
+/* cmp_is_drained:
+ *  TRUE once proc_id has nothing in flight after decoupled_fe_stall_on_path: no
+ *  ops, no pending recovery or redirect and no outstanding memory requests. Sampled
+ *  simulation waits for this before it switches the core to functional warming.
+ *  The op pool is shared, so this only works for a single core.
+ */
+Flag cmp_is_drained(uns8 proc_id) {
+  Bp_Recovery_Info* info = &cmp_model.bp_recovery_info[proc_id];
+  return decoupled_fe_is_idle(proc_id) && op_pool_active_ops == 0 && info->recovery_cycle == MAX_CTR &&
+         info->redirect_cycle == MAX_CTR && mem_get_req_count(proc_id) == 0;
+}
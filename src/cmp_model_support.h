@@ -37,7 +37,11 @@
 void cmp_init_cmp_model(void);
 void cmp_init_thread_data(uns8);
 void cmp_set_all_stages(uns8);
+void cmp_set_core_context(Core_Context*);
 void cmp_init_bogus_sim(uns8);
+void cmp_init_bogus_replay(uns8);
+Flag cmp_is_drained(uns8);
+Flag cmp_is_core_drained(uns8);
 
 /**************************************************************************************/
 /* External variables */
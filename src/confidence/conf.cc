@@ -159,11 +159,44 @@ void Conf::process_op(Op* op, Conf_Off_Path_Reason& new_reason, bool last_in_ft)
   set_prev_op(op);
 }
 
-void Conf::update(FT pushed_ft) {
+/* batch_update: Conf::update through the ft_update of the mechanism. The ops before the one that turns confidence
+   off are on-path by confidence with no reason, the ones after it are off-path with its reason. */
+bool Conf::batch_update(const std::vector<Op*>& ops) {
+  if (PERFECT_CONFIDENCE || CONF_PERFECT_BTB_MISS_CONF || CONF_PERFECT_IBTB_MISS_CONF || CONF_PERFECT_MISFETCH_CONF ||
+      CONF_PERFECT_MISPRED_CONF)
+    return false;
+
+  Conf_Off_Path_Reason new_reason = REASON_CONF_NOT_IDENTIFIED;
+  bool was_off_path = conf_off_path;
+  int num_ops = ops.size();
+  int off_idx = num_ops;
+  if (!was_off_path) {
+    off_idx = conf_mech->ft_update(ops, new_reason);
+    if (off_idx < 0)
+      return false;
+  }
+
+  for (int ii = 0; ii < num_ops; ii++) {
+    Op* op = ops[ii];
+    op->conf_off_path = was_off_path || ii > off_idx;
+    if (!op->conf_off_path && op->table_info->cf_type)
+      log_cf_conf(op);
+    Conf_Off_Path_Reason reason = ii >= off_idx ? new_reason : REASON_CONF_NOT_IDENTIFIED;
+    conf_mech->conf_mech_stat->update(op, reason, ii == num_ops - 1);
+    STAT_EVENT(proc_id, CONF_OFF_IBTB_MISS_BP_TAKEN + reason);
+    set_prev_op(op);
+  }
+  conf_off_path |= (new_reason != REASON_CONF_NOT_IDENTIFIED);
+  return true;
+}
+
+void Conf::update(const FT& pushed_ft) {
   ASSERT(proc_id, CONFIDENCE_ENABLE);
 
-  std::vector<Op*> ops = pushed_ft.get_ops();
+  const std::vector<Op*>& ops = pushed_ft.get_ops();
   ASSERT(proc_id, !ops.empty());
+  if (CONF_FT_BATCH && batch_update(ops))
+    return;
 
   Conf_Off_Path_Reason new_reason = REASON_CONF_NOT_IDENTIFIED;
 
@@ -211,7 +244,10 @@ void Conf::per_op_update(Op* op, Conf_Off_Path_Reason& new_reason) {
 
 void Conf::per_cf_op_update(Op* op, Conf_Off_Path_Reason& new_reason) {
   conf_mech->per_cf_op_update(op, new_reason);
+  log_cf_conf(op);
+}
 
+void Conf::log_cf_conf(Op* op) {
   // log conf stats
   // if it is a cf with bp conf
   if ((op)->table_info->cf_type == CF_CBR || (op)->table_info->cf_type == CF_IBR ||
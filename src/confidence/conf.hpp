@@ -86,6 +86,11 @@ class ConfMechBase {
   // resolve cf
   virtual void resolve_cf(Op* op) = 0;
 
+  // batch update (CONF_FT_BATCH): same as per_ft_update on the last op followed by per_op_update and
+  // per_cf_op_update on the ops in order, stopping at the first op that sets new_reason. Returns the index of that
+  // op (ops.size() if none), or -1 if the mechanism has no batch update.
+  virtual int ft_update(const std::vector<Op*>& ops, Conf_Off_Path_Reason& new_reason) { return -1; }
+
   uns proc_id;
 
   ConfMechStatBase* conf_mech_stat;
@@ -99,7 +104,7 @@ class Conf {
   uns get_conf() { return conf_off_path; }
   void recover(Op* op);
   void set_prev_op(Op* op);
-  void update(FT ft_pushed);
+  void update(const FT& ft_pushed);
   void resolve_cf(Op* op) { conf_mech->resolve_cf(op); }
   Off_Path_Reason get_off_path_reason() { return conf_mech->conf_mech_stat->get_off_path_reason(); }
   Conf_Off_Path_Reason get_conf_off_path_reason() { return conf_mech->conf_mech_stat->get_conf_off_path_reason(); }
@@ -114,6 +119,8 @@ class Conf {
   void update_state_perfect_conf(Op* op) { conf_mech->update_state_perfect_conf(op); }
   void perfect_conf_update(Op* op, Conf_Off_Path_Reason& new_reason);
   void process_op(Op* op, Conf_Off_Path_Reason& new_reason, bool last_in_ft);
+  bool batch_update(const std::vector<Op*>& ops);
+  void log_cf_conf(Op* op);
 
   // confidence mech object
   ConfMechBase* conf_mech;
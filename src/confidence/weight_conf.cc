@@ -5,13 +5,21 @@ WeightConfStat::WeightConfStat(uns _proc_id, WeightConf* _conf_mech) : ConfMechS
   conf_mech = _conf_mech;
 }
 
+void WeightConf::update_weights() {
+  double rate_weight = (double)CONF_BTB_MISS_RATE_WEIGHT * btb_miss_rate;
+  for (int conf = 0; conf < 4; conf++)
+    cf_weight[conf] = 3 - conf + rate_weight;
+  op_weight = 1.0 + rate_weight;
+  distance_weight = CONF_OFF_PATH_INC + rate_weight;
+}
+
 void WeightConf::per_op_update(Op* op, Conf_Off_Path_Reason& new_reason) {
   if (!CONF_BTB_MISS_RATE_CONF && !(op->table_info->cf_type)) {
     if (cf_op_distance >= CONF_OFF_PATH_THRESHOLD) {
-      low_confidence_cnt += CONF_OFF_PATH_INC + (double)CONF_BTB_MISS_RATE_WEIGHT * btb_miss_rate;
+      low_confidence_cnt += distance_weight;
       cf_op_distance = 0.0;
     } else {
-      cf_op_distance += (1.0 + (double)CONF_BTB_MISS_RATE_WEIGHT * btb_miss_rate);
+      cf_op_distance += op_weight;
     }
   }
 
@@ -21,8 +29,7 @@ void WeightConf::per_op_update(Op* op, Conf_Off_Path_Reason& new_reason) {
 
 void WeightConf::per_cf_op_update(Op* op, Conf_Off_Path_Reason& new_reason) {
   if (!CONF_PERFECT_BTB_MISS_CONF && !CONF_PERFECT_MISPRED_CONF) {
-    low_confidence_cnt +=
-        3 - op->bp_confidence + (double)CONF_BTB_MISS_RATE_WEIGHT * btb_miss_rate;  // 3 is highest bp_confidence
+    low_confidence_cnt += cf_weight[op->bp_confidence];
     cf_op_distance = 0.0;
   }
 
@@ -38,6 +45,7 @@ void WeightConf::per_cycle_update(Conf_Off_Path_Reason& new_reason) {
   if (cycle_count % CONF_BTB_MISS_SAMPLE_RATE == 0) {
     btb_miss_rate = (double)cnt_btb_miss / (double)CONF_BTB_MISS_SAMPLE_RATE;
     cnt_btb_miss = 0;
+    update_weights();
   }
 }
 
@@ -54,4 +62,35 @@ void WeightConf::recover(Op* op) {
 
 void WeightConf::resolve_cf(Op* op) {
   return;
-}
\ No newline at end of file
+}
+/* ft_update: per_op_update and per_cf_op_update of every op without the virtual calls (per_ft_update does
+   nothing). Only called without perfect confidence, so every cf op adds its weight. */
+int WeightConf::ft_update(const std::vector<Op*>& ops, Conf_Off_Path_Reason& new_reason) {
+  uns threshold = CONF_OFF_PATH_THRESHOLD;
+  bool count_distance = !CONF_BTB_MISS_RATE_CONF;
+  int num_ops = ops.size();
+
+  for (int ii = 0; ii < num_ops; ii++) {
+    const Op* op = ops[ii];
+    if (low_confidence_cnt >= threshold) {
+      new_reason = REASON_CONF_THRESHOLD;
+      return ii;
+    }
+    if (op->table_info->cf_type) {
+      low_confidence_cnt += cf_weight[op->bp_confidence];
+      cf_op_distance = 0.0;
+    } else if (count_distance) {
+      if (cf_op_distance >= threshold) {
+        low_confidence_cnt += distance_weight;
+        cf_op_distance = 0.0;
+      } else {
+        cf_op_distance += op_weight;
+      }
+    }
+    if (low_confidence_cnt >= threshold) {
+      new_reason = REASON_CONF_THRESHOLD;
+      return ii;
+    }
+  }
+  return num_ops;
+}
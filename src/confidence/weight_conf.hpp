@@ -18,6 +18,7 @@ class WeightConf : public ConfMechBase {
   WeightConf(uns _proc_id)
       : ConfMechBase(_proc_id), cnt_btb_miss(0), btb_miss_rate(0.0), low_confidence_cnt(0), cf_op_distance(0.0) {
     conf_mech_stat = new WeightConfStat(_proc_id, this);
+    update_weights();
   }
   // update functions
   void per_op_update(Op* op, Conf_Off_Path_Reason& new_reason) override;
@@ -33,6 +34,8 @@ class WeightConf : public ConfMechBase {
   // resolve cf
   void resolve_cf(Op* op) override;
 
+  int ft_update(const std::vector<Op*>& ops, Conf_Off_Path_Reason& new_reason) override;
+
  private:
   /* global variables for BTB miss-based BP confidence */
   Counter cnt_btb_miss;
@@ -41,6 +44,12 @@ class WeightConf : public ConfMechBase {
   // confidence counter
   uns low_confidence_cnt;
   double cf_op_distance;
+
+  /* increments of the counters, which only change with btb_miss_rate */
+  void update_weights();
+  double cf_weight[4];     // low_confidence_cnt increment of a cf by bp_confidence (3 is highest)
+  double op_weight;        // cf_op_distance increment of a non-cf op
+  double distance_weight;  // low_confidence_cnt increment when cf_op_distance reaches the threshold
 };
 
 #endif  // __CONF_MECH_H__
\ No newline at end of file
@@ -38,6 +38,13 @@
 #include "core.param.def"
 #undef DEF_PARAM
 
+/* Builds configured with -DSCARAB_NUM_CORES=n (make opt1) fix the core count at compile
+   time, so the per-core loops and lookups fold. param_parser.c still sees the variable,
+   which --num_cores must set to n. */
+#if defined(SCARAB_NUM_CORES) && !defined(PARAM_PARSER_STORAGE)
+#define NUM_CORES ((uns)SCARAB_NUM_CORES)
+#endif
+
 /* The values of these parameters are computed from other parameters*/
 extern uns NUM_FUS;
 extern uns NUM_RS;
@@ -0,0 +1,71 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : core_context.h
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : Per-core context handed to the pipeline stages. It bundles
+ *                the per-core state that used to be reached only through the
+ *                "current core" globals set by cmp_set_all_stages.
+ ***************************************************************************************/
+
+#ifndef __CORE_CONTEXT_H__
+#define __CORE_CONTEXT_H__
+
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Types */
+
+struct Thread_struct;
+struct Bp_Data_struct;
+struct Bp_Recovery_Info_struct;
+struct Icache_Stage_struct;
+struct Decode_Stage_struct;
+struct Uop_Cache_Stage_struct;
+struct Map_Stage_struct;
+struct Node_Stage_struct;
+struct Exec_Stage_struct;
+struct Dcache_Stage_struct;
+
+struct Core_Context_struct {
+  uns8 proc_id;
+  struct Thread_struct* td;
+  struct Bp_Data_struct* bp_data;
+  struct Bp_Recovery_Info_struct* bp_recovery_info;
+  struct Icache_Stage_struct* ic;
+  struct Decode_Stage_struct* dec;
+  struct Uop_Cache_Stage_struct* uc;
+  struct Map_Stage_struct* map;
+  struct Node_Stage_struct* node;
+  struct Exec_Stage_struct* exec;
+  struct Dcache_Stage_struct* dc;
+};
+
+/**************************************************************************************/
+/* External variables */
+
+/* context of the core that is being simulated by this host thread */
+extern CORE_LOCAL Core_Context* core_ctx;
+
+#endif /* #ifndef __CORE_CONTEXT_H__ */
@@ -0,0 +1,271 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : crit_path.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Critical-path CPI stack of the retired ops (--crit_path), after
+ *                Fields et al., "Focusing Processor Policies via Critical-Path
+ *                Prediction", ISCA 2001.
+ ***************************************************************************************/
+
+#include "crit_path.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "memory/memory.param.h"
+
+#include "op.h"
+#include "statistics.h"
+
+/*
+ * Each retired op is four events of the dependence graph: fetched (F), dispatched into
+ * the ROB (D), result available (X) and retired (C), at the cycles the op recorded.
+ * The edges into them are
+ *   F <- F of the previous op                    fetch
+ *   F <- X (or decode) of a preceding recovery   br_mispred
+ *   D <- F, D <- D of the previous op            frontend
+ *   D <- C of the op NODE_TABLE_SIZE older        rob_full
+ *   X <- D, X <- X of each producer              fu_contention up to the issue cycle, then
+ *                                                data_dep / dcache / llc / dram for the
+ *                                                execution of the op itself
+ *   C <- X, C <- C of the previous op            commit
+ * The critical predecessor of an event is the edge that arrived last, and every event
+ * carries the cycles of the critical path into it, by category. The graph is built as
+ * the ops retire, so an event inherits its predecessor's breakdown and adds its own
+ * edge; no path is ever walked. Every CRIT_PATH_WINDOW ops the breakdown of the last
+ * retired op is added to the CRIT_PATH stats and all breakdowns restart from zero.
+ */
+
+#define CRIT_PATH_NUM_CATS (CRIT_PATH_COMMIT_CYCLES - CRIT_PATH_FETCH_CYCLES + 1)
+#define CP_CAT(stat) ((stat) - CRIT_PATH_FETCH_CYCLES)
+
+typedef struct Crit_Path_Node_struct {
+  Counter time;
+  uns64 cycles[CRIT_PATH_NUM_CATS]; /* the critical path into this event, by category */
+} Crit_Path_Node;
+
+typedef struct Crit_Path_Entry_struct {
+  Counter op_num; /* 0: empty */
+  Crit_Path_Node done;
+  Crit_Path_Node retire;
+} Crit_Path_Entry;
+
+typedef struct Crit_Path_Data_struct {
+  Crit_Path_Entry* ring; /* the last retired ops, by op_num; at least twice the ROB */
+  uns ring_mask;
+  Crit_Path_Node fetch;    /* of the last retired op */
+  Crit_Path_Node dispatch; /* of the last retired op */
+  Crit_Path_Node redirect; /* where fetch restarted after the recovery of the last retired op */
+  Flag redirect_valid;
+  Counter last_op_num; /* 0 before the first op */
+  uns window_ops;
+} Crit_Path_Data;
+
+static Crit_Path_Data* crit_path_data;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static inline Counter crit_path_time(Counter cycle);
+static inline Crit_Path_Entry* crit_path_entry(Crit_Path_Data* cp, Counter op_num);
+static inline void crit_path_extend(Crit_Path_Node* node, const Crit_Path_Node* pred, Counter time, uns cat);
+static uns crit_path_exec_cat(Op* op);
+static void crit_path_restart(Crit_Path_Data* cp, Op* op);
+
+/**************************************************************************************/
+/* crit_path_init: */
+
+void crit_path_init(uns proc_id) {
+  if (!crit_path_data)
+    crit_path_data = (Crit_Path_Data*)calloc(NUM_CORES, sizeof(Crit_Path_Data));
+  Crit_Path_Data* cp = &crit_path_data[proc_id];
+  ASSERTM(proc_id, CRIT_PATH_WINDOW, "CRIT_PATH_WINDOW must be non-zero\n");
+  uns ring_size = 1;
+  while (ring_size < 2 * NODE_TABLE_SIZE)
+    ring_size <<= 1;
+  cp->ring = (Crit_Path_Entry*)calloc(ring_size, sizeof(Crit_Path_Entry));
+  cp->ring_mask = ring_size - 1;
+}
+
+/**************************************************************************************/
+/* Graph helpers */
+
+/* the op fields of events that did not happen (e.g. of fused ops) are MAX_CTR */
+static inline Counter crit_path_time(Counter cycle) {
+  return cycle == MAX_CTR ? 0 : cycle;
+}
+
+static inline Crit_Path_Entry* crit_path_entry(Crit_Path_Data* cp, Counter op_num) {
+  Crit_Path_Entry* entry = &cp->ring[op_num & cp->ring_mask];
+  return op_num && entry->op_num == op_num ? entry : NULL;
+}
+
+/* crit_path_extend: node happens at time through its critical predecessor pred (node may
+   be pred itself); an event never precedes its predecessor */
+static inline void crit_path_extend(Crit_Path_Node* node, const Crit_Path_Node* pred, Counter time, uns cat) {
+  if (node != pred)
+    memcpy(node->cycles, pred->cycles, sizeof(node->cycles));
+  time = MAX2(time, pred->time);
+  node->cycles[cat] += time - pred->time;
+  node->time = time;
+}
+
+/* crit_path_exec_cat: loads are charged to where they were served; a load that took
+   longer than a dcache hit but did not miss the LLC was served by the MLC or the LLC */
+static uns crit_path_exec_cat(Op* op) {
+  if (op->table_info->mem_type != MEM_LD)
+    return CP_CAT(CRIT_PATH_DATA_DEP_CYCLES);
+  if (op->engine_info.l1_miss)
+    return CP_CAT(CRIT_PATH_DRAM_CYCLES);
+  Counter dcache_cycle = crit_path_time(op->dcache_cycle);
+  if (op->engine_info.mlc_miss ||
+      crit_path_time(op->done_cycle) > dcache_cycle + DCACHE_CYCLES + op->inst_info->extra_ld_latency)
+    return CP_CAT(CRIT_PATH_LLC_CYCLES);
+  return CP_CAT(CRIT_PATH_DCACHE_CYCLES);
+}
+
+/* crit_path_restart: the op does not follow the last retired one (the first op, or op
+   numbers restarted), so the graph starts over at its fetch */
+static void crit_path_restart(Crit_Path_Data* cp, Op* op) {
+  for (uns ii = 0; ii <= cp->ring_mask; ii++)
+    cp->ring[ii].op_num = 0;
+  memset(&cp->fetch, 0, sizeof(cp->fetch));
+  memset(&cp->dispatch, 0, sizeof(cp->dispatch));
+  cp->fetch.time = crit_path_time(op->fetch_cycle);
+  cp->dispatch.time = cp->fetch.time;
+  cp->redirect_valid = FALSE;
+}
+
+/**************************************************************************************/
+/* crit_path_retire: adds the events of a retired op to the graph */
+
+void crit_path_retire(Op* op) {
+  Crit_Path_Data* cp = &crit_path_data[op->proc_id];
+  if (!cp->last_op_num || op->op_num != cp->last_op_num + 1)
+    crit_path_restart(cp, op);
+
+  /* F */
+  if (cp->redirect_valid && cp->redirect.time >= cp->fetch.time)
+    crit_path_extend(&cp->fetch, &cp->redirect, crit_path_time(op->fetch_cycle), CP_CAT(CRIT_PATH_BR_MISPRED_CYCLES));
+  else
+    crit_path_extend(&cp->fetch, &cp->fetch, crit_path_time(op->fetch_cycle), CP_CAT(CRIT_PATH_FETCH_CYCLES));
+  cp->redirect_valid = FALSE;
+
+  /* D */
+  const Crit_Path_Node* pred = &cp->dispatch;
+  uns cat = CP_CAT(CRIT_PATH_FRONTEND_CYCLES);
+  if (cp->fetch.time > pred->time)
+    pred = &cp->fetch;
+  Crit_Path_Entry* rob_head = op->op_num > NODE_TABLE_SIZE ? crit_path_entry(cp, op->op_num - NODE_TABLE_SIZE) : NULL;
+  if (rob_head && rob_head->retire.time > pred->time) {
+    pred = &rob_head->retire;
+    cat = CP_CAT(CRIT_PATH_ROB_FULL_CYCLES);
+  }
+  crit_path_extend(&cp->dispatch, pred, crit_path_time(op->issue_cycle), cat);
+
+  /* X, through the issue of the op. A producer may still occupy the op's own slot, so
+     the slot is only claimed once the X event is written. */
+  pred = &cp->dispatch;
+  for (uns ii = 0; ii < op->oracle_info.num_srcs; ii++) {
+    Crit_Path_Entry* producer = crit_path_entry(cp, op->oracle_info.src_info[ii].op_num);
+    if (producer && producer->done.time > pred->time)
+      pred = &producer->done;
+  }
+  Crit_Path_Entry* entry = &cp->ring[op->op_num & cp->ring_mask];
+  crit_path_extend(&entry->done, pred, crit_path_time(op->sched_cycle), CP_CAT(CRIT_PATH_FU_CONTENTION_CYCLES));
+  crit_path_extend(&entry->done, &entry->done, crit_path_time(op->done_cycle), crit_path_exec_cat(op));
+
+  /* C */
+  Crit_Path_Entry* prev = crit_path_entry(cp, op->op_num - 1);
+  pred = prev && prev->retire.time > entry->done.time ? &prev->retire : &entry->done;
+  crit_path_extend(&entry->retire, pred, crit_path_time(op->retire_cycle), CP_CAT(CRIT_PATH_COMMIT_CYCLES));
+  entry->op_num = op->op_num;
+
+  if (op->table_info->cf_type && op->oracle_info.recover_at_exec) {
+    cp->redirect = entry->done;
+    cp->redirect_valid = TRUE;
+  } else if (op->table_info->cf_type && op->oracle_info.recover_at_decode) {
+    crit_path_extend(&cp->redirect, &cp->fetch, op->decode_cycle, CP_CAT(CRIT_PATH_FRONTEND_CYCLES));
+    cp->redirect_valid = TRUE;
+  }
+
+  cp->last_op_num = op->op_num;
+  if (++cp->window_ops >= CRIT_PATH_WINDOW)
+    crit_path_flush(op->proc_id);
+}
+
+/**************************************************************************************/
+/* crit_path_flush: ends the current window. Its critical path is the one into the last
+   retired op; the next window's paths start from the events already in the graph. */
+
+void crit_path_flush(uns proc_id) {
+  if (!crit_path_data || !crit_path_data[proc_id].window_ops)
+    return;
+  Crit_Path_Data* cp = &crit_path_data[proc_id];
+  Crit_Path_Entry* last = crit_path_entry(cp, cp->last_op_num);
+  ASSERT(proc_id, last);
+  for (uns ii = 0; ii < CRIT_PATH_NUM_CATS; ii++)
+    INC_STAT_EVENT(proc_id, CRIT_PATH_FETCH_CYCLES + ii, last->retire.cycles[ii]);
+  STAT_EVENT(proc_id, CRIT_PATH_WINDOWS);
+
+  for (uns ii = 0; ii <= cp->ring_mask; ii++) {
+    memset(cp->ring[ii].done.cycles, 0, sizeof(cp->ring[ii].done.cycles));
+    memset(cp->ring[ii].retire.cycles, 0, sizeof(cp->ring[ii].retire.cycles));
+  }
+  memset(cp->fetch.cycles, 0, sizeof(cp->fetch.cycles));
+  memset(cp->dispatch.cycles, 0, sizeof(cp->dispatch.cycles));
+  memset(cp->redirect.cycles, 0, sizeof(cp->redirect.cycles));
+  cp->window_ops = 0;
+}
+
+/**************************************************************************************/
+/* crit_path_done: prints the CPI stack of the core */
+
+void crit_path_done(uns proc_id) {
+  static const char* const names[CRIT_PATH_NUM_CATS] = {
+      "fetch", "br_mispred", "frontend", "rob_full", "fu_contention", "data_dep", "dcache", "llc", "dram", "commit"};
+  if (!crit_path_data)
+    return;
+  crit_path_flush(proc_id);
+
+  Counter insts = GET_STAT_EVENT(proc_id, NODE_INST_COUNT);
+  uns64 total = 0;
+  for (uns ii = 0; ii < CRIT_PATH_NUM_CATS; ii++)
+    total += GET_STAT_EVENT(proc_id, CRIT_PATH_FETCH_CYCLES + ii);
+  fprintf(mystdout, "** Core %u critical-path CPI %.3f:", proc_id, insts ? (double)total / insts : 0.0);
+  for (uns ii = 0; ii < CRIT_PATH_NUM_CATS; ii++)
+    fprintf(mystdout, " %s %.3f", names[ii],
+            insts ? (double)GET_STAT_EVENT(proc_id, CRIT_PATH_FETCH_CYCLES + ii) / insts : 0.0);
+  fprintf(mystdout, "\n");
+
+  free(crit_path_data[proc_id].ring);
+  crit_path_data[proc_id].ring = NULL;
+}
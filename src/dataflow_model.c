@@ -0,0 +1,348 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : dataflow_model.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Dataflow limit-study model: streams the on-path ops through register
+ *                and memory dependence tracking only and reports the ideal IPC of
+ *                several instruction windows in one pass
+ ***************************************************************************************/
+
+#include "dataflow_model.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "core.param.h"
+#include "general.param.h"
+#include "prefetcher/pref.param.h"
+
+#include "frontend/frontend.h"
+#include "isa/isa_macros.h"
+
+#include "freq.h"
+#include "model.h"
+#include "sim.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Defines */
+
+/* map.c keys its memory map the same way */
+#define DATAFLOW_WORD_SIZE_LOG 3
+#define DATAFLOW_WORD(va) ((va) >> DATAFLOW_WORD_SIZE_LOG)
+
+/* cycles of the issue slot ring; ops issue at most this far past each other */
+#define DATAFLOW_SLOTS (1 << 16)
+
+/**************************************************************************************/
+/* Global variables */
+
+Dataflow_Model dataflow_model;
+
+/* the ops never outlive one call to dataflow_process_op, so a single op is reused */
+static Op dataflow_op;
+static Table_Info dataflow_table_info;
+static Inst_Info dataflow_inst_info;
+static struct timespec dataflow_start_time;
+
+/**************************************************************************************/
+/* dataflow_parse_windows: reads the window sizes of DATAFLOW_WINDOWS */
+
+static void dataflow_parse_windows(uns* sizes) {
+  char list[MAX_STR_LENGTH + 1];
+  char* name;
+
+  strncpy(list, DATAFLOW_WINDOWS, MAX_STR_LENGTH);
+  list[MAX_STR_LENGTH] = '\0';
+
+  for (name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+    char* end;
+    long size = strtol(name, &end, 0);
+    if (*end || size <= 0)
+      FATAL_ERROR(0, "Invalid window size '%s' in DATAFLOW_WINDOWS\n", name);
+    ASSERTM(0, dataflow_model.num_windows < DATAFLOW_MAX_WINDOWS, "DATAFLOW_WINDOWS lists more than %d windows\n",
+            DATAFLOW_MAX_WINDOWS);
+    sizes[dataflow_model.num_windows++] = size;
+  }
+  ASSERTM(0, dataflow_model.num_windows, "DATAFLOW_WINDOWS lists no window\n");
+}
+
+/**************************************************************************************/
+/* dataflow_issue_slot: returns the first cycle at or after the given one with an issue
+ * slot left and takes that slot. Full cycles point past themselves, and the pointers are
+ * compressed on the way, so a burst of ready ops does not rescan the same full cycles. */
+
+static Counter dataflow_issue_slot(Dataflow_Window* win, Counter cycle) {
+  Counter free_cycle = cycle;
+  Dataflow_Slot* slot;
+
+  for (;;) {
+    slot = &win->slots[free_cycle & (DATAFLOW_SLOTS - 1)];
+    if (slot->cycle != free_cycle || slot->count < DATAFLOW_ISSUE_WIDTH)
+      break;
+    free_cycle = slot->skip;
+  }
+  for (Counter full = cycle; full != free_cycle;) {
+    Dataflow_Slot* full_slot = &win->slots[full & (DATAFLOW_SLOTS - 1)];
+    full = full_slot->skip;
+    full_slot->skip = free_cycle;
+  }
+
+  /* a slot of an older cycle is free again */
+  if (slot->cycle != free_cycle) {
+    slot->cycle = free_cycle;
+    slot->count = 0;
+  }
+  if (++slot->count == DATAFLOW_ISSUE_WIDTH)
+    slot->skip = free_cycle + 1;
+  return free_cycle;
+}
+
+/**************************************************************************************/
+/* dataflow_process_op: schedules an op in every window. An op enters its window when
+ * the op a window size older commits, issues once its register and store sources are
+ * done (and an issue slot is free), is done its latency later and commits in order.
+ * Fetch, branch prediction and the caches are perfect. */
+
+static void dataflow_process_op(Dataflow_Core* core, Op* op) {
+  Table_Info* table_info = op->table_info;
+  Inst_Info* inst_info = op->inst_info;
+  Flag load = table_info->mem_type == MEM_LD;
+  Flag store = table_info->mem_type == MEM_ST;
+  uns latency = load                  ? DATAFLOW_LOAD_LATENCY
+                : DATAFLOW_OP_LATENCY ? DATAFLOW_OP_LATENCY
+                                      : MAX2(abs(inst_info->latency), 1);
+  Counter mem_ready[DATAFLOW_MAX_WINDOWS] = {0};
+  Counter done[DATAFLOW_MAX_WINDOWS];
+  Counter index = core->num_ops++;
+  Addr first_word = 0;
+  Addr num_words = 0;
+
+  if (load || store) {
+    Addr va = op->oracle_info.va;
+    first_word = DATAFLOW_WORD(va);
+    num_words = MIN2(DATAFLOW_WORD(va + MAX2(op->oracle_info.mem_size, 1) - 1) - first_word + 1,
+                     DATAFLOW_MEM_ENTRIES);
+  }
+
+  if (load) {
+    Flag mem_dep = FALSE;
+    for (Addr word = first_word; word < first_word + num_words; word++) {
+      Dataflow_Mem_Entry* entry = &core->mem[word & (DATAFLOW_MEM_ENTRIES - 1)];
+      if (entry->word != word)
+        continue;
+      mem_dep = TRUE;
+      for (uns ii = 0; ii < dataflow_model.num_windows; ii++)
+        mem_ready[ii] = MAX2(mem_ready[ii], entry->ready[ii]);
+    }
+    STAT_EVENT(op->proc_id, DATAFLOW_LOAD_NO_STORE_DEP + mem_dep);
+  }
+
+  for (uns ii = 0; ii < dataflow_model.num_windows; ii++) {
+    Dataflow_Window* win = &core->windows[ii];
+    /* the first ops read ring entries that are not written yet, which hold 0 */
+    Counter ready = MAX2(mem_ready[ii], win->commit[(index - win->size) & win->commit_mask]);
+
+    for (uns jj = 0; jj < table_info->num_src_regs; jj++)
+      ready = MAX2(ready, win->reg_ready[inst_info->srcs[jj].id]);
+    if (DATAFLOW_ISSUE_WIDTH)
+      ready = dataflow_issue_slot(win, ready);
+    done[ii] = ready + latency;
+    for (uns jj = 0; jj < table_info->num_dest_regs; jj++)
+      win->reg_ready[inst_info->dests[jj].id] = done[ii];
+
+    win->last_commit = MAX2(win->last_commit, done[ii]);
+    win->commit[index & win->commit_mask] = win->last_commit;
+  }
+
+  if (store) {
+    for (Addr word = first_word; word < first_word + num_words; word++) {
+      Dataflow_Mem_Entry* entry = &core->mem[word & (DATAFLOW_MEM_ENTRIES - 1)];
+      entry->word = word;
+      memcpy(entry->ready, done, dataflow_model.num_windows * sizeof(Counter));
+    }
+  }
+}
+
+/**************************************************************************************/
+/* dataflow_flush: adds the cycles each window advanced by to its stat */
+
+static void dataflow_flush(uns proc_id) {
+  Dataflow_Core* core = &dataflow_model.cores[proc_id];
+
+  for (uns ii = 0; ii < dataflow_model.num_windows; ii++) {
+    Dataflow_Window* win = &core->windows[ii];
+    INC_STAT_EVENT(proc_id, DATAFLOW_WINDOW_0_CYCLES + ii, win->last_commit - win->reported);
+    win->reported = win->last_commit;
+  }
+}
+
+/**************************************************************************************/
+/* dataflow_init */
+
+void dataflow_init(uns mode) {
+  if (mode == SIMULATION_MODE) {
+    /* the cycles of the warmup ops are not part of the stats */
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      for (uns ii = 0; ii < dataflow_model.num_windows; ii++)
+        dataflow_model.cores[proc_id].windows[ii].reported = dataflow_model.cores[proc_id].windows[ii].last_commit;
+    clock_gettime(CLOCK_MONOTONIC, &dataflow_start_time);
+    return;
+  }
+
+  /* as in the cmp model, the real initialization is done in warmup */
+  uns sizes[DATAFLOW_MAX_WINDOWS];
+  ASSERT(0, mode == WARMUP_MODE);
+  ASSERTM(0, !DUMB_CORE_ON, "The dataflow model cannot run next to a dumb core\n");
+  ASSERTM(0, !CONFIDENCE_ENABLE && !FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE,
+          "The dataflow model has no decoupled frontend (CONFIDENCE_ENABLE, FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE)\n");
+  ASSERTM(0, DATAFLOW_INSTS_PER_CYCLE > 0, "DATAFLOW_INSTS_PER_CYCLE must be positive\n");
+  ASSERTM(0, DATAFLOW_MEM_ENTRIES && !(DATAFLOW_MEM_ENTRIES & (DATAFLOW_MEM_ENTRIES - 1)),
+          "DATAFLOW_MEM_ENTRIES must be a power of two\n");
+  dataflow_parse_windows(sizes);
+
+  freq_init();
+
+  dataflow_model.cores = (Dataflow_Core*)calloc(NUM_CORES, sizeof(Dataflow_Core));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Dataflow_Core* core = &dataflow_model.cores[proc_id];
+
+    core->mem = (Dataflow_Mem_Entry*)calloc(DATAFLOW_MEM_ENTRIES, sizeof(Dataflow_Mem_Entry));
+    for (uns ii = 0; ii < dataflow_model.num_windows; ii++) {
+      Dataflow_Window* win = &core->windows[ii];
+      uns ring_size = 1;
+      while (ring_size < sizes[ii])
+        ring_size <<= 1;
+      win->size = sizes[ii];
+      win->commit_mask = ring_size - 1;
+      win->commit = (Counter*)calloc(ring_size, sizeof(Counter));
+      win->reg_ready = (Counter*)calloc(NUM_REG_IDS, sizeof(Counter));
+      if (DATAFLOW_ISSUE_WIDTH)
+        win->slots = (Dataflow_Slot*)calloc(DATAFLOW_SLOTS, sizeof(Dataflow_Slot));
+    }
+  }
+
+  dataflow_op.table_info = &dataflow_table_info;
+  dataflow_op.inst_info = &dataflow_inst_info;
+  dataflow_op.mbp7_info = NULL;
+}
+
+/**************************************************************************************/
+/* dataflow_reset: */
+
+void dataflow_reset(void) {
+}
+
+/**************************************************************************************/
+/* dataflow_cycle: streams up to DATAFLOW_INSTS_PER_CYCLE instructions of each core
+ * through the windows. As in the bp_only model a "cycle" only paces the main loop;
+ * the cycles of each window are in the DATAFLOW_WINDOW_*_CYCLES stats. */
+
+void dataflow_cycle(void) {
+  Op* op = &dataflow_op;
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (retired_exit[proc_id] || sim_done[proc_id])
+      continue;
+
+    Dataflow_Core* core = &dataflow_model.cores[proc_id];
+    for (uns insts = 0; insts < DATAFLOW_INSTS_PER_CYCLE && !retired_exit[proc_id];) {
+      frontend_fetch_op(proc_id, op);
+      op_count[proc_id]++;
+      uop_count[proc_id]++;
+      STAT_EVENT(proc_id, NODE_UOP_COUNT);
+
+      dataflow_process_op(core, op);
+
+      if (op->exit)
+        retired_exit[proc_id] = TRUE;
+      if (op->eom) {
+        inst_count[proc_id]++;
+        inst_count_fetched[proc_id]++;
+        STAT_EVENT(proc_id, NODE_INST_COUNT);
+        frontend_retire(proc_id, op->inst_uid);
+        insts++;
+        /* stop exactly at the limit so that the stats match the cmp model's */
+        if (INST_LIMIT && inst_count[proc_id] >= inst_limit[proc_id])
+          break;
+      }
+    }
+    dataflow_flush(proc_id);
+  }
+}
+
+/**************************************************************************************/
+/* dataflow_debug: nothing is in flight between cycles */
+
+void dataflow_debug(void) {
+}
+
+/**************************************************************************************/
+/* dataflow_per_core_done: prints the ideal IPC of each window */
+
+void dataflow_per_core_done(uns8 proc_id) {
+  Counter insts = GET_TOTAL_STAT_EVENT(proc_id, NODE_INST_COUNT);
+
+  dataflow_flush(proc_id);
+  fprintf(mystdout, "** Core %u dataflow: %llu insts, ideal IPC by window size:", proc_id, insts);
+  for (uns ii = 0; ii < dataflow_model.num_windows; ii++) {
+    Counter cycles = GET_TOTAL_STAT_EVENT(proc_id, DATAFLOW_WINDOW_0_CYCLES + ii);
+    fprintf(mystdout, " %u: %.3f", dataflow_model.cores[proc_id].windows[ii].size,
+            cycles ? (double)insts / cycles : 0.0);
+  }
+  fprintf(mystdout, "\n");
+}
+
+/**************************************************************************************/
+/* dataflow_done: reports the simulation speed */
+
+void dataflow_done(void) {
+  struct timespec now;
+  Counter insts = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double secs = (now.tv_sec - dataflow_start_time.tv_sec) + (now.tv_nsec - dataflow_start_time.tv_nsec) / 1e9;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    insts += inst_count[proc_id];
+  fprintf(mystdout, "** dataflow: %llu insts in %.2f seconds (%.2f MIPS)\n", insts, secs,
+          secs > 0 ? insts / secs / 1e6 : 0.0);
+}
+
+/**************************************************************************************/
+/* dataflow_warmup: warmup ops fill the windows and the register and store times */
+
+void dataflow_warmup(Op* op) {
+  dataflow_process_op(&dataflow_model.cores[op->proc_id], op);
+}
@@ -0,0 +1,98 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : dataflow_model.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Dataflow limit-study model: streams the on-path ops through register
+ *                and memory dependence tracking only and reports the ideal IPC of
+ *                several instruction windows in one pass
+ ***************************************************************************************/
+
+#ifndef __DATAFLOW_MODEL_H__
+#define __DATAFLOW_MODEL_H__
+
+#include "globals/global_types.h"
+
+#include "op.h"
+
+/**************************************************************************************/
+/* Defines */
+
+#define DATAFLOW_MAX_WINDOWS 8
+
+/**************************************************************************************/
+/* dataflow model data  */
+
+typedef struct Dataflow_Slot_struct {
+  Counter cycle; /* issue cycle the count is for */
+  Counter skip;  /* when the cycle is full: a later cycle such that all cycles in between are full */
+  uns count;     /* ops issued in the cycle */
+} Dataflow_Slot;
+
+typedef struct Dataflow_Window_struct {
+  uns size;             /* ops in flight at most */
+  Counter* reg_ready;   /* [NUM_REG_IDS] cycle the last writer of each register is done */
+  Counter* commit;      /* ring of the commit cycles of the last ops, indexed by op number */
+  uns commit_mask;      /* ring size - 1, the ring holds at least size ops */
+  Dataflow_Slot* slots; /* ring of the issue cycles (only with DATAFLOW_ISSUE_WIDTH) */
+  Counter last_commit;  /* commit cycle of the youngest op */
+  Counter reported;     /* part of last_commit already added to the stats */
+} Dataflow_Window;
+
+typedef struct Dataflow_Mem_Entry_struct {
+  Addr word;                           /* 8-byte word (map.c's MEM_MAP_KEY) of the last store */
+  Counter ready[DATAFLOW_MAX_WINDOWS]; /* cycle that store is done in each window */
+} Dataflow_Mem_Entry;
+
+typedef struct Dataflow_Core_struct {
+  Dataflow_Window windows[DATAFLOW_MAX_WINDOWS];
+  Dataflow_Mem_Entry* mem; /* direct-mapped table of the last stores */
+  Counter num_ops;         /* ops streamed so far */
+} Dataflow_Core;
+
+typedef struct Dataflow_Model_struct {
+  uns num_windows;
+  Dataflow_Core* cores;
+} Dataflow_Model;
+
+/**************************************************************************************/
+/* Global vars */
+
+extern Dataflow_Model dataflow_model;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void dataflow_init(uns mode);
+void dataflow_reset(void);
+void dataflow_cycle(void);
+void dataflow_debug(void);
+void dataflow_per_core_done(uns8);
+void dataflow_done(void);
+void dataflow_warmup(Op*);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __DATAFLOW_MODEL_H__ */
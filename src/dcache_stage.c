@@ -39,6 +39,7 @@
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/pc_prof.h"
 
 #include "core.param.h"
 #include "memory/memory.param.h"
@@ -46,14 +47,17 @@
 #include "prefetcher/pref.param.h"
 
 #include "bp/bp.h"
+#include "memory/coherence.h"
 #include "prefetcher/l2l1pref.h"
 #include "prefetcher/pref_common.h"
 #include "prefetcher/stream_pref.h"
 
 #include "cmp_model.h"
+#include "core_context.h"
 #include "map.h"
 #include "model.h"
 #include "statistics.h"
+#include "tlb.h"
 
 /**************************************************************************************/
 /* Macros */
@@ -64,16 +68,21 @@
 /**************************************************************************************/
 /* Global Variables */
 
-Dcache_Stage* dc = NULL;
+CORE_LOCAL Dcache_Stage* dc = NULL;
 
 /**************************************************************************************/
 /* Prototypes for Inline Methods */
 
+static void dcache_stage_access_ops(Stage_Data* src_sd);
 static inline Flag dcache_stage_addr_unready(Op* op);
 static inline Flag dcache_stage_check_mem_type(Op* op);
 static inline void dcache_stage_remove_src_op(Stage_Data* src_sd, int ii);
+static inline uns dcache_bank(Addr va);
+static inline Flag dcache_inserts_on_access(void);
 
 static inline void dcache_cacheline_hit(Op* op, Addr line_addr, Dcache_Data* line);
+static inline void dcache_cacheline_hit_state(Op* op, Dcache_Data* line);
+static inline void dcache_perfect_fill(Op* op, Addr line_addr, uns latency);
 static inline void dcache_cacheline_miss(Op* op, Addr line_addr);
 
 static inline void dcache_fill_wp_collect_stats(Dcache_Data* line, Mem_Req* req);
@@ -87,8 +96,8 @@ static inline void dcache_fill_process_cacheline(Mem_Req* req, Dcache_Data* data
 /**************************************************************************************/
 /* External Interfaces for CMP Model */
 
-void set_dcache_stage(Dcache_Stage* new_dc) {
-  dc = new_dc;
+void set_dcache_stage(Core_Context* ctx) {
+  dc = ctx->dc;
 }
 
 void init_dcache_stage(uns8 proc_id, const char* name) {
@@ -101,6 +110,10 @@ void init_dcache_stage(uns8 proc_id, const char* name) {
   dc->sd.name = (char*)strdup(name);
   dc->sd.max_op_count = STAGE_MAX_OP_COUNT;
   dc->sd.ops = (Op**)malloc(sizeof(Op*) * STAGE_MAX_OP_COUNT);
+  dc->access_slot = (uns*)malloc(sizeof(uns) * STAGE_MAX_OP_COUNT);
+  dc->access_va = (Addr*)malloc(sizeof(Addr) * STAGE_MAX_OP_COUNT);
+  dc->access_line_addr = (Addr*)malloc(sizeof(Addr) * STAGE_MAX_OP_COUNT);
+  dc->access_line = (void**)malloc(sizeof(void*) * STAGE_MAX_OP_COUNT);
 
   /* initialize the cache structure */
   init_cache(&dc->dcache, "DCACHE", DCACHE_SIZE, DCACHE_ASSOC, DCACHE_LINE_SIZE, sizeof(Dcache_Data), DCACHE_REPL);
@@ -147,7 +160,24 @@ void debug_dcache_stage() {
   print_op_array(GLOBAL_DEBUG_STREAM, dc->sd.ops, STAGE_MAX_OP_COUNT, STAGE_MAX_OP_COUNT);
 }
 
-void update_dcache_stage(Stage_Data* src_sd) {
+void update_dcache_stage(Core_Context* ctx, Stage_Data* src_sd) {
+  set_dcache_stage(ctx);
+  if (TLB_ON)
+    update_tlb(dc->proc_id);
+  /* an empty stage fed by an empty stage has no op to move or access */
+  if (src_sd->op_count || dc->sd.op_count)
+    dcache_stage_access_ops(src_sd);
+
+  /* prefetcher update */
+  if (STREAM_PREFETCH_ON)
+    update_pref_queue();
+  if (L2WAY_PREF && !L1PREF_IMMEDIATE)
+    update_l2way_pref_req_queue();
+  if (L2MARKV_PREF_ON && !L1MARKV_PREF_IMMEDIATE)
+    update_l2markv_pref_req_queue();
+}
+
+static void dcache_stage_access_ops(Stage_Data* src_sd) {
   /* phase 1 - move ops into the dcache stage */
   ASSERT(dc->proc_id, src_sd->max_op_count == dc->sd.max_op_count);
   for (uns ii = 0; ii < src_sd->max_op_count; ii++) {
@@ -197,46 +227,72 @@ void update_dcache_stage(Stage_Data* src_sd) {
     ASSERTM(dc->proc_id, cycle_count >= op->exec_cycle, "o:%s  %s\n", unsstr64(op->op_num), Op_State_str(op->state));
   }
 
-  /* phase 2 - check the dcache port availability and do dcache access */
-  int start_op_count = dc->sd.op_count;
-  Counter last_oldest_op_num = 0;
-  for (uns ii = 0; ii < start_op_count; ii++) {
-    /* update in program order (make things easier) */
-    uns oldest_index = 0;
-    Counter oldest_op_num = MAX_CTR;
-    // TODO: adjust this O(n2) algorithm by getting the program order outside first
-    for (uns jj = 0; jj < dc->sd.max_op_count; jj++) {
-      if (dc->sd.ops[jj] && dc->sd.ops[jj]->op_num > last_oldest_op_num && dc->sd.ops[jj]->op_num < oldest_op_num) {
-        oldest_op_num = dc->sd.ops[jj]->op_num;
-        oldest_index = jj;
-      }
-    }
-    last_oldest_op_num = oldest_op_num;
+  /* phase 2 - in program order, check the dcache port availability of each op */
+  uns num_ops = 0;
+  for (uns ii = 0; num_ops < (uns)dc->sd.op_count && ii < dc->sd.max_op_count; ii++) {
+    Op* op = dc->sd.ops[ii];
+    if (!op)
+      continue;
+    // insertion sort by op_num, the stage holds only a few ops
+    uns jj = num_ops++;
+    for (; jj > 0 && dc->sd.ops[dc->access_slot[jj - 1]]->op_num > op->op_num; jj--)
+      dc->access_slot[jj] = dc->access_slot[jj - 1];
+    dc->access_slot[jj] = ii;
+  }
+  ASSERT(dc->proc_id, num_ops == dc->sd.op_count);
 
-    ASSERT(dc->proc_id, oldest_op_num < MAX_CTR);
-    Op* op = dc->sd.ops[oldest_index];
+  uns num_access = 0;
+  for (uns kk = 0; kk < num_ops; kk++) {
+    uns slot = dc->access_slot[kk];
+    Op* op = dc->sd.ops[slot];
 
     // if the op is replaying, squish it
     if (op->replay && op->exec_cycle == MAX_CTR) {
-      dc->sd.ops[oldest_index] = NULL;
+      dc->sd.ops[slot] = NULL;
       dc->sd.op_count--;
       ASSERT(dc->proc_id, dc->sd.op_count >= 0);
       continue;
     }
 
+    // the op waits in the stage until its translation is available
+    if (TLB_ON && !PERFECT_DCACHE && !tlb_translate(dc->proc_id, op->oracle_info.va, FALSE)) {
+      op->state = OS_WAIT_DCACHE;
+      STAT_EVENT(dc->proc_id, DTLB_STALL_CYCLES);
+      continue;
+    }
+
     /* check on the availability of a read port for the given bank */
-    // the bank bits are the lowest order cache index bits
-    uns bank = op->oracle_info.va >> dc->dcache.shift_bits & N_BIT_MASK(LOG2(DCACHE_BANKS));
+    uns bank = dcache_bank(op->oracle_info.va);
     DEBUG(dc->proc_id, "check_read and write port availiabilty mem_type:%s bank:%d \n",
           (op->table_info->mem_type == MEM_ST) ? "ST" : "LD", bank);
     if (!PERFECT_DCACHE && ((op->table_info->mem_type == MEM_ST && !get_write_port(&dc->ports[bank])) ||
                             (op->table_info->mem_type != MEM_ST && !get_read_port(&dc->ports[bank])))) {
       op->state = OS_WAIT_DCACHE;
+      // a bank conflict if an older op of this cycle got a port of the same bank
+      for (uns jj = 0; jj < num_access; jj++) {
+        if (dcache_bank(dc->access_va[jj]) == bank) {
+          STAT_EVENT(dc->proc_id, DCACHE_BANK_CONFLICT);
+          break;
+        }
+      }
       continue;
     }
 
     // memory ops are marked as scheduled so that they can be removed from the node->rdy_list
     op->state = OS_SCHEDULED;
+    dc->access_slot[num_access] = slot;  // num_access <= kk, so no unvisited slot is overwritten
+    dc->access_va[num_access] = op->oracle_info.va;
+    num_access++;
+  }
+
+  /* phase 3 - do the dcache accesses in program order. Unless a mechanism inserts into
+     the dcache in the middle of the accesses, they only ever see each other's replacement
+     updates, so their lookups are done in one batch */
+  Flag batch = num_access > 1 && !PERFECT_DCACHE && !dcache_inserts_on_access();
+  if (batch)
+    cache_access_multi(&dc->dcache, num_access, dc->access_va, dc->access_line_addr, dc->access_line, TRUE);
+  for (uns kk = 0; kk < num_access; kk++) {
+    Op* op = dc->sd.ops[dc->access_slot[kk]];
 
     // ideal l2 l1 prefetcher bring l1 data immediately
     if (IDEAL_L2_L1_PREFETCHER)
@@ -244,7 +300,13 @@ void update_dcache_stage(Stage_Data* src_sd) {
 
     /* now access the dcache with it */
     Addr line_addr;
-    Dcache_Data* line = (Dcache_Data*)cache_access(&dc->dcache, op->oracle_info.va, &line_addr, TRUE);
+    Dcache_Data* line;
+    if (batch) {
+      line_addr = dc->access_line_addr[kk];
+      line = (Dcache_Data*)dc->access_line[kk];
+    } else {
+      line = (Dcache_Data*)cache_access(&dc->dcache, op->oracle_info.va, &line_addr, TRUE);
+    }
     op->dcache_cycle = cycle_count;
     dc->idle_cycle = MAX2(dc->idle_cycle, cycle_count + DCACHE_CYCLES);
 
@@ -281,21 +343,13 @@ void update_dcache_stage(Stage_Data* src_sd) {
     }
     dcache_cacheline_miss(op, line_addr);
   }
-
-  /* prefetcher update */
-  if (STREAM_PREFETCH_ON)
-    update_pref_queue();
-  if (L2WAY_PREF && !L1PREF_IMMEDIATE)
-    update_l2way_pref_req_queue();
-  if (L2MARKV_PREF_ON && !L1MARKV_PREF_IMMEDIATE)
-    update_l2markv_pref_req_queue();
 }
 
 /**************************************************************************************/
 /* External API for architectural cache */
 
 Flag dcache_fill_line(Mem_Req* req) {
-  set_dcache_stage(&cmp_model.dcache_stage[req->proc_id]);
+  set_dcache_stage(&cmp_model.core_context[req->proc_id]);
   Counter old_cycle_count = cycle_count;  // FIXME HACK!
   cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[req->proc_id]);
 
@@ -304,12 +358,14 @@ Flag dcache_fill_line(Mem_Req* req) {
   ASSERT(dc->proc_id, req->op_count == req->op_uniques.count);
 
   /* if it can't get a write port, fail */
-  uns bank = req->addr >> dc->dcache.shift_bits & N_BIT_MASK(LOG2(DCACHE_BANKS));
+  uns bank = dcache_bank(req->addr);
   if (!get_write_port(&dc->ports[bank])) {
     cycle_count = old_cycle_count;
     STAT_EVENT(dc->proc_id, DCACHE_FILL_PORT_UNAVAILABLE_ONPATH + req->off_path);
     return FAILURE;
   }
+  if (PARALLEL_CORES && PARALLEL_SLACK)
+    cmp_slack_late_fill(dc->proc_id);
 
   /* get new line in the cache */
   Dcache_Data* data = dcache_fill_get_cacheline(req);
@@ -346,6 +402,9 @@ Flag dcache_fill_line(Mem_Req* req) {
 
   /* update cacheline fields and wake up dependent ops */
   dcache_fill_process_cacheline(req, data);
+  HIST_RECORD(dc->proc_id, DCACHE_MISS_LATENCY, req->type, cycle_count - req->emitted_cycle);
+  if (PC_PROF && req->type == MRT_DFETCH && !req->off_path)
+    pc_prof_load(dc->proc_id, req->oldest_op_addr, req->mlc_miss, req->l1_miss, cycle_count - req->emitted_cycle);
 
   cycle_count = old_cycle_count;
   return SUCCESS;
@@ -361,9 +420,40 @@ Flag do_oracle_dcache_access(Op* op, Addr* line_addr) {
     return FALSE;
 }
 
+/* dcache_wrong_path_lite_access: the dcache access (and miss request) of an off-path
+   load at its oracle address under WRONG_PATH_LITE, where the load is never executed.
+   The request carries no op, since the op is freed right after. */
+void dcache_wrong_path_lite_access(Op* op) {
+  Addr line_addr;
+  Dcache_Data* line = (Dcache_Data*)cache_access(&dc->dcache, op->oracle_info.va, &line_addr, TRUE);
+  if (line || PERFECT_DCACHE) {
+    STAT_EVENT(dc->proc_id, WRONG_PATH_LITE_DCACHE_HIT);
+    if (line && PREF_FRAMEWORK_ON && PREF_UPDATE_ON_WRONGPATH && !line->HW_prefetch)
+      pref_dl0_hit(line_addr, op->inst_info->addr);
+  } else if (model->mem == MODEL_MEM && new_mem_req(MRT_DFETCH, dc->proc_id, line_addr, DCACHE_LINE_SIZE,
+                                                    DCACHE_CYCLES - 1, NULL, dcache_fill_line, unique_count, 0)) {
+    STAT_EVENT(dc->proc_id, WRONG_PATH_LITE_DCACHE_MISS);
+    if (PREF_UPDATE_ON_WRONGPATH)
+      pref_dl0_miss(line_addr, op->inst_info->addr);
+  } else {
+    STAT_EVENT(dc->proc_id, WRONG_PATH_LITE_DCACHE_DROPPED);
+  }
+}
+
 /**************************************************************************************/
 /* Inline Methods */
 
+/* the bank bits are the lowest order cache index bits */
+static inline uns dcache_bank(Addr va) {
+  return va >> dc->dcache.shift_bits & N_BIT_MASK(LOG2(DCACHE_BANKS));
+}
+
+/* whether a dcache access can insert lines into the dcache before the next access
+   of the same cycle is looked up (the ideal and dcache-side prefetchers) */
+static inline Flag dcache_inserts_on_access(void) {
+  return IDEAL_L2_L1_PREFETCHER || DC_PREF_CACHE_ENABLE || L2L1PREF_ON || L2WAY_PREF || L2MARKV_PREF_ON;
+}
+
 static inline void dcache_stage_remove_src_op(Stage_Data* src_sd, int ii) {
   src_sd->ops[ii] = NULL;
   src_sd->op_count--;
@@ -555,14 +645,26 @@ static inline void dcache_cacheline_hit(Op* op, Addr line_addr, Dcache_Data* lin
     STAT_EVENT(op->proc_id, DCACHE_HIT_OFFPATH);
   }
 
-  /* update cacheline state */
+  if (COHERENCE_PROTOCOL != COHERENCE_PROTOCOL_NONE && !op->off_path && op->table_info->mem_type == MEM_ST)
+    coh_store_hit(op->proc_id, line_addr);
+  dcache_cacheline_hit_state(op, line);
+}
+
+/* dcache_cacheline_hit_state: updates the line an op hits and schedules the op */
+static inline void dcache_cacheline_hit_state(Op* op, Dcache_Data* line) {
   op->done_cycle = cycle_count + DCACHE_CYCLES + op->inst_info->extra_ld_latency;
+  /* under PERFECT_FAST_PATH the line may still be on its way from the perfect level, which
+     only the ops that would have waited for a fill wait for */
+  Mem_Type mem_type = op->table_info->mem_type;
+  Flag blocks = mem_type == MEM_ST ? !STORES_DO_NOT_BLOCK_WINDOW
+                                   : mem_type == MEM_LD || (mem_type == MEM_WH && !PREFS_DO_NOT_BLOCK_WINDOW);
+  if (PERFECT_FAST_PATH && blocks)
+    op->done_cycle = MAX2(op->done_cycle, line->rdy_cycle + op->inst_info->extra_ld_latency);
   line->read_count[op->off_path] = line->read_count[op->off_path] + (op->table_info->mem_type == MEM_LD);
   line->write_count[op->off_path] = line->write_count[op->off_path] + (op->table_info->mem_type == MEM_ST);
   line->misc_state = (line->misc_state & 2) | op->off_path;
-  if (!op->off_path) {
+  if (!op->off_path)
     line->dirty |= op->table_info->mem_type == MEM_ST;
-  }
 
   /* wake up source inst if the op is completed */
   if (op->table_info->mem_type != MEM_ST) {
@@ -571,6 +673,29 @@ static inline void dcache_cacheline_hit(Op* op, Addr line_addr, Dcache_Data* lin
   }
 }
 
+/* dcache_perfect_fill: PERFECT_FAST_PATH miss, the line is inserted right away and
+   becomes usable after the latency of the perfect level */
+static inline void dcache_perfect_fill(Op* op, Addr line_addr, uns latency) {
+  Addr dummy_line_addr, repl_line_addr;
+  Dcache_Data* line = (Dcache_Data*)cache_insert(&dc->dcache, dc->proc_id, line_addr, &dummy_line_addr,
+                                                 &repl_line_addr);
+  memset(line, 0, sizeof(Dcache_Data));
+  line->misc_state = op->off_path | op->off_path << 1;
+  line->fetched_by_offpath = op->off_path;
+  line->fetch_cycle = cycle_count;
+  line->rdy_cycle = cycle_count + DCACHE_CYCLES + latency;
+
+  if (!op->off_path) {
+    STAT_EVENT(op->proc_id, DCACHE_MISS);
+    STAT_EVENT(op->proc_id, DCACHE_MISS_ONPATH);
+    op->oracle_info.dcmiss = TRUE;
+  } else {
+    STAT_EVENT(op->proc_id, DCACHE_MISS_OFFPATH);
+  }
+  STAT_EVENT(op->proc_id, DCACHE_FILL);
+  dcache_cacheline_hit_state(op, line);
+}
+
 static inline void dcache_cacheline_miss(Op* op, Addr line_addr) {
   if (op->table_info->mem_type == MEM_ST)
     STAT_EVENT(op->proc_id, POWER_DCACHE_WRITE_MISS);
@@ -580,6 +705,12 @@ static inline void dcache_cacheline_miss(Op* op, Addr line_addr) {
   if (CACHE_STAT_ENABLE)
     dc_miss_stat(op);
 
+  uns perfect_latency;
+  if (model->mem == MODEL_MEM && mem_perfect_latency(dc->proc_id, line_addr, &perfect_latency)) {
+    dcache_perfect_fill(op, line_addr, perfect_latency);
+    return;
+  }
+
   Flag wrongpath_dcmiss = FALSE;
 
   switch (op->table_info->mem_type) {
@@ -794,6 +925,7 @@ static inline void dcache_fill_process_cacheline(Mem_Req* req, Dcache_Data* data
   data->offpath_op_unique = req->oldest_op_unique_num;
   data->fetch_cycle = cycle_count;
   data->onpath_use_cycle = (req->type == MRT_DPRF || req->off_path) ? 0 : cycle_count;
+  data->rdy_cycle = 0;
 
   if (req->type == MRT_DPRF) {  // cmp FIXME
     data->HW_prefetch = TRUE;
@@ -804,17 +936,13 @@ static inline void dcache_fill_process_cacheline(Mem_Req* req, Dcache_Data* data
   }
 
   /* process req op */
-  Op** op_p = (Op**)list_start_head_traversal(&req->op_ptrs);
-  Counter* op_unique = (Counter*)list_start_head_traversal(&req->op_uniques);
-  for (; op_p;
-       op_p = (Op**)list_next_element(&req->op_ptrs), op_unique = (Counter*)list_next_element(&req->op_uniques)) {
-    Op* op = *op_p;
+  for (int ii = 0; ii < req->op_ptrs.count; ii++) {
+    Op* op = RING_AT(&req->op_ptrs, Op*, ii);
     ASSERT(dc->proc_id, op);
-    ASSERT(dc->proc_id, op_unique);
     ASSERT(dc->proc_id, dc->proc_id == op->proc_id);
     ASSERT(dc->proc_id, op->proc_id == req->proc_id);
 
-    if (op->unique_num != *op_unique || !op->op_pool_valid) {
+    if (op->unique_num != RING_AT(&req->op_uniques, Counter, ii) || !op->op_pool_valid) {
       continue;
     }
 
@@ -54,6 +54,12 @@ typedef struct Dcache_Stage_struct {
   Flag mem_blocked;   /* Are memory request buffers (aka MSHRs) full? */
 
   char rand_wb_state[31]; /* state of random number generator for random writebacks */
+
+  /* per cycle scratch of update_dcache_stage, one entry per slot of sd */
+  uns* access_slot;       /* slots of the ops that access the dcache, in program order */
+  Addr* access_va;        /* their addresses */
+  Addr* access_line_addr; /* their line addresses (from the batched lookup) */
+  void** access_line;     /* their lines (from the batched lookup) */
 } Dcache_Stage;
 
 typedef struct Dcache_Data_struct {
@@ -80,20 +86,21 @@ typedef struct Dcache_Data_struct {
 /**************************************************************************************/
 /* External variables */
 
-extern Dcache_Stage* dc;
+extern CORE_LOCAL Dcache_Stage* dc;
 
 /**************************************************************************************/
 /* Prototypes */
 
-void set_dcache_stage(Dcache_Stage*);
+void set_dcache_stage(Core_Context*);
 void init_dcache_stage(uns8, const char*);
 void reset_dcache_stage(void);
 void recover_dcache_stage(void);
 void debug_dcache_stage(void);
-void update_dcache_stage(Stage_Data*);
+void update_dcache_stage(Core_Context*, Stage_Data*);
 
 Flag dcache_fill_line(Mem_Req*);
 Flag do_oracle_dcache_access(Op*, Addr*);
+void dcache_wrong_path_lite_access(Op*);
 
 /**************************************************************************************/
 
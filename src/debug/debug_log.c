@@ -0,0 +1,339 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : debug/debug_log.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Binary debug log (--debug_log_file): the debug macros write the format
+ *                string id and the raw arguments, bin/scarab_debuglog.py formats them.
+ ***************************************************************************************/
+
+#include "debug/debug_log.h"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+
+#include "general.param.h"
+
+/**************************************************************************************
+
+Formatting every debug message (and flushing it) is what makes debug runs
+slow. With debug_log_file the message is only encoded: the first message of
+every call site writes a site record with the file, line, debug flag and
+format string, and every message writes an event record with the site id,
+the progress counters and the raw arguments the format string consumes.
+The stream is buffered and never flushed by the simulator.
+
+File format (native endianness):
+header: char magic[8] "SCARDBG", uns32 version
+then records, each uns8 tag, uns16 payload size, payload:
+site (tag 1):  uns32 id, uns32 line, uns8 lean, then the file, flag and
+               format strings
+event (tag 2): uns32 site id, uns32 proc_id, uns64 op, inst and cycle
+               counts, then one value per argument consumed by the format
+               string: strings as strings, floating point as double and
+               everything else (including * widths) as 64-bit integers
+strings are an uns16 length followed by the bytes (no terminator)
+
+An event with a truncated argument list (very long strings) is cut at the
+record size limit; the formatter prints the missing arguments as '?'.
+
+***************************************************************************************/
+
+#define DEBUG_LOG_MAGIC "SCARDBG"
+#define DEBUG_LOG_VERSION 1
+#define DEBUG_LOG_SITE_TAG 1
+#define DEBUG_LOG_EVENT_TAG 2
+#define DEBUG_LOG_MAX_PAYLOAD 4096
+#define DEBUG_LOG_SITES_INIT_LOG2 10
+#define DEBUG_LOG_STREAM_BUF_SIZE (1 << 20)
+
+typedef struct Debug_Log_Site_struct {
+  const char* fmt;
+  const char* file;
+  uns line;
+  uns id;
+} Debug_Log_Site;
+
+typedef struct Debug_Log_Record_struct {
+  uns8 data[3 + DEBUG_LOG_MAX_PAYLOAD];
+  uns size;
+  Flag full;
+} Debug_Log_Record;
+
+/**************************************************************************************/
+/* Global variables */
+
+Flag debug_log_on = FALSE;
+
+static FILE* debug_log_stream = NULL;
+static char* debug_log_stream_buf = NULL;
+
+/* call sites seen so far, open-addressed on the format string pointer and kept at most half full */
+static Debug_Log_Site* debug_log_sites = NULL;
+static uns debug_log_sites_log2 = 0;
+static uns debug_log_num_sites = 0;
+
+/* parallel cores may print at the same time */
+static pthread_mutex_t debug_log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**************************************************************************************/
+/* Static prototypes */
+
+static void record_start(Debug_Log_Record* rec, uns8 tag);
+static void record_put(Debug_Log_Record* rec, const void* src, uns size);
+static void record_put_string(Debug_Log_Record* rec, const char* str);
+static void record_put_args(Debug_Log_Record* rec, const char* fmt, va_list ap);
+static void record_write(Debug_Log_Record* rec);
+static uns site_hash(const char* fmt, uns line, uns log2);
+static void sites_grow(void);
+static uns site_id(const char* file, uns line, const char* flag, Flag lean, const char* fmt);
+
+/**************************************************************************************/
+/* debug_log_init */
+
+void debug_log_init(void) {
+  if (!DEBUG_LOG_FILE)
+    return;
+  debug_log_stream = file_tag_fopen(OUTPUT_DIR, DEBUG_LOG_FILE, "wb");
+  ASSERTM(0, debug_log_stream, "Could not open debug log %s\n", DEBUG_LOG_FILE);
+  debug_log_stream_buf = (char*)malloc(DEBUG_LOG_STREAM_BUF_SIZE);
+  setvbuf(debug_log_stream, debug_log_stream_buf, _IOFBF, DEBUG_LOG_STREAM_BUF_SIZE);
+
+  char magic[8] = DEBUG_LOG_MAGIC;
+  uns32 version = DEBUG_LOG_VERSION;
+  fwrite(magic, sizeof(magic), 1, debug_log_stream);
+  fwrite(&version, sizeof(version), 1, debug_log_stream);
+  debug_log_on = TRUE;
+}
+
+/**************************************************************************************/
+/* debug_log_write */
+
+void debug_log_write(const char* file, uns line, const char* flag, Flag lean, uns proc_id, const char* fmt, ...) {
+  Debug_Log_Record rec;
+  va_list ap;
+
+  pthread_mutex_lock(&debug_log_lock);
+  uns32 id = site_id(file, line, flag, lean, fmt);
+  uns32 proc = proc_id;
+  record_start(&rec, DEBUG_LOG_EVENT_TAG);
+  record_put(&rec, &id, sizeof(id));
+  record_put(&rec, &proc, sizeof(proc));
+  record_put(&rec, &op_count[proc_id], sizeof(Counter));
+  record_put(&rec, &inst_count[proc_id], sizeof(Counter));
+  record_put(&rec, &cycle_count, sizeof(Counter));
+  va_start(ap, fmt);
+  record_put_args(&rec, fmt, ap);
+  va_end(ap);
+  record_write(&rec);
+  pthread_mutex_unlock(&debug_log_lock);
+}
+
+/**************************************************************************************/
+/* debug_log_done */
+
+void debug_log_done(void) {
+  if (!debug_log_on)
+    return;
+  pthread_mutex_lock(&debug_log_lock);
+  debug_log_on = FALSE;
+  fclose(debug_log_stream);
+  debug_log_stream = NULL;
+  free(debug_log_stream_buf);
+  debug_log_stream_buf = NULL;
+  pthread_mutex_unlock(&debug_log_lock);
+}
+
+/**************************************************************************************/
+/* record encoding */
+
+static void record_start(Debug_Log_Record* rec, uns8 tag) {
+  rec->data[0] = tag;
+  rec->size = 3;
+  rec->full = FALSE;
+}
+
+/* values that do not fit are dropped along with everything after them */
+static void record_put(Debug_Log_Record* rec, const void* src, uns size) {
+  if (rec->full || rec->size + size > sizeof(rec->data)) {
+    rec->full = TRUE;
+    return;
+  }
+  memcpy(&rec->data[rec->size], src, size);
+  rec->size += size;
+}
+
+static void record_put_string(Debug_Log_Record* rec, const char* str) {
+  if (!str)
+    str = "(null)";
+  uns16 length = MIN2(strlen(str), DEBUG_LOG_MAX_PAYLOAD / 4);
+  record_put(rec, &length, sizeof(length));
+  record_put(rec, str, length);
+}
+
+/* consumes the arguments the way printf would for fmt */
+static void record_put_args(Debug_Log_Record* rec, const char* fmt, va_list ap) {
+  for (const char* c = fmt; *c; c++) {
+    if (*c != '%')
+      continue;
+    c++;
+    while (*c && strchr("-+ #0'", *c))
+      c++;
+    for (; *c && (isdigit(*c) || *c == '.' || *c == '*'); c++) {
+      if (*c == '*') {
+        int64 width = va_arg(ap, int);
+        record_put(rec, &width, sizeof(width));
+      }
+    }
+    uns longs = 0;
+    Flag long_double = FALSE;
+    for (; *c && strchr("hlLqjzt", *c); c++) {
+      if (*c == 'L')
+        long_double = TRUE;
+      else if (*c != 'h')
+        longs++;
+    }
+
+    switch (*c) {
+      case 'd':
+      case 'i': {
+        int64 value = longs > 1 ? va_arg(ap, long long) : longs ? va_arg(ap, long) : va_arg(ap, int);
+        record_put(rec, &value, sizeof(value));
+        break;
+      }
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'c': {
+        uns64 value = longs > 1 ? va_arg(ap, unsigned long long)
+                                : longs ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+        record_put(rec, &value, sizeof(value));
+        break;
+      }
+      case 'p': {
+        uns64 value = (uintptr_t)va_arg(ap, void*);
+        record_put(rec, &value, sizeof(value));
+        break;
+      }
+      case 'a':
+      case 'A':
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G': {
+        double value = long_double ? (double)va_arg(ap, long double) : va_arg(ap, double);
+        record_put(rec, &value, sizeof(value));
+        break;
+      }
+      case 's':
+        record_put_string(rec, va_arg(ap, const char*));
+        break;
+      case 'n':
+        va_arg(ap, void*);
+        break;
+      case '\0':
+        return;
+      default:
+        break;
+    }
+  }
+}
+
+static void record_write(Debug_Log_Record* rec) {
+  uns16 payload = rec->size - 3;
+  memcpy(&rec->data[1], &payload, sizeof(payload));
+  fwrite(rec->data, rec->size, 1, debug_log_stream);
+}
+
+/**************************************************************************************/
+/* call sites */
+
+static uns site_hash(const char* fmt, uns line, uns log2) {
+  uns64 key = ((uns64)(uintptr_t)fmt ^ ((uns64)line << 48)) * 0x9E3779B97F4A7C15ULL;
+  return (uns)(key >> (64 - log2));
+}
+
+static void sites_grow(void) {
+  Debug_Log_Site* old = debug_log_sites;
+  uns old_size = debug_log_sites_log2 ? 1 << debug_log_sites_log2 : 0;
+  debug_log_sites_log2 = debug_log_sites_log2 ? debug_log_sites_log2 + 1 : DEBUG_LOG_SITES_INIT_LOG2;
+  debug_log_sites = (Debug_Log_Site*)calloc(1 << debug_log_sites_log2, sizeof(Debug_Log_Site));
+  uns mask = N_BIT_MASK(debug_log_sites_log2);
+  for (uns i = 0; i < old_size; i++) {
+    if (!old[i].fmt)
+      continue;
+    uns idx = site_hash(old[i].fmt, old[i].line, debug_log_sites_log2);
+    while (debug_log_sites[idx].fmt)
+      idx = (idx + 1) & mask;
+    debug_log_sites[idx] = old[i];
+  }
+  free(old);
+}
+
+/* the same format literal can be shared by several sites, so a site is its format string, file and line */
+static uns site_id(const char* file, uns line, const char* flag, Flag lean, const char* fmt) {
+  if (2 * (debug_log_num_sites + 1) > (debug_log_sites_log2 ? 1u << debug_log_sites_log2 : 0))
+    sites_grow();
+  uns mask = N_BIT_MASK(debug_log_sites_log2);
+  uns idx = site_hash(fmt, line, debug_log_sites_log2);
+  for (; debug_log_sites[idx].fmt; idx = (idx + 1) & mask) {
+    Debug_Log_Site* site = &debug_log_sites[idx];
+    if (site->fmt == fmt && site->line == line && site->file == file)
+      return site->id;
+  }
+
+  Debug_Log_Site* site = &debug_log_sites[idx];
+  site->fmt = fmt;
+  site->file = file;
+  site->line = line;
+  site->id = debug_log_num_sites++;
+
+  Debug_Log_Record rec;
+  uns32 id = site->id;
+  uns32 line32 = line;
+  uns8 lean8 = lean;
+  record_start(&rec, DEBUG_LOG_SITE_TAG);
+  record_put(&rec, &id, sizeof(id));
+  record_put(&rec, &line32, sizeof(line32));
+  record_put(&rec, &lean8, sizeof(lean8));
+  record_put_string(&rec, file);
+  record_put_string(&rec, flag);
+  record_put_string(&rec, fmt);
+  record_write(&rec);
+  return site->id;
+}
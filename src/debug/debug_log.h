@@ -0,0 +1,65 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : debug/debug_log.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Binary debug log (--debug_log_file): the debug macros write the format
+ *                string id and the raw arguments, bin/scarab_debuglog.py formats them.
+ ***************************************************************************************/
+
+#ifndef __DEBUG_LOG_H__
+#define __DEBUG_LOG_H__
+
+#include "globals/global_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************/
+/* Global variables */
+
+/* set by debug_log_init when debug_log_file is given */
+extern Flag debug_log_on;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void debug_log_init(void);
+
+/* Appends one debug message. lean messages were printed without the
+   location/progress prefix. */
+void debug_log_write(const char* file, uns line, const char* flag, Flag lean, uns proc_id, const char* fmt, ...)
+    __attribute__((format(printf, 6, 7)));
+
+void debug_log_done(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**************************************************************************************/
+
+#endif /* #ifndef __DEBUG_LOG_H__ */
@@ -38,6 +38,13 @@ output when
 - DEBUG_FEATURE is on, and
 - simulation progress is withing the debug range specified by
   DEBUG_INST_START, DEBUG_INST_STOP, and other similar parameters.
+
+Configuring with -DSCARAB_DEBUG_GROUPS="DEBUG_FEATURE;..." keeps the debug
+output of the listed groups only, in every build type (including the
+optimized ones): the call sites of the other groups compile out.
+
+With --debug_log_file the messages go to a binary log that
+bin/scarab_debuglog.py formats offline (see debug/debug_log.c).
 ***************************************************************************************/
 
 #ifndef __DEBUG_MACROS_H__
@@ -49,6 +56,7 @@ output when
 #include "globals/utils.h"
 
 #include "debug/debug.param.h"
+#include "debug/debug_log.h"
 
 #include "freq.h"
 
@@ -60,7 +68,7 @@ output when
    ((freq_time() >= DEBUG_TIME_START) && (!DEBUG_TIME_STOP || freq_time() <= DEBUG_TIME_STOP)) ||                 \
    ((op_count[proc_id] >= DEBUG_OP_START) && (!DEBUG_OP_STOP || op_count[proc_id] <= DEBUG_OP_STOP)))
 
-#ifdef NO_DEBUG
+#if defined(NO_DEBUG) && !defined(DEBUG_STATIC_GROUPS)
 #define ENABLE_GLOBAL_DEBUG_PRINT FALSE /* default FALSE */
 #else
 #define ENABLE_GLOBAL_DEBUG_PRINT TRUE /* default TRUE */
@@ -68,6 +76,36 @@ output when
 
 #define GLOBAL_DEBUG_STREAM mystdout /* default mystdout */
 
+/* With DEBUG_STATIC_GROUPS the build defines DEBUG_COMPILE_<group> to 1 for
+   every group in SCARAB_DEBUG_GROUPS. DEBUG_GROUP_ON(debug_flag) is then a
+   constant 0 for the other groups (the "placeholder" test expands to 1 only
+   if the pasted name is a macro defined to 1). */
+#define DEBUG_PLACEHOLDER_1 0,
+#define DEBUG_SECOND_ARG(ignored, val, ...) val
+#define DEBUG_IS_ONE(macro) DEBUG_IS_ONE_(macro)
+#define DEBUG_IS_ONE_(val) DEBUG_IS_ONE__(DEBUG_PLACEHOLDER_##val)
+#define DEBUG_IS_ONE__(arg1_or_junk) DEBUG_SECOND_ARG(arg1_or_junk 1, 0)
+
+#ifdef DEBUG_STATIC_GROUPS
+#define DEBUG_GROUP_ON(debug_flag) (DEBUG_IS_ONE(DEBUG_COMPILE_##debug_flag) && (debug_flag))
+#else
+#define DEBUG_GROUP_ON(debug_flag) (debug_flag)
+#endif
+
+/* Prints one debug message with the location/progress prefix, or logs it
+   to the binary debug log. */
+#define DEBUG_EMIT(proc_id, debug_flag, args...)                                                                    \
+  do {                                                                                                              \
+    if (debug_log_on) {                                                                                             \
+      debug_log_write(__FILE__, __LINE__, #debug_flag, FALSE, proc_id, ##args);                                     \
+    } else {                                                                                                        \
+      fprintf(GLOBAL_DEBUG_STREAM, "%s:%u: " #debug_flag " (P=%u O=%llu  I=%llu  C=%llu):  ", __FILE__, __LINE__,   \
+              proc_id, op_count[proc_id], inst_count[proc_id], cycle_count);                                        \
+      fprintf(GLOBAL_DEBUG_STREAM, ##args);                                                                         \
+      fflush(GLOBAL_DEBUG_STREAM);                                                                                  \
+    }                                                                                                               \
+  } while (0)
+
 /**************************************************************************************/
 /* Unconditional debug printf that cannot be turned off. */
 #define DPRINTF(args...) fprintf(GLOBAL_DEBUG_STREAM, ##args);
@@ -95,42 +133,40 @@ output when
    the debugging range. */
 #define _DEBUG(proc_id, debug_flag, args...)                                                                      \
   do {                                                                                                            \
-    if (debug_flag && DEBUG_RANGE_COND(proc_id)) {                                                                \
-      fprintf(GLOBAL_DEBUG_STREAM, "%s:%u: " #debug_flag " (P=%u O=%llu  I=%llu  C=%llu):  ", __FILE__, __LINE__, \
-              proc_id, op_count[proc_id], inst_count[proc_id], cycle_count);                                      \
-      fprintf(GLOBAL_DEBUG_STREAM, ##args);                                                                       \
-      fflush(GLOBAL_DEBUG_STREAM);                                                                                \
+    if (DEBUG_GROUP_ON(debug_flag) && DEBUG_RANGE_COND(proc_id)) {                                                \
+      DEBUG_EMIT(proc_id, debug_flag, ##args);                                                                    \
     }                                                                                                             \
   } while (0)
 
 /* Prints args printf-style if debug_flag is on and simulation is in
    the debugging range. Does not print proc_id, op_count, inst_count, cycle
    count. i.e., it only prints the given statement.*/
-#define _DEBUG_LEAN(proc_id, debug_flag, args...)  \
-  do {                                             \
-    if (debug_flag && DEBUG_RANGE_COND(proc_id)) { \
-      fprintf(GLOBAL_DEBUG_STREAM, ##args);        \
-      fflush(GLOBAL_DEBUG_STREAM);                 \
-    }                                              \
+#define _DEBUG_LEAN(proc_id, debug_flag, args...)                                  \
+  do {                                                                             \
+    if (DEBUG_GROUP_ON(debug_flag) && DEBUG_RANGE_COND(proc_id)) {                 \
+      if (debug_log_on) {                                                          \
+        debug_log_write(__FILE__, __LINE__, #debug_flag, TRUE, proc_id, ##args);   \
+      } else {                                                                     \
+        fprintf(GLOBAL_DEBUG_STREAM, ##args);                                      \
+        fflush(GLOBAL_DEBUG_STREAM);                                               \
+      }                                                                            \
+    }                                                                              \
   } while (0)
 
 /* Macro for tracing args to a file stream. */
-#define _TRACE(debug_flag, stream, args...)  \
-  do {                                       \
-    if (debug_flag && DEBUG_RANGE_COND(0)) { \
-      fprintf(stream, ##args);               \
-    }                                        \
+#define _TRACE(debug_flag, stream, args...)                  \
+  do {                                                       \
+    if (DEBUG_GROUP_ON(debug_flag) && DEBUG_RANGE_COND(0)) { \
+      fprintf(stream, ##args);                               \
+    }                                                        \
   } while (0)
 
 /* Prints args printf-style if debug_flag is on, regardless of whether
    simulation is in the debugging range. */
 #define _DEBUGU(proc_id, debug_flag, args...)                                                                     \
   do {                                                                                                            \
-    if (debug_flag) {                                                                                             \
-      fprintf(GLOBAL_DEBUG_STREAM, "%s:%u: " #debug_flag " (P=%u O=%llu  I=%llu  C=%llu):  ", __FILE__, __LINE__, \
-              proc_id, op_count[proc_id], inst_count[proc_id], cycle_count);                                      \
-      fprintf(GLOBAL_DEBUG_STREAM, ##args);                                                                       \
-      fflush(GLOBAL_DEBUG_STREAM);                                                                                \
+    if (DEBUG_GROUP_ON(debug_flag)) {                                                                             \
+      DEBUG_EMIT(proc_id, debug_flag, ##args);                                                                    \
     }                                                                                                             \
   } while (0)
 
@@ -138,11 +174,8 @@ output when
    simulation is in the debugging range. */
 #define _DEBUGC(proc_id, debug_flag, cond, args...)                                                               \
   do {                                                                                                            \
-    if ((cond) && debug_flag && DEBUG_RANGE_COND(proc_id)) {                                                      \
-      fprintf(GLOBAL_DEBUG_STREAM, "%s:%u: " #debug_flag " (P=%u O=%llu  I=%llu  C=%llu):  ", __FILE__, __LINE__, \
-              proc_id, op_count[proc_id], inst_count[proc_id], cycle_count);                                      \
-      fprintf(GLOBAL_DEBUG_STREAM, ##args);                                                                       \
-      fflush(GLOBAL_DEBUG_STREAM);                                                                                \
+    if (DEBUG_GROUP_ON(debug_flag) && (cond) && DEBUG_RANGE_COND(proc_id)) {                                      \
+      DEBUG_EMIT(proc_id, debug_flag, ##args);                                                                    \
     }                                                                                                             \
   } while (0)
 
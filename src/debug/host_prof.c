@@ -0,0 +1,178 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : debug/host_prof.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Host time spent in each part of the simulator (--host_prof).
+ ***************************************************************************************/
+
+#include "debug/host_prof.h"
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+
+/**************************************************************************************/
+/* Global variables */
+
+DEFINE_ENUM(Host_Prof_Region, HOST_PROF_REGION_LIST);
+
+Counter host_prof_ticks[MAX_NUM_PROCS + 1][HOST_PROF_NUM_ELEMS] __attribute__((aligned(64)));
+
+typedef struct Host_Prof_Mark_struct {
+  uns64 ticks;
+  uns64 ns;
+  Counter cycles;
+  Counter insts;
+  Counter region_ticks[HOST_PROF_NUM_ELEMS];
+} Host_Prof_Mark;
+
+static Counter host_prof_cycles;
+static Host_Prof_Mark start_mark;
+static Host_Prof_Mark heartbeat_mark;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static void host_prof_mark(Host_Prof_Mark* mark);
+static double host_prof_ns_per_tick(const Host_Prof_Mark* now);
+
+/**************************************************************************************/
+/* host_prof_mark: */
+
+static void host_prof_mark(Host_Prof_Mark* mark) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  mark->ticks = host_prof_now();
+  mark->ns = (uns64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  mark->cycles = host_prof_cycles;
+  mark->insts = 0;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    mark->insts += inst_count[proc_id];
+  for (uns region = 0; region < HOST_PROF_NUM_ELEMS; region++) {
+    mark->region_ticks[region] = host_prof_ticks[HOST_PROF_UNCORE_ROW][region];
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      mark->region_ticks[region] += host_prof_ticks[proc_id][region];
+  }
+}
+
+/* The tick rate is calibrated over the whole run against the monotonic clock */
+static double host_prof_ns_per_tick(const Host_Prof_Mark* now) {
+  if (now->ticks == start_mark.ticks)
+    return 1.0;
+  return (double)(now->ns - start_mark.ns) / (now->ticks - start_mark.ticks);
+}
+
+/**************************************************************************************/
+/* host_prof_init: */
+
+void host_prof_init(void) {
+  ASSERTM(0, NUM_CORES <= MAX_NUM_PROCS, "host_prof supports up to %d cores\n", MAX_NUM_PROCS);
+  memset(host_prof_ticks, 0, sizeof(host_prof_ticks));
+  host_prof_cycles = 0;
+  host_prof_mark(&start_mark);
+  heartbeat_mark = start_mark;
+}
+
+/**************************************************************************************/
+/* host_prof_cycle: */
+
+void host_prof_cycle(void) {
+  host_prof_cycles++;
+}
+
+/**************************************************************************************/
+/* host_prof_heartbeat: */
+
+void host_prof_heartbeat(void) {
+  Host_Prof_Mark now;
+  host_prof_mark(&now);
+  double ns_per_tick = host_prof_ns_per_tick(&now);
+  double ns = (double)(now.ns - heartbeat_mark.ns);
+  Counter cycles = now.cycles - heartbeat_mark.cycles;
+  Counter insts = now.insts - heartbeat_mark.insts;
+
+  /* the three regions that took the most time in this interval */
+  uns top[3] = {HOST_PROF_NUM_ELEMS, HOST_PROF_NUM_ELEMS, HOST_PROF_NUM_ELEMS};
+  for (uns region = 0; region < HOST_PROF_NUM_ELEMS; region++) {
+    Counter ticks = now.region_ticks[region] - heartbeat_mark.region_ticks[region];
+    for (uns ii = 0; ii < 3; ii++) {
+      if (top[ii] == HOST_PROF_NUM_ELEMS ||
+          ticks > now.region_ticks[top[ii]] - heartbeat_mark.region_ticks[top[ii]]) {
+        for (uns jj = 2; jj > ii; jj--)
+          top[jj] = top[jj - 1];
+        top[ii] = region;
+        break;
+      }
+    }
+  }
+
+  fprintf(mystdout, "** Host profile: %.1f ns/cycle  %.1f ns/inst --", cycles ? ns / cycles : 0.0,
+          insts ? ns / insts : 0.0);
+  for (uns ii = 0; ii < 3; ii++) {
+    Counter ticks = now.region_ticks[top[ii]] - heartbeat_mark.region_ticks[top[ii]];
+    fprintf(mystdout, " %s %.1f%%", Host_Prof_Region_str(top[ii]), ns ? 100.0 * ticks * ns_per_tick / ns : 0.0);
+  }
+  fprintf(mystdout, "\n");
+  fflush(mystdout);
+  heartbeat_mark = now;
+}
+
+/**************************************************************************************/
+/* host_prof_done: */
+
+void host_prof_done(void) {
+  Host_Prof_Mark now;
+  host_prof_mark(&now);
+  double ns_per_tick = host_prof_ns_per_tick(&now);
+  double ns = (double)(now.ns - start_mark.ns);
+  Counter cycles = now.cycles - start_mark.cycles;
+  Counter insts = now.insts - start_mark.insts;
+
+  fprintf(mystdout, "** Host profile: %.3f s  %s cycles  %s insts  %.1f ns/cycle  %.1f ns/inst\n", ns / 1e9,
+          unsstr64(cycles), unsstr64(insts), cycles ? ns / cycles : 0.0, insts ? ns / insts : 0.0);
+  fprintf(mystdout, "   %-14s %12s %12s %8s\n", "region", "ns/cycle", "ns/inst", "time");
+  double accounted = 0;
+  for (uns region = 0; region < HOST_PROF_NUM_ELEMS; region++) {
+    double region_ns = (now.region_ticks[region] - start_mark.region_ticks[region]) * ns_per_tick;
+    if (region != HOST_PROF_FETCH_OP && region != HOST_PROF_CONF)
+      accounted += region_ns;
+    fprintf(mystdout, "   %-14s %12.2f %12.2f %7.2f%%\n", Host_Prof_Region_str(region),
+            cycles ? region_ns / cycles : 0.0, insts ? region_ns / insts : 0.0, ns ? 100.0 * region_ns / ns : 0.0);
+  }
+  fprintf(mystdout, "   %-14s %12.2f %12.2f %7.2f%%\n", "(other)", cycles ? (ns - accounted) / cycles : 0.0,
+          insts ? (ns - accounted) / insts : 0.0, ns ? 100.0 * (ns - accounted) / ns : 0.0);
+  fprintf(mystdout, "   (FETCH_OP and CONF are mostly part of DECOUPLED_FE and not added to the total)\n");
+  fflush(mystdout);
+}
+
+/**************************************************************************************/
+/* host_prof_ticks_to_ns: */
+
+double host_prof_ticks_to_ns(Counter ticks) {
+  Host_Prof_Mark now;
+  host_prof_mark(&now);
+  return ticks * host_prof_ns_per_tick(&now);
+}
@@ -0,0 +1,123 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : debug/host_prof.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Host time spent in each part of the simulator (--host_prof).
+ ***************************************************************************************/
+
+#ifndef __HOST_PROF_H__
+#define __HOST_PROF_H__
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "globals/enum.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+#include "debug/sim_probe.h"
+
+#include "general.param.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************/
+/* Types */
+
+/* FETCH_OP is frontend_fetch_op(), which mostly runs inside DECOUPLED_FE, and CONF is the confidence estimation
+   of the decoupled frontend, which runs inside it */
+#define HOST_PROF_REGION_LIST(elem)                                                                              \
+  elem(RECOVER) elem(REDIRECT) elem(MEMORY) elem(DCACHE) elem(EXEC) elem(NODE) elem(MAP) elem(IDQ) elem(UOP_QUEUE) \
+      elem(DECODE) elem(ICACHE) elem(DECOUPLED_FE) elem(FDIP) elem(EIP) elem(UNCORE) elem(FETCH_OP) elem(CONF)
+
+DECLARE_ENUM(Host_Prof_Region, HOST_PROF_REGION_LIST, HOST_PROF_);
+
+/* regions outside of any core (memory, dvfs) are charged to this row */
+#define HOST_PROF_UNCORE_ROW MAX_NUM_PROCS
+
+/**************************************************************************************/
+/* Global variables */
+
+/* host ticks per [proc_id][region]; one row per core so that parallel cores do
+   not share cache lines */
+extern Counter host_prof_ticks[MAX_NUM_PROCS + 1][HOST_PROF_NUM_ELEMS];
+
+/**************************************************************************************/
+/* Inline functions */
+
+/* Host timestamp, 0 when --host_prof is off */
+static inline uns64 host_prof_now(void) {
+  if (!HOST_PROF)
+    return 0;
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uns64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/* Charge the time since start to region and return the new start, so that
+   consecutive calls can be chained:
+     uns64 t = host_prof_now();
+     update_a(); t = host_prof_lap(proc_id, HOST_PROF_A, t);
+     update_b(); t = host_prof_lap(proc_id, HOST_PROF_B, t);
+   The end of each region also fires the scarab:region_end probe, even without --host_prof. */
+static inline uns64 host_prof_lap(uns proc_id, Host_Prof_Region region, uns64 start) {
+  SIM_PROBE2(region_end, proc_id, region);
+  if (!HOST_PROF)
+    return 0;
+  uns64 now = host_prof_now();
+  host_prof_ticks[proc_id][region] += now - start;
+  return now;
+}
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Start profiling (clears what was measured before, e.g. during warmup) */
+void host_prof_init(void);
+
+/* Count one simulated cycle */
+void host_prof_cycle(void);
+
+/* Print host time per cycle and instruction since the previous heartbeat */
+void host_prof_heartbeat(void);
+
+/* Print the per-region summary of the whole simulation */
+void host_prof_done(void);
+
+/* Convert host_prof_now() ticks to ns (e.g. for counters kept outside of the regions) */
+double host_prof_ticks_to_ns(Counter ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_PROF_H__ */
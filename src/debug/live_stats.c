@@ -0,0 +1,335 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : debug/live_stats.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Shared-memory page with live progress counters for external
+ *                monitors (--live_stats).
+ ***************************************************************************************/
+
+/* Every LIVE_STATS_INTERVAL cycles the simulation thread copies a few raw counters
+   (instructions, uops, ROB and request buffer occupancy, the totals of LIVE_STATS_STATS)
+   into a staging buffer. A background thread wakes up every LIVE_STATS_PERIOD_MS,
+   computes IPC, KIPS and the per-kilo-instruction rate of every stat from the latest
+   sample and writes them to <output_dir>/<file_tag><live_stats_file>, which is mapped
+   shared so that any process can read it while the simulation runs (see
+   bin/scarab_live.py). Both buffers are seqlocks: the sequence number is odd while a
+   writer is updating them, and a reader retries if it changed under it. Neither the
+   simulation nor the monitor ever blocks the other.
+
+   Page format (native endianness):
+   header: char magic[8] "SCARLIV", uns32 version, uns32 num_cores, uns32 num_stats,
+           uns32 state (1: running, 2: done), uns64 seq, uns64 updates,
+           double wall_secs, uns64 cycles, double kips, double interval_kips
+   then num_stats names of LIVE_STATS_NAME_LENGTH bytes
+   then per core: uns64 insts, uns64 uops, uns64 rob_ops, uns64 mem_reqs, double ipc,
+                  and per stat: uns64 count, double pki */
+
+#include "debug/live_stats.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "general.param.h"
+
+#include "memory/memory.h"
+
+#include "cmp_model.h"
+#include "model.h"
+#include "stat_trace.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define LIVE_STATS_MAGIC "SCARLIV"
+#define LIVE_STATS_VERSION 1
+#define LIVE_STATS_NAME_LENGTH 64
+#define LIVE_STATS_RUNNING 1
+#define LIVE_STATS_DONE 2
+
+/* raw counters of a core in the staging buffer, followed by the stat totals */
+#define LIVE_CORE_INSTS 0
+#define LIVE_CORE_UOPS 1
+#define LIVE_CORE_ROB_OPS 2
+#define LIVE_CORE_MEM_REQS 3
+#define LIVE_CORE_FIELDS 4
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Live_Stats_Header_struct {
+  char magic[8];
+  uns32 version;
+  uns32 num_cores;
+  uns32 num_stats;
+  uns32 state;
+  uns64 seq;
+  uns64 updates;
+  double wall_secs;
+  uns64 cycles;
+  double kips;
+  double interval_kips;
+} Live_Stats_Header;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Stat_Enum* live_stat_indices;
+static uns live_num_stats;
+static uns sample_words; /* cycles, then LIVE_CORE_FIELDS + live_num_stats per core */
+static uns64* sample;    /* written by the simulation thread */
+static uns64 sample_seq;
+static Counter next_sample_cycle;
+
+static int page_fd = -1;
+static uns8* page;
+static size_t page_size;
+static Live_Stats_Header* header;
+static uns8* page_cores;
+
+static struct timespec start_time;
+static pthread_t publish_thread;
+static pthread_mutex_t publish_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t publish_cond = PTHREAD_COND_INITIALIZER;
+static Flag publish_stop = FALSE;
+static Flag publish_running = FALSE;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static void take_sample(void);
+static void publish(uns64* buf, uns64* last_insts, double* last_secs);
+static void* publish_loop(void*);
+static void live_stats_exit(void);
+
+/**************************************************************************************/
+/* live_stats_init: */
+
+void live_stats_init(void) {
+  if (!LIVE_STATS)
+    return;
+  ASSERTM(0, LIVE_STATS_INTERVAL > 0, "LIVE_STATS_INTERVAL must be positive\n");
+
+  uns max_stats = LIVE_STATS_STATS ? num_tokens(LIVE_STATS_STATS, DELIMITERS) : 0;
+  live_stat_indices = (Stat_Enum*)malloc(MAX2(max_stats, 1) * sizeof(Stat_Enum));
+  live_num_stats = 0;
+  if (LIVE_STATS_STATS) {
+    char* stats_str = strdup(LIVE_STATS_STATS);
+    for (char* name = strtok(stats_str, DELIMITERS); name; name = strtok(NULL, DELIMITERS)) {
+      Stat_Enum stat_idx = get_stat_idx(name);
+      ASSERTM(0, stat_idx < NUM_GLOBAL_STATS, "Stat %s not found\n", name);
+      ASSERTM(0, stat_is_on(stat_idx), "Stat %s is in a stat group that is off\n", name);
+      ASSERTM(0, global_stat_array[0][stat_idx].type != FLOAT_TYPE_STAT, "Stat %s is not a count\n", name);
+      ASSERTM(0, strlen(name) < LIVE_STATS_NAME_LENGTH, "Stat name %s is too long\n", name);
+      live_stat_indices[live_num_stats++] = stat_idx;
+    }
+    free(stats_str);
+  }
+
+  sample_words = 1 + NUM_CORES * (LIVE_CORE_FIELDS + live_num_stats);
+  sample = (uns64*)calloc(sample_words, sizeof(uns64));
+  sample_seq = 0;
+  next_sample_cycle = 0;
+
+  char file_name[MAX_STR_LENGTH + 1];
+  snprintf(file_name, MAX_STR_LENGTH, "%s%s%s%s", OUTPUT_DIR ? OUTPUT_DIR : "", OUTPUT_DIR ? "/" : "", FILE_TAG,
+           LIVE_STATS_FILE);
+  page_size = sizeof(Live_Stats_Header) + live_num_stats * LIVE_STATS_NAME_LENGTH +
+              NUM_CORES * (LIVE_CORE_FIELDS + 1 + 2 * live_num_stats) * sizeof(uns64);
+  page_fd = open(file_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  ASSERTM(0, page_fd >= 0, "Could not open %s\n", file_name);
+  ASSERTM(0, ftruncate(page_fd, page_size) == 0, "Could not size %s\n", file_name);
+  page = mmap(NULL, page_size, PROT_READ | PROT_WRITE, MAP_SHARED, page_fd, 0);
+  ASSERTM(0, page != MAP_FAILED, "Could not map %s\n", file_name);
+
+  header = (Live_Stats_Header*)page;
+  memcpy(header->magic, LIVE_STATS_MAGIC, 8);
+  header->version = LIVE_STATS_VERSION;
+  header->num_cores = NUM_CORES;
+  header->num_stats = live_num_stats;
+  header->state = LIVE_STATS_RUNNING;
+  char* names = (char*)(page + sizeof(Live_Stats_Header));
+  for (uns ii = 0; ii < live_num_stats; ii++)
+    strncpy(names + ii * LIVE_STATS_NAME_LENGTH, global_stat_array[0][live_stat_indices[ii]].name,
+            LIVE_STATS_NAME_LENGTH - 1);
+  page_cores = (uns8*)names + live_num_stats * LIVE_STATS_NAME_LENGTH;
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  publish_running = !pthread_create(&publish_thread, NULL, publish_loop, NULL);
+  ASSERTM(0, publish_running, "Could not start the live stats thread\n");
+  /* so that a monitor sees the run end even when it ends in an ASSERT */
+  atexit(live_stats_exit);
+}
+
+/**************************************************************************************/
+/* live_stats_cycle: */
+
+void live_stats_cycle(void) {
+  if (cycle_count < next_sample_cycle)
+    return;
+  next_sample_cycle = cycle_count + LIVE_STATS_INTERVAL;
+  take_sample();
+}
+
+/**************************************************************************************/
+/* live_stats_done: */
+
+void live_stats_done(void) {
+  if (!LIVE_STATS)
+    return;
+  take_sample();
+  live_stats_exit();
+}
+
+/**************************************************************************************/
+/* take_sample: copy the raw counters into the staging buffer (simulation thread) */
+
+static void take_sample(void) {
+  __atomic_store_n(&sample_seq, sample_seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  uns64* p = sample;
+  *p++ = cycle_count;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Flag cmp = SIM_MODEL == CMP_MODEL;
+    p[LIVE_CORE_INSTS] = inst_count[proc_id];
+    p[LIVE_CORE_UOPS] = uop_count[proc_id];
+    p[LIVE_CORE_ROB_OPS] = cmp ? cmp_model.node_stage[proc_id].node_count : 0;
+    p[LIVE_CORE_MEM_REQS] = cmp ? mem_get_req_count(proc_id) : 0;
+    p += LIVE_CORE_FIELDS;
+    for (uns ii = 0; ii < live_num_stats; ii++)
+      *p++ = GET_TOTAL_STAT_EVENT(proc_id, live_stat_indices[ii]);
+  }
+  __atomic_store_n(&sample_seq, sample_seq + 1, __ATOMIC_RELEASE);
+}
+
+/**************************************************************************************/
+/* publish: compute the derived metrics of the latest sample and write the page
+   (publishing thread) */
+
+static void publish(uns64* buf, uns64* last_insts, double* last_secs) {
+  uns64 seq;
+  do {
+    seq = __atomic_load_n(&sample_seq, __ATOMIC_ACQUIRE);
+    memcpy(buf, sample, sample_words * sizeof(uns64));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) || seq != __atomic_load_n(&sample_seq, __ATOMIC_RELAXED));
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double secs = (now.tv_sec - start_time.tv_sec) + (now.tv_nsec - start_time.tv_nsec) / 1e9;
+  uns64 cycles = buf[0];
+  uns64 total_insts = 0;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    total_insts += buf[1 + proc_id * (LIVE_CORE_FIELDS + live_num_stats) + LIVE_CORE_INSTS];
+
+  __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  header->updates++;
+  header->wall_secs = secs;
+  header->cycles = cycles;
+  header->kips = secs > 0 ? total_insts / secs / 1000 : 0.0;
+  header->interval_kips = secs > *last_secs ? (total_insts - *last_insts) / (secs - *last_secs) / 1000 : 0.0;
+  uns64* src = buf + 1;
+  uns64* dst = (uns64*)page_cores;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    uns64 insts = src[LIVE_CORE_INSTS];
+    memcpy(dst, src, LIVE_CORE_FIELDS * sizeof(uns64));
+    double ipc = cycles ? (double)insts / cycles : 0.0;
+    memcpy(&dst[LIVE_CORE_FIELDS], &ipc, sizeof(double));
+    src += LIVE_CORE_FIELDS;
+    dst += LIVE_CORE_FIELDS + 1;
+    for (uns ii = 0; ii < live_num_stats; ii++) {
+      double pki = insts ? 1000.0 * src[ii] / insts : 0.0;
+      dst[2 * ii] = src[ii];
+      memcpy(&dst[2 * ii + 1], &pki, sizeof(double));
+    }
+    src += live_num_stats;
+    dst += 2 * live_num_stats;
+  }
+  __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELEASE);
+
+  *last_insts = total_insts;
+  *last_secs = secs;
+}
+
+/**************************************************************************************/
+/* publish_loop: */
+
+static void* publish_loop(void* arg) {
+  UNUSED(arg);
+  uns64* buf = (uns64*)malloc(sample_words * sizeof(uns64));
+  uns64 last_insts = 0;
+  double last_secs = 0.0;
+  pthread_mutex_lock(&publish_lock);
+  while (TRUE) {
+    Flag stop = publish_stop;
+    pthread_mutex_unlock(&publish_lock);
+    publish(buf, &last_insts, &last_secs);
+    pthread_mutex_lock(&publish_lock);
+    if (stop)
+      break;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += LIVE_STATS_PERIOD_MS / 1000;
+    deadline.tv_nsec += (LIVE_STATS_PERIOD_MS % 1000) * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    if (!publish_stop)
+      pthread_cond_timedwait(&publish_cond, &publish_lock, &deadline);
+  }
+  pthread_mutex_unlock(&publish_lock);
+  free(buf);
+  return NULL;
+}
+
+/**************************************************************************************/
+/* live_stats_exit: stop the thread after a last update and mark the page done */
+
+static void live_stats_exit(void) {
+  if (!publish_running)
+    return;
+  pthread_mutex_lock(&publish_lock);
+  publish_stop = TRUE;
+  pthread_cond_signal(&publish_cond);
+  pthread_mutex_unlock(&publish_lock);
+  pthread_join(publish_thread, NULL);
+  publish_running = FALSE;
+  __atomic_store_n(&header->state, LIVE_STATS_DONE, __ATOMIC_RELEASE);
+  munmap(page, page_size);
+  close(page_fd);
+}
@@ -0,0 +1,49 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : debug/live_stats.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Shared-memory page with live progress counters for external
+ *                monitors (--live_stats).
+ ***************************************************************************************/
+
+#ifndef __LIVE_STATS_H__
+#define __LIVE_STATS_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Create the page and start the publishing thread */
+void live_stats_init(void);
+
+/* Call every cycle of core 0; samples the counters every LIVE_STATS_INTERVAL cycles */
+void live_stats_cycle(void);
+
+/* Publish the last sample, mark the page done and stop the thread */
+void live_stats_done(void);
+
+#endif /* #ifndef __LIVE_STATS_H__ */
@@ -0,0 +1,252 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : debug/pc_prof.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Per-PC profile of branch mispredicts, load misses and code line misses
+ *                (--pc_prof), dumped as top-N lists at the end of the run.
+ ***************************************************************************************/
+
+#include "debug/pc_prof.h"
+
+#include <stdlib.h>
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* Each core has one open-addressed table per kind of event, keyed by PC (loads,
+   branches) or line address (code). An event costs one lookup; a key that finds no
+   slot within PC_PROF_PROBES of its home is dropped and counted. */
+#define PC_PROF_PROBES 8
+#define PC_PROF_NUM_COUNTERS 4
+
+typedef enum Pc_Prof_Table_enum {
+  PC_PROF_BRANCH, /* mispredicts, misfetches, executions */
+  PC_PROF_LOAD,   /* dcache misses, MLC misses, LLC misses, total latency */
+  PC_PROF_LINE,   /* icache misses, uop cache misses */
+  PC_PROF_NUM_TABLES,
+} Pc_Prof_Table;
+
+typedef struct Pc_Prof_Entry_struct {
+  Addr key; /* 0 = free */
+  Counter count[PC_PROF_NUM_COUNTERS];
+} Pc_Prof_Entry;
+
+typedef struct Pc_Prof_Core_struct {
+  Pc_Prof_Entry* entries[PC_PROF_NUM_TABLES];
+  Counter used[PC_PROF_NUM_TABLES];
+  Counter dropped[PC_PROF_NUM_TABLES];
+} Pc_Prof_Core;
+
+/**************************************************************************************/
+/* Global variables */
+
+static Pc_Prof_Core* pc_prof;
+static uns pc_prof_shift;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static Pc_Prof_Entry* pc_prof_entry(uns proc_id, Pc_Prof_Table table, Addr key);
+static Counter pc_prof_rank(Pc_Prof_Table table, const Pc_Prof_Entry* entry);
+static int pc_prof_compare(const void* a, const void* b);
+static void pc_prof_dump_table(FILE* file, uns proc_id, Pc_Prof_Table table);
+
+/**************************************************************************************/
+/* pc_prof_init: */
+
+void pc_prof_init(void) {
+  ASSERTM(0, is_power_of_2(PC_PROF_ENTRIES) && PC_PROF_ENTRIES >= PC_PROF_PROBES,
+          "PC_PROF_ENTRIES must be a power of 2 of at least %d\n", PC_PROF_PROBES);
+  pc_prof_shift = 64 - LOG2(PC_PROF_ENTRIES);
+  pc_prof = (Pc_Prof_Core*)calloc(NUM_CORES, sizeof(Pc_Prof_Core));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    for (uns table = 0; table < PC_PROF_NUM_TABLES; table++)
+      pc_prof[proc_id].entries[table] = (Pc_Prof_Entry*)calloc(PC_PROF_ENTRIES, sizeof(Pc_Prof_Entry));
+  }
+}
+
+/**************************************************************************************/
+/* pc_prof_entry: returns the entry of key, creating it if needed, or NULL if the
+   table has no room for it near its home slot */
+
+static Pc_Prof_Entry* pc_prof_entry(uns proc_id, Pc_Prof_Table table, Addr key) {
+  if (!pc_prof || !key)
+    return NULL;
+  Pc_Prof_Entry* entries = pc_prof[proc_id].entries[table];
+  uns home = (uns)((key * 0x9E3779B97F4A7C15ULL) >> pc_prof_shift);
+  for (uns ii = 0; ii < PC_PROF_PROBES; ii++) {
+    Pc_Prof_Entry* entry = &entries[(home + ii) & (PC_PROF_ENTRIES - 1)];
+    if (entry->key == key)
+      return entry;
+    if (!entry->key) {
+      entry->key = key;
+      pc_prof[proc_id].used[table]++;
+      return entry;
+    }
+  }
+  pc_prof[proc_id].dropped[table]++;
+  return NULL;
+}
+
+/**************************************************************************************/
+/* Events */
+
+void pc_prof_branch(uns proc_id, Addr pc, Flag mispred, Flag misfetch) {
+  Pc_Prof_Entry* entry = pc_prof_entry(proc_id, PC_PROF_BRANCH, pc);
+  if (!entry)
+    return;
+  entry->count[0] += mispred;
+  entry->count[1] += misfetch;
+  entry->count[2]++;
+}
+
+void pc_prof_load(uns proc_id, Addr pc, Flag mlc_miss, Flag llc_miss, Counter latency) {
+  Pc_Prof_Entry* entry = pc_prof_entry(proc_id, PC_PROF_LOAD, pc);
+  if (!entry)
+    return;
+  entry->count[0]++;
+  entry->count[1] += mlc_miss;
+  entry->count[2] += llc_miss;
+  entry->count[3] += latency;
+}
+
+void pc_prof_line(uns proc_id, Addr line_addr, Flag icache_miss, Flag uop_cache_miss) {
+  Pc_Prof_Entry* entry = pc_prof_entry(proc_id, PC_PROF_LINE, line_addr);
+  if (!entry)
+    return;
+  entry->count[0] += icache_miss;
+  entry->count[1] += uop_cache_miss;
+}
+
+/**************************************************************************************/
+/* pc_prof_rank: what the top-N lists are sorted by: mispredicts, total miss latency
+   and all code line misses */
+
+static Counter pc_prof_rank(Pc_Prof_Table table, const Pc_Prof_Entry* entry) {
+  switch (table) {
+    case PC_PROF_BRANCH:
+      return entry->count[0];
+    case PC_PROF_LOAD:
+      return entry->count[3];
+    case PC_PROF_LINE:
+      return entry->count[0] + entry->count[1];
+    default:
+      ASSERT(0, FALSE);
+      return 0;
+  }
+}
+
+static Pc_Prof_Table pc_prof_sort_table;
+
+static int pc_prof_compare(const void* a, const void* b) {
+  const Pc_Prof_Entry* entry_a = *(const Pc_Prof_Entry* const*)a;
+  const Pc_Prof_Entry* entry_b = *(const Pc_Prof_Entry* const*)b;
+  Counter rank_a = pc_prof_rank(pc_prof_sort_table, entry_a);
+  Counter rank_b = pc_prof_rank(pc_prof_sort_table, entry_b);
+  if (rank_a != rank_b)
+    return rank_a < rank_b ? 1 : -1;
+  return entry_a->key < entry_b->key ? -1 : entry_a->key > entry_b->key;
+}
+
+/**************************************************************************************/
+/* pc_prof_dump_table: */
+
+static void pc_prof_dump_table(FILE* file, uns proc_id, Pc_Prof_Table table) {
+  static const char* const titles[PC_PROF_NUM_TABLES] = {"branches by mispredicts", "loads by total miss latency",
+                                                         "code lines by icache + uop cache misses"};
+  Pc_Prof_Core* core = &pc_prof[proc_id];
+  Pc_Prof_Entry** sorted = (Pc_Prof_Entry**)malloc(sizeof(Pc_Prof_Entry*) * (core->used[table] + 1));
+  uns num = 0;
+  for (uns ii = 0; ii < PC_PROF_ENTRIES; ii++) {
+    if (core->entries[table][ii].key)
+      sorted[num++] = &core->entries[table][ii];
+  }
+  pc_prof_sort_table = table;
+  qsort(sorted, num, sizeof(Pc_Prof_Entry*), pc_prof_compare);
+
+  fprintf(file, "# core %u: top %u %s (%u %s, %s events dropped)\n", proc_id, MIN2(num, PC_PROF_TOP), titles[table],
+          num, table == PC_PROF_LINE ? "lines" : "PCs", unsstr64(core->dropped[table]));
+  switch (table) {
+    case PC_PROF_BRANCH:
+      fprintf(file, "%18s %12s %12s %12s %9s\n", "pc", "mispred", "misfetch", "executed", "mispred%");
+      break;
+    case PC_PROF_LOAD:
+      fprintf(file, "%18s %12s %12s %12s %12s\n", "pc", "dcache_miss", "mlc_miss", "llc_miss", "avg_latency");
+      break;
+    case PC_PROF_LINE:
+      fprintf(file, "%18s %12s %12s\n", "line", "icache_miss", "uopc_miss");
+      break;
+    default:
+      ASSERT(0, FALSE);
+  }
+  for (uns ii = 0; ii < MIN2(num, PC_PROF_TOP); ii++) {
+    const Pc_Prof_Entry* entry = sorted[ii];
+    switch (table) {
+      case PC_PROF_BRANCH:
+        fprintf(file, "%18s %12llu %12llu %12llu %8.2f%%\n", hexstr64s(entry->key), entry->count[0], entry->count[1],
+                entry->count[2], 100.0 * entry->count[0] / entry->count[2]);
+        break;
+      case PC_PROF_LOAD:
+        fprintf(file, "%18s %12llu %12llu %12llu %12.1f\n", hexstr64s(entry->key), entry->count[0], entry->count[1],
+                entry->count[2], (double)entry->count[3] / entry->count[0]);
+        break;
+      case PC_PROF_LINE:
+        fprintf(file, "%18s %12llu %12llu\n", hexstr64s(entry->key), entry->count[0], entry->count[1]);
+        break;
+      default:
+        ASSERT(0, FALSE);
+    }
+  }
+  fprintf(file, "\n");
+  free(sorted);
+}
+
+/**************************************************************************************/
+/* pc_prof_done: */
+
+void pc_prof_done(void) {
+  if (!pc_prof)
+    return;
+  FILE* file = file_tag_fopen(OUTPUT_DIR, "pc_prof.out", "w");
+  ASSERTM(0, file, "Could not open the pc_prof output file\n");
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    for (uns table = 0; table < PC_PROF_NUM_TABLES; table++)
+      pc_prof_dump_table(file, proc_id, table);
+  }
+  fclose(file);
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    for (uns table = 0; table < PC_PROF_NUM_TABLES; table++)
+      free(pc_prof[proc_id].entries[table]);
+  }
+  free(pc_prof);
+  pc_prof = NULL;
+}
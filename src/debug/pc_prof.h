@@ -0,0 +1,66 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : debug/pc_prof.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Per-PC profile of branch mispredicts, load misses and code line misses
+ *                (--pc_prof), dumped as top-N lists at the end of the run.
+ ***************************************************************************************/
+
+#ifndef __PC_PROF_H__
+#define __PC_PROF_H__
+
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+#include "general.param.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Start profiling; events before this (e.g. during warmup) are not counted */
+void pc_prof_init(void);
+
+/* An on-path branch was resolved */
+void pc_prof_branch(uns proc_id, Addr pc, Flag mispred, Flag misfetch);
+
+/* The dcache miss of an on-path load was filled after latency core cycles; the PC is
+   the one of the oldest load waiting for the request */
+void pc_prof_load(uns proc_id, Addr pc, Flag mlc_miss, Flag llc_miss, Counter latency);
+
+/* An on-path fetch missed the icache or the uop cache in the given code line */
+void pc_prof_line(uns proc_id, Addr line_addr, Flag icache_miss, Flag uop_cache_miss);
+
+/* Write the top PC_PROF_TOP entries of every table to <output_dir>/pc_prof.out */
+void pc_prof_done(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PC_PROF_H__ */
@@ -28,6 +28,9 @@
 
 #include "debug/pipeview.h"
 
+#include <pthread.h>
+#include <time.h>
+
 #include "globals/assert.h"
 #include "globals/global_defs.h"
 
@@ -46,13 +49,64 @@ O3PipeView:<event>:<timestamp>
 <event> can be map, issue, sched, etc.
 All events for a uop must be on consecutive lines
 
+With PIPEVIEW_BINARY the same information goes out as one fixed-size
+Pipeview_Record per op into a per-core ring buffer, and a background thread
+appends the ring to <pipeview_file>.<proc_id>.bin. The simulation never waits
+for the disk: if the ring is full the record is dropped and counted.
+bin/scarab_pipeview.py converts the file to the text format above or to a
+Chrome/Perfetto trace.
+
+Binary file format (native endianness):
+header: char magic[8] "SCARPVW", uns32 version, uns32 record size,
+        uns32 decode_cycles, uns32 map_cycles
+then Pipeview_Record until the end of the file
+
 ***************************************************************************************/
 
+#define PIPEVIEW_BIN_MAGIC "SCARPVW"
+#define PIPEVIEW_BIN_VERSION 1
+#define PIPEVIEW_DISASM_LENGTH 48
+
+typedef struct Pipeview_Record_struct {
+  uns64 unique_num;
+  uns64 addr;
+  Counter fetch_cycle;
+  Counter map_cycle;
+  Counter issue_cycle;
+  Counter rdy_cycle;
+  Counter sched_cycle;
+  Counter exec_cycle;
+  Counter dcache_cycle;
+  Counter done_cycle;
+  Counter retire_cycle;
+  Counter free_cycle;  // cycle_count when the op was freed (flush cycle for off-path ops)
+  uns32 proc_id;
+  uns8 off_path;
+  uns8 srcs_rdy;
+  uns8 pad[2];
+  char disasm[PIPEVIEW_DISASM_LENGTH];
+} Pipeview_Record;
+
+typedef struct Pipeview_Ring_struct {
+  Pipeview_Record* records;
+  uns64 head;  // written by the simulation thread
+  uns64 tail;  // written by the flush thread
+  Counter dropped;
+  FILE* file;
+} Pipeview_Ring;
+
 /**************************************************************************************/
 /* Global variables: */
 
 static FILE** files = NULL;
 
+static Pipeview_Ring* rings = NULL;
+static pthread_t flush_thread;
+static pthread_mutex_t flush_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static Flag flush_stop = FALSE;
+static Flag flush_running = FALSE;
+
 /**************************************************************************************/
 /* Constants: */
 
@@ -63,13 +117,36 @@ static const char* PREFIX = "O3PipeView";
 
 void print_header(FILE*, Op*);
 void print_event(FILE*, Op*, const char*, Counter);
+static Flag pipeview_sampled(Op*);
+static void record_op(Op*);
+static void flush_ring(Pipeview_Ring*);
+static void* flush_loop(void*);
+static void pipeview_exit(void);
 
 /**************************************************************************************/
 /* pipeview_init: */
 
 void pipeview_init(void) {
   files = malloc(sizeof(FILE*) * NUM_CORES);
-  if (PIPEVIEW) {
+  if (PIPEVIEW && PIPEVIEW_BINARY) {
+    ASSERTM(0, PIPEVIEW_RING_SIZE && !(PIPEVIEW_RING_SIZE & (PIPEVIEW_RING_SIZE - 1)),
+            "PIPEVIEW_RING_SIZE must be a power of 2\n");
+    rings = calloc(NUM_CORES, sizeof(Pipeview_Ring));
+    uns32 header[4] = {PIPEVIEW_BIN_VERSION, sizeof(Pipeview_Record), DECODE_CYCLES, MAP_CYCLES};
+    for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id) {
+      char filename[MAX_STR_LENGTH + 1];
+      sprintf(filename, "%s.%d.bin", PIPEVIEW_FILE, proc_id);
+      rings[proc_id].file = fopen(filename, "wb");
+      ASSERT(proc_id, rings[proc_id].file);
+      rings[proc_id].records = malloc(sizeof(Pipeview_Record) * PIPEVIEW_RING_SIZE);
+      fwrite(PIPEVIEW_BIN_MAGIC, 1, 8, rings[proc_id].file);
+      fwrite(header, sizeof(header), 1, rings[proc_id].file);
+    }
+    flush_running = !pthread_create(&flush_thread, NULL, flush_loop, NULL);
+    ASSERTM(0, flush_running, "Could not start the pipeview flush thread\n");
+    /* so that the ops leading up to an ASSERT still reach the file */
+    atexit(pipeview_exit);
+  } else if (PIPEVIEW) {
     for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id) {
       char filename[MAX_STR_LENGTH + 1];
       sprintf(filename, "%s.%d.trace", PIPEVIEW_FILE, proc_id);
@@ -83,8 +160,13 @@ void pipeview_init(void) {
 /* pipeview_print_op: */
 
 void pipeview_print_op(struct Op_struct* op) {
-  if (!DEBUG_RANGE_COND(op->proc_id))
+  if (!DEBUG_RANGE_COND(op->proc_id) || !pipeview_sampled(op))
+    return;
+
+  if (rings) {
+    record_op(op);
     return;
+  }
 
   FILE* file = files[op->proc_id];
   print_header(file, op);
@@ -123,13 +205,126 @@ void pipeview_print_op(struct Op_struct* op) {
 /* pipeview_done: */
 
 void pipeview_done(void) {
-  if (PIPEVIEW) {
+  if (rings) {
+    pipeview_exit();
+    for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id) {
+      if (rings[proc_id].dropped)
+        fprintf(mystdout, "** Pipeview: core %u dropped %llu of %llu records (ring full)\n", proc_id,
+                rings[proc_id].dropped, rings[proc_id].head + rings[proc_id].dropped);
+    }
+  } else if (PIPEVIEW) {
     for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id) {
       fclose(files[proc_id]);
     }
   }
 }
 
+/**************************************************************************************/
+/* pipeview_sampled: record one in PIPEVIEW_SAMPLE ops, and only ops fetched in
+   the first PIPEVIEW_WINDOW_SIZE cycles of every PIPEVIEW_WINDOW_PERIOD */
+
+static Flag pipeview_sampled(Op* op) {
+  if (PIPEVIEW_SAMPLE > 1 && op->unique_num_per_proc % PIPEVIEW_SAMPLE)
+    return FALSE;
+  if (PIPEVIEW_WINDOW_PERIOD && op->fetch_cycle % PIPEVIEW_WINDOW_PERIOD >= PIPEVIEW_WINDOW_SIZE)
+    return FALSE;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* record_op: */
+
+static void record_op(Op* op) {
+  Pipeview_Ring* ring = &rings[op->proc_id];
+  uns64 tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (ring->head - tail == PIPEVIEW_RING_SIZE) {
+    ring->dropped++;
+    return;
+  }
+
+  Pipeview_Record* rec = &ring->records[ring->head & (PIPEVIEW_RING_SIZE - 1)];
+  rec->unique_num = op->unique_num_per_proc;
+  rec->addr = op->inst_info->addr;
+  rec->fetch_cycle = op->fetch_cycle;
+  rec->map_cycle = op->map_cycle;
+  rec->issue_cycle = op->issue_cycle;
+  rec->rdy_cycle = op->rdy_cycle;
+  rec->sched_cycle = op->sched_cycle;
+  rec->exec_cycle = op->exec_cycle;
+  rec->dcache_cycle = op->dcache_cycle;
+  rec->done_cycle = op->done_cycle;
+  rec->retire_cycle = op->retire_cycle;
+  rec->free_cycle = cycle_count;
+  rec->proc_id = op->proc_id;
+  rec->off_path = op->off_path;
+  rec->srcs_rdy = op->srcs_not_rdy_vector == 0;
+  strncpy(rec->disasm, disasm_op(op, TRUE), PIPEVIEW_DISASM_LENGTH - 1);
+  rec->disasm[PIPEVIEW_DISASM_LENGTH - 1] = '\0';
+
+  __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+  if (ring->head - tail == PIPEVIEW_RING_SIZE / 2)
+    pthread_cond_signal(&flush_cond);
+}
+
+/**************************************************************************************/
+/* flush_ring: write the records between tail and head (flush thread only) */
+
+static void flush_ring(Pipeview_Ring* ring) {
+  uns64 head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uns64 tail = ring->tail;
+  while (tail != head) {
+    uns64 pos = tail & (PIPEVIEW_RING_SIZE - 1);
+    uns64 count = MIN2(head - tail, PIPEVIEW_RING_SIZE - pos);
+    fwrite(&ring->records[pos], sizeof(Pipeview_Record), count, ring->file);
+    tail += count;
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+  }
+}
+
+/**************************************************************************************/
+/* flush_loop: */
+
+static void* flush_loop(void* arg) {
+  UNUSED(arg);
+  pthread_mutex_lock(&flush_lock);
+  while (TRUE) {
+    Flag stop = flush_stop;
+    pthread_mutex_unlock(&flush_lock);
+    for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id)
+      flush_ring(&rings[proc_id]);
+    pthread_mutex_lock(&flush_lock);
+    if (stop)
+      break;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 10 * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    if (!flush_stop)
+      pthread_cond_timedwait(&flush_cond, &flush_lock, &deadline);
+  }
+  pthread_mutex_unlock(&flush_lock);
+  return NULL;
+}
+
+/**************************************************************************************/
+/* pipeview_exit: stop the flush thread after it drained the rings */
+
+static void pipeview_exit(void) {
+  if (!flush_running)
+    return;
+  pthread_mutex_lock(&flush_lock);
+  flush_stop = TRUE;
+  pthread_cond_signal(&flush_cond);
+  pthread_mutex_unlock(&flush_lock);
+  pthread_join(flush_thread, NULL);
+  flush_running = FALSE;
+  for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id)
+    fclose(rings[proc_id].file);
+}
+
 /**************************************************************************************/
 /* print_event: */
 
@@ -0,0 +1,183 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : debug/set_prof.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Cache set and DRAM bank contention profile (--set_prof_caches,
+ *                --set_prof_dram), sampled every SET_PROF_INTERVAL cycles to binary files.
+ ***************************************************************************************/
+
+#include "debug/set_prof.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "memory/memory.param.h"
+#include "general.param.h"
+
+#include "libs/cache_lib.h"
+#include "ramulator.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* One output file: a cache whose counters cache_lib keeps, or the DRAM banks, whose
+   counters are read out of ramulator into acts and conflicts */
+typedef struct Set_Prof_Out_struct {
+  FILE* file;
+  Cache* cache; /* NULL for DRAM */
+  uns rows;
+  uns counters;
+  uns32* matrix; /* DRAM only: [rows][SET_PROF_BANK_COUNTERS] */
+  uns32* acts;
+  uns32* conflicts;
+} Set_Prof_Out;
+
+/**************************************************************************************/
+/* Global variables */
+
+static Set_Prof_Out* set_prof_outs;
+static uns set_prof_num_outs;
+static Counter set_prof_next;
+static Counter set_prof_last;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static FILE* set_prof_open(const char* file_name, uns rows, uns counters, uns assoc);
+static void set_prof_dump(void);
+
+/**************************************************************************************/
+/* set_prof_open: */
+
+static FILE* set_prof_open(const char* file_name, uns rows, uns counters, uns assoc) {
+  FILE* file = file_tag_fopen(OUTPUT_DIR, file_name, "w");
+  ASSERTM(0, file, "Could not open the set_prof file %s\n", file_name);
+  Set_Prof_Header header = {SET_PROF_MAGIC, rows, counters, assoc, SET_PROF_INTERVAL};
+  fwrite(&header, sizeof(header), 1, file);
+  return file;
+}
+
+/**************************************************************************************/
+/* set_prof_init: caches with the same name (one per core) are told apart by their
+   instance number, in initialization order */
+
+void set_prof_init(void) {
+  uns num_caches;
+  Cache* const* caches = cache_set_prof_caches(&num_caches);
+  if (!num_caches && !SET_PROF_DRAM)
+    return;
+  ASSERTM(0, SET_PROF_INTERVAL, "SET_PROF_INTERVAL must be non-zero\n");
+
+  set_prof_outs = (Set_Prof_Out*)calloc(num_caches + 1, sizeof(Set_Prof_Out));
+  for (uns ii = 0; ii < num_caches; ii++) {
+    Cache* cache = caches[ii];
+    uns instance = 0;
+    for (uns jj = 0; jj < ii; jj++)
+      instance += !strcmp(caches[jj]->name, cache->name);
+
+    char file_name[MAX_STR_LENGTH + 1];
+    snprintf(file_name, MAX_STR_LENGTH, "%s.%u.set_prof.bin", cache->name, instance);
+    for (char* c = file_name; *c; c++) {
+      if (*c == ' ')
+        *c = '_';
+    }
+    Set_Prof_Out* out = &set_prof_outs[set_prof_num_outs++];
+    out->cache = cache;
+    out->rows = cache->num_sets;
+    out->counters = CACHE_SET_PROF_COUNTERS;
+    out->file = set_prof_open(file_name, out->rows, out->counters, cache->assoc);
+  }
+
+  if (SET_PROF_DRAM) {
+    Set_Prof_Out* out = &set_prof_outs[set_prof_num_outs++];
+    out->rows = ramulator_bank_prof_num_banks();
+    out->counters = SET_PROF_BANK_COUNTERS;
+    out->matrix = (uns32*)malloc(sizeof(uns32) * out->rows * out->counters);
+    out->acts = (uns32*)malloc(sizeof(uns32) * out->rows);
+    out->conflicts = (uns32*)malloc(sizeof(uns32) * out->rows);
+    out->file = set_prof_open("dram.bank_prof.bin", out->rows, out->counters, 0);
+    ramulator_bank_prof_read(out->acts, out->conflicts); /* drop what happened before the profile started */
+  }
+
+  set_prof_last = cycle_count;
+  set_prof_next = cycle_count + SET_PROF_INTERVAL;
+}
+
+/**************************************************************************************/
+/* set_prof_dump: writes one interval record to every file and clears the counters */
+
+static void set_prof_dump(void) {
+  uns64 cycle = cycle_count;
+  for (uns ii = 0; ii < set_prof_num_outs; ii++) {
+    Set_Prof_Out* out = &set_prof_outs[ii];
+    size_t size = (size_t)out->rows * out->counters;
+    fwrite(&cycle, sizeof(cycle), 1, out->file);
+    if (out->cache) {
+      fwrite(out->cache->set_prof, sizeof(uns32), size, out->file);
+      memset(out->cache->set_prof, 0, sizeof(uns32) * size);
+    } else {
+      ramulator_bank_prof_read(out->acts, out->conflicts);
+      for (uns bank = 0; bank < out->rows; bank++) {
+        out->matrix[bank * SET_PROF_BANK_COUNTERS + SET_PROF_BANK_ACT] = out->acts[bank];
+        out->matrix[bank * SET_PROF_BANK_COUNTERS + SET_PROF_BANK_CONFLICT] = out->conflicts[bank];
+      }
+      fwrite(out->matrix, sizeof(uns32), size, out->file);
+    }
+  }
+  set_prof_last = cycle_count;
+}
+
+/**************************************************************************************/
+/* set_prof_cycle: */
+
+void set_prof_cycle(void) {
+  if (!set_prof_outs || cycle_count < set_prof_next)
+    return;
+  set_prof_dump();
+  set_prof_next = cycle_count + SET_PROF_INTERVAL;
+}
+
+/**************************************************************************************/
+/* set_prof_done: */
+
+void set_prof_done(void) {
+  if (!set_prof_outs)
+    return;
+  if (cycle_count > set_prof_last)
+    set_prof_dump();
+  for (uns ii = 0; ii < set_prof_num_outs; ii++) {
+    Set_Prof_Out* out = &set_prof_outs[ii];
+    fclose(out->file);
+    free(out->matrix);
+    free(out->acts);
+    free(out->conflicts);
+  }
+  free(set_prof_outs);
+  set_prof_outs = NULL;
+  set_prof_num_outs = 0;
+}
@@ -0,0 +1,79 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : debug/set_prof.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Cache set and DRAM bank contention profile (--set_prof_caches,
+ *                --set_prof_dram), sampled every SET_PROF_INTERVAL cycles to binary files.
+ ***************************************************************************************/
+
+#ifndef __SET_PROF_H__
+#define __SET_PROF_H__
+
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************/
+/* File format: a Set_Prof_Header, then one record per interval made of the uns64
+   cycle of core 0 the interval ended at and rows x counters uns32 counts, row-major.
+   The counters of a cache row (set) are Cache_Set_Prof_Counter; the ones of a DRAM row
+   (bank, channel-major, then rank..bank within the channel) are Set_Prof_Bank_Counter. */
+
+#define SET_PROF_MAGIC 0x31505353 /* "SSP1" */
+
+typedef enum Set_Prof_Bank_Counter_enum {
+  SET_PROF_BANK_ACT,
+  SET_PROF_BANK_CONFLICT,
+  SET_PROF_BANK_COUNTERS,
+} Set_Prof_Bank_Counter;
+
+typedef struct Set_Prof_Header_struct {
+  uns32 magic;
+  uns32 rows;     /* sets of the cache, or banks over all channels */
+  uns32 counters; /* counts per row */
+  uns32 assoc;    /* ways of the cache (0 for DRAM) */
+  uns64 interval; /* SET_PROF_INTERVAL */
+} Set_Prof_Header;
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Open the output files of the profiled caches and DRAM; call after the caches and
+   ramulator are initialized */
+void set_prof_init(void);
+
+/* Write an interval record to every file once SET_PROF_INTERVAL cycles have passed */
+void set_prof_cycle(void);
+
+/* Write the last, partial interval and close the files */
+void set_prof_done(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SET_PROF_H__ */
@@ -0,0 +1,57 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : debug/sim_probe.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : USDT probes (provider "scarab") at the stage boundaries of the simulator, for perf and bpftrace.
+ *                A probe is a nop until a tracer attaches to it. They are compiled in when <sys/sdt.h> is
+ *                found at configure time (SCARAB_HAVE_SDT) and expand to nothing otherwise.
+ ***************************************************************************************/
+
+#ifndef __SIM_PROBE_H__
+#define __SIM_PROBE_H__
+
+#ifdef SCARAB_HAVE_SDT
+#include <sys/sdt.h>
+
+#define SIM_PROBE(name) DTRACE_PROBE(scarab, name)
+#define SIM_PROBE1(name, a1) DTRACE_PROBE1(scarab, name, a1)
+#define SIM_PROBE2(name, a1, a2) DTRACE_PROBE2(scarab, name, a1, a2)
+#define SIM_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(scarab, name, a1, a2, a3)
+#else
+#define SIM_PROBE(name) \
+  do {                  \
+  } while (0)
+#define SIM_PROBE1(name, a1) \
+  do {                       \
+  } while (0)
+#define SIM_PROBE2(name, a1, a2) \
+  do {                           \
+  } while (0)
+#define SIM_PROBE3(name, a1, a2, a3) \
+  do {                               \
+  } while (0)
+#endif
+
+#endif /* __SIM_PROBE_H__ */
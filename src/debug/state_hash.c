@@ -0,0 +1,171 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : debug/state_hash.c
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Deterministic state hash checker (--state_hash_interval).
+ ***************************************************************************************/
+
+#include "debug/state_hash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "general.param.h"
+
+#include "memory/memory.h"
+
+#include "cmp_model.h"
+#include "model.h"
+#include "op.h"
+#include "op_pool.h"
+#include "statistics.h"
+#include "warm_state.h"
+
+/**************************************************************************************/
+/* Global variables */
+
+static FILE* state_hash_file;
+static Counter state_hash_interval_num;
+static Counter state_hash_next;
+/* per core: what retired (op numbers, PCs, addresses, directions) and when */
+static uns64* state_hash_retired;
+static uns64* state_hash_retire_timing;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static void state_hash_section(const char* name, uns64 hash);
+static void state_hash_dump(void);
+
+/**************************************************************************************/
+/* state_hash_init: */
+
+void state_hash_init(void) {
+  if (!STATE_HASH_INTERVAL)
+    return;
+
+  state_hash_file = file_tag_fopen(OUTPUT_DIR, "state_hash.out", "w");
+  ASSERTM(0, state_hash_file, "Could not open the state_hash file\n");
+  state_hash_retired = (uns64*)malloc(sizeof(uns64) * NUM_CORES);
+  state_hash_retire_timing = (uns64*)malloc(sizeof(uns64) * NUM_CORES);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    state_hash_retired[proc_id] = STATE_HASH_INIT;
+    state_hash_retire_timing[proc_id] = STATE_HASH_INIT;
+  }
+  fprintf(state_hash_file, "# interval cycle section hash\n");
+  state_hash_next = cycle_count + STATE_HASH_INTERVAL;
+}
+
+/**************************************************************************************/
+/* state_hash_retire: the hashes run over the whole simulation, so a divergence
+   shows in every later interval too */
+
+void state_hash_retire(Op* op) {
+  uns64 hash = state_hash_retired[op->proc_id];
+  hash = state_hash_bytes(hash, &op->op_num, sizeof(op->op_num));
+  hash = state_hash_bytes(hash, &op->inst_info->addr, sizeof(op->inst_info->addr));
+  hash = state_hash_bytes(hash, &op->oracle_info.npc, sizeof(op->oracle_info.npc));
+  if (op->table_info->mem_type != NOT_MEM)
+    hash = state_hash_bytes(hash, &op->oracle_info.va, sizeof(op->oracle_info.va));
+  state_hash_retired[op->proc_id] = hash;
+  state_hash_retire_timing[op->proc_id] =
+      state_hash_bytes(state_hash_retire_timing[op->proc_id], &op->retire_cycle, sizeof(op->retire_cycle));
+}
+
+/**************************************************************************************/
+/* state_hash_section: */
+
+static void state_hash_section(const char* name, uns64 hash) {
+  fprintf(state_hash_file, "%llu %llu %s %016llx\n", state_hash_interval_num, cycle_count, name, hash);
+}
+
+/**************************************************************************************/
+/* state_hash_dump: one line per section; the caches and branch predictors are the
+   sections of the model's warm state */
+
+static void state_hash_dump(void) {
+  char name[MAX_STR_LENGTH + 1];
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    snprintf(name, MAX_STR_LENGTH, "retired%u", proc_id);
+    state_hash_section(name, state_hash_retired[proc_id]);
+    snprintf(name, MAX_STR_LENGTH, "retire_timing%u", proc_id);
+    state_hash_section(name, state_hash_retire_timing[proc_id]);
+  }
+
+  if (model->save_warm_state_func)
+    warm_state_hash(state_hash_section);
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    uns64 hash = STATE_HASH_INIT;
+    int mem_reqs = mem_get_req_count(proc_id);
+    hash = state_hash_bytes(hash, &mem_reqs, sizeof(mem_reqs));
+    if (SIM_MODEL == CMP_MODEL) {
+      Node_Stage* node = &cmp_model.node_stage[proc_id];
+      for (Op* op = node->node_head; op; op = op->next_node)
+        hash = state_hash_bytes(hash, &op->op_num, sizeof(op->op_num));
+      for (uns ii = 0; ii < NUM_RS; ii++)
+        hash = state_hash_bytes(hash, &node->rs[ii].rs_op_count, sizeof(node->rs[ii].rs_op_count));
+    }
+    snprintf(name, MAX_STR_LENGTH, "queues%u", proc_id);
+    state_hash_section(name, hash);
+
+    snprintf(name, MAX_STR_LENGTH, "stats%u", proc_id);
+    state_hash_section(name, state_hash_bytes(STATE_HASH_INIT, global_stat_values[proc_id],
+                                              sizeof(Stat_Value) * NUM_GLOBAL_STATS));
+  }
+  state_hash_section("op_pool", state_hash_bytes(STATE_HASH_INIT, &op_pool_active_ops, sizeof(op_pool_active_ops)));
+
+  state_hash_interval_num++;
+}
+
+/**************************************************************************************/
+/* state_hash_cycle: */
+
+void state_hash_cycle(void) {
+  if (cycle_count < state_hash_next)
+    return;
+  state_hash_dump();
+  state_hash_next = cycle_count + STATE_HASH_INTERVAL;
+}
+
+/**************************************************************************************/
+/* state_hash_done: */
+
+void state_hash_done(void) {
+  if (!state_hash_file)
+    return;
+  state_hash_dump();
+  fclose(state_hash_file);
+  state_hash_file = NULL;
+  free(state_hash_retired);
+  free(state_hash_retire_timing);
+}
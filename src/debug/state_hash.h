@@ -0,0 +1,76 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : debug/state_hash.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Deterministic state hash checker (--state_hash_interval): every
+ *                interval, hashes of the retired ops, caches, branch predictors, queues
+ *                and stats are written to state_hash.out, to be compared across runs
+ *                with bin/scarab_statehash.py.
+ ***************************************************************************************/
+
+#ifndef __STATE_HASH_H__
+#define __STATE_HASH_H__
+
+#include "globals/global_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Op_struct;
+
+/**************************************************************************************/
+/* FNV-1a */
+
+#define STATE_HASH_INIT 0xcbf29ce484222325ULL
+#define STATE_HASH_PRIME 0x100000001b3ULL
+
+static inline uns64 state_hash_bytes(uns64 hash, const void* data, uns64 size) {
+  const uns8* bytes = (const uns8*)data;
+  for (uns64 ii = 0; ii < size; ii++)
+    hash = (hash ^ bytes[ii]) * STATE_HASH_PRIME;
+  return hash;
+}
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Open state_hash.out; call after the model is initialized */
+void state_hash_init(void);
+
+/* Fold a retired op into the retire hashes of its core */
+void state_hash_retire(struct Op_struct* op);
+
+/* Write the hashes of an interval once STATE_HASH_INTERVAL cycles have passed */
+void state_hash_cycle(void);
+
+/* Write the last, partial interval and close the file */
+void state_hash_done(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STATE_HASH_H__ */
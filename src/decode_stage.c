@@ -48,6 +48,7 @@
 #include "isa/isa_macros.h"
 #include "prefetcher/branch_misprediction_table.h"
 
+#include "core_context.h"
 #include "decoupled_frontend.h"
 #include "ft.h"
 #include "op_pool.h"
@@ -65,8 +66,8 @@
 /**************************************************************************************/
 /* Global Variables */
 
-Decode_Stage* dec = NULL;
-bool decode_off_path;
+CORE_LOCAL Decode_Stage* dec = NULL;
+CORE_LOCAL bool decode_off_path;
 
 /**************************************************************************************/
 /* Local prototypes */
@@ -76,8 +77,8 @@ static inline void update_cycles_stats(Stage_Data* src_sd, int empty_stage_idx);
 /**************************************************************************************/
 /* set_decode_stage: */
 
-void set_decode_stage(Decode_Stage* new_dec) {
-  dec = new_dec;
+void set_decode_stage(Core_Context* ctx) {
+  dec = ctx->dec;
 }
 
 /**************************************************************************************/
@@ -162,7 +163,8 @@ void debug_decode_stage() {
  *               What if there is a branch mispred? are instr properly flushed?
  */
 
-void update_decode_stage(Stage_Data* src_sd) {
+void update_decode_stage(Core_Context* ctx, Stage_Data* src_sd) {
+  set_decode_stage(ctx);
   Flag stall = (dec->last_sd->op_count > 0);
   Stage_Data *cur, *prev;
   Op** temp;
@@ -197,11 +199,15 @@ void update_decode_stage(Stage_Data* src_sd) {
   /* Ops from the uop cache do not go to the decode stage. */
   cur = &dec->sds[STAGE_MAX_DEPTH - 1];
   if (cur->op_count == 0 && src_sd->op_count) {
-    for (int i = 0; i < src_sd->max_op_count; i++) {
+    int left = src_sd->op_count;
+    for (int i = 0; left && i < src_sd->max_op_count; i++) {
       Op* src_op = src_sd->ops[i];
-      if (src_op && src_op->off_path)
+      if (!src_op)
+        continue;
+      left--;
+      if (src_op->off_path)
         decode_off_path = true;
-      if (src_op && !src_op->fetched_from_uop_cache) {
+      if (!src_op->fetched_from_uop_cache) {
         cur->ops[cur->op_count] = src_op;
         src_sd->ops[i] = NULL;
         cur->op_count++;
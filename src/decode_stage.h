@@ -43,18 +43,18 @@ typedef struct Decode_Stage_struct {
 /**************************************************************************************/
 /* External Variables */
 
-extern Decode_Stage* dec;
+extern CORE_LOCAL Decode_Stage* dec;
 
 /**************************************************************************************/
 /* Prototypes */
 
 /* vanilla hps model */
-void set_decode_stage(Decode_Stage*);
+void set_decode_stage(Core_Context*);
 void init_decode_stage(uns8, const char*);
 void reset_decode_stage(void);
 void recover_decode_stage(void);
 void debug_decode_stage(void);
-void update_decode_stage(Stage_Data*);
+void update_decode_stage(Core_Context*, Stage_Data*);
 // Needed when ops skip the decode stage when fetched from the uop cache.
 void decode_stage_process_op(Op*);
 
@@ -1,18 +1,23 @@
 #include "decoupled_frontend.h"
 
 #include <cmath>
-#include <deque>
 #include <iostream>
 #include <tuple>
 #include <vector>
 
+#include "bp/bp.param.h"
+#include "core.param.h"
 #include "memory/memory.param.h"
 #include "prefetcher/pref.param.h"
 
+#include "debug/host_prof.h"
 #include "frontend/frontend_intf.h"
 #include "isa/isa_macros.h"
 
+#include "core_context.h"
+#include "dcache_stage.h"
 #include "ft.h"
+#include "icache_stage.h"
 #include "op.h"
 #include "op_pool.h"
 #include "thread.h"
@@ -21,6 +26,46 @@
 
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_DECOUPLED_FE, ##args)
 
+/* Fixed-capacity FIFO of FTs, sized once for the largest FTQ so that pushing and popping FTs never allocates */
+class FTQ_Ring {
+ public:
+  void init(uint64_t max_fts) {
+    uint64_t capacity = 1;
+    while (capacity < max_fts)
+      capacity <<= 1;
+    slots.assign(capacity, nullptr);
+    mask = capacity - 1;
+    head = 0;
+    count = 0;
+  }
+  uint64_t size() const { return count; }
+  uint64_t capacity() const { return slots.size(); }
+  bool empty() const { return count == 0; }
+  FT* at(uint64_t pos) const { return slots[(head + pos) & mask]; }
+  FT* front() const { return at(0); }
+  FT* back() const { return at(count - 1); }
+  void push_back(FT* ft) {
+    ASSERT(0, count < slots.size());
+    slots[(head + count) & mask] = ft;
+    count++;
+  }
+  void pop_front() {
+    ASSERT(0, count);
+    head = (head + 1) & mask;
+    count--;
+  }
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+
+ private:
+  std::vector<FT*> slots;
+  uint64_t mask;
+  uint64_t head;
+  uint64_t count;
+};
+
 class Decoupled_FE {
  public:
   Decoupled_FE(uns _proc_id);
@@ -35,7 +80,10 @@ class Decoupled_FE {
   uint64_t ftq_num_ops();
   uint64_t ftq_num_fts() { return ftq.size(); }
   void retire(Op* op, int op_proc_id, uns64 inst_uid);
-  void set_ftq_num(uint64_t set_ftq_ft_num) { ftq_ft_num = set_ftq_ft_num; }
+  void set_ftq_num(uint64_t set_ftq_ft_num) {
+    ASSERT(proc_id, set_ftq_ft_num <= ftq.capacity());
+    ftq_ft_num = set_ftq_ft_num;
+  }
   uint64_t get_ftq_num() { return ftq_ft_num; }
   Op* get_cur_op() { return cur_op; }
   uns get_conf() { return conf->get_conf(); }
@@ -44,6 +92,8 @@ class Decoupled_FE {
   void conf_resolve_cf(Op* op) { conf->resolve_cf(op); }
   Off_Path_Reason eval_off_path_reason(Op* op);
   void print_conf_data() { conf->print_data(); }
+  void set_on_path_stall(bool stall) { on_path_stall = stall; }
+  bool is_idle() const { return on_path_stall && state == SERVING_ON_PATH && ftq.empty(); }
 
   // FSM states for DFE
   enum DFE_STATE {
@@ -62,7 +112,7 @@ class Decoupled_FE {
   // Per core fetch target queue:
   // Each core has a queue of FTs,
   // where each FT contains a queue of micro instructions.
-  std::deque<FT*> ftq;
+  FTQ_Ring ftq;
   // keep track of the current FT to be pushed next
   FT* current_ft_to_push;
   FT* saved_recovery_ft;
@@ -75,17 +125,22 @@ class Decoupled_FE {
   bool trace_mode;
   Op* cur_op;
   Conf* conf;
+  // no new on-path FTs are built while set (the pipeline is being drained)
+  bool on_path_stall;
+  // off-path ops sent to the memory system since the last redirect (WRONG_PATH_LITE)
+  uint64_t wrong_path_lite_ops;
 
   DFE_STATE state;  // FSM state
   bool is_off_path_state() const { return state == SERVING_OFF_PATH; }
 
   void check_consecutivity_and_push_to_ftq();
   void redirect_to_off_path(FT_PredictResult result);
+  void send_wrong_path_lite(FT* ft);
   inline uint64_t ftq_max_size() { return ftq_ft_num; }
 };
 
 /* Global Variables */
-Decoupled_FE* dfe = nullptr;
+CORE_LOCAL Decoupled_FE* dfe = nullptr;
 Flag have_seen_exit_on_prebuilt = 0;
 uint64_t op_num_count = 1;
 uint64_t current_off_path_op_num_count = 0;
@@ -117,9 +172,9 @@ bool decoupled_fe_is_off_path() {
   return dfe->is_off_path();
 }
 
-void set_decoupled_fe(uns proc_id) {
-  dfe = &per_core_dfe[proc_id];
-  ASSERT(proc_id, dfe);
+void set_decoupled_fe(Core_Context* ctx) {
+  dfe = &per_core_dfe[ctx->proc_id];
+  ASSERT(ctx->proc_id, dfe);
 }
 
 void reset_decoupled_fe() {
@@ -132,7 +187,8 @@ void recover_decoupled_fe() {
 void debug_decoupled_fe() {
 }
 
-void update_decoupled_fe() {
+void update_decoupled_fe(Core_Context* ctx) {
+  set_decoupled_fe(ctx);
   dfe->update();
 }
 
@@ -184,6 +240,14 @@ void decoupled_fe_retire(Op* op, int op_proc_id, uns64 inst_uid) {
   dfe->retire(op, op_proc_id, inst_uid);
 }
 
+void decoupled_fe_stall_on_path(uns proc_id, Flag stall) {
+  per_core_dfe[proc_id].set_on_path_stall(stall);
+}
+
+Flag decoupled_fe_is_idle(uns proc_id) {
+  return per_core_dfe[proc_id].is_idle();
+}
+
 void decoupled_fe_set_ftq_num(uint64_t ftq_ft_num) {
   dfe->set_ftq_num(ftq_ft_num);
 }
@@ -227,12 +291,17 @@ void Decoupled_FE::init(uns _proc_id) {
 #ifdef ENABLE_PT_MEMTRACE
   trace_mode |= (FRONTEND == FE_PT || FRONTEND == FE_MEMTRACE);
 #endif
+  trace_mode |= (FRONTEND == FE_SCT);
   proc_id = _proc_id;
   sched_off_path = false;
   recovery_addr = 0;
   redirect_cycle = 0;
   ftq_ft_num = FE_FTQ_BLOCK_NUM;
+  // UFTQ may grow the FTQ up to UFTQ_MAX_FTQ_BLOCK_NUM at run time
+  ftq.init(FDIP_ADJUSTABLE_FTQ ? MAX2(FE_FTQ_BLOCK_NUM, UFTQ_MAX_FTQ_BLOCK_NUM) : FE_FTQ_BLOCK_NUM);
   cur_op = nullptr;
+  on_path_stall = false;
+  wrong_path_lite_ops = 0;
 
   current_ft_to_push = nullptr;
 
@@ -247,8 +316,8 @@ void Decoupled_FE::recover() {
   cur_op = nullptr;
   recovery_addr = bp_recovery_info->recovery_fetch_addr;
 
-  for (auto it = ftq.begin(); it != ftq.end(); it++) {
-    delete (*it);
+  for (uint64_t ii = 0; ii < ftq.size(); ii++) {
+    free_ft(ftq.at(ii));
   }
   ftq.clear();
 
@@ -268,6 +337,9 @@ void Decoupled_FE::recover() {
   else if (op->oracle_info.recover_at_exec)
     STAT_EVENT(proc_id, FTQ_RECOVER_EXEC);
 
+  // the redirect squashes any BTB read in flight
+  g_bp_data->btb_ready_cycle = 0;
+
   uint64_t offpath_cycles = cycle_count - redirect_cycle;
   ASSERT(proc_id, cycle_count > redirect_cycle);
   INC_STAT_EVENT(proc_id, FTQ_OFFPATH_CYCLES, offpath_cycles);
@@ -303,8 +375,11 @@ void Decoupled_FE::update() {
     STAT_EVENT(proc_id, FTQ_CYCLES_ONPATH);
 
   // update per-cycle confidence mechanism state
-  if (CONFIDENCE_ENABLE)
+  if (CONFIDENCE_ENABLE) {
+    uns64 prof_t = host_prof_now();
     conf->per_cycle_update();
+    host_prof_lap(proc_id, HOST_PROF_CONF, prof_t);
+  }
 
   while (1) {
     ASSERT(proc_id, ftq.size() <= ftq_max_size());
@@ -331,6 +406,11 @@ void Decoupled_FE::update() {
       STAT_EVENT(proc_id, FTQ_BREAK_PRED_BR_ONPATH + is_off_path_state());
       break;
     }
+    if (cycle_count < g_bp_data->btb_ready_cycle) {
+      DEBUG(proc_id, "Break due to BTB latency\n");
+      STAT_EVENT(proc_id, FTQ_BREAK_BTB_LATENCY_ONPATH + is_off_path_state());
+      break;
+    }
     fwd_progress = 0;
     // FSM-based FT build logic - four states:
     // EXITING: stop whend end of track seen
@@ -338,6 +418,7 @@ void Decoupled_FE::update() {
     // SERVING_ON_PATH: normal execution mode
     // SERVING_OFF_PATH: fetching off-path operations
     FT_PredictResult result;
+    bool wrong_path_lite = false;
     switch (state) {
       case EXITING:
         return;
@@ -362,7 +443,9 @@ void Decoupled_FE::update() {
       }
       // recover will fall through to on-path exec
       case SERVING_ON_PATH: {
-        current_ft_to_push = new FT();
+        if (on_path_stall)
+          return;
+        current_ft_to_push = alloc_ft();
         // Build new on-path FT if no recovery ft availble
         ASSERT(proc_id, !current_ft_to_push->has_unread_ops());
         auto build_success = current_ft_to_push->build([](uns8 pid) { return frontend_can_fetch_op(pid); },
@@ -391,9 +474,14 @@ void Decoupled_FE::update() {
       }
 
       case SERVING_OFF_PATH: {
+        if (WRONG_PATH_LITE && wrong_path_lite_ops >= NODE_TABLE_SIZE) {
+          // the off-path ops would have filled the window by now
+          STAT_EVENT(proc_id, WRONG_PATH_LITE_WINDOW_FULL);
+          return;
+        }
         // for off-path just build and. redirect
         // cf processed while building
-        current_ft_to_push = new FT();
+        current_ft_to_push = alloc_ft();
         ASSERT(proc_id, !current_ft_to_push->has_unread_ops());
         auto build_success = current_ft_to_push->build([](uns8 pid) { return frontend_can_fetch_op(pid); },
                                                        [](uns8 pid, Op* op) -> bool {
@@ -406,14 +494,23 @@ void Decoupled_FE::update() {
           frontend_redirect(proc_id, current_ft_to_push->get_last_op()->inst_uid,
                             current_ft_to_push->get_last_op()->oracle_info.pred_npc);
         }
+        wrong_path_lite = WRONG_PATH_LITE;
         break;
       }
     }
     STAT_EVENT(proc_id, DFE_GEN_ON_PATH_FT + is_off_path_state());
-    check_consecutivity_and_push_to_ftq();
     cfs_taken_this_cycle += (current_ft_to_push->get_end_reason() == FT_TAKEN_BRANCH) ||
                             (current_ft_to_push->get_end_reason() == FT_BAR_FETCH);
     ft_pushed_this_cycle++;
+    if (BTB_L1_LATENCY > 1 && current_ft_to_push->get_end_reason() == FT_TAKEN_BRANCH)
+      g_bp_data->btb_ready_cycle = MAX2(g_bp_data->btb_ready_cycle, cycle_count + BTB_L1_LATENCY - 1);
+    if (wrong_path_lite) {
+      send_wrong_path_lite(current_ft_to_push);
+      free_ft(current_ft_to_push);
+      current_ft_to_push = nullptr;
+    } else {
+      check_consecutivity_and_push_to_ftq();
+    }
   }
 }
 
@@ -491,8 +588,8 @@ Op* Decoupled_FE::ftq_iter_get_next(decoupled_fe_iter* iter, bool* end_of_ft) {
 
 uint64_t Decoupled_FE::ftq_num_ops() {
   uint64_t num_ops = 0;
-  for (auto it = ftq.begin(); it != ftq.end(); it++) {
-    num_ops += (*it)->ops.size();
+  for (uint64_t ii = 0; ii < ftq.size(); ii++) {
+    num_ops += ftq.at(ii)->ops.size();
   }
   return num_ops;
 }
@@ -542,13 +639,35 @@ Off_Path_Reason Decoupled_FE::eval_off_path_reason(Op* op) {
 void Decoupled_FE::check_consecutivity_and_push_to_ftq() {
   if (ftq.size())
     ASSERT(proc_id, current_ft_to_push->is_consecutive(*ftq.back()));
-  if (CONFIDENCE_ENABLE)
+  if (CONFIDENCE_ENABLE) {
+    uns64 prof_t = host_prof_now();
     conf->update(*current_ft_to_push);
+    host_prof_lap(proc_id, HOST_PROF_CONF, prof_t);
+  }
   if (recovery_addr) {
     ASSERT(proc_id, recovery_addr == current_ft_to_push->get_start_addr());
     recovery_addr = 0;
   }
-  ftq.emplace_back(std::move(current_ft_to_push));
+  ftq.push_back(current_ft_to_push);
+}
+
+// WRONG_PATH_LITE: instead of sending an off-path FT down the pipeline, make the icache accesses of its lines and
+// the dcache accesses of its loads (at the addresses the frontend gives them) right away, then drop it. The off-path
+// ops of the mispredicting FT itself still go down the pipeline, since they share the FT with on-path ops.
+void Decoupled_FE::send_wrong_path_lite(FT* ft) {
+  Addr last_line_addr = 0;
+  for (auto op : ft->ops) {
+    ASSERT(proc_id, op->off_path);
+    Addr line_addr = op->inst_info->addr & ~(Addr)(ICACHE_LINE_SIZE - 1);
+    if (line_addr != last_line_addr) {
+      icache_wrong_path_lite_fetch(op->inst_info->addr);
+      last_line_addr = line_addr;
+    }
+    if (op->table_info->mem_type == MEM_LD && op->oracle_info.va)
+      dcache_wrong_path_lite_access(op);
+  }
+  INC_STAT_EVENT(proc_id, WRONG_PATH_LITE_OPS, ft->ops.size());
+  wrong_path_lite_ops += ft->ops.size();
 }
 
 void Decoupled_FE::redirect_to_off_path(FT_PredictResult result) {
@@ -563,7 +682,7 @@ void Decoupled_FE::redirect_to_off_path(FT_PredictResult result) {
   }
   // no trailing ft, misprediction happened at the last op of the on-path FT, fetch the next on-path ft, then redirect
   else {
-    saved_recovery_ft = new FT();
+    saved_recovery_ft = alloc_ft();
     auto build_success = saved_recovery_ft->build([](uns8 pid) { return frontend_can_fetch_op(pid); },
                                                   [](uns8 pid, Op* op) -> bool {
                                                     frontend_fetch_op(pid, op);
@@ -574,6 +693,7 @@ void Decoupled_FE::redirect_to_off_path(FT_PredictResult result) {
   }
   redirect_cycle = cycle_count;
   state = SERVING_OFF_PATH;
+  wrong_path_lite_ops = 0;
   frontend_redirect(proc_id, result.op->inst_uid, result.pred_addr);
   // set the current op number as the beginning op count of this off-path divergence
   set_off_path_op_id(current_ft_to_push->get_last_op()->op_num + 1);
@@ -94,15 +94,19 @@ struct decoupled_fe_iter {
 // Simulator API
 void alloc_mem_decoupled_fe(uns numProcs);
 void init_decoupled_fe(uns proc_id, const char*);
-void set_decoupled_fe(uns proc_id);
+void set_decoupled_fe(Core_Context* ctx);
 void reset_decoupled_fe();
 void debug_decoupled_fe();
-void update_decoupled_fe();
+void update_decoupled_fe(Core_Context* ctx);
 // Icache/Core API
 void recover_decoupled_fe();
 void decoupled_fe_pop_ft(FT* ft);
 bool decoupled_fe_is_off_path();
 void decoupled_fe_retire(Op* op, int proc_id, uns64 inst_uid);
+/* stop building on-path FTs for proc_id (off-path and recovery FTs still flow)
+   so that the pipeline drains; idle once the stalled FTQ is empty */
+void decoupled_fe_stall_on_path(uns proc_id, Flag stall);
+Flag decoupled_fe_is_idle(uns proc_id);
 
 FT* decoupled_fe_get_ft();
 // FTQ API
@@ -181,7 +181,10 @@ void dvfs_init(void) {
     metric = get_metric();
 
     if (DVFS_USE_ORACLE) {
-      opt2_init(num_configs, 1, &set_config_num);
+      // decided at the DVFS period by dvfs_reconfigure_oracle()
+      static Opt2_Client opt2_client = {"DVFS", 0, &set_config_num, &compute_oracle_metric, NULL, NULL};
+      opt2_client.num_configs = num_configs;
+      opt2_client_init(&opt2_client);
     }
   }
 }
@@ -340,9 +343,6 @@ void dvfs_cycle(void) {
 /* dvfs_done: */
 
 void dvfs_done(void) {
-  if (DVFS_USE_ORACLE) {
-    opt2_comparison_barrier(compute_oracle_metric());
-  }
   if (DVFS_REPLAY_CONFIG_TRACE) {
     fclose(config_trace);
   }
@@ -387,10 +387,7 @@ static uns dvfs_read_config_trace(void) {
 }
 
 static void dvfs_reconfigure_oracle(void) {
-  double gmean_ipt = compute_oracle_metric();
-  opt2_comparison_barrier(gmean_ipt);
-  // we passed the barrier
-  opt2_decision_point();
+  opt2_client_decide();
 }
 
 static void dvfs_reconfigure_perf_pred(void) {
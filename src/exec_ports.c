@@ -242,6 +242,7 @@ void init_exec_ports_rs_list(uns proc_id, Reservation_Station* rs, Func_Unit* lo
       idx = idx - 1;                  // built in returns 1 + the true index
       ASSERTM(proc_id, idx < NUM_FUS, "Attempted connections with an FU that does not exist\n");
       rs[i].connected_fus[num_fus] = &local_fus[idx];
+      rs[i].fu_types |= local_fus[idx].type;
       // Update the FU to RS mapping
       node->fu_to_rs_map[idx] = i;
       num_fus++;
@@ -50,7 +50,9 @@
 #include "dvfs/perf_pred.h"
 
 #include "cmp_model.h"
+#include "core_context.h"
 #include "exec_ports.h"
+#include "lsq.h"
 #include "map.h"
 #include "map_rename.h"
 #include "statistics.h"
@@ -64,9 +66,9 @@
 /**************************************************************************************/
 /* Global Variables */
 
-Exec_Stage* exec = NULL;
+CORE_LOCAL Exec_Stage* exec = NULL;
 int op_type_delays[NUM_OP_TYPES];
-int exec_off_path;
+CORE_LOCAL int exec_off_path;
 
 /**************************************************************************************/
 /* Prototypes */
@@ -85,8 +87,8 @@ static inline void exec_stage_bp_resolve(Op* op);
 /**************************************************************************************/
 /* set_exec_stage: */
 
-void set_exec_stage(Exec_Stage* new_exec) {
-  exec = new_exec;
+void set_exec_stage(Core_Context* ctx) {
+  exec = ctx->exec;
 }
 
 /**************************************************************************************/
@@ -186,7 +188,8 @@ void debug_exec_stage() {
 /**************************************************************************************/
 /* exec_cycle: */
 
-void update_exec_stage(Stage_Data* src_sd) {
+void update_exec_stage(Core_Context* ctx, Stage_Data* src_sd) {
+  set_exec_stage(ctx);
   ASSERT(exec->proc_id, exec->sd.op_count <= exec->sd.max_op_count);
   exec->is_issue_stall = TRUE;
 
@@ -199,9 +202,12 @@ void update_exec_stage(Stage_Data* src_sd) {
     STAT_EVENT(exec->proc_id, EXEC_STAGE_OFF_PATH);
   }
 
-  for (uns ii = 0; ii < src_sd->max_op_count; ii++) {
-    if (src_sd->ops[ii] && src_sd->ops[ii]->off_path)
-      exec_off_path = 1;
+  for (int ii = 0, left = src_sd->op_count; left && ii < src_sd->max_op_count; ii++) {
+    if (src_sd->ops[ii]) {
+      left--;
+      if (src_sd->ops[ii]->off_path)
+        exec_off_path = 1;
+    }
   }
 
   /* phase 1 - success/failure of latching and wake up of dependent ops */
@@ -238,7 +244,7 @@ void update_exec_stage(Stage_Data* src_sd) {
     }
 
     ASSERTM(exec->proc_id, OP_SRCS_RDY(op), "op_num:%s\n", unsstr64(op->op_num));
-    ASSERT(exec->proc_id, get_fu_type(op->table_info->op_type, op->table_info->is_simd) & exec->fus[ii].type);
+    ASSERT(exec->proc_id, op->table_info->fu_type & exec->fus[ii].type);
 
     /* if we get to here, then it means the op is going into the functional unit. */
     op->sched_cycle = cycle_count;
@@ -456,6 +462,7 @@ static inline void exec_stage_dep_wakeup(Op* op) {
     // only wake up if this is the first time this op executes
     if (op->exec_count == 0) {
       op->wake_cycle = exec_cycle;
+      lsq_store_resolved(op);
       wake_up_ops(op, MEM_ADDR_DEP, model->wake_hook);
       wake_up_ops(op, MEM_DATA_DEP, model->wake_hook);
     }
@@ -60,18 +60,18 @@ typedef struct Exec_Stage_struct {
 /**************************************************************************************/
 /* External Variables */
 
-extern Exec_Stage* exec;
+extern CORE_LOCAL Exec_Stage* exec;
 
 /**************************************************************************************/
 /* Prototypes */
 
 /* vanilla hps model */
-void set_exec_stage(Exec_Stage*);
+void set_exec_stage(Core_Context*);
 void init_exec_stage(uns8, const char*);
 void reset_exec_stage(void);
 void recover_exec_stage(void);
 void debug_exec_stage(void);
-void update_exec_stage(Stage_Data*);
+void update_exec_stage(Core_Context*, Stage_Data*);
 void finalize_exec_stage(void);
 
 /**************************************************************************************/
@@ -0,0 +1,472 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : farm.cc
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Region farming: a coordinator hands (trace, parameters) jobs to
+ *                resident workers on other hosts and collects their binary stats.
+ *
+ * Every non-empty line of the FARM_JOBS file not starting with '#' is one job: a
+ * trace followed by the '--name value' parameters of its run (simpoint and
+ * configuration). The coordinator waits for FARM_WORKERS workers on
+ * FARM_COORDINATOR, then answers the request of each idle worker with a job,
+ * preferring one on the trace the worker ran last, then one on a trace no other
+ * worker is on.
+ *
+ * A worker stays resident and forks a child per job that parses the worker's own
+ * arguments plus those of the job, and simulates with stats_format binary into
+ * FARM_SCRATCH_DIR. The last FARM_TRACE_CACHE traces are copied to the scratch
+ * directory and kept open, so repeated jobs on a trace read a local copy and reuse
+ * the fast forward index the earlier ones left next to it. Once the child is done,
+ * its stats<proc_id>.bin files stream back to the coordinator, which writes them to
+ * <output_dir>/job<n>/.
+ *
+ * The messages are Farm_Msg structs over the Server/Client sockets of
+ * pin/pin_lib/message_queue_interface_lib.h.
+ ***************************************************************************************/
+
+#include "farm.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "general.param.h"
+}
+
+#include <deque>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pin/pin_lib/message_queue_interface_lib.h"
+
+/**************************************************************************************/
+/* Types */
+
+typedef enum Farm_Msg_Type_enum {
+  FARM_MSG_READY,   /* worker: idle, wants a job */
+  FARM_MSG_JOB,     /* coordinator: job number and its line */
+  FARM_MSG_STOP,    /* coordinator: no more jobs, the worker exits */
+  FARM_MSG_STATS,   /* worker: next chunk of stats<arg>.bin of the job */
+  FARM_MSG_RESULT,  /* worker: the job is done, arg is its exit status */
+} Farm_Msg_Type;
+
+#define FARM_MSG_DATA (MAX_PACKET_SIZE - 4 * sizeof(uns32))
+
+typedef struct Farm_Msg_struct {
+  uns32 type; /* Farm_Msg_Type */
+  uns32 job;
+  uns32 arg;
+  uns32 len; /* bytes of data */
+  char data[FARM_MSG_DATA];
+} Farm_Msg;
+
+typedef struct Farm_Job_struct {
+  std::string trace;
+  std::string line;
+} Farm_Job;
+
+typedef struct Farm_Cached_Trace_struct {
+  std::string trace; /* path given by the jobs */
+  std::string local; /* copy in the scratch directory */
+  int fd;
+} Farm_Cached_Trace;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static Farm_Msg farm_msg(Farm_Msg_Type type, uns job, uns arg);
+static std::vector<Farm_Job> farm_read_jobs(void);
+static int farm_pick_job(std::map<std::string, std::deque<uns>>& pending, const std::vector<std::string>& trace_order,
+                         std::map<std::string, uns>& trace_workers, const std::string& last_trace);
+static std::string farm_cache_trace(std::list<Farm_Cached_Trace>& cache, const std::string& trace);
+static Flag farm_copy_file(const std::string& from, const std::string& to);
+static void farm_send_stats(Client* client, uns job, const std::string& dir);
+static void farm_clean_dir(const std::string& dir);
+
+/**************************************************************************************/
+/* farm_msg: */
+
+static Farm_Msg farm_msg(Farm_Msg_Type type, uns job, uns arg) {
+  Farm_Msg msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.type = type;
+  msg.job = job;
+  msg.arg = arg;
+  return msg;
+}
+
+/**************************************************************************************/
+/* farm_read_jobs: */
+
+static std::vector<Farm_Job> farm_read_jobs(void) {
+  std::vector<Farm_Job> jobs;
+  char line[MAX_STR_LENGTH + 1];
+
+  FILE* file = fopen(FARM_JOBS, "r");
+  if (!file)
+    FATAL_ERROR(0, "Could not open the FARM_JOBS file %s\n", FARM_JOBS);
+  while (fgets(line, sizeof(line), file)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    char* start = line + strspn(line, " \t");
+    if (!*start || *start == '#')
+      continue;
+    ASSERTM(0, strlen(start) < FARM_MSG_DATA, "Farm job %u is longer than a message\n", (uns)jobs.size());
+
+    Farm_Job job;
+    job.line = start;
+    job.trace = job.line.substr(0, job.line.find_first_of(" \t"));
+    jobs.push_back(job);
+  }
+  fclose(file);
+  return jobs;
+}
+
+/**************************************************************************************/
+/* farm_pick_job: next job for a worker that ran last_trace last, -1 if none is left */
+
+static int farm_pick_job(std::map<std::string, std::deque<uns>>& pending, const std::vector<std::string>& trace_order,
+                         std::map<std::string, uns>& trace_workers, const std::string& last_trace) {
+  const std::string* best = NULL;
+
+  /* the trace of the last job is cached on the worker */
+  auto it = pending.find(last_trace);
+  if (it != pending.end() && !it->second.empty())
+    best = &last_trace;
+  /* else the trace with jobs left that the fewest workers are on, in the order of the file */
+  for (uns ii = 0; !best && ii < trace_order.size(); ii++) {
+    const std::string& trace = trace_order[ii];
+    if (pending[trace].empty())
+      continue;
+    if (!best || trace_workers[trace] < trace_workers[*best])
+      best = &trace;
+  }
+  if (!best)
+    return -1;
+
+  std::deque<uns>& queue = pending[*best];
+  uns job = queue.front();
+  queue.pop_front();
+  return job;
+}
+
+/**************************************************************************************/
+/* farm_coordinator: */
+
+unsigned farm_coordinator(void) {
+  std::vector<Farm_Job> jobs = farm_read_jobs();
+  std::map<std::string, std::deque<uns>> pending;
+  std::vector<std::string> trace_order;
+  std::map<std::string, uns> trace_workers; /* workers running a job on the trace */
+  std::map<std::pair<uns, uns>, FILE*> stat_files;
+  uns done = 0;
+  uns failed = 0;
+
+  for (uns job = 0; job < jobs.size(); job++) {
+    if (pending.find(jobs[job].trace) == pending.end())
+      trace_order.push_back(jobs[job].trace);
+    pending[jobs[job].trace].push_back(job);
+  }
+
+  fprintf(mystdout, "** Farm: %u jobs on %u traces, waiting for %u workers on %s\n", (uns)jobs.size(),
+          (uns)trace_order.size(), FARM_WORKERS, FARM_COORDINATOR);
+  fflush(mystdout);
+  Server server(FARM_COORDINATOR, FARM_WORKERS);
+
+  std::vector<std::string> last_trace(FARM_WORKERS);
+  std::vector<Flag> active(FARM_WORKERS, TRUE);
+  uns num_active = FARM_WORKERS;
+  while (num_active) {
+    int32_t worker = server.wait_for_client(-1);
+    if (worker < 0)
+      continue;
+    Farm_Msg msg = server.receive_exact<Farm_Msg>(worker);
+
+    switch (msg.type) {
+      case FARM_MSG_READY: {
+        int job = farm_pick_job(pending, trace_order, trace_workers, last_trace[worker]);
+        if (job < 0) {
+          server.send(worker, Message<Farm_Msg>(farm_msg(FARM_MSG_STOP, 0, 0)));
+          server.disconnect(worker);
+          active[worker] = FALSE;
+          num_active--;
+          break;
+        }
+        char dir[MAX_STR_LENGTH + 1];
+        snprintf(dir, MAX_STR_LENGTH, "%s/job%d", OUTPUT_DIR, job);
+        if (mkdir(dir, 0777) && errno != EEXIST)
+          FATAL_ERROR(0, "Could not create the farm output directory %s\n", dir);
+        FILE* record = file_tag_fopen(dir, "job.params", "w");
+        if (record) {
+          fprintf(record, "%s\n", jobs[job].line.c_str());
+          fclose(record);
+        }
+
+        Farm_Msg reply = farm_msg(FARM_MSG_JOB, job, 0);
+        reply.len = jobs[job].line.size();
+        memcpy(reply.data, jobs[job].line.c_str(), reply.len);
+        server.send(worker, Message<Farm_Msg>(reply));
+        last_trace[worker] = jobs[job].trace;
+        trace_workers[jobs[job].trace]++;
+        break;
+      }
+
+      case FARM_MSG_STATS: {
+        ASSERTM(0, msg.job < jobs.size() && msg.arg < MAX_NUM_PROCS && msg.len <= FARM_MSG_DATA,
+                "Bad stats message from farm worker %d\n", worker);
+        FILE*& file = stat_files[std::make_pair(msg.job, msg.arg)];
+        if (!file) {
+          char dir[MAX_STR_LENGTH + 1];
+          char name[MAX_STR_LENGTH + 1];
+          snprintf(dir, MAX_STR_LENGTH, "%s/job%u", OUTPUT_DIR, msg.job);
+          snprintf(name, MAX_STR_LENGTH, "stats%u.bin", msg.arg);
+          file = file_tag_fopen(dir, name, "wb");
+          ASSERTM(0, file, "Could not write the stats of farm job %u\n", msg.job);
+        }
+        fwrite(msg.data, 1, msg.len, file);
+        break;
+      }
+
+      case FARM_MSG_RESULT: {
+        ASSERTM(0, msg.job < jobs.size(), "Bad result message from farm worker %d\n", worker);
+        for (auto it = stat_files.lower_bound(std::make_pair(msg.job, 0u));
+             it != stat_files.end() && it->first.first == msg.job;) {
+          fclose(it->second);
+          it = stat_files.erase(it);
+        }
+        trace_workers[jobs[msg.job].trace]--;
+        done++;
+        failed += msg.arg != 0;
+        fprintf(mystdout, "** Farm job %u done on worker %d (status %u), %u of %u\n", msg.job, worker, msg.arg, done,
+                (uns)jobs.size());
+        fflush(mystdout);
+        break;
+      }
+
+      default:
+        FATAL_ERROR(0, "Unexpected message %u from farm worker %d\n", msg.type, worker);
+    }
+  }
+
+  fprintf(mystdout, "** Farm done: %u jobs, %u failed\n", done, failed);
+  return failed + (uns)jobs.size() - done;
+}
+
+/**************************************************************************************/
+/* farm_copy_file: */
+
+static Flag farm_copy_file(const std::string& from, const std::string& to) {
+  static char buf[1 << 20];
+  int in = open(from.c_str(), O_RDONLY);
+  if (in < 0)
+    return FALSE;
+  std::string tmp = to + ".tmp";
+  int out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  Flag ok = out >= 0;
+
+  ssize_t len;
+  while (ok && (len = read(in, buf, sizeof(buf))) > 0)
+    ok = write(out, buf, len) == len;
+  ok &= len == 0;
+  close(in);
+  if (out >= 0)
+    ok &= !close(out);
+  if (!ok || rename(tmp.c_str(), to.c_str())) {
+    unlink(tmp.c_str());
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* farm_cache_trace: path the job should read trace from. The cache is kept in order of
+   use, most recent first. */
+
+static std::string farm_cache_trace(std::list<Farm_Cached_Trace>& cache, const std::string& trace) {
+  if (!FARM_TRACE_CACHE)
+    return trace;
+
+  for (auto it = cache.begin(); it != cache.end(); it++) {
+    if (it->trace == trace) {
+      cache.splice(cache.begin(), cache, it);
+      posix_fadvise(it->fd, 0, 0, POSIX_FADV_WILLNEED);
+      return it->local;
+    }
+  }
+
+  while (cache.size() >= FARM_TRACE_CACHE) {
+    Farm_Cached_Trace& victim = cache.back();
+    close(victim.fd);
+    unlink(victim.local.c_str());
+    unlink((victim.local + ".ffidx").c_str());
+    cache.pop_back();
+  }
+
+  static uns num_cached = 0;
+  std::string base = trace.substr(trace.find_last_of('/') + 1);
+  std::string local = std::string(FARM_SCRATCH_DIR) + "/trace" + std::to_string(num_cached++) + "_" + base;
+  if (!farm_copy_file(trace, local)) {
+    fprintf(mystdout, "** Farm: could not cache %s, reading it in place\n", trace.c_str());
+    return trace;
+  }
+  /* the fast forward index of the trace, if there is one */
+  farm_copy_file(trace + ".ffidx", local + ".ffidx");
+
+  Farm_Cached_Trace entry;
+  entry.trace = trace;
+  entry.local = local;
+  entry.fd = open(local.c_str(), O_RDONLY);
+  cache.push_front(entry);
+  return local;
+}
+
+/**************************************************************************************/
+/* farm_send_stats: streams the binary stats of a finished job to the coordinator */
+
+static void farm_send_stats(Client* client, uns job, const std::string& dir) {
+  for (uns proc_id = 0; proc_id < MAX_NUM_PROCS; proc_id++) {
+    char name[MAX_STR_LENGTH + 1];
+    snprintf(name, MAX_STR_LENGTH, "%s/%sstats%u.bin", dir.c_str(), FILE_TAG, proc_id);
+    FILE* file = fopen(name, "rb");
+    if (!file)
+      break;
+
+    Farm_Msg msg = farm_msg(FARM_MSG_STATS, job, proc_id);
+    do {
+      msg.len = fread(msg.data, 1, FARM_MSG_DATA, file);
+      client->send(Message<Farm_Msg>(msg));
+    } while (msg.len == FARM_MSG_DATA);
+    fclose(file);
+  }
+}
+
+/**************************************************************************************/
+/* farm_clean_dir: removes the files of a job directory and the directory */
+
+static void farm_clean_dir(const std::string& dir) {
+  std::string cmd = "rm -rf '" + dir + "'";
+  if (system(cmd.c_str()))
+    fprintf(mystdout, "** Farm: could not remove %s\n", dir.c_str());
+}
+
+/**************************************************************************************/
+/* farm_worker: */
+
+void farm_worker(int* argc, char*** argv) {
+  std::list<Farm_Cached_Trace> cache;
+
+  if (mkdir(FARM_SCRATCH_DIR, 0777) && errno != EEXIST)
+    FATAL_ERROR(0, "Could not create the farm scratch directory %s\n", FARM_SCRATCH_DIR);
+  Client* client = new Client(FARM_WORKER);
+
+  for (;;) {
+    client->send(Message<Farm_Msg>(farm_msg(FARM_MSG_READY, 0, 0)));
+    Farm_Msg msg = client->receive_exact<Farm_Msg>();
+    if (msg.type == FARM_MSG_STOP)
+      break;
+    ASSERTM(0, msg.type == FARM_MSG_JOB && msg.len < FARM_MSG_DATA, "Unexpected message %u from the coordinator\n",
+            msg.type);
+    msg.data[msg.len] = '\0';
+
+    std::istringstream line(msg.data);
+    std::string trace;
+    line >> trace;
+    std::string local = farm_cache_trace(cache, trace);
+    std::string dir = std::string(FARM_SCRATCH_DIR) + "/job" + std::to_string(msg.job) + "_" +
+                      std::to_string(getpid());
+    if (mkdir(dir.c_str(), 0777) && errno != EEXIST)
+      FATAL_ERROR(0, "Could not create the farm job directory %s\n", dir.c_str());
+
+    fflush(NULL); /* or the child prints what is buffered again */
+    pid_t pid = fork();
+    if (pid < 0)
+      FATAL_ERROR(0, "Could not fork farm job %u: %s\n", msg.job, strerror(errno));
+    if (!pid) {
+      /* the worker's arguments without --farm_worker, then those of the job */
+      std::vector<char*> args;
+      for (int ii = 0; ii < *argc; ii++) {
+        if (!strcmp((*argv)[ii], "--farm_worker")) {
+          ii++;
+          continue;
+        }
+        if (!strncmp((*argv)[ii], "--farm_worker=", 14))
+          continue;
+        args.push_back((*argv)[ii]);
+      }
+      args.push_back(strdup("--cbp_trace_r0"));
+      args.push_back(strdup(local.c_str()));
+      for (std::string token; line >> token;)
+        args.push_back(strdup(token.c_str()));
+      args.push_back(strdup("--stats_format"));
+      args.push_back(strdup("binary"));
+      args.push_back(strdup("--output_dir"));
+      args.push_back(strdup(dir.c_str()));
+
+      client->disconnect();
+      if (!freopen((dir + "/sim.out").c_str(), "w", stdout))
+        FATAL_ERROR(0, "Could not redirect the output of farm job %u\n", msg.job);
+      dup2(fileno(stdout), fileno(stderr));
+
+      *argc = args.size();
+      *argv = (char**)malloc(sizeof(char*) * (args.size() + 1));
+      memcpy(*argv, args.data(), sizeof(char*) * args.size());
+      (*argv)[args.size()] = NULL;
+      return;
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+      ;
+    uns result = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    farm_send_stats(client, msg.job, dir);
+    client->send(Message<Farm_Msg>(farm_msg(FARM_MSG_RESULT, msg.job, result)));
+    if (!result)
+      farm_clean_dir(dir);
+  }
+
+  for (auto& entry : cache) {
+    close(entry.fd);
+    unlink(entry.local.c_str());
+    unlink((entry.local + ".ffidx").c_str());
+  }
+  delete client;
+  exit(EXIT_SUCCESS);
+}
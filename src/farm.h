@@ -0,0 +1,52 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : farm.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Region farming: a coordinator hands (trace, parameters) jobs to
+ *                resident workers on other hosts and collects their binary stats.
+ ***************************************************************************************/
+
+#ifndef __FARM_H__
+#define __FARM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Runs the jobs of FARM_JOBS on the FARM_WORKERS workers connecting to FARM_COORDINATOR.
+   Returns the number of jobs that failed. */
+unsigned farm_coordinator(void);
+
+/* Connects to FARM_WORKER and runs the jobs it is given, each in a forked child. Returns
+   only in such a child, with *argc and *argv replaced by the arguments of its job; the
+   worker itself exits once the coordinator has no more jobs. */
+void farm_worker(int* argc, char*** argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef __FARM_H__ */
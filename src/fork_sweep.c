@@ -0,0 +1,216 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : fork_sweep.c
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Parameter sweeps forked from one warmup (FORK_SWEEP).
+ *
+ * Every non-empty line of the FORK_SWEEP file not starting with '#' is one
+ * configuration: '--name value' (or '--name=value') overrides of parameters that
+ * warmup does not depend on.  At the end of warmup the process forks a child per
+ * configuration, which shares the warmed state copy-on-write, applies its
+ * overrides and simulates with its output in <output_dir>/sweep<n>.
+ ***************************************************************************************/
+
+#include "fork_sweep.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "general.param.h"
+
+#include "param_parser.h"
+
+/**************************************************************************************/
+/* Global Variables */
+
+Flag fork_sweep_child = FALSE;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static uns fork_sweep_host_threads(void);
+static void fork_sweep_private_files(void);
+static void fork_sweep_apply(uns config, char* line);
+
+/**************************************************************************************/
+/* fork_sweep_host_threads: fork() copies only the calling thread */
+
+static uns fork_sweep_host_threads(void) {
+  DIR* dir = opendir("/proc/self/task");
+  struct dirent* entry;
+  uns threads = 0;
+
+  if (!dir)
+    return 1;
+  while ((entry = readdir(dir)))
+    threads += entry->d_name[0] != '.';
+  closedir(dir);
+  return threads;
+}
+
+/**************************************************************************************/
+/* fork_sweep_private_files: the children inherit the parent's open file
+   descriptions, whose offsets they would move under each other's feet, so every
+   file open for reading (the traces) is reopened at the same offset */
+
+static void fork_sweep_private_files(void) {
+  DIR* dir = opendir("/proc/self/fd");
+  struct dirent* entry;
+
+  ASSERTM(0, dir, "Could not list the open files\n");
+  while ((entry = readdir(dir))) {
+    char link[64];
+    char path[MAX_STR_LENGTH + 1];
+    struct stat st;
+    int fd = atoi(entry->d_name);
+
+    if (entry->d_name[0] == '.' || fd == dirfd(dir))
+      continue;
+    if ((fcntl(fd, F_GETFL) & O_ACCMODE) != O_RDONLY || fstat(fd, &st) || !S_ISREG(st.st_mode))
+      continue;
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    ssize_t len = readlink(link, path, MAX_STR_LENGTH);
+    if (len <= 0)
+      continue;
+    path[len] = '\0';
+
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+    int new_fd = open(path, O_RDONLY | (fcntl(fd, F_GETFD) & FD_CLOEXEC ? O_CLOEXEC : 0));
+    if (new_fd < 0)
+      FATAL_ERROR(0, "Could not reopen %s in the sweep child: %s\n", path, strerror(errno));
+    if (lseek(new_fd, offset, SEEK_SET) != offset || dup2(new_fd, fd) < 0)
+      FATAL_ERROR(0, "Could not reopen %s in the sweep child: %s\n", path, strerror(errno));
+    close(new_fd);
+  }
+  closedir(dir);
+}
+
+/**************************************************************************************/
+/* fork_sweep_apply: applies the overrides of a configuration in its child */
+
+static void fork_sweep_apply(uns config, char* line) {
+  char dir[MAX_STR_LENGTH + 1];
+  char* save = NULL;
+  char* token;
+
+  snprintf(dir, MAX_STR_LENGTH, "%s/sweep%u", OUTPUT_DIR, config);
+  if (mkdir(dir, 0777) && errno != EEXIST)
+    FATAL_ERROR(0, "Could not create the sweep output directory %s\n", dir);
+
+  FILE* record = file_tag_fopen(dir, "sweep.params", "w");
+  if (record) {
+    fputs(line, record);
+    fclose(record);
+  }
+
+  for (token = strtok_r(line, " \t\n", &save); token; token = strtok_r(NULL, " \t\n", &save)) {
+    char* value;
+    if (strncmp(token, "--", 2))
+      FATAL_ERROR(0, "Sweep configuration %u: expected --name, got '%s'\n", config, token);
+    token += 2;
+    value = strchr(token, '=');
+    if (value)
+      *value++ = '\0';
+    else
+      value = strtok_r(NULL, " \t\n", &save);
+    if (!value)
+      FATAL_ERROR(0, "Sweep configuration %u: --%s has no value\n", config, token);
+    if (!strcmp(token, "output_dir") || !set_param(token, value))
+      FATAL_ERROR(0, "Sweep configuration %u: cannot set parameter %s\n", config, token);
+  }
+  set_param("output_dir", dir);
+
+  FILE* out = file_tag_fopen(OUTPUT_DIR, "sim.out", "w");
+  if (out)
+    mystdout = out;
+}
+
+/**************************************************************************************/
+/* fork_sweep: */
+
+void fork_sweep(void) {
+  char line[MAX_STR_LENGTH + 1];
+  uns num_configs = 0;
+  uns running = 0;
+  uns failed = 0;
+  int status;
+
+  ASSERTM(0, fork_sweep_host_threads() == 1,
+          "FORK_SWEEP needs a single-threaded simulator at the end of warmup (no PARALLEL_CORES, decode threads, "
+          "prefetch producers or binary stat trace)\n");
+  FILE* file = fopen(FORK_SWEEP, "r");
+  if (!file)
+    FATAL_ERROR(0, "Could not open the FORK_SWEEP file %s\n", FORK_SWEEP);
+
+  fflush(NULL); /* or the children print what is buffered again */
+  while (fgets(line, sizeof(line), file)) {
+    char* start = line + strspn(line, " \t\n");
+    if (!*start || *start == '#')
+      continue;
+
+    if (FORK_SWEEP_JOBS && running == FORK_SWEEP_JOBS) {
+      if (wait(&status) > 0) {
+        running--;
+        failed += !WIFEXITED(status) || WEXITSTATUS(status);
+      }
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+      FATAL_ERROR(0, "Could not fork sweep configuration %u: %s\n", num_configs, strerror(errno));
+    if (!pid) {
+      fork_sweep_child = TRUE;
+      fork_sweep_private_files();
+      fclose(file);
+      fork_sweep_apply(num_configs, start);
+      return;
+    }
+    fprintf(mystdout, "** Sweep configuration %u (pid %d): %s", num_configs, (int)pid, start);
+    fflush(mystdout);
+    num_configs++;
+    running++;
+  }
+  fclose(file);
+
+  while (running && wait(&status) > 0) {
+    running--;
+    failed += !WIFEXITED(status) || WEXITSTATUS(status);
+  }
+  fprintf(mystdout, "** Sweep done: %u configurations, %u failed\n", num_configs, failed);
+  exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,50 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : fork_sweep.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Parameter sweeps forked from one warmup (FORK_SWEEP).
+ ***************************************************************************************/
+
+#ifndef __FORK_SWEEP_H__
+#define __FORK_SWEEP_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Global Variables */
+
+/* set in the children, so that init_model(SIMULATION_MODE) re-reads the parameters
+   the child may have overridden */
+extern Flag fork_sweep_child;
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Called at the end of warmup: forks one child per configuration of the FORK_SWEEP
+   file and returns in each child with its overrides applied. The parent waits for
+   the children and exits. */
+void fork_sweep(void);
+
+#endif /* #ifndef __FORK_SWEEP_H__ */
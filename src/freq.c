@@ -30,6 +30,7 @@
 
 #include "globals/assert.h"
 #include "globals/global_defs.h"
+#include "globals/utils.h"
 
 #include "debug/debug_macros.h"
 
@@ -43,7 +44,8 @@
 /* Macros */
 
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_FREQ, ##args)
-#define MAX_FREQ_DOMAINS 100
+#define MAX_FREQ_DOMAINS (MAX_NUM_PROCS + 36)
+#define READY_MASK_WORDS ((MAX_FREQ_DOMAINS + 63) / 64)
 
 /**************************************************************************************/
 /* Types */
@@ -51,7 +53,7 @@
 typedef struct Domain_Info_struct {
   Counter cycles;
   uns cycle_time;
-  uns time_until_next_cycle;
+  Counter next_cycle_time;  // time the domain's next cycle starts, cur_time while it is ready
   char* name;
 } Domain_Info;
 
@@ -66,6 +68,19 @@ static Counter cur_time;
 static uns num_domains = 0;
 Domain_Info domains[MAX_FREQ_DOMAINS];
 
+/* Domains waiting for their next cycle sit in a min-heap on next_cycle_time; the ones whose cycle starts at
+   cur_time are listed in ready_domains and flagged in ready_mask instead. */
+static Freq_Domain_Id waiting_heap[MAX_FREQ_DOMAINS];
+static uns num_waiting = 0;
+static Freq_Domain_Id ready_domains[MAX_FREQ_DOMAINS];
+static uns num_ready = 0;
+static uns64 ready_mask[READY_MASK_WORDS];
+
+/* Slack simulation (PARALLEL_SLACK): a worker thread running a cycle of its core ahead of
+   cur_time sets that cycle here, and then sees every domain as it is at that cycle */
+static CORE_LOCAL Freq_Domain_Id local_domain;
+static CORE_LOCAL Counter local_cycles;
+
 Freq_Domain_Id FREQ_DOMAIN_CORES[MAX_NUM_PROCS];
 Freq_Domain_Id FREQ_DOMAIN_L1;
 Freq_Domain_Id FREQ_DOMAIN_MEMORY;
@@ -74,13 +89,16 @@ Freq_Domain_Id FREQ_DOMAIN_MEMORY;
 /* Local prototypes */
 
 static Freq_Domain_Id freq_domain_create(char* name, uns cycle_time);
+static void freq_set_ready(Freq_Domain_Id id);
+static void freq_heap_push(Freq_Domain_Id id);
+static Freq_Domain_Id freq_heap_pop(void);
 
 /**************************************************************************************/
 /* Function definitions */
 
 void freq_init(void) {
   char buf[MAX_STR_LENGTH + 1];
-  uns core_cycle_times[MAX_NUM_PROCS] = {
+  uns core_cycle_times[MAX_NUM_PROC_PARAMS] = {
       CORE_0_CYCLE_TIME,  CORE_1_CYCLE_TIME,  CORE_2_CYCLE_TIME,  CORE_3_CYCLE_TIME,  CORE_4_CYCLE_TIME,
       CORE_5_CYCLE_TIME,  CORE_6_CYCLE_TIME,  CORE_7_CYCLE_TIME,  CORE_8_CYCLE_TIME,  CORE_9_CYCLE_TIME,
       CORE_10_CYCLE_TIME, CORE_11_CYCLE_TIME, CORE_12_CYCLE_TIME, CORE_13_CYCLE_TIME, CORE_14_CYCLE_TIME,
@@ -98,15 +116,17 @@ void freq_init(void) {
   uns l1_cycle_time = L1_CYCLE_TIME;
   if (CHIP_CYCLE_TIME) {
     // if CHIP_CYCLE_TIME is set, it overrides core and L1 cycle times
-    for (int proc_id = 0; proc_id < MAX_NUM_PROCS; proc_id++) {
+    for (int proc_id = 0; proc_id < MAX_NUM_PROC_PARAMS; proc_id++) {
       core_cycle_times[proc_id] = CHIP_CYCLE_TIME;
     }
     l1_cycle_time = CHIP_CYCLE_TIME;
   }
   for (int proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    // cores past the numbered params run at the cycle time of core 0
+    uns cycle_time = core_cycle_times[proc_id < MAX_NUM_PROC_PARAMS ? proc_id : 0];
     sprintf(buf, "CORE_%d", proc_id);
-    FREQ_DOMAIN_CORES[proc_id] = freq_domain_create(buf, core_cycle_times[proc_id]);
-    GET_STAT_EVENT(proc_id, PARAM_CORE_CYCLE_TIME) = core_cycle_times[proc_id];
+    FREQ_DOMAIN_CORES[proc_id] = freq_domain_create(buf, cycle_time);
+    GET_STAT_EVENT(proc_id, PARAM_CORE_CYCLE_TIME) = cycle_time;
   }
   FREQ_DOMAIN_L1 = freq_domain_create("L1", l1_cycle_time);
   // FREQ_DOMAIN_MEMORY = freq_domain_create("MEMORY", MEMORY_CYCLE_TIME);
@@ -124,36 +144,66 @@ static Freq_Domain_Id freq_domain_create(char* name, uns cycle_time) {
   domains[num_domains].cycles = 0;
   domains[num_domains].cycle_time = cycle_time;
   // every domain's first cycle can start at time zero
-  domains[num_domains].time_until_next_cycle = 0;
+  domains[num_domains].next_cycle_time = cur_time;
   domains[num_domains].name = strdup(name);
+  freq_set_ready(num_domains);
   num_domains++;
   return num_domains - 1;
 }
 
+static void freq_set_ready(Freq_Domain_Id id) {
+  ready_domains[num_ready++] = id;
+  SETBIT(ready_mask[id / 64], id % 64);
+}
+
+static void freq_heap_push(Freq_Domain_Id id) {
+  uns pos = num_waiting++;
+  while (pos > 0) {
+    uns parent = (pos - 1) / 2;
+    if (domains[waiting_heap[parent]].next_cycle_time <= domains[id].next_cycle_time)
+      break;
+    waiting_heap[pos] = waiting_heap[parent];
+    pos = parent;
+  }
+  waiting_heap[pos] = id;
+}
+
+static Freq_Domain_Id freq_heap_pop(void) {
+  ASSERT(0, num_waiting > 0);
+  Freq_Domain_Id top = waiting_heap[0];
+  Freq_Domain_Id last = waiting_heap[--num_waiting];
+  uns pos = 0;
+  while (2 * pos + 1 < num_waiting) {
+    uns child = 2 * pos + 1;
+    if (child + 1 < num_waiting &&
+        domains[waiting_heap[child + 1]].next_cycle_time < domains[waiting_heap[child]].next_cycle_time)
+      child++;
+    if (domains[last].next_cycle_time <= domains[waiting_heap[child]].next_cycle_time)
+      break;
+    waiting_heap[pos] = waiting_heap[child];
+    pos = child;
+  }
+  waiting_heap[pos] = last;
+  return top;
+}
+
 Flag freq_is_ready(Freq_Domain_Id id) {
   ASSERT(0, id < num_domains);
-  return domains[id].time_until_next_cycle == 0;
+  return TESTBIT(ready_mask[id / 64], id % 64);
 }
 
 void freq_advance_time(void) {
   /* Make currently ready domains wait for their next cycles */
-  for (uns i = 0; i < num_domains; i++) {
-    if (domains[i].time_until_next_cycle == 0) {
-      domains[i].time_until_next_cycle = domains[i].cycle_time;
-    }
-  }
-
-  /* Find the time until the next cycle */
-  uns min_time_until_next_cycle = domains[0].time_until_next_cycle;
-
-  for (uns i = 1; i < num_domains; i++) {
-    if (domains[i].time_until_next_cycle < min_time_until_next_cycle) {
-      min_time_until_next_cycle = domains[i].time_until_next_cycle;
-    }
+  for (uns i = 0; i < num_ready; i++) {
+    Freq_Domain_Id id = ready_domains[i];
+    domains[id].next_cycle_time = cur_time + domains[id].cycle_time;
+    CLRBIT(ready_mask[id / 64], id % 64);
+    freq_heap_push(id);
   }
+  num_ready = 0;
 
   /* Time until the next cycle is the time delta */
-  uns time_delta = min_time_until_next_cycle;
+  Counter time_delta = domains[waiting_heap[0]].next_cycle_time - cur_time;
   ASSERT(0, time_delta > 0);
 
   /* Update externally visible state */
@@ -162,30 +212,54 @@ void freq_advance_time(void) {
   INC_STAT_EVENT_ALL(POWER_TIME, time_delta);
   DEBUG(0, "Advancing time to %lld fs\n", cur_time);
 
-  /* Update every domain's info using the time delta */
-  for (uns i = 0; i < num_domains; i++) {
-    domains[i].time_until_next_cycle -= time_delta;
-    if (domains[i].time_until_next_cycle == 0) {
-      /* This domain is now ready. Update its cycle count. */
-      domains[i].cycles++;
-      DEBUG(0, "Domain %s ready to simulate cycle %lld\n", domains[i].name, domains[i].cycles);
-    }
+  /* The domains whose cycles start now are ready. Update their cycle counts. */
+  while (num_waiting > 0 && domains[waiting_heap[0]].next_cycle_time == cur_time) {
+    Freq_Domain_Id id = freq_heap_pop();
+    domains[id].cycles++;
+    freq_set_ready(id);
+    DEBUG(0, "Domain %s ready to simulate cycle %lld\n", domains[id].name, domains[id].cycles);
   }
 }
 
 void freq_reset_cycle_counts(void) {
+  num_waiting = 0;
+  num_ready = 0;
+  memset(ready_mask, 0, sizeof(ready_mask));
   for (uns i = 0; i < num_domains; i++) {
     domains[i].cycles = 0;
-    domains[i].time_until_next_cycle = 0;
+    domains[i].next_cycle_time = cur_time;
+    freq_set_ready(i);
   }
 }
 
+/* the thread is running a cycle of local_domain that starts after cur_time */
+static inline Flag freq_local_ahead(void) {
+  return local_cycles > domains[local_domain].cycles;
+}
+
+/* time the given (current or future) cycle of a domain starts */
+static Counter freq_cycle_start_time(Freq_Domain_Id id, Counter cycles) {
+  Flag ready_now = (domains[id].next_cycle_time == cur_time);
+  Counter last_cycle_time = domains[id].next_cycle_time - (ready_now ? 0 : domains[id].cycle_time);
+  return last_cycle_time + (cycles - domains[id].cycles) * domains[id].cycle_time;
+}
+
+void freq_set_local_cycle(Freq_Domain_Id id, Counter cycles) {
+  ASSERT(0, id < num_domains);
+  local_domain = id;
+  local_cycles = cycles;
+}
+
 Counter freq_cycle_count(Freq_Domain_Id id) {
   ASSERT(0, id < num_domains);
+  if (freq_local_ahead())
+    return id == local_domain ? local_cycles : freq_convert_future_cycle(local_domain, local_cycles, id);
   return domains[id].cycles;
 }
 
 Counter freq_time(void) {
+  if (freq_local_ahead())
+    return freq_cycle_start_time(local_domain, local_cycles);
   return cur_time;
 }
 
@@ -193,14 +267,14 @@ Counter freq_future_time(Freq_Domain_Id id, Counter cycles) {
   ASSERT(0, id < num_domains);
   ASSERT(0, domains[id].cycles <= cycles);
 
-  return freq_time() + (cycles - domains[id].cycles) * domains[id].cycle_time;
+  return cur_time + (cycles - domains[id].cycles) * domains[id].cycle_time;
 }
 
 void freq_set_cycle_time(Freq_Domain_Id id, uns cycle_time) {
   ASSERT(0, id < num_domains);
   ASSERT(0, cycle_time > 0);
   domains[id].cycle_time = cycle_time;
-  // Not changing time_until_next_cycle for simplicity (the
+  // Not changing next_cycle_time for simplicity (the
   // frequency change will take effect after the current cycle
   // finishes).
 }
@@ -217,20 +291,15 @@ Counter freq_convert(Freq_Domain_Id src, Counter src_cycle_count, Freq_Domain_Id
 
 Counter freq_convert_future_cycle(Freq_Domain_Id src, Counter src_cycle_count, Freq_Domain_Id dst) {
   ASSERT(0, src_cycle_count >= domains[src].cycles);
-  Counter remaining_src_cycles = src_cycle_count - domains[src].cycles;
-  Flag src_cycle_ready_now = (domains[src].time_until_next_cycle == 0);
-  Counter last_src_cycle_time =
-      cur_time + domains[src].time_until_next_cycle - (src_cycle_ready_now ? 0 : domains[src].cycle_time);
-  Counter time_after_last_src_cycle = remaining_src_cycles * domains[src].cycle_time;
-  Counter future_time = last_src_cycle_time + time_after_last_src_cycle;
-
-  Flag dst_cycle_ready_now = (domains[dst].time_until_next_cycle == 0);
-  if (future_time <= cur_time + domains[dst].time_until_next_cycle) {
+  Counter future_time = freq_cycle_start_time(src, src_cycle_count);
+
+  Flag dst_cycle_ready_now = (domains[dst].next_cycle_time == cur_time);
+  if (future_time <= domains[dst].next_cycle_time) {
     // either this cycle or next cycle
     return domains[dst].cycles + !dst_cycle_ready_now;
   }
 
-  Counter time_remaining_after_immediate_dst_cycle = future_time - cur_time - domains[dst].time_until_next_cycle;
+  Counter time_remaining_after_immediate_dst_cycle = future_time - domains[dst].next_cycle_time;
 
   // make sure we don't add an extra cycle if the future time is a cycle
   // boundary for both domains
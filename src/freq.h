@@ -67,6 +67,10 @@ void freq_reset_cycle_counts(void);
 /* Returns the cycle count in the specified frequency domain */
 Counter freq_cycle_count(Freq_Domain_Id id);
 
+/* Makes the calling thread see the time of the given cycle of a domain, which may be ahead
+   of the global time (see PARALLEL_SLACK in cmp_model.c) */
+void freq_set_local_cycle(Freq_Domain_Id id, Counter cycles);
+
 /* Returns the current simulation time (in femtoseconds) */
 Counter freq_time(void);
 
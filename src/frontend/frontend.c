@@ -32,6 +32,8 @@
 #include "globals/global_defs.h"
 #include "globals/global_vars.h"
 
+#include "debug/host_prof.h"
+
 #include "core.param.h"
 #include "general.param.h"
 
@@ -42,9 +44,11 @@
 #include "op.h"
 #include "pin_exec_driven_fe.h"
 #include "pin_trace_fe.h"
+#include "sct_fe.h"
 #include "sim.h"
 #include "statistics.h"
 #include "thread.h"
+#include "trace_io.h"
 
 #ifdef ENABLE_PT_MEMTRACE
 #include "frontend/pt_memtrace/trace_fe.h"
@@ -62,6 +66,7 @@ extern int op_type_delays[];
 void frontend_init() {
   ASSERT(0, ST_OP_INV + NUM_OP_TYPES == ST_NOT_CF);
   frontend_intf_init();
+  trace_io_init();
 
   switch (FRONTEND) {
     case FE_PIN_EXEC_DRIVEN: {
@@ -72,6 +77,10 @@ void frontend_init() {
       trace_init();
       break;
     }
+    case FE_SCT: {
+      sct_init();
+      break;
+    }
 #ifdef ENABLE_PT_MEMTRACE
     case FE_PT:
     case FE_MEMTRACE: {
@@ -95,6 +104,10 @@ void frontend_done(Flag* retired_exit) {
       trace_done();
       break;
     }
+    case FE_SCT: {
+      sct_done();
+      break;
+    }
 #ifdef ENABLE_PT_MEMTRACE
     case FE_PT:
     case FE_MEMTRACE: {
@@ -108,6 +121,52 @@ void frontend_done(Flag* retired_exit) {
   }
 }
 
+char** frontend_trace_files(void) {
+  static char** files = NULL;
+  if (files)
+    return files;
+
+  files = (char**)calloc(NUM_CORES, sizeof(char*));
+  if (TRACE_LIST) {
+    FILE* list = fopen(TRACE_LIST, "r");
+    ASSERTM(0, list, "Cannot open trace list %s\n", TRACE_LIST);
+    char line[MAX_STR_LENGTH + 1];
+    uns proc_id = 0;
+    while (proc_id < NUM_CORES && fgets(line, sizeof(line), list)) {
+      line[strcspn(line, "\r\n")] = '\0';
+      if (line[0] == '\0' || line[0] == '#')
+        continue;
+      files[proc_id++] = strdup(line);
+    }
+    fclose(list);
+    ASSERTM(0, proc_id == NUM_CORES || DUMB_CORE_ON, "Trace list %s has %u traces for %u cores\n", TRACE_LIST, proc_id,
+            NUM_CORES);
+  } else {
+    /* temp variable needed for easy initialization syntax */
+    char* trace_params[MAX_NUM_PROC_PARAMS] = {
+      CBP_TRACE_R0,  CBP_TRACE_R1,  CBP_TRACE_R2,  CBP_TRACE_R3,  CBP_TRACE_R4,  CBP_TRACE_R5,  CBP_TRACE_R6,
+      CBP_TRACE_R7,  CBP_TRACE_R8,  CBP_TRACE_R9,  CBP_TRACE_R10, CBP_TRACE_R11, CBP_TRACE_R12, CBP_TRACE_R13,
+      CBP_TRACE_R14, CBP_TRACE_R15, CBP_TRACE_R16, CBP_TRACE_R17, CBP_TRACE_R18, CBP_TRACE_R19, CBP_TRACE_R20,
+      CBP_TRACE_R21, CBP_TRACE_R22, CBP_TRACE_R23, CBP_TRACE_R24, CBP_TRACE_R25, CBP_TRACE_R26, CBP_TRACE_R27,
+      CBP_TRACE_R28, CBP_TRACE_R29, CBP_TRACE_R30, CBP_TRACE_R31, CBP_TRACE_R32, CBP_TRACE_R33, CBP_TRACE_R34,
+      CBP_TRACE_R35, CBP_TRACE_R36, CBP_TRACE_R37, CBP_TRACE_R38, CBP_TRACE_R39, CBP_TRACE_R40, CBP_TRACE_R41,
+      CBP_TRACE_R42, CBP_TRACE_R43, CBP_TRACE_R44, CBP_TRACE_R45, CBP_TRACE_R46, CBP_TRACE_R47, CBP_TRACE_R48,
+      CBP_TRACE_R49, CBP_TRACE_R50, CBP_TRACE_R51, CBP_TRACE_R52, CBP_TRACE_R53, CBP_TRACE_R54, CBP_TRACE_R55,
+      CBP_TRACE_R56, CBP_TRACE_R57, CBP_TRACE_R58, CBP_TRACE_R59, CBP_TRACE_R60, CBP_TRACE_R61, CBP_TRACE_R62,
+      CBP_TRACE_R63,
+    };
+    ASSERTM(0, NUM_CORES <= MAX_NUM_PROC_PARAMS, "Use --trace_list to give traces to more than %d cores\n",
+            MAX_NUM_PROC_PARAMS);
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      files[proc_id] = trace_params[proc_id];
+  }
+  if (DUMB_CORE_ON) {
+    // avoid errors by specifying a trace known to be good
+    files[DUMB_CORE] = files[0];
+  }
+  return files;
+}
+
 Addr frontend_next_fetch_addr(uns proc_id) {
   return convert_to_cmp_addr(proc_id, frontend->next_fetch_addr(proc_id));
 }
@@ -117,8 +176,10 @@ Flag frontend_can_fetch_op(uns proc_id) {
 }
 
 void frontend_fetch_op(uns proc_id, Op* op) {
+  uns64 prof_t = host_prof_now();
   frontend->fetch_op(proc_id, op);
   collect_op_stats(op);
+  host_prof_lap(proc_id, HOST_PROF_FETCH_OP, prof_t);
 }
 
 void frontend_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr) {
@@ -141,6 +202,48 @@ void frontend_retire(uns proc_id, uns64 inst_uid) {
   DEBUG(proc_id, "Retiring inst_uid %lld end\n", inst_uid);
 }
 
+uns frontend_fetch_warmup_batch(uns proc_id, Warmup_Inst* insts, uns max) {
+  if (FRONTEND == FE_TRACE)
+    return trace_fetch_warmup_batch(proc_id, insts, max);
+
+  static Op op;
+  static Table_Info table_info;
+  static Inst_Info inst_info;
+  op.table_info = &table_info;
+  op.inst_info = &inst_info;
+  op.mbp7_info = NULL;
+
+  uns num = 0;
+  while (num < max) {
+    Warmup_Inst* inst = &insts[num++];
+    inst->num_ld = inst->num_st = 0;
+    inst->cf_type = NOT_CF;
+    inst->taken = FALSE;
+    inst->exit = FALSE;
+    do {
+      frontend_fetch_op(proc_id, &op);
+      if (op.bom)
+        inst->pc = op.inst_info->addr;
+      if (op.table_info->mem_type == MEM_LD && inst->num_ld < WARMUP_INST_MAX_LD)
+        inst->ld_addr[inst->num_ld++] = op.oracle_info.va;
+      else if (op.table_info->mem_type == MEM_ST && inst->num_st < WARMUP_INST_MAX_ST)
+        inst->st_addr[inst->num_st++] = op.oracle_info.va;
+      if (op.table_info->cf_type) {
+        inst->cf_type = op.table_info->cf_type;
+        inst->taken = op.oracle_info.dir;
+        inst->target = op.oracle_info.target;
+      }
+      inst->exit |= op.exit;
+    } while (!op.eom);
+    inst->inst_uid = op.inst_uid;
+    inst->npc = op.oracle_info.npc;
+    frontend_retire(proc_id, op.inst_uid);
+    if (inst->exit)
+      break;
+  }
+  return num;
+}
+
 static void collect_op_stats(Op* op) {
   if (!op->off_path) {
     STAT_EVENT(op->proc_id, ST_OP_ONPATH);
@@ -177,5 +280,18 @@ void frontend_extract_basic_block_vectors() {
       break;
   }
 }
+
+void frontend_write_sct_trace() {
+  switch (FRONTEND) {
+    case FE_PT:
+    case FE_MEMTRACE: {
+      ext_trace_write_sct();
+      break;
+    }
+    default:
+      ASSERT(0, 0);
+      break;
+  }
+}
 #endif
 /*************************************************************/
@@ -30,6 +30,10 @@
 
 #include "globals/global_types.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*************************************************************/
 /* External frontend interface */
 
@@ -59,10 +63,42 @@ void frontend_recover(uns proc_id, uns64 inst_uid);
 /* Let the frontend know that this instruction is retired) */
 void frontend_retire(uns proc_id, uns64 inst_uid);
 
+/* One instruction of the functional warmup fast path: what cmp_warmup needs, without
+   the uops of the instruction */
+#define WARMUP_INST_MAX_LD 8
+#define WARMUP_INST_MAX_ST 8
+
+typedef struct Warmup_Inst_struct {
+  uns64 inst_uid;
+  Addr pc;
+  Addr npc;
+  Addr target; /* branch target of a control flow instruction */
+  Addr ld_addr[WARMUP_INST_MAX_LD];
+  Addr st_addr[WARMUP_INST_MAX_ST];
+  uns8 num_ld;
+  uns8 num_st;
+  uns8 cf_type; /* Cf_Type */
+  Flag taken;
+  Flag exit;
+} Warmup_Inst;
+
+/* Fetches up to max on-path instructions of proc_id for functional warmup and retires
+   them. Stops after the exit; returns the number fetched. Frontends without their own
+   fast path fall back to fetching and summarizing the uops. */
+uns frontend_fetch_warmup_batch(uns proc_id, Warmup_Inst* insts, uns max);
+
 #ifdef ENABLE_PT_MEMTRACE
 /* Trace post-processing to extract basic block vectors */
 void frontend_extract_basic_block_vectors(void);
+void frontend_write_sct_trace(void);
 #endif
+/* Trace file of each core (NUM_CORES entries), from TRACE_LIST or the cbp_trace_r* params */
+char** frontend_trace_files(void);
+
 /*************************************************************/
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /*  __FRONTEND_H__*/
@@ -35,6 +35,7 @@
 /* Include headers of all the implementations here */
 #include "frontend/pin_exec_driven_fe.h"
 #include "frontend/pin_trace_fe.h"
+#include "frontend/sct_fe.h"
 
 #ifdef ENABLE_PT_MEMTRACE
 #include "frontend/pt_memtrace/trace_fe.h"
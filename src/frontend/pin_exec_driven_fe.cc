@@ -46,6 +46,7 @@ extern "C" {
 #include "frontend/pin_exec_driven_fe.h"
 #include "pin/pin_lib/message_queue_interface_lib.h"
 #include "pin/pin_lib/pin_scarab_common_lib.h"
+#include "pin/pin_lib/shm_ring_lib.h"
 #include "pin/pin_lib/uop_generator.h"
 
 #include "decoupled_frontend.h"
@@ -54,33 +55,71 @@ extern "C" {
 
 Server* server;
 std::vector<ScarabOpBuffer_type> cached_cop_buffers;
+std::vector<ShmRing*> rings;  // PIN_EXEC_DRIVEN_FE_SHM: ops are read in place from the ring
 
+void send_cmd_to_pin(uns proc_id, const Scarab_To_Pin_Msg& msg);
 void get_next_op_buffer_from_pin(uns proc_id);
 void update_op_buffer_if_empty(uns proc_id);
 void invalidate_op_buffer(uns proc_id);
+bool op_buffer_empty(uns proc_id);
+compressed_op* op_buffer_front(uns proc_id);
+void op_buffer_pop(uns proc_id);
 
 /**********************************************************
  * Cached Op interface
  **********************************************************/
+void send_cmd_to_pin(uns proc_id, const Scarab_To_Pin_Msg& msg) {
+  if (PIN_EXEC_DRIVEN_FE_SHM)
+    rings[proc_id]->push_cmd(msg);
+  else
+    server->send(proc_id, (Message<Scarab_To_Pin_Msg>)msg);  // blocking
+}
+
 void get_next_op_buffer_from_pin(uns proc_id) {
   Scarab_To_Pin_Msg msg;
   msg.type = FE_FETCH_OP;
   msg.inst_addr = 0;
   msg.inst_uid = 0;
 
+  if (PIN_EXEC_DRIVEN_FE_SHM) {
+    // tagged with the packets seen so far, so PIN can tell it from a fetch that raced with run-ahead
+    uint64_t packets = rings[proc_id]->num_packets();
+    msg.inst_uid = packets;
+    rings[proc_id]->push_cmd(msg);
+    rings[proc_id]->wait_for_packet(packets);  // spins until PIN publishes the packet it has been filling
+    return;
+  }
   server->send(proc_id, (Message<Scarab_To_Pin_Msg>)msg);                       // blocking
   cached_cop_buffers[proc_id] = server->receive<ScarabOpBuffer_type>(proc_id);  // blocking
 }
 
 void update_op_buffer_if_empty(uns proc_id) {
-  if (cached_cop_buffers[proc_id].size() == 0) {
+  if (op_buffer_empty(proc_id)) {
     DEBUG(proc_id, "Calling FETCH_OP to PIN\n");
     get_next_op_buffer_from_pin(proc_id);
   }
 }
 
 inline void invalidate_op_buffer(uns proc_id) {
-  cached_cop_buffers[proc_id].clear();
+  if (PIN_EXEC_DRIVEN_FE_SHM)
+    rings[proc_id]->request_flush();  // drops the invalidated ops once PIN has acknowledged the command
+  else
+    cached_cop_buffers[proc_id].clear();
+}
+
+inline bool op_buffer_empty(uns proc_id) {
+  return PIN_EXEC_DRIVEN_FE_SHM ? rings[proc_id]->ops_empty() : cached_cop_buffers[proc_id].empty();
+}
+
+inline compressed_op* op_buffer_front(uns proc_id) {
+  return PIN_EXEC_DRIVEN_FE_SHM ? rings[proc_id]->op_front() : &cached_cop_buffers[proc_id].front();
+}
+
+inline void op_buffer_pop(uns proc_id) {
+  if (PIN_EXEC_DRIVEN_FE_SHM)
+    rings[proc_id]->op_pop();
+  else
+    op_buffer_pop(proc_id);
 }
 
 Addr get_fetch_address(uns proc_id, compressed_op* cop) {
@@ -91,6 +130,18 @@ Addr get_fetch_address(uns proc_id, compressed_op* cop) {
  * PIN Exec Driven Interface Functions
  **********************************************************/
 void pin_exec_driven_init(uns numProcs) {
+  // the rings must exist before PIN connects, which is how it tells which transport to use
+  ASSERTM(0, PIN_EXEC_DRIVEN_FE_SHM || !PIN_EXEC_DRIVEN_FE_RUNAHEAD_OPS, "Run-ahead needs PIN_EXEC_DRIVEN_FE_SHM\n");
+  rings.resize(numProcs, NULL);
+  for (uns proc_id = 0; proc_id < numProcs; proc_id++) {
+    std::string path = ShmRing::path_for(PIN_EXEC_DRIVEN_FE_SOCKET, proc_id);
+    if (!PIN_EXEC_DRIVEN_FE_SHM) {
+      unlink(path.c_str());
+      continue;
+    }
+    rings[proc_id] = new ShmRing();
+    ASSERTM(proc_id, rings[proc_id]->create(path, PIN_EXEC_DRIVEN_FE_SHM_OPS, PIN_EXEC_DRIVEN_FE_RUNAHEAD_OPS), "Could not create %s\n", path.c_str());
+  }
   server = new Server(PIN_EXEC_DRIVEN_FE_SOCKET, numProcs);
   cached_cop_buffers.resize(numProcs);
   uop_generator_init(numProcs);
@@ -110,20 +161,22 @@ void pin_exec_driven_done(Flag* retired_exit) {
     server->wait_for_client_to_close(i);
   }
   delete server;
+  for (ShmRing* ring : rings)
+    delete ring;
 }
 
 Flag pin_exec_driven_can_fetch_op(uns proc_id) {
   DEBUG(proc_id, "Can Fetch Op begin:\n");
   update_op_buffer_if_empty(proc_id);
 
-  return !cached_cop_buffers[proc_id].empty() && !is_sentinal_op(&cached_cop_buffers[proc_id].front());
+  return !op_buffer_empty(proc_id) && !is_sentinal_op(op_buffer_front(proc_id));
 }
 
 Addr pin_exec_driven_next_fetch_addr(uns proc_id) {
   DEBUG(proc_id, "Next Fetch Addr begin:\n");
   update_op_buffer_if_empty(proc_id);
 
-  Addr next_fetch_addr = get_fetch_address(proc_id, &cached_cop_buffers[proc_id].front());
+  Addr next_fetch_addr = get_fetch_address(proc_id, op_buffer_front(proc_id));
   ASSERT_PROC_ID_IN_ADDR(proc_id, next_fetch_addr);
   return next_fetch_addr;
 }
@@ -132,16 +185,17 @@ void pin_exec_driven_fetch_op(uns proc_id, Op* op) {
   DEBUG(proc_id, "Fetch Op begin:\n");
   update_op_buffer_if_empty(proc_id);
 
-  Flag eom = uop_generator_extract_op(proc_id, op, &cached_cop_buffers[proc_id].front());
+  compressed_op* cop = op_buffer_front(proc_id);
+  Flag eom = uop_generator_extract_op(proc_id, op, cop);
   if (eom) {
     if (!decoupled_fe_is_off_path()) {
-      if (cached_cop_buffers[proc_id].front().scarab_marker_roi_begin == true) {
+      if (cop->scarab_marker_roi_begin == true) {
         ASSERT(proc_id, !roi_dump_began);
         // reset stats
         printf("Reached roi dump begin marker, reset stats\n");
         reset_stats(TRUE);
         roi_dump_began = TRUE;
-      } else if (cached_cop_buffers[proc_id].front().scarab_marker_roi_end == true) {
+      } else if (cop->scarab_marker_roi_end == true) {
         ASSERT(proc_id, roi_dump_began);
         // dump stats
         printf("Reached roi dump end marker, dump stats between\n");
@@ -150,7 +204,7 @@ void pin_exec_driven_fetch_op(uns proc_id, Op* op) {
         roi_dump_ID++;
       }
     }
-    cached_cop_buffers[proc_id].pop_front();
+    op_buffer_pop(proc_id);
   }
 
   DEBUG(proc_id, "Fetch Op end: %llx (%llu)\n", op->inst_info->addr, op->inst_uid);
@@ -166,7 +220,7 @@ void pin_exec_driven_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr) {
   msg.inst_uid = inst_uid;
   uop_generator_recover(proc_id);
 
-  server->send(proc_id, (Message<Scarab_To_Pin_Msg>)msg);  // blocking
+  send_cmd_to_pin(proc_id, msg);
   invalidate_op_buffer(proc_id);
   DEBUG(proc_id, "Fetch Redirect end: %llx\n", fetch_addr);
 }
@@ -181,7 +235,7 @@ void pin_exec_driven_recover(uns proc_id, uns64 inst_uid) {
   msg.inst_uid = inst_uid;
   uop_generator_recover(proc_id);
 
-  server->send(proc_id, (Message<Scarab_To_Pin_Msg>)msg);  // blocking
+  send_cmd_to_pin(proc_id, msg);
   invalidate_op_buffer(proc_id);
   DEBUG(proc_id, "Fetch Recover end: %llu\n", inst_uid);
 }
@@ -193,6 +247,6 @@ void pin_exec_driven_retire(uns proc_id, uns64 inst_uid) {
   msg.inst_addr = inst_uid == (uns64)-1;
   msg.inst_uid = inst_uid;
 
-  server->send(proc_id, (Message<Scarab_To_Pin_Msg>)msg);  // blocking
+  send_cmd_to_pin(proc_id, msg);
   DEBUG(proc_id, "Fetch Retire end: %llu\n", inst_uid);
 }
@@ -27,6 +27,8 @@
  ***************************************************************************************/
 #include "frontend/pin_trace_fe.h"
 
+#include <string.h>
+
 #include "globals/assert.h"
 #include "globals/global_defs.h"
 #include "globals/global_types.h"
@@ -37,13 +39,16 @@
 #include "debug/debug_macros.h"
 
 #include "bp/bp.param.h"
+#include "core.param.h"
 
 #include "./pin/pin_lib/uop_generator.h"
 #include "bp/bp.h"
+#include "frontend/frontend.h"
 #include "frontend/pin_trace_read.h"
 #include "isa/isa.h"
 
 #include "ctype_pin_inst.h"
+#include "host_placement.h"
 #include "statistics.h"
 
 /**************************************************************************************/
@@ -54,10 +59,26 @@
 /**************************************************************************************/
 /* Global Variables */
 
-static char* trace_files[MAX_NUM_PROCS];
+static char** trace_files;
 
 ctype_pin_inst* next_pi;
 
+/* Trace scheduler: the programs are the per-core traces followed by the
+   TRACE_SCHED_PROGRAMS ones, and each keeps its trace stream open for the whole run
+   (pin_trace_read streams are indexed by program). The programs that are not on a
+   core wait in a round-robin queue with the instruction they will fetch next. */
+typedef struct Trace_Program_struct {
+  char* file;
+  ctype_pin_inst next_pi; /* next instruction while the program is switched out */
+} Trace_Program;
+
+static Trace_Program* programs;
+static uns num_programs;
+static uns core_program[MAX_NUM_PROCS]; /* program running on each core */
+static uns* waiting;                    /* [num_programs - NUM_CORES] programs not on a core, oldest first */
+
+static void trace_sched_init(void);
+
 /**************************************************************************************/
 /* trace_init() */
 
@@ -70,36 +91,84 @@ void trace_init() {
 
   next_pi = (ctype_pin_inst*)malloc(NUM_CORES * sizeof(ctype_pin_inst));
 
-  pin_trace_file_pointer_init(NUM_CORES);
-
-  /* temp variable needed for easy initialization syntax */
-  char* tmp_trace_files[MAX_NUM_PROCS] = {
-      CBP_TRACE_R0,  CBP_TRACE_R1,  CBP_TRACE_R2,  CBP_TRACE_R3,  CBP_TRACE_R4,  CBP_TRACE_R5,  CBP_TRACE_R6,
-      CBP_TRACE_R7,  CBP_TRACE_R8,  CBP_TRACE_R9,  CBP_TRACE_R10, CBP_TRACE_R11, CBP_TRACE_R12, CBP_TRACE_R13,
-      CBP_TRACE_R14, CBP_TRACE_R15, CBP_TRACE_R16, CBP_TRACE_R17, CBP_TRACE_R18, CBP_TRACE_R19, CBP_TRACE_R20,
-      CBP_TRACE_R21, CBP_TRACE_R22, CBP_TRACE_R23, CBP_TRACE_R24, CBP_TRACE_R25, CBP_TRACE_R26, CBP_TRACE_R27,
-      CBP_TRACE_R28, CBP_TRACE_R29, CBP_TRACE_R30, CBP_TRACE_R31, CBP_TRACE_R32, CBP_TRACE_R33, CBP_TRACE_R34,
-      CBP_TRACE_R35, CBP_TRACE_R36, CBP_TRACE_R37, CBP_TRACE_R38, CBP_TRACE_R39, CBP_TRACE_R40, CBP_TRACE_R41,
-      CBP_TRACE_R42, CBP_TRACE_R43, CBP_TRACE_R44, CBP_TRACE_R45, CBP_TRACE_R46, CBP_TRACE_R47, CBP_TRACE_R48,
-      CBP_TRACE_R49, CBP_TRACE_R50, CBP_TRACE_R51, CBP_TRACE_R52, CBP_TRACE_R53, CBP_TRACE_R54, CBP_TRACE_R55,
-      CBP_TRACE_R56, CBP_TRACE_R57, CBP_TRACE_R58, CBP_TRACE_R59, CBP_TRACE_R60, CBP_TRACE_R61, CBP_TRACE_R62,
-      CBP_TRACE_R63,
-  };
-  if (DUMB_CORE_ON) {
-    // avoid errors by specifying a trace known to be good
-    tmp_trace_files[DUMB_CORE] = tmp_trace_files[0];
-  }
-  for (uns proc_id = 0; proc_id < MAX_NUM_PROCS; proc_id++) {
-    trace_files[proc_id] = tmp_trace_files[proc_id];
-  }
+  pin_trace_set_decomp_threads(PIN_TRACE_DECOMP_THREADS);
+
+  trace_files = frontend_trace_files();
+  trace_sched_init();
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     trace_setup(proc_id);
   }
 }
 
+static void trace_sched_init(void) {
+  uns max_programs = NUM_CORES + 1;
+  for (char const* c = TRACE_SCHED_PROGRAMS; c && *c; c++)
+    max_programs += *c == ',';
+  programs = (Trace_Program*)calloc(max_programs, sizeof(Trace_Program));
+  num_programs = NUM_CORES;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    programs[proc_id].file = trace_files[proc_id];
+    core_program[proc_id] = proc_id;
+  }
+  if (TRACE_SCHED_PROGRAMS) {
+    char* list = strdup(TRACE_SCHED_PROGRAMS);
+    for (char* file = strtok(list, ","); file; file = strtok(NULL, ","))
+      programs[num_programs++].file = file;
+  }
+  ASSERTM(0, num_programs <= 256, "At most 256 traces can be scheduled\n");
+
+  pin_trace_file_pointer_init(num_programs);
+  waiting = (uns*)malloc(sizeof(uns) * MAX2(num_programs - NUM_CORES, 1));
+  for (uns prog = NUM_CORES; prog < num_programs; prog++) {
+    waiting[prog - NUM_CORES] = prog;
+    host_placement_helpers_begin(prog % NUM_CORES);
+    pin_trace_open(prog, programs[prog].file);
+    host_placement_helpers_end();
+    pin_trace_read(prog, &programs[prog].next_pi);
+  }
+}
+
 void trace_setup(uns proc_id) {
-  pin_trace_open(proc_id, trace_files[proc_id]);
-  pin_trace_read(proc_id, &next_pi[proc_id]);
+  uns prog = core_program[proc_id];
+  host_placement_helpers_begin(proc_id);
+  pin_trace_open(prog, programs[prog].file);
+  host_placement_helpers_end();
+  pin_trace_read(prog, &next_pi[proc_id]);
+}
+
+/* trace_restart: starts the program of proc_id over. The open stream is rewound when
+   the trace can seek, so the trace is not reopened and its format not detected again */
+void trace_restart(uns proc_id) {
+  uns prog = core_program[proc_id];
+  host_placement_helpers_begin(proc_id);
+  if (!pin_trace_rewind(prog))
+    pin_trace_open(prog, programs[prog].file);
+  host_placement_helpers_end();
+  pin_trace_read(prog, &next_pi[proc_id]);
+}
+
+/* trace_sched_waiting: number of programs waiting for a core */
+uns trace_sched_waiting(void) {
+  return num_programs - NUM_CORES;
+}
+
+/* trace_switch_program: puts the program of proc_id at the back of the waiting queue
+   and runs the longest-waiting one on proc_id instead. The core must be drained
+   (cmp_is_core_drained), so no instruction of the old program is in flight. */
+void trace_switch_program(uns proc_id) {
+  uns num_waiting = trace_sched_waiting();
+  ASSERT(proc_id, num_waiting > 0);
+  ASSERT(proc_id, uop_generator_get_eom(proc_id) && !trace_read_done[proc_id]);
+
+  uns out = core_program[proc_id];
+  uns in = waiting[0];
+  memmove(waiting, waiting + 1, sizeof(uns) * (num_waiting - 1));
+  waiting[num_waiting - 1] = out;
+
+  programs[out].next_pi = next_pi[proc_id];
+  next_pi[proc_id] = programs[in].next_pi;
+  core_program[proc_id] = in;
+  DEBUG(proc_id, "Switching from program %u (%s) to %u (%s)\n", out, programs[out].file, in, programs[in].file);
 }
 
 /**************************************************************************************/
@@ -114,13 +183,13 @@ Addr trace_next_fetch_addr(uns proc_id) {
 
 void trace_done() {
   uns proc_id;
-  for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+  for (proc_id = 0; proc_id < num_programs; proc_id++) {
     pin_trace_close(proc_id);
   }
 }
 
 void trace_close_trace_file(uns proc_id) {
-  pin_trace_close(proc_id);
+  pin_trace_close(core_program[proc_id]);
 }
 
 Flag trace_can_fetch_op(uns proc_id) {
@@ -136,7 +205,7 @@ void trace_fetch_op(uns proc_id, Op* op) {
   }
 
   if (uop_generator_get_eom(proc_id)) {
-    int success = pin_trace_read(proc_id, &next_pi[proc_id]);
+    int success = pin_trace_read(core_program[proc_id], &next_pi[proc_id]);
     if (!success) {
       trace_read_done[proc_id] = TRUE;
       reached_exit[proc_id] = TRUE;
@@ -148,6 +217,41 @@ void trace_fetch_op(uns proc_id, Op* op) {
   }
 }
 
+/* trace_fetch_warmup_batch: the warmup fast path reads the instructions straight from the
+   trace, without the uop generator. It only runs between instructions, so the uop
+   generator finds next_pi where it expects it afterwards. */
+uns trace_fetch_warmup_batch(uns proc_id, Warmup_Inst* insts, uns max) {
+  ASSERT(proc_id, uop_generator_get_bom(proc_id));
+  uns num = 0;
+  while (num < max && !trace_read_done[proc_id]) {
+    ctype_pin_inst* pi = &next_pi[proc_id];
+    Warmup_Inst* inst = &insts[num++];
+    inst->inst_uid = pi->inst_uid;
+    inst->pc = convert_to_cmp_addr(proc_id, pi->instruction_addr);
+    inst->cf_type = pi->is_string ? NOT_CF : pi->cf_type;
+    inst->taken = pi->cf_type == CF_CBR ? pi->actually_taken : inst->cf_type != NOT_CF;
+    inst->target = convert_to_cmp_addr(proc_id, pi->branch_target);
+    inst->num_ld = MIN2(pi->num_ld, WARMUP_INST_MAX_LD);
+    for (uns ii = 0; ii < inst->num_ld; ii++)
+      inst->ld_addr[ii] = convert_to_cmp_addr(proc_id, pi->ld_vaddr[ii]);
+    inst->num_st = MIN2(pi->num_st, WARMUP_INST_MAX_ST);
+    for (uns ii = 0; ii < inst->num_st; ii++)
+      inst->st_addr[ii] = convert_to_cmp_addr(proc_id, pi->st_vaddr[ii]);
+    inst->exit = FALSE;
+
+    uns8 size = pi->size;
+    if (pin_trace_read(core_program[proc_id], pi)) {
+      inst->npc = convert_to_cmp_addr(proc_id, pi->instruction_addr);
+    } else {
+      inst->npc = inst->pc + size;
+      trace_read_done[proc_id] = TRUE;
+      reached_exit[proc_id] = TRUE;
+      inst->exit = TRUE;
+    }
+  }
+  return num;
+}
+
 void trace_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr) {
   FATAL_ERROR(proc_id,
               "Trace frontend does not support wrong path. Turn off "
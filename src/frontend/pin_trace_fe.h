@@ -51,9 +51,17 @@ void trace_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr);
 void trace_recover(uns proc_id, uns64 inst_uid);
 void trace_retire(uns proc_id, uns64 inst_uid);
 
+struct Warmup_Inst_struct;
+uns trace_fetch_warmup_batch(uns proc_id, struct Warmup_Inst_struct* insts, uns max);
+
 /* For restarting of traces */
 void trace_done(void);
 void trace_close_trace_file(uns proc_id);
 void trace_setup(uns proc_id);
+void trace_restart(uns proc_id);
+
+/* Trace scheduler (TRACE_SCHED_PROGRAMS) */
+uns trace_sched_waiting(void);
+void trace_switch_program(uns proc_id);
 
 #endif
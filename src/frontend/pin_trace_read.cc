@@ -33,43 +33,80 @@
 #include <iostream>
 #include <string>
 
+#include "frontend/pin_trace_stream.h"
 #include "isa/isa.h"
+#include "pin/pin_lib/pin_trace_compact.h"
 
 extern "C" {
 #include "globals/assert.h"
 #include "globals/utils.h"
 }
 
-#define CMP_ADDR_MASK (((uint64_t) - 1) << 58)
+static Pin_Trace_Stream** pin_streams;
+static Pin_Trace_Compact_Reader** pin_compact; // NULL for a trace of raw ctype_pin_insts
+static unsigned pin_trace_decomp_threads = 1;
 
-FILE** pin_file;
+static void pin_trace_detect_format(unsigned char proc_id, const char* name);
 
 // static Reg_Id convert_pin_reg_to_scarab_reg(uns pin_reg);
-void pin_trace_file_pointer_init(unsigned char num_cores) {
-  pin_file = (FILE**)malloc(num_cores * sizeof(FILE*));
+// one stream per trace, indexed by core or, with the trace scheduler, by program
+void pin_trace_file_pointer_init(unsigned num_streams) {
+  pin_streams = (Pin_Trace_Stream**)calloc(num_streams, sizeof(Pin_Trace_Stream*));
+  pin_compact = (Pin_Trace_Compact_Reader**)calloc(num_streams, sizeof(Pin_Trace_Compact_Reader*));
+}
+
+void pin_trace_set_decomp_threads(unsigned num_threads) {
+  pin_trace_decomp_threads = num_threads;
 }
 
 void pin_trace_open(unsigned char proc_id, const char* name) {
-  char cmdline[1024];
-  sprintf(cmdline, "bzip2 -dc %s", name);
-  pin_file[proc_id] = popen(cmdline, "r");
+  pin_streams[proc_id] = new Pin_Trace_Stream(name, pin_trace_decomp_threads);
   printf("pin trace should be opened now for core %u: %s \n", proc_id, name);
-  if (!pin_file[proc_id]) {
+  if (!pin_streams[proc_id]->ok()) {
     printf("Cannot open trace file: %s\n", name);
     exit(1);
   }
+  pin_trace_detect_format(proc_id, name);
 }
 
-void pin_trace_close(unsigned char proc_id) {
-  pclose(pin_file[proc_id]);
+/* pin_trace_detect_format: a compact trace (gen_trace -compact) starts with a header
+   that is consumed here; a raw trace is read as it is */
+static void pin_trace_detect_format(unsigned char proc_id, const char* name) {
+  char header[PIN_TRACE_COMPACT_HEADER_LEN];
+  bool layout_ok;
+  if (!pin_streams[proc_id]->peek(header, sizeof(header)) ||
+      !Pin_Trace_Compact_Reader::is_compact(header, &layout_ok))
+    return;
+  if (!layout_ok) {
+    printf("Compact trace %s was written for another version of ctype_pin_inst\n", name);
+    exit(1);
+  }
+  pin_streams[proc_id]->read(header, sizeof(header));
+  if (!pin_compact[proc_id])
+    pin_compact[proc_id] = new Pin_Trace_Compact_Reader();
+  pin_compact[proc_id]->reset();
 }
 
-int pin_trace_read(unsigned char proc_id, ctype_pin_inst* pi) {
-  int read_size;
+void pin_trace_close(unsigned char proc_id) {
+  delete pin_streams[proc_id];
+  pin_streams[proc_id] = NULL;
+  delete pin_compact[proc_id];
+  pin_compact[proc_id] = NULL;
+}
 
-  read_size = fread(pi, sizeof(ctype_pin_inst), 1, pin_file[proc_id]);
-  if (read_size != 1) {
-    return 0;
+// Restarts the trace at its first instruction on the open stream; returns 0 (the stream
+// is closed) if it cannot seek
+int pin_trace_rewind(unsigned char proc_id) {
+  if (pin_streams[proc_id]->rewind()) {
+    pin_trace_detect_format(proc_id, "");
+    return 1;
   }
-  return 1;
+  pin_trace_close(proc_id);
+  return 0;
+}
+
+int pin_trace_read(unsigned char proc_id, ctype_pin_inst* pi) {
+  if (pin_compact[proc_id])
+    return pin_compact[proc_id]->read(*pin_streams[proc_id], pi);
+  return pin_streams[proc_id]->read(pi, sizeof(ctype_pin_inst));
 }
@@ -35,10 +35,12 @@
 extern "C" {
 #endif
 
-void pin_trace_file_pointer_init(unsigned char);
+void pin_trace_file_pointer_init(unsigned);
+void pin_trace_set_decomp_threads(unsigned);
 int pin_trace_read(unsigned char, ctype_pin_inst*);
 void pin_trace_open(unsigned char, const char*);
 void pin_trace_close(unsigned char);
+int pin_trace_rewind(unsigned char);
 
 #ifdef __cplusplus
 }
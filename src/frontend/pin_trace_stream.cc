@@ -0,0 +1,637 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/pin_trace_stream.cc
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : In-process reader for compressed PIN traces (bzip2, zstd, lz4) and
+ *                gzipped PT traces.
+ ***************************************************************************************/
+
+#include "frontend/pin_trace_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef SCARAB_HAVE_BZIP2
+#include <bzlib.h>
+#endif
+#ifdef SCARAB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef SCARAB_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+#ifdef SCARAB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Granularity of file reads and of the decompressed blocks handed to the consumer
+#define PIN_TRACE_CHUNK_SIZE (4 << 20)
+// A zstd frame that does not fit in this much input is decoded as a stream
+#define PIN_TRACE_ZSTD_MAX_WINDOW (256 << 20)
+
+#if defined(SCARAB_HAVE_BZIP2) || defined(SCARAB_HAVE_ZSTD) || defined(SCARAB_HAVE_LZ4) || defined(SCARAB_HAVE_ZLIB)
+static void pin_trace_stream_fatal(const std::string& name, const char* msg) {
+  fprintf(stderr, "Error reading trace %s: %s\n", name.c_str(), msg);
+  exit(1);
+}
+#endif
+
+/**************************************************************************************/
+/* Uncompressed file, or the output of an external decompressor */
+
+class Raw_Decoder : public Pin_Trace_Decoder {
+ public:
+  Raw_Decoder(FILE* _fp, bool _is_pipe) : fp(_fp), is_pipe(_is_pipe) {}
+  ~Raw_Decoder() override {
+    if (is_pipe)
+      pclose(fp);
+    else
+      fclose(fp);
+  }
+
+  bool decode(std::vector<std::vector<char>>& out) override {
+    std::vector<char> block(PIN_TRACE_CHUNK_SIZE);
+    size_t n = fread(block.data(), 1, block.size(), fp);
+    if (!n)
+      return false;
+    block.resize(n);
+    out.push_back(std::move(block));
+    return true;
+  }
+
+  bool rewind() override { return !is_pipe && !fseek(fp, 0, SEEK_SET); }
+
+ private:
+  FILE* fp;
+  bool is_pipe;
+};
+
+#if !defined(SCARAB_HAVE_BZIP2) || !defined(SCARAB_HAVE_ZSTD) || !defined(SCARAB_HAVE_LZ4) || !defined(SCARAB_HAVE_ZLIB)
+static Pin_Trace_Decoder* pin_trace_popen_decoder(FILE* fp, const char* tool, const char* name) {
+  fclose(fp);
+  std::string cmdline = std::string(tool) + " -dc " + name;
+  FILE* pipe = popen(cmdline.c_str(), "r");
+  return pipe ? new Raw_Decoder(pipe, true) : nullptr;
+}
+#endif
+
+/**************************************************************************************/
+/* bzip2 */
+
+#ifdef SCARAB_HAVE_BZIP2
+class Bzip2_Decoder : public Pin_Trace_Decoder {
+ public:
+  Bzip2_Decoder(FILE* _fp, const char* _name) : fp(_fp), name(_name), in(PIN_TRACE_CHUNK_SIZE), in_eof(false) {
+    memset(&strm, 0, sizeof(strm));
+    if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK)
+      pin_trace_stream_fatal(name, "cannot initialize bzip2");
+  }
+  ~Bzip2_Decoder() override {
+    BZ2_bzDecompressEnd(&strm);
+    fclose(fp);
+  }
+
+  bool decode(std::vector<std::vector<char>>& out) override {
+    std::vector<char> block(PIN_TRACE_CHUNK_SIZE);
+    strm.next_out = block.data();
+    strm.avail_out = block.size();
+    while (strm.avail_out) {
+      if (!strm.avail_in) {
+        if (in_eof)
+          break;
+        size_t n = fread(in.data(), 1, in.size(), fp);
+        in_eof = n < in.size();
+        strm.next_in = in.data();
+        strm.avail_in = n;
+        if (!n)
+          break;
+      }
+      int ret = BZ2_bzDecompress(&strm);
+      if (ret == BZ_STREAM_END) {
+        // parallel compressors (pbzip2, lbzip2) concatenate streams, restart at each one
+        bz_stream next = strm;
+        BZ2_bzDecompressEnd(&strm);
+        memset(&strm, 0, sizeof(strm));
+        if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK)
+          pin_trace_stream_fatal(name, "cannot initialize bzip2");
+        strm.next_in = next.next_in;
+        strm.avail_in = next.avail_in;
+        strm.next_out = next.next_out;
+        strm.avail_out = next.avail_out;
+      } else if (ret != BZ_OK) {
+        pin_trace_stream_fatal(name, "corrupt bzip2 data");
+      }
+    }
+    size_t n = block.size() - strm.avail_out;
+    if (!n)
+      return false;
+    block.resize(n);
+    out.push_back(std::move(block));
+    return true;
+  }
+
+  bool rewind() override {
+    BZ2_bzDecompressEnd(&strm);
+    memset(&strm, 0, sizeof(strm));
+    if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK)
+      pin_trace_stream_fatal(name, "cannot initialize bzip2");
+    in_eof = false;
+    return !fseek(fp, 0, SEEK_SET);
+  }
+
+ private:
+  FILE* fp;
+  std::string name;
+  bz_stream strm;
+  std::vector<char> in;
+  bool in_eof;
+};
+#endif
+
+/**************************************************************************************/
+/* lz4 frame format */
+
+#ifdef SCARAB_HAVE_LZ4
+class Lz4_Decoder : public Pin_Trace_Decoder {
+ public:
+  Lz4_Decoder(FILE* _fp, const char* _name)
+      : fp(_fp), name(_name), in(PIN_TRACE_CHUNK_SIZE), in_pos(0), in_end(0), in_eof(false) {
+    if (LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION)))
+      pin_trace_stream_fatal(name, "cannot initialize lz4");
+  }
+  ~Lz4_Decoder() override {
+    LZ4F_freeDecompressionContext(dctx);
+    fclose(fp);
+  }
+
+  bool decode(std::vector<std::vector<char>>& out) override {
+    std::vector<char> block(PIN_TRACE_CHUNK_SIZE);
+    size_t out_pos = 0;
+    while (out_pos < block.size()) {
+      if (in_pos == in_end) {
+        if (in_eof)
+          break;
+        in_end = fread(in.data(), 1, in.size(), fp);
+        in_eof = in_end < in.size();
+        in_pos = 0;
+        if (!in_end)
+          break;
+      }
+      size_t src_size = in_end - in_pos;
+      size_t dst_size = block.size() - out_pos;
+      size_t ret = LZ4F_decompress(dctx, block.data() + out_pos, &dst_size, in.data() + in_pos, &src_size, nullptr);
+      if (LZ4F_isError(ret))
+        pin_trace_stream_fatal(name, LZ4F_getErrorName(ret));
+      in_pos += src_size;
+      out_pos += dst_size;
+    }
+    if (!out_pos)
+      return false;
+    block.resize(out_pos);
+    out.push_back(std::move(block));
+    return true;
+  }
+
+  bool rewind() override {
+    LZ4F_resetDecompressionContext(dctx);
+    in_pos = in_end = 0;
+    in_eof = false;
+    return !fseek(fp, 0, SEEK_SET);
+  }
+
+ private:
+  FILE* fp;
+  std::string name;
+  LZ4F_dctx* dctx;
+  std::vector<char> in;
+  size_t in_pos;
+  size_t in_end;
+  bool in_eof;
+};
+#endif
+
+/**************************************************************************************/
+/* gzip, including files of several concatenated members */
+
+#ifdef SCARAB_HAVE_ZLIB
+class Gzip_Decoder : public Pin_Trace_Decoder {
+ public:
+  Gzip_Decoder(FILE* _fp, const char* _name) : fp(_fp), name(_name), in(PIN_TRACE_CHUNK_SIZE), in_eof(false) {
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK)
+      pin_trace_stream_fatal(name, "cannot initialize zlib");
+  }
+  ~Gzip_Decoder() override {
+    inflateEnd(&strm);
+    fclose(fp);
+  }
+
+  bool decode(std::vector<std::vector<char>>& out) override {
+    std::vector<char> block(PIN_TRACE_CHUNK_SIZE);
+    strm.next_out = reinterpret_cast<Bytef*>(block.data());
+    strm.avail_out = block.size();
+    while (strm.avail_out) {
+      if (!strm.avail_in) {
+        if (in_eof)
+          break;
+        size_t n = fread(in.data(), 1, in.size(), fp);
+        in_eof = n < in.size();
+        strm.next_in = reinterpret_cast<Bytef*>(in.data());
+        strm.avail_in = n;
+        if (!n)
+          break;
+      }
+      int ret = inflate(&strm, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END) {
+        // pigz and cat'd traces have several members, restart at each one
+        if (inflateReset(&strm) != Z_OK)
+          pin_trace_stream_fatal(name, "cannot reset zlib");
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        pin_trace_stream_fatal(name, "corrupt gzip data");
+      }
+    }
+    size_t n = block.size() - strm.avail_out;
+    if (!n)
+      return false;
+    block.resize(n);
+    out.push_back(std::move(block));
+    return true;
+  }
+
+  bool rewind() override {
+    if (inflateReset(&strm) != Z_OK)
+      pin_trace_stream_fatal(name, "cannot reset zlib");
+    strm.avail_in = 0;
+    in_eof = false;
+    return !fseek(fp, 0, SEEK_SET);
+  }
+
+ private:
+  FILE* fp;
+  std::string name;
+  z_stream strm;
+  std::vector<char> in;
+  bool in_eof;
+};
+#endif
+
+/**************************************************************************************/
+/* zstd: complete frames in the input window are decoded in parallel, one per
+   context. Traces written as a single frame fall back to streaming. */
+
+#ifdef SCARAB_HAVE_ZSTD
+class Zstd_Decoder : public Pin_Trace_Decoder {
+ public:
+  Zstd_Decoder(FILE* _fp, const char* _name, unsigned num_threads)
+      : fp(_fp), name(_name), in(PIN_TRACE_CHUNK_SIZE), in_pos(0), in_end(0), in_eof(false), streaming(false) {
+    for (unsigned i = 0; i < std::max(num_threads, 1u); i++) {
+      dctxs.push_back(ZSTD_createDCtx());
+      if (!dctxs.back())
+        pin_trace_stream_fatal(name, "cannot initialize zstd");
+    }
+  }
+  ~Zstd_Decoder() override {
+    for (ZSTD_DCtx* dctx : dctxs)
+      ZSTD_freeDCtx(dctx);
+    fclose(fp);
+  }
+
+  bool decode(std::vector<std::vector<char>>& out) override {
+    if (streaming)
+      return decode_stream(out);
+
+    // collect up to one complete frame per context
+    std::vector<std::pair<const char*, size_t>> frames;
+    size_t pos = in_pos;
+    while (frames.size() < dctxs.size()) {
+      size_t size = ZSTD_findFrameCompressedSize(in.data() + pos, in_end - pos);
+      if (!ZSTD_isError(size)) {
+        frames.push_back(std::make_pair(in.data() + pos, size));
+        pos += size;
+        continue;
+      }
+      if (!frames.empty())
+        break;  // the window only moves once the collected frames are decoded
+      if (!refill()) {
+        if (in_pos == in_end)
+          return false;
+        if (in_eof)
+          pin_trace_stream_fatal(name, "truncated zstd frame");
+        streaming = true;
+        return decode_stream(out);
+      }
+      pos = in_pos;
+    }
+
+    size_t first = out.size();
+    out.resize(first + frames.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < frames.size(); i++)
+      workers.emplace_back(&Zstd_Decoder::decode_frame, this, dctxs[i], frames[i].first, frames[i].second,
+                           &out[first + i]);
+    decode_frame(dctxs[0], frames[0].first, frames[0].second, &out[first]);
+    for (std::thread& worker : workers)
+      worker.join();
+    in_pos = pos;
+    return true;
+  }
+
+  bool rewind() override {
+    ZSTD_DCtx_reset(dctxs[0], ZSTD_reset_session_only);
+    in_pos = in_end = 0;
+    in_eof = false;
+    streaming = false;
+    return !fseek(fp, 0, SEEK_SET);
+  }
+
+ private:
+  // Moves the unread input to the front of the window and reads more, growing the window if it is full
+  bool refill() {
+    if (in_eof)
+      return false;
+    memmove(in.data(), in.data() + in_pos, in_end - in_pos);
+    in_end -= in_pos;
+    in_pos = 0;
+    if (in_end == in.size()) {
+      if (in.size() >= PIN_TRACE_ZSTD_MAX_WINDOW)
+        return false;
+      in.resize(in.size() * 2);
+    }
+    size_t want = in.size() - in_end;
+    size_t n = fread(in.data() + in_end, 1, want, fp);
+    in_eof = n < want;
+    in_end += n;
+    return n > 0;
+  }
+
+  void decode_frame(ZSTD_DCtx* dctx, const char* src, size_t size, std::vector<char>* out) {
+    unsigned long long content = ZSTD_getFrameContentSize(src, size);
+    bool known = content != ZSTD_CONTENTSIZE_UNKNOWN && content != ZSTD_CONTENTSIZE_ERROR;
+    out->resize(known ? content : PIN_TRACE_CHUNK_SIZE);
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+    ZSTD_inBuffer input = {src, size, 0};
+    ZSTD_outBuffer output = {out->data(), out->size(), 0};
+    size_t ret = 1;
+    while (ret) {
+      if (output.pos == output.size) {
+        out->resize(std::max(out->size() * 2, (size_t)PIN_TRACE_CHUNK_SIZE));
+        output.dst = out->data();
+        output.size = out->size();
+      }
+      ret = ZSTD_decompressStream(dctx, &output, &input);
+      if (ZSTD_isError(ret))
+        pin_trace_stream_fatal(name, ZSTD_getErrorName(ret));
+      if (ret && input.pos == input.size && output.pos < output.size)
+        pin_trace_stream_fatal(name, "truncated zstd frame");
+    }
+    out->resize(output.pos);
+  }
+
+  bool decode_stream(std::vector<std::vector<char>>& out) {
+    std::vector<char> block(PIN_TRACE_CHUNK_SIZE);
+    ZSTD_outBuffer output = {block.data(), block.size(), 0};
+    while (output.pos < output.size) {
+      if (in_pos == in_end)
+        refill();
+      size_t produced = output.pos;
+      ZSTD_inBuffer input = {in.data() + in_pos, in_end - in_pos, 0};
+      size_t ret = ZSTD_decompressStream(dctxs[0], &output, &input);
+      if (ZSTD_isError(ret))
+        pin_trace_stream_fatal(name, ZSTD_getErrorName(ret));
+      in_pos += input.pos;
+      if (!input.pos && output.pos == produced)
+        break;
+    }
+    if (!output.pos)
+      return false;
+    block.resize(output.pos);
+    out.push_back(std::move(block));
+    return true;
+  }
+
+  FILE* fp;
+  std::string name;
+  std::vector<char> in;
+  size_t in_pos;
+  size_t in_end;
+  bool in_eof;
+  bool streaming;
+  std::vector<ZSTD_DCtx*> dctxs;
+};
+#endif
+
+/**************************************************************************************/
+/* Pin_Trace_Stream */
+
+FILE* (*Pin_Trace_Stream::open_func)(const char* name) = nullptr;
+std::atomic<uint64_t> Pin_Trace_Stream::stall_ns(0);
+
+Pin_Trace_Stream::Pin_Trace_Stream(const char* name, unsigned decomp_threads)
+    : format_name("raw"),
+      cur_pos(0),
+      threaded(decomp_threads > 0),
+      max_queued(2 * std::max(decomp_threads, 1u)),
+      reader_done(false),
+      stop(false) {
+  static const unsigned char bzip2_magic[] = {'B', 'Z', 'h'};
+  static const unsigned char zstd_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+  static const unsigned char lz4_magic[] = {0x04, 0x22, 0x4d, 0x18};
+  static const unsigned char gzip_magic[] = {0x1f, 0x8b};
+
+  FILE* fp = open_func ? open_func(name) : fopen(name, "rb");
+  if (!fp)
+    return;
+  unsigned char magic[4] = {0};
+  size_t n = fread(magic, 1, sizeof(magic), fp);
+  ::rewind(fp);
+
+  if (n >= sizeof(bzip2_magic) && !memcmp(magic, bzip2_magic, sizeof(bzip2_magic))) {
+    format_name = "bzip2";
+#ifdef SCARAB_HAVE_BZIP2
+    decoder.reset(new Bzip2_Decoder(fp, name));
+#else
+    decoder.reset(pin_trace_popen_decoder(fp, "bzip2", name));
+#endif
+  } else if (n == sizeof(zstd_magic) && !memcmp(magic, zstd_magic, sizeof(zstd_magic))) {
+    format_name = "zstd";
+#ifdef SCARAB_HAVE_ZSTD
+    decoder.reset(new Zstd_Decoder(fp, name, decomp_threads));
+#else
+    decoder.reset(pin_trace_popen_decoder(fp, "zstd", name));
+#endif
+  } else if (n == sizeof(lz4_magic) && !memcmp(magic, lz4_magic, sizeof(lz4_magic))) {
+    format_name = "lz4";
+#ifdef SCARAB_HAVE_LZ4
+    decoder.reset(new Lz4_Decoder(fp, name));
+#else
+    decoder.reset(pin_trace_popen_decoder(fp, "lz4", name));
+#endif
+  } else if (n >= sizeof(gzip_magic) && !memcmp(magic, gzip_magic, sizeof(gzip_magic))) {
+    format_name = "gzip";
+#ifdef SCARAB_HAVE_ZLIB
+    decoder.reset(new Gzip_Decoder(fp, name));
+#else
+    decoder.reset(pin_trace_popen_decoder(fp, "gzip", name));
+#endif
+  } else {
+    decoder.reset(new Raw_Decoder(fp, false));
+  }
+
+  if (decoder && threaded)
+    reader = std::thread(&Pin_Trace_Stream::reader_loop, this);
+}
+
+Pin_Trace_Stream::~Pin_Trace_Stream() {
+  stop_reader();
+}
+
+void Pin_Trace_Stream::stop_reader() {
+  if (reader.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stop = true;
+    }
+    cond.notify_all();
+    reader.join();
+  }
+}
+
+bool Pin_Trace_Stream::rewind() {
+  stop_reader();
+  queue.clear();
+  cur.clear();
+  cur_pos = 0;
+  reader_done = false;
+  stop = false;
+  if (!decoder->rewind()) {
+    decoder.reset();
+    return false;
+  }
+  if (threaded)
+    reader = std::thread(&Pin_Trace_Stream::reader_loop, this);
+  return true;
+}
+
+void Pin_Trace_Stream::reader_loop() {
+  std::vector<std::vector<char>> blocks;
+  bool more = true;
+  while (more) {
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      cond.wait(guard, [this] { return stop || queue.size() < max_queued; });
+      if (stop)
+        break;
+    }
+    blocks.clear();
+    more = decoder->decode(blocks);
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      for (std::vector<char>& block : blocks)
+        queue.push_back(std::move(block));
+    }
+    cond.notify_all();
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    reader_done = true;
+  }
+  cond.notify_all();
+}
+
+bool Pin_Trace_Stream::next_block() {
+  cur.clear();
+  cur_pos = 0;
+  while (cur.empty()) {
+    if (threaded) {
+      std::unique_lock<std::mutex> guard(lock);
+      if (queue.empty() && !reader_done) {
+        auto start = std::chrono::steady_clock::now();
+        cond.wait(guard, [this] { return !queue.empty() || reader_done; });
+        stall_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                        .count();
+      }
+      if (queue.empty())
+        return false;
+      cur.swap(queue.front());
+      queue.pop_front();
+      guard.unlock();
+      cond.notify_all();
+    } else if (!queue.empty()) {
+      cur.swap(queue.front());
+      queue.pop_front();
+    } else {
+      if (reader_done)
+        return false;
+      std::vector<std::vector<char>> blocks;
+      auto start = std::chrono::steady_clock::now();
+      reader_done = !decoder->decode(blocks);
+      stall_ns +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+      for (std::vector<char>& block : blocks)
+        queue.push_back(std::move(block));
+    }
+  }
+  return true;
+}
+
+size_t Pin_Trace_Stream::read_some(void* dst, size_t size) {
+  char* out = static_cast<char*>(dst);
+  size_t done = 0;
+  while (done < size) {
+    if (cur_pos == cur.size() && !next_block())
+      break;
+    size_t n = std::min(size - done, cur.size() - cur_pos);
+    memcpy(out + done, cur.data() + cur_pos, n);
+    cur_pos += n;
+    done += n;
+  }
+  return done;
+}
+
+bool Pin_Trace_Stream::peek(void* dst, size_t size) {
+  if (cur_pos == cur.size() && !next_block())
+    return false;
+  if (cur.size() - cur_pos < size)
+    return false;
+  memcpy(dst, cur.data() + cur_pos, size);
+  return true;
+}
+
+bool Pin_Trace_Stream::read(void* dst, size_t size) {
+  char* out = static_cast<char*>(dst);
+  while (size) {
+    if (cur_pos == cur.size() && !next_block())
+      return false;
+    size_t n = std::min(size, cur.size() - cur_pos);
+    memcpy(out, cur.data() + cur_pos, n);
+    cur_pos += n;
+    out += n;
+    size -= n;
+  }
+  return true;
+}
@@ -0,0 +1,117 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/pin_trace_stream.h
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : In-process reader for compressed PIN traces (bzip2, zstd, lz4).
+ *                Reads the trace file in large blocks and optionally decompresses
+ *                on background threads, decoding independent frames in parallel.
+ ***************************************************************************************/
+
+#ifndef __PIN_TRACE_STREAM_H__
+#define __PIN_TRACE_STREAM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**************************************************************************************/
+/* Pin_Trace_Decoder: produces the decompressed bytes of a trace in order */
+
+class Pin_Trace_Decoder {
+ public:
+  virtual ~Pin_Trace_Decoder() {}
+  // Appends the next decompressed block(s) to out; returns false at the end of the trace
+  virtual bool decode(std::vector<std::vector<char>>& out) = 0;
+  // Restarts decoding at the start of the trace; returns false if the input cannot seek
+  virtual bool rewind() { return false; }
+};
+
+/**************************************************************************************/
+/* Pin_Trace_Stream */
+
+class Pin_Trace_Stream {
+ public:
+  /* decomp_threads == 0 decompresses on the calling thread. Otherwise one
+     reader thread decompresses ahead of the consumer and zstd traces made of
+     several frames are decoded decomp_threads frames at a time. */
+  Pin_Trace_Stream(const char* name, unsigned decomp_threads);
+  ~Pin_Trace_Stream();
+
+  bool ok() const { return decoder != nullptr; }
+  const char* format() const { return format_name; }
+  // Copies exactly size bytes into dst; returns false once the trace is exhausted
+  bool read(void* dst, size_t size);
+  // Copies up to size bytes into dst; returns fewer only at the end of the trace
+  size_t read_some(void* dst, size_t size);
+  // Copies the next byte into dst; returns false once the trace is exhausted
+  bool get(uint8_t* dst) {
+    if (cur_pos == cur.size() && !next_block())
+      return false;
+    *dst = (uint8_t)cur[cur_pos++];
+    return true;
+  }
+  // Copies the next size bytes into dst without consuming them; returns false if the
+  // trace has fewer (or they are not in one decompressed block)
+  bool peek(void* dst, size_t size);
+  // Restarts the stream at the start of the trace without reopening it; returns false
+  // (leaving the stream unusable) if the trace cannot seek, such as a decompressor pipe
+  bool rewind();
+
+  // Opens the trace files of the streams created after the call (default: fopen)
+  static void set_open_func(FILE* (*func)(const char* name)) { open_func = func; }
+  // Nanoseconds the consumers of all streams waited for trace data since the last call
+  static uint64_t take_stall_ns() { return stall_ns.exchange(0); }
+
+ private:
+  bool next_block();
+  void reader_loop();
+  void stop_reader();
+
+  std::unique_ptr<Pin_Trace_Decoder> decoder;
+  const char* format_name;
+  std::vector<char> cur;
+  size_t cur_pos;
+
+  // background decompression
+  bool threaded;
+  size_t max_queued;
+  std::thread reader;
+  std::mutex lock;
+  std::condition_variable cond;
+  std::deque<std::vector<char>> queue;
+  bool reader_done;
+  bool stop;
+
+  static FILE* (*open_func)(const char* name);
+  static std::atomic<uint64_t> stall_ns;
+};
+
+#endif
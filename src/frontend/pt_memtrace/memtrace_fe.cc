@@ -35,12 +35,16 @@ extern "C" {
 
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
+
+#include "host_placement.h"
 }
 
 #include "bp/bp.param.h"
 
 #include "bp/bp.h"
+#include "frontend/frontend.h"
 #include "frontend/pt_memtrace/memtrace_fe.h"
+#include "frontend/trace_io.h"
 #include "isa/isa.h"
 #include "pin/pin_lib/gather_scatter_addresses.h"
 #include "pin/pin_lib/uop_generator.h"
@@ -51,15 +55,25 @@ extern "C" {
 
 #define DR_DO_NOT_DEFINE_int64
 
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "frontend/pt_memtrace/memtrace_trace_reader_memtrace.h"
 
 /**************************************************************************************/
 /* Global Variables */
 
-static char* trace_files[MAX_NUM_PROCS];
+static char** trace_files;
 TraceReader* trace_readers[MAX_NUM_PROCS];
 // TODO: Make per proc?
 uint64_t ins_id = 0;
@@ -72,9 +86,119 @@ extern scatter_info_map scatter_info_storage;
 Flag roi_dump_began = FALSE;
 Counter roi_dump_ID = 0;
 
+/* Prefetching reader (MEMTRACE_PREFETCH_DEPTH): a producer thread per core
+   decodes instructions ahead of the simulator into a single-producer
+   single-consumer ring. Decoding touches the shared globals above and the XED
+   helpers, so producers of different cores take turns under decode_lock. */
+typedef enum Memtrace_Rec_Type_enum {
+  MEMTRACE_REC_INST,
+  MEMTRACE_REC_ROI_END,
+  MEMTRACE_REC_TRACE_END,
+} Memtrace_Rec_Type;
+
+typedef struct Memtrace_Rec_struct {
+  ctype_pin_inst inst;
+  Memtrace_Rec_Type type;
+} Memtrace_Rec;
+
+typedef struct Memtrace_Ring_struct {
+  std::vector<Memtrace_Rec> recs;
+  alignas(64) std::atomic<uint64_t> head;  // next slot written by the producer
+  alignas(64) std::atomic<uint64_t> tail;  // next slot read by the consumer
+  Flag drained;                            // consumer has seen the last record
+  std::thread producer;
+} Memtrace_Ring;
+
+static Memtrace_Ring* prefetch_rings = nullptr;
+static std::atomic<bool> prefetch_stop(false);
+static std::mutex decode_lock;
+
+/* Thread demultiplexer (MEMTRACE_THREAD_MAP): the trace of core 0 is read once and every
+   record of a mapped thread is decoded into the queue of its core. The records of the other
+   threads are dropped before they are decoded. A core that reads ahead of the others makes
+   their queues grow, so the queues are bounded only by how far apart the cores run. */
+typedef struct Memtrace_Demux_struct {
+  std::unordered_map<uint64_t, int> tid_core;  // core of each thread seen, -1 if dropped
+  Flag auto_map;                               // cores take the threads in order of appearance
+  uns auto_cores;                              // cores given a thread so far with auto_map
+  std::vector<std::deque<Memtrace_Rec>> queues;
+  Flag eof;
+  uint64_t dropped;
+  std::mutex lock;
+} Memtrace_Demux;
+
+static Memtrace_Demux* demux = nullptr;
+
+/* Fast forward index (MEMTRACE_FF_INDEX_INTERVAL): a sidecar <trace>.ffidx that
+   maps instruction counts to trace ordinals. An entry is only taken at a fetched
+   instruction followed by another fetched one, so resuming at the next ordinal
+   never lands inside a REP sequence. */
+#define MEMTRACE_FF_INDEX_MAGIC "SCARFFX"
+#define MEMTRACE_FF_INDEX_VERSION 1
+
+typedef struct Memtrace_Ff_Header_struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_entries;
+  uint64_t trace_size;  // of the trace the index belongs to
+  uint64_t trace_mtime;
+} Memtrace_Ff_Header;
+
+typedef struct Memtrace_Ff_Entry_struct {
+  uint64_t ins_id;  // ins_id and ins_id_fetched after the instruction
+  uint64_t ins_id_fetched;
+  uint64_t ordinal;  // trace ordinal of the instruction
+} Memtrace_Ff_Entry;
+
+/* Static part of the converted instruction (registers, op and cf type, SIMD info), built once per PC and
+   encoding from the XED decode and copied into every dynamic instance. Only touched under decode_lock when
+   prefetching. */
+typedef struct Memtrace_Static_Inst_struct {
+  uint64_t inst_binary_lsb;  // encoding the entry was built from
+  uint64_t inst_binary_msb;
+  ctype_pin_inst inst;
+} Memtrace_Static_Inst;
+
+static std::unordered_map<uint64_t, Memtrace_Static_Inst> static_inst_map;
+
 /**************************************************************************************/
 /* Private Functions */
 
+static const ctype_pin_inst* memtrace_static_inst(const InstInfo* insi) {
+  uint64_t lsb = 0;
+  uint64_t msb = 0;
+  uint32_t size = XED_INS_Size(insi->ins);
+  for (uint32_t ii = 0; ii < 8 && ii < size; ii++) {
+    lsb = (lsb << 8) + XED_INS_Byte(insi->ins, ii);
+  }
+  for (uint32_t ii = 0; ii < 16 && ii < size; ii++) {
+    msb = (msb << 8) + XED_INS_Byte(insi->ins, ii);
+  }
+
+  auto it = static_inst_map.find(insi->pc);
+  if (it != static_inst_map.end() && it->second.inst_binary_lsb == lsb && it->second.inst_binary_msb == msb)
+    return &it->second.inst;
+
+  Memtrace_Static_Inst* entry = &static_inst_map[insi->pc];
+  entry->inst_binary_lsb = lsb;
+  entry->inst_binary_msb = msb;
+  ctype_pin_inst* info = &entry->inst;
+  memset(info, 0, sizeof(ctype_pin_inst));
+  // direct branch targets and the gather/scatter storage are keyed off the PC
+  info->instruction_addr = insi->pc;
+  fill_in_basic_info(info, insi->ins);
+  if (XED_INS_IsVgather(insi->ins) || XED_INS_IsVscatter(insi->ins)) {
+    xed_category_enum_t category = XED_INS_Category(insi->ins);
+    scatter_info_storage[insi->pc] = add_to_gather_scatter_info_storage(insi->pc, XED_INS_IsVgather(insi->ins),
+                                                                        XED_INS_IsVscatter(insi->ins), category);
+  }
+  uint32_t max_op_width = add_dependency_info(info, insi->ins);
+  fill_in_simd_info(info, insi->ins, max_op_width);
+  apply_x87_bug_workaround(info, insi->ins);
+  fill_in_cf_info(info, insi->ins);
+  return info;
+}
+
 void fill_in_dynamic_info(ctype_pin_inst* info, const InstInfo* insi) {
   uint8_t ld = 0;
   uint8_t st = 0;
@@ -171,7 +295,29 @@ int roi(const xed_decoded_inst_t* ins) {
   return 0;
 }
 
-int memtrace_trace_read(int proc_id, ctype_pin_inst* next_onpath_pi) {
+static Memtrace_Rec_Type memtrace_convert_inst(const InstInfo* insi, ctype_pin_inst* next_onpath_pi) {
+  if (insi->is_dr_ins) {
+    memcpy(next_onpath_pi, insi->info, sizeof(ctype_pin_inst));
+    // dr_ins ctype_pin_inst are already populated in memtrace_reader_memtrace
+    fill_in_dynamic_info(next_onpath_pi, insi);
+  } else {
+    const ctype_pin_inst* static_inst = memtrace_static_inst(insi);
+    memcpy(next_onpath_pi, static_inst, sizeof(ctype_pin_inst));
+    fill_in_dynamic_info(next_onpath_pi, insi);
+    // fill_in_cf_info overrides the trace target of direct branches with the decoded one
+    if (static_inst->cf_type == CF_BR || static_inst->cf_type == CF_CBR || static_inst->cf_type == CF_CALL)
+      next_onpath_pi->branch_target = static_inst->branch_target;
+    print_err_if_invalid(next_onpath_pi, insi->ins);
+  }
+
+  // End of ROI
+  if (!insi->is_dr_ins && roi(insi->ins))
+    return MEMTRACE_REC_ROI_END;
+
+  return MEMTRACE_REC_INST;
+}
+
+static Memtrace_Rec_Type memtrace_decode_inst(int proc_id, ctype_pin_inst* next_onpath_pi) {
   InstInfo* insi;
 
   do {
@@ -192,30 +338,15 @@ int memtrace_trace_read(int proc_id, ctype_pin_inst* next_onpath_pi) {
       }
     } else {
       std::cout << "Reached end of trace" << std::endl;
-      return 0;  // end of trace
+      return MEMTRACE_REC_TRACE_END;
     }
   } while (insi->pid != prior_pid || insi->tid != prior_tid);
 
-  if (insi->is_dr_ins) {
-    memcpy(next_onpath_pi, insi->info, sizeof(ctype_pin_inst));
-    // dr_ins ctype_pin_inst are already populated in memtrace_reader_memtrace
-    fill_in_dynamic_info(next_onpath_pi, insi);
-  } else {
-    memset(next_onpath_pi, 0, sizeof(ctype_pin_inst));
-    fill_in_dynamic_info(next_onpath_pi, insi);
-    fill_in_basic_info(next_onpath_pi, insi->ins);
-    if (XED_INS_IsVgather(insi->ins) || XED_INS_IsVscatter(insi->ins)) {
-      xed_category_enum_t category = XED_INS_Category(insi->ins);
-      scatter_info_storage[insi->pc] = add_to_gather_scatter_info_storage(insi->pc, XED_INS_IsVgather(insi->ins),
-                                                                          XED_INS_IsVscatter(insi->ins), category);
-    }
-    uint32_t max_op_width = add_dependency_info(next_onpath_pi, insi->ins);
-    fill_in_simd_info(next_onpath_pi, insi->ins, max_op_width);
-    apply_x87_bug_workaround(next_onpath_pi, insi->ins);
-    fill_in_cf_info(next_onpath_pi, insi->ins);
-    print_err_if_invalid(next_onpath_pi, insi->ins);
-  }
+  return memtrace_convert_inst(insi, next_onpath_pi);
+}
 
+// Stats are reset/dumped on the simulation thread, never by a producer
+static void memtrace_roi_markers(int proc_id, const ctype_pin_inst* next_onpath_pi) {
   if (next_onpath_pi->scarab_marker_roi_begin == true) {
     assert(!roi_dump_began);
     // reset stats
@@ -230,12 +361,218 @@ int memtrace_trace_read(int proc_id, ctype_pin_inst* next_onpath_pi) {
     roi_dump_began = FALSE;
     roi_dump_ID++;
   }
+}
 
-  // End of ROI
-  if (!insi->is_dr_ins && roi(insi->ins))
-    return 0;
+static void memtrace_prefetch_producer(uns proc_id) {
+  Memtrace_Ring* ring = &prefetch_rings[proc_id];
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  Memtrace_Rec_Type type = MEMTRACE_REC_INST;
 
-  return 1;
+  host_placement_pin_helper(proc_id);
+
+  while (type == MEMTRACE_REC_INST) {
+    while (head - ring->tail.load(std::memory_order_acquire) == MEMTRACE_PREFETCH_DEPTH) {
+      if (prefetch_stop.load(std::memory_order_relaxed))
+        return;
+      std::this_thread::yield();
+    }
+    if (prefetch_stop.load(std::memory_order_relaxed))
+      return;
+
+    Memtrace_Rec* rec = &ring->recs[head % MEMTRACE_PREFETCH_DEPTH];
+    {
+      std::lock_guard<std::mutex> guard(decode_lock);
+      type = memtrace_decode_inst(proc_id, &rec->inst);
+    }
+    rec->type = type;
+    ring->head.store(++head, std::memory_order_release);
+  }
+}
+
+static Memtrace_Rec_Type memtrace_prefetch_pop(int proc_id, ctype_pin_inst* next_onpath_pi) {
+  Memtrace_Ring* ring = &prefetch_rings[proc_id];
+  if (ring->drained)
+    return MEMTRACE_REC_TRACE_END;
+
+  uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+  if (ring->head.load(std::memory_order_acquire) == tail) {
+    STAT_EVENT(proc_id, MEMTRACE_PREFETCH_RING_EMPTY);
+    while (ring->head.load(std::memory_order_acquire) == tail)
+      std::this_thread::yield();
+  }
+  STAT_EVENT(proc_id, MEMTRACE_PREFETCH_READ);
+
+  Memtrace_Rec* rec = &ring->recs[tail % MEMTRACE_PREFETCH_DEPTH];
+  Memtrace_Rec_Type type = rec->type;
+  // like the synchronous reader, the end of the trace leaves the inst untouched
+  if (type != MEMTRACE_REC_TRACE_END)
+    *next_onpath_pi = rec->inst;
+  ring->tail.store(tail + 1, std::memory_order_release);
+  if (type != MEMTRACE_REC_INST)
+    ring->drained = TRUE;
+  return type;
+}
+
+static void memtrace_prefetch_init(void) {
+  if (!MEMTRACE_PREFETCH_DEPTH)
+    return;
+
+  prefetch_rings = new Memtrace_Ring[NUM_CORES];
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Memtrace_Ring* ring = &prefetch_rings[proc_id];
+    ring->recs.resize(MEMTRACE_PREFETCH_DEPTH);
+    ring->head.store(0);
+    ring->tail.store(0);
+    ring->drained = FALSE;
+    ring->producer = std::thread(memtrace_prefetch_producer, proc_id);
+  }
+}
+
+static void memtrace_demux_init(void) {
+  if (!MEMTRACE_THREAD_MAP)
+    return;
+  ASSERTM(0, !MEMTRACE_PREFETCH_DEPTH, "MEMTRACE_THREAD_MAP reads one trace for all cores, without prefetching\n");
+
+  demux = new Memtrace_Demux;
+  demux->auto_map = !strcmp(MEMTRACE_THREAD_MAP, "auto");
+  demux->auto_cores = 0;
+  demux->queues.resize(NUM_CORES);
+  demux->eof = FALSE;
+  demux->dropped = 0;
+  if (demux->auto_map)
+    return;
+
+  std::string map(MEMTRACE_THREAD_MAP);
+  uns proc_id = 0;
+  for (size_t pos = 0; pos <= map.size(); proc_id++) {
+    size_t end = map.find(',', pos);
+    if (end == std::string::npos)
+      end = map.size();
+    ASSERTM(0, proc_id < NUM_CORES, "MEMTRACE_THREAD_MAP %s has more threads than cores\n", MEMTRACE_THREAD_MAP);
+    uint64_t tid = strtoull(map.substr(pos, end - pos).c_str(), nullptr, 0);
+    ASSERTM(0, tid && !demux->tid_core.count(tid), "Bad thread %s in MEMTRACE_THREAD_MAP\n",
+            map.substr(pos, end - pos).c_str());
+    demux->tid_core[tid] = proc_id;
+    pos = end + 1;
+  }
+  ASSERTM(0, proc_id == NUM_CORES, "MEMTRACE_THREAD_MAP %s has %u threads for %u cores\n", MEMTRACE_THREAD_MAP,
+          proc_id, NUM_CORES);
+}
+
+static int memtrace_demux_core(uint64_t tid) {
+  auto it = demux->tid_core.find(tid);
+  if (it != demux->tid_core.end())
+    return it->second;
+
+  int proc_id = -1;
+  if (demux->auto_map && demux->auto_cores < NUM_CORES) {
+    proc_id = demux->auto_cores++;
+    std::cout << "Thread " << tid << " runs on core " << proc_id << std::endl;
+  }
+  demux->tid_core[tid] = proc_id;
+  return proc_id;
+}
+
+/* fills the queue of proc_id from the shared trace and pops its next record */
+static Memtrace_Rec_Type memtrace_demux_pop(int proc_id, ctype_pin_inst* next_onpath_pi) {
+  std::lock_guard<std::mutex> guard(demux->lock);
+  std::deque<Memtrace_Rec>& queue = demux->queues[proc_id];
+
+  while (queue.empty() && !demux->eof) {
+    const InstInfo* insi = trace_readers[0]->nextInstruction();
+    if (!insi->valid) {
+      std::cout << "Reached end of trace" << std::endl;
+      demux->eof = TRUE;
+      break;
+    }
+    ins_id++;
+    if (insi->fetched_instruction)
+      ins_id_fetched++;
+
+    int core = memtrace_demux_core(insi->tid);
+    if (core < 0) {
+      demux->dropped++;
+      continue;
+    }
+    demux->queues[core].emplace_back();
+    Memtrace_Rec* rec = &demux->queues[core].back();
+    rec->type = memtrace_convert_inst(insi, &rec->inst);
+  }
+
+  if (queue.empty())
+    return MEMTRACE_REC_TRACE_END;
+  Memtrace_Rec_Type type = queue.front().type;
+  *next_onpath_pi = queue.front().inst;
+  queue.pop_front();
+  return type;
+}
+
+int memtrace_trace_read(int proc_id, ctype_pin_inst* next_onpath_pi) {
+  Memtrace_Rec_Type type = demux                     ? memtrace_demux_pop(proc_id, next_onpath_pi)
+                           : MEMTRACE_PREFETCH_DEPTH ? memtrace_prefetch_pop(proc_id, next_onpath_pi)
+                                                     : memtrace_decode_inst(proc_id, next_onpath_pi);
+  if (type == MEMTRACE_REC_TRACE_END)
+    return 0;  // end of trace
+
+  memtrace_roi_markers(proc_id, next_onpath_pi);
+
+  return type == MEMTRACE_REC_INST;
+}
+
+static void memtrace_ff_index_stamp(uns proc_id, Memtrace_Ff_Header* header) {
+  struct stat st;
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, MEMTRACE_FF_INDEX_MAGIC, sizeof(header->magic));
+  header->version = MEMTRACE_FF_INDEX_VERSION;
+  if (!stat(trace_files[proc_id], &st)) {
+    header->trace_size = st.st_size;
+    header->trace_mtime = st.st_mtime;
+  }
+}
+
+// Entries of the index of proc_id's trace, empty if there is none or it is stale
+static std::vector<Memtrace_Ff_Entry> memtrace_ff_index_read(uns proc_id) {
+  std::vector<Memtrace_Ff_Entry> entries;
+  std::string path = std::string(trace_files[proc_id]) + ".ffidx";
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return entries;
+
+  Memtrace_Ff_Header header, expected;
+  memtrace_ff_index_stamp(proc_id, &expected);
+  if (fread(&header, sizeof(header), 1, file) == 1 && !memcmp(header.magic, expected.magic, sizeof(header.magic)) &&
+      header.version == expected.version && header.trace_size == expected.trace_size &&
+      header.trace_mtime == expected.trace_mtime) {
+    entries.resize(header.num_entries);
+    if (fread(entries.data(), sizeof(Memtrace_Ff_Entry), entries.size(), file) != entries.size())
+      entries.clear();
+  } else {
+    std::cout << "Ignoring stale fast forward index " << path << std::endl;
+  }
+  fclose(file);
+  return entries;
+}
+
+// Replaced through a rename so that concurrent runs never read a partial index
+static void memtrace_ff_index_write(uns proc_id, const std::vector<Memtrace_Ff_Entry>& entries) {
+  std::string path = std::string(trace_files[proc_id]) + ".ffidx";
+  std::string tmp_path = path + ".tmp" + std::to_string(getpid());
+  FILE* file = fopen(tmp_path.c_str(), "wb");
+  if (!file) {
+    std::cout << "Cannot write fast forward index " << path << std::endl;
+    return;
+  }
+
+  Memtrace_Ff_Header header;
+  memtrace_ff_index_stamp(proc_id, &header);
+  header.num_entries = entries.size();
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(entries.data(), sizeof(Memtrace_Ff_Entry), entries.size(), file) == entries.size();
+  ok &= !fclose(file);
+  if (!ok || rename(tmp_path.c_str(), path.c_str())) {
+    std::cout << "Cannot write fast forward index " << path << std::endl;
+    unlink(tmp_path.c_str());
+  }
 }
 
 /**************************************************************************************/
@@ -248,42 +585,75 @@ void memtrace_init(void) {
 
   // next_onpath_pi = (ctype_pin_inst*)malloc(NUM_CORES * sizeof(ctype_pin_inst));
 
-  /* temp variable needed for easy initialization syntax */
-  char* tmp_trace_files[MAX_NUM_PROCS] = {
-      CBP_TRACE_R0,  CBP_TRACE_R1,  CBP_TRACE_R2,  CBP_TRACE_R3,  CBP_TRACE_R4,  CBP_TRACE_R5,  CBP_TRACE_R6,
-      CBP_TRACE_R7,  CBP_TRACE_R8,  CBP_TRACE_R9,  CBP_TRACE_R10, CBP_TRACE_R11, CBP_TRACE_R12, CBP_TRACE_R13,
-      CBP_TRACE_R14, CBP_TRACE_R15, CBP_TRACE_R16, CBP_TRACE_R17, CBP_TRACE_R18, CBP_TRACE_R19, CBP_TRACE_R20,
-      CBP_TRACE_R21, CBP_TRACE_R22, CBP_TRACE_R23, CBP_TRACE_R24, CBP_TRACE_R25, CBP_TRACE_R26, CBP_TRACE_R27,
-      CBP_TRACE_R28, CBP_TRACE_R29, CBP_TRACE_R30, CBP_TRACE_R31, CBP_TRACE_R32, CBP_TRACE_R33, CBP_TRACE_R34,
-      CBP_TRACE_R35, CBP_TRACE_R36, CBP_TRACE_R37, CBP_TRACE_R38, CBP_TRACE_R39, CBP_TRACE_R40, CBP_TRACE_R41,
-      CBP_TRACE_R42, CBP_TRACE_R43, CBP_TRACE_R44, CBP_TRACE_R45, CBP_TRACE_R46, CBP_TRACE_R47, CBP_TRACE_R48,
-      CBP_TRACE_R49, CBP_TRACE_R50, CBP_TRACE_R51, CBP_TRACE_R52, CBP_TRACE_R53, CBP_TRACE_R54, CBP_TRACE_R55,
-      CBP_TRACE_R56, CBP_TRACE_R57, CBP_TRACE_R58, CBP_TRACE_R59, CBP_TRACE_R60, CBP_TRACE_R61, CBP_TRACE_R62,
-      CBP_TRACE_R63,
-  };
-  if (DUMB_CORE_ON) {
-    // avoid errors by specifying a trace known to be good
-    tmp_trace_files[DUMB_CORE] = tmp_trace_files[0];
+  trace_files = frontend_trace_files();
+  memtrace_demux_init();
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    memtrace_setup(proc_id);
   }
+  memtrace_prefetch_init();
+}
 
-  for (uns proc_id = 0; proc_id < MAX_NUM_PROCS; proc_id++) {
-    trace_files[proc_id] = tmp_trace_files[proc_id];
+void memtrace_done(void) {
+  // a producer blocked on a decode buffer is released by the end of its trace
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (trace_readers[proc_id])
+      static_cast<TraceReaderMemtrace*>(trace_readers[proc_id])->stopDecoding();
   }
+  if (demux) {
+    std::cout << "Memtrace thread map dropped " << demux->dropped << " instructions of unmapped threads" << std::endl;
+    delete demux;
+    demux = nullptr;
+  }
+  if (!prefetch_rings)
+    return;
+
+  prefetch_stop.store(true, std::memory_order_relaxed);
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    memtrace_setup(proc_id);
+    prefetch_rings[proc_id].producer.join();
   }
+  delete[] prefetch_rings;
+  prefetch_rings = nullptr;
 }
 
 void memtrace_setup(uns proc_id) {
+  // with a thread map every core reads the trace of core 0
+  if (demux && proc_id) {
+    trace_readers[proc_id] = nullptr;
+    return;
+  }
+
   std::string path(trace_files[proc_id]);
-  std::string trace(path);
+  std::string trace(trace_io_local_path(path.c_str()));
+
+  // the index counts from the start of the trace, which only the first setup sees
+  bool use_ff_index = FAST_FORWARD && FAST_FORWARD_TRACE_INS && MEMTRACE_FF_INDEX_INTERVAL && !ins_id;
+  std::vector<Memtrace_Ff_Entry> ff_index;
+  uint64_t start_ordinal = 0;
+  if (use_ff_index) {
+    ff_index = memtrace_ff_index_read(proc_id);
+    // the last entry before the target: the loop below must still read at least one instruction
+    for (auto it = ff_index.rbegin(); it != ff_index.rend(); it++) {
+      if ((USE_FETCHED_COUNT ? it->ins_id_fetched : it->ins_id) < FAST_FORWARD_TRACE_INS) {
+        start_ordinal = it->ordinal + 1;
+        ins_id = it->ins_id;
+        ins_id_fetched = it->ins_id_fetched;
+        std::cout << "Fast forward index resumes the trace after " << ins_id << " instructions" << std::endl;
+        break;
+      }
+    }
+  }
 
-  trace_readers[proc_id] = new TraceReaderMemtrace(trace, 1);
+  host_placement_helpers_begin(proc_id);
+  trace_readers[proc_id] = new TraceReaderMemtrace(trace, 1, start_ordinal);
+  host_placement_helpers_end();
 
   if (FAST_FORWARD) {
     ASSERT(proc_id, !MEMTRACE_ROI_BEGIN && !MEMTRACE_ROI_END);
     uint64_t inst_count_to_use = USE_FETCHED_COUNT ? ins_id_fetched : ins_id;
     std::cout << "Enter fast forward " << inst_count_to_use << std::endl;
+    size_t ff_index_size = ff_index.size();
+    uint64_t next_ff_entry = (ff_index.empty() ? 0 : ff_index.back().ins_id) + MEMTRACE_FF_INDEX_INTERVAL;
+    Memtrace_Ff_Entry ff_candidate = {0, 0, 0};
     // FFWD the first instruction and as many as later ffwding parameters specify.
     // insi is invalid once end of trace is reached.
     // Reaching the end of the trace breaks out of the loop and segfaults later in this function.
@@ -297,6 +667,16 @@ void memtrace_setup(uns proc_id) {
         }
       }
 
+      if (use_ff_index && insi->valid) {
+        if (ff_candidate.ins_id && insi->fetched_instruction) {
+          ff_index.push_back(ff_candidate);
+          next_ff_entry = ff_candidate.ins_id + MEMTRACE_FF_INDEX_INTERVAL;
+        }
+        ff_candidate.ins_id = 0;
+        if (insi->fetched_instruction && ins_id >= next_ff_entry)
+          ff_candidate = {ins_id, ins_id_fetched, insi->ordinal};
+      }
+
       inst_count_to_use = USE_FETCHED_COUNT ? ins_id_fetched : ins_id;
 
       if ((inst_count_to_use % 10000000) == 0)
@@ -304,5 +684,8 @@ void memtrace_setup(uns proc_id) {
                   << " instr." << std::endl;
     } while (ffwd(insi->ins));
     std::cout << "Exit fast forward " << inst_count_to_use << std::endl;
+
+    if (ff_index.size() > ff_index_size)
+      memtrace_ff_index_write(proc_id, ff_index);
   }
 }
@@ -30,6 +30,11 @@
 
 #include "pin/pin_lib/x86_decoder.h"
 
+#include "core.param.h"
+
+#include <algorithm>
+#include <iterator>
+
 #include "dr_api.h"
 #include "dr_ir_instr.h"
 #include "elf.h"
@@ -46,6 +51,11 @@ typedef enum Reg_Id_struct {
 
 using namespace dynamorio::drmemtrace;
 
+// Ready buffers each decode worker may hold ahead of the simulation thread
+static const size_t MEMTRACE_DECODE_QUEUE = 4;
+// Entries of the direct-mapped PC to code bytes cache of locationForVAddr (a power of 2)
+static const size_t CODE_LOOKUP_ENTRIES = 4096;
+
 const char* trace_type_to_string(dynamorio::drmemtrace::trace_type_t type) {
   switch (type) {
     case TRACE_TYPE_INSTR:
@@ -248,7 +258,7 @@ uint8_t dr_isa_to_scarab_reg(reg_id_t reg) {
 }
 
 // Trace Reader
-TraceReaderMemtrace::TraceReaderMemtrace(const std::string& _trace, uint32_t _bufsize)
+TraceReaderMemtrace::TraceReaderMemtrace(const std::string& _trace, uint32_t _bufsize, uint64_t _start_ordinal)
     : TraceReader(_trace, _bufsize),
       module_mapper_(nullptr),
       directory_(),
@@ -262,11 +272,48 @@ TraceReaderMemtrace::TraceReaderMemtrace(const std::string& _trace, uint32_t _bu
       mt_seq_(0),
       mt_prior_isize_(0),
       mt_using_info_a_(true),
-      mt_warn_target_(0) {
+      mt_warn_target_(0),
+      start_ordinal_(_start_ordinal),
+      mt_ordinal_(_start_ordinal ? _start_ordinal - 1 : 0),
+      mt_first_instr_(true),
+      mt_seeked_(false),
+      primary_(nullptr),
+      decode_stop_(false),
+      decode_first_ordinal_(0),
+      decode_span_(0),
+      decode_pos_(0) {
   init(_trace);
 }
 
+TraceReaderMemtrace::TraceReaderMemtrace(TraceReaderMemtrace* _primary)
+    : TraceReader(_primary->trace_, 0),
+      module_mapper_(nullptr),
+      directory_(),
+      dcontext_(_primary->dcontext_),
+      knob_verbose_(0),
+      trace_has_encodings_(_primary->trace_has_encodings_),
+      is_dr_isa(false),
+      mt_state_(MTState::INST),
+      mt_use_next_ref_(true),
+      mt_mem_ops_(0),
+      mt_seq_(0),
+      mt_prior_isize_(0),
+      mt_using_info_a_(true),
+      mt_warn_target_(0),
+      start_ordinal_(0),
+      mt_ordinal_(0),
+      mt_first_instr_(true),
+      mt_seeked_(false),
+      primary_(_primary),
+      decode_stop_(false),
+      decode_first_ordinal_(0),
+      decode_span_(0),
+      decode_pos_(0) {
+  init(_primary->trace_);
+}
+
 TraceReaderMemtrace::~TraceReaderMemtrace() {
+  stopDecoding();
   if (mt_warn_target_ > 0) {
     warn("Set %lu conditional branches to 'not-taken' due to pid/tid gaps\n", mt_warn_target_);
   }
@@ -293,6 +340,11 @@ const char* TraceReaderMemtrace::parse_buildid_string(const char* src, OUT void*
 #endif
 
 bool TraceReaderMemtrace::initTrace() {
+  if (primary_) {
+    // a decode worker opens its stream at each seek()
+    return true;
+  }
+
   {
     // temporary scope only for reading filetype
     std::vector<dynamorio::drmemtrace::scheduler_t::input_workload_t> sched_inputs;
@@ -326,44 +378,181 @@ bool TraceReaderMemtrace::initTrace() {
     }
   }
 
-  std::vector<dynamorio::drmemtrace::scheduler_t::input_workload_t> sched_inputs;
   // memtrace region of interest provides a view of the trace only of interest
   // inst count satrt with 1
   // begin 0 is invalid
   // end is inclusive
   // end 0 is end of trace
-  if (MEMTRACE_ROI_BEGIN) {
+  if (start_ordinal_) {
+    // resume at a known instruction, the reader skips the records before it without decoding them
+    ASSERT(0, !MEMTRACE_ROI_BEGIN);
+  } else if (MEMTRACE_ROI_BEGIN) {
     ASSERT(0, MEMTRACE_ROI_BEGIN < MEMTRACE_ROI_END || MEMTRACE_ROI_END == 0);
-    dynamorio::drmemtrace::scheduler_t::range_t roi(static_cast<uint64_t>(MEMTRACE_ROI_BEGIN),
-                                                    static_cast<uint64_t>(MEMTRACE_ROI_END));
-    sched_inputs.emplace_back(trace_, std::vector<dynamorio::drmemtrace::scheduler_t::range_t>{roi});
+  }
+  uint64_t first_ordinal = start_ordinal_ ? start_ordinal_ : static_cast<uint64_t>(MEMTRACE_ROI_BEGIN);
+
+  if (MEMTRACE_DECODE_THREADS) {
+    startDecoding(first_ordinal ? first_ordinal : 1);
+    return true;
+  }
+
+  if (!openStream(first_ordinal))
+    return false;
+
+  // Set info 'A' to the first complete instruction.
+  // It will initially lack branch target information.
+  getNextInstruction__(&mt_info_a_, &mt_info_b_);
+  mt_using_info_a_ = false;
+  return true;
+}
+
+// Open the stream at instruction record _start_ordinal (0 = start of the trace), ending with the ROI
+bool TraceReaderMemtrace::openStream(uint64_t _start_ordinal) {
+  std::vector<dynamorio::drmemtrace::scheduler_t::input_workload_t> sched_inputs;
+  if (_start_ordinal) {
+    dynamorio::drmemtrace::scheduler_t::range_t range(_start_ordinal, roiEnd());
+    sched_inputs.emplace_back(trace_, std::vector<dynamorio::drmemtrace::scheduler_t::range_t>{range});
   } else {
     sched_inputs.emplace_back(trace_);
   }
 
-  if (scheduler.init(sched_inputs, 1, dynamorio::drmemtrace::scheduler_t::make_scheduler_serial_options()) !=
+  scheduler = std::make_unique<dynamorio::drmemtrace::scheduler_t>();
+  if (scheduler->init(sched_inputs, 1, dynamorio::drmemtrace::scheduler_t::make_scheduler_serial_options()) !=
       dynamorio::drmemtrace::scheduler_t::STATUS_SUCCESS) {
-    panic("failed to initialize scheduler: %s", scheduler.get_error_string().c_str());
+    panic("failed to initialize scheduler: %s", scheduler->get_error_string().c_str());
     return false;
   }
+  return true;
+}
 
-  // Set info 'A' to the first complete instruction.
-  // It will initially lack branch target information.
-  getNextInstruction__(&mt_info_a_, &mt_info_b_);
+// Last instruction record of the ROI, 0 for the end of the trace (MEMTRACE_ROI_END needs MEMTRACE_ROI_BEGIN)
+uint64_t TraceReaderMemtrace::roiEnd() {
+  return MEMTRACE_ROI_BEGIN ? static_cast<uint64_t>(MEMTRACE_ROI_END) : 0;
+}
+
+// Restart a decode worker at instruction record _ordinal, false if the trace ends before it
+bool TraceReaderMemtrace::seek(uint64_t _ordinal) {
+  if (!openStream(_ordinal))
+    return false;
+
+  mt_state_ = MTState::INST;
+  mt_use_next_ref_ = true;
+  mt_mem_ops_ = 0;
+  mt_prior_isize_ = 0;
+  mt_ordinal_ = _ordinal - 1;
+  mt_seeked_ = true;
+  // no prior instruction to patch: the last one of the previous span was patched by the worker that decoded it
+  mt_info_a_ = invalid_info_;
+  mt_info_b_ = invalid_info_;
+  mt_info_a_.valid = true;
+  mt_info_b_.valid = true;
   mt_using_info_a_ = false;
+  return getNextInstruction__(&mt_info_a_, &mt_info_b_);
+}
+
+void TraceReaderMemtrace::startDecoding(uint64_t _first_ordinal) {
+  ASSERT(0, MEMTRACE_DECODE_SPAN > 0 && MEMTRACE_DECODE_BUFFER > 0);
+  decode_first_ordinal_ = _first_ordinal;
+  for (uint32_t ii = 0; ii < MEMTRACE_DECODE_THREADS; ii++) {
+    decode_workers_.emplace_back(new DecodeWorker());
+    decode_workers_.back()->reader.reset(new TraceReaderMemtrace(this));
+  }
+  // the workers index decode_workers_, start them once it is complete
+  for (uint32_t ii = 0; ii < MEMTRACE_DECODE_THREADS; ii++) {
+    decode_workers_[ii]->thread = std::thread(&TraceReaderMemtrace::decodeSpans, this, ii);
+  }
+}
+
+// Worker _worker decodes spans _worker, _worker + MEMTRACE_DECODE_THREADS, ...
+void TraceReaderMemtrace::decodeSpans(uint32_t _worker) {
+  DecodeWorker* worker = decode_workers_[_worker].get();
+  TraceReaderMemtrace* reader = worker->reader.get();
+
+  for (uint64_t span = _worker;; span += decode_workers_.size()) {
+    uint64_t begin = decode_first_ordinal_ + span * MEMTRACE_DECODE_SPAN;
+    uint64_t end = begin + MEMTRACE_DECODE_SPAN;
+    bool in_roi = !roiEnd() || begin <= roiEnd();
+    const InstInfo* info = in_roi && reader->seek(begin) ? reader->getNextInstruction() : &invalid_info_;
+
+    DecodeBuffer buf;
+    buf.insts.reserve(MEMTRACE_DECODE_BUFFER);
+    // the first instruction of the next span is read as well, it completes the branch info of the last one
+    for (; info->valid && info->ordinal < end; info = reader->getNextInstruction()) {
+      buf.insts.push_back(*info);
+      if (buf.insts.size() == MEMTRACE_DECODE_BUFFER) {
+        if (!pushDecoded(worker, std::move(buf)))
+          return;
+        buf = DecodeBuffer();
+        buf.insts.reserve(MEMTRACE_DECODE_BUFFER);
+      }
+    }
+    bool trace_end = !info->valid;
+    buf.span_end = true;
+    buf.trace_end = trace_end;
+    if (!pushDecoded(worker, std::move(buf)) || trace_end)
+      return;
+  }
+}
+
+bool TraceReaderMemtrace::pushDecoded(DecodeWorker* _worker, DecodeBuffer&& _buf) {
+  std::unique_lock<std::mutex> guard(_worker->lock);
+  _worker->cv.wait(guard, [&] { return _worker->bufs.size() < MEMTRACE_DECODE_QUEUE || decode_stop_.load(); });
+  if (decode_stop_.load())
+    return false;
+  _worker->bufs.push_back(std::move(_buf));
+  guard.unlock();
+  _worker->cv.notify_all();
   return true;
 }
 
+// The next decoded instruction, in trace order
+const InstInfo* TraceReaderMemtrace::nextDecoded() {
+  while (decode_pos_ == decode_buf_.insts.size()) {
+    if (decode_buf_.trace_end)
+      return &invalid_info_;
+    if (decode_buf_.span_end)
+      decode_span_++;
+
+    DecodeWorker* worker = decode_workers_[decode_span_ % decode_workers_.size()].get();
+    std::unique_lock<std::mutex> guard(worker->lock);
+    worker->cv.wait(guard, [&] { return !worker->bufs.empty() || decode_stop_.load(); });
+    if (worker->bufs.empty())
+      return &invalid_info_;
+    decode_buf_ = std::move(worker->bufs.front());
+    worker->bufs.pop_front();
+    guard.unlock();
+    worker->cv.notify_all();
+    decode_pos_ = 0;
+  }
+  return &decode_buf_.insts[decode_pos_++];
+}
+
+void TraceReaderMemtrace::stopDecoding() {
+  if (decode_workers_.empty() || decode_stop_.load())
+    return;
+
+  decode_stop_.store(true);
+  for (auto& worker : decode_workers_) {
+    // taking the lock orders the store with a worker about to wait
+    { std::lock_guard<std::mutex> guard(worker->lock); }
+    worker->cv.notify_all();
+  }
+  // the workers and their decode caches stay: the records handed out point into them
+  for (auto& worker : decode_workers_) {
+    worker->thread.join();
+  }
+}
+
 bool TraceReaderMemtrace::getNextInstruction__(InstInfo* _info, InstInfo* _prior) {
-  static bool first_instr = true;
   uint32_t prior_isize = mt_prior_isize_;
   bool complete = false;
 
-  auto* stream = scheduler.get_stream(0);
+  auto* stream = scheduler->get_stream(0);
 
   if (mt_use_next_ref_) {
     // start with the next entry
     mt_status_ = stream->next_record(mt_ref_);
+    mt_ordinal_ += mt_status_ == dynamorio::drmemtrace::scheduler_t::STATUS_OK && type_is_instr(mt_ref_.instr.type);
   } else {
     // mt_use_next_ref_ is false following a REP BUG
     // start with the current entry because it needs to be processed
@@ -382,11 +571,12 @@ bool TraceReaderMemtrace::getNextInstruction__(InstInfo* _info, InstInfo* _prior
     switch (mt_state_) {
       case (MTState::INST):
         if (type_is_instr(mt_ref_.instr.type)) {
-          if (first_instr) {
+          mt_seeked_ = false;
+          if (mt_first_instr_) {
             // if this is the first instruction ever,
             // the file type marker of the trace should have been processed internally by DynamoRIO.
             // it is time to see if encodings are available.
-            first_instr = false;
+            mt_first_instr_ = false;
             instr_t drinst;
             instr_init(dcontext_, &drinst);
             decode(dcontext_, mt_ref_.instr.encoding, &drinst);
@@ -401,11 +591,15 @@ bool TraceReaderMemtrace::getNextInstruction__(InstInfo* _info, InstInfo* _prior
           } else {
             processInst(_info);
           }
+          _info->ordinal = mt_ordinal_;
           if (mt_mem_ops_ > 0) {
             mt_state_ = MTState::MEM1;
           } else {
             complete = true;
           }
+        } else if (mt_seeked_ && (mt_ref_.instr.type == dynamorio::drmemtrace::TRACE_TYPE_INSTR_NO_FETCH ||
+                                  typeIsMem(mt_ref_.data.type))) {
+          // the rest of an instruction before the seek target, skip it
         } else if (mt_ref_.instr.type == dynamorio::drmemtrace::TRACE_TYPE_INSTR_NO_FETCH) {
           // a repeated rep
           if (!is_dr_isa) {  // impossible to check DR_ISA_REGDEPS for REP
@@ -495,6 +689,7 @@ bool TraceReaderMemtrace::getNextInstruction__(InstInfo* _info, InstInfo* _prior
     }
     // advance to the next entry if the instruction has not yet completed
     mt_status_ = stream->next_record(mt_ref_);
+    mt_ordinal_ += mt_status_ == dynamorio::drmemtrace::scheduler_t::STATUS_OK && type_is_instr(mt_ref_.instr.type);
   }
 PATCH_REP:
   _info->valid &= complete;
@@ -805,16 +1000,14 @@ void TraceReaderMemtrace::fill_in_basic_info(ctype_pin_inst* info, instr_t* drin
   info->scarab_marker_roi_end = false;
 }
 
-std::unordered_map<uint64_t, std::tuple<int, bool, bool, bool, ctype_pin_inst>> ctype_inst_map;
-
-
 void TraceReaderMemtrace::processDrIsaInst(InstInfo* _info, bool has_another_mem) {
   assert(mt_ref_.instr.size);
   instr_t drinst;
   bool unknown_type, cond_branch;
   instr_init(dcontext_, &drinst);
   _info->pc = mt_ref_.instr.addr;
-  auto ctype_inst_iter = ctype_inst_map.find(mt_ref_.instr.addr);
+  auto ctype_inst_iter = ctype_inst_map_.find(mt_ref_.instr.addr);
+  ctype_pin_inst* cinst_used;
   if (mt_ref_.instr.encoding_is_new) {
     ctype_pin_inst cinst;
     memset(&cinst, 0, sizeof(cinst));
@@ -822,28 +1015,31 @@ void TraceReaderMemtrace::processDrIsaInst(InstInfo* _info, bool has_another_mem
 
     fill_in_basic_info(&cinst, &drinst, mt_ref_.instr.size, mt_ref_.instr.type);
     add_dependency_info(&cinst, &drinst);
-    ctype_inst_map.erase(mt_ref_.instr.addr);
-    ctype_inst_map.emplace(mt_ref_.instr.addr,
-                           std::make_tuple(cinst.num_ld + cinst.num_st, false, cinst.cf_type, false, cinst));
-    ctype_inst_iter = ctype_inst_map.find(mt_ref_.instr.addr);
+    ctype_insts_.push_back(cinst);
+    cinst_used = &ctype_insts_.back();
+    cinst.encoding_is_new = false;
+    ctype_insts_.push_back(cinst);
+    ctype_inst_map_[mt_ref_.instr.addr] =
+        std::make_tuple(cinst.num_ld + cinst.num_st, false, cinst.cf_type, false, &ctype_insts_.back());
+    ctype_inst_iter = ctype_inst_map_.find(mt_ref_.instr.addr);
     // printf("PC %lx cat %i, str:%s ld %i st %i type %s \n", mt_ref_.instr.addr, instr_get_category(&drinst),
     // category_to_str(instr_get_category(&drinst)), cinst.num_ld, cinst.num_st,
     // trace_type_to_string(mt_ref_.instr.type));
   } else {
-    assert(ctype_inst_iter != ctype_inst_map.end());
-    std::get<MAP_XED>(ctype_inst_iter->second).encoding_is_new = false;
+    assert(ctype_inst_iter != ctype_inst_map_.end());
+    cinst_used = std::get<MAP_XED>(ctype_inst_iter->second);
   }
 
   tie(mt_mem_ops_, unknown_type, cond_branch, std::ignore, std::ignore) = ctype_inst_iter->second;
   mt_prior_isize_ = mt_ref_.instr.size;
   _info->is_dr_ins = is_dr_isa;
-  _info->info = &(std::get<MAP_XED>(ctype_inst_iter->second));
+  _info->info = cinst_used;
   _info->pid = mt_ref_.instr.pid;
   _info->tid = mt_ref_.instr.tid;
   _info->target = 0;  // Set when the next instruction is evaluated
   // Set as taken if it's a branch.
   // Conditional branches are patched when the next instruction is evaluated.
-  _info->taken = std::get<MAP_XED>(ctype_inst_iter->second).cf_type;
+  _info->taken = cinst_used->cf_type;
   _info->mem_addr[0] = 0;
   _info->mem_addr[1] = 0;
   _info->mem_used[0] = false;
@@ -910,6 +1106,9 @@ bool TraceReaderMemtrace::typeIsMem(dynamorio::drmemtrace::trace_type_t _type) {
 }
 
 const InstInfo* TraceReaderMemtrace::getNextInstruction() {
+  if (!decode_workers_.empty())
+    return nextDecoded();
+
   InstInfo& info = (mt_using_info_a_ ? mt_info_a_ : mt_info_b_);
   InstInfo& prior = (mt_using_info_a_ ? mt_info_b_ : mt_info_a_);
   mt_using_info_a_ = !mt_using_info_a_;
@@ -926,18 +1125,58 @@ const InstInfo* TraceReaderMemtrace::getNextInstruction() {
 }
 
 bool TraceReaderMemtrace::locationForVAddr(uint64_t _vaddr, uint8_t** _loc, uint64_t* _size) {
+  if (code_lookups_.empty())
+    code_lookups_.resize(CODE_LOOKUP_ENTRIES);
+  CodeLookup& lookup = code_lookups_[(_vaddr ^ (_vaddr >> 12)) & (CODE_LOOKUP_ENTRIES - 1)];
+  if (lookup.loc && lookup.vaddr == _vaddr) {
+    *_loc = lookup.loc;
+    *_size = lookup.size;
+    return true;
+  }
+
+  // the last module starting at or below _vaddr
+  auto range = std::upper_bound(module_ranges_.begin(), module_ranges_.end(), _vaddr,
+                                [](uint64_t vaddr, const ModuleRange& r) { return vaddr < r.vaddr; });
+  if (range == module_ranges_.begin() || _vaddr - std::prev(range)->vaddr >= std::prev(range)->size) {
+    ModuleRange module;
+    if (primary_) {
+      // the decode workers share the module map of the primary reader
+      std::lock_guard<std::mutex> guard(primary_->module_lock_);
+      if (!primary_->findModule(_vaddr, &module))
+        return false;
+    } else if (!findModule(_vaddr, &module)) {
+      return false;
+    }
+    range = module_ranges_.insert(range, module);
+  } else {
+    range = std::prev(range);
+  }
+
+  uint64_t offset = _vaddr - range->vaddr;
+  lookup.vaddr = _vaddr;
+  lookup.loc = range->loc + offset;
+  lookup.size = range->size - offset;
+  *_loc = lookup.loc;
+  *_size = lookup.size;
+  return true;
+}
+
+// Ask the module mapper for the mapped module holding _vaddr
+bool TraceReaderMemtrace::findModule(uint64_t _vaddr, ModuleRange* _module) {
   assert(module_mapper_ != nullptr && "Module mapper is not initialized");
 
   app_pc module_start;
   size_t module_size;
 
-  *_loc = module_mapper_->find_mapped_trace_bounds(reinterpret_cast<app_pc>(_vaddr), &module_start, &module_size);
-  *_size = reinterpret_cast<uint64_t>(module_size) -
-           (reinterpret_cast<uint64_t>(*_loc) - reinterpret_cast<uint64_t>(module_start));
+  app_pc loc = module_mapper_->find_mapped_trace_bounds(reinterpret_cast<app_pc>(_vaddr), &module_start, &module_size);
   if (!module_mapper_->get_last_error().empty()) {
     std::cout << "Failed to find mapped address: " << std::hex << _vaddr
               << " Error: " << module_mapper_->get_last_error() << std::endl;
     return false;
   }
+  uint64_t offset = reinterpret_cast<uint64_t>(loc) - reinterpret_cast<uint64_t>(module_start);
+  _module->vaddr = _vaddr - offset;
+  _module->size = module_size;
+  _module->loc = reinterpret_cast<uint8_t*>(module_start);
   return true;
 }
@@ -28,6 +28,12 @@
 #ifndef MEMTRACE_READER_MEMTRACE_H
 #define MEMTRACE_READER_MEMTRACE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "globals/assert.h"
 
 #include "frontend/pt_memtrace/memtrace_trace_reader.h"
@@ -42,12 +48,53 @@
 class TraceReaderMemtrace : public TraceReader {
  public:
   const InstInfo* getNextInstruction() override;
-  TraceReaderMemtrace(const std::string& _trace, uint32_t _bufsize);
+  // A nonzero _start_ordinal starts the trace at that instruction record (1-based)
+  TraceReaderMemtrace(const std::string& _trace, uint32_t _bufsize, uint64_t _start_ordinal = 0);
   ~TraceReaderMemtrace();
+  // Joins the MEMTRACE_DECODE_THREADS workers; getNextInstruction() then returns the end of the trace
+  void stopDecoding();
 
  private:
+  /* Parallel decode (MEMTRACE_DECODE_THREADS): the trace is cut into spans of MEMTRACE_DECODE_SPAN ordinals.
+     Worker w decodes spans w, w + threads, ... each from its own stream into buffers of
+     MEMTRACE_DECODE_BUFFER instructions, and the simulation thread walks the buffers span by span. */
+  struct DecodeBuffer {
+    std::vector<InstInfo> insts;
+    bool span_end = false;   // last buffer of its span
+    bool trace_end = false;  // the trace ends in this buffer
+  };
+  struct DecodeWorker {
+    std::unique_ptr<TraceReaderMemtrace> reader;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::deque<DecodeBuffer> bufs;  // decoded ahead, oldest first
+    std::thread thread;
+  };
+
+  // A decode worker of _primary: it shares the DynamoRIO context and the module map of _primary
+  explicit TraceReaderMemtrace(TraceReaderMemtrace* _primary);
   bool initTrace() override;
+  bool openStream(uint64_t _start_ordinal);
+  static uint64_t roiEnd();
+  bool seek(uint64_t _ordinal);
+  void startDecoding(uint64_t _first_ordinal);
+  void decodeSpans(uint32_t _worker);
+  bool pushDecoded(DecodeWorker* _worker, DecodeBuffer&& _buf);
+  const InstInfo* nextDecoded();
+  /* Code bytes of instructions without encodings: a direct-mapped cache of the last lookup of each PC, then the
+     sorted modules found so far, then the module mapper */
+  struct ModuleRange {
+    uint64_t vaddr;  // application address of the module start
+    uint64_t size;
+    uint8_t* loc;  // where the module is mapped in the simulator
+  };
+  struct CodeLookup {
+    uint64_t vaddr = 0;
+    uint8_t* loc = nullptr;  // nullptr if unused
+    uint64_t size = 0;
+  };
   bool locationForVAddr(uint64_t _vaddr, uint8_t** _loc, uint64_t* _size) override;
+  bool findModule(uint64_t _vaddr, ModuleRange* _module);
   void init(const std::string& _trace);
   static const char* parse_buildid_string(const char* src, OUT void** data);
   bool getNextInstruction__(InstInfo* _info, InstInfo* _prior);
@@ -58,6 +105,8 @@ class TraceReaderMemtrace : public TraceReader {
   bool typeIsMem(dynamorio::drmemtrace::trace_type_t _type);
 
   std::unique_ptr<dynamorio::drmemtrace::module_mapper_t> module_mapper_;
+  std::vector<ModuleRange> module_ranges_;  // sorted by vaddr, they do not overlap
+  std::vector<CodeLookup> code_lookups_;    // CODE_LOOKUP_ENTRIES once used
   dynamorio::drmemtrace::raw2trace_directory_t directory_;
   void* dcontext_;
   unsigned int knob_verbose_;
@@ -72,7 +121,7 @@ class TraceReaderMemtrace : public TraceReader {
 
   // std::unique_ptr<dynamorio::drmemtrace::analyzer_t> mt_reader_;
 
-  dynamorio::drmemtrace::scheduler_t scheduler;
+  std::unique_ptr<dynamorio::drmemtrace::scheduler_t> scheduler;
 
   MTState mt_state_;
   dynamorio::drmemtrace::memref_t mt_ref_;
@@ -85,6 +134,24 @@ class TraceReaderMemtrace : public TraceReader {
   InstInfo mt_info_b_;
   bool mt_using_info_a_;
   uint64_t mt_warn_target_;
+  uint64_t start_ordinal_;
+  uint64_t mt_ordinal_;  // instruction records read from the stream so far
+  bool mt_first_instr_;
+  bool mt_seeked_;  // the stream was restarted and has not reached a fetched instruction yet
+
+  /* DR_ISA_REGDEPS instructions decoded by PC, pointing into ctype_insts_. Every new encoding adds a first-seen
+     and a seen-again copy there, so no entry a decoded record points at is written again. */
+  std::unordered_map<uint64_t, std::tuple<int, bool, bool, bool, ctype_pin_inst*>> ctype_inst_map_;
+  std::deque<ctype_pin_inst> ctype_insts_;
+
+  TraceReaderMemtrace* primary_;  // set in decode workers
+  std::mutex module_lock_;        // serializes the module map lookups of the decode workers
+  std::vector<std::unique_ptr<DecodeWorker>> decode_workers_;
+  std::atomic<bool> decode_stop_;
+  uint64_t decode_first_ordinal_;  // ordinal of the start of span 0
+  uint64_t decode_span_;           // span the simulation thread is in
+  DecodeBuffer decode_buf_;        // buffer the simulation thread is walking
+  size_t decode_pos_;
 };
 
 #endif
@@ -36,6 +36,8 @@ extern "C" {
 #include "debug/debug_macros.h"
 
 #include "memory/memory.param.h"
+
+#include "host_placement.h"
 }
 
 #include <cmath>
@@ -45,6 +47,7 @@ extern "C" {
 #include "bp/bp.param.h"
 
 #include "bp/bp.h"
+#include "frontend/frontend.h"
 #include "frontend/pt_memtrace/pt_fe.h"
 #include "isa/isa.h"
 #include "pin/pin_lib/uop_generator.h"
@@ -64,7 +67,7 @@ extern "C" {
 /**************************************************************************************/
 /* Global Variables for PT */
 
-char* pt_trace_files[MAX_NUM_PROCS];
+char** pt_trace_files;
 TraceReaderPT* pt_trace_readers[MAX_NUM_PROCS];
 uint64_t pt_ins_id = 0;
 uint64_t pt_prior_tid = 0;
@@ -185,27 +188,7 @@ void pt_init(void) {
     pt_trace_readers[i] = nullptr;
   }
 
-  /* temp variable needed for easy initialization syntax */
-  char* tmp_trace_files[MAX_NUM_PROCS] = {
-      CBP_TRACE_R0,  CBP_TRACE_R1,  CBP_TRACE_R2,  CBP_TRACE_R3,  CBP_TRACE_R4,  CBP_TRACE_R5,  CBP_TRACE_R6,
-      CBP_TRACE_R7,  CBP_TRACE_R8,  CBP_TRACE_R9,  CBP_TRACE_R10, CBP_TRACE_R11, CBP_TRACE_R12, CBP_TRACE_R13,
-      CBP_TRACE_R14, CBP_TRACE_R15, CBP_TRACE_R16, CBP_TRACE_R17, CBP_TRACE_R18, CBP_TRACE_R19, CBP_TRACE_R20,
-      CBP_TRACE_R21, CBP_TRACE_R22, CBP_TRACE_R23, CBP_TRACE_R24, CBP_TRACE_R25, CBP_TRACE_R26, CBP_TRACE_R27,
-      CBP_TRACE_R28, CBP_TRACE_R29, CBP_TRACE_R30, CBP_TRACE_R31, CBP_TRACE_R32, CBP_TRACE_R33, CBP_TRACE_R34,
-      CBP_TRACE_R35, CBP_TRACE_R36, CBP_TRACE_R37, CBP_TRACE_R38, CBP_TRACE_R39, CBP_TRACE_R40, CBP_TRACE_R41,
-      CBP_TRACE_R42, CBP_TRACE_R43, CBP_TRACE_R44, CBP_TRACE_R45, CBP_TRACE_R46, CBP_TRACE_R47, CBP_TRACE_R48,
-      CBP_TRACE_R49, CBP_TRACE_R50, CBP_TRACE_R51, CBP_TRACE_R52, CBP_TRACE_R53, CBP_TRACE_R54, CBP_TRACE_R55,
-      CBP_TRACE_R56, CBP_TRACE_R57, CBP_TRACE_R58, CBP_TRACE_R59, CBP_TRACE_R60, CBP_TRACE_R61, CBP_TRACE_R62,
-      CBP_TRACE_R63,
-  };
-  if (DUMB_CORE_ON) {
-    // avoid errors by specifying a trace known to be good
-    tmp_trace_files[DUMB_CORE] = tmp_trace_files[0];
-  }
-
-  for (uns proc_id = 0; proc_id < MAX_NUM_PROCS; proc_id++) {
-    pt_trace_files[proc_id] = tmp_trace_files[proc_id];
-  }
+  pt_trace_files = frontend_trace_files();
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     pt_setup(proc_id);
   }
@@ -215,7 +198,9 @@ void pt_setup(uns proc_id) {
   std::string path(pt_trace_files[proc_id]);
   std::string trace(path);
 
+  host_placement_helpers_begin(proc_id);
   pt_trace_readers[proc_id] = new TraceReaderPT(trace);
+  host_placement_helpers_end();
 
   // FFWD
   const InstInfo* insi = pt_trace_readers[proc_id]->nextInstruction();
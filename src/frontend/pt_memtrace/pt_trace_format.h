@@ -0,0 +1,224 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : frontend/pt_memtrace/pt_trace_format.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Allocation-free readers for the text and binary Intel PT traces,
+ *                shared by TraceReaderPT and utils/pt_trace_convert
+ ***************************************************************************************/
+
+/* Text format, one instruction per line: "<hex pc>  <size> <hex byte> ...".
+
+   Binary format (written by utils/pt_trace_convert):
+   header: char magic[8] "SCARPTB", uint32 version
+   per instruction: varint zigzag(pc - (previous pc + previous size)), then one byte
+                    with the size in the low bits and PT_BIN_NEW_BYTES set when the
+                    instruction bytes follow. The bytes are only stored the first time a
+                    pc is seen (or when they change): the reader decodes each pc once
+                    and caches it, so it never needs them again.
+
+   Both readers pull the trace through a Pin_Trace_Stream, so it may be plain, gzip, zstd,
+   bzip2 or lz4, and is decompressed on decomp_threads background threads (zstd traces of
+   several frames decode that many frames at once). They copy it out in PT_BLOCK_SIZE
+   blocks and parse the buffer in place. */
+
+#ifndef __PT_TRACE_FORMAT_H__
+#define __PT_TRACE_FORMAT_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#include "frontend/pin_trace_stream.h"
+
+#define PT_BLOCK_SIZE (1 << 20)
+#define PT_MAX_RECORD 64 /* longest text line or binary record */
+#define PT_BIN_MAGIC "SCARPTB"
+#define PT_BIN_VERSION 1
+#define PT_BIN_NEW_BYTES 0x80
+
+struct PTInst {
+  uint64_t pc;
+  uint8_t size;
+  uint8_t inst_bytes[16];
+};
+
+/* Block buffer over the decompressed trace; keeps at least PT_MAX_RECORD bytes ahead of pos until the end of
+   the file */
+class PTBlockInput {
+ private:
+  Pin_Trace_Stream* stream = nullptr;
+  char* buf = nullptr;
+  size_t end = 0;
+  bool eof = false;
+
+ public:
+  size_t pos = 0;
+
+  bool open(const char* name, unsigned decomp_threads) {
+    stream = new Pin_Trace_Stream(name, decomp_threads);
+    if (!stream->ok())
+      return false;
+    buf = new char[PT_BLOCK_SIZE + 1];
+    return true;
+  }
+  ~PTBlockInput() {
+    delete stream;
+    delete[] buf;
+  }
+
+  /* returns the number of bytes available at pos, refilling the block if fewer than PT_MAX_RECORD are */
+  size_t fill() {
+    if (end - pos >= PT_MAX_RECORD || eof)
+      return end - pos;
+    memmove(buf, buf + pos, end - pos);
+    end -= pos;
+    pos = 0;
+    size_t n = stream->read_some(buf + end, PT_BLOCK_SIZE - end);
+    eof = end + n < PT_BLOCK_SIZE;
+    end += n;
+    buf[end] = '\0';
+    return end - pos;
+  }
+  const char* data() const { return buf + pos; }
+};
+
+/* Text trace parser */
+class PTTextInput {
+ private:
+  PTBlockInput in;
+
+  static inline int hex_digit(char c) {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    return -1;
+  }
+  static inline uint64_t parse_hex(const char*& p) {
+    uint64_t x = 0;
+    if (p[0] == '0' && (p[1] | 0x20) == 'x')
+      p += 2;
+    for (int d; (d = hex_digit(*p)) >= 0; p++)
+      x = (x << 4) | d;
+    return x;
+  }
+  static inline const char* skip_spaces(const char* p) {
+    while (*p == ' ' || *p == '\t')
+      p++;
+    return p;
+  }
+
+ public:
+  bool open(const char* name, unsigned decomp_threads) { return in.open(name, decomp_threads); }
+
+  /* parses the next line into inst; false at the end of the trace or on a malformed line */
+  bool next(PTInst& inst) {
+    size_t avail;
+    const char* p;
+    do {
+      avail = in.fill();
+      if (!avail)
+        return false;
+      p = in.data();
+      const char* eol = (const char*)memchr(p, '\n', avail);
+      in.pos += eol ? eol - p + 1 : avail;
+    } while (*skip_spaces(p) == '\n' || *skip_spaces(p) == '\0');
+
+    p = skip_spaces(p);
+    inst.pc = parse_hex(p);
+    p = skip_spaces(p);
+    unsigned size = 0;
+    while (*p >= '0' && *p <= '9')
+      size = size * 10 + (*p++ - '0');
+    if (size == 0 || size > sizeof(inst.inst_bytes))
+      return false;
+    inst.size = size;
+    for (unsigned i = 0; i < size; i++) {
+      p = skip_spaces(p);
+      if (hex_digit(*p) < 0)
+        return false;
+      inst.inst_bytes[i] = parse_hex(p);
+    }
+    return true;
+  }
+};
+
+/* Binary trace reader */
+class PTBinInput {
+ private:
+  PTBlockInput in;
+  uint64_t next_pc = 0;
+
+ public:
+  /* false when the last record did not store inst_bytes (its pc was seen before) */
+  bool new_bytes = false;
+
+  bool open(const char* name, unsigned decomp_threads) {
+    if (!in.open(name, decomp_threads) || in.fill() < 12 || memcmp(in.data(), PT_BIN_MAGIC, 8))
+      return false;
+    uint32_t version;
+    memcpy(&version, in.data() + 8, sizeof(version));
+    in.pos += 12;
+    return version == PT_BIN_VERSION;
+  }
+
+  bool next(PTInst& inst) {
+    size_t avail = in.fill();
+    if (!avail)
+      return false;
+    const uint8_t* p = (const uint8_t*)in.data();
+    const uint8_t* start = p;
+    uint64_t zz = 0;
+    for (int shift = 0;; shift += 7) {
+      uint8_t byte = *p++;
+      zz |= (uint64_t)(byte & 0x7f) << shift;
+      if (byte < 0x80)
+        break;
+    }
+    inst.pc = next_pc + (uint64_t)((zz >> 1) ^ -(zz & 1));
+    uint8_t size_byte = *p++;
+    inst.size = size_byte & ~PT_BIN_NEW_BYTES;
+    new_bytes = size_byte & PT_BIN_NEW_BYTES;
+    if (new_bytes) {
+      memcpy(inst.inst_bytes, p, inst.size);
+      p += inst.size;
+    }
+    if ((size_t)(p - start) > avail)
+      return false;
+    in.pos += p - start;
+    next_pc = inst.pc + inst.size;
+    return true;
+  }
+};
+
+/* true if the (decompressed) file starts with the binary trace magic */
+static inline bool pt_trace_is_binary(const char* name) {
+  Pin_Trace_Stream stream(name, 0);
+  char magic[8];
+  return stream.ok() && stream.read(magic, 8) && !memcmp(magic, PT_BIN_MAGIC, 8);
+}
+
+#endif  // __PT_TRACE_FORMAT_H__
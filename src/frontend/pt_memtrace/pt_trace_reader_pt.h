@@ -26,12 +26,12 @@
  * Notes        : This code has been adapted from zsim which was released under
  *                GNU General Public License as published by the Free Software
  *                Foundation, version 2.
- * Description  : Interface to read gziped Intel processor trace
+ * Description  : Interface to read compressed Intel processor trace
  ***************************************************************************************/
 #ifndef __PT_TRACE_READER_PT_H__
 #define __PT_TRACE_READER_PT_H__
+#include <algorithm>
 #include <map>
-#include <sstream>
 #include <stdlib.h>
 #include <string>
 #include <vector>
@@ -40,28 +40,64 @@
 #include "general.param.h"
 
 #include "frontend/pt_memtrace/memtrace_trace_reader.h"
+#include "frontend/pt_memtrace/pt_trace_format.h"
 
-#define GZ_BUFFER_SIZE 80
 #define panic(...) printf(__VA_ARGS__)
 
-struct PTInst {
-  uint64_t pc;
-  uint8_t size;
-  uint8_t inst_bytes[16];
+/* The code-bloat remap as sorted flat arrays. lookup() finds the last block starting at
+   or before pc by interpolation, since the block addresses are close to uniform within
+   a binary, and finishes with a short linear scan. */
+class PTBloatMap {
+ private:
+  std::vector<uint64_t> prev_addrs;
+  std::vector<uint64_t> new_addrs;
+
+ public:
+  void init(const std::map<uint64_t, uint64_t>& map) {
+    prev_addrs.reserve(map.size());
+    new_addrs.reserve(map.size());
+    for (auto& entry : map) {
+      prev_addrs.push_back(entry.first);
+      new_addrs.push_back(entry.second);
+    }
+  }
+  bool empty() const { return prev_addrs.empty(); }
+
+  uint64_t lookup(uint64_t pc) const {
+    size_t lo = 0, hi = prev_addrs.size() - 1;
+    if (pc < prev_addrs[lo])
+      return pc;
+    if (pc >= prev_addrs[hi])
+      return new_addrs[hi] + (pc - prev_addrs[hi]);
+    // invariant: prev_addrs[lo] <= pc < prev_addrs[hi]
+    while (hi - lo > 8) {
+      size_t mid = lo + (size_t)((double)(pc - prev_addrs[lo]) / (prev_addrs[hi] - prev_addrs[lo]) * (hi - lo));
+      mid = std::min(std::max(mid, lo + 1), hi - 1);
+      if (prev_addrs[mid] <= pc)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    while (prev_addrs[lo + 1] <= pc)
+      lo++;
+    return new_addrs[lo] + (pc - prev_addrs[lo]);
+  }
 };
 
 class TraceReaderPT : public TraceReader {
  private:
-  gzFile raw_file = NULL;
   InstInfo inst_info_a;
   InstInfo inst_info_b;
   PTInst pt_inst_a, pt_inst_b;
   bool enable_code_bloat_effect = false;
   bool use_info_a = true;  // true when filling info a, false when filling info b
-  std::map<uint64_t, uint64_t> *prev_to_new_bbl_address_map = nullptr;
+  PTBloatMap bloat_map;
   uint64_t num_nops_in_trace = 0, num_inserted_nops = 0;
   uint64_t num_direct_brs_in_trace = 0, num_inserted_direct_brs = 0;
-  std::vector<std::string> parsed;
+  bool binary = false;
+  bool opened = false;
+  PTTextInput text_input;
+  PTBinInput bin_input;
 
  public:
   bool read_next_line(PTInst &inst) {
@@ -73,49 +109,13 @@ class TraceReaderPT : public TraceReader {
       inst.inst_bytes[0] = 0x90;
       return true;
     }
-    if (raw_file == NULL)
+    if (!opened)
       return false;
-    char buffer[GZ_BUFFER_SIZE];
-    if (gzgets(raw_file, buffer, GZ_BUFFER_SIZE) == Z_NULL)
+    if (!(binary ? bin_input.next(inst) : text_input.next(inst)))
       return false;
-    std::string line = buffer;
 
-    parsed.clear();
-    std::stringstream check1(line);
-    std::string intermediate;
-    while (getline(check1, intermediate, ' ')) {
-      parsed.emplace_back(intermediate);
-    }
-    if (parsed.size() < 3)
-      panic("TraceReaderPT: GZ File line has less than 3 items");
-    assert(parsed[1].length() == 0);
-    inst.pc = strtoul(parsed[0].c_str(), NULL, 16);
-    inst.size = strtoul(parsed[2].c_str(), NULL, 10);
-
-    int found = 0;
-    assert(inst.size);
-    for (uint8_t i = 3; found < inst.size; i++) {
-      if (parsed[i].length() == 0) {
-        continue;
-      }
-      inst.inst_bytes[found++] = strtoul(parsed[i].c_str(), NULL, 16);
-    }
-
-    if (enable_code_bloat_effect && (prev_to_new_bbl_address_map != nullptr)) {
-      uint64_t result = inst.pc;
-      auto it = prev_to_new_bbl_address_map->lower_bound(inst.pc);
-      if (it->first == inst.pc) {
-        result = it->second;
-      } else {
-        if (it == prev_to_new_bbl_address_map->begin())
-          result = inst.pc;
-        else {
-          it--;
-          result = it->second + (inst.pc - (it->first));
-        }
-      }
-      inst.pc = result;
-    }
+    if (enable_code_bloat_effect && !bloat_map.empty())
+      inst.pc = bloat_map.lookup(inst.pc);
     return true;
   }
 
@@ -248,13 +248,16 @@ class TraceReaderPT : public TraceReader {
   }
   TraceReaderPT(const std::string &_trace, bool _enable_code_bloat_effect = false,
                 std::map<uint64_t, uint64_t> *_prev_to_new_bbl_address_map = nullptr) {
-    raw_file = gzopen(_trace.c_str(), "rb");
-    if (!raw_file) {
+    binary = pt_trace_is_binary(_trace.c_str());
+    opened = binary ? bin_input.open(_trace.c_str(), PT_DECOMP_THREADS)
+                    : text_input.open(_trace.c_str(), PT_DECOMP_THREADS);
+    if (!opened) {
       panic("TraceReaderPT: Invalid GZ File");
       throw "Could not open file";
     }
     enable_code_bloat_effect = _enable_code_bloat_effect;
-    prev_to_new_bbl_address_map = _prev_to_new_bbl_address_map;
+    if (_prev_to_new_bbl_address_map)
+      bloat_map.init(*_prev_to_new_bbl_address_map);
     inst_info_a.valid = false;
     inst_info_b.valid = false;
     init("");
@@ -291,8 +294,6 @@ class TraceReaderPT : public TraceReader {
     std::cout << "num trace direct brs: " << num_direct_brs_in_trace
               << " , num added direct brs: " << num_inserted_direct_brs
               << ", ratio: " << double(num_inserted_direct_brs) / double(num_direct_brs_in_trace) << std::endl;
-    if (raw_file != NULL)
-      gzclose(raw_file);
   }
 };
 
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
 #include <limits>
 #include <map>
 
@@ -12,6 +13,7 @@
 #include "frontend/frontend_intf.h"
 #include "frontend/pt_memtrace/memtrace_fe.h"
 #include "frontend/pt_memtrace/pt_fe.h"
+#include "frontend/sct_trace.h"
 #include "isa/isa.h"
 #include "pin/pin_lib/uop_generator.h"
 #include "pin/pin_lib/x86_decoder.h"
@@ -27,6 +29,7 @@
 
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
+#include "debug/sim_probe.h"
 // #include "globals/global_defs.h"
 // #include "globals/global_types.h"
 // #include "globals/global_vars.h"
@@ -36,53 +39,242 @@
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_TRACE_READ, ##args)
 
 /* Globals */
-static ctype_pin_inst next_onpath_pi[MAX_NUM_PROCS];
+/* next_onpath_pi points at the core's current on-path instruction. With a trace buffer the slot is exchanged with
+   the head of the buffer on every read, so an instruction is decoded once in place and never copied afterwards. */
+static ctype_pin_inst next_onpath_store[MAX_NUM_PROCS];
+static ctype_pin_inst *next_onpath_pi[MAX_NUM_PROCS];
 static ctype_pin_inst next_offpath_pi[MAX_NUM_PROCS];
 static bool off_path_mode[MAX_NUM_PROCS] = {false};
 static uint64_t off_path_addr[MAX_NUM_PROCS] = {0};
-static std::unordered_map<uint64_t, ctype_pin_inst> pc_to_inst;
+
+/* Every on-path instruction is checked against the last instance seen at its PC, and the last instance is kept for
+   wrong-path generation. The check only touches a compact record (encoding, next PC and a signature of the memory
+   addresses) in an open-addressed table. The instance is kept split in two pool slots: the static part is rewritten
+   only when the encoding at the PC changes, the dynamic part (Trace_Inst_Dyn) whenever the next PC or the memory
+   addresses change. */
+typedef struct Trace_Inst_Rec_struct {
+  Addr addr;
+  uint64_t inst_binary_lsb;
+  uint64_t inst_binary_msb;
+  Addr instruction_next_addr;
+  uint64_t mem_sig;
+  uns pool_idx;
+  Flag valid;
+} Trace_Inst_Rec;
+
+typedef struct Trace_Inst_Dyn_struct {
+  Addr instruction_next_addr;
+  Addr branch_target;
+  uint64_t ld_vaddr[MAX_LD_NUM];
+  uint64_t st_vaddr[MAX_ST_NUM];
+  uint8_t num_ld;
+  uint8_t num_st;
+  uint8_t actually_taken;
+} Trace_Inst_Dyn;
+
+#define TRACE_INST_MAP_INIT_LOG2 16
+#define TRACE_HASH_MULT 0x9E3779B97F4A7C15ULL
+
+static std::vector<Trace_Inst_Rec> pc_to_inst;
+static std::vector<ctype_pin_inst> pc_to_inst_pool;
+static std::vector<Trace_Inst_Dyn> pc_to_inst_dyn;
+static uns pc_to_inst_log2 = 0;
 
 uint64_t rdptr = 0;
 uint64_t wrptr = 0;
-std::vector<ctype_pin_inst> circ_buf;
-std::unordered_map<Addr, Counter> buf_map;
+std::vector<ctype_pin_inst *> circ_buf;
+static std::vector<ctype_pin_inst> circ_buf_store;
 const int CLINE = ~0x3F;
 
+/* per-line instruction counts of the trace buffer window, open-addressed with backward-shift deletion so that the
+   window can slide without tombstones */
+typedef struct Buf_Map_Entry_struct {
+  Addr line_addr;
+  Counter count;
+} Buf_Map_Entry;
+
+static std::vector<Buf_Map_Entry> buf_map;
+static uns buf_map_log2 = 0;
+
 extern uint64_t ins_id;
 extern uint64_t ins_id_fetched;
 
+static inline uns trace_hash(Addr addr, uns log2) {
+  return (uns)((addr * TRACE_HASH_MULT) >> (64 - log2));
+}
+
+static uint64_t ctype_pin_inst_mem_sig(const ctype_pin_inst *inst) {
+  uint64_t sig = 0;
+  for (uns i = 0; i < MAX_LD_NUM; i++) {
+    sig = (sig ^ inst->ld_vaddr[i]) * TRACE_HASH_MULT;
+  }
+  for (uns i = 0; i < MAX_ST_NUM; i++) {
+    sig = (sig ^ inst->st_vaddr[i]) * TRACE_HASH_MULT;
+  }
+  return sig;
+}
+
+static Trace_Inst_Rec *pc_to_inst_find(Addr addr) {
+  if (!pc_to_inst_log2)
+    return NULL;
+  uns mask = N_BIT_MASK(pc_to_inst_log2);
+  for (uns idx = trace_hash(addr, pc_to_inst_log2);; idx = (idx + 1) & mask) {
+    Trace_Inst_Rec *rec = &pc_to_inst[idx];
+    if (!rec->valid)
+      return NULL;
+    if (rec->addr == addr)
+      return rec;
+  }
+}
+
+static void pc_to_inst_place(const Trace_Inst_Rec &src) {
+  uns mask = N_BIT_MASK(pc_to_inst_log2);
+  uns idx = trace_hash(src.addr, pc_to_inst_log2);
+  while (pc_to_inst[idx].valid) {
+    idx = (idx + 1) & mask;
+  }
+  pc_to_inst[idx] = src;
+}
+
+/* keep the table at most half full; only the compact records move, pool slots stay put */
+static void pc_to_inst_grow() {
+  std::vector<Trace_Inst_Rec> old;
+  old.swap(pc_to_inst);
+  pc_to_inst_log2 = pc_to_inst_log2 ? pc_to_inst_log2 + 1 : TRACE_INST_MAP_INIT_LOG2;
+  pc_to_inst.assign((size_t)1 << pc_to_inst_log2, Trace_Inst_Rec());
+  for (const Trace_Inst_Rec &rec : old) {
+    if (rec.valid)
+      pc_to_inst_place(rec);
+  }
+}
+
+/* only the first num_ld/num_st addresses are kept; the rest read back as zero */
+static void pc_to_inst_write_dyn(Trace_Inst_Rec *rec, const ctype_pin_inst *inst) {
+  Trace_Inst_Dyn *dyn = &pc_to_inst_dyn[rec->pool_idx];
+  rec->instruction_next_addr = inst->instruction_next_addr;
+  rec->mem_sig = ctype_pin_inst_mem_sig(inst);
+  dyn->instruction_next_addr = inst->instruction_next_addr;
+  dyn->branch_target = inst->branch_target;
+  dyn->num_ld = MIN2(inst->num_ld, MAX_LD_NUM);
+  dyn->num_st = MIN2(inst->num_st, MAX_ST_NUM);
+  dyn->actually_taken = inst->actually_taken;
+  for (uns i = 0; i < dyn->num_ld; i++) {
+    dyn->ld_vaddr[i] = inst->ld_vaddr[i];
+  }
+  for (uns i = 0; i < dyn->num_st; i++) {
+    dyn->st_vaddr[i] = inst->st_vaddr[i];
+  }
+  uop_generator_wrong_path_invalidate(rec->addr);
+}
+
+static void pc_to_inst_write(Trace_Inst_Rec *rec, const ctype_pin_inst *inst) {
+  rec->inst_binary_lsb = inst->inst_binary_lsb;
+  rec->inst_binary_msb = inst->inst_binary_msb;
+  pc_to_inst_pool[rec->pool_idx] = *inst;
+  pc_to_inst_write_dyn(rec, inst);
+}
+
+/* rebuilds the last instance seen at the PC of rec */
+static void pc_to_inst_read(const Trace_Inst_Rec *rec, ctype_pin_inst *inst) {
+  const Trace_Inst_Dyn *dyn = &pc_to_inst_dyn[rec->pool_idx];
+  *inst = pc_to_inst_pool[rec->pool_idx];
+  inst->instruction_next_addr = dyn->instruction_next_addr;
+  inst->branch_target = dyn->branch_target;
+  inst->num_ld = dyn->num_ld;
+  inst->num_st = dyn->num_st;
+  inst->actually_taken = dyn->actually_taken;
+  memset(inst->ld_vaddr, 0, sizeof(inst->ld_vaddr));
+  memset(inst->st_vaddr, 0, sizeof(inst->st_vaddr));
+  for (uns i = 0; i < dyn->num_ld; i++) {
+    inst->ld_vaddr[i] = dyn->ld_vaddr[i];
+  }
+  for (uns i = 0; i < dyn->num_st; i++) {
+    inst->st_vaddr[i] = dyn->st_vaddr[i];
+  }
+}
+
+static void pc_to_inst_insert(const ctype_pin_inst *inst) {
+  if (2 * (pc_to_inst_pool.size() + 1) > pc_to_inst.size())
+    pc_to_inst_grow();
+  Trace_Inst_Rec rec = {};
+  rec.addr = inst->instruction_addr;
+  rec.pool_idx = pc_to_inst_pool.size();
+  rec.valid = TRUE;
+  pc_to_inst_pool.push_back(*inst);
+  pc_to_inst_dyn.push_back(Trace_Inst_Dyn());
+  pc_to_inst_place(rec);
+  pc_to_inst_write(pc_to_inst_find(rec.addr), inst);
+}
+
+static void buf_map_init() {
+  buf_map_log2 = 1;
+  while (((uns)1 << buf_map_log2) < 2 * NUM_CORES * TRACE_BUF_SIZE) {
+    buf_map_log2++;
+  }
+  buf_map.assign((size_t)1 << buf_map_log2, Buf_Map_Entry());
+}
+
+/* returns the slot holding line_addr, or the empty slot that ends its probe sequence */
+static uns buf_map_slot(Addr line_addr) {
+  uns mask = N_BIT_MASK(buf_map_log2);
+  uns idx = trace_hash(line_addr, buf_map_log2);
+  while (buf_map[idx].count && buf_map[idx].line_addr != line_addr) {
+    idx = (idx + 1) & mask;
+  }
+  return idx;
+}
+
 Flag buf_map_find(Addr line_addr) {
-  return buf_map.find(line_addr) != buf_map.end();
+  if (!buf_map_log2)
+    return FALSE;
+  return buf_map[buf_map_slot(line_addr)].count != 0;
 }
 
 // inserts the inst written to write_ptr location
 void buf_map_insert() {
-  Addr line_addr = circ_buf[wrptr].instruction_addr & CLINE;
-  auto it = buf_map.find(line_addr);
-  if (it != buf_map.end()) {
-    it->second++;
-  } else {
-    buf_map.insert(std::pair<Addr, Counter>(line_addr, 1));
-  }
+  Addr line_addr = circ_buf[wrptr]->instruction_addr & CLINE;
+  Buf_Map_Entry *entry = &buf_map[buf_map_slot(line_addr)];
+  entry->line_addr = line_addr;
+  entry->count++;
   wrptr = (wrptr + 1) % TRACE_BUF_SIZE;
 }
 
 void buf_map_remove() {
-  Addr line_addr = circ_buf[rdptr].instruction_addr & CLINE;
-  auto it = buf_map.find(line_addr);
-  assert(it != buf_map.end());
-  if (it->second > 1) {
-    it->second--;
+  Addr line_addr = circ_buf[rdptr]->instruction_addr & CLINE;
+  uns mask = N_BIT_MASK(buf_map_log2);
+  uns hole = buf_map_slot(line_addr);
+  ASSERT(0, buf_map[hole].count);
+  rdptr = (rdptr + 1) % TRACE_BUF_SIZE;
+  if (--buf_map[hole].count)
+    return;
+  // pull back any later entry of the cluster whose home slot does not lie in (hole, idx]
+  for (uns idx = (hole + 1) & mask; buf_map[idx].count; idx = (idx + 1) & mask) {
+    uns home = trace_hash(buf_map[idx].line_addr, buf_map_log2);
+    if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+      buf_map[hole] = buf_map[idx];
+      buf_map[idx].count = 0;
+      hole = idx;
+    }
+  }
+}
+
+/* streams the uops of a recently generated wrong-path instruction straight from the uop generator's cache */
+static void off_path_next_inst(uns proc_id) {
+  uns inst_size;
+  if (uop_generator_wrong_path_load(proc_id, off_path_addr[proc_id], &inst_size)) {
+    next_offpath_pi[proc_id].instruction_addr = off_path_addr[proc_id];
+    off_path_addr[proc_id] += inst_size;
+    DEBUG(proc_id, "Stream cached off-path inst:%lx inst_size:%i ", next_offpath_pi[proc_id].instruction_addr,
+          inst_size);
   } else {
-    buf_map.erase(it);
+    off_path_generate_inst(proc_id, &off_path_addr[proc_id], &next_offpath_pi[proc_id]);
   }
-  rdptr = (rdptr + 1) % TRACE_BUF_SIZE;
 }
 
 void off_path_generate_inst(uns proc_id, uint64_t *off_path_addr, ctype_pin_inst *inst) {
-  auto op_iter = pc_to_inst.find(*off_path_addr);
-  if (op_iter != pc_to_inst.end()) {
-    *inst = op_iter->second;
+  Trace_Inst_Rec *rec = pc_to_inst_find(*off_path_addr);
+  if (rec) {
+    pc_to_inst_read(rec, inst);
     *off_path_addr += inst->size;
     DEBUG(proc_id, "Generate off-path inst:%lx inst_size:%i ", inst->instruction_addr, inst->size);
   } else {
@@ -91,23 +283,7 @@ void off_path_generate_inst(uns proc_id, uint64_t *off_path_addr, ctype_pin_inst
   }
 }
 
-Flag ctype_pin_inst_same_mem_vaddr(ctype_pin_inst inst_a, ctype_pin_inst inst_b) {
-  for (uns i = 0; i < MAX_LD_NUM; i++) {
-    if (inst_a.ld_vaddr[i] != inst_b.ld_vaddr[i]) {
-      return FALSE;
-    }
-  }
-
-  for (uns i = 0; i < MAX_ST_NUM; i++) {
-    if (inst_a.st_vaddr[i] != inst_b.st_vaddr[i]) {
-      return FALSE;
-    }
-  }
-
-  return TRUE;
-}
-
-void assert_ctype_pin_inst_same(uns proc_id, ctype_pin_inst inst_a, ctype_pin_inst inst_b) {
+void assert_ctype_pin_inst_same(uns proc_id, const ctype_pin_inst &inst_a, const ctype_pin_inst &inst_b) {
   // uint64_t inst_uid;  // unique ID produced by the frontend
 
   ASSERT(proc_id, inst_a.instruction_addr == inst_b.instruction_addr);
@@ -192,48 +368,63 @@ void trace_buf_init() {
   if (!TRACE_BUF_SIZE)
     return;
 
+  buf_map_init();
+  circ_buf_store.resize(TRACE_BUF_SIZE);
+  circ_buf.resize(TRACE_BUF_SIZE);
+  for (uns i = 0; i < TRACE_BUF_SIZE; i++) {
+    circ_buf[i] = &circ_buf_store[i];
+  }
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    circ_buf.resize(TRACE_BUF_SIZE);
     rdptr = 0;
     wrptr = 0;
     if (FRONTEND == FE_PT) {
       for (uint i = 0; i < TRACE_BUF_SIZE; i++) {
-        pt_trace_read(proc_id, &circ_buf[wrptr]);
+        pt_trace_read(proc_id, circ_buf[wrptr]);
         buf_map_insert();
       }
     } else if (FRONTEND == FE_MEMTRACE) {
       for (uint i = 0; i < TRACE_BUF_SIZE; i++) {
-        memtrace_trace_read(proc_id, &circ_buf[wrptr]);
+        memtrace_trace_read(proc_id, circ_buf[wrptr]);
         buf_map_insert();
       }
     }
   }
 }
 
-int trace_read(int proc_id, ctype_pin_inst *next_onpath_pi) {
+/* reads the next on-path instruction of proc_id into next_onpath_pi[proc_id]. With a trace buffer the head slot
+   becomes the core's instruction and the core's old slot is refilled from the trace, so the entry is not copied. */
+static int trace_read(int proc_id) {
+  int ret = 0;
+  SIM_PROBE1(trace_read_begin, proc_id);
   if (!TRACE_BUF_SIZE) {
     if (FRONTEND == FE_PT)
-      return pt_trace_read(proc_id, next_onpath_pi);
+      ret = pt_trace_read(proc_id, next_onpath_pi[proc_id]);
     else if (FRONTEND == FE_MEMTRACE)
-      return memtrace_trace_read(proc_id, next_onpath_pi);
+      ret = memtrace_trace_read(proc_id, next_onpath_pi[proc_id]);
+    SIM_PROBE2(trace_read_end, proc_id, ret);
+    return ret;
   }
 
   ASSERT(0, TRACE_BUF_SIZE);
-  *next_onpath_pi = circ_buf[rdptr];
+  ctype_pin_inst *head = circ_buf[rdptr];
   buf_map_remove();
-  int ret = 0;
+  // the buffer is always full, so the freed head slot is the one written next
+  ASSERT(proc_id, circ_buf[wrptr] == head);
+  circ_buf[wrptr] = next_onpath_pi[proc_id];
+  next_onpath_pi[proc_id] = head;
   if (FRONTEND == FE_PT)
-    ret = pt_trace_read(proc_id, &circ_buf[wrptr]);
+    ret = pt_trace_read(proc_id, circ_buf[wrptr]);
   else if (FRONTEND == FE_MEMTRACE)
-    ret = memtrace_trace_read(proc_id, &circ_buf[wrptr]);
+    ret = memtrace_trace_read(proc_id, circ_buf[wrptr]);
   buf_map_insert();
+  SIM_PROBE2(trace_read_end, proc_id, ret);
   return ret;
 }
 
 void ext_trace_fetch_op(uns proc_id, Op *op) {
   if (uop_generator_get_bom(proc_id)) {
     if (!off_path_mode[proc_id]) {
-      uop_generator_get_uop(proc_id, op, &next_onpath_pi[proc_id]);
+      uop_generator_get_uop(proc_id, op, next_onpath_pi[proc_id]);
     } else {
       uop_generator_get_uop(proc_id, op, &next_offpath_pi[proc_id]);
       op->exit = false;
@@ -245,56 +436,53 @@ void ext_trace_fetch_op(uns proc_id, Op *op) {
   if (uop_generator_get_eom(proc_id)) {
     if (!off_path_mode[proc_id]) {
       int success = false;
-      success = trace_read(proc_id, &next_onpath_pi[proc_id]);
+      success = trace_read(proc_id);
       if (!success) {
         trace_read_done[proc_id] = TRUE;
         reached_exit[proc_id] = TRUE;
         op->exit = TRUE;
       } else {
-        uint64_t addr = next_onpath_pi[proc_id].instruction_addr;
-        auto find = pc_to_inst.find(addr);
-        if (find == pc_to_inst.end()) {
-          pc_to_inst.insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (next_onpath_pi[proc_id].encoding_is_new) {
+        const ctype_pin_inst *pi = next_onpath_pi[proc_id];
+        Addr addr = pi->instruction_addr;
+        Trace_Inst_Rec *rec = pc_to_inst_find(addr);
+        if (!rec) {
+          pc_to_inst_insert(pi);
+        } else if (pi->encoding_is_new) {
           STAT_EVENT(proc_id, INST_MAP_UPDATE_ENCODING);
-          pc_to_inst.erase(addr);
-          pc_to_inst.insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (next_onpath_pi[proc_id].inst_binary_lsb != find->second.inst_binary_lsb ||
-                   next_onpath_pi[proc_id].inst_binary_msb != find->second.inst_binary_msb) {
+          pc_to_inst_write(rec, pi);
+        } else if (pi->inst_binary_lsb != rec->inst_binary_lsb || pi->inst_binary_msb != rec->inst_binary_msb) {
           DEBUG(proc_id, "Previously seen PC references new instruction addr:%lx inst_size:%i lsb:%lx msb:%lx\n ", addr,
-                next_onpath_pi[proc_id].size, next_onpath_pi[proc_id].inst_binary_lsb,
-                next_onpath_pi[proc_id].inst_binary_msb);
+                pi->size, pi->inst_binary_lsb, pi->inst_binary_msb);
           // Handle jitted code
           STAT_EVENT(proc_id, INST_MAP_UPDATE_JITTED);
-          pc_to_inst.erase(addr);
-          pc_to_inst.insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (next_onpath_pi[proc_id].instruction_next_addr != find->second.instruction_next_addr) {
-          ASSERT(proc_id, next_onpath_pi[proc_id].op_type == find->second.op_type);
-          if (next_onpath_pi[proc_id].cf_type) {
-            ASSERT(proc_id, next_onpath_pi[proc_id].cf_type == find->second.cf_type);
+          pc_to_inst_write(rec, pi);
+        } else if (pi->instruction_next_addr != rec->instruction_next_addr) {
+          ASSERT(proc_id, pi->op_type == pc_to_inst_pool[rec->pool_idx].op_type);
+          if (pi->cf_type) {
+            ASSERT(proc_id, pi->cf_type == pc_to_inst_pool[rec->pool_idx].cf_type);
             // This can fail for java pt traces
-            // ASSERT(proc_id, next_onpath_pi[proc_id].cf_type == CF_CBR ||
-            //                 next_onpath_pi[proc_id].cf_type >= CF_IBR ||
-            //                 next_onpath_pi[proc_id].last_inst_from_trace);
+            // ASSERT(proc_id, next_onpath_pi[proc_id]->cf_type == CF_CBR ||
+            //                 next_onpath_pi[proc_id]->cf_type >= CF_IBR ||
+            //                 next_onpath_pi[proc_id]->last_inst_from_trace);
           }
-          STAT_EVENT(proc_id, INST_MAP_UPDATE_NPC_INV + next_onpath_pi[proc_id].op_type);
-          pc_to_inst.erase(addr);
-          pc_to_inst.insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else if (!ctype_pin_inst_same_mem_vaddr(next_onpath_pi[proc_id], find->second)) {
-          ASSERT(proc_id, next_onpath_pi[proc_id].op_type == find->second.op_type);
-          STAT_EVENT(proc_id, INST_MAP_UPDATE_MEM_INV + next_onpath_pi[proc_id].op_type);
-          pc_to_inst.erase(addr);
-          pc_to_inst.insert(std::pair<uint64_t, ctype_pin_inst>(addr, next_onpath_pi[proc_id]));
-        } else {
-          assert_ctype_pin_inst_same(proc_id, next_onpath_pi[proc_id], find->second);
+          STAT_EVENT(proc_id, INST_MAP_UPDATE_NPC_INV + pi->op_type);
+          pc_to_inst_write(rec, pi);
+        } else if (ctype_pin_inst_mem_sig(pi) != rec->mem_sig) {
+          ASSERT(proc_id, pi->op_type == pc_to_inst_pool[rec->pool_idx].op_type);
+          STAT_EVENT(proc_id, INST_MAP_UPDATE_MEM_INV + pi->op_type);
+          pc_to_inst_write(rec, pi);
+        } else if (ENABLE_ASSERTIONS) {
+          ctype_pin_inst last;
+          pc_to_inst_read(rec, &last);
+          assert_ctype_pin_inst_same(proc_id, *pi, last);
         }
       }
     } else {
-      off_path_generate_inst(proc_id, &off_path_addr[proc_id], &next_offpath_pi[proc_id]);
+      off_path_next_inst(proc_id);
     }
   }
   DEBUG(proc_id, "Fetch op is_on_path:%i on_path:%lx off_path:%lx\n", off_path_mode[proc_id],
-        next_onpath_pi[proc_id].instruction_addr, next_offpath_pi[proc_id].instruction_addr);
+        next_onpath_pi[proc_id]->instruction_addr, next_offpath_pi[proc_id].instruction_addr);
 }
 
 Flag ext_trace_can_fetch_op(uns proc_id) {
@@ -307,8 +495,8 @@ Flag ext_trace_can_fetch_op(uns proc_id) {
 void ext_trace_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr) {
   off_path_mode[proc_id] = true;
   off_path_addr[proc_id] = fetch_addr;
-  off_path_generate_inst(proc_id, &off_path_addr[proc_id], &next_offpath_pi[proc_id]);
-  DEBUG(proc_id, "Redirect on-path:%lx off-path:%lx", next_onpath_pi[proc_id].instruction_addr,
+  off_path_next_inst(proc_id);
+  DEBUG(proc_id, "Redirect on-path:%lx off-path:%lx", next_onpath_pi[proc_id]->instruction_addr,
         next_offpath_pi[proc_id].instruction_addr);
 }
 
@@ -319,7 +507,8 @@ void ext_trace_recover(uns proc_id, uns64 inst_uid) {
   while (!uop_generator_get_eom(proc_id)) {
     uop_generator_get_uop(proc_id, &dummy_op, &next_offpath_pi[proc_id]);
   }
-  DEBUG(proc_id, "Recover CF:%lx ", next_onpath_pi[proc_id].instruction_addr);
+  uop_generator_wrong_path_cancel(proc_id);
+  DEBUG(proc_id, "Recover CF:%lx ", next_onpath_pi[proc_id]->instruction_addr);
 }
 
 void ext_trace_retire(uns proc_id, uns64 inst_uid) {
@@ -328,12 +517,14 @@ void ext_trace_retire(uns proc_id, uns64 inst_uid) {
 }
 
 Addr ext_trace_next_fetch_addr(uns proc_id) {
-  return next_onpath_pi[proc_id].instruction_addr;
+  return next_onpath_pi[proc_id]->instruction_addr;
 }
 
 void ext_trace_init() {
   memset(next_offpath_pi, 0, sizeof(next_offpath_pi));
-  memset(next_onpath_pi, 0, sizeof(next_onpath_pi));
+  memset(next_onpath_store, 0, sizeof(next_onpath_store));
+  for (uns proc_id = 0; proc_id < MAX_NUM_PROCS; proc_id++)
+    next_onpath_pi[proc_id] = &next_onpath_store[proc_id];
 
   if (FRONTEND == FE_PT)
     pt_init();
@@ -342,16 +533,108 @@ void ext_trace_init() {
 
   trace_buf_init();
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
-    trace_read(proc_id, &next_onpath_pi[proc_id]);
+    trace_read(proc_id);
 }
 
 void ext_trace_done() {
+  if (FRONTEND == FE_MEMTRACE)
+    memtrace_done();
+}
+
+// Reads the whole trace once and writes it as a pre-decoded .sct trace for FE_SCT
+void ext_trace_write_sct() {
+  ASSERT(0, NUM_CORES == 1);
+  uns8 proc_id = 0;
+  ASSERT(proc_id, SCT_OUTPUT);
+
+  Sct_Writer writer(SCT_OUTPUT);
+  ASSERTM(proc_id, writer.ok(), "Cannot create sct trace: %s\n", SCT_OUTPUT);
+
+  // the first trace entry was read during frontend initialization
+  ctype_pin_inst *inst = next_onpath_pi[proc_id];
+  int success = true;
+  while (success) {
+    writer.add(inst);
+    success = trace_read(proc_id);
+    inst = next_onpath_pi[proc_id];
+  }
+  writer.finish();
+
+  std::cout << "Wrote " << writer.num_dynamic() << " instructions (" << writer.num_static()
+            << " static) to " << SCT_OUTPUT << std::endl;
+}
+
+/* BBV bookkeeping keyed by basic block start PC or id, open-addressed and kept at most half full. The
+   fingerprints are cleared every segment, so clearing only touches the slots that were used. */
+typedef struct Bbv_Map_Entry_struct {
+  uint64_t key;
+  uint64_t value;
+  Flag valid;
+} Bbv_Map_Entry;
+
+typedef struct Bbv_Map_struct {
+  std::vector<Bbv_Map_Entry> slots;
+  std::vector<uns> used;  // slots in insertion order
+  uns log2;
+} Bbv_Map;
+
+#define BBV_MAP_INIT_LOG2 10
+
+static void bbv_map_grow(Bbv_Map *map) {
+  std::vector<uns> old_used;
+  old_used.swap(map->used);
+  std::vector<Bbv_Map_Entry> old;
+  old.swap(map->slots);
+  map->log2 = map->log2 ? map->log2 + 1 : BBV_MAP_INIT_LOG2;
+  map->slots.assign((size_t)1 << map->log2, Bbv_Map_Entry());
+  uns mask = N_BIT_MASK(map->log2);
+  for (uns old_idx : old_used) {
+    uns idx = trace_hash(old[old_idx].key, map->log2);
+    while (map->slots[idx].valid)
+      idx = (idx + 1) & mask;
+    map->slots[idx] = old[old_idx];
+    map->used.push_back(idx);
+  }
+}
+
+/* returns the value of key, inserting it as 0 if it is not in the map */
+static uint64_t &bbv_map_get(Bbv_Map *map, uint64_t key) {
+  if (2 * (map->used.size() + 1) > map->slots.size())
+    bbv_map_grow(map);
+  uns mask = N_BIT_MASK(map->log2);
+  uns idx = trace_hash(key, map->log2);
+  while (map->slots[idx].valid && map->slots[idx].key != key)
+    idx = (idx + 1) & mask;
+  Bbv_Map_Entry *entry = &map->slots[idx];
+  if (!entry->valid) {
+    entry->key = key;
+    entry->value = 0;
+    entry->valid = TRUE;
+    map->used.push_back(idx);
+  }
+  return entry->value;
+}
+
+static Bbv_Map_Entry *bbv_map_find(Bbv_Map *map, uint64_t key) {
+  if (!map->log2)
+    return NULL;
+  uns mask = N_BIT_MASK(map->log2);
+  for (uns idx = trace_hash(key, map->log2); map->slots[idx].valid; idx = (idx + 1) & mask) {
+    if (map->slots[idx].key == key)
+      return &map->slots[idx];
+  }
+  return NULL;
+}
+
+static void bbv_map_clear(Bbv_Map *map) {
+  for (uns idx : map->used)
+    map->slots[idx].valid = FALSE;
+  map->used.clear();
 }
 
 // is also used to print footprint
-uint64_t output_fingerprint(std::string file_name, std::map<uint64_t, uint64_t> fingerprint) {
+uint64_t output_fingerprint(std::string file_name, Bbv_Map *fingerprint) {
   // output the map for this segment
-  // make it a function?
   std::ofstream myfile;
   myfile.open(file_name, std::ofstream::out | std::ofstream::app);
 
@@ -359,31 +642,22 @@ uint64_t output_fingerprint(std::string file_name, std::map<uint64_t, uint64_t>
     std::cout << "open file failed: " << file_name << std::endl;
   }
 
-  // std::cout << num_of_segments << "th fp dimensions: " << fingerprint.size() << std::endl;
-  // fine if comment starting here
-  std::map<uint64_t, uint64_t>::iterator freq;
-  uint64_t instrs_count = 0;
-
-  uint64_t nonzero_count = 0;
-  // static std::vector<uint64> csv_line(counts_as_built.blocks, 0);
+  // the dimensions are written in key order
+  std::vector<std::pair<uint64_t, uint64_t>> freqs;
+  freqs.reserve(fingerprint->used.size());
+  for (uns idx : fingerprint->used)
+    freqs.emplace_back(fingerprint->slots[idx].key, fingerprint->slots[idx].value);
+  std::sort(freqs.begin(), freqs.end());
 
-  for (freq = fingerprint.begin(); freq != fingerprint.end(); freq++) {
+  uint64_t instrs_count = 0;
+  for (auto freq = freqs.begin(); freq != freqs.end(); freq++) {
     instrs_count += freq->second;
-    if (freq == fingerprint.begin()) {
+    if (freq == freqs.begin()) {
       myfile << "T";
     }
     myfile << ":" << freq->first << ":" << freq->second << " ";
-
-    // csv_line[freq->first] = freq->second;
-    nonzero_count++;
-
-    // if (freq->first + 1 == counts_as_built.blocks) {
-    //     witness_total = true;
-    // }
   }
 
-  // ASSERT(proc_id, nonzero_count == fingerprint.size());
-
   myfile << std::endl;
   myfile.close();
 
@@ -524,10 +798,9 @@ void ext_trace_extract_basic_block_vectors() {
   uint64_t cur_counter = 0;
   uint64_t cur_counter_fetched = 0;
 
-  // unordered map to hash basic block identifier to the basic block info
-  // the identifier: the first pc of the basic block
+  // map from the basic block identifier, its first pc, to the basic block id
   // this map is used throughout the post-processing
-  std::unordered_map<uint64_t, basic_block_info> bb_map;
+  Bbv_Map bb_map{};
 
   std::unordered_map<uint64_t, std::vector<basic_block_info>> bb_identity_map;
 
@@ -535,18 +808,19 @@ void ext_trace_extract_basic_block_vectors() {
   // essentially the fingerprint for a segment
   // this map is cleared every SEGMENT_SIZE instruction
   // mode 1: the key is the basic block id, used for the whole trace
-  // mode 2: the key is the first addr of the basic block, used for trace chunks
-  std::map<uint64_t, uint64_t> fingerprint;
+  // mode 2: the key is the first addr of the basic block, used for trace chunks and shards (TRACE_BBV_KEY_BY_PC)
+  Bbv_Map fingerprint{};
+  bool key_by_pc = SIM_MODE == TRACE_BBV_DISTRIBUTED_MODE || TRACE_BBV_KEY_BY_PC;
 
   // for instruction footprint analysis
-  std::map<uint64_t, uint64_t> footprint;
+  Bbv_Map footprint{};
 
   // maintain the current basic block
   basic_block_info cur_bb{};
 
   // the first trace entry was read during frontend initialization
   // assume the first read succeeded
-  ctype_pin_inst *inst = &next_onpath_pi[proc_id];
+  ctype_pin_inst *inst = next_onpath_pi[proc_id];
   int success = true;
 
   printf("read from initialization: %p\n", (void *)(inst->instruction_addr));
@@ -572,12 +846,13 @@ void ext_trace_extract_basic_block_vectors() {
     // increment fetched count if it is fetched
     if (inst->fetched_instruction) {
       // increment unique inst frequency
-      footprint[inst->instruction_addr]++;
+      bbv_map_get(&footprint, inst->instruction_addr)++;
       cur_bb.inst_count_fetched++;
     }
 
-    // read the next instruction from the trace, which overwrites inst
-    success = trace_read(proc_id, inst);
+    // read the next instruction from the trace
+    success = trace_read(proc_id);
+    inst = next_onpath_pi[proc_id];
 
     if (cur_bb.ins_list.back().is_repeat && !inst->is_repeat) {
       ASSERT(proc_id, cur_bb.ins_list.back().instruction_addr != inst->instruction_addr);
@@ -594,8 +869,7 @@ void ext_trace_extract_basic_block_vectors() {
 
     if (cur_bb.ins_list.back().cf_type || !success || (!cur_bb.ins_list.back().is_repeat && inst->is_repeat) ||
         cur_bb.ins_list.back().is_repeat) {
-      std::unordered_map<uint64_t, basic_block_info>::iterator map_lookup =
-          bb_map.find(cur_bb.ins_list.front().instruction_addr);
+      Bbv_Map_Entry *map_lookup = bbv_map_find(&bb_map, cur_bb.ins_list.front().instruction_addr);
 
       // std::ofstream cinstf;
       // cinstf.open("cinst.log", std::ofstream::out | std::ofstream::app);
@@ -605,10 +879,10 @@ void ext_trace_extract_basic_block_vectors() {
       //          << std::dec << std::setfill(' ') << std::endl;
       // }
       // cinstf.close();
-      if (map_lookup != bb_map.end()) {
+      if (map_lookup) {
         // not the first time bb
         // the bb size might be cut if at boundary
-        cur_bb.bb_id = map_lookup->second.bb_id;
+        cur_bb.bb_id = map_lookup->value;
 
         // sanity check: are they the same?
         auto bb_key = cur_bb.ins_list.front().instruction_addr;
@@ -630,7 +904,7 @@ void ext_trace_extract_basic_block_vectors() {
 
           if (bb_identity_map[bb_key].size() > 1) {
             for (uint i = 0; i < cur_bb.ins_list.size(); i++) {
-              fprintf(stderr, "[%lu]: ad: %p, op: %d\n", map_lookup->second.bb_id,
+              fprintf(stderr, "[%lu]: ad: %p, op: %d\n", map_lookup->value,
                       (void *)cur_bb.ins_list[i].instruction_addr, cur_bb.ins_list[i].true_op_type);
             }
             fprintf(stderr, "DUP bb detected%s\n", success ? "" : " at trace end");
@@ -648,7 +922,7 @@ void ext_trace_extract_basic_block_vectors() {
         counts_as_built.fetched_size += cur_bb.inst_count_fetched;
 
         // enter bb map
-        bb_map[cur_bb.ins_list.front().instruction_addr] = cur_bb;
+        bbv_map_get(&bb_map, cur_bb.ins_list.front().instruction_addr) = cur_bb.bb_id;
         // sanity check
         cur_bb.freq++;
         bb_identity_map[cur_bb.ins_list.front().instruction_addr].push_back(cur_bb);
@@ -684,7 +958,7 @@ void ext_trace_extract_basic_block_vectors() {
       // (cur_counter_fetched == SEGMENT_INSTR_COUNT) <=> !success
       // since do not know if it is the last one,
       // (cur_counter_fetched == SEGMENT_INSTR_COUNT) -> !success
-      if (cur_counter_fetched == SEGMENT_INSTR_COUNT) {
+      if (SIM_MODE == TRACE_BBV_DISTRIBUTED_MODE && cur_counter_fetched == SEGMENT_INSTR_COUNT) {
         ASSERT(proc_id, !success);
       }
 
@@ -749,12 +1023,8 @@ void ext_trace_extract_basic_block_vectors() {
       // (to_new_vector_count > 0));
 
       if (cur_bb.inst_count_fetched) {
-        if (SIM_MODE == TRACE_BBV_MODE) {
-          fingerprint[cur_bb.bb_id] += to_last_vector_count;
-        } else {
-          // TRACE_BBV_DISTRIBUTED_MODE
-          fingerprint[cur_bb.ins_list.front().instruction_addr] += to_last_vector_count;
-        }
+        uint64_t bb_key = key_by_pc ? cur_bb.ins_list.front().instruction_addr : cur_bb.bb_id;
+        bbv_map_get(&fingerprint, bb_key) += to_last_vector_count;
       }
 
       // perfect alignment
@@ -772,26 +1042,21 @@ void ext_trace_extract_basic_block_vectors() {
 
         std::string bbv_output(TRACE_BBV_OUTPUT);
         std::string footprint_output(TRACE_FOOTPRINT_OUTPUT);
-        uint64_t instrs_count_bbv = output_fingerprint(bbv_output, fingerprint);
+        uint64_t instrs_count_bbv = output_fingerprint(bbv_output, &fingerprint);
         if (!footprint_output.empty()) {
-          uint64_t instrs_count_footprint = output_fingerprint(footprint_output, footprint);
+          uint64_t instrs_count_footprint = output_fingerprint(footprint_output, &footprint);
           ASSERT(proc_id, instrs_count_bbv == instrs_count_footprint);
         }
 
         // clear for the next segment
-        fingerprint.clear();
-        footprint.clear();
+        bbv_map_clear(&fingerprint);
+        bbv_map_clear(&footprint);
 
         // record the residue
         // if to_new_vector_count > 0, the bb must have crossed the vector boundary
         if (to_new_vector_count > 0) {
-          if (SIM_MODE == TRACE_BBV_MODE) {
-            fingerprint.insert(std::make_pair(cur_bb.bb_id, to_new_vector_count));
-          } else {
-            // TRACE_BBV_DISTRIBUTED_MODE
-            uint64_t bb_addr = cur_bb.ins_list.front().instruction_addr;
-            fingerprint.insert(std::make_pair(bb_addr, to_new_vector_count));
-          }
+          uint64_t bb_key = key_by_pc ? cur_bb.ins_list.front().instruction_addr : cur_bb.bb_id;
+          bbv_map_get(&fingerprint, bb_key) = to_new_vector_count;
 
           cur_counter = to_new_vector_count;
           cur_counter_fetched = to_new_vector_count_fetched;
@@ -803,7 +1068,7 @@ void ext_trace_extract_basic_block_vectors() {
       // clear out current bb
       cur_bb.clear();
 
-      if (!success && !fingerprint.empty()) {
+      if (!success && !fingerprint.used.empty()) {
         num_of_segments++;
         output_counts(num_of_segments, counts_dynamic, counts_as_built, op_taken_count, bb_identity_map);
 
@@ -813,9 +1078,9 @@ void ext_trace_extract_basic_block_vectors() {
 
         std::string bbv_output(TRACE_BBV_OUTPUT);
         std::string footprint_output(TRACE_FOOTPRINT_OUTPUT);
-        uint64_t instrs_count_bbv = output_fingerprint(bbv_output, fingerprint);
+        uint64_t instrs_count_bbv = output_fingerprint(bbv_output, &fingerprint);
         if (!footprint_output.empty()) {
-          uint64_t instrs_count_footprint = output_fingerprint(footprint_output, footprint);
+          uint64_t instrs_count_footprint = output_fingerprint(footprint_output, &footprint);
           ASSERT(proc_id, instrs_count_bbv == instrs_count_footprint);
         }
 
@@ -62,6 +62,7 @@ void ext_trace_retire(uns proc_id, uns64 inst_uid);
 void ext_trace_init();
 void ext_trace_done(void);
 void ext_trace_extract_basic_block_vectors();
+void ext_trace_write_sct();
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,311 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/sct_fe.cc
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : Frontend replaying pre-decoded .sct traces without any x86
+ *                decoding. Wrong-path instructions are rebuilt from the last
+ *                on-path instance of the fetched PC, as in the memtrace frontend.
+ ***************************************************************************************/
+
+extern "C" {
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+
+#include "core.param.h"
+#include "general.param.h"
+
+#include "host_placement.h"
+#include "op.h"
+#include "statistics.h"
+}
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "frontend/frontend.h"
+#include "frontend/sct_fe.h"
+#include "frontend/sct_trace.h"
+#include "frontend/trace_io.h"
+#include "pin/pin_lib/uop_generator.h"
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_TRACE_READ, ##args)
+
+/**************************************************************************************/
+/* Global Variables */
+
+/* Read-ahead (SCT_PREFETCH_DEPTH): a producer thread per core decodes on-path records ahead of the simulator into a
+   single-producer single-consumer ring. The consumer applies everything that off-path generation depends on
+   (last_rec) and the ROI markers itself, in trace order, so the read-ahead does not change the simulated stream. */
+typedef struct Sct_Rec_struct {
+  ctype_pin_inst inst;
+  const uint8_t* rec;
+  uint32_t idx;
+  bool valid;  // false marks the end of the trace
+} Sct_Rec;
+
+typedef struct Sct_Core_struct {
+  Sct_Reader reader;
+  ctype_pin_inst next_onpath_pi;
+  ctype_pin_inst next_offpath_pi;
+  bool off_path_mode;
+  uint64_t off_path_addr;
+  // static entries of each PC and the last dynamic record of each static entry
+  std::unordered_map<uint64_t, std::vector<uint32_t>> pc_statics;
+  std::vector<const uint8_t*> last_rec;
+
+  std::vector<Sct_Rec> recs;
+  alignas(64) std::atomic<uint64_t> head;  // next slot written by the producer
+  alignas(64) std::atomic<uint64_t> tail;  // next slot read by the consumer
+  bool drained;                            // consumer has seen the end of the trace
+  std::thread producer;
+} Sct_Core;
+
+static Sct_Core* sct_cores;
+static std::atomic<bool> sct_prefetch_stop(false);
+
+/**************************************************************************************/
+/* Private Functions */
+
+static void sct_prefetch_producer(uns proc_id) {
+  Sct_Core* core = &sct_cores[proc_id];
+  uint64_t head = core->head.load(std::memory_order_relaxed);
+  bool valid = true;
+
+  host_placement_pin_helper(proc_id);
+
+  while (valid) {
+    while (head - core->tail.load(std::memory_order_acquire) == SCT_PREFETCH_DEPTH) {
+      if (sct_prefetch_stop.load(std::memory_order_relaxed))
+        return;
+      std::this_thread::yield();
+    }
+    if (sct_prefetch_stop.load(std::memory_order_relaxed))
+      return;
+
+    Sct_Rec* rec = &core->recs[head % SCT_PREFETCH_DEPTH];
+    valid = core->reader.next(&rec->inst, &rec->rec, &rec->idx);
+    rec->valid = valid;
+    core->head.store(++head, std::memory_order_release);
+  }
+}
+
+static bool sct_prefetch_pop(uns proc_id, ctype_pin_inst* inst, const uint8_t** rec_ptr, uint32_t* idx) {
+  Sct_Core* core = &sct_cores[proc_id];
+  if (core->drained)
+    return false;
+
+  uint64_t tail = core->tail.load(std::memory_order_relaxed);
+  if (core->head.load(std::memory_order_acquire) == tail) {
+    STAT_EVENT(proc_id, SCT_PREFETCH_RING_EMPTY);
+    while (core->head.load(std::memory_order_acquire) == tail)
+      std::this_thread::yield();
+  }
+  STAT_EVENT(proc_id, SCT_PREFETCH_READ);
+
+  Sct_Rec* rec = &core->recs[tail % SCT_PREFETCH_DEPTH];
+  bool valid = rec->valid;
+  if (valid) {
+    *inst = rec->inst;
+    *rec_ptr = rec->rec;
+    *idx = rec->idx;
+  }
+  core->tail.store(tail + 1, std::memory_order_release);
+  core->drained = !valid;
+  return valid;
+}
+
+static Flag sct_read(uns proc_id, ctype_pin_inst* inst) {
+  Sct_Core* core = &sct_cores[proc_id];
+  const uint8_t* rec;
+  uint32_t idx;
+  bool valid = SCT_PREFETCH_DEPTH ? sct_prefetch_pop(proc_id, inst, &rec, &idx) : core->reader.next(inst, &rec, &idx);
+  if (!valid)
+    return FALSE;
+  core->last_rec[idx] = rec;
+
+  if (inst->scarab_marker_roi_begin) {
+    ASSERT(proc_id, !roi_dump_began);
+    std::cout << "Reached roi dump begin marker, reset stats" << std::endl;
+    reset_stats(TRUE);
+    roi_dump_began = TRUE;
+  } else if (inst->scarab_marker_roi_end) {
+    ASSERT(proc_id, roi_dump_began);
+    std::cout << "Reached roi dump end marker, dump stats between" << std::endl;
+    dump_stats(proc_id, TRUE, global_stat_array[proc_id], NUM_GLOBAL_STATS);
+    roi_dump_began = FALSE;
+    roi_dump_ID++;
+  }
+  return TRUE;
+}
+
+static void sct_off_path_generate_inst(uns proc_id) {
+  Sct_Core* core = &sct_cores[proc_id];
+  const uint8_t* last = nullptr;
+  auto it = core->pc_statics.find(core->off_path_addr);
+  if (it != core->pc_statics.end()) {
+    // records are laid out in trace order, so the highest address is the most recent
+    for (uint32_t idx : it->second)
+      last = std::max(last, core->last_rec[idx]);
+  }
+
+  if (last) {
+    core->reader.decode(last, &core->next_offpath_pi);
+    core->off_path_addr += core->next_offpath_pi.size;
+    DEBUG(proc_id, "Generate off-path inst:%lx inst_size:%i ", core->next_offpath_pi.instruction_addr,
+          core->next_offpath_pi.size);
+  } else {
+    core->next_offpath_pi = create_dummy_nop(core->off_path_addr, WPNM_REASON_REDIRECT_TO_NOT_INSTRUMENTED);
+    core->off_path_addr += DUMMY_NOP_SIZE;
+  }
+}
+
+/**************************************************************************************/
+/* sct_init() */
+
+void sct_init() {
+  ASSERTM(0, !TRACE_BUF_SIZE, "The sct frontend does not support TRACE_BUF_SIZE\n");
+  uop_generator_init(NUM_CORES);
+
+  char** trace_files = frontend_trace_files();
+
+  sct_cores = new Sct_Core[NUM_CORES];
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Sct_Core* core = &sct_cores[proc_id];
+    ASSERTM(proc_id, trace_files[proc_id] && core->reader.open(trace_io_local_path(trace_files[proc_id])), "Cannot open sct trace: %s\n",
+            trace_files[proc_id] ? trace_files[proc_id] : "(null)");
+    memset(&core->next_onpath_pi, 0, sizeof(core->next_onpath_pi));
+    memset(&core->next_offpath_pi, 0, sizeof(core->next_offpath_pi));
+    core->off_path_mode = false;
+    core->off_path_addr = 0;
+    if (FAST_FORWARD) {
+      // the index replaces the instruction by instruction fast forward of the other trace frontends
+      ASSERTM(proc_id, FAST_FORWARD_TRACE_INS, "The sct frontend fast forwards only by FAST_FORWARD_TRACE_INS\n");
+      ASSERTM(proc_id, core->reader.skip(FAST_FORWARD_TRACE_INS, USE_FETCHED_COUNT),
+              "sct trace %s is shorter than FAST_FORWARD_TRACE_INS\n", trace_files[proc_id]);
+    }
+    core->last_rec.assign(core->reader.num_static(), nullptr);
+    for (uint32_t idx = 0; idx < core->reader.num_static(); idx++)
+      core->pc_statics[core->reader.static_inst(idx)->instruction_addr].push_back(idx);
+
+    core->head.store(0);
+    core->tail.store(0);
+    core->drained = false;
+    if (SCT_PREFETCH_DEPTH) {
+      core->recs.resize(SCT_PREFETCH_DEPTH);
+      core->producer = std::thread(sct_prefetch_producer, proc_id);
+    }
+
+    if (!sct_read(proc_id, &core->next_onpath_pi))
+      trace_read_done[proc_id] = TRUE;
+  }
+}
+
+void sct_done() {
+  if (!sct_cores)
+    return;
+  sct_prefetch_stop.store(true, std::memory_order_relaxed);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (sct_cores[proc_id].producer.joinable())
+      sct_cores[proc_id].producer.join();
+  }
+  delete[] sct_cores;
+  sct_cores = nullptr;
+}
+
+/**************************************************************************************/
+/* Frontend interface */
+
+Addr sct_next_fetch_addr(uns proc_id) {
+  return sct_cores[proc_id].next_onpath_pi.instruction_addr;
+}
+
+Flag sct_can_fetch_op(uns proc_id) {
+  if (!sct_cores[proc_id].off_path_mode)
+    return !(uop_generator_get_eom(proc_id) && trace_read_done[proc_id]);
+  else
+    return TRUE;
+}
+
+void sct_fetch_op(uns proc_id, Op* op) {
+  Sct_Core* core = &sct_cores[proc_id];
+  if (uop_generator_get_bom(proc_id)) {
+    if (!core->off_path_mode) {
+      uop_generator_get_uop(proc_id, op, &core->next_onpath_pi);
+    } else {
+      uop_generator_get_uop(proc_id, op, &core->next_offpath_pi);
+      op->exit = FALSE;
+    }
+  } else {
+    uop_generator_get_uop(proc_id, op, NULL);
+  }
+
+  if (uop_generator_get_eom(proc_id)) {
+    if (!core->off_path_mode) {
+      if (!sct_read(proc_id, &core->next_onpath_pi)) {
+        trace_read_done[proc_id] = TRUE;
+        reached_exit[proc_id] = TRUE;
+        op->exit = TRUE;
+      }
+    } else {
+      sct_off_path_generate_inst(proc_id);
+    }
+  }
+  DEBUG(proc_id, "Fetch op is_on_path:%i on_path:%lx off_path:%lx\n", core->off_path_mode,
+        core->next_onpath_pi.instruction_addr, core->next_offpath_pi.instruction_addr);
+}
+
+void sct_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr) {
+  Sct_Core* core = &sct_cores[proc_id];
+  core->off_path_mode = true;
+  core->off_path_addr = fetch_addr;
+  sct_off_path_generate_inst(proc_id);
+  DEBUG(proc_id, "Redirect on-path:%lx off-path:%lx", core->next_onpath_pi.instruction_addr,
+        core->next_offpath_pi.instruction_addr);
+}
+
+void sct_recover(uns proc_id, uns64 inst_uid) {
+  Sct_Core* core = &sct_cores[proc_id];
+  Op dummy_op;
+  core->off_path_mode = false;
+  // Finish decoding of the current off-path inst before switching to on-path
+  while (!uop_generator_get_eom(proc_id)) {
+    uop_generator_get_uop(proc_id, &dummy_op, &core->next_offpath_pi);
+  }
+  DEBUG(proc_id, "Recover CF:%lx ", core->next_onpath_pi.instruction_addr);
+}
+
+void sct_retire(uns proc_id, uns64 inst_uid) {
+  // Trace frontend does not need to communicate to PIN which instruction are
+  // retired.
+}
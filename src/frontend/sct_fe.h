@@ -0,0 +1,61 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/sct_fe.h
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : Frontend replaying pre-decoded .sct traces (see frontend/sct_trace.h)
+ ***************************************************************************************/
+
+#ifndef __SCT_FE_H__
+#define __SCT_FE_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Forward Declarations */
+
+struct Op_struct;
+
+/**************************************************************************************/
+/* Prototypes */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sct_init(void);
+void sct_done(void);
+
+/* Implementing the frontend interface */
+Addr sct_next_fetch_addr(uns proc_id);
+Flag sct_can_fetch_op(uns proc_id);
+void sct_fetch_op(uns proc_id, struct Op_struct* op);
+void sct_redirect(uns proc_id, uns64 inst_uid, Addr fetch_addr);
+void sct_recover(uns proc_id, uns64 inst_uid);
+void sct_retire(uns proc_id, uns64 inst_uid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
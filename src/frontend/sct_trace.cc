@@ -0,0 +1,282 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/sct_trace.cc
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : Writer and mmap reader for the Scarab compact trace (.sct) format.
+ ***************************************************************************************/
+
+#include "frontend/sct_trace.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static inline uint64_t sct_read_u64(const uint8_t** ptr) {
+  uint64_t val;
+  memcpy(&val, *ptr, sizeof(val));
+  *ptr += sizeof(val);
+  return val;
+}
+
+static inline unsigned sct_num_extra(const Sct_Record& rec) {
+  return !!(rec.flags & SCT_NEXT_ADDR) + !!(rec.flags & SCT_TARGET) + !!(rec.flags & SCT_INST_UID) +
+         (rec.num_vaddrs & 0xf) + (rec.num_vaddrs >> 4);
+}
+
+/**************************************************************************************/
+/* Sct_Writer */
+
+Sct_Writer::Sct_Writer(const char* path) : prev_uid(0), num_fetched(0) {
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SCT_MAGIC, sizeof(header.magic));
+  header.version = SCT_VERSION;
+  header.inst_size = sizeof(ctype_pin_inst);
+  header.dynamic_offset = sizeof(Sct_Header);
+
+  file = fopen(path, "wb");
+  if (file)
+    fwrite(&header, sizeof(header), 1, file);
+}
+
+Sct_Writer::~Sct_Writer() {
+  if (file)
+    finish();
+}
+
+void Sct_Writer::add(const ctype_pin_inst* inst) {
+  if (header.num_dynamic % SCT_INDEX_INTERVAL == 0)
+    index.push_back({header.dynamic_size, prev_uid, num_fetched});
+  num_fetched += !!inst->fetched_instruction;
+
+  // the static part is the instruction with every per-instance field cleared
+  ctype_pin_inst key = *inst;
+  key.inst_uid = 0;
+  key.num_ld = 0;
+  key.num_st = 0;
+  memset(key.ld_vaddr, 0, sizeof(key.ld_vaddr));
+  memset(key.st_vaddr, 0, sizeof(key.st_vaddr));
+  key.branch_target = 0;
+  key.actually_taken = 0;
+  key.encoding_is_new = 0;
+  key.instruction_next_addr = 0;
+  key.last_inst_from_trace = 0;
+  key.fetched_instruction = 0;
+
+  std::string bytes(reinterpret_cast<const char*>(&key), sizeof(key));
+  auto it = static_ids.find(bytes);
+  uint32_t idx;
+  if (it == static_ids.end()) {
+    idx = statics.size();
+    statics.push_back(key);
+    static_ids.emplace(std::move(bytes), idx);
+  } else {
+    idx = it->second;
+  }
+
+  Sct_Record rec;
+  uint64_t extra[3 + MAX_LD_NUM + MAX_ST_NUM];
+  unsigned num_extra = 0;
+  rec.static_idx = idx;
+  rec.flags = (inst->actually_taken ? SCT_TAKEN : 0) | (inst->fetched_instruction ? SCT_FETCHED : 0) |
+              (inst->last_inst_from_trace ? SCT_LAST_INST : 0) | (inst->encoding_is_new ? SCT_ENCODING_NEW : 0);
+  rec.num_ld = inst->num_ld;
+  rec.num_st = inst->num_st;
+  if (inst->instruction_next_addr != inst->instruction_addr + inst->size) {
+    rec.flags |= SCT_NEXT_ADDR;
+    extra[num_extra++] = inst->instruction_next_addr;
+  }
+  if (inst->branch_target != inst->instruction_next_addr) {
+    rec.flags |= SCT_TARGET;
+    extra[num_extra++] = inst->branch_target;
+  }
+  if (inst->inst_uid != prev_uid + 1) {
+    rec.flags |= SCT_INST_UID;
+    extra[num_extra++] = inst->inst_uid;
+  }
+  prev_uid = inst->inst_uid;
+
+  unsigned num_ld_vaddrs = MAX_LD_NUM;
+  while (num_ld_vaddrs && !inst->ld_vaddr[num_ld_vaddrs - 1])
+    num_ld_vaddrs--;
+  unsigned num_st_vaddrs = MAX_ST_NUM;
+  while (num_st_vaddrs && !inst->st_vaddr[num_st_vaddrs - 1])
+    num_st_vaddrs--;
+  for (unsigned i = 0; i < num_ld_vaddrs; i++)
+    extra[num_extra++] = inst->ld_vaddr[i];
+  for (unsigned i = 0; i < num_st_vaddrs; i++)
+    extra[num_extra++] = inst->st_vaddr[i];
+  rec.num_vaddrs = num_ld_vaddrs | (num_st_vaddrs << 4);
+
+  fwrite(&rec, sizeof(rec), 1, file);
+  fwrite(extra, sizeof(uint64_t), num_extra, file);
+  header.num_dynamic++;
+  header.dynamic_size += sizeof(rec) + num_extra * sizeof(uint64_t);
+}
+
+void Sct_Writer::finish() {
+  header.num_static = statics.size();
+  header.static_offset = header.dynamic_offset + header.dynamic_size;
+  fwrite(statics.data(), sizeof(ctype_pin_inst), statics.size(), file);
+  header.num_index = index.size();
+  header.index_offset = header.static_offset + statics.size() * sizeof(ctype_pin_inst);
+  fwrite(index.data(), sizeof(Sct_Index_Entry), index.size(), file);
+  fseek(file, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, file);
+  fclose(file);
+  file = nullptr;
+}
+
+/**************************************************************************************/
+/* Sct_Reader */
+
+Sct_Reader::Sct_Reader()
+    : map(nullptr),
+      map_size(0),
+      header(nullptr),
+      statics(nullptr),
+      index(nullptr),
+      cur(nullptr),
+      end(nullptr),
+      prev_uid(0) {}
+
+Sct_Reader::~Sct_Reader() {
+  if (map)
+    munmap(map, map_size);
+}
+
+bool Sct_Reader::open(const char* path) {
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) || (size_t)st.st_size < sizeof(Sct_Header)) {
+    ::close(fd);
+    return false;
+  }
+  map_size = st.st_size;
+  map = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    map = nullptr;
+    return false;
+  }
+
+  const uint8_t* base = static_cast<const uint8_t*>(map);
+  header = reinterpret_cast<const Sct_Header*>(base);
+  if (memcmp(header->magic, SCT_MAGIC, sizeof(header->magic)) || header->version != SCT_VERSION ||
+      header->inst_size != sizeof(ctype_pin_inst) || header->dynamic_offset + header->dynamic_size > map_size ||
+      header->static_offset + header->num_static * sizeof(ctype_pin_inst) > map_size ||
+      header->index_offset + header->num_index * sizeof(Sct_Index_Entry) > map_size ||
+      header->num_index != (header->num_dynamic + SCT_INDEX_INTERVAL - 1) / SCT_INDEX_INTERVAL) {
+    fprintf(stderr, "%s is not a compatible .sct trace\n", path);
+    return false;
+  }
+
+  statics = reinterpret_cast<const ctype_pin_inst*>(base + header->static_offset);
+  index = reinterpret_cast<const Sct_Index_Entry*>(base + header->index_offset);
+  cur = base + header->dynamic_offset;
+  end = cur + header->dynamic_size;
+  madvise(const_cast<uint8_t*>(cur), header->dynamic_size, MADV_SEQUENTIAL);
+  return true;
+}
+
+const uint8_t* Sct_Reader::decode_record(const uint8_t* rec_ptr, ctype_pin_inst* inst, uint64_t uid) const {
+  Sct_Record rec;
+  memcpy(&rec, rec_ptr, sizeof(rec));
+  const uint8_t* ptr = rec_ptr + sizeof(rec);
+
+  *inst = statics[rec.static_idx];
+  inst->num_ld = rec.num_ld;
+  inst->num_st = rec.num_st;
+  inst->actually_taken = !!(rec.flags & SCT_TAKEN);
+  inst->fetched_instruction = !!(rec.flags & SCT_FETCHED);
+  inst->last_inst_from_trace = !!(rec.flags & SCT_LAST_INST);
+  inst->encoding_is_new = !!(rec.flags & SCT_ENCODING_NEW);
+  inst->instruction_next_addr =
+      (rec.flags & SCT_NEXT_ADDR) ? sct_read_u64(&ptr) : inst->instruction_addr + inst->size;
+  inst->branch_target = (rec.flags & SCT_TARGET) ? sct_read_u64(&ptr) : inst->instruction_next_addr;
+  inst->inst_uid = (rec.flags & SCT_INST_UID) ? sct_read_u64(&ptr) : uid;
+  for (unsigned i = 0; i < (rec.num_vaddrs & 0xf); i++)
+    inst->ld_vaddr[i] = sct_read_u64(&ptr);
+  for (unsigned i = 0; i < (rec.num_vaddrs >> 4); i++)
+    inst->st_vaddr[i] = sct_read_u64(&ptr);
+  return ptr;
+}
+
+bool Sct_Reader::next(ctype_pin_inst* inst, const uint8_t** rec_ptr, uint32_t* static_idx) {
+  if (cur >= end)
+    return false;
+  *rec_ptr = cur;
+  memcpy(static_idx, cur + offsetof(Sct_Record, static_idx), sizeof(*static_idx));
+  cur = decode_record(cur, inst, prev_uid + 1);
+  prev_uid = inst->inst_uid;
+  return true;
+}
+
+void Sct_Reader::decode(const uint8_t* rec_ptr, ctype_pin_inst* inst) const {
+  decode_record(rec_ptr, inst, 0);
+}
+
+bool Sct_Reader::skip(uint64_t count, bool fetched) {
+  if (!count)
+    return true;
+  if (!header->num_index)
+    return false;
+
+  // last index entry at or before the target
+  uint64_t entry;
+  if (fetched) {
+    const Sct_Index_Entry* it = std::upper_bound(
+        index, index + header->num_index, count,
+        [](uint64_t val, const Sct_Index_Entry& e) { return val < e.num_fetched; });
+    entry = it - index - 1;
+  } else {
+    entry = std::min<uint64_t>(count / SCT_INDEX_INTERVAL, header->num_index - 1);
+  }
+  const uint8_t* base = static_cast<const uint8_t*>(map);
+  cur = base + header->dynamic_offset + index[entry].offset;
+  prev_uid = index[entry].prev_uid;
+  uint64_t done = fetched ? index[entry].num_fetched : entry * SCT_INDEX_INTERVAL;
+
+  while (done < count) {
+    if (cur >= end)
+      return false;
+    Sct_Record rec;
+    memcpy(&rec, cur, sizeof(rec));
+    if (rec.flags & SCT_INST_UID) {
+      const uint8_t* uid_ptr =
+          cur + sizeof(rec) + sizeof(uint64_t) * (!!(rec.flags & SCT_NEXT_ADDR) + !!(rec.flags & SCT_TARGET));
+      prev_uid = sct_read_u64(&uid_ptr);
+    } else {
+      prev_uid++;
+    }
+    done += fetched ? !!(rec.flags & SCT_FETCHED) : 1;
+    cur += sizeof(rec) + sct_num_extra(rec) * sizeof(uint64_t);
+  }
+  return true;
+}
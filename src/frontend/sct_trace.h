@@ -0,0 +1,149 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : frontend/sct_trace.h
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : Scarab compact trace (.sct): a pre-decoded, mmap-able trace.
+ *
+ * Layout: a Sct_Header, then the dynamic stream, the static table and the index.
+ * The static table holds one ctype_pin_inst per distinct instruction
+ * (deduplicated by PC, encoding and decoded fields) with its dynamic fields
+ * cleared. Each dynamic record is a Sct_Record followed by the optional 64-bit
+ * fields named in its flags and then the load and store addresses. The index
+ * holds one Sct_Index_Entry every SCT_INDEX_INTERVAL records, so a reader can
+ * seek into the stream without decoding what it skips.
+ ***************************************************************************************/
+
+#ifndef __SCT_TRACE_H__
+#define __SCT_TRACE_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ctype_pin_inst.h"
+
+#define SCT_MAGIC "SCARSCT"
+#define SCT_VERSION 2
+#define SCT_INDEX_INTERVAL 65536
+
+typedef struct Sct_Header_struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t inst_size;  // sizeof(ctype_pin_inst) of the writer
+  uint64_t num_static;
+  uint64_t static_offset;
+  uint64_t num_dynamic;
+  uint64_t dynamic_offset;
+  uint64_t dynamic_size;
+  uint64_t num_index;
+  uint64_t index_offset;
+} Sct_Header;
+
+typedef struct Sct_Index_Entry_struct {
+  uint64_t offset;       // of the record from dynamic_offset
+  uint64_t prev_uid;     // inst_uid of the record before it
+  uint64_t num_fetched;  // fetched instructions before it
+} Sct_Index_Entry;
+
+/* Sct_Record flags; fields not flagged take their default */
+#define SCT_TAKEN 0x01
+#define SCT_FETCHED 0x02
+#define SCT_LAST_INST 0x04
+#define SCT_ENCODING_NEW 0x08
+#define SCT_NEXT_ADDR 0x10   // default: instruction_addr + size
+#define SCT_TARGET 0x20      // default: instruction_next_addr
+#define SCT_INST_UID 0x40    // default: previous inst_uid + 1
+
+typedef struct Sct_Record_struct {
+  uint32_t static_idx;
+  uint8_t flags;
+  uint8_t num_ld;
+  uint8_t num_st;
+  uint8_t num_vaddrs;  // stored ld_vaddr entries | stored st_vaddr entries << 4
+} __attribute__((packed)) Sct_Record;
+
+/**************************************************************************************/
+/* Sct_Writer: builds a .sct file from a stream of on-path instructions */
+
+class Sct_Writer {
+ public:
+  explicit Sct_Writer(const char* path);
+  ~Sct_Writer();
+
+  bool ok() const { return file != nullptr; }
+  void add(const ctype_pin_inst* inst);
+  // Appends the static table and the final header
+  void finish();
+
+  uint64_t num_dynamic() const { return header.num_dynamic; }
+  uint64_t num_static() const { return statics.size(); }
+
+ private:
+  FILE* file;
+  Sct_Header header;
+  uint64_t prev_uid;
+  uint64_t num_fetched;
+  std::vector<ctype_pin_inst> statics;
+  std::vector<Sct_Index_Entry> index;
+  std::unordered_map<std::string, uint32_t> static_ids;
+};
+
+/**************************************************************************************/
+/* Sct_Reader: replays a .sct file from a read-only mapping */
+
+class Sct_Reader {
+ public:
+  Sct_Reader();
+  ~Sct_Reader();
+
+  bool open(const char* path);
+  /* Fills inst with the next dynamic instruction and reports where its record
+     and static entry are; returns false at the end of the trace */
+  bool next(ctype_pin_inst* inst, const uint8_t** rec_ptr, uint32_t* static_idx);
+  // Rebuilds the instruction of an earlier record (inst_uid is not recovered)
+  void decode(const uint8_t* rec_ptr, ctype_pin_inst* inst) const;
+  /* Moves past the first count instructions (fetched instructions if fetched
+     is set) through the index, without decoding; returns false if the trace is
+     shorter. Only valid before the first next() */
+  bool skip(uint64_t count, bool fetched);
+
+  uint64_t num_static() const { return header ? header->num_static : 0; }
+  const ctype_pin_inst* static_inst(uint32_t idx) const { return &statics[idx]; }
+
+ private:
+  const uint8_t* decode_record(const uint8_t* rec_ptr, ctype_pin_inst* inst, uint64_t uid) const;
+
+  void* map;
+  size_t map_size;
+  const Sct_Header* header;
+  const ctype_pin_inst* statics;
+  const Sct_Index_Entry* index;
+  const uint8_t* cur;
+  const uint8_t* end;
+  uint64_t prev_uid;
+};
+
+#endif
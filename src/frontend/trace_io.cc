@@ -0,0 +1,373 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : frontend/trace_io.cc
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Trace file I/O for network storage: large aligned block reads,
+ *                readahead hints, optional O_DIRECT and a node-local trace cache.
+ ***************************************************************************************/
+
+/* The PIN and PT trace streams open their file through trace_io_open, a stdio FILE
+   whose reads are served from a TRACE_IO_BLOCK_SIZE buffer. The buffer is refilled
+   with one pread of the whole block at an aligned offset, and the kernel is asked to
+   read TRACE_IO_READAHEAD bytes past it, so NFS and Lustre see few large sequential
+   reads instead of the small ones of the decompressors. TRACE_IO_DIRECT bypasses the
+   page cache, for traces read once.
+
+   With TRACE_IO_CACHE_DIR, a trace is first copied to
+   <dir>/<hash of its real path>-<size>-<mtime>-<name>, and every later run on the node
+   reads the copy; a changed trace gets a new name. A copy is made under a temporary name
+   and renamed, so concurrent runs never read a partial one. Past TRACE_IO_CACHE_GB, the
+   least recently used copies are removed. The sct and memtrace frontends read the
+   copy too (trace_io_local_path), through their own readers.
+
+   The counters are shared by every trace and land in the stats of core 0. */
+
+#include "frontend/trace_io.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "frontend/pin_trace_stream.h"
+
+extern "C" {
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "general.param.h"
+
+#include "statistics.h"
+}
+
+#define TRACE_IO_ALIGN 4096
+
+/**************************************************************************************/
+/* Types */
+
+struct Trace_Io_File {
+  int fd;
+  char* buf;
+  size_t pos;     // next byte of buf to return
+  size_t end;     // valid bytes in buf
+  off64_t off;    // file offset of buf[0]
+  off64_t size;
+};
+
+/**************************************************************************************/
+/* Global Variables */
+
+static std::atomic<uint64_t> io_bytes(0);
+static std::atomic<uint64_t> io_reads(0);
+static std::atomic<uint64_t> io_read_ns(0);
+static std::atomic<uint64_t> io_cache_hits(0);
+static std::atomic<uint64_t> io_cache_misses(0);
+static std::atomic<uint64_t> io_cache_fill_ns(0);
+static std::unordered_map<std::string, std::string> local_paths;
+static std::mutex local_paths_lock;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static ssize_t trace_io_read(void* cookie, char* dst, size_t size);
+static int trace_io_seek(void* cookie, off64_t* offset, int whence);
+static int trace_io_close(void* cookie);
+
+/**************************************************************************************/
+/* trace_io_ns: */
+
+static inline uint64_t trace_io_ns(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**************************************************************************************/
+/* trace_io_init: */
+
+void trace_io_init(void) {
+  ASSERTM(0, TRACE_IO_BLOCK_SIZE && TRACE_IO_BLOCK_SIZE % TRACE_IO_ALIGN == 0,
+          "TRACE_IO_BLOCK_SIZE must be a multiple of %d\n", TRACE_IO_ALIGN);
+  Pin_Trace_Stream::set_open_func(trace_io_open);
+}
+
+/**************************************************************************************/
+/* trace_io_fill: reads the block after the buffered one. With O_DIRECT, a filesystem
+   that refuses it (tmpfs, some FUSE) is read through the page cache instead. */
+
+static void trace_io_fill(Trace_Io_File* file) {
+  file->off += file->end;
+  file->pos = file->end = 0;
+  uint64_t start = trace_io_ns();
+  ssize_t n = pread64(file->fd, file->buf, TRACE_IO_BLOCK_SIZE, file->off);
+  if (n < 0 && errno == EINVAL && (fcntl(file->fd, F_GETFL) & O_DIRECT)) {
+    fcntl(file->fd, F_SETFL, fcntl(file->fd, F_GETFL) & ~O_DIRECT);
+    n = pread64(file->fd, file->buf, TRACE_IO_BLOCK_SIZE, file->off);
+  }
+  io_read_ns += trace_io_ns() - start;
+  io_reads++;
+  if (n <= 0)
+    return;
+  file->end = n;
+  io_bytes += n;
+  if (TRACE_IO_READAHEAD && file->off + n < file->size)
+    posix_fadvise(file->fd, file->off + n, TRACE_IO_READAHEAD, POSIX_FADV_WILLNEED);
+}
+
+/**************************************************************************************/
+/* trace_io_read: */
+
+static ssize_t trace_io_read(void* cookie, char* dst, size_t size) {
+  Trace_Io_File* file = static_cast<Trace_Io_File*>(cookie);
+  size_t done = 0;
+  while (done < size) {
+    if (file->pos == file->end) {
+      trace_io_fill(file);
+      if (!file->end)
+        break;
+    }
+    size_t n = std::min(size - done, file->end - file->pos);
+    memcpy(dst + done, file->buf + file->pos, n);
+    file->pos += n;
+    done += n;
+  }
+  return done;
+}
+
+/**************************************************************************************/
+/* trace_io_seek: reads the aligned block holding the new position unless it is
+   already buffered */
+
+static int trace_io_seek(void* cookie, off64_t* offset, int whence) {
+  Trace_Io_File* file = static_cast<Trace_Io_File*>(cookie);
+  off64_t target = *offset;
+  if (whence == SEEK_CUR)
+    target += file->off + file->pos;
+  else if (whence == SEEK_END)
+    target += file->size;
+  if (target < 0)
+    return -1;
+
+  if (target < file->off || target > file->off + (off64_t)file->end) {
+    file->off = target & ~(off64_t)(TRACE_IO_ALIGN - 1);
+    file->end = 0;
+    trace_io_fill(file);
+  }
+  file->pos = std::min((size_t)(target - file->off), file->end);
+  *offset = target;
+  return 0;
+}
+
+/**************************************************************************************/
+/* trace_io_close: */
+
+static int trace_io_close(void* cookie) {
+  Trace_Io_File* file = static_cast<Trace_Io_File*>(cookie);
+  int ret = close(file->fd);
+  free(file->buf);
+  delete file;
+  return ret;
+}
+
+/**************************************************************************************/
+/* trace_io_open: */
+
+FILE* trace_io_open(const char* name) {
+  const char* path = trace_io_local_path(name);
+  int fd = open(path, O_RDONLY | (TRACE_IO_DIRECT ? O_DIRECT : 0));
+  if (fd < 0 && TRACE_IO_DIRECT)
+    fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  struct stat st;
+  Trace_Io_File* file = new Trace_Io_File();
+  file->fd = fd;
+  file->size = fstat(fd, &st) ? 0 : st.st_size;
+  if (posix_memalign((void**)&file->buf, TRACE_IO_ALIGN, TRACE_IO_BLOCK_SIZE)) {
+    close(fd);
+    delete file;
+    return NULL;
+  }
+
+  cookie_io_functions_t funcs = {trace_io_read, NULL, trace_io_seek, trace_io_close};
+  FILE* fp = fopencookie(file, "rb", funcs);
+  if (!fp) {
+    trace_io_close(file);
+    return NULL;
+  }
+  /* the block buffer is the only buffer, so reads of the decoders are not copied twice */
+  setvbuf(fp, NULL, _IONBF, 0);
+  return fp;
+}
+
+/**************************************************************************************/
+/* trace_io_copy: copies from to to through a temporary file */
+
+static bool trace_io_copy(const char* from, const std::string& to) {
+  int in = open(from, O_RDONLY);
+  if (in < 0)
+    return false;
+  posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+  std::string tmp = to + ".tmp" + std::to_string(getpid());
+  int out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  bool ok = out >= 0;
+
+  std::vector<char> buf(TRACE_IO_BLOCK_SIZE);
+  ssize_t len = 0;
+  while (ok && (len = read(in, buf.data(), buf.size())) > 0)
+    ok = write(out, buf.data(), len) == len;
+  ok &= len == 0;
+  close(in);
+  if (out >= 0)
+    ok &= !close(out);
+  if (!ok || rename(tmp.c_str(), to.c_str())) {
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************************/
+/* trace_io_cache_evict: removes the least recently used copies until need more bytes
+   fit in TRACE_IO_CACHE_GB */
+
+static void trace_io_cache_evict(uint64_t need) {
+  struct Entry {
+    std::string path;
+    uint64_t size;
+    time_t used;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+  DIR* dir = opendir(TRACE_IO_CACHE_DIR);
+  if (!dir)
+    return;
+  for (struct dirent* ent = readdir(dir); ent; ent = readdir(dir)) {
+    std::string path = std::string(TRACE_IO_CACHE_DIR) + "/" + ent->d_name;
+    struct stat st;
+    if (ent->d_name[0] == '.' || strstr(ent->d_name, ".tmp") || stat(path.c_str(), &st) || !S_ISREG(st.st_mode))
+      continue;
+    entries.push_back({path, (uint64_t)st.st_size, st.st_mtime});
+    total += st.st_size;
+  }
+  closedir(dir);
+
+  uint64_t cap = (uint64_t)TRACE_IO_CACHE_GB << 30;
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+  for (const Entry& entry : entries) {
+    if (total + need <= cap)
+      break;
+    if (!unlink(entry.path.c_str()))
+      total -= entry.size;
+  }
+}
+
+/**************************************************************************************/
+/* trace_io_local_path: */
+
+const char* trace_io_local_path(const char* name) {
+  struct stat st;
+  if (!TRACE_IO_CACHE_DIR || stat(name, &st) || !S_ISREG(st.st_mode))
+    return name;
+  std::lock_guard<std::mutex> guard(local_paths_lock);
+  auto it = local_paths.find(name);
+  if (it != local_paths.end())
+    return it->second.c_str();
+
+  /* FNV-1a of the real path, so that relative paths to one trace share the copy */
+  char* real = realpath(name, NULL);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char* c = real ? real : name; *c; c++)
+    hash = (hash ^ (uint8_t)*c) * 0x100000001b3ULL;
+  free(real);
+  const char* base = strrchr(name, '/');
+  char key[MAX_STR_LENGTH + 1];
+  snprintf(key, MAX_STR_LENGTH, "%s/%016llx-%lld-%lld-%s", TRACE_IO_CACHE_DIR, (unsigned long long)hash,
+           (long long)st.st_size, (long long)st.st_mtime, base ? base + 1 : name);
+  std::string local = key;
+
+  struct stat local_st;
+  if (!stat(local.c_str(), &local_st) && local_st.st_size == st.st_size) {
+    io_cache_hits++;
+    utimensat(AT_FDCWD, local.c_str(), NULL, 0); /* most recently used */
+  } else {
+    io_cache_misses++;
+    uint64_t start = trace_io_ns();
+    if (mkdir(TRACE_IO_CACHE_DIR, 0777) && errno != EEXIST)
+      local = name;
+    else {
+      trace_io_cache_evict(st.st_size);
+      if (!trace_io_copy(name, local))
+        local = name;
+    }
+    io_cache_fill_ns += trace_io_ns() - start;
+    if (local == name)
+      fprintf(mystdout, "** Trace I/O: could not cache %s in %s, reading it in place\n", name, TRACE_IO_CACHE_DIR);
+  }
+  return local_paths.emplace(name, local).first->second.c_str();
+}
+
+/**************************************************************************************/
+/* trace_io_take_us: whole microseconds of ns, the rest stays for the next flush */
+
+static uint64_t trace_io_take_us(std::atomic<uint64_t>& ns) {
+  uint64_t us = ns.load() / 1000;
+  ns -= us * 1000;
+  return us;
+}
+
+/**************************************************************************************/
+/* trace_io_flush_stats: */
+
+void trace_io_flush_stats(uns proc_id) {
+  static std::atomic<uint64_t> stall_ns(0);
+  if (proc_id)
+    return;
+  stall_ns += Pin_Trace_Stream::take_stall_ns();
+  INC_STAT_EVENT(0, TRACE_IO_BYTES, io_bytes.exchange(0));
+  INC_STAT_EVENT(0, TRACE_IO_READS, io_reads.exchange(0));
+  INC_STAT_EVENT(0, TRACE_IO_READ_US, trace_io_take_us(io_read_ns));
+  INC_STAT_EVENT(0, TRACE_IO_STALL_US, trace_io_take_us(stall_ns));
+  INC_STAT_EVENT(0, TRACE_IO_CACHE_HIT, io_cache_hits.exchange(0));
+  INC_STAT_EVENT(0, TRACE_IO_CACHE_MISS, io_cache_misses.exchange(0));
+  INC_STAT_EVENT(0, TRACE_IO_CACHE_FILL_US, trace_io_take_us(io_cache_fill_ns));
+}
@@ -0,0 +1,63 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : frontend/trace_io.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Trace file I/O for network storage: large aligned block reads,
+ *                readahead hints, optional O_DIRECT and a node-local trace cache.
+ ***************************************************************************************/
+
+#ifndef __TRACE_IO_H__
+#define __TRACE_IO_H__
+
+#include <stdio.h>
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Makes the PIN and PT trace streams read through trace_io_open */
+void trace_io_init(void);
+
+/* Opens a trace for reading in TRACE_IO_BLOCK_SIZE blocks; NULL if it cannot be opened */
+FILE* trace_io_open(const char* name);
+
+/* Path to read the trace from: its copy in TRACE_IO_CACHE_DIR (made on first use) or
+   name itself. The result stays valid until the end of the run. */
+const char* trace_io_local_path(const char* name);
+
+/* Adds the I/O counters since the last call to the stats (of core 0) */
+void trace_io_flush_stats(uns proc_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __TRACE_IO_H__
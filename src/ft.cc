@@ -44,14 +44,33 @@
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_DECOUPLED_FE, ##args)
 
 uint64_t FT_id_counter = 0;
+static CORE_LOCAL FT* ft_free_head = nullptr;
+
+FT* alloc_ft(uns proc_id) {
+  FT* ft = ft_free_head;
+  if (!ft)
+    return new FT(proc_id);
+  ft_free_head = ft->next_free;
+  ft->reset(proc_id);
+  return ft;
+}
+
+void free_ft(FT* ft) {
+  ft->free_ops();
+  ft->ops.clear();
+  ft->next_free = ft_free_head;
+  ft_free_head = ft;
+}
 
 /* FT member functions */
-FT::~FT() {
+void FT::free_ops() {
   ASSERT(proc_id, !ops.empty());
+  // the ops to free are packed to the front of ops and returned to the pool together
+  uns num = 0;
   for (auto ft_op : ops) {
     if (!ft_op->parent_FT_off_path || ft_op->off_path) {
       ft_op->parent_FT = nullptr;
-      free_op(ft_op);
+      ops[num++] = ft_op;
     }
     if (ft_op->parent_FT_off_path) {
       ASSERT(proc_id, !ft_op->off_path);
@@ -59,9 +78,16 @@ FT::~FT() {
       ft_op->parent_FT_off_path = nullptr;
     }
   }
+  ::free_ops(ops.data(), num);
 }
 
-FT::FT(uns _proc_id) : proc_id(_proc_id) {
+FT::FT(uns _proc_id) : next_free(nullptr) {
+  reset(_proc_id);
+}
+
+void FT::reset(uns _proc_id) {
+  ASSERT(_proc_id, ops.empty());
+  proc_id = _proc_id;
   ft_info.dynamic_info.FT_id = FT_id_counter++;
   op_pos = 0;
   ft_info.static_info.start = 0;
@@ -69,6 +95,8 @@ FT::FT(uns _proc_id) : proc_id(_proc_id) {
   ft_info.static_info.n_uops = 0;
   ft_info.dynamic_info.ended_by = FT_NOT_ENDED;
   ft_info.dynamic_info.first_op_off_path = FALSE;
+  ft_info.dynamic_info.contains_fake_nop = FALSE;
+  next_free = nullptr;
 }
 
 bool FT::can_fetch_op() {
@@ -104,7 +132,7 @@ Flag FT::build(std::function<bool(uns8)> can_fetch_op_fn, std::function<bool(uns
   do {
     if (!can_fetch_op_fn(proc_id)) {
       std::cout << "Warning could not fetch inst from frontend" << std::endl;
-      delete this;
+      free_ft(this);
       return false;
     }
     Op* op = alloc_op(proc_id);
@@ -188,7 +216,7 @@ std::pair<FT*, FT*> FT::extract_off_path_ft(uns split_index) {
     return {this, nullptr};
   }
   // Initialize off-path FT that will contain off-path ops after split position
-  FT* off_path_ft = new FT(proc_id);
+  FT* off_path_ft = alloc_ft(proc_id);
 
   bool has_trailing_ops = (index_uns + 1 < ops.size());
 
@@ -223,6 +251,7 @@ FT_Event FT::predict_one_cf_op(Op* op) {
 #ifdef ENABLE_PT_MEMTRACE
   trace_mode |= (FRONTEND == FE_PT || FRONTEND == FE_MEMTRACE);
 #endif
+  trace_mode |= (FRONTEND == FE_SCT);
   if (op->table_info->cf_type) {
     ASSERT(proc_id, op->eom);
     bp_predict_op(g_bp_data, op, 1, op->inst_info->addr);
@@ -341,11 +370,15 @@ FT_Ended_By FT::get_end_reason() const {
   }
 
   Op* op = ops.back();  // Get the last op
+  return ft_op_end_reason(op, op->oracle_info.pred == TAKEN);
+}
+
+FT_Ended_By ft_op_end_reason(const Op* op, Flag taken) {
   if (op->eom) {
     uns offset = ADDR_PLUS_OFFSET(op->inst_info->addr, op->inst_info->trace_info.inst_size) -
                  ROUND_DOWN(op->inst_info->addr, ICACHE_LINE_SIZE);
     bool end_of_icache_line = offset >= ICACHE_LINE_SIZE;
-    bool cf_taken = (op->table_info->cf_type && op->oracle_info.pred == TAKEN);
+    bool cf_taken = (op->table_info->cf_type && taken);
     bool bar_fetch = IS_CALLSYS(op->table_info) || op->table_info->bar_type & BAR_FETCH;
 
     if (op->exit) {
@@ -386,7 +419,7 @@ void FT::clear_recovery_info() {
 }
 
 // generate_uop_cache_data was moved to uop_cache.cc as
-// generate_uop_cache_data_from_FT(FT*, std::vector<Uop_Cache_Data>&)
+// generate_uop_cache_data_from_FT(FT*, Uop_Cache_FT_Lines*)
 // to keep FT class focused on FT semantics. Implementation lives in
 // uop_cache.cc and is declared a friend of FT (see ft.h).
 
@@ -407,7 +440,7 @@ FT_Info ft_get_ft_info(FT* ft) {
 void ft_free_op(Op* op) {
   ASSERT(0, op->parent_FT);
   if (op->parent_FT_off_path && op->parent_FT_off_path->get_last_op() == op)
-    delete op->parent_FT_off_path;
+    free_ft(op->parent_FT_off_path);
   if (!op->parent_FT_off_path && op->parent_FT->get_last_op() == op)
-    delete op->parent_FT;
+    free_ft(op->parent_FT);
 }
\ No newline at end of file
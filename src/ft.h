@@ -46,6 +46,9 @@ bool ft_can_fetch_op(FT* ft);
 Op* ft_fetch_op(FT* ft);
 FT_Info ft_get_ft_info(FT* ft);
 void ft_free_op(Op* op);
+/* the reason an FT whose last op is op ends (FT_NOT_ENDED if the FT goes on), with the op's branch followed in the
+   direction taken */
+FT_Ended_By ft_op_end_reason(const Op* op, Flag taken);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -81,16 +84,18 @@ struct FT_PredictResult {
 class FT {
  public:
   FT(uns _proc_id = 0);
-  ~FT();
+  FT(const FT&) = delete;
+  FT& operator=(const FT&) = delete;
   void add_op(Op* op);
   bool can_fetch_op();
   Op* fetch_op();
   FT_Info get_ft_info() const;
 
   std::vector<Op*>& get_ops();
+  const std::vector<Op*>& get_ops() const { return ops; }
 
   /* kept as friend so that it can access FT internals like ops and op_pos */
-  friend void generate_uop_cache_data_from_FT(FT* ft, std::vector<Uop_Cache_Data>& out);
+  friend void generate_uop_cache_data_from_FT(FT* ft, Uop_Cache_FT_Lines* out);
 
   // Change return type to FT_BuildResult
   Flag build(std::function<bool(uns8)> can_fetch_op_fn, std::function<bool(uns8, Op*)> fetch_op_fn, bool off_path,
@@ -118,11 +123,23 @@ class FT {
   uint64_t op_pos;
   FT_Info ft_info;
   std::vector<Op*> ops;
+  // next FT on the free list while this FT is not in use
+  FT* next_free;
   FT_Event predict_one_cf_op(Op* op);
   void generate_ft_info();
+  void reset(uns _proc_id);
+  void free_ops();  // leaves ops clobbered, free_ft clears it
   friend class Decoupled_FE;
+  friend FT* alloc_ft(uns proc_id);
+  friend void free_ft(FT* ft);
 };
 
+/* FTs are recycled through a per host thread free list, like ops in op_pool.c, so building, popping and flushing
+   FTs does not touch the heap once the list is warm. A recycled FT keeps the capacity of its ops vector. */
+FT* alloc_ft(uns proc_id = 0);
+/* frees the ops the FT owns and returns it to the free list */
+void free_ft(FT* ft);
+
 #endif  // __cplusplus
 
 #endif  // __FT_H__
\ No newline at end of file
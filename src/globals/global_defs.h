@@ -46,7 +46,15 @@
 #define TAKEN 1
 #define NOT_TAKEN 0
 
-#define MAX_NUM_PROCS 64
+#define MAX_NUM_PROCS 256
+/* cores with their own numbered params (cbp_trace_rN, core_N_cycle_time) */
+#define MAX_NUM_PROC_PARAMS 64
+
+/* The proc_id is kept in the top bits of every simulated address (see
+   convert_to_cmp_addr), enough of them for MAX_NUM_PROCS cores */
+#define CMP_ADDR_PROC_ID_BITS 8
+#define CMP_ADDR_PROC_ID_SHIFT (64 - CMP_ADDR_PROC_ID_BITS)
+#define CMP_ADDR_MASK (((uns64)-1) << CMP_ADDR_PROC_ID_SHIFT)
 
 #define MAX_STR_LENGTH 1024
 #define MAX_SIMULTANEOUS_STRINGS 32 /* default 32 */ /* power of 2 */
@@ -63,6 +71,11 @@
 #undef UNUSED
 #define UNUSED(X) (void)(X)
 
+/* Storage class for the "current core" globals (stage pointers, cycle_count,
+   sim_time, ...) that cmp_set_all_stages swaps in.  Each parallel core worker
+   (see PARALLEL_CORES and PARALLEL_WARMUP) sees its own copy. */
+#define CORE_LOCAL __thread
+
 /**************************************************************************************/
 
 #ifndef NULL
@@ -37,6 +37,7 @@ source file. Be really careful about putting stuff in here.  You don't want to
 /* Forward declarations of typedefs. They are in this file to avoid
    typedef re-definition. Typedef re-definition is actually OK in gcc 4.4+,
    but since the base HPS gcc is only 4.1.2, we are using this solution. */
+typedef struct Core_Context_struct Core_Context;
 typedef struct Inst_Info_struct Inst_Info;
 typedef struct Mem_Req_struct Mem_Req;
 typedef struct Op_Info_struct Op_Info;
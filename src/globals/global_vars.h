@@ -46,8 +46,8 @@ extern Counter* unique_count_per_core;
 extern Counter* op_count;
 extern Counter* inst_count;
 extern Counter* inst_count_fetched;
-extern Counter cycle_count;
-extern Counter sim_time;
+extern CORE_LOCAL Counter cycle_count;
+extern CORE_LOCAL Counter sim_time;
 extern Counter* uop_count;
 extern Counter* pret_inst_count;
 extern uns operating_mode;
@@ -38,7 +38,6 @@
 #include "core.param.h"
 #include "general.param.h"
 
-#define CMP_ADDR_MASK (((Addr) - 1) << 58)
 /**************************************************************************************/
 /* breakpoint: A function to help debugging. */
 
@@ -662,25 +661,6 @@ Flag is_power_of_2(uns64 x) {
   return (x != 0) && ((x & (x - 1)) == 0);
 }
 
-/**************************************************************************************/
-/* convert_to_cmp_addr */
-
-Addr convert_to_cmp_addr(uns8 proc_id, Addr addr) {
-  if ((addr & CMP_ADDR_MASK)) {
-    addr = addr & ~CMP_ADDR_MASK;
-  }
-
-  return addr | (((Addr)proc_id) << 58);
-}
-
-/**************************************************************************************/
-/* get_proc_id_from_cmp_addr */
-
-uns get_proc_id_from_cmp_addr(Addr addr) {
-  uns proc_id = addr >> 58;
-  return proc_id;
-}
-
 /**************************************************************************************/
 /* check_and_remove_addr_sign_extended_bits */
 
@@ -301,6 +301,21 @@ extern "C" {
   ASSERTM(proc_id, proc_id == get_proc_id_from_cmp_addr(addr), \
           "Proc ID (%d) does not match proc ID in address (%d)!\n", proc_id, get_proc_id_from_cmp_addr(addr));
 
+/**************************************************************************************/
+/* convert_to_cmp_addr: puts proc_id in the top bits of addr. Inline, so the shifts fold
+   away when proc_id is a constant (as in single-core SCARAB_NUM_CORES builds). */
+
+static inline Addr convert_to_cmp_addr(uns8 proc_id, Addr addr) {
+  return (addr & ~CMP_ADDR_MASK) | (((Addr)proc_id) << CMP_ADDR_PROC_ID_SHIFT);
+}
+
+/**************************************************************************************/
+/* get_proc_id_from_cmp_addr */
+
+static inline uns get_proc_id_from_cmp_addr(Addr addr) {
+  return addr >> CMP_ADDR_PROC_ID_SHIFT;
+}
+
 /**************************************************************************************/
 /* Prototypes for functions in globals/utils.c */
 
@@ -326,8 +341,6 @@ FILE* file_tag_fopen(char const* const, char const* const, char const* const);
 uns factorial(uns);
 Flag similar(float, float, float);
 Flag is_power_of_2(uns64);
-Addr convert_to_cmp_addr(uns8 proc_id, Addr addr);
-uns get_proc_id_from_cmp_addr(Addr addr);
 Addr check_and_remove_addr_sign_extended_bits(Addr virt_addr, uns num_non_sign_extended_bits,
                                               Flag verify_bits_masked_out);
 int parse_int_array(int dest[], const void* str, int max_num);
@@ -0,0 +1,441 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : host_placement.c
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Placement of the simulator threads on the host (HOST_PLACEMENT).
+ *
+ * The CPUs the process may run on are grouped into physical cores (SMT siblings)
+ * and NUMA nodes from sysfs, and the physical cores are ordered into slots:
+ * 'compact' fills one NUMA node before the next, 'scatter' alternates between
+ * nodes.  Slot 0 runs the main thread and slot 1 + n the simulation thread of core
+ * n, whose trace reading threads go on the SMT siblings of the slot.  The memory a
+ * thread touches first lands on its node, so the per-core tables and op pool slabs
+ * the core threads allocate stay local to them.
+ ***************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "host_placement.h"
+
+#include <dirent.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "general.param.h"
+
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define HOST_SMT_MAX 8
+#define HOST_PLACEMENT_LINE_BYTES 64
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Host_Core_struct {
+  int package;
+  int core_id;
+  int node;
+  int cpus[HOST_SMT_MAX];
+  uns num_cpus;
+} Host_Core;
+
+typedef struct Host_Thread_struct {
+  int cpu; /* -1: not pinned */
+  int node;
+  Flag helpers; /* trace reading threads were placed */
+  cpu_set_t helper_cpus;
+} Host_Thread;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Flag host_on = FALSE;
+static Host_Core* host_cores = NULL;
+static uns host_num_cores = 0;
+static uns host_num_cpus = 0;
+static uns host_num_nodes = 0;
+static Host_Thread host_main;
+static Host_Thread host_threads[MAX_NUM_PROCS];
+static __thread cpu_set_t host_saved_cpus; /* of the thread between helpers_begin and helpers_end */
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static int host_read_int(const char* path, int dflt);
+static void host_parse_cpulist(const char* list, cpu_set_t* set);
+static void host_print_cpulist(FILE* file, const cpu_set_t* set);
+static int host_cmp_compact(const void* a, const void* b);
+static Host_Core* host_slot(uns slot);
+static void host_node_cpus(int node, cpu_set_t* set);
+static void host_helper_cpus(uns proc_id, cpu_set_t* set);
+static void host_set_affinity(const cpu_set_t* set, const char* who);
+
+/**************************************************************************************/
+/* host_read_int: */
+
+static int host_read_int(const char* path, int dflt) {
+  FILE* file = fopen(path, "r");
+  int value = dflt;
+  if (file) {
+    if (fscanf(file, "%d", &value) != 1)
+      value = dflt;
+    fclose(file);
+  }
+  return value;
+}
+
+/**************************************************************************************/
+/* host_parse_cpulist: sysfs lists like "0-3,8-11" */
+
+static void host_parse_cpulist(const char* list, cpu_set_t* set) {
+  const char* pos = list;
+  CPU_ZERO(set);
+  while (*pos) {
+    char* end;
+    long first = strtol(pos, &end, 10);
+    long last = first;
+    if (end == pos)
+      break;
+    if (*end == '-')
+      last = strtol(end + 1, &end, 10);
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+      CPU_SET(cpu, set);
+    pos = end + (*end == ',');
+    if (*end != ',')
+      break;
+  }
+}
+
+/**************************************************************************************/
+/* host_print_cpulist: */
+
+static void host_print_cpulist(FILE* file, const cpu_set_t* set) {
+  const char* sep = "";
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    int last = cpu;
+    if (!CPU_ISSET(cpu, set))
+      continue;
+    while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, set))
+      last++;
+    if (last > cpu)
+      fprintf(file, "%s%d-%d", sep, cpu, last);
+    else
+      fprintf(file, "%s%d", sep, cpu);
+    sep = ",";
+    cpu = last;
+  }
+  if (!*sep)
+    fprintf(file, "-");
+}
+
+/**************************************************************************************/
+/* host_cmp_compact: */
+
+static int host_cmp_compact(const void* a, const void* b) {
+  const Host_Core* x = (const Host_Core*)a;
+  const Host_Core* y = (const Host_Core*)b;
+  if (x->node != y->node)
+    return x->node - y->node;
+  if (x->package != y->package)
+    return x->package - y->package;
+  if (x->core_id != y->core_id)
+    return x->core_id - y->core_id;
+  return x->cpus[0] - y->cpus[0];
+}
+
+/**************************************************************************************/
+/* host_slot: more threads than physical cores share them round robin */
+
+static Host_Core* host_slot(uns slot) {
+  return &host_cores[slot % host_num_cores];
+}
+
+/**************************************************************************************/
+/* host_node_cpus: the CPUs of node the process may run on */
+
+static void host_node_cpus(int node, cpu_set_t* set) {
+  CPU_ZERO(set);
+  for (uns ii = 0; ii < host_num_cores; ii++) {
+    if (host_cores[ii].node != node)
+      continue;
+    for (uns jj = 0; jj < host_cores[ii].num_cpus; jj++)
+      CPU_SET(host_cores[ii].cpus[jj], set);
+  }
+}
+
+/**************************************************************************************/
+/* host_helper_cpus: the SMT siblings of the core thread's CPU, or its node */
+
+static void host_helper_cpus(uns proc_id, cpu_set_t* set) {
+  Host_Thread* thread = &host_threads[proc_id];
+  Host_Core* slot = host_slot(1 + proc_id);
+  CPU_ZERO(set);
+  for (uns ii = 1; ii < slot->num_cpus; ii++)
+    CPU_SET(slot->cpus[ii], set);
+  if (!CPU_COUNT(set))
+    host_node_cpus(slot->node, set);
+  thread->helpers = TRUE;
+  thread->helper_cpus = *set;
+}
+
+/**************************************************************************************/
+/* host_set_affinity: placement is a hint, a failure only costs performance */
+
+static void host_set_affinity(const cpu_set_t* set, const char* who) {
+  if (sched_setaffinity(0, sizeof(cpu_set_t), set))
+    WARNING(0, "HOST_PLACEMENT: could not pin the %s thread\n", who);
+}
+
+/**************************************************************************************/
+/* host_placement_init: */
+
+void host_placement_init(void) {
+  cpu_set_t allowed;
+  int cpu_node[CPU_SETSIZE];
+  char path[MAX_STR_LENGTH + 1];
+
+  host_main.cpu = -1;
+  for (uns proc_id = 0; proc_id < MAX_NUM_PROCS; proc_id++)
+    host_threads[proc_id].cpu = -1;
+  if (!HOST_PLACEMENT || !strcmp(HOST_PLACEMENT, "none"))
+    return;
+  ASSERTM(0, !strcmp(HOST_PLACEMENT, "compact") || !strcmp(HOST_PLACEMENT, "scatter"),
+          "HOST_PLACEMENT must be none, compact or scatter, not %s\n", HOST_PLACEMENT);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed)) {
+    WARNING(0, "HOST_PLACEMENT: could not read the CPUs the simulator may use\n");
+    return;
+  }
+
+  /* NUMA nodes (a kernel without NUMA has no node directory: one node) */
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    cpu_node[cpu] = 0;
+  DIR* dir = opendir("/sys/devices/system/node");
+  if (dir) {
+    struct dirent* entry;
+    while ((entry = readdir(dir))) {
+      char list[4096];
+      cpu_set_t node_cpus;
+      int node;
+      if (sscanf(entry->d_name, "node%d", &node) != 1 || node < 0 || node >= CPU_SETSIZE)
+        continue;
+      snprintf(path, MAX_STR_LENGTH, "/sys/devices/system/node/%s/cpulist", entry->d_name);
+      FILE* file = fopen(path, "r");
+      if (!file)
+        continue;
+      if (fgets(list, sizeof(list), file)) {
+        host_parse_cpulist(list, &node_cpus);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+          if (CPU_ISSET(cpu, &node_cpus))
+            cpu_node[cpu] = node;
+      }
+      fclose(file);
+    }
+    closedir(dir);
+  }
+
+  /* physical cores: the allowed CPUs with the same package and core id */
+  host_cores = (Host_Core*)calloc(CPU_COUNT(&allowed), sizeof(Host_Core));
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, &allowed))
+      continue;
+    snprintf(path, MAX_STR_LENGTH, "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    int package = host_read_int(path, 0);
+    snprintf(path, MAX_STR_LENGTH, "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+    int core_id = host_read_int(path, cpu);
+    uns ii;
+    for (ii = 0; ii < host_num_cores; ii++)
+      if (host_cores[ii].package == package && host_cores[ii].core_id == core_id &&
+          host_cores[ii].node == cpu_node[cpu])
+        break;
+    if (ii == host_num_cores) {
+      host_cores[ii].package = package;
+      host_cores[ii].core_id = core_id;
+      host_cores[ii].node = cpu_node[cpu];
+      host_num_cores++;
+    }
+    if (host_cores[ii].num_cpus < HOST_SMT_MAX)
+      host_cores[ii].cpus[host_cores[ii].num_cpus++] = cpu;
+    host_num_cpus++;
+  }
+  ASSERT(0, host_num_cores > 0);
+  qsort(host_cores, host_num_cores, sizeof(Host_Core), host_cmp_compact);
+  for (uns ii = 0; ii < host_num_cores; ii++)
+    host_num_nodes += !ii || host_cores[ii].node != host_cores[ii - 1].node;
+
+  /* scatter: the first physical core of every node, then the second, ... */
+  if (!strcmp(HOST_PLACEMENT, "scatter") && host_num_nodes > 1) {
+    Host_Core* order = (Host_Core*)malloc(host_num_cores * sizeof(Host_Core));
+    uns num = 0;
+    for (uns rank = 0; num < host_num_cores; rank++) {
+      uns first = 0;
+      for (uns ii = 0; ii <= host_num_cores; ii++) {
+        if (ii < host_num_cores && host_cores[ii].node == host_cores[first].node)
+          continue;
+        if (first + rank < ii)
+          order[num++] = host_cores[first + rank];
+        first = ii;
+      }
+    }
+    free(host_cores);
+    host_cores = order;
+  }
+  host_on = TRUE;
+
+  Host_Core* slot = host_slot(0);
+  host_node_cpus(slot->node, &host_main.helper_cpus);
+  host_main.node = slot->node;
+  host_set_affinity(&host_main.helper_cpus, "main");
+}
+
+/**************************************************************************************/
+/* host_placement_pin_main: */
+
+void host_placement_pin_main(void) {
+  cpu_set_t set;
+  if (!host_on)
+    return;
+  host_main.cpu = host_slot(0)->cpus[0];
+  CPU_ZERO(&set);
+  CPU_SET(host_main.cpu, &set);
+  host_set_affinity(&set, "main");
+}
+
+/**************************************************************************************/
+/* host_placement_pin_core: */
+
+void host_placement_pin_core(uns proc_id) {
+  Host_Thread* thread = &host_threads[proc_id];
+  cpu_set_t set;
+  if (!host_on)
+    return;
+  Host_Core* slot = host_slot(1 + proc_id);
+  thread->cpu = slot->cpus[0];
+  thread->node = slot->node;
+  CPU_ZERO(&set);
+  CPU_SET(thread->cpu, &set);
+  host_set_affinity(&set, "core");
+}
+
+/**************************************************************************************/
+/* host_placement_pin_helper: */
+
+void host_placement_pin_helper(uns proc_id) {
+  cpu_set_t set;
+  if (!host_on)
+    return;
+  host_helper_cpus(proc_id, &set);
+  host_set_affinity(&set, "trace reader");
+}
+
+/**************************************************************************************/
+/* host_placement_helpers_begin: */
+
+void host_placement_helpers_begin(uns proc_id) {
+  cpu_set_t set;
+  if (!host_on)
+    return;
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &host_saved_cpus))
+    CPU_ZERO(&host_saved_cpus);
+  host_helper_cpus(proc_id, &set);
+  host_set_affinity(&set, "trace reader");
+}
+
+/**************************************************************************************/
+/* host_placement_helpers_end: */
+
+void host_placement_helpers_end(void) {
+  if (host_on && CPU_COUNT(&host_saved_cpus))
+    host_set_affinity(&host_saved_cpus, "trace opening");
+}
+
+/**************************************************************************************/
+/* host_placement_done: a core thread on another node than the uncore (the main
+   thread) moves every L1 request across nodes, and its fill back: two lines each */
+
+void host_placement_done(void) {
+  Counter total_lines = 0;
+  if (!host_on)
+    return;
+  FILE* file = file_tag_fopen(OUTPUT_DIR, "host_placement.out", "w");
+  if (!file)
+    return;
+
+  fprintf(file, "placement %s: %u cpus, %u physical cores, %u NUMA nodes\n", HOST_PLACEMENT, host_num_cpus,
+          host_num_cores, host_num_nodes);
+  for (uns ii = 0; ii < host_num_cores; ii++) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uns jj = 0; jj < host_cores[ii].num_cpus; jj++)
+      CPU_SET(host_cores[ii].cpus[jj], &set);
+    fprintf(file, "slot %-4u node %-3d package %-3d core %-4d cpus ", ii, host_cores[ii].node,
+            host_cores[ii].package, host_cores[ii].core_id);
+    host_print_cpulist(file, &set);
+    fprintf(file, "\n");
+  }
+
+  fprintf(file, "\n%-10s %-6s %-5s %s\n", "thread", "cpu", "node", "trace readers");
+  if (host_main.cpu >= 0)
+    fprintf(file, "%-10s %-6d %-5d -\n", "main", host_main.cpu, host_main.node);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Host_Thread* thread = &host_threads[proc_id];
+    char name[16];
+    snprintf(name, sizeof(name), "core%u", proc_id);
+    if (thread->cpu >= 0)
+      fprintf(file, "%-10s %-6d %-5d ", name, thread->cpu, thread->node);
+    else
+      fprintf(file, "%-10s %-6s %-5s ", name, "main", "-");
+    if (thread->helpers)
+      host_print_cpulist(file, &thread->helper_cpus);
+    else
+      fprintf(file, "-");
+    fprintf(file, "\n");
+  }
+
+  fprintf(file, "\ncross-NUMA estimate (core <-> uncore, %u-byte lines)\n", HOST_PLACEMENT_LINE_BYTES);
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Host_Thread* thread = &host_threads[proc_id];
+    Counter accesses = GET_TOTAL_STAT_EVENT(proc_id, L1_ACCESS);
+    Counter lines = thread->cpu >= 0 && thread->node != host_main.node ? 2 * accesses : 0;
+    fprintf(file, "core%-6u l1_accesses %-12llu lines %-12llu bytes %llu\n", proc_id, accesses, lines,
+            lines * HOST_PLACEMENT_LINE_BYTES);
+    total_lines += lines;
+  }
+  fprintf(file, "%-10s %-24s lines %-12llu bytes %llu\n", "total", "", total_lines,
+          total_lines * HOST_PLACEMENT_LINE_BYTES);
+  fclose(file);
+}
@@ -0,0 +1,66 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : host_placement.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Placement of the simulator threads on the host (HOST_PLACEMENT).
+ ***************************************************************************************/
+
+#ifndef __HOST_PLACEMENT_H__
+#define __HOST_PLACEMENT_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Reads the host topology from sysfs and restricts the calling (main) thread to the
+   NUMA node of its slot, so that threads it starts before host_placement_pin_main()
+   stay on that node. */
+void host_placement_init(void);
+
+/* Pins the main thread, which runs the uncore with PARALLEL_CORES and everything
+   otherwise, to its own CPU. */
+void host_placement_pin_main(void);
+
+/* Pins the calling thread, the simulation thread of core proc_id, to its own
+   physical core. */
+void host_placement_pin_core(uns proc_id);
+
+/* Pins the calling thread, a trace reading thread of core proc_id, to the SMT
+   siblings of that core's CPU, or to its NUMA node without SMT. */
+void host_placement_pin_helper(uns proc_id);
+
+/* Brackets the opening of the trace of core proc_id: the threads the trace readers
+   start in between inherit the CPUs of host_placement_pin_helper(), without the
+   readers knowing their core. */
+void host_placement_helpers_begin(uns proc_id);
+void host_placement_helpers_end(void);
+
+/* Writes host_placement.out: the topology, where each thread ran, and an estimate of
+   the traffic between cores and the uncore that crossed NUMA nodes. */
+void host_placement_done(void);
+
+#endif /* #ifndef __HOST_PLACEMENT_H__ */
@@ -39,6 +39,7 @@
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/pc_prof.h"
 
 #include "bp/bp.param.h"
 #include "core.param.h"
@@ -46,25 +47,28 @@
 #include "prefetcher/pref.param.h"
 
 #include "bp/bp.h"
+#include "bp/bp_targ_mech.h"
 #include "frontend/frontend.h"
 #include "frontend/pin_trace_fe.h"
 #include "libs/list_lib.h"
 #include "memory/memory.h"
-#include "prefetcher/D_JOLT.h"
-#include "prefetcher/FNL+MMA.h"
-#include "prefetcher/eip.h"
 #include "prefetcher/fdip.h"
+#include "prefetcher/iprefetch.h"
 #include "prefetcher/l2l1pref.h"
 #include "prefetcher/stream_pref.h"
 
 #include "cmp_model.h"
+#include "core_context.h"
 #include "decode_stage.h"
 #include "ft.h"
+#include "idq_stage.h"
 #include "map.h"
 #include "op_pool.h"
 #include "sim.h"
+#include "smt.h"
 #include "statistics.h"
 #include "thread.h"
+#include "tlb.h"
 #include "uop_queue_stage.h"
 
 /**************************************************************************************/
@@ -78,7 +82,7 @@
 
 /**************************************************************************************/
 
-Icache_Stage* ic = NULL;
+CORE_LOCAL Icache_Stage* ic = NULL;
 
 extern Cmp_Model cmp_model;
 extern Memory* mem;
@@ -90,7 +94,6 @@ extern Rob_Block_Issue_Reason rob_block_issue_reason;
 
 static inline void icache_process_ops(Stage_Data* cur_data, Flag fetched_from_uop_cache, uns start_idx);
 static inline Inst_Info** lookup_icache(void);
-static inline void prefetcher_update_on_icache_access(Flag icache_hit);
 static inline void icache_hit_events(void);
 static inline void icache_miss_events(void);
 static inline Flag mem_req_on_icache_miss(void);
@@ -121,8 +124,8 @@ static inline Flag is_fetch_barrier_op(Op* op) {
 /**************************************************************************************/
 /* set_icache_stage: */
 
-void set_icache_stage(Icache_Stage* new_ic) {
-  ic = new_ic;
+void set_icache_stage(Core_Context* ctx) {
+  ic = ctx->ic;
 }
 
 /**************************************************************************************/
@@ -196,6 +199,7 @@ void reset_icache_stage() {
   ic->back_on_path = FALSE;
   ic->fetch_barrier_pending = FALSE;
   ic->fetch_barrier_inst_uid = 0;
+  icache_line_buffer_flush(ic);
   op_count[ic->proc_id] = 1;
   unique_count_per_core[ic->proc_id] = 1;
 }
@@ -285,7 +289,7 @@ void debug_icache_stage() {
 
 void icache_resolve_fetch_barrier(uns8 proc_id, uns64 inst_uid) {
   if (model->id == CMP_MODEL) {
-    set_icache_stage(&cmp_model.icache_stage[proc_id]);
+    set_icache_stage(&cmp_model.core_context[proc_id]);
   }
 
   ASSERT(proc_id,
@@ -316,6 +320,61 @@ Flag in_icache(Addr addr) {
   return cache_access(&ic->icache, addr, &line_addr, FALSE) != NULL;
 }
 
+/**************************************************************************************/
+/* icache_wrong_path_lite_fetch: the icache access (and miss request) an off-path
+ *            fetch of addr makes under WRONG_PATH_LITE, where off-path ops never
+ *            reach the icache stage
+ */
+
+void icache_wrong_path_lite_fetch(Addr addr) {
+  Addr line_addr;
+  Flag hit = PERFECT_ICACHE || cache_access(&ic->icache, addr, &line_addr, TRUE) != NULL;
+  iprefetch_train_icache_access(ic->proc_id, addr, hit, TRUE);
+  if (hit) {
+    STAT_EVENT(ic->proc_id, WRONG_PATH_LITE_ICACHE_HIT);
+  } else if (model->mem == MODEL_MEM && new_mem_req(MRT_IFETCH, ic->proc_id, line_addr, ICACHE_LINE_SIZE, 0, NULL,
+                                                    instr_fill_line, unique_count, 0)) {
+    STAT_EVENT(ic->proc_id, WRONG_PATH_LITE_ICACHE_MISS);
+  } else {
+    STAT_EVENT(ic->proc_id, WRONG_PATH_LITE_ICACHE_DROPPED);
+  }
+}
+
+/**************************************************************************************/
+/* icache_line_buffer_flush: called whenever a line is inserted into the icache,
+ *            which may evict the buffered line or push it out of the MRU position
+ */
+
+void icache_line_buffer_flush(Icache_Stage* stage) {
+  stage->line_buf = NULL;
+}
+
+/**************************************************************************************/
+/* icache_access: cache_access on the icache, served from the line buffer when the
+ *            fetch stays in the last line hit
+ */
+
+static inline Inst_Info** icache_access(void) {
+  Cache* icache = &ic->icache;
+  if (ICACHE_LINE_BUFFER && ic->line_buf && ic->line_buf_access == icache->num_demand_access &&
+      (ic->fetch_addr & ~icache->offset_mask) == ic->line_buf_addr) {
+    // the line is already the MRU of its set, so only the access count of the lookup is kept
+    STAT_EVENT(ic->proc_id, ICACHE_LINE_BUFFER_HIT);
+    icache->num_demand_access++;
+    ic->line_buf_access = icache->num_demand_access;
+    ic->line_addr = ic->line_buf_addr;
+    return ic->line_buf;
+  }
+
+  Inst_Info** line = (Inst_Info**)cache_access(icache, ic->fetch_addr, &ic->line_addr, TRUE);
+  if (ICACHE_LINE_BUFFER && line) {
+    ic->line_buf = line;
+    ic->line_buf_addr = ic->line_addr;
+    ic->line_buf_access = icache->num_demand_access;
+  }
+  return line;
+}
+
 /**************************************************************************************/
 /* lookup_icache: returns instr if found in icache or other structures when enabled
  */
@@ -324,7 +383,7 @@ Inst_Info** lookup_icache() {
   STAT_EVENT(ic->proc_id, POWER_ITLB_ACCESS);
 
   Inst_Info** line = NULL;
-  line = (Inst_Info**)cache_access(&ic->icache, ic->fetch_addr, &ic->line_addr, TRUE);
+  line = icache_access();
   if (PERFECT_ICACHE && !line)
     line = (Inst_Info**)INIT_CACHE_DATA_VALUE;
 
@@ -338,6 +397,7 @@ Inst_Info** lookup_icache() {
       STAT_EVENT(ic->proc_id, L2_IDEAL_FILL_ICACHE);
       // actually bring it into the L1 icache
       Addr dummy_repl_line_addr;
+      icache_line_buffer_flush(ic);
       line =
           (Inst_Info**)cache_insert(&ic->icache, ic->proc_id, ic->fetch_addr, &dummy_line_addr, &dummy_repl_line_addr);
     } else
@@ -360,29 +420,22 @@ Inst_Info** lookup_icache() {
   return line;
 }
 
-void prefetcher_update_on_icache_access(Flag icache_hit) {
-  if (EIP_ENABLE)
-    eip_prefetch(ic->proc_id, ic->fetch_addr, icache_hit, 0, ic->off_path);
-  if (DJOLT_ENABLE)
-    djolt_prefetch(ic->proc_id, ic->fetch_addr, icache_hit, 0);
-  if (FNLMMA_ENABLE)
-    fnlmma_prefetch(ic->proc_id, ic->fetch_addr, icache_hit, 0);
-}
-
 void icache_hit_events() {
   DEBUG(ic->proc_id, "Cache hit on op_num:%s @ 0x%s line_addr 0x%s\n", unsstr64(op_count[ic->proc_id]),
         hexstr64s(ic->fetch_addr), hexstr64s(ic->fetch_addr & ~0x3F));
 
-  prefetcher_update_on_icache_access(/*icache_hit*/ TRUE);
+  iprefetch_train_icache_access(ic->proc_id, ic->fetch_addr, /*icache_hit*/ TRUE, ic->off_path);
   log_stats_ic_hit();
 }
 
 void icache_miss_events() {
   DEBUG(ic->proc_id, "Cache miss on op_num:%s @ 0x%s\n", unsstr64(op_count[ic->proc_id]), hexstr64s(ic->fetch_addr));
 
-  prefetcher_update_on_icache_access(/*icache_hit*/ FALSE);
+  iprefetch_train_icache_access(ic->proc_id, ic->fetch_addr, /*icache_hit*/ FALSE, ic->off_path);
   log_stats_ic_miss();
   log_stats_mshr_hit(ic->line_addr);
+  if (PC_PROF && !ic->off_path)
+    pc_prof_line(ic->proc_id, ic->line_addr, TRUE, FALSE);
 }
 
 Flag mem_req_on_icache_miss() {
@@ -449,6 +502,22 @@ FT_Arbitration_Result ft_arbitration() {
     ic->fetch_addr = ft_info.static_info.start;
     ASSERT_PROC_ID_IN_ADDR(ic->proc_id, ic->fetch_addr);
 
+    // an FT of a loop locked in the LSD is streamed from the IDQ: no ITLB, uop cache or icache lookup
+    if (LSD_ENABLE && UOP_CACHE_ENABLE &&
+        idq_stage_lsd_covers_ft(ft_info.static_info.start, ft_info.static_info.length)) {
+      STAT_EVENT(ic->proc_id, FT_LSD_HIT_ON_PATH + ic->off_path);
+      uop_cache_fill_lookup_buffer_from_lsd(ft_info);
+      ASSERT(ic->proc_id, !uc->current_ft);
+      uc->current_ft = ft;
+      return FT_HIT_UOP_CACHE;
+    }
+
+    // the FT stays in the FTQ until its translation is available
+    if (TLB_ON && !PERFECT_ICACHE && !tlb_translate(ic->proc_id, ic->fetch_addr, TRUE)) {
+      STAT_EVENT(ic->proc_id, ITLB_STALL_CYCLES);
+      return FT_UNAVAILABLE;
+    }
+
     // look up uop cache
     Flag ft_in_uop_cache = uop_cache_lookup_ft_and_fill_lookup_buffer(ft_info, ic->off_path);
 
@@ -489,6 +558,8 @@ FT_Arbitration_Result ft_arbitration() {
       // uop cache miss and icache hit
       if (!ic->off_path) {
         STAT_EVENT(ic->proc_id, FT_UOP_CACHE_MISS_ICACHE_HIT_ON_PATH);
+        if (PC_PROF && UOP_CACHE_ENABLE)
+          pc_prof_line(ic->proc_id, ic->line_addr, FALSE, TRUE);
       } else {
         STAT_EVENT(ic->proc_id, FT_UOP_CACHE_MISS_ICACHE_HIT_OFF_PATH);
       }
@@ -502,6 +573,8 @@ FT_Arbitration_Result ft_arbitration() {
       // uop cache miss and icache miss
       if (!ic->off_path) {
         STAT_EVENT(ic->proc_id, FT_UOP_CACHE_MISS_ICACHE_MISS_ON_PATH);
+        if (PC_PROF && UOP_CACHE_ENABLE)
+          pc_prof_line(ic->proc_id, ic->line_addr, FALSE, TRUE);
       } else {
         STAT_EVENT(ic->proc_id, FT_UOP_CACHE_MISS_ICACHE_MISS_OFF_PATH);
       }
@@ -766,6 +839,12 @@ void execute_coupled_FSM() {
     ic->icache_stage_resteer_signaled = FALSE;
     ic->next_state = ICACHE_STAGE_RESTEER;
     break_fetch = BREAK_ICACHE_STAGE_RESTEER;
+  } else if (SMT_THREADS > 1 &&
+             (ic->state == ICACHE_STAGE_RESTEER || ic->state == ICACHE_SERVING || ic->state == UOP_CACHE_SERVING) &&
+             !smt_fetch_granted(ic->proc_id)) {
+    // another thread of the SMT core fetches this cycle; misses in flight keep going
+    ic->next_state = ic->state;
+    break_fetch = BREAK_SMT_ICOUNT;
   } else if (ic->state == ICACHE_STAGE_RESTEER) {
     ASSERT(ic->proc_id, !uc || !uc->current_ft || !ft_can_fetch_op(uc->current_ft));
     ASSERT(ic->proc_id, !ic->current_ft || !ft_can_fetch_op(ic->current_ft));
@@ -831,7 +910,8 @@ void execute_coupled_FSM() {
 /**************************************************************************************/
 /* icache_cycle: */
 
-void update_icache_stage() {
+void update_icache_stage(Core_Context* ctx) {
+  set_icache_stage(ctx);
   ic->lookups_per_cycle_count = 0;
   if (UOP_CACHE_ENABLE) {
     uc->lookups_per_cycle_count = 0;
@@ -895,6 +975,8 @@ static inline void icache_process_ops(Stage_Data* cur_data, Flag fetched_from_uo
     STAT_EVENT(op->proc_id, ORACLE_ON_PATH_INST_MEM + (op->table_info->mem_type == NOT_MEM) + 2 * op->off_path);
 
     op->fetch_cycle = cycle_count;
+    if (SMT_THREADS > 1)
+      smt_op_fetched(op);
 
     if (is_fetch_barrier_op(op)) {
       ASSERT(ic->proc_id, !ic->fetch_barrier_pending);
@@ -922,8 +1004,7 @@ static inline void icache_process_ops(Stage_Data* cur_data, Flag fetched_from_uo
 
     if (op->table_info->cf_type) {
       // TODO: can we move this prefetch update to decoupled front-end or need it be here?
-      if (DJOLT_ENABLE)
-        update_djolt(ic->proc_id, op->inst_info->addr, op->table_info->cf_type, op->oracle_info.pred_npc);
+      iprefetch_train_branch(ic->proc_id, op->inst_info->addr, op->table_info->cf_type, op->oracle_info.pred_npc);
 
       ASSERT(ic->proc_id,
              (op->oracle_info.mispred << 2 | op->oracle_info.misfetch << 1 | op->oracle_info.btb_miss) <= 0x7);
@@ -952,6 +1033,14 @@ static inline void icache_process_ops(Stage_Data* cur_data, Flag fetched_from_uo
   }
 }
 
+/**************************************************************************************/
+/* icache_btb_prefetch: predecode a line brought in by an FDIP prefetch into the BTB */
+
+static inline void icache_btb_prefetch(Mem_Req* req) {
+  if (BTB_PREFETCH && (mem_req_is_type(req, MRT_FDIPPRFON) || mem_req_is_type(req, MRT_FDIPPRFOFF)))
+    bp_btb_prefetch_line(&cmp_model.bp_data[req->proc_id], req->addr);
+}
+
 /**************************************************************************************/
 /* icache_fill_line: */
 
@@ -967,7 +1056,7 @@ Flag icache_fill_line(Mem_Req* req)  // cmp FIXME maybe needed to be optimized
 
   // cmp
   if (model->id == CMP_MODEL) {
-    set_icache_stage(&cmp_model.icache_stage[req->proc_id]);
+    set_icache_stage(&cmp_model.core_context[req->proc_id]);
   }
 
   ASSERT(ic->proc_id, ic->proc_id == req->proc_id);
@@ -978,6 +1067,9 @@ Flag icache_fill_line(Mem_Req* req)  // cmp FIXME maybe needed to be optimized
            hexstr64s(req->addr), ic->off_path);
   }
 
+  if (PARALLEL_CORES && PARALLEL_SLACK && model->id == CMP_MODEL)
+    cmp_slack_late_fill(ic->proc_id);
+
   /* get new line in the cache */
   if ((ic->line_addr == req->addr) && ic->next_state == ICACHE_WAIT_FOR_MISS) {
     INC_STAT_EVENT(ic->proc_id, MISS_WAIT_TIME, cycle_count - ic->wait_for_miss_start);
@@ -994,7 +1086,10 @@ Flag icache_fill_line(Mem_Req* req)  // cmp FIXME maybe needed to be optimized
       return TRUE;
     }
 
+    icache_line_buffer_flush(ic);
     ic->line = (Inst_Info**)cache_insert(&ic->icache, ic->proc_id, ic->fetch_addr, &ic->line_addr, &repl_line_addr);
+    iprefetch_icache_evict(ic->proc_id, repl_line_addr);
+    icache_btb_prefetch(req);
     DEBUG(ic->proc_id, "Got line switch into ic fetch %llx\n", ic->line_addr);
     STAT_EVENT(ic->proc_id, ICACHE_FILL);
 
@@ -1003,8 +1098,7 @@ Flag icache_fill_line(Mem_Req* req)  // cmp FIXME maybe needed to be optimized
                                              &repl_line_addr2);
       if (line_info) {
         wp_process_icache_evicted(line_info, req, &repl_line_addr2);
-        if (EIP_ENABLE)
-          eip_cache_fill(ic->proc_id, req->addr, repl_line_addr2);
+        iprefetch_train_icache_fill(ic->proc_id, req->addr, repl_line_addr2);
         line_info->fetched_by_offpath = USE_CONFIRMED_OFF ? req->off_path_confirmed : req->off_path;
         line_info->offpath_op_addr = req->oldest_op_addr;
         line_info->offpath_op_unique = req->oldest_op_unique_num;
@@ -1061,7 +1155,10 @@ Flag icache_fill_line(Mem_Req* req)  // cmp FIXME maybe needed to be optimized
       return TRUE;
     }
 
+    icache_line_buffer_flush(ic);
     line = (Inst_Info**)cache_insert(&ic->icache, ic->proc_id, req->addr, &dummy_addr, &repl_line_addr);
+    iprefetch_icache_evict(ic->proc_id, repl_line_addr);
+    icache_btb_prefetch(req);
 
     if (WP_COLLECT_STATS) {  // cmp IGNORE
       line_info =
@@ -1070,8 +1167,7 @@ Flag icache_fill_line(Mem_Req* req)  // cmp FIXME maybe needed to be optimized
         STAT_EVENT(ic->proc_id, ICACHE_FILL);
 
         wp_process_icache_evicted(line_info, req, &repl_line_addr2);
-        if (EIP_ENABLE)
-          eip_cache_fill(ic->proc_id, req->addr, repl_line_addr2);
+        iprefetch_train_icache_fill(ic->proc_id, req->addr, repl_line_addr2);
         line_info->fetched_by_offpath = USE_CONFIRMED_OFF ? req->off_path_confirmed : req->off_path;
         line_info->offpath_op_addr = req->oldest_op_addr;
         line_info->offpath_op_unique = req->oldest_op_unique_num;
@@ -1119,10 +1215,10 @@ Flag icache_fill_line(Mem_Req* req)  // cmp FIXME maybe needed to be optimized
 }
 
 /**************************************************************************************/
-/* icache_off_path: */
+/* icache_off_path: the models without icache stages never fetch off the path */
 
 inline Flag icache_off_path(void) {
-  return ic->off_path;
+  return ic && ic->off_path;
 }
 
 /*************************************************************************************/
@@ -1145,6 +1241,7 @@ Inst_Info** ic_pref_cache_access(void) {
   }
 
   if (line) {
+    icache_line_buffer_flush(ic);
     inserted_line =
         (Inst_Info**)cache_insert(&ic->icache, ic->proc_id, ic->fetch_addr, &ic->line_addr, &repl_line_addr);
     DEBUG(ic->proc_id, "ic_pref cache hit:fetch_addr:0x%s \n", hexstr64(ic->fetch_addr));
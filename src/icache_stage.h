@@ -73,7 +73,8 @@ typedef enum Break_Reason_enum {
   BREAK_UOP_CACHE_STALLED,
   BREAK_UOP_CACHE_TO_ICACHE_SWITCH,
   BREAK_UOP_CACHE_READ_LIMIT,
-  BREAK_UOP_CACHE_ISSUE_WIDTH
+  BREAK_UOP_CACHE_ISSUE_WIDTH,
+  BREAK_SMT_ICOUNT  // break because another SMT thread of the core won fetch arbitration
 } Break_Reason;
 
 typedef enum FT_Arbitration_Result_enum {
@@ -100,6 +101,11 @@ typedef struct Icache_Stage_struct {
 
   Inst_Info** line; /* pointer to current line on a hit */
   Addr line_addr;   /* address of the last cache line hit */
+  /* ICACHE_LINE_BUFFER: the last line hit and the icache demand access count right after that hit. While no other
+     line has been hit or inserted since, the line is still the MRU of its set and a refetch skips the set lookup */
+  Inst_Info** line_buf;
+  Addr line_buf_addr;
+  Counter line_buf_access;
   Addr fetch_addr;  /* address to fetch or fetching */
   // keep track of the current FT being used by the icache / uop cache
   FT* current_ft;
@@ -130,13 +136,13 @@ typedef struct Icache_Data_struct {
 /**************************************************************************************/
 /* External Variables */
 
-extern Icache_Stage* ic;
+extern CORE_LOCAL Icache_Stage* ic;
 
 /**************************************************************************************/
 /* Prototypes */
 
 /* vanilla hps model */
-void set_icache_stage(Icache_Stage*);
+void set_icache_stage(Core_Context*);
 void init_icache_stage(uns8, const char*);
 Stage_Data* get_current_stage_data(void);
 void reset_icache_stage(void);
@@ -144,13 +150,15 @@ void reset_all_ops_icache_stage(void);
 void recover_icache_stage(void);
 void redirect_icache_stage(void);
 void debug_icache_stage(void);
-void update_icache_stage(void);
+void update_icache_stage(Core_Context*);
 void icache_resolve_fetch_barrier(uns8 proc_id, uns64 inst_uid);
 
 Flag icache_fill_line(Mem_Req*);
 Flag icache_off_path(void);
 Flag instr_fill_line(Mem_Req* req);
 Flag in_icache(Addr addr);  // For branch stat collection
+void icache_wrong_path_lite_fetch(Addr addr);
+void icache_line_buffer_flush(Icache_Stage* stage);
 
 /**************************************************************************************/
 
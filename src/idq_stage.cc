@@ -30,6 +30,7 @@
 
 #include <vector>
 
+#include "core_context.h"
 #include "ft.h"
 
 extern "C" {
@@ -40,12 +41,14 @@ extern "C" {
 #include "globals/global_vars.h"
 #include "globals/utils.h"
 
+#include "core.param.h"
 #include "memory/memory.param.h"
 
 #include "bp/bp.h"
 
 #include "decode_stage.h"
 #include "op_pool.h"
+#include "statistics.h"
 #include "topdown.h"
 }
 
@@ -60,6 +63,7 @@ class IDQ_Stage {
 
   void set_recovery_cycle(int recovery_cycle);
   int get_recovery_cycle() const;
+  bool lsd_covers(Addr start, Addr length) const;
 
  private:
   uns8 proc_id;
@@ -74,15 +78,24 @@ class IDQ_Stage {
   /* the IDQ outpur stage data */
   Stage_Data idq_sd;
 
+  /* loop stream detector: the candidate loop is [lsd_loop_start, lsd_loop_end), closed by its backward branch */
+  Addr lsd_loop_start;
+  Addr lsd_loop_end;  // 0 if there is no candidate loop
+  int lsd_body_uops;  // on-path uops since the last taken branch
+  uns lsd_iterations;
+  bool lsd_locked;
+
   Stage_Data* select_input_stage_data(Stage_Data* dec_src_sd, Stage_Data* ic_uopc_sd, Stage_Data* uop_queue_sd);
   void process_input_stage_data(Stage_Data* consume_from_sd, int& count_issued, int& count_issued_on_path);
+  void lsd_train(Op* op);
+  void lsd_reset();
   bool enqueue(Op* op);
   Op* dequeue();
   inline int wrap_around(int);
 };
 
 /* Global Variables */
-IDQ_Stage* idq_stage = NULL;
+CORE_LOCAL IDQ_Stage* idq_stage = NULL;
 
 /* Per-Core IDQ_Stage */
 std::vector<IDQ_Stage> per_core_idq_stage;
@@ -110,6 +123,7 @@ void IDQ_Stage::reset() {
   head = 0;
   tail = 0;
   recovery_cycle = 0;
+  lsd_reset();
 
   for (int i = 0; i < idq_sd.max_op_count; i++) {
     idq_sd.ops[i] = NULL;
@@ -141,6 +155,9 @@ void IDQ_Stage::recover() {
     next_op_num = bp_recovery_info->recovery_op_num + 1;
   }
 
+  /* like the hardware, a misprediction unlocks the loop */
+  lsd_reset();
+
   for (int i = idq_sd.op_count - 1; i >= 0; i--) {
     Op* op = idq_sd.ops[i];
     if (op && FLUSH_OP(op)) {
@@ -215,6 +232,9 @@ void IDQ_Stage::process_input_stage_data(Stage_Data* consume_from_sd, int& count
       ASSERT(proc_id, op->fetched_from_uop_cache);
       decode_stage_process_op(op);
     }
+    if (LSD_ENABLE && !op->off_path) {
+      lsd_train(op);
+    }
     /* If there are still slots in the output stage data,
      * bypass the queue and go straight to the output data.
      * Otherwise, enqueue the IDQ. */
@@ -265,6 +285,50 @@ void IDQ_Stage::update(Stage_Data* dec_src_sd, Stage_Data* ic_uopc_sd, Stage_Dat
   topdown_idq_update(proc_id, idq_sd.op_count, count_issued, count_issued_on_path);
 }
 
+/* The loop is detected on the on-path uops entering the IDQ: it locks once its backward branch has been taken
+ * LSD_DETECT_ITERATIONS times in a row with at most LSD_SIZE uops and no other taken branch per iteration,
+ * and stays locked until a uop from outside the loop (or a recovery) shows up. */
+void IDQ_Stage::lsd_train(Op* op) {
+  Addr addr = op->inst_info->addr;
+  if (lsd_loop_end && (addr < lsd_loop_start || addr >= lsd_loop_end)) {
+    lsd_reset();
+  }
+  lsd_body_uops++;
+
+  Cf_Type cf_type = op->table_info->cf_type;
+  if (cf_type == NOT_CF || op->oracle_info.dir == NOT_TAKEN) {
+    return;
+  }
+
+  Addr target = op->oracle_info.npc;
+  Addr end = addr + op->inst_info->trace_info.inst_size;
+  if (target == lsd_loop_start && end == lsd_loop_end && lsd_body_uops <= (int)LSD_SIZE) {
+    if (++lsd_iterations == LSD_DETECT_ITERATIONS) {
+      lsd_locked = true;
+      STAT_EVENT(proc_id, LSD_LOCKED);
+    }
+  } else {
+    lsd_reset();
+    if ((cf_type == CF_CBR || cf_type == CF_BR) && target <= addr) {
+      lsd_loop_start = target;
+      lsd_loop_end = end;
+    }
+  }
+  lsd_body_uops = 0;
+}
+
+void IDQ_Stage::lsd_reset() {
+  lsd_loop_start = 0;
+  lsd_loop_end = 0;
+  lsd_body_uops = 0;
+  lsd_iterations = 0;
+  lsd_locked = false;
+}
+
+bool IDQ_Stage::lsd_covers(Addr start, Addr length) const {
+  return lsd_locked && start >= lsd_loop_start && start + length <= lsd_loop_end;
+}
+
 bool IDQ_Stage::enqueue(Op* op) {
   if (occupied_count == capacity) {
     return false;
@@ -311,8 +375,8 @@ void alloc_mem_idq_stage(uns8 num_cores) {
   per_core_idq_stage.resize(num_cores);
 }
 
-void set_idq_stage(uns8 proc_id) {
-  idq_stage = &per_core_idq_stage[proc_id];
+void set_idq_stage(Core_Context* ctx) {
+  idq_stage = &per_core_idq_stage[ctx->proc_id];
 }
 
 void init_idq_stage(uns8 proc_id, const char* name) {
@@ -331,7 +395,8 @@ void debug_idq_stage(void) {
   idq_stage->debug();
 }
 
-void update_idq_stage(Stage_Data* dec_src_sd, Stage_Data* ic_uopc_sd, Stage_Data* uop_queue_sd) {
+void update_idq_stage(Core_Context* ctx, Stage_Data* dec_src_sd, Stage_Data* ic_uopc_sd, Stage_Data* uop_queue_sd) {
+  set_idq_stage(ctx);
   idq_stage->update(dec_src_sd, ic_uopc_sd, uop_queue_sd);
 }
 
@@ -345,4 +410,8 @@ void idq_stage_set_recovery_cycle(int recovery_cycle) {
 
 int idq_stage_get_recovery_cycle() {
   return idq_stage->get_recovery_cycle();
+}
+
+Flag idq_stage_lsd_covers_ft(Addr start, Addr length) {
+  return idq_stage->lsd_covers(start, length);
 }
\ No newline at end of file
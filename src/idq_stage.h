@@ -43,21 +43,22 @@ typedef struct IDQ_Stage IDQ_Stage;
 /**************************************************************************************/
 /* External Variables */
 
-extern IDQ_Stage* idq_stage;
+extern CORE_LOCAL IDQ_Stage* idq_stage;
 
 /**************************************************************************************/
 /* Prototypes */
 
 void alloc_mem_idq_stage(uns8);
-void set_idq_stage(uns8);
+void set_idq_stage(Core_Context*);
 void init_idq_stage(uns8, const char*);
 void reset_idq_stage(void);
 void recover_idq_stage(void);
 void debug_idq_stage(void);
-void update_idq_stage(Stage_Data*, Stage_Data*, Stage_Data*);
+void update_idq_stage(Core_Context*, Stage_Data*, Stage_Data*, Stage_Data*);
 Stage_Data* idq_stage_get_stage_data(void);
 void idq_stage_set_recovery_cycle(int recovery_cycle);
 int idq_stage_get_recovery_cycle();
+Flag idq_stage_lsd_covers_ft(Addr start, Addr length);
 
 #ifdef __cplusplus
 }
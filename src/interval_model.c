@@ -0,0 +1,669 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : interval_model.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Interval core model: a dispatch-width/ROB-window timing model of each
+ *                core on top of the frontend, the branch predictor and the real uncore
+ ***************************************************************************************/
+
+/* Each core dispatches up to ISSUE_WIDTH on-path ops per cycle into a window of
+   NODE_TABLE_SIZE ops and retires up to NODE_RET_WIDTH of them in order. There are no
+   pipeline stages, schedulers or functional units: an op is done its latency after its
+   sources are done, so the core runs at the dispatch width until a miss event opens an
+   interval:
+
+   - a load that misses the private dcache goes to the memory system through
+     new_mem_req and stays in the window until its line comes back. Dispatch goes on
+     behind it, so the misses of independent loads within one window overlap, until
+     the window is full and the oldest miss stalls the core.
+   - a mispredicted branch stops dispatch until it resolves, plus the refill of the
+     frontend (INTERVAL_REDIRECT_CYCLES). A misfetch only costs the icache and decode
+     latencies.
+   - an icache miss stops dispatch until its line comes back.
+
+   Stores complete into a store buffer; their misses are sent but never wait. An op
+   whose source waits for a miss does not know its done cycle; it is scheduled when the
+   miss comes back (or, with more than INTERVAL_WAIT_SRCS such sources, once it is the
+   oldest op in the window), so dependent misses such as pointer chasing serialize.
+   The branch predictor sees each branch at dispatch and is updated
+   right away, as in the bp_only model, so no wrong-path ops are simulated. */
+
+#include "interval_model.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "bp/bp.param.h"
+#include "core.param.h"
+#include "general.param.h"
+#include "memory/memory.param.h"
+#include "prefetcher/pref.param.h"
+
+#include "frontend/frontend.h"
+#include "isa/isa_macros.h"
+#include "memory/coherence.h"
+#include "prefetcher/pref_common.h"
+
+#include "cmp_model.h"
+#include "freq.h"
+#include "model.h"
+#include "sim.h"
+#include "statistics.h"
+#include "warm_state.h"
+
+/**************************************************************************************/
+/* Macros */
+
+/* done cycle of an op that waits for a miss */
+#define INTERVAL_PENDING MAX_CTR
+/* sources an op can wait for outside of the window head */
+#define INTERVAL_WAIT_SRCS 2
+
+/**************************************************************************************/
+/* Types */
+
+typedef enum Interval_State_enum {
+  INTERVAL_DONE,    /* done_cycle is known */
+  INTERVAL_WAIT,    /* waits for the sources in wait_seq (or for a memory request buffer) */
+  INTERVAL_MISS,    /* load waiting for its dcache line */
+} Interval_State;
+
+/* why a core dispatched nothing in a cycle, in the order of the INTERVAL_CYCLE_* stats */
+typedef enum Interval_Stall_enum {
+  INTERVAL_STALL_NONE,
+  INTERVAL_STALL_WINDOW,
+  INTERVAL_STALL_ICACHE,
+  INTERVAL_STALL_REDIRECT,
+  INTERVAL_STALL_FRONTEND,
+  INTERVAL_STALL_DRAIN,
+} Interval_Stall;
+
+typedef struct Interval_Entry_struct {
+  Counter done_cycle; /* INTERVAL_WAIT: when the other sources are done, INTERVAL_MISS: INTERVAL_PENDING */
+  Counter wait_seq[INTERVAL_WAIT_SRCS];
+  Addr va;        /* data address of a load or store */
+  Addr line_addr; /* dcache line of a load miss */
+  uns16 latency;
+  uns8 mem_type;
+  uns8 state;
+  uns8 num_wait; /* INTERVAL_WAIT_SRCS + 1: too many, scheduled at the window head */
+  Flag eom;
+  Flag exit;
+} Interval_Entry;
+
+typedef struct Interval_Line_struct {
+  Flag dirty;
+} Interval_Line;
+
+/**************************************************************************************/
+/* Global variables */
+
+Interval_Model interval_model;
+
+/* the ops are copied into the window as they are fetched, so a single op is reused */
+static Op interval_op;
+static Table_Info interval_table_info;
+static Inst_Info interval_inst_info;
+static uns interval_redirect_cycles;
+static struct timespec interval_start_time;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static Flag interval_fill_line(Mem_Req* req);
+
+/**************************************************************************************/
+/* interval_entry: the op with sequence number seq, or NULL if it has retired */
+
+static inline Interval_Entry* interval_entry(Interval_Core* core, Counter seq) {
+  if (seq < core->head_seq)
+    return NULL;
+  ASSERT(0, seq < core->head_seq + core->window.count);
+  return &RING_AT(&core->window, Interval_Entry, seq - core->head_seq);
+}
+
+/**************************************************************************************/
+/* interval_dcache_access: accesses the dcache for a load or store whose address is
+ * ready at cycle start */
+
+static void interval_dcache_access(uns proc_id, Interval_Core* core, Interval_Entry* entry, Counter start) {
+  Flag store = entry->mem_type == MEM_ST;
+  Addr line_addr;
+  Interval_Line* line = (Interval_Line*)cache_access(&core->dcache, entry->va, &line_addr, TRUE);
+
+  if (line) {
+    STAT_EVENT(proc_id, INTERVAL_DCACHE_HIT);
+    line->dirty |= store;
+    entry->done_cycle = start + DCACHE_CYCLES;
+    entry->state = INTERVAL_DONE;
+    return;
+  }
+
+  if (!new_mem_req(store ? MRT_DSTORE : MRT_DFETCH, proc_id, line_addr, DCACHE_LINE_SIZE, 0, NULL, interval_fill_line,
+                   unique_count, NULL)) {
+    /* retried at the next wakeup or when the op reaches the window head */
+    STAT_EVENT(proc_id, INTERVAL_MEM_REQ_REJECTED);
+    entry->done_cycle = cycle_count;
+    entry->num_wait = 0;
+    entry->state = INTERVAL_WAIT;
+    return;
+  }
+  unique_count++;
+  STAT_EVENT(proc_id, INTERVAL_DCACHE_MISS);
+
+  if (store) {
+    entry->done_cycle = start + DCACHE_CYCLES;
+    entry->state = INTERVAL_DONE;
+    return;
+  }
+  if (core->outstanding_misses)
+    STAT_EVENT(proc_id, INTERVAL_DCACHE_MISS_OVERLAPPED);
+  core->outstanding_misses++;
+  entry->line_addr = line_addr;
+  entry->done_cycle = INTERVAL_PENDING;
+  entry->state = INTERVAL_MISS;
+}
+
+/**************************************************************************************/
+/* interval_schedule: computes the done cycle of an op whose sources are done at cycle
+ * ready */
+
+static void interval_schedule(uns proc_id, Interval_Core* core, Interval_Entry* entry, Counter ready) {
+  if (entry->mem_type == MEM_LD || entry->mem_type == MEM_ST) {
+    interval_dcache_access(proc_id, core, entry, ready + entry->latency);
+  } else {
+    entry->done_cycle = ready + entry->latency;
+    entry->state = INTERVAL_DONE;
+  }
+}
+
+/**************************************************************************************/
+/* interval_fill_line: done function of the icache and dcache misses */
+
+static Flag interval_fill_line(Mem_Req* req) {
+  uns proc_id = req->proc_id;
+  Interval_Core* core = &interval_model.cores[proc_id];
+  Counter fill_cycle = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+  Addr line_addr, repl_line_addr;
+
+  if (mem_req_is_type(req, MRT_DFETCH) || mem_req_is_type(req, MRT_DSTORE)) {
+    Flag repl_line_valid;
+    Interval_Line* line = (Interval_Line*)get_next_repl_line(&core->dcache, proc_id, req->addr, &repl_line_addr,
+                                                              &repl_line_valid);
+    if (repl_line_valid && line->dirty) {
+      /* the memory system calls again if the writeback does not fit */
+      if (!new_mem_dc_wb_req(MRT_WB, get_proc_id_from_cmp_addr(repl_line_addr), repl_line_addr, DCACHE_LINE_SIZE, 1,
+                             NULL, NULL, unique_count, TRUE))
+        return FALSE;
+      STAT_EVENT(proc_id, INTERVAL_DCACHE_WB);
+    }
+    line = (Interval_Line*)cache_insert(&core->dcache, proc_id, req->addr, &line_addr, &repl_line_addr);
+    line->dirty = mem_req_is_type(req, MRT_DSTORE);
+
+    for (int pos = 0; core->outstanding_misses && pos < core->window.count; pos++) {
+      Interval_Entry* entry = &RING_AT(&core->window, Interval_Entry, pos);
+      if (entry->state == INTERVAL_MISS && entry->line_addr == line_addr) {
+        entry->done_cycle = fill_cycle + DCACHE_CYCLES;
+        entry->state = INTERVAL_DONE;
+        core->outstanding_misses--;
+        core->wake = TRUE;
+      }
+    }
+  }
+
+  if (mem_req_is_type(req, MRT_IFETCH)) {
+    cache_insert(&core->icache, proc_id, req->addr, &line_addr, &repl_line_addr);
+    if (core->icache_miss_line == line_addr)
+      core->icache_miss_line = 0;
+  }
+
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* interval_wake: schedules the waiting ops whose sources are now done, oldest first so
+ * that dependence chains resolve in one pass */
+
+static void interval_wake(uns proc_id, Interval_Core* core) {
+  core->wake = FALSE;
+  for (int pos = 0; pos < core->window.count; pos++) {
+    Interval_Entry* entry = &RING_AT(&core->window, Interval_Entry, pos);
+    if (entry->state != INTERVAL_WAIT || entry->num_wait > INTERVAL_WAIT_SRCS)
+      continue;
+
+    Counter ready = entry->done_cycle;
+    Flag wait = FALSE;
+    for (uns ii = 0; ii < entry->num_wait && !wait; ii++) {
+      Interval_Entry* src = interval_entry(core, entry->wait_seq[ii]);
+      if (src && src->state != INTERVAL_DONE)
+        wait = TRUE;
+      else if (src)
+        ready = MAX2(ready, src->done_cycle);
+    }
+    if (!wait)
+      interval_schedule(proc_id, core, entry, ready);
+  }
+}
+
+/**************************************************************************************/
+/* interval_redirect: fetch restarts once the mispredicted branch is done and the
+ * frontend has refilled */
+
+static inline void interval_redirect(Interval_Core* core, Interval_Entry* branch) {
+  ASSERT(0, branch->state == INTERVAL_DONE);
+  core->fetch_cycle = MAX2(core->fetch_cycle, branch->done_cycle + interval_redirect_cycles);
+  core->branch_seq = 0;
+}
+
+/**************************************************************************************/
+/* interval_retire: */
+
+static void interval_retire(uns proc_id, Interval_Core* core) {
+  for (uns ii = 0; ii < NODE_RET_WIDTH && core->window.count; ii++) {
+    Interval_Entry* entry = &RING_AT(&core->window, Interval_Entry, 0);
+
+    /* everything older has retired, so the sources are done */
+    if (entry->state == INTERVAL_WAIT)
+      interval_schedule(proc_id, core, entry, MAX2(entry->done_cycle, cycle_count));
+    if (entry->state != INTERVAL_DONE || entry->done_cycle > cycle_count) {
+      if (ii == 0 && entry->state == INTERVAL_MISS)
+        STAT_EVENT(proc_id, INTERVAL_RET_BLOCKED_DCACHE_MISS);
+      break;
+    }
+
+    if (core->branch_seq == core->head_seq + 1)
+      interval_redirect(core, entry);
+    Flag eom = entry->eom;
+    if (entry->exit)
+      retired_exit[proc_id] = TRUE;
+    ring_remove_head(&core->window);
+    core->head_seq++;
+
+    if (eom) {
+      inst_count[proc_id]++;
+      STAT_EVENT(proc_id, NODE_INST_COUNT);
+      /* stop exactly at the limit so that the stats match the cmp model's */
+      if (INST_LIMIT && inst_count[proc_id] >= inst_limit[proc_id])
+        break;
+    }
+  }
+}
+
+/**************************************************************************************/
+/* interval_fetch_line: TRUE if the next op is in the icache, otherwise sends the miss */
+
+static Flag interval_fetch_line(uns proc_id, Interval_Core* core) {
+  Addr addr = frontend_next_fetch_addr(proc_id);
+  Addr line_addr;
+
+  if ((addr & ~(Addr)(ICACHE_LINE_SIZE - 1)) == core->fetch_line)
+    return TRUE;
+  if (cache_access(&core->icache, addr, &line_addr, TRUE)) {
+    STAT_EVENT(proc_id, INTERVAL_ICACHE_HIT);
+    core->fetch_line = line_addr;
+    return TRUE;
+  }
+  if (new_mem_req(MRT_IFETCH, proc_id, line_addr, ICACHE_LINE_SIZE, 0, NULL, interval_fill_line, unique_count, NULL)) {
+    unique_count++;
+    STAT_EVENT(proc_id, INTERVAL_ICACHE_MISS);
+    core->icache_miss_line = line_addr;
+  }
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* interval_predict: runs a control-flow op through the branch predictor and stops
+ * fetch on a misprediction or a misfetch */
+
+static void interval_predict(uns proc_id, Interval_Core* core, Op* op, Counter seq) {
+  Bp_Data* bp_data = &interval_model.bp_data[proc_id];
+
+  bp_predict_op(bp_data, op, 1, op->inst_info->addr);
+  bp_target_known_op(bp_data, op);
+  bp_resolve_op(bp_data, op);
+  if (op->oracle_info.mispred || op->oracle_info.misfetch)
+    bp_recover_op(bp_data, op->table_info->cf_type, &op->recovery_info);
+  bp_retire_op(bp_data, op);
+
+  STAT_EVENT(proc_id, INTERVAL_BR_CORRECT + op->oracle_info.mispred + 2 * op->oracle_info.misfetch);
+  if (op->oracle_info.mispred)
+    core->branch_seq = seq + 1;
+  else if (op->oracle_info.misfetch)
+    core->fetch_cycle = cycle_count + ICACHE_LATENCY + DECODE_CYCLES + EXTRA_REDIRECT_CYCLES;
+}
+
+/**************************************************************************************/
+/* interval_dispatch_op: puts a fetched op at the tail of the window */
+
+static void interval_dispatch_op(uns proc_id, Interval_Core* core, Op* op) {
+  Table_Info* table_info = op->table_info;
+  Inst_Info* inst_info = op->inst_info;
+  Counter seq = core->head_seq + core->window.count;
+  Interval_Entry* entry = (Interval_Entry*)ring_add_tail(&core->window);
+  Counter ready = cycle_count;
+  uns num_wait = 0;
+
+  op_count[proc_id]++;
+  uop_count[proc_id]++;
+  STAT_EVENT(proc_id, NODE_UOP_COUNT);
+
+  for (uns ii = 0; ii < table_info->num_src_regs; ii++) {
+    uns16 id = inst_info->srcs[ii].id;
+    Counter done = core->reg_done[id];
+    if (done == INTERVAL_PENDING) {
+      Interval_Entry* src = interval_entry(core, core->reg_seq[id]);
+      done = !src ? 0 : src->state == INTERVAL_DONE ? src->done_cycle : INTERVAL_PENDING;
+    }
+    if (done != INTERVAL_PENDING)
+      ready = MAX2(ready, done);
+    else if (num_wait++ < INTERVAL_WAIT_SRCS)
+      entry->wait_seq[num_wait - 1] = core->reg_seq[id];
+  }
+
+  entry->va = op->oracle_info.va;
+  entry->line_addr = 0;
+  entry->latency = MAX2(abs(inst_info->latency), 1);
+  entry->mem_type = table_info->mem_type;
+  entry->eom = op->eom;
+  entry->exit = op->exit;
+  entry->done_cycle = ready;
+  entry->num_wait = MIN2(num_wait, INTERVAL_WAIT_SRCS + 1);
+  entry->state = INTERVAL_WAIT;
+  if (!num_wait)
+    interval_schedule(proc_id, core, entry, ready);
+
+  for (uns ii = 0; ii < table_info->num_dest_regs; ii++) {
+    uns16 id = inst_info->dests[ii].id;
+    core->reg_done[id] = entry->state == INTERVAL_DONE ? entry->done_cycle : INTERVAL_PENDING;
+    core->reg_seq[id] = seq;
+  }
+
+  if (table_info->cf_type != NOT_CF)
+    interval_predict(proc_id, core, op, seq);
+
+  if (op->eom) {
+    inst_count_fetched[proc_id]++;
+    frontend_retire(proc_id, op->inst_uid);
+  }
+  if (op->exit)
+    core->fetch_done = TRUE;
+}
+
+/**************************************************************************************/
+/* interval_dispatch: */
+
+static void interval_dispatch(uns proc_id, Interval_Core* core) {
+  Interval_Stall stall = INTERVAL_STALL_NONE;
+  uns dispatched = 0;
+
+  if (core->branch_seq) {
+    Interval_Entry* branch = interval_entry(core, core->branch_seq - 1);
+    if (branch->state == INTERVAL_DONE)
+      interval_redirect(core, branch);
+  }
+
+  while (dispatched < ISSUE_WIDTH) {
+    if (core->fetch_done)
+      stall = INTERVAL_STALL_DRAIN;
+    else if (core->branch_seq || cycle_count < core->fetch_cycle)
+      stall = INTERVAL_STALL_REDIRECT;
+    else if (core->icache_miss_line)
+      stall = INTERVAL_STALL_ICACHE;
+    else if (core->window.count == (int)NODE_TABLE_SIZE)
+      stall = INTERVAL_STALL_WINDOW;
+    else if (!frontend_can_fetch_op(proc_id))
+      stall = INTERVAL_STALL_FRONTEND;
+    else if (!interval_fetch_line(proc_id, core))
+      stall = INTERVAL_STALL_ICACHE;
+    if (stall != INTERVAL_STALL_NONE)
+      break;
+
+    frontend_fetch_op(proc_id, &interval_op);
+    interval_dispatch_op(proc_id, core, &interval_op);
+    dispatched++;
+  }
+
+  STAT_EVENT(proc_id, INTERVAL_CYCLE_DISPATCH + (dispatched ? INTERVAL_STALL_NONE : stall));
+  if (stall == INTERVAL_STALL_WINDOW)
+    STAT_EVENT(proc_id, FULL_WINDOW_STALL);
+}
+
+/**************************************************************************************/
+/* interval_init */
+
+void interval_init(uns mode) {
+  if (mode == SIMULATION_MODE) {
+    clock_gettime(CLOCK_MONOTONIC, &interval_start_time);
+    return;
+  }
+
+  /* as in the cmp model, the real initialization is done in warmup */
+  ASSERT(0, mode == WARMUP_MODE);
+  ASSERTM(0, !DUMB_CORE_ON, "The interval model cannot run next to a dumb core\n");
+  ASSERTM(0, !CONFIDENCE_ENABLE && !FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE,
+          "The interval model has no decoupled frontend (CONFIDENCE_ENABLE, FDIP_DUAL_PATH_PREF_UOC_ONLINE_ENABLE)\n");
+  ASSERTM(0, COHERENCE_PROTOCOL == COHERENCE_PROTOCOL_NONE, "The interval model does not support coherence\n");
+  ASSERTM(0, ISSUE_WIDTH > 0 && NODE_TABLE_SIZE > 0 && NODE_RET_WIDTH > 0,
+          "The interval model needs a positive ISSUE_WIDTH, NODE_TABLE_SIZE and NODE_RET_WIDTH\n");
+
+  freq_init();
+
+  interval_model.bp_recovery_info = (Bp_Recovery_Info*)calloc(NUM_CORES, sizeof(Bp_Recovery_Info));
+  interval_model.bp_data = (Bp_Data*)calloc(NUM_CORES, sizeof(Bp_Data));
+  interval_model.cores = (Interval_Core*)calloc(NUM_CORES, sizeof(Interval_Core));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Interval_Core* core = &interval_model.cores[proc_id];
+
+    init_bp_recovery_info(proc_id, &interval_model.bp_recovery_info[proc_id]);
+    init_bp_data(proc_id, &interval_model.bp_data[proc_id]);
+
+    init_ring(&core->window, "INTERVAL WINDOW", sizeof(Interval_Entry), NODE_TABLE_SIZE);
+    core->reg_done = (Counter*)calloc(NUM_REG_IDS, sizeof(Counter));
+    core->reg_seq = (Counter*)calloc(NUM_REG_IDS, sizeof(Counter));
+    init_cache(&core->icache, "ICACHE", ICACHE_SIZE, ICACHE_ASSOC, ICACHE_LINE_SIZE, 0, ICACHE_REPL);
+    init_cache(&core->dcache, "DCACHE", DCACHE_SIZE, DCACHE_ASSOC, DCACHE_LINE_SIZE, sizeof(Interval_Line),
+               DCACHE_REPL);
+  }
+
+  interval_redirect_cycles = INTERVAL_REDIRECT_CYCLES ? INTERVAL_REDIRECT_CYCLES
+                                                      : ICACHE_LATENCY + DECODE_CYCLES + MAP_CYCLES +
+                                                            EXTRA_RECOVERY_CYCLES;
+
+  interval_op.table_info = &interval_table_info;
+  interval_op.inst_info = &interval_inst_info;
+  interval_op.mbp7_info = NULL;
+
+  set_memory(&interval_model.memory);
+  init_memory();
+}
+
+/**************************************************************************************/
+/* interval_reset: */
+
+void interval_reset(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Interval_Core* core = &interval_model.cores[proc_id];
+    core->head_seq += core->window.count;
+    ring_clear(&core->window);
+    core->outstanding_misses = 0;
+    core->wake = FALSE;
+    core->icache_miss_line = 0;
+    core->branch_seq = 0;
+  }
+  reset_memory();
+}
+
+/**************************************************************************************/
+/* interval_cycle: */
+
+void interval_cycle(void) {
+  update_memory();
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (retired_exit[proc_id] || !freq_is_ready(FREQ_DOMAIN_CORES[proc_id]))
+      continue;
+
+    Interval_Core* core = &interval_model.cores[proc_id];
+    cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+    set_bp_data(&interval_model.bp_data[proc_id]);
+    set_bp_recovery_info(&interval_model.bp_recovery_info[proc_id]);
+    STAT_EVENT(proc_id, NODE_CYCLE);
+
+    if (core->wake)
+      interval_wake(proc_id, core);
+    interval_retire(proc_id, core);
+    interval_dispatch(proc_id, core);
+  }
+}
+
+/**************************************************************************************/
+/* interval_debug: */
+
+void interval_debug(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Interval_Core* core = &interval_model.cores[proc_id];
+    cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+
+    FPRINT_LINE(proc_id, GLOBAL_DEBUG_STREAM);
+    DPRINTF("# interval core %u  cycle:%s  window:%d  head:%s  misses:%u  icache_miss:0x%s  branch:%s  fetch:%s\n",
+            proc_id, unsstr64(cycle_count), core->window.count, unsstr64(core->head_seq), core->outstanding_misses,
+            hexstr64s(core->icache_miss_line), unsstr64(core->branch_seq), unsstr64(core->fetch_cycle));
+  }
+  debug_memory();
+}
+
+/**************************************************************************************/
+/* interval_per_core_done: */
+
+void interval_per_core_done(uns8 proc_id) {
+  Counter cycles = GET_TOTAL_STAT_EVENT(proc_id, NODE_CYCLE);
+
+  fprintf(mystdout, "** Core %u interval: %llu insts, %llu cycles, %.3f IPC\n", proc_id, inst_count[proc_id], cycles,
+          cycles ? (double)inst_count[proc_id] / cycles : 0.0);
+  if (PREF_FRAMEWORK_ON)
+    pref_per_core_done(proc_id);
+}
+
+/**************************************************************************************/
+/* interval_done: finalizes the memory system and reports the simulation speed */
+
+void interval_done(void) {
+  struct timespec now;
+  Counter insts = 0;
+
+  if (PREF_FRAMEWORK_ON)
+    pref_done();
+  finalize_memory();
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double secs = (now.tv_sec - interval_start_time.tv_sec) + (now.tv_nsec - interval_start_time.tv_nsec) / 1e9;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    insts += inst_count[proc_id];
+  fprintf(mystdout, "** interval: %llu insts in %.2f seconds (%.2f MIPS)\n", insts, secs,
+          secs > 0 ? insts / secs / 1e6 : 0.0);
+}
+
+/**************************************************************************************/
+/* interval_warmup: warms up the branch predictor, the icache, the dcache and the L1
+ * like cmp_warmup */
+
+void interval_warmup(Op* op) {
+  uns proc_id = op->proc_id;
+  Interval_Core* core = &interval_model.cores[proc_id];
+  Addr line_addr, repl_line_addr;
+
+  if (!cache_access(&core->icache, op->inst_info->addr, &line_addr, TRUE)) {
+    warmup_uncore(proc_id, op->inst_info->addr, FALSE);
+    cache_insert(&core->icache, proc_id, op->inst_info->addr, &line_addr, &repl_line_addr);
+  }
+
+  Flag is_store = op->table_info->mem_type == MEM_ST;
+  if (op->table_info->mem_type == MEM_LD || is_store) {
+    Addr va = op->oracle_info.va;
+    Interval_Line* line = (Interval_Line*)cache_access(&core->dcache, va, &line_addr, TRUE);
+    if (line) {
+      line->dirty |= is_store;
+    } else {
+      warmup_uncore(proc_id, va, FALSE);
+      line = (Interval_Line*)cache_insert(&core->dcache, proc_id, va, &line_addr, &repl_line_addr);
+      if (line->dirty)
+        warmup_uncore(proc_id, repl_line_addr, TRUE);
+      line->dirty = is_store;
+    }
+  }
+
+  if (op->table_info->cf_type != NOT_CF) {
+    Bp_Data* bp_data = &interval_model.bp_data[proc_id];
+    set_bp_data(bp_data);
+    set_bp_recovery_info(&interval_model.bp_recovery_info[proc_id]);
+    bp_predict_op(bp_data, op, 1, op->inst_info->addr);
+    bp_target_known_op(bp_data, op);
+    bp_resolve_op(bp_data, op);
+    if (op->oracle_info.mispred || op->oracle_info.misfetch)
+      bp_recover_op(bp_data, op->table_info->cf_type, &op->recovery_info);
+    bp_retire_op(bp_data, op);
+  }
+}
+
+/**************************************************************************************/
+/* interval_save_warm_state: writes the same state as cmp_save_warm_state */
+
+void interval_save_warm_state(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Interval_Core* core = &interval_model.cores[proc_id];
+    warm_state_save_cache(&core->icache, "interval_icache%u", proc_id);
+    warm_state_save_cache(&core->dcache, "interval_dcache%u", proc_id);
+    if (L1_SLICES == 1 && (PRIVATE_L1 || proc_id == 0))
+      warm_state_save_cache(&interval_model.memory.uncores[proc_id].l1->cache, "l1_%u", proc_id);
+    bp_save_warm_state(&interval_model.bp_data[proc_id]);
+  }
+  for (uns slice = 0; L1_SLICES > 1 && slice < L1_SLICES; slice++)
+    warm_state_save_cache(&interval_model.memory.l1_slices[slice]->cache, "l1_slice_%u", slice);
+}
+
+/**************************************************************************************/
+/* interval_load_warm_state: */
+
+void interval_load_warm_state(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Interval_Core* core = &interval_model.cores[proc_id];
+    warm_state_load_cache(&core->icache, "interval_icache%u", proc_id);
+    warm_state_load_cache(&core->dcache, "interval_dcache%u", proc_id);
+    if (L1_SLICES == 1 && (PRIVATE_L1 || proc_id == 0))
+      warm_state_load_cache(&interval_model.memory.uncores[proc_id].l1->cache, "l1_%u", proc_id);
+    bp_load_warm_state(&interval_model.bp_data[proc_id]);
+  }
+  for (uns slice = 0; L1_SLICES > 1 && slice < L1_SLICES; slice++)
+    warm_state_load_cache(&interval_model.memory.l1_slices[slice]->cache, "l1_slice_%u", slice);
+}
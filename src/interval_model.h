@@ -0,0 +1,89 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : interval_model.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Interval core model: a dispatch-width/ROB-window timing model of each
+ *                core on top of the frontend, the branch predictor and the real uncore
+ ***************************************************************************************/
+
+#ifndef __INTERVAL_MODEL_H__
+#define __INTERVAL_MODEL_H__
+
+#include "bp/bp.h"
+#include "libs/cache_lib.h"
+#include "libs/ring_lib.h"
+#include "memory/memory.h"
+
+/**************************************************************************************/
+/* interval model data  */
+
+typedef struct Interval_Core_struct {
+  Ring window;       /* Interval_Entry of the dispatched ops, oldest first */
+  Counter head_seq;  /* sequence number of the oldest op in the window */
+  Counter* reg_done; /* [NUM_REG_IDS] cycle the last writer of each register is done */
+  Counter* reg_seq;  /* [NUM_REG_IDS] sequence number of the last writer of each register */
+
+  Cache icache;
+  Cache dcache;
+  Addr fetch_line;        /* icache line of the last fetched op */
+  Addr icache_miss_line;  /* icache line fetch is waiting for (0 if none) */
+  Counter branch_seq;     /* 1 + sequence number of the mispredicted branch fetch waits for (0 if none) */
+  Counter fetch_cycle;    /* first cycle fetch can dispatch again after a redirect */
+  Flag fetch_done;        /* the exit op was fetched */
+  uns outstanding_misses; /* load misses in the window waiting for the memory system */
+  Flag wake;              /* a load miss came back, waiting ops may be ready */
+} Interval_Core;
+
+typedef struct Interval_Model_struct {
+  Bp_Recovery_Info* bp_recovery_info;
+  Bp_Data* bp_data;
+
+  Memory memory;
+
+  Interval_Core* cores;
+} Interval_Model;
+
+/**************************************************************************************/
+/* Global vars */
+
+extern Interval_Model interval_model;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void interval_init(uns mode);
+void interval_reset(void);
+void interval_cycle(void);
+void interval_debug(void);
+void interval_per_core_done(uns8);
+void interval_done(void);
+void interval_warmup(Op*);
+void interval_save_warm_state(void);
+void interval_load_warm_state(void);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __INTERVAL_MODEL_H__ */
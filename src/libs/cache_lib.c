@@ -29,6 +29,12 @@
 #include "libs/cache_lib.h"
 
 #include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #include "globals/assert.h"
 #include "globals/global_defs.h"
@@ -44,6 +50,7 @@
 #include "memory/memory.param.h"
 
 #include "frontend/frontend_intf.h"
+#include "libs/table_alloc.h"
 
 // DeleteMe
 #define ideal_num_entries 256
@@ -53,12 +60,37 @@
 
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_CACHE_LIB, ##args)
 
+/**************************************************************************************/
+/* Types */
+
+/* the per-line metadata callbacks (see Cache_Meta_Ops) */
+typedef enum Cache_Meta_Event_enum {
+  CACHE_META_HIT,
+  CACHE_META_INSERT,
+  CACHE_META_EVICT,
+} Cache_Meta_Event;
+
 /**************************************************************************************/
 /* Static Prototypes */
 
 static inline uns cache_index(Cache* cache, Addr addr, Addr* tag, Addr* line_addr);
+static void cache_init_tag_store(Cache* cache);
+static inline void cache_sync_tag(Cache* cache, uns set, Cache_Entry* line);
+static inline uns cache_match_tag(Addr const* tags, uns num, Addr tag, uns start);
+static inline uns cache_find_way(Cache* cache, uns set, Addr tag, uns start);
+static inline void* cache_access_set(Cache* cache, uns set, Addr tag, Addr addr, Addr* line_addr, Flag update_repl);
 static inline void update_repl_policy(Cache*, Cache_Entry*, uns, uns, Flag);
 static inline Cache_Entry* find_repl_entry(Cache*, uns8, uns, uns*);
+static void cache_record_init(Cache*, const char*, uns, uns, uns, uns, Repl_Policy);
+static inline void cache_record(Cache*, Cache_Record_Op, uns8, Addr, uns8);
+static void cache_set_prof_init(Cache*, const char*, uns);
+static inline void cache_set_prof(Cache*, uns, Cache_Set_Prof_Counter);
+static inline void cache_set_prof_access(Cache*, uns, void*);
+static void cache_invalidate_line(Cache*, Addr, Addr*);
+static inline void cache_opt_step(Cache*, Addr);
+static inline void cache_opt_set_next_use(Cache*, uns, uns, Counter);
+static void cache_meta_event(Cache*, Cache_Entry*, Cache_Meta_Event);
+static void cache_meta_clear(Cache*);
 
 /* for ideal replacement */
 static inline void* access_unsure_lines(Cache*, uns, Addr, Flag);
@@ -70,6 +102,81 @@ static inline void invalidate_unsure_line(Cache*, uns, Addr);
 
 char rand_repl_state[31];
 
+static Flag cache_record_opened = FALSE;
+
+static Cache** cache_set_prof_list = NULL;
+static uns cache_set_prof_num = 0;
+
+/**************************************************************************************/
+/* cache_record_init: only the first cache named CACHE_ACCESS_RECORD is recorded, so
+   that a multi-core run produces one stream */
+
+static void cache_record_init(Cache* cache, const char* name, uns cache_size, uns assoc, uns line_size, uns data_size,
+                              Repl_Policy repl_policy) {
+  cache->record = NULL;
+  if (!CACHE_ACCESS_RECORD || cache_record_opened || strcmp(name, CACHE_ACCESS_RECORD))
+    return;
+
+  char file_name[MAX_STR_LENGTH + 1];
+  snprintf(file_name, MAX_STR_LENGTH, "%s.cache_accesses", name);
+  cache->record = file_tag_fopen(OUTPUT_DIR, file_name, "w");
+  ASSERTM(0, cache->record, "Could not open the CACHE_ACCESS_RECORD file of cache '%s'\n", name);
+  Cache_Record_Header header = {CACHE_RECORD_MAGIC, cache_size, assoc, line_size, data_size, repl_policy};
+  fwrite(&header, sizeof(header), 1, cache->record);
+  cache_record_opened = TRUE;
+}
+
+/**************************************************************************************/
+/* cache_set_prof_init: SET_PROF_CACHES is a comma-separated list of cache names, or
+   "all" */
+
+static void cache_set_prof_init(Cache* cache, const char* name, uns num_sets) {
+  cache->set_prof = NULL;
+  if (!SET_PROF_CACHES)
+    return;
+
+  Flag match = !strcmp(SET_PROF_CACHES, "all");
+  size_t len = strlen(name);
+  const char* item = SET_PROF_CACHES;
+  while (!match && item) {
+    const char* end = strchr(item, ',');
+    size_t item_len = end ? (size_t)(end - item) : strlen(item);
+    match = item_len == len && !strncmp(item, name, len);
+    item = end ? end + 1 : NULL;
+  }
+  if (!match)
+    return;
+
+  cache->set_prof = (uns32*)calloc((size_t)num_sets * CACHE_SET_PROF_COUNTERS, sizeof(uns32));
+  cache_set_prof_list = (Cache**)realloc(cache_set_prof_list, sizeof(Cache*) * (cache_set_prof_num + 1));
+  cache_set_prof_list[cache_set_prof_num++] = cache;
+}
+
+Cache* const* cache_set_prof_caches(uns* num) {
+  *num = cache_set_prof_num;
+  return cache_set_prof_list;
+}
+
+static inline void cache_set_prof(Cache* cache, uns set, Cache_Set_Prof_Counter counter) {
+  if (cache->set_prof)
+    cache->set_prof[set * CACHE_SET_PROF_COUNTERS + counter]++;
+}
+
+static inline void cache_set_prof_access(Cache* cache, uns set, void* line_data) {
+  if (cache->set_prof) {
+    cache->set_prof[set * CACHE_SET_PROF_COUNTERS + CACHE_SET_PROF_ACCESS]++;
+    cache->set_prof[set * CACHE_SET_PROF_COUNTERS + CACHE_SET_PROF_MISS] += !line_data;
+  }
+}
+
+/**************************************************************************************/
+/* cache_record: */
+
+static inline void cache_record(Cache* cache, Cache_Record_Op op, uns8 proc_id, Addr addr, uns8 arg) {
+  Cache_Record record = {addr, op, proc_id, arg};
+  fwrite(&record, sizeof(record), 1, cache->record);
+}
+
 /**************************************************************************************/
 
 static inline uns cache_index(Cache* cache, Addr addr, Addr* tag, Addr* line_addr) {
@@ -87,6 +194,194 @@ uns ext_cache_index(Cache* cache, Addr addr, Addr* tag, Addr* line_addr) {
   return cache_index(cache, addr, tag, line_addr);
 }
 
+/**************************************************************************************/
+/* Tag store: cache->tags mirrors the (valid, tag) pair of every line in
+   cache->entries, so a lookup scans assoc dense tags instead of assoc
+   Cache_Entry structs.  The entries keep the replacement state and data
+   pointers.  Every change of an entry's valid bit or tag in this file must be
+   followed by cache_sync_tag. */
+
+static void cache_init_tag_store(Cache* cache) {
+  uns ii;
+
+  cache->tags = NULL;
+  if (!CACHE_TAG_STORE)
+    return;
+
+  cache->tags = (Addr*)table_alloc("cache_lib", sizeof(Addr) * cache->num_sets * cache->assoc);
+  for (ii = 0; ii < cache->num_sets * cache->assoc; ii++)
+    cache->tags[ii] = CACHE_TAG_INVALID;
+}
+
+static inline void cache_sync_tag(Cache* cache, uns set, Cache_Entry* line) {
+  uns way;
+
+  if (!cache->tags)
+    return;
+
+  way = line - cache->entries[set];
+  ASSERT(0, way < cache->assoc);
+  cache->tags[set * cache->assoc + way] = line->valid ? line->tag : CACHE_TAG_INVALID;
+}
+
+/* cache_match_tag: index of the first of tags[start..num) equal to tag, or num */
+static inline uns cache_match_tag(Addr const* tags, uns num, Addr tag, uns start) {
+  uns ii = start;
+
+#if defined(__AVX2__)
+  __m256i key = _mm256_set1_epi64x((long long)tag);
+  for (; ii + 4 <= num; ii += 4) {
+    __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((__m256i const*)&tags[ii]), key);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+    if (mask)
+      return ii + __builtin_ctz(mask);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  uint64x2_t key = vdupq_n_u64((uint64_t)tag);
+  for (; ii + 2 <= num; ii += 2) {
+    uint64x2_t eq = vceqq_u64(vld1q_u64((uint64_t const*)&tags[ii]), key);
+    if (vgetq_lane_u64(eq, 0))
+      return ii;
+    if (vgetq_lane_u64(eq, 1))
+      return ii + 1;
+  }
+#endif
+  for (; ii < num; ii++)
+    if (tags[ii] == tag)
+      return ii;
+  return num;
+}
+
+/* cache_find_way: first way at or after start that holds a valid line with
+   the tag, or cache->assoc.  A tag store match is confirmed on the entry, which
+   only matters if a real tag ever equals CACHE_TAG_INVALID. */
+static inline uns cache_find_way(Cache* cache, uns set, Addr tag, uns start) {
+  uns ii;
+
+  if (cache->tags) {
+    Addr const* tags = &cache->tags[set * cache->assoc];
+    for (ii = cache_match_tag(tags, cache->assoc, tag, start); ii < cache->assoc;
+         ii = cache_match_tag(tags, cache->assoc, tag, ii + 1)) {
+      Cache_Entry* line = &cache->entries[set][ii];
+      if (line->valid && line->tag == tag)
+        return ii;
+    }
+    return cache->assoc;
+  }
+
+  for (ii = start; ii < cache->assoc; ii++) {
+    Cache_Entry* line = &cache->entries[set][ii];
+    if (line->valid && line->tag == tag)
+      return ii;
+  }
+  return cache->assoc;
+}
+
+/**************************************************************************************/
+/* Line storage: the Cache_Entry structs of a cache are one array and their
+   payloads one slab, both in (set, way) order, so a set's lines and data are
+   adjacent in memory and a cache costs two table_alloc allocations instead of two
+   mallocs per line.  entries[set] and each line's data point into them. */
+
+static void cache_alloc_lines(Cache_Entry** sets, uns num_sets, uns ways, uns data_size) {
+  Cache_Entry* lines = (Cache_Entry*)table_alloc("cache_lib", sizeof(Cache_Entry) * num_sets * ways);
+  char* slab = data_size ? (char*)table_alloc("cache_lib", (size_t)data_size * num_sets * ways) : NULL;
+  uns ii, jj;
+
+  for (ii = 0; ii < num_sets; ii++) {
+    sets[ii] = &lines[(size_t)ii * ways];
+    for (jj = 0; jj < ways; jj++) {
+      sets[ii][jj].valid = FALSE;
+      sets[ii][jj].data = slab ? slab + ((size_t)ii * ways + jj) * data_size : INIT_CACHE_DATA_VALUE;
+    }
+  }
+}
+
+/**************************************************************************************/
+/* Per-line metadata: cache->meta holds meta_size bytes for every line of
+   cache->entries, in (set, way) order, and the registered slots are laid out
+   back to back in them.  A line that leaves its way in this file gets the
+   evict callbacks while it still holds its old base, and a line that takes a
+   way gets a zeroed slot and then the insert callbacks. */
+
+static inline char* cache_meta_line(Cache* cache, Cache_Entry* line) {
+  size_t index = line - cache->entries[0];
+
+  ASSERT(0, index < (size_t)cache->num_sets * cache->assoc);
+  return cache->meta + index * cache->meta_size;
+}
+
+static void cache_meta_event(Cache* cache, Cache_Entry* line, Cache_Meta_Event event) {
+  char* meta = cache_meta_line(cache, line);
+  uns ii;
+
+  if (event == CACHE_META_INSERT)
+    memset(meta, 0, cache->meta_size);
+  for (ii = 0; ii < cache->num_meta_slots; ii++) {
+    Cache_Meta_Slot* slot = &cache->meta_slots[ii];
+    Cache_Meta_Func func = event == CACHE_META_HIT      ? slot->ops.hit
+                           : event == CACHE_META_INSERT ? slot->ops.insert
+                                                        : slot->ops.evict;
+    if (func)
+      func(cache, line, meta + slot->offset, slot->ops.arg);
+  }
+}
+
+/* cache_meta_clear: zeroes the slots of every line, for the callers that drop
+   or replace lines without going through the events */
+static void cache_meta_clear(Cache* cache) {
+  if (cache->meta)
+    memset(cache->meta, 0, (size_t)cache->meta_size * cache->num_sets * cache->assoc);
+}
+
+uns cache_meta_register(Cache* cache, uns size, const Cache_Meta_Ops* ops) {
+  size_t num_lines = (size_t)cache->num_sets * cache->assoc;
+  uns offset = cache->meta_size;
+  uns meta_size = offset + ROUND_UP(size, sizeof(Counter));
+  char* meta = (char*)table_alloc("cache_lib", meta_size * num_lines);
+  Cache_Meta_Slot* slot;
+  size_t ii;
+
+  ASSERTM(0, size, "Cache '%s': metadata slots must not be empty\n", cache->name);
+  if (cache->meta) {
+    for (ii = 0; ii < num_lines; ii++)
+      memcpy(meta + ii * meta_size, cache->meta + ii * offset, offset);
+    table_free("cache_lib", cache->meta, offset * num_lines);
+  }
+  cache->meta = meta;
+  cache->meta_size = meta_size;
+
+  cache->meta_slots =
+      (Cache_Meta_Slot*)realloc(cache->meta_slots, sizeof(Cache_Meta_Slot) * (cache->num_meta_slots + 1));
+  slot = &cache->meta_slots[cache->num_meta_slots];
+  memset(slot, 0, sizeof(Cache_Meta_Slot));
+  slot->offset = offset;
+  if (ops)
+    slot->ops = *ops;
+  DEBUG(0, "Cache '%s': metadata slot %u of %u bytes at offset %u\n", cache->name, cache->num_meta_slots, size,
+        offset);
+  return cache->num_meta_slots++;
+}
+
+void* cache_line_meta(Cache* cache, Cache_Entry* line, uns slot) {
+  ASSERT(0, slot < cache->num_meta_slots);
+  return cache_meta_line(cache, line) + cache->meta_slots[slot].offset;
+}
+
+void* cache_data_meta(Cache* cache, void* data, uns slot) {
+  ASSERT(0, cache->data_size);
+  return cache_line_meta(cache, &cache->entries[0][((char*)data - (char*)cache->entries[0][0].data) / cache->data_size],
+                         slot);
+}
+
+void* cache_meta(Cache* cache, Addr addr, uns slot) {
+  Addr tag, line_addr;
+  uns set = cache_index(cache, addr, &tag, &line_addr);
+  uns way = cache_find_way(cache, set, tag, 0);
+
+  return way < cache->assoc ? cache_line_meta(cache, &cache->entries[set][way], slot) : NULL;
+}
+
 /**************************************************************************************/
 /* init_cache: */
 
@@ -94,9 +389,16 @@ void init_cache(Cache* cache, const char* name, uns cache_size, uns assoc, uns l
                 Repl_Policy repl_policy) {
   uns num_lines = cache_size / line_size;
   uns num_sets = cache_size / line_size / assoc;
-  uns ii, jj;
+  uns ii;
 
   DEBUG(0, "Initializing cache called '%s'.\n", name);
+  cache->opt = NULL;
+  cache->meta = NULL;
+  cache->meta_size = 0;
+  cache->num_meta_slots = 0;
+  cache->meta_slots = NULL;
+  cache_record_init(cache, name, cache_size, assoc, line_size, data_size, repl_policy);
+  cache_set_prof_init(cache, name, num_sets);
 
   if (repl_policy >= REPL_VOID) {
     init_cache_strategy(cache, name, cache_size, assoc, line_size, data_size, repl_policy);
@@ -127,29 +429,17 @@ void init_cache(Cache* cache, const char* name, uns cache_size, uns assoc, uns l
 
   /* allocate memory for the unsure lists (if necessary) */
   if (cache->repl_policy == REPL_IDEAL)
-    cache->unsure_lists = (List*)malloc(sizeof(List) * num_sets);
+    cache->unsure_lists = (Ring*)malloc(sizeof(Ring) * num_sets);
 
-  /* allocate memory for all of the lines in each set */
-  for (ii = 0; ii < num_sets; ii++) {
-    cache->entries[ii] = (Cache_Entry*)malloc(sizeof(Cache_Entry) * assoc);
-    /* allocate memory for all of the data elements in each line */
-    for (jj = 0; jj < assoc; jj++) {
-      cache->entries[ii][jj].valid = FALSE;
-      if (data_size) {
-        cache->entries[ii][jj].data = (void*)malloc(data_size);
-        memset(cache->entries[ii][jj].data, 0, data_size);
-      } else
-        cache->entries[ii][jj].data = INIT_CACHE_DATA_VALUE;
-    }
+  /* allocate memory for all of the lines and their data */
+  cache_alloc_lines(cache->entries, num_sets, assoc, data_size);
 
-    /* initialize the unsure lists (if necessary) */
-    if (cache->repl_policy == REPL_IDEAL) {
-      char list_name[MAX_STR_LENGTH + 1];
-      // 21 guaruntees the string will always be smaller than MAX_STR_LENGTH
-      snprintf(list_name, MAX_STR_LENGTH, "%.*s unsure [%d]", MAX_STR_LENGTH - 20, cache->name, ii);
-      init_list(&cache->unsure_lists[ii], list_name, sizeof(Cache_Entry), USE_UNSURE_FREE_LISTS);
-    }
+  /* initialize the unsure lists (if necessary) */
+  if (cache->repl_policy == REPL_IDEAL) {
+    for (ii = 0; ii < num_sets; ii++)
+      init_ring(&cache->unsure_lists[ii], cache->name, sizeof(Cache_Entry), assoc);
   }
+  cache_init_tag_store(cache);
   cache->num_demand_access = 0;
   cache->last_update = 0;
 
@@ -159,43 +449,23 @@ void init_cache(Cache* cache, const char* name, uns cache_size, uns assoc, uns l
     cache->num_ways_occupied_core = (uns*)malloc(sizeof(uns) * NUM_CORES);
     cache->lru_index_core = (uns*)malloc(sizeof(uns) * NUM_CORES);
     cache->lru_time_core = (Counter*)malloc(sizeof(Counter) * NUM_CORES);
+    cache->way_mask_core = NULL;
   }
 
   /* allocate memory for the back-up lists (if necessary) */
   if (cache->repl_policy == REPL_SHADOW_IDEAL) {
     cache->shadow_entries = (Cache_Entry**)malloc(sizeof(Cache_Entry*) * num_sets);
-    /* allocate memory for all of the lines in each set */
-    for (ii = 0; ii < num_sets; ii++) {
-      cache->shadow_entries[ii] = (Cache_Entry*)malloc(sizeof(Cache_Entry) * assoc);
-      /* allocate memory for all of the data elements in each line */
-      for (jj = 0; jj < assoc; jj++) {
-        cache->shadow_entries[ii][jj].valid = FALSE;
-        if (data_size) {
-          cache->shadow_entries[ii][jj].data = (void*)malloc(data_size);
-          memset(cache->shadow_entries[ii][jj].data, 0, data_size);
-        } else
-          cache->shadow_entries[ii][jj].data = INIT_CACHE_DATA_VALUE;
-      }
-    }
+    /* allocate memory for all of the lines and their data */
+    cache_alloc_lines(cache->shadow_entries, num_sets, assoc, data_size);
   }
 
   else if (cache->repl_policy == REPL_IDEAL_STORAGE) {
     cache->shadow_entries = (Cache_Entry**)malloc(sizeof(Cache_Entry*) * num_sets);
     cache->queue_end = (uns*)malloc(sizeof(uns) * num_sets);
-    /* allocate memory for all of the lines in each set */
-    for (ii = 0; ii < num_sets; ii++) {
-      cache->shadow_entries[ii] = (Cache_Entry*)malloc(sizeof(Cache_Entry) * ideal_num_entries);
-      /* allocate memory for all of the data elements in each line */
-      for (jj = 0; jj < ideal_num_entries; jj++) {
-        cache->shadow_entries[ii][jj].valid = FALSE;
-        if (data_size) {
-          cache->shadow_entries[ii][jj].data = (void*)malloc(data_size);
-          memset(cache->shadow_entries[ii][jj].data, 0, data_size);
-        } else
-          cache->shadow_entries[ii][jj].data = INIT_CACHE_DATA_VALUE;
-      }
+    /* allocate memory for all of the lines and their data */
+    cache_alloc_lines(cache->shadow_entries, num_sets, ideal_num_entries, data_size);
+    for (ii = 0; ii < num_sets; ii++)
       cache->queue_end[ii] = 0;
-    }
   }
 
   cache->tag_incl_offset = FALSE;
@@ -208,9 +478,48 @@ void init_cache(Cache* cache, const char* name, uns cache_size, uns assoc, uns l
 void* cache_access(Cache* cache, Addr addr, Addr* line_addr, Flag update_repl) {
   Addr tag;
   uns set = cache_index(cache, addr, &tag, line_addr);
+  void* line_data = cache_access_set(cache, set, tag, addr, line_addr, update_repl);
+  cache_set_prof_access(cache, set, line_data);
+  return line_data;
+}
+
+/**************************************************************************************/
+/* cache_access_multi: cache_access of num addresses, in order.  All the set
+ * indices and tags are computed first and the sets are fetched together before
+ * any of them is probed, which hides most of the set loads behind each other.
+ * The caller must not change the cache contents between the accesses it
+ * batches. */
+
+void cache_access_multi(Cache* cache, uns num, const Addr* addrs, Addr* line_addrs, void** lines, Flag update_repl) {
+  Addr tags[CACHE_ACCESS_MULTI_CHUNK];
+  uns sets[CACHE_ACCESS_MULTI_CHUNK];
+
+  for (uns base = 0; base < num; base += CACHE_ACCESS_MULTI_CHUNK) {
+    uns count = MIN2(num - base, CACHE_ACCESS_MULTI_CHUNK);
+    for (uns ii = 0; ii < count; ii++) {
+      sets[ii] = cache_index(cache, addrs[base + ii], &tags[ii], &line_addrs[base + ii]);
+      __builtin_prefetch(cache->tags ? (void*)&cache->tags[sets[ii] * cache->assoc] : (void*)cache->entries[sets[ii]]);
+    }
+    for (uns ii = 0; ii < count; ii++) {
+      lines[base + ii] =
+          cache_access_set(cache, sets[ii], tags[ii], addrs[base + ii], &line_addrs[base + ii], update_repl);
+      cache_set_prof_access(cache, sets[ii], lines[base + ii]);
+    }
+  }
+}
+
+/**************************************************************************************/
+/* cache_access_set: cache_access once addr is split into set and tag */
+
+static inline void* cache_access_set(Cache* cache, uns set, Addr tag, Addr addr, Addr* line_addr, Flag update_repl) {
   uns ii;
   void* line_data = NULL;
 
+  if (cache->record)
+    cache_record(cache, CACHE_RECORD_ACCESS, 0, addr, update_repl);
+  if (cache->opt && update_repl)
+    cache_opt_step(cache, addr);
+
   if (cache->repl_policy >= REPL_VOID)
     return cache_access_strategy(cache, addr, line_addr, update_repl);
 
@@ -218,27 +527,27 @@ void* cache_access(Cache* cache, Addr addr, Addr* line_addr, Flag update_repl) {
     return access_ideal_storage(cache, set, tag, addr);
   }
 
-  for (ii = 0; ii < cache->assoc; ii++) {
+  for (ii = cache_find_way(cache, set, tag, 0); ii < cache->assoc; ii = cache_find_way(cache, set, tag, ii + 1)) {
     Cache_Entry* line = &cache->entries[set][ii];
 
-    if (line->valid && line->tag == tag) {
-      /* update replacement state if necessary */
-      ASSERT(0, line->data);
-      DEBUG(0, "Found line in cache '%s' at (set %u, way %u, base 0x%s)\n", cache->name, set, ii,
-            hexstr64s(line->base));
+    /* update replacement state if necessary */
+    ASSERT(0, line->data);
+    DEBUG(0, "Found line in cache '%s' at (set %u, way %u, base 0x%s)\n", cache->name, set, ii,
+          hexstr64s(line->base));
 
-      if (update_repl) {
-        if (line->pref) {
-          line->pref = FALSE;
-        }
-        cache->num_demand_access++;
-        update_repl_policy(cache, line, set, ii, FALSE);
-        DEBUG(0, "(%s, %d) [0x%x, 0x%x]: in access\n\n", cache->name, cache->repl_policy, cache->num_sets,
-              cache->assoc);
+    if (update_repl) {
+      if (line->pref) {
+        line->pref = FALSE;
       }
-
-      line_data = line->data;
+      cache->num_demand_access++;
+      update_repl_policy(cache, line, set, ii, FALSE);
+      if (cache->meta)
+        cache_meta_event(cache, line, CACHE_META_HIT);
+      DEBUG(0, "(%s, %d) [0x%x, 0x%x]: in access\n\n", cache->name, cache->repl_policy, cache->num_sets,
+            cache->assoc);
     }
+
+    line_data = line->data;
   }
 
   if (line_data)
@@ -270,8 +579,11 @@ void* cache_access(Cache* cache, Addr addr, Addr* line_addr, Flag update_repl) {
 */
 
 void* cache_insert(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr, Addr* repl_line_addr) {
-  if (cache->repl_policy >= REPL_VOID)
+  if (cache->repl_policy >= REPL_VOID) {
+    if (cache->record)
+      cache_record(cache, CACHE_RECORD_INSERT, proc_id, addr, INSERT_REPL_DEFAULT);
     return cache_insert_strategy(cache, proc_id, addr, line_addr, repl_line_addr);
+  }
 
   return cache_insert_replpos(cache, proc_id, addr, line_addr, repl_line_addr, INSERT_REPL_DEFAULT, FALSE);
 }
@@ -291,8 +603,11 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr, Addr* line_add
   uns set = cache_index(cache, addr, &tag, line_addr);
   Cache_Entry* new_line;
 
+  if (cache->record)
+    cache_record(cache, CACHE_RECORD_INSERT, proc_id, addr, insert_repl_policy | (isPrefetch ? CACHE_RECORD_PREF : 0));
+
   // Sanity check. Ensure that we do not insert the same line twice
-  cache_invalidate(cache, addr, line_addr);
+  cache_invalidate_line(cache, addr, line_addr);
 
   if (cache->repl_policy >= REPL_VOID)
     return cache_insert_strategy(cache, proc_id, addr, line_addr, repl_line_addr);
@@ -306,11 +621,14 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr, Addr* line_add
     /* insert that entry to the shadow cache */
     if ((cache->repl_policy == REPL_SHADOW_IDEAL) && new_line->valid)
       shadow_cache_insert(cache, set, new_line->tag, new_line->base);
+    if (cache->meta && new_line->valid)
+      cache_meta_event(cache, new_line, CACHE_META_EVICT);
 
     /* bug fixed. 4/26/04 if the entry is not valid, repl_line_addr should be set to 0 */
-    if (new_line->valid)
+    if (new_line->valid) {
       *repl_line_addr = new_line->base;
-    else
+      cache_set_prof(cache, set, CACHE_SET_PROF_EVICT);
+    } else
       *repl_line_addr = 0;
     DEBUG(0, "Replacing 2.2f(set %u, way %u, tag 0x%s, base 0x%s) in cache '%s' with base 0x%s\n", set, repl_index,
           hexstr64s(new_line->tag), hexstr64s(new_line->base), cache->name, hexstr64s(*line_addr));
@@ -319,11 +637,14 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr, Addr* line_add
   new_line->proc_id = proc_id;
   new_line->valid = TRUE;
   new_line->tag = tag;
+  cache_sync_tag(cache, set, new_line);
   new_line->base = *line_addr;
   new_line->last_access_time = sim_time;  // FIXME: this fixes valgrind warnings in update_prf_
   new_line->pref = isPrefetch;
 
   new_line->pw_start_addr = addr;  // only means anything for uop cache
+  if (cache->meta)
+    cache_meta_event(cache, new_line, CACHE_META_INSERT);
 
   switch (insert_repl_policy) {
     case INSERT_REPL_DEFAULT:
@@ -407,6 +728,7 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr, Addr* line_add
       main_line = &cache->entries[set][lru_ind];
       main_line->valid = TRUE;
       main_line->tag = tag;
+      cache_sync_tag(cache, set, main_line);
       main_line->base = *line_addr;
       main_line->last_access_time = sim_time;
     }
@@ -415,20 +737,32 @@ void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr, Addr* line_add
 }
 
 /**************************************************************************************/
-/* invalidate_line: Invalidates based on the address.  */
+/* cache_invalidate: Invalidates based on the address.  */
 
 void cache_invalidate(Cache* cache, Addr addr, Addr* line_addr) {
+  if (cache->record)
+    cache_record(cache, CACHE_RECORD_INVALIDATE, 0, addr, 0);
+  cache_invalidate_line(cache, addr, line_addr);
+}
+
+/**************************************************************************************/
+/* cache_invalidate_line: */
+
+static void cache_invalidate_line(Cache* cache, Addr addr, Addr* line_addr) {
   Addr tag;
   uns set = cache_index(cache, addr, &tag, line_addr);
   uns ii;
 
-  for (ii = 0; ii < cache->assoc; ii++) {
+  for (ii = cache_find_way(cache, set, tag, 0); ii < cache->assoc; ii = cache_find_way(cache, set, tag, ii + 1)) {
     Cache_Entry* line = &cache->entries[set][ii];
-    if (line->tag == tag && line->valid) {
-      line->tag = 0;
-      line->valid = FALSE;
-      line->base = 0;
-    }
+    if (cache->meta)
+      cache_meta_event(cache, line, CACHE_META_EVICT);
+    line->tag = 0;
+    line->valid = FALSE;
+    line->base = 0;
+    cache_sync_tag(cache, set, line);
+    if (cache->opt)
+      cache_opt_set_next_use(cache, set, ii, MAX_CTR);
   }
 
   if (cache->repl_policy == REPL_IDEAL)
@@ -525,10 +859,33 @@ Cache_Entry* find_repl_entry(Cache* cache, uns8 proc_id, uns set, uns* way) {
        * it's very likely the victim comes from the very over-occupied partition
        * instead of request's own partition.
        */
-      uns8 way_proc_id;
+      uns way_proc_id;
       uns lru_ind = 0;
       uns total_assigned_ways = 0;
 
+      if (cache->way_mask_core) {
+        // way partitioning: the victim is the LRU line among the requester's own ways
+        uns64 mask = cache->way_mask_core[proc_id];
+        Counter lru_time = MAX_CTR;
+        lru_ind = cache->assoc;
+        for (ii = 0; ii < cache->assoc; ii++) {
+          if (!(mask >> ii & 1))
+            continue;
+          Cache_Entry* entry = &cache->entries[set][ii];
+          if (!entry->valid) {
+            lru_ind = ii;
+            break;
+          }
+          if (entry->last_access_time < lru_time) {
+            lru_ind = ii;
+            lru_time = entry->last_access_time;
+          }
+        }
+        ASSERTM(proc_id, lru_ind < cache->assoc, "No ways in the partition of core %u\n", proc_id);
+        *way = lru_ind;
+        return &cache->entries[set][lru_ind];
+      }
+
       for (way_proc_id = 0; way_proc_id < NUM_CORES; way_proc_id++) {
         cache->num_ways_occupied_core[way_proc_id] = 0;
         cache->lru_time_core[way_proc_id] = MAX_CTR;
@@ -703,14 +1060,12 @@ void update_repl_resteer_policy(Cache* cache, Addr addr) {
   Addr tag;
   Addr line_addr;
   uns set = cache_index(cache, addr, &tag, &line_addr);
-  for (ii = 0; ii < cache->assoc; ii++) {
+  for (ii = cache_find_way(cache, set, tag, 0); ii < cache->assoc; ii = cache_find_way(cache, set, tag, ii + 1)) {
     Cache_Entry* line = &cache->entries[set][ii];
-    if (line->valid && line->tag == tag) {
-      ASSERT(0, line->data);
-      DEBUG(0, "updating access time REPL_RESTEER '%s' at (set %u, way %u, base 0x%s)\n", cache->name, set, ii,
-            hexstr64s(line->base));
-      line->last_access_time = sim_time;
-    }
+    ASSERT(0, line->data);
+    DEBUG(0, "updating access time REPL_RESTEER '%s' at (set %u, way %u, base 0x%s)\n", cache->name, set, ii,
+          hexstr64s(line->base));
+    line->last_access_time = sim_time;
   }
 }
 
@@ -736,25 +1091,28 @@ uns cache_get_invalid_line_count(Cache* cache, Addr addr) {
 /* access_unsure_lines: */
 
 static inline void* access_unsure_lines(Cache* cache, uns set, Addr tag, Flag update_repl) {
-  List* list = &cache->unsure_lists[set];
-  Cache_Entry* temp;
-  int ii;
+  Ring* list = &cache->unsure_lists[set];
+  int ii, pos;
 
-  for (temp = (Cache_Entry*)list_start_head_traversal(list); temp; temp = (Cache_Entry*)list_next_element(list)) {
+  for (pos = 0; pos < list->count; pos++) {
+    Cache_Entry* temp = (Cache_Entry*)ring_at(list, pos);
     ASSERT(0, temp->valid);
     if (temp->tag == tag) {
       for (ii = 0; ii < cache->assoc; ii++) {
         if (!cache->entries[set][ii].valid) {
           void* data = cache->entries[set][ii].data;
           memcpy(&cache->entries[set][ii], temp, sizeof(Cache_Entry));
-          temp->data = data;
-          ASSERT(0, dl_list_remove_current(list) == temp);
+          cache_sync_tag(cache, set, &cache->entries[set][ii]);
+          /* the line keeps its own slot of the payload slab */
+          cache->entries[set][ii].data = data;
+          memcpy(data, temp->data, cache->data_size);
+          free(temp->data);
+          ring_remove(list, pos);
           ASSERT(0, ++cache->repl_ctrs[set] <= cache->assoc); /* repl ctr holds the sure count */
           if (cache->repl_ctrs[set] == cache->assoc) {
-            for (temp = (Cache_Entry*)list_start_head_traversal(list); temp;
-                 temp = (Cache_Entry*)list_next_element(list))
-              free(temp->data);
-            clear_list(&cache->unsure_lists[set]);
+            for (pos = 0; pos < list->count; pos++)
+              free(RING_AT(list, Cache_Entry, pos).data);
+            ring_clear(list);
           }
           return cache->entries[set][ii].data;
         }
@@ -769,19 +1127,22 @@ static inline void* access_unsure_lines(Cache* cache, uns set, Addr tag, Flag up
 /* insert_sure_line: */
 
 static inline Cache_Entry* insert_sure_line(Cache* cache, uns set, Addr tag) {
-  List* list = &cache->unsure_lists[set];
+  Ring* list = &cache->unsure_lists[set];
   int ii;
-  if (list_get_head(list) || cache->repl_ctrs[set] == cache->assoc) {
+  if (list->count || cache->repl_ctrs[set] == cache->assoc) {
     /* if there is an unsure list already, or if we have all sure entries... */
     int count = 0;
     for (ii = 0; ii < cache->assoc; ii++) {
       Cache_Entry* entry = &cache->entries[set][ii];
       if (entry->valid) {
-        Cache_Entry* temp = (Cache_Entry*)dl_list_add_tail(list);
+        Cache_Entry* temp = (Cache_Entry*)ring_add_tail(list);
         memcpy(temp, entry, sizeof(Cache_Entry));
-        temp->data = malloc(sizeof(cache->data_size));
-        memcpy(entry->data, temp->data, sizeof(cache->data_size));
+        temp->data = malloc(cache->data_size);
+        memcpy(temp->data, entry->data, cache->data_size);
+        if (cache->meta)
+          cache_meta_event(cache, entry, CACHE_META_EVICT);
         entry->valid = FALSE;
+        cache_sync_tag(cache, set, entry);
         count++;
       }
     }
@@ -805,13 +1166,13 @@ static inline Cache_Entry* insert_sure_line(Cache* cache, uns set, Addr tag) {
 /* invalidate_unsure_line: */
 
 static inline void invalidate_unsure_line(Cache* cache, uns set, Addr tag) {
-  List* list = &cache->unsure_lists[set];
-  Cache_Entry* temp;
-  for (temp = (Cache_Entry*)list_start_head_traversal(list); temp; temp = (Cache_Entry*)list_next_element(list)) {
+  Ring* list = &cache->unsure_lists[set];
+  for (int pos = 0; pos < list->count; pos++) {
+    Cache_Entry* temp = (Cache_Entry*)ring_at(list, pos);
     ASSERT(0, temp->valid);
     if (temp->tag == tag) {
       free(temp->data);
-      dl_list_remove_current(list);
+      ring_remove(list, pos);
       return;
     }
   }
@@ -859,6 +1220,7 @@ void* access_shadow_lines(Cache* cache, uns set, Addr tag) {
         tmp_line = (cache->entries[set][lru_ind]);
         (cache->entries[set][lru_ind]) = *line;
         *line = tmp_line;
+        cache_sync_tag(cache, set, &cache->entries[set][lru_ind]);
         line->last_access_time = (cache->entries[set][lru_ind]).last_access_time;
         (cache->entries[set][lru_ind]).last_access_time = sim_time;
         DEBUG(0,
@@ -1019,10 +1381,13 @@ void* cache_insert_lru(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr, A
     /* insert that entry to the shadow cache */
     if ((cache->repl_policy == REPL_SHADOW_IDEAL) && new_line->valid)
       shadow_cache_insert(cache, set, new_line->tag, new_line->base);
-    if (new_line->valid)  // bug fixed. 4/26/04 if the entry is not valid,
-                          // repl_line_addr should be set to 0
+    if (cache->meta && new_line->valid)
+      cache_meta_event(cache, new_line, CACHE_META_EVICT);
+    if (new_line->valid) {  // bug fixed. 4/26/04 if the entry is not valid,
+                            // repl_line_addr should be set to 0
       *repl_line_addr = new_line->base;
-    else
+      cache_set_prof(cache, set, CACHE_SET_PROF_EVICT);
+    } else
       *repl_line_addr = 0;
     DEBUG(0,
           "Replacing (set %u, way %u, tag 0x%s, base 0x%s) in cache '%s' with "
@@ -1033,10 +1398,13 @@ void* cache_insert_lru(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr, A
   new_line->proc_id = proc_id;
   new_line->valid = TRUE;
   new_line->tag = tag;
+  cache_sync_tag(cache, set, new_line);
   new_line->base = *line_addr;
   update_repl_policy(cache, new_line, set, repl_index, TRUE);
   if (cache->repl_policy == REPL_TRUE_LRU)
     new_line->last_access_time = 137;
+  if (cache->meta)
+    cache_meta_event(cache, new_line, CACHE_META_INSERT);
 
   if (cache->repl_policy == REPL_IDEAL_STORAGE) {
     new_line->last_access_time = cache->assoc;
@@ -1074,6 +1442,7 @@ void* cache_insert_lru(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr, A
       main_line = &cache->entries[set][lru_ind];
       main_line->valid = TRUE;
       main_line->tag = tag;
+      cache_sync_tag(cache, set, main_line);
       main_line->base = *line_addr;
       main_line->last_access_time = sim_time;
     }
@@ -1090,8 +1459,12 @@ void reset_cache(Cache* cache) {
   for (ii = 0; ii < cache->num_sets; ii++) {
     for (jj = 0; jj < cache->assoc; jj++) {
       cache->entries[ii][jj].valid = FALSE;
+      cache_sync_tag(cache, ii, &cache->entries[ii][jj]);
+      if (cache->opt)
+        cache_opt_set_next_use(cache, ii, jj, MAX_CTR);
     }
   }
+  cache_meta_clear(cache);
 }
 
 /**************************************************************************************/
@@ -1109,13 +1482,10 @@ int cache_find_pos_in_lru_stack(Cache* cache, uns8 proc_id, Addr addr, Addr* lin
   Cache_Entry* hit_line = NULL;
   Flag hit = FALSE;
 
-  for (ii = 0; ii < cache->assoc; ii++) {
+  ii = cache_find_way(cache, set, tag, 0);
+  if (ii < cache->assoc) {
     hit_line = &cache->entries[set][ii];
-
-    if (hit_line->valid && hit_line->tag == tag) {
-      hit = TRUE;
-      break;
-    }
+    hit = TRUE;
   }
 
   if (!hit)
@@ -1140,6 +1510,14 @@ void set_partition_allocate(Cache* cache, uns8 proc_id, uns num_ways) {
   cache->num_ways_allocted_core[proc_id] = num_ways;
 }
 
+void set_partition_way_mask(Cache* cache, uns8 proc_id, uns64 way_mask) {
+  ASSERT(proc_id, cache->repl_policy == REPL_PARTITION);
+  ASSERT(proc_id, cache->assoc <= 64);
+  if (!cache->way_mask_core)
+    cache->way_mask_core = (uns64*)calloc(NUM_CORES, sizeof(uns64));
+  cache->way_mask_core[proc_id] = way_mask;
+}
+
 uns get_partition_allocated(Cache* cache, uns8 proc_id) {
   ASSERT(proc_id, cache->repl_policy == REPL_PARTITION);
   ASSERT(proc_id, cache->num_ways_allocted_core);
@@ -1264,13 +1642,19 @@ void* cache_insert_strategy(Cache* cache, uns8 proc_id, Addr addr, Addr* line_ad
   // update_evict -> action_repl -> update_insert
   // External func also directly call it
   new_line = repl_policy_func_table[policy].update_evict(cache, proc_id, set, &repl_index, NULL, FALSE);
+  if (cache->meta && new_line->valid)
+    cache_meta_event(cache, new_line, CACHE_META_EVICT);
 
-  if (new_line->valid)
+  if (new_line->valid) {
     *repl_line_addr = new_line->base;
-  else
+    cache_set_prof(cache, set, CACHE_SET_PROF_EVICT);
+  } else
     *repl_line_addr = 0;
   repl_policy_func_table[policy].action_repl(cache, new_line, proc_id, tag, line_addr, repl_line_addr);
+  cache_sync_tag(cache, set, new_line);
   repl_policy_func_table[policy].update_insert(cache, proc_id, set, repl_index, NULL);
+  if (cache->meta)
+    cache_meta_event(cache, new_line, CACHE_META_INSERT);
 
   return new_line->data;
 }
@@ -1293,15 +1677,15 @@ void* cache_access_strategy(Cache* cache, Addr addr, Addr* line_addr, Flag updat
 
   DEBUG(0, "%s, %d: Access Strategy\n", cache->name, cache->repl_policy);
 
-  for (ii = 0; ii < cache->assoc; ii++) {
-    Cache_Entry* line = &cache->entries[set][ii];
-
-    if (line->valid && line->tag == tag) {
-      if (update_repl)
-        repl_policy_func_table[policy].update_hit(cache, set, ii, NULL);
-
-      return line->data;
+  ii = cache_find_way(cache, set, tag, 0);
+  if (ii < cache->assoc) {
+    if (update_repl) {
+      repl_policy_func_table[policy].update_hit(cache, set, ii, NULL);
+      if (cache->meta)
+        cache_meta_event(cache, &cache->entries[set][ii], CACHE_META_HIT);
     }
+
+    return cache->entries[set][ii].data;
   }
 
   return NULL;
@@ -1339,7 +1723,6 @@ void general_action_init(Cache* cache, const char* name, uns cache_size, uns ass
                          Repl_Policy repl_policy) {
   uns num_lines = cache_size / line_size;
   uns num_sets = cache_size / line_size / assoc;
-  uns ii, jj;
 
   /* set the basic parameters */
   strncpy(cache->name, name, MAX_STR_LENGTH);
@@ -1360,19 +1743,9 @@ void general_action_init(Cache* cache, const char* name, uns cache_size, uns ass
   /* allocate memory for all the sets (pointers to line arrays)  */
   cache->entries = (Cache_Entry**)malloc(sizeof(Cache_Entry*) * num_sets);
 
-  /* allocate memory for all of the lines in each set */
-  for (ii = 0; ii < num_sets; ii++) {
-    cache->entries[ii] = (Cache_Entry*)malloc(sizeof(Cache_Entry) * assoc);
-    /* allocate memory for all of the data elements in each line */
-    for (jj = 0; jj < assoc; jj++) {
-      cache->entries[ii][jj].valid = FALSE;
-      if (data_size) {
-        cache->entries[ii][jj].data = (void*)malloc(data_size);
-        memset(cache->entries[ii][jj].data, 0, data_size);
-      } else
-        cache->entries[ii][jj].data = INIT_CACHE_DATA_VALUE;
-    }
-  }
+  /* allocate memory for all of the lines and their data */
+  cache_alloc_lines(cache->entries, num_sets, assoc, data_size);
+  cache_init_tag_store(cache);
 }
 
 void general_action_repl(Cache* cache, Cache_Entry* new_line, uns8 proc_id, Addr tag, Addr* line_addr,
@@ -1772,6 +2145,225 @@ Cache_Entry* ship_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, vo
   return line;
 }
 
+/**************************************************************************************/
+/* OPT */
+void opt_action_init(Cache* cache, const char* name, uns cache_size, uns assoc, uns line_size, uns data_size,
+                     Repl_Policy repl_policy);
+void opt_update_hit(Cache* cache, uns set, uns way, void* arg);
+void opt_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg);
+Cache_Entry* opt_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external);
+
+/* demand accesses searched ahead for one that is not the next of the recorded stream */
+#define CACHE_OPT_RESYNC_WINDOW 256
+
+struct Cache_Opt_struct {
+  Cache_Opt_Record* records; /* the side file of the CACHE_OPT_RECORD stream */
+  uns64 num_accesses;
+  uns64 pos;            /* next demand access of the stream */
+  uns32 cur_line;       /* line of the last demand access */
+  Counter cur_next_use; /* demand access that next uses the line of the last one */
+  Counter* next_use;    /* [set * assoc + way] demand access that next uses the line (MAX_CTR: none, or invalid) */
+  uns* heap;            /* [set * assoc + ii] the ways of each set as a max-heap on next_use */
+  uns* heap_pos;        /* [set * assoc + way] index of the way in the heap of its set */
+};
+
+static Flag cache_opt_opened = FALSE;
+
+static inline Flag cache_opt_is_demand(const Cache_Record* record) {
+  return record->op == CACHE_RECORD_ACCESS && record->arg;
+}
+
+/* cache_opt_build: the pre-pass.  Keeps the demand accesses of the stream and scans them backwards with the next
+   use of every line in a hash table.  Inserts, probes and invalidates depend on the replacement policy that
+   recorded the stream, so they are left out. */
+static void cache_opt_build(Cache_Opt* opt, FILE* file, uns64 num_records, uns shift_bits) {
+  Cache_Record* records = (Cache_Record*)malloc(sizeof(Cache_Record) * MAX2(num_records, 1));
+  Hash_Table next_uses;
+  uns64 ii, kk;
+
+  ASSERTM(0, records, "Could not allocate the CACHE_OPT_RECORD stream\n");
+  ASSERTM(0, fread(records, sizeof(Cache_Record), num_records, file) == num_records,
+          "Could not read the CACHE_OPT_RECORD stream\n");
+  for (ii = 0, kk = 0; ii < num_records; ii++) {
+    if (cache_opt_is_demand(&records[ii]))
+      records[kk++] = records[ii];
+  }
+  opt->num_accesses = kk;
+  opt->records = (Cache_Opt_Record*)table_alloc("cache_lib", sizeof(Cache_Opt_Record) * MAX2(kk, 1));
+
+  init_hash_table(&next_uses, "cache opt next uses", 1 << 16, sizeof(Counter));
+  for (kk = opt->num_accesses; kk-- > 0;) {
+    Addr line = records[kk].addr >> shift_bits;
+    Flag new_entry;
+    Counter* next = (Counter*)hash_table_access_create(&next_uses, line, &new_entry);
+
+    opt->records[kk].next_use = new_entry ? 0 : (uns32)MIN2(*next - kk, 0xffffffffULL);
+    opt->records[kk].line = (uns32)line;
+    *next = kk;
+  }
+
+  hash_table_clear(&next_uses);
+  free(next_uses.ctrl);
+  free(next_uses.entries);
+  free(next_uses.name);
+  free(records);
+}
+
+/* cache_opt_load: loads the side file of the record, or computes and writes it if it is missing or was computed
+   from another record */
+static void cache_opt_load(Cache_Opt* opt, const char* record_name, uns line_size, uns shift_bits) {
+  char side_name[MAX_STR_LENGTH + 1];
+  Cache_Record_Header header;
+  Cache_Opt_Header side;
+  FILE* file = fopen(record_name, "r");
+  FILE* side_file;
+  uns64 record_bytes;
+
+  ASSERTM(0, file, "Could not open the CACHE_OPT_RECORD file '%s'\n", record_name);
+  ASSERTM(0, fread(&header, sizeof(header), 1, file) == 1 && header.magic == CACHE_RECORD_MAGIC,
+          "Not a CACHE_ACCESS_RECORD file: '%s'\n", record_name);
+  ASSERTM(0, header.line_size == line_size, "CACHE_OPT_RECORD '%s' has %u-byte lines, the cache %u-byte lines\n",
+          record_name, header.line_size, line_size);
+  fseek(file, 0, SEEK_END);
+  record_bytes = ftell(file);
+
+  snprintf(side_name, MAX_STR_LENGTH, "%s.next_use", record_name);
+  side_file = fopen(side_name, "r");
+  if (side_file) {
+    if (fread(&side, sizeof(side), 1, side_file) == 1 && side.magic == CACHE_OPT_MAGIC &&
+        side.line_size == line_size && side.record_bytes == record_bytes) {
+      opt->num_accesses = side.num_accesses;
+      opt->records =
+          (Cache_Opt_Record*)table_alloc("cache_lib", sizeof(Cache_Opt_Record) * MAX2(opt->num_accesses, 1));
+      if (fread(opt->records, sizeof(Cache_Opt_Record), opt->num_accesses, side_file) == opt->num_accesses) {
+        fclose(side_file);
+        fclose(file);
+        return;
+      }
+      table_free("cache_lib", opt->records, sizeof(Cache_Opt_Record) * MAX2(opt->num_accesses, 1));
+    }
+    fclose(side_file);
+  }
+
+  fseek(file, sizeof(header), SEEK_SET);
+  cache_opt_build(opt, file, (record_bytes - sizeof(header)) / sizeof(Cache_Record), shift_bits);
+  fclose(file);
+
+  memset(&side, 0, sizeof(side));
+  side.magic = CACHE_OPT_MAGIC;
+  side.line_size = line_size;
+  side.record_bytes = record_bytes;
+  side.num_accesses = opt->num_accesses;
+  side_file = fopen(side_name, "w");
+  if (!side_file) {
+    WARNINGU(0, "Could not write the REPL_OPT side file '%s'\n", side_name);
+    return;
+  }
+  fwrite(&side, sizeof(side), 1, side_file);
+  fwrite(opt->records, sizeof(Cache_Opt_Record), opt->num_accesses, side_file);
+  fclose(side_file);
+}
+
+void opt_action_init(Cache* cache, const char* name, uns cache_size, uns assoc, uns line_size, uns data_size,
+                     Repl_Policy repl_policy) {
+  Cache_Opt* opt;
+  uns ii, jj;
+
+  general_action_init(cache, name, cache_size, assoc, line_size, data_size, repl_policy);
+  ASSERTM(0, CACHE_OPT_RECORD, "REPL_OPT cache '%s' needs a CACHE_OPT_RECORD stream\n", name);
+  ASSERTM(0, !cache_opt_opened, "REPL_OPT cache '%s': only one cache can replay CACHE_OPT_RECORD\n", name);
+  cache_opt_opened = TRUE;
+
+  opt = (Cache_Opt*)calloc(1, sizeof(Cache_Opt));
+  opt->cur_next_use = MAX_CTR;
+  opt->next_use = (Counter*)table_alloc("cache_lib", sizeof(Counter) * cache->num_lines);
+  opt->heap = (uns*)table_alloc("cache_lib", sizeof(uns) * cache->num_lines);
+  opt->heap_pos = (uns*)table_alloc("cache_lib", sizeof(uns) * cache->num_lines);
+  for (ii = 0; ii < cache->num_sets; ii++) {
+    for (jj = 0; jj < assoc; jj++) {
+      opt->next_use[ii * assoc + jj] = MAX_CTR;
+      opt->heap[ii * assoc + jj] = jj;
+      opt->heap_pos[ii * assoc + jj] = jj;
+    }
+  }
+  cache_opt_load(opt, CACHE_OPT_RECORD, line_size, cache->shift_bits);
+  cache->opt = opt;
+}
+
+/* cache_opt_step: moves the stream past a demand access to addr.  If the simulated stream has left the recorded
+   one, the access is looked for a little further ahead; if it is not there, the line is taken to have no next
+   use. */
+static inline void cache_opt_step(Cache* cache, Addr addr) {
+  Cache_Opt* opt = cache->opt;
+  uns32 line = (uns32)(addr >> cache->shift_bits);
+  uns64 end = MIN2(opt->pos + CACHE_OPT_RESYNC_WINDOW, opt->num_accesses);
+  uns64 pos;
+
+  for (pos = opt->pos; pos < end && opt->records[pos].line != line; pos++)
+    ;
+  if (pos != opt->pos)
+    WARNINGU_ONCE(0, "Cache '%s' left its CACHE_OPT_RECORD stream at access %llu, REPL_OPT is no longer exact\n",
+                  cache->name, opt->pos);
+  opt->cur_line = line;
+  if (pos == end) {
+    opt->cur_next_use = MAX_CTR;
+    return;
+  }
+  opt->cur_next_use = opt->records[pos].next_use ? pos + opt->records[pos].next_use : MAX_CTR;
+  opt->pos = pos + 1;
+}
+
+/* cache_opt_set_next_use: rekeys a way and moves it up or down its set's heap */
+static inline void cache_opt_set_next_use(Cache* cache, uns set, uns way, Counter next_use) {
+  Cache_Opt* opt = cache->opt;
+  uns* heap = &opt->heap[set * cache->assoc];
+  uns* heap_pos = &opt->heap_pos[set * cache->assoc];
+  Counter* key = &opt->next_use[set * cache->assoc];
+  uns ii = heap_pos[way];
+
+  key[way] = next_use;
+  while (ii > 0 && key[heap[(ii - 1) / 2]] < next_use) {
+    heap[ii] = heap[(ii - 1) / 2];
+    heap_pos[heap[ii]] = ii;
+    ii = (ii - 1) / 2;
+  }
+  while (2 * ii + 1 < cache->assoc) {
+    uns child = 2 * ii + 1;
+    if (child + 1 < cache->assoc && key[heap[child + 1]] > key[heap[child]])
+      child++;
+    if (key[heap[child]] <= next_use)
+      break;
+    heap[ii] = heap[child];
+    heap_pos[heap[ii]] = ii;
+    ii = child;
+  }
+  heap[ii] = way;
+  heap_pos[way] = ii;
+}
+
+void opt_update_hit(Cache* cache, uns set, uns way, void* arg) {
+  cache_opt_set_next_use(cache, set, way, cache->opt->cur_next_use);
+  cache_debug_print_set(cache, set, way, CACHE_EVENT_HIT);
+}
+
+void opt_update_insert(Cache* cache, uns8 proc_id, uns set, uns way, void* arg) {
+  Cache_Opt* opt = cache->opt;
+
+  // a fill after its demand miss; lines nothing asked for yet (prefetches) are not in the stream
+  if ((uns32)(cache->entries[set][way].base >> cache->shift_bits) == opt->cur_line)
+    cache_opt_set_next_use(cache, set, way, opt->cur_next_use);
+  else
+    cache_opt_set_next_use(cache, set, way, MAX_CTR);
+  cache_debug_print_set(cache, set, way, CACHE_EVENT_INSERT);
+}
+
+Cache_Entry* opt_update_evict(Cache* cache, uns8 proc_id, uns set, uns* way, void* arg, Flag if_external) {
+  // the line used furthest in the future; invalid ways have no next use and come first
+  *way = cache->opt->heap[set * cache->assoc];
+  cache_debug_print_set(cache, set, *way, CACHE_EVENT_EVICT);
+  return &cache->entries[set][*way];
+}
+
 /**************************************************************************************/
 /* Driven Table */
 
@@ -1783,8 +2375,253 @@ struct repl_policy_func repl_policy_func_table[NUM_REPL] = {
   { REPL_BRRIP,   brrip_action_init,    general_action_repl,  nru_update_hit,     brrip_update_insert,  srrip_update_evict  },
   { REPL_DRRIP,   drrip_action_init,    general_action_repl,  nru_update_hit,     drrip_update_insert,  drrip_update_evict  },
   { REPL_SHIP,    ship_action_init,     general_action_repl,  ship_update_hit,    ship_update_insert,   ship_update_evict   },
+  { REPL_OPT,     opt_action_init,      general_action_repl,  opt_update_hit,     opt_update_insert,    opt_update_evict    },
   { REPL_VOID,    NULL,                 NULL,                 NULL,               NULL,                 NULL                },
 };
 // clang-format on
 
-/**************************************************************************************/
\ No newline at end of file
+/**************************************************************************************/
+/**************************************************************************************/
+/* Warm state image: a Cache_State_Header, the per-set replacement counters,
+   the DRRIP miss counters and partition bookkeeping of caches that have them,
+   one Cache_State_Line per way (sets row major), the line data, and the SHIP
+   signature counters.  The unsure lists and shadow entries of the ideal
+   policies are not part of the image. */
+
+typedef struct Cache_State_Header_struct {
+  uns32 num_sets;
+  uns32 assoc;
+  uns32 line_size;
+  uns32 data_size;
+  uns32 repl_policy;
+  uns32 num_ship_sigs;
+  Counter num_demand_access;
+  Counter last_update;
+  Counter bimodal_count;
+} Cache_State_Header;
+
+typedef struct Cache_State_Line_struct {
+  Addr tag;
+  Addr base;
+  Counter last_access_time;
+  Counter insertion_time;
+  Addr pw_start_addr;
+  uns8 proc_id;
+  Flag valid;
+  Flag pref;
+  Flag dirty;
+  uns8 reference_val;
+  Flag outcome;
+} Cache_State_Line;
+
+typedef struct Cache_State_Sig_struct {
+  int64 sig;
+  Counter count;
+} Cache_State_Sig;
+
+static uns cache_state_num_ship_sigs(Cache* cache) {
+  if (cache->repl_policy != REPL_SHIP)
+    return 0;
+  return ((struct ship_shct*)cache->predictor)->shct_hash.count;
+}
+
+static void cache_state_copy_ship_sig(int64 sig, void* data, void* arg) {
+  Cache_State_Sig** cur = (Cache_State_Sig**)arg;
+  (*cur)->sig = sig;
+  (*cur)->count = *(Counter*)data;
+  (*cur)++;
+}
+
+static uns64 cache_state_image_size(Cache* cache, uns num_ship_sigs) {
+  uns64 num_ways = (uns64)cache->num_sets * cache->assoc;
+  uns64 size = sizeof(Cache_State_Header);
+
+  if (cache->repl_policy < REPL_VOID)
+    size += sizeof(uns) * cache->num_sets;
+  if (cache->repl_policy == REPL_DRRIP)
+    size += sizeof(Counter) * cache->num_sets;
+  if (cache->repl_policy == REPL_PARTITION)
+    size += (3 * sizeof(uns) + sizeof(Counter)) * NUM_CORES;
+  size += num_ways * (sizeof(Cache_State_Line) + cache->data_size);
+  size += sizeof(Cache_State_Sig) * num_ship_sigs;
+  return size;
+}
+
+/* cache_state_size: bytes cache_save_state writes for the cache */
+uns64 cache_state_size(Cache* cache) {
+  return cache_state_image_size(cache, cache_state_num_ship_sigs(cache));
+}
+
+/* cache_save_state: writes the image of the cache into buf, which must hold
+   cache_state_size(cache) bytes */
+void cache_save_state(Cache* cache, void* buf) {
+  uns8* cur = (uns8*)buf;
+  Cache_State_Header header;
+  uns ii, jj;
+
+  memset(&header, 0, sizeof(header));
+  header.num_sets = cache->num_sets;
+  header.assoc = cache->assoc;
+  header.line_size = cache->line_size;
+  header.data_size = cache->data_size;
+  header.repl_policy = cache->repl_policy;
+  header.num_ship_sigs = cache_state_num_ship_sigs(cache);
+  if (cache->repl_policy < REPL_VOID) {
+    header.num_demand_access = cache->num_demand_access;
+    header.last_update = cache->last_update;
+  }
+  if (cache->repl_policy == REPL_BRRIP || cache->repl_policy == REPL_DRRIP)
+    header.bimodal_count = cache->bimodal_count;
+  memcpy(cur, &header, sizeof(header));
+  cur += sizeof(header);
+
+  if (cache->repl_policy < REPL_VOID) {
+    memcpy(cur, cache->repl_ctrs, sizeof(uns) * cache->num_sets);
+    cur += sizeof(uns) * cache->num_sets;
+  }
+  if (cache->repl_policy == REPL_DRRIP) {
+    memcpy(cur, cache->miss_count, sizeof(Counter) * cache->num_sets);
+    cur += sizeof(Counter) * cache->num_sets;
+  }
+  if (cache->repl_policy == REPL_PARTITION) {
+    memcpy(cur, cache->num_ways_allocted_core, sizeof(uns) * NUM_CORES);
+    cur += sizeof(uns) * NUM_CORES;
+    memcpy(cur, cache->num_ways_occupied_core, sizeof(uns) * NUM_CORES);
+    cur += sizeof(uns) * NUM_CORES;
+    memcpy(cur, cache->lru_index_core, sizeof(uns) * NUM_CORES);
+    cur += sizeof(uns) * NUM_CORES;
+    memcpy(cur, cache->lru_time_core, sizeof(Counter) * NUM_CORES);
+    cur += sizeof(Counter) * NUM_CORES;
+  }
+
+  for (ii = 0; ii < cache->num_sets; ii++) {
+    for (jj = 0; jj < cache->assoc; jj++) {
+      Cache_Entry* line = &cache->entries[ii][jj];
+      Cache_State_Line state;
+
+      memset(&state, 0, sizeof(state));
+      state.tag = line->tag;
+      state.base = line->base;
+      state.last_access_time = line->last_access_time;
+      state.insertion_time = line->insertion_time;
+      state.pw_start_addr = line->pw_start_addr;
+      state.proc_id = line->proc_id;
+      state.valid = line->valid;
+      state.pref = line->pref;
+      state.dirty = line->dirty;
+      state.reference_val = line->reference_val;
+      state.outcome = line->outcome;
+      memcpy(cur, &state, sizeof(state));
+      cur += sizeof(state);
+    }
+  }
+
+  if (cache->data_size) {
+    for (ii = 0; ii < cache->num_sets; ii++) {
+      for (jj = 0; jj < cache->assoc; jj++) {
+        memcpy(cur, cache->entries[ii][jj].data, cache->data_size);
+        cur += cache->data_size;
+      }
+    }
+  }
+
+  if (header.num_ship_sigs) {
+    Cache_State_Sig* sig = (Cache_State_Sig*)cur;
+    hash_table_scan_keys(&((struct ship_shct*)cache->predictor)->shct_hash, cache_state_copy_ship_sig, &sig);
+    cur = (uns8*)sig;
+  }
+
+  ASSERT(0, (uns64)(cur - (uns8*)buf) == cache_state_size(cache));
+}
+
+/* cache_load_state: restores an image written by cache_save_state.  Returns
+   FALSE, leaving the cache untouched, if the image does not match the cache's
+   geometry and replacement policy. */
+Flag cache_load_state(Cache* cache, const void* buf, uns64 size) {
+  const uns8* cur = (const uns8*)buf;
+  Cache_State_Header header;
+  uns ii, jj;
+
+  if (size < sizeof(header))
+    return FALSE;
+  memcpy(&header, cur, sizeof(header));
+  cur += sizeof(header);
+  if (header.num_sets != cache->num_sets || header.assoc != cache->assoc || header.line_size != cache->line_size ||
+      header.data_size != cache->data_size || header.repl_policy != (uns32)cache->repl_policy)
+    return FALSE;
+  if (size != cache_state_image_size(cache, header.num_ship_sigs))
+    return FALSE;
+
+  if (cache->repl_policy < REPL_VOID) {
+    cache->num_demand_access = header.num_demand_access;
+    cache->last_update = header.last_update;
+    memcpy(cache->repl_ctrs, cur, sizeof(uns) * cache->num_sets);
+    cur += sizeof(uns) * cache->num_sets;
+  }
+  if (cache->repl_policy == REPL_BRRIP || cache->repl_policy == REPL_DRRIP)
+    cache->bimodal_count = header.bimodal_count;
+  if (cache->repl_policy == REPL_DRRIP) {
+    memcpy(cache->miss_count, cur, sizeof(Counter) * cache->num_sets);
+    cur += sizeof(Counter) * cache->num_sets;
+  }
+  if (cache->repl_policy == REPL_PARTITION) {
+    memcpy(cache->num_ways_allocted_core, cur, sizeof(uns) * NUM_CORES);
+    cur += sizeof(uns) * NUM_CORES;
+    memcpy(cache->num_ways_occupied_core, cur, sizeof(uns) * NUM_CORES);
+    cur += sizeof(uns) * NUM_CORES;
+    memcpy(cache->lru_index_core, cur, sizeof(uns) * NUM_CORES);
+    cur += sizeof(uns) * NUM_CORES;
+    memcpy(cache->lru_time_core, cur, sizeof(Counter) * NUM_CORES);
+    cur += sizeof(Counter) * NUM_CORES;
+  }
+
+  for (ii = 0; ii < cache->num_sets; ii++) {
+    for (jj = 0; jj < cache->assoc; jj++) {
+      Cache_Entry* line = &cache->entries[ii][jj];
+      Cache_State_Line state;
+
+      memcpy(&state, cur, sizeof(state));
+      cur += sizeof(state);
+      line->tag = state.tag;
+      line->base = state.base;
+      line->last_access_time = state.last_access_time;
+      line->insertion_time = state.insertion_time;
+      line->pw_start_addr = state.pw_start_addr;
+      line->proc_id = state.proc_id;
+      line->valid = state.valid;
+      line->pref = state.pref;
+      line->dirty = state.dirty;
+      line->reference_val = state.reference_val;
+      line->outcome = state.outcome;
+      cache_sync_tag(cache, ii, line);
+      if (cache->opt)
+        cache_opt_set_next_use(cache, ii, jj, MAX_CTR);
+    }
+  }
+
+  if (cache->data_size) {
+    for (ii = 0; ii < cache->num_sets; ii++) {
+      for (jj = 0; jj < cache->assoc; jj++) {
+        memcpy(cache->entries[ii][jj].data, cur, cache->data_size);
+        cur += cache->data_size;
+      }
+    }
+  }
+  cache_meta_clear(cache);
+
+  if (cache->repl_policy == REPL_SHIP) {
+    Hash_Table* shct = &((struct ship_shct*)cache->predictor)->shct_hash;
+    hash_table_clear(shct);
+    for (ii = 0; ii < header.num_ship_sigs; ii++) {
+      Cache_State_Sig sig;
+      Flag new_entry;
+
+      memcpy(&sig, cur, sizeof(sig));
+      cur += sizeof(sig);
+      *(Counter*)hash_table_access_create(shct, sig.sig, &new_entry) = sig.count;
+    }
+  }
+
+  ASSERT(0, (uns64)(cur - (const uns8*)buf) == size);
+  return TRUE;
+}
@@ -29,15 +29,24 @@
 #ifndef __CACHE_LIB_H__
 #define __CACHE_LIB_H__
 
+#include <stdio.h>
+
 #include "globals/global_defs.h"
 
 #include "libs/list_lib.h"
+#include "libs/ring_lib.h"
 
 /**************************************************************************************/
 
 /* set data pointers to this initially */
 #define INIT_CACHE_DATA_VALUE ((void*)0x8badbeef)
 
+/* addresses cache_access_multi indexes ahead of its probes */
+#define CACHE_ACCESS_MULTI_CHUNK 8
+
+/* tag store value of an invalid way */
+#define CACHE_TAG_INVALID MAX_ADDR
+
 /**************************************************************************************/
 
 typedef enum Repl_Policy_enum {
@@ -63,6 +72,7 @@ typedef enum Repl_Policy_enum {
   REPL_BRRIP,   /* bimodal re-reference interval prediction */
   REPL_DRRIP,   /* dynamic re-reference interval prediction */
   REPL_SHIP,    /* signature-based hit predictor */
+  REPL_OPT,     /* Belady's optimal replacement over a recorded stream (CACHE_OPT_RECORD) */
 
   NUM_REPL
 } Repl_Policy;
@@ -99,7 +109,85 @@ typedef enum Cache_Insert_Repl_enum {
   NUM_INSERT_REPL
 } Cache_Insert_Repl;
 
-typedef struct Cache_struct {
+/* CACHE_ACCESS_RECORD writes a Cache_Record_Header with the geometry of the cache, followed by one Cache_Record per
+   access, insert and invalidate, so that test/libs_bench.cc can replay them on an identical cache */
+#define CACHE_RECORD_MAGIC 0x31434353 /* "SCC1" */
+
+typedef enum Cache_Record_Op_enum {
+  CACHE_RECORD_ACCESS,     /* arg: update_repl */
+  CACHE_RECORD_INSERT,     /* arg: Cache_Insert_Repl, CACHE_RECORD_PREF for prefetches */
+  CACHE_RECORD_INVALIDATE, /* arg: unused */
+} Cache_Record_Op;
+
+#define CACHE_RECORD_PREF 0x80
+
+typedef struct Cache_Record_Header_struct {
+  uns32 magic;
+  uns32 cache_size;
+  uns32 assoc;
+  uns32 line_size;
+  uns32 data_size;
+  uns32 repl_policy;
+} Cache_Record_Header;
+
+typedef struct Cache_Record_struct {
+  Addr addr;
+  uns8 op;
+  uns8 proc_id;
+  uns8 arg;
+} Cache_Record;
+
+/* REPL_OPT replays the demand accesses (those that update the replacement state) of a CACHE_ACCESS_RECORD file.
+   The first run on a record writes a side file with one Cache_Opt_Record per demand access next to it, as
+   <record>.next_use, that later runs load directly */
+#define CACHE_OPT_MAGIC 0x314f4353 /* "SCO1" */
+
+typedef struct Cache_Opt_Header_struct {
+  uns32 magic;
+  uns32 line_size;
+  uns64 record_bytes; /* size of the record file the side file was computed from */
+  uns64 num_accesses;
+} Cache_Opt_Header;
+
+/* SET_PROF_CACHES counts, for each set of the named caches, the accesses (cache_access and cache_access_multi),
+   the misses among them and the valid lines evicted by inserts.  debug/set_prof.c samples and clears the counters
+   of every profiled cache once per interval. */
+typedef enum Cache_Set_Prof_Counter_enum {
+  CACHE_SET_PROF_ACCESS,
+  CACHE_SET_PROF_MISS,
+  CACHE_SET_PROF_EVICT,
+  CACHE_SET_PROF_COUNTERS,
+} Cache_Set_Prof_Counter;
+
+typedef struct Cache_Opt_Record_struct {
+  uns32 next_use; /* demand accesses until the next one to the same line (0: none, saturates) */
+  uns32 line;     /* low 32 bits of the line number, to check that the stream is followed */
+} Cache_Opt_Record;
+
+typedef struct Cache_Opt_struct Cache_Opt;
+
+/* Per-line metadata: a prefetcher or profiler registers a fixed-size slot with cache_meta_register before the cache
+   is used, and gets the slot of each line (zeroed when the line is inserted) passed to its callbacks on a demand hit
+   (cache_access with update_repl), after an insert and before an eviction or invalidation.  The slots of all lines
+   are one slab in (set, way) order, like the tag store, so reaching the slot of a line costs no lookup.  Lines
+   restored by cache_load_state or dropped by reset_cache get zeroed slots without callbacks, and only the lines of
+   cache->entries have slots (not the shadow or unsure lines of the ideal policies). */
+typedef struct Cache_struct Cache;
+typedef void (*Cache_Meta_Func)(Cache* cache, Cache_Entry* line, void* meta, void* arg);
+
+typedef struct Cache_Meta_Ops_struct {
+  Cache_Meta_Func hit;    /* NULL: not interested */
+  Cache_Meta_Func insert; /* NULL: not interested */
+  Cache_Meta_Func evict;  /* NULL: not interested */
+  void* arg;
+} Cache_Meta_Ops;
+
+typedef struct Cache_Meta_Slot_struct {
+  uns offset; /* of the slot in the metadata of a line */
+  Cache_Meta_Ops ops;
+} Cache_Meta_Slot;
+
+struct Cache_struct {
   char name[MAX_STR_LENGTH + 1]; /* name to identify the cache (for debugging) */
   uns data_size;                 /* how big are the data items in each cache entry? (for malloc) */
 
@@ -120,8 +208,12 @@ typedef struct Cache_struct {
   /* A dynamically allocated array of all of the cache entries. The array is two-dimensional, sets are row major. */
   Cache_Entry** entries;
 
+  /* Dense copy of the entries' tags, assoc per set (CACHE_TAG_STORE).  Invalid ways hold CACHE_TAG_INVALID, so a
+     lookup scans this array and only reads the Cache_Entry of a matching way.  NULL when disabled. */
+  Addr* tags;
+
   /* A linked list for each set in the cache that is used when simulating ideal replacement policies */
-  List* unsure_lists;
+  Ring* unsure_lists;
 
   Flag perfect;                 /* is the cache perfect (for henry mem system) */
   uns repl_pref_thresh;         /* threshhold for how many entries are high-priority. */
@@ -135,6 +227,7 @@ typedef struct Cache_struct {
   uns* num_ways_occupied_core; /* For cache partitioning */
   uns* lru_index_core;         /* For cache partitioning */
   Counter* lru_time_core;      /* For cache partitioning */
+  uns64* way_mask_core;        /* For cache partitioning: ways each core may fill (NULL: any) */
 
   Flag tag_incl_offset; /* The uop cache is byte-addressable, so the tag includes offset bits as well */
 
@@ -145,7 +238,16 @@ typedef struct Cache_struct {
 
   /* For repl with predictor */
   void* predictor;
-} Cache;
+
+  FILE* record;   /* CACHE_ACCESS_RECORD output (NULL if this cache is not recorded) */
+  uns32* set_prof; /* SET_PROF_CACHES counters of the current interval, [num_sets][CACHE_SET_PROF_COUNTERS] (or NULL) */
+  Cache_Opt* opt; /* REPL_OPT next-use state (NULL for the other policies) */
+
+  char* meta;                  /* metadata slab, [num_sets * assoc][meta_size] (NULL: no slots registered) */
+  uns meta_size;               /* bytes of metadata per line */
+  uns num_meta_slots;          /* slots registered with cache_meta_register */
+  Cache_Meta_Slot* meta_slots; /* [num_meta_slots] */
+};
 
 /**************************************************************************************/
 /* Strategy Design */
@@ -176,6 +278,7 @@ const static Flag CACHE_DEBUG_ENABLE = FALSE;  // To be Changed into DEBUG_PARA
 
 void init_cache(Cache*, const char*, uns, uns, uns, uns, Repl_Policy);
 void* cache_access(Cache*, Addr, Addr*, Flag);
+void cache_access_multi(Cache* cache, uns num, const Addr* addrs, Addr* line_addrs, void** lines, Flag update_repl);
 void* cache_insert(Cache*, uns8, Addr, Addr*, Addr*);
 void* cache_insert_replpos(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr, Addr* repl_line_addr,
                            Cache_Insert_Repl insert_repl_policy, Flag isPrefetch);
@@ -196,6 +299,24 @@ void reset_cache(Cache*);
 int cache_find_pos_in_lru_stack(Cache* cache, uns8 proc_id, Addr addr, Addr* line_addr);
 void set_partition_allocate(Cache* cache, uns8 proc_id, uns num_ways);
 uns get_partition_allocated(Cache* cache, uns8 proc_id);
+void set_partition_way_mask(Cache* cache, uns8 proc_id, uns64 way_mask);
+
+/* The caches that keep SET_PROF_CACHES counters, in initialization order */
+Cache* const* cache_set_prof_caches(uns* num);
+
+/* Per-line metadata (see Cache_Meta_Ops).  cache_meta_register returns the slot id.  cache_line_meta takes a line
+   of the cache, cache_data_meta the line data returned by cache_access or cache_insert (the cache must have a
+   non-zero data_size), and cache_meta the address of a line, returning NULL if it is not in the cache. */
+uns cache_meta_register(Cache* cache, uns size, const Cache_Meta_Ops* ops);
+void* cache_line_meta(Cache* cache, Cache_Entry* line, uns slot);
+void* cache_data_meta(Cache* cache, void* data, uns slot);
+void* cache_meta(Cache* cache, Addr addr, uns slot);
+
+/* Warm state: a flat image of a cache's lines, line data and replacement state
+   that cache_load_state restores into a cache of the same geometry */
+uns64 cache_state_size(Cache* cache);
+void cache_save_state(Cache* cache, void* buf);
+Flag cache_load_state(Cache* cache, const void* buf, uns64 size);
 
 /**************************************************************************************/
 
@@ -1,6 +1,9 @@
 #include "libs/cpp_hash_lib_wrapper.h"
 
+#include "globals/global_defs.h"
+
 #include <iostream>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -31,19 +34,38 @@ struct hash_fn {
   }
 };
 
-std::unordered_map<key, Inst_Info *, hash_fn> hash_map;
+// Inst_Info of every static uop seen by each core; the entries hold the cmp address of their core
+std::unordered_map<key, Inst_Info *, hash_fn> hash_map[MAX_NUM_PROCS];
+
+// Table_Info shared by all cores: cores running the same binary decode to the same static info, so only one copy of
+// it is kept. Entries are never removed or changed once inserted, so a pointer returned by
+// cpp_table_info_intern stays valid and may be read by any core without the lock.
+std::unordered_map<key, Table_Info *, hash_fn> table_info_map;
+std::mutex table_info_lock;
 
 Inst_Info *cpp_hash_table_access_create(int core, uint64_t addr, uint64_t lsb_bytes, uint64_t msb_bytes, uint8_t op_idx,
                                         unsigned char *new_entry) {
   *new_entry = false;
   key _key(addr, lsb_bytes, msb_bytes, op_idx);
-  auto lookup = hash_map.find(_key);
-  if (lookup != hash_map.end()) {
+  auto lookup = hash_map[core].find(_key);
+  if (lookup != hash_map[core].end()) {
     return lookup->second;
   } else {
     Inst_Info *info = new Inst_Info();  //&vec.back();
-    hash_map.insert(std::pair<key, Inst_Info *>(_key, info));
+    hash_map[core].insert(std::pair<key, Inst_Info *>(_key, info));
     *new_entry = true;
     return info;
   }
 }
+
+Table_Info *cpp_table_info_intern(uint64_t addr, uint64_t lsb_bytes, uint64_t msb_bytes, uint8_t op_idx,
+                                  const Table_Info *table_info) {
+  key _key(addr, lsb_bytes, msb_bytes, op_idx);
+  std::lock_guard<std::mutex> guard(table_info_lock);
+  auto lookup = table_info_map.find(_key);
+  if (lookup != table_info_map.end())
+    return lookup->second;
+  Table_Info *shared = new Table_Info(*table_info);
+  table_info_map.insert(std::pair<key, Table_Info *>(_key, shared));
+  return shared;
+}
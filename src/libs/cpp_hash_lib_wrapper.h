@@ -9,8 +9,12 @@ extern "C" {
 
 // class cpp_hash_lib_wrapper {
 
+// per-core Inst_Info of the static uop op_idx of the instruction at addr with the given encoding
 Inst_Info *cpp_hash_table_access_create(int core, uint64_t addr, uint64_t lsb_bytes, uint64_t msb_bytes, uint8_t op_idx,
                                         unsigned char *new_entry);
+// returns the copy of table_info shared by all cores for this static uop, inserting table_info on the first call
+Table_Info *cpp_table_info_intern(uint64_t addr, uint64_t lsb_bytes, uint64_t msb_bytes, uint8_t op_idx,
+                                  const Table_Info *table_info);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,13 @@
+// CPP cache with the associativity, replacement policy and set indexing fixed at compile time.
+
+#ifndef __CPP_STATIC_CACHE_H__
+#define __CPP_STATIC_CACHE_H__
+
+#include "globals/global_types.h"
+
+#include "cache_lib.h"
+#include "cpp_cache.h"
+
+#include "cpp_static_cache.tpp"
+
+#endif
@@ -0,0 +1,380 @@
+// CPP cache with the associativity, replacement policy and set indexing fixed at compile time.
+//
+// Cpp_Static_Cache<Key, Data, Index, Policy, ASSOC> keeps the ways of each set in flat arrays and resolves the
+// replacement policy and the set index function statically, so the way loops are inlined (and unrolled when ASSOC is
+// non-zero; ASSOC == 0 takes the associativity at construction time).
+//
+// Index is a class constructed with (num_sets, line_bytes) that provides
+//   uns set(const Key&) const        -- set index of a key
+//   Addr signature(const Key&) const -- PC-like signature for SHiP
+//
+// Policy is a class template over ASSOC providing
+//   void init(uns num_sets, uns assoc)
+//   void hit(uns set, uns way, Addr sig)
+//   void insert(uns set, uns way, Addr sig)   -- a new line went into the way
+//   void evict(uns set, uns way)              -- a valid line left the way by replacement
+//   uns victim(uns set, const Flag* valid)    -- way to replace; prefer valid ways
+//
+// Cpp_Cache_Intf and new_cpp_static_cache pick one instantiation from a runtime Repl_Policy and associativity for
+// callers whose configuration comes from parameters: one virtual call per operation instead of a policy switch per way.
+
+#include <vector>
+
+extern "C" {
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+}
+
+/**************************************************************************************/
+/* Replacement policies */
+
+// helper for policies that take the associativity as a template parameter
+template <uns ASSOC>
+struct Cpp_Cache_Ways {
+  uns assoc_rt;
+  inline uns assoc() const { return ASSOC ? ASSOC : assoc_rt; }
+};
+
+// true LRU by access cycle; ties go to the lowest way
+template <uns ASSOC>
+class Cpp_Cache_Lru : public Cpp_Cache_Ways<ASSOC> {
+  std::vector<Counter> accessed_cycle;
+
+ public:
+  void init(uns num_sets, uns assoc) {
+    this->assoc_rt = assoc;
+    accessed_cycle.assign(num_sets * assoc, 0);
+  }
+  void hit(uns set, uns way, Addr sig) { accessed_cycle[set * this->assoc() + way] = cycle_count; }
+  void insert(uns set, uns way, Addr sig) { accessed_cycle[set * this->assoc() + way] = cycle_count; }
+  void evict(uns set, uns way) {}
+  uns victim(uns set, const Flag* valid) {
+    const Counter* cycles = &accessed_cycle[set * this->assoc()];
+    Counter lru_cycle = MAX_CTR;
+    uns repl_idx = 0;
+    for (uns i = 0; i < this->assoc(); i++) {
+      if (valid[i] && cycles[i] < lru_cycle) {
+        repl_idx = i;
+        lru_cycle = cycles[i];
+      }
+    }
+    return repl_idx;
+  }
+};
+
+// random among the valid ways
+template <uns ASSOC>
+class Cpp_Cache_Random : public Cpp_Cache_Ways<ASSOC> {
+ public:
+  void init(uns num_sets, uns assoc) { this->assoc_rt = assoc; }
+  void hit(uns set, uns way, Addr sig) {}
+  void insert(uns set, uns way, Addr sig) {}
+  void evict(uns set, uns way) {}
+  uns victim(uns set, const Flag* valid) {
+    uns num_valid = 0;
+    for (uns i = 0; i < this->assoc(); i++)
+      num_valid += valid[i];
+    if (!num_valid)
+      return rand() % this->assoc();
+    uns pick = rand() % num_valid;
+    for (uns i = 0; i < this->assoc(); i++)
+      if (valid[i] && !pick--)
+        return i;
+    return 0;
+  }
+};
+
+// next valid way after the last victim
+template <uns ASSOC>
+class Cpp_Cache_Round_Robin : public Cpp_Cache_Ways<ASSOC> {
+  std::vector<uns> next_evict;
+
+ public:
+  void init(uns num_sets, uns assoc) {
+    this->assoc_rt = assoc;
+    next_evict.assign(num_sets, 0);
+  }
+  void hit(uns set, uns way, Addr sig) {}
+  void insert(uns set, uns way, Addr sig) {}
+  void evict(uns set, uns way) {}
+  uns victim(uns set, const Flag* valid) {
+    uns start_idx = (next_evict[set] + 1) % this->assoc();
+    for (uns offset = 0; offset < this->assoc(); offset++) {
+      uns candidate_idx = (start_idx + offset) % this->assoc();
+      if (valid[candidate_idx]) {
+        next_evict[set] = candidate_idx;
+        return candidate_idx;
+      }
+    }
+    next_evict[set] = start_idx;
+    return start_idx;
+  }
+};
+
+// 2-bit re-reference interval prediction; Jaleel et al., ISCA 2010
+template <uns ASSOC>
+class Cpp_Cache_Srrip : public Cpp_Cache_Ways<ASSOC> {
+ protected:
+  static constexpr uns8 RRPV_MAX = 3;
+  std::vector<uns8> rrpv;
+
+  void insert_at(uns set, uns way, uns8 value) { rrpv[set * this->assoc() + way] = value; }
+
+ public:
+  void init(uns num_sets, uns assoc) {
+    this->assoc_rt = assoc;
+    rrpv.assign(num_sets * assoc, RRPV_MAX);
+  }
+  void hit(uns set, uns way, Addr sig) { rrpv[set * this->assoc() + way] = 0; }
+  void insert(uns set, uns way, Addr sig) { insert_at(set, way, RRPV_MAX - 1); }
+  void evict(uns set, uns way) {}
+  uns victim(uns set, const Flag* valid) {
+    uns8* values = &rrpv[set * this->assoc()];
+    uns8 oldest = 0;
+    uns repl_idx = 0;
+    Flag any_valid = FALSE;
+    // age the set by the distance the oldest valid line still needs to reach RRPV_MAX
+    for (uns i = 0; i < this->assoc(); i++) {
+      if (valid[i] && (!any_valid || values[i] > oldest)) {
+        oldest = values[i];
+        repl_idx = i;
+        any_valid = TRUE;
+      }
+    }
+    if (any_valid && oldest < RRPV_MAX) {
+      uns8 age = RRPV_MAX - oldest;
+      for (uns i = 0; i < this->assoc(); i++)
+        if (valid[i])
+          values[i] += age;
+    }
+    return repl_idx;
+  }
+};
+
+// set dueling between SRRIP and bimodal RRIP insertion
+template <uns ASSOC>
+class Cpp_Cache_Drrip : public Cpp_Cache_Srrip<ASSOC> {
+  static constexpr uns DUEL_PERIOD = 32;  // one SRRIP and one BRRIP leader set per period
+  static constexpr uns PSEL_MAX = 1023;
+  static constexpr uns BIMODAL_PERIOD = 32;  // BRRIP inserts at RRPV_MAX - 1 once per period
+  uns psel;
+  uns bimodal_count;
+
+ public:
+  void init(uns num_sets, uns assoc) {
+    Cpp_Cache_Srrip<ASSOC>::init(num_sets, assoc);
+    psel = PSEL_MAX / 2;
+    bimodal_count = 0;
+  }
+  void insert(uns set, uns way, Addr sig) {
+    uns leader = set % DUEL_PERIOD;
+    Flag brrip;
+    if (leader == 0) {
+      psel += psel < PSEL_MAX;  // a miss in an SRRIP leader favors BRRIP
+      brrip = FALSE;
+    } else if (leader == 1) {
+      psel -= psel > 0;
+      brrip = TRUE;
+    } else {
+      brrip = psel > PSEL_MAX / 2;
+    }
+    if (brrip && ++bimodal_count % BIMODAL_PERIOD)
+      this->insert_at(set, way, this->RRPV_MAX);
+    else
+      this->insert_at(set, way, this->RRPV_MAX - 1);
+  }
+};
+
+// signature-based hit prediction on top of SRRIP; Wu et al., MICRO 2011
+template <uns ASSOC>
+class Cpp_Cache_Ship : public Cpp_Cache_Srrip<ASSOC> {
+  static constexpr uns SHCT_BITS = 14;
+  static constexpr uns8 SHCT_MAX = 3;
+  std::vector<uns8> shct;  // signature history counter table
+  std::vector<uns> line_sig;
+  std::vector<Flag> line_reused;
+
+  static inline uns shct_index(Addr sig) {
+    return (sig ^ (sig >> SHCT_BITS) ^ (sig >> (2 * SHCT_BITS))) & N_BIT_MASK(SHCT_BITS);
+  }
+
+ public:
+  void init(uns num_sets, uns assoc) {
+    Cpp_Cache_Srrip<ASSOC>::init(num_sets, assoc);
+    shct.assign(1 << SHCT_BITS, 1);
+    line_sig.assign(num_sets * assoc, 0);
+    line_reused.assign(num_sets * assoc, FALSE);
+  }
+  void hit(uns set, uns way, Addr sig) {
+    uns idx = set * this->assoc() + way;
+    Cpp_Cache_Srrip<ASSOC>::hit(set, way, sig);
+    line_reused[idx] = TRUE;
+    shct[line_sig[idx]] += shct[line_sig[idx]] < SHCT_MAX;
+  }
+  void insert(uns set, uns way, Addr sig) {
+    uns idx = set * this->assoc() + way;
+    line_sig[idx] = shct_index(sig);
+    line_reused[idx] = FALSE;
+    this->insert_at(set, way, shct[line_sig[idx]] ? this->RRPV_MAX - 1 : this->RRPV_MAX);
+  }
+  void evict(uns set, uns way) {
+    uns idx = set * this->assoc() + way;
+    if (!line_reused[idx])
+      shct[line_sig[idx]] -= shct[line_sig[idx]] > 0;
+  }
+};
+
+/**************************************************************************************/
+/* Cache */
+
+template <typename User_Key_Type, typename User_Data_Type>
+class Cpp_Cache_Intf {
+ public:
+  virtual ~Cpp_Cache_Intf() = default;
+  virtual User_Data_Type* access(User_Key_Type key, bool update_repl) = 0;
+  virtual Entry<User_Key_Type, User_Data_Type> insert(User_Key_Type key, User_Data_Type data) = 0;
+  virtual Entry<User_Key_Type, User_Data_Type> invalidate(User_Key_Type key) = 0;
+  virtual uns get_free_space(User_Key_Type key) = 0;
+  virtual Entry<User_Key_Type, User_Data_Type> evict_one_line(User_Key_Type key) = 0;
+};
+
+template <typename User_Key_Type, typename User_Data_Type, class Index, template <uns> class Policy, uns ASSOC = 0>
+class Cpp_Static_Cache : public Cpp_Cache_Intf<User_Key_Type, User_Data_Type> {
+  typedef Entry<User_Key_Type, User_Data_Type> Cache_Entry_Type;
+
+  uns assoc_rt;
+  uns num_sets;
+  Index index;
+  Policy<ASSOC> policy;
+  std::vector<Flag> valid;
+  std::vector<User_Key_Type> keys;
+  std::vector<User_Data_Type> datas;
+
+  inline uns assoc() const { return ASSOC ? ASSOC : assoc_rt; }
+
+  // way of the valid line holding key in set, or assoc()
+  inline uns find(uns set, const User_Key_Type& key) const {
+    const Flag* set_valid = &valid[set * assoc()];
+    const User_Key_Type* set_keys = &keys[set * assoc()];
+    for (uns i = 0; i < assoc(); i++)
+      if (set_valid[i] && set_keys[i] == key)
+        return i;
+    return assoc();
+  }
+
+  inline Cache_Entry_Type entry(uns set, uns way) const {
+    uns idx = set * assoc() + way;
+    return Cache_Entry_Type{valid[idx], keys[idx], datas[idx], 0};
+  }
+
+ public:
+  Cpp_Static_Cache(uns nl, uns asc, uns lb)
+      : assoc_rt(asc), num_sets(nl / asc), index(nl / asc, lb), valid(nl, FALSE), keys(nl), datas(nl) {
+    ASSERT(0, !ASSOC || ASSOC == asc);
+    ASSERT(0, num_sets * asc == nl);
+    policy.init(num_sets, asc);
+  }
+
+  // access: Looks up the cache based on key. Returns pointer to line data if found
+  User_Data_Type* access(User_Key_Type key, bool update_repl) override {
+    uns set = index.set(key);
+    uns way = find(set, key);
+    if (way == assoc())
+      return NULL;
+    if (update_repl)
+      policy.hit(set, way, index.signature(key));
+    return &datas[set * assoc() + way];
+  }
+
+  // insert: the key must not be present; returns the replaced entry, which is an eviction victim iff it is valid
+  Entry<User_Key_Type, User_Data_Type> insert(User_Key_Type key, User_Data_Type data) override {
+    uns set = index.set(key);
+    uns way;
+    ASSERT(0, find(set, key) == assoc());
+
+    for (way = 0; way < assoc(); way++)
+      if (!valid[set * assoc() + way])
+        break;
+    if (way == assoc()) {
+      way = policy.victim(set, &valid[set * assoc()]);
+      policy.evict(set, way);
+    }
+
+    Cache_Entry_Type evicted_entry = entry(set, way);
+    uns idx = set * assoc() + way;
+    valid[idx] = TRUE;
+    keys[idx] = key;
+    datas[idx] = data;
+    policy.insert(set, way, index.signature(key));
+    return evicted_entry;
+  }
+
+  Entry<User_Key_Type, User_Data_Type> invalidate(User_Key_Type key) override {
+    uns set = index.set(key);
+    uns way = find(set, key);
+    if (way == assoc())
+      return Cache_Entry_Type{};
+    Cache_Entry_Type invalidated_entry = entry(set, way);
+    valid[set * assoc() + way] = FALSE;
+    return invalidated_entry;
+  }
+
+  uns get_free_space(User_Key_Type key) override {
+    const Flag* set_valid = &valid[index.set(key) * assoc()];
+    uns free_count = 0;
+    for (uns i = 0; i < assoc(); i++)
+      free_count += !set_valid[i];
+    return free_count;
+  }
+
+  // evict_one_line: invalidates the policy's victim in key's set and returns it
+  Entry<User_Key_Type, User_Data_Type> evict_one_line(User_Key_Type key) override {
+    uns set = index.set(key);
+    uns way = policy.victim(set, &valid[set * assoc()]);
+    Cache_Entry_Type evicted_entry = entry(set, way);
+    if (evicted_entry.valid)
+      policy.evict(set, way);
+    valid[set * assoc() + way] = FALSE;
+    return evicted_entry;
+  }
+};
+
+/**************************************************************************************/
+/* new_cpp_static_cache: instantiates the cache for a runtime policy and associativity.  Associativities without a
+   specialization use the runtime-associativity instantiation. */
+
+template <typename User_Key_Type, typename User_Data_Type, class Index, template <uns> class Policy>
+Cpp_Cache_Intf<User_Key_Type, User_Data_Type>* new_cpp_static_cache_assoc(uns nl, uns asc, uns lb) {
+  switch (asc) {
+    case 4:
+      return new Cpp_Static_Cache<User_Key_Type, User_Data_Type, Index, Policy, 4>(nl, asc, lb);
+    case 8:
+      return new Cpp_Static_Cache<User_Key_Type, User_Data_Type, Index, Policy, 8>(nl, asc, lb);
+    case 16:
+      return new Cpp_Static_Cache<User_Key_Type, User_Data_Type, Index, Policy, 16>(nl, asc, lb);
+    default:
+      return new Cpp_Static_Cache<User_Key_Type, User_Data_Type, Index, Policy, 0>(nl, asc, lb);
+  }
+}
+
+template <typename User_Key_Type, typename User_Data_Type, class Index>
+Cpp_Cache_Intf<User_Key_Type, User_Data_Type>* new_cpp_static_cache(uns nl, uns asc, uns lb, Repl_Policy rp) {
+  switch (rp) {
+    case REPL_TRUE_LRU:
+      return new_cpp_static_cache_assoc<User_Key_Type, User_Data_Type, Index, Cpp_Cache_Lru>(nl, asc, lb);
+    case REPL_RANDOM:
+      return new_cpp_static_cache_assoc<User_Key_Type, User_Data_Type, Index, Cpp_Cache_Random>(nl, asc, lb);
+    case REPL_ROUND_ROBIN:
+      return new_cpp_static_cache_assoc<User_Key_Type, User_Data_Type, Index, Cpp_Cache_Round_Robin>(nl, asc, lb);
+    case REPL_SRRIP:
+      return new_cpp_static_cache_assoc<User_Key_Type, User_Data_Type, Index, Cpp_Cache_Srrip>(nl, asc, lb);
+    case REPL_DRRIP:
+      return new_cpp_static_cache_assoc<User_Key_Type, User_Data_Type, Index, Cpp_Cache_Drrip>(nl, asc, lb);
+    case REPL_SHIP:
+      return new_cpp_static_cache_assoc<User_Key_Type, User_Data_Type, Index, Cpp_Cache_Ship>(nl, asc, lb);
+    default:
+      ASSERTM(0, FALSE, "Replacement policy %d is not supported by Cpp_Static_Cache\n", rp);
+      return NULL;
+  }
+}
@@ -29,6 +29,9 @@
 #include "libs/hash_lib.h"
 
 #include <stdlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "globals/assert.h"
 #include "globals/global_defs.h"
@@ -43,28 +46,209 @@
 /**************************************************************************************/
 /* Macros */
 
-#define DEBUG(args...) _DEBUG(DEBUG_HASH_LIB, ##args)
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_HASH_LIB, ##args)
 
-int64 HASH_INDEX(const Hash_Table* table, int64 key);
-int64 HASH_INDEX(const Hash_Table* table, int64 key) {
-  int64_t mask = (~0UL) % table->buckets;
-  int64_t hash = 0;
-  int log2 = 64 - __builtin_clzl(table->buckets);
-  for (int i = 0; i < 64; i += log2) {
-    hash ^= (key & mask);
-    key = key >> log2;
-  }
+#define HASH_CTRL_EMPTY 0x80
+#define HASH_CTRL_DELETED 0xfe
+#define HASH_CTRL_FULL(ctrl) (!((ctrl)&0x80))
+
+#define HASH_H1(hash) ((hash) >> 7)
+#define HASH_H2(hash) ((uns8)((hash)&0x7f))
+
+/* grow when full plus deleted slots would pass 7/8 of the table */
+#define HASH_TABLE_MAX_LOAD(buckets) ((buckets) - (buckets) / 8)
+
+typedef uns Hash_Group_Mask;  // one bit per slot of a group
+
+/**************************************************************************************/
+/* Prototypes */
+
+static inline uns64 hash_table_hash(int64 key);
+static inline Hash_Group_Mask hash_group_match(uns8 const* group, uns8 value);
+static inline Hash_Group_Mask hash_group_match_empty_or_deleted(uns8 const* group);
+static inline int hash_table_find(Hash_Table const* table, int64 key, void const* data);
+static inline uns hash_table_find_free(Hash_Table const* table, uns64 hash);
+static uns hash_table_insert(Hash_Table* table, int64 key);
+static void hash_table_resize(Hash_Table* table, uns new_buckets);
+static void hash_table_delete_slot(Hash_Table* table, uns slot);
+
+/**************************************************************************************/
+/* hash_table_hash: the keys are often addresses or small integers, so spread
+   them out with the murmur3 finalizer before taking slot bits */
+
+static inline uns64 hash_table_hash(int64 key) {
+  uns64 hash = (uns64)key;
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
   return hash;
 }
 
 /**************************************************************************************/
-// Global variables
+/* hash_group_match: bit mask of the slots in the group whose control byte
+   equals value */
+
+static inline Hash_Group_Mask hash_group_match(uns8 const* group, uns8 value) {
+#ifdef __SSE2__
+  __m128i ctrl = _mm_loadu_si128((__m128i const*)group);
+  return (Hash_Group_Mask)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)value)));
+#else
+  Hash_Group_Mask mask = 0;
+  uns ii;
+  for (ii = 0; ii < HASH_TABLE_GROUP_SIZE; ii++)
+    mask |= (Hash_Group_Mask)(group[ii] == value) << ii;
+  return mask;
+#endif
+}
+
+/* empty and deleted are the only control bytes with the top bit set */
+static inline Hash_Group_Mask hash_group_match_empty_or_deleted(uns8 const* group) {
+#ifdef __SSE2__
+  return (Hash_Group_Mask)_mm_movemask_epi8(_mm_loadu_si128((__m128i const*)group));
+#else
+  Hash_Group_Mask mask = 0;
+  uns ii;
+  for (ii = 0; ii < HASH_TABLE_GROUP_SIZE; ii++)
+    mask |= (Hash_Group_Mask)(group[ii] >> 7) << ii;
+  return mask;
+#endif
+}
+
+/**************************************************************************************/
+/* hash_table_find: returns the slot holding key (and, for complex tables, an
+   element equal to data), or -1.  Groups are probed triangularly, which visits
+   every group of a power-of-2 table; a group with an empty slot ends the
+   probe because no insert could have gone past it. */
+
+static inline int hash_table_find(Hash_Table const* table, int64 key, void const* data) {
+  uns64 hash = hash_table_hash(key);
+  uns group_mask = table->buckets / HASH_TABLE_GROUP_SIZE - 1;
+  uns group = HASH_H1(hash) & group_mask;
+  uns8 h2 = HASH_H2(hash);
+  uns step;
+
+  for (step = 1;; step++) {
+    uns base = group * HASH_TABLE_GROUP_SIZE;
+    Hash_Group_Mask match = hash_group_match(&table->ctrl[base], h2);
+    while (match) {
+      uns slot = base + __builtin_ctz(match);
+      Hash_Table_Entry const* entry = &table->entries[slot];
+      if (entry->key == key && (!data || table->eq_func(entry->data, data)))
+        return slot;
+      match &= match - 1;
+    }
+    if (hash_group_match(&table->ctrl[base], HASH_CTRL_EMPTY))
+      return -1;
+    ASSERT(0, step <= group_mask + 1);
+    group = (group + step) & group_mask;
+  }
+}
+
+/**************************************************************************************/
+/* hash_table_find_free: first empty or deleted slot on the probe sequence */
+
+static inline uns hash_table_find_free(Hash_Table const* table, uns64 hash) {
+  uns group_mask = table->buckets / HASH_TABLE_GROUP_SIZE - 1;
+  uns group = HASH_H1(hash) & group_mask;
+  uns step;
+
+  for (step = 1;; step++) {
+    uns base = group * HASH_TABLE_GROUP_SIZE;
+    Hash_Group_Mask free_mask = hash_group_match_empty_or_deleted(&table->ctrl[base]);
+    if (free_mask)
+      return base + __builtin_ctz(free_mask);
+    ASSERT(0, step <= group_mask + 1);
+    group = (group + step) & group_mask;
+  }
+}
+
+/**************************************************************************************/
+/* hash_table_insert: claims a slot for a key known not to be present (or, for
+   a complex table, not equal to any element with that key), growing the table
+   first if needed.  Returns the slot; its data pointer is left to the caller. */
+
+static uns hash_table_insert(Hash_Table* table, int64 key) {
+  uns64 hash = hash_table_hash(key);
+  uns slot = hash_table_find_free(table, hash);
+
+  if (table->ctrl[slot] == HASH_CTRL_EMPTY && table->count + table->tombstones + 1 > HASH_TABLE_MAX_LOAD(table->buckets)) {
+    /* mostly tombstones: rebuild at the same size, otherwise double */
+    if (table->count + 1 <= HASH_TABLE_MAX_LOAD(table->buckets) / 2)
+      hash_table_resize(table, table->buckets);
+    else
+      hash_table_resize(table, table->buckets * 2);
+    slot = hash_table_find_free(table, hash);
+  }
+
+  if (table->ctrl[slot] == HASH_CTRL_DELETED)
+    table->tombstones--;
+  table->ctrl[slot] = HASH_H2(hash);
+  table->entries[slot].key = key;
+  table->entries[slot].data = NULL;
+  table->count++;
+  return slot;
+}
+
+/**************************************************************************************/
+/* hash_table_resize: rebuilds the table with new_buckets slots, dropping the
+   tombstones */
+
+static void hash_table_resize(Hash_Table* table, uns new_buckets) {
+  uns8* old_ctrl = table->ctrl;
+  Hash_Table_Entry* old_entries = table->entries;
+  uns old_buckets = table->buckets;
+  uns ii;
 
-#define NUM_HASH_TABLE_PRIMES 12
-static uns const hash_table_primes[NUM_HASH_TABLE_PRIMES] = {1, 5, 11, 23, 47, 101, 211, 401, 811, 1601, 3209, 6373};
+  ASSERT(0, new_buckets >= HASH_TABLE_GROUP_SIZE && !(new_buckets & (new_buckets - 1)));
+  ASSERT(0, table->count <= HASH_TABLE_MAX_LOAD(new_buckets));
+  DEBUG(0, "Resizing hash table %s from %u to %u slots (%d entries)\n", table->name, old_buckets, new_buckets,
+        table->count);
+
+  table->buckets = new_buckets;
+  table->tombstones = 0;
+  table->ctrl = (uns8*)malloc(new_buckets);
+  ASSERT(0, table->ctrl);
+  memset(table->ctrl, HASH_CTRL_EMPTY, new_buckets);
+  table->entries = (Hash_Table_Entry*)malloc(new_buckets * sizeof(Hash_Table_Entry));
+  ASSERT(0, table->entries);
+
+  for (ii = 0; ii < old_buckets; ii++) {
+    if (HASH_CTRL_FULL(old_ctrl[ii])) {
+      uns64 hash = hash_table_hash(old_entries[ii].key);
+      uns slot = hash_table_find_free(table, hash);
+      table->ctrl[slot] = HASH_H2(hash);
+      table->entries[slot] = old_entries[ii];
+    }
+  }
+
+  free(old_ctrl);
+  free(old_entries);
+}
+
+/**************************************************************************************/
+/* hash_table_delete_slot: frees the element and releases the slot.  The slot
+   can go back to empty if its group already has an empty slot, since then no
+   probe sequence continues past the group. */
+
+static void hash_table_delete_slot(Hash_Table* table, uns slot) {
+  uns base = slot & ~(HASH_TABLE_GROUP_SIZE - 1);
+
+  sfree(table->data_size, table->entries[slot].data);
+  if (hash_group_match(&table->ctrl[base], HASH_CTRL_EMPTY))
+    table->ctrl[slot] = HASH_CTRL_EMPTY;
+  else {
+    table->ctrl[slot] = HASH_CTRL_DELETED;
+    table->tombstones++;
+  }
+  table->count--;
+  ASSERT(0, table->count >= 0);
+}
 
 /**************************************************************************************/
-/* init_hash_table: */
+/* init_hash_table: buckets is only the initial size hint; the table grows as
+   needed */
 
 void init_hash_table(Hash_Table* table, const char* name, uns buckets, uns data_size) {
   init_complex_hash_table(table, name, buckets, data_size, NULL);
@@ -72,11 +256,21 @@ void init_hash_table(Hash_Table* table, const char* name, uns buckets, uns data_
 
 void init_complex_hash_table(Hash_Table* table, const char* name, uns buckets, uns data_size,
                              Flag (*eq_func)(void const*, void const*)) {
+  uns slots = HASH_TABLE_GROUP_SIZE;
+
+  while (HASH_TABLE_MAX_LOAD(slots) < buckets)
+    slots *= 2;
+
   table->name = strdup(name);
-  table->buckets = buckets;
+  table->buckets = slots;
   table->data_size = data_size;
   table->count = 0;
-  table->entries = (Hash_Table_Entry**)calloc(buckets, sizeof(Hash_Table_Entry*));
+  table->tombstones = 0;
+  table->ctrl = (uns8*)malloc(slots);
+  ASSERT(0, table->ctrl);
+  memset(table->ctrl, HASH_CTRL_EMPTY, slots);
+  table->entries = (Hash_Table_Entry*)malloc(slots * sizeof(Hash_Table_Entry));
+  ASSERT(0, table->entries);
   table->eq_func = eq_func;
 }
 
@@ -86,32 +280,20 @@ void init_complex_hash_table(Hash_Table* table, const char* name, uns buckets, u
 
 void* hash_table_access(Hash_Table const* table, int64 key) {
   // {{{ access hash table using simple key compare
-  uns index = HASH_INDEX(table, key);
-  Hash_Table_Entry* bucket = table->entries[index];
-  Hash_Table_Entry* temp;
-
-  for (temp = bucket; temp != NULL; temp = temp->next)
-    if (temp->key == key)
-      return temp->data;
-
-  return NULL;
+  int slot = hash_table_find(table, key, NULL);
+  return slot < 0 ? NULL : table->entries[slot].data;
   // }}}
 }
 
 void* complex_hash_table_access(Hash_Table const* table, int64 key, void const* data) {
   // {{{ access hash table using a complex comparison
-  uns index = HASH_INDEX(table, key);
-  Hash_Table_Entry* bucket = table->entries[index];
-  Hash_Table_Entry* temp;
+  int slot;
 
   ASSERT(0, table->eq_func);
   ASSERT(0, data);
 
-  for (temp = bucket; temp != NULL; temp = temp->next)
-    if (temp->key == key && table->eq_func(temp->data, data))
-      return temp->data;
-
-  return NULL;
+  slot = hash_table_find(table, key, data);
+  return slot < 0 ? NULL : table->entries[slot].data;
   // }}}
 }
 
@@ -122,78 +304,45 @@ void* complex_hash_table_access(Hash_Table const* table, int64 key, void const*
 
 void* hash_table_access_create(Hash_Table* table, int64 key, Flag* new_entry) {
   // {{{ access hash table using simple key compare
-  uns index = HASH_INDEX(table, key);
-  Hash_Table_Entry* bucket = table->entries[index];
-  Hash_Table_Entry* new_hash = NULL;
-  Hash_Table_Entry* temp;
-  Hash_Table_Entry* prev = NULL;
+  int slot = hash_table_find(table, key, NULL);
 
   *new_entry = FALSE;
-  ASSERT(0, index < table->buckets);
-  for (temp = bucket; temp != NULL; temp = temp->next) {
-    if (temp->key == key)
-      return temp->data;
-    else
-      prev = temp;
-  }
-  table->count++;
+  if (slot >= 0)
+    return table->entries[slot].data;
+
   *new_entry = TRUE;
-  new_hash = (Hash_Table_Entry*)smalloc(sizeof(Hash_Table_Entry));
-  ASSERT(0, new_hash);
-  new_hash->key = key;
-  new_hash->next = NULL;
-  new_hash->data = (void*)smalloc(table->data_size);
-  ASSERT(0, new_hash->data);
-
-  if (prev)
-    prev->next = new_hash;
-  else
-    table->entries[index] = new_hash;
-
-  _DEBUGA(0, 0, "smalloc'd %ld bytes for %s (%d entries)\n",
-          (unsigned long int)sizeof(Hash_Table_Entry) + table->data_size, table->name, table->count);
-
-  return new_hash->data;
+  slot = hash_table_insert(table, key);
+  table->entries[slot].data = (void*)smalloc(table->data_size);
+  ASSERT(0, table->entries[slot].data);
+
+  _DEBUGA(0, 0, "smalloc'd %ld bytes for %s (%d entries)\n", (unsigned long int)table->data_size, table->name,
+          table->count);
+
+  return table->entries[slot].data;
   // }}}
 }
 
 void* complex_hash_table_access_create(Hash_Table* table, int64 key, void const* data, Flag* new_entry) {
   // {{{ access hash table using a complex comparison
-  uns index = HASH_INDEX(table, key);
-  Hash_Table_Entry* bucket = table->entries[index];
-  Hash_Table_Entry* new_hash = NULL;
-  Hash_Table_Entry* temp;
-  Hash_Table_Entry* prev = NULL;
+  int slot;
 
   ASSERT(0, table->eq_func);
   ASSERT(0, data);
 
   *new_entry = FALSE;
-  ASSERT(0, index < table->buckets);
-  for (temp = bucket; temp != NULL; temp = temp->next) {
-    if (temp->key == key && table->eq_func(temp->data, data))
-      return temp->data;
-    else
-      prev = temp;
-  }
-  table->count++;
+  slot = hash_table_find(table, key, data);
+  if (slot >= 0)
+    return table->entries[slot].data;
+
   *new_entry = TRUE;
-  new_hash = (Hash_Table_Entry*)smalloc(sizeof(Hash_Table_Entry));
-  ASSERT(0, new_hash);
-  new_hash->key = key;
-  new_hash->next = NULL;
-  new_hash->data = (void*)smalloc(table->data_size);
-  ASSERT(0, new_hash->data);
-
-  if (prev)
-    prev->next = new_hash;
-  else
-    table->entries[index] = new_hash;
-
-  _DEBUGA(0, 0, "smalloc'd %ld bytes for %s (%d entries)\n",
-          (unsigned long int)sizeof(Hash_Table_Entry) + table->data_size, table->name, table->count);
-
-  return new_hash->data;
+  slot = hash_table_insert(table, key);
+  table->entries[slot].data = (void*)smalloc(table->data_size);
+  ASSERT(0, table->entries[slot].data);
+
+  _DEBUGA(0, 0, "smalloc'd %ld bytes for %s (%d entries)\n", (unsigned long int)table->data_size, table->name,
+          table->count);
+
+  return table->entries[slot].data;
   // }}}
 }
 
@@ -203,58 +352,27 @@ void* complex_hash_table_access_create(Hash_Table* table, int64 key, void const*
 
 Flag hash_table_access_delete(Hash_Table* table, int64 key) {
   // {{{ access hash table using simple key compare
-  uns index = HASH_INDEX(table, key);
-  Hash_Table_Entry* bucket = table->entries[index];
-  Hash_Table_Entry* temp;
-  Hash_Table_Entry* prev = NULL;
-
-  for (temp = bucket; temp != NULL; temp = temp->next) {
-    if (temp->key == key) {
-      Hash_Table_Entry* next_ptr = temp->next;
-      sfree(table->data_size, temp->data);
-      sfree(sizeof(Hash_Table_Entry), temp);
-      if (prev)
-        prev->next = next_ptr;
-      else
-        table->entries[index] = next_ptr;
-      table->count--;
-      ASSERT(0, table->count >= 0);
-      return TRUE;
-    } else
-      prev = temp;
-  }
+  int slot = hash_table_find(table, key, NULL);
 
-  return FALSE;
+  if (slot < 0)
+    return FALSE;
+  hash_table_delete_slot(table, slot);
+  return TRUE;
   // }}}
 }
 
 Flag complex_hash_table_access_delete(Hash_Table* table, int64 key, void const* data) {
   // {{{ access hash table using a complex comparison
-  uns index = HASH_INDEX(table, key);
-  Hash_Table_Entry* bucket = table->entries[index];
-  Hash_Table_Entry* temp;
-  Hash_Table_Entry* prev = NULL;
+  int slot;
 
   ASSERT(0, table->eq_func);
   ASSERT(0, data);
 
-  for (temp = bucket; temp != NULL; temp = temp->next) {
-    if (temp->key == key && table->eq_func(temp->data, data)) {
-      Hash_Table_Entry* next_ptr = temp->next;
-      sfree(table->data_size, temp->data);
-      sfree(sizeof(Hash_Table_Entry), temp);
-      if (prev)
-        prev->next = next_ptr;
-      else
-        table->entries[index] = next_ptr;
-      table->count--;
-      ASSERT(0, table->count >= 0);
-      return TRUE;
-    } else
-      prev = temp;
-  }
-
-  return FALSE;
+  slot = hash_table_find(table, key, data);
+  if (slot < 0)
+    return FALSE;
+  hash_table_delete_slot(table, slot);
+  return TRUE;
   // }}}
 }
 
@@ -262,24 +380,19 @@ Flag complex_hash_table_access_delete(Hash_Table* table, int64 key, void const*
 /* hash_table_clear: */
 
 void hash_table_clear(Hash_Table* table) {
-  Hash_Table_Entry* temp0;
-  Hash_Table_Entry* temp1;
   uns count = 0;
-  int ii;
+  uns ii;
 
   for (ii = 0; ii < table->buckets; ii++) {
-    temp0 = table->entries[ii];
-    while (temp0) {
-      temp1 = temp0->next;
-      sfree(table->data_size, temp0->data);
-      sfree(sizeof(Hash_Table_Entry), temp0);
-      temp0 = temp1;
+    if (HASH_CTRL_FULL(table->ctrl[ii])) {
+      sfree(table->data_size, table->entries[ii].data);
       count++;
     }
-    table->entries[ii] = NULL;
   }
+  memset(table->ctrl, HASH_CTRL_EMPTY, table->buckets);
   ASSERT(0, count == table->count);
   table->count = 0;
+  table->tombstones = 0;
 }
 
 /**************************************************************************************/
@@ -288,10 +401,9 @@ void hash_table_clear(Hash_Table* table) {
  */
 
 void** hash_table_flatten(Hash_Table* table, void** reuse_array) {
-  Hash_Table_Entry* temp;
   void** new_array;
   uns count = 0;
-  int ii;
+  uns ii;
 
   if (table->count == 0)
     return NULL;
@@ -304,14 +416,9 @@ void** hash_table_flatten(Hash_Table* table, void** reuse_array) {
   }
 
   /* write into the new array */
-  count = 0;
-  for (ii = 0; ii < table->buckets; ii++) {
-    temp = table->entries[ii];
-    while (temp) {
-      new_array[count++] = temp->data;
-      temp = temp->next;
-    }
-  }
+  for (ii = 0; ii < table->buckets; ii++)
+    if (HASH_CTRL_FULL(table->ctrl[ii]))
+      new_array[count++] = table->entries[ii].data;
 
   ASSERTM(0, count == table->count, "%d %d\n", count, table->count);
   ASSERTM(0, count > 0, "%d %d\n", count, table->count);
@@ -325,8 +432,7 @@ void** hash_table_flatten(Hash_Table* table, void** reuse_array) {
 
 void hash_table_scan(Hash_Table* table, void (*scan_func)(void*, void*), void* arg) {
   int count = 0;
-  Hash_Table_Entry* temp;
-  int ii;
+  uns ii;
 
   ASSERT(0, scan_func);
 
@@ -334,64 +440,52 @@ void hash_table_scan(Hash_Table* table, void (*scan_func)(void*, void*), void* a
     return;
 
   for (ii = 0; ii < table->buckets; ii++) {
-    temp = table->entries[ii];
-    while (temp) {
+    if (HASH_CTRL_FULL(table->ctrl[ii])) {
       count++;
-      scan_func(temp->data, arg);
-      temp = temp->next;
+      scan_func(table->entries[ii].data, arg);
     }
   }
   ASSERT(0, count == table->count);
 }
 
 /**************************************************************************************/
-// hash_table_rehash: expand or contract the hash table
-// WARNING: this hasn't really been tested
+// hash_table_scan_keys: like hash_table_scan, but also passes each element's key
 
-void hash_table_rehash(Hash_Table* table, int new_buckets) {
-  Hash_Table_Entry** new_entries;
-  Hash_Table_Entry** flat_entries;
-  Hash_Table_Entry** old_entries = table->entries;
-  uns old_buckets = table->buckets;
-  Hash_Table_Entry* temp;
-  uns ii, jj;
+void hash_table_scan_keys(Hash_Table* table, void (*scan_func)(int64, void*, void*), void* arg) {
+  int count = 0;
+  uns ii;
 
-  ASSERT(0, new_buckets >= 0);
-  if (new_buckets == 0) {  // use next prime
-    new_buckets = table->buckets;
-    for (ii = 0; ii < NUM_HASH_TABLE_PRIMES - 1; ii++)
-      if (hash_table_primes[ii] == old_buckets) {
-        new_buckets = hash_table_primes[ii + 1];
-        break;
-      }
-  }
-  if (new_buckets == old_buckets)
-    return;
+  ASSERT(0, scan_func);
 
-  // flatten hash table into an array of entries
-  flat_entries = (Hash_Table_Entry**)malloc(table->count * sizeof(Hash_Table_Entry*));
-  for (ii = 0, jj = 0; ii < old_buckets; ii++)
-    for (temp = old_entries[ii]; temp; temp = temp->next)
-      flat_entries[jj++] = temp;
-  ASSERT(0, jj == table->count);
-
-  // replace old with new and free the old entry array
-  new_entries = (Hash_Table_Entry**)calloc(new_buckets, sizeof(Hash_Table_Entry*));
-  ASSERT(0, new_entries);
-  ASSERT(0, new_buckets > 0 && new_buckets < 100000);
-  table->buckets = new_buckets;
-  table->entries = new_entries;
-  free(old_entries);
+  if (table->count == 0)
+    return;
 
-  // insert each element
-  for (ii = 0; ii < table->count; ii++) {
-    Hash_Table_Entry* temp = flat_entries[ii];
-    uns index = HASH_INDEX(table, temp->key);
-    temp->next = table->entries[index];
-    table->entries[index] = temp;
+  for (ii = 0; ii < table->buckets; ii++) {
+    if (HASH_CTRL_FULL(table->ctrl[ii])) {
+      count++;
+      scan_func(table->entries[ii].key, table->entries[ii].data, arg);
+    }
   }
+  ASSERT(0, count == table->count);
+}
 
-  free(flat_entries);
+/**************************************************************************************/
+// hash_table_rehash: expand or contract the hash table.  The table already
+// grows on its own; this is for callers that want to presize it or give back
+// memory.  new_buckets of 0 doubles the table.
+
+void hash_table_rehash(Hash_Table* table, int new_buckets) {
+  uns slots = HASH_TABLE_GROUP_SIZE;
+
+  ASSERT(0, new_buckets >= 0);
+  if (new_buckets == 0)
+    new_buckets = table->buckets * 2;
+  while (slots < new_buckets || HASH_TABLE_MAX_LOAD(slots) < table->count)
+    slots *= 2;
+  if (slots == table->buckets && table->tombstones == 0)
+    return;
+
+  hash_table_resize(table, slots);
 }
 
 /**************************************************************************************/
@@ -400,40 +494,18 @@ void hash_table_rehash(Hash_Table* table, int new_buckets) {
 //                            if it doesn't exist yet
 void hash_table_access_replace(Hash_Table* table, int64 key, void* replacement) {
   // {{{ access hash table using simple key compare
-  uns index = HASH_INDEX(table, key);
-  Hash_Table_Entry* bucket = table->entries[index];
-  Hash_Table_Entry* new_hash = NULL;
-  Hash_Table_Entry* temp;
-  Hash_Table_Entry* prev = NULL;
-  Flag new_entry = FALSE;
-  UNUSED(new_entry);
+  int slot = hash_table_find(table, key, NULL);
+
   ASSERT(0, replacement);
-  ASSERT(0, index < table->buckets);
-  for (temp = bucket; temp != NULL; temp = temp->next) {
-    if (temp->key == key) {
-      /* May not want to free the memory in case there are other valid pointers
-         to it. ASSERT(0,temp->data); free(table->data_size, temp->data);
-      */
-      temp->data = replacement;
-      return;
-    } else {
-      prev = temp;
-    }
+  if (slot >= 0) {
+    /* May not want to free the memory in case there are other valid pointers
+       to it. ASSERT(0,temp->data); free(table->data_size, temp->data);
+    */
+    table->entries[slot].data = replacement;
+    return;
   }
-  table->count++;
-  new_entry = TRUE;
-  new_hash = (Hash_Table_Entry*)smalloc(sizeof(Hash_Table_Entry));
-  ASSERT(0, new_hash);
-  new_hash->key = key;
-  new_hash->next = NULL;
-  new_hash->data = replacement;
-
-  if (prev)
-    prev->next = new_hash;
-  else
-    table->entries[index] = new_hash;
-
-  _DEBUGA(0, 0, "smalloc'd %ld bytes for %s (%d entries)\n", (unsigned long int)sizeof(Hash_Table_Entry), table->name,
-          table->count);
+
+  slot = hash_table_insert(table, key);
+  table->entries[slot].data = replacement;
   // }}}
 }
@@ -35,18 +35,28 @@
 /**************************************************************************************/
 /* Types */
 
+/* Open-addressed table in the style of a Swiss table: slots are split into
+   groups of HASH_TABLE_GROUP_SIZE, and each slot has a control byte holding
+   either the low 7 bits of the key's hash or an empty/deleted marker.  A lookup
+   compares a whole group of control bytes at once and only looks at the slots
+   whose byte matches.  The data elements are allocated separately so that the
+   pointers handed out stay valid when the table grows. */
+
+#define HASH_TABLE_GROUP_SIZE 16
+
 typedef struct Hash_Table_Entry_struct {
   int64 key;
   void* data;
-  struct Hash_Table_Entry_struct* next;
 } Hash_Table_Entry;
 
 typedef struct Hash_Table_struct {
   char* name;
-  uns buckets;
+  uns buckets;  // number of slots (power of 2, grown automatically)
   uns data_size;
-  int count;  // total number of elements in the hash table
-  Hash_Table_Entry** entries;
+  int count;       // total number of elements in the hash table
+  int tombstones;  // deleted slots that still break probe sequences
+  uns8* ctrl;      // control byte per slot
+  Hash_Table_Entry* entries;
   Flag (*eq_func)(void const* const, void const* const);
 } Hash_Table;
 
@@ -66,6 +76,7 @@ Flag complex_hash_table_access_delete(Hash_Table*, int64, void const*);
 void hash_table_clear(Hash_Table*);
 void** hash_table_flatten(Hash_Table*, void**);
 void hash_table_scan(Hash_Table*, void (*)(void*, void*), void*);
+void hash_table_scan_keys(Hash_Table*, void (*)(int64, void*, void*), void*);
 void hash_table_rehash(Hash_Table*, int);
 
 void hash_table_access_replace(Hash_Table*, int64, void*);
@@ -27,94 +27,100 @@
  ***************************************************************************************/
 #include "libs/malloc_lib.h"
 
+#include <stdlib.h>
+
 #include "globals/assert.h"
 #include "globals/global_defs.h"
 #include "globals/global_types.h"
 #include "globals/global_vars.h"
+#include "globals/utils.h"
 
 #include "debug/debug_macros.h"
 
 /* Defines */
-#define MAX_SMALLOC 32768
-#define WRAPPER_BLOCK 1024
-#define SMALLOC_BLOCK (0x1 << 20)
+#define SMALLOC_SMALL_STEP 8
+#define SMALLOC_SMALL_MAX 256
+#define SMALLOC_NUM_SMALL (SMALLOC_SMALL_MAX / SMALLOC_SMALL_STEP) /* classes 1 .. 32 */
+#define SMALLOC_NUM_CLASSES (SMALLOC_NUM_SMALL + 1 + 7)            /* then 512 .. 32768 */
+#define SMALLOC_CHUNK (0x1 << 20)
+
+/* Free blocks hold the pointer to the next free block of their class */
+typedef struct SMalloc_Free_struct {
+  struct SMalloc_Free_struct* next;
+} SMalloc_Free;
 
 /* Global Variables */
-static char* raw_mem_ptr = NULL;
-static int raw_mem_size = 0;
-static SMalloc_Entry* wrapper_free_list = NULL;
-static SMalloc_Entry* smalloc_free_list[MAX_SMALLOC];
+static __thread char* chunk_ptr = NULL;
+static __thread int chunk_size = 0;
+static __thread SMalloc_Free* free_lists[SMALLOC_NUM_CLASSES];
 
-static inline SMalloc_Entry* get_wrapper();
-static inline void free_wrapper(SMalloc_Entry* wrap);
+static inline uns smalloc_class(int nbytes);
+static inline int smalloc_class_size(uns size_class);
 
 /**************************************************************************************/
-/* get_wrapper */
-static inline SMalloc_Entry* get_wrapper() {
-  SMalloc_Entry* tmp;
-
-  if (wrapper_free_list == NULL) {
-    char* wrap_mem = (char*)malloc(sizeof(SMalloc_Entry) * WRAPPER_BLOCK);
-    SMalloc_Entry* cur_wrap;
-    int ii;
-    ASSERT(0, wrap_mem);
-    for (ii = 0; ii < WRAPPER_BLOCK; ii++) {
-      cur_wrap = (SMalloc_Entry*)wrap_mem;
-      cur_wrap->next = wrapper_free_list;
-      wrapper_free_list = cur_wrap;
-      wrap_mem += sizeof(SMalloc_Entry);
-    }
-  }
-  tmp = wrapper_free_list;
-  wrapper_free_list = wrapper_free_list->next;
-  return tmp;
+/* smalloc_class: */
+static inline uns smalloc_class(int nbytes) {
+  if (nbytes <= SMALLOC_SMALL_MAX)
+    return nbytes <= SMALLOC_SMALL_STEP ? 1 : (nbytes + SMALLOC_SMALL_STEP - 1) / SMALLOC_SMALL_STEP;
+  /* 257 .. 512 is the first power of 2 class */
+  return SMALLOC_NUM_SMALL + 1 + (31 - __builtin_clz(nbytes - 1)) - LOG2(SMALLOC_SMALL_MAX);
 }
 
 /**************************************************************************************/
-/* free_wrapper */
-static inline void free_wrapper(SMalloc_Entry* wrap) {
-  wrap->next = wrapper_free_list;
-  wrapper_free_list = wrap;
+/* smalloc_class_size: */
+static inline int smalloc_class_size(uns size_class) {
+  if (size_class <= SMALLOC_NUM_SMALL)
+    return size_class * SMALLOC_SMALL_STEP;
+  return SMALLOC_SMALL_MAX << (size_class - SMALLOC_NUM_SMALL);
 }
 
 /**************************************************************************************/
 /* smalloc */
 void* smalloc(int nbytes) {
-  SMalloc_Entry* tmp;
-  void* ptr = NULL;
+  if (nbytes > SMALLOC_MAX_SIZE) {
+    void* ptr = malloc(nbytes);
+    ASSERT(0, ptr);
+    return ptr;
+  }
+
+  uns size_class = smalloc_class(nbytes);
+  SMalloc_Free* block = free_lists[size_class];
+  if (block) {
+    free_lists[size_class] = block->next;
+    return block;
+  }
 
-  ASSERT(0, nbytes < MAX_SMALLOC);
-  if (smalloc_free_list[nbytes]) {
-    tmp = smalloc_free_list[nbytes];
-    smalloc_free_list[nbytes] = smalloc_free_list[nbytes]->next;
-    ptr = tmp->data;
-    free_wrapper(tmp);
-  } else { /* need to allocate some memory */
-    if (nbytes > raw_mem_size) {
-      while (raw_mem_size >= sizeof(SMalloc_Entry)) { /* never can have too many wrappers */
-        tmp = (SMalloc_Entry*)raw_mem_ptr;
-        free_wrapper(tmp);
-        raw_mem_ptr += sizeof(SMalloc_Entry);
-        raw_mem_size -= sizeof(SMalloc_Entry);
-      }
-      /* Yes, we waste up to 7 bytes per SMALLOC_BLOCK allocation */
-      raw_mem_ptr = (char*)malloc(SMALLOC_BLOCK);
-      ASSERT(0, raw_mem_ptr);
-      raw_mem_size = SMALLOC_BLOCK;
+  int size = smalloc_class_size(size_class);
+  if (size > chunk_size) {
+    /* the rest of the old chunk goes to the free lists of the classes it fits */
+    while (chunk_size >= SMALLOC_SMALL_STEP) {
+      uns rest_class = smalloc_class(chunk_size);
+      if (smalloc_class_size(rest_class) > chunk_size)
+        rest_class--;
+      int rest_size = smalloc_class_size(rest_class);
+      sfree(rest_size, chunk_ptr);
+      chunk_ptr += rest_size;
+      chunk_size -= rest_size;
     }
-    ptr = raw_mem_ptr;
-    raw_mem_ptr += nbytes;
-    raw_mem_size -= nbytes;
+    chunk_ptr = (char*)malloc(SMALLOC_CHUNK);
+    ASSERT(0, chunk_ptr);
+    chunk_size = SMALLOC_CHUNK;
   }
-  ASSERT(0, ptr);
+  void* ptr = chunk_ptr;
+  chunk_ptr += size;
+  chunk_size -= size;
   return ptr;
 }
 
 /**************************************************************************************/
 /* sfree */
 void sfree(int nbytes, void* item) {
-  SMalloc_Entry* wrapper = get_wrapper();
-  wrapper->next = smalloc_free_list[nbytes];
-  wrapper->data = item;
-  smalloc_free_list[nbytes] = wrapper;
+  if (nbytes > SMALLOC_MAX_SIZE) {
+    free(item);
+    return;
+  }
+  uns size_class = smalloc_class(nbytes);
+  SMalloc_Free* block = (SMalloc_Free*)item;
+  block->next = free_lists[size_class];
+  free_lists[size_class] = block;
 }
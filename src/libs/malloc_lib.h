@@ -29,15 +29,14 @@
 #ifndef __MALLOC_LIB_H__
 #define __MALLOC_LIB_H__
 
-typedef struct SMalloc_Raw_struct {
-  char* ptr;
-  int cur_size;
-} SMalloc_Raw;
+/* smalloc rounds each request up to a size class (multiples of 8 bytes up to 256, then
+   powers of 2 up to SMALLOC_MAX_SIZE) and keeps a free list per class and thread, threaded
+   through the free blocks themselves.  A thread never touches another thread's lists, so
+   the cores can allocate in parallel without locks; a block freed by another thread simply
+   joins that thread's list.  Larger requests go to malloc.  sfree must be given the size
+   that was passed to smalloc. */
 
-typedef struct SMalloc_Entry_struct {
-  void* data;
-  struct SMalloc_Entry_struct* next;
-} SMalloc_Entry;
+#define SMALLOC_MAX_SIZE 32768
 
 void* smalloc(int nbytes);
 void sfree(int nbytes, void* item);
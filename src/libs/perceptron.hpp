@@ -145,13 +145,13 @@ class PerceptronTable {
 
   // helpful functions
   static void extract_bipolar_features(int input, double* output, int num_features) {
-    for (u_int i = 0; i < num_features; ++i) {
+    for (int i = 0; i < num_features; ++i) {
       output[i] = (input & (1 << i)) ? 1.0 : -1.0;
     }
   }
 
   static void extract_binary_features(int input, double* output, int num_features) {
-    for (u_int i = 0; i < num_features; ++i) {
+    for (int i = 0; i < num_features; ++i) {
       output[i] = (input & (1 << i)) ? 1.0 : 0.0;
     }
   }
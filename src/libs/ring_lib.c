@@ -0,0 +1,150 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : libs/ring_lib.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : A growable ring buffer of fixed-size elements, addressed by position
+ ***************************************************************************************/
+
+#include "libs/ring_lib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_LIST_LIB, ##args)
+
+/**************************************************************************************/
+/* Prototypes */
+
+static void ring_grow(Ring*);
+
+/**************************************************************************************/
+/* init_ring: */
+
+void init_ring(Ring* ring, const char* name, uns data_size, uns capacity) {
+  DEBUG(0, "Initializing ring called '%s'.\n", name);
+  ring->name = name;
+  ring->data_size = data_size;
+  ring->capacity = 1;
+  while (ring->capacity < capacity)
+    ring->capacity <<= 1;
+  ring->head = 0;
+  ring->count = 0;
+  ring->data = (char*)malloc(ring->capacity * data_size);
+}
+
+/**************************************************************************************/
+/* ring_grow: doubles the array, unwrapping the elements to start at slot 0 */
+
+static void ring_grow(Ring* ring) {
+  char* data = (char*)malloc(2 * ring->capacity * ring->data_size);
+  uns first = ring->capacity - ring->head;
+  memcpy(data, ring->data + ring->head * ring->data_size, first * ring->data_size);
+  memcpy(data + first * ring->data_size, ring->data, ring->head * ring->data_size);
+  free(ring->data);
+  ring->data = data;
+  ring->head = 0;
+  ring->capacity *= 2;
+  DEBUG(0, "Ring '%s' grew to %u elements.\n", ring->name, ring->capacity);
+}
+
+/**************************************************************************************/
+/* ring_add_tail: */
+
+void* ring_add_tail(Ring* ring) {
+  if ((uns)ring->count == ring->capacity)
+    ring_grow(ring);
+  return ring_at(ring, ring->count++);
+}
+
+/**************************************************************************************/
+/* ring_add_head: */
+
+void* ring_add_head(Ring* ring) {
+  if ((uns)ring->count == ring->capacity)
+    ring_grow(ring);
+  ring->head = (ring->head - 1) & (ring->capacity - 1);
+  ring->count++;
+  return ring_at(ring, 0);
+}
+
+/**************************************************************************************/
+/* ring_remove_head: */
+
+void* ring_remove_head(Ring* ring) {
+  if (!ring->count)
+    return NULL;
+  void* data = ring_at(ring, 0);
+  ring->head = (ring->head + 1) & (ring->capacity - 1);
+  ring->count--;
+  return data;
+}
+
+/**************************************************************************************/
+/* ring_remove_tail: */
+
+void* ring_remove_tail(Ring* ring) {
+  if (!ring->count)
+    return NULL;
+  return ring_at(ring, --ring->count);
+}
+
+/**************************************************************************************/
+/* ring_remove: */
+
+void ring_remove(Ring* ring, int pos) {
+  ASSERT(0, pos >= 0 && pos < ring->count);
+  for (int ii = pos; ii < ring->count - 1; ii++)
+    memcpy(ring_at(ring, ii), ring_at(ring, ii + 1), ring->data_size);
+  ring->count--;
+}
+
+/**************************************************************************************/
+/* ring_clip: */
+
+void ring_clip(Ring* ring, int count) {
+  ASSERT(0, count >= 0 && count <= ring->count);
+  ring->count = count;
+}
+
+/**************************************************************************************/
+/* ring_clear: */
+
+void ring_clear(Ring* ring) {
+  ring->head = 0;
+  ring->count = 0;
+}
@@ -0,0 +1,85 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : libs/ring_lib.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : A growable ring buffer of fixed-size elements, addressed by position
+ ***************************************************************************************/
+
+#ifndef __RING_LIB_H__
+#define __RING_LIB_H__
+
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* The elements are stored inline in one power-of-2 array and addressed by their position
+   from the head (0 is the oldest, count - 1 the youngest).  A traversal is just a position,
+   so nested and reverse traversals need no state in the ring.  The array doubles when it is
+   full, so a pointer to an element is only valid until the next add. */
+typedef struct Ring_struct {
+  const char* name; /* name of the ring (for debugging) */
+  uns data_size;    /* size of the elements */
+  uns capacity;     /* slots in data (power of 2) */
+  uns head;         /* slot of position 0 */
+  int count;        /* number of elements */
+  char* data;
+} Ring;
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* capacity is rounded up to a power of 2 */
+void init_ring(Ring*, const char*, uns data_size, uns capacity);
+
+/* Return the new element.  The returned element is uninitialized. */
+void* ring_add_tail(Ring*);
+void* ring_add_head(Ring*);
+
+/* Return the removed element (valid until the next add), or NULL if the ring is empty */
+void* ring_remove_head(Ring*);
+void* ring_remove_tail(Ring*);
+
+/* Remove the element at pos, moving the younger ones up by one */
+void ring_remove(Ring*, int pos);
+
+/* Remove every element from position count on.  The removed elements keep their slots,
+   so ring_at(ring, count + ii) still reads them until the next add. */
+void ring_clip(Ring*, int count);
+
+void ring_clear(Ring*);
+
+/**************************************************************************************/
+/* ring_at: the element at pos (0 <= pos < count, or a clipped element, see ring_clip) */
+
+static inline void* ring_at(Ring const* ring, int pos) {
+  return ring->data + ((ring->head + pos) & (ring->capacity - 1)) * ring->data_size;
+}
+
+#define RING_AT(ring, type, pos) (*(type*)ring_at(ring, pos))
+
+#endif /* #ifndef __RING_LIB_H__ */
@@ -0,0 +1,188 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : libs/table_alloc.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Allocator for the large tables of the simulator
+ ***************************************************************************************/
+
+#include "libs/table_alloc.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "general.param.h"
+
+/**************************************************************************************/
+/* Defines */
+
+#define TABLE_ALLOC_ALIGN 64
+#define TABLE_HUGE_PAGE_SIZE (2 << 20)
+#define TABLE_MAX_OWNERS 64
+#define TABLE_MAX_MAPPINGS 1024
+
+/**************************************************************************************/
+/* Global Variables */
+
+typedef struct Table_Owner_struct {
+  const char* name;
+  size_t bytes;
+  size_t huge_bytes; /* part of bytes that asked for huge pages */
+  uns tables;
+} Table_Owner;
+
+/* allocations that came from mmap(MAP_HUGETLB) and must be munmapped */
+typedef struct Table_Mapping_struct {
+  void* ptr;
+  size_t bytes;
+} Table_Mapping;
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+static Table_Owner owners[TABLE_MAX_OWNERS];
+static uns num_owners = 0;
+static Table_Mapping mappings[TABLE_MAX_MAPPINGS];
+static uns num_mappings = 0;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static Table_Owner* table_owner(const char* owner);
+
+/**************************************************************************************/
+/* table_owner: caller holds table_lock */
+
+static Table_Owner* table_owner(const char* owner) {
+  for (uns ii = 0; ii < num_owners; ii++)
+    if (!strcmp(owners[ii].name, owner))
+      return &owners[ii];
+  ASSERTM(0, num_owners < TABLE_MAX_OWNERS, "Too many table_alloc owners\n");
+  owners[num_owners].name = owner;
+  return &owners[num_owners++];
+}
+
+/**************************************************************************************/
+/* table_alloc */
+
+void* table_alloc(const char* owner, size_t nbytes) {
+  void* ptr = NULL;
+  Flag huge = HUGE_PAGE_TABLES && nbytes >= TABLE_HUGE_PAGE_SIZE;
+  size_t rounded = (nbytes + TABLE_HUGE_PAGE_SIZE - 1) & ~(size_t)(TABLE_HUGE_PAGE_SIZE - 1);
+  Flag mapped = FALSE;
+
+#ifdef MAP_HUGETLB
+  if (huge && HUGE_PAGE_TABLES == 2) {
+    ptr = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr == MAP_FAILED)
+      ptr = NULL;
+    else
+      mapped = TRUE; /* anonymous mappings are already zero */
+  }
+#endif
+  if (!ptr && huge) {
+    if (posix_memalign(&ptr, TABLE_HUGE_PAGE_SIZE, rounded))
+      ptr = NULL;
+#ifdef MADV_HUGEPAGE
+    else
+      madvise(ptr, rounded, MADV_HUGEPAGE);
+#endif
+  }
+  if (!ptr && posix_memalign(&ptr, TABLE_ALLOC_ALIGN, nbytes ? nbytes : 1))
+    ptr = NULL;
+  ASSERTM(0, ptr, "Could not allocate %zu bytes for %s\n", nbytes, owner);
+  /* the pages are first touched by the calling thread, which places them on its NUMA node */
+  if (!mapped)
+    memset(ptr, 0, nbytes);
+
+  pthread_mutex_lock(&table_lock);
+  Table_Owner* entry = table_owner(owner);
+  entry->bytes += nbytes;
+  entry->huge_bytes += huge ? nbytes : 0;
+  entry->tables++;
+  if (mapped) {
+    ASSERTM(0, num_mappings < TABLE_MAX_MAPPINGS, "Too many huge page tables\n");
+    mappings[num_mappings].ptr = ptr;
+    mappings[num_mappings].bytes = rounded;
+    num_mappings++;
+  }
+  pthread_mutex_unlock(&table_lock);
+  return ptr;
+}
+
+/**************************************************************************************/
+/* table_free */
+
+void table_free(const char* owner, void* ptr, size_t nbytes) {
+  size_t mapped_bytes = 0;
+
+  if (!ptr)
+    return;
+  pthread_mutex_lock(&table_lock);
+  Table_Owner* entry = table_owner(owner);
+  ASSERT(0, entry->bytes >= nbytes && entry->tables);
+  entry->bytes -= nbytes;
+  if (HUGE_PAGE_TABLES && nbytes >= TABLE_HUGE_PAGE_SIZE)
+    entry->huge_bytes -= nbytes;
+  entry->tables--;
+  for (uns ii = 0; ii < num_mappings; ii++) {
+    if (mappings[ii].ptr == ptr) {
+      mapped_bytes = mappings[ii].bytes;
+      mappings[ii] = mappings[--num_mappings];
+      break;
+    }
+  }
+  pthread_mutex_unlock(&table_lock);
+
+  if (mapped_bytes)
+    munmap(ptr, mapped_bytes);
+  else
+    free(ptr);
+}
+
+/**************************************************************************************/
+/* table_alloc_report */
+
+void table_alloc_report(FILE* file) {
+  size_t total = 0;
+
+  pthread_mutex_lock(&table_lock);
+  for (uns ii = 0; ii < num_owners; ii++)
+    total += owners[ii].bytes;
+  fprintf(file, "** Host tables: %.1f MB", total / (1024.0 * 1024.0));
+  for (uns ii = 0; ii < num_owners; ii++) {
+    if (!owners[ii].bytes)
+      continue;
+    fprintf(file, "  %s %.1f MB in %u (%.0f%% huge)", owners[ii].name, owners[ii].bytes / (1024.0 * 1024.0),
+            owners[ii].tables, 100.0 * owners[ii].huge_bytes / owners[ii].bytes);
+  }
+  fprintf(file, "\n");
+  pthread_mutex_unlock(&table_lock);
+}
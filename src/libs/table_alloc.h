@@ -0,0 +1,58 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : libs/table_alloc.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Allocator for the large tables of the simulator (cache arrays, predictor
+ *                tables, the op pool and the memory request buffer)
+ ***************************************************************************************/
+
+#ifndef __TABLE_ALLOC_H__
+#define __TABLE_ALLOC_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* table_alloc returns zeroed, 64-byte aligned memory.  Allocations of at least one 2MB
+   page are backed by huge pages as HUGE_PAGE_TABLES asks (transparent huge pages through
+   madvise, or explicit MAP_HUGETLB pages that fall back to transparent ones when the
+   system has none reserved).  Every allocation is charged to its owner, a static string
+   naming the subsystem, for table_alloc_report.  table_free must be given the owner and
+   size that were passed to table_alloc.  Both are thread safe. */
+
+void* table_alloc(const char* owner, size_t nbytes);
+void table_free(const char* owner, void* ptr, size_t nbytes);
+
+/* Prints the live footprint of every owner */
+void table_alloc_report(FILE* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef __TABLE_ALLOC_H__ */
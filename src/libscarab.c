@@ -0,0 +1,128 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : libscarab.c
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : C API of libscarab (see libscarab.h). The calls are the pieces of
+ *                main() and full_sim(), so a run through the library behaves like
+ *                the same run from the command line.
+ ***************************************************************************************/
+
+#include "libscarab.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "general.param.h"
+
+#include "param_parser.h"
+#include "sim.h"
+#include "statistics.h"
+#include "warm_state.h"
+
+extern char** environ;
+
+static Flag scarab_created = FALSE;
+
+/**************************************************************************************/
+/* scarab_create: */
+
+void scarab_create(int argc, char* argv[]) {
+  ASSERTM(0, !scarab_created, "libscarab holds one simulation per process\n");
+  mystdout = stdout;
+  mystderr = stderr;
+  mystatus = NULL;
+
+  char** simulated_argv = get_params(argc, argv);
+  init_global(simulated_argv, environ);
+  ASSERTM(0, SIM_MODE == FULL_SIM_MODE, "libscarab only runs SIM_MODE full\n");
+
+  full_sim_begin();
+  scarab_created = TRUE;
+}
+
+/**************************************************************************************/
+/* scarab_set_param: */
+
+int scarab_set_param(const char* name, const char* value) {
+  return set_param(name, value);
+}
+
+/**************************************************************************************/
+/* scarab_run: */
+
+int scarab_run(uint64_t num_insts) {
+  ASSERT(0, scarab_created);
+  return full_sim_run(num_insts);
+}
+
+/**************************************************************************************/
+/* scarab_get_stat: */
+
+int scarab_get_stat(unsigned proc_id, const char* name, double* value) {
+  ASSERT(0, scarab_created);
+  const Stat* stat = proc_id < NUM_CORES ? get_stat(proc_id, name) : NULL;
+  if (!stat)
+    return FALSE;
+  *value = stat->type == FLOAT_TYPE_STAT ? stat->current->value : (double)stat->current->count;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* scarab_reset_stats: */
+
+void scarab_reset_stats(void) {
+  ASSERT(0, scarab_created);
+  reset_stats(TRUE);
+}
+
+/**************************************************************************************/
+/* scarab_save_warm_state: */
+
+void scarab_save_warm_state(const char* path) {
+  ASSERT(0, scarab_created);
+  full_sim_drain();
+  warm_state_save(path);
+}
+
+/**************************************************************************************/
+/* scarab_load_warm_state: */
+
+void scarab_load_warm_state(const char* path) {
+  ASSERT(0, scarab_created);
+  full_sim_drain();
+  warm_state_restore(path);
+}
+
+/**************************************************************************************/
+/* scarab_destroy: */
+
+void scarab_destroy(void) {
+  ASSERT(0, scarab_created);
+  full_sim_end();
+  close_output_streams();
+}
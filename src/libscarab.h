@@ -0,0 +1,89 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : libscarab.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : C API of libscarab, for programs that run many short simulations
+ *                in one process (parameter searches, tuners) without starting
+ *                Scarab, reading PARAMS and opening the traces every time.
+ *
+ * A process holds at most one simulation, since Scarab keeps its state in globals:
+ *
+ *   scarab_create(argc, argv);          // like the command line, runs the warmup
+ *   scarab_save_warm_state("w.state");  // caches and predictors after warmup
+ *   for (...) {
+ *     scarab_set_param("pref_stride_degree", "8");
+ *     scarab_load_warm_state("w.state");
+ *     scarab_reset_stats();
+ *     scarab_run(1000000);
+ *     scarab_get_stat(0, "NODE_CYCLE", &cycles);
+ *   }
+ *   scarab_destroy();
+ *
+ * Each scarab_run continues the traces where the last one stopped.
+ ***************************************************************************************/
+
+#ifndef __LIBSCARAB_H__
+#define __LIBSCARAB_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parses argv like the scarab command line (with PARAMS.in), initializes the
+   simulator, opens the traces and runs the warmup. Only SIM_MODE full. */
+void scarab_create(int argc, char* argv[]);
+
+/* Sets a parameter as --name value would. The value is only seen by code that
+   reads the parameter again after initialization, such as policy knobs; sizes of
+   structures that are allocated at init keep their old value. Returns 0 if there
+   is no settable parameter called name. */
+int scarab_set_param(const char* name, const char* value);
+
+/* Simulates until every core that is still running has retired num_insts more
+   instructions (0: until the simulation ends). Returns 0 once it has ended. */
+int scarab_run(uint64_t num_insts);
+
+/* Value of a stat of core proc_id in the current stat interval (since the last
+   reset). Returns 0 if there is no such stat. */
+int scarab_get_stat(unsigned proc_id, const char* name, double* value);
+
+/* Starts a new stat interval */
+void scarab_reset_stats(void);
+
+/* Drain the pipelines, then write the caches and branch predictors to path, or
+   replace them with the ones saved there (cmp model only) */
+void scarab_save_warm_state(const char* path);
+void scarab_load_warm_state(const char* path);
+
+/* Finishes the simulation and writes the final stat files */
+void scarab_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef __LIBSCARAB_H__ */
@@ -40,13 +40,17 @@ extern "C" {
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
 
+#include "core.param.h"
+
 #include "bp/bp.h"
 
+#include "core_context.h"
 #include "exec_ports.h"
 #include "node_stage.h"
+#include "statistics.h"
+#include "store_set.h"
 }
 
-#include <deque>
 #include <vector>
 
 /**************************************************************************************/
@@ -74,7 +78,12 @@ class LSQ {
   Mem_Type mem_type;
   size_t entry_num;
 
-  std::deque<LSQ_Entry> entries;
+  // circular buffer of entry_num entries in age order, the oldest at head
+  std::vector<LSQ_Entry> entries;
+  size_t head;
+  size_t count;
+
+  size_t index(size_t pos) const { return head + pos < entry_num ? head + pos : head + pos - entry_num; }
 
  public:
   void init(uns8 proc_id, Mem_Type mem_type, size_t entry_num);
@@ -84,35 +93,43 @@ class LSQ {
   void recover(Counter flush_op_num);
 
   LSQ(){};
-  const std::deque<LSQ_Entry>& get_entries() const { return entries; }
+  size_t size() const { return count; }
+  // pos-th oldest entry
+  const LSQ_Entry& at(size_t pos) const { return entries[index(pos)]; }
 };
 
 void LSQ::init(const uns8 proc_id, const Mem_Type mem_type, const size_t entry_num) {
   this->proc_id = proc_id;
   this->mem_type = mem_type;
   this->entry_num = entry_num;
-  entries.clear();
+  entries.assign(entry_num, LSQ_Entry());
+  head = 0;
+  count = 0;
 }
 
 void LSQ::allocate(Op* mem_op) {
-  ASSERT(proc_id, entries.size() < entry_num);
+  ASSERT(proc_id, count < entry_num);
   ASSERT(proc_id, mem_op->table_info->mem_type == this->mem_type);
+  // recover relies on the entries staying sorted by op_num
+  ASSERT(proc_id, !count || at(count - 1).op_num <= mem_op->op_num);
 
-  entries.emplace_back(mem_op);
+  entries[index(count)] = LSQ_Entry(mem_op);
+  count++;
 }
 
 void LSQ::free(Op* mem_op) {
-  ASSERT(proc_id, !entries.empty());
+  ASSERT(proc_id, count);
   ASSERT(proc_id, mem_op->table_info->mem_type == this->mem_type);
   ASSERT(proc_id, !mem_op->off_path);
 
-  ASSERT(proc_id, entries.front().op_num == mem_op->op_num);
-  entries.pop_front();
+  ASSERT(proc_id, entries[head].op_num == mem_op->op_num);
+  head = index(1);
+  count--;
 }
 
 bool LSQ::available() {
-  ASSERT(proc_id, entries.size() <= entry_num);
-  if (entries.size() == entry_num) {
+  ASSERT(proc_id, count <= entry_num);
+  if (count == entry_num) {
     return false;
   }
 
@@ -120,21 +137,23 @@ bool LSQ::available() {
 }
 
 void LSQ::recover(Counter flush_op_num) {
-  while (!entries.empty()) {
-    auto& back_entry = entries.back();
-
-    // Stop when reaching on-path ops earlier than the branch
-    if (back_entry.op_num < flush_op_num) {
-      break;
-    }
+  // binary search for the oldest entry at or after the branch, everything from it on is off-path
+  size_t lo = 0;
+  size_t hi = count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (at(mid).op_num < flush_op_num)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
 
-    // Free this off-path mem op from the back
-    ASSERT(proc_id, !entries.empty());
-    ASSERT(proc_id, back_entry.op->off_path);
-    ASSERT(proc_id, entries.back().op_num == back_entry.op->op_num);
-    ASSERT(proc_id, back_entry.op->table_info->mem_type == this->mem_type);
-    entries.pop_back();
+  if (lo < count) {
+    ASSERT(proc_id, at(lo).op->off_path);
+    ASSERT(proc_id, at(lo).op->table_info->mem_type == this->mem_type);
   }
+  // drop them by pulling the tail back
+  count = lo;
 }
 
 /**************************************************************************************/
@@ -156,6 +175,20 @@ class LSQ_Unit {
   void commit(Op* mem_op);
 };
 
+/* the load could have issued before the store resolved: it is waiting in the RS only for producers the store-set
+ * predictor did not make it wait for */
+static bool lsq_load_issued_early(const Op* load_op) {
+  if (load_op->state != OS_IN_RS || load_op->rdy_cycle > cycle_count)
+    return false;
+  for (uns ii = 0; ii < load_op->oracle_info.num_srcs; ii++) {
+    const Src_Info* src_info = &load_op->oracle_info.src_info[ii];
+    if ((load_op->srcs_not_rdy_vector >> ii & 1) &&
+        (src_info->type != MEM_DATA_DEP || src_info->op_num == load_op->mem_dep_pred_op_num))
+      return false;
+  }
+  return true;
+}
+
 LSQ_Unit::LSQ_Unit(uns8 proc_id) {
   this->init(proc_id);
 }
@@ -238,7 +271,7 @@ void LSQ_Unit::commit(Op* mem_op) {
 /* Global Values */
 
 static std::vector<LSQ_Unit> per_core_lsq_unit;
-LSQ_Unit* lsq_unit = nullptr;
+CORE_LOCAL LSQ_Unit* lsq_unit = nullptr;
 
 /**************************************************************************************/
 /* External Methods */
@@ -252,11 +285,11 @@ void alloc_mem_lsq(uns num_cores) {
   }
 }
 
-void set_lsq(uns8 proc_id) {
+void set_lsq(Core_Context* ctx) {
   if (!LSQ_ENABLE)
     return;
 
-  lsq_unit = &per_core_lsq_unit[proc_id];
+  lsq_unit = &per_core_lsq_unit[ctx->proc_id];
 }
 
 void init_lsq(uns8 proc_id, const char* name) {
@@ -316,6 +349,38 @@ void lsq_commit(Op* mem_op) {
   lsq_unit->commit(mem_op);
 }
 
+/*
+  Called by:
+  --- exec_stage.c -> when a store computes its address, before it wakes up its dependents
+  Desc:
+  --- with store sets, a younger load that reads from the store but issued before it is a memory order
+  --- violation: the predictor learns the pair, and the load is replayed STORE_SET_VIOLATION_PENALTY
+  --- cycles after the store
+*/
+void lsq_store_resolved(Op* store_op) {
+  if (!LSQ_ENABLE || !MEM_DEP_STORE_SETS)
+    return;
+
+  const LSQ* load_queue = lsq_unit->get_queue(MEM_LD);
+  for (size_t ii = load_queue->size(); ii-- > 0;) {
+    Op* load_op = load_queue->at(ii).op;
+    if (load_op->op_num < store_op->op_num)
+      break;
+    if (!lsq_load_issued_early(load_op))
+      continue;
+    for (uns jj = 0; jj < load_op->oracle_info.num_srcs; jj++) {
+      const Src_Info* src_info = &load_op->oracle_info.src_info[jj];
+      if (src_info->op == store_op && src_info->unique_num == store_op->unique_num &&
+          src_info->op_num != load_op->mem_dep_pred_op_num) {
+        STAT_EVENT(load_op->proc_id, STORE_SET_VIOLATION);
+        store_set_train(load_op, store_op);
+        load_op->rdy_cycle = MAX2(load_op->rdy_cycle, store_op->wake_cycle + STORE_SET_VIOLATION_PENALTY);
+        break;
+      }
+    }
+  }
+}
+
 /**************************************************************************************/
 
 int lsq_get_in_flight_load_num() {
@@ -323,9 +388,9 @@ int lsq_get_in_flight_load_num() {
     return 0;
 
   int in_flight_num = 0;
-  const auto& store_entries = lsq_unit->get_queue(MEM_LD)->get_entries();
-  for (const auto& entry : store_entries) {
-    if (entry.op->state >= OS_IN_RS)
+  const LSQ* load_queue = lsq_unit->get_queue(MEM_LD);
+  for (size_t ii = 0; ii < load_queue->size(); ii++) {
+    if (load_queue->at(ii).op->state >= OS_IN_RS)
       in_flight_num++;
   }
 
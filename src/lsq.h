@@ -40,7 +40,7 @@ extern "C" {
 /* External Methods */
 
 void alloc_mem_lsq(uns num_cores);
-void set_lsq(uns8 proc_id);
+void set_lsq(Core_Context* ctx);
 void init_lsq(uns8 proc_id, const char* name);
 void recover_lsq();
 
@@ -49,6 +49,7 @@ void lsq_dispatch(Op* mem_op);          // insert mem op into LSQ when mem op is
 void lsq_commit(Op* mem_op);            // free the entry when the mem op is retired
 
 int lsq_get_in_flight_load_num();
+void lsq_store_resolved(Op* store_op);  // catch the younger loads that issued before the store (store sets)
 
 #ifdef __cplusplus
 }
@@ -154,6 +154,8 @@ Scarab's source code is organized as follows:
         + prefetcher/pref_ghb.h
         + prefetcher/pref_markov.h
         + prefetcher/pref_phase.h
+        + prefetcher/pref_sms.h
+        + prefetcher/pref_triage.h
         + prefetcher//pref_stream.h
         + prefetcher//pref_stride.h
         + prefetcher//pref_stridepc.h
@@ -212,6 +214,7 @@ Scarab's source code is organized as follows:
 
 #include "general.param.h"
 
+#include "farm.h"
 #include "optimizer2.h"
 #include "param_parser.h"
 #include "sim.h"
@@ -245,6 +248,15 @@ int main(int argc, char* argv[], char* envp[]) {
   /* read parameters from PARAMS.in and the command line */
   simulated_argv = get_params(argc, argv);
 
+  /* region farming: the coordinator only hands out jobs, a worker returns here in the child
+     forked for each job, with the arguments of the job */
+  if (FARM_COORDINATOR)
+    return farm_coordinator() ? EXIT_FAILURE : 0;
+  if (FARM_WORKER) {
+    farm_worker(&argc, &argv);
+    simulated_argv = get_params(argc, argv);
+  }
+
   /* perform global initialization */
   init_global(simulated_argv, envp);
 
@@ -276,6 +288,9 @@ int main(int argc, char* argv[], char* envp[]) {
     case TRACE_BBV_DISTRIBUTED_MODE:
       extract_basic_block_vectors();
       break;
+    case TRACE_SCT_MODE:
+      write_sct_trace();
+      break;
 #endif
     default:
       FATAL_ERROR(0, "Unknown simulation mode.");
@@ -47,6 +47,7 @@
 #include "map_rename.h"
 #include "model.h"
 #include "statistics.h"
+#include "store_set.h"
 #include "thread.h"
 
 /**************************************************************************************/
@@ -55,8 +56,9 @@
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_MAP, ##args)
 #define DEBUGU(proc_id, args...) _DEBUGU(proc_id, DEBUG_MAP, ##args)
 
-#define WAKE_UP_ENTRIES_INC 256 /* default 256 */
-#define MEM_ADDR_SRC 0          /* address for memory instructions calculated off source 0 */
+#define WAKE_UP_CHUNKS_INC 64 /* default 64 */
+#define SRC_BLOCKS_INC 64     /* default 64 */
+#define MEM_ADDR_SRC 0        /* address for memory instructions calculated off source 0 */
 
 #define MEM_MAP_ENTRY_SIZE_LOG 3
 #define MEM_MAP_ENTRY_SIZE (1 << MEM_MAP_ENTRY_SIZE_LOG)
@@ -73,6 +75,8 @@ typedef struct Mem_Map_Entry_struct {
   Op* op[2 * MEM_MAP_ENTRY_SIZE]; /* last op to write (invalid when committed),
                                    * first half onpath, second half offpath*/
   uns flag_mask;                  /* offpath flags, one per byte */
+  Counter flag_epoch;             /* map_data->mem_flag_epoch flag_mask was written in
+                                   * (flag_mask reads as 0 once recover_map bumps it) */
   uns store_mask;                 /* shows position of all distinct stores
                                    * supplying a partial value to this map entry */
 } Mem_Map_Entry;
@@ -97,7 +101,7 @@ extern Op invalid_op;
 /**************************************************************************************/
 /* Global Variables */
 
-Map_Data* map_data = NULL;
+CORE_LOCAL Map_Data* map_data = NULL;
 
 const char* const dep_type_names[NUM_DEP_TYPES] = {
     "REG_DATA",
@@ -112,19 +116,19 @@ static inline void read_reg_map(Op*);
 static inline void read_store_map(Op*);
 static inline void update_map(Op*);
 
-static inline void expand_wake_up_entries(void);
+static inline void expand_wake_up_chunks(void);
+static inline void expand_src_blocks(void);
 static inline void update_store_hash(Op* op);
 static inline Op* add_store_deps(Op* op);
 static inline void update_map_entry(Op* op, Map_Entry* map_entry);
-static inline void recover_mem_map_entry(void* hash_entry, void* arg);
+static inline uns mem_map_flag_mask(Mem_Map_Entry* entry);
 
 /* memory map hash traversal */
 static inline void mem_map_entry_traversal_init(Mem_Map_Traversal* traversal, Addr va, uns size);
 static inline Flag mem_map_entry_traversal_done(Mem_Map_Traversal* traversal);
 static inline void mem_map_entry_traversal_next(Mem_Map_Traversal* traversal);
 static inline void mem_map_byte_traversal_init(Mem_Map_Traversal* traversal);
-static inline Flag mem_map_byte_traversal_done(Mem_Map_Traversal* traversal);
-static inline void mem_map_byte_traversal_next(Mem_Map_Traversal* traversal);
+static inline uns mem_map_byte_traversal_mask(Mem_Map_Traversal* traversal);
 
 /**************************************************************************************/
 /* set_map_data: */
@@ -158,18 +162,21 @@ void init_map(uns8 proc_id) {
   map_data->last_store[1].op = &invalid_op;
   map_data->last_store[1].op_num = 0;
 
-  /* Allocate the wake_up_entry pool. */
-  expand_wake_up_entries();
+  /* Allocate the wake up chunk and source block pools. */
+  expand_wake_up_chunks();
+  expand_src_blocks();
 
   /* Initialize the memory dependence hash table. The number of
-     buckets matters since we scan all entries (and all buckets) on
-     branch misprediction recovery, so we want to keep the number of
-     buckets large enough to avoid collisions but small enough to
-     keep the scan fast. Since the number of entries is roughly at
-     most the number of in-flight stores, we set the number of
-     buckets to the size of instruction window. */
+     entries is roughly at most the number of in-flight stores, so we
+     set the number of buckets to the size of instruction window. */
   init_hash_table(&map_data->oracle_mem_hash, "oracle mem dependence map", NODE_TABLE_SIZE, sizeof(Mem_Map_Entry));
 
+  /* The oracle map stays the ground truth: it supplies the data dependences and lets the LSQ catch violations */
+  if (MEM_DEP_STORE_SETS) {
+    ASSERTM(proc_id, MEM_OBEY_STORE_DEP && LSQ_ENABLE, "Store sets need MEM_OBEY_STORE_DEP and LSQ_ENABLE\n");
+    init_store_set(proc_id);
+  }
+
   /* Init the register renaming table */
   reg_file_init();
 }
@@ -183,16 +190,17 @@ void recover_map() {
   for (ii = 0; ii < NUM_REG_IDS; ii++)
     map_data->map_flags[ii] = FALSE;
   map_data->last_store_flag = FALSE;
-  hash_table_scan(&map_data->oracle_mem_hash, recover_mem_map_entry, NULL);
+  /* clears the offpath flags of every memory map entry without visiting them */
+  map_data->mem_flag_epoch++;
   rebuild_offpath_map();
 }
 
 /**************************************************************************************/
-/* recover_mem_map_entry: */
+/* mem_map_flag_mask: offpath flags of a memory map entry, 0 if they were
+   written before the last recovery */
 
-void recover_mem_map_entry(void* hash_entry, void* arg) {
-  Mem_Map_Entry* entry = (Mem_Map_Entry*)hash_entry;
-  entry->flag_mask = 0;
+static inline uns mem_map_flag_mask(Mem_Map_Entry* entry) {
+  return entry->flag_epoch == map_data->mem_flag_epoch ? entry->flag_mask : 0;
 }
 
 /**************************************************************************************/
@@ -206,34 +214,49 @@ void rebuild_offpath_map() {
   ASSERT(map_data->proc_id, map_data->proc_id == td->proc_id);
 
   /* First find the oldest offpath op */
-  Op** op_p = (Op**)list_start_head_traversal(&td->seq_op_list);
-  while (op_p && !(*op_p)->off_path) {
-    op_p = (Op**)list_next_element(&td->seq_op_list);
-  }
+  int ii = 0;
+  while (ii < td->seq_op_list.count && !RING_AT(&td->seq_op_list, Op*, ii)->off_path)
+    ii++;
 
   /* rebuild the map starting with the first offpath op */
-  for (; op_p; op_p = (Op**)list_next_element(&td->seq_op_list)) {
-    update_map(*op_p);
-    if ((*op_p)->table_info->mem_type == MEM_ST) {
-      update_store_hash(*op_p);
+  for (; ii < td->seq_op_list.count; ii++) {
+    Op* op = RING_AT(&td->seq_op_list, Op*, ii);
+    update_map(op);
+    if (op->table_info->mem_type == MEM_ST) {
+      update_store_hash(op);
     }
   }
 }
 
 /**************************************************************************************/
-/* expand_wake_up_pool: */
+/* expand_wake_up_chunks: */
 
-static inline void expand_wake_up_entries() {
-  Wake_Up_Entry* new_pool = (Wake_Up_Entry*)calloc(WAKE_UP_ENTRIES_INC, sizeof(Wake_Up_Entry));
+static inline void expand_wake_up_chunks() {
+  Wake_Up_Chunk* new_pool = (Wake_Up_Chunk*)calloc(WAKE_UP_CHUNKS_INC, sizeof(Wake_Up_Chunk));
   uns ii;
 
-  DEBUGU(map_data->proc_id, "Expanding wake up pool to size %d\n", (map_data->wake_up_entries + WAKE_UP_ENTRIES_INC));
-  for (ii = 0; ii < WAKE_UP_ENTRIES_INC - 1; ii++)
+  DEBUGU(map_data->proc_id, "Expanding wake up pool to size %d\n", (map_data->wake_up_chunks + WAKE_UP_CHUNKS_INC));
+  for (ii = 0; ii < WAKE_UP_CHUNKS_INC - 1; ii++)
     new_pool[ii].next = &new_pool[ii + 1];
   new_pool[ii].next = map_data->free_list_head;
   map_data->free_list_head = &new_pool[0];
-  map_data->wake_up_entries += WAKE_UP_ENTRIES_INC;
-  ASSERT(map_data->proc_id, map_data->wake_up_entries <= WAKE_UP_ENTRIES_INC * 128);
+  map_data->wake_up_chunks += WAKE_UP_CHUNKS_INC;
+  ASSERT(map_data->proc_id, map_data->wake_up_chunks <= WAKE_UP_CHUNKS_INC * 128);
+}
+
+/**************************************************************************************/
+/* expand_src_blocks: */
+
+static inline void expand_src_blocks() {
+  Src_Block* new_pool = (Src_Block*)calloc(SRC_BLOCKS_INC, sizeof(Src_Block));
+  uns ii;
+
+  DEBUGU(map_data->proc_id, "Expanding src block pool to size %d\n", (map_data->src_blocks + SRC_BLOCKS_INC));
+  for (ii = 0; ii < SRC_BLOCKS_INC - 1; ii++)
+    new_pool[ii].next = &new_pool[ii + 1];
+  new_pool[ii].next = map_data->free_src_blocks;
+  map_data->free_src_blocks = &new_pool[0];
+  map_data->src_blocks += SRC_BLOCKS_INC;
 }
 
 /**************************************************************************************/
@@ -250,6 +273,17 @@ void map_op(Op* op) {
   ASSERT(map_data->proc_id, op);
   ASSERT(map_data->proc_id, map_data->proc_id == op->proc_id);
 
+  /* the src array is attached here rather than being part of the op, so the ops
+     waiting in the FTQ do not carry it */
+  ASSERT(map_data->proc_id, !op->oracle_info.src_info);
+  if (map_data->free_src_blocks == NULL) {
+    ASSERT(map_data->proc_id, map_data->active_src_blocks == map_data->src_blocks);
+    expand_src_blocks();
+  }
+  op->oracle_info.src_info = map_data->free_src_blocks->entries;
+  map_data->free_src_blocks = map_data->free_src_blocks->next;
+  map_data->active_src_blocks++;
+
   read_reg_map(op);   /* set reg sources */
   read_store_map(op); /* set addr dependency on last store */
   update_map(op);     /* update reg and last store maps */
@@ -284,6 +318,9 @@ static inline void read_reg_map(Op* op) {
 static inline void read_store_map(Op* op) {
   if (!MEM_OBEY_STORE_DEP || MEM_OOO_STORES)
     return;
+  /* with store sets, loads speculate past the stores whose addresses are unknown */
+  if (MEM_DEP_STORE_SETS && op->table_info->mem_type == MEM_LD)
+    return;
 
   if (op->table_info->mem_type) {
     uns ind = map_data->last_store_flag;
@@ -351,8 +388,11 @@ inline void update_map_entry(Op* op, Map_Entry* map_entry) {
 void map_mem_dep(Op* op) {
   if (!MEM_OBEY_STORE_DEP)
     return;
-  if (op->table_info->mem_type == MEM_ST)
+  if (op->table_info->mem_type == MEM_ST) {
     update_store_hash(op);
+    if (MEM_DEP_STORE_SETS)
+      store_set_map_store(op);
+  }
   if (op->table_info->mem_type == MEM_LD)
     add_store_deps(op);
 }
@@ -393,12 +433,9 @@ static inline void mem_map_byte_traversal_init(Mem_Map_Traversal* traversal) {
   ASSERT(0, traversal->byte <= traversal->last_byte);
 }
 
-static inline Flag mem_map_byte_traversal_done(Mem_Map_Traversal* traversal) {
-  return traversal->byte > traversal->last_byte;
-}
-
-static inline void mem_map_byte_traversal_next(Mem_Map_Traversal* traversal) {
-  traversal->byte++;
+/* mask of the bytes of the current entry covered by the access (call after mem_map_byte_traversal_init) */
+static inline uns mem_map_byte_traversal_mask(Mem_Map_Traversal* traversal) {
+  return (uns)(N_BIT_MASK(traversal->last_byte + 1) & ~N_BIT_MASK(traversal->byte));
 }
 
 /**************************************************************************************/
@@ -419,11 +456,12 @@ void delete_store_hash_entry(Op* op) {
     if (!mem_map_p)
       continue;
 
-    /* Iterate through each byte written to by the op (within this entry) */
-    for (mem_map_byte_traversal_init(&traversal); !mem_map_byte_traversal_done(&traversal);
-         mem_map_byte_traversal_next(&traversal)) {
-      uns ind = MEM_MAP_BYTE_INDEX(traversal.byte, op->off_path);
-      if (TESTBIT(mem_map_p->store_mask, ind) && mem_map_p->op[ind] == op) {
+    /* Check each valid byte written to by the op (within this entry) */
+    mem_map_byte_traversal_init(&traversal);
+    uns inds = mem_map_byte_traversal_mask(&traversal) << MEM_MAP_BYTE_INDEX(0, op->off_path);
+    for (uns mask = inds & mem_map_p->store_mask; mask; mask &= mask - 1) {
+      uns ind = __builtin_ctz(mask);
+      if (mem_map_p->op[ind] == op) {
         CLRBIT(mem_map_p->store_mask, ind);
       }
     }
@@ -439,6 +477,7 @@ void delete_store_hash_entry(Op* op) {
 static inline Op* add_store_deps(Op* op) {
   Addr va = op->oracle_info.va;
   Op* last_src_op = NULL;
+  Op* pred_src_op = MEM_DEP_STORE_SETS ? store_set_predict_load(op) : NULL;
   uns orig_num_srcs = op->oracle_info.num_srcs;
   Mem_Map_Traversal traversal;
 
@@ -453,13 +492,21 @@ static inline Op* add_store_deps(Op* op) {
     if (!mem_map_p)
       continue;
 
-    /* Iterate through each byte read by the op (within this entry) */
-    for (mem_map_byte_traversal_init(&traversal); !mem_map_byte_traversal_done(&traversal);
-         mem_map_byte_traversal_next(&traversal)) {
-      uns ind = MEM_MAP_BYTE_INDEX(traversal.byte, TESTBIT(mem_map_p->flag_mask, traversal.byte));
-      if (!TESTBIT(mem_map_p->store_mask, ind))
-        continue; /* ensure mem_map_p info is valid */
-      Op* src_op = mem_map_p->op[ind];
+    /* Visit each byte read by the op (within this entry) that has a valid store, in
+       the half its flag_mask bit selects */
+    mem_map_byte_traversal_init(&traversal);
+    uns bytes = mem_map_byte_traversal_mask(&traversal);
+    uns on_path_store_bytes = mem_map_p->store_mask & N_BIT_MASK(MEM_MAP_ENTRY_SIZE);
+    uns off_path_store_bytes = mem_map_p->store_mask >> MEM_MAP_ENTRY_SIZE;
+    uns flag_mask = mem_map_flag_mask(mem_map_p);
+    uns valid = bytes & ((~flag_mask & on_path_store_bytes) | (flag_mask & off_path_store_bytes));
+    Op* prev_src_op = NULL;
+    for (; valid; valid &= valid - 1) {
+      uns byte = __builtin_ctz(valid);
+      Op* src_op = mem_map_p->op[MEM_MAP_BYTE_INDEX(byte, TESTBIT(flag_mask, byte))];
+      if (src_op == prev_src_op)
+        continue; /* a store usually supplies several bytes in a row */
+      prev_src_op = src_op;
       ASSERTM(op->proc_id,
               BYTE_OVERLAP(src_op->oracle_info.va, src_op->oracle_info.mem_size, va, op->oracle_info.mem_size),
               "%d@0x%08x and %d@0x%08x\n", src_op->oracle_info.mem_size, (uns32)src_op->oracle_info.va,
@@ -475,6 +522,20 @@ static inline Op* add_store_deps(Op* op) {
     }
   }
 
+  /* the load waits for its predicted store on top of the stores it reads from, see lsq_store_resolved */
+  if (pred_src_op) {
+    op->mem_dep_pred_op_num = pred_src_op->op_num;
+    if (!pred_src_op->marked && pred_src_op != last_src_op) {
+      add_src_from_op(op, pred_src_op, MEM_DATA_DEP);
+      pred_src_op->marked = MEM_OOO_STORES && last_src_op; /* unmarked below with the stores read from */
+    }
+    STAT_EVENT(op->proc_id, !last_src_op               ? STORE_SET_DEP_FALSE
+                            : pred_src_op == last_src_op ? STORE_SET_DEP_CORRECT
+                                                         : STORE_SET_DEP_WRONG);
+  } else if (MEM_DEP_STORE_SETS && last_src_op) {
+    STAT_EVENT(op->proc_id, STORE_SET_DEP_MISSED);
+  }
+
   if (!last_src_op) {
     STAT_EVENT(op->proc_id, LD_NO_FORWARD);
     return NULL; /* No dependency found */
@@ -514,16 +575,22 @@ static inline void update_store_hash(Op* op) {
     if (new_entry) {
       mem_map_p->flag_mask = 0;
       mem_map_p->store_mask = 0;
+    } else {
+      mem_map_p->flag_mask = mem_map_flag_mask(mem_map_p);
     }
-
-    /* Iterate through each byte written to by the op (within this entry) */
-    for (mem_map_byte_traversal_init(&traversal); !mem_map_byte_traversal_done(&traversal);
-         mem_map_byte_traversal_next(&traversal)) {
-      DEFBIT(mem_map_p->flag_mask, traversal.byte, op->off_path);
-      uns ind = MEM_MAP_BYTE_INDEX(traversal.byte, op->off_path);
-      SETBIT(mem_map_p->store_mask, ind);
-      mem_map_p->op[ind] = op;
-    }
+    mem_map_p->flag_epoch = map_data->mem_flag_epoch;
+
+    /* Record the op as the last writer of each byte it writes (within this entry) */
+    mem_map_byte_traversal_init(&traversal);
+    uns bytes = mem_map_byte_traversal_mask(&traversal);
+    if (op->off_path)
+      mem_map_p->flag_mask |= bytes;
+    else
+      mem_map_p->flag_mask &= ~bytes;
+    uns inds = bytes << MEM_MAP_BYTE_INDEX(0, op->off_path);
+    mem_map_p->store_mask |= inds;
+    for (; inds; inds &= inds - 1)
+      mem_map_p->op[__builtin_ctz(inds)] = op;
   }
 }
 
@@ -532,6 +599,7 @@ static inline void update_store_hash(Op* op) {
 
 void wake_up_ops(Op* op, Dep_Type type, void (*wake_action)(Op*, Op*, uns8)) {
   Wake_Up_Entry* temp;
+  Wake_Up_Iter iter;
 
   _DEBUG(op->proc_id, DEBUG_REPLAY, "Waking up ops from src_op:%s unique:%s type:%s\n", unsstr64(op->op_num),
          unsstr64(op->unique_num), dep_type_names[type]);
@@ -542,14 +610,12 @@ void wake_up_ops(Op* op, Dep_Type type, void (*wake_action)(Op*, Op*, uns8)) {
   reg_file_produce(op);
 
   ASSERT(op->proc_id, wake_action);
-  for (temp = op->wake_up_head; temp; temp = temp->next) {
+  for (temp = wake_up_iter_first(&op->wake_up_lists[type], &iter); temp; temp = wake_up_iter_next(&iter)) {
     Op* dep_op = temp->op;
     Counter dep_unique_num = temp->unique_num;
 
     ASSERT(op->proc_id, dep_op);
 
-    if (temp->dep_type != type)
-      continue;
     /* if the stored unique num is not the same as the op pool entry, the op has
            been reclaimed and the wake up should be ignored */
     if (dep_op->unique_num == dep_unique_num && dep_op->op_pool_valid) {
@@ -594,48 +660,49 @@ void add_to_wake_up_lists(Op* op, Op_Info* op_info, void (*wake_action)(Op*, Op*
         src_op->unique_num == src_info->unique_num) {
       /* make sure the source op is still in the machine */
       /* add to the src op's wake up list regardless of whether it has already produced a result or not */
+      Wake_Up_List* list = &src_op->wake_up_lists[src_info->type];
       Wake_Up_Entry* wake;
 
       ASSERTM(op->proc_id, op->proc_id == src_op->proc_id,
               "op num: %llu fetch: %llu, src_op num: %llu unique: %llu fetch: %llu\n", op->op_num, op->fetch_cycle,
               src_op->op_num, src_op->unique_num, src_op->fetch_cycle);
 
-      if (map_data->free_list_head == NULL) {
-        ASSERT(map_data->proc_id, map_data->active_wake_up_entries == map_data->wake_up_entries);
-        expand_wake_up_entries();
-      }
-
       if (src_info->type == MEM_DATA_DEP)
         dep_on_in_window_store = TRUE;
 
-      wake = map_data->free_list_head;
-      map_data->active_wake_up_entries++;
-      map_data->free_list_head = wake->next;
+      if (list->count < WAKE_UP_INLINE_ENTRIES) {
+        wake = &list->inline_entries[list->count];
+      } else {
+        uns pos = (list->count - WAKE_UP_INLINE_ENTRIES) % WAKE_UP_CHUNK_ENTRIES;
+        if (pos == 0) {
+          Wake_Up_Chunk* chunk;
+          if (map_data->free_list_head == NULL) {
+            ASSERT(map_data->proc_id, map_data->active_wake_up_chunks == map_data->wake_up_chunks);
+            expand_wake_up_chunks();
+          }
+          chunk = map_data->free_list_head;
+          map_data->active_wake_up_chunks++;
+          map_data->free_list_head = chunk->next;
+          chunk->next = NULL;
+          if (list->overflow_tail)
+            list->overflow_tail->next = chunk;
+          else
+            list->overflow_head = chunk;
+          list->overflow_tail = chunk;
+        }
+        wake = &list->overflow_tail->entries[pos];
+      }
+      list->count++;
+      src_op->wake_up_count++;
 
       wake->op = op;
       wake->unique_num = op->unique_num;
-      wake->dep_type = src_info->type;
       wake->rdy_bit = ii;
-      wake->next = NULL;
 
-      if (src_op->wake_up_tail == NULL) {
-        src_op->wake_up_head = wake;
-        src_op->wake_up_tail = wake;
-        src_op->wake_up_count = 1;
-      } else {
-        ASSERT(map_data->proc_id, src_op->wake_up_head);
-        src_op->wake_up_tail->next = wake;
-        src_op->wake_up_tail = wake;
-        src_op->wake_up_count++;
-      }
-
-      if (TRACK_L1_MISS_DEPS) {
-        // An op can occupy multiple entries in the wakeup list of another op
-        if (src_op->engine_info.l1_miss && !src_op->engine_info.l1_miss_satisfied)
-          op->engine_info.dep_on_l1_miss = TRUE;
-
-        if (src_op->engine_info.dep_on_l1_miss)
-          op->engine_info.dep_on_l1_miss = TRUE;
+      if (TRACK_L1_MISS_DEPS && l1_miss_pending(src_op)) {
+        // An op can occupy multiple entries in the wakeup list of another op, each one is counted
+        op->engine_info.l1_miss_dep_srcs++;
+        op->engine_info.dep_on_l1_miss = TRUE;
       }
 
       if (src_op->wake_up_signaled[src_info->type]) {
@@ -653,6 +720,72 @@ void add_to_wake_up_lists(Op* op, Op_Info* op_info, void (*wake_action)(Op*, Op*
   }
 }
 
+/**************************************************************************************/
+/* update_l1_miss_deps: op's l1_miss or l1_miss_satisfied changed; if that
+   changed l1_miss_pending(op) from was_pending, adjust the count of every
+   wake up entry of op and of the dependents whose state flips in turn.  Each
+   entry is visited once per flip, without recursion. */
+
+static CORE_LOCAL Op** l1_miss_dep_stack;
+static CORE_LOCAL uns l1_miss_dep_stack_size;
+
+static void propagate_l1_miss_deps(Op* op, int delta) {
+  uns top = 0;
+
+  if (!l1_miss_dep_stack_size) {
+    l1_miss_dep_stack_size = 64;
+    l1_miss_dep_stack = (Op**)malloc(sizeof(Op*) * l1_miss_dep_stack_size);
+  }
+  l1_miss_dep_stack[top++] = op;
+
+  while (top) {
+    Op* src_op = l1_miss_dep_stack[--top];
+    Wake_Up_Entry* temp;
+    Wake_Up_Iter iter;
+    uns type;
+
+    for (type = 0; type < NUM_DEP_TYPES; type++) {
+      for (temp = wake_up_iter_first(&src_op->wake_up_lists[type], &iter); temp; temp = wake_up_iter_next(&iter)) {
+        Op* dep_op = temp->op;
+
+        if (dep_op->unique_num != temp->unique_num || !dep_op->op_pool_valid)
+          continue;
+        ASSERT(src_op->proc_id, src_op->proc_id == dep_op->proc_id);
+        ASSERT(dep_op->proc_id, delta > 0 || dep_op->engine_info.l1_miss_dep_srcs > 0);
+
+        Flag was_pending = l1_miss_pending(dep_op);
+        dep_op->engine_info.l1_miss_dep_srcs += delta;
+        if (dep_op->engine_info.dep_on_l1_miss && !dep_op->engine_info.l1_miss_dep_srcs)
+          dep_op->engine_info.was_dep_on_l1_miss = TRUE;
+        dep_op->engine_info.dep_on_l1_miss = dep_op->engine_info.l1_miss_dep_srcs > 0;
+
+        if (l1_miss_pending(dep_op) != was_pending) {
+          if (top == l1_miss_dep_stack_size) {
+            l1_miss_dep_stack_size *= 2;
+            l1_miss_dep_stack = (Op**)realloc(l1_miss_dep_stack, sizeof(Op*) * l1_miss_dep_stack_size);
+          }
+          l1_miss_dep_stack[top++] = dep_op;
+        }
+      }
+    }
+  }
+}
+
+void update_l1_miss_deps(Op* op, Flag was_pending) {
+  Flag pending = l1_miss_pending(op);
+  if (pending != was_pending)
+    propagate_l1_miss_deps(op, pending ? 1 : -1);
+}
+
+/**************************************************************************************/
+/* release_l1_miss_deps: op leaves the window, its entries stop counting (a
+   store can retire before its l1 miss is satisfied) */
+
+void release_l1_miss_deps(Op* op) {
+  if (l1_miss_pending(op))
+    propagate_l1_miss_deps(op, -1);
+}
+
 /**************************************************************************************/
 /* free_wake_up_list: */
 
@@ -660,20 +793,44 @@ void free_wake_up_list(Op* op) {
   ASSERT(map_data->proc_id, op);
   ASSERT(map_data->proc_id, op->proc_id == map_data->proc_id);
 
-  if (op->wake_up_tail) {
-    ASSERT(map_data->proc_id, op->wake_up_head);
+  if (op->wake_up_count) {
+    uns type;
     DEBUG(map_data->proc_id, "Freeing wake up list for op_num:%s\n", unsstr64(op->op_num));
-    op->wake_up_tail->next = map_data->free_list_head;
-    map_data->free_list_head = op->wake_up_head;
-    map_data->active_wake_up_entries -= op->wake_up_count;
-    ASSERT(map_data->proc_id, map_data->active_wake_up_entries >= 0);
-    op->wake_up_head = NULL;
-    op->wake_up_tail = NULL;
+    for (type = 0; type < NUM_DEP_TYPES; type++) {
+      Wake_Up_List* list = &op->wake_up_lists[type];
+      if (list->overflow_head) {
+        uns num_chunks = (list->count - WAKE_UP_INLINE_ENTRIES + WAKE_UP_CHUNK_ENTRIES - 1) / WAKE_UP_CHUNK_ENTRIES;
+        ASSERT(map_data->proc_id, map_data->active_wake_up_chunks >= num_chunks);
+        list->overflow_tail->next = map_data->free_list_head;
+        map_data->free_list_head = list->overflow_head;
+        map_data->active_wake_up_chunks -= num_chunks;
+        list->overflow_head = NULL;
+        list->overflow_tail = NULL;
+      }
+      list->count = 0;
+    }
+    op->wake_up_count = 0;
   } else {
     DEBUG(map_data->proc_id, "No wake up list for op_num:%s\n", unsstr64(op->op_num));
   }
 }
 
+/**************************************************************************************/
+/* free_src_info: returns the src array of a mapped op to the pool */
+
+void free_src_info(Op* op) {
+  Src_Block* block = (Src_Block*)op->oracle_info.src_info;
+
+  if (!block)
+    return;
+  ASSERT(map_data->proc_id, op->proc_id == map_data->proc_id);
+  ASSERT(map_data->proc_id, map_data->active_src_blocks);
+  block->next = map_data->free_src_blocks;
+  map_data->free_src_blocks = block;
+  map_data->active_src_blocks--;
+  op->oracle_info.src_info = NULL;
+}
+
 /**************************************************************************************/
 /* add_src_from_op: . */
 
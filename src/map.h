@@ -54,19 +54,66 @@ typedef struct Map_Data_struct {
   Flag last_store_flag;
 
   Hash_Table oracle_mem_hash;
+  Counter mem_flag_epoch; /* recoveries so far, see Mem_Map_Entry flag_epoch */
 
-  Wake_Up_Entry* free_list_head;
-  uns wake_up_entries;
-  uns active_wake_up_entries;
+  Wake_Up_Chunk* free_list_head;
+  uns wake_up_chunks;
+  uns active_wake_up_chunks;
+
+  Src_Block* free_src_blocks;
+  uns src_blocks;
+  uns active_src_blocks;
 
   /* register files for INT/FP with arch/physical tables */
   Reg_File* reg_file[REG_FILE_REG_TYPE_NUM];
 } Map_Data;
 
+/* walks one wake up list in order:
+   for (entry = wake_up_iter_first(list, &iter); entry; entry = wake_up_iter_next(&iter)) */
+typedef struct Wake_Up_Iter_struct {
+  Wake_Up_Entry* entry;
+  Wake_Up_Entry* end;
+  Wake_Up_Chunk* next_chunk;
+  uns left;  // entries after end
+} Wake_Up_Iter;
+
 /**************************************************************************************/
 /* External Variables */
 
-extern Map_Data* map_data;
+extern CORE_LOCAL Map_Data* map_data;
+
+/**************************************************************************************/
+/* Inline functions */
+
+static inline Wake_Up_Entry* wake_up_iter_first(Wake_Up_List* list, Wake_Up_Iter* iter) {
+  uns num = MIN2(list->count, WAKE_UP_INLINE_ENTRIES);
+  if (!num)
+    return NULL;
+  iter->entry = list->inline_entries;
+  iter->end = list->inline_entries + num;
+  iter->next_chunk = list->overflow_head;
+  iter->left = list->count - num;
+  return iter->entry;
+}
+
+/* is op waiting for an l1 miss, its own or one of its srcs' (TRACK_L1_MISS_DEPS) */
+static inline Flag l1_miss_pending(Op* op) {
+  return (op->engine_info.l1_miss && !op->engine_info.l1_miss_satisfied) || op->engine_info.dep_on_l1_miss;
+}
+
+static inline Wake_Up_Entry* wake_up_iter_next(Wake_Up_Iter* iter) {
+  uns num;
+  if (++iter->entry < iter->end)
+    return iter->entry;
+  if (!iter->left)
+    return NULL;
+  num = MIN2(iter->left, WAKE_UP_CHUNK_ENTRIES);
+  iter->entry = iter->next_chunk->entries;
+  iter->end = iter->entry + num;
+  iter->next_chunk = iter->next_chunk->next;
+  iter->left -= num;
+  return iter->entry;
+}
 
 /**************************************************************************************/
 /* Prototypes */
@@ -80,6 +127,9 @@ void map_op(Op*);
 void map_mem_dep(Op*);
 void wake_up_ops(Op*, Dep_Type, void (*)(Op*, Op*, uns8));
 void free_wake_up_list(Op*);
+void free_src_info(Op*);
+void update_l1_miss_deps(Op*, Flag);
+void release_l1_miss_deps(Op*);
 void add_to_wake_up_lists(Op*, Op_Info*, void (*)(Op*, Op*, uns8));
 
 void add_src_from_op(Op*, Op*, Dep_Type);
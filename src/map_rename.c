@@ -49,7 +49,7 @@
 /**************************************************************************************/
 /* Extern Definition */
 
-struct reg_file **reg_file;
+CORE_LOCAL struct reg_file **reg_file;
 
 extern Op invalid_op;
 
@@ -59,7 +59,7 @@ extern Op invalid_op;
 /* Prototypes */
 
 // free list operations
-void reg_free_list_init(struct reg_free_list *reg_free_list);
+void reg_free_list_init(struct reg_free_list *reg_free_list, struct reg_table_entry *entries, uns size);
 void reg_free_list_free(struct reg_free_list *reg_free_list, struct reg_table_entry *entry);
 struct reg_table_entry *reg_free_list_alloc(struct reg_free_list *reg_free_list);
 
@@ -405,6 +405,8 @@ static inline void reg_file_write_dst(Op *op, int self_reg_table_type, int paren
     reg_table->entries[self_reg_id].num_refs++;
 
     // update the parent table to ensure the latest assignment
+    if (parent_reg_table_type == REG_TABLE_TYPE_ARCHITECTURAL)
+      reg_file_log_srt_write(reg_type, parent_reg_id, op->prev_dst_reg_id[ii][self_reg_table_type]);
     reg_table->parent_reg_table->entries[parent_reg_id].child_reg_id = self_reg_id;
 
     // update the dst register id into the op
@@ -546,9 +548,11 @@ static inline void reg_file_release_prev(Op *op, int *reg_table_types, int reg_t
 static inline void reg_file_init_checkpoint() {
   for (uns ii = 0; ii < REG_FILE_REG_TYPE_NUM; ++ii) {
     reg_file[ii]->reg_checkpoint = (struct reg_checkpoint *)malloc(sizeof(struct reg_checkpoint));
-    reg_file[ii]->reg_checkpoint->entries = (struct reg_table_entry *)malloc(
-        sizeof(struct reg_table_entry) * reg_file[ii]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL]->size);
     reg_file[ii]->reg_checkpoint->is_valid = FALSE;
+    reg_file[ii]->reg_checkpoint->log_num = 0;
+    reg_file[ii]->reg_checkpoint->log_size = REG_FILE_CHECKPOINT_LOG_INIT_SIZE;
+    reg_file[ii]->reg_checkpoint->log = (struct reg_checkpoint_log_entry *)malloc(
+        sizeof(struct reg_checkpoint_log_entry) * REG_FILE_CHECKPOINT_LOG_INIT_SIZE);
   }
 }
 
@@ -556,16 +560,32 @@ static inline void reg_file_init_checkpoint() {
   Scarab currently does not support early flushes and will only trigger a flush if the
   oldest mispredicted branch is resolved
   Therefore, only maintain one checkpoint of that mispredicted branch for recovering SRT
+  The SRT itself is not copied; the writes made after the snapshot are logged instead
 */
 static inline void reg_file_snapshot_srt() {
   for (uns ii = 0; ii < REG_FILE_REG_TYPE_NUM; ++ii) {
-    struct reg_table *srt = reg_file[ii]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL];
     struct reg_checkpoint *checkpoint = reg_file[ii]->reg_checkpoint;
-    memcpy(checkpoint->entries, srt->entries, sizeof(struct reg_table_entry) * srt->size);
 
     ASSERT(map_data->proc_id, !checkpoint->is_valid);
     checkpoint->is_valid = TRUE;
+    checkpoint->log_num = 0;
+  }
+}
+
+// record the old mapping of an SRT entry before it is overwritten under a valid checkpoint
+static inline void reg_file_log_srt_write(int reg_type, int parent_reg_id, int child_reg_id) {
+  struct reg_checkpoint *checkpoint = reg_file[reg_type]->reg_checkpoint;
+  if (!checkpoint->is_valid)
+    return;
+
+  if (checkpoint->log_num == checkpoint->log_size) {
+    checkpoint->log_size *= 2;
+    checkpoint->log = (struct reg_checkpoint_log_entry *)realloc(
+        checkpoint->log, sizeof(struct reg_checkpoint_log_entry) * checkpoint->log_size);
   }
+  checkpoint->log[checkpoint->log_num].parent_reg_id = parent_reg_id;
+  checkpoint->log[checkpoint->log_num].child_reg_id = child_reg_id;
+  checkpoint->log_num++;
 }
 
 /*
@@ -578,9 +598,13 @@ static inline void reg_file_rollback_srt() {
   for (uns ii = 0; ii < REG_FILE_REG_TYPE_NUM; ++ii) {
     struct reg_table *srt = reg_file[ii]->reg_table[REG_TABLE_TYPE_ARCHITECTURAL];
     struct reg_checkpoint *checkpoint = reg_file[ii]->reg_checkpoint;
-    memcpy(srt->entries, checkpoint->entries, sizeof(struct reg_table_entry) * srt->size);
-
     ASSERT(map_data->proc_id, checkpoint->is_valid);
+
+    // only the child mapping of SRT entries changes after init, undo those writes
+    while (checkpoint->log_num > 0) {
+      struct reg_checkpoint_log_entry *log = &checkpoint->log[--checkpoint->log_num];
+      srt->entries[log->parent_reg_id].child_reg_id = log->child_reg_id;
+    }
     checkpoint->is_valid = FALSE;
   }
 }
@@ -588,32 +612,42 @@ static inline void reg_file_rollback_srt() {
 /**************************************************************************************/
 /* register free list operation */
 
-void reg_free_list_init(struct reg_free_list *reg_free_list) {
+void reg_free_list_init(struct reg_free_list *reg_free_list, struct reg_table_entry *entries, uns size) {
   ASSERT(map_data->proc_id, reg_free_list != NULL);
 
+  reg_free_list->entries = entries;
+  reg_free_list->num_words = (size + 63) / 64;
+  reg_free_list->free_bits = (uns64 *)calloc(MAX2(reg_free_list->num_words, 1), sizeof(uns64));
+  reg_free_list->first_word = reg_free_list->num_words;
   reg_free_list->reg_free_num = 0;
-  reg_free_list->reg_free_list_head = NULL;
 }
 
-/* push the entry to the free list */
+/* set the bit of the entry in the free list */
 void reg_free_list_free(struct reg_free_list *reg_free_list, struct reg_table_entry *entry) {
-  ASSERT(map_data->proc_id, reg_free_list != NULL && entry->next_free == NULL);
+  ASSERT(map_data->proc_id, reg_free_list != NULL && entry == &reg_free_list->entries[entry->self_reg_id]);
+  uns word = entry->self_reg_id / 64;
+  uns64 bit = 1ULL << (entry->self_reg_id % 64);
+  ASSERT(map_data->proc_id, !(reg_free_list->free_bits[word] & bit));
 
-  entry->next_free = reg_free_list->reg_free_list_head;
-  reg_free_list->reg_free_list_head = entry;
+  reg_free_list->free_bits[word] |= bit;
+  reg_free_list->first_word = MIN2(reg_free_list->first_word, word);
   ++reg_free_list->reg_free_num;
 }
 
-/* pop the entry from the free list */
+/* take the lowest free entry from the free list */
 struct reg_table_entry *reg_free_list_alloc(struct reg_free_list *reg_free_list) {
-  ASSERT(map_data->proc_id, reg_free_list != NULL && reg_free_list->reg_free_list_head != NULL);
+  ASSERT(map_data->proc_id, reg_free_list != NULL && reg_free_list->reg_free_num > 0);
+
+  while (!reg_free_list->free_bits[reg_free_list->first_word])
+    ++reg_free_list->first_word;
+  ASSERT(map_data->proc_id, reg_free_list->first_word < reg_free_list->num_words);
 
-  struct reg_table_entry *entry = reg_free_list->reg_free_list_head;
-  reg_free_list->reg_free_list_head = entry->next_free;
-  entry->next_free = NULL;
+  uns64 *word = &reg_free_list->free_bits[reg_free_list->first_word];
+  uns reg_id = reg_free_list->first_word * 64 + __builtin_ctzll(*word);
+  *word &= *word - 1;
   --reg_free_list->reg_free_num;
 
-  return entry;
+  return &reg_free_list->entries[reg_id];
 }
 
 struct reg_free_list_ops reg_free_list_ops = {
@@ -761,16 +795,16 @@ void reg_table_init(struct reg_table *reg_table, struct reg_table *parent_reg_ta
   // set the parent table pointer for tracking
   reg_table->parent_reg_table = parent_reg_table;
 
-  reg_table->free_list = (struct reg_free_list *)malloc(sizeof(struct reg_free_list));
-  reg_table->free_list->ops = &reg_free_list_ops;
-  reg_table->free_list->ops->init(reg_table->free_list);
-
   reg_table->reg_type = reg_type;
   reg_table->reg_table_type = reg_table_type;
 
   reg_table->size = reg_table_size;
   reg_table->entries = (struct reg_table_entry *)malloc(sizeof(struct reg_table_entry) * reg_table_size);
 
+  reg_table->free_list = (struct reg_free_list *)malloc(sizeof(struct reg_free_list));
+  reg_table->free_list->ops = &reg_free_list_ops;
+  reg_table->free_list->ops->init(reg_table->free_list, reg_table->entries, reg_table_size);
+
   // init and insert all the empty entries into the free list
   for (uns ii = 0; ii < reg_table_size; ii++) {
     struct reg_table_entry *entry = &reg_table->entries[ii];
@@ -779,7 +813,6 @@ void reg_table_init(struct reg_table *reg_table, struct reg_table *parent_reg_ta
     entry->reg_type = reg_type;
     entry->reg_table_type = reg_table_type;
     entry->ops->clear(entry);
-    entry->next_free = NULL;
     reg_table->free_list->ops->free(reg_table->free_list, entry);
   }
 
@@ -1045,9 +1078,9 @@ void reg_renaming_scheme_realistic_recover(Op *op) {
 
   // release the registers from the youngest to the flush point
   int reg_table_types[] = {REG_TABLE_TYPE_PHYSICAL};
-  for (Op **op_p = (Op **)list_start_tail_traversal(&td->seq_op_list); op_p && (*op_p)->op_num > op->op_num;
-       op_p = (Op **)list_prev_element(&td->seq_op_list)) {
-    reg_file_flush_mispredict(*op_p, reg_table_types, sizeof(reg_table_types) / sizeof(reg_table_types[0]));
+  for (int ii = td->seq_op_list.count - 1; ii >= 0 && RING_AT(&td->seq_op_list, Op *, ii)->op_num > op->op_num; ii--) {
+    reg_file_flush_mispredict(RING_AT(&td->seq_op_list, Op *, ii), reg_table_types,
+                              sizeof(reg_table_types) / sizeof(reg_table_types[0]));
   }
 }
 
@@ -1194,9 +1227,9 @@ void reg_renaming_scheme_late_allocation_recover(Op *op) {
 
   // release the registers from the youngest to the flush point for both register tables
   int reg_table_types[] = {REG_TABLE_TYPE_VIRTUAL, REG_TABLE_TYPE_PHYSICAL};
-  for (Op **op_p = (Op **)list_start_tail_traversal(&td->seq_op_list); op_p && (*op_p)->op_num > op->op_num;
-       op_p = (Op **)list_prev_element(&td->seq_op_list)) {
-    reg_file_flush_mispredict(*op_p, reg_table_types, sizeof(reg_table_types) / sizeof(reg_table_types[0]));
+  for (int ii = td->seq_op_list.count - 1; ii >= 0 && RING_AT(&td->seq_op_list, Op *, ii)->op_num > op->op_num; ii--) {
+    reg_file_flush_mispredict(RING_AT(&td->seq_op_list, Op *, ii), reg_table_types,
+                              sizeof(reg_table_types) / sizeof(reg_table_types[0]));
   }
 }
 
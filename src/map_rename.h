@@ -66,6 +66,7 @@ const static int REG_TABLE_TYPE_INVALID = -1;
 const static int REG_FILE_REG_TYPE_OTHER = -1;
 const static uns REG_RENAMING_SCHEME_LATE_ALLOCATION_RESERVE_NUM = 1;
 const static int REG_RENAMING_SCHEME_EARLY_RELEASE_PENDING_CONSUMED_MAX = 7;
+const static uns REG_FILE_CHECKPOINT_LOG_INIT_SIZE = 256;  // SRT writes logged per checkpoint before growing
 
 // CPUID instruction will need 4 int register destination
 const static uns REG_FILE_MAX_DESTS[] = {4, 2};
@@ -92,9 +93,6 @@ struct reg_table_entry {
   // register state info
   enum reg_table_entry_state reg_state;
 
-  // tracking free register entries
-  struct reg_table_entry *next_free;
-
   // register entry operation
   struct reg_table_entry_ops *ops;
 
@@ -134,8 +132,11 @@ struct reg_table_entry {
 };
 
 struct reg_free_list {
-  // stack implementation for free list
-  struct reg_table_entry *reg_free_list_head;
+  // bit vector implementation for free list, bit i is set when entries[i] is free
+  uns64 *free_bits;
+  uns num_words;
+  uns first_word;  // no free entry below this word
+  struct reg_table_entry *entries;
   uns reg_free_num;
 
   // free list operation
@@ -161,12 +162,19 @@ struct reg_table {
   struct reg_table_ops *ops;
 };
 
+struct reg_checkpoint_log_entry {
+  int parent_reg_id;  // SRT entry that was written
+  int child_reg_id;   // its mapping before the write
+};
+
 struct reg_checkpoint {
   // metadata for validation of the special checkpoint mechanism in Scarab
   Flag is_valid;
 
-  // only map on-path op for recovery
-  struct reg_table_entry *entries;
+  // SRT writes since the snapshot, undone from the newest on rollback
+  struct reg_checkpoint_log_entry *log;
+  uns log_num;
+  uns log_size;
 };
 
 struct reg_file {
@@ -192,7 +200,7 @@ struct reg_table_entry_ops {
 };
 
 struct reg_free_list_ops {
-  void (*init)(struct reg_free_list *reg_free_list);
+  void (*init)(struct reg_free_list *reg_free_list, struct reg_table_entry *entries, uns size);
   void (*free)(struct reg_free_list *reg_free_list, struct reg_table_entry *entry);
   struct reg_table_entry *(*alloc)(struct reg_free_list *reg_free_list);
 };
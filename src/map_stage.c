@@ -45,6 +45,7 @@
 
 #include "bp/bp.h"
 
+#include "core_context.h"
 #include "ft.h"
 #include "map.h"
 #include "map_rename.h"
@@ -62,9 +63,9 @@
 /**************************************************************************************/
 /* Global Variables */
 
-Map_Stage* map = NULL;
+CORE_LOCAL Map_Stage* map = NULL;
 
-int map_off_path = 0;
+CORE_LOCAL int map_off_path = 0;
 Counter map_stage_next_op_num = 1;
 /* The next op number is used when deciding whether to consume ops from the uop
  * cache: i.e. check if any preceding instructions are still in the decoder. */
@@ -79,8 +80,8 @@ static inline void map_stage_fetch_op(Stage_Data*);
 /**************************************************************************************/
 /* set_map_stage: */
 
-void set_map_stage(Map_Stage* new_map) {
-  map = new_map;
+void set_map_stage(Core_Context* ctx) {
+  map = ctx->map;
 }
 
 /**************************************************************************************/
@@ -172,7 +173,8 @@ void debug_map_stage() {
 /**************************************************************************************/
 /* map_cycle: */
 
-void update_map_stage(Stage_Data* src_sd) {
+void update_map_stage(Core_Context* ctx, Stage_Data* src_sd) {
+  set_map_stage(ctx);
   /* stall if the renaming table is full */
   if (!reg_file_available(STAGE_MAX_OP_COUNT)) {
     map->reg_file_stall = TRUE;
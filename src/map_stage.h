@@ -46,18 +46,18 @@ typedef struct Map_Stage_struct {
 /**************************************************************************************/
 /* External Variables */
 
-extern Map_Stage* map;
+extern CORE_LOCAL Map_Stage* map;
 
 /**************************************************************************************/
 /* prototypes */
 
 /* vanilla hps model */
-void set_map_stage(Map_Stage*);
+void set_map_stage(Core_Context*);
 void init_map_stage(uns8, const char*);
 void reset_map_stage(void);
 void recover_map_stage(void);
 void debug_map_stage(void);
-void update_map_stage(Stage_Data*);
+void update_map_stage(Core_Context*, Stage_Data*);
 
 /**************************************************************************************/
 
@@ -0,0 +1,435 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+/***************************************************************************************
+ * File         : mem_replay_model.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Memory replay model: replays the requests the cores sent to the memory
+ *                system in a recorded run (MEM_RECORD_FILE) without simulating the cores
+ ***************************************************************************************/
+
+/* Any model records the requests its cores hand to new_mem_req and new_mem_dc_wb_req
+   (icache and dcache misses, stores, writebacks and the core-side prefetches) when
+   MEM_RECORD_FILE is set, one stream per core. The requests the uncore prefetchers send
+   from pref_update are not recorded: the replay runs the same uncore, which regenerates
+   them.
+
+   The mem_replay model drives the real uncore with these streams. Each core sends its
+   next request once its core cycle reaches the recorded one. When the memory system does
+   not take a request, the core retries it in the next cycle and the rest of its stream
+   slips by one cycle, so a slower memory system stretches the run the way a stalled core
+   would (without the overlap an out-of-order core finds, which the replay cannot know).
+   The replayed requests carry no op, so the PC-based prefetchers see no load PCs.
+
+   BOGUS_REPLAY uses the same streams inside the cmp model. Every core keeps the last
+   BOGUS_REPLAY_RECORDS requests of its real run in a ring. Once the core is done, the cmp
+   model stops simulating its pipeline and the ring is replayed in a loop to keep the
+   interference on the other cores, instead of running the restarted trace in detail. Each
+   pass lasts from the oldest request in the ring to the cycle the core finished in. */
+
+#include "mem_replay_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "general.param.h"
+#include "memory/memory.param.h"
+#include "prefetcher/pref.param.h"
+
+#include "prefetcher/pref_common.h"
+
+#include "freq.h"
+#include "model.h"
+#include "sim.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define MEM_REPLAY_BIN_MAGIC "SCARMRQ"
+#define MEM_REPLAY_BIN_VERSION 1
+#define MEM_REPLAY_BUF_RECORDS 4096
+
+/**************************************************************************************/
+/* Types */
+
+/* one request of the binary stream */
+typedef struct Mem_Replay_Record_struct {
+  uns64 cycle; /* core cycle the request was sent in */
+  uns64 inst;  /* instructions retired by then */
+  uns64 addr;
+  uns16 size;
+  uns16 delay;
+  uns8 type; /* Mem_Req_Type */
+  uns8 wb;   /* sent through new_mem_dc_wb_req */
+  uns8 used_onpath;
+  uns8 pad;
+} Mem_Replay_Record;
+
+typedef struct Mem_Replay_Core_struct {
+  FILE* file;
+  Mem_Replay_Record* buf;
+  uns head;    /* next record to send in buf */
+  uns count;   /* records read into buf */
+  Flag eof;    /* the whole stream is in buf */
+  Counter lag; /* cycles the stream slipped behind the recorded timing */
+  Counter base; /* cycles added to the recorded ones in this pass over a looped stream */
+  Counter loop; /* cycles of one pass over the stream, 0 if it is not looped */
+} Mem_Replay_Core;
+
+/* BOGUS_REPLAY: ring of the recent requests of a core, then the looped replay of them */
+typedef struct Bogus_Replay_Core_struct {
+  Mem_Replay_Record* ring;
+  Counter recorded; /* requests written to ring */
+  Flag replaying;
+  Mem_Replay_Core replay;
+} Bogus_Replay_Core;
+
+/**************************************************************************************/
+/* Global variables */
+
+Mem_Replay_Model mem_replay_model;
+static Mem_Replay_Core* replay_cores;
+static FILE** record_files;
+static Counter replay_req_num;
+static Bogus_Replay_Core* bogus_cores;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static FILE* mem_replay_open(const char* name, const char* mode, uns proc_id);
+static Flag mem_replay_next(Mem_Replay_Core* core);
+static Flag mem_replay_req_done(Mem_Req* req);
+static Flag mem_replay_issue(uns proc_id, Mem_Replay_Core* core);
+static void mem_replay_fill_record(Mem_Replay_Record* rec, Mem_Req_Type type, uns proc_id, Addr addr, uns size,
+                                   uns delay, Flag wb, Flag used_onpath);
+
+/**************************************************************************************/
+/* mem_replay_open: opens one stream file and reads or writes its header */
+
+static FILE* mem_replay_open(const char* name, const char* mode, uns proc_id) {
+  FILE* file = fopen(name, mode);
+  ASSERTM(proc_id, file, "Could not open %s\n", name);
+
+  if (mode[0] == 'w') {
+    uns32 header[4] = {MEM_REPLAY_BIN_VERSION, proc_id, sizeof(Mem_Replay_Record), 0};
+    fwrite(MEM_REPLAY_BIN_MAGIC, 1, 8, file);
+    fwrite(header, sizeof(header), 1, file);
+  } else {
+    char magic[8];
+    uns32 header[4];
+    Flag ok = fread(magic, 1, 8, file) == 8 && fread(header, sizeof(header), 1, file) == 1;
+    ASSERTM(proc_id, ok && !memcmp(magic, MEM_REPLAY_BIN_MAGIC, 8), "%s is not a memory request stream\n", name);
+    ASSERTM(proc_id, header[0] == MEM_REPLAY_BIN_VERSION && header[2] == sizeof(Mem_Replay_Record),
+            "%s has version %u, expected %u\n", name, header[0], MEM_REPLAY_BIN_VERSION);
+  }
+  return file;
+}
+
+/**************************************************************************************/
+/* mem_record_req: appends a request a core sent to the stream of the core */
+
+void mem_record_req(Mem_Req_Type type, uns proc_id, Addr addr, uns size, uns delay, Flag wb, Flag used_onpath) {
+  if (!record_files)
+    record_files = (FILE**)calloc(NUM_CORES, sizeof(FILE*));
+  if (!record_files[proc_id]) {
+    char name[MAX_STR_LENGTH + 1];
+    snprintf(name, MAX_STR_LENGTH, "%s%s.%u.bin", FILE_TAG, MEM_RECORD_FILE, proc_id);
+    record_files[proc_id] = mem_replay_open(name, "wb", proc_id);
+  }
+
+  Mem_Replay_Record rec;
+  mem_replay_fill_record(&rec, type, proc_id, addr, size, delay, wb, used_onpath);
+  fwrite(&rec, sizeof(rec), 1, record_files[proc_id]);
+}
+
+static void mem_replay_fill_record(Mem_Replay_Record* rec, Mem_Req_Type type, uns proc_id, Addr addr, uns size,
+                                   uns delay, Flag wb, Flag used_onpath) {
+  memset(rec, 0, sizeof(*rec));
+  rec->cycle = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+  rec->inst = inst_count[proc_id];
+  rec->addr = addr;
+  rec->size = size;
+  rec->delay = MIN2(delay, 0xffff);
+  rec->type = type;
+  rec->wb = wb;
+  rec->used_onpath = used_onpath;
+}
+
+/**************************************************************************************/
+/* mem_record_done: */
+
+void mem_record_done(void) {
+  if (!record_files)
+    return;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (record_files[proc_id])
+      fclose(record_files[proc_id]);
+  }
+  free(record_files);
+  record_files = NULL;
+}
+
+/**************************************************************************************/
+/* mem_replay_next: makes sure the next record of the core is in its buffer, returns
+ * FALSE at the end of the stream. A looped stream starts its next pass instead. */
+
+static Flag mem_replay_next(Mem_Replay_Core* core) {
+  if (core->head < core->count)
+    return TRUE;
+  if (core->loop && core->count) {
+    core->head = 0;
+    core->base += core->loop;
+    return TRUE;
+  }
+  if (core->eof)
+    return FALSE;
+  core->head = 0;
+  core->count = fread(core->buf, sizeof(Mem_Replay_Record), MEM_REPLAY_BUF_RECORDS, core->file);
+  core->eof = core->count < MEM_REPLAY_BUF_RECORDS;
+  return core->count > 0;
+}
+
+/**************************************************************************************/
+/* mem_replay_init */
+
+void mem_replay_init(uns mode) {
+  if (mode != WARMUP_MODE)
+    return;
+
+  ASSERTM(0, MEM_REPLAY_FILE, "The mem_replay model needs a MEM_REPLAY_FILE\n");
+  ASSERTM(0, !WARMUP, "The mem_replay model has no warmup, the recorded stream starts after it\n");
+  ASSERTM(0, !DUMB_CORE_ON, "The mem_replay model cannot run next to a dumb core\n");
+
+  replay_req_num = 0;
+  replay_cores = (Mem_Replay_Core*)calloc(NUM_CORES, sizeof(Mem_Replay_Core));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Mem_Replay_Core* core = &replay_cores[proc_id];
+    char name[MAX_STR_LENGTH + 1];
+    snprintf(name, MAX_STR_LENGTH, "%s.%u.bin", MEM_REPLAY_FILE, proc_id);
+    core->file = mem_replay_open(name, "rb", proc_id);
+    core->buf = (Mem_Replay_Record*)malloc(MEM_REPLAY_BUF_RECORDS * sizeof(Mem_Replay_Record));
+  }
+
+  freq_init();
+  set_memory(&mem_replay_model.memory);
+  init_memory();
+}
+
+/**************************************************************************************/
+/* mem_replay_reset: */
+
+void mem_replay_reset(void) {
+  reset_memory();
+}
+
+/**************************************************************************************/
+/* mem_replay_cycle: */
+
+static Flag mem_replay_req_done(Mem_Req* req) {
+  return TRUE;
+}
+
+/* sends the requests of the core that are due, returns FALSE at the end of its stream */
+static Flag mem_replay_issue(uns proc_id, Mem_Replay_Core* core) {
+  while (mem_replay_next(core)) {
+    Mem_Replay_Record* rec = &core->buf[core->head];
+    if (rec->cycle + core->base + core->lag > cycle_count)
+      return TRUE;
+
+    Flag sent;
+    if (rec->wb)
+      sent = new_mem_dc_wb_req(rec->type, proc_id, rec->addr, rec->size, rec->delay, NULL, NULL, replay_req_num,
+                               rec->used_onpath);
+    else
+      sent = new_mem_req(rec->type, proc_id, rec->addr, rec->size, rec->delay, NULL, mem_replay_req_done,
+                         replay_req_num, NULL);
+    if (!sent) {
+      STAT_EVENT(proc_id, MEM_REPLAY_STALL_CYCLE);
+      core->lag++;
+      return TRUE;
+    }
+
+    STAT_EVENT(proc_id, rec->wb ? MEM_REPLAY_WB : MEM_REPLAY_REQ);
+    replay_req_num++;
+    core->head++;
+    /* a looped stream replays a finished core, whose counts are final */
+    if (core->loop)
+      STAT_EVENT(proc_id, BOGUS_REPLAY_REQ);
+    else if (rec->inst > inst_count[proc_id]) {
+      INC_STAT_EVENT(proc_id, NODE_INST_COUNT, rec->inst - inst_count[proc_id]);
+      inst_count[proc_id] = rec->inst;
+      uop_count[proc_id] = rec->inst;
+    }
+  }
+  return FALSE;
+}
+
+void mem_replay_cycle(void) {
+  update_memory();
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    if (retired_exit[proc_id] || !freq_is_ready(FREQ_DOMAIN_CORES[proc_id]))
+      continue;
+    cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+    STAT_EVENT(proc_id, NODE_CYCLE);
+    /* the stream is over once its last requests are done */
+    if (!mem_replay_issue(proc_id, &replay_cores[proc_id]) && mem_get_req_count(proc_id) == 0)
+      retired_exit[proc_id] = TRUE;
+  }
+}
+
+/**************************************************************************************/
+/* mem_replay_debug: */
+
+void mem_replay_debug(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Mem_Replay_Core* core = &replay_cores[proc_id];
+    cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+
+    FPRINT_LINE(proc_id, GLOBAL_DEBUG_STREAM);
+    DPRINTF("# mem_replay core %u  cycle:%s  lag:%s  buffered:%u  reqs:%d\n", proc_id, unsstr64(cycle_count),
+            unsstr64(core->lag), core->count - core->head, mem_get_req_count(proc_id));
+  }
+  debug_memory();
+}
+
+/**************************************************************************************/
+/* mem_replay_per_core_done: */
+
+void mem_replay_per_core_done(uns8 proc_id) {
+  Counter cycles = GET_TOTAL_STAT_EVENT(proc_id, NODE_CYCLE);
+
+  fprintf(mystdout, "** Core %u mem_replay: %llu insts, %llu cycles (%llu behind the recording)\n", proc_id,
+          inst_count[proc_id], cycles, replay_cores[proc_id].lag);
+  if (PREF_FRAMEWORK_ON)
+    pref_per_core_done(proc_id);
+}
+
+/**************************************************************************************/
+/* mem_replay_done: */
+
+void mem_replay_done(void) {
+  if (PREF_FRAMEWORK_ON)
+    pref_done();
+  finalize_memory();
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    fclose(replay_cores[proc_id].file);
+    free(replay_cores[proc_id].buf);
+  }
+  free(replay_cores);
+  replay_cores = NULL;
+}
+
+/**************************************************************************************/
+/* bogus_replay_record: keeps a request of a core that is not done in the ring of the core */
+
+void bogus_replay_record(Mem_Req_Type type, uns proc_id, Addr addr, uns size, uns delay, Flag wb, Flag used_onpath) {
+  if (!bogus_cores)
+    bogus_cores = (Bogus_Replay_Core*)calloc(NUM_CORES, sizeof(Bogus_Replay_Core));
+  Bogus_Replay_Core* core = &bogus_cores[proc_id];
+  if (!core->ring)
+    core->ring = (Mem_Replay_Record*)malloc(BOGUS_REPLAY_RECORDS * sizeof(Mem_Replay_Record));
+
+  Mem_Replay_Record rec;
+  mem_replay_fill_record(&rec, type, proc_id, addr, size, delay, wb, used_onpath);
+  /* the core cycles restarted (a reset after warmup), keep only the requests after it */
+  if (core->recorded && rec.cycle < core->ring[(core->recorded - 1) % BOGUS_REPLAY_RECORDS].cycle)
+    core->recorded = 0;
+  core->ring[core->recorded % BOGUS_REPLAY_RECORDS] = rec;
+  core->recorded++;
+}
+
+/**************************************************************************************/
+/* bogus_replay_start: starts the looped replay of a core that is done at cycle_count,
+ * returns FALSE if it sent no request to replay */
+
+Flag bogus_replay_start(uns proc_id) {
+  Bogus_Replay_Core* core = bogus_cores ? &bogus_cores[proc_id] : NULL;
+  if (!core || !core->recorded)
+    return FALSE;
+
+  /* unroll the ring, oldest request first */
+  uns count = MIN2(core->recorded, BOGUS_REPLAY_RECORDS);
+  uns oldest = core->recorded > BOGUS_REPLAY_RECORDS ? core->recorded % BOGUS_REPLAY_RECORDS : 0;
+  Mem_Replay_Core* replay = &core->replay;
+  memset(replay, 0, sizeof(*replay));
+  replay->buf = (Mem_Replay_Record*)malloc(count * sizeof(Mem_Replay_Record));
+  memcpy(replay->buf, core->ring + oldest, (count - oldest) * sizeof(Mem_Replay_Record));
+  memcpy(replay->buf + count - oldest, core->ring, oldest * sizeof(Mem_Replay_Record));
+  free(core->ring);
+  core->ring = NULL;
+
+  Counter first = replay->buf[0].cycle;
+  replay->count = count;
+  replay->eof = TRUE;
+  replay->loop = MAX2(cycle_count, replay->buf[count - 1].cycle) - first + 1;
+  replay->base = cycle_count + 1 - first; /* the first pass starts next cycle */
+  core->replaying = TRUE;
+  STAT_EVENT(proc_id, BOGUS_REPLAY_LOOP);
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* bogus_replay_active: */
+
+Flag bogus_replay_active(uns proc_id) {
+  return bogus_cores && bogus_cores[proc_id].replaying;
+}
+
+/**************************************************************************************/
+/* bogus_replay_cycle: sends the requests of the replayed core due at cycle_count */
+
+void bogus_replay_cycle(uns proc_id) {
+  Mem_Replay_Core* replay = &bogus_cores[proc_id].replay;
+  Counter base = replay->base;
+  mem_replay_issue(proc_id, replay);
+  if (replay->base != base)
+    STAT_EVENT(proc_id, BOGUS_REPLAY_LOOP);
+}
+
+/**************************************************************************************/
+/* bogus_replay_done: */
+
+void bogus_replay_done(void) {
+  if (!bogus_cores)
+    return;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    free(bogus_cores[proc_id].ring);
+    free(bogus_cores[proc_id].replay.buf);
+  }
+  free(bogus_cores);
+  bogus_cores = NULL;
+}
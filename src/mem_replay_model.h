@@ -0,0 +1,73 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+/***************************************************************************************
+ * File         : mem_replay_model.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Memory replay model: replays the requests the cores sent to the memory
+ *                system in a recorded run (MEM_RECORD_FILE) without simulating the cores
+ ***************************************************************************************/
+
+#ifndef __MEM_REPLAY_MODEL_H__
+#define __MEM_REPLAY_MODEL_H__
+
+#include "memory/memory.h"
+
+/**************************************************************************************/
+/* mem replay model data  */
+
+typedef struct Mem_Replay_Model_struct {
+  Memory memory;
+} Mem_Replay_Model;
+
+/**************************************************************************************/
+/* Global vars */
+
+extern Mem_Replay_Model mem_replay_model;
+
+/**************************************************************************************/
+/* Prototypes */
+
+void mem_replay_init(uns mode);
+void mem_replay_reset(void);
+void mem_replay_cycle(void);
+void mem_replay_debug(void);
+void mem_replay_per_core_done(uns8);
+void mem_replay_done(void);
+
+/* recorder of the requests sent by the cores, called by the memory system */
+void mem_record_req(Mem_Req_Type type, uns proc_id, Addr addr, uns size, uns delay, Flag wb, Flag used_onpath);
+void mem_record_done(void);
+
+/* BOGUS_REPLAY: the cmp model loops the recorded requests of a finished core */
+void bogus_replay_record(Mem_Req_Type type, uns proc_id, Addr addr, uns size, uns delay, Flag wb, Flag used_onpath);
+Flag bogus_replay_start(uns proc_id);
+Flag bogus_replay_active(uns proc_id);
+void bogus_replay_cycle(uns proc_id);
+void bogus_replay_done(void);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __MEM_REPLAY_MODEL_H__ */
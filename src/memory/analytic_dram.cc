@@ -0,0 +1,172 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : memory/analytic_dram.cc
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Analytic DRAM timing model that can stand in for Ramulator
+ ***************************************************************************************/
+
+/* The model schedules every request first come, first served at the moment it is sent. Each bank tracks its open
+ * row (open-page policy) and when it can take its next command, and each channel tracks when its data bus frees
+ * up. A row hit waits for tCL (tCWL for writes), a row miss adds tRCD, and a row conflict adds tRP after the open
+ * row has been active for tRAS. Waiting for a busy bank or bus is the queueing delay. Refresh and read/write
+ * turnaround are not modeled. */
+
+#include <algorithm>
+#include <vector>
+
+#include "memory/analytic_dram.h"
+
+extern "C" {
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/utils.h"
+
+#include "memory/memory.param.h"
+#include "ramulator.param.h"
+
+#include "statistics.h"
+}
+
+using ramulator::Request;
+
+struct Analytic_Bank {
+  long open_row = -1;  // -1 while precharged
+  Counter ready = 0;   // first cycle the bank takes another column command
+  Counter act = 0;     // cycle of the last activation
+};
+
+struct Analytic_Channel {
+  std::vector<Analytic_Bank> banks;
+  Counter bus_free = 0;  // first cycle the data bus is idle
+  uns reads = 0;         // requests sent and not yet completed, bounded by the Ramulator queue sizes
+  uns writes = 0;
+};
+
+struct Analytic_Access {
+  Counter due;
+  Counter seq;
+  uns channel;
+  Request req;
+};
+
+// accesses leave a min-heap by due cycle, the ones due in the same cycle in the order they were sent
+struct Analytic_Access_Later {
+  bool operator()(const Analytic_Access& a, const Analytic_Access& b) const {
+    return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+  }
+};
+
+static std::vector<Analytic_Channel> channels;
+static std::vector<Analytic_Access> accesses;
+static Counter dram_cycle = 0;
+static Counter access_seq = 0;
+static uns lines_per_row;
+static uns banks_per_rank;
+static uns burst_cycles;
+
+void analytic_dram_init(void) {
+  // a column delivers one bus width, so a row holds RAMULATOR_COLS bus widths
+  lines_per_row = MAX2(1, RAMULATOR_COLS * BUS_WIDTH_IN_BYTES / DCACHE_LINE_SIZE);
+  banks_per_rank = MAX2(1, RAMULATOR_BANKGROUPS) * RAMULATOR_BANKS;
+  // double data rate: two bus widths per cycle
+  burst_cycles = MAX2(RAMULATOR_TBL, DCACHE_LINE_SIZE / (2 * BUS_WIDTH_IN_BYTES));
+
+  channels.assign(RAMULATOR_CHANNELS, Analytic_Channel());
+  for (Analytic_Channel& channel : channels)
+    channel.banks.assign(RAMULATOR_RANKS * banks_per_rank, Analytic_Bank());
+  accesses.reserve(RAMULATOR_CHANNELS * (RAMULATOR_READQ_ENTRIES + RAMULATOR_WRITEQ_ENTRIES));
+}
+
+bool analytic_dram_send(Request& req) {
+  // row:bank:rank:column:channel, so that consecutive lines spread over the channels and then fill a row
+  Addr line = (Addr)req.addr / DCACHE_LINE_SIZE;
+  uns channel_id = line % RAMULATOR_CHANNELS;
+  line /= RAMULATOR_CHANNELS;
+  line /= lines_per_row;
+  uns bank_id = line % banks_per_rank;
+  line /= banks_per_rank;
+  uns rank_id = line % RAMULATOR_RANKS;
+  long row = line / RAMULATOR_RANKS;
+
+  Analytic_Channel& channel = channels[channel_id];
+  Flag is_read = req.type == Request::Type::READ;
+  if (is_read ? channel.reads >= RAMULATOR_READQ_ENTRIES : channel.writes >= RAMULATOR_WRITEQ_ENTRIES)
+    return false;
+
+  Analytic_Bank& bank = channel.banks[rank_id * banks_per_rank + bank_id];
+  Counter start = MAX2(dram_cycle, bank.ready);
+  Counter cas = start;
+  if (bank.open_row == row) {
+    STAT_EVENT(req.coreid, ANALYTIC_DRAM_ROW_HIT);
+  } else {
+    Counter act = start;
+    if (bank.open_row != -1) {
+      act = MAX2(start, bank.act + RAMULATOR_TRAS) + RAMULATOR_TRP;
+      STAT_EVENT(req.coreid, ANALYTIC_DRAM_ROW_CONFLICT);
+      STAT_EVENT(req.coreid, POWER_DRAM_PRECHARGE);
+    } else {
+      STAT_EVENT(req.coreid, ANALYTIC_DRAM_ROW_MISS);
+    }
+    STAT_EVENT(req.coreid, POWER_DRAM_ACTIVATE);
+    bank.open_row = row;
+    bank.act = act;
+    cas = act + RAMULATOR_TRCD;
+  }
+
+  // the column command waits for its slot on the data bus
+  uns cas_latency = is_read ? RAMULATOR_TCL : RAMULATOR_TCWL;
+  Counter data = MAX2(cas + cas_latency, channel.bus_free);
+  channel.bus_free = data + burst_cycles;
+  bank.ready = data - cas_latency + RAMULATOR_TCCD;
+
+  Analytic_Access access = {data + burst_cycles, access_seq++, channel_id, req};
+  accesses.push_back(access);
+  std::push_heap(accesses.begin(), accesses.end(), Analytic_Access_Later());
+  if (is_read) {
+    channel.reads++;
+    INC_STAT_EVENT(req.coreid, ANALYTIC_DRAM_READ_CYCLES, access.due - dram_cycle);
+    STAT_EVENT(req.coreid, POWER_DRAM_READ);
+  } else {
+    channel.writes++;
+    STAT_EVENT(req.coreid, POWER_DRAM_WRITE);
+  }
+  return true;
+}
+
+void analytic_dram_tick(void) {
+  dram_cycle++;
+  while (!accesses.empty() && accesses.front().due <= dram_cycle) {
+    std::pop_heap(accesses.begin(), accesses.end(), Analytic_Access_Later());
+    Analytic_Access& access = accesses.back();
+    if (access.req.type == Request::Type::READ) {
+      channels[access.channel].reads--;
+      access.req.callback(access.req);
+    } else {
+      channels[access.channel].writes--;
+    }
+    accesses.pop_back();
+  }
+}
@@ -0,0 +1,41 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : memory/analytic_dram.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Analytic DRAM timing model that can stand in for Ramulator
+ ***************************************************************************************/
+
+#ifndef __ANALYTIC_DRAM_H__
+#define __ANALYTIC_DRAM_H__
+
+#include "ramulator/Request.h"
+
+/* Requests reach the model at the same ramulator_send() boundary as Ramulator, and reads complete through their
+ * callback like Ramulator's do, so the in-flight tracking and the response queue of ramulator.cc are shared. */
+void analytic_dram_init(void);
+bool analytic_dram_send(ramulator::Request& req);
+void analytic_dram_tick(void);
+
+#endif  // __ANALYTIC_DRAM_H__
@@ -42,6 +42,7 @@
 #include "memory/mem_req.h"
 #include "memory/memory.h"
 
+#include "optimizer2.h"
 #include "stat_mon.h"
 #include "statistics.h"
 #include "trigger.h"
@@ -54,16 +55,27 @@
 /**************************************************************************************/
 /* Types */
 
+/* Utility monitor (UMON-DSS) of one core: an LRU tag stack for each of L1_PART_UMON_SETS
+   sampled sets and a hit counter per stack position */
+typedef struct Umon_struct {
+  Addr* tags;     // [sampled set * L1_ASSOC + LRU position], line index + 1 (0: invalid)
+  Counter* hits;  // [LRU position]
+  Counter accesses;
+} Umon;
+
 typedef struct Proc_Info_struct {
-  Cache shadow_cache;
+  Cache shadow_cache;  // without L1_PART_UMON_SETS
+  Umon umon;           // with L1_PART_UMON_SETS
   double* miss_rates;  // indexed by number of ways - 1
+  double accesses;     // accesses the miss curve was measured over
+  double* cost;        // this core's term of the metric, indexed by number of ways
 } Proc_Info;
 
 typedef struct Shadow_Cache_Data_struct {
   Flag prefetched;
 } Shadow_Cache_Data;
 
-typedef double (*Metric_Func)(uns*);
+typedef double (*Metric_Func)(uns proc_id, uns ways);
 typedef void (*Search_Func)(void);
 
 /**************************************************************************************/
@@ -80,6 +92,8 @@ uns* current_partition;  // actual enforced partition
 uns* new_partition;      // pre-allocated structure for new partition
 uns* temp_partition;     // pre-allocated structure for partition exploration
 uns tie_breaker_proc_id;
+uns umon_set_stride;  // every umon_set_stride-th L1 set is sampled
+uns* opt2_partitions;  // CACHE_PART_SEARCH_OPT2: [config][proc_id], config 0 is the even split
 
 /**************************************************************************************/
 /* Enums */
@@ -91,13 +105,20 @@ DEFINE_ENUM(Cache_Part_Search, CACHE_PART_SEARCH_LIST);
 /* Local Prototypes */
 
 static Flag in_shadow_cache(Addr addr);
-static double get_global_miss_rate(uns* partition);
-static double get_miss_rate_sum(uns* partition);
-static double get_gmean_perf(uns* partition);
+static void umon_access(uns proc_id, Addr addr, Flag count);
+static double get_miss_rate(uns proc_id, uns ways);
+static double get_global_miss_rate(uns proc_id, uns ways);
+static double get_miss_rate_sum(uns proc_id, uns ways);
+static double get_gmean_perf(uns proc_id, uns ways);
+static double get_metric(uns* partition);
 static double get_best_marginal_utility(uns* partition, uns proc_id, uns balance, uns* extra_ways);
 static void measure_miss_curves(void);
+static void set_way_masks(uns* partition);
 static void search_lookahead(void);
 static void search_bruteforce(void);
+static Flag next_partition(uns* partition);
+static void init_opt2_partitions(void);
+static void opt2_set_partition(int config);
 static void set_partition(void);
 static void debug_cache_part(uns* old_partition, uns* new_partition);
 
@@ -113,16 +134,29 @@ void cache_part_init(void) {
   ASSERTM(0, !PRIVATE_L1, "Cache partitioning works only on shared cache.\n");
   ASSERT(0, L1_CACHE_REPL_POLICY == REPL_PARTITION);
   ASSERT(0, L1_ASSOC <= 128);
-
-  // create shadow cache for each core
+  ASSERTM(0, !L1_PART_WAY_MASK || L1_ASSOC <= 64, "L1_PART_WAY_MASK supports at most 64 ways\n");
+
+  // create shadow cache or utility monitor for each core
+  uns num_sets = L1_SIZE / L1_LINE_SIZE / L1_ASSOC;
+  if (L1_PART_UMON_SETS) {
+    ASSERTM(0, L1_PART_UMON_SETS <= num_sets && num_sets % L1_PART_UMON_SETS == 0,
+            "L1_PART_UMON_SETS must divide the %u L1 sets\n", num_sets);
+    umon_set_stride = num_sets / L1_PART_UMON_SETS;
+  }
   proc_infos = calloc(NUM_CORES, sizeof(Proc_Info));
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     Proc_Info* proc_info = &proc_infos[proc_id];
-    char buf[MAX_STR_LENGTH + 1];
-    sprintf(buf, "SHADOW L1[%d]", proc_id);
-    init_cache(&proc_info->shadow_cache, buf, L1_SIZE, L1_ASSOC, L1_LINE_SIZE, sizeof(Shadow_Cache_Data),
-               REPL_TRUE_LRU);
+    if (L1_PART_UMON_SETS) {
+      proc_info->umon.tags = calloc(L1_PART_UMON_SETS * L1_ASSOC, sizeof(Addr));
+      proc_info->umon.hits = calloc(L1_ASSOC, sizeof(Counter));
+    } else {
+      char buf[MAX_STR_LENGTH + 1];
+      sprintf(buf, "SHADOW L1[%d]", proc_id);
+      init_cache(&proc_info->shadow_cache, buf, L1_SIZE, L1_ASSOC, L1_LINE_SIZE, sizeof(Shadow_Cache_Data),
+                 REPL_TRUE_LRU);
+    }
     proc_info->miss_rates = calloc(L1_ASSOC, sizeof(double));
+    proc_info->cost = calloc(L1_ASSOC + 1, sizeof(double));
   }
 
   l1_part_trigger = trigger_create("L1 PART TRIGGER", L1_PART_TRIGGER, TRIGGER_REPEAT);
@@ -415,6 +449,9 @@ void cache_part_init(void) {
     case CACHE_PART_SEARCH_BRUTE_FORCE:
       search_func = &search_bruteforce;
       break;
+    case CACHE_PART_SEARCH_OPT2:
+      search_func = NULL;
+      break;
     default:
       FATAL_ERROR(0, "Unknown search algorithm %s\n", Cache_Part_Search_str(L1_PART_METRIC));
       break;
@@ -427,9 +464,13 @@ void cache_part_init(void) {
     set_partition_allocate(&mem->uncores[0].l1->cache, proc_id, current_partition[proc_id]);
     GET_STAT_EVENT(proc_id, NORESET_L1_PARTITION) = current_partition[proc_id];
   }
+  set_way_masks(current_partition);
   new_partition = calloc(NUM_CORES, sizeof(uns));
   temp_partition = calloc(NUM_CORES, sizeof(uns));
   tie_breaker_proc_id = 0;
+
+  if (L1_PART_SEARCH == CACHE_PART_SEARCH_OPT2)
+    init_opt2_partitions();
 }
 
 /**
@@ -449,6 +490,11 @@ void cache_part_l1_access(Mem_Req* req) {
     return;
   if (!in_shadow_cache(req->addr))
     return;
+  if (L1_PART_UMON_SETS) {
+    umon_access(req->proc_id, req->addr,
+                L1_PART_USE_STALLING ? mem_req_type_is_stalling(req->type) : mem_req_type_is_demand(req->type));
+    return;
+  }
 
   Proc_Info* proc_info = &proc_infos[req->proc_id];
   Addr dummy_line_addr;
@@ -495,6 +541,11 @@ void cache_part_l1_access(Mem_Req* req) {
 /* cache_part_l1_warmup: */
 
 void cache_part_l1_warmup(uns proc_id, Addr addr) {
+  if (L1_PART_UMON_SETS) {
+    if (in_shadow_cache(addr))
+      umon_access(proc_id, addr, FALSE);
+    return;
+  }
   Proc_Info* proc_info = &proc_infos[proc_id];
   Addr dummy_line_addr;
   L1_Data* data = (L1_Data*)cache_access(&proc_info->shadow_cache, addr, &dummy_line_addr, TRUE);
@@ -525,7 +576,7 @@ void cache_part_update(void) {
     return;
 
   DEBUG(0, "Cache partition triggered\n");
-  if (trigger_on(l1_part_start)) {
+  if (trigger_on(l1_part_start) && search_func) {
     measure_miss_curves();
     set_partition();
   }
@@ -542,24 +593,79 @@ void cache_part_update(void) {
 
 Flag in_shadow_cache(Addr addr) {
   Addr dummy_addr;
+  if (L1_PART_UMON_SETS) {
+    uns set = ext_cache_index(&mem->uncores[0].l1->cache, addr, &dummy_addr, &dummy_addr);
+    return set % umon_set_stride == 0;
+  }
   uns set = ext_cache_index(&proc_infos[0].shadow_cache, addr, &dummy_addr, &dummy_addr);
   return set % L1_SHADOW_TAGS_MODULO == 0;
 }
 
+/**************************************************************************************/
+/* umon_access: move the line to the MRU position of its sampled set, counting the hit
+   position if count is set */
+
+void umon_access(uns proc_id, Addr addr, Flag count) {
+  Umon* umon = &proc_infos[proc_id].umon;
+  Addr dummy_addr;
+  uns set = ext_cache_index(&mem->uncores[0].l1->cache, addr, &dummy_addr, &dummy_addr) / umon_set_stride;
+  Addr* stack = &umon->tags[set * L1_ASSOC];
+  Addr tag = (addr >> LOG2(L1_LINE_SIZE)) + 1;
+
+  uns pos;
+  for (pos = 0; pos < L1_ASSOC - 1; pos++) {
+    if (stack[pos] == tag)
+      break;
+  }
+  Flag hit = stack[pos] == tag;
+  memmove(&stack[1], &stack[0], pos * sizeof(Addr));
+  stack[0] = tag;
+
+  if (!count)
+    return;
+  umon->accesses++;
+  STAT_EVENT(proc_id, L1_UMON_ACCESS);
+  if (hit) {
+    umon->hits[pos]++;
+    STAT_EVENT(proc_id, L1_UMON_HIT);
+  }
+}
+
 /**************************************************************************************/
 /* Measure miss curves from monitored statistics */
 
 void measure_miss_curves(void) {
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     Proc_Info* proc_info = &proc_infos[proc_id];
+    if (L1_PART_UMON_SETS) {
+      // the counters are halved after each measurement, so older intervals fade out
+      Umon* umon = &proc_info->umon;
+      Counter misses = umon->accesses;
+      for (uns ii = 0; ii < L1_ASSOC; ii++) {
+        misses -= umon->hits[ii];
+        proc_info->miss_rates[ii] = umon->accesses ? (double)misses / (double)umon->accesses : 0.0;
+        umon->hits[ii] /= 2;
+      }
+      proc_info->accesses = umon->accesses;
+      umon->accesses /= 2;
+      continue;
+    }
     uns access_stat = L1_PART_USE_STALLING ? L1_SHADOW_ACCESS_STALLING : L1_SHADOW_ACCESS_DEMAND;
     uns pos0_hit_stat = L1_PART_USE_STALLING ? L1_SHADOW_STALLING_HIT_POS0 : L1_SHADOW_DEMAND_HIT_POS0;
     Counter shadow_accesses = stat_mon_get_count(stat_mon, proc_id, access_stat);
     Counter shadow_misses_sum = shadow_accesses;
-    for (uns ii = 0; ii < L1_ASSOC - 1; ii++) {
+    for (uns ii = 0; ii < L1_ASSOC; ii++) {
       Counter way_hits = stat_mon_get_count(stat_mon, proc_id, pos0_hit_stat + ii);
       shadow_misses_sum -= way_hits;
-      proc_info->miss_rates[ii] = (double)shadow_misses_sum / (double)shadow_accesses;
+      proc_info->miss_rates[ii] = shadow_accesses ? (double)shadow_misses_sum / (double)shadow_accesses : 0.0;
+    }
+    proc_info->accesses = shadow_accesses;
+  }
+
+  // every metric is a sum of per-core terms, so the searches only look them up
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    for (uns ways = 1; ways <= L1_ASSOC; ways++) {
+      proc_infos[proc_id].cost[ways] = metric_func(proc_id, ways);
     }
   }
 }
@@ -576,19 +682,16 @@ double get_best_marginal_utility(uns* partition, uns proc_id, uns balance, uns*
   uns old_ways = partition[proc_id];
   uns max_ways = old_ways + balance;
   ASSERT(0, max_ways <= L1_ASSOC);
-  double cur_metric = metric_func(partition);
+  double* cost = proc_infos[proc_id].cost;
   double best_mu = 0.0;
   uns best_ways = old_ways;
   for (uns ways = old_ways + 1; ways <= max_ways; ways++) {
-    partition[proc_id] = ways;
-    double new_metric = metric_func(partition);
-    double mu = (new_metric - cur_metric) / (double)(ways - old_ways);
+    double mu = (cost[ways] - cost[old_ways]) / (double)(ways - old_ways);
     if (mu < best_mu) {
       best_mu = mu;
       best_ways = ways;
     }
   }
-  partition[proc_id] = old_ways;
   *extra_ways = best_ways - old_ways;
   return best_mu;
 }
@@ -616,7 +719,7 @@ void search_bruteforce(void) {
     partition[NUM_CORES - 1] += L1_ASSOC - sum;
 
     /* check the metric for the partition */
-    double metric = metric_func(partition);
+    double metric = get_metric(partition);
     if (ENABLE_GLOBAL_DEBUG_PRINT && DEBUG_RANGE_COND(0)) {
       char buf[MAX_STR_LENGTH + 1];
       char* ptr = buf;
@@ -632,23 +735,78 @@ void search_bruteforce(void) {
       memcpy(best_partition, partition, NUM_CORES * sizeof(uns));
     }
 
-    /* generate next partition */
-    uns proc_id;
-    for (proc_id = NUM_CORES - 1; proc_id > 0; proc_id--) {
-      if (partition[proc_id] != 1)
-        break;
-    }
-    if (proc_id == 0) {
-      done = TRUE;
-    } else {
-      partition[proc_id] = 1;
-      partition[proc_id - 1]++;
-    }
+    done = !next_partition(partition);
   }
   memcpy(partition, best_partition, NUM_CORES * sizeof(uns));
   ASSERT(0, best_metric != 1.0e99);
 }
 
+/**************************************************************************************/
+/* Step to the next partition of the brute-force order; the caller assigns the ways left
+   over to the last core. FALSE when there is none. */
+
+Flag next_partition(uns* partition) {
+  uns proc_id;
+  for (proc_id = NUM_CORES - 1; proc_id > 0; proc_id--) {
+    if (partition[proc_id] != 1)
+      break;
+  }
+  if (proc_id == 0)
+    return FALSE;
+  partition[proc_id] = 1;
+  partition[proc_id - 1]++;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* Enumerate every partition as an optimizer2 config and start exploring them */
+
+void init_opt2_partitions(void) {
+  uns num_configs = 0, capacity = 16;
+  opt2_partitions = malloc(capacity * NUM_CORES * sizeof(uns));
+  uns* partition = temp_partition;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    partition[proc_id] = 1;
+  do {
+    uns sum = 0;
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      sum += partition[proc_id];
+    partition[NUM_CORES - 1] += L1_ASSOC - sum;
+    if (num_configs == capacity) {
+      capacity *= 2;
+      opt2_partitions = realloc(opt2_partitions, capacity * NUM_CORES * sizeof(uns));
+    }
+    uns* config = &opt2_partitions[num_configs * NUM_CORES];
+    memcpy(config, partition, NUM_CORES * sizeof(uns));
+    // keep the even split that cache_part_init set up as config 0
+    if (!memcmp(config, current_partition, NUM_CORES * sizeof(uns))) {
+      memcpy(config, opt2_partitions, NUM_CORES * sizeof(uns));
+      memcpy(opt2_partitions, current_partition, NUM_CORES * sizeof(uns));
+    }
+    num_configs++;
+  } while (next_partition(partition));
+
+  static Opt2_Client opt2_client = {"L1 partition", 0, &opt2_set_partition, NULL, NULL, NULL};
+  opt2_client.num_configs = num_configs;
+  opt2_client.start = L1_PART_START;
+  opt2_client.period = L1_PART_TRIGGER;
+  opt2_client_init(&opt2_client);
+}
+
+/**************************************************************************************/
+/* Enforce one of the enumerated partitions (in a freshly forked optimizer2 slave) */
+
+void opt2_set_partition(int config) {
+  memcpy(new_partition, &opt2_partitions[config * NUM_CORES], NUM_CORES * sizeof(uns));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    set_partition_allocate(&mem->uncores[0].l1->cache, proc_id, new_partition[proc_id]);
+    current_partition[proc_id] = new_partition[proc_id];
+    GET_STAT_EVENT(proc_id, NORESET_L1_PARTITION) = new_partition[proc_id];
+  }
+  set_way_masks(current_partition);
+  STAT_EVENT_ALL(L1_PARTITION_INTERVALS);
+}
+
 /**************************************************************************************/
 /* Use lookahead method to estimate best partition */
 
@@ -706,6 +864,7 @@ void set_partition(void) {
     current_partition[proc_id] = new_partition[proc_id];
     GET_STAT_EVENT(proc_id, NORESET_L1_PARTITION) = new_partition[proc_id];
   }
+  set_way_masks(current_partition);
   STAT_EVENT_ALL(L1_PARTITION_INTERVALS);
 }
 
@@ -726,79 +885,97 @@ void debug_cache_part(uns* old_partition, uns* new_partition) {
     }
     DPRINTF("\n");
   }
-  DPRINTF("New partition {%s}, metric %.4f -> %.4f\n", buf, metric_func(old_partition), metric_func(new_partition));
+  DPRINTF("New partition {%s}, metric %.4f -> %.4f\n", buf, get_metric(old_partition), get_metric(new_partition));
 }
 
 /**************************************************************************************/
-/* get global miss rate */
+/* With L1_PART_WAY_MASK, each core fills only its own contiguous range of ways */
 
-double get_global_miss_rate(uns* partition) {
-  double sum = 0.0;
+void set_way_masks(uns* partition) {
+  if (!L1_PART_WAY_MASK)
+    return;
+  uns first_way = 0;
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    Proc_Info* proc_info = &proc_infos[proc_id];
-    Counter accesses = stat_mon_get_count(stat_mon, proc_id,
-                                          L1_PART_USE_STALLING ? L1_SHADOW_ACCESS_STALLING : L1_SHADOW_ACCESS_DEMAND);
-    sum += proc_info->miss_rates[partition[proc_id]] * (double)accesses;
+    uns64 mask = N_BIT_MASK(partition[proc_id]) << first_way;
+    set_partition_way_mask(&mem->uncores[0].l1->cache, proc_id, mask);
+    first_way += partition[proc_id];
   }
-  return sum;
+  ASSERT(0, first_way <= L1_ASSOC);
 }
 
 /**************************************************************************************/
-/* get miss rate sum */
+/* miss rate of a core with the given number of ways */
 
-double get_miss_rate_sum(uns* partition) {
-  double sum = 0.0;
-  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    Proc_Info* proc_info = &proc_infos[proc_id];
-    sum += proc_info->miss_rates[partition[proc_id]];
-  }
-  return sum;
+double get_miss_rate(uns proc_id, uns ways) {
+  return proc_infos[proc_id].miss_rates[ways - 1];
 }
 
 /**************************************************************************************/
-/* get negative gmean of core performance (negative because we minimize the
- * metric) */
+/* metric of a partition (lower is better) */
 
-double get_gmean_perf(uns* partition) {
-  double product = 1.0;
+double get_metric(uns* partition) {
+  double sum = 0.0;
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    /* Assuming constant stall time per miss and constant compute time per
-       access:
+    sum += proc_infos[proc_id].cost[partition[proc_id]];
+  }
+  // the gmean terms are -log of each core's performance
+  return L1_PART_METRIC == CACHE_PART_METRIC_GMEAN_PERF ? -exp(-sum) : sum;
+}
 
-          stall time    misses      compute time       time
-          ---------- x --------  +  ------------  =  --------
-            misses     accesses       accesses       accesses
+/**************************************************************************************/
+/* get a core's term of the global miss rate: its misses */
 
-          stall time   miss rate    compute time       time
-           per miss                   per miss      per access
+double get_global_miss_rate(uns proc_id, uns ways) {
+  return get_miss_rate(proc_id, ways) * proc_infos[proc_id].accesses;
+}
 
-           CONSTANT    VARIABLE       CONSTANT       VARIABLE
+/**************************************************************************************/
+/* get a core's term of the miss rate sum */
 
-       From this model, we can derive that normalized performance
-       given a new vs old miss rate is the *reciprocal* of:
+double get_miss_rate_sum(uns proc_id, uns ways) {
+  return get_miss_rate(proc_id, ways);
+}
 
-               / new miss rate     \
-           1 + | ------------- - 1 | x stall frac
-               \ old miss rate     /
-    */
-    Proc_Info* proc_info = &proc_infos[proc_id];
-    double stall_frac = (double)stat_mon_get_count(stat_mon, proc_id, RET_BLOCKED_L1_MISS) /
-                        (double)stat_mon_get_count(stat_mon, proc_id, NODE_CYCLE);
-    double miss_rate0 = proc_info->miss_rates[current_partition[proc_id]];
-    double miss_rate = proc_info->miss_rates[partition[proc_id]];
-    double pred_perf;
-    if (miss_rate0 == 0.0 || stall_frac == 0.0) {
-      // in case of zero misses or stall time make the smallest
-      // partition most attractive
-      if (partition[proc_id] == 1) {
-        pred_perf = 1.0;
-      } else {
-        pred_perf = 0.0;
-      }
+/**************************************************************************************/
+/* get a core's term of the negative gmean of core performance (negative
+ * because we minimize the metric): -log of its predicted performance */
+
+double get_gmean_perf(uns proc_id, uns ways) {
+  /* Assuming constant stall time per miss and constant compute time per
+     access:
+
+        stall time    misses      compute time       time
+        ---------- x --------  +  ------------  =  --------
+          misses     accesses       accesses       accesses
+
+        stall time   miss rate    compute time       time
+         per miss                   per miss      per access
+
+         CONSTANT    VARIABLE       CONSTANT       VARIABLE
+
+     From this model, we can derive that normalized performance
+     given a new vs old miss rate is the *reciprocal* of:
+
+             / new miss rate     \
+         1 + | ------------- - 1 | x stall frac
+             \ old miss rate     /
+  */
+  double stall_frac = (double)stat_mon_get_count(stat_mon, proc_id, RET_BLOCKED_L1_MISS) /
+                      (double)stat_mon_get_count(stat_mon, proc_id, NODE_CYCLE);
+  double miss_rate0 = get_miss_rate(proc_id, current_partition[proc_id]);
+  double miss_rate = get_miss_rate(proc_id, ways);
+  double pred_perf;
+  if (miss_rate0 == 0.0 || stall_frac == 0.0) {
+    // in case of zero misses or stall time make the smallest
+    // partition most attractive
+    if (ways == 1) {
+      pred_perf = 1.0;
     } else {
-      pred_perf = 1.0 / (1.0 + (miss_rate / miss_rate0 - 1) * stall_frac);
+      pred_perf = 0.0;
     }
-    product *= pred_perf;
+  } else {
+    pred_perf = 1.0 / (1.0 + (miss_rate / miss_rate0 - 1) * stall_frac);
   }
-  return -product;
+  // -log, so that the metric of a partition is a sum; a zero makes the partition unusable
+  return pred_perf > 0.0 ? -log(pred_perf) : 1.0e30;
 }
@@ -40,7 +40,8 @@ struct Mem_Req_struct;
 
 DECLARE_ENUM(Cache_Part_Metric, CACHE_PART_METRIC_LIST, CACHE_PART_METRIC_);
 
-#define CACHE_PART_SEARCH_LIST(elem) elem(LOOKAHEAD) elem(BRUTE_FORCE)
+/* OPT2 forks a slave per partition at each L1_PART_TRIGGER and keeps the fastest (optimizer2) */
+#define CACHE_PART_SEARCH_LIST(elem) elem(LOOKAHEAD) elem(BRUTE_FORCE) elem(OPT2)
 
 DECLARE_ENUM(Cache_Part_Search, CACHE_PART_SEARCH_LIST, CACHE_PART_SEARCH_);
 
@@ -0,0 +1,224 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : memory/coherence.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : MESI/MOESI directory at the shared L1 for cores running threads of one
+ *                program
+ ***************************************************************************************/
+
+/* The memory system tags every address with the proc_id of its core, so the cores never
+   share a line. With a coherence protocol, the directory treats the cores as threads of
+   one program instead: it tracks lines by their address without the proc_id bits, and
+   the copy of a line held by another core is the same address with that core's proc_id.
+
+   Each line has a bit-vector of the cores that may hold it in their dcache or MLC and the
+   core that owns it in E, O or M, found in O(1) through a hash table. A request reaching
+   the L1 checks the directory: a store invalidates every other copy, and a read of a line
+   owned by another core gets it forwarded from the owner (which drops to S, or to O under
+   MOESI if the line is dirty). The request waits for the round trip to those cores, over
+   the NoC if there is one. A store that hits a private cache upgrades the line the same
+   way without waiting for the acks. Private caches evict silently, so the sharers are a
+   superset of the cores that hold the line. */
+
+#include "coherence.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+
+#include "core.param.h"
+#include "memory.param.h"
+
+#include "libs/hash_lib.h"
+#include "cmp_model.h"
+#include "mem_req.h"
+#include "memory.h"
+#include "noc.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_MEMORY, ##args)
+
+/**************************************************************************************/
+/* Types */
+
+typedef enum Coh_State_enum {
+  COH_I,
+  COH_S,
+  COH_E,
+  COH_O,
+  COH_M,
+} Coh_State;
+
+typedef struct Coh_Dir_Entry_struct {
+  uns64 sharers; /* one bit per core that may hold the line */
+  uns8 owner;    /* core holding the line in E, O or M */
+  uns8 state;    /* Coh_State */
+} Coh_Dir_Entry;
+
+/**************************************************************************************/
+/* Global variables */
+
+DEFINE_ENUM(Coherence_Protocol, COHERENCE_PROTOCOL_LIST);
+
+static Hash_Table coh_dir;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static inline int64 coh_line_key(Addr addr);
+static Counter coh_round_trip(uns proc_id, Addr addr, uns64 cores, uns reply_flits, Counter cycle);
+static void coh_invalidate_copies(uns proc_id, Addr addr, uns64 cores);
+
+/**************************************************************************************/
+/* init_coherence: */
+
+void init_coherence(void) {
+  if (COHERENCE_PROTOCOL == COHERENCE_PROTOCOL_NONE)
+    return;
+  ASSERTM(0, COHERENCE_PROTOCOL < COHERENCE_PROTOCOL_NUM_ELEMS, "Unknown COHERENCE_PROTOCOL %u\n",
+          COHERENCE_PROTOCOL);
+  ASSERTM(0, NUM_CORES <= 64, "The directory tracks up to 64 cores\n");
+  ASSERTM(0, !PRIVATE_L1, "The directory needs a shared L1\n");
+  init_hash_table(&coh_dir, "Coherence directory", 1 << 16, sizeof(Coh_Dir_Entry));
+}
+
+/**************************************************************************************/
+/* coh_line_key: */
+
+static inline int64 coh_line_key(Addr addr) {
+  return convert_to_cmp_addr(0, addr) >> LOG2(L1_LINE_SIZE);
+}
+
+/**************************************************************************************/
+/* coh_round_trip: cycles for the directory to reach cores and hear back from all of them
+   (an ack, or the line for a forward) */
+
+static Counter coh_round_trip(uns proc_id, Addr addr, uns64 cores, uns reply_flits, Counter cycle) {
+  if (NOC_TOPOLOGY == NOC_TOPOLOGY_NONE)
+    return 2 * COHERENCE_MSG_CYCLES;
+
+  uns dir_node = noc_l1_node(mem_l1_slice(addr));
+  Counter done = cycle;
+  for (uns64 left = cores; left; left &= left - 1) {
+    uns core_node = noc_core_node(__builtin_ctzll(left));
+    Counter at_core = noc_send(proc_id, dir_node, core_node, noc_ctrl_flits(), cycle);
+    done = MAX2(done, noc_send(proc_id, core_node, dir_node, reply_flits, at_core));
+  }
+  return done - cycle;
+}
+
+/**************************************************************************************/
+/* coh_invalidate_copies: */
+
+static void coh_invalidate_copies(uns proc_id, Addr addr, uns64 cores) {
+  for (uns64 left = cores; left; left &= left - 1) {
+    uns core = __builtin_ctzll(left);
+    Addr core_addr = convert_to_cmp_addr(core, addr);
+    Addr line_addr;
+    cache_invalidate(&cmp_model.dcache_stage[core].dcache, core_addr, &line_addr);
+    if (MLC_PRESENT)
+      cache_invalidate(&mem->uncores[core].mlc->cache, core_addr, &line_addr);
+    STAT_EVENT(proc_id, COH_INVALIDATIONS);
+    DEBUG(proc_id, "Coherence invalidates line 0x%s of core %u\n", hexstr64s(line_addr), core);
+  }
+}
+
+/**************************************************************************************/
+/* coh_l1_access: */
+
+Counter coh_l1_access(Mem_Req* req, Counter cycle) {
+  if (req->type == MRT_WB || req->type == MRT_WB_NODIRTY)
+    return 0;
+
+  Flag new_entry;
+  Coh_Dir_Entry* entry = (Coh_Dir_Entry*)hash_table_access_create(&coh_dir, coh_line_key(req->addr), &new_entry);
+  if (new_entry) {
+    entry->sharers = 0;
+    entry->state = COH_I;
+  }
+  uns64 self = 1ULL << req->proc_id;
+  uns64 others = entry->sharers & ~self;
+  Flag dirty = entry->state == COH_M || entry->state == COH_O;
+  Counter cycles = 0;
+
+  if (req->type == MRT_DSTORE) {
+    // read for ownership: a dirty owner sends the line along with its ack
+    if (others) {
+      cycles = coh_round_trip(req->proc_id, req->addr, others, dirty ? noc_data_flits() : noc_ctrl_flits(), cycle);
+      coh_invalidate_copies(req->proc_id, req->addr, others);
+      if (dirty && entry->owner != req->proc_id)
+        STAT_EVENT(req->proc_id, COH_FORWARDS);
+    }
+    entry->sharers = self;
+    entry->owner = req->proc_id;
+    entry->state = COH_M;
+  } else if (others && entry->state >= COH_E && entry->owner != req->proc_id) {
+    // the owner forwards the line; under MESI a dirty owner also writes it back
+    cycles = coh_round_trip(req->proc_id, req->addr, 1ULL << entry->owner, noc_data_flits(), cycle);
+    STAT_EVENT(req->proc_id, COH_FORWARDS);
+    if (dirty && COHERENCE_PROTOCOL == COHERENCE_PROTOCOL_MESI)
+      STAT_EVENT(req->proc_id, COH_WRITEBACKS);
+    entry->state = dirty && COHERENCE_PROTOCOL == COHERENCE_PROTOCOL_MOESI ? COH_O : COH_S;
+    entry->sharers |= self;
+  } else if (!others) {
+    if (entry->state == COH_I || !(entry->sharers & self)) {
+      entry->owner = req->proc_id;
+      entry->state = COH_E;
+    }
+    entry->sharers = self;
+  } else {
+    entry->sharers |= self;
+  }
+
+  INC_STAT_EVENT(req->proc_id, COH_WAIT_CYCLES, cycles);
+  return cycles;
+}
+
+/**************************************************************************************/
+/* coh_store_hit: */
+
+void coh_store_hit(uns proc_id, Addr addr) {
+  Coh_Dir_Entry* entry = (Coh_Dir_Entry*)hash_table_access(&coh_dir, coh_line_key(addr));
+  if (!entry)  // filled before the directory saw it (warmup)
+    return;
+  uns64 self = 1ULL << proc_id;
+  uns64 others = entry->sharers & ~self;
+  if (others) {
+    // the store retires through the store buffer, so only the traffic is modeled
+    STAT_EVENT(proc_id, COH_UPGRADES);
+    coh_round_trip(proc_id, addr, others, noc_ctrl_flits(), cycle_count);
+    coh_invalidate_copies(proc_id, addr, others);
+  }
+  entry->sharers = self;
+  entry->owner = proc_id;
+  entry->state = COH_M;
+}
@@ -0,0 +1,62 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : memory/coherence.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : MESI/MOESI directory at the shared L1 for cores running threads of one
+ *                program
+ ***************************************************************************************/
+
+#ifndef __COHERENCE_H__
+#define __COHERENCE_H__
+
+#include "globals/enum.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Forward Declarations */
+
+struct Mem_Req_struct;
+
+/**************************************************************************************/
+/* Enums */
+
+#define COHERENCE_PROTOCOL_LIST(elem) elem(NONE) elem(MESI) elem(MOESI)
+
+DECLARE_ENUM(Coherence_Protocol, COHERENCE_PROTOCOL_LIST, COHERENCE_PROTOCOL_);
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Initialize (after the NoC) */
+void init_coherence(void);
+
+/* Report a request starting its L1 access at cycle; returns the cycles it waits for
+   invalidations or a forward from the owner */
+Counter coh_l1_access(struct Mem_Req_struct* req, Counter cycle);
+
+/* Report an on-path store hitting a private cache of proc_id */
+void coh_store_hit(uns proc_id, Addr addr);
+
+#endif /* #ifndef __COHERENCE_H__ */
@@ -31,7 +31,7 @@
 
 #include "globals/enum.h"
 
-#include "libs/list_lib.h"
+#include "libs/ring_lib.h"
 
 /**************************************************************************************/
 /* Forward Declarations */
@@ -125,6 +125,7 @@ struct Mem_Req_struct {
   uns mem_flat_bank;                   /* flattened bank index across channels */
   Counter start_cycle;                 /* cycle that the request is ready to process */
   Counter rdy_cycle;                   /* cycle when the current operation is complete */
+  Counter noc_mem_cycles;              /* NoC latency to the memory controller, added to the fill */
   uns reserved_entry_count;            /* how many entries are reserved for this request */
   Counter first_stalling_cycle;        /* cycle this request became a type considered
                                           stalling */
@@ -135,8 +136,8 @@ struct Mem_Req_struct {
                                           req - may not be in the machine any more */
   Counter oldest_op_addr;              /* PC of the oldest op that is waiting for this req -
                                           may not be in the machine any more */
-  List op_ptrs;
-  List op_uniques;
+  Ring op_ptrs;
+  Ring op_uniques;
   uns op_count;                              /* number of ops that are waiting for the miss */
   uns req_count;                             /* number of requests coalesced into this one */
   Flag (*done_func)(struct Mem_Req_struct*); /* pointer to function to call when
@@ -41,6 +41,7 @@
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
 #include "debug/memview.h"
+#include "libs/table_alloc.h"
 
 #include "core.param.h"
 #include "memory.param.h"
@@ -59,7 +60,11 @@
 #include "cache_part.h"
 #include "cmp_model.h"
 #include "icache_stage.h"
+#include "mem_replay_model.h"
+#include "coherence.h"
+#include "map.h"
 #include "mem_req.h"
+#include "noc.h"
 #include "op.h"
 #include "statistics.h"
 // #include "dram.h"
@@ -79,6 +84,13 @@
 
 #define MLC(proc_id) (mem->uncores[proc_id].mlc)
 #define L1(proc_id) (mem->uncores[proc_id].l1)
+/* with L1_SLICES > 1, the shared L1 is split into slices by the lowest line address bits */
+#define L1_SLICE(addr) ((addr) >> LOG2(L1_LINE_SIZE) & N_BIT_MASK(LOG2(L1_SLICES)))
+#define L1_OF(proc_id, addr) (L1_SLICES > 1 ? mem->l1_slices[L1_SLICE(addr)] : L1(proc_id))
+#define L1_QUEUE(addr) (&mem->l1_queues[L1_SLICE(addr)])
+/* L1_META_WAYS of every L1 set hold prefetcher metadata; the data array keeps the rest */
+#define L1_DATA_ASSOC (L1_ASSOC - L1_META_WAYS)
+#define L1_DATA_SIZE(size) ((size) / L1_ASSOC * L1_DATA_ASSOC)
 
 /**************************************************************************************/
 /* Global Variables */
@@ -96,9 +108,14 @@ static Counter* core_fill_seq_num;
 static uns mem_req_demand_entries = 0;
 static uns mem_req_pref_entries = 0;
 static uns mem_req_wb_entries = 0;
+static Stat_Integrator mem_req_demand_integrator;
+static Stat_Integrator mem_req_pref_integrator;
+static Stat_Integrator mem_req_wb_integrator;
+/* set while the uncore prefetchers send their requests, which are not recorded */
+static Flag mem_in_pref_update = FALSE;
 
 Memory* mem = NULL;
-extern Icache_Stage* ic;
+extern CORE_LOCAL Icache_Stage* ic;
 extern Counter last_recover_cycle;
 
 Counter Mem_Req_Priority[MRT_NUM_ELEMS];
@@ -110,12 +127,17 @@ Counter Mem_Req_Priority_Offset[MRT_NUM_ELEMS];
 static void init_mem_req_type_priorities(void);
 static void init_uncores(void);
 static void update_memory_queues(void);
-static void update_on_chip_memory_stats(void);
+static int l1_queue_entry_count(void);
+static uns l1_slice_hops(uns proc_id, Addr addr);
+static Counter l1_noc_round_trip(Mem_Req* req, uns core_node, uns l1_node, Flag need_wp);
+static void mem_add_outstanding_l1_misses(uns proc_id, int delta);
 
 static void mark_ops_as_l1_miss(Mem_Req* req);
-static void mark_l1_miss_deps(Op* op);
-static void unmark_l1_miss_deps(Op* op);
 static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta);
+static Flag new_mem_req_impl(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay, Op* op,
+                             Flag done_func(Mem_Req*), Counter unique_num, Pref_Req_Info* pref_info);
+static Flag new_mem_dc_wb_req_impl(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay, Op* op,
+                                   Flag done_func(Mem_Req*), Counter unique_num, Flag used_onpath);
 
 int mem_compare_priority(const void* a, const void* b);
 void mem_start_mlc_access(Mem_Req* req);
@@ -169,6 +191,20 @@ static void mem_init_new_req(Mem_Req* new_req, Mem_Req_Type type, Mem_Queue_Type
                              Counter new_priority);
 
 static inline void init_mem_queue(Mem_Queue* queue, char* name, uns size, Mem_Queue_Type type);
+static inline void mem_queue_index_clear(Mem_Queue* queue);
+static inline void mem_queue_index_insert(Mem_Queue* queue, Mem_Queue_Entry* entry);
+static inline void mem_queue_index_remove(Mem_Queue* queue, Mem_Queue_Entry* entry);
+static inline int mem_queue_index_lookup(Mem_Queue* queue, Addr addr);
+static inline void mem_queue_prefetch_insert(Mem_Queue* queue, Mem_Queue_Entry* entry);
+static int mem_queue_prefetch_victim(Mem_Queue* queue, uns mem_bank);
+static inline void mem_queue_remove_tail(Mem_Queue* queue, int count);
+static void init_mem_store_index(void);
+static void mem_store_index_clear(void);
+static inline void mem_store_index_sync(Mem_Req* req);
+static inline void mem_queue_entry_set_priority(Mem_Queue_Entry* entry, Counter priority);
+static inline void mem_queue_sort(Mem_Queue* queue);
+static inline Flag mem_queue_walk_begin(Mem_Queue* queue);
+static inline void mem_queue_walk_note(Mem_Queue* queue, Mem_Req* req);
 
 static void print_mem_queue_generic(Mem_Queue* queue);
 
@@ -210,6 +246,276 @@ static inline void init_mem_queue(Mem_Queue* queue, char* name, uns size, Mem_Qu
   queue->reserved_entry_count = 0;
   queue->type = type;
   strcpy(queue->name, name);
+
+  uns num_slots = 1;
+  while (num_slots < 2 * (size + 1))
+    num_slots <<= 1;
+  queue->index.slots = (Mem_Queue_Index_Slot*)malloc(sizeof(Mem_Queue_Index_Slot) * num_slots);
+  queue->index.mask = num_slots - 1;
+  queue->index.sizes = (uns*)malloc(sizeof(uns) * (size + 1));
+  queue->index.size_counts = (uns*)malloc(sizeof(uns) * (size + 1));
+  queue->index.candidates = (int*)malloc(sizeof(int) * (size + 1));
+  queue->entry_seqs = (Counter*)malloc(sizeof(Counter) * mem->total_mem_req_buffers);
+  queue->prefetch_capacity = 2 * (size + 1);
+  queue->prefetches = (Mem_Queue_Prefetch*)malloc(sizeof(Mem_Queue_Prefetch) * queue->prefetch_capacity);
+  mem_queue_index_clear(queue);
+
+  queue->sorted_count = 0;
+  queue->next_seq = 0;
+  queue->scratch = (Mem_Queue_Entry*)malloc(sizeof(Mem_Queue_Entry) * (size + 1));
+}
+
+/**************************************************************************************/
+/* mem_queue_index_hash: */
+
+static inline uns mem_queue_index_hash(Mem_Queue_Index* index, Addr line_addr) {
+  uns64 hash = line_addr * 0x9e3779b97f4a7c15ULL;
+  return (uns)(hash ^ (hash >> 32)) & index->mask;
+}
+
+/**************************************************************************************/
+/* mem_queue_index_clear: empty the line index and the prefetch list */
+
+static inline void mem_queue_index_clear(Mem_Queue* queue) {
+  for (uns ii = 0; ii <= queue->index.mask; ii++)
+    queue->index.slots[ii].reqbuf = -1;
+  queue->index.num_sizes = 0;
+
+  for (uns ii = 0; ii < mem->total_mem_req_buffers; ii++)
+    queue->entry_seqs[ii] = MAX_CTR;
+  queue->prefetch_head = 0;
+  queue->prefetch_tail = 0;
+  queue->next_rdy_cycle = 0;
+}
+
+/**************************************************************************************/
+/* mem_queue_index_insert: index a newly added queue entry */
+
+static inline void mem_queue_index_insert(Mem_Queue* queue, Mem_Queue_Entry* entry) {
+  Mem_Queue_Index* index = &queue->index;
+  uns pos = mem_queue_index_hash(index, entry->line_addr);
+  uns ii;
+
+  while (index->slots[pos].reqbuf != -1)
+    pos = (pos + 1) & index->mask;
+  index->slots[pos].line_addr = entry->line_addr;
+  index->slots[pos].line_size = entry->line_size;
+  index->slots[pos].reqbuf = entry->reqbuf;
+
+  for (ii = 0; ii < index->num_sizes; ii++) {
+    if (index->sizes[ii] == entry->line_size)
+      break;
+  }
+  if (ii == index->num_sizes) {
+    index->sizes[ii] = entry->line_size;
+    index->size_counts[ii] = 0;
+    index->num_sizes++;
+  }
+  index->size_counts[ii]++;
+}
+
+/**************************************************************************************/
+/* mem_queue_index_remove: drop a queue entry from the index (backward-shift
+   deletion, so lookups never need tombstones) */
+
+static inline void mem_queue_index_remove(Mem_Queue* queue, Mem_Queue_Entry* entry) {
+  Mem_Queue_Index* index = &queue->index;
+  uns pos = mem_queue_index_hash(index, entry->line_addr);
+  uns ii;
+
+  while (index->slots[pos].reqbuf != entry->reqbuf || index->slots[pos].line_addr != entry->line_addr ||
+         index->slots[pos].line_size != entry->line_size) {
+    ASSERTM(0, index->slots[pos].reqbuf != -1, "%s: reqbuf %d missing from the line index\n", queue->name,
+            entry->reqbuf);
+    pos = (pos + 1) & index->mask;
+  }
+
+  uns hole = pos;
+  for (pos = (hole + 1) & index->mask; index->slots[pos].reqbuf != -1; pos = (pos + 1) & index->mask) {
+    uns home = mem_queue_index_hash(index, index->slots[pos].line_addr);
+    /* move the slot into the hole unless its home lies cyclically in (hole, pos] */
+    if (((pos - home) & index->mask) >= ((pos - hole) & index->mask)) {
+      index->slots[hole] = index->slots[pos];
+      hole = pos;
+    }
+  }
+  index->slots[hole].reqbuf = -1;
+
+  for (ii = 0; ii < index->num_sizes; ii++) {
+    if (index->sizes[ii] == entry->line_size)
+      break;
+  }
+  ASSERT(0, ii < index->num_sizes && index->size_counts[ii] > 0);
+  if (--index->size_counts[ii] == 0) {
+    index->num_sizes--;
+    index->sizes[ii] = index->sizes[index->num_sizes];
+    index->size_counts[ii] = index->size_counts[index->num_sizes];
+  }
+}
+
+/**************************************************************************************/
+/* mem_queue_index_lookup: collect the reqbuf ids of the entries whose line
+   address matches addr (at their own size) into index.candidates */
+
+static inline int mem_queue_index_lookup(Mem_Queue* queue, Addr addr) {
+  Mem_Queue_Index* index = &queue->index;
+  int num_candidates = 0;
+
+  for (uns ii = 0; ii < index->num_sizes; ii++) {
+    uns line_size = index->sizes[ii];
+    Addr line_addr = CACHE_SIZE_ADDR(line_size, addr);
+    uns pos = mem_queue_index_hash(index, line_addr);
+
+    for (; index->slots[pos].reqbuf != -1; pos = (pos + 1) & index->mask) {
+      if (index->slots[pos].line_addr == line_addr && index->slots[pos].line_size == line_size)
+        index->candidates[num_candidates++] = index->slots[pos].reqbuf;
+    }
+  }
+  return num_candidates;
+}
+
+/**************************************************************************************/
+/* mem_queue_prefetch_stale: the listed prefetch is no longer a prefetch
+   entry of the queue (it will not become one again) */
+
+static inline Flag mem_queue_prefetch_stale(Mem_Queue* queue, Mem_Queue_Prefetch* prefetch) {
+  return queue->entry_seqs[prefetch->reqbuf] != prefetch->seq ||
+         !mem_req_type_is_prefetch(mem->req_buffer[prefetch->reqbuf].type);
+}
+
+/**************************************************************************************/
+/* mem_queue_prefetch_before: age order of the prefetch list */
+
+static inline Flag mem_queue_prefetch_before(Mem_Queue_Prefetch* a, Mem_Queue_Prefetch* b) {
+  if (a->start_cycle != b->start_cycle)
+    return a->start_cycle < b->start_cycle;
+  if (a->priority != b->priority)
+    return a->priority < b->priority;
+  return a->seq < b->seq;
+}
+
+/**************************************************************************************/
+/* mem_queue_prefetch_insert: list a prefetch entry of the queue.  New
+   requests are the youngest, so the insertion point is usually the end. */
+
+static inline void mem_queue_prefetch_insert(Mem_Queue* queue, Mem_Queue_Entry* entry) {
+  Mem_Req* req = &mem->req_buffer[entry->reqbuf];
+  Mem_Queue_Prefetch prefetch = {req->start_cycle, entry->priority, entry->seq, entry->reqbuf};
+  int ii;
+
+  if (!KICKOUT_OLDEST_PREFETCH)
+    return;
+
+  if (queue->prefetch_tail == queue->prefetch_capacity) {
+    /* compact: at most entry_count of the listed prefetches are still live */
+    int num = 0;
+    for (ii = queue->prefetch_head; ii < queue->prefetch_tail; ii++) {
+      if (!mem_queue_prefetch_stale(queue, &queue->prefetches[ii]))
+        queue->prefetches[num++] = queue->prefetches[ii];
+    }
+    queue->prefetch_head = 0;
+    queue->prefetch_tail = num;
+    ASSERT(req->proc_id, num < queue->prefetch_capacity);
+  }
+
+  for (ii = queue->prefetch_tail; ii > queue->prefetch_head; ii--) {
+    if (!mem_queue_prefetch_before(&prefetch, &queue->prefetches[ii - 1]))
+      break;
+    queue->prefetches[ii] = queue->prefetches[ii - 1];
+  }
+  queue->prefetches[ii] = prefetch;
+  queue->prefetch_tail++;
+}
+
+/**************************************************************************************/
+/* mem_queue_prefetch_victim: the oldest prefetch of the queue that has not
+   reached memory yet, preferring one of mem_bank with
+   KICKOUT_OLDEST_PREFETCH_WITHIN_BANK; the reqbuf, -1 if none */
+
+static int mem_queue_prefetch_victim(Mem_Queue* queue, uns mem_bank) {
+  int oldest = -1;
+
+  for (int ii = queue->prefetch_head; ii < queue->prefetch_tail; ii++) {
+    Mem_Queue_Prefetch* prefetch = &queue->prefetches[ii];
+    if (mem_queue_prefetch_stale(queue, prefetch)) {
+      if (ii == queue->prefetch_head)
+        queue->prefetch_head++;
+      continue;
+    }
+
+    Mem_Req* req = &mem->req_buffer[prefetch->reqbuf];
+    if (req->state >= MRS_MEM_WAIT)
+      continue;
+    if (!KICKOUT_OLDEST_PREFETCH_WITHIN_BANK || req->mem_flat_bank == mem_bank)
+      return prefetch->reqbuf;
+    if (oldest == -1)
+      oldest = prefetch->reqbuf;
+  }
+  return oldest;
+}
+
+/**************************************************************************************/
+/* mem_queue_remove_tail: queues drop entries by sorting them to the end and
+   shrinking entry_count; this keeps the line index in step */
+
+static inline void mem_queue_remove_tail(Mem_Queue* queue, int count) {
+  ASSERT(0, count >= 0 && count <= queue->entry_count);
+  for (int ii = queue->entry_count - count; ii < queue->entry_count; ii++) {
+    mem_queue_index_remove(queue, &queue->base[ii]);
+    queue->entry_seqs[queue->base[ii].reqbuf] = MAX_CTR;
+    HIST_RECORD(mem->req_buffer[queue->base[ii].reqbuf].proc_id, MEM_QUEUE_DELAY, __builtin_ctz(queue->type),
+                freq_cycle_count(FREQ_DOMAIN_L1) - queue->base[ii].insert_cycle);
+  }
+  queue->entry_count -= count;
+  queue->sorted_count = MIN2(queue->sorted_count, queue->entry_count);
+  mem->event_count += count;
+}
+
+/**************************************************************************************/
+/* mem_queue_entry_set_priority: change the priority of an entry already in a
+   queue; the entry is re-placed by the next mem_queue_sort */
+
+static inline void mem_queue_entry_set_priority(Mem_Queue_Entry* entry, Counter priority) {
+  entry->priority = priority;
+  entry->resort = TRUE;
+}
+
+/**************************************************************************************/
+/* mem_queue_sort: put the queue in mem_compare_priority order.  Only the
+   entries appended or re-prioritized since the last sort can be out of
+   place, so those are pulled out, sorted on their own and merged back into
+   the (still ordered) rest of the queue.  The result is the same as sorting
+   the whole queue. */
+
+static inline void mem_queue_sort(Mem_Queue* queue) {
+  int num_kept = 0;
+  int num_moved = 0;
+
+  for (int ii = 0; ii < queue->entry_count; ii++) {
+    Mem_Queue_Entry* entry = &queue->base[ii];
+    if (ii >= queue->sorted_count || entry->resort) {
+      entry->resort = FALSE;
+      queue->scratch[num_moved++] = *entry;
+    } else if (num_kept != ii) {
+      queue->base[num_kept++] = *entry;
+    } else {
+      num_kept++;
+    }
+  }
+  queue->sorted_count = queue->entry_count;
+  if (num_moved == 0)
+    return;
+
+  qsort(queue->scratch, num_moved, sizeof(Mem_Queue_Entry), mem_compare_priority);
+
+  int kept = num_kept - 1;
+  int moved = num_moved - 1;
+  for (int ii = queue->entry_count - 1; moved >= 0; ii--) {
+    if (kept >= 0 && mem_compare_priority(&queue->base[kept], &queue->scratch[moved]) > 0)
+      queue->base[ii] = queue->base[kept--];
+    else
+      queue->base[ii] = queue->scratch[moved--];
+  }
 }
 
 /**************************************************************************************/
@@ -276,14 +582,13 @@ void init_mem_req_type_priorities() {
 
 void init_memory() {
   int ii;
-  char name[20];
-  uns8 proc_id;
+  uns proc_id;
 
   ASSERT(0, mem);
   ASSERT(0, L1_LINE_SIZE <= L1_INTERLEAVE_FACTOR);
   ASSERT(0, L1_LINE_SIZE <= MLC_INTERLEAVE_FACTOR);
   ASSERT(0, L1_LINE_SIZE <= VA_PAGE_SIZE_BYTES);
-  ASSERT(0, NUM_ADDR_NON_SIGN_EXTEND_BITS <= 58);
+  ASSERT(0, NUM_ADDR_NON_SIGN_EXTEND_BITS <= CMP_ADDR_PROC_ID_SHIFT);
   ASSERT(0, LOG2(VA_PAGE_SIZE_BYTES) <= NUM_ADDR_NON_SIGN_EXTEND_BITS);
   memset(mem, 0, sizeof(Memory));
 
@@ -291,33 +596,41 @@ void init_memory() {
 
   /* Initialize request buffers */
   mem->total_mem_req_buffers = MEM_REQ_BUFFER_ENTRIES * (PRIVATE_MSHR_ON ? NUM_CORES : 1);
-  mem->req_buffer = (Mem_Req*)malloc(sizeof(Mem_Req) * mem->total_mem_req_buffers);
+  mem->req_buffer = (Mem_Req*)table_alloc("mem_req_buffer", sizeof(Mem_Req) * mem->total_mem_req_buffers);
   for (ii = 0; ii < mem->total_mem_req_buffers; ii++) {
     mem->req_buffer[ii].state = MRS_INV;
   }
   mem->num_req_buffers_per_core = calloc(NUM_CORES, sizeof(uns));
-  init_list(&mem->req_buffer_free_list, "REQ BUF FREE LIST", sizeof(int), TRUE);
+  init_ring(&mem->req_buffer_free_list, "REQ BUF FREE LIST", sizeof(int), mem->total_mem_req_buffers);
 
   if (ROUND_ROBIN_TO_L1) {
-    mem->l1_in_buffer_core = (List*)malloc(sizeof(List) * NUM_CORES);
+    mem->l1_in_buffer_core = (Ring*)malloc(sizeof(Ring) * NUM_CORES);
     for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-      init_list(&mem->l1_in_buffer_core[proc_id], "L1 IN BUFFER", sizeof(Mem_Req*), TRUE);
+      init_ring(&mem->l1_in_buffer_core[proc_id], "L1 IN BUFFER", sizeof(Mem_Req*), 16);
     }
   }
 
   for (ii = 0; ii < mem->total_mem_req_buffers; ii++) {
     mem->req_buffer[ii].id = ii;
-    sprintf(name, "%d OPP_L", ii);
-    init_list(&mem->req_buffer[ii].op_ptrs, name, sizeof(Op*), TRUE);
-    sprintf(name, "%d OPU_L", ii);
-    init_list(&mem->req_buffer[ii].op_uniques, name, sizeof(Counter), TRUE);
+    init_ring(&mem->req_buffer[ii].op_ptrs, "OP PTRS", sizeof(Op*), 4);
+    init_ring(&mem->req_buffer[ii].op_uniques, "OP UNIQUES", sizeof(Counter), 4);
   }
+  init_mem_store_index();
 
   /* Initialize l1 and bus access queues which hold id's of request buffers */
   init_mem_queue(&mem->mlc_queue, "MLC_QUEUE", QUEUE_MLC_SIZE == 0 ? mem->total_mem_req_buffers : QUEUE_MLC_SIZE,
                  QUEUE_MLC);
   init_mem_queue(&mem->mlc_fill_queue, "MLC_FILL_QUEUE", mem->total_mem_req_buffers, QUEUE_MLC_FILL);
-  init_mem_queue(&mem->l1_queue, "L1_QUEUE", QUEUE_L1_SIZE == 0 ? mem->total_mem_req_buffers : QUEUE_L1_SIZE, QUEUE_L1);
+  mem->l1_queues = (Mem_Queue*)calloc(L1_SLICES, sizeof(Mem_Queue));
+  for (ii = 0; ii < L1_SLICES; ii++) {
+    char buf[MAX_STR_LENGTH + 1];
+    if (L1_SLICES > 1)
+      sprintf(buf, "L1_QUEUE[%d]", ii);
+    else
+      sprintf(buf, "L1_QUEUE");
+    init_mem_queue(&mem->l1_queues[ii], buf,
+                   QUEUE_L1_SIZE == 0 ? mem->total_mem_req_buffers : MAX2(1, QUEUE_L1_SIZE / L1_SLICES), QUEUE_L1);
+  }
   init_mem_queue(&mem->bus_out_queue, "BUS_OUT_QUEUE",
                  QUEUE_BUS_OUT_SIZE == 0 ? mem->total_mem_req_buffers : QUEUE_BUS_OUT_SIZE, QUEUE_BUS_OUT);
   init_mem_queue(&mem->l1fill_queue, "L1FILL_QUEUE", mem->total_mem_req_buffers, QUEUE_L1FILL);
@@ -351,6 +664,8 @@ void init_memory() {
 
   // init_dram ();
   ramulator_init();
+  init_noc();
+  init_coherence();
 
   reset_memory();
 
@@ -379,7 +694,9 @@ void init_uncores(void) {
   }
 
   /* Initialize LLC */
+  ASSERTM(0, L1_META_WAYS < L1_ASSOC, "L1_META_WAYS must leave at least one data way\n");
   if (PRIVATE_L1) {
+    ASSERTM(0, L1_SLICES == 1, "L1_SLICES only applies to a shared L1\n");
     ASSERTM(0, L1_SIZE % NUM_CORES == 0, "Total L1_SIZE must be a multiple of NUM_CORES if PRIVATE_L1 is on\n");
     ASSERTM(0, L1_BANKS % NUM_CORES == 0, "Total L1_BANKS must be a multiple of NUM_CORES if PRIVATE_L1 is on\n");
     for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
@@ -387,7 +704,8 @@ void init_uncores(void) {
 
       char buf[MAX_STR_LENGTH + 1];
       sprintf(buf, "L1[%d]", proc_id);
-      init_cache(&l1->cache, buf, L1_SIZE / NUM_CORES, L1_ASSOC, L1_LINE_SIZE, sizeof(L1_Data), L1_CACHE_REPL_POLICY);
+      init_cache(&l1->cache, buf, L1_DATA_SIZE(L1_SIZE / NUM_CORES), L1_DATA_ASSOC, L1_LINE_SIZE, sizeof(L1_Data),
+                 L1_CACHE_REPL_POLICY);
 
       l1->num_banks = L1_BANKS / NUM_CORES;
       l1->ports = (Ports*)malloc(sizeof(Ports) * l1->num_banks);
@@ -398,9 +716,40 @@ void init_uncores(void) {
       }
       L1(proc_id) = l1;
     }
+  } else if (L1_SLICES > 1) {
+    ASSERTM(0, (L1_SLICES & (L1_SLICES - 1)) == 0, "L1_SLICES must be a power of two\n");
+    ASSERTM(0, L1_BANKS % L1_SLICES == 0, "L1_BANKS must be a multiple of L1_SLICES\n");
+    ASSERTM(0, L1_CACHE_REPL_POLICY != REPL_PARTITION && !L1_PART_ON,
+            "L1 partitioning is not supported with L1_SLICES > 1\n");
+    ASSERTM(0, !HIER_MSHR_ON, "HIER_MSHR_ON is not supported with L1_SLICES > 1\n");
+    mem->l1_slices = (Ported_Cache**)malloc(sizeof(Ported_Cache*) * L1_SLICES);
+    for (uns slice = 0; slice < L1_SLICES; slice++) {
+      Ported_Cache* l1 = (Ported_Cache*)malloc(sizeof(Ported_Cache));
+
+      char buf[MAX_STR_LENGTH + 1];
+      sprintf(buf, "L1_CACHE[%d]", slice);
+      init_cache(&l1->cache, buf, L1_DATA_SIZE(L1_SIZE / L1_SLICES), L1_DATA_ASSOC, L1_LINE_SIZE, sizeof(L1_Data),
+                 L1_CACHE_REPL_POLICY);
+      // every line of a slice has the same slice bits, so skip them when indexing the sets
+      l1->cache.shift_bits += LOG2(L1_SLICES);
+
+      l1->num_banks = L1_BANKS / L1_SLICES;
+      l1->ports = (Ports*)malloc(sizeof(Ports) * l1->num_banks);
+      for (uns ii = 0; ii < l1->num_banks; ii++) {
+        char name[MAX_STR_LENGTH + 1];
+        snprintf(name, MAX_STR_LENGTH, "L1[%d] BANK %d PORTS", slice, ii);
+        init_ports(&l1->ports[ii], name, L1_READ_PORTS, L1_WRITE_PORTS, FALSE);
+      }
+      mem->l1_slices[slice] = l1;
+    }
+    // code that does not know the address still finds the first slice
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      L1(proc_id) = mem->l1_slices[0];
+    }
   } else {
     Ported_Cache* l1 = (Ported_Cache*)malloc(sizeof(Ported_Cache));
-    init_cache(&l1->cache, "L1_CACHE", L1_SIZE, L1_ASSOC, L1_LINE_SIZE, sizeof(L1_Data), L1_CACHE_REPL_POLICY);
+    init_cache(&l1->cache, "L1_CACHE", L1_DATA_SIZE(L1_SIZE), L1_DATA_ASSOC, L1_LINE_SIZE, sizeof(L1_Data),
+               L1_CACHE_REPL_POLICY);
     l1->num_banks = L1_BANKS;
     l1->ports = (Ports*)malloc(sizeof(Ports) * l1->num_banks);
     for (uns ii = 0; ii < l1->num_banks; ii++) {
@@ -414,13 +763,15 @@ void init_uncores(void) {
   }
 
   if (L1_CACHE_REPL_POLICY == REPL_PARTITION) {
-    // initially equally partition
-    uns num_ways = L1_ASSOC / NUM_CORES;
+    // initially equally partition the data ways
+    uns num_ways = L1_DATA_ASSOC / NUM_CORES;
     for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
       set_partition_allocate(&L1(proc_id)->cache, proc_id, num_ways);
     }
 
     // set static partition (if used)
+    ASSERTM(0, !L1_META_WAYS || !L1_DYNAMIC_PARTITION_ENABLE,
+            "Dynamic L1 partitioning assumes all L1_ASSOC ways hold data\n");
     if (L1_STATIC_PARTITION_ENABLE) {
       ASSERT(0, !L1_DYNAMIC_PARTITION_ENABLE);
       ASSERTM(0, L1_STATIC_PARTITION, "Please specify L1_STATIC_PARTITION\n");
@@ -451,10 +802,23 @@ void init_uncores(void) {
   }
 
   for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    mem->uncores[proc_id].num_outstanding_l1_accesses = 0;
-    mem->uncores[proc_id].num_outstanding_l1_misses = 0;
-    mem->uncores[proc_id].mem_block_start = 0;
-  }
+    Uncore* uncore = &mem->uncores[proc_id];
+    uncore->num_outstanding_l1_accesses = 0;
+    uncore->num_outstanding_l1_misses = 0;
+    uncore->mem_block_start = 0;
+    stat_integrator_init(&uncore->cycle_integrator, proc_id, FREQ_DOMAIN_L1, L1_CYCLE, NUM_GLOBAL_STATS,
+                         NUM_GLOBAL_STATS, 0);
+    stat_integrator_set(&uncore->cycle_integrator, 1);
+    stat_integrator_init(&uncore->mlp_integrator, proc_id, FREQ_DOMAIN_L1, CORE_MLP, CORE_MLP_0, CORE_MLP_32, 1);
+    stat_integrator_init(&uncore->lines_integrator, proc_id, FREQ_DOMAIN_L1, L1_LINES, NUM_GLOBAL_STATS,
+                         NUM_GLOBAL_STATS, 0);
+  }
+  stat_integrator_init(&mem_req_demand_integrator, 0, FREQ_DOMAIN_L1, MEM_REQ_DEMAND_CYCLES, MEM_REQ_DEMANDS__0,
+                       MEM_REQ_DEMANDS_64, 4);
+  stat_integrator_init(&mem_req_pref_integrator, 0, FREQ_DOMAIN_L1, MEM_REQ_PREF_CYCLES, MEM_REQ_PREFS__0,
+                       MEM_REQ_PREFS_64, 4);
+  stat_integrator_init(&mem_req_wb_integrator, 0, FREQ_DOMAIN_L1, MEM_REQ_WB_CYCLES, MEM_REQ_WRITEBACKS__0,
+                       MEM_REQ_WRITEBACKS_64, 4);
 }
 
 /**************************************************************************************/
@@ -463,38 +827,51 @@ void init_uncores(void) {
 void reset_memory() {
   uns ii;
 
-  clear_list(&mem->req_buffer_free_list);
+  ring_clear(&mem->req_buffer_free_list);
 
-  mem->l1_queue.entry_count = 0;
+  for (ii = 0; ii < L1_SLICES; ii++) {
+    mem->l1_queues[ii].entry_count = 0;
+    mem_queue_index_clear(&mem->l1_queues[ii]);
+    mem->l1_queues[ii].sorted_count = 0;
+  }
   mem->mlc_queue.entry_count = 0;
   mem->bus_out_queue.entry_count = 0;
   mem->l1fill_queue.entry_count = 0;
   mem->mlc_fill_queue.entry_count = 0;
+  mem_queue_index_clear(&mem->mlc_queue);
+  mem_queue_index_clear(&mem->bus_out_queue);
+  mem_queue_index_clear(&mem->l1fill_queue);
+  mem_queue_index_clear(&mem->mlc_fill_queue);
+  mem->mlc_queue.sorted_count = 0;
+  mem->bus_out_queue.sorted_count = 0;
+  mem->l1fill_queue.sorted_count = 0;
+  mem->mlc_fill_queue.sorted_count = 0;
 
   for (ii = 0; ii < mem->total_mem_req_buffers; ii++) {
-    int* free_list_entry = sl_list_add_tail(&mem->req_buffer_free_list);
+    int* free_list_entry = ring_add_tail(&mem->req_buffer_free_list);
     *free_list_entry = ii;
     mem->req_buffer[ii].state = MRS_INV;
   }
+  mem_store_index_clear();
 
   mem->req_count = 0;
 
-  uns8 proc_id;
+  uns proc_id;
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     mem->l1_ave_num_ways_per_core[proc_id] = 0;
   }
 }
 
 static void mem_clear_reqbuf(Mem_Req* req) {
-  clear_list(&req->op_ptrs);
-  clear_list(&req->op_uniques);
+  ring_clear(&req->op_ptrs);
+  ring_clear(&req->op_uniques);
 }
 
 void mem_free_reqbuf(Mem_Req* req) {
   int* reqbuf_num_ptr;
 
   DEBUG(req->proc_id, "Freeing mem buffer entry  index:%d queue:%s rcount:%d l1:%d bo:%d lf:%d\n", req->id,
-        (NULL == req->queue) ? "NULL" : req->queue->name, mem->req_count, mem->l1_queue.entry_count,
+        (NULL == req->queue) ? "NULL" : req->queue->name, mem->req_count, l1_queue_entry_count(),
         mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count);
 
   if (req->state == MRS_MEM_DONE) {
@@ -569,12 +946,14 @@ void mem_free_reqbuf(Mem_Req* req) {
   ASSERT(req->proc_id, req->reserved_entry_count == 0);
 
   req->state = MRS_INV;
+  mem_store_index_sync(req);
   mem->req_count--;
+  mem->event_count++;
   ASSERT(req->proc_id, mem->req_count >= 0);
-  clear_list(&req->op_ptrs);
-  clear_list(&req->op_uniques);
+  ring_clear(&req->op_ptrs);
+  ring_clear(&req->op_uniques);
 
-  reqbuf_num_ptr = sl_list_add_tail(&mem->req_buffer_free_list);
+  reqbuf_num_ptr = ring_add_tail(&mem->req_buffer_free_list);
 
   ASSERT(req->proc_id, reqbuf_num_ptr);
   *reqbuf_num_ptr = req->id;
@@ -653,7 +1032,8 @@ void print_req_buffer() {
 void print_mem_queue(Mem_Queue_Type queue_type) {
   fprintf(stdout, "\n");
   if (queue_type & QUEUE_L1)
-    print_mem_queue_generic(&(mem->l1_queue));
+    for (uns ii = 0; ii < L1_SLICES; ii++)
+      print_mem_queue_generic(&mem->l1_queues[ii]);
 
   if (queue_type & QUEUE_MLC)
     print_mem_queue_generic(&(mem->mlc_queue));
@@ -730,7 +1110,7 @@ void debug_memory() {
   DPRINTF("reqbuf_used_count:    %d\n", mem->req_count);
   DPRINTF("reqbuf_free_count:    %d\n", mem->req_buffer_free_list.count);
   DPRINTF("mlc_queue_count:      %d\n", mem->mlc_queue.entry_count);
-  DPRINTF("l1_queue_count:       %d\n", mem->l1_queue.entry_count);
+  DPRINTF("l1_queue_count:       %d\n", l1_queue_entry_count());
   DPRINTF("bus_out_queue_count:  %d\n", mem->bus_out_queue.entry_count);
   DPRINTF("mlc_fill_queue_count: %d\n", mem->mlc_fill_queue.entry_count);
   DPRINTF("l1fill_queue_count:   %d\n", mem->l1fill_queue.entry_count);
@@ -742,16 +1122,47 @@ void debug_memory() {
 /**************************************************************************************/
 /* update_memory: */
 
+static int l1_queue_entry_count(void) {
+  int count = 0;
+  for (uns ii = 0; ii < L1_SLICES; ii++)
+    count += mem->l1_queues[ii].entry_count;
+  return count;
+}
+
+/* l1_slice_hops: ring distance between a core and the L1 slice of addr, with the
+   cores and the slices spread evenly over max(NUM_CORES, L1_SLICES) stops */
+
+static uns l1_slice_hops(uns proc_id, Addr addr) {
+  uns num_stops = MAX2(NUM_CORES, L1_SLICES);
+  uns core_stop = proc_id * num_stops / NUM_CORES;
+  uns slice_stop = L1_SLICE(addr) * num_stops / L1_SLICES;
+  uns dist = core_stop > slice_stop ? core_stop - slice_stop : slice_stop - core_stop;
+  return MIN2(dist, num_stops - dist);
+}
+
+/* l1_noc_round_trip: the request (or the data of a writeback) travels from the core to
+   the L1, and the line (or an ack) travels back once the lookup is done. Both trips are
+   reserved when the access starts, so a miss pays for the trip back as if it hit. Returns
+   the new rdy_cycle. */
+
+static Counter l1_noc_round_trip(Mem_Req* req, uns core_node, uns l1_node, Flag need_wp) {
+  Counter lookup_cycles = req->rdy_cycle - cycle_count;
+  Counter at_l1 = noc_send(req->proc_id, core_node, l1_node, need_wp ? noc_data_flits() : noc_ctrl_flits(),
+                           cycle_count);
+  return noc_send(req->proc_id, l1_node, core_node, need_wp ? noc_ctrl_flits() : noc_data_flits(),
+                  at_l1 + lookup_cycles);
+}
+
 static inline void queue_sanity_check(int location) {
-  int queue_count = mem->l1_queue.entry_count + mem->bus_out_queue.entry_count + mem->l1fill_queue.entry_count +
+  int queue_count = l1_queue_entry_count() + mem->bus_out_queue.entry_count + mem->l1fill_queue.entry_count +
                     mem->mlc_queue.entry_count + mem->mlc_fill_queue.entry_count;
 
   ASSERTM(0, mem->req_count == queue_count, "rc:%d l1:%d bo:%d lf:%d loc:%d\n", mem->req_count,
-          mem->l1_queue.entry_count, mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, location);
+          l1_queue_entry_count(), mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, location);
 
   ASSERTM(0, (mem->req_count + mem->req_buffer_free_list.count) == mem->total_mem_req_buffers,
           "rc:%d rf:%d l1:%d bo:%d lf:%d loc:%d\n", mem->req_count, mem->req_buffer_free_list.count,
-          mem->l1_queue.entry_count, mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, location);
+          l1_queue_entry_count(), mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, location);
 }
 
 int cycle_l1q_insert_count = 0;
@@ -770,37 +1181,22 @@ void update_memory_queues() {
   }
 
   if (!ALL_FIFO_QUEUES && (cycle_l1q_insert_count > 0)) {
-    qsort(mem->l1_queue.base, mem->l1_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
+    for (uns ii = 0; ii < L1_SLICES; ii++)
+      mem_queue_sort(&mem->l1_queues[ii]);
     cycle_l1q_insert_count = 0;
   }
 
   if (!ALL_FIFO_QUEUES && (cycle_mlcq_insert_count > 0)) {
-    qsort(mem->mlc_queue.base, mem->mlc_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
+    mem_queue_sort(&mem->mlc_queue);
     cycle_mlcq_insert_count = 0;
   }
 
   if (!ALL_FIFO_QUEUES && (cycle_busoutq_insert_count > 0)) {
-    qsort(mem->bus_out_queue.base, mem->bus_out_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
+    mem_queue_sort(&mem->bus_out_queue);
     cycle_busoutq_insert_count = 0;
   }
 }
 
-void update_on_chip_memory_stats() {
-  STAT_EVENT_ALL(L1_CYCLE);
-  STAT_EVENT(0, MIN2(MEM_REQ_DEMANDS__0 + mem_req_demand_entries / 4, MEM_REQ_DEMANDS_64));
-  STAT_EVENT(0, MIN2(MEM_REQ_PREFS__0 + mem_req_pref_entries / 4, MEM_REQ_PREFS_64));
-  STAT_EVENT(0, MIN2(MEM_REQ_WRITEBACKS__0 + mem_req_wb_entries / 4, MEM_REQ_WRITEBACKS_64));
-  INC_STAT_EVENT(0, MEM_REQ_DEMAND_CYCLES, mem_req_demand_entries);
-  INC_STAT_EVENT(0, MEM_REQ_PREF_CYCLES, mem_req_pref_entries);
-  INC_STAT_EVENT(0, MEM_REQ_WB_CYCLES, mem_req_wb_entries);
-  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    STAT_EVENT(proc_id, CORE_MLP_0 + MIN2(mem->uncores[proc_id].num_outstanding_l1_misses, 32));
-    INC_STAT_EVENT(proc_id, CORE_MLP, mem->uncores[proc_id].num_outstanding_l1_misses);
-    Counter l1_lines = GET_TOTAL_STAT_EVENT(proc_id, NORESET_L1_FILL) - GET_TOTAL_STAT_EVENT(proc_id, NORESET_L1_EVICT);
-    INC_STAT_EVENT(proc_id, L1_LINES, l1_lines);
-  }
-}
-
 /**
  * @brief simulate the memory system for one cycle
  * functions are called in reverse order, that's fill queues (req going back to
@@ -813,9 +1209,10 @@ void update_memory() {
 
     perf_pred_cycle();
 
+    mem_in_pref_update = TRUE;
     pref_update();
+    mem_in_pref_update = FALSE;
     update_memory_queues();
-    update_on_chip_memory_stats();
 
     mem_process_mlc_fill_reqs();
     mem_process_l1_fill_reqs();
@@ -857,6 +1254,10 @@ int mem_compare_priority(const void* a, const void* b) {
     return -1;
   else if (priority1 < priority0)
     return 1;
+  else if (e0->seq < e1->seq) /* older entry first among equal priorities */
+    return -1;
+  else if (e1->seq < e0->seq)
+    return 1;
   else
     return 0;
 }
@@ -898,8 +1299,18 @@ void mem_start_l1_access(Mem_Req* req) {
   /* FIXME: Only WB reqs try to get a write port? How about stores? */
   Flag need_wp = ((req->type == MRT_WB) || (req->type == MRT_WB_NODIRTY));
   Flag need_rp = !need_wp;
-  if ((need_wp && get_write_port(&L1(req->proc_id)->ports[req->l1_bank])) ||
-      (need_rp && get_read_port(&L1(req->proc_id)->ports[req->l1_bank]))) {
+  uns core_node = 0, l1_node = 0;
+  if (NOC_TOPOLOGY != NOC_TOPOLOGY_NONE) {
+    core_node = noc_core_node(req->proc_id);
+    l1_node = PRIVATE_L1 ? core_node : noc_l1_node(L1_SLICE(req->addr));
+    // no port is taken until the core's router has a credit for the request
+    if (!noc_can_inject(core_node, l1_node, cycle_count)) {
+      STAT_EVENT(req->proc_id, NOC_INJECT_STALLS);
+      return;
+    }
+  }
+  if ((need_wp && get_write_port(&L1_OF(req->proc_id, req->addr)->ports[req->l1_bank])) ||
+      (need_rp && get_read_port(&L1_OF(req->proc_id, req->addr)->ports[req->l1_bank]))) {
     DEBUG(req->proc_id,
           "Mem request accessing L1  index:%ld  type:%s  addr:0x%s  "
           "mem_bank:%d  size:%d  state: %s\n",
@@ -908,15 +1319,23 @@ void mem_start_l1_access(Mem_Req* req) {
 
     avail = TRUE;
     req->state = MRS_L1_WAIT;
+    // a sliced L1 adds the trip to the slice and back
+    uns l1_cycles = L1_CYCLES;
+    if (L1_SLICES > 1 && NOC_TOPOLOGY == NOC_TOPOLOGY_NONE)
+      l1_cycles += 2 * L1_SLICE_HOP_CYCLES * l1_slice_hops(req->proc_id, req->addr);
     if (L1_USE_CORE_FREQ) {
       // model cache as being in the requesting core's frequency domain
       // useful for modeling per-core DVFS with private LLCs
       Freq_Domain_Id core_domain = FREQ_DOMAIN_CORES[req->proc_id];
       Counter core_cycle_count = freq_cycle_count(core_domain);
-      req->rdy_cycle = freq_convert_future_cycle(core_domain, core_cycle_count + L1_CYCLES, FREQ_DOMAIN_L1);
+      req->rdy_cycle = freq_convert_future_cycle(core_domain, core_cycle_count + l1_cycles, FREQ_DOMAIN_L1);
     } else {
-      req->rdy_cycle = cycle_count + L1_CYCLES;
+      req->rdy_cycle = cycle_count + l1_cycles;
     }
+    if (NOC_TOPOLOGY != NOC_TOPOLOGY_NONE)
+      req->rdy_cycle = l1_noc_round_trip(req, core_node, l1_node, need_wp);
+    if (COHERENCE_PROTOCOL != COHERENCE_PROTOCOL_NONE)
+      req->rdy_cycle += coh_l1_access(req, cycle_count);
 
     mem->uncores[req->proc_id].num_outstanding_l1_accesses++;
     memview_l1(req);
@@ -1046,7 +1465,7 @@ Flag mem_process_l1_hit_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry, Ad
   }
 
   /* Set the priority so that this entry will be removed from the l1_queue */
-  l1_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+  mem_queue_entry_set_priority(l1_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
 
   if (L2L1PREF_ON)
     l2l1pref_mem(req);
@@ -1064,6 +1483,9 @@ Flag mem_process_mlc_hit_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_entry,
   if (!req->done_func || req->done_func(req)) {
     /* If done_func is not complete we will keep accessing MLC until done_func returns TRUE */
 
+    if (COHERENCE_PROTOCOL != COHERENCE_PROTOCOL_NONE && req->type == MRT_DSTORE)
+      coh_store_hit(req->proc_id, req->addr);
+
     if (data) { /* not perfect mlc */
       if ((req->type == MRT_DFETCH) || (req->type == MRT_DSTORE) || (req->type == MRT_IFETCH)) {
         if (data->prefetch) {  // prefetch hit
@@ -1121,7 +1543,7 @@ Flag mem_process_mlc_hit_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_entry,
     }
 
     /* Set the priority so that this entry will be removed from the mlc_queue */
-    mlc_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+    mem_queue_entry_set_priority(mlc_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
 
     return TRUE;
   } else {
@@ -1198,7 +1620,7 @@ static Flag mem_process_l1_miss_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_e
         req->state = MRS_L1_HIT_DONE;
         req->rdy_cycle = cycle_count + 1;
         mem_free_reqbuf(req);
-        l1_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+        mem_queue_entry_set_priority(l1_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
         return TRUE;
       } else {
         req->rdy_cycle = cycle_count + 1;
@@ -1219,7 +1641,7 @@ static Flag mem_process_l1_miss_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_e
         req->rdy_cycle = cycle_count + 1;
         mem_free_reqbuf(req);
       }
-      l1_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+      mem_queue_entry_set_priority(l1_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
       return TRUE;
     }
   }
@@ -1229,7 +1651,7 @@ static Flag mem_process_l1_miss_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_e
     req->state = MRS_INV;
     req->rdy_cycle = cycle_count + 1;
     mem_free_reqbuf(req);
-    l1_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+    mem_queue_entry_set_priority(l1_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
     return TRUE;
   }
 
@@ -1322,7 +1744,7 @@ static Flag mem_process_mlc_miss_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue
         req->state = MRS_MLC_HIT_DONE;
         req->rdy_cycle = cycle_count + 1;
         mem_free_reqbuf(req);
-        mlc_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+        mem_queue_entry_set_priority(mlc_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
         return TRUE;
       } else {
         req->rdy_cycle = cycle_count + 1;
@@ -1339,18 +1761,18 @@ static Flag mem_process_mlc_miss_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue
         req->rdy_cycle = cycle_count + 1;
         mem_free_reqbuf(req);
       }
-      mlc_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+      mem_queue_entry_set_priority(mlc_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
       return TRUE;
     }
   }
 
-  if (!queue_full(&mem->l1_queue)) {
+  if (!queue_full(L1_QUEUE(req->addr))) {
     req->state = MRS_L1_NEW;
     /* this req will be ready to be sent to memory in the  next cycle */
     req->rdy_cycle = cycle_count + MLCQ_TO_L1Q_TRANSFER_LATENCY;
 
     /* Set the priority so that this entry will be removed from the mlc_queue */
-    mlc_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+    mem_queue_entry_set_priority(mlc_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
     return TRUE;
   } else {
     STAT_EVENT(req->proc_id, REJECTED_QUEUE_L1);
@@ -1371,7 +1793,8 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
 
   if (L1_CACHE_HIT_POSITION_COLLECT || (L1_DYNAMIC_PARTITION_ENABLE && L1_DYNAMIC_PARTITION_POLICY == MARGINAL_UTIL)) {
     if ((req->type == MRT_DFETCH) || (req->type == MRT_DSTORE) || (req->type == MRT_IFETCH)) {
-      lru_position = cache_find_pos_in_lru_stack(&L1(req->proc_id)->cache, req->proc_id, req->addr, &line_addr);
+      lru_position =
+          cache_find_pos_in_lru_stack(&L1_OF(req->proc_id, req->addr)->cache, req->proc_id, req->addr, &line_addr);
       ASSERT(req->proc_id, lru_position < (int)L1_ASSOC);
     }
   }
@@ -1389,7 +1812,7 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
       ASSERT(0, L1_CACHE_REPL_POLICY == REPL_PARTITION);
       ASSERT(0, ADDR_TRANSLATION == ADDR_TRANS_NONE);
 
-      l1_cache = &L1(req->proc_id)->cache;
+      l1_cache = &L1_OF(req->proc_id, req->addr)->cache;
       set = req->addr >> l1_cache->shift_bits & l1_cache->set_mask;
       if (set % 33 == 0) {
         set = set / 33;  // converting the addr
@@ -1422,7 +1845,7 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
   if (!PREFETCH_UPDATE_LRU_L1 && (req->type == MRT_DPRF || req->type == MRT_IPRF || req->type == MRT_UOCPRF ||
                                   req->type == MRT_FDIPPRFON || req->type == MRT_FDIPPRFOFF))
     update_l1_lru = FALSE;
-  data = (L1_Data*)cache_access(&L1(req->proc_id)->cache, req->addr, &line_addr,
+  data = (L1_Data*)cache_access(&L1_OF(req->proc_id, req->addr)->cache, req->addr, &line_addr,
                                 update_l1_lru);  // access L2
   req->l1_hit = data ? TRUE : FALSE;
   cache_part_l1_access(req);
@@ -1462,7 +1885,7 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
         // Train the Data prefetcher
         ASSERT(req->proc_id, PERFECT_L1 || data);
         ASSERT(req->proc_id, PERFECT_L1 || req->proc_id == data->proc_id);
-        ASSERT(req->proc_id, req->proc_id == req->addr >> 58);
+        ASSERT(req->proc_id, req->proc_id == req->addr >> CMP_ADDR_PROC_ID_SHIFT);
         pref_ul1_hit(req->proc_id, req->addr, req->loadPC, req->global_hist);
       }
 
@@ -1484,6 +1907,9 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
           ASSERT(req->proc_id, req->mem_queue_cycle >= req->rdy_cycle);
           DEBUG(req->proc_id, "L1 write through request is sent to Ramulator\n");
           mem_seq_num++;
+          if (NOC_TOPOLOGY != NOC_TOPOLOGY_NONE)
+            noc_send(req->proc_id, noc_l1_node(L1_SLICE(req->addr)), noc_mc_node(req->addr), noc_data_flits(),
+                     cycle_count);
           // perf_pred_mem_req_start(req);
           mem_free_reqbuf(req);
         }
@@ -1503,7 +1929,7 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
     Flag l1_miss_access = mem_process_l1_miss_access(req, l1_queue_entry, &line_addr, data);
     if (l1_miss_access && l1_miss_send_bus) {
       if (CONSTANT_MEMORY_LATENCY) {
-        mem->uncores[req->proc_id].num_outstanding_l1_misses++;
+        mem_add_outstanding_l1_misses(req->proc_id, 1);
         mem_complete_bus_in_access(req, l1_queue_entry->priority);
         req->rdy_cycle = cycle_count + freq_convert(FREQ_DOMAIN_MEMORY, MEMORY_CYCLES, FREQ_DOMAIN_L1);
         req->mem_queue_cycle = cycle_count;
@@ -1537,8 +1963,13 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
 
           DEBUG(req->proc_id, "l1 miss request is sent to ramulator\n");
           mem_seq_num++;
+          // Ramulator sees the request now; the trip to the controller is added when the line comes back
+          if (NOC_TOPOLOGY != NOC_TOPOLOGY_NONE)
+            req->noc_mem_cycles = noc_send(req->proc_id, noc_l1_node(L1_SLICE(req->addr)), noc_mc_node(req->addr),
+                                           noc_ctrl_flits(), cycle_count) -
+                                  cycle_count;
           perf_pred_mem_req_start(req);
-          mem->uncores[req->proc_id].num_outstanding_l1_misses++;
+          mem_add_outstanding_l1_misses(req->proc_id, 1);
 
           if (TRACK_L1_MISS_DEPS || MARK_L1_MISSES)
             mark_ops_as_l1_miss(req);
@@ -1553,7 +1984,7 @@ static Flag mem_complete_l1_access(Mem_Req* req, Mem_Queue_Entry* l1_queue_entry
 
           /* Set the priority so that this entry will be removed from the
            * l1_queue */
-          l1_queue_entry->priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+          mem_queue_entry_set_priority(l1_queue_entry, Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
 
           STAT_EVENT(req->proc_id, SEND_MISS_REQ_QUEUE);
           // return TRUE;
@@ -1643,12 +2074,12 @@ static Flag mem_complete_mlc_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_ent
         // Train the Data prefetcher
         ASSERT(req->proc_id, data);
         ASSERT(req->proc_id, req->proc_id == data->proc_id);
-        ASSERT(req->proc_id, req->proc_id == req->addr >> 58);
+        ASSERT(req->proc_id, req->proc_id == req->addr >> CMP_ADDR_PROC_ID_SHIFT);
         pref_umlc_hit(req->proc_id, req->addr, req->loadPC, req->global_hist);
       }
 
       if (MLC_WRITE_THROUGH && (req->type == MRT_WB)) {
-        req->queue = &(mem->l1_queue);
+        req->queue = L1_QUEUE(req->addr);
         mem_insert_req_into_queue(req, req->queue, ALL_FIFO_QUEUES ? l1_seq_num : 0);
         l1_seq_num++;
         (*l1_queue_insertion_count) += 1;
@@ -1663,9 +2094,9 @@ static Flag mem_complete_mlc_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_ent
     Flag mlc_miss_access = mem_process_mlc_miss_access(req, mlc_queue_entry, &line_addr, data);
     if (mlc_miss_access && mlc_miss_send_l1) {
       DEBUG(req->proc_id, "mlc miss request is inserted to l1 queue rc:%d mlc:%d bo:%d lf:%d\n", mem->req_count,
-            mem->mlc_queue.entry_count, mem->l1_queue.entry_count, mem->mlc_fill_queue.entry_count);
+            mem->mlc_queue.entry_count, l1_queue_entry_count(), mem->mlc_fill_queue.entry_count);
 
-      req->queue = &(mem->l1_queue);
+      req->queue = L1_QUEUE(req->addr);
       // queue full check is done in mem_process_mlc_miss_access
       mem_insert_req_into_queue(req, req->queue, ALL_FIFO_QUEUES ? l1_seq_num : 0);
       l1_seq_num++;
@@ -1693,6 +2124,24 @@ static Flag mem_complete_mlc_access(Mem_Req* req, Mem_Queue_Entry* mlc_queue_ent
   return FALSE;
 }
 
+/**************************************************************************************/
+/* mem_queue_walk_begin: FALSE if no entry of the queue can be ready this cycle, else
+   start collecting the earliest rdy_cycle of the entries the walk leaves behind */
+
+static inline Flag mem_queue_walk_begin(Mem_Queue* queue) {
+  if (cycle_count < queue->next_rdy_cycle)
+    return FALSE;
+  queue->next_rdy_cycle = MAX_CTR;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* mem_queue_walk_note: account for a visited entry in the queue's next ready cycle */
+
+static inline void mem_queue_walk_note(Mem_Queue* queue, Mem_Req* req) {
+  queue->next_rdy_cycle = MIN2(queue->next_rdy_cycle, req->rdy_cycle);
+}
+
 /**************************************************************************************/
 /* mem_process_new_reqs: */
 /* Access L1 if port is ready - If L1 miss, then put the request into miss queue */
@@ -1701,76 +2150,90 @@ static void mem_process_l1_reqs() {
   Mem_Req* req = NULL;
   int ii;
   int reqbuf_id;
-  int l1_queue_removal_count = 0;
   int out_queue_insertion_count = 0;
-  int l1_queue_reserve_entry_count = 0;
 
-  INC_STAT_EVENT(0, L1_QUEUE_OCCUPANCY, mem->l1_queue.entry_count);
-  /* Go thru the l1_queue and try to access L1 for each request */
-
-  for (ii = 0; ii < mem->l1_queue.entry_count; ii++) {
-    reqbuf_id = mem->l1_queue.base[ii].reqbuf;
-    req = &(mem->req_buffer[reqbuf_id]);
-
-    // this is just a print
-    if (req->state == MRS_INV) {
-      print_mem_queue(QUEUE_L1 | QUEUE_BUS_OUT | QUEUE_L1FILL | QUEUE_MLC | QUEUE_MLC_FILL);
-    }
+  INC_STAT_EVENT(0, L1_QUEUE_OCCUPANCY, l1_queue_entry_count());
+  /* Go thru the l1_queue of every slice and try to access L1 for each request */
 
-    ASSERTM(req->proc_id, req->state != MRS_INV, "id:%d state:%s type:%s rc:%d l1:%d bi:%d lf:%d\n", req->id,
-            mem_req_state_names[req->state], Mem_Req_Type_str(req->type), mem->req_count, mem->l1_queue.entry_count,
-            mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count);
+  for (uns slice = 0; slice < L1_SLICES; slice++) {
+    Mem_Queue* l1_queue = &mem->l1_queues[slice];
+    int l1_queue_removal_count = 0;
+    int l1_queue_reserve_entry_count = 0;
+    int slice_out_queue_insertion_count = 0;
 
-    /* if the request is not yet ready, then try the next one */
-    if (cycle_count < req->rdy_cycle)
+    if (!mem_queue_walk_begin(l1_queue))
       continue;
 
-    /* Request is ready: see what state it is in */
+    for (ii = 0; ii < l1_queue->entry_count; ii++) {
+      reqbuf_id = l1_queue->base[ii].reqbuf;
+      req = &(mem->req_buffer[reqbuf_id]);
 
-    /* If this is a new request, reserve L1 port and transition to wait state */
-    if (req->state == MRS_L1_NEW) {
-      mem_start_l1_access(req);
-      STAT_EVENT(req->proc_id, L1_ACCESS);
-      if (req->type == MRT_DPRF || req->type == MRT_IPRF || req->type == MRT_UOCPRF || req->type == MRT_FDIPPRFON ||
-          req->type == MRT_FDIPPRFOFF)
-        STAT_EVENT(req->proc_id, L1_PREF_ACCESS);
-      else
-        STAT_EVENT(req->proc_id, L1_DEMAND_ACCESS);
-    } else {
-      ASSERTM(req->proc_id, req->state == MRS_L1_WAIT, "id:%d state:%s type:%s rc:%d l1:%d bi:%d lf:%d\n", req->id,
-              mem_req_state_names[req->state], Mem_Req_Type_str(req->type), mem->req_count, mem->l1_queue.entry_count,
+      // this is just a print
+      if (req->state == MRS_INV) {
+        print_mem_queue(QUEUE_L1 | QUEUE_BUS_OUT | QUEUE_L1FILL | QUEUE_MLC | QUEUE_MLC_FILL);
+      }
+
+      ASSERTM(req->proc_id, req->state != MRS_INV, "id:%d state:%s type:%s rc:%d l1:%d bi:%d lf:%d\n", req->id,
+              mem_req_state_names[req->state], Mem_Req_Type_str(req->type), mem->req_count, l1_queue->entry_count,
               mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count);
 
-      if (mem_complete_l1_access(req, &(mem->l1_queue.base[ii]), &out_queue_insertion_count,
-                                 &l1_queue_reserve_entry_count))
-        l1_queue_removal_count++;
-    }
-  }
+      /* if the request is not yet ready, then try the next one */
+      if (cycle_count < req->rdy_cycle) {
+        mem_queue_walk_note(l1_queue, req);
+        continue;
+      }
 
-  ASSERT(req->proc_id, out_queue_insertion_count <= l1_queue_removal_count);
-  ASSERT(req->proc_id, l1_queue_reserve_entry_count <= out_queue_insertion_count);
+      /* Request is ready: see what state it is in */
 
-  /* Remove requests from l1 access queue */
-  if (l1_queue_removal_count > 0) {
-    /* After this sort requests that should be removed will be at the tail of
-     * the l1_queue */
-    DEBUG(0, "l1_queue removal\n");
-    qsort(mem->l1_queue.base, mem->l1_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
-    mem->l1_queue.entry_count -= l1_queue_removal_count;
-    ASSERT(req->proc_id, mem->l1_queue.entry_count >= 0);
-    /* if HIER_MSHR_ON, requests stay in the queues until filled (by reserving
-     * entries) */
-    if (HIER_MSHR_ON) {
-      mem->l1_queue.reserved_entry_count += l1_queue_reserve_entry_count;
+      /* If this is a new request, reserve L1 port and transition to wait state */
+      if (req->state == MRS_L1_NEW) {
+        mem_start_l1_access(req);
+        mem_queue_walk_note(l1_queue, req);
+        STAT_EVENT(req->proc_id, L1_ACCESS);
+        if (req->type == MRT_DPRF || req->type == MRT_IPRF || req->type == MRT_UOCPRF || req->type == MRT_FDIPPRFON ||
+            req->type == MRT_FDIPPRFOFF)
+          STAT_EVENT(req->proc_id, L1_PREF_ACCESS);
+        else
+          STAT_EVENT(req->proc_id, L1_DEMAND_ACCESS);
+      } else {
+        ASSERTM(req->proc_id, req->state == MRS_L1_WAIT, "id:%d state:%s type:%s rc:%d l1:%d bi:%d lf:%d\n", req->id,
+                mem_req_state_names[req->state], Mem_Req_Type_str(req->type), mem->req_count, l1_queue->entry_count,
+                mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count);
+
+        if (mem_complete_l1_access(req, &(l1_queue->base[ii]), &slice_out_queue_insertion_count,
+                                   &l1_queue_reserve_entry_count))
+          l1_queue_removal_count++;
+        else
+          mem_queue_walk_note(l1_queue, req);
+      }
+    }
+
+    ASSERT(req->proc_id, slice_out_queue_insertion_count <= l1_queue_removal_count);
+    ASSERT(req->proc_id, l1_queue_reserve_entry_count <= slice_out_queue_insertion_count);
+    out_queue_insertion_count += slice_out_queue_insertion_count;
+
+    /* Remove requests from l1 access queue */
+    if (l1_queue_removal_count > 0) {
+      /* After this sort requests that should be removed will be at the tail of
+       * the l1_queue */
+      DEBUG(0, "l1_queue removal\n");
+      mem_queue_sort(l1_queue);
+      mem_queue_remove_tail(l1_queue, l1_queue_removal_count);
+      ASSERT(req->proc_id, l1_queue->entry_count >= 0);
+      /* if HIER_MSHR_ON, requests stay in the queues until filled (by reserving
+       * entries) */
+      if (HIER_MSHR_ON) {
+        l1_queue->reserved_entry_count += l1_queue_reserve_entry_count;
+      }
     }
   }
 
   /* Sort the out queue if requests were inserted */
   if (!ALL_FIFO_QUEUES && (out_queue_insertion_count > 0)) {
     if (CONSTANT_MEMORY_LATENCY) {  // request went straight to L1 fill queue
-      qsort(mem->l1fill_queue.base, mem->l1fill_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
+      mem_queue_sort(&mem->l1fill_queue);
     } else {
-      qsort(mem->bus_out_queue.base, mem->bus_out_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
+      mem_queue_sort(&mem->bus_out_queue);
     }
   }
 }
@@ -1787,9 +2250,12 @@ static void mem_process_mlc_reqs() {
   int l1_queue_insertion_count = 0;
   int mlc_queue_reserve_entry_count = 0;
 
-  INC_STAT_EVENT(0, MLC_QUEUE_OCCUPANCY, mem->l1_queue.entry_count);
+  INC_STAT_EVENT(0, MLC_QUEUE_OCCUPANCY, l1_queue_entry_count());
   /* Go thru the mlc_queue and try to access MLC for each request */
 
+  if (!mem_queue_walk_begin(&mem->mlc_queue))
+    return;
+
   for (ii = 0; ii < mem->mlc_queue.entry_count; ii++) {
     reqbuf_id = mem->mlc_queue.base[ii].reqbuf;
     req = &(mem->req_buffer[reqbuf_id]);
@@ -1801,11 +2267,13 @@ static void mem_process_mlc_reqs() {
 
     ASSERTM(req->proc_id, req->state != MRS_INV, "id:%d state:%s type:%s rc:%d mlc:%d l1:%d mf:%d\n", req->id,
             mem_req_state_names[req->state], Mem_Req_Type_str(req->type), mem->req_count, mem->mlc_queue.entry_count,
-            mem->l1_queue.entry_count, mem->mlc_fill_queue.entry_count);
+            l1_queue_entry_count(), mem->mlc_fill_queue.entry_count);
 
     /* if the request is not yet ready, then try the next one */
-    if (cycle_count < req->rdy_cycle)
+    if (cycle_count < req->rdy_cycle) {
+      mem_queue_walk_note(&mem->mlc_queue, req);
       continue;
+    }
 
     /* Request is ready: see what state it is in */
 
@@ -1813,6 +2281,7 @@ static void mem_process_mlc_reqs() {
      */
     if (req->state == MRS_MLC_NEW) {
       mem_start_mlc_access(req);
+      mem_queue_walk_note(&mem->mlc_queue, req);
       STAT_EVENT(req->proc_id, MLC_ACCESS);
       if (req->type == MRT_DPRF || req->type == MRT_IPRF || req->type == MRT_UOCPRF || req->type == MRT_FDIPPRFON ||
           req->type == MRT_FDIPPRFOFF)
@@ -1822,10 +2291,12 @@ static void mem_process_mlc_reqs() {
     } else {
       ASSERTM(req->proc_id, req->state == MRS_MLC_WAIT, "id:%d state:%s type:%s rc:%d mlc:%d l1:%d mf:%d\n", req->id,
               mem_req_state_names[req->state], Mem_Req_Type_str(req->type), mem->req_count, mem->mlc_queue.entry_count,
-              mem->l1_queue.entry_count, mem->mlc_fill_queue.entry_count);
+              l1_queue_entry_count(), mem->mlc_fill_queue.entry_count);
       if (mem_complete_mlc_access(req, &(mem->mlc_queue.base[ii]), &l1_queue_insertion_count,
                                   &mlc_queue_reserve_entry_count))
         mlc_queue_removal_count++;
+      else
+        mem_queue_walk_note(&mem->mlc_queue, req);
     }
   }
 
@@ -1837,8 +2308,8 @@ static void mem_process_mlc_reqs() {
     /* After this sort requests that should be removed will be at the tail of
      * the mlc_queue */
     DEBUG(0, "mlc_queue removal\n");
-    qsort(mem->mlc_queue.base, mem->mlc_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
-    mem->mlc_queue.entry_count -= mlc_queue_removal_count;
+    mem_queue_sort(&mem->mlc_queue);
+    mem_queue_remove_tail(&mem->mlc_queue, mlc_queue_removal_count);
     ASSERT(req->proc_id, mem->mlc_queue.entry_count >= 0);
     /* if HIER_MSHR_ON, requests stay in the queues until filled (by reserving
      * entries) */
@@ -1849,7 +2320,8 @@ static void mem_process_mlc_reqs() {
 
   /* Sort the l1 queue if requests were inserted */
   if (!ALL_FIFO_QUEUES && (l1_queue_insertion_count > 0)) {
-    qsort(mem->l1_queue.base, mem->l1_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
+    for (uns ii = 0; ii < L1_SLICES; ii++)
+      mem_queue_sort(&mem->l1_queues[ii]);
   }
 }
 
@@ -1905,7 +2377,7 @@ static void mem_process_bus_out_reqs() {
 
       /* Adjust the request's priority so that it will be removed */
       bus_schedule = TRUE;
-      mem->bus_out_queue.base[ii].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+      mem_queue_entry_set_priority(&mem->bus_out_queue.base[ii], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
 
       DEBUG(req->proc_id,
             "Mem request acquired the bus out  index:%ld  type:%s  addr:0x%s  "
@@ -1918,7 +2390,7 @@ static void mem_process_bus_out_reqs() {
         break;
     }
   } else if (ROUND_ROBIN_TO_MEM_QUEUE) {
-    uns8 proc_id;
+    uns proc_id;
     uns8 next_proc_id;
 
     ASSERTM(0, !MEM_MEM_QUEUE_PARTITION_ENABLE, "ERROR: MEM_QUEUE partitioning is not implemented in Ramulator!\n");
@@ -1968,8 +2440,8 @@ static void mem_process_bus_out_reqs() {
     for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
       if (mem->bus_out_queue_index_core[next_proc_id] != -1) {  // found one
         bus_schedule = TRUE;
-        mem->bus_out_queue.base[mem->bus_out_queue_index_core[next_proc_id]].priority =
-            Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+        mem_queue_entry_set_priority(&mem->bus_out_queue.base[mem->bus_out_queue_index_core[next_proc_id]],
+                                     Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
 
         reqbuf_id = mem->bus_out_queue.base[mem->bus_out_queue_index_core[next_proc_id]].reqbuf;
         req = &(mem->req_buffer[reqbuf_id]);
@@ -1981,7 +2453,7 @@ static void mem_process_bus_out_reqs() {
       next_proc_id = (next_proc_id + 1) % NUM_CORES;  // look at the next core
     }
   } else if (ONE_CORE_FIRST_TO_MEM_QUEUE) {
-    uns8 proc_id;
+    uns proc_id;
     uns8 next_proc_id;
 
     ASSERTM(0, !MEM_MEM_QUEUE_PARTITION_ENABLE, "ERROR: MEM_QUEUE partitioning is not implemented in Ramulator!\n");
@@ -2031,8 +2503,8 @@ static void mem_process_bus_out_reqs() {
     for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
       if (mem->bus_out_queue_index_core[next_proc_id] != -1) {  // found one
         bus_schedule = TRUE;
-        mem->bus_out_queue.base[mem->bus_out_queue_index_core[next_proc_id]].priority =
-            Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+        mem_queue_entry_set_priority(&mem->bus_out_queue.base[mem->bus_out_queue_index_core[next_proc_id]],
+                                     Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
 
         reqbuf_id = mem->bus_out_queue.base[mem->bus_out_queue_index_core[next_proc_id]].reqbuf;
         req = &(mem->req_buffer[reqbuf_id]);
@@ -2112,8 +2584,8 @@ static void mem_process_bus_out_reqs() {
     if (mem->uncores[req->proc_id].num_outstanding_l1_misses == 0) {
       STAT_EVENT(req->proc_id, CORE_MLP_CLUSTERS);
     }
-    mem->uncores[req->proc_id].num_outstanding_l1_misses++;  // Ramulator_note: Do we need to move this
-                                                             // after ramulator_send()?
+    mem_add_outstanding_l1_misses(req->proc_id, 1);  // Ramulator_note: Do we need to move this
+                                                     // after ramulator_send()?
     // dram->proc_infos[req->proc_id].reqs_per_bank[req->mem_flat_bank]++; //
     // Ramulator_todo: replicate this stat
 
@@ -2124,8 +2596,8 @@ static void mem_process_bus_out_reqs() {
     //}
 
     DEBUG(0, "bus_out_queue removal\n");
-    qsort(mem->bus_out_queue.base, mem->bus_out_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
-    mem->bus_out_queue.entry_count--;
+    mem_queue_sort(&mem->bus_out_queue);
+    mem_queue_remove_tail(&mem->bus_out_queue, 1);
     ASSERT(req->proc_id, mem->bus_out_queue.entry_count >= 0);
 
     // Ramulator_remove: Ramulator implements its own request queues. This
@@ -2147,9 +2619,14 @@ void mem_complete_bus_in_access(Mem_Req* req, Counter priority) {
         mem_req_state_names[req->state]);
 
   req->state = MRS_FILL_L1;
+  if (!CONSTANT_MEMORY_LATENCY)
+    HIST_RECORD(req->proc_id, DRAM_LATENCY, req->type, cycle_count - req->mem_queue_cycle);
 
   /* Crossing frequency domain boundary between the chip and memory controller */
   req->rdy_cycle = freq_cycle_count(FREQ_DOMAIN_L1) + 1;
+  if (NOC_TOPOLOGY != NOC_TOPOLOGY_NONE && !CONSTANT_MEMORY_LATENCY)
+    req->rdy_cycle = noc_send(req->proc_id, noc_mc_node(req->addr), noc_l1_node(L1_SLICE(req->addr)), noc_data_flits(),
+                              req->rdy_cycle + req->noc_mem_cycles);
 
   req->queue = &(mem->l1fill_queue);
 
@@ -2160,7 +2637,7 @@ void mem_complete_bus_in_access(Mem_Req* req, Counter priority) {
 
   l1fill_seq_num++;
   ASSERT(req->proc_id, mem->uncores[req->proc_id].num_outstanding_l1_misses > 0);
-  mem->uncores[req->proc_id].num_outstanding_l1_misses--;
+  mem_add_outstanding_l1_misses(req->proc_id, -1);
 
   if (!CONSTANT_MEMORY_LATENCY && !PERF_PRED_REQS_FINISH_AT_FILL)
     perf_pred_mem_req_done(req);
@@ -2189,13 +2666,13 @@ static void remove_from_l1_fill_queue(uns proc_id, int* p_l1fill_queue_removal_c
     /* After this sort requests that should be removed will be at the tail of
      * the l1_queue */
     DEBUG(0, "l1fill_queue removal\n");
-    qsort(mem->l1fill_queue.base, mem->l1fill_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
-    mem->l1fill_queue.entry_count -= *p_l1fill_queue_removal_count;
+    mem_queue_sort(&mem->l1fill_queue);
+    mem_queue_remove_tail(&mem->l1fill_queue, *p_l1fill_queue_removal_count);
     ASSERT(proc_id, mem->l1fill_queue.entry_count >= 0);
     /* free corresponding reserved entries in the L1 queue if HIER_MSHR_ON */
     if (HIER_MSHR_ON) {
-      mem->l1_queue.reserved_entry_count -= *p_l1fill_queue_removal_count;
-      ASSERT(0, mem->l1_queue.reserved_entry_count >= 0);
+      mem->l1_queues[0].reserved_entry_count -= *p_l1fill_queue_removal_count;
+      ASSERT(0, mem->l1_queues[0].reserved_entry_count >= 0);
     }
   }
 
@@ -2214,6 +2691,9 @@ static void mem_process_l1_fill_reqs() {
 
   /* Go thru the l1fill_queue */
 
+  if (!mem_queue_walk_begin(&mem->l1fill_queue))
+    return;
+
   for (ii = 0; ii < mem->l1fill_queue.entry_count; ii++) {
     reqbuf_id = mem->l1fill_queue.base[ii].reqbuf;
     req = &(mem->req_buffer[reqbuf_id]);
@@ -2223,8 +2703,10 @@ static void mem_process_l1_fill_reqs() {
     ASSERT(req->proc_id, req->type != MRT_WB_NODIRTY);
 
     /* if the request is not yet ready, then try the next one */
-    if (cycle_count < req->rdy_cycle)
+    if (cycle_count < req->rdy_cycle) {
+      mem_queue_walk_note(&mem->l1fill_queue, req);
       continue;
+    }
 
     if (req->state == MRS_FILL_L1) {
       DEBUG(req->proc_id,
@@ -2250,6 +2732,7 @@ static void mem_process_l1_fill_reqs() {
           perf_pred_off_chip_effect_end(req);
         }
       }
+      mem_queue_walk_note(&mem->l1fill_queue, req);
     } else if (req->state == MRS_FILL_MLC) {
       ASSERT(req->proc_id, MLC_PRESENT);
       // insert into mlc queue
@@ -2264,7 +2747,7 @@ static void mem_process_l1_fill_reqs() {
       if (HIER_MSHR_ON)
         req->reserved_entry_count -= 1;
       l1fill_queue_removal_count++;
-      mem->l1fill_queue.base[ii].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+      mem_queue_entry_set_priority(&mem->l1fill_queue.base[ii], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
     } else {
       ASSERT(req->proc_id, req->state == MRS_FILL_DONE);
       if (!req->done_func) {
@@ -2276,9 +2759,11 @@ static void mem_process_l1_fill_reqs() {
 
         // remove from l1fill queue
         l1fill_queue_removal_count++;
-        mem->l1fill_queue.base[ii].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+        mem_queue_entry_set_priority(&mem->l1fill_queue.base[ii], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
 
         remove_from_l1_fill_queue(req->proc_id, &l1fill_queue_removal_count);
+        /* the sort may have moved unvisited entries below ii */
+        mem->l1fill_queue.next_rdy_cycle = 0;
       } else {
         req->rdy_cycle = freq_cycle_count(FREQ_DOMAIN_CORES[req->proc_id]);  // no +1 to match old performance
         // insert into core fill queue
@@ -2291,7 +2776,7 @@ static void mem_process_l1_fill_reqs() {
         core_fill_seq_num[req->proc_id]++;
         // remove from l1fill queue
         l1fill_queue_removal_count++;
-        mem->l1fill_queue.base[ii].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+        mem_queue_entry_set_priority(&mem->l1fill_queue.base[ii], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
       }
     }
   }
@@ -2312,6 +2797,9 @@ static void mem_process_mlc_fill_reqs() {
 
   /* Go thru the mlc_fill_queue */
 
+  if (!mem_queue_walk_begin(&mem->mlc_fill_queue))
+    return;
+
   for (ii = 0; ii < mem->mlc_fill_queue.entry_count; ii++) {
     reqbuf_id = mem->mlc_fill_queue.base[ii].reqbuf;
     req = &(mem->req_buffer[reqbuf_id]);
@@ -2322,8 +2810,10 @@ static void mem_process_mlc_fill_reqs() {
     ASSERT(req->proc_id, req->destination < DEST_L1);
 
     /* if the request is not yet ready, then try the next one */
-    if (cycle_count < req->rdy_cycle)
+    if (cycle_count < req->rdy_cycle) {
+      mem_queue_walk_note(&mem->mlc_fill_queue, req);
       continue;
+    }
 
     if (req->state == MRS_FILL_MLC) {
       DEBUG(req->proc_id,
@@ -2335,6 +2825,7 @@ static void mem_process_mlc_fill_reqs() {
         req->state = MRS_FILL_DONE;
         req->rdy_cycle = cycle_count + 1;
       }
+      mem_queue_walk_note(&mem->mlc_fill_queue, req);
     } else {
       ASSERT(req->proc_id, req->state == MRS_FILL_DONE);
       if (!req->done_func || req->done_func(req)) {
@@ -2346,7 +2837,9 @@ static void mem_process_mlc_fill_reqs() {
 
         // remove from mlc_fill queue - how do we handle this now?
         mlc_fill_queue_removal_count++;
-        mem->mlc_fill_queue.base[ii].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+        mem_queue_entry_set_priority(&mem->mlc_fill_queue.base[ii], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
+      } else {
+        mem_queue_walk_note(&mem->mlc_fill_queue, req);
       }
     }
   }
@@ -2356,8 +2849,8 @@ static void mem_process_mlc_fill_reqs() {
     /* After this sort requests that should be removed will be at the tail of
      * the mlc_queue */
     DEBUG(0, "mlc_fill_queue removal\n");
-    qsort(mem->mlc_fill_queue.base, mem->mlc_fill_queue.entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
-    mem->mlc_fill_queue.entry_count -= mlc_fill_queue_removal_count;
+    mem_queue_sort(&mem->mlc_fill_queue);
+    mem_queue_remove_tail(&mem->mlc_fill_queue, mlc_fill_queue_removal_count);
     ASSERT(req->proc_id, mem->mlc_fill_queue.entry_count >= 0);
     /* free corresponding reserved entries in the MLC queue if HIER_MSHR_ON */
     if (HIER_MSHR_ON) {
@@ -2398,7 +2891,7 @@ static void mem_process_core_fill_reqs(uns proc_id) {
 
       // remove from core fill queue
       core_fill_queue_removal_count++;
-      core_fill_queue->base[ii].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+      mem_queue_entry_set_priority(&core_fill_queue->base[ii], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
     }
   }
 
@@ -2407,25 +2900,130 @@ static void mem_process_core_fill_reqs(uns proc_id) {
     /* After this sort requests that should be removed will be at the tail of
      * the core_fill_queue */
     DEBUG(0, "core_fill_queue removal\n");
-    qsort(core_fill_queue->base, core_fill_queue->entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
-    core_fill_queue->entry_count -= core_fill_queue_removal_count;
+    mem_queue_sort(core_fill_queue);
+    mem_queue_remove_tail(core_fill_queue, core_fill_queue_removal_count);
     ASSERT(req->proc_id, core_fill_queue->entry_count >= 0);
   }
 }
 
 /**************************************************************************************/
-/* scan_stores: */
+/* init_mem_store_index: */
 
-Flag scan_stores(Addr addr, uns size) {
+static void init_mem_store_index(void) {
+  uns num_chains = 1;
+  while (num_chains < 2 * mem->total_mem_req_buffers)
+    num_chains <<= 1;
+
+  mem->store_index = (Mem_Store_Index*)calloc(NUM_CORES, sizeof(Mem_Store_Index));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    mem->store_index[proc_id].heads = (int*)malloc(sizeof(int) * num_chains);
+    mem->store_index[proc_id].mask = num_chains - 1;
+  }
+  mem->store_nodes = (Mem_Store_Index_Node*)malloc(sizeof(Mem_Store_Index_Node) * mem->total_mem_req_buffers);
+  mem_store_index_clear();
+}
+
+/**************************************************************************************/
+/* mem_store_index_clear: */
+
+static void mem_store_index_clear(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Mem_Store_Index* index = &mem->store_index[proc_id];
+    for (uns ii = 0; ii <= index->mask; ii++)
+      index->heads[ii] = -1;
+    index->num_sizes = 0;
+  }
+  for (uns ii = 0; ii < mem->total_mem_req_buffers; ii++)
+    mem->store_nodes[ii].size = 0;
+}
+
+/**************************************************************************************/
+/* mem_store_index_hash: */
+
+static inline uns mem_store_index_hash(Mem_Store_Index* index, Addr block, uns size) {
+  uns64 hash = (block ^ size) * 0x9e3779b97f4a7c15ULL;
+  return (uns)(hash ^ (hash >> 32)) & index->mask;
+}
+
+/**************************************************************************************/
+/* mem_store_index_sync: index req if it is a valid store and drop it
+   otherwise; called wherever a reqbuf changes state, type or address */
+
+static inline void mem_store_index_sync(Mem_Req* req) {
+  Mem_Store_Index_Node* node = &mem->store_nodes[req->id];
+  Flag is_store = req->state != MRS_INV && req->type == MRT_DSTORE;
   uns ii;
 
-  for (ii = 0; ii < mem->total_mem_req_buffers; ii++) {
-    Mem_Req* req = &mem->req_buffer[ii];
-    if (req->state != MRS_INV && req->type == MRT_DSTORE && BYTE_CONTAIN(req->addr, req->size, addr, size)) {
-      uns load_proc_id = get_proc_id_from_cmp_addr(addr);
-      ASSERTM(req->proc_id, req->proc_id == load_proc_id, "Load from %d matched a store from %d!\n", load_proc_id,
-              req->proc_id);
-      return SUCCESS;
+  if (node->size) {
+    if (is_store && node->proc_id == req->proc_id && node->size == req->size &&
+        node->block == req->addr / req->size * req->size)
+      return;
+
+    /* unlink the reqbuf from its chain */
+    Mem_Store_Index* index = &mem->store_index[node->proc_id];
+    int* link = &index->heads[mem_store_index_hash(index, node->block, node->size)];
+    while (*link != req->id) {
+      ASSERTM(0, *link != -1, "reqbuf %d missing from the store index\n", req->id);
+      link = &mem->store_nodes[*link].next;
+    }
+    *link = node->next;
+
+    for (ii = 0; ii < index->num_sizes; ii++) {
+      if (index->sizes[ii] == node->size)
+        break;
+    }
+    ASSERT(0, ii < index->num_sizes && index->size_counts[ii] > 0);
+    if (--index->size_counts[ii] == 0) {
+      index->num_sizes--;
+      index->sizes[ii] = index->sizes[index->num_sizes];
+      index->size_counts[ii] = index->size_counts[index->num_sizes];
+    }
+    node->size = 0;
+  }
+
+  if (is_store && req->size) {
+    Mem_Store_Index* index = &mem->store_index[req->proc_id];
+    node->block = req->addr / req->size * req->size;
+    node->size = req->size;
+    node->proc_id = req->proc_id;
+    int* head = &index->heads[mem_store_index_hash(index, node->block, node->size)];
+    node->next = *head;
+    *head = req->id;
+
+    for (ii = 0; ii < index->num_sizes; ii++) {
+      if (index->sizes[ii] == node->size)
+        break;
+    }
+    if (ii == index->num_sizes) {
+      ASSERTM(req->proc_id, ii < MEM_STORE_INDEX_MAX_SIZES, "Too many distinct store sizes\n");
+      index->sizes[ii] = node->size;
+      index->size_counts[ii] = 0;
+      index->num_sizes++;
+    }
+    index->size_counts[ii]++;
+  }
+}
+
+/**************************************************************************************/
+/* scan_stores: is the load contained in an outstanding store of its core? */
+
+Flag scan_stores(Addr addr, uns size) {
+  uns load_proc_id = get_proc_id_from_cmp_addr(addr);
+  Mem_Store_Index* index = &mem->store_index[load_proc_id];
+
+  for (uns ii = 0; ii < index->num_sizes; ii++) {
+    uns store_size = index->sizes[ii];
+    Addr block = addr / store_size * store_size;
+    /* a store containing the load starts in the load's block or, if it is
+       unaligned, in the block before */
+    for (uns back = 0; back < 2; back++, block -= store_size) {
+      int id = index->heads[mem_store_index_hash(index, block, store_size)];
+      for (; id != -1; id = mem->store_nodes[id].next) {
+        Mem_Req* req = &mem->req_buffer[id];
+        if (mem->store_nodes[id].block == block && mem->store_nodes[id].size == store_size &&
+            BYTE_CONTAIN(req->addr, req->size, addr, size))
+          return SUCCESS;
+      }
     }
   }
   return FAILURE;
@@ -2454,8 +3052,23 @@ static inline Mem_Req* mem_search_queue(
 
   // CMP ignore "size" from argument
 
-  for (ii = 0; ii < queue->entry_count; ii++) {
+  /* The line index narrows the search to the reqbufs that can address-match;
+     the queue is still walked in order so the first match is unchanged. */
+  int num_candidates = mem_queue_index_lookup(queue, addr);
+  if (num_candidates == 0)
+    return NULL;
+
+  for (ii = 0; ii < queue->entry_count && num_candidates > 0; ii++) {
     used_reqbuf_id = queue->base[ii].reqbuf;
+    int jj;
+    for (jj = 0; jj < num_candidates; jj++) {
+      if (queue->index.candidates[jj] == used_reqbuf_id)
+        break;
+    }
+    if (jj == num_candidates)
+      continue;
+    queue->index.candidates[jj] = queue->index.candidates[--num_candidates];
+
     req = &mem->req_buffer[used_reqbuf_id];
     dest_addr = CACHE_SIZE_ADDR(req->size, req->addr);
     src_addr = CACHE_SIZE_ADDR(req->size, addr);
@@ -2626,7 +3239,7 @@ static inline Mem_Req* mem_search_reqbuf(
   }
 
   if (queues_to_search & QUEUE_L1) {
-    req = mem_search_queue(&mem->l1_queue, proc_id, addr, type, size, demand_hit_prefetch, demand_hit_writeback,
+    req = mem_search_queue(L1_QUEUE(addr), proc_id, addr, type, size, demand_hit_prefetch, demand_hit_writeback,
                            queue_entry, TRUE);
     if (req)
       return req;
@@ -2719,9 +3332,9 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
     ASSERT(req->proc_id, req->type != MRT_WB && req->type != MRT_WB_NODIRTY);
 
     req->op_count++;
-    op_ptr = sl_list_add_tail(&req->op_ptrs);
+    op_ptr = ring_add_tail(&req->op_ptrs);
     *op_ptr = op;
-    op_unique = sl_list_add_tail(&req->op_uniques);
+    op_unique = ring_add_tail(&req->op_uniques);
     *op_unique = op->unique_num;
 
     if (op->table_info->mem_type == MEM_ST && !op->off_path)
@@ -2749,16 +3362,16 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
 
     if (!req->done_func)
       req->done_func = done_func;
+    Flag was_l1_miss_pending = l1_miss_pending(op);
     if (req->mlc_miss)
       op->engine_info.mlc_miss = TRUE;
-    if (req->l1_miss) {
+    if (req->l1_miss)
       op->engine_info.l1_miss = TRUE;
-      if (TRACK_L1_MISS_DEPS)
-        mark_l1_miss_deps(op);
-    }
 
     op->engine_info.mlc_miss_satisfied = req->mlc_miss_satisfied ? TRUE : op->engine_info.mlc_miss_satisfied;
     op->engine_info.l1_miss_satisfied = req->l1_miss_satisfied ? TRUE : op->engine_info.l1_miss_satisfied;
+    if (TRACK_L1_MISS_DEPS)
+      update_l1_miss_deps(op, was_l1_miss_pending);
 
     // cmp FIXME prefetchers
     if (demand_hit_prefetch && type != MRT_DPRF && type != MRT_IPRF) {
@@ -2775,6 +3388,7 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
       pref_ul1_pref_hit_late(req->proc_id, req->addr, req->loadPC, req->global_hist, req->prefetcher_id);
       req->demand_match_prefetch = TRUE;
       req->type = type;  // type promotion
+      mem_store_index_sync(req);
       req->done_func = done_func;
       // if (DRAM_SCHED == DRAM_SCHED_FAIR_QUEUING_2LEVEL) {
       //    req->fq_start_time = MAX_CTR;
@@ -2791,8 +3405,8 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
                                        l1fill requests? */
       req->priority = new_priority; /* Change the priority of req */
       if (!ramulator_match)
-        (*queue_entry)->priority = new_priority; /* Change the priority in the
-                               queue entry */
+        /* Change the priority in the queue entry */
+        mem_queue_entry_set_priority(*queue_entry, new_priority);
       if (PROMOTE_TO_HIGHER_PRIORITY_MEM_REQ_TYPE && Mem_Req_Priority[type] < Mem_Req_Priority[req->type]) {
         if (req->type == MRT_FDIPPRFOFF && type == MRT_FDIPPRFON)
           STAT_EVENT(req->proc_id, PROMOTION_FROM_FDIP_OFF_TO_ON);
@@ -2800,11 +3414,16 @@ Flag mem_adjust_matching_request(Mem_Req* req, Mem_Req_Type type, Addr addr, uns
            only looks at type priority). This may lead to a
            bit of inaccuracy, but quick_release perf diff is
            minimal. */
+        Flag was_prefetch = mem_req_type_is_prefetch(req->type);
         req->type = type;
+        mem_store_index_sync(req);
         memview_req_changed_type(req);
+        if (!ramulator_match && !was_prefetch && mem_req_type_is_prefetch(type))
+          mem_queue_prefetch_insert(req->queue, *queue_entry);
       }
-      qsort(req->queue->base, req->queue->entry_count, sizeof(Mem_Queue_Entry),
-            mem_compare_priority); /* Sort the associated queue */
+      /* the line index holds reqbuf ids, so neither the type promotion
+         above nor this resort touches it */
+      mem_queue_sort(req->queue); /* Sort the associated queue */
     }
 
     switch (req->queue->type) {
@@ -2943,7 +3562,7 @@ Flag mem_can_allocate_req_buffer(uns proc_id, Mem_Req_Type type, Flag for_l1_wri
   }
 
   if (mem->req_count == mem->total_mem_req_buffers) {
-    ASSERT(0, sl_list_remove_head(&mem->req_buffer_free_list) == 0);
+    ASSERT(0, ring_remove_head(&mem->req_buffer_free_list) == 0);
     return FALSE;
   }
 
@@ -2958,7 +3577,7 @@ static inline Mem_Req* mem_allocate_req_buffer(uns proc_id, Mem_Req_Type type, F
   if (!mem_can_allocate_req_buffer(proc_id, type, for_l1_writeback))
     return FALSE;
 
-  int* reqbuf_num_ptr = sl_list_remove_head(&mem->req_buffer_free_list);
+  int* reqbuf_num_ptr = ring_remove_head(&mem->req_buffer_free_list);
 
   ASSERT(0, reqbuf_num_ptr);
   ASSERT(0, mem->req_buffer[*reqbuf_num_ptr].state == MRS_INV);
@@ -2983,56 +3602,24 @@ static Mem_Req* mem_kick_out_prefetch_from_queue(uns mem_bank, Mem_Queue* queue,
   if (queue->entry_count == 0)
     return NULL;
 
-  qsort(queue->base, queue->entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
+  mem_queue_sort(queue);
 
   if (KICKOUT_OLDEST_PREFETCH) {
-    int ii, oldest_index = 0;
+    int ii, oldest_reqbuf = mem_queue_prefetch_victim(queue, mem_bank);
     Mem_Req* req_kicked_out = NULL;
-    Counter oldest_req_age = MAX_CTR;
-
-    if (KICKOUT_OLDEST_PREFETCH_WITHIN_BANK) {
-      for (ii = 0; ii < queue->entry_count; ii++) {
-        Mem_Req* req = &(mem->req_buffer[queue->base[ii].reqbuf]);
-        if (req->type != MRT_IPRF && req->type != MRT_DPRF && req->type != MRT_UOCPRF && req->type != MRT_FDIPPRFON &&
-            req->type != MRT_FDIPPRFOFF)
-          continue;
-        if (oldest_req_age > req->start_cycle && mem_bank == req->mem_flat_bank) {
-          if (req->state < MRS_MEM_WAIT) {
-            oldest_req_age = req->start_cycle;
-            req_kicked_out = req;
-            oldest_index = ii;
-          }
-        }
-      }
-    }
-
-    if (!req_kicked_out) {
-      oldest_req_age = MAX_CTR;
-      // Search for the oldest prefetch
-      for (ii = 0; ii < queue->entry_count; ii++) {
-        Mem_Req* req = &(mem->req_buffer[queue->base[ii].reqbuf]);
-        if (req->type != MRT_IPRF && req->type != MRT_DPRF && req->type != MRT_UOCPRF && req->type != MRT_FDIPPRFON &&
-            req->type != MRT_FDIPPRFOFF)
-          continue;
-        if (oldest_req_age > req->start_cycle) {
-          if (req->state < MRS_MEM_WAIT) {
-            oldest_req_age = req->start_cycle;
-            req_kicked_out = req;
-            oldest_index = ii;
-          }
-        }
-      }
-    }
 
     // If the oldest prefetch found
-    if (req_kicked_out) {
+    if (oldest_reqbuf != -1) {
+      req_kicked_out = &mem->req_buffer[oldest_reqbuf];
+      for (ii = 0; queue->base[ii].reqbuf != oldest_reqbuf; ii++)
+        ASSERT(0, ii + 1 < queue->entry_count);
       ASSERT(0, req_kicked_out->priority > new_priority);
       STAT_EVENT(req_kicked_out->proc_id, ONPATH_KICKED_OUT_PREFETCH);
-      queue->base[oldest_index].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
+      mem_queue_entry_set_priority(&queue->base[ii], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
       DEBUG(0, "%s removal\n", queue->name);
-      qsort(queue->base, queue->entry_count, sizeof(Mem_Queue_Entry), mem_compare_priority);
-      queue->entry_count--;
-      pref_req_drop_process(req_kicked_out->proc_id, mem->req_buffer[queue->base[oldest_index].reqbuf].prefetcher_id);
+      mem_queue_sort(queue);
+      mem_queue_remove_tail(queue, 1);
+      pref_req_drop_process(req_kicked_out->proc_id, req_kicked_out->prefetcher_id);
     }
 
     return req_kicked_out;
@@ -3047,8 +3634,8 @@ static Mem_Req* mem_kick_out_prefetch_from_queue(uns mem_bank, Mem_Queue* queue,
       }
       ASSERT(0, mem->req_buffer[kickout_reqbuf_num].priority > new_priority);
       STAT_EVENT(mem->req_buffer[kickout_reqbuf_num].proc_id, ONPATH_KICKED_OUT_PREFETCH);
-      queue->base[queue->entry_count - 1].priority = Mem_Req_Priority_Offset[MRT_MIN_PRIORITY];
-      queue->entry_count--;
+      mem_queue_entry_set_priority(&queue->base[queue->entry_count - 1], Mem_Req_Priority_Offset[MRT_MIN_PRIORITY]);
+      mem_queue_remove_tail(queue, 1);
       pref_req_drop_process(mem->req_buffer[kickout_reqbuf_num].proc_id,
                             mem->req_buffer[kickout_reqbuf_num].prefetcher_id);
       return &(mem->req_buffer[kickout_reqbuf_num]);
@@ -3065,9 +3652,11 @@ static Mem_Req* mem_kick_out_prefetch_from_queues(uns mem_bank, Counter new_prio
   Mem_Req* req;
 
   if (queues_to_search & QUEUE_L1) {
-    req = mem_kick_out_prefetch_from_queue(mem_bank, &mem->l1_queue, new_priority);
-    if (req)
-      return req;
+    for (uns ii = 0; ii < L1_SLICES; ii++) {
+      req = mem_kick_out_prefetch_from_queue(mem_bank, &mem->l1_queues[ii], new_priority);
+      if (req)
+        return req;
+    }
   }
 
   if (queues_to_search & QUEUE_BUS_OUT) {
@@ -3122,9 +3711,11 @@ static Mem_Req* mem_kick_out_oldest_first_prefetch_from_queues(uns mem_bank, Cou
   }
 
   if (queues_to_search & QUEUE_L1) {
-    req = mem_kick_out_prefetch_from_queue(mem_bank, &mem->l1_queue, new_priority);
-    if (req)
-      return req;
+    for (uns ii = 0; ii < L1_SLICES; ii++) {
+      req = mem_kick_out_prefetch_from_queue(mem_bank, &mem->l1_queues[ii], new_priority);
+      if (req)
+        return req;
+    }
   }
 
   return NULL;
@@ -3152,6 +3743,7 @@ static void mem_init_new_req(Mem_Req* new_req, Mem_Req_Type type, Mem_Queue_Type
   } else {
     mem_clear_reqbuf(new_req);
   }
+  mem->event_count++;
 
   new_req->off_path = op ? op->off_path : FALSE;
   new_req->off_path_confirmed = FALSE;
@@ -3171,7 +3763,7 @@ static void mem_init_new_req(Mem_Req* new_req, Mem_Req_Type type, Mem_Queue_Type
     new_req->fdip_emitted_cycle = 0;
   }
   mem_req_set_types(new_req, type);
-  new_req->queue = to_mlc ? &mem->mlc_queue : &mem->l1_queue;
+  new_req->queue = to_mlc ? &mem->mlc_queue : L1_QUEUE(addr);
   new_req->proc_id = proc_id;
   new_req->addr = addr;
   new_req->phys_addr = addr_translate(addr);
@@ -3192,9 +3784,11 @@ static void mem_init_new_req(Mem_Req* new_req, Mem_Req_Type type, Mem_Queue_Type
   new_req->mem_bank = BANK_IN_CHANNEL(new_req->mem_flat_bank, RAMULATOR_BANKS);
   */
   new_req->mlc_bank = BANK(addr, MLC(proc_id)->num_banks, MLC_INTERLEAVE_FACTOR);
-  new_req->l1_bank = BANK(addr, L1(proc_id)->num_banks, L1_INTERLEAVE_FACTOR);
+  /* the slice bits are the lowest line address bits, so the banks of a slice interleave above them */
+  new_req->l1_bank = BANK(addr >> LOG2(L1_SLICES), L1_OF(proc_id, addr)->num_banks, L1_INTERLEAVE_FACTOR);
   new_req->start_cycle = freq_cycle_count(FREQ_DOMAIN_L1) + delay;
   new_req->rdy_cycle = freq_cycle_count(FREQ_DOMAIN_L1) + delay;
+  new_req->noc_mem_cycles = 0;
   new_req->first_stalling_cycle = mem_req_type_is_stalling(type) ? new_req->start_cycle : MAX_CTR;
   new_req->op_count = 0;
   new_req->req_count = 1;
@@ -3231,8 +3825,8 @@ static void mem_init_new_req(Mem_Req* new_req, Mem_Req_Type type, Mem_Queue_Type
   if (op) {
     ASSERT(new_req->proc_id, new_req->proc_id == op->proc_id);
 
-    Op** op_ptr = sl_list_add_tail(&new_req->op_ptrs);
-    Counter* op_unique = sl_list_add_tail(&new_req->op_uniques);
+    Op** op_ptr = ring_add_tail(&new_req->op_ptrs);
+    Counter* op_unique = ring_add_tail(&new_req->op_uniques);
     *op_ptr = op;
     *op_unique = op->unique_num;
     new_req->op_count++;
@@ -3278,6 +3872,9 @@ static void mem_init_new_req(Mem_Req* new_req, Mem_Req_Type type, Mem_Queue_Type
     check_and_remove_addr_sign_extended_bits(addr, NUM_ADDR_NON_SIGN_EXTEND_BITS, TRUE);
   }
 
+  // a kicked out prefetch reuses its buffer without freeing it
+  mem_store_index_sync(new_req);
+
   DEBUG(new_req->proc_id, "New mem request is initiated index:%ld type:%s addr:0x%s state:%s\n",
         (long int)(new_req - mem->req_buffer), Mem_Req_Type_str(new_req->type), hexstr64s(new_req->addr),
         mem_req_state_names[new_req->state]);
@@ -3298,16 +3895,27 @@ static inline Mem_Queue_Entry* mem_insert_req_into_queue(Mem_Req* new_req, Mem_Q
           "name:%s  count:%d  size:%d  reserved:%d  reqbuf:%d  rc:%d l1:%d "
           "bo:%d lf:%d rf:%d\n",
           queue->name, queue->entry_count, queue->size, queue->reserved_entry_count, new_req->id, mem->req_count,
-          mem->l1_queue.entry_count, mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count,
+          l1_queue_entry_count(), mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count,
           mem->req_buffer_free_list.count);
 
   Mem_Queue_Entry* new_entry = &queue->base[queue->entry_count];
   new_entry->reqbuf = new_req->id;
   new_entry->priority = priority > 0 ? priority : new_req->priority;
+  new_entry->line_addr = CACHE_SIZE_ADDR(new_req->size, new_req->addr);
+  new_entry->line_size = new_req->size;
+  new_entry->seq = queue->next_seq++;
+  new_entry->resort = FALSE;
+  new_entry->insert_cycle = freq_cycle_count(FREQ_DOMAIN_L1);
+  mem_queue_index_insert(queue, new_entry);
+  queue->entry_seqs[new_req->id] = new_entry->seq;
+  if (mem_req_type_is_prefetch(new_req->type))
+    mem_queue_prefetch_insert(queue, new_entry);
   queue->entry_count++;
+  queue->next_rdy_cycle = 0;
+  mem->event_count++;
 
   DEBUG(new_req->proc_id, "Inserted into %s index:%d pri:%s rc:%d l1:%d bo:%d lf:%d\n", queue->name, new_req->id,
-        unsstr64(priority > 0 ? priority : new_req->priority), mem->req_count, mem->l1_queue.entry_count,
+        unsstr64(priority > 0 ? priority : new_req->priority), mem->req_count, l1_queue_entry_count(),
         mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count);
   return new_entry;
 }
@@ -3316,12 +3924,12 @@ static inline Mem_Queue_Entry* mem_insert_req_into_queue(Mem_Req* new_req, Mem_Q
 /* mem_insert_req_round_robin: */
 void mem_insert_req_round_robin() {
   ASSERT(0, ROUND_ROBIN_TO_L1);
-  uns8 proc_id;
+  uns proc_id;
   Mem_Req** req_ptr;
 
   while (l1_in_buf_count) {
     for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-      req_ptr = sl_list_remove_head(&mem->l1_in_buffer_core[proc_id]);
+      req_ptr = ring_remove_head(&mem->l1_in_buffer_core[proc_id]);
       if (req_ptr) {
         (*req_ptr)->priority =
             ((*req_ptr)->type == MRT_DPRF || (*req_ptr)->type == MRT_IPRF) ? (*req_ptr)->priority : order_num;
@@ -3347,6 +3955,17 @@ void mem_insert_req_round_robin() {
 Flag new_mem_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay, Op* op, Flag done_func(Mem_Req*),
                  Counter unique_num, /* This counter is used when op is NULL */
                  Pref_Req_Info* pref_info) {
+  Flag accepted = new_mem_req_impl(type, proc_id, addr, size, delay, op, done_func, unique_num, pref_info);
+  /* only the requests of the cores are recorded, the uncore prefetchers regenerate their own */
+  if (MEM_RECORD_FILE && accepted && !mem_in_pref_update)
+    mem_record_req(type, proc_id, addr, size, delay, FALSE, FALSE);
+  if (BOGUS_REPLAY && accepted && !mem_in_pref_update && !sim_done[proc_id])
+    bogus_replay_record(type, proc_id, addr, size, delay, FALSE, FALSE);
+  return accepted;
+}
+
+static Flag new_mem_req_impl(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay, Op* op,
+                             Flag done_func(Mem_Req*), Counter unique_num, Pref_Req_Info* pref_info) {
   Mem_Req* new_req = NULL;
   Mem_Req* matching_req = NULL;
   Mem_Queue_Entry* queue_entry = NULL;
@@ -3445,8 +4064,8 @@ Flag new_mem_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay
       return FALSE;
     }
   } else {
-    if (queue_full(&mem->l1_queue) ||
-        ((type == MRT_IPRF || type == MRT_DPRF) && queue_num_free(&mem->l1_queue) <= MEM_REQ_BUFFER_PREF_WATERMARK)) {
+    if (queue_full(L1_QUEUE(addr)) ||
+        ((type == MRT_IPRF || type == MRT_DPRF) && queue_num_free(L1_QUEUE(addr)) <= MEM_REQ_BUFFER_PREF_WATERMARK)) {
       STAT_EVENT(proc_id, REJECTED_QUEUE_L1);
       return FALSE;
     }
@@ -3484,7 +4103,7 @@ Flag new_mem_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay
       DEBUG(proc_id,
             "Request denied in mem buffer  addr:%s rc:%d mlc:%d l1:%d bo:%d "
             "lf:%d mf:%d rf:%d\n",
-            hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, mem->l1_queue.entry_count,
+            hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, l1_queue_entry_count(),
             mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, mem->mlc_fill_queue.entry_count,
             mem->req_buffer_free_list.count);
       STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
@@ -3513,7 +4132,7 @@ Flag new_mem_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay
       Addr line_addr;
 
       ASSERTM(0, ADDR_TRANSLATION == ADDR_TRANS_NONE, "PREF_ORACLE_TRAIN_ON && ADDR_TRANSLATION not supported\n");
-      data = (L1_Data*)cache_access(&L1(proc_id)->cache, addr, &line_addr, FALSE);
+      data = (L1_Data*)cache_access(&L1_OF(proc_id, addr)->cache, addr, &line_addr, FALSE);
 
       if (data) {
         pref_ul1_hit(proc_id, addr, (op ? op->inst_info->addr : 0), (op ? op->oracle_info.pred_global_hist : 0));
@@ -3583,7 +4202,7 @@ Flag new_mem_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay
 
 static Flag insert_new_req_into_l1_queue(uns proc_id, Mem_Req* new_req) {
   if (!ROUND_ROBIN_TO_L1) {
-    if (queue_full(&mem->l1_queue)) {
+    if (queue_full(new_req->queue)) {
       ASSERT(proc_id, 0);
     }
     mem_insert_req_into_queue(new_req, new_req->queue, ALL_FIFO_QUEUES ? l1_seq_num : 0);
@@ -3591,7 +4210,7 @@ static Flag insert_new_req_into_l1_queue(uns proc_id, Mem_Req* new_req) {
     l1_seq_num++;
   } else {
     ASSERT(proc_id, 0);
-    Mem_Req** req_ptr = sl_list_add_tail(&mem->l1_in_buffer_core[proc_id]);
+    Mem_Req** req_ptr = ring_add_tail(&mem->l1_in_buffer_core[proc_id]);
     *req_ptr = new_req;
     l1_in_buf_count++;
   }
@@ -3617,6 +4236,16 @@ static Flag insert_new_req_into_mlc_queue(uns proc_id, Mem_Req* new_req) {
 
 Flag new_mem_dc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay, Op* op,
                        Flag done_func(Mem_Req*), Counter unique_num, Flag used_onpath) {
+  Flag accepted = new_mem_dc_wb_req_impl(type, proc_id, addr, size, delay, op, done_func, unique_num, used_onpath);
+  if (MEM_RECORD_FILE && accepted)
+    mem_record_req(type, proc_id, addr, size, delay, TRUE, used_onpath);
+  if (BOGUS_REPLAY && accepted && !sim_done[proc_id])
+    bogus_replay_record(type, proc_id, addr, size, delay, TRUE, used_onpath);
+  return accepted;
+}
+
+static Flag new_mem_dc_wb_req_impl(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns delay, Op* op,
+                                   Flag done_func(Mem_Req*), Counter unique_num, Flag used_onpath) {
   Mem_Req* new_req = NULL;
   Mem_Req* matching_req = NULL;
   Mem_Queue_Entry* queue_entry = NULL;
@@ -3661,7 +4290,7 @@ Flag new_mem_dc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns
       return FALSE;
     }
   } else {
-    if (queue_full(&mem->l1_queue)) {
+    if (queue_full(L1_QUEUE(addr))) {
       STAT_EVENT(proc_id, REJECTED_QUEUE_L1);
       return FALSE;
     }
@@ -3679,7 +4308,7 @@ Flag new_mem_dc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns size, uns
     DEBUG(proc_id,
           "Request denied in mem buffer  addr:%s rc:%d mlc:%d l1:%d bo:%d "
           "lf:%d mf:%d rf:%d\n",
-          hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, mem->l1_queue.entry_count,
+          hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, l1_queue_entry_count(),
           mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, mem->mlc_fill_queue.entry_count,
           mem->req_buffer_free_list.count);
     STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
@@ -3747,7 +4376,7 @@ static Flag new_mem_mlc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns s
   }
 
   /* Step 2.5: Check if there is space in the L1 queue */
-  if (queue_full(&mem->l1_queue)) {
+  if (queue_full(L1_QUEUE(addr))) {
     STAT_EVENT(proc_id, REJECTED_QUEUE_L1);
     return FALSE;
   }
@@ -3763,7 +4392,7 @@ static Flag new_mem_mlc_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns s
     DEBUG(proc_id,
           "Request denied in mem buffer  addr:%s rc:%d mlc:%d l1:%d bo:%d "
           "lf:%d mf:%d rf:%d\n",
-          hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, mem->l1_queue.entry_count,
+          hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, l1_queue_entry_count(),
           mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, mem->mlc_fill_queue.entry_count,
           mem->req_buffer_free_list.count);
     STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
@@ -3835,9 +4464,10 @@ static Flag new_mem_l1_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns si
                                         ramulator_match));
   }
 
-  // TODO: obsolete now that we don't have a bus_out queue after Ramulator integration
-  /* Step 2.5: Check if there is space in the bus_out queue */
-  if (queue_full(&mem->bus_out_queue)) {
+  /* Step 2.5: Check if the Ramulator write queue has room, before building a
+   * request it would reject. MEMORY_RANDOM_ADDR picks the address when the
+   * request is built */
+  if (!MEMORY_RANDOM_ADDR && !ramulator_has_room(addr_translate(addr), TRUE)) {
     STAT_EVENT(proc_id, REJECTED_QUEUE_BUS_OUT);
     return FALSE;
   }
@@ -3876,7 +4506,7 @@ static Flag new_mem_l1_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns si
       DEBUG(proc_id,
             "Request denied in mem buffer  addr:%s rc:%d mlc:%d l1:%d bo:%d "
             "lf:%d mf:%d rf:%d\n",
-            hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, mem->l1_queue.entry_count,
+            hexstr64s(addr), mem->req_count, mem->mlc_queue.entry_count, l1_queue_entry_count(),
             mem->bus_out_queue.entry_count, mem->l1fill_queue.entry_count, mem->mlc_fill_queue.entry_count,
             mem->req_buffer_free_list.count);
       STAT_EVENT(proc_id, MEM_REQ_BUFFER_FULL);
@@ -3917,7 +4547,7 @@ static Flag new_mem_l1_wb_req(Mem_Req_Type type, uns8 proc_id, Addr addr, uns si
       mem_free_reqbuf(new_req);
     }
   } else {
-    Mem_Req** req_ptr = sl_list_add_tail(&mem->l1_in_buffer_core[proc_id]);
+    Mem_Req** req_ptr = ring_add_tail(&mem->l1_in_buffer_core[proc_id]);
     *req_ptr = new_req;
     l1_in_buf_count++;
     ASSERTM(proc_id, FALSE, "Ramulator integration not complete if ROUND_ROBIN_TO_L1 is enabled");
@@ -3947,7 +4577,7 @@ Flag l1_fill_line(Mem_Req* req) {
   UNUSED(tmp_num);
 
   if (req->op_count) {
-    top = *((Op**)list_start_head_traversal(&req->op_ptrs));
+    top = RING_AT(&req->op_ptrs, Op*, 0);
     tmp_num = top->unique_num;
   }
 
@@ -3981,7 +4611,7 @@ Flag l1_fill_line(Mem_Req* req) {
      that we won't be able to insert the writeback into the
      memory system. */
   Flag repl_line_valid;
-  data = (L1_Data*)get_next_repl_line(&L1(req->proc_id)->cache, req->proc_id, req->addr, &repl_line_addr,
+  data = (L1_Data*)get_next_repl_line(&L1_OF(req->proc_id, req->addr)->cache, req->proc_id, req->addr, &repl_line_addr,
                                       &repl_line_valid);
 
   /* If we are replacing anything, check if we need to write it back */
@@ -3998,6 +4628,7 @@ Flag l1_fill_line(Mem_Req* req) {
 
     STAT_EVENT(data->proc_id, L1_DATA_EVICT);
     STAT_EVENT(data->proc_id, NORESET_L1_EVICT);
+    mem_l1_lines_changed(data->proc_id);
 
     if (data->dcache_touch)
       STAT_EVENT(data->proc_id, TOUCH_L1_REPLACE);
@@ -4131,15 +4762,17 @@ Flag l1_fill_line(Mem_Req* req) {
         STAT_EVENT(req->proc_id, PREF_REPL_MID);
       }
     }
-    data = (L1_Data*)cache_insert_replpos(&L1(req->proc_id)->cache, req->proc_id, req->addr, &line_addr,
+    data = (L1_Data*)cache_insert_replpos(&L1_OF(req->proc_id, req->addr)->cache, req->proc_id, req->addr, &line_addr,
                                           &repl_line_addr, mem->pref_replpos, TRUE);
     if (repl_line_addr && (!data->prefetch || (data->prefetch && data->seen_prefetch)))  // Prefetch kicks out demand
       pref_ul1evictOnPF(req->proc_id, repl_line_addr, data->proc_id);
   } else {
-    data = (L1_Data*)cache_insert(&L1(req->proc_id)->cache, req->proc_id, req->addr, &line_addr, &repl_line_addr);
+    data = (L1_Data*)cache_insert(&L1_OF(req->proc_id, req->addr)->cache, req->proc_id, req->addr, &line_addr,
+                                  &repl_line_addr);
   }
 
   STAT_EVENT(req->proc_id, NORESET_L1_FILL);
+  mem_l1_lines_changed(req->proc_id);
   if (mem_req_type_is_prefetch(req->type) || req->demand_match_prefetch)
     STAT_EVENT(req->proc_id, NORESET_L1_FILL_PREF);
   else
@@ -4176,7 +4809,7 @@ Flag l1_fill_line(Mem_Req* req) {
         uns set;
         Addr tag, conv_addr, dummy_addr;
 
-        l1_cache = &L1(req->proc_id)->cache;
+        l1_cache = &L1_OF(req->proc_id, req->addr)->cache;
         set = req->addr >> l1_cache->shift_bits & l1_cache->set_mask;
         if (set % 33 == 0) {
           set = set / 33;  // converting the addr
@@ -4233,6 +4866,8 @@ Flag l1_fill_line(Mem_Req* req) {
     INC_STAT_EVENT_ALL(TOTAL_DATA_MISS_LATENCY, latency);
     STAT_EVENT_ALL(TOTAL_DATA_MISS_COUNT);
   }
+  if (req->l1_miss_cycle != MAX_CTR)
+    HIST_RECORD(req->proc_id, L1_FILL_LATENCY, req->type, cycle_count - req->l1_miss_cycle);
   req->l1_miss_cycle = MAX_CTR;
 
   // cmp FIXME
@@ -4256,7 +4891,7 @@ Flag mlc_fill_line(Mem_Req* req) {
   UNUSED(tmp_num);
 
   if (req->op_count) {
-    top = *((Op**)list_start_head_traversal(&req->op_ptrs));
+    top = RING_AT(&req->op_ptrs, Op*, 0);
     tmp_num = top->unique_num;
   }
 
@@ -4449,6 +5084,7 @@ Flag mlc_fill_line(Mem_Req* req) {
   ASSERT(req->proc_id, req->mlc_miss_cycle != MAX_CTR);
   ASSERT(req->proc_id, req->mlc_miss);
 
+  HIST_RECORD(req->proc_id, MLC_FILL_LATENCY, req->type, cycle_count - req->mlc_miss_cycle);
   req->mlc_miss_cycle = MAX_CTR;
 
   return SUCCESS;
@@ -4482,6 +5118,30 @@ Flag mem_req_older_than_uniquenum(int reqbuf, Counter unique_num) {
   }
 }
 
+/**************************************************************************************/
+/* mem_l1: the L1 (or L1 slice) that holds addr for proc_id */
+
+Ported_Cache* mem_l1(uns proc_id, Addr addr) {
+  return L1_OF(proc_id, addr);
+}
+
+/**************************************************************************************/
+/* mem_l1_get_port: takes a read (or write) port of the L1 bank that serves addr this
+   cycle, for accesses that bypass the L1 queue such as prefetcher metadata */
+
+Flag mem_l1_get_port(uns proc_id, Addr addr, Flag write) {
+  Ported_Cache* l1 = L1_OF(proc_id, addr);
+  Ports* ports = &l1->ports[BANK(addr >> LOG2(L1_SLICES), l1->num_banks, L1_INTERLEAVE_FACTOR)];
+  return write ? get_write_port(ports) : get_read_port(ports);
+}
+
+/**************************************************************************************/
+/* mem_l1_slice: the L1 slice that holds addr (0 without slices) */
+
+uns mem_l1_slice(Addr addr) {
+  return L1_SLICE(addr);
+}
+
 /**************************************************************************************/
 /* do_l1_access: */
 
@@ -4489,7 +5149,7 @@ L1_Data* do_l1_access(Op* op) {
   L1_Data* hit;
   Addr line_addr;
 
-  hit = (L1_Data*)cache_access(&L1(op->proc_id)->cache, op->oracle_info.va, &line_addr, FALSE);
+  hit = (L1_Data*)cache_access(&L1_OF(op->proc_id, op->oracle_info.va)->cache, op->oracle_info.va, &line_addr, FALSE);
 
   return hit;
 }
@@ -4514,7 +5174,7 @@ L1_Data* do_l1_access_addr(Addr addr) {
   Addr line_addr;
   uns proc_id = get_proc_id_from_cmp_addr(addr);
 
-  hit = (L1_Data*)cache_access(&L1(proc_id)->cache, addr, &line_addr, FALSE);
+  hit = (L1_Data*)cache_access(&L1_OF(proc_id, addr)->cache, addr, &line_addr, FALSE);
 
   return hit;
 }
@@ -4532,27 +5192,60 @@ MLC_Data* do_mlc_access_addr(Addr addr) {
   return hit;
 }
 
+/**************************************************************************************/
+/* mem_perfect_latency: with PERFECT_FAST_PATH, whether a dcache miss of proc_id to
+   line_addr is served by a PERFECT_MLC or PERFECT_L1 level without a Mem_Req, and in
+   how many cycles. A non-perfect MLC in front of a perfect L1 is still looked up and
+   filled. Writebacks to a perfect level are dropped. */
+
+Flag mem_perfect_latency(uns proc_id, Addr line_addr, uns* latency) {
+  if (!PERFECT_FAST_PATH || COHERENCE_PROTOCOL != COHERENCE_PROTOCOL_NONE)
+    return FALSE;
+
+  if (MLC_PRESENT && PERFECT_MLC) {
+    *latency = MLC_CYCLES;
+    STAT_EVENT(proc_id, PERFECT_FAST_PATH_MLC);
+    return TRUE;
+  }
+  if (!PERFECT_L1)
+    return FALSE;
+
+  *latency = L1_CYCLES;
+  if (MLC_PRESENT) {
+    Addr mlc_line_addr, repl_line_addr;
+    Cache* mlc = &MLC(proc_id)->cache;
+    *latency += MLC_CYCLES;
+    if (cache_access(mlc, line_addr, &mlc_line_addr, TRUE)) {
+      *latency = MLC_CYCLES;
+      STAT_EVENT(proc_id, PERFECT_FAST_PATH_MLC);
+      return TRUE;
+    }
+    MLC_Data* data = (MLC_Data*)cache_insert(mlc, proc_id, line_addr, &mlc_line_addr, &repl_line_addr);
+    memset(data, 0, sizeof(MLC_Data));
+    data->proc_id = proc_id;
+    data->fetch_cycle = freq_cycle_count(FREQ_DOMAIN_L1);
+  }
+  STAT_EVENT(proc_id, PERFECT_FAST_PATH_L1);
+  return TRUE;
+}
+
 /**************************************************************************************/
 /* mark_ops_as_l1_miss: */
 
 static void mark_ops_as_l1_miss(Mem_Req* req) {
-  Op* op;
-  Op** op_p = (Op**)list_start_head_traversal(&req->op_ptrs);
-  Counter* op_unique = (Counter*)list_start_head_traversal(&req->op_uniques);
+  ASSERT(req->proc_id, req->op_ptrs.count == req->op_uniques.count);
+  for (int ii = 0; ii < req->op_ptrs.count; ii++) {
+    Op* op = RING_AT(&req->op_ptrs, Op*, ii);
 
-  for (; op_p; op_p = (Op**)list_next_element(&req->op_ptrs)) {
-    ASSERT(req->proc_id, op_unique);
-    op = *op_p;
-
-    if (op->unique_num == *op_unique && op->op_pool_valid) {
+    if (op->unique_num == RING_AT(&req->op_uniques, Counter, ii) && op->op_pool_valid) {
       ASSERT(req->proc_id, req->proc_id == op->proc_id);
       if (op->req == req) {
+        Flag was_pending = l1_miss_pending(op);
         op->engine_info.l1_miss = TRUE;
         if (TRACK_L1_MISS_DEPS)
-          mark_l1_miss_deps(op);
+          update_l1_miss_deps(op, was_pending);
       }
     }
-    op_unique = (Counter*)list_next_element(&req->op_uniques);
   }
 
   // collect stats on l1 misses during RA
@@ -4562,16 +5255,11 @@ static void mark_ops_as_l1_miss(Mem_Req* req) {
 /* mark_ops_as_l1_miss_satisfied: */
 
 void mark_ops_as_l1_miss_satisfied(Mem_Req* req) {
-  Op* op;
-  Op** op_p = (Op**)list_start_head_traversal(&req->op_ptrs);
-  Counter* op_unique = (Counter*)list_start_head_traversal(&req->op_uniques);
-
-  for (; op_p; op_p = (Op**)list_next_element(&req->op_ptrs)) {
-    ASSERT(req->proc_id, op_unique);
-
-    op = *op_p;
+  ASSERT(req->proc_id, req->op_ptrs.count == req->op_uniques.count);
+  for (int ii = 0; ii < req->op_ptrs.count; ii++) {
+    Op* op = RING_AT(&req->op_ptrs, Op*, ii);
 
-    if (op->unique_num == *op_unique && op->op_pool_valid) {
+    if (op->unique_num == RING_AT(&req->op_uniques, Counter, ii) && op->op_pool_valid) {
       ASSERTM(req->proc_id, req->proc_id == op->proc_id,
               "req addr: %llx, valid_op: %u, op_proc_id: %u op_num: %llu, "
               "offpath: %u op_type: %u, mem_type: %u\n",
@@ -4579,96 +5267,10 @@ void mark_ops_as_l1_miss_satisfied(Mem_Req* req) {
               op->table_info->mem_type);
 
       if (op->req == req) {
+        Flag was_pending = l1_miss_pending(op);
         op->engine_info.l1_miss_satisfied = TRUE;
-        if (TRACK_L1_MISS_DEPS) {
-          unmark_l1_miss_deps(op);
-        }
-      }
-    }
-
-    op_unique = (Counter*)list_next_element(&req->op_uniques);
-  }
-}
-
-/**************************************************************************************/
-/* mark_l1_miss_deps: */
-/* recursively go through the wake up lists of the op and mark ops as
- * l1_miss_dep */
-static void mark_l1_miss_deps(Op* op) {
-  Wake_Up_Entry* temp;
-
-  ASSERT(op->proc_id,
-         (op->engine_info.l1_miss && !op->engine_info.l1_miss_satisfied) || op->engine_info.dep_on_l1_miss);
-
-  for (temp = op->wake_up_head; temp; temp = temp->next) {
-    Op* dep_op = temp->op;
-    Counter dep_unique_num = temp->unique_num;
-
-    if (dep_op->unique_num == dep_unique_num && dep_op->op_pool_valid) {
-      ASSERT(op->proc_id, op->proc_id == dep_op->proc_id);
-      /*printf("MARK c: %s dep_op: %s %s %s %s op: %s %s %s %s\n",
-         unsstr64(cycle_count), unsstr64(dep_op->unique_num),
-         unsstr64(dep_op->exec_cycle), disasm_op(dep_op, TRUE),
-         unsstr64(dep_op->oracle_info.va), unsstr64(op->unique_num),
-         unsstr64(op->exec_cycle), disasm_op(op, TRUE),
-         unsstr64(op->oracle_info.va)); */
-      ASSERT(dep_op->proc_id, !dep_op->engine_info.l1_miss || dep_op->table_info->mem_type == MEM_ST);
-      if (!dep_op->engine_info.dep_on_l1_miss) {
-        dep_op->engine_info.dep_on_l1_miss = TRUE;
-        mark_l1_miss_deps(dep_op);
-      }
-    }
-  }
-}
-
-/**************************************************************************************/
-/* unmark_l1_miss_deps: */
-/* recursively go through the wake up lists of the op and unmark ops as
- * l1_miss_dep */
-
-static void unmark_l1_miss_deps(Op* op) {
-  Wake_Up_Entry* temp;
-
-  ASSERT(op->proc_id,
-         op->engine_info.l1_miss_satisfied || (!op->engine_info.dep_on_l1_miss && op->engine_info.was_dep_on_l1_miss));
-
-  /* Go thru the wake up list and unmark ops if they are not dependent on
-   * another l1 miss */
-  for (temp = op->wake_up_head; temp; temp = temp->next) {
-    Op* dep_op = temp->op;
-    Counter dep_unique_num = temp->unique_num;
-
-    if (dep_op->unique_num == dep_unique_num && dep_op->op_pool_valid) {
-      int ii;
-      Op_Info* op_info = &dep_op->oracle_info;
-      Flag still_dep_on_l1_miss = FALSE;
-
-      ASSERT(op->proc_id, op->proc_id == dep_op->proc_id);
-      ASSERT(dep_op->proc_id, dep_op->engine_info.dep_on_l1_miss || dep_op->engine_info.was_dep_on_l1_miss);
-
-      if (dep_op->engine_info.dep_on_l1_miss) {
-        /* Determine if the op is dependent on another l1_miss */
-        for (ii = 0; ii < op_info->num_srcs; ii++) {
-          Src_Info* src_info = &op_info->src_info[ii];
-          Op* src_op = src_info->op;
-
-          if (src_op->unique_num == src_info->unique_num && src_op->op_pool_valid) {
-            if (src_op->unique_num != op->unique_num)
-              if ((src_op->engine_info.l1_miss && !src_op->engine_info.l1_miss_satisfied) ||
-                  src_op->engine_info.dep_on_l1_miss)
-                still_dep_on_l1_miss = TRUE;
-          }
-          if (still_dep_on_l1_miss)
-            break;
-        }
-
-        /* If the op is not dependent on another l1 miss, then go ahead and
-           unmark it and figure out if we need to unmark its dependents */
-        if (!still_dep_on_l1_miss) {
-          dep_op->engine_info.dep_on_l1_miss = FALSE;
-          dep_op->engine_info.was_dep_on_l1_miss = TRUE;
-          unmark_l1_miss_deps(dep_op);
-        }
+        if (TRACK_L1_MISS_DEPS)
+          update_l1_miss_deps(op, was_pending);
       }
     }
   }
@@ -4687,7 +5289,7 @@ L1_Data* l1_pref_cache_access(Mem_Req* req) {
     return pref_data;
 
   if (pref_data) {
-    data = cache_insert(&L1(req->proc_id)->cache, req->proc_id, req->addr, &line_addr, &repl_line_addr);
+    data = cache_insert(&L1_OF(req->proc_id, req->addr)->cache, req->proc_id, req->addr, &line_addr, &repl_line_addr);
     STAT_EVENT(req->proc_id, L1_DATA_EVICT);
     STAT_EVENT(req->proc_id, L1_PREF_MOVE_L1);
     if (data) {
@@ -4759,7 +5361,12 @@ void stats_per_core_collect(uns8 proc_id) {
 /**************************************************************************************/
 /* mem_done */
 void finalize_memory() {
+  if (MEM_RECORD_FILE)
+    mem_record_done();
+  if (BOGUS_REPLAY)
+    bogus_replay_done();
   perf_pred_done();
+  noc_done();
 }
 
 /***************************************************************************************/
@@ -4767,34 +5374,36 @@ void finalize_memory() {
 /* l1_cache_collect_stats  */
 
 void l1_cache_collect_stats() {
-  uns8 proc_id;
+  uns proc_id;
   uns ii, jj;
-  uns lines_per_core[64];
+  uns lines_per_core[MAX_NUM_PROCS];
+  uns num_sets = 0;
 
   if (PRIVATE_L1) {
     WARNING(0, "Some L1 stats not collected with PRIVATE_L1 on\n");
     return;
   }
-  Cache* l1_cache = &L1(0)->cache;
-
-  ASSERT(0, NUM_CORES <= 64);
 
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
     lines_per_core[proc_id] = 0;
 
-  for (ii = 0; ii < l1_cache->num_sets; ii++) {
-    for (jj = 0; jj < l1_cache->assoc; jj++) {
-      if (l1_cache->entries[ii][jj].valid) {
-        L1_Data* l1_line = l1_cache->entries[ii][jj].data;
-        lines_per_core[l1_line->proc_id]++;
+  for (uns slice = 0; slice < L1_SLICES; slice++) {
+    Cache* l1_cache = L1_SLICES > 1 ? &mem->l1_slices[slice]->cache : &L1(0)->cache;
+    num_sets += l1_cache->num_sets;
+    for (ii = 0; ii < l1_cache->num_sets; ii++) {
+      for (jj = 0; jj < l1_cache->assoc; jj++) {
+        if (l1_cache->entries[ii][jj].valid) {
+          L1_Data* l1_line = l1_cache->entries[ii][jj].data;
+          lines_per_core[l1_line->proc_id]++;
+        }
       }
     }
   }
 
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-    INC_STAT_EVENT(proc_id, CORE_TOTAL_SETS_ALL_INTERVALS, l1_cache->num_sets);
+    INC_STAT_EVENT(proc_id, CORE_TOTAL_SETS_ALL_INTERVALS, num_sets);
     INC_STAT_EVENT(proc_id, CORE_L1_AVG_NUM_WAYS, lines_per_core[proc_id]);
-    mem->l1_ave_num_ways_per_core[proc_id] = (double)lines_per_core[proc_id] / l1_cache->num_sets;
+    mem->l1_ave_num_ways_per_core[proc_id] = (double)lines_per_core[proc_id] / num_sets;
   }
 }
 
@@ -4971,11 +5580,13 @@ void wp_process_reqbuf_match(Mem_Req* req, Op* op) {
 
 static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta) {
   uns* counter;
+  Stat_Integrator* integrator;
   switch (type) {
     case MRT_IFETCH:
     case MRT_DFETCH:
     case MRT_DSTORE:
       counter = &mem_req_demand_entries;
+      integrator = &mem_req_demand_integrator;
       break;
     case MRT_IPRF:
     case MRT_DPRF:
@@ -4983,10 +5594,12 @@ static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta) {
     case MRT_FDIPPRFON:
     case MRT_FDIPPRFOFF:
       counter = &mem_req_pref_entries;
+      integrator = &mem_req_pref_integrator;
       break;
     case MRT_WB:
     case MRT_WB_NODIRTY:
       counter = &mem_req_wb_entries;
+      integrator = &mem_req_wb_integrator;
       break;
     default:
       FATAL_ERROR(0, "Unknown mem req state\n");
@@ -4994,6 +5607,24 @@ static void update_mem_req_occupancy_counter(Mem_Req_Type type, int delta) {
   }
   *counter += delta;
   ASSERT(0, *counter <= mem->total_mem_req_buffers);
+  stat_integrator_set(integrator, *counter);
+}
+
+/**************************************************************************************/
+/* mem_add_outstanding_l1_misses: */
+
+static void mem_add_outstanding_l1_misses(uns proc_id, int delta) {
+  Uncore* uncore = &mem->uncores[proc_id];
+  uncore->num_outstanding_l1_misses += delta;
+  stat_integrator_set(&uncore->mlp_integrator, uncore->num_outstanding_l1_misses);
+}
+
+/**************************************************************************************/
+/* mem_l1_lines_changed: */
+
+void mem_l1_lines_changed(uns proc_id) {
+  stat_integrator_set(&mem->uncores[proc_id].lines_integrator,
+                      GET_TOTAL_STAT_EVENT(proc_id, NORESET_L1_FILL) - GET_TOTAL_STAT_EVENT(proc_id, NORESET_L1_EVICT));
 }
 
 uns num_offchip_stall_reqs(uns proc_id) {
@@ -36,11 +36,13 @@
 #include "libs/cache_lib.h"
 #include "libs/hash_lib.h"
 #include "libs/list_lib.h"
+#include "libs/ring_lib.h"
 #include "libs/port_lib.h"
 #include "memory/mem_req.h"
 
 #include "freq.h"
 #include "op_info.h"
+#include "statistics.h"
 // #include "dram.h"
 
 /**************************************************************************************/
@@ -96,8 +98,65 @@ typedef struct Mem_Queue_Entry_struct {
   int reqbuf;       /* request buffer num */
   Counter priority; /* priority of the miss */
   Counter rdy_cycle;
+  Addr line_addr;       /* CACHE_SIZE_ADDR of the req at insertion (index key) */
+  uns line_size;        /* req size the key was computed with */
+  Counter seq;          /* insertion order in the queue, breaks priority ties */
+  Flag resort;          /* priority changed since the queue was last sorted */
+  Counter insert_cycle; /* L1 cycle the entry was inserted, for MEM_QUEUE_DELAY */
 } Mem_Queue_Entry;
 
+/* Open-addressing (linear probing) index of a queue's entries keyed by
+   CACHE_SIZE_ADDR.  Slots hold request buffer ids rather than queue
+   positions since the queues are re-sorted in place.  A search probes once
+   per distinct request size present in the queue. */
+typedef struct Mem_Queue_Index_Slot_struct {
+  Addr line_addr;
+  int reqbuf; /* -1 if the slot is empty */
+  uns line_size;
+} Mem_Queue_Index_Slot;
+
+typedef struct Mem_Queue_Index_struct {
+  Mem_Queue_Index_Slot* slots;
+  uns mask;         /* number of slots - 1 */
+  uns* sizes;       /* distinct line sizes currently indexed */
+  uns* size_counts; /* number of entries indexed with each size */
+  uns num_sizes;
+  int* candidates; /* reqbuf ids found by the last lookup */
+} Mem_Queue_Index;
+
+/* Per-core index of the valid MRT_DSTORE request buffers for scan_stores.
+   A store is chained under its address rounded down to its own size.  A
+   lookup probes the block holding the load and the one before it (for an
+   unaligned store), once per distinct store size, and checks BYTE_CONTAIN
+   on the stores found. */
+#define MEM_STORE_INDEX_MAX_SIZES 8
+
+typedef struct Mem_Store_Index_struct {
+  int* heads; /* first reqbuf id of each chain, -1 if empty */
+  uns mask;   /* number of chains - 1 */
+  uns sizes[MEM_STORE_INDEX_MAX_SIZES];       /* distinct store sizes indexed */
+  uns size_counts[MEM_STORE_INDEX_MAX_SIZES]; /* stores indexed with each size */
+  uns num_sizes;
+} Mem_Store_Index;
+
+typedef struct Mem_Store_Index_Node_struct {
+  Addr block;  /* address the reqbuf is chained under */
+  uns size;    /* size it is indexed with, 0 if not indexed */
+  uns8 proc_id;
+  int next; /* next reqbuf id in the chain, -1 if last */
+} Mem_Store_Index_Node;
+
+/* A prefetch entry of a queue, for mem_kick_out_prefetch_from_queue with
+   KICKOUT_OLDEST_PREFETCH.  The entries are kept oldest first and are
+   dropped lazily once their reqbuf left the queue or stopped being a
+   prefetch. */
+typedef struct Mem_Queue_Prefetch_struct {
+  Counter start_cycle; /* of the req, the age the victim is chosen by */
+  Counter priority;    /* of the entry, with seq the queue order of equally old ones */
+  Counter seq;
+  int reqbuf;
+} Mem_Queue_Prefetch;
+
 typedef struct Mem_Queue_struct {
   Mem_Queue_Entry* base;
   int entry_count;
@@ -105,6 +164,18 @@ typedef struct Mem_Queue_struct {
   uns size;
   char name[20];
   Mem_Queue_Type type;
+  Mem_Queue_Index index;
+  int sorted_count;         /* base[0, sorted_count) was in order at the last sort */
+  Counter next_seq;         /* seq for the next inserted entry */
+  Mem_Queue_Entry* scratch; /* entries being re-placed by mem_queue_sort */
+
+  Counter* entry_seqs;            /* [total_mem_req_buffers] seq of the reqbuf's entry, MAX_CTR if not queued */
+  Mem_Queue_Prefetch* prefetches; /* [prefetch_capacity] oldest first from prefetch_head */
+  int prefetch_head;
+  int prefetch_tail;
+  int prefetch_capacity;
+
+  Counter next_rdy_cycle; /* no entry is ready before this cycle; 0 forces the next walk */
 } Mem_Queue;
 
 typedef struct Mem_Bank_Queue_Entry_struct {
@@ -134,28 +205,42 @@ typedef struct Uncore_struct {
   uns num_outstanding_l1_accesses;
   uns num_outstanding_l1_misses;
   Counter mem_block_start;
+  Stat_Integrator cycle_integrator;  // L1_CYCLE
+  Stat_Integrator mlp_integrator;    // CORE_MLP and CORE_MLP_<n> of num_outstanding_l1_misses
+  Stat_Integrator lines_integrator;  // L1_LINES of the L1 lines the core filled
 } Uncore;
 
 typedef struct Memory_struct {
   /* miss buffer */
   Mem_Req* req_buffer;
-  List req_buffer_free_list;
-  List* l1_in_buffer_core;
+  Ring req_buffer_free_list;
+  Ring* l1_in_buffer_core;
   uns total_mem_req_buffers;
   uns* num_req_buffers_per_core;
 
   int req_count;
 
+  /* outstanding stores, see scan_stores */
+  Mem_Store_Index* store_index;     /* [NUM_CORES] */
+  Mem_Store_Index_Node* store_nodes; /* [total_mem_req_buffers] */
+
+  /* bumped whenever a request buffer is allocated or freed, or a request
+     enters or leaves one of the queues (see SKIP_STALLED_CYCLES) */
+  Counter event_count;
+
   /* uncore (includes MLC and L1) */
   Uncore* uncores;
 
+  /* the slices of the shared L1 when L1_SLICES > 1 (see mem_l1) */
+  Ported_Cache** l1_slices;
+
   /* prfetcher cache */
   Cache pref_l1_cache;
 
   /* various queues (arrays) */
   Mem_Queue mlc_queue;
   Mem_Queue mlc_fill_queue;
-  Mem_Queue l1_queue;
+  Mem_Queue* l1_queues; /* one per L1 slice */
   Mem_Queue bus_out_queue;
   Mem_Queue l1fill_queue;
   Mem_Queue* core_fill_queues;
@@ -229,6 +314,9 @@ Flag scan_stores(Addr, uns);
 void op_nuke_mem_req(Op*);
 Flag mem_req_younger_than_uniquenum(int, Counter);
 Flag mem_req_older_than_uniquenum(int, Counter);
+Ported_Cache* mem_l1(uns proc_id, Addr addr);
+uns mem_l1_slice(Addr addr);
+Flag mem_l1_get_port(uns proc_id, Addr addr, Flag write);
 L1_Data* do_l1_access(Op* op);
 L1_Data* do_l1_access_addr(Addr);
 L1_Data* do_mlc_access(Op* op);
@@ -246,7 +334,10 @@ Flag mlc_fill_line(Mem_Req* req);
 Flag l1_fill_line(Mem_Req* req);
 
 void mark_ops_as_l1_miss_satisfied(Mem_Req* req);
+/* the L1 lines of proc_id changed (NORESET_L1_FILL - NORESET_L1_EVICT) */
+void mem_l1_lines_changed(uns proc_id);
 int mem_get_req_count(uns proc_id);
+Flag mem_perfect_latency(uns proc_id, Addr line_addr, uns* latency);
 Flag mem_can_allocate_req_buffer(uns proc_id, Mem_Req_Type type, Flag for_l1_writeback);
 
 void open_mem_stat_interval_file(void);
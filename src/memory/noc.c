@@ -0,0 +1,246 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : memory/noc.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Ring/mesh network-on-chip between the cores, the L1 slices and the
+ *                memory controllers, with per-link bandwidth and credits
+ ***************************************************************************************/
+
+/* The network has max(NUM_CORES, L1_SLICES) routers; the cores, the L1 slices and the
+   RAMULATOR_CHANNELS memory controllers are each spread evenly over them. A ring routes
+   the shorter way around. A mesh is as close to square as possible, with its last row
+   filled up by routers without endpoints, and routes X then Y.
+
+   Nothing is simulated per cycle. Each directed link remembers the cycle it is free, and a
+   message reserves every link on its route when it is sent: its head waits for the link,
+   holds it for flits / NOC_LINK_FLITS_PER_CYCLE cycles and moves to the next router
+   NOC_HOP_CYCLES later. Each link has NOC_LINK_CREDITS flits of buffering at its
+   downstream router; when the head has to wait longer than that buffer takes to drain,
+   it backs up and keeps the upstream link busy as well. A source can only inject while
+   its first link has a free credit. The cost is O(hops) per message, independent of how
+   long messages wait. */
+
+#include "noc.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/host_prof.h"
+
+#include "core.param.h"
+#include "general.param.h"
+#include "memory.param.h"
+#include "ramulator.param.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_MEMORY, ##args)
+
+/* outgoing links of each router */
+typedef enum Noc_Dir_enum {
+  NOC_DIR_EAST,  // ring: clockwise
+  NOC_DIR_WEST,  // ring: counterclockwise
+  NOC_DIR_NORTH,
+  NOC_DIR_SOUTH,
+  NOC_NUM_DIRS
+} Noc_Dir;
+
+/**************************************************************************************/
+/* Global variables */
+
+DEFINE_ENUM(Noc_Topology, NOC_TOPOLOGY_LIST);
+
+static uns noc_num_nodes;            /* routers with endpoints */
+static uns noc_width;                /* routers per mesh row */
+static Counter* noc_link_free_cycle; /* [node * NOC_NUM_DIRS + dir] */
+static Counter noc_credit_cycles;    /* cycles the downstream buffer of a link takes to drain */
+static Counter noc_host_ticks;
+static Counter noc_flits;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static Noc_Dir noc_route(uns node, uns dst);
+static uns noc_next(uns node, Noc_Dir dir);
+
+/**************************************************************************************/
+/* init_noc: */
+
+void init_noc(void) {
+  if (NOC_TOPOLOGY == NOC_TOPOLOGY_NONE)
+    return;
+  ASSERTM(0, NOC_TOPOLOGY < NOC_TOPOLOGY_NUM_ELEMS, "Unknown NOC_TOPOLOGY %u\n", NOC_TOPOLOGY);
+  ASSERTM(0, NOC_LINK_FLITS_PER_CYCLE > 0, "NOC_LINK_FLITS_PER_CYCLE must be positive\n");
+  ASSERTM(0, NOC_FLIT_BYTES > 0, "NOC_FLIT_BYTES must be positive\n");
+  ASSERTM(0, NOC_LINK_CREDITS >= noc_data_flits(), "NOC_LINK_CREDITS must fit a data message (%u flits)\n",
+          noc_data_flits());
+
+  noc_num_nodes = MAX2(NUM_CORES, L1_SLICES);
+  noc_width = noc_num_nodes;
+  if (NOC_TOPOLOGY == NOC_TOPOLOGY_MESH) {
+    noc_width = 1;
+    while (noc_width * noc_width < noc_num_nodes)
+      noc_width++;
+  }
+  uns num_routers = (noc_num_nodes + noc_width - 1) / noc_width * noc_width;
+  noc_link_free_cycle = (Counter*)calloc(num_routers * NOC_NUM_DIRS, sizeof(Counter));
+  noc_credit_cycles = NOC_LINK_CREDITS / NOC_LINK_FLITS_PER_CYCLE;
+  noc_host_ticks = 0;
+  noc_flits = 0;
+}
+
+/**************************************************************************************/
+/* noc_core_node: */
+
+uns noc_core_node(uns proc_id) {
+  return proc_id * noc_num_nodes / NUM_CORES;
+}
+
+/**************************************************************************************/
+/* noc_l1_node: */
+
+uns noc_l1_node(uns slice) {
+  return slice * noc_num_nodes / L1_SLICES;
+}
+
+/**************************************************************************************/
+/* noc_mc_node: the channel of a line is not known outside of Ramulator, so the lines
+   are assumed to interleave across the channels */
+
+uns noc_mc_node(Addr addr) {
+  uns channel = (addr >> LOG2(L1_LINE_SIZE)) % RAMULATOR_CHANNELS;
+  return channel * noc_num_nodes / RAMULATOR_CHANNELS;
+}
+
+/**************************************************************************************/
+/* noc_ctrl_flits: */
+
+uns noc_ctrl_flits(void) {
+  return 1;
+}
+
+/**************************************************************************************/
+/* noc_data_flits: a header flit and the line */
+
+uns noc_data_flits(void) {
+  return 1 + (L1_LINE_SIZE + NOC_FLIT_BYTES - 1) / NOC_FLIT_BYTES;
+}
+
+/**************************************************************************************/
+/* noc_route: */
+
+static Noc_Dir noc_route(uns node, uns dst) {
+  if (NOC_TOPOLOGY == NOC_TOPOLOGY_RING) {
+    uns cw = (dst + noc_num_nodes - node) % noc_num_nodes;
+    return cw <= noc_num_nodes - cw ? NOC_DIR_EAST : NOC_DIR_WEST;
+  }
+  uns x = node % noc_width, dst_x = dst % noc_width;
+  if (x != dst_x)
+    return dst_x > x ? NOC_DIR_EAST : NOC_DIR_WEST;
+  return dst > node ? NOC_DIR_SOUTH : NOC_DIR_NORTH;
+}
+
+/**************************************************************************************/
+/* noc_next: */
+
+static uns noc_next(uns node, Noc_Dir dir) {
+  if (NOC_TOPOLOGY == NOC_TOPOLOGY_RING)
+    return dir == NOC_DIR_EAST ? (node + 1) % noc_num_nodes : (node + noc_num_nodes - 1) % noc_num_nodes;
+  switch (dir) {
+    case NOC_DIR_EAST:
+      return node + 1;
+    case NOC_DIR_WEST:
+      return node - 1;
+    case NOC_DIR_SOUTH:
+      return node + noc_width;
+    default:
+      return node - noc_width;
+  }
+}
+
+/**************************************************************************************/
+/* noc_can_inject: */
+
+Flag noc_can_inject(uns src, uns dst, Counter cycle) {
+  if (src == dst)
+    return TRUE;
+  Counter link_free = noc_link_free_cycle[src * NOC_NUM_DIRS + noc_route(src, dst)];
+  return link_free <= cycle + noc_credit_cycles;
+}
+
+/**************************************************************************************/
+/* noc_send: */
+
+Counter noc_send(uns proc_id, uns src, uns dst, uns flits, Counter cycle) {
+  if (src == dst)
+    return cycle;
+
+  uns64 prof_t = host_prof_now();
+  Counter link_cycles = (flits + NOC_LINK_FLITS_PER_CYCLE - 1) / NOC_LINK_FLITS_PER_CYCLE;
+  Counter* prev_link = NULL;
+  Counter head = cycle;
+  uns hops = 0;
+
+  for (uns node = src; node != dst; hops++) {
+    Noc_Dir dir = noc_route(node, dst);
+    Counter* link = &noc_link_free_cycle[node * NOC_NUM_DIRS + dir];
+    Counter start = MAX2(head, *link);
+    // out of credits: the message waits in the upstream buffer and holds the link behind it
+    if (prev_link && start > head + noc_credit_cycles)
+      *prev_link = MAX2(*prev_link, start - noc_credit_cycles);
+    INC_STAT_EVENT(proc_id, NOC_CONTENTION_CYCLES, start - head);
+    *link = start + link_cycles;
+    head = start + NOC_HOP_CYCLES;
+    prev_link = link;
+    node = noc_next(node, dir);
+  }
+
+  STAT_EVENT(proc_id, NOC_MESSAGES);
+  INC_STAT_EVENT(proc_id, NOC_FLITS, flits);
+  INC_STAT_EVENT(proc_id, NOC_FLIT_HOPS, flits * hops);
+  noc_flits += flits;
+  if (HOST_PROF)
+    noc_host_ticks += host_prof_now() - prof_t;
+  DEBUG(proc_id, "NoC message  src:%u  dst:%u  flits:%u  hops:%u  sent:%s  arrives:%s\n", src, dst, flits, hops,
+        unsstr64(cycle), unsstr64(head + link_cycles - 1));
+  return head + link_cycles - 1;
+}
+
+/**************************************************************************************/
+/* noc_done: */
+
+void noc_done(void) {
+  if (NOC_TOPOLOGY == NOC_TOPOLOGY_NONE || !HOST_PROF)
+    return;
+  double ns = host_prof_ticks_to_ns(noc_host_ticks);
+  fprintf(mystdout, "** NoC host time: %s flits  %.1f ns/flit  %.3f s\n", unsstr64(noc_flits),
+          noc_flits ? ns / noc_flits : 0.0, ns / 1e9);
+}
@@ -0,0 +1,70 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : memory/noc.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Ring/mesh network-on-chip between the cores, the L1 slices and the
+ *                memory controllers, with per-link bandwidth and credits
+ ***************************************************************************************/
+
+#ifndef __NOC_H__
+#define __NOC_H__
+
+#include "globals/enum.h"
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Enums */
+
+/* NONE keeps the fixed L1_SLICE_HOP_CYCLES delay instead of the network */
+#define NOC_TOPOLOGY_LIST(elem) elem(NONE) elem(RING) elem(MESH)
+
+DECLARE_ENUM(Noc_Topology, NOC_TOPOLOGY_LIST, NOC_TOPOLOGY_);
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Build the nodes and links (call after the L1 slices exist) */
+void init_noc(void);
+
+/* Router of each kind of endpoint */
+uns noc_core_node(uns proc_id);
+uns noc_l1_node(uns slice);
+uns noc_mc_node(Addr addr);
+
+/* Flits of a message without and with a cache line of payload */
+uns noc_ctrl_flits(void);
+uns noc_data_flits(void);
+
+/* TRUE if the first link from src to dst has a free credit at cycle (always TRUE if src == dst) */
+Flag noc_can_inject(uns src, uns dst, Counter cycle);
+
+/* Reserve the links from src to dst for a message of flits whose head enters the network at
+   cycle, and return the cycle its tail reaches dst */
+Counter noc_send(uns proc_id, uns src, uns dst, uns flits, Counter cycle);
+
+/* Print the host time per flit (--host_prof) */
+void noc_done(void);
+
+#endif /* #ifndef __NOC_H__ */
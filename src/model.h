@@ -39,6 +39,10 @@
 typedef enum Model_Id_enum {
   CMP_MODEL,
   DUMB_MODEL,
+  BP_ONLY_MODEL,
+  INTERVAL_MODEL,
+  MEM_REPLAY_MODEL,
+  DATAFLOW_MODEL,
   NUM_MODELS,
 } Model_Id;
 
@@ -66,6 +70,8 @@ typedef struct Model_struct {
   void (*op_fetched_hook)(Op*);
   void (*op_retired_hook)(Op*);  // called just before the op is freed
   void (*warmup_func)(Op* op);   // called for warmup(may be NULL)
+  void (*save_warm_state_func)(void);  // called at the end of warmup with SAVE_WARM_STATE (may be NULL)
+  void (*load_warm_state_func)(void);  // called at the end of warmup with LOAD_WARM_STATE (may be NULL)
 
   /*      void (*l0_cache_miss_hook)      (Op *); */
   /*      void (*resolve_mispredict_hook) (Op *); */
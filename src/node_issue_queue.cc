@@ -29,6 +29,8 @@
 
 #include "node_issue_queue.h"
 
+#include <string.h>
+
 extern "C" {
 #include "globals/assert.h"
 #include "globals/global_defs.h"
@@ -40,6 +42,9 @@ extern "C" {
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
 
+#include "core.param.h"
+
+#include "bp/bp.h"
 #include "memory/memory.h"
 
 #include "exec_ports.h"
@@ -51,12 +56,171 @@ extern "C" {
 
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_NODE_STAGE, ##args)
 
+/**************************************************************************************/
+/* Types */
+
+/*
+ * Ready bitmaps of the BITMAP schedule scheme. Each op that enters an RS takes
+ * the next age slot (rs_age_seq modulo num_slots) and the ready list becomes one
+ * bitvector per RS indexed by that slot. Ops enter the RSs in program order and
+ * the slots in use never span more than the node table, so scanning the bits
+ * circularly from the oldest slot visits the ready ops oldest first.
+ */
+typedef struct Node_Rdy_Bitmap_struct {
+  uns32 num_slots;   // power of two, covers every op that can be in the node table
+  uns32 num_words;   // 64-bit words in each bitvector
+  uns64* rdy_bits;   // NUM_RS bitvectors, bit set if the op in that slot is on the ready list
+  uns64* sched_bits; // selected ops that have not come back as OS_SCHEDULED/OS_MISS yet
+  Op** slot_ops;     // op in each age slot, NULL once it has left its RS
+  Counter head_seq;  // age sequence number of the oldest op that may still be in an RS
+  Counter next_seq;  // age sequence number of the next op entering an RS
+  uns32 rdy_count;   // number of bits set in rdy_bits
+} Node_Rdy_Bitmap;
+
+/*
+ * Ready wheel. An op whose sources are all woken up but whose rdy_cycle is more
+ * than a cycle away is parked in the slot of the cycle it becomes schedulable
+ * (rdy_cycle - 1), linked through next_rdy, and only joins the ready list (or
+ * bitmaps) when that slot is drained. Ops due more than a lap ahead, or woken up
+ * again while parked, are parked again when their slot comes around. Parked ops
+ * keep in_rdy_list set so they are not added twice.
+ */
+typedef struct Node_Rdy_Wheel_struct {
+  uns32 num_slots;    // power of two
+  Op** slot_heads;    // ops parked in each slot
+  Counter next_cycle; // first cycle whose slot has not been drained yet
+  uns32 count;        // number of parked ops
+} Node_Rdy_Wheel;
+
 /**************************************************************************************/
 /* Prototypes */
 
 int64 node_dispatch_find_emptiest_rs(Op*);
 void node_schedule_oldest_first_sched(Op*);
 void node_track_fu_idle_stats();
+Flag node_issue_queue_op_schedulable(Op*);
+void node_schedule_bitmap(Node_Rdy_Bitmap*);
+
+/**************************************************************************************/
+/* Ready Bitmaps */
+
+static inline uns32 node_rdy_bitmap_slot(Node_Rdy_Bitmap* bm, Counter seq) {
+  return (uns32)(seq & (bm->num_slots - 1));
+}
+
+static inline uns64* node_rdy_bitmap_rs_bits(Node_Rdy_Bitmap* bm, Counter rs_id) {
+  return &bm->rdy_bits[rs_id * bm->num_words];
+}
+
+static inline void node_rdy_bitmap_set(uns64* bits, uns32 slot) {
+  bits[slot >> 6] |= 1ull << (slot & 63);
+}
+
+static inline void node_rdy_bitmap_unset(uns64* bits, uns32 slot) {
+  bits[slot >> 6] &= ~(1ull << (slot & 63));
+}
+
+/* skip past the age slots whose ops have already left the RSs */
+static void node_rdy_bitmap_advance_head(Node_Rdy_Bitmap* bm) {
+  while (bm->head_seq < bm->next_seq && !bm->slot_ops[node_rdy_bitmap_slot(bm, bm->head_seq)])
+    bm->head_seq++;
+}
+
+/* give an op entering rs the next age slot and record which of the RS's FUs can execute it */
+static void node_rdy_bitmap_enter_rs(Node_Rdy_Bitmap* bm, Op* op, Reservation_Station* rs) {
+  node_rdy_bitmap_advance_head(bm);
+  ASSERTM(node->proc_id, bm->next_seq - bm->head_seq < bm->num_slots, "RS ops span more than %u age slots\n",
+          bm->num_slots);
+
+  uns32 slot = node_rdy_bitmap_slot(bm, bm->next_seq);
+  ASSERT(node->proc_id, !bm->slot_ops[slot]);
+  op->rs_age_seq = bm->next_seq++;
+  bm->slot_ops[slot] = op;
+
+  uns64 op_fu_type = op->table_info->fu_type;
+  op->rs_fu_mask = 0;
+  for (uns32 i = 0; i < rs->num_fus; ++i) {
+    if (op_fu_type & rs->connected_fus[i]->type)
+      op->rs_fu_mask |= 1ull << i;
+  }
+}
+
+static void node_rdy_bitmap_leave_rs(Node_Rdy_Bitmap* bm, Op* op) {
+  uns32 slot = node_rdy_bitmap_slot(bm, op->rs_age_seq);
+  ASSERT(node->proc_id, bm->slot_ops[slot] == op);
+  if (op->in_rdy_list) {
+    node_rdy_bitmap_unset(node_rdy_bitmap_rs_bits(bm, op->rs_id), slot);
+    ASSERT(node->proc_id, bm->rdy_count > 0);
+    bm->rdy_count--;
+    op->in_rdy_list = FALSE;
+  }
+  node_rdy_bitmap_unset(bm->sched_bits, slot);
+  bm->slot_ops[slot] = NULL;
+}
+
+/**************************************************************************************/
+/* Ready Wheel */
+
+static inline void node_rdy_wheel_park(Node_Rdy_Wheel* wheel, Op* op) {
+  Op** head = &wheel->slot_heads[(op->rdy_cycle - 1) & (wheel->num_slots - 1)];
+  op->next_rdy = *head;
+  *head = op;
+}
+
+static void node_issue_queue_link_ready(Op* op) {
+  Node_Rdy_Bitmap* bm = node->rdy_bitmap;
+  if (bm) {
+    uns32 slot = node_rdy_bitmap_slot(bm, op->rs_age_seq);
+    ASSERT(node->proc_id, bm->slot_ops[slot] == op);
+    node_rdy_bitmap_set(node_rdy_bitmap_rs_bits(bm, op->rs_id), slot);
+    bm->rdy_count++;
+    return;
+  }
+
+  op->next_rdy = node->rdy_head;
+  node->rdy_head = op;
+}
+
+/* move the ops that can be scheduled this cycle from the wheel to the ready list */
+static void node_rdy_wheel_drain(Node_Rdy_Wheel* wheel) {
+  Counter cycle = wheel->next_cycle;
+  // after a skip longer than a lap every slot is visited once
+  if (cycle + wheel->num_slots <= cycle_count)
+    cycle = cycle_count + 1 - wheel->num_slots;
+
+  for (; wheel->count && cycle <= cycle_count; cycle++) {
+    Op** head = &wheel->slot_heads[cycle & (wheel->num_slots - 1)];
+    Op* op = *head;
+    *head = NULL;
+    while (op) {
+      Op* next = op->next_rdy;
+      if (op->rdy_cycle > cycle_count + 1) {
+        node_rdy_wheel_park(wheel, op);
+      } else {
+        wheel->count--;
+        node_issue_queue_link_ready(op);
+      }
+      op = next;
+    }
+  }
+  wheel->next_cycle = cycle_count + 1;
+}
+
+static void node_rdy_wheel_flush(Node_Rdy_Wheel* wheel) {
+  for (uns32 slot = 0; wheel->count && slot < wheel->num_slots; ++slot) {
+    Op** last = &wheel->slot_heads[slot];
+    for (Op* op = *last; op; op = op->next_rdy) {
+      if (FLUSH_OP(op)) {
+        ASSERT(node->proc_id, op->op_num > bp_recovery_info->recovery_op_num);
+        *last = op->next_rdy;
+        op->in_rdy_list = FALSE;
+        wheel->count--;
+      } else {
+        last = &op->next_rdy;
+      }
+    }
+  }
+}
 
 /**************************************************************************************/
 /* Issuers:
@@ -84,24 +248,18 @@ int64 node_dispatch_find_emptiest_rs(Op* op) {
     /* TODO: support infinite RS for upper-bound expr */
     ASSERTM(node->proc_id, rs->size, "Infinite RS not suppoted by node_dispatch_find_emptiest_rs issuer.");
 
-    for (uns32 i = 0; i < rs->num_fus; ++i) {
-      // find the FU that can execute this op
-      Func_Unit* fu = rs->connected_fus[i];
-      if (!(get_fu_type(op->table_info->op_type, op->table_info->is_simd) & fu->type)) {
-        continue;
-      }
+    // skip RSs that are not connected to any FU that can execute this op
+    if (!(op->table_info->fu_type & rs->fu_types)) {
+      continue;
+    }
 
-      ASSERT(node->proc_id, rs->size >= rs->rs_op_count);
-      uns num_empty_slots = rs->size - rs->rs_op_count;
-      if (num_empty_slots == 0) {
-        continue;
-      }
+    ASSERT(node->proc_id, rs->size >= rs->rs_op_count);
+    uns num_empty_slots = rs->size - rs->rs_op_count;
 
-      // find the emptiest RS
-      if (emptiest_rs_slots < num_empty_slots) {
-        emptiest_rs_id = rs_id;
-        emptiest_rs_slots = num_empty_slots;
-      }
+    // find the emptiest RS
+    if (emptiest_rs_slots < num_empty_slots) {
+      emptiest_rs_id = rs_id;
+      emptiest_rs_slots = num_empty_slots;
     }
   }
 
@@ -128,7 +286,7 @@ void node_schedule_oldest_first_sched(Op* op) {
   for (uns32 i = 0; i < rs->num_fus; ++i) {
     // check if this op can be executed by this FU
     Func_Unit* fu = rs->connected_fus[i];
-    if (!(get_fu_type(op->table_info->op_type, op->table_info->is_simd) & fu->type)) {
+    if (!(op->table_info->fu_type & fu->type)) {
       continue;
     }
 
@@ -185,6 +343,82 @@ void node_schedule_oldest_first_sched(Op* op) {
   ASSERT(node->proc_id, node->sd.op_count <= node->sd.max_op_count);
 }
 
+/*
+ * BITMAP: oldest first over the ready bitmaps. Each RS scans its ready bits from
+ * the oldest age slot and gives every schedulable op the first of the RS's free FUs
+ * in its rs_fu_mask, stopping once all of the RS's FUs have an op. Ops left behind
+ * at that point are counted as ready but not issued without being examined.
+ */
+void node_schedule_bitmap(Node_Rdy_Bitmap* bm) {
+  node_rdy_bitmap_advance_head(bm);
+  uns32 start = node_rdy_bitmap_slot(bm, bm->head_seq);
+  uns32 start_word = start >> 6;
+  uns64 start_mask = N_BIT_MASK(start & 63);
+
+  for (uns32 rs_id = 0; rs_id < NUM_RS; ++rs_id) {
+    Reservation_Station* rs = &node->rs[rs_id];
+    uns64* bits = node_rdy_bitmap_rs_bits(bm, rs_id);
+    uns64 free_fus = rs->num_fus == 64 ? N_BIT_MASK_64 : N_BIT_MASK(rs->num_fus);
+    uns64 wanted_fus = 0;  // FUs that some ready op of this RS could execute on
+    uns not_issued = 0;
+
+    // the first word is visited twice: slots from start up first, the ones below start last
+    for (uns32 n = 0; n <= bm->num_words; ++n) {
+      uns32 w = (start_word + n) & (bm->num_words - 1);
+      uns64 word = bits[w] & (n == 0 ? ~start_mask : n == bm->num_words ? start_mask : N_BIT_MASK_64);
+      if (!free_fus) {
+        not_issued += __builtin_popcountll(word & ~bm->sched_bits[w]);
+        continue;
+      }
+
+      for (; word && free_fus; word &= word - 1) {
+        uns32 slot = (w << 6) | __builtin_ctzll(word);
+        Op* op = bm->slot_ops[slot];
+        ASSERT(node->proc_id, op && op->in_rdy_list && op->rs_id == rs_id);
+        if (!node_issue_queue_op_schedulable(op))
+          continue;
+
+        if (op->state == OS_READY || op->state == OS_WAIT_FWD)
+          wanted_fus |= op->rs_fu_mask;
+
+        uns64 avail = op->rs_fu_mask & free_fus;
+        if (!avail) {
+          not_issued++;
+          continue;
+        }
+
+        uns32 i = __builtin_ctzll(avail);
+        free_fus &= ~(1ull << i);
+        uns32 fu_id = rs->connected_fus[i]->fu_id;
+        ASSERT(node->proc_id, fu_id < (uns32)node->sd.max_op_count && !node->sd.ops[fu_id]);
+        DEBUG(node->proc_id, "Scheduler selecting    op_num:%s  fu_id:%d op:%s l1:%d\n", unsstr64(op->op_num), fu_id,
+              disasm_op(op, TRUE), op->engine_info.l1_miss);
+        op->fu_num = fu_id;
+        node->sd.ops[fu_id] = op;
+        node->last_scheduled_opnum = op->op_num;
+        node->sd.op_count++;
+        node_rdy_bitmap_set(bm->sched_bits, slot);
+      }
+      if (!free_fus)
+        not_issued += __builtin_popcountll(word & ~bm->sched_bits[w]);
+    }
+
+    if (not_issued) {
+      INC_STAT_EVENT(node->proc_id, RS_OP_READY_NOT_ISSUED_TOTAL, not_issued);
+      INC_STAT_EVENT(node->proc_id, RS_0_OP_READY_NOT_ISSUED + (rs_id < 8 ? rs_id : 8), not_issued);
+    }
+
+    // FUs left without an op that no ready op of the RS could have used
+    for (uns64 idle = free_fus & ~wanted_fus; idle; idle &= idle - 1) {
+      Func_Unit* fu = rs->connected_fus[__builtin_ctzll(idle)];
+      if (fu->avail_cycle > cycle_count || fu->held_by_mem)
+        continue;
+      STAT_EVENT(node->proc_id, FU_IDLE_NO_READY_OPS_TOTAL);
+      STAT_EVENT(node->proc_id, FU_0_IDLE_NO_READY_OPS + (fu->fu_id < 32 ? fu->fu_id : 32));
+    }
+  }
+}
+
 /**************************************************************************************/
 /* Driven Table */
 
@@ -196,6 +430,8 @@ Dispatch_Func dispatch_func_table[NODE_ISSUE_QUEUE_DISPATCH_SCHEME_NUM] = {
 using Schedule_Func = void (*)(Op*);
 Schedule_Func schedule_func_table[NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_NUM] = {
     [NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_OLDEST_FIRST] = {node_schedule_oldest_first_sched},
+    // selects whole cycles from the ready bitmaps, see node_schedule_bitmap
+    [NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_BITMAP] = {NULL},
 };
 
 /**************************************************************************************/
@@ -227,6 +463,32 @@ void node_issue_queue_check_mem() {
  * Remove scheduled ops (i.e., going from RS to FUs) from the RS and ready queue
  */
 void node_issue_queue_clear() {
+  Node_Rdy_Bitmap* bm = node->rdy_bitmap;
+  if (bm) {
+    // only the ops selected in earlier cycles can have left the RS
+    for (uns32 w = 0; w < bm->num_words; ++w) {
+      for (uns64 word = bm->sched_bits[w]; word; word &= word - 1) {
+        uns32 slot = (w << 6) | __builtin_ctzll(word);
+        Op* op = bm->slot_ops[slot];
+        if (op->state == OS_IN_RS || op->state == OS_READY || op->state == OS_WAIT_FWD) {
+          // the FU did not take it, schedule it again
+          node_rdy_bitmap_unset(bm->sched_bits, slot);
+          continue;
+        }
+        if (op->state != OS_SCHEDULED && op->state != OS_MISS)
+          continue;
+
+        DEBUG(node->proc_id, "Removing from RS (and ready list)  op_num:%s op:%s l1:%d\n", unsstr64(op->op_num),
+              disasm_op(op, TRUE), op->engine_info.l1_miss);
+        ASSERT(node->proc_id, node->rs[op->rs_id].rs_op_count > 0);
+        node->rs[op->rs_id].rs_op_count--;
+        node_rdy_bitmap_leave_rs(bm, op);
+        STAT_EVENT(node->proc_id, OP_ISSUED);
+      }
+    }
+    return;
+  }
+
   // TODO: make this traversal more efficient since we know what ops we tried to schedule last cycle
   Op** last = &node->rdy_head;
   for (Op* op = node->rdy_head; op; op = op->next_rdy) {
@@ -271,6 +533,8 @@ void node_issue_queue_dispatch() {
     op->rs_id = (Counter)rs_id;
     rs->rs_op_count++;
     num_fill_rs++;
+    if (node->rdy_bitmap)
+      node_rdy_bitmap_enter_rs(node->rdy_bitmap, op, rs);
 
     DEBUG(node->proc_id, "Filling %s with op_num:%s (%d)\n", rs->name, unsstr64(op->op_num), rs->rs_op_count);
 
@@ -279,9 +543,7 @@ void node_issue_queue_dispatch() {
       DEBUG(node->proc_id, "Adding to ready list  op_num:%s op:%s l1:%d\n", unsstr64(op->op_num), disasm_op(op, TRUE),
             op->engine_info.l1_miss);
       op->state = (cycle_count + 1 >= op->rdy_cycle ? OS_READY : OS_WAIT_FWD);
-      op->next_rdy = node->rdy_head;
-      node->rdy_head = op;
-      op->in_rdy_list = TRUE;
+      node_issue_queue_add_ready(op);
     }
 
     // maximum number of operations to fill into the RS per cycle (0 = unlimited)
@@ -295,6 +557,37 @@ void node_issue_queue_dispatch() {
   node->next_op_into_rs = op;
 }
 
+/*
+ * Returns TRUE if a ready op can be handed to an FU this cycle
+ * (ops waiting on a memory request buffer are let go once one frees up).
+ */
+Flag node_issue_queue_op_schedulable(Op* op) {
+  if (op->state == OS_WAIT_MEM) {
+    if (node->mem_blocked)
+      return FALSE;
+    else
+      op->state = OS_READY;
+  }
+
+  if (op->state == OS_TENTATIVE || op->state == OS_WAIT_DCACHE)
+    return FALSE;
+
+  ASSERTM(node->proc_id, op->state == OS_IN_RS || op->state == OS_READY || op->state == OS_WAIT_FWD,
+          "op_num: %llu, op_state: %s\n", op->op_num, Op_State_str(op->state));
+  DEBUG(node->proc_id, "Scheduler examining    op_num:%s op:%s l1:%d st:%s rdy:%s exec:%s done:%s\n",
+        unsstr64(op->op_num), disasm_op(op, TRUE), op->engine_info.l1_miss, Op_State_str(op->state),
+        unsstr64(op->rdy_cycle), unsstr64(op->exec_cycle), unsstr64(op->done_cycle));
+
+  /* op will be ready next cycle, try to schedule */
+  if (cycle_count >= op->rdy_cycle - 1) {
+    ASSERT(node->proc_id, op->srcs_not_rdy_vector == 0x0);
+    DEBUG(node->proc_id, "Scheduler considering  op_num:%s op:%s l1:%d\n", unsstr64(op->op_num), disasm_op(op, TRUE),
+          op->engine_info.l1_miss);
+    return TRUE;
+  }
+  return FALSE;
+}
+
 /*
  * Schedule ready ops (ops that are currently in the ready list).
  *
@@ -316,33 +609,19 @@ void node_issue_queue_schedule() {
   // Check to see if the L1 Q is (still) full
   node_issue_queue_check_mem();
 
+  if (node->rdy_wheel)
+    node_rdy_wheel_drain(node->rdy_wheel);
+
+  if (node->rdy_bitmap) {
+    node_schedule_bitmap(node->rdy_bitmap);
+    return;
+  }
+
   for (Op* op = node->rdy_head; op; op = op->next_rdy) {
     ASSERT(node->proc_id, node->proc_id == op->proc_id);
     ASSERTM(node->proc_id, op->in_rdy_list, "op_num %llu\n", op->op_num);
-    if (op->state == OS_WAIT_MEM) {
-      if (node->mem_blocked)
-        continue;
-      else
-        op->state = OS_READY;
-    }
-
-    if (op->state == OS_TENTATIVE || op->state == OS_WAIT_DCACHE)
-      continue;
-
-    ASSERTM(node->proc_id, op->state == OS_IN_RS || op->state == OS_READY || op->state == OS_WAIT_FWD,
-            "op_num: %llu, op_state: %s\n", op->op_num, Op_State_str(op->state));
-    DEBUG(node->proc_id, "Scheduler examining    op_num:%s op:%s l1:%d st:%s rdy:%s exec:%s done:%s\n",
-          unsstr64(op->op_num), disasm_op(op, TRUE), op->engine_info.l1_miss, Op_State_str(op->state),
-          unsstr64(op->rdy_cycle), unsstr64(op->exec_cycle), unsstr64(op->done_cycle));
-
-    /* op will be ready next cycle, try to schedule */
-    if (cycle_count >= op->rdy_cycle - 1) {
-      ASSERT(node->proc_id, op->srcs_not_rdy_vector == 0x0);
-      DEBUG(node->proc_id, "Scheduler considering  op_num:%s op:%s l1:%d\n", unsstr64(op->op_num), disasm_op(op, TRUE),
-            op->engine_info.l1_miss);
-
+    if (node_issue_queue_op_schedulable(op))
       schedule_func_table[NODE_ISSUE_QUEUE_SCHEDULE_SCHEME](op);
-    }
   }
   // Track statistics for idle FUs when no ready ops are available
   node_track_fu_idle_stats();
@@ -356,7 +635,7 @@ void node_issue_queue_schedule() {
  * ready ops that could potentially be executed on it.
  */
 void node_track_fu_idle_stats(void) {
-  extern Exec_Stage* exec;  // Access to FUs through exec stage
+  extern CORE_LOCAL Exec_Stage* exec;  // Access to FUs through exec stage
 
   // Create ready_type vector for each RS to track which op types have ready ops
   uns64 ready_type_per_rs[NUM_RS] = {0};
@@ -364,8 +643,7 @@ void node_track_fu_idle_stats(void) {
   // Iterate over ready ops and set bits in ready_type corresponding to FU_TYPE of each op
   for (Op* op = node->rdy_head; op; op = op->next_rdy) {
     if ((op->state == OS_READY || op->state == OS_WAIT_FWD) && cycle_count >= op->rdy_cycle - 1) {
-      uns64 op_fu_type = get_fu_type(op->table_info->op_type, op->table_info->is_simd);
-      ready_type_per_rs[op->rs_id] |= op_fu_type;
+      ready_type_per_rs[op->rs_id] |= op->table_info->fu_type;
     }
   }
 
@@ -396,6 +674,97 @@ void node_track_fu_idle_stats(void) {
 /**************************************************************************************/
 /* External Function */
 
+void node_issue_queue_init() {
+  ASSERTM(node->proc_id, NODE_ISSUE_QUEUE_SCHEDULE_SCHEME < NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_NUM,
+          "Unknown NODE_ISSUE_QUEUE_SCHEDULE_SCHEME %u\n", NODE_ISSUE_QUEUE_SCHEDULE_SCHEME);
+  node->rdy_wheel = NULL;
+  if (NODE_RDY_WHEEL_SLOTS) {
+    Node_Rdy_Wheel* wheel = (Node_Rdy_Wheel*)calloc(1, sizeof(Node_Rdy_Wheel));
+    wheel->num_slots = 1;
+    while (wheel->num_slots < NODE_RDY_WHEEL_SLOTS)
+      wheel->num_slots <<= 1;
+    wheel->slot_heads = (Op**)calloc(wheel->num_slots, sizeof(Op*));
+    node->rdy_wheel = wheel;
+  }
+
+  node->rdy_bitmap = NULL;
+  if (NODE_ISSUE_QUEUE_SCHEDULE_SCHEME != NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_BITMAP)
+    return;
+
+  Node_Rdy_Bitmap* bm = (Node_Rdy_Bitmap*)calloc(1, sizeof(Node_Rdy_Bitmap));
+  // fused ops do not count against NODE_TABLE_SIZE: a ROB entry holds up to a load, its micro-fused cmp and the
+  // macro-fused jcc
+  bm->num_slots = 64;
+  while (bm->num_slots < 3 * NODE_TABLE_SIZE)
+    bm->num_slots <<= 1;
+  bm->num_words = bm->num_slots / 64;
+  bm->rdy_bits = (uns64*)calloc(NUM_RS * bm->num_words, sizeof(uns64));
+  bm->sched_bits = (uns64*)calloc(bm->num_words, sizeof(uns64));
+  bm->slot_ops = (Op**)calloc(bm->num_slots, sizeof(Op*));
+  node->rdy_bitmap = bm;
+}
+
+void node_issue_queue_reset() {
+  Node_Rdy_Wheel* wheel = node->rdy_wheel;
+  if (wheel) {
+    memset(wheel->slot_heads, 0, sizeof(Op*) * wheel->num_slots);
+    wheel->next_cycle = cycle_count;
+    wheel->count = 0;
+  }
+
+  Node_Rdy_Bitmap* bm = node->rdy_bitmap;
+  if (!bm)
+    return;
+
+  memset(bm->rdy_bits, 0, sizeof(uns64) * NUM_RS * bm->num_words);
+  memset(bm->sched_bits, 0, sizeof(uns64) * bm->num_words);
+  memset(bm->slot_ops, 0, sizeof(Op*) * bm->num_slots);
+  bm->head_seq = 0;
+  bm->next_seq = 0;
+  bm->rdy_count = 0;
+}
+
+void node_issue_queue_add_ready(Op* op) {
+  ASSERT(node->proc_id, !op->in_rdy_list);
+  op->in_rdy_list = TRUE;
+
+  Node_Rdy_Wheel* wheel = node->rdy_wheel;
+  if (wheel && op->rdy_cycle > cycle_count + 1) {
+    node_rdy_wheel_park(wheel, op);
+    wheel->count++;
+    return;
+  }
+
+  node_issue_queue_link_ready(op);
+}
+
+void node_issue_queue_flush() {
+  // parked ops leave the wheel first so the bitmaps below only see ops that hold a ready bit
+  if (node->rdy_wheel)
+    node_rdy_wheel_flush(node->rdy_wheel);
+
+  Node_Rdy_Bitmap* bm = node->rdy_bitmap;
+  if (!bm)
+    return;
+
+  /* Every op that entered an RS after the youngest surviving one is being flushed. Handing
+   * their age slots out again keeps the slots in use within one node table's worth of ops. */
+  for (; bm->next_seq > bm->head_seq; bm->next_seq--) {
+    Op* op = bm->slot_ops[node_rdy_bitmap_slot(bm, bm->next_seq - 1)];
+    if (!op)
+      continue;
+    if (!FLUSH_OP(op))
+      break;
+    ASSERT(node->proc_id, op->op_num > bp_recovery_info->recovery_op_num);
+    node_rdy_bitmap_leave_rs(bm, op);
+  }
+}
+
+Flag node_issue_queue_has_ready(Node_Stage* node_stage) {
+  return node_stage->rdy_head || (node_stage->rdy_bitmap && node_stage->rdy_bitmap->rdy_count) ||
+         (node_stage->rdy_wheel && node_stage->rdy_wheel->count);
+}
+
 void node_issue_queue_update() {
   /* remove scheduled ops from RS and ready list */
   node_issue_queue_clear();
@@ -46,16 +46,29 @@ typedef enum NODE_ISSUE_QUEUE_DISPATCH_SCHEME_enum {
 
 typedef enum NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_enum {
   NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_OLDEST_FIRST,
+  NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_BITMAP,
   NODE_ISSUE_QUEUE_SCHEDULE_SCHEME_NUM
 } Node_Issue_Queue_Schedule_Scheme;
 
 const static int64 NODE_ISSUE_QUEUE_RS_SLOT_INVALID = -1;
 const static int32 NODE_ISSUE_QUEUE_FU_SLOT_INVALID = -1;
 
+/**************************************************************************************/
+/* Types */
+
+struct Node_Stage_struct;
+
 /**************************************************************************************/
 /* External Methods */
 
+void node_issue_queue_init();
+void node_issue_queue_reset();
 void node_issue_queue_update();
+/* puts an op whose sources are all ready on the ready list (or in the ready bitmaps) */
+void node_issue_queue_add_ready(Op* op);
+/* drops the ops being flushed by the current recovery from the ready list/bitmaps */
+void node_issue_queue_flush();
+Flag node_issue_queue_has_ready(struct Node_Stage_struct* node_stage);
 
 #ifdef __cplusplus
 }
@@ -40,6 +40,7 @@
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
 #include "debug/memview.h"
+#include "debug/state_hash.h"
 
 #include "bp/bp.param.h"
 #include "core.param.h"
@@ -50,6 +51,8 @@
 #include "frontend/frontend.h"
 #include "memory/memory.h"
 
+#include "core_context.h"
+#include "crit_path.h"
 #include "decoupled_frontend.h"
 #include "exec_ports.h"
 #include "ft.h"
@@ -58,8 +61,10 @@
 #include "map.h"
 #include "map_rename.h"
 #include "node_issue_queue.h"
+#include "online_phase.h"
 #include "op_pool.h"
 #include "sim.h"
+#include "smt.h"
 #include "statistics.h"
 #include "thread.h"
 #include "xed-iclass-enum.h"
@@ -75,7 +80,7 @@
 /**************************************************************************************/
 /* Global Variables */
 
-Node_Stage* node = NULL;
+CORE_LOCAL Node_Stage* node = NULL;
 Rob_Stall_Reason rob_stall_reason = ROB_STALL_NONE;
 Rob_Block_Issue_Reason rob_block_issue_reason = ROB_BLOCK_ISSUE_NONE;
 
@@ -107,8 +112,8 @@ void node_fuse_op(Op* op);
 /**************************************************************************************/
 /* set_node_stage:*/
 
-void set_node_stage(Node_Stage* new_node) {
-  node = new_node;
+void set_node_stage(Core_Context* ctx) {
+  node = ctx->node;
 }
 
 /**************************************************************************************/
@@ -126,6 +131,7 @@ void init_node_stage(uns8 proc_id, const char* name) {
   node->sd.ops = (Op**)malloc(sizeof(Op*) * node->sd.max_op_count);
   // allocate FU to RS mapping array
   node->fu_to_rs_map = (int32*)malloc(sizeof(int32) * NUM_FUS);
+  node_issue_queue_init();
 
   reset_node_stage();
 }
@@ -144,6 +150,7 @@ void reset_node_stage() {
   node->node_head = NULL;
   node->node_tail = NULL;
   node->rdy_head = NULL;
+  node_issue_queue_reset();
   node->next_op_into_rs = NULL;
 
   node->node_count = 0;
@@ -155,6 +162,7 @@ void reset_node_stage() {
 
   node->node_precommit = NULL;
   node->prev_op_fusable = FALSE;
+  node->micro_fusable_op_num = 0;
 }
 
 /**************************************************************************************/
@@ -200,6 +208,7 @@ void flush_ready_list() {
     } else
       last = &op->next_rdy;
   }
+  node_issue_queue_flush();
 }
 
 void flush_scheduling_buffer() {
@@ -228,45 +237,54 @@ void flush_rs() {
 }
 
 void flush_window() {
-  Op* op;
-  Op** last;
   uns flush_ops = 0;
-  uns keep_ops = 0;
 
-  node->node_tail = NULL;
-  for (op = node->node_head, last = &node->node_head; op; op = *last) {
+  /* The flushed ops are the youngest ones in the window, and recover_thread has
+     already cut exactly those off the seq op list, so only they are visited */
+  for (int ii = 0; ii < td->seq_op_squash_count; ii++) {
+    Op* op = seq_op_list_squashed(td, ii);
     ASSERT(node->proc_id, node->proc_id == op->proc_id);
+    ASSERT(node->proc_id, FLUSH_OP(op));
+    if (!op->in_node_list)
+      continue; /* not in the window yet, the map stage flushes it */
+
+    DEBUG(node->proc_id, "Node flushing  op:%s\n", unsstr64(op->op_num));
+    if (!OP_FUSED(op))
+      flush_ops++;
+    op->in_node_list = FALSE;
+    if (op->state == OS_IN_RS || op->state == OS_READY || op->state == OS_WAIT_FWD) {
+      ASSERT(op->proc_id, node->rs[op->rs_id].rs_op_count > 0);
+      node->rs[op->rs_id].rs_op_count--;
+    }
+    if (op->parent_FT)
+      ft_free_op(op);
+  }
 
-    if (FLUSH_OP(op)) {
-      DEBUG(node->proc_id, "Node flushing  op:%s\n", unsstr64(op->op_num));
-      if (!op->macro_fused)
-        flush_ops++;
-      ASSERT(node->proc_id, op->op_num > bp_recovery_info->recovery_op_num);
-      op->in_node_list = FALSE;
-      *last = op->next_node;
-      if (op->state == OS_IN_RS || op->state == OS_READY || op->state == OS_WAIT_FWD) {
-        ASSERT(op->proc_id, node->rs[op->rs_id].rs_op_count > 0);
-        node->rs[op->rs_id].rs_op_count--;
-      }
-      if (op->parent_FT)
-        ft_free_op(op);
-    } else {
-      /* Keep op */
-
-      if (IS_FLUSHING_OP(op)) {
-        /* Mark that the scheduled recovery has occurred */
-        op->recovery_scheduled = FALSE;
-      }
-      DEBUG(node->proc_id, "Node keeping  op:%s node_id:%llu\n", unsstr64(op->op_num), op->node_id);
-      if (!op->macro_fused)
-        keep_ops++;
-      last = &op->next_node;
+  /* The youngest kept op in the window is the new tail */
+  node->node_tail = NULL;
+  for (int ii = td->seq_op_list.count - 1; ii >= 0; ii--) {
+    Op* op = RING_AT(&td->seq_op_list, Op*, ii);
+    if (op->in_node_list) {
       node->node_tail = op;
+      break;
+    }
+  }
+  if (node->node_tail)
+    node->node_tail->next_node = NULL;
+  else
+    node->node_head = NULL;
+
+  /* The recovering op is the youngest op kept in the seq op list */
+  if (td->seq_op_list.count) {
+    Op* op = RING_AT(&td->seq_op_list, Op*, td->seq_op_list.count - 1);
+    if (op->in_node_list && IS_FLUSHING_OP(op)) {
+      /* Mark that the scheduled recovery has occurred */
+      op->recovery_scheduled = FALSE;
     }
   }
 
-  ASSERT(node->proc_id, flush_ops + keep_ops == node->node_count);
-  node->node_count = keep_ops;
+  ASSERT(node->proc_id, flush_ops <= node->node_count);
+  node->node_count -= flush_ops;
   ASSERT(node->proc_id, node->node_count <= NODE_TABLE_SIZE);
 }
 
@@ -376,7 +394,8 @@ void debug_print_ready_list() {
 /**************************************************************************************/
 /* node_cycle: */
 
-void update_node_stage(Stage_Data* src_sd) {
+void update_node_stage(Core_Context* ctx, Stage_Data* src_sd) {
+  set_node_stage(ctx);
   DEBUG(node->proc_id, "Beginning '%s' stage\n", node->sd.name);
   STAT_EVENT(node->proc_id, NODE_CYCLE);
   STAT_EVENT(node->proc_id, POWER_CYCLE);
@@ -412,6 +431,8 @@ void node_fill_rob(Stage_Data* src_sd) {
   for (ii = 0; ii < src_sd->max_op_count; ii++) {
     /* if node table is full, stall */
     if (is_node_table_full()) {
+      if (node->node_count < NODE_TABLE_SIZE)
+        STAT_EVENT(node->proc_id, SMT_ROB_FULL_SHARED_CYCLES);
       collect_node_table_full_stats(node->node_head);
       rob_block_issue_reason = ROB_BLOCK_ISSUE_FULL;
       return;
@@ -442,6 +463,7 @@ void node_fill_rob(Stage_Data* src_sd) {
     src_sd->ops[ii] = NULL;
     src_sd->op_count--;
     ASSERT(node->proc_id, src_sd->op_count >= 0);
+    smt_op_left_frontend(op);
 
     /* set op fields */
     op->node_id = node->node_count;
@@ -460,9 +482,9 @@ void node_fill_rob(Stage_Data* src_sd) {
     if (!node->next_op_into_rs)   /* if there are no ops waiting to enter RS */
       node->next_op_into_rs = op; /* this will be the first one */
 
-    // Jump uop after CMP or TEST will be fused into one uop
+    // Jump uop after CMP or TEST (and the operate uop after a load) will be fused into one uop
     node_fuse_op(op);
-    if (!op->macro_fused)
+    if (!OP_FUSED(op))
       node->node_count++;
 
     ASSERTM(node->proc_id, node->node_count <= NODE_TABLE_SIZE,
@@ -589,11 +611,17 @@ void node_retire() {
       STAT_EVENT(op->proc_id, LD_EXEC_CYCLES_0 + (op->done_cycle - op->sched_cycle));
     }
     if (op->table_info->mem_type == MEM_LD) {
-      STAT_EVENT(op->proc_id, LD_NO_DEPENDENTS + (op->wake_up_head ? 1 : 0));
+      STAT_EVENT(op->proc_id, LD_NO_DEPENDENTS + (op->wake_up_count ? 1 : 0));
     }
     STAT_EVENT(op->proc_id, RET_OP_EXEC_COUNT_0 + MIN2(32, op->exec_count));
 
     op->retire_cycle = cycle_count;
+    if (CRIT_PATH)
+      crit_path_retire(op);
+    if (STATE_HASH_INTERVAL)
+      state_hash_retire(op);
+    if (PHASE_INTERVAL)
+      online_phase_op(op);
 
     // free the previous register entries with same architectural destination
     reg_file_commit(op);
@@ -610,7 +638,7 @@ void node_retire() {
       ft_free_op(op);
 
     // the fused op does not occupy the ROB entry
-    if (!op->macro_fused)
+    if (!OP_FUSED(op))
       node->node_count--;
 
     ASSERT(node->proc_id, node->node_count >= 0);
@@ -633,9 +661,9 @@ void node_retire() {
  * ready ops */
 
 Flag is_node_stage_stalled() {
-  return (node->node_count == NODE_TABLE_SIZE) && /* node table is full */
-         !node->rdy_head &&                       /* no ready ops */
-         !node->next_op_into_rs;                  /* no ops waiting to enter RS */
+  return is_node_table_full() &&               /* node table is full */
+         !node_issue_queue_has_ready(node) && /* no ready ops */
+         !node->next_op_into_rs;              /* no ops waiting to enter RS */
 }
 
 void debug_print_retired_uop(Op* op) {
@@ -665,7 +693,7 @@ Flag op_not_ready_for_retire(Op* op) {
 Flag is_node_table_empty() {
   if (node->node_count == 0) {
     if (node->node_head != NULL) {
-      ASSERT(node->proc_id, node->node_head->macro_fused);
+      ASSERT(node->proc_id, OP_FUSED(node->node_head));
       return FALSE;
     }
 
@@ -718,7 +746,7 @@ void collect_not_ready_to_retire_stats(Op* op) {
 
 Flag is_node_table_full() {
   ASSERT(node->proc_id, node->node_count <= NODE_TABLE_SIZE);
-  return (node->node_count == NODE_TABLE_SIZE);
+  return node->node_count == NODE_TABLE_SIZE || (SMT_THREADS > 1 && smt_rob_full(node->proc_id));
 }
 
 void collect_node_table_full_stats(Op* op) {
@@ -786,11 +814,25 @@ void node_precommit_retire(Op* op) {
   node->node_precommit = NULL;
 }
 
-/* Marcro-Fusion op */
+/* Macro- and micro-fusion of an op with the op dispatched before it */
 void node_fuse_op(Op* op) {
+  if (MICRO_FUSION) {
+    // the op after the first uop of an instruction is from the same instruction unless it starts one itself
+    if (!op->bom && op->op_num == node->micro_fusable_op_num && op->table_info->mem_type == NOT_MEM) {
+      op->micro_fused = TRUE;
+      STAT_EVENT(op->proc_id, OP_MICRO_FUSION_ONPATH + op->off_path);
+    }
+    node->micro_fusable_op_num = op->bom && op->table_info->mem_type == MEM_LD ? op->op_num + 1 : 0;
+  }
+
+  if (!MACRO_FUSION)
+    return;
+
   uns16 op_code = op->inst_info->table_info->true_op_type;
 
-  if (op_code == XED_ICLASS_CMP || op_code == XED_ICLASS_TEST) {
+  if (op_code == XED_ICLASS_CMP || op_code == XED_ICLASS_TEST ||
+      (MACRO_FUSION_ALU && (op_code == XED_ICLASS_ADD || op_code == XED_ICLASS_SUB || op_code == XED_ICLASS_AND ||
+                            op_code == XED_ICLASS_INC || op_code == XED_ICLASS_DEC))) {
     node->prev_op_fusable = TRUE;
     return;
   }
@@ -41,6 +41,7 @@ typedef struct Reservation_Station_struct {
   uns32 size;                          // 0 is infinite
   Func_Unit** connected_fus;           // FUs that this reservation station is connected to.
   uns32 num_fus;                       // number of fus that this rs is connected to.
+  uns64 fu_types;                      // union of the connected FUs' types, ops of other types can't use this rs
   uns32 rs_op_count;                   // number of ops in this reservation station
 } Reservation_Station;
 
@@ -53,11 +54,16 @@ typedef struct Node_Stage_struct {
   Op* node_precommit;  // the pre-commit pointer in the ROB
   int32 node_count;    // number of ops in the node table
 
-  Flag prev_op_fusable;  // if the next dispatched op is macro-fusable
+  Flag prev_op_fusable;            // if the next dispatched op is macro-fusable
+  Counter micro_fusable_op_num;    // op_num of the op that can micro-fuse with the last dispatched load (0 if none)
 
   /* linked-list of ops that are ready to schedule. Ops are put in here when they are issued,
    * or after they are issued and another op wakes them up. */
   Op* rdy_head;
+  /* age-indexed ready bitmaps that replace rdy_head under the BITMAP schedule scheme */
+  struct Node_Rdy_Bitmap_struct* rdy_bitmap;
+  /* ops on the ready list that cannot be scheduled before a later cycle, see NODE_RDY_WHEEL_SLOTS */
+  struct Node_Rdy_Wheel_struct* rdy_wheel;
 
   Counter ret_op;                // next op number to retire
   Counter last_scheduled_opnum;  // op num of the last scheduled op
@@ -75,18 +81,18 @@ typedef struct Node_Stage_struct {
 /**************************************************************************************/
 // External Variables
 
-extern Node_Stage* node;
+extern CORE_LOCAL Node_Stage* node;
 
 /**************************************************************************************/
 // Prototypes
 
-void set_node_stage(Node_Stage*);
+void set_node_stage(Core_Context*);
 void init_node_stage(uns8, const char*);
 void reset_node_stage(void);
 void reset_all_ops_node_stage(void);
 void recover_node_stage(void);
 void debug_node_stage(void);
-void update_node_stage(Stage_Data*);
+void update_node_stage(Core_Context*, Stage_Data*);
 Flag is_node_stage_stalled(void);
 
 /**************************************************************************************/
@@ -0,0 +1,327 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : online_phase.c
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Online phase detection with extrapolation of repeated phases
+ *                (PHASE_INTERVAL).
+ *
+ * The signature of an interval is a basic block vector projected on
+ * PHASE_SIG_DIMS buckets: every basic block adds its instruction count to the
+ * bucket its first PC hashes to.  At the end of an interval its normalized
+ * signature joins the nearest phase within PHASE_THRESHOLD, whose centroid is the
+ * mean of its members, or starts a new phase.  The next interval is predicted to
+ * be in the same phase.  Once PHASE_DETAILED_SAMPLES intervals of that phase were
+ * simulated in detail, the core drains and the following intervals are only
+ * warmed, like the functional part of SAMPLE_PERIOD, for as long as they land in
+ * such a phase.  Each warmed interval is credited the cycles and stat counts per
+ * instruction of the detailed intervals of its phase, or of the predicted phase
+ * when it landed in a phase with too few samples, which ends the warmed stretch.
+ ***************************************************************************************/
+
+#include "online_phase.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "general.param.h"
+
+#include "cmp_model_support.h"
+#include "decoupled_frontend.h"
+#include "freq.h"
+#include "sim.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define PHASE_SIG_BITS 5
+#define PHASE_SIG_DIMS (1 << PHASE_SIG_BITS)
+#define PHASE_MAX_PHASES 64
+#define PHASE_SIG_HASH(addr) ((uns)(((uns64)(addr)*0x9e3779b97f4a7c15ULL) >> (64 - PHASE_SIG_BITS)))
+
+/**************************************************************************************/
+/* Types */
+
+typedef enum Online_Phase_Mode_enum {
+  ONLINE_PHASE_DETAILED,
+  ONLINE_PHASE_DRAIN, /* stopped fetching before the warmed intervals */
+} Online_Phase_Mode;
+
+typedef struct Phase_struct {
+  double centroid[PHASE_SIG_DIMS];
+  uns intervals;           /* intervals in the phase */
+  uns detailed;            /* of them, simulated in detail */
+  Counter detailed_insts;  /* summed over the detailed intervals */
+  Counter detailed_cycles;
+  Counter* detailed_stats; /* NUM_GLOBAL_STATS counts */
+  Counter warmed_insts;    /* summed over the warmed intervals */
+} Phase;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Phase phases[PHASE_MAX_PHASES];
+static uns num_phases;
+static Online_Phase_Mode mode;
+static uns predicted; /* phase of the last detailed interval */
+static uns mispredicts;
+static uns warmed_intervals;
+
+static Counter sig[PHASE_SIG_DIMS]; /* of the current interval */
+static Addr block_start;
+static Counter block_insts;
+static Flag inst_cf; /* a uop of the current instruction is control flow */
+
+static Counter interval_start_inst;
+static Counter interval_start_cycle;
+static Counter* interval_start_stats;
+
+static Counter warm_cycles;     /* core cycles spent warming, which detailed runs do not have */
+static Counter* warm_stats;     /* stat counts added while warming */
+static double extrap_cycles;
+static double* extrap_stats;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static void online_phase_snapshot(Counter* counts);
+static void online_phase_start_interval(void);
+static uns online_phase_classify(void);
+static void online_phase_warm(uns proc_id);
+
+/**************************************************************************************/
+/* online_phase_init: */
+
+void online_phase_init(void) {
+  interval_start_stats = (Counter*)calloc(NUM_GLOBAL_STATS, sizeof(Counter));
+  warm_stats = (Counter*)calloc(NUM_GLOBAL_STATS, sizeof(Counter));
+  extrap_stats = (double*)calloc(NUM_GLOBAL_STATS, sizeof(double));
+  mode = ONLINE_PHASE_DETAILED;
+  online_phase_start_interval();
+}
+
+/**************************************************************************************/
+/* online_phase_op: */
+
+void online_phase_op(Op* op) {
+  if (!block_start)
+    block_start = op->inst_info->addr;
+  inst_cf |= op->table_info->cf_type != NOT_CF;
+  if (!op->eom)
+    return;
+  block_insts++;
+  if (inst_cf) {
+    sig[PHASE_SIG_HASH(block_start)] += block_insts;
+    block_start = 0;
+    block_insts = 0;
+  }
+  inst_cf = FALSE;
+}
+
+/**************************************************************************************/
+/* online_phase_snapshot: the stat counts of core 0 */
+
+static void online_phase_snapshot(Counter* counts) {
+  for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++)
+    counts[ii] = global_stat_values[0][ii].count;
+}
+
+/**************************************************************************************/
+/* online_phase_start_interval: the open basic block carries over */
+
+static void online_phase_start_interval(void) {
+  memset(sig, 0, sizeof(sig));
+  interval_start_inst = inst_count[0];
+  interval_start_cycle = cycle_count;
+  online_phase_snapshot(interval_start_stats);
+}
+
+/**************************************************************************************/
+/* online_phase_classify: the phase of the interval that just ended */
+
+static uns online_phase_classify(void) {
+  double norm[PHASE_SIG_DIMS];
+  Counter total = 0;
+  double best_dist = 3.0;
+  uns best = 0;
+
+  for (uns ii = 0; ii < PHASE_SIG_DIMS; ii++)
+    total += sig[ii];
+  for (uns ii = 0; ii < PHASE_SIG_DIMS; ii++)
+    norm[ii] = total ? (double)sig[ii] / total : 0.0;
+
+  for (uns pp = 0; pp < num_phases; pp++) {
+    double dist = 0.0;
+    for (uns ii = 0; ii < PHASE_SIG_DIMS; ii++)
+      dist += norm[ii] > phases[pp].centroid[ii] ? norm[ii] - phases[pp].centroid[ii]
+                                                 : phases[pp].centroid[ii] - norm[ii];
+    if (dist < best_dist) {
+      best_dist = dist;
+      best = pp;
+    }
+  }
+
+  if (!num_phases || (best_dist > PHASE_THRESHOLD && num_phases < PHASE_MAX_PHASES)) {
+    best = num_phases++;
+    phases[best].detailed_stats = (Counter*)calloc(NUM_GLOBAL_STATS, sizeof(Counter));
+  }
+  Phase* phase = &phases[best];
+  phase->intervals++;
+  for (uns ii = 0; ii < PHASE_SIG_DIMS; ii++)
+    phase->centroid[ii] += (norm[ii] - phase->centroid[ii]) / phase->intervals;
+  return best;
+}
+
+/**************************************************************************************/
+/* online_phase_warm: warms intervals while they land in phases with enough detailed
+   samples. Stats cleared meanwhile (CLEAR_STATS) count from zero. */
+
+static void online_phase_warm(uns proc_id) {
+  Counter* before = (Counter*)malloc(NUM_GLOBAL_STATS * sizeof(Counter));
+  Counter start_cycle = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+
+  /* the drain simulated the first instructions of the interval in detail */
+  online_phase_snapshot(before);
+  extrap_cycles -= cycle_count - interval_start_cycle;
+  for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++)
+    extrap_stats[ii] -= before[ii] >= interval_start_stats[ii] ? before[ii] - interval_start_stats[ii] : before[ii];
+
+  while (!retired_exit[proc_id] && (!INST_LIMIT || inst_count[proc_id] < inst_limit[proc_id])) {
+    Counter done = inst_count[proc_id] - interval_start_inst;
+    if (done < PHASE_INTERVAL)
+      sim_functional_warm(proc_id, PHASE_INTERVAL - done);
+    Counter insts = inst_count[proc_id] - interval_start_inst;
+    if (!insts)
+      break;
+
+    uns pp = online_phase_classify();
+    Flag known = phases[pp].detailed >= PHASE_DETAILED_SAMPLES;
+    Phase* source = phases[pp].detailed ? &phases[pp] : &phases[predicted];
+    double scale = (double)insts / source->detailed_insts;
+    extrap_cycles += scale * source->detailed_cycles;
+    for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++)
+      extrap_stats[ii] += scale * source->detailed_stats[ii];
+    phases[pp].warmed_insts += insts;
+    warmed_intervals++;
+    online_phase_start_interval();
+    if (!known) {
+      mispredicts++;
+      break;
+    }
+    predicted = pp;
+  }
+
+  for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
+    Counter now = global_stat_values[0][ii].count;
+    warm_stats[ii] += now >= before[ii] ? now - before[ii] : now;
+  }
+  warm_cycles += freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]) - start_cycle;
+  interval_start_cycle = freq_cycle_count(FREQ_DOMAIN_CORES[proc_id]);
+  online_phase_snapshot(interval_start_stats);
+  free(before);
+}
+
+/**************************************************************************************/
+/* online_phase_cycle: */
+
+void online_phase_cycle(uns proc_id) {
+  if (sim_done[proc_id] || retired_exit[proc_id])
+    return;
+
+  switch (mode) {
+    case ONLINE_PHASE_DETAILED:
+      if (inst_count[proc_id] - interval_start_inst >= PHASE_INTERVAL) {
+        uns pp = online_phase_classify();
+        Phase* phase = &phases[pp];
+        phase->detailed++;
+        phase->detailed_insts += inst_count[proc_id] - interval_start_inst;
+        phase->detailed_cycles += cycle_count - interval_start_cycle;
+        for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
+          Counter now = global_stat_values[0][ii].count;
+          phase->detailed_stats[ii] += now >= interval_start_stats[ii] ? now - interval_start_stats[ii] : now;
+        }
+        online_phase_start_interval();
+        predicted = pp;
+        if (phase->detailed >= PHASE_DETAILED_SAMPLES) {
+          decoupled_fe_stall_on_path(proc_id, TRUE);
+          mode = ONLINE_PHASE_DRAIN;
+        }
+      }
+      break;
+    case ONLINE_PHASE_DRAIN:
+      if (cmp_is_drained(proc_id)) {
+        online_phase_warm(proc_id);
+        decoupled_fe_stall_on_path(proc_id, FALSE);
+        mode = ONLINE_PHASE_DETAILED;
+      }
+      break;
+  }
+}
+
+/**************************************************************************************/
+/* online_phase_done: the counts of a stat are the detailed ones (without what
+   warming added) plus the extrapolated ones */
+
+void online_phase_done(void) {
+  Counter detailed_cycles = cycle_count - warm_cycles;
+  double cycles = detailed_cycles + extrap_cycles;
+
+  fprintf(mystdout,
+          "** Online phases: %u phases, %u warmed intervals (%u mispredicted), estimated cycles %.0f, CPI %.4f\n",
+          num_phases, warmed_intervals, mispredicts, cycles, inst_count[0] ? cycles / inst_count[0] : 0.0);
+
+  FILE* file = file_tag_fopen(OUTPUT_DIR, "phase.out", "w");
+  if (!file)
+    return;
+  fprintf(file, "interval %llu  phases %u  warmed intervals %u  mispredicted %u\n", PHASE_INTERVAL, num_phases,
+          warmed_intervals, mispredicts);
+  fprintf(file, "detailed cycles %llu  extrapolated cycles %.0f  estimated cycles %.0f\n\n", detailed_cycles,
+          extrap_cycles, cycles);
+  fprintf(file, "%-6s %-10s %-10s %-14s %-10s %s\n", "phase", "intervals", "detailed", "detailed_insts", "CPI",
+          "warmed_insts");
+  for (uns pp = 0; pp < num_phases; pp++) {
+    Phase* phase = &phases[pp];
+    fprintf(file, "%-6u %-10u %-10u %-14llu %-10.4f %llu\n", pp, phase->intervals, phase->detailed,
+            phase->detailed_insts, phase->detailed_insts ? (double)phase->detailed_cycles / phase->detailed_insts : 0.0,
+            phase->warmed_insts);
+  }
+
+  fprintf(file, "\n%-48s %14s %14s\n", "stat", "detailed", "estimated");
+  for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
+    Counter count = global_stat_values[0][ii].count;
+    Counter detailed = count >= warm_stats[ii] ? count - warm_stats[ii] : 0;
+    if (!detailed && !extrap_stats[ii])
+      continue;
+    fprintf(file, "%-48s %14llu %14.0f\n", global_stat_array[0][ii].name, detailed, detailed + extrap_stats[ii]);
+  }
+  fclose(file);
+}
@@ -0,0 +1,54 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : online_phase.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Online phase detection with extrapolation of repeated phases
+ *                (PHASE_INTERVAL).
+ ***************************************************************************************/
+
+#ifndef __ONLINE_PHASE_H__
+#define __ONLINE_PHASE_H__
+
+#include "globals/global_types.h"
+
+#include "op.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+void online_phase_init(void);
+
+/* adds an instruction to the signature of the current interval: called for the
+   retired ops of detailed intervals and the fetched ops of warmed ones */
+void online_phase_op(Op* op);
+
+/* called every cycle: ends detailed intervals and runs the warmed ones */
+void online_phase_cycle(uns proc_id);
+
+/* prints the estimate and writes phase.out with the phases and extrapolated stats */
+void online_phase_done(void);
+
+#endif /* #ifndef __ONLINE_PHASE_H__ */
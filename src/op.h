@@ -45,6 +45,7 @@ typedef struct FT FT;
 
 #define OP_SRCS_RDY(x) ((x)->srcs_not_rdy_vector == 0 && cycle_count >= (x)->rdy_cycle)
 #define OP_DONE(x) (cycle_count >= (x)->done_cycle)
+#define OP_FUSED(x) ((x)->macro_fused || (x)->micro_fused) /* shares the ROB entry of the op before it */
 #define OP_BROADCAST(x) ((cycle_count + 1) >= (x)->done_cycle)
 #define MULTI_CYCLE_OP(x) ((x)->inst_info->latency > 1 + RFILE_STAGE || (x)->table_info->mem_type == MEM_LD)
 #define MAX_STRANDS 400
@@ -73,14 +74,30 @@ DECLARE_ENUM(Op_State, OP_STATE_LIST, OS_);
 
 /**************************************************************************************/
 
+#define WAKE_UP_INLINE_ENTRIES 2 /* entries of each wake up list kept in the op itself */
+#define WAKE_UP_CHUNK_ENTRIES 6  /* entries per overflow chunk */
+
 typedef struct Wake_Up_Entry_struct {
   Op* op;
   Counter unique_num;
-  Dep_Type dep_type;
   uns8 rdy_bit;
-  struct Wake_Up_Entry_struct* next;
 } Wake_Up_Entry;
 
+/* overflow chunks come from a per-core pool in map.c */
+typedef struct Wake_Up_Chunk_struct {
+  Wake_Up_Entry entries[WAKE_UP_CHUNK_ENTRIES];
+  struct Wake_Up_Chunk_struct* next;
+} Wake_Up_Chunk;
+
+/* the ops dependent on an op through one dependency type, in the order they were added: the first
+   WAKE_UP_INLINE_ENTRIES inline, the rest in chunks */
+typedef struct Wake_Up_List_struct {
+  uns count;
+  Wake_Up_Entry inline_entries[WAKE_UP_INLINE_ENTRIES];
+  Wake_Up_Chunk* overflow_head;
+  Wake_Up_Chunk* overflow_tail;
+} Wake_Up_List;
+
 // per branch stats
 typedef struct Per_Branch_Stat_struct {
   Addr addr;
@@ -113,6 +130,7 @@ typedef struct Recovery_Info_struct {  // QUESTION no proc_id?
   Addr branchTarget;
   int64 branch_id;  // set by the branch predictor timestamp_func().
   uns64 predict_cycle;
+  int64 shadow_branch_id[MAX_SHADOW_BPS];  // set by the shadow branch predictors' timestamp_func().
 } Recovery_Info;
 
 typedef struct Dp_Info_struct {
@@ -127,24 +145,46 @@ typedef struct Dp_Info_struct {
 /* typedef in globals/global_types.h */
 
 struct Op_struct {
+  // {{{ hot fields --- read by every ready-list walk in the node stage and by
+  // wake_up_ops on each dependent op.  They fill the first cache line of the
+  // op (ops are 64-byte aligned, see op_pool.c); the second line holds the
+  // rest of the scheduling state.
+  struct Op_struct* next_rdy;   // pointer to next ready op (node table)
+  Counter rdy_cycle;            // cycle when the final source value is available to the op (only useful when vector is clear)
+  Counter unique_num;           // unique number for each instance of an op (not reset on recovery)
+  Counter rs_id;                // id for which Reservation Station (RS) this op is assigned to
+  Table_Info* table_info;       // copy of info->table_info to limit pointer chasing
+  Op_State state;               // the state of the op in the datapath
+  uns srcs_not_rdy_vector;      // bits as given by order in the src_info array
+  uns proc_id;                  // processor id for cmp model
+  Flag op_pool_valid;           // is op allocated from the op_pool?
+  Flag in_rdy_list;             // is the op in the node stage's ready list?
+  Flag in_node_list;            // is the op in the node list?
+  Flag in_smt_icount;           // is the op counted in the ICOUNT of its thread? (smt.c)
+  Flag off_path;                // is the op on the correct path of the program? - oracle information
+
+  Counter wake_cycle;           // used by wake up logic for time wake up signal is sent
+  struct Op_struct* next_node;  // pointer to the next op in the node table
+  Counter op_num;               // op number
+  Counter issue_cycle;          // cycle an individual instruction is issued -- same as chkpt
+  uns fu_num;                   // functional unit number the op will or did execute on
+  Counter rs_age_seq;           // RS dispatch sequence number, picks the op's age slot in the BITMAP scheduler
+  uns64 rs_fu_mask;             // bit i set if the RS's connected_fus[i] can execute the op (BITMAP scheduler)
+  // }}}
+
   // {{{ op_pool stuff --- don't use outside of op pool management
-  Flag op_pool_valid;  // is op allocated from the op_pool?
   Op* op_pool_next;    // either next free or next active op
   uns op_pool_id;      // unique identifier for op (doesn't change)
   // }}}
 
   // {{{ op numbers and info pointers
-  uns proc_id;                  // processor id for cmp model
   uns thread_id;                // id number for the thread to which this op belongs
   Flag bom;                     // begining of macro instruction when we use op as a uop
   Flag eom;                     // end of macro instruction when we use op as a uop
   Flag fetched_instruction;     // is this op fetched or a rep op?
-  Counter op_num;               // op number
-  Counter unique_num;           // unique number for each instance of an op (not reset on recovery)
   Counter unique_num_per_proc;  // unique number per core
   uns64 inst_uid;               // unique number for the macro instruction provided by the frontend (PIN)
   Counter addr_pred_num;        // unique number for each address prediction
-  Table_Info* table_info;       // copy of info->table_info to limit pointer chasing
   Inst_Info* inst_info;         // pointer to unique struct for each static instruction
   Op_Info oracle_info;          // information about the execution of the op in the oracle
   Op_Info engine_info;          // information about the execution of the op in the engine
@@ -160,12 +200,9 @@ struct Op_struct {
   uns32  bp_perceptron_index;    /* Table index used */
 
   // {{{ state and event cycle counters
-  Op_State state;        // the state of the op in the datapath
   Counter fetch_cycle;   // cycle an individual instruction is fetched
   Counter bp_cycle;      // cycle a CF instruction accesses the branch predictor
   Counter map_cycle;     // cycle an individual instruction enters the map stage
-  Counter issue_cycle;   // cycle an individual instruction is issued -- same as chkpt
-  Counter rdy_cycle;     // cycle when the final source value is available to the op (only useful when vector is clear)
   Counter sched_cycle;   // cycle when the op is scheduled (arrives at the functional unit)
   Counter exec_cycle;    // cycle when execution (or addr gen) of op will be completed (result usable)
   Counter dcache_cycle;  // cycle when the op accesses the dcache
@@ -178,7 +215,6 @@ struct Op_struct {
   // }}}
 
   // {{{ path and fetch info
-  Flag off_path;                // is the op on the correct path of the program? - oracle information
   Flag conf_off_path;           // is the op on the correct path of the program? - confidence information
   Flag exit;                    // is this the last instruction to execute?
   Flag prog_input;              // is this op directly related to an input value of the program ?
@@ -187,17 +223,13 @@ struct Op_struct {
   // }}}
 
   // {{{ scheduler information
-  uns fu_num;         // functional unit number the op will or did execute on
   Counter node_id;    // id for position in the node table
-  Counter rs_id;      // id for which Reservation Station (RS) this op is assigned to
   Counter chkpt_num;  // id for chkpt (WARNING: this can change due to recoveries)
 
-  struct Op_struct* next_rdy;   // pointer to next ready op (node table)
-  Flag in_rdy_list;             // is the op in the node stage's ready list?
-  struct Op_struct* next_node;  // pointer to the next op in the node table
-  Flag in_node_list;            // is the op in the node list?
   Flag precommitted;            // if the op is pre-commit in the ROB
   Flag macro_fused;             // if the op should be fused with the previous op (CMP/TEST)
+  Flag micro_fused;             // if the op is fused with the load uop of its instruction before it
+  Counter mem_dep_pred_op_num;  // store the store-set predictor makes the load wait for (0 if none)
   Flag move_eliminated;         // if the op can be move-eliminated
   Flag replay;                  // is the op waiting to replay?
   uns replay_count;             // number of times the op has replayed
@@ -206,12 +238,9 @@ struct Op_struct {
   // }}}
 
   // {{{ dependency information
-  uns srcs_not_rdy_vector;               // bits as given by order in the src_info array
-  Flag wake_up_signaled[NUM_DEP_TYPES];  // set to true once a wake up has been signaled by the op for the given type
-  Wake_Up_Entry* wake_up_head;           // list of ops that are dependent on this op, by dependency type
-  Wake_Up_Entry* wake_up_tail;           // last entry in each wake up list (for speed)
-  uns wake_up_count;                     // count of ops to be awakened by this op (wake up list length)
-  Counter wake_cycle;                    // used by wake up logic for time wake up signal is sent
+  Flag wake_up_signaled[NUM_DEP_TYPES];       // set once a wake up has been signaled by the op for the given type
+  Wake_Up_List wake_up_lists[NUM_DEP_TYPES];  // ops that are dependent on this op, by dependency type
+  uns wake_up_count;                          // count of ops to be awakened by this op (all wake up lists)
   // }}}
 
   struct Mem_Req_struct* req;  // pointer to memory request responsible for waking up the op
@@ -279,7 +308,7 @@ struct Op_struct {
   // }}}
   FT* parent_FT;
   FT* parent_FT_off_path;
-};
+} __attribute__((aligned(64)));
 
 /**************************************************************************************/
 
@@ -37,6 +37,7 @@
 
 #define MAX_DEPS 128
 #define MAX_OUTS 3
+#define MAX_SHADOW_BPS 4 /* shadow branch predictors, see bp/bp_shadow.h */
 
 /**************************************************************************************/
 
@@ -62,6 +63,12 @@ typedef struct Src_Info_struct {
   Quad val;
 } Src_Info;
 
+/* the sources of a mapped op, from a per-core pool in map.c */
+typedef union Src_Block_union {
+  Src_Info entries[MAX_DEPS];
+  union Src_Block_union* next;  // next free block
+} Src_Block;
+
 /**************************************************************************************/
 /* The 'Op_Info' struct holds information that is unique to the
  * current instance of the instruction (data values, etc.)
@@ -72,7 +79,7 @@ struct Op_Info_struct {
   struct Inst_Info_struct* inst_info;    // copy of op->inst_info
 
   uns num_srcs;                 // number of dependencies to obey
-  Src_Info src_info[MAX_DEPS];  // information about each source
+  Src_Info* src_info;           // information about each source (a Src_Block once the op is mapped, NULL before)
   Flag update_fpcr;             // need to update the fpcr
   UQuad new_fpcr;               // fpcr value resulting from this op
 
@@ -122,6 +129,8 @@ struct Op_Info_struct {
   uns8 pred_tc_selector_entry;  // which ibtb predicted this op?
   Flag ibp_miss;                // true if the target is not predicted by the indirect pred
 
+  uns8 shadow_pred[MAX_SHADOW_BPS];  // directions predicted by the shadow branch predictors
+
   Flag dcmiss;  // dcache miss has occurred
 
   Flag pred_conf;
@@ -138,6 +147,7 @@ struct Op_Info_struct {
   Flag l1_miss_satisfied;   // l1 miss caused by this op is already satisfied
   Flag dep_on_l1_miss;      // op is waiting for an l1_miss to be satisfied
   Flag was_dep_on_l1_miss;  // op was waiting for an l1_miss to be satisfied, but not any more
+  uns l1_miss_dep_srcs;     // wake up entries from srcs waiting for an l1_miss (dep_on_l1_miss if nonzero)
 
   uns32 error_event;  // bit vector for the unexpected events generated by this op (error_event.h)
 };
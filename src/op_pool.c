@@ -30,6 +30,8 @@ allocates them once and then hands out pointers every time 'alloc_op' is called.
 
 #include "op_pool.h"
 
+#include <stdlib.h>
+
 #include "globals/assert.h"
 #include "globals/global_defs.h"
 #include "globals/global_types.h"
@@ -47,10 +49,12 @@ allocates them once and then hands out pointers every time 'alloc_op' is called.
 #include "bp/bp.h"
 #include "frontend/frontend_intf.h"
 #include "frontend/pin_trace_fe.h"
+#include "libs/table_alloc.h"
 
 #include "map.h"
 #include "model.h"
 #include "sim.h"
+#include "smt.h"
 
 /**************************************************************************************/
 /* Macros */
@@ -58,15 +62,20 @@ allocates them once and then hands out pointers every time 'alloc_op' is called.
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_OP_POOL, ##args)
 #define DEBUGU(proc_id, args...) _DEBUGU(proc_id, DEBUG_OP_POOL, ##args)
 
-// TODO: it should be increased to 512 to use more than 50,000 FDIP lookahead buffer entries
 #define OP_POOL_ENTRIES_INC 128 /* default 128 */
+/* ops waiting in a deep FTQ (FDIP lookahead) come from the pool too; they do not carry
+   the src arrays (map.c attaches those), so a large pool stays affordable */
+#define OP_POOL_MAX_SLABS 1024
 
 /**************************************************************************************/
 /* Global variables */
 
+/* The counters are shared by all cores and updated atomically.  The free list
+   is per host thread so that parallel core workers (PARALLEL_CORES) can
+   allocate and free ops without locking. */
 uns op_pool_entries = 0;
 uns op_pool_active_ops = 0;
-static Op* op_pool_free_head;
+static CORE_LOCAL Op* op_pool_free_head;
 
 Op invalid_op;
 
@@ -74,6 +83,7 @@ Op invalid_op;
 /* Prototypes */
 
 static inline void expand_op_pool(void);
+static void release_op(Op* op);
 
 /**************************************************************************************/
 /* init_op_pool: */
@@ -110,7 +120,7 @@ Op* alloc_op(uns proc_id) {
   Op* new_op;
 
   if (op_pool_free_head == NULL) {
-    ASSERT(0, op_pool_active_ops == op_pool_entries);
+    ASSERT(0, PARALLEL_CORES || op_pool_active_ops == op_pool_entries);
     expand_op_pool();
   }
 
@@ -120,7 +130,7 @@ Op* alloc_op(uns proc_id) {
 
   op_pool_setup_op(proc_id, new_op);
 
-  op_pool_active_ops++;
+  __atomic_fetch_add(&op_pool_active_ops, 1, __ATOMIC_RELAXED);
   DEBUG(0, "Allocating op  id:%u  op_pool_active_ops:%u  op_pool_entries:%d\n", new_op->op_pool_id, op_pool_active_ops,
         op_pool_entries);
   op_pool_free_head = new_op->op_pool_next;
@@ -132,6 +142,35 @@ Op* alloc_op(uns proc_id) {
 /* free_op:  "frees" an op */
 
 void free_op(Op* op) {
+  release_op(op);
+  __atomic_fetch_sub(&op_pool_active_ops, 1, __ATOMIC_RELAXED);
+  DEBUG(0, "Freed op  id:%u  op_pool_active_ops: %u\n", op->op_pool_id, op_pool_active_ops);
+
+  op->op_pool_next = op_pool_free_head;
+  op_pool_free_head = op;
+}
+
+/**************************************************************************************/
+/* free_ops: frees num ops at once (e.g. all the ops of a squashed FT), taking
+   them off the active count with one update instead of one per op */
+
+void free_ops(Op* const* ops, uns num) {
+  Op* head = op_pool_free_head;
+  for (uns ii = 0; ii < num; ii++) {
+    release_op(ops[ii]);
+    ops[ii]->op_pool_next = head;
+    head = ops[ii];
+  }
+  op_pool_free_head = head;
+  ASSERTM(0, op_pool_active_ops >= num, "op_pool_active_ops:%u  num:%u\n", op_pool_active_ops, num);
+  __atomic_fetch_sub(&op_pool_active_ops, num, __ATOMIC_RELAXED);
+  DEBUG(0, "Freed %u ops  op_pool_active_ops: %u\n", num, op_pool_active_ops);
+}
+
+/**************************************************************************************/
+/* release_op: everything freeing an op does except returning it to the pool */
+
+static void release_op(Op* op) {
   ASSERT(0, op);
   ASSERT(0, op->op_pool_valid);
   ASSERT(0, !op->marked);
@@ -140,9 +179,6 @@ void free_op(Op* op) {
     pipeview_print_op(op);
 
   op->op_pool_valid = FALSE;
-  op_pool_active_ops--;
-  ASSERTM(0, op_pool_active_ops >= 0, "op_pool_active_ops:%u\n", op_pool_active_ops);
-  DEBUG(0, "Freed op  id:%u  op_pool_active_ops: %u\n", op->op_pool_id, op_pool_active_ops);
 
   if (op->sched_info)
     free(op->sched_info);
@@ -158,9 +194,12 @@ void free_op(Op* op) {
     op->inst_info = NULL;
   }
 
-  op->op_pool_next = op_pool_free_head;
-  op_pool_free_head = op;
+  if (TRACK_L1_MISS_DEPS)
+    release_l1_miss_deps(op);
+  if (op->in_smt_icount)
+    smt_op_left_frontend(op);
   free_wake_up_list(op);
+  free_src_info(op);
 }
 
 /**************************************************************************************/
@@ -215,8 +254,11 @@ void op_pool_setup_op(uns proc_id, Op* op) {
   op->exec_count = 0;
   op->in_rdy_list = FALSE;
   op->in_node_list = FALSE;
+  op->in_smt_icount = FALSE;
   op->precommitted = FALSE;
   op->macro_fused = FALSE;
+  op->micro_fused = FALSE;
+  op->mem_dep_pred_op_num = 0;
   op->move_eliminated = FALSE;
 
   op->req = NULL;
@@ -228,6 +270,7 @@ void op_pool_setup_op(uns proc_id, Op* op) {
   op->same_src_last_op = 0;
 
   op->oracle_info.num_srcs = 0;
+  op->oracle_info.src_info = NULL;
   op->oracle_info.update_fpcr = FALSE;
   op->oracle_info.error_event = 0;
   op->oracle_info.mispred = FALSE;
@@ -242,7 +285,9 @@ void op_pool_setup_op(uns proc_id, Op* op) {
   op->engine_info.l1_miss_satisfied = FALSE;
   op->engine_info.dep_on_l1_miss = FALSE;
   op->engine_info.was_dep_on_l1_miss = FALSE;
+  op->engine_info.l1_miss_dep_srcs = 0;
   op->engine_info.num_srcs = 0;
+  op->engine_info.src_info = NULL;
   op->engine_info.update_fpcr = FALSE;
 
   op->recovery_scheduled = FALSE;
@@ -269,22 +314,31 @@ void op_pool_setup_op(uns proc_id, Op* op) {
 /**************************************************************************************/
 /* expand_op_pool: */
 
+/* Ops are carved out of slabs of OP_POOL_ENTRIES_INC entries.  Op is declared
+   64-byte aligned (the hot scheduling fields sit in its first two cache
+   lines), which calloc does not guarantee, so the slab comes from
+   table_alloc, which returns zeroed, 64-byte aligned memory.  The slab is cleared and
+   linked by the host thread that will use it: under PARALLEL_CORES every
+   worker grows its own free list, so with the kernel's first-touch policy each
+   core's ops land on the NUMA node of the thread that simulates it. */
 static inline void expand_op_pool() {
-  Op* new_pool = (Op*)calloc(OP_POOL_ENTRIES_INC, sizeof(Op));
+  Op* new_pool = NULL;
   uns ii;
 
+  new_pool = (Op*)table_alloc("op_pool", OP_POOL_ENTRIES_INC * sizeof(Op));
+
   DEBUGU(0, "Expanding op pool to size %d\n", op_pool_entries + OP_POOL_ENTRIES_INC);
   for (ii = 0; ii < OP_POOL_ENTRIES_INC - 1; ii++) {
     new_pool[ii].op_pool_valid = FALSE;
     new_pool[ii].op_pool_next = &new_pool[ii + 1];
-    new_pool[ii].op_pool_id = op_pool_entries++;
+    new_pool[ii].op_pool_id = __atomic_fetch_add(&op_pool_entries, 1, __ATOMIC_RELAXED);
     op_pool_init_op(&new_pool[ii]);
   }
   new_pool[ii].op_pool_valid = FALSE;
   new_pool[ii].op_pool_next = op_pool_free_head;
-  new_pool[ii].op_pool_id = op_pool_entries++;
+  new_pool[ii].op_pool_id = __atomic_fetch_add(&op_pool_entries, 1, __ATOMIC_RELAXED);
   op_pool_init_op(&new_pool[ii]);
 
   op_pool_free_head = &new_pool[0];
-  ASSERT(0, op_pool_entries <= OP_POOL_ENTRIES_INC * 128);
+  ASSERT(0, op_pool_entries <= OP_POOL_ENTRIES_INC * OP_POOL_MAX_SLABS);
 }
@@ -49,6 +49,7 @@ void init_op_pool(void);
 void reset_op_pool(void);
 Op* alloc_op(uns proc_id);
 void free_op(Op*);
+void free_ops(Op* const* ops, uns num);
 void op_pool_init_op(Op*);
 void op_pool_setup_op(uns proc_id, Op* op);
 
@@ -37,6 +37,7 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <math.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -55,7 +56,9 @@
 
 #include "general.param.h"
 
+#include "stat_mon.h"
 #include "statistics.h"
+#include "trigger.h"
 
 #define DEBUG(proc_id, args...) _DEBUGU(proc_id, DEBUG_OPTIMIZER2, ##args)
 
@@ -107,6 +110,10 @@ static FILE* read_stream;
 static FILE* feedback_read_stream;
 static FILE* feedback_write_stream;
 void (*setup_param_fn)(int) = NULL;
+static const Opt2_Client* client = NULL;
+static Stat_Mon* client_stat_mon;
+static Trigger* client_start;
+static Trigger* client_period;
 
 static void init_slave(void);
 static void send_msg(FILE* stream, Message_Type type, Counter data);
@@ -380,6 +387,58 @@ void opt2_decision_point(void) {
   spawn_children();
 }
 
+void opt2_client_init(const Opt2_Client* new_client) {
+  ASSERTM(0, !client, "optimizer2 is already exploring %s, cannot also explore %s\n", client ? client->name : "",
+          new_client->name);
+  ASSERT(0, new_client->num_configs > 0);
+  client = new_client;
+  if (client->period) {
+    client_start = trigger_create("OPT2 START", client->start, TRIGGER_ONCE);
+    client_period = trigger_create("OPT2 PERIOD", client->period, TRIGGER_REPEAT);
+  }
+  if (!client->metric) {
+    Stat_Enum monitored_stats[] = {NODE_INST_COUNT, EXECUTION_TIME};
+    client_stat_mon = stat_mon_create_from_array(monitored_stats, NUM_ELEMENTS(monitored_stats));
+  }
+  MESSAGEU(0, "optimizer2 exploring %u %s configs\n", client->num_configs, client->name);
+  client->setup_config(0);
+  opt2_init(client->num_configs, 1, client->setup_config);
+}
+
+/* -gmean of the instructions per unit of time of the cores */
+static double client_metric(void) {
+  if (client->metric)
+    return client->metric();
+  double ipt_product = 1.0;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Counter insts = stat_mon_get_count(client_stat_mon, proc_id, NODE_INST_COUNT);
+    Counter exec_time = stat_mon_get_count(client_stat_mon, proc_id, EXECUTION_TIME);
+    ipt_product *= exec_time ? (double)insts / (double)exec_time : 0.0;
+  }
+  return -pow(ipt_product, 1.0 / NUM_CORES);
+}
+
+void opt2_client_decide(void) {
+  ASSERT(0, client);
+  opt2_comparison_barrier(client_metric());
+  // we passed the barrier
+  opt2_decision_point();
+  if (client_stat_mon)
+    stat_mon_reset(client_stat_mon);
+}
+
+void opt2_client_cycle(void) {
+  if (!client || !client->period)
+    return;
+  if (trigger_fired(client_period) && trigger_on(client_start))
+    opt2_client_decide();
+}
+
+void opt2_client_done(void) {
+  if (client)
+    opt2_comparison_barrier(client_metric());
+}
+
 void opt2_sim_complete(void) {
   send_msg(feedback_write_stream, OPT_SIM_COMPLETE, 0);
   slave_clean_up();
@@ -47,6 +47,30 @@ void opt2_decision_point(void);
 /* Called by slave when its simulation is complete */
 void opt2_sim_complete(void);
 
+/* A component whose configuration is chosen at run time by forking a slave per
+   configuration at each decision point and keeping the best one at the next. Only one
+   client can be active per run. */
+typedef struct Opt2_Client_struct {
+  const char* name;
+  uns num_configs;
+  void (*setup_config)(int config); /* switch to config in a freshly forked slave */
+  double (*metric)(void);           /* score of the interval, lower is better (NULL: -gmean IPT) */
+  const char* start;                /* trigger specs of the decision points, NULL period if */
+  const char* period;               /*   the client calls opt2_client_decide() itself */
+} Opt2_Client;
+
+/* Start exploring the client's configurations (forks the master), starting from config 0 */
+void opt2_client_init(const Opt2_Client* client);
+
+/* Compare the slaves on the interval that just ended and spawn the configurations again */
+void opt2_client_decide(void);
+
+/* Called every cycle: decides at the client's period */
+void opt2_client_cycle(void);
+
+/* Report the last interval before the simulation completes */
+void opt2_client_done(void);
+
 /* Is optimizer2 being used? */
 Flag opt2_in_use(void);
 
@@ -38,8 +38,17 @@ still possible to pass command-line arguments; they override anything in the
 file. If DUMP_USED_PARAMS is TRUE, a file called 'PARAMS.out' will be created
 with all of the command-line and file arguments that were actually used to run
 the program.  This way, an exact duplicate run can be performed.
+
+    Options are looked up in a hash table built once from the option array, so
+the cost of parsing does not grow with the number of parameters.  A fully
+resolved parameter set can be saved with '--dump_config_bin <file>' and
+restored with '--load_config_bin <file>', which skips PARAMS.in and the
+per-parameter parsing altogether.
 ***************************************************************************************/
 
+/* the parameter variables are defined here, so NUM_CORES stays one in every build */
+#define PARAM_PARSER_STORAGE
+
 #include "param_parser.h"
 
 #include <ctype.h>
@@ -69,6 +78,9 @@ the program.  This way, an exact duplicate run can be performed.
 
 #define ARG_FILE_OUT "PARAMS" /* the name of the parameter dump file */
 
+#define CONFIG_BIN_MAGIC 0x53434346 /* "SCCF" */
+#define CONFIG_BIN_VERSION 1
+
 #define ASSERTM(proc_id, cond, ...) \
   if (!(cond)) {                    \
     printf(__VA_ARGS__);            \
@@ -83,7 +95,7 @@ const char* help_options[] = {"-help", "-h", "--help", "--h"}; /* cmd-line help
 const char* sim_mode_names[] = {"uop", "full"
 #ifdef ENABLE_PT_MEMTRACE
                                 ,
-                                "trace_bbv", "trace_bbv_distributed"
+                                "trace_bbv", "trace_bbv_distributed", "trace_sct"
 #endif
 };
 const char* exit_cond_names[] = {"last_done", "first_done"};
@@ -111,6 +123,8 @@ uns NUM_RS;
 typedef enum param_enum {
 #include "param_files.def"
   PARAM_ENUM_help,
+  PARAM_ENUM_dump_config_bin,
+  PARAM_ENUM_load_config_bin,
   NUM_PARAMS,
 } Param_Enum;
 #undef DEF_PARAM
@@ -125,6 +139,8 @@ static int param_idx;
 struct option long_options[] = {
 #include "param_files.def"
     {"help", 0, &param_idx, PARAM_ENUM_help},
+    {"dump_config_bin", TRUE, &param_idx, PARAM_ENUM_dump_config_bin},
+    {"load_config_bin", TRUE, &param_idx, PARAM_ENUM_load_config_bin},
     {0, 0, 0, 0},
 };
 #undef DEF_PARAM
@@ -132,7 +148,7 @@ struct option long_options[] = {
 #define DEF_PARAM(name, variable, type, func, def, const) #const,
 char* const_options[] = {
 #include "param_files.def"
-    "", "", ""};
+    "", "", "", ""};
 #undef DEF_PARAM
 
 #define DEF_PARAM(name, variable, type, func, def, const) {#variable, #def, #const},
@@ -141,6 +157,58 @@ char* compiled_param_dump_array[][3] = {
     {0, 0, 0}};
 #undef DEF_PARAM
 
+/* storage of every parameter, for the binary config snapshot */
+typedef struct Param_Var_struct {
+  void* addr;
+  uns size;
+  const char* func;
+} Param_Var;
+
+#define DEF_PARAM(name, variable, type, func, def, const) {(void*)&variable, sizeof(variable), #func},
+static const Param_Var param_vars[] = {
+#include "param_files.def"
+    {0, 0, 0}};
+#undef DEF_PARAM
+
+/* Levels of the --fidelity subsystems, from the most accurate to the fastest. A level
+   is the options it stands for; an empty level keeps whatever PARAMS.in set. */
+typedef struct Fidelity_Level_struct {
+  const char* subsystem;
+  const char* level;
+  const char* args;
+} Fidelity_Level;
+
+static const Fidelity_Level fidelity_levels[] = {
+    {"core", "cmp", "--model cmp"},
+    {"core", "interval", "--model interval --confidence_enable 0 --fdip_dual_path_pref_uoc_online_enable 0"},
+    {"dram", "ramulator", "--constant_memory_latency 0"},
+    {"dram", "speedy", "--constant_memory_latency 0 --ramulator_controller SpeedyController"},
+    {"dram", "constant", "--constant_memory_latency 1"},
+    {"wrong_path", "full", "--fetch_off_path_ops 1 --wrong_path_lite 0"},
+    {"wrong_path", "lite", "--fetch_off_path_ops 1 --wrong_path_lite 1"},
+    {"wrong_path", "off", "--fetch_off_path_ops 0"},
+    {"stats", "all", ""},
+    {"stats", "lean",
+     "--wp_collect_stats 0 --stat_groups_off "
+     "INST,POWER,DFE,PREF_STREAM,PREF_L2L1,PREF,L1_HIT_POSITION,CACHE_PART,BATCH_SCHED,PERF_PRED,DVFS,INTERFERENCE,"
+     "DRAM_SHARING"},
+    {"warmup", "op", "--warmup_fast_path 0"},
+    {"warmup", "fast", "--warmup_fast_path 1"},
+    {0, 0, 0},
+};
+
+/* the interval core has no fast warmup path, so the fast profile warms with ops */
+static const char* fidelity_profiles[][2] = {
+    {"accurate", "core=cmp,dram=ramulator,wrong_path=full,stats=all,warmup=op"},
+    {"balanced", "core=cmp,dram=speedy,wrong_path=lite,stats=lean,warmup=fast"},
+    {"fast", "core=interval,dram=constant,wrong_path=off,stats=lean,warmup=op"},
+    {0, 0},
+};
+
+/* open-addressed hash of the option names, indexed by name hash */
+static int* param_hash = NULL;
+static uns param_hash_mask;
+
 /**************************************************************************************/
 
 typedef struct Param_Record_struct {
@@ -148,7 +216,7 @@ typedef struct Param_Record_struct {
   char optarg[MAX_STR_LENGTH + 1];
 } Param_Record;
 
-void dump_params(char** arg_list, Param_Record used_params[], Flag exe_found);
+void dump_params(char** arg_list, uns sim_argv_index, Param_Record used_params[], Flag exe_found);
 
 /**************************************************************************************/
 /* Local prototypes */
@@ -164,6 +232,7 @@ int count_parameters_in_file(FILE* f);
 Flag param_is_exe_option(char* param);
 Flag contains_exe_option_in_file(FILE* param_file_fp);
 Flag contains_exe_option_in_args(char* argv[]);
+Flag contains_load_config_bin_option(char* argv[]);
 Flag param_is_comment(char* param);
 uns add_arg_to_arg_list_at_index(char** arg_list, const char* arg, uns index);
 int find_index_of_first_nonspace(char* str);
@@ -172,6 +241,13 @@ uns fill_arg_list_with_param_file_args(FILE* param_file_fp, const int param_file
 uns add_all_param_file_args_to_arg_list(FILE* param_file_fp, const uns param_file_arg_count, char** arg_list, int argc);
 uns add_all_command_line_args_to_end_of_arg_list(char** arg_list, uns arg_list_index, char* argv[]);
 uns get_param_file_args_and_command_line_args(char*** arg_list, int argc, char* argv[]);
+static uns hash_param_name(const char* name, uns len);
+static void init_param_hash(void);
+static int find_param(const char* name, uns len);
+static int find_param_or_prefix(const char* name, uns len);
+static void dump_config_bin(const char* file, Param_Record used_params[]);
+static void load_config_bin(const char* file, Param_Record used_params[]);
+static uns splice_fidelity_args(char*** arg_list_ptr, uns arg_list_count, uns arg_index, const char* spec);
 
 /**************************************************************************************/
 /**************************************************************************************/
@@ -438,7 +514,7 @@ void get_uns64_param(const char* name, uns64* variable) {
 /**************************************************************************************/
 /* dump_params: */
 
-void dump_params(char** arg_list, Param_Record used_params[], Flag exe_found) {
+void dump_params(char** arg_list, uns sim_argv_index, Param_Record used_params[], Flag exe_found) {
   int ii;
   FILE* arg_stream_out = file_tag_fopen(NULL, ARG_FILE_OUT, "w");
   if (!arg_stream_out) {
@@ -450,7 +526,7 @@ void dump_params(char** arg_list, Param_Record used_params[], Flag exe_found) {
       fprintf(arg_stream_out, "--%s %s\n", long_options[ii].name, used_params[ii].optarg);
   if (exe_found)
     fprintf(arg_stream_out, "--exe ");
-  for (ii = optind; arg_list[ii]; ii++)
+  for (ii = sim_argv_index; arg_list[ii]; ii++)
     fprintf(arg_stream_out, "%s ", arg_list[ii]);
 
   fprintf(arg_stream_out, "\n\n--- Cut out everything below to use this file as PARAMS.in ---\n\n");
@@ -470,6 +546,266 @@ void dump_params(char** arg_list, Param_Record used_params[], Flag exe_found) {
     fclose(arg_stream_out);
 }
 
+/**************************************************************************************/
+/* hash_param_name: FNV-1a hash of the first len characters of name */
+
+static uns hash_param_name(const char* name, uns len) {
+  uns32 hash = 2166136261u;
+  for (uns ii = 0; ii < len; ii++)
+    hash = (hash ^ (uns8)name[ii]) * 16777619u;
+  return hash;
+}
+
+/**************************************************************************************/
+/* init_param_hash: builds the name hash once, at four slots per option so the
+   probe sequences stay short */
+
+static void init_param_hash(void) {
+  uns size = 1;
+  while (size < 4 * NUM_PARAMS)
+    size <<= 1;
+  param_hash_mask = size - 1;
+  param_hash = (int*)malloc(sizeof(int) * size);
+  for (uns ii = 0; ii < size; ii++)
+    param_hash[ii] = -1;
+  for (int ii = 0; ii < NUM_PARAMS; ii++) {
+    const char* name = long_options[ii].name;
+    uns slot = hash_param_name(name, strlen(name)) & param_hash_mask;
+    while (param_hash[slot] != -1)
+      slot = (slot + 1) & param_hash_mask;
+    param_hash[slot] = ii;
+  }
+}
+
+/**************************************************************************************/
+/* find_param: returns the index of the option named by the first len characters
+   of name, or -1 */
+
+static int find_param(const char* name, uns len) {
+  if (!param_hash)
+    init_param_hash();
+  uns slot = hash_param_name(name, len) & param_hash_mask;
+  for (; param_hash[slot] != -1; slot = (slot + 1) & param_hash_mask) {
+    const char* option = long_options[param_hash[slot]].name;
+    if (strncmp(option, name, len) == 0 && option[len] == '\0')
+      return param_hash[slot];
+  }
+  return -1;
+}
+
+/**************************************************************************************/
+/* find_param_or_prefix: like find_param, but also accepts an unambiguous prefix
+   of an option name the way getopt_long does */
+
+static int find_param_or_prefix(const char* name, uns len) {
+  int index = find_param(name, len);
+  if (index != -1)
+    return index;
+  for (int ii = 0; ii < NUM_PARAMS; ii++) {
+    if (strncmp(long_options[ii].name, name, len) == 0) {
+      if (index != -1)
+        return -1;
+      index = ii;
+    }
+  }
+  return index;
+}
+
+/**************************************************************************************/
+/* config_bin_write/config_bin_read: length-prefixed records of the snapshot.  A
+   length of -1 stands for a NULL string. */
+
+static void config_bin_write(FILE* file, const void* data, int32 len) {
+  fwrite(&len, sizeof(len), 1, file);
+  if (len > 0)
+    fwrite(data, len, 1, file);
+}
+
+static void config_bin_write_str(FILE* file, const char* str) {
+  config_bin_write(file, str, str ? (int32)strlen(str) : -1);
+}
+
+static int32 config_bin_read(FILE* file, const char* name, void* data, int32 max_len) {
+  int32 len;
+  ASSERTM(0, fread(&len, sizeof(len), 1, file) == 1, "Truncated config snapshot at '%s'\n", name);
+  ASSERTM(0, len <= max_len, "Config snapshot entry '%s' is %d bytes, expected at most %d\n", name, len, max_len);
+  if (len > 0)
+    ASSERTM(0, fread(data, len, 1, file) == 1, "Truncated config snapshot at '%s'\n", name);
+  return len;
+}
+
+static char* config_bin_read_str(FILE* file, const char* name) {
+  char buffer[MAX_STR_LENGTH + 1];
+  int32 len = config_bin_read(file, name, buffer, MAX_STR_LENGTH);
+  if (len < 0)
+    return NULL;
+  buffer[len] = '\0';
+  return strdup(buffer);
+}
+
+/**************************************************************************************/
+/* dump_config_bin: writes the value of every settable parameter, and the option
+   that set it, so that load_config_bin can restore the run without parsing */
+
+static void dump_config_bin(const char* file_name, Param_Record used_params[]) {
+  FILE* file = fopen(file_name, "wb");
+  ASSERTM(0, file, "Could not open config snapshot '%s' for writing\n", file_name);
+  uns32 header[3] = {CONFIG_BIN_MAGIC, CONFIG_BIN_VERSION, 0};
+  for (int ii = 0; param_vars[ii].addr; ii++)
+    header[2] += strncmp(const_options[ii], "const", MAX_STR_LENGTH) != 0;
+  fwrite(header, sizeof(header), 1, file);
+
+  for (int ii = 0; param_vars[ii].addr; ii++) {
+    const Param_Var* var = &param_vars[ii];
+    if (strncmp(const_options[ii], "const", MAX_STR_LENGTH) == 0)
+      continue;
+    config_bin_write_str(file, long_options[ii].name);
+    config_bin_write_str(file, used_params[ii].used ? used_params[ii].optarg : NULL);
+    if (strcmp(var->func, "string") == 0) {
+      config_bin_write_str(file, *(char**)var->addr);
+    } else if (strcmp(var->func, "strlist") == 0) {
+      char** list = *(char***)var->addr;
+      int32 count = 0;
+      while (list && list[count])
+        count++;
+      fwrite(&count, sizeof(count), 1, file);
+      for (int jj = 0; jj < count; jj++)
+        config_bin_write_str(file, list[jj]);
+    } else {
+      config_bin_write(file, var->addr, var->size);
+    }
+  }
+  fclose(file);
+}
+
+/**************************************************************************************/
+/* load_config_bin: restores a snapshot written by dump_config_bin.  The entries
+   are matched by name, but the snapshot must come from a build with exactly the
+   same settable parameters. */
+
+static void load_config_bin(const char* file_name, Param_Record used_params[]) {
+  FILE* file = fopen(file_name, "rb");
+  ASSERTM(0, file, "Could not open config snapshot '%s'\n", file_name);
+  uns32 header[3];
+  ASSERTM(0, fread(header, sizeof(header), 1, file) == 1 && header[0] == CONFIG_BIN_MAGIC,
+          "'%s' is not a config snapshot\n", file_name);
+  ASSERTM(0, header[1] == CONFIG_BIN_VERSION, "Config snapshot '%s' has version %u, expected %u\n", file_name,
+          header[1], CONFIG_BIN_VERSION);
+
+  uns num_settable = 0;
+  for (int ii = 0; param_vars[ii].addr; ii++)
+    num_settable += strncmp(const_options[ii], "const", MAX_STR_LENGTH) != 0;
+  ASSERTM(0, header[2] == num_settable,
+          "Config snapshot '%s' has %u parameters, this build has %u --- was it dumped by another build?\n", file_name,
+          header[2], num_settable);
+
+  for (uns ii = 0; ii < header[2]; ii++) {
+    char name[MAX_STR_LENGTH + 1];
+    int32 len = config_bin_read(file, file_name, name, MAX_STR_LENGTH);
+    ASSERTM(0, len > 0, "Corrupt config snapshot '%s'\n", file_name);
+    int index = find_param(name, len);
+    name[len] = '\0';
+    ASSERTM(0, index != -1 && index < PARAM_ENUM_help && strncmp(const_options[index], "const", MAX_STR_LENGTH) != 0,
+            "Config snapshot '%s' sets unknown parameter '%s'\n", file_name, name);
+
+    len = config_bin_read(file, name, used_params[index].optarg, MAX_STR_LENGTH);
+    used_params[index].used = len >= 0;
+    if (len >= 0)
+      used_params[index].optarg[len] = '\0';
+
+    const Param_Var* var = &param_vars[index];
+    if (strcmp(var->func, "string") == 0) {
+      *(char**)var->addr = config_bin_read_str(file, name);
+    } else if (strcmp(var->func, "strlist") == 0) {
+      int32 count;
+      ASSERTM(0, fread(&count, sizeof(count), 1, file) == 1, "Truncated config snapshot at '%s'\n", name);
+      char** list = (char**)malloc(sizeof(char*) * (count + 1));
+      for (int jj = 0; jj < count; jj++)
+        list[jj] = config_bin_read_str(file, name);
+      list[count] = NULL;
+      *(char***)var->addr = list;
+    } else {
+      len = config_bin_read(file, name, var->addr, var->size);
+      ASSERTM(0, len == (int32)var->size, "Config snapshot entry '%s' is %d bytes, expected %u\n", name, len,
+              var->size);
+    }
+  }
+  fclose(file);
+}
+
+/**************************************************************************************/
+/* add_fidelity_level: picks the level of one subsystem=level token */
+
+static void add_fidelity_level(const char* token, const Fidelity_Level* picked[], uns num_subsystems) {
+  const char* eq = strchr(token, '=');
+  if (!eq)
+    FATAL_ERROR(0, "Unknown fidelity profile '%s' (accurate, balanced, fast or <subsystem>=<level>)\n", token);
+  uns len = eq - token;
+  Flag subsystem_found = FALSE;
+  for (uns ii = 0, subsystem = 0; fidelity_levels[ii].subsystem; ii++) {
+    if (ii && strcmp(fidelity_levels[ii].subsystem, fidelity_levels[ii - 1].subsystem))
+      subsystem++;
+    if (strlen(fidelity_levels[ii].subsystem) != len || strncmp(fidelity_levels[ii].subsystem, token, len))
+      continue;
+    subsystem_found = TRUE;
+    if (!strcmp(fidelity_levels[ii].level, eq + 1)) {
+      ASSERTM(0, subsystem < num_subsystems, "Too many fidelity subsystems\n");
+      picked[subsystem] = &fidelity_levels[ii];
+      return;
+    }
+  }
+  FATAL_ERROR(0, "Unknown fidelity %s '%s'\n", subsystem_found ? "level" : "subsystem", token);
+}
+
+/**************************************************************************************/
+/* splice_fidelity_args: inserts the options of a --fidelity spec at arg_index, so
+   that they act as if given where --fidelity was and the options after it still
+   override them. Returns the new arg_list_count. */
+
+static uns splice_fidelity_args(char*** arg_list_ptr, uns arg_list_count, uns arg_index, const char* spec) {
+  const Fidelity_Level* picked[sizeof(fidelity_levels) / sizeof(fidelity_levels[0])] = {0};
+  uns num_subsystems = sizeof(picked) / sizeof(picked[0]);
+
+  /* later tokens override earlier ones, a profile name picks every subsystem */
+  char* buf = strdup(spec);
+  for (char* token = strtok(buf, ","); token; token = strtok(NULL, ",")) {
+    uns profile;
+    for (profile = 0; fidelity_profiles[profile][0]; profile++)
+      if (!strcmp(fidelity_profiles[profile][0], token))
+        break;
+    if (!fidelity_profiles[profile][0]) {
+      add_fidelity_level(token, picked, num_subsystems);
+      continue;
+    }
+    char* levels = strdup(fidelity_profiles[profile][1]);
+    char* save = NULL;
+    for (char* level = strtok_r(levels, ",", &save); level; level = strtok_r(NULL, ",", &save))
+      add_fidelity_level(level, picked, num_subsystems);
+    free(levels);
+  }
+  free(buf);
+
+  char* args[64];
+  uns num_args = 0;
+  for (uns subsystem = 0; subsystem < num_subsystems; subsystem++) {
+    if (!picked[subsystem])
+      continue;
+    char* level_args = strdup(picked[subsystem]->args);
+    for (char* arg = strtok(level_args, " "); arg; arg = strtok(NULL, " ")) {
+      ASSERTM(0, num_args < sizeof(args) / sizeof(args[0]), "Too many fidelity options\n");
+      args[num_args++] = strdup(arg);
+    }
+    free(level_args);
+  }
+
+  /* arg_list ends with a NULL sentinel at arg_list_count */
+  char** arg_list = (char**)realloc(*arg_list_ptr, sizeof(char*) * (arg_list_count + num_args + 1));
+  memmove(&arg_list[arg_index + num_args], &arg_list[arg_index], sizeof(char*) * (arg_list_count - arg_index + 1));
+  memcpy(&arg_list[arg_index], args, sizeof(char*) * num_args);
+  *arg_list_ptr = arg_list;
+  return arg_list_count + num_args;
+}
+
 /**************************************************************************************/
 /* get_params: Parses argv and a default file for any long options and calls
    the appropriate function when it finds one.  It also returns a pointer to
@@ -561,6 +897,15 @@ Flag contains_exe_option_in_file(FILE* param_file_fp) {
   return FALSE;
 }
 
+Flag contains_load_config_bin_option(char* argv[]) {
+  uns i;
+  for (i = 1; argv[i] && !param_is_exe_option(argv[i]); i++) {
+    if (strncmp(argv[i], "--load_config_bin", strlen("--load_config_bin")) == 0)
+      return TRUE;
+  }
+  return FALSE;
+}
+
 Flag contains_exe_option_in_args(char* argv[]) {
   uns i;
   for (i = 1; argv[i]; i++) {
@@ -702,7 +1047,11 @@ uns get_param_file_args_and_command_line_args(char*** arg_list_ptr, int argc, ch
   char** arg_list = NULL;
 
   uns command_line_arg_index = 1;
-  if (!param_file_exists(param_file_fp)) {
+  if (param_file_exists(param_file_fp) && contains_load_config_bin_option(argv)) {
+    /* the snapshot already holds everything PARAMS.in would have set */
+    fclose(param_file_fp);
+    arg_list = allocate_and_initialize_arg_list(param_file_arg_count, argc, argv);
+  } else if (!param_file_exists(param_file_fp)) {
     WARNINGU(0,
              "Parameter file '%s' not found --- Using hard-coded defaults and "
              "command-line arguments only.\n",
@@ -740,15 +1089,39 @@ char** get_params(int argc, char* argv[]) {
 
   arg_list_count = get_param_file_args_and_command_line_args(&arg_list, argc, argv);
 
-  int temp_index = 0;
-  param_idx = -1;
-  opterr = 0;  // Suppress getopt_long's error message (we have our own)
+  /* Options are matched like getopt_long does it ('--name value', '--name=value'
+     or an unambiguous prefix of the name), and everything else is moved, in
+     order, to the end of arg_list as the simulated command */
+  char** non_options = (char**)malloc(sizeof(char*) * (arg_list_count + 1));
+  uns num_non_options = 0;
+  uns arg_index = 1;
+  char* dump_config_file = NULL;
   mark_all_params_as_unused(used_params);
-  while (getopt_long(arg_list_count, arg_list, "", long_options, &temp_index) != -1) {
-    int index = param_idx;
-    param_idx = -1;
+  while (arg_index < arg_list_count) {
+    char* arg = arg_list[arg_index++];
+    if (arg[0] != '-' || arg[1] == '\0') {
+      non_options[num_non_options++] = arg;
+      continue;
+    }
+    if (strcmp(arg, "--") == 0)
+      break;
+    if (arg[1] != '-')
+      FATAL_ERROR(0, "Unknown parameter '%s'\n", arg);
+
+    char* name = arg + 2;
+    char* value = strchr(name, '=');
+    int index = find_param_or_prefix(name, value ? (uns)(value - name) : strlen(name));
     if (index == -1) {
-      FATAL_ERROR(0, "Unknown parameter '%s'\n", arg_list[optind - 1]);
+      FATAL_ERROR(0, "Unknown parameter '%s'\n", arg);
+    }
+    optarg = NULL;
+    if (long_options[index].has_arg) {
+      if (value)
+        optarg = value + 1;
+      else if (arg_index < arg_list_count)
+        optarg = arg_list[arg_index++];
+      else
+        FATAL_ERROR(0, "Parameter '%s' missing value.\n", long_options[index].name);
     }
     if (strncmp(const_options[index], "const", MAX_STR_LENGTH) == 0) {
       FATAL_ERROR(0, "Cannot set parameter '%s' compiled as a constant.\n", long_options[index].name);
@@ -761,10 +1134,23 @@ char** get_params(int argc, char* argv[]) {
           if (system("cat $SIMDIR/doc/cmd-line_options") != 0)
             ERROR(0, "File 'cmd-line_options' could not be found.\n");
         break;
+      case PARAM_ENUM_dump_config_bin:
+        dump_config_file = optarg;
+        break;
+      case PARAM_ENUM_load_config_bin:
+        load_config_bin(optarg, used_params);
+        break;
       default:
         FATAL_ERROR(0, "Unknown command-line option found (index:%u).\n", index);
     }
+    if (index == PARAM_ENUM_fidelity) {
+      arg_list_count = splice_fidelity_args(&arg_list, arg_list_count, arg_index, FIDELITY);
+      non_options = (char**)realloc(non_options, sizeof(char*) * (arg_list_count + 1));
+    }
   }
+  uns sim_argv_index = arg_index - num_non_options;
+  memcpy(&arg_list[sim_argv_index], non_options, sizeof(char*) * num_non_options);
+  free(non_options);
 
   // Set global size variables.
   NUM_RS = num_tokens(RS_SIZES, DELIMITERS);
@@ -775,24 +1161,58 @@ char** get_params(int argc, char* argv[]) {
           "RS_CONNECTIONS(%d)",
           NUM_RS, temp);
 
-  if ((FRONTEND == FE_TRACE
+  ASSERTM(0, NUM_CORES <= MAX_NUM_PROCS, "NUM_CORES (%u) is larger than MAX_NUM_PROCS (%d)\n", NUM_CORES,
+          MAX_NUM_PROCS);
+#ifdef SCARAB_NUM_CORES
+  ASSERTM(0, NUM_CORES == SCARAB_NUM_CORES, "This scarab is built for %d cores (SCARAB_NUM_CORES), not %u\n",
+          SCARAB_NUM_CORES, NUM_CORES);
+#endif
+
+  if ((FRONTEND == FE_TRACE || FRONTEND == FE_SCT
 #ifdef ENABLE_PT_MEMTRACE
        || FRONTEND == FE_MEMTRACE
 #endif
        ) &&
-      !CBP_TRACE_R0) {
+      !CBP_TRACE_R0 && !TRACE_LIST) {
     if (SIM_MODEL != DUMB_MODEL) {
       FATAL_ERROR(0,
                   "Trace frontend specified, but no trace file specified "
-                  "(use --cbp_trace_r0).\n");
+                  "(use --cbp_trace_r0 or --trace_list).\n");
     }
   }
 
   ASSERTM(0, arg_list[arg_list_count] == 0x0,
           "3: Reading in parameters overflowed the space allocated for the "
           "args_list\n");
-  dump_params(arg_list, used_params, FALSE);
-  return &arg_list[optind]; /* return pointer to simulated argv */
+  dump_params(arg_list, sim_argv_index, used_params, FALSE);
+  if (dump_config_file)
+    dump_config_bin(dump_config_file, used_params);
+  return &arg_list[sim_argv_index]; /* return pointer to simulated argv */
+}
+
+#undef DEF_PARAM
+
+/**************************************************************************************/
+/* set_param: sets one parameter after startup, as '--name value' would have.
+   Returns FALSE if there is no settable parameter called name.  It is up to the
+   caller to know whether the simulator reads the parameter again after init. */
+
+#define DEF_PARAM(name, variable, type, func, def, const) \
+  case PARAM_ENUM_##name:                                 \
+    get_##func##_param(#name, (type*)&variable);          \
+    break;
+
+Flag set_param(const char* name, const char* value) {
+  int index = find_param(name, strlen(name));
+  if (index == -1 || index >= PARAM_ENUM_help || strncmp(const_options[index], "const", MAX_STR_LENGTH) == 0)
+    return FALSE;
+  optarg = (char*)value;
+  switch (index) {
+#include "param_files.def"
+    default:
+      return FALSE;
+  }
+  return TRUE;
 }
 
 static void print_help(void) {
@@ -818,6 +1238,14 @@ static void print_help(void) {
       "        must be the last option given in the PARAMS.in file or on the\n"
       "        command line.  (No Default)\n"
       "\n"
+      "    --dump_config_bin <file>\n"
+      "        Saves the fully resolved parameters of this run to <file>.\n"
+      "\n"
+      "    --load_config_bin <file>\n"
+      "        Restores the parameters saved by --dump_config_bin without\n"
+      "        reading PARAMS.in.  Options given after it still override the\n"
+      "        saved values.\n"
+      "\n"
       "Other options are listed in *.param.def files in the src directory.\n";
 
   printf("%s", help);
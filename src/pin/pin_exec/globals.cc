@@ -37,6 +37,7 @@ CONTEXT last_ctxt;
 ADDRINT next_eip;
 
 Client*                   scarab;
+ShmRing*                  scarab_ring = NULL;
 ScarabOpBuffer_type       scarab_op_buffer;
 compressed_op             op_mailbox;
 bool                      op_mailbox_full           = false;
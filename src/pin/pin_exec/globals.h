@@ -34,6 +34,7 @@
 #undef WARNING
 
 #include "../pin_lib/message_queue_interface_lib.h"
+#include "../pin_lib/shm_ring_lib.h"
 #include "read_mem_map.h"
 #include "utils.h"
 
@@ -54,6 +55,7 @@ extern CONTEXT last_ctxt;
 extern ADDRINT next_eip;
 
 extern Client*                   scarab;
+extern ShmRing*                  scarab_ring;  // NULL unless Scarab created a ring
 extern ScarabOpBuffer_type       scarab_op_buffer;
 extern compressed_op             op_mailbox;
 extern bool                      op_mailbox_full;
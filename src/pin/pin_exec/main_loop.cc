@@ -240,7 +240,8 @@ void main_loop(CONTEXT* ctxt) {
     }
 
     buffer_ready               = scarab_buffer_full() || pending_syscall;
-    bool send_buffer_to_scarab = buffer_ready && pending_fetch_op &&
+    bool send_buffer_to_scarab = buffer_ready &&
+                                 (pending_fetch_op || scarab_can_run_ahead()) &&
                                  have_consumed_op;
     if(send_buffer_to_scarab) {
       scarab_send_buffer();
@@ -325,6 +325,14 @@ int main(int argc, char* argv[]) {
   PIN_AddFiniFunction(Fini, 0);
 
   scarab = new Client(KnobSocketPath, KnobCoreId);
+  // Scarab creates the ring before it listens, so it is there once we are connected
+  scarab_ring = new ShmRing();
+  if(scarab_ring->attach(ShmRing::path_for(KnobSocketPath, KnobCoreId))) {
+    ASSERTX(scarab_ring->op_capacity() >= scarab_ring->runahead_ops() + 2 * max_buffer_size);
+  } else {
+    delete scarab_ring;
+    scarab_ring = NULL;
+  }
 
   // Start the program, never returns
   PIN_StartProgram();
@@ -26,7 +26,13 @@ Scarab_To_Pin_Msg get_scarab_cmd() {
 
   DBG_PRINT(uid_ctr, dbg_print_start_uid, dbg_print_end_uid,
             "START: Receiving from Scarab\n");
-  cmd = scarab->receive<Scarab_To_Pin_Msg>();
+  if(scarab_ring) {
+    do {
+      cmd = scarab_ring->pop_cmd();
+    } while(scarab_ring->is_stale_fetch(cmd));
+  } else {
+    cmd = scarab->receive<Scarab_To_Pin_Msg>();
+  }
   DBG_PRINT(uid_ctr, dbg_print_start_uid, dbg_print_end_uid,
             "END: %d Received from Scarab\n", cmd.type);
 
@@ -34,17 +40,32 @@ Scarab_To_Pin_Msg get_scarab_cmd() {
 }
 
 void insert_scarab_op_in_buffer(compressed_op& cop) {
+  if(scarab_ring) {
+    // written in place; Scarab sees it once the packet is published
+    scarab_ring->write_op(cop);
+    return;
+  }
   scarab_op_buffer.push_back(cop);
 }
 
 bool scarab_buffer_full() {
-  return scarab_op_buffer.size() > (max_buffer_size - 2);
+  uint32_t size = scarab_ring ? scarab_ring->num_unpublished_ops() : scarab_op_buffer.size();
+  return size > (max_buffer_size - 2);
   // Two spots are always reserved in the buffer just in case the
   // exit syscall and sentinel nullop are
   // the last two elements of a packet sent to Scarab.
 }
 
+bool scarab_can_run_ahead() {
+  // syscalls still wait for FETCH_OP, which tells PIN that Scarab has retired everything before them
+  return scarab_ring && !pending_syscall && scarab_ring->can_run_ahead();
+}
+
 void scarab_send_buffer() {
+  if(scarab_ring) {
+    scarab_ring->publish_ops();
+    return;
+  }
   Message<ScarabOpBuffer_type> message = scarab_op_buffer;
   DBG_PRINT(uid_ctr, dbg_print_start_uid, dbg_print_end_uid,
             "START: Sending message to Scarab.\n");
@@ -55,6 +76,8 @@ void scarab_send_buffer() {
 }
 
 void scarab_clear_all_buffers() {
+  if(scarab_ring)
+    scarab_ring->discard_unpublished_ops();
   scarab_op_buffer.clear();
   op_mailbox_full = false;
 }
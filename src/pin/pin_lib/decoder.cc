@@ -84,12 +84,7 @@ std::vector<PIN_MEM_ACCESS_INFO> compute_mem_access_infos(
   const CONTEXT* ctxt, gather_scatter_info* info);
 ADDRDELTA compute_base_reg_addr_contribution(const CONTEXT*       ctxt,
                                              gather_scatter_info* info);
-ADDRDELTA compute_base_index_addr_contribution(
-  const PIN_REGISTER& vector_index_reg_val, const UINT32 lane_id,
-  gather_scatter_info* info);
 PIN_MEMOP_ENUM type_to_PIN_MEMOP_ENUM(gather_scatter_info* info);
-bool extract_mask_on(const PIN_REGISTER& mask_reg_val_buf, const UINT32 lane_id,
-                     gather_scatter_info* info);
 
 /**************************** Public Functions ********************************/
 void pin_decoder_init(bool translate_x87_regs, std::ostream* err_ostream) {
@@ -375,7 +370,7 @@ static void verify_mem_access_infos(
 // TODO: extract displacement information
 vector<PIN_MEM_ACCESS_INFO> compute_mem_access_infos(
   const CONTEXT* ctxt, gather_scatter_info* info) {
-  info->verify_fields_for_mem_access_info_generation();
+  const gather_scatter_lane_layout& layout = info->get_lane_layout();
 
   vector<PIN_MEM_ACCESS_INFO> mem_access_infos;
   ADDRINT base_addr_contribution = compute_base_reg_addr_contribution(ctxt,
@@ -392,18 +387,18 @@ vector<PIN_MEM_ACCESS_INFO> compute_mem_access_infos(
          reg_xed_to_pin_map.end());
   PIN_GetContextRegval(ctxt, reg_xed_to_pin_map[info->get_mask_reg()],
                        (UINT8*)&mask_reg_val_buf);
-  for(UINT32 lane_id = 0; lane_id < info->get_num_mem_ops(); lane_id++) {
-    ADDRDELTA index_val = compute_base_index_addr_contribution(
-      vector_index_reg_val_buf, lane_id, info);
-    ADDRINT final_addr = base_addr_contribution +
-                         (index_val * info->get_scale()) +
-                         info->get_displacement();
-    bool mask_on = extract_mask_on(mask_reg_val_buf, lane_id, info);
+
+  UINT64 lane_addrs[GATHER_SCATTER_MAX_LANES];
+  UINT64 mask_on_lanes = expand_gather_scatter_lanes(
+    layout, base_addr_contribution, vector_index_reg_val_buf.byte,
+    mask_reg_val_buf.byte, lane_addrs);
+  mem_access_infos.reserve(layout.num_lanes);
+  for(UINT32 lane_id = 0; lane_id < layout.num_lanes; lane_id++) {
     PIN_MEM_ACCESS_INFO access_info = {
-      .memoryAddress = final_addr,
+      .memoryAddress = lane_addrs[lane_id],
       .memopType     = memop_type,
-      .bytesAccessed = info->get_data_lane_width_bytes(),
-      .maskOn        = mask_on};
+      .bytesAccessed = layout.data_lane_width_bytes,
+      .maskOn        = ((mask_on_lanes >> lane_id) & 1) != 0};
 
     mem_access_infos.push_back(access_info);
   }
@@ -433,24 +428,6 @@ ADDRDELTA compute_base_reg_addr_contribution(const CONTEXT*       ctxt,
   return base_addr_contribution;
 }
 
-ADDRDELTA compute_base_index_addr_contribution(
-  const PIN_REGISTER& vector_index_reg_val, const UINT32 lane_id,
-  gather_scatter_info* info) {
-  ADDRDELTA index_val;
-  switch(info->get_index_lane_width_bytes()) {
-    case 4:
-      index_val = vector_index_reg_val.s_dword[lane_id];
-      break;
-    case 8:
-      index_val = vector_index_reg_val.s_qword[lane_id];
-      break;
-    default:
-      ASSERTX(false);
-      break;
-  }
-  return index_val;
-}
-
 PIN_MEMOP_ENUM type_to_PIN_MEMOP_ENUM(gather_scatter_info* info) {
   switch(info->get_type()) {
     case gather_scatter_info::GATHER:
@@ -463,40 +440,6 @@ PIN_MEMOP_ENUM type_to_PIN_MEMOP_ENUM(gather_scatter_info* info) {
   }
 }
 
-bool extract_mask_on(const PIN_REGISTER& mask_reg_val_buf, const UINT32 lane_id,
-                     gather_scatter_info* info) {
-  bool   mask_on  = false;
-  UINT64 msb_mask = ((UINT64)1) << (info->get_data_lane_width_bytes() * 8 - 1);
-
-  switch(info->get_mask_reg_type()) {
-    case gather_scatter_info::K:
-      mask_on = (mask_reg_val_buf.word[0] & (1 << lane_id));
-      break;
-    case gather_scatter_info::XYMM:
-      // Conditionality is specified by the most significant bit of each data
-      // element of the mask register. The width of data element in the
-      // destination register and mask register are identical.
-      switch(info->get_data_lane_width_bytes()) {
-        case 4:
-          mask_on = (mask_reg_val_buf.dword[lane_id] & msb_mask);
-          break;
-
-        case 8:
-          mask_on = (mask_reg_val_buf.qword[lane_id] & msb_mask);
-          break;
-
-        default:
-          ASSERT(false, "expecting data lane width to be 4 or 8 bytes");
-          break;
-      }
-      break;
-    default:
-      ASSERTX(false);
-      break;
-  }
-  return mask_on;
-}
-
 void init_reg_xed_to_pin_map() {
   reg_xed_to_pin_map[XED_REG_INVALID] = REG_INVALID_;
   reg_xed_to_pin_map[XED_REG_RDI]     = REG_RDI;
@@ -21,12 +21,27 @@
 
 #include "gather_scatter_addresses.h"
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <map>
 
 // Global static instruction map just for scatter instructions
 scatter_info_map scatter_info_storage;
 
+// The operand setters below are called once per operand of the same
+// instruction, so remember the last entry instead of hashing for each call.
+// Entries are never erased, so the pointer stays valid across inserts.
+static ADDRINT              last_info_iaddr = 0;
+static gather_scatter_info* last_info       = nullptr;
+
+static gather_scatter_info* lookup_gather_scatter_info(const ADDRINT iaddr) {
+  if(!last_info || last_info_iaddr != iaddr) {
+    last_info_iaddr = iaddr;
+    last_info       = &scatter_info_storage[iaddr];
+  }
+  return last_info;
+}
+
 gather_scatter_info add_to_gather_scatter_info_storage(
   const ADDRINT iaddr, const bool is_gather, const bool is_scatter,
   const xed_category_enum_t category) {
@@ -87,17 +102,20 @@ static void set_gather_scatter_data_width(
       assert(false);
       break;
   }
-  scatter_info_storage[iaddr].set_data_reg_total_width(xed_reg);
+  lookup_gather_scatter_info(iaddr)->set_data_reg_total_width(xed_reg);
 }
 
 void set_gather_scatter_reg_operand_info(const ADDRINT        iaddr,
                                          const xed_reg_enum_t pin_reg,
                                          const bool           operandRead,
                                          const bool           operandWritten) {
+  // already recorded when this PC was decoded before
+  if(lookup_gather_scatter_info(iaddr)->operands_recorded())
+    return;
   const gather_scatter_info::type info_type =
-    scatter_info_storage[iaddr].get_type();
+    lookup_gather_scatter_info(iaddr)->get_type();
   const gather_scatter_info::mask_reg_type mask_reg_type =
-    scatter_info_storage[iaddr].get_mask_reg_type();
+    lookup_gather_scatter_info(iaddr)->get_mask_reg_type();
   assert(gather_scatter_info::INVALID_TYPE != info_type);
   assert(gather_scatter_info::INVALID_MASK_REG_TYPE != mask_reg_type);
 
@@ -105,7 +123,7 @@ void set_gather_scatter_reg_operand_info(const ADDRINT        iaddr,
     assert(operandRead);
     assert(operandWritten);
     assert(gather_scatter_info::K == mask_reg_type);
-    scatter_info_storage[iaddr].set_mask_reg(pin_reg);
+    lookup_gather_scatter_info(iaddr)->set_mask_reg(pin_reg);
   } else {
     assert(XED_REG_is_xmm_ymm_zmm(pin_reg));
     // for AVX2 gathers, both the destination
@@ -120,8 +138,8 @@ void set_gather_scatter_reg_operand_info(const ADDRINT        iaddr,
     // already set, then we assume the incoming pin_reg is a mask_reg.
     // Otherwise, we assume it's the destination register
     if((gather_scatter_info::XYMM == mask_reg_type) &&
-       scatter_info_storage[iaddr].data_dest_reg_set()) {
-      scatter_info_storage[iaddr].set_mask_reg(pin_reg);
+       lookup_gather_scatter_info(iaddr)->data_dest_reg_set()) {
+      lookup_gather_scatter_info(iaddr)->set_mask_reg(pin_reg);
     } else {
       set_gather_scatter_data_width(iaddr, pin_reg, operandRead, operandWritten,
                                     info_type, mask_reg_type);
@@ -134,7 +152,9 @@ void set_gather_scatter_memory_operand_info(
   const xed_reg_enum_t                            pin_index_reg,
   /*const uint64_t displacement,*/ const uint32_t scale,
   const bool operandReadOnly, const bool operandWritenOnly) {
-  switch(scatter_info_storage[iaddr].get_type()) {
+  if(lookup_gather_scatter_info(iaddr)->operands_recorded())
+    return;
+  switch(lookup_gather_scatter_info(iaddr)->get_type()) {
     case gather_scatter_info::GATHER:
       assert(operandReadOnly);
       break;
@@ -145,10 +165,10 @@ void set_gather_scatter_memory_operand_info(
       assert(false);
       break;
   }
-  scatter_info_storage[iaddr].set_base_reg(pin_base_reg);
-  scatter_info_storage[iaddr].set_index_reg(pin_index_reg);
-  // scatter_info_storage[iaddr].set_displacement(displacement);
-  scatter_info_storage[iaddr].set_scale(scale);
+  lookup_gather_scatter_info(iaddr)->set_base_reg(pin_base_reg);
+  lookup_gather_scatter_info(iaddr)->set_index_reg(pin_index_reg);
+  // lookup_gather_scatter_info(iaddr)->set_displacement(displacement);
+  lookup_gather_scatter_info(iaddr)->set_scale(scale);
 }
 
 static void set_info_num_ld_or_st(const ADDRINT iaddr, ctype_pin_inst* info) {
@@ -159,8 +179,8 @@ static void set_info_num_ld_or_st(const ADDRINT iaddr, ctype_pin_inst* info) {
   assert(info->is_gather_scatter);
 
   uint32_t total_mask_on_and_off_mem_ops =
-    scatter_info_storage[iaddr].get_num_mem_ops();
-  switch(scatter_info_storage[iaddr].get_type()) {
+    lookup_gather_scatter_info(iaddr)->get_num_mem_ops();
+  switch(lookup_gather_scatter_info(iaddr)->get_type()) {
     case gather_scatter_info::GATHER:
       // should be set to 1 in decoder.cc:add_dependency_info, because PIN
       // treats gathers as having 1 memory operand
@@ -183,21 +203,22 @@ void finalize_scatter_info(const ADDRINT iaddr, ctype_pin_inst* info) {
   assert(info->is_simd);
   assert(info->is_gather_scatter);
 
-  switch(scatter_info_storage[iaddr].get_type()) {
+  switch(lookup_gather_scatter_info(iaddr)->get_type()) {
     case gather_scatter_info::GATHER:
-      scatter_info_storage[iaddr].set_data_lane_width_bytes(info->ld_size);
+      lookup_gather_scatter_info(iaddr)->set_data_lane_width_bytes(info->ld_size);
       break;
     case gather_scatter_info::SCATTER:
-      scatter_info_storage[iaddr].set_data_lane_width_bytes(info->st_size);
+      lookup_gather_scatter_info(iaddr)->set_data_lane_width_bytes(info->st_size);
       break;
     default:
       assert(false);
       break;
   }
-  scatter_info_storage[iaddr].set_index_lane_width_bytes(
+  lookup_gather_scatter_info(iaddr)->set_index_lane_width_bytes(
     info->lane_width_bytes);
-  scatter_info_storage[iaddr].compute_num_mem_ops();
-  scatter_info_storage[iaddr].verify_fields_for_mem_access_info_generation();
+  lookup_gather_scatter_info(iaddr)->compute_num_mem_ops();
+  lookup_gather_scatter_info(iaddr)->verify_fields_for_mem_access_info_generation();
+  lookup_gather_scatter_info(iaddr)->compute_lane_layout();
 
   // set info->num_ld/st to the total number of mem ops (both mask on and off)
   // However, when we actually generate the compressed op, we're going to set
@@ -212,11 +233,11 @@ void finalize_scatter_info(const ADDRINT iaddr, ctype_pin_inst* info) {
   assert(info->is_simd);
   assert(info->is_gather_scatter);
   assert(1 == scatter_info_storage.count(iaddr));
-  assert(type == scatter_info_storage[iaddr].get_type());
+  assert(type == lookup_gather_scatter_info(iaddr)->get_type());
   // number of actual mask on loads/stores should be less or equal to total of
   // mem ops (both mask on and off) in the gather/scatter instruction
   uint32_t total_mask_on_and_off_mem_ops =
-    scatter_info_storage[iaddr].get_num_mem_ops();
+    lookup_gather_scatter_info(iaddr)->get_num_mem_ops();
   switch(type) {
     case gather_scatter_info::GATHER:
       assert(num_maskon_memops <= total_mask_on_and_off_mem_ops);
@@ -332,6 +353,7 @@ gather_scatter_info::gather_scatter_info() {
   _scale                             = 0;
   _index_lane_width_bytes            = 0;
   _num_mem_ops                       = 0;
+  memset(&_lane_layout, 0, sizeof(_lane_layout));
 }
 
 gather_scatter_info::gather_scatter_info(
@@ -519,3 +541,84 @@ bool gather_scatter_info::base_reg_is_gr32() const {
   }
   return false;
 }
+
+bool gather_scatter_info::operands_recorded() const {
+  // the index register comes from the memory operand, the last one recorded
+  return data_dest_reg_set() && XED_REG_valid(_mask_reg) &&
+         XED_REG_valid(_index_reg);
+}
+
+void gather_scatter_info::compute_lane_layout() {
+  verify_fields_for_mem_access_info_generation();
+  assert(_num_mem_ops <= GATHER_SCATTER_MAX_LANES);
+  _lane_layout.num_lanes              = _num_mem_ops;
+  _lane_layout.index_lane_width_bytes = _index_lane_width_bytes;
+  _lane_layout.data_lane_width_bytes  = _data_lane_width_bytes;
+  _lane_layout.scale                  = _scale;
+  _lane_layout.displacement           = _displacement;
+  _lane_layout.mask_is_k = (gather_scatter_info::K == _mask_reg_type);
+}
+
+const gather_scatter_lane_layout& gather_scatter_info::get_lane_layout() const {
+  assert(_lane_layout.num_lanes);
+  return _lane_layout;
+}
+
+// Straight-line loops over fixed-width lanes, so that the compiler turns each
+// of them into a few vector instructions
+template <typename T>
+static void expand_lane_addrs(const T* index_vals, const uint32_t num_lanes,
+                              const int64_t base, const int64_t scale,
+                              uint64_t* lane_addrs) {
+  for(uint32_t lane = 0; lane < num_lanes; lane++) {
+    lane_addrs[lane] = (uint64_t)(base + (int64_t)index_vals[lane] * scale);
+  }
+}
+
+template <typename T>
+static uint64_t expand_lane_msb_mask(const T*       mask_vals,
+                                     const uint32_t num_lanes) {
+  uint64_t mask_on = 0;
+  for(uint32_t lane = 0; lane < num_lanes; lane++) {
+    mask_on |= (uint64_t)(mask_vals[lane] < 0) << lane;
+  }
+  return mask_on;
+}
+
+uint64_t expand_gather_scatter_lanes(const gather_scatter_lane_layout& layout,
+                                     const int64_t  base_addr_contribution,
+                                     const uint8_t* index_reg_val,
+                                     const uint8_t* mask_reg_val,
+                                     uint64_t*      lane_addrs) {
+  const uint32_t n    = layout.num_lanes;
+  const int64_t  base = base_addr_contribution + (int64_t)layout.displacement;
+  assert(n && n <= GATHER_SCATTER_MAX_LANES);
+
+  if(4 == layout.index_lane_width_bytes) {
+    int32_t index_vals[GATHER_SCATTER_MAX_LANES];
+    memcpy(index_vals, index_reg_val, n * sizeof(int32_t));
+    expand_lane_addrs(index_vals, n, base, layout.scale, lane_addrs);
+  } else {
+    assert(8 == layout.index_lane_width_bytes);
+    int64_t index_vals[GATHER_SCATTER_MAX_LANES];
+    memcpy(index_vals, index_reg_val, n * sizeof(int64_t));
+    expand_lane_addrs(index_vals, n, base, layout.scale, lane_addrs);
+  }
+
+  if(layout.mask_is_k) {
+    // one bit per lane in the low word of the k register
+    uint16_t k_mask;
+    memcpy(&k_mask, mask_reg_val, sizeof(k_mask));
+    return k_mask & ((1ULL << n) - 1);
+  }
+  // conditionality is the most significant bit of each data element
+  if(4 == layout.data_lane_width_bytes) {
+    int32_t mask_vals[GATHER_SCATTER_MAX_LANES];
+    memcpy(mask_vals, mask_reg_val, n * sizeof(int32_t));
+    return expand_lane_msb_mask(mask_vals, n);
+  }
+  assert(8 == layout.data_lane_width_bytes);
+  int64_t mask_vals[GATHER_SCATTER_MAX_LANES];
+  memcpy(mask_vals, mask_reg_val, n * sizeof(int64_t));
+  return expand_lane_msb_mask(mask_vals, n);
+}
@@ -34,6 +34,19 @@
 #include "../../ctype_pin_inst.h"
 #include "pin_api_to_xed.h"
 
+#define GATHER_SCATTER_MAX_LANES 16  // 512-bit vector of doubleword indices
+
+// Everything needed to turn a dynamic instance's register values into lane
+// addresses, fixed once the static instruction has been decoded
+struct gather_scatter_lane_layout {
+  uint32_t num_lanes;
+  uint32_t index_lane_width_bytes;
+  uint32_t data_lane_width_bytes;
+  uint32_t scale;
+  uint64_t displacement;
+  bool     mask_is_k;  // k mask register, otherwise msb of each xmm/ymm lane
+};
+
 class gather_scatter_info {
  public:
   enum type { INVALID_TYPE, GATHER, SCATTER, NUM_TYPES };
@@ -72,6 +85,9 @@ class gather_scatter_info {
   uint32_t       get_num_mem_ops() const;
   void           verify_fields_for_mem_access_info_generation() const;
   bool           base_reg_is_gr32() const;
+  bool           operands_recorded() const;
+  void           compute_lane_layout();
+  const gather_scatter_lane_layout& get_lane_layout() const;
 
   friend std::ostream& operator<<(std::ostream&              os,
                                   const gather_scatter_info& sinfo);
@@ -88,6 +104,7 @@ class gather_scatter_info {
   uint32_t                           _scale;
   uint32_t                           _index_lane_width_bytes;
   uint32_t                           _num_mem_ops;
+  gather_scatter_lane_layout         _lane_layout;
 
   bool     is_non_zero_and_powerof2(const uint32_t v) const;
   uint32_t pin_xyzmm_reg_width_in_bytes(
@@ -110,6 +127,14 @@ void set_gather_scatter_memory_operand_info(const ADDRINT        iaddr,
                                             const bool operandReadOnly,
                                             const bool operandWritenOnly);
 void finalize_scatter_info(const ADDRINT iaddr, ctype_pin_inst* info);
+// Computes the address and mask bit of every lane of a dynamic instance in one
+// pass over the raw index and mask register contents. Returns the bitmap of
+// masked-on lanes.
+uint64_t expand_gather_scatter_lanes(const gather_scatter_lane_layout& layout,
+                                     const int64_t  base_addr_contribution,
+                                     const uint8_t* index_reg_val,
+                                     const uint8_t* mask_reg_val,
+                                     uint64_t*      lane_addrs);
 void init_reg_xed_to_pin_map();
 
 #endif  // __SCATTER_H__
@@ -22,7 +22,13 @@
 
 #include "message_queue_interface_lib.h"
 
-extern "C" {}
+extern "C" {
+#ifndef PIN_COMPILE
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#endif
+}
 
 #define RECEIVE_BUFFER_MAX_SIZE (0x01 << 12)
 #define CHECK_FOR_FAILURE(f, str)                                       \
@@ -88,6 +94,9 @@ const std::vector<char>* MessageBase::get_raw_data() const {
  *******************************************************************************************/
 
 TCPSocket::TCPSocket() {
+#ifndef PIN_COMPILE
+  use_inet = false;
+#endif
   server_init_message   = "Server Init Message";
   client_init_message   = "Client Init Message";
   socket_address_length = sizeof(socket_address);
@@ -141,6 +150,25 @@ std::vector<char> TCPSocket::scarab_receive(SocketDescriptor socket) {
   return message;
 }
 
+std::vector<char> TCPSocket::receive_bytes(SocketDescriptor socket,
+                                           uint32_t         num_bytes) {
+  std::vector<char> message(num_bytes);
+  uint32_t          total_bytes_recv = 0;
+
+  while(total_bytes_recv < num_bytes) {
+    int32_t bytes_recv = recv(socket, &message[total_bytes_recv],
+                              num_bytes - total_bytes_recv, 0);
+    CHECK_FOR_FAILURE(bytes_recv == 0,
+                      "Socket closed unexpectedly on read (receive_bytes)");
+    if(bytes_recv < 0 && (errno == EWOULDBLOCK || errno == EAGAIN ||
+                          errno == EINTR))
+      continue;
+    CHECK_FOR_FAILURE(bytes_recv < 0, "Receive Failed (receive_bytes)");
+    total_bytes_recv += bytes_recv;
+  }
+  return message;
+}
+
 #endif
 
 #if defined(PIN_COMPILE) || defined(GTEST_COMPILE)
@@ -207,16 +235,68 @@ void TCPSocket::create_socket_file_descriptor() {
    * TCP. 0 (the protocol field): allow the OS to choose the most appropirate
    * protocol. Should choose TCP.
    */
+#ifndef PIN_COMPILE
+  use_inet = socket_path.compare(0, 4, "tcp:") == 0;
+  if(use_inet) {
+    int32_t one = 1;
+    socket_fd   = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_FOR_FAILURE(socket_fd < 0, "Socket Failed");
+    setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return;
+  }
+#endif
   socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
   CHECK_FOR_FAILURE(socket_fd == 0, "Socket Failed");
 }
 
 void TCPSocket::setup_unix_sockaddr_struct() {
+#ifndef PIN_COMPILE
+  if(use_inet) {
+    setup_inet_sockaddr_struct();
+    return;
+  }
+#endif
   socket_address.sun_family = AF_UNIX;
   strcpy(socket_address.sun_path, socket_path.c_str());
 }
 
+/* tcp:<host>:<port>, an empty host is any address (for the server) */
+void TCPSocket::setup_inet_sockaddr_struct() {
+#ifndef PIN_COMPILE
+  size_t colon = socket_path.rfind(':');
+  assertm(colon > 3, "A tcp socket path is tcp:<host>:<port>");
+  std::string host = socket_path.substr(4, colon - 4);
+  std::string port = socket_path.substr(colon + 1);
+
+  memset(&inet_address, 0, sizeof(inet_address));
+  inet_address.sin_family = AF_INET;
+  inet_address.sin_port   = htons(atoi(port.c_str()));
+  if(host.empty() || host == "*") {
+    inet_address.sin_addr.s_addr = htonl(INADDR_ANY);
+  } else {
+    struct addrinfo  hints;
+    struct addrinfo* result = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    CHECK_FOR_FAILURE(getaddrinfo(host.c_str(), NULL, &hints, &result) || !result,
+                      "Could not resolve the host of the tcp socket");
+    inet_address.sin_addr = ((struct sockaddr_in*)result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+  }
+#endif
+}
+
 void TCPSocket::bind_socket_to_file() {
+#ifndef PIN_COMPILE
+  if(use_inet) {
+    int32_t failure = bind(socket_fd, (struct sockaddr*)&inet_address,
+                           sizeof(inet_address));
+    CHECK_FOR_FAILURE(failure < 0, "Bind Failed");
+    return;
+  }
+#endif
   unlink(socket_path.c_str());
   int32_t failure = bind(socket_fd, (struct sockaddr*)&socket_address,
                          socket_address_length);
@@ -257,8 +337,13 @@ Server::Server(const std::string& _socket_path, uint32_t numClients) {
 
 Server::~Server() {
   for(uint32_t i = 0; i < client_fds.size(); ++i) {
-    close(client_fds[i]);
+    if(client_fds[i] >= 0)
+      close(client_fds[i]);
   }
+#ifndef PIN_COMPILE
+  if(use_inet)
+    return;
+#endif
   unlink(socket_path.c_str());
 }
 
@@ -297,8 +382,13 @@ void Server::accept_new_clients() {
   SocketDescriptor new_socket;
 
   do {
-    new_socket = accept(socket_fd, (struct sockaddr*)&socket_address,
-                        (socklen_t*)&socket_address_length);
+#ifndef PIN_COMPILE
+    if(use_inet)
+      new_socket = accept(socket_fd, NULL, NULL);
+    else
+#endif
+      new_socket = accept(socket_fd, (struct sockaddr*)&socket_address,
+                          (socklen_t*)&socket_address_length);
     CHECK_FOR_FAILURE(
       new_socket < 0 && (errno != EWOULDBLOCK && errno != EAGAIN),
       "Accept Failed (1)");
@@ -358,10 +448,34 @@ void Server::verify_and_assign_requested_client_ids(uint32_t numClients) {
   client_fds = temp_client_fds;
 }
 
+#if !defined(PIN_COMPILE) || defined(GTEST_COMPILE)
+int32_t Server::wait_for_client(int timeout_ms) {
+  std::vector<struct pollfd> fds(client_fds.size());
+  for(uint32_t i = 0; i < client_fds.size(); ++i) {
+    fds[i].fd      = client_fds[i];
+    fds[i].events  = POLLIN;
+    fds[i].revents = 0;
+  }
+
+  int32_t ready;
+  do {
+    ready = poll(fds.data(), fds.size(), timeout_ms);
+  } while(ready < 0 && errno == EINTR);
+  CHECK_FOR_FAILURE(ready < 0, "Poll Failed");
+
+  for(uint32_t i = 0; i < fds.size(); ++i) {
+    if(fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+      return i;
+  }
+  return -1;
+}
+#endif
+
 void Server::disconnect(uint32_t client_id) {
   assertm(client_id < client_fds.size(),
           "Attempting to disconnect from an invalid client_id!");
   TCPSocket::disconnect(client_fds[client_id]);
+  client_fds[client_id] = -1;  // ignored by wait_for_client
 }
 
 /********************************************************************************************
@@ -401,9 +515,17 @@ void Client::connect_to_server() {
   constexpr int WAIT_PERIOD_IN_USECONDS = 100000;  // Retry after 100ms
   constexpr int NUM_TRIALS              = 100;     // Total trail time = 10s
 
+  struct sockaddr* address        = (struct sockaddr*)&socket_address;
+  socklen_t        address_length = socket_address_length;
+#ifndef PIN_COMPILE
+  if(use_inet) {
+    address        = (struct sockaddr*)&inet_address;
+    address_length = sizeof(inet_address);
+  }
+#endif
+
   for(int i = 0; i < NUM_TRIALS; ++i) {
-    if(connect(socket_fd, (struct sockaddr*)&socket_address,
-               socket_address_length) == 0) {
+    if(connect(socket_fd, address, address_length) == 0) {
       return;
     }
 
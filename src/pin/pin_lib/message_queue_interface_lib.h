@@ -29,6 +29,9 @@ extern "C" {
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#ifndef PIN_COMPILE
+#include <netinet/in.h>
+#endif
 }
 
 #include <algorithm>
@@ -248,6 +251,13 @@ class TCPSocket {
   bool               is_server;
   SocketDescriptor   socket_fd;
   struct sockaddr_un socket_address;
+#ifndef PIN_COMPILE
+  /* a socket_path of the form tcp:<host>:<port> connects over TCP/IPv4 instead
+   * of a unix socket, so that the server and the clients can be on different
+   * hosts */
+  bool               use_inet;
+  struct sockaddr_in inet_address;
+#endif
   int32_t            socket_address_length;
   std::string        socket_path;  // TODO: initialize this
   std::deque<char>   receive_buffer;
@@ -259,6 +269,7 @@ class TCPSocket {
 
 #if !defined(PIN_COMPILE) || defined(GTEST_COMPILE)
   std::vector<char> scarab_receive(SocketDescriptor socket);
+  std::vector<char> receive_bytes(SocketDescriptor socket, uint32_t num_bytes);
 #endif
 
 #if defined(PIN_COMPILE) || defined(GTEST_COMPILE)
@@ -270,6 +281,7 @@ class TCPSocket {
   void verify_socket_write(SocketDescriptor new_socket, std::string msg);
   void create_socket_file_descriptor();
   void setup_unix_sockaddr_struct();
+  void setup_inet_sockaddr_struct();
   void bind_socket_to_file();
   int  setNonblocking();
   void disconnect(SocketDescriptor socket);
@@ -281,6 +293,11 @@ class TCPSocket {
   void send(SocketDescriptor socket, const Message<T>& m);
   template <typename T>
   Message<T> receive(SocketDescriptor socket);
+#if !defined(PIN_COMPILE) || defined(GTEST_COMPILE)
+  /* receives exactly sizeof(T) bytes, however the stream splits them */
+  template <typename T>
+  Message<T> receive_exact(SocketDescriptor socket);
+#endif
 };
 
 class Server : public TCPSocket {
@@ -310,6 +327,13 @@ class Server : public TCPSocket {
   void       disconnect(uint32_t client_id);
   uint32_t   getNumClients() const { return client_fds.size(); }
   void       wait_for_client_to_close(uint32_t client_id);
+#if !defined(PIN_COMPILE) || defined(GTEST_COMPILE)
+  template <typename T>
+  Message<T> receive_exact(uint32_t id);
+  /* id of a connected client with data to read, after waiting up to timeout_ms
+   * (-1: forever); -1 if there is none */
+  int32_t    wait_for_client(int timeout_ms);
+#endif
 };
 
 class Client : public TCPSocket {
@@ -331,6 +355,10 @@ class Client : public TCPSocket {
   template <typename T>
   Message<T> receive();
   void       disconnect();
+#if !defined(PIN_COMPILE) || defined(GTEST_COMPILE)
+  template <typename T>
+  Message<T> receive_exact();
+#endif
 
 #ifdef GTEST_COMPILE
   template <typename T>
@@ -348,6 +376,23 @@ Message<T> Server::receive(uint32_t id) {
   return TCPSocket::receive<T>(client_fds[id]);
 }
 
+#if !defined(PIN_COMPILE) || defined(GTEST_COMPILE)
+template <typename T>
+Message<T> Server::receive_exact(uint32_t id) {
+  return TCPSocket::receive_exact<T>(client_fds[id]);
+}
+
+template <typename T>
+Message<T> Client::receive_exact() {
+  return TCPSocket::receive_exact<T>(socket_fd);
+}
+
+template <typename T>
+Message<T> TCPSocket::receive_exact(SocketDescriptor socket) {
+  return Message<T>(receive_bytes(socket, sizeof(T)));
+}
+#endif
+
 template <typename T>
 void Client::send(const Message<T>& m) {
   TCPSocket::send(socket_fd, m);
@@ -65,6 +65,8 @@ struct InstInfo {
   bool last_inst_from_trace;
   // used by MEMTRACE frontend to distinguish fetched/non-fetched inst
   bool fetched_instruction;
+  // used by MEMTRACE frontend: ordinal of the instruction record in the trace (1-based)
+  uint64_t ordinal;
 };
 
 #define XED_OP_NAME(ins, op) \
@@ -0,0 +1,258 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : pin/pin_lib/pin_trace_compact.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Compact PIN trace records: a dictionary of static instructions and
+ *                short dynamic records, written by gen_trace -compact and read by the
+ *                trace frontend (frontend/pin_trace_read.cc)
+ ***************************************************************************************/
+
+/* The decompressed trace starts with PIN_TRACE_COMPACT_MAGIC, the format version and
+   sizeof(ctype_pin_inst), then has one record per dynamic instruction:
+
+     flags        PTC_* bits
+     static inst  sizeof(ctype_pin_inst) bytes, with PTC_DEFINE: the next dictionary entry
+     index        varint, without PTC_DEFINE: the dictionary entry of the instruction
+     target       8 bytes, with PTC_TARGET: the branch target changed since the last
+                  instance of the entry
+     uid          8 bytes, with PTC_UID (an inst_uid of 0 is not stored)
+     addresses    zigzag varint per load, then per store: the difference to the address
+                  of the same operand in the last instance of the entry
+     next         8 bytes, with PTC_NEXT: instruction_next_addr, when it is not the
+                  taken target or the fall-through
+
+   An entry is the instruction with its dynamic fields cleared, so any change of a
+   static field (such as the access size of a string instruction) makes a new entry and
+   the reader gets back exactly the instructions that were written. */
+
+#ifndef __PIN_TRACE_COMPACT_H__
+#define __PIN_TRACE_COMPACT_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../ctype_pin_inst.h"
+
+#define PIN_TRACE_COMPACT_MAGIC "ScarabCT"
+#define PIN_TRACE_COMPACT_MAGIC_LEN 8
+#define PIN_TRACE_COMPACT_VERSION 1
+#define PIN_TRACE_COMPACT_HEADER_LEN (PIN_TRACE_COMPACT_MAGIC_LEN + 8)
+
+enum Pin_Trace_Compact_Flags {
+  PTC_DEFINE = 1 << 0,
+  PTC_TAKEN  = 1 << 1,
+  PTC_TARGET = 1 << 2,
+  PTC_UID    = 1 << 3,
+  PTC_NEXT   = 1 << 4,
+};
+
+/* the entry of an instruction: everything but its dynamic fields */
+inline void pin_trace_compact_clear_dynamic(ctype_pin_inst* inst) {
+  inst->inst_uid = 0;
+  memset(inst->ld_vaddr, 0, sizeof(inst->ld_vaddr));
+  memset(inst->st_vaddr, 0, sizeof(inst->st_vaddr));
+  inst->branch_target         = 0;
+  inst->actually_taken        = 0;
+  inst->instruction_next_addr = 0;
+}
+
+/* the instruction_next_addr that is not stored */
+inline uint64_t pin_trace_compact_next(const ctype_pin_inst* inst) {
+  return inst->actually_taken ? inst->branch_target :
+                                inst->instruction_addr + inst->size;
+}
+
+/**************************************************************************************/
+/* Pin_Trace_Compact_Writer */
+
+class Pin_Trace_Compact_Writer {
+ public:
+  static void write_header(FILE* out) {
+    uint32_t header[2] = {PIN_TRACE_COMPACT_VERSION, sizeof(ctype_pin_inst)};
+    fwrite(PIN_TRACE_COMPACT_MAGIC, 1, PIN_TRACE_COMPACT_MAGIC_LEN, out);
+    fwrite(header, sizeof(header), 1, out);
+  }
+
+  void write(FILE* out, const ctype_pin_inst& inst) {
+    ctype_pin_inst image = inst;
+    pin_trace_compact_clear_dynamic(&image);
+    std::string key(reinterpret_cast<const char*>(&image), sizeof(image));
+
+    uint8_t  flags = 0;
+    uint32_t idx;
+    auto     it = index.find(key);
+    if(it == index.end()) {
+      flags |= PTC_DEFINE;
+      idx = entries.size();
+      index.emplace(std::move(key), idx);
+      entries.push_back(image);
+    } else {
+      idx = it->second;
+    }
+    ctype_pin_inst* entry = &entries[idx];
+
+    if(inst.actually_taken)
+      flags |= PTC_TAKEN;
+    if(inst.branch_target != entry->branch_target)
+      flags |= PTC_TARGET;
+    if(inst.inst_uid)
+      flags |= PTC_UID;
+    if(inst.instruction_next_addr != pin_trace_compact_next(&inst))
+      flags |= PTC_NEXT;
+
+    buf.clear();
+    buf.push_back(flags);
+    if(flags & PTC_DEFINE)
+      put_bytes(&image, sizeof(image));
+    else
+      put_varint(idx);
+    if(flags & PTC_TARGET)
+      put_bytes(&inst.branch_target, 8);
+    if(flags & PTC_UID)
+      put_bytes(&inst.inst_uid, 8);
+    for(uint8_t ii = 0; ii < inst.num_ld && ii < MAX_LD_NUM; ii++)
+      put_varint(zigzag(inst.ld_vaddr[ii] - entry->ld_vaddr[ii]));
+    for(uint8_t ii = 0; ii < inst.num_st && ii < MAX_ST_NUM; ii++)
+      put_varint(zigzag(inst.st_vaddr[ii] - entry->st_vaddr[ii]));
+    if(flags & PTC_NEXT)
+      put_bytes(&inst.instruction_next_addr, 8);
+    fwrite(buf.data(), 1, buf.size(), out);
+
+    entry->branch_target = inst.branch_target;
+    memcpy(entry->ld_vaddr, inst.ld_vaddr, sizeof(inst.ld_vaddr));
+    memcpy(entry->st_vaddr, inst.st_vaddr, sizeof(inst.st_vaddr));
+  }
+
+  size_t num_entries() const { return entries.size(); }
+
+ private:
+  static uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+  }
+  void put_bytes(const void* src, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(src);
+    buf.insert(buf.end(), bytes, bytes + size);
+  }
+  void put_varint(uint64_t value) {
+    for(; value >= 0x80; value >>= 7)
+      buf.push_back((uint8_t)(value | 0x80));
+    buf.push_back((uint8_t)value);
+  }
+
+  std::unordered_map<std::string, uint32_t> index;
+  std::vector<ctype_pin_inst> entries;  // static fields and last dynamic values
+  std::vector<uint8_t>        buf;
+};
+
+/**************************************************************************************/
+/* Pin_Trace_Compact_Reader: Source has bool get(uint8_t*) and bool read(void*, size_t),
+   both returning false at the end of the trace */
+
+class Pin_Trace_Compact_Reader {
+ public:
+  /* whether header (PIN_TRACE_COMPACT_HEADER_LEN bytes) starts a compact trace; a
+     compact trace of another ctype_pin_inst layout is an error */
+  static bool is_compact(const char* header, bool* layout_ok) {
+    uint32_t fields[2];
+    if(memcmp(header, PIN_TRACE_COMPACT_MAGIC, PIN_TRACE_COMPACT_MAGIC_LEN))
+      return false;
+    memcpy(fields, header + PIN_TRACE_COMPACT_MAGIC_LEN, sizeof(fields));
+    *layout_ok = fields[0] == PIN_TRACE_COMPACT_VERSION &&
+                 fields[1] == sizeof(ctype_pin_inst);
+    return true;
+  }
+
+  void reset() { entries.clear(); }
+
+  template <typename Source>
+  bool read(Source& src, ctype_pin_inst* inst) {
+    uint8_t flags;
+    if(!src.get(&flags))
+      return false;
+
+    uint64_t idx = entries.size();
+    if(flags & PTC_DEFINE) {
+      entries.emplace_back();
+      if(!src.read(&entries.back(), sizeof(ctype_pin_inst)))
+        return false;
+    } else if(!get_varint(src, &idx) || idx >= entries.size()) {
+      return false;
+    }
+    ctype_pin_inst* entry = &entries[idx];
+
+    if((flags & PTC_TARGET) && !src.read(&entry->branch_target, 8))
+      return false;
+    uint64_t uid = 0;
+    if((flags & PTC_UID) && !src.read(&uid, 8))
+      return false;
+    for(uint8_t ii = 0; ii < entry->num_ld && ii < MAX_LD_NUM; ii++) {
+      uint64_t delta;
+      if(!get_varint(src, &delta))
+        return false;
+      entry->ld_vaddr[ii] += unzigzag(delta);
+    }
+    for(uint8_t ii = 0; ii < entry->num_st && ii < MAX_ST_NUM; ii++) {
+      uint64_t delta;
+      if(!get_varint(src, &delta))
+        return false;
+      entry->st_vaddr[ii] += unzigzag(delta);
+    }
+
+    *inst                = *entry;
+    inst->inst_uid       = uid;
+    inst->actually_taken = (flags & PTC_TAKEN) != 0;
+    if(flags & PTC_NEXT)
+      return src.read(&inst->instruction_next_addr, 8);
+    inst->instruction_next_addr = pin_trace_compact_next(inst);
+    return true;
+  }
+
+ private:
+  static uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+  }
+  template <typename Source>
+  static bool get_varint(Source& src, uint64_t* value) {
+    *value = 0;
+    for(unsigned shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if(!src.get(&byte))
+        return false;
+      *value |= (uint64_t)(byte & 0x7f) << shift;
+      if(!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  std::vector<ctype_pin_inst> entries;  // static fields and last dynamic values
+};
+
+#endif
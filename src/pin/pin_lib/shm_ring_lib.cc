@@ -0,0 +1,226 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : pin/pin_lib/shm_ring_lib.cc
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Shared-memory rings carrying ops from PIN to Scarab and commands from
+ *                Scarab to PIN, in place of the unix socket of the exec-driven frontend
+ ***************************************************************************************/
+
+#include "shm_ring_lib.h"
+
+extern "C" {
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+#include <assert.h>
+#include <new>
+
+/* polls of a counter before each yield to the OS */
+#define SHM_RING_SPIN_POLLS 1024
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "shared counters must be plain words");
+
+namespace {
+
+inline void backoff(uint32_t& polls) {
+  if(++polls % SHM_RING_SPIN_POLLS == 0)
+    sched_yield();
+  else
+    __builtin_ia32_pause();
+}
+
+}  // namespace
+
+ShmRing::ShmRing() : hdr(NULL), ops(NULL), map_size(0), owner(false), write_pos(0), flush_wait(0) {}
+
+ShmRing::~ShmRing() {
+  if(hdr)
+    munmap(hdr, map_size);
+  if(owner)
+    unlink(file_path.c_str());
+}
+
+std::string ShmRing::path_for(const std::string& socket_path, uint32_t core_id) {
+  return socket_path + ".ring" + std::to_string(core_id);
+}
+
+bool ShmRing::map(int fd, size_t size) {
+  void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(addr == MAP_FAILED)
+    return false;
+  hdr      = (Shm_Ring_Header*)addr;
+  ops      = (compressed_op*)((char*)addr + sizeof(Shm_Ring_Header));
+  map_size = size;
+  return true;
+}
+
+bool ShmRing::create(const std::string& path, uint32_t op_capacity, uint32_t runahead_ops) {
+  size_t size = sizeof(Shm_Ring_Header) + (size_t)op_capacity * sizeof(compressed_op);
+  int    fd   = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if(fd < 0)
+    return false;
+  if(ftruncate(fd, size) != 0) {
+    close(fd);
+    return false;
+  }
+  if(!map(fd, size))
+    return false;
+  file_path = path;
+  owner     = true;
+  new(&hdr->op_head) std::atomic<uint64_t>(0);
+  new(&hdr->op_tail) std::atomic<uint64_t>(0);
+  new(&hdr->packets) std::atomic<uint64_t>(0);
+  new(&hdr->cmd_head) std::atomic<uint64_t>(0);
+  new(&hdr->cmd_tail) std::atomic<uint64_t>(0);
+  new(&hdr->flush_seq) std::atomic<uint64_t>(0);
+  new(&hdr->flush_tail) std::atomic<uint64_t>(0);
+  hdr->op_capacity  = op_capacity;
+  hdr->runahead_ops = runahead_ops;
+  return true;
+}
+
+bool ShmRing::attach(const std::string& path) {
+  int fd = open(path.c_str(), O_RDWR);
+  if(fd < 0)
+    return false;
+  off_t size = lseek(fd, 0, SEEK_END);
+  if(size < (off_t)sizeof(Shm_Ring_Header)) {
+    close(fd);
+    return false;
+  }
+  if(!map(fd, size))
+    return false;
+  file_path = path;
+  write_pos = hdr->op_tail.load(std::memory_order_acquire);
+  return true;
+}
+
+/**************************************************************************************/
+/* Scarab side */
+
+void ShmRing::push_cmd(const Scarab_To_Pin_Msg& msg) {
+  uint64_t tail  = hdr->cmd_tail.load(std::memory_order_relaxed);
+  uint32_t polls = 0;
+  while(tail - hdr->cmd_head.load(std::memory_order_acquire) >= SHM_RING_CMD_CAPACITY)
+    backoff(polls);
+  hdr->cmds[tail % SHM_RING_CMD_CAPACITY] = msg;
+  hdr->cmd_tail.store(tail + 1, std::memory_order_release);
+}
+
+uint64_t ShmRing::num_packets() const {
+  return hdr->packets.load(std::memory_order_acquire);
+}
+
+void ShmRing::wait_for_packet(uint64_t last_packets) const {
+  uint32_t polls = 0;
+  while(hdr->packets.load(std::memory_order_acquire) == last_packets)
+    backoff(polls);
+}
+
+/* Wait for PIN to acknowledge the last redirect or recover and drop the ops it invalidated */
+void ShmRing::sync_flush() {
+  if(!flush_wait)
+    return;
+  uint32_t polls = 0;
+  while(hdr->flush_seq.load(std::memory_order_acquire) < flush_wait)
+    backoff(polls);
+  hdr->op_head.store(hdr->flush_tail.load(std::memory_order_relaxed), std::memory_order_release);
+  flush_wait = 0;
+}
+
+bool ShmRing::ops_empty() {
+  sync_flush();
+  return hdr->op_head.load(std::memory_order_relaxed) == hdr->op_tail.load(std::memory_order_acquire);
+}
+
+compressed_op* ShmRing::op_front() {
+  sync_flush();
+  assert(!ops_empty());
+  return &ops[hdr->op_head.load(std::memory_order_relaxed) % hdr->op_capacity];
+}
+
+void ShmRing::op_pop() {
+  assert(!ops_empty());
+  hdr->op_head.store(hdr->op_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/* Called right after pushing a redirect or recover; PIN may still be publishing the old path */
+void ShmRing::request_flush() {
+  flush_wait = hdr->cmd_tail.load(std::memory_order_relaxed);
+}
+
+/**************************************************************************************/
+/* PIN side */
+
+Scarab_To_Pin_Msg ShmRing::pop_cmd() {
+  uint64_t head  = hdr->cmd_head.load(std::memory_order_relaxed);
+  uint32_t polls = 0;
+  while(hdr->cmd_tail.load(std::memory_order_acquire) == head)
+    backoff(polls);
+  Scarab_To_Pin_Msg msg = hdr->cmds[head % SHM_RING_CMD_CAPACITY];
+  hdr->cmd_head.store(head + 1, std::memory_order_release);
+  return msg;
+}
+
+/* A fetch sent before Scarab saw the latest packet; it would release a syscall too early */
+bool ShmRing::is_stale_fetch(const Scarab_To_Pin_Msg& msg) const {
+  return hdr->runahead_ops && msg.type == FE_FETCH_OP &&
+         msg.inst_uid != hdr->packets.load(std::memory_order_relaxed);
+}
+
+void ShmRing::write_op(const compressed_op& cop) {
+  uint32_t polls = 0;
+  while(write_pos - hdr->op_head.load(std::memory_order_acquire) >= hdr->op_capacity)
+    backoff(polls);
+  ops[write_pos % hdr->op_capacity] = cop;
+  write_pos++;
+}
+
+uint32_t ShmRing::num_unpublished_ops() const {
+  return write_pos - hdr->op_tail.load(std::memory_order_relaxed);
+}
+
+bool ShmRing::can_run_ahead() const {
+  return hdr->runahead_ops &&
+         hdr->op_tail.load(std::memory_order_relaxed) - hdr->op_head.load(std::memory_order_acquire) <
+           hdr->runahead_ops;
+}
+
+void ShmRing::publish_ops() {
+  hdr->op_tail.store(write_pos, std::memory_order_release);
+  hdr->packets.fetch_add(1, std::memory_order_release);
+}
+
+/* Called on every redirect and recover: acknowledges the command just read */
+void ShmRing::discard_unpublished_ops() {
+  write_pos = hdr->op_tail.load(std::memory_order_relaxed);
+  hdr->flush_tail.store(write_pos, std::memory_order_relaxed);
+  hdr->flush_seq.store(hdr->cmd_head.load(std::memory_order_relaxed), std::memory_order_release);
+}
@@ -0,0 +1,117 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : pin/pin_lib/shm_ring_lib.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Shared-memory rings carrying ops from PIN to Scarab and commands from
+ *                Scarab to PIN, in place of the unix socket of the exec-driven frontend
+ ***************************************************************************************/
+
+/* One file per core, mapped by both processes. The op ring has a single producer (PIN)
+   and a single consumer (Scarab): PIN writes compressed_ops straight into the slots past
+   op_tail and makes them visible as one packet by moving op_tail and bumping packets;
+   Scarab decodes them in place and frees them by moving op_head. The command ring goes
+   the other way with the same scheme. Both sides spin on the counters, and yield to the
+   OS when the other side is slow, so no round trip goes through the kernel.
+
+   With runahead_ops, PIN publishes packets without waiting for FE_FETCH_OP as long as
+   Scarab has fewer than runahead_ops of them left to read. Scarab still sends FE_FETCH_OP
+   when it runs dry, tagged with the packets it has seen, and PIN ignores the ones that
+   are out of date. A redirect or recover invalidates ops Scarab cannot see yet, so PIN
+   acknowledges each one with the op_tail it flushed to, and Scarab drops everything
+   before that tail before it reads on.
+
+   The socket is still used to connect and to wait for PIN to exit. */
+
+#ifndef __SHM_RING_LIB_H__
+#define __SHM_RING_LIB_H__
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include "pin_scarab_common_lib.h"
+
+#define SHM_RING_CMD_CAPACITY 1024
+
+struct Shm_Ring_Header {
+  std::atomic<uint64_t> op_head;   // next op Scarab reads
+  std::atomic<uint64_t> op_tail;   // end of the ops PIN has published
+  std::atomic<uint64_t> packets;   // packets PIN has published
+  std::atomic<uint64_t> cmd_head;  // next command PIN reads
+  std::atomic<uint64_t> cmd_tail;  // end of the commands Scarab has pushed
+  std::atomic<uint64_t> flush_seq;   // commands PIN had read at its last flush
+  std::atomic<uint64_t> flush_tail;  // op_tail at that flush
+  uint32_t              op_capacity;
+  uint32_t              runahead_ops;
+  Scarab_To_Pin_Msg     cmds[SHM_RING_CMD_CAPACITY];
+};
+
+class ShmRing {
+ public:
+  ShmRing();
+  ~ShmRing();
+
+  /* Scarab: create the file with room for op_capacity ops */
+  bool create(const std::string& path, uint32_t op_capacity, uint32_t runahead_ops);
+  /* PIN: map the file if Scarab created one */
+  bool attach(const std::string& path);
+  uint32_t op_capacity() const { return hdr->op_capacity; }
+  uint32_t runahead_ops() const { return hdr->runahead_ops; }
+
+  /* Scarab side */
+  void           push_cmd(const Scarab_To_Pin_Msg& msg);
+  uint64_t       num_packets() const;
+  void           wait_for_packet(uint64_t last_packets) const;
+  bool           ops_empty();
+  compressed_op* op_front();
+  void           op_pop();
+  void           request_flush();
+
+  /* PIN side */
+  Scarab_To_Pin_Msg pop_cmd();
+  bool              is_stale_fetch(const Scarab_To_Pin_Msg& msg) const;
+  void              write_op(const compressed_op& cop);
+  uint32_t          num_unpublished_ops() const;
+  bool              can_run_ahead() const;
+  void              publish_ops();
+  void              discard_unpublished_ops();
+
+  static std::string path_for(const std::string& socket_path, uint32_t core_id);
+
+ private:
+  Shm_Ring_Header* hdr;
+  compressed_op*   ops;
+  size_t           map_size;
+  std::string      file_path;
+  bool             owner;
+  uint64_t         write_pos;  // PIN: end of the unpublished ops
+  uint64_t         flush_wait; // Scarab: commands PIN must have read before the next op (0 = none)
+
+  void sync_flush();
+
+  bool map(int fd, size_t size);
+};
+
+#endif  // __SHM_RING_LIB_H__
@@ -40,6 +40,7 @@
 
 #include "bp/bp.param.h"
 #include "general.param.h"
+#include "memory/memory.param.h"
 
 #include "bp/bp.h"
 #include "isa/isa.h"
@@ -47,6 +48,7 @@
 #include "libs/hash_lib.h"
 
 #include "ctype_pin_inst.h"
+#include "exec_ports.h"
 #include "math.h"
 #include "statistics.h"
 
@@ -56,6 +58,15 @@
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_TRACE_READ, ##args)
 #define DEBUG_PRINT(proc_id, args...) fprintf(GLOBAL_DEBUG_STREAM, ##args)
 #define MAX_PUP 256
+#define UOP_DECODE_CACHE_MAX_UOPS 8  // instructions with more uops always go through the hash table
+#define WRONG_PATH_UOP_CACHE_MAX_UOPS 8
+/* fast-string iterations are keyed in the decoded-instruction hash by the shape of their uop sequence, above the
+   uop indices of ordinary instructions */
+#define FAST_STRING_START 0x1  // first iteration: startup uop
+#define FAST_STRING_MEM 0x2    // iteration touching a new cache line: line-sized loads/stores
+#define FAST_STRING_END 0x4    // last iteration: RSI/RDI/RCX updates
+#define FAST_STRING_MAX_UOPS 16
+#define FAST_STRING_OP_IDX(variant) (128 + (variant)*FAST_STRING_MAX_UOPS)
 /**************************************************************************************/
 /* Types */
 
@@ -93,9 +104,48 @@ struct Trace_Uop_struct {
 
   Inst_Info* info;
   Flag alu_uop;
+  Flag fast_string_startup;  // takes FAST_STRINGS_STARTUP_LATENCY cycles
 };
 typedef struct Trace_Uop_struct Trace_Uop;
 
+/* decoded instruction, as keyed in the decoded-instruction hash, with the Inst_Info of each of its uops */
+typedef struct Uop_Decode_Cache_Entry_struct {
+  Addr addr;
+  uint64_t inst_binary_lsb;
+  uint64_t inst_binary_msb;
+  uns num_uop;  // 0 when the entry is invalid
+  Inst_Info* info[UOP_DECODE_CACHE_MAX_UOPS];
+} Uop_Decode_Cache_Entry;
+
+/* dynamic fields of a generated uop, as uop_generator_get_uop reads them from its Trace_Uop */
+typedef struct Wrong_Path_Uop_struct {
+  Inst_Info* info;
+  uint64_t inst_uid;
+  Flag actual_taken;
+  Addr va;
+  uns mem_size;
+  Addr target;
+  Addr npc;
+  Flag eom;
+  Flag exit;
+} Wrong_Path_Uop;
+
+/* uop sequence generated for a wrong-path instruction, keyed by its trace PC */
+typedef struct Wrong_Path_Uop_Cache_Entry_struct {
+  Addr addr;
+  uns inst_size;
+  Flag fetched_instruction;
+  uns num_uop;  // 0 when the entry is invalid
+  Wrong_Path_Uop uops[WRONG_PATH_UOP_CACHE_MAX_UOPS];
+} Wrong_Path_Uop_Cache_Entry;
+
+/* REP string instruction whose iterations a core is converting under FAST_STRINGS */
+typedef struct Fast_String_State_struct {
+  Addr pc;  // 0 when the last converted instruction did not loop back to itself
+  Addr ld_line[MAX_LD_NUM];
+  Addr st_line[MAX_ST_NUM];
+} Fast_String_State;
+
 /**************************************************************************************/
 /* Global Variables */
 
@@ -112,6 +162,17 @@ uns* num_sending_uop;
 uns* num_uops;
 Addr* last_ga_va;
 
+Uop_Decode_Cache_Entry** uop_decode_cache;
+uns uop_decode_cache_mask;
+
+Wrong_Path_Uop_Cache_Entry** wrong_path_uop_cache;
+uns wrong_path_uop_cache_mask;
+uns wp_num_cores;
+Flag* wp_staged;    // trace_uop_bulk already holds the uops of the next instruction
+Addr* wp_fill_addr; // the next converted instruction fills the cache under this PC (0 = no fill)
+
+Fast_String_State* fast_string_state;
+
 /**************************************************************************************/
 /* Local prototypes */
 
@@ -119,6 +180,7 @@ static void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop*
 static void convert_t_uop_to_info(uns8 proc_id, Trace_Uop* t_uop, Inst_Info* info);
 static void convert_dyn_uop(uns8 proc_id, Inst_Info* info, ctype_pin_inst* pi, Trace_Uop* trace_uop, uns mem_size,
                             Flag is_last_uop);
+static void wrong_path_uop_cache_fill(uns proc_id, ctype_pin_inst* inst, Trace_Uop** trace_uop);
 
 /**************************************************************************************/
 
@@ -218,6 +280,35 @@ void uop_generator_init(uint32_t num_cores) {
   memset(num_sending_uop, 0, num_cores * sizeof(uns));
 
   last_ga_va = (Addr*)malloc(num_cores * sizeof(Addr));
+
+  uop_decode_cache = NULL;
+  if (UOP_DECODE_CACHE_ENTRIES) {
+    uns entries = 1;
+    while (entries < UOP_DECODE_CACHE_ENTRIES)
+      entries <<= 1;
+    uop_decode_cache_mask = entries - 1;
+    uop_decode_cache = (Uop_Decode_Cache_Entry**)malloc(num_cores * sizeof(Uop_Decode_Cache_Entry*));
+    for (uns ii = 0; ii < num_cores; ii++) {
+      uop_decode_cache[ii] = (Uop_Decode_Cache_Entry*)calloc(entries, sizeof(Uop_Decode_Cache_Entry));
+    }
+  }
+
+  fast_string_state = (Fast_String_State*)calloc(num_cores, sizeof(Fast_String_State));
+
+  wp_num_cores = num_cores;
+  wp_staged = (Flag*)calloc(num_cores, sizeof(Flag));
+  wp_fill_addr = (Addr*)calloc(num_cores, sizeof(Addr));
+  wrong_path_uop_cache = NULL;
+  if (WRONG_PATH_UOP_CACHE_ENTRIES) {
+    uns entries = 1;
+    while (entries < WRONG_PATH_UOP_CACHE_ENTRIES)
+      entries <<= 1;
+    wrong_path_uop_cache_mask = entries - 1;
+    wrong_path_uop_cache = (Wrong_Path_Uop_Cache_Entry**)malloc(num_cores * sizeof(Wrong_Path_Uop_Cache_Entry*));
+    for (uns ii = 0; ii < num_cores; ii++) {
+      wrong_path_uop_cache[ii] = (Wrong_Path_Uop_Cache_Entry*)calloc(entries, sizeof(Wrong_Path_Uop_Cache_Entry));
+    }
+  }
 }
 
 Flag uop_generator_extract_op(uns proc_id, Op* op, compressed_op* cop) {
@@ -285,9 +376,23 @@ void uop_generator_get_uop(uns proc_id, Op* op, ctype_pin_inst* inst) {
   // cmp: find the correct core
   trace_uop_array = trace_uop_bulk[proc_id];
 
-  if (bom[proc_id]) {
+  if (bom[proc_id] && wp_staged[proc_id]) {
+    // uops already streamed in from the wrong-path uop cache
+    wp_staged[proc_id] = FALSE;
+    op->bom = TRUE;
+    trace_uop = trace_uop_array[0];
+    info = trace_uop->info;
+    num_uops[proc_id] = info->trace_info.num_uop;
+
+    num_sending_uop[proc_id] = 1;
+    eom[proc_id] = trace_uop->eom;
+  } else if (bom[proc_id]) {
     ASSERT(proc_id, inst != NULL);
     convert_pinuop_to_t_uop(proc_id, inst, trace_uop_array);
+    if (wp_fill_addr[proc_id]) {
+      wrong_path_uop_cache_fill(proc_id, inst, trace_uop_array);
+      wp_fill_addr[proc_id] = 0;
+    }
 
     op->bom = TRUE;
     trace_uop = trace_uop_array[0];
@@ -374,6 +479,7 @@ void uop_generator_get_uop(uns proc_id, Op* op, ctype_pin_inst* inst) {
   op->engine_info.l1_miss_satisfied = FALSE;
   op->engine_info.dep_on_l1_miss = FALSE;
   op->engine_info.was_dep_on_l1_miss = FALSE;
+  op->engine_info.l1_miss_dep_srcs = 0;
 
   /* multi path support */
 
@@ -436,6 +542,85 @@ void uop_generator_get_uop(uns proc_id, Op* op, ctype_pin_inst* inst) {
   }
 }
 
+static inline Wrong_Path_Uop_Cache_Entry* wrong_path_uop_cache_entry(uns proc_id, Addr addr) {
+  return &wrong_path_uop_cache[proc_id][((addr * 0x9E3779B97F4A7C15ULL) >> 32) & wrong_path_uop_cache_mask];
+}
+
+static void wrong_path_uop_cache_fill(uns proc_id, ctype_pin_inst* inst, Trace_Uop** trace_uop) {
+  uns num_uop = trace_uop[0]->info->trace_info.num_uop;
+  if (inst->fake_inst || inst->is_gather_scatter || num_uop > WRONG_PATH_UOP_CACHE_MAX_UOPS)
+    return;
+
+  Wrong_Path_Uop_Cache_Entry* entry = wrong_path_uop_cache_entry(proc_id, wp_fill_addr[proc_id]);
+  entry->addr = wp_fill_addr[proc_id];
+  entry->inst_size = inst->size;
+  entry->fetched_instruction = inst->fetched_instruction;
+  entry->num_uop = num_uop;
+  for (uns ii = 0; ii < num_uop; ii++) {
+    Trace_Uop* t_uop = trace_uop[ii];
+    Wrong_Path_Uop* wp_uop = &entry->uops[ii];
+    wp_uop->info = t_uop->info;
+    wp_uop->inst_uid = t_uop->inst_uid;
+    wp_uop->actual_taken = t_uop->actual_taken;
+    wp_uop->va = t_uop->va;
+    wp_uop->mem_size = t_uop->mem_size;
+    wp_uop->target = t_uop->target;
+    wp_uop->npc = t_uop->npc;
+    wp_uop->eom = t_uop->eom;
+    wp_uop->exit = t_uop->exit;
+  }
+}
+
+Flag uop_generator_wrong_path_load(uns proc_id, Addr addr, uns* inst_size) {
+  wp_staged[proc_id] = FALSE;
+  wp_fill_addr[proc_id] = 0;
+  // trace_uop_bulk still holds the rest of the current instruction when redirected mid-instruction
+  if (!wrong_path_uop_cache || !bom[proc_id])
+    return FALSE;
+
+  Wrong_Path_Uop_Cache_Entry* entry = wrong_path_uop_cache_entry(proc_id, addr);
+  if (!entry->num_uop || entry->addr != addr) {
+    STAT_EVENT(proc_id, WRONG_PATH_UOP_CACHE_MISS);
+    wp_fill_addr[proc_id] = addr;
+    return FALSE;
+  }
+
+  STAT_EVENT(proc_id, WRONG_PATH_UOP_CACHE_HIT);
+  Trace_Uop** trace_uop = trace_uop_bulk[proc_id];
+  for (uns ii = 0; ii < entry->num_uop; ii++) {
+    Trace_Uop* t_uop = trace_uop[ii];
+    Wrong_Path_Uop* wp_uop = &entry->uops[ii];
+    t_uop->info = wp_uop->info;
+    t_uop->inst_uid = wp_uop->inst_uid;
+    t_uop->actual_taken = wp_uop->actual_taken;
+    t_uop->va = wp_uop->va;
+    t_uop->mem_size = wp_uop->mem_size;
+    t_uop->target = wp_uop->target;
+    t_uop->npc = wp_uop->npc;
+    t_uop->eom = wp_uop->eom;
+    t_uop->exit = wp_uop->exit;
+  }
+  fetched_instruction[proc_id] = entry->fetched_instruction;
+  *inst_size = entry->inst_size;
+  wp_staged[proc_id] = TRUE;
+  return TRUE;
+}
+
+void uop_generator_wrong_path_cancel(uns proc_id) {
+  wp_staged[proc_id] = FALSE;
+  wp_fill_addr[proc_id] = 0;
+}
+
+void uop_generator_wrong_path_invalidate(Addr addr) {
+  if (!wrong_path_uop_cache)
+    return;
+  for (uns proc_id = 0; proc_id < wp_num_cores; proc_id++) {
+    Wrong_Path_Uop_Cache_Entry* entry = wrong_path_uop_cache_entry(proc_id, addr);
+    if (entry->addr == addr)
+      entry->num_uop = 0;
+  }
+}
+
 Flag uop_generator_get_bom(uns proc_id) {
   return bom[proc_id];
 }
@@ -538,6 +723,15 @@ static Flag is_stack_reg(Reg_Id reg) {
   return reg == REG_RSP || reg == REG_SS;
 }
 
+static void add_rep_branch_uop(Trace_Uop** trace_uop, uns* idx) {
+  Trace_Uop* uop = trace_uop[*idx];
+  clear_t_uop(uop);
+  uop->op_type = OP_CF;
+  uop->cf_type = CF_CBR;
+  add_t_uop_src_reg(uop, REG_ZPS);
+  *idx = *idx + 1;
+}
+
 static void add_rep_uops(ctype_pin_inst* pi, Trace_Uop** trace_uop, uns* idx) {
   Flag add_rsi_add = FALSE;
   Flag add_rdi_add = FALSE;
@@ -590,13 +784,7 @@ static void add_rep_uops(ctype_pin_inst* pi, Trace_Uop** trace_uop, uns* idx) {
     add_t_uop_src_reg(uop, REG_RCX);
     add_t_uop_dest_reg(uop, REG_RCX);
     *idx = *idx + 1;
-    // Control flow micro-op
-    uop = trace_uop[*idx];
-    clear_t_uop(uop);
-    uop->op_type = OP_CF;
-    uop->cf_type = CF_CBR;
-    add_t_uop_src_reg(uop, REG_ZPS);
-    *idx = *idx + 1;
+    add_rep_branch_uop(trace_uop, idx);
   }
 }
 
@@ -609,7 +797,7 @@ static Flag use_ld1_addr_regs(const uns8 proc_id, const compressed_op* pi, const
   }
 }
 
-static uns generate_uops(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace_uop) {
+static uns generate_inst_uops(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace_uop) {
   /* Generating microinstructions for the trace instruction. The
    * general sequence of every instruction other than REP insts is:
    *     load_1, load_2, operate, store, control                 */
@@ -765,6 +953,12 @@ static uns generate_uops(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace_uop
     }
   }
 
+  return idx;
+}
+
+static uns generate_uops(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace_uop) {
+  uns idx = generate_inst_uops(proc_id, pi, trace_uop);
+
   if (pi->is_string) {
     add_rep_uops(pi, trace_uop, &idx);
   }
@@ -782,14 +976,128 @@ static uns generate_uops(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace_uop
   return idx;
 }
 
+/* Uops of one iteration of a REP string instruction under FAST_STRINGS. The startup uop reads and writes the string
+   registers, so the line accesses of the whole instruction wait for it but not for each other. */
+static uns generate_fast_string_uops(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace_uop, uns variant) {
+  uns idx = 0;
+
+  if (variant & FAST_STRING_START) {
+    Trace_Uop* uop = trace_uop[idx];
+    idx += 1;
+    clear_t_uop(uop);
+    uop->op_type = OP_IADD;
+    uop->alu_uop = TRUE;
+    uop->fast_string_startup = TRUE;
+    Reg_Id regs[] = {REG_RSI, REG_RDI, REG_RCX};
+    for (uns ii = 0; ii < sizeof(regs) / sizeof(regs[0]); ii++) {
+      add_t_uop_src_reg(uop, regs[ii]);
+      add_t_uop_dest_reg(uop, regs[ii]);
+    }
+  }
+
+  if (variant & FAST_STRING_MEM) {
+    uns first = idx;
+    idx += generate_inst_uops(proc_id, pi, trace_uop + idx);
+    for (uns ii = first; ii < idx; ii++) {
+      if (trace_uop[ii]->mem_type)
+        trace_uop[ii]->mem_size = DCACHE_LINE_SIZE;
+    }
+  }
+
+  if (variant & FAST_STRING_END)
+    add_rep_uops(pi, trace_uop, &idx);
+  else
+    add_rep_branch_uop(trace_uop, &idx);
+
+  ASSERT(proc_id, idx <= FAST_STRING_MAX_UOPS);
+  return idx;
+}
+
+/* Picks the uop sequence of a REP string iteration under FAST_STRINGS and aligns its accesses to cache lines.
+   Iterations that stay within the lines already accessed by the instruction only get the loop branch. */
+static uns fast_string_variant(uns8 proc_id, ctype_pin_inst* pi) {
+  Fast_String_State* state = &fast_string_state[proc_id];
+  Addr line_mask = ~((Addr)DCACHE_LINE_SIZE - 1);
+  uns variant = 0;
+
+  if (state->pc != pi->instruction_addr) {
+    variant |= FAST_STRING_START | FAST_STRING_MEM;
+    STAT_EVENT(proc_id, FAST_STRING_STARTS);
+  }
+  for (uns ii = 0; ii < pi->num_ld; ii++) {
+    Addr line = pi->ld_vaddr[ii] & line_mask;
+    if (line != state->ld_line[ii])
+      variant |= FAST_STRING_MEM;
+    state->ld_line[ii] = line;
+    pi->ld_vaddr[ii] = line;
+  }
+  for (uns ii = 0; ii < pi->num_st; ii++) {
+    Addr line = pi->st_vaddr[ii] & line_mask;
+    if (line != state->st_line[ii])
+      variant |= FAST_STRING_MEM;
+    state->st_line[ii] = line;
+    pi->st_vaddr[ii] = line;
+  }
+
+  if (pi->instruction_next_addr == pi->instruction_addr) {
+    state->pc = pi->instruction_addr;
+  } else {
+    variant |= FAST_STRING_END;
+    state->pc = 0;
+  }
+
+  STAT_EVENT(proc_id, FAST_STRING_ITERATIONS);
+  if (variant & FAST_STRING_MEM)
+    STAT_EVENT(proc_id, FAST_STRING_LINE_ITERATIONS);
+  return variant;
+}
+
+static inline Uop_Decode_Cache_Entry* uop_decode_cache_entry(uns8 proc_id, Addr addr, uint64_t inst_binary_lsb) {
+  uint64_t hash = (addr ^ inst_binary_lsb) * 0x9E3779B97F4A7C15ULL;
+  return &uop_decode_cache[proc_id][(hash >> 32) & uop_decode_cache_mask];
+}
+
+/* returns the cached uops of an instruction decoded before, NULL on a miss */
+static inline Uop_Decode_Cache_Entry* uop_decode_cache_probe(uns8 proc_id, ctype_pin_inst* pi) {
+  if (!uop_decode_cache || pi->is_gather_scatter)
+    return NULL;
+
+  Uop_Decode_Cache_Entry* entry = uop_decode_cache_entry(proc_id, pi->instruction_addr, pi->inst_binary_lsb);
+  if (entry->num_uop && entry->addr == pi->instruction_addr && entry->inst_binary_lsb == pi->inst_binary_lsb &&
+      entry->inst_binary_msb == pi->inst_binary_msb)
+    return entry;
+  return NULL;
+}
+
+static inline void uop_decode_cache_fill(uns8 proc_id, ctype_pin_inst* pi, Addr addr, Trace_Uop** trace_uop,
+                                         uns num_uop) {
+  if (!uop_decode_cache || pi->is_gather_scatter || num_uop > UOP_DECODE_CACHE_MAX_UOPS)
+    return;
+
+  Uop_Decode_Cache_Entry* entry = uop_decode_cache_entry(proc_id, addr, pi->inst_binary_lsb);
+  entry->addr = addr;
+  entry->inst_binary_lsb = pi->inst_binary_lsb;
+  entry->inst_binary_msb = pi->inst_binary_msb;
+  entry->num_uop = num_uop;
+  for (uns ii = 0; ii < num_uop; ii++) {
+    entry->info[ii] = trace_uop[ii]->info;
+  }
+}
+
 void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace_uop) {
   Flag new_entry = FALSE;
   Inst_Info* info;
+  Uop_Decode_Cache_Entry* cached = NULL;
+  Addr inst_addr = pi->instruction_addr;  // hash key, before the conversion to a cmp address, the same for all cores
   // Due to JIT compilation, each branch must be decoded to verify which instruction the PC maps to.
   // To decrease unnecessary malloc/free, fetch inst_info from hashmap
   // instead of allocating. However first instruction must be decoded.
   static Inst_Info dummy_nop;
   static Flag generated_dummy_nop = FALSE;
+  // iterations of a fast string are looked up by the shape of their uop sequence
+  Flag fast_string = FAST_STRINGS && pi->is_string && pi->is_repeat && !pi->fake_inst;
+  uns fast_string_uops = fast_string ? fast_string_variant(proc_id, pi) : 0;
+  uns8 op_idx_base = fast_string ? FAST_STRING_OP_IDX(fast_string_uops) : 0;
   if (pi->fake_inst) {
     info = (Inst_Info*)calloc(1, sizeof(Inst_Info));
     if (generated_dummy_nop) {
@@ -799,8 +1107,12 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
     info->fake_inst = TRUE;
     info->fake_inst_reason = pi->fake_inst_reason;
   } else {
-    info = cpp_hash_table_access_create(proc_id, pi->instruction_addr, pi->inst_binary_lsb, pi->inst_binary_msb, 0,
-                                        &new_entry);
+    cached = fast_string ? NULL : uop_decode_cache_probe(proc_id, pi);
+    if (cached)
+      info = cached->info[0];
+    else
+      info = cpp_hash_table_access_create(proc_id, pi->instruction_addr, pi->inst_binary_lsb, pi->inst_binary_msb,
+                                          op_idx_base, &new_entry);
     info->fake_inst = FALSE;
     info->fake_inst_reason = WPNM_NOT_IN_WPNM;
   }
@@ -828,7 +1140,8 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
     generated_dummy_nop = TRUE;
 
   if (need_to_gen_uops) {
-    num_uop = generate_uops(proc_id, pi, trace_uop);
+    num_uop = fast_string ? generate_fast_string_uops(proc_id, pi, trace_uop, fast_string_uops)
+                          : generate_uops(proc_id, pi, trace_uop);
     ASSERT(proc_id, num_uop > 0);
 
     info->trace_info.num_uop = num_uop;
@@ -840,8 +1153,8 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
           info->fake_inst = TRUE;
           info->fake_inst_reason = pi->fake_inst_reason;
         } else {
-          info = cpp_hash_table_access_create(proc_id, pi->instruction_addr, pi->inst_binary_lsb, pi->inst_binary_msb,
-                                              ii, &new_entry);
+          info = cpp_hash_table_access_create(proc_id, inst_addr, pi->inst_binary_lsb, pi->inst_binary_msb,
+                                              op_idx_base + ii, &new_entry);
 
           info->fake_inst = FALSE;
           info->fake_inst_reason = WPNM_NOT_IN_WPNM;
@@ -863,9 +1176,12 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
 
       convert_t_uop_to_info(proc_id, trace_uop[ii], info);
       trace_uop[ii]->info = info;
+      if (trace_uop[ii]->fast_string_startup)
+        info->latency = MAX2(FAST_STRINGS_STARTUP_LATENCY, 1);
 
       info->table_info->true_op_type = pi->true_op_type;
       trace_uop[ii]->info->table_info->is_simd = pi->is_simd;
+      trace_uop[ii]->info->table_info->fu_type = get_fu_type(trace_uop[ii]->op_type, pi->is_simd);
       trace_uop[ii]->info->uop_seq_num = ii;
       strcpy(trace_uop[ii]->info->table_info->name, pi->pin_iclass);
       if (trace_uop[ii]->alu_uop) {
@@ -874,6 +1190,17 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
       }
       trace_uop[ii]->info->trace_info.is_gather_scatter = pi->is_gather_scatter;
 
+      /* the static info of a uop only depends on its instruction, so the cores share one copy of it. Gathers and
+         scatters are regenerated every time and keep their own */
+      if (!pi->fake_inst && !pi->is_gather_scatter) {
+        Table_Info* shared = cpp_table_info_intern(inst_addr, pi->inst_binary_lsb, pi->inst_binary_msb,
+                                                   op_idx_base + ii, info->table_info);
+        if (shared != info->table_info) {
+          free(info->table_info);
+          info->table_info = shared;
+        }
+      }
+
       ASSERT(proc_id, info->trace_info.inst_size == pi->size);
 
       Flag is_last_uop = (ii == (num_uop - 1));
@@ -891,8 +1218,11 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
 
     for (ii = 0; ii < num_uop; ii++) {
       if (ii > 0) {
-        info = cpp_hash_table_access_create(proc_id, pi->instruction_addr, pi->inst_binary_lsb, pi->inst_binary_msb, ii,
-                                            &new_entry);
+        if (cached)
+          info = cached->info[ii];
+        else
+          info = cpp_hash_table_access_create(proc_id, inst_addr, pi->inst_binary_lsb, pi->inst_binary_msb,
+                                              op_idx_base + ii, &new_entry);
       }
       ASSERT(proc_id, !new_entry);
 
@@ -907,6 +1237,8 @@ void convert_pinuop_to_t_uop(uns8 proc_id, ctype_pin_inst* pi, Trace_Uop** trace
   }
 
   ASSERT(proc_id, num_uop > 0);
+  if (!pi->fake_inst && !cached && !fast_string)
+    uop_decode_cache_fill(proc_id, pi, inst_addr, trace_uop, num_uop);
   trace_uop[num_uop - 1]->eom = TRUE;
 
   trace_uop[num_uop - 1]->npc = pi->instruction_next_addr;
@@ -952,4 +1284,5 @@ void convert_dyn_uop(uns8 proc_id, Inst_Info* info, ctype_pin_inst* pi, Trace_Uo
 
 void uop_generator_recover(uns8 proc_id) {
   bom[proc_id] = 1;
+  fast_string_state[proc_id].pc = 0;
 }
@@ -48,6 +48,13 @@ Flag uop_generator_get_bom(uns proc_id);  // Called before uop_generator_get_uop
 Flag uop_generator_get_eom(uns proc_id);  // Called after uop_generator_get_uop.
 void uop_generator_recover(uns8 proc_id);
 
+/* Wrong-path uop cache: at an instruction boundary, stream the uops generated for the wrong-path instruction at
+   addr the last time it was fetched. On a hit the next uop_generator_get_uop() skips conversion and inst_size is
+   set; on a miss the next converted instruction fills the entry. */
+Flag uop_generator_wrong_path_load(uns proc_id, Addr addr, uns* inst_size);
+void uop_generator_wrong_path_cancel(uns proc_id);    // drop a staged load or pending fill on recovery
+void uop_generator_wrong_path_invalidate(Addr addr);  // the instruction recorded at addr changed
+
 #ifdef __cplusplus
 }
 #endif
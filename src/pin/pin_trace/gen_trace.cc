@@ -77,6 +77,7 @@ using namespace CONTROLLER;
 
 #include "../../ctype_pin_inst.h"
 #include "../../table_info.h"
+#include "../pin_lib/pin_trace_compact.h"
 
 std::vector<std::string> iclass_prints;
 
@@ -95,6 +96,13 @@ KNOB<BOOL> KnobPinPlayReplayer(KNOB_MODE_WRITEONCE, "pintool", "replay", "0",
 // Knobs that control trace generation
 KNOB<string> Knob_output(KNOB_MODE_WRITEONCE, "pintool", "o", "trace.bz2",
                          "trace outputfilename");
+KNOB<BOOL> KnobCompact(
+  KNOB_MODE_WRITEONCE, "pintool", "compact", "0",
+  "Write a dictionary of static instructions and short dynamic records in "
+  "zstd frames instead of bzip2-compressed ctype_pin_insts");
+KNOB<UINT64> KnobFrameInsts(
+  KNOB_MODE_WRITEONCE, "pintool", "frame_insts", "10000000",
+  "Instructions per zstd frame of a compact trace (frames decode in parallel)");
 
 // Trace start and end options
 KNOB<UINT64> KnobStartRip(
@@ -113,6 +121,9 @@ FILE* output_stream;
 ctype_pin_inst mailbox;
 bool           mailbox_full = false;
 
+Pin_Trace_Compact_Writer compact_writer;
+uint64_t                 frame_insts_left = 0;
+
 bool    need_to_change_rip        = false;
 bool    skip_dumping_instructions = false;
 int64_t fast_forward_insts_left   = 0;
@@ -133,13 +144,42 @@ void change_rip(CONTEXT* ctx) {
   PIN_ExecuteAt(ctx);
 }
 
+// A compact trace is a sequence of zstd frames, each compressed by its own zstd
+// process appending to the output file
+void open_output_stream(bool append) {
+  char popename[1024];
+  if(KnobCompact.Value())
+    sprintf(popename, "zstd -q -c %s %s", append ? ">>" : ">",
+            Knob_output.Value().c_str());
+  else
+    sprintf(popename, "bzip2 > %s", Knob_output.Value().c_str());
+  output_stream = popen(popename, "w");
+}
+
+void write_instruction(const ctype_pin_inst& inst) {
+  if(!KnobCompact.Value()) {
+    fwrite(&inst, sizeof(inst), 1, output_stream);
+    return;
+  }
+  if(frame_insts_left == 0) {
+    pclose(output_stream);
+    open_output_stream(true);
+    frame_insts_left = KnobFrameInsts.Value();
+  }
+  compact_writer.write(output_stream, inst);
+  frame_insts_left--;
+}
+
 LOCALFUN VOID Fini(int n, void* v) {
   pin_decoder_print_unknown_opcodes();
   if(output_stream) {
     if(mailbox_full) {
-      fwrite(&mailbox, sizeof(mailbox), 1, output_stream);
+      write_instruction(mailbox);
     }
     pclose(output_stream);
+    if(KnobCompact.Value())
+      std::cout << "Compact trace: " << compact_writer.num_entries()
+                << " static instructions\n";
   }
 }
 
@@ -178,7 +218,7 @@ void dump_instruction() {
   ctype_pin_inst* info = pin_decoder_get_latest_inst();
   if(mailbox_full) {
     mailbox.instruction_next_addr = info->instruction_addr;
-    fwrite(&mailbox, sizeof(mailbox), 1, output_stream);
+    write_instruction(mailbox);
   }
   mailbox      = *info;
   mailbox_full = true;
@@ -222,9 +262,11 @@ int main(int argc, char* argv[]) {
   pinplay_engine.Activate(argc, argv, KnobPinPlayLogger, KnobPinPlayReplayer);
 
   if(!Knob_output.Value().empty()) {
-    char popename[1024];
-    sprintf(popename, "bzip2 > %s", Knob_output.Value().c_str());
-    output_stream = popen(popename, "w");
+    open_output_stream(false);
+    if(KnobCompact.Value()) {
+      Pin_Trace_Compact_Writer::write_header(output_stream);
+      frame_insts_left = KnobFrameInsts.Value();
+    }
   } else {
     cout << "No trace specified. Only verifying opcodes." << endl;
   }
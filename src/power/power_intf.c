@@ -28,7 +28,10 @@
 
 #include "power_intf.h"
 
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "globals/assert.h"
 #include "globals/global_defs.h"
@@ -64,6 +67,14 @@ typedef struct Value_struct {
 // static void dump_power_stats(void);
 static void run_power_model_exec(void);
 static void parse_power_model_results(void);
+static void derive_power_values(void);
+static void measure_activity(double* mix, double* activity);
+static Flag power_cache_lookup(void);
+static void power_cache_fill(void);
+static void power_linear_calibrate(void);
+static Flag power_linear_load(const char* filename);
+static void power_linear_save(const char* filename);
+static void power_linear_eval(void);
 static void update_energy_stats(void);
 static void scale_values(Power_Domain domain);
 static Freq_Domain_Id freq_domain(Power_Domain);
@@ -77,6 +88,37 @@ static const char* model_results_filename = "power_model_results";
 static Value values[POWER_DOMAIN_NUM_ELEMS][POWER_RESULT_NUM_ELEMS];
 static double elapsed_time;  // time elapsed in this interval, seconds
 
+/* POWER_INTF_CACHE: the last power model run and the activity it was run with */
+static struct {
+  Flag valid;
+  double intf_values[POWER_DOMAIN_NUM_ELEMS][POWER_RESULT_NUM_ELEMS];
+  Flag set[POWER_DOMAIN_NUM_ELEMS][POWER_RESULT_NUM_ELEMS];
+  double activity[POWER_DOMAIN_NUM_ELEMS];  // sum of the domain's POWER_* counts
+  double cycles;                            // POWER_CYCLE, which McPAT divides the energy by
+  double* mix;                              // [proc][stat] counts normalized to sum to 1
+} power_cache;
+static double* cur_mix;
+static double cur_activity[POWER_DOMAIN_NUM_ELEMS];
+
+#define POWER_ACTIVITY_FIRST POWER_CYCLE
+#define POWER_ACTIVITY_NUM (POWER_STATS_END - POWER_ACTIVITY_FIRST)
+
+/* calibration probes: POWER_CYCLE cycles with one count at POWER_LINEAR_CAL_COUNT per core */
+#define POWER_LINEAR_CAL_CYCLES 1000000
+#define POWER_LINEAR_CAL_COUNT 100000
+
+/* POWER_INTF_LINEAR: the power model results with no activity but the cycles, and the
+   energy per count (in W * cycles) of each domain; a core domain is charged for the counts
+   of its own core and the others for the counts of all cores */
+static struct {
+  Flag valid;
+  double base[POWER_DOMAIN_NUM_ELEMS][POWER_RESULT_NUM_ELEMS];
+  Flag set[POWER_DOMAIN_NUM_ELEMS][POWER_RESULT_NUM_ELEMS];
+  double coeff[POWER_DOMAIN_NUM_ELEMS][POWER_ACTIVITY_NUM];
+} power_linear;
+
+#define IS_CORE_DOMAIN(domain) ((domain) >= POWER_DOMAIN_CORE_0 && (domain) <= POWER_DOMAIN_CORE_7)
+
 /**************************************************************************************/
 /* power_intf_init: */
 
@@ -85,10 +127,16 @@ void power_intf_init(void) {
     return;
 
   ASSERTM(0, NUM_CORES <= 8, "power_intf supports up to 8 cores\n");
+  ASSERTM(0, stat_is_on(POWER_CYCLE), "The power model needs the stat group %s\n", stat_group_name(POWER_CYCLE));
 
   for (uns stat = POWER_STATS_BEGIN; stat <= POWER_STATS_END; ++stat) {
     ASSERT(0, GET_TOTAL_STAT_EVENT(0, stat) == 0);
   }
+
+  if (POWER_INTF_CACHE) {
+    power_cache.mix = (double*)calloc(NUM_CORES * POWER_ACTIVITY_NUM, sizeof(double));
+    cur_mix = (double*)calloc(NUM_CORES * POWER_ACTIVITY_NUM, sizeof(double));
+  }
 }
 
 /**************************************************************************************/
@@ -98,8 +146,18 @@ void power_intf_calc(void) {
   double fempto_elapsed_time = (double)GET_TOTAL_STAT_EVENT(0, POWER_TIME);
   elapsed_time = fempto_elapsed_time * 1.0e-15;
 
-  run_power_model_exec();
-  parse_power_model_results();
+  if (POWER_INTF_LINEAR) {
+    power_linear_eval();
+  } else if (POWER_INTF_CACHE && power_cache_lookup()) {
+    STAT_EVENT(0, POWER_INTF_CACHE_HITS);
+  } else {
+    run_power_model_exec();
+    parse_power_model_results();
+    if (POWER_INTF_CACHE)
+      power_cache_fill();
+    STAT_EVENT(0, POWER_INTF_MODEL_RUNS);
+  }
+  derive_power_values();
   update_energy_stats();
 }
 
@@ -181,7 +239,13 @@ void parse_power_model_results(void) {
    * dynamic power. */
   values[POWER_DOMAIN_MEMORY][POWER_RESULT_STATIC].intf_value *= ramulator_get_num_chips();
   DEBUG(0, "Number of DRAM chips: %d\n", ramulator_get_num_chips());
+}
 
+/**************************************************************************************/
+/* derive_power_values: fill in the other system power, the scaled values and the totals
+   from the values of the power model */
+
+void derive_power_values(void) {
   /* Set other system power */
   values[POWER_DOMAIN_OTHER][POWER_RESULT_STATIC].intf_value = POWER_OTHER;
   values[POWER_DOMAIN_OTHER][POWER_RESULT_STATIC].set = TRUE;
@@ -214,6 +278,269 @@ void parse_power_model_results(void) {
   }
 }
 
+/**************************************************************************************/
+/* measure_activity: the POWER_* counts of this interval, as a normalized mix and summed
+   by the domain that consumes their energy */
+
+void measure_activity(double* mix, double* activity) {
+  double total = 0;
+  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain)
+    activity[domain] = 0;
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    for (uns i = 0; i < POWER_ACTIVITY_NUM; i++) {
+      uns stat = POWER_ACTIVITY_FIRST + i;
+      double count = (double)GET_TOTAL_STAT_EVENT(proc_id, stat);
+      Power_Domain domain;
+      switch (stat) {
+        case POWER_DRAM_PRECHARGE:
+        case POWER_DRAM_ACTIVATE:
+        case POWER_DRAM_READ:
+        case POWER_DRAM_WRITE:
+          domain = POWER_DOMAIN_MEMORY;
+          break;
+        case POWER_LLC_READ_ACCESS:
+        case POWER_LLC_WRITE_ACCESS:
+        case POWER_LLC_READ_MISS:
+        case POWER_LLC_WRITE_MISS:
+        case POWER_L1DIREC_READ_ACCESS:
+        case POWER_L1DIREC_WRITE_ACCESS:
+        case POWER_L1DIREC_READ_MISS:
+        case POWER_L1DIREC_WRITE_MISS:
+        case POWER_L2DIREC_READ_ACCESS:
+        case POWER_L2DIREC_WRITE_ACCESS:
+        case POWER_L2DIREC_READ_MISS:
+        case POWER_L2DIREC_WRITE_MISS:
+        case POWER_MEMORY_ACCESS:
+        case POWER_MEMORY_READ_ACCESS:
+        case POWER_MEMORY_WRITE_ACCESS:
+        case POWER_MEMORY_CTRL_ACCESS:
+        case POWER_MEMORY_CTRL_READ:
+        case POWER_MEMORY_CTRL_WRITE:
+          domain = POWER_DOMAIN_UNCORE;
+          break;
+        default:
+          domain = POWER_DOMAIN_CORE_0 + proc_id;
+          break;
+      }
+      activity[domain] += count;
+      mix[proc_id * POWER_ACTIVITY_NUM + i] = count;
+      total += count;
+    }
+  }
+
+  for (uns i = 0; i < NUM_CORES * POWER_ACTIVITY_NUM; i++)
+    mix[i] = total > 0 ? mix[i] / total : 0;
+}
+
+/**************************************************************************************/
+/* power_cache_lookup: if the activity mix of this interval is close enough to the cached
+   run, fill in the values from it with the dynamic power scaled by the activity */
+
+Flag power_cache_lookup(void) {
+  measure_activity(cur_mix, cur_activity);
+  if (!power_cache.valid)
+    return FALSE;
+
+  double distance = 0;
+  for (uns i = 0; i < NUM_CORES * POWER_ACTIVITY_NUM; i++)
+    distance += fabs(cur_mix[i] - power_cache.mix[i]);
+  if (distance > POWER_INTF_CACHE_TOLERANCE)
+    return FALSE;
+
+  double cycles = (double)GET_TOTAL_STAT_EVENT(0, POWER_CYCLE);
+  if (cycles == 0)
+    return FALSE;
+  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+    if (power_cache.activity[domain] == 0 && cur_activity[domain] > 0)
+      return FALSE;
+  }
+
+  DEBUG(0, "Power model cache hit (mix distance %g)\n", distance);
+  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+    double scale = power_cache.activity[domain] > 0 ?
+                       cur_activity[domain] / power_cache.activity[domain] * power_cache.cycles / cycles :
+                       0;
+    for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result) {
+      values[domain][result].set = power_cache.set[domain][result];
+      values[domain][result].intf_value = power_cache.intf_values[domain][result];
+    }
+    values[domain][POWER_RESULT_DYNAMIC].intf_value *= scale;
+  }
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* power_cache_fill: remember the power model run of this interval */
+
+void power_cache_fill(void) {
+  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+    power_cache.activity[domain] = cur_activity[domain];
+    for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result) {
+      power_cache.set[domain][result] = values[domain][result].set;
+      power_cache.intf_values[domain][result] = values[domain][result].intf_value;
+    }
+  }
+  memcpy(power_cache.mix, cur_mix, NUM_CORES * POWER_ACTIVITY_NUM * sizeof(double));
+  power_cache.cycles = (double)GET_TOTAL_STAT_EVENT(0, POWER_CYCLE);
+  power_cache.valid = TRUE;
+}
+
+/**************************************************************************************/
+/* power_linear_calibrate: run the power model on synthetic intervals, first with only
+   the cycles and then with each count in turn, and fit the energy per count from the
+   difference in dynamic power. The counts of the current interval are restored after. */
+
+void power_linear_calibrate(void) {
+  uns num_stats = POWER_STATS_END - POWER_STATS_BEGIN + 1;
+  Stat* saved = (Stat*)malloc(NUM_CORES * num_stats * sizeof(Stat));
+  Stat_Value* saved_values = (Stat_Value*)malloc(NUM_CORES * num_stats * sizeof(Stat_Value));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    memcpy(&saved[proc_id * num_stats], &global_stat_array[proc_id][POWER_STATS_BEGIN], num_stats * sizeof(Stat));
+    memcpy(&saved_values[proc_id * num_stats], &global_stat_values[proc_id][POWER_STATS_BEGIN],
+           num_stats * sizeof(Stat_Value));
+  }
+
+  for (uns probe = 0; probe < POWER_ACTIVITY_NUM; probe++) {
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      for (uns stat = POWER_STATS_BEGIN; stat <= POWER_STATS_END; stat++) {
+        global_stat_values[proc_id][stat].count = 0;
+        global_stat_array[proc_id][stat].total_count = 0;
+      }
+      global_stat_array[proc_id][POWER_CYCLE].total_count = POWER_LINEAR_CAL_CYCLES;
+      if (probe > 0)
+        global_stat_array[proc_id][POWER_ACTIVITY_FIRST + probe].total_count = POWER_LINEAR_CAL_COUNT;
+    }
+
+    run_power_model_exec();
+    parse_power_model_results();
+    STAT_EVENT(0, POWER_INTF_MODEL_RUNS);
+
+    for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+      if (probe == 0) {
+        for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result) {
+          power_linear.base[domain][result] = values[domain][result].intf_value;
+          power_linear.set[domain][result] = values[domain][result].set;
+        }
+        continue;
+      }
+      double delta = values[domain][POWER_RESULT_DYNAMIC].intf_value - power_linear.base[domain][POWER_RESULT_DYNAMIC];
+      double counts = (double)POWER_LINEAR_CAL_COUNT * (IS_CORE_DOMAIN(domain) ? 1 : NUM_CORES);
+      power_linear.coeff[domain][probe] = delta * POWER_LINEAR_CAL_CYCLES / counts;
+    }
+  }
+
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    memcpy(&global_stat_array[proc_id][POWER_STATS_BEGIN], &saved[proc_id * num_stats], num_stats * sizeof(Stat));
+    memcpy(&global_stat_values[proc_id][POWER_STATS_BEGIN], &saved_values[proc_id * num_stats],
+           num_stats * sizeof(Stat_Value));
+  }
+  free(saved);
+  free(saved_values);
+  power_linear.valid = TRUE;
+}
+
+/**************************************************************************************/
+/* power_linear_load: read coefficients written by power_linear_save, FALSE if there is
+   no such file */
+
+Flag power_linear_load(const char* filename) {
+  FILE* file = fopen(filename, "r");
+  if (!file)
+    return FALSE;
+
+  char line[MAX_STR_LENGTH + 1];
+  char kind[MAX_STR_LENGTH + 1];
+  char domain_str[MAX_STR_LENGTH + 1];
+  char name[MAX_STR_LENGTH + 1];
+  uns set;
+  double value;
+  uns num_read = 0;
+
+  while (fgets(line, MAX_STR_LENGTH, file)) {
+    uns num_matches = sscanf(line, "%s\t%s\t%s\t%u\t%le", kind, domain_str, name, &set, &value);
+    ASSERTM(0, num_matches == 5, "Malformed line in %s: %s\n", filename, line);
+    Power_Domain domain = Power_Domain_parse(domain_str);
+    if (strcmp(kind, "base") == 0) {
+      Power_Result result = Power_Result_parse(name);
+      power_linear.base[domain][result] = value;
+      power_linear.set[domain][result] = set;
+    } else {
+      uns i;
+      for (i = 1; i < POWER_ACTIVITY_NUM; i++) {
+        if (strcmp(global_stat_array[0][POWER_ACTIVITY_FIRST + i].name, name) == 0)
+          break;
+      }
+      ASSERTM(0, i < POWER_ACTIVITY_NUM, "Unknown power stat %s in %s\n", name, filename);
+      power_linear.coeff[domain][i] = value;
+    }
+    num_read++;
+  }
+  fclose(file);
+
+  ASSERTM(0, num_read == POWER_DOMAIN_NUM_ELEMS * (POWER_RESULT_NUM_ELEMS + POWER_ACTIVITY_NUM - 1),
+          "%s does not match this build of Scarab\n", filename);
+  power_linear.valid = TRUE;
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* power_linear_save: */
+
+void power_linear_save(const char* filename) {
+  FILE* file = fopen(filename, "w");
+  ASSERTM(0, file, "Could not open %s\n", filename);
+  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+    for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result)
+      fprintf(file, "base\t%s\t%s\t%u\t%.17le\n", Power_Domain_str(domain), Power_Result_str(result),
+              power_linear.set[domain][result], power_linear.base[domain][result]);
+    for (uns i = 1; i < POWER_ACTIVITY_NUM; i++)
+      fprintf(file, "coeff\t%s\t%s\t1\t%.17le\n", Power_Domain_str(domain),
+              global_stat_array[0][POWER_ACTIVITY_FIRST + i].name, power_linear.coeff[domain][i]);
+  }
+  fclose(file);
+}
+
+/**************************************************************************************/
+/* power_linear_eval: fill in the values of the power model from the linear model */
+
+void power_linear_eval(void) {
+  if (!power_linear.valid) {
+    const char* filename = POWER_INTF_LINEAR_COEFF_FILE;
+    if (!filename || !power_linear_load(filename)) {
+      power_linear_calibrate();
+      if (filename)
+        power_linear_save(filename);
+    }
+  }
+
+  double cycles = (double)GET_TOTAL_STAT_EVENT(0, POWER_CYCLE);
+  for (uns domain = 0; domain < POWER_DOMAIN_NUM_ELEMS; ++domain) {
+    for (uns result = 0; result < POWER_RESULT_NUM_ELEMS; ++result) {
+      values[domain][result].intf_value = power_linear.base[domain][result];
+      values[domain][result].set = power_linear.set[domain][result];
+    }
+    if (cycles == 0)
+      continue;
+
+    double energy = 0;
+    for (uns i = 1; i < POWER_ACTIVITY_NUM; i++) {
+      if (power_linear.coeff[domain][i] == 0)
+        continue;
+      double count = 0;
+      if (IS_CORE_DOMAIN(domain)) {
+        uns proc_id = domain - POWER_DOMAIN_CORE_0;
+        count = proc_id < NUM_CORES ? (double)GET_TOTAL_STAT_EVENT(proc_id, POWER_ACTIVITY_FIRST + i) : 0;
+      } else {
+        for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+          count += (double)GET_TOTAL_STAT_EVENT(proc_id, POWER_ACTIVITY_FIRST + i);
+      }
+      energy += power_linear.coeff[domain][i] * count;
+    }
+    values[domain][POWER_RESULT_DYNAMIC].intf_value += energy / cycles;
+  }
+}
+
 void update_energy_stats(void) {
   INC_STAT_VALUE(0, TIME, elapsed_time);
 
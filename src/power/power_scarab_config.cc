@@ -469,11 +469,11 @@ void power_print_core_params(std::ofstream& out, uint32_t core_id) {
   /***********************************************************************/
 
   ADD_XML_COMPONENT(out, header, "system.core" + std::to_string(core_id) + ".itlb", "itlb", );
-  ADD_XML_PARAM(out, header, "number_entries", 128,
-                "Scarab: models perfect tlb, this number is hard coded in the power file");
+  ADD_XML_PARAM(out, header, "number_entries", TLB_ON ? ITLB_4K_ENTRIES : 128,
+                "Scarab: 128 (hard coded) unless TLB_ON models the TLBs");
 
   ADD_XML_CORE_STAT(out, header, core_id, "total_accesses", POWER_ITLB_ACCESS, );
-  ADD_XML_STAT(out, header, "total_misses", 0, "Scarab: perfect TLB");
+  ADD_XML_CORE_STAT(out, header, core_id, "total_misses", POWER_ITLB_MISS, "Scarab: 0 (perfect TLB) unless TLB_ON");
   /* Note: conflicts parameter is not used in McPat anywhere, although some of
    * the predefined descriptor files have non-zero values. */
   ADD_XML_STAT(out, header, "conflicts", 0, );
@@ -517,9 +517,9 @@ void power_print_core_params(std::ofstream& out, uint32_t core_id) {
   /***********************************************************************/
 
   ADD_XML_COMPONENT(out, header, "system.core" + std::to_string(core_id) + ".dtlb", "dtlb", );
-  ADD_XML_PARAM(out, header, "number_entries", 128, "dual threads");
+  ADD_XML_PARAM(out, header, "number_entries", TLB_ON ? DTLB_4K_ENTRIES : 128, "dual threads");
   ADD_XML_CORE_STAT(out, header, core_id, "total_accesses", POWER_DTLB_ACCESS, );
-  ADD_XML_STAT(out, header, "total_misses", 0, "Scarab: perfect DTLB");
+  ADD_XML_CORE_STAT(out, header, core_id, "total_misses", POWER_DTLB_MISS, "Scarab: 0 (perfect DTLB) unless TLB_ON");
   /* Note: conflicts parameter is not used in McPat anywhere, although some of
    * the predefined descriptor files have non-zero values. */
   ADD_XML_STAT(out, header, "conflicts", 0, );
@@ -23,7 +23,9 @@ extern "C" {
 #include "prefetcher/pref.param.h"
 
 #include "memory/memory.h"
+#include "prefetcher/iprefetch.h"
 
+#include "core_context.h"
 #include "op.h"
 }
 
@@ -35,7 +37,7 @@ extern "C" {
 #include <utility>
 #include <vector>
 
-uint32_t djolt_proc_id;
+CORE_LOCAL uint32_t djolt_proc_id;
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_DJOLT, ##args)
 // ============================================================
 //  D-JOLT parameters.
@@ -513,7 +515,7 @@ class WindowBasedStreamPrefetcher {
       for (size_t j = 0; j < Degree; ++j) {
         const uint64_t pf_addr = (stream.start_line_address + Distance) << LOG2(ICACHE_LINE_SIZE);
 
-        new_mem_req(MRT_IPRF, djolt_proc_id, pf_addr, ICACHE_LINE_SIZE, 0, NULL, instr_fill_line, unique_count, 0);
+        iprefetch_issue(djolt_proc_id, IPREF_DJOLT, pf_addr);
         INC_STAT_EVENT(0, DJOLT_PREFETCH_ENTRY, 1);
         ++stream.start_line_address;
       }
@@ -527,7 +529,7 @@ class WindowBasedStreamPrefetcher {
     // i == 0 is not needed since it is the same line as the demand access.
     for (size_t i = 1; i < Distance; ++i) {
       const uint64_t pf_addr = (line_address + i) << LOG2(ICACHE_LINE_SIZE);
-      new_mem_req(MRT_IPRF, djolt_proc_id, pf_addr, ICACHE_LINE_SIZE, 0, NULL, instr_fill_line, unique_count, 0);
+      iprefetch_issue(djolt_proc_id, IPREF_DJOLT, pf_addr);
       INC_STAT_EVENT(0, DJOLT_PREFETCH_INITIAL, 1);
     }
   }
@@ -619,7 +621,7 @@ void D_JOLT_PREFETCHER::prefetch_with_sig(const Table& table, uint32_t sig) {
     for (const auto& v : table[sig].getValidEntries()) {
       for (const auto& address : v.getAddresses()) {
         const uint64_t pf_addr = upper_bit_table.decompress(address);
-        new_mem_req(MRT_IPRF, proc_id, pf_addr, ICACHE_LINE_SIZE, 0, NULL, instr_fill_line, unique_count, 0);
+        iprefetch_issue(proc_id, IPREF_DJOLT, pf_addr);
         INC_STAT_EVENT(0, DJOLT_PREFETCH_SIG, 1);
       }
     }
@@ -713,8 +715,8 @@ void init_djolt(uns proc_id) {
   per_core_d_jolt_prefetcher[proc_id] = new D_JOLT_PREFETCHER(proc_id);
 }
 
-void set_djolt(uns proc_id) {
-  djolt_proc_id = proc_id;
+void set_djolt(Core_Context* ctx) {
+  djolt_proc_id = ctx->proc_id;
 }
 
 void update_djolt(uns proc_id, Addr fetch_addr, uint8_t branch_type, uint64_t branch_target) {
@@ -11,7 +11,7 @@ extern "C" {
 void alloc_mem_djolt(uns numCores);
 void init_djolt(uns proc_id);
 void djolt_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefetch_hit);
-void set_djolt(uns proc_id);
+void set_djolt(Core_Context* ctx);
 void update_djolt(uns proc_id, Addr fetch_addr, uint8_t branch_type, uint64_t branch_target);
 void djolt_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefetch_hit);
 void djolt_cycle_operate(uns proc_id);
@@ -23,7 +23,9 @@ extern "C" {
 #include "prefetcher/pref.param.h"
 
 #include "memory/memory.h"
+#include "prefetcher/iprefetch.h"
 
+#include "core_context.h"
 #include "op.h"
 }
 
@@ -32,7 +34,7 @@ extern "C" {
 using std::cout;
 using std::endl;
 
-uint32_t fnlmma_proc_id;
+CORE_LOCAL uint32_t fnlmma_proc_id;
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_FNLMMA, ##args)
 
 #define AHEADPRED
@@ -232,9 +234,7 @@ class PredictMiss {
 
 PredictMiss AHEAD, AHEADphist;
 
-#define PrefCodeBlock(X)                                                                                         \
-  new_mem_req(MRT_IPRF, fnlmma_proc_id, X << LOG2(ICACHE_LINE_SIZE), ICACHE_LINE_SIZE, 0, NULL, instr_fill_line, \
-              unique_count, 0)
+#define PrefCodeBlock(X) iprefetch_issue(fnlmma_proc_id, IPREF_FNLMMA, (X) << LOG2(ICACHE_LINE_SIZE))
 // prefetch  works on  blocks
 
 /////////////////////////////////
@@ -246,8 +246,8 @@ void init_fnlmma(uns proc_id) {
   AHEADphist.init(DISTAHEAD);
 }
 
-void set_fnlmma(uns _proc_id) {
-  fnlmma_proc_id = _proc_id;
+void set_fnlmma(Core_Context* ctx) {
+  fnlmma_proc_id = ctx->proc_id;
 }
 
 void update_fnlmma() {
@@ -37,12 +37,16 @@
 
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/host_prof.h"
 
 #include "libs/hash_lib.h"
 #include "libs/list_lib.h"
+#include "libs/table_alloc.h"
 #include "prefetcher/fdip.h"
+#include "prefetcher/iprefetch.h"
 #include "prefetcher/pref_common.h"
 
+#include "core_context.h"
 #include "statistics.h"
 
 extern "C" {
@@ -70,16 +74,13 @@ using std::hex;
 extern int per_cyc_ipref;
 
 // To access cpu in my functions
-uint32_t eip_proc_id;
+CORE_LOCAL uint32_t eip_proc_id;
 uint32_t L1I_RQ_SIZE = 0;
 uint32_t L1I_TIMING_MSHR_SIZE = 0;
 uint32_t L1I_SET = 0;
+uint32_t L1I_SET_MASK = 0;
 uint32_t L1I_WAY = 0;
 
-uint64_t l1i_last_basic_block;
-uint32_t l1i_consecutive_count;
-uint32_t l1i_basic_block_merge_diff;
-
 bool debug = 0;
 
 #define L1I_HIST_TABLE_ENTRIES 16
@@ -111,6 +112,7 @@ uint64_t l1i_get_latency(uint64_t cycle, uint64_t cycle_prev) {
 // ENTANGLED COMPRESSION FORMAT
 
 #define L1I_ENTANGLED_MAX_FORMATS 7
+#define L1I_ENTANGLED_NUM_FORMATS 6
 
 // STATS
 #define L1I_STATS_TABLE_INDEX_BITS 16
@@ -125,8 +127,62 @@ typedef struct __l1i_stats_entry {
   uint64_t wrong;  // early
 } l1i_stats_entry;
 
-// l1i_stats_entry l1i_stats_table[NUM_CPUS][L1I_STATS_TABLE_ENTRIES];
-std::vector<l1i_stats_entry *> l1i_stats_table;
+// PER-CORE STATE
+
+#define L1I_MAX_ENTANGLED_PER_LINE L1I_ENTANGLED_NUM_FORMATS
+
+// timing mshr and timing cache entry flags
+#define L1I_TIMING_VALID 0x1
+#define L1I_TIMING_ACCESSED 0x2
+
+/*
+ * All tables of one core, stored as one array per field (carved out of a single allocation by l1i_alloc_core_state)
+ * so that a lookup only streams through the field it compares. Fields are sized to their hardware budget.
+ */
+typedef struct __l1i_core_state {
+  // history buffer
+  uint64_t hist_tag[L1I_HIST_TABLE_ENTRIES];        // L1I_HIST_TAG_BITS bits
+  uint32_t hist_time_diff[L1I_HIST_TABLE_ENTRIES];  // L1I_TIME_DIFF_BITS bits
+  uint8_t hist_bb_size[L1I_HIST_TABLE_ENTRIES];     // L1I_MERGE_BBSIZE_BITS bits
+  uint32_t hist_head;                               // log_2 (L1I_HIST_TABLE_ENTRIES)
+  uint64_t hist_head_time;                          // 64 bits
+
+  // We do not have access to the MSHR, so we aproximate it using this structure (L1I_TIMING_MSHR_SIZE entries)
+  uint64_t *mshr_tag;         // L1I_TIMING_MSHR_TAG_BITS bits
+  uint8_t *mshr_flags;        // L1I_TIMING_VALID, L1I_TIMING_ACCESSED
+  uint16_t *mshr_source_set;  // 8 bits
+  uint8_t *mshr_source_way;   // 6 bits
+  uint16_t *mshr_timestamp;   // L1I_TIME_BITS bits // time when issued
+  uint8_t *mshr_pos_hist;     // log_2 (L1I_HIST_TABLE_ENTRIES) + 1 bits
+
+  // We do not have access to the cache, so we aproximate it using this structure (L1I_SET x L1I_WAY entries)
+  uint64_t *tc_tag;         // L1I_TIMING_CACHE_TAG_BITS bits
+  uint8_t *tc_flags;        // L1I_TIMING_VALID, L1I_TIMING_ACCESSED
+  uint16_t *tc_source_set;  // 8 bits
+  uint8_t *tc_source_way;   // 6 bits
+
+  // entangled table (L1I_ENTANGLED_TABLE_SETS x L1I_ENTANGLED_TABLE_WAYS entries)
+  uint32_t *ent_tag;      // L1I_TAG_BITS bits
+  uint8_t *ent_format;    // log2(L1I_ENTANGLED_NUM_FORMATS) bits
+  uint8_t *ent_bb_size;   // L1I_MERGE_BBSIZE_BITS bits
+  uint16_t *ent_conf;     // L1I_MAX_ENTANGLED_PER_LINE x L1I_CONFIDENCE_COUNTER_BITS bits
+  uint64_t *ent_addr;     // L1I_MAX_ENTANGLED_PER_LINE per entry, JUST DIFF
+  uint8_t *ent_fifo;      // log2(L1I_ENTANGLED_TABLE_WAYS) bits per set
+
+  l1i_stats_entry *stats;  // L1I_STATS_TABLE_ENTRIES
+
+  uint64_t last_basic_block;
+  uint32_t consecutive_count;
+  uint32_t basic_block_merge_diff;
+
+  // host time spent in eip_prefetch and eip_cache_fill (--host_prof)
+  uint64_t prof_events;
+  uint64_t prof_ticks;
+
+  char *arena;
+} l1i_core_state;
+
+std::vector<l1i_core_state> l1i_state;
 uint64_t l1i_stats_discarded_prefetches;
 uint64_t l1i_stats_evict_entangled_j_table;
 uint64_t l1i_stats_evict_entangled_k_table;
@@ -139,11 +195,11 @@ uint64_t l1i_stats_basic_blocks_ent[L1I_MERGE_BBSIZE_MAX_VALUE + 1];
 
 void l1i_init_stats_table() {
   for (int i = 0; i < L1I_STATS_TABLE_ENTRIES; i++) {
-    l1i_stats_table[eip_proc_id][i].accesses = 0;
-    l1i_stats_table[eip_proc_id][i].misses = 0;
-    l1i_stats_table[eip_proc_id][i].hits = 0;
-    l1i_stats_table[eip_proc_id][i].late = 0;
-    l1i_stats_table[eip_proc_id][i].wrong = 0;
+    l1i_state[eip_proc_id].stats[i].accesses = 0;
+    l1i_state[eip_proc_id].stats[i].misses = 0;
+    l1i_state[eip_proc_id].stats[i].hits = 0;
+    l1i_state[eip_proc_id].stats[i].late = 0;
+    l1i_state[eip_proc_id].stats[i].wrong = 0;
   }
   l1i_stats_discarded_prefetches = 0;
   l1i_stats_evict_entangled_j_table = 0;
@@ -172,11 +228,11 @@ void l1i_print_stats_table() {
   uint64_t max_addr = 0;
   uint64_t total_accesses = 0;
   for (uint32_t i = 0; i < L1I_STATS_TABLE_ENTRIES; i++) {
-    if (l1i_stats_table[eip_proc_id][i].accesses > max) {
-      max = l1i_stats_table[eip_proc_id][i].accesses;
+    if (l1i_state[eip_proc_id].stats[i].accesses > max) {
+      max = l1i_state[eip_proc_id].stats[i].accesses;
       max_addr = i;
     }
-    total_accesses += l1i_stats_table[eip_proc_id][i].accesses;
+    total_accesses += l1i_state[eip_proc_id].stats[i].accesses;
   }
   cout << hex << max_addr << " " << (max_addr << LOG2(ICACHE_LINE_SIZE)) << dec << " " << max << " / " << total_accesses
        << endl;
@@ -185,11 +241,11 @@ void l1i_print_stats_table() {
   max_addr = 0;
   uint64_t total_misses = 0;
   for (uint32_t i = 0; i < L1I_STATS_TABLE_ENTRIES; i++) {
-    if (l1i_stats_table[eip_proc_id][i].misses > max) {
-      max = l1i_stats_table[eip_proc_id][i].misses;
+    if (l1i_state[eip_proc_id].stats[i].misses > max) {
+      max = l1i_state[eip_proc_id].stats[i].misses;
       max_addr = i;
     }
-    total_misses += l1i_stats_table[eip_proc_id][i].misses;
+    total_misses += l1i_state[eip_proc_id].stats[i].misses;
   }
   cout << hex << max_addr << " " << (max_addr << LOG2(ICACHE_LINE_SIZE)) << dec << " " << max << " / " << total_misses
        << endl;
@@ -198,11 +254,11 @@ void l1i_print_stats_table() {
   max_addr = 0;
   uint64_t total_hits = 0;
   for (uint32_t i = 0; i < L1I_STATS_TABLE_ENTRIES; i++) {
-    if (l1i_stats_table[eip_proc_id][i].hits > max) {
-      max = l1i_stats_table[eip_proc_id][i].hits;
+    if (l1i_state[eip_proc_id].stats[i].hits > max) {
+      max = l1i_state[eip_proc_id].stats[i].hits;
       max_addr = i;
     }
-    total_hits += l1i_stats_table[eip_proc_id][i].hits;
+    total_hits += l1i_state[eip_proc_id].stats[i].hits;
   }
   cout << hex << max_addr << " " << (max_addr << LOG2(ICACHE_LINE_SIZE)) << dec << " " << max << " / " << total_hits
        << endl;
@@ -211,11 +267,11 @@ void l1i_print_stats_table() {
   max_addr = 0;
   uint64_t total_late = 0;
   for (uint32_t i = 0; i < L1I_STATS_TABLE_ENTRIES; i++) {
-    if (l1i_stats_table[eip_proc_id][i].late > max) {
-      max = l1i_stats_table[eip_proc_id][i].late;
+    if (l1i_state[eip_proc_id].stats[i].late > max) {
+      max = l1i_state[eip_proc_id].stats[i].late;
       max_addr = i;
     }
-    total_late += l1i_stats_table[eip_proc_id][i].late;
+    total_late += l1i_state[eip_proc_id].stats[i].late;
   }
   cout << hex << max_addr << " " << (max_addr << LOG2(ICACHE_LINE_SIZE)) << dec << " " << max << " / " << total_late
        << endl;
@@ -224,11 +280,11 @@ void l1i_print_stats_table() {
   max_addr = 0;
   uint64_t total_wrong = 0;
   for (uint32_t i = 0; i < L1I_STATS_TABLE_ENTRIES; i++) {
-    if (l1i_stats_table[eip_proc_id][i].wrong > max) {
-      max = l1i_stats_table[eip_proc_id][i].wrong;
+    if (l1i_state[eip_proc_id].stats[i].wrong > max) {
+      max = l1i_state[eip_proc_id].stats[i].wrong;
       max_addr = i;
     }
-    total_wrong += l1i_stats_table[eip_proc_id][i].wrong;
+    total_wrong += l1i_state[eip_proc_id].stats[i].wrong;
   }
   cout << hex << max_addr << " " << (max_addr << LOG2(ICACHE_LINE_SIZE)) << dec << " " << max << " / " << total_wrong
        << endl;
@@ -305,34 +361,23 @@ void l1i_print_stats_table() {
 #define L1I_HIST_TAG_BITS 58
 #define L1I_HIST_TAG_MASK (((uint64_t)1 << L1I_HIST_TAG_BITS) - 1)
 
-typedef struct __l1i_hist_entry {
-  uint64_t tag;        // L1I_HIST_TAG_BITS bits
-  uint64_t time_diff;  // L1I_TIME_DIFF_BITS bits
-  uint32_t bb_size;    // L1I_MERGE_BBSIZE_BITS bits
-} l1i_hist_entry;
-
-// l1i_hist_entry l1i_hist_table[NUM_CPUS][L1I_HIST_TABLE_ENTRIES];
-std::vector<l1i_hist_entry *> l1i_hist_table;
-// uint64_t l1i_hist_table_head[NUM_CPUS]; // log_2 (L1I_HIST_TABLE_ENTRIES)
-std::vector<uint64_t> l1i_hist_table_head;  // log_2 (L1I_HIST_TABLE_ENTRIES)
-// uint64_t l1i_hist_table_head_time[NUM_CPUS]; // 64 bits
-std::vector<uint64_t> l1i_hist_table_head_time;  // 64 bits
-
 void l1i_init_hist_table() {
-  l1i_hist_table_head[eip_proc_id] = 0;
-  l1i_hist_table_head_time[eip_proc_id] = cycle_count;
+  l1i_core_state *s = &l1i_state[eip_proc_id];
+  s->hist_head = 0;
+  s->hist_head_time = cycle_count;
   for (uint32_t i = 0; i < L1I_HIST_TABLE_ENTRIES; i++) {
-    l1i_hist_table[eip_proc_id][i].tag = 0;
-    l1i_hist_table[eip_proc_id][i].time_diff = 0;
-    l1i_hist_table[eip_proc_id][i].bb_size = 0;
+    s->hist_tag[i] = 0;
+    s->hist_time_diff[i] = 0;
+    s->hist_bb_size[i] = 0;
   }
 }
 
 uint64_t l1i_find_hist_entry(uint64_t line_addr) {
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
   uint64_t tag = line_addr & L1I_HIST_TAG_MASK;
-  for (uint32_t count = 0, i = (l1i_hist_table_head[eip_proc_id] + L1I_HIST_TABLE_MASK) % L1I_HIST_TABLE_ENTRIES;
-       count < L1I_HIST_TABLE_ENTRIES; count++, i = (i + L1I_HIST_TABLE_MASK) % L1I_HIST_TABLE_ENTRIES) {
-    if (l1i_hist_table[eip_proc_id][i].tag == tag)
+  for (uint32_t count = 0, i = (s->hist_head + L1I_HIST_TABLE_MASK) & L1I_HIST_TABLE_MASK;
+       count < L1I_HIST_TABLE_ENTRIES; count++, i = (i + L1I_HIST_TABLE_MASK) & L1I_HIST_TABLE_MASK) {
+    if (s->hist_tag[i] == tag)
       return i;
   }
   return L1I_HIST_TABLE_ENTRIES;
@@ -340,42 +385,43 @@ uint64_t l1i_find_hist_entry(uint64_t line_addr) {
 
 // It can have duplicated entries if the line was evicted in between
 uint32_t l1i_add_hist_table(uint64_t line_addr) {
+  l1i_core_state *s = &l1i_state[eip_proc_id];
   // Insert empty addresses in hist not to have timediff overflows
-  while (cycle_count - l1i_hist_table_head_time[eip_proc_id] >= L1I_TIME_DIFF_OVERFLOW) {
-    l1i_hist_table[eip_proc_id][l1i_hist_table_head[eip_proc_id]].tag = 0;
-    l1i_hist_table[eip_proc_id][l1i_hist_table_head[eip_proc_id]].time_diff = L1I_TIME_DIFF_MASK;
-    l1i_hist_table[eip_proc_id][l1i_hist_table_head[eip_proc_id]].bb_size = 0;
-    l1i_hist_table_head[eip_proc_id] = (l1i_hist_table_head[eip_proc_id] + 1) % L1I_HIST_TABLE_ENTRIES;
-    l1i_hist_table_head_time[eip_proc_id] += L1I_TIME_DIFF_MASK;
+  while (cycle_count - s->hist_head_time >= L1I_TIME_DIFF_OVERFLOW) {
+    s->hist_tag[s->hist_head] = 0;
+    s->hist_time_diff[s->hist_head] = L1I_TIME_DIFF_MASK;
+    s->hist_bb_size[s->hist_head] = 0;
+    s->hist_head = (s->hist_head + 1) & L1I_HIST_TABLE_MASK;
+    s->hist_head_time += L1I_TIME_DIFF_MASK;
   }
 
   // Allocate a new entry (evict old one if necessary)
-  l1i_hist_table[eip_proc_id][l1i_hist_table_head[eip_proc_id]].tag = line_addr & L1I_HIST_TAG_MASK;
-  l1i_hist_table[eip_proc_id][l1i_hist_table_head[eip_proc_id]].time_diff =
-      (cycle_count - l1i_hist_table_head_time[eip_proc_id]) & L1I_TIME_DIFF_MASK;
-  l1i_hist_table[eip_proc_id][l1i_hist_table_head[eip_proc_id]].bb_size = 0;
-  uint32_t pos = l1i_hist_table_head[eip_proc_id];
-  l1i_hist_table_head[eip_proc_id] = (l1i_hist_table_head[eip_proc_id] + 1) % L1I_HIST_TABLE_ENTRIES;
-  l1i_hist_table_head_time[eip_proc_id] = cycle_count;
+  s->hist_tag[s->hist_head] = line_addr & L1I_HIST_TAG_MASK;
+  s->hist_time_diff[s->hist_head] = (cycle_count - s->hist_head_time) & L1I_TIME_DIFF_MASK;
+  s->hist_bb_size[s->hist_head] = 0;
+  uint32_t pos = s->hist_head;
+  s->hist_head = (s->hist_head + 1) & L1I_HIST_TABLE_MASK;
+  s->hist_head_time = cycle_count;
   return pos;
 }
 
 void l1i_add_bb_size_hist_table(uint64_t line_addr, uint32_t bb_size) {
   uint64_t index = l1i_find_hist_entry(line_addr);
-  l1i_hist_table[eip_proc_id][index].bb_size = bb_size & L1I_MERGE_BBSIZE_MAX_VALUE;
+  if (index < L1I_HIST_TABLE_ENTRIES)
+    l1i_state[eip_proc_id].hist_bb_size[index] = bb_size & L1I_MERGE_BBSIZE_MAX_VALUE;
 }
 
 uint32_t l1i_find_bb_merge_hist_table(uint64_t line_addr) {
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
   uint64_t tag = line_addr & L1I_HIST_TAG_MASK;
-  for (uint32_t count = 0, i = (l1i_hist_table_head[eip_proc_id] + L1I_HIST_TABLE_MASK) % L1I_HIST_TABLE_ENTRIES;
-       count < L1I_HIST_TABLE_ENTRIES; count++, i = (i + L1I_HIST_TABLE_MASK) % L1I_HIST_TABLE_ENTRIES) {
+  for (uint32_t count = 0, i = (s->hist_head + L1I_HIST_TABLE_MASK) & L1I_HIST_TABLE_MASK;
+       count < L1I_HIST_TABLE_ENTRIES; count++, i = (i + L1I_HIST_TABLE_MASK) & L1I_HIST_TABLE_MASK) {
     if (count >= L1I_BB_MERGE_ENTRIES) {
       return 0;
     }
-    if (tag > l1i_hist_table[eip_proc_id][i].tag &&
-        (tag - l1i_hist_table[eip_proc_id][i].tag) <= l1i_hist_table[eip_proc_id][i].bb_size) {
-      //&& (tag - l1i_hist_table[eip_proc_id][i].tag) == l1i_hist_table[eip_proc_id][i].bb_size) {
-      return tag - l1i_hist_table[eip_proc_id][i].tag;
+    if (tag > s->hist_tag[i] && (tag - s->hist_tag[i]) <= s->hist_bb_size[i]) {
+      //&& (tag - s->hist_tag[i]) == s->hist_bb_size[i]) {
+      return tag - s->hist_tag[i];
     }
   }
   ASSERT(eip_proc_id, false);
@@ -383,31 +429,32 @@ uint32_t l1i_find_bb_merge_hist_table(uint64_t line_addr) {
 
 // return src-entangled pair
 uint64_t l1i_get_src_entangled_hist_table(uint64_t line_addr, uint32_t pos_hist, uint64_t latency, uint32_t skip = 0) {
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
   ASSERT(eip_proc_id, pos_hist < L1I_HIST_TABLE_ENTRIES);
   uint64_t tag = line_addr & L1I_HIST_TAG_MASK;
   ASSERT(eip_proc_id, tag);
-  if (l1i_hist_table[eip_proc_id][pos_hist].tag != tag) {
+  if (s->hist_tag[pos_hist] != tag) {
     l1i_stats_hist_lookups[L1I_HIST_TABLE_ENTRIES]++;
     return 0;  // removed
   }
-  uint32_t next_pos = (pos_hist + L1I_HIST_TABLE_MASK) % L1I_HIST_TABLE_ENTRIES;
-  uint32_t first = (l1i_hist_table_head[eip_proc_id] + L1I_HIST_TABLE_MASK) % L1I_HIST_TABLE_ENTRIES;
-  uint64_t time_i = l1i_hist_table[eip_proc_id][pos_hist].time_diff;
+  uint32_t next_pos = (pos_hist + L1I_HIST_TABLE_MASK) & L1I_HIST_TABLE_MASK;
+  uint32_t first = (s->hist_head + L1I_HIST_TABLE_MASK) & L1I_HIST_TABLE_MASK;
+  uint64_t time_i = s->hist_time_diff[pos_hist];
   uint32_t num_skipped = 0;
-  for (uint32_t count = 0, i = next_pos; i != first; count++, i = (i + L1I_HIST_TABLE_MASK) % L1I_HIST_TABLE_ENTRIES) {
+  for (uint32_t count = 0, i = next_pos; i != first; count++, i = (i + L1I_HIST_TABLE_MASK) & L1I_HIST_TABLE_MASK) {
     // Against the time overflow
-    if (l1i_hist_table[eip_proc_id][i].tag == tag) {
+    if (s->hist_tag[i] == tag) {
       return 0;  // Second time it appeared (it was evicted in between) or many for the same set. No entangle
     }
-    if (l1i_hist_table[eip_proc_id][i].tag && time_i >= latency) {
+    if (s->hist_tag[i] && time_i >= latency) {
       if (skip == num_skipped) {
         l1i_stats_hist_lookups[count]++;
-        return l1i_hist_table[eip_proc_id][i].tag;
+        return s->hist_tag[i];
       } else {
         num_skipped++;
       }
     }
-    time_i += l1i_hist_table[eip_proc_id][i].time_diff;
+    time_i += s->hist_time_diff[i];
   }
   l1i_stats_hist_lookups[L1I_HIST_TABLE_ENTRIES + 1]++;
   return 0;
@@ -423,64 +470,41 @@ uint64_t l1i_get_src_entangled_hist_table(uint64_t line_addr, uint32_t pos_hist,
 #define L1I_TIMING_CACHE_TAG_BITS (L1I_TIMING_MSHR_TAG_BITS - L1I_SET_BITS)
 #define L1I_TIMING_CACHE_TAG_MASK (((uint64_t)1 << L1I_HIST_TAG_BITS) - 1)
 
-// We do not have access to the MSHR, so we aproximate it using this structure
-typedef struct __l1i_timing_mshr_entry {
-  bool valid;           // 1 bit
-  uint64_t tag;         // L1I_TIMING_MSHR_TAG_BITS bits
-  uint32_t source_set;  // 8 bits
-  uint32_t source_way;  // 6 bits
-  uint64_t timestamp;   // L1I_TIME_BITS bits // time when issued
-  bool accessed;        // 1 bit
-  uint32_t pos_hist;    // 1 bit
-} l1i_timing_mshr_entry;
-
-// We do not have access to the cache, so we aproximate it using this structure
-typedef struct __l1i_timing_cache_entry {
-  bool valid;           // 1 bit
-  uint64_t tag;         // L1I_TIMING_CACHE_TAG_BITS bits
-  uint32_t source_set;  // 8 bits
-  uint32_t source_way;  // 6 bits
-  bool accessed;        // 1 bit
-} l1i_timing_cache_entry;
-
-// l1i_timing_mshr_entry l1i_timing_mshr_table[NUM_CPUS][L1I_TIMING_MSHR_SIZE];
-std::vector<l1i_timing_mshr_entry *> l1i_timing_mshr_table;
-// l1i_timing_cache_entry l1i_timing_cache_table[NUM_CPUS][L1I_SET][L1I_WAY];
-std::vector<l1i_timing_cache_entry **> l1i_timing_cache_table;
-
 void l1i_init_timing_tables() {
+  l1i_core_state *s = &l1i_state[eip_proc_id];
   for (uint32_t i = 0; i < L1I_TIMING_MSHR_SIZE; i++) {
-    l1i_timing_mshr_table[eip_proc_id][i].valid = 0;
+    s->mshr_flags[i] = 0;
   }
-  for (uint32_t i = 0; i < L1I_SET; i++) {
-    for (uint32_t j = 0; j < L1I_WAY; j++) {
-      l1i_timing_cache_table[eip_proc_id][i][j].valid = 0;
-    }
+  for (uint32_t i = 0; i < L1I_SET * L1I_WAY; i++) {
+    s->tc_flags[i] = 0;
   }
 }
 
 uint64_t l1i_find_timing_mshr_entry(uint64_t line_addr) {
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint64_t tag = line_addr & L1I_TIMING_MSHR_TAG_MASK;
   for (uint32_t i = 0; i < L1I_TIMING_MSHR_SIZE; i++) {
-    if (l1i_timing_mshr_table[eip_proc_id][i].tag == (line_addr & L1I_TIMING_MSHR_TAG_MASK) &&
-        l1i_timing_mshr_table[eip_proc_id][i].valid)
+    if (s->mshr_tag[i] == tag && (s->mshr_flags[i] & L1I_TIMING_VALID))
       return i;
   }
   return L1I_TIMING_MSHR_SIZE;
 }
 
 uint64_t l1i_find_timing_cache_entry(uint64_t line_addr) {
-  uint64_t i = line_addr % L1I_SET;
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t base = (line_addr & L1I_SET_MASK) * L1I_WAY;
+  uint64_t tag = (line_addr >> L1I_SET_BITS) & L1I_TIMING_CACHE_TAG_MASK;
   for (uint32_t j = 0; j < L1I_WAY; j++) {
-    if (l1i_timing_cache_table[eip_proc_id][i][j].tag == ((line_addr >> L1I_SET_BITS) & L1I_TIMING_CACHE_TAG_MASK) &&
-        l1i_timing_cache_table[eip_proc_id][i][j].valid)
+    if (s->tc_tag[base + j] == tag && (s->tc_flags[base + j] & L1I_TIMING_VALID))
       return j;
   }
   return L1I_WAY;
 }
 
 uint32_t l1i_get_invalid_timing_mshr_entry() {
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
   for (uint32_t i = 0; i < L1I_TIMING_MSHR_SIZE; i++) {
-    if (!l1i_timing_mshr_table[eip_proc_id][i].valid)
+    if (!(s->mshr_flags[i] & L1I_TIMING_VALID))
       return i;
   }
   ASSERT(eip_proc_id, false);  // It must return a free entry
@@ -488,12 +512,15 @@ uint32_t l1i_get_invalid_timing_mshr_entry() {
 }
 
 uint32_t l1i_get_invalid_timing_cache_entry(uint64_t line_addr) {
-  uint32_t i = line_addr % L1I_SET;
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t i = line_addr & L1I_SET_MASK;
+  uint32_t base = i * L1I_WAY;
+  uint64_t tag = (line_addr >> L1I_SET_BITS) & L1I_TIMING_CACHE_TAG_MASK;
   DEBUG(eip_proc_id, "find a timing cache entry to invalidate for set %u\n", i);
   for (uint32_t j = 0; j < L1I_WAY; j++) {
-    if (l1i_timing_cache_table[eip_proc_id][i][j].tag == ((line_addr >> L1I_SET_BITS) & L1I_TIMING_CACHE_TAG_MASK))
+    if (s->tc_tag[base + j] == tag)
       return j;
-    if (!l1i_timing_cache_table[eip_proc_id][i][j].valid)
+    if (!(s->tc_flags[base + j] & L1I_TIMING_VALID))
       return j;
   }
   ASSERT(eip_proc_id, false);  // It must return a free entry
@@ -507,93 +534,91 @@ void l1i_add_timing_entry(uint64_t line_addr, uint32_t source_set, uint32_t sour
   if (l1i_find_timing_cache_entry(line_addr) < L1I_WAY)
     return;
 
+  l1i_core_state *s = &l1i_state[eip_proc_id];
   uint32_t i = l1i_get_invalid_timing_mshr_entry();
-  l1i_timing_mshr_table[eip_proc_id][i].valid = true;
-  l1i_timing_mshr_table[eip_proc_id][i].tag = line_addr & L1I_TIMING_MSHR_TAG_MASK;
-  l1i_timing_mshr_table[eip_proc_id][i].source_set = source_set;
-  l1i_timing_mshr_table[eip_proc_id][i].source_way = source_way;
-  l1i_timing_mshr_table[eip_proc_id][i].timestamp = cycle_count & L1I_TIME_MASK;
-  l1i_timing_mshr_table[eip_proc_id][i].accessed = false;
+  s->mshr_flags[i] = L1I_TIMING_VALID;  // not accessed
+  s->mshr_tag[i] = line_addr & L1I_TIMING_MSHR_TAG_MASK;
+  s->mshr_source_set[i] = source_set;
+  s->mshr_source_way[i] = source_way;
+  s->mshr_timestamp[i] = cycle_count & L1I_TIME_MASK;
 }
 
 void l1i_invalid_timing_mshr_entry(uint64_t line_addr) {
   uint32_t index = l1i_find_timing_mshr_entry(line_addr);
   ASSERT(eip_proc_id, index < L1I_TIMING_MSHR_SIZE);
-  l1i_timing_mshr_table[eip_proc_id][index].valid = false;
+  l1i_state[eip_proc_id].mshr_flags[index] &= ~L1I_TIMING_VALID;
 }
 
 void l1i_move_timing_entry(uint64_t line_addr) {
+  l1i_core_state *s = &l1i_state[eip_proc_id];
   uint32_t index_mshr = l1i_find_timing_mshr_entry(line_addr);
+  uint32_t set = line_addr & L1I_SET_MASK;
+  uint32_t index_cache = l1i_get_invalid_timing_cache_entry(line_addr);
+  uint32_t entry = set * L1I_WAY + index_cache;
+  s->tc_tag[entry] = (line_addr >> L1I_SET_BITS) & L1I_TIMING_CACHE_TAG_MASK;
   if (index_mshr == L1I_TIMING_MSHR_SIZE) {
-    uint32_t set = line_addr % L1I_SET;
-    uint32_t index_cache = l1i_get_invalid_timing_cache_entry(line_addr);
-    l1i_timing_cache_table[eip_proc_id][set][index_cache].valid = true;
-    l1i_timing_cache_table[eip_proc_id][set][index_cache].tag = (line_addr >> L1I_SET_BITS) & L1I_TIMING_CACHE_TAG_MASK;
-    l1i_timing_cache_table[eip_proc_id][set][index_cache].source_way = L1I_ENTANGLED_TABLE_WAYS;
-    l1i_timing_cache_table[eip_proc_id][set][index_cache].accessed = true;
+    s->tc_flags[entry] = L1I_TIMING_VALID | L1I_TIMING_ACCESSED;
+    s->tc_source_way[entry] = L1I_ENTANGLED_TABLE_WAYS;
     DEBUG(eip_proc_id, "fill timing_cache_entry at set %u index %u for 0x%lx icache_line_addr 0x%lx\n", set,
           index_cache, line_addr, line_addr << LOG2(ICACHE_LINE_SIZE));
     return;
   }
-  uint64_t set = line_addr % L1I_SET;
-  uint64_t index_cache = l1i_get_invalid_timing_cache_entry(line_addr);
-  l1i_timing_cache_table[eip_proc_id][set][index_cache].valid = true;
-  l1i_timing_cache_table[eip_proc_id][set][index_cache].tag = (line_addr >> L1I_SET_BITS) & L1I_TIMING_CACHE_TAG_MASK;
-  l1i_timing_cache_table[eip_proc_id][set][index_cache].source_set =
-      l1i_timing_mshr_table[eip_proc_id][index_mshr].source_set;
-  l1i_timing_cache_table[eip_proc_id][set][index_cache].source_way =
-      l1i_timing_mshr_table[eip_proc_id][index_mshr].source_way;
-  l1i_timing_cache_table[eip_proc_id][set][index_cache].accessed =
-      l1i_timing_mshr_table[eip_proc_id][index_mshr].accessed;
+  s->tc_flags[entry] = L1I_TIMING_VALID | (s->mshr_flags[index_mshr] & L1I_TIMING_ACCESSED);
+  s->tc_source_set[entry] = s->mshr_source_set[index_mshr];
+  s->tc_source_way[entry] = s->mshr_source_way[index_mshr];
   l1i_invalid_timing_mshr_entry(line_addr);
-  DEBUG(eip_proc_id, "fill timing_cache_entry at set %lu index %lu for 0x%lx icache_line_addr 0x%lx\n", set,
+  DEBUG(eip_proc_id, "fill timing_cache_entry at set %u index %u for 0x%lx icache_line_addr 0x%lx\n", set,
         index_cache, line_addr, line_addr << LOG2(ICACHE_LINE_SIZE));
 }
 
 // returns if accessed
 bool l1i_invalid_timing_cache_entry(uint64_t line_addr, uint32_t &source_set, uint32_t &source_way) {
-  uint32_t set = line_addr % L1I_SET;
+  l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t set = line_addr & L1I_SET_MASK;
   uint32_t way = l1i_find_timing_cache_entry(line_addr);
   ASSERT(eip_proc_id, way < L1I_WAY);
-  l1i_timing_cache_table[eip_proc_id][set][way].valid = false;
+  uint32_t entry = set * L1I_WAY + way;
+  s->tc_flags[entry] &= ~L1I_TIMING_VALID;
   DEBUG(eip_proc_id, "invalidate timing_cache_entry at set %u index %u for 0x%lx icache_line_addr 0x%lx\n", set, way,
         line_addr, line_addr << LOG2(ICACHE_LINE_SIZE));
-  source_set = l1i_timing_cache_table[eip_proc_id][set][way].source_set;
-  source_way = l1i_timing_cache_table[eip_proc_id][set][way].source_way;
-  return l1i_timing_cache_table[eip_proc_id][set][way].accessed;
+  source_set = s->tc_source_set[entry];
+  source_way = s->tc_source_way[entry];
+  return s->tc_flags[entry] & L1I_TIMING_ACCESSED;
 }
 
 void l1i_access_timing_entry(uint64_t line_addr, uint32_t pos_hist, uint32_t &source_set, uint32_t &source_way) {
+  l1i_core_state *s = &l1i_state[eip_proc_id];
   uint32_t index = l1i_find_timing_mshr_entry(line_addr);
   if (index < L1I_TIMING_MSHR_SIZE) {
-    if (!l1i_timing_mshr_table[eip_proc_id][index].accessed) {  // Prefetch accessed while in MSHR: late
-      l1i_timing_mshr_table[eip_proc_id][index].accessed = true;
-      l1i_timing_mshr_table[eip_proc_id][index].pos_hist = pos_hist;
-      if (l1i_timing_mshr_table[eip_proc_id][index].source_way < L1I_ENTANGLED_TABLE_WAYS) {
-        source_set = l1i_timing_mshr_table[eip_proc_id][index].source_set;
-        source_way = l1i_timing_mshr_table[eip_proc_id][index].source_way;
-        l1i_timing_mshr_table[eip_proc_id][index].source_set = 0;
-        l1i_timing_mshr_table[eip_proc_id][index].source_way = L1I_ENTANGLED_TABLE_WAYS;
+    if (!(s->mshr_flags[index] & L1I_TIMING_ACCESSED)) {  // Prefetch accessed while in MSHR: late
+      s->mshr_flags[index] |= L1I_TIMING_ACCESSED;
+      s->mshr_pos_hist[index] = pos_hist;
+      if (s->mshr_source_way[index] < L1I_ENTANGLED_TABLE_WAYS) {
+        source_set = s->mshr_source_set[index];
+        source_way = s->mshr_source_way[index];
+        s->mshr_source_set[index] = 0;
+        s->mshr_source_way[index] = L1I_ENTANGLED_TABLE_WAYS;
       }
     }
     return;
   }
-  uint32_t set = line_addr % L1I_SET;
+  uint32_t set = line_addr & L1I_SET_MASK;
   uint32_t way = l1i_find_timing_cache_entry(line_addr);
   if (way < L1I_WAY) {
-    l1i_timing_cache_table[eip_proc_id][set][way].accessed = true;
+    s->tc_flags[set * L1I_WAY + way] |= L1I_TIMING_ACCESSED;
   }
 }
 
 bool l1i_is_accessed_timing_entry(uint64_t line_addr) {
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
   uint32_t index = l1i_find_timing_mshr_entry(line_addr);
   if (index < L1I_TIMING_MSHR_SIZE) {
-    return l1i_timing_mshr_table[eip_proc_id][index].accessed;
+    return s->mshr_flags[index] & L1I_TIMING_ACCESSED;
   }
-  uint32_t set = line_addr % L1I_SET;
+  uint32_t set = line_addr & L1I_SET_MASK;
   uint32_t way = l1i_find_timing_cache_entry(line_addr);
   if (way < L1I_WAY) {
-    return l1i_timing_cache_table[eip_proc_id][set][way].accessed;
+    return s->tc_flags[set * L1I_WAY + way] & L1I_TIMING_ACCESSED;
   }
   return false;
 }
@@ -613,23 +638,23 @@ bool l1i_ongoing_accessed_request(uint64_t line_addr) {
   uint32_t index = l1i_find_timing_mshr_entry(line_addr);
   if (index == L1I_TIMING_MSHR_SIZE)
     return false;
-  return l1i_timing_mshr_table[eip_proc_id][index].accessed;
+  return l1i_state[eip_proc_id].mshr_flags[index] & L1I_TIMING_ACCESSED;
 }
 
 uint64_t l1i_get_latency_timing_mshr(uint64_t line_addr, uint32_t &pos_hist) {
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
   uint32_t index = l1i_find_timing_mshr_entry(line_addr);
   if (index == L1I_TIMING_MSHR_SIZE)
     return 0;
-  if (!l1i_timing_mshr_table[eip_proc_id][index].accessed)
+  if (!(s->mshr_flags[index] & L1I_TIMING_ACCESSED))
     return 0;
-  pos_hist = l1i_timing_mshr_table[eip_proc_id][index].pos_hist;
-  return l1i_get_latency(cycle_count, l1i_timing_mshr_table[eip_proc_id][index].timestamp);
+  pos_hist = s->mshr_pos_hist[index];
+  return l1i_get_latency(cycle_count, s->mshr_timestamp[index]);
 }
 
 // ENTANGLED TABLE
 
 uint32_t L1I_ENTANGLED_FORMATS[L1I_ENTANGLED_MAX_FORMATS] = {58, 28, 18, 13, 10, 8, 6};
-#define L1I_ENTANGLED_NUM_FORMATS 6
 
 uint32_t l1i_get_format_entangled(uint64_t line_addr, uint64_t entangled_addr) {
   for (uint32_t i = L1I_ENTANGLED_NUM_FORMATS; i != 0; i--) {
@@ -649,9 +674,8 @@ uint64_t l1i_compress_format_entangled(uint64_t entangled_addr, uint32_t format)
   return entangled_addr & (((uint64_t)1 << L1I_ENTANGLED_FORMATS[format - 1]) - 1);
 }
 
-#define L1I_MAX_ENTANGLED_PER_LINE L1I_ENTANGLED_NUM_FORMATS
-
 uint32_t L1I_ENTANGLED_TABLE_SETS;
+uint32_t L1I_ENTANGLED_TABLE_MASK;
 uint32_t L1I_TAG_BITS;
 uint32_t L1I_TAG_MASK;
 
@@ -660,44 +684,62 @@ uint32_t L1I_TAG_MASK;
 #define L1I_CONFIDENCE_COUNTER_THRESHOLD 1
 #define L1I_TRIES_AVAIL_ENTANGLED 2
 
-typedef struct __l1i_entangled_entry {
-  uint64_t tag;                                         // L1I_TAG_BITS bits
-  uint32_t format;                                      // log2(L1I_ENTANGLED_NUM_FORMATS) bits
-  uint64_t entangled_addr[L1I_MAX_ENTANGLED_PER_LINE];  // JUST DIFF
-  uint32_t entangled_conf[L1I_MAX_ENTANGLED_PER_LINE];  // L1I_CONFIDENCE_COUNTER_BITS bits
-  uint32_t bb_size;                                     // L1I_MERGE_BBSIZE_BITS bits
-} l1i_entangled_entry;
+static_assert(L1I_MAX_ENTANGLED_PER_LINE * L1I_CONFIDENCE_COUNTER_BITS <= 16, "ent_conf packs all counters of a line");
 
-// l1i_entangled_entry l1i_entangled_table[NUM_CPUS][L1I_ENTANGLED_TABLE_SETS][L1I_ENTANGLED_TABLE_WAYS];
-std::vector<l1i_entangled_entry **> l1i_entangled_table;
-// uint32_t l1i_entangled_fifo[NUM_CPUS][L1I_ENTANGLED_TABLE_SETS]; // log2(L1I_ENTANGLED_TABLE_WAYS) *
-// L1I_ENTANGLED_TABLE_SETS bits
-std::vector<uint32_t *> l1i_entangled_fifo;  // log2(L1I_ENTANGLED_TABLE_WAYS) * L1I_ENTANGLED_TABLE_SETS bits
+// entries are indexed set * L1I_ENTANGLED_TABLE_WAYS + way
+static inline uint32_t l1i_entangled_entry(uint32_t set, uint32_t way) {
+  return set * L1I_ENTANGLED_TABLE_WAYS + way;
+}
+
+static inline uint32_t l1i_get_conf(const l1i_core_state *s, uint32_t entry, uint32_t k) {
+  return (s->ent_conf[entry] >> (k * L1I_CONFIDENCE_COUNTER_BITS)) & L1I_CONFIDENCE_COUNTER_MAX_VALUE;
+}
+
+static inline void l1i_set_conf(l1i_core_state *s, uint32_t entry, uint32_t k, uint32_t conf) {
+  uint32_t shift = k * L1I_CONFIDENCE_COUNTER_BITS;
+  s->ent_conf[entry] = (s->ent_conf[entry] & ~(L1I_CONFIDENCE_COUNTER_MAX_VALUE << shift)) |
+                       ((conf & L1I_CONFIDENCE_COUNTER_MAX_VALUE) << shift);
+}
+
+static inline bool l1i_has_confident_entangled(const l1i_core_state *s, uint32_t entry) {
+  for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
+    if (l1i_get_conf(s, entry, k) >= L1I_CONFIDENCE_COUNTER_THRESHOLD)
+      return true;
+  }
+  return false;
+}
 
 uint64_t l1i_hash(uint64_t line_addr) {
   return line_addr ^ (line_addr >> 2) ^ (line_addr >> 5);
 }
 
+static void l1i_clear_entangled_entry(l1i_core_state *s, uint32_t entry, uint32_t tag) {
+  s->ent_tag[entry] = tag;
+  s->ent_format[entry] = 1;
+  s->ent_conf[entry] = 0;
+  for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
+    s->ent_addr[entry * L1I_MAX_ENTANGLED_PER_LINE + k] = 0;
+  }
+  s->ent_bb_size[entry] = 0;
+}
+
 void l1i_init_entangled_table() {
+  l1i_core_state *s = &l1i_state[eip_proc_id];
   for (uint32_t i = 0; i < L1I_ENTANGLED_TABLE_SETS; i++) {
     for (uint32_t j = 0; j < L1I_ENTANGLED_TABLE_WAYS; j++) {
-      l1i_entangled_table[eip_proc_id][i][j].tag = 0;
-      l1i_entangled_table[eip_proc_id][i][j].format = 1;
-      for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-        l1i_entangled_table[eip_proc_id][i][j].entangled_addr[k] = 0;
-        l1i_entangled_table[eip_proc_id][i][j].entangled_conf[k] = 0;
-      }
-      l1i_entangled_table[eip_proc_id][i][j].bb_size = 0;
+      l1i_clear_entangled_entry(s, l1i_entangled_entry(i, j), 0);
     }
-    l1i_entangled_fifo[eip_proc_id][i] = 0;
+    s->ent_fifo[i] = 0;
   }
 }
 
 uint32_t l1i_get_way_entangled_table(uint64_t line_addr) {
-  uint64_t tag = (l1i_hash(line_addr) >> L1I_ENTANGLED_TABLE_INDEX_BITS) & L1I_TAG_MASK;
-  uint32_t set = l1i_hash(line_addr) % L1I_ENTANGLED_TABLE_SETS;
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t tag = (l1i_hash(line_addr) >> L1I_ENTANGLED_TABLE_INDEX_BITS) & L1I_TAG_MASK;
+  uint32_t set = l1i_hash(line_addr) & L1I_ENTANGLED_TABLE_MASK;
+  const uint32_t *set_tags = &s->ent_tag[l1i_entangled_entry(set, 0)];
   for (uint32_t i = 0; i < L1I_ENTANGLED_TABLE_WAYS; i++) {
-    if (l1i_entangled_table[eip_proc_id][set][i].tag == tag) {  // Found
+    if (set_tags[i] == tag) {  // Found
       return i;
     }
   }
@@ -705,31 +747,21 @@ uint32_t l1i_get_way_entangled_table(uint64_t line_addr) {
 }
 
 void l1i_try_realocate_evicted_in_available_entangled_table(uint32_t set) {
-  uint64_t way = l1i_entangled_fifo[eip_proc_id][set];
-  bool dest_free_way = true;
-  for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-    if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
-      dest_free_way = false;
-      break;
-    }
-  }
-  if (dest_free_way && l1i_entangled_table[eip_proc_id][set][way].bb_size == 0)
+  l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t way = s->ent_fifo[set];
+  uint32_t way_entry = l1i_entangled_entry(set, way);
+  bool dest_free_way = !l1i_has_confident_entangled(s, way_entry);
+  if (dest_free_way && s->ent_bb_size[way_entry] == 0)
     return;
   uint32_t free_way = way;
   bool free_with_size = false;
   for (uint32_t i = (way + 1) % L1I_ENTANGLED_TABLE_WAYS; i != way; i = (i + 1) % L1I_ENTANGLED_TABLE_WAYS) {
-    bool dest_free = true;
-    for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-      if (l1i_entangled_table[eip_proc_id][set][i].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
-        dest_free = false;
-        break;
-      }
-    }
-    if (dest_free) {
+    uint32_t entry = l1i_entangled_entry(set, i);
+    if (!l1i_has_confident_entangled(s, entry)) {
       if (free_way == way) {
         free_way = i;
-        free_with_size = (l1i_entangled_table[eip_proc_id][set][i].bb_size != 0);
-      } else if (free_with_size && l1i_entangled_table[eip_proc_id][set][i].bb_size == 0) {
+        free_with_size = (s->ent_bb_size[entry] != 0);
+      } else if (free_with_size && s->ent_bb_size[entry] == 0) {
         free_way = i;
         free_with_size = false;
         break;
@@ -738,39 +770,39 @@ void l1i_try_realocate_evicted_in_available_entangled_table(uint32_t set) {
   }
   if (free_way != way &&
       ((!free_with_size) || (free_with_size && !dest_free_way))) {  // Only evict if it has more information
-    l1i_entangled_table[eip_proc_id][set][free_way].tag = l1i_entangled_table[eip_proc_id][set][way].tag;
-    l1i_entangled_table[eip_proc_id][set][free_way].format = l1i_entangled_table[eip_proc_id][set][way].format;
-    for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-      l1i_entangled_table[eip_proc_id][set][free_way].entangled_addr[k] =
-          l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k];
-      l1i_entangled_table[eip_proc_id][set][free_way].entangled_conf[k] =
-          l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k];
-    }
-    l1i_entangled_table[eip_proc_id][set][free_way].bb_size = l1i_entangled_table[eip_proc_id][set][way].bb_size;
+    uint32_t free_entry = l1i_entangled_entry(set, free_way);
+    s->ent_tag[free_entry] = s->ent_tag[way_entry];
+    s->ent_format[free_entry] = s->ent_format[way_entry];
+    s->ent_conf[free_entry] = s->ent_conf[way_entry];
+    memcpy(&s->ent_addr[free_entry * L1I_MAX_ENTANGLED_PER_LINE], &s->ent_addr[way_entry * L1I_MAX_ENTANGLED_PER_LINE],
+           sizeof(uint64_t) * L1I_MAX_ENTANGLED_PER_LINE);
+    s->ent_bb_size[free_entry] = s->ent_bb_size[way_entry];
   }
 }
 
-void l1i_add_entangled_table(uint64_t line_addr, uint64_t entangled_addr) {
-  uint64_t tag = (l1i_hash(line_addr) >> L1I_ENTANGLED_TABLE_INDEX_BITS) & L1I_TAG_MASK;
-  uint32_t set = l1i_hash(line_addr) % L1I_ENTANGLED_TABLE_SETS;
+// returns the way of line_addr in its set, allocating it (FIFO) when not present
+static uint32_t l1i_find_or_alloc_entangled_table(uint64_t line_addr, uint32_t set) {
+  l1i_core_state *s = &l1i_state[eip_proc_id];
   uint32_t way = l1i_get_way_entangled_table(line_addr);
   if (way == L1I_ENTANGLED_TABLE_WAYS) {
+    uint32_t tag = (l1i_hash(line_addr) >> L1I_ENTANGLED_TABLE_INDEX_BITS) & L1I_TAG_MASK;
     l1i_try_realocate_evicted_in_available_entangled_table(set);
-    way = l1i_entangled_fifo[eip_proc_id][set];
-    l1i_entangled_table[eip_proc_id][set][way].tag = tag;
-    l1i_entangled_table[eip_proc_id][set][way].format = 1;
-    for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-      l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k] = 0;
-      l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] = 0;
-    }
-    l1i_entangled_table[eip_proc_id][set][way].bb_size = 0;
-    l1i_entangled_fifo[eip_proc_id][set] = (l1i_entangled_fifo[eip_proc_id][set] + 1) % L1I_ENTANGLED_TABLE_WAYS;
+    way = s->ent_fifo[set];
+    l1i_clear_entangled_entry(s, l1i_entangled_entry(set, way), tag);
+    s->ent_fifo[set] = (s->ent_fifo[set] + 1) % L1I_ENTANGLED_TABLE_WAYS;
   }
+  return way;
+}
+
+void l1i_add_entangled_table(uint64_t line_addr, uint64_t entangled_addr) {
+  l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t set = l1i_hash(line_addr) & L1I_ENTANGLED_TABLE_MASK;
+  uint32_t entry = l1i_entangled_entry(set, l1i_find_or_alloc_entangled_table(line_addr, set));
+  uint64_t *addrs = &s->ent_addr[entry * L1I_MAX_ENTANGLED_PER_LINE];
   for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-    if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD &&
-        l1i_extend_format_entangled(line_addr, l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k],
-                                    l1i_entangled_table[eip_proc_id][set][way].format) == entangled_addr) {
-      l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] = L1I_CONFIDENCE_COUNTER_MAX_VALUE;
+    if (l1i_get_conf(s, entry, k) >= L1I_CONFIDENCE_COUNTER_THRESHOLD &&
+        l1i_extend_format_entangled(line_addr, addrs[k], s->ent_format[entry]) == entangled_addr) {
+      l1i_set_conf(s, entry, k, L1I_CONFIDENCE_COUNTER_MAX_VALUE);
       return;
     }
   }
@@ -786,57 +818,55 @@ void l1i_add_entangled_table(uint64_t line_addr, uint64_t entangled_addr) {
     uint32_t min_value = L1I_CONFIDENCE_COUNTER_MAX_VALUE + 1;
     uint32_t min_pos = 0;
     for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-      if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
+      uint32_t conf = l1i_get_conf(s, entry, k);
+      if (conf >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
         num_valid++;
         uint32_t format_k = l1i_get_format_entangled(
-            line_addr,
-            l1i_extend_format_entangled(line_addr, l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k],
-                                        l1i_entangled_table[eip_proc_id][set][way].format));
+            line_addr, l1i_extend_format_entangled(line_addr, addrs[k], s->ent_format[entry]));
         if (format_k < min_format) {
           min_format = format_k;
         }
-        if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] < min_value) {
-          min_value = l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k];
+        if (conf < min_value) {
+          min_value = conf;
           min_pos = k;
         }
       }
     }
     if (num_valid > min_format) {  // Eviction is necessary. We chose the lower confidence one
       l1i_stats_evict_entangled_k_table++;
-      l1i_entangled_table[eip_proc_id][set][way].entangled_conf[min_pos] = 0;
+      l1i_set_conf(s, entry, min_pos, 0);
     } else {
       // Reformat
       for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-        if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
-          l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k] = l1i_compress_format_entangled(
-              l1i_extend_format_entangled(line_addr, l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k],
-                                          l1i_entangled_table[eip_proc_id][set][way].format),
-              min_format);
+        if (l1i_get_conf(s, entry, k) >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
+          addrs[k] = l1i_compress_format_entangled(
+              l1i_extend_format_entangled(line_addr, addrs[k], s->ent_format[entry]), min_format);
         }
       }
-      l1i_entangled_table[eip_proc_id][set][way].format = min_format;
+      s->ent_format[entry] = min_format;
       break;
     }
   }
   for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-    if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] < L1I_CONFIDENCE_COUNTER_THRESHOLD) {
-      l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k] =
-          l1i_compress_format_entangled(entangled_addr, l1i_entangled_table[eip_proc_id][set][way].format);
-      l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] = L1I_CONFIDENCE_COUNTER_MAX_VALUE;
+    if (l1i_get_conf(s, entry, k) < L1I_CONFIDENCE_COUNTER_THRESHOLD) {
+      addrs[k] = l1i_compress_format_entangled(entangled_addr, s->ent_format[entry]);
+      l1i_set_conf(s, entry, k, L1I_CONFIDENCE_COUNTER_MAX_VALUE);
       return;
     }
   }
 }
 
 bool l1i_avail_entangled_table(uint64_t line_addr, uint64_t entangled_addr, bool insert_not_present) {
-  uint32_t set = l1i_hash(line_addr) % L1I_ENTANGLED_TABLE_SETS;
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t set = l1i_hash(line_addr) & L1I_ENTANGLED_TABLE_MASK;
   uint32_t way = l1i_get_way_entangled_table(line_addr);
   if (way == L1I_ENTANGLED_TABLE_WAYS)
     return insert_not_present;
+  uint32_t entry = l1i_entangled_entry(set, way);
+  const uint64_t *addrs = &s->ent_addr[entry * L1I_MAX_ENTANGLED_PER_LINE];
   for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-    if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD &&
-        l1i_extend_format_entangled(line_addr, l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k],
-                                    l1i_entangled_table[eip_proc_id][set][way].format) == entangled_addr) {
+    if (l1i_get_conf(s, entry, k) >= L1I_CONFIDENCE_COUNTER_THRESHOLD &&
+        l1i_extend_format_entangled(line_addr, addrs[k], s->ent_format[entry]) == entangled_addr) {
       return true;
     }
   }
@@ -844,12 +874,10 @@ bool l1i_avail_entangled_table(uint64_t line_addr, uint64_t entangled_addr, bool
   uint32_t min_format = l1i_get_format_entangled(line_addr, entangled_addr);
   uint32_t num_valid = 1;
   for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-    if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
+    if (l1i_get_conf(s, entry, k) >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
       num_valid++;
       uint32_t format_k = l1i_get_format_entangled(
-          line_addr,
-          l1i_extend_format_entangled(line_addr, l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k],
-                                      l1i_entangled_table[eip_proc_id][set][way].format));
+          line_addr, l1i_extend_format_entangled(line_addr, addrs[k], s->ent_format[entry]));
       if (format_k < min_format) {
         min_format = format_k;
       }
@@ -863,23 +891,11 @@ bool l1i_avail_entangled_table(uint64_t line_addr, uint64_t entangled_addr, bool
 }
 
 void l1i_add_bbsize_table(uint64_t line_addr, uint32_t bb_size) {
-  uint64_t tag = (l1i_hash(line_addr) >> L1I_ENTANGLED_TABLE_INDEX_BITS) & L1I_TAG_MASK;
-  uint32_t set = l1i_hash(line_addr) % L1I_ENTANGLED_TABLE_SETS;
-  uint32_t way = l1i_get_way_entangled_table(line_addr);
-  if (way == L1I_ENTANGLED_TABLE_WAYS) {
-    l1i_try_realocate_evicted_in_available_entangled_table(set);
-    way = l1i_entangled_fifo[eip_proc_id][set];
-    l1i_entangled_table[eip_proc_id][set][way].tag = tag;
-    l1i_entangled_table[eip_proc_id][set][way].format = 1;
-    for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-      l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k] = 0;
-      l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] = 0;
-    }
-    l1i_entangled_table[eip_proc_id][set][way].bb_size = 0;
-    l1i_entangled_fifo[eip_proc_id][set] = (l1i_entangled_fifo[eip_proc_id][set] + 1) % L1I_ENTANGLED_TABLE_WAYS;
-  }
-  if (bb_size > l1i_entangled_table[eip_proc_id][set][way].bb_size) {
-    l1i_entangled_table[eip_proc_id][set][way].bb_size = bb_size & L1I_MERGE_BBSIZE_MAX_VALUE;
+  l1i_core_state *s = &l1i_state[eip_proc_id];
+  uint32_t set = l1i_hash(line_addr) & L1I_ENTANGLED_TABLE_MASK;
+  uint32_t entry = l1i_entangled_entry(set, l1i_find_or_alloc_entangled_table(line_addr, set));
+  if (bb_size > s->ent_bb_size[entry]) {
+    s->ent_bb_size[entry] = bb_size & L1I_MERGE_BBSIZE_MAX_VALUE;
   }
   if (bb_size > l1i_stats_max_bb_size) {
     l1i_stats_max_bb_size = bb_size;
@@ -887,89 +903,116 @@ void l1i_add_bbsize_table(uint64_t line_addr, uint32_t bb_size) {
 }
 
 uint64_t l1i_get_entangled_addr_entangled_table(uint64_t line_addr, uint32_t index_k, uint32_t &set, uint32_t &way) {
-  set = l1i_hash(line_addr) % L1I_ENTANGLED_TABLE_SETS;
+  const l1i_core_state *s = &l1i_state[eip_proc_id];
+  set = l1i_hash(line_addr) & L1I_ENTANGLED_TABLE_MASK;
   way = l1i_get_way_entangled_table(line_addr);
   if (way < L1I_ENTANGLED_TABLE_WAYS) {
-    if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[index_k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
-      return l1i_extend_format_entangled(line_addr, l1i_entangled_table[eip_proc_id][set][way].entangled_addr[index_k],
-                                         l1i_entangled_table[eip_proc_id][set][way].format);
+    uint32_t entry = l1i_entangled_entry(set, way);
+    if (l1i_get_conf(s, entry, index_k) >= L1I_CONFIDENCE_COUNTER_THRESHOLD) {
+      return l1i_extend_format_entangled(line_addr, s->ent_addr[entry * L1I_MAX_ENTANGLED_PER_LINE + index_k],
+                                         s->ent_format[entry]);
     }
   }
   return 0;
 }
 
 uint32_t l1i_get_bbsize_entangled_table(uint64_t line_addr) {
-  uint32_t set = l1i_hash(line_addr) % L1I_ENTANGLED_TABLE_SETS;
+  uint32_t set = l1i_hash(line_addr) & L1I_ENTANGLED_TABLE_MASK;
   uint32_t way = l1i_get_way_entangled_table(line_addr);
   if (way < L1I_ENTANGLED_TABLE_WAYS) {
-    return l1i_entangled_table[eip_proc_id][set][way].bb_size;
+    return l1i_state[eip_proc_id].ent_bb_size[l1i_entangled_entry(set, way)];
   }
   return 0;
 }
 
 void l1i_update_confidence_entangled_table(uint32_t set, uint32_t way, uint64_t entangled_addr, bool accessed) {
   if (way < L1I_ENTANGLED_TABLE_WAYS) {
+    l1i_core_state *s = &l1i_state[eip_proc_id];
+    uint32_t entry = l1i_entangled_entry(set, way);
+    uint32_t format = s->ent_format[entry];
     for (uint32_t k = 0; k < L1I_MAX_ENTANGLED_PER_LINE; k++) {
-      if (l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] >= L1I_CONFIDENCE_COUNTER_THRESHOLD &&
-          l1i_compress_format_entangled(l1i_entangled_table[eip_proc_id][set][way].entangled_addr[k],
-                                        l1i_entangled_table[eip_proc_id][set][way].format) ==
-              l1i_compress_format_entangled(entangled_addr, l1i_entangled_table[eip_proc_id][set][way].format)) {
-        if (accessed &&
-            l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] < L1I_CONFIDENCE_COUNTER_MAX_VALUE) {
-          l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k]++;
+      uint32_t conf = l1i_get_conf(s, entry, k);
+      if (conf >= L1I_CONFIDENCE_COUNTER_THRESHOLD &&
+          l1i_compress_format_entangled(s->ent_addr[entry * L1I_MAX_ENTANGLED_PER_LINE + k], format) ==
+              l1i_compress_format_entangled(entangled_addr, format)) {
+        if (accessed && conf < L1I_CONFIDENCE_COUNTER_MAX_VALUE) {
+          l1i_set_conf(s, entry, k, conf + 1);
         }
-        if (!accessed && l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k] > 0) {
-          l1i_entangled_table[eip_proc_id][set][way].entangled_conf[k]--;
+        if (!accessed && conf > 0) {
+          l1i_set_conf(s, entry, k, conf - 1);
         }
       }
     }
   }
 }
 
+// PER-CORE STATE ALLOCATION
+
+// every array of l1i_core_state, with its entry count
+#define L1I_CORE_STATE_ARRAYS(X)                                                  \
+  X(mshr_tag, L1I_TIMING_MSHR_SIZE)                                               \
+  X(mshr_flags, L1I_TIMING_MSHR_SIZE)                                             \
+  X(mshr_source_set, L1I_TIMING_MSHR_SIZE)                                        \
+  X(mshr_source_way, L1I_TIMING_MSHR_SIZE)                                        \
+  X(mshr_timestamp, L1I_TIMING_MSHR_SIZE)                                         \
+  X(mshr_pos_hist, L1I_TIMING_MSHR_SIZE)                                          \
+  X(tc_tag, L1I_SET *L1I_WAY)                                                     \
+  X(tc_flags, L1I_SET *L1I_WAY)                                                   \
+  X(tc_source_set, L1I_SET *L1I_WAY)                                              \
+  X(tc_source_way, L1I_SET *L1I_WAY)                                              \
+  X(ent_tag, L1I_ENTANGLED_TABLE_SETS *L1I_ENTANGLED_TABLE_WAYS)                  \
+  X(ent_format, L1I_ENTANGLED_TABLE_SETS *L1I_ENTANGLED_TABLE_WAYS)               \
+  X(ent_bb_size, L1I_ENTANGLED_TABLE_SETS *L1I_ENTANGLED_TABLE_WAYS)              \
+  X(ent_conf, L1I_ENTANGLED_TABLE_SETS *L1I_ENTANGLED_TABLE_WAYS)                 \
+  X(ent_addr, L1I_ENTANGLED_TABLE_SETS *L1I_ENTANGLED_TABLE_WAYS *L1I_MAX_ENTANGLED_PER_LINE)  \
+  X(ent_fifo, L1I_ENTANGLED_TABLE_SETS)                                           \
+  X(stats, L1I_STATS_TABLE_ENTRIES)
+
+// arrays start on their own cache line
+#define L1I_ARENA_BYTES(field, entries) (((size_t)(entries) * sizeof(*((l1i_core_state *)0)->field) + 63) & ~(size_t)63)
+
+static void l1i_alloc_core_state(l1i_core_state *s) {
+  size_t bytes = 0;
+#define L1I_ARENA_SIZE(field, entries) bytes += L1I_ARENA_BYTES(field, entries);
+  L1I_CORE_STATE_ARRAYS(L1I_ARENA_SIZE)
+#undef L1I_ARENA_SIZE
+
+  s->arena = (char *)table_alloc("eip", bytes);
+
+  char *cursor = s->arena;
+#define L1I_ARENA_CARVE(field, entries)     \
+  s->field = (decltype(s->field))cursor; \
+  cursor += L1I_ARENA_BYTES(field, entries);
+  L1I_CORE_STATE_ARRAYS(L1I_ARENA_CARVE)
+#undef L1I_ARENA_CARVE
+}
+
 // INTERFACE
 void alloc_mem_eip(uns numCores) {
   if (!EIP_ENABLE)
     return;
 
   L1I_ENTANGLED_TABLE_SETS = (1 << L1I_ENTANGLED_TABLE_INDEX_BITS);
+  L1I_ENTANGLED_TABLE_MASK = L1I_ENTANGLED_TABLE_SETS - 1;
   L1I_TAG_BITS = (19 - L1I_ENTANGLED_TABLE_INDEX_BITS);
   L1I_TAG_MASK = (((uint64_t)1 << L1I_TAG_BITS) - 1);
+  // source_set and source_way (including the L1I_ENTANGLED_TABLE_WAYS sentinel) are stored in 16 and 8 bits
+  ASSERT(eip_proc_id, L1I_ENTANGLED_TABLE_INDEX_BITS <= 16 && L1I_ENTANGLED_TABLE_WAYS < 256);
 
   ASSERT(eip_proc_id, MEM_REQ_BUFFER_ENTRIES > 16);
   L1I_RQ_SIZE = QUEUE_L1_SIZE == 0 ? MEM_REQ_BUFFER_ENTRIES : QUEUE_L1_SIZE;
   ASSERT(eip_proc_id, L1I_RQ_SIZE > 0);
   L1I_SET = ICACHE_SIZE / ICACHE_LINE_SIZE / ICACHE_ASSOC;
+  ASSERTM(eip_proc_id, L1I_SET && !(L1I_SET & (L1I_SET - 1)), "EIP needs a power-of-two number of icache sets\n");
+  L1I_SET_MASK = L1I_SET - 1;
   L1I_WAY = ICACHE_ASSOC;
   int L1I_MSHR_SIZE = (MEM_REQ_BUFFER_ENTRIES <= 64 && MEM_REQ_BUFFER_ENTRIES > 16) ? 16 : MEM_REQ_BUFFER_ENTRIES / 4;
   L1I_TIMING_MSHR_SIZE = FE_FTQ_BLOCK_NUM + L1I_MSHR_SIZE + L1I_RQ_SIZE;
   DEBUG(eip_proc_id, "L1I_RQ_SIZE: %d, L1I_SET: %d, L1I_WAY: %d, L1I_TIMING_MSHR_SIZE: %d\n", L1I_RQ_SIZE, L1I_SET,
         L1I_WAY, L1I_TIMING_MSHR_SIZE);
-  l1i_stats_table.resize(numCores);
-  for (auto it = l1i_stats_table.begin(); it != l1i_stats_table.end(); ++it)
-    *it = (l1i_stats_entry *)malloc(sizeof(l1i_stats_entry) * L1I_STATS_TABLE_ENTRIES);
-  l1i_hist_table.resize(numCores);
-  for (auto it = l1i_hist_table.begin(); it != l1i_hist_table.end(); ++it)
-    *it = (l1i_hist_entry *)malloc(sizeof(l1i_hist_entry) * L1I_HIST_TABLE_ENTRIES);
-  l1i_hist_table_head.resize(numCores);
-  l1i_hist_table_head_time.resize(numCores);
-  l1i_timing_mshr_table.resize(numCores);
-  for (auto it = l1i_timing_mshr_table.begin(); it != l1i_timing_mshr_table.end(); ++it)
-    *it = (l1i_timing_mshr_entry *)malloc(sizeof(l1i_timing_mshr_entry) * L1I_TIMING_MSHR_SIZE);
-  l1i_timing_cache_table.resize(numCores);
-  for (auto it = l1i_timing_cache_table.begin(); it != l1i_timing_cache_table.end(); ++it) {
-    *it = (l1i_timing_cache_entry **)malloc(sizeof(l1i_timing_cache_entry *) * L1I_SET);
-    for (uint32_t i = 0; i < L1I_SET; i++)
-      (*it)[i] = (l1i_timing_cache_entry *)malloc(sizeof(l1i_timing_cache_entry) * L1I_WAY);
-  }
-  l1i_entangled_table.resize(numCores);
-  for (auto it = l1i_entangled_table.begin(); it != l1i_entangled_table.end(); ++it) {
-    *it = (l1i_entangled_entry **)malloc(sizeof(l1i_entangled_entry *) * L1I_ENTANGLED_TABLE_SETS);
-    for (uint32_t i = 0; i < L1I_ENTANGLED_TABLE_SETS; i++)
-      (*it)[i] = (l1i_entangled_entry *)malloc(sizeof(l1i_entangled_entry) * L1I_ENTANGLED_TABLE_WAYS);
-  }
-  l1i_entangled_fifo.resize(numCores);
-  for (auto it = l1i_entangled_fifo.begin(); it != l1i_entangled_fifo.end(); ++it)
-    *it = (uint32_t *)malloc(sizeof(uint32_t) * L1I_ENTANGLED_TABLE_SETS);
+  l1i_state.resize(numCores);
+  for (auto &s : l1i_state)
+    l1i_alloc_core_state(&s);
 }
 
 void init_eip(uns proc_id) {
@@ -980,16 +1023,17 @@ void init_eip(uns proc_id) {
 
   eip_proc_id = proc_id;
   l1i_init_stats_table();
-  l1i_last_basic_block = 0;
-  l1i_consecutive_count = 0;
-  l1i_basic_block_merge_diff = 0;
+  l1i_state[proc_id].last_basic_block = 0;
+  l1i_state[proc_id].consecutive_count = 0;
+  l1i_state[proc_id].basic_block_merge_diff = 0;
 
   l1i_init_hist_table();
   l1i_init_timing_tables();
   l1i_init_entangled_table();
 }
 
-void eip_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefetch_hit, Flag off_path) {
+static void l1i_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefetch_hit, Flag off_path) {
+  l1i_core_state *s = &l1i_state[proc_id];
   uint64_t line_addr = v_addr >> LOG2(ICACHE_LINE_SIZE);
   DEBUG(proc_id,
         "eip_prefetch 0x%lx, icache_line_addr 0x%lx line_addr 0x%lx, cache hit %d, prefetch_hit %d, "
@@ -1003,23 +1047,23 @@ void eip_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefe
   if (cache_hit)
     ASSERT(eip_proc_id, l1i_find_timing_cache_entry(line_addr) < L1I_WAY);
 
-  l1i_stats_table[proc_id][(line_addr & L1I_STATS_TABLE_MASK)].accesses++;
+  s->stats[(line_addr & L1I_STATS_TABLE_MASK)].accesses++;
   if (!cache_hit) {
-    l1i_stats_table[proc_id][(line_addr & L1I_STATS_TABLE_MASK)].misses++;
+    s->stats[(line_addr & L1I_STATS_TABLE_MASK)].misses++;
     if (l1i_ongoing_request(line_addr) && !l1i_is_accessed_timing_entry(line_addr)) {
-      l1i_stats_table[proc_id][(line_addr & L1I_STATS_TABLE_MASK)].late++;
+      s->stats[(line_addr & L1I_STATS_TABLE_MASK)].late++;
     }
   }
   if (prefetch_hit) {
-    l1i_stats_table[proc_id][(line_addr & L1I_STATS_TABLE_MASK)].hits++;
+    s->stats[(line_addr & L1I_STATS_TABLE_MASK)].hits++;
   }
 
   bool consecutive = false;
 
-  if (l1i_last_basic_block + l1i_consecutive_count == line_addr) {  // Same
+  if (s->last_basic_block + s->consecutive_count == line_addr) {  // Same
     return;
-  } else if (l1i_last_basic_block + l1i_consecutive_count + 1 == line_addr) {  // Consecutive
-    l1i_consecutive_count++;
+  } else if (s->last_basic_block + s->consecutive_count + 1 == line_addr) {  // Consecutive
+    s->consecutive_count++;
     consecutive = true;
   }
   if (!FDIP_ENABLE)
@@ -1035,8 +1079,7 @@ void eip_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefe
       Flag success = FALSE;
       // TODO : limit per-cycle prefetches
       // if (per_cyc_ipref < IPRF_MAX_FTQ_ENTRY_CYC)
-      success =
-          new_mem_req(MRT_IPRF, eip_proc_id, pf_addr, ICACHE_LINE_SIZE, 0, NULL, instr_fill_line, unique_count, 0);
+      success = iprefetch_issue(eip_proc_id, IPREF_EIP, pf_addr);
       if (success) {
         DEBUG(proc_id, "new_mem_req (BB pref) for v_addr 0x%lx,line_addr 0x%lx  pf_addr 0x%lx, unique_count: %llu\n",
               v_addr, v_addr & ~0x3F, pf_addr, unique_count);
@@ -1065,8 +1108,7 @@ void eip_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefe
           Flag success = FALSE;
           // TODO : limit per-cycle prefetches
           // if (per_cyc_ipref < IPRF_MAX_FTQ_ENTRY_CYC)
-          success = new_mem_req(MRT_IPRF, eip_proc_id, pf_line_addr << LOG2(ICACHE_LINE_SIZE), ICACHE_LINE_SIZE, 0,
-                                NULL, instr_fill_line, unique_count, 0);
+          success = iprefetch_issue(eip_proc_id, IPREF_EIP, pf_line_addr << LOG2(ICACHE_LINE_SIZE));
           if (success) {
             DEBUG(proc_id, "new_mem_req (Entangled pref) for 0x%lx, unique_count: %llu\n",
                   pf_line_addr << LOG2(ICACHE_LINE_SIZE), unique_count);
@@ -1083,34 +1125,34 @@ void eip_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefe
     l1i_stats_entangled[num_entangled]++;
 
   if (!consecutive) {  // New basic block found
-    uint32_t max_bb_size = l1i_get_bbsize_entangled_table(l1i_last_basic_block);
+    uint32_t max_bb_size = l1i_get_bbsize_entangled_table(s->last_basic_block);
 
     // Check for merging bb opportunities
-    if (l1i_consecutive_count) {  // single blocks no need to merge and are not inserted in the entangled table
-      if (l1i_basic_block_merge_diff > 0) {
-        l1i_add_bbsize_table(l1i_last_basic_block - l1i_basic_block_merge_diff,
-                             l1i_consecutive_count + l1i_basic_block_merge_diff);
-        l1i_add_bb_size_hist_table(l1i_last_basic_block - l1i_basic_block_merge_diff,
-                                   l1i_consecutive_count + l1i_basic_block_merge_diff);
+    if (s->consecutive_count) {  // single blocks no need to merge and are not inserted in the entangled table
+      if (s->basic_block_merge_diff > 0) {
+        l1i_add_bbsize_table(s->last_basic_block - s->basic_block_merge_diff,
+                             s->consecutive_count + s->basic_block_merge_diff);
+        l1i_add_bb_size_hist_table(s->last_basic_block - s->basic_block_merge_diff,
+                                   s->consecutive_count + s->basic_block_merge_diff);
       } else {
-        l1i_add_bbsize_table(l1i_last_basic_block, std::max(max_bb_size, l1i_consecutive_count));
-        l1i_add_bb_size_hist_table(l1i_last_basic_block, std::max(max_bb_size, l1i_consecutive_count));
+        l1i_add_bbsize_table(s->last_basic_block, std::max(max_bb_size, s->consecutive_count));
+        l1i_add_bb_size_hist_table(s->last_basic_block, std::max(max_bb_size, s->consecutive_count));
       }
     }
   }
 
   if (!consecutive) {  // New basic block found
-    l1i_consecutive_count = 0;
-    l1i_last_basic_block = line_addr;
+    s->consecutive_count = 0;
+    s->last_basic_block = line_addr;
   }
 
   if (!consecutive) {
-    l1i_basic_block_merge_diff = l1i_find_bb_merge_hist_table(l1i_last_basic_block);
+    s->basic_block_merge_diff = l1i_find_bb_merge_hist_table(s->last_basic_block);
   }
 
   // Add the request in the history buffer
   uint32_t pos_hist = L1I_HIST_TABLE_ENTRIES;
-  if (!consecutive && l1i_basic_block_merge_diff == 0) {
+  if (!consecutive && s->basic_block_merge_diff == 0) {
     if ((l1i_find_hist_entry(line_addr) == L1I_HIST_TABLE_ENTRIES)) {
       pos_hist = l1i_add_hist_table(line_addr);
     } else {
@@ -1135,16 +1177,27 @@ void eip_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefe
   }
 }
 
-void set_eip(uns _proc_id) {
-  eip_proc_id = _proc_id;
+void eip_prefetch(uns proc_id, uint64_t v_addr, uint8_t cache_hit, uint8_t prefetch_hit, Flag off_path) {
+  uns64 prof_t = host_prof_now();
+  l1i_prefetch(proc_id, v_addr, cache_hit, prefetch_hit, off_path);
+  if (HOST_PROF) {
+    l1i_state[proc_id].prof_events++;
+    l1i_state[proc_id].prof_ticks += host_prof_now() - prof_t;
+  }
 }
 
-void update_eip() {
+void set_eip(Core_Context* ctx) {
+  eip_proc_id = ctx->proc_id;
+}
+
+void update_eip(Core_Context* ctx) {
+  set_eip(ctx);
   if (!EIP_ENABLE)
     return;
 }
 
 void eip_cache_fill(uns proc_id, uint64_t v_addr, uint64_t evicted_v_addr) {
+  uns64 prof_t = host_prof_now();
   eip_proc_id = proc_id;
   uint64_t line_addr = (v_addr >> LOG2(ICACHE_LINE_SIZE));
   uint64_t evicted_line_addr = (evicted_v_addr >> LOG2(ICACHE_LINE_SIZE));
@@ -1157,7 +1210,7 @@ void eip_cache_fill(uns proc_id, uint64_t v_addr, uint64_t evicted_v_addr) {
     uint32_t source_way = L1I_ENTANGLED_TABLE_WAYS;
     bool accessed = l1i_invalid_timing_cache_entry(evicted_line_addr, source_set, source_way);
     if (!accessed) {
-      l1i_stats_table[proc_id][(evicted_line_addr & L1I_STATS_TABLE_MASK)].wrong++;
+      l1i_state[proc_id].stats[(evicted_line_addr & L1I_STATS_TABLE_MASK)].wrong++;
     }
     if (source_way < L1I_ENTANGLED_TABLE_WAYS) {
       // If accessed hit, but if not wrong
@@ -1190,8 +1243,18 @@ void eip_cache_fill(uns proc_id, uint64_t v_addr, uint64_t evicted_v_addr) {
       }
     }
   }
+  if (HOST_PROF) {
+    l1i_state[proc_id].prof_events++;
+    l1i_state[proc_id].prof_ticks += host_prof_now() - prof_t;
+  }
 }
 
 void print_eip_stats(uns proc_id) {
   l1i_print_stats_table();
+  if (HOST_PROF) {
+    const l1i_core_state *s = &l1i_state[proc_id];
+    double ns = host_prof_ticks_to_ns(s->prof_ticks);
+    fprintf(mystdout, "** EIP host time: %s accesses, %.1f ns/access\n", unsstr64(s->prof_events),
+            s->prof_events ? ns / s->prof_events : 0.0);
+  }
 }
@@ -2,6 +2,7 @@
 
 #include "frontend/pt_memtrace/trace_fe.h"
 
+#include "core_context.h"
 #include "decoupled_frontend.h"
 #include "sim.h"
 
@@ -14,6 +15,7 @@ extern "C" {
 
 #include "memory/memory.h"
 #include "prefetcher/eip.h"
+#include "prefetcher/iprefetch.h"
 
 #include "op.h"
 }
@@ -56,6 +58,125 @@ typedef enum UTILITY_PREF_POLICY_enum {
   PREF_POL_END,  // add a new policy above this line
 } Utility_Pref_Policy;
 
+/* Per-line event sequences for the FDIP_PRINT_CL_INFO dumps. By default every event of every line is kept. With
+   FDIP_STAT_SEQ_LEN set, lines live in a flat open-addressing table of at most FDIP_STAT_SEQ_LINES entries and each
+   keeps only its last FDIP_STAT_SEQ_LEN events in a fixed ring, so memory is bounded no matter how long the run is.
+   FDIP_STAT_SAMPLE_SHIFT records only one in every 2^N lines in either mode. */
+template <typename T>
+class FDIP_Line_Seq {
+ public:
+  FDIP_Line_Seq() : seq_len(FDIP_STAT_SEQ_LEN), num_lines(0), dropped_lines(0) {
+    if (!seq_len)
+      return;
+    ASSERTM(0, FDIP_STAT_SEQ_LINES > 0, "FDIP_STAT_SEQ_LINES must be positive when FDIP_STAT_SEQ_LEN is set\n");
+    uns capacity = 1;
+    while (capacity < 2 * FDIP_STAT_SEQ_LINES)
+      capacity <<= 1;
+    mask = capacity - 1;
+    keys.resize(capacity, 0);
+    totals.resize(capacity, 0);
+    ring.resize((size_t)capacity * seq_len);
+  }
+
+  // appends val to the sequence of line_addr, returns TRUE if this started a new sequence
+  Flag push(Addr line_addr, const T& val) {
+    if (!sampled(line_addr))
+      return FALSE;
+    if (!seq_len) {
+      auto it = lines.find(line_addr);
+      if (it == lines.end()) {
+        lines.insert(make_pair(line_addr, vector<T>(1, val)));
+        return TRUE;
+      }
+      it->second.push_back(val);
+      return FALSE;
+    }
+    uns slot = find_slot(line_addr);
+    Flag new_line = totals[slot] == 0;
+    if (new_line) {
+      if (num_lines >= FDIP_STAT_SEQ_LINES) {
+        dropped_lines++;
+        return FALSE;
+      }
+      keys[slot] = line_addr;
+      num_lines++;
+    }
+    ring[(size_t)slot * seq_len + totals[slot] % seq_len] = val;
+    totals[slot]++;
+    return new_line;
+  }
+
+  // copies the kept events of line_addr into seq (oldest first), returns FALSE if the line has no sequence
+  Flag get(Addr line_addr, vector<T>* seq) const {
+    if (!seq_len) {
+      auto it = lines.find(line_addr);
+      if (it == lines.end())
+        return FALSE;
+      *seq = it->second;
+      return TRUE;
+    }
+    uns slot = find_slot(line_addr);
+    if (totals[slot] == 0)
+      return FALSE;
+    copy_slot(slot, seq);
+    return TRUE;
+  }
+
+  // calls fn(line_addr, kept events, total events) for every recorded line
+  template <typename F>
+  void for_each(F fn) const {
+    if (!seq_len) {
+      for (auto it = lines.begin(); it != lines.end(); ++it)
+        fn(it->first, it->second, (Counter)it->second.size());
+      return;
+    }
+    vector<T> seq;
+    for (uns slot = 0; slot <= mask; slot++) {
+      if (totals[slot] == 0)
+        continue;
+      copy_slot(slot, &seq);
+      fn(keys[slot], seq, totals[slot]);
+    }
+  }
+
+  Counter get_dropped_lines() const { return dropped_lines; }
+
+ private:
+  static Flag sampled(Addr line_addr) {
+    if (!FDIP_STAT_SAMPLE_SHIFT)
+      return TRUE;
+    uns64 hash = (line_addr >> 6) * 0x9E3779B97F4A7C15ULL;
+    return (hash >> (64 - FDIP_STAT_SAMPLE_SHIFT)) == 0;
+  }
+
+  // linear probing; returns the slot holding line_addr or the empty slot where it would go
+  uns find_slot(Addr line_addr) const {
+    uns slot = (uns)(((line_addr >> 6) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while (totals[slot] != 0 && keys[slot] != line_addr)
+      slot = (slot + 1) & mask;
+    return slot;
+  }
+
+  void copy_slot(uns slot, vector<T>* seq) const {
+    Counter total = totals[slot];
+    Counter first = total > seq_len ? total - seq_len : 0;
+    seq->clear();
+    for (Counter ii = first; ii < total; ii++)
+      seq->push_back(ring[(size_t)slot * seq_len + ii % seq_len]);
+  }
+
+  uns seq_len;
+  // unbounded mode
+  unordered_map<Addr, vector<T>> lines;
+  // bounded mode: a line occupies a slot once it has at least one event
+  uns mask;
+  uns num_lines;
+  Counter dropped_lines;
+  vector<Addr> keys;
+  vector<Counter> totals;
+  vector<T> ring;
+};
+
 class FDIP_Stat {
  public:
   FDIP_Stat()
@@ -123,15 +244,15 @@ class FDIP_Stat {
   // - prefetched and access time information for timeliness analysis
   unordered_map<Addr, pair<pair<Counter, Flag>, pair<Counter, Counter>>> prefetched_cls_info;
   // <CL address, sequence of useful/unuseful>
-  unordered_map<Addr, vector<uns8>> useful_sequence;
+  FDIP_Line_Seq<uns8> useful_sequence;
   // <CL address, sequence of hit/miss>
-  unordered_map<Addr, vector<uns8>> icache_sequence;
+  FDIP_Line_Seq<uns8> icache_sequence;
   // <CL address, all sequence> char - P: prefetch, p: not prefetch, m: icache miss, h: icache hit, U: useful, u:
   // unuseful (Counter - cycle count)
-  unordered_map<Addr, vector<pair<char, Counter>>> sequence_bw;
+  FDIP_Line_Seq<pair<char, Counter>> sequence_bw;
   // <CL address, all sequence> char - P: prefetch, p: not prefetch, m: icache miss, h: icache hit, U: useful, u:
   // unuseful (Counter - cycle count)
-  unordered_map<Addr, vector<pair<char, Counter>>> sequence_aw;
+  FDIP_Line_Seq<pair<char, Counter>> sequence_aw;
   // <CL address, total miss delay>
   map<Addr, Counter> per_line_delay_aw;
   Counter cur_line_delay;
@@ -201,7 +322,7 @@ class FDIP {
 };
 
 /* Global Variables */
-FDIP* fdip = NULL;
+CORE_LOCAL FDIP* fdip = NULL;
 
 // Per core FDIP
 vector<FDIP> per_core_fdip;
@@ -223,16 +344,17 @@ void init_fdip(uns proc_id) {
   ASSERT(proc_id, WP_COLLECT_STATS);
 }
 
-void set_fdip(int _proc_id, Icache_Stage* _ic) {
-  fdip = &per_core_fdip[_proc_id];
-  fdip->set_ic_ref(_ic);
+void set_fdip(Core_Context* ctx) {
+  fdip = &per_core_fdip[ctx->proc_id];
+  fdip->set_ic_ref(ctx->ic);
 }
 
 void recover_fdip() {
   fdip->recover();
 }
 
-void update_fdip() {
+void update_fdip(Core_Context* ctx) {
+  set_fdip(ctx);
   if (!FDIP_ENABLE)
     return;
   fdip->update();
@@ -449,45 +571,50 @@ void FDIP_Stat::print_cl_info(Icache_Stage* ic_ref) {
 
   fp = fopen("per_line_useful_seq.csv", "w");
   fprintf(fp, "cl_addr,seq\n");
-  for (auto it = useful_sequence.begin(); it != useful_sequence.end(); ++it) {
-    fprintf(fp, "%llx", it->first);
-    for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+  useful_sequence.for_each([fp](Addr line_addr, const vector<uns8>& seq, Counter total) {
+    UNUSED(total);
+    fprintf(fp, "%llx", line_addr);
+    for (auto it2 = seq.begin(); it2 != seq.end(); ++it2) {
       fprintf(fp, ",%u", *it2);
     }
     fprintf(fp, "\n");
-  }
+  });
   fclose(fp);
 
   fp = fopen("per_line_icache_seq.csv", "w");
   fprintf(fp, "cl_addr,seq\n");
-  for (auto it = icache_sequence.begin(); it != icache_sequence.end(); ++it) {
-    fprintf(fp, "%llx", it->first);
-    for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+  icache_sequence.for_each([fp](Addr line_addr, const vector<uns8>& seq, Counter total) {
+    UNUSED(total);
+    fprintf(fp, "%llx", line_addr);
+    for (auto it2 = seq.begin(); it2 != seq.end(); ++it2) {
       fprintf(fp, ",%u", *it2);
     }
     fprintf(fp, "\n");
-  }
+  });
   fclose(fp);
 
   fp = fopen("per_line_seq_aw.csv", "w");
   fprintf(fp, "cl_addr,seq\n");
-  for (auto it = sequence_aw.begin(); it != sequence_aw.end(); ++it) {
-    fprintf(fp, "%llx", it->first);
-    if (it->second.size() == 2) {
-      auto it2 = it->second.begin();
+  sequence_aw.for_each([fp, proc_id](Addr line_addr, const vector<pair<char, Counter>>& seq, Counter total) {
+    fprintf(fp, "%llx", line_addr);
+    if (total == 2) {
+      auto it2 = seq.begin();
       if (it2++->first == 'P' && it2->first == 'u')
         STAT_EVENT(proc_id, FDIP_PREFETCH_EVICT_NO_HIT_ONLY_ONCE);
     }
-    for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+    for (auto it2 = seq.begin(); it2 != seq.end(); ++it2) {
       fprintf(fp, ",%c", it2->first);
     }
     fprintf(fp, "\n");
-    for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+    for (auto it2 = seq.begin(); it2 != seq.end(); ++it2) {
       fprintf(fp, ",%lld", it2->second);
     }
     fprintf(fp, "\n");
-  }
+  });
   fclose(fp);
+  INC_STAT_EVENT(proc_id, FDIP_SEQ_DROPPED_LINES,
+                 useful_sequence.get_dropped_lines() + icache_sequence.get_dropped_lines() +
+                     sequence_bw.get_dropped_lines() + sequence_aw.get_dropped_lines());
 
   multimap<Counter, Addr> per_line_delay_sorted = flip_map(per_line_delay_aw);
   fp = fopen("per_line_delay.csv", "w");
@@ -507,13 +634,7 @@ void FDIP_Stat::inc_cnt_useful_signed(Addr line_addr) {
     it->second += UDP_WEIGHT_USEFUL;
 
   uns8 useful_value = fdip->get_warmed_up() ? 3 : 1;
-  auto it2 = useful_sequence.find(line_addr);
-  if (it2 == useful_sequence.end()) {
-    useful_sequence.insert(make_pair(line_addr, vector<uns8>()));
-    useful_sequence[line_addr].push_back(useful_value);
-  } else {
-    it2->second.push_back(useful_value);
-  }
+  useful_sequence.push(line_addr, useful_value);
 }
 
 void FDIP_Stat::inc_cnt_unuseful(Addr line_addr) {
@@ -533,21 +654,9 @@ void FDIP_Stat::inc_cnt_unuseful(Addr line_addr) {
     else
       it->second++;
 
-    auto it2 = sequence_aw.find(line_addr);
-    if (it2 == sequence_aw.end()) {
-      sequence_aw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_aw[line_addr].push_back(make_pair('u', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('u', cycle_count));
-    }
+    sequence_aw.push(line_addr, make_pair('u', cycle_count));
   } else {
-    auto it2 = sequence_bw.find(line_addr);
-    if (it2 == sequence_bw.end()) {
-      sequence_bw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_bw[line_addr].push_back(make_pair('u', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('u', cycle_count));
-    }
+    sequence_bw.push(line_addr, make_pair('u', cycle_count));
   }
 }
 
@@ -574,21 +683,9 @@ void FDIP_Stat::inc_cnt_useful(Addr line_addr, Flag pref_miss) {
       it->second.second = pref_miss;
     }
 
-    auto it2 = sequence_aw.find(line_addr);
-    if (it2 == sequence_aw.end()) {
-      sequence_aw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_aw[line_addr].push_back(make_pair('U', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('U', cycle_count));
-    }
+    sequence_aw.push(line_addr, make_pair('U', cycle_count));
   } else {
-    auto iter = sequence_bw.find(line_addr);
-    if (iter == sequence_bw.end()) {
-      sequence_bw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_bw[line_addr].push_back(make_pair('U', cycle_count));
-    } else {
-      iter->second.push_back(make_pair('U', cycle_count));
-    }
+    sequence_bw.push(line_addr, make_pair('U', cycle_count));
   }
 }
 
@@ -600,23 +697,11 @@ void FDIP_Stat::probe_prefetched_cls(Addr line_addr) {
 
 void FDIP_Stat::not_prefetch(Addr line_addr) {
   if (fdip->get_warmed_up()) {
-    auto it = sequence_aw.find(line_addr);
     Counter onoff_cycle_count = fdip_off_path() ? -cycle_count : cycle_count;
-    if (it == sequence_aw.end()) {
-      sequence_aw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_aw[line_addr].push_back(make_pair('p', onoff_cycle_count));
-    } else {
-      it->second.push_back(make_pair('p', onoff_cycle_count));
-    }
+    sequence_aw.push(line_addr, make_pair('p', onoff_cycle_count));
   } else {
-    auto it = sequence_bw.find(line_addr);
     Counter onoff_cycle_count = fdip_off_path() ? -cycle_count : cycle_count;
-    if (it == sequence_bw.end()) {
-      sequence_bw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_bw[line_addr].push_back(make_pair('p', onoff_cycle_count));
-    } else {
-      it->second.push_back(make_pair('p', onoff_cycle_count));
-    }
+    sequence_bw.push(line_addr, make_pair('p', onoff_cycle_count));
   }
 }
 
@@ -636,58 +721,39 @@ void FDIP_Stat::inc_icache_miss(Addr line_addr) {
     else
       it->second++;
 
-    auto it2 = sequence_aw.find(line_addr);
-    if (it2 == sequence_aw.end()) {
-      sequence_aw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_aw[line_addr].push_back(make_pair('m', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('m', cycle_count));
-    }
+    sequence_aw.push(line_addr, make_pair('m', cycle_count));
 
     cur_line_delay = cycle_count;
   } else {
-    auto it2 = sequence_bw.find(line_addr);
-    if (it2 == sequence_bw.end()) {
-      sequence_bw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_bw[line_addr].push_back(make_pair('m', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('m', cycle_count));
-    }
+    sequence_bw.push(line_addr, make_pair('m', cycle_count));
   }
 
   uns icache_val = fdip->get_warmed_up() ? 2 : 0;
-  auto it = icache_sequence.find(line_addr);
-  if (it == icache_sequence.end()) {
-    icache_sequence.insert(make_pair(line_addr, vector<uns8>()));
-    icache_sequence[line_addr].push_back(icache_val);
-    if (icache_val == 2) {
-      auto it2 = sequence_bw.find(line_addr);
-      if (it2 != sequence_bw.end()) {
-        STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_SEEN_DURING_WARMUP);
-        Counter no_pref = 0;
-        Counter unuseful = 0;
-        Counter useful = 0;
-        auto it3 = it2->second.begin();
-        while (it3 != it2->second.end()) {
-          if (it3->first == 'p')
-            no_pref++;
-          else if (it3->first == 'u')
-            useful++;
-          else if (it3->first == 'U')
-            unuseful++;
-          ++it3;
-        }
-        if (no_pref && !unuseful && !useful)
-          STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_NO_PREF_DURING_WARMUP);
-        if (!no_pref && unuseful && !useful)
-          STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_TRAINED_UNUSEFUL_DURING_WARMUP);
-        if (!no_pref && !unuseful && useful)
-          STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_TRAINED_USEFUL_DURING_WARMUP);
-      } else
-        STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_NOT_SEEN_DURING_WARMUP);
-    }
-  } else {
-    it->second.push_back(icache_val);
+  vector<pair<char, Counter>> seq_bw;
+  if (icache_sequence.push(line_addr, icache_val) && icache_val == 2) {
+    if (sequence_bw.get(line_addr, &seq_bw)) {
+      STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_SEEN_DURING_WARMUP);
+      Counter no_pref = 0;
+      Counter unuseful = 0;
+      Counter useful = 0;
+      auto it3 = seq_bw.begin();
+      while (it3 != seq_bw.end()) {
+        if (it3->first == 'p')
+          no_pref++;
+        else if (it3->first == 'u')
+          useful++;
+        else if (it3->first == 'U')
+          unuseful++;
+        ++it3;
+      }
+      if (no_pref && !unuseful && !useful)
+        STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_NO_PREF_DURING_WARMUP);
+      if (!no_pref && unuseful && !useful)
+        STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_TRAINED_UNUSEFUL_DURING_WARMUP);
+      if (!no_pref && !unuseful && useful)
+        STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_TRAINED_USEFUL_DURING_WARMUP);
+    } else
+      STAT_EVENT(proc_id, ICACHE_FIRST_MISS_AFTER_WARMUP_NOT_SEEN_DURING_WARMUP);
   }
 }
 
@@ -732,23 +798,11 @@ void FDIP_Stat::inc_prefetched_cls(Addr line_addr, Flag on_path, uns success) {
         it->second++;
     }
 
-    auto it2 = sequence_aw.find(line_addr);
     Counter onoff_cycle_count = fdip_off_path() ? -cycle_count : cycle_count;
-    if (it2 == sequence_aw.end()) {
-      sequence_aw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_aw[line_addr].push_back(make_pair('P', onoff_cycle_count));
-    } else {
-      it2->second.push_back(make_pair('P', onoff_cycle_count));
-    }
+    sequence_aw.push(line_addr, make_pair('P', onoff_cycle_count));
   } else {
-    auto it2 = sequence_bw.find(line_addr);
     Counter onoff_cycle_count = fdip_off_path() ? -cycle_count : cycle_count;
-    if (it2 == sequence_bw.end()) {
-      sequence_bw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_bw[line_addr].push_back(make_pair('P', onoff_cycle_count));
-    } else {
-      it2->second.push_back(make_pair('P', onoff_cycle_count));
-    }
+    sequence_bw.push(line_addr, make_pair('P', onoff_cycle_count));
   }
 }
 
@@ -760,13 +814,7 @@ void FDIP_Stat::dec_cnt_useful_signed(Addr line_addr) {
     it->second -= UDP_WEIGHT_UNUSEFUL;
 
   uns8 unuseful_value = fdip->get_warmed_up() ? 2 : 0;
-  auto it2 = useful_sequence.find(line_addr);
-  if (it2 == useful_sequence.end()) {
-    useful_sequence.insert(make_pair(line_addr, vector<uns8>()));
-    useful_sequence[line_addr].push_back(unuseful_value);
-  } else {
-    it2->second.push_back(unuseful_value);
-  }
+  useful_sequence.push(line_addr, unuseful_value);
 }
 
 void FDIP_Stat::inc_icache_hit(Addr line_addr) {
@@ -784,13 +832,7 @@ void FDIP_Stat::inc_icache_hit(Addr line_addr) {
     else
       it->second++;
 
-    auto it2 = sequence_aw.find(line_addr);
-    if (it2 == sequence_aw.end()) {
-      sequence_aw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_aw[line_addr].push_back(make_pair('h', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('h', cycle_count));
-    }
+    sequence_aw.push(line_addr, make_pair('h', cycle_count));
 
     if (cur_line_delay) {
       auto it3 = per_line_delay_aw.find(line_addr);
@@ -802,23 +844,11 @@ void FDIP_Stat::inc_icache_hit(Addr line_addr) {
     }
     cur_line_delay = 0;
   } else {
-    auto it2 = sequence_bw.find(line_addr);
-    if (it2 == sequence_bw.end()) {
-      sequence_bw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      sequence_bw[line_addr].push_back(make_pair('h', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('h', cycle_count));
-    }
+    sequence_bw.push(line_addr, make_pair('h', cycle_count));
   }
 
   uns icache_val = fdip->get_warmed_up() ? 3 : 1;
-  auto it = icache_sequence.find(line_addr);
-  if (it == icache_sequence.end()) {
-    icache_sequence.insert(make_pair(line_addr, vector<uns8>()));
-    icache_sequence[line_addr].push_back(icache_val);
-  } else {
-    it->second.push_back(icache_val);
-  }
+  icache_sequence.push(line_addr, icache_val);
 }
 
 /* FDIP member functions */
@@ -897,7 +927,7 @@ void FDIP::update() {
           UNUSED(line_info);
         }
         bool mlc_line = (Inst_Info**)cache_access(&mem->uncores[proc_id].mlc->cache, pc_addr, &dummy_addr, FALSE);
-        bool l1_line = (Inst_Info**)cache_access(&mem->uncores[proc_id].l1->cache, pc_addr, &dummy_addr, FALSE);
+        bool l1_line = (Inst_Info**)cache_access(&mem_l1(proc_id, pc_addr)->cache, pc_addr, &dummy_addr, FALSE);
         UNUSED(dummy_addr);
         uns pref_from = line ? 0 : (mlc_line ? 1 : (l1_line ? 2 : 3));
         STAT_EVENT(proc_id, FDIP_PREFETCH_HIT_ICACHE + pref_from);
@@ -968,9 +998,16 @@ void FDIP::update() {
           } else
             ASSERT(proc_id, false);
           success = Mem_Queue_Req_Result::SUCCESS_NEW;
+        } else if (iprefetch_filter_hit(proc_id, IPREF_FDIP, line_addr)) {
+          // another engine asked for this line recently: count it as merged into that request
+          success = Mem_Queue_Req_Result::SUCCESS_MERGED;
         } else {
           success =
               new_mem_req(mem_type, proc_id, line_addr, ICACHE_LINE_SIZE, 0, NULL, instr_fill_line, unique_count, 0);
+          if (success != Mem_Queue_Req_Result::FAILED) {
+            STAT_EVENT(proc_id, IPREF_ISSUED_FDIP);
+            iprefetch_filter_insert(proc_id, line_addr);
+          }
           // ICACHE_LINE_SIZE, 0, NULL, instr_fill_line, unique_count++, 0); // bug?
           // A buffer entry should be available since it is checked by mem_can_allocate_req_buffer for a new prefetch
           if (success == Mem_Queue_Req_Result::SUCCESS_NEW) {
@@ -1425,21 +1462,9 @@ void FDIP::assert_break_reason(Addr line_addr) {
 
 void FDIP::add_evict_seq(Addr line_addr) {
   if (warmed_up) {
-    auto it2 = fdip_stat.sequence_aw.find(line_addr);
-    if (it2 == fdip_stat.sequence_aw.end()) {
-      fdip_stat.sequence_aw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      fdip_stat.sequence_aw[line_addr].push_back(make_pair('e', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('e', cycle_count));
-    }
+    fdip_stat.sequence_aw.push(line_addr, make_pair('e', cycle_count));
   } else {
-    auto it2 = fdip_stat.sequence_bw.find(line_addr);
-    if (it2 == fdip_stat.sequence_bw.end()) {
-      fdip_stat.sequence_bw.insert(make_pair(line_addr, vector<pair<char, Counter>>()));
-      fdip_stat.sequence_bw[line_addr].push_back(make_pair('e', cycle_count));
-    } else {
-      it2->second.push_back(make_pair('e', cycle_count));
-    }
+    fdip_stat.sequence_bw.push(line_addr, make_pair('e', cycle_count));
   }
 }
 
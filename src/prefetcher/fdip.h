@@ -37,9 +37,9 @@ extern "C" {
 
 void alloc_mem_fdip(uns numProcs);
 void init_fdip(uns proc_id);
-void update_fdip();
+void update_fdip(Core_Context* ctx);
 void recover_fdip();
-void set_fdip(int _proc_id, Icache_Stage* _ic);
+void set_fdip(Core_Context* ctx);
 Flag fdip_off_path();
 uns64 fdip_get_ghist();
 uns64 fdip_hash_addr_ghist(uint64_t addr, uint64_t ghist);
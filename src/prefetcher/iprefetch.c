@@ -0,0 +1,188 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : prefetcher/iprefetch.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Common front door for the instruction prefetchers (FDIP, EIP, D-JOLT,
+ *                FNL+MMA)
+ ***************************************************************************************/
+
+/* The filter is a per-core direct-mapped table of the last lines an instruction prefetcher
+   asked for, tagged with the cycle of the request. A candidate that hits a live entry is
+   dropped before it probes the memory queues: it is either still in flight (and would only
+   merge) or was filled within the last IPREF_FILTER_CYCLES (and would waste L1/MLC bandwidth
+   on a line the icache already holds). A line that a memory fill evicts from the icache
+   leaves the filter, so its refetch is not suppressed. IPREF_FILTER_ENTRIES == 0 disables
+   the filter and every candidate goes straight to new_mem_req as before. */
+
+#include "prefetcher/iprefetch.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "memory/memory.param.h"
+#include "prefetcher/pref.param.h"
+
+#include "debug/host_prof.h"
+#include "memory/memory.h"
+#include "prefetcher/D_JOLT.h"
+#include "prefetcher/FNL+MMA.h"
+#include "prefetcher/eip.h"
+#include "prefetcher/fdip.h"
+
+#include "icache_stage.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Iprefetch_Filter_Entry_struct {
+  Addr line_addr; /* 0 marks an empty slot */
+  Counter cycle;
+} Iprefetch_Filter_Entry;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Iprefetch_Filter_Entry** iprefetch_filter = NULL;
+static uns iprefetch_filter_mask = 0;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static inline Iprefetch_Filter_Entry* iprefetch_filter_entry(uns proc_id, Addr line_addr);
+
+/**************************************************************************************/
+/* Simulator API */
+
+void alloc_mem_iprefetch(uns numProcs) {
+  alloc_mem_fdip(numProcs);
+  alloc_mem_eip(numProcs);
+  alloc_mem_djolt(numProcs);
+  alloc_mem_fnlmma(numProcs);
+
+  if (!IPREF_FILTER_ENTRIES)
+    return;
+  ASSERTM(0, is_power_of_2(IPREF_FILTER_ENTRIES), "IPREF_FILTER_ENTRIES must be a power of two\n");
+  iprefetch_filter_mask = IPREF_FILTER_ENTRIES - 1;
+  iprefetch_filter = (Iprefetch_Filter_Entry**)calloc(numProcs, sizeof(Iprefetch_Filter_Entry*));
+  for (uns proc_id = 0; proc_id < numProcs; proc_id++)
+    iprefetch_filter[proc_id] =
+        (Iprefetch_Filter_Entry*)calloc(IPREF_FILTER_ENTRIES, sizeof(Iprefetch_Filter_Entry));
+}
+
+void init_iprefetch(uns proc_id) {
+  init_fdip(proc_id);
+  init_eip(proc_id);
+  init_djolt(proc_id);
+  init_fnlmma(proc_id);
+}
+
+void set_iprefetch(Core_Context* ctx) {
+  set_eip(ctx);
+  set_djolt(ctx);
+  set_fnlmma(ctx);
+  set_fdip(ctx);
+}
+
+uns64 update_iprefetch(Core_Context* ctx, uns64 prof_t) {
+  update_fdip(ctx);
+  prof_t = host_prof_lap(ctx->proc_id, HOST_PROF_FDIP, prof_t);
+  update_eip(ctx);
+  return host_prof_lap(ctx->proc_id, HOST_PROF_EIP, prof_t);
+}
+
+/**************************************************************************************/
+/* Training */
+
+void iprefetch_train_icache_access(uns proc_id, Addr fetch_addr, Flag icache_hit, Flag off_path) {
+  if (EIP_ENABLE)
+    eip_prefetch(proc_id, fetch_addr, icache_hit, 0, off_path);
+  if (DJOLT_ENABLE)
+    djolt_prefetch(proc_id, fetch_addr, icache_hit, 0);
+  if (FNLMMA_ENABLE)
+    fnlmma_prefetch(proc_id, fetch_addr, icache_hit, 0);
+}
+
+void iprefetch_train_branch(uns proc_id, Addr branch_addr, uns8 cf_type, Addr target) {
+  if (DJOLT_ENABLE)
+    update_djolt(proc_id, branch_addr, cf_type, target);
+}
+
+void iprefetch_train_icache_fill(uns proc_id, Addr line_addr, Addr evicted_line_addr) {
+  if (EIP_ENABLE)
+    eip_cache_fill(proc_id, line_addr, evicted_line_addr);
+}
+
+void iprefetch_icache_evict(uns proc_id, Addr evicted_line_addr) {
+  if (!iprefetch_filter || !evicted_line_addr)
+    return;
+  Iprefetch_Filter_Entry* entry = iprefetch_filter_entry(proc_id, evicted_line_addr);
+  if (entry->line_addr == evicted_line_addr)
+    entry->line_addr = 0;
+}
+
+/**************************************************************************************/
+/* Shared recently-requested filter */
+
+static inline Iprefetch_Filter_Entry* iprefetch_filter_entry(uns proc_id, Addr line_addr) {
+  Addr line = line_addr >> LOG2(ICACHE_LINE_SIZE);
+  return &iprefetch_filter[proc_id][(line ^ (line >> 16)) & iprefetch_filter_mask];
+}
+
+Flag iprefetch_filter_hit(uns proc_id, Iprefetch_Engine engine, Addr line_addr) {
+  if (!iprefetch_filter)
+    return FALSE;
+  line_addr &= ~(Addr)(ICACHE_LINE_SIZE - 1);
+  Iprefetch_Filter_Entry* entry = iprefetch_filter_entry(proc_id, line_addr);
+  if (entry->line_addr != line_addr || cycle_count - entry->cycle >= IPREF_FILTER_CYCLES)
+    return FALSE;
+  STAT_EVENT(proc_id, IPREF_FILTERED_FDIP + engine);
+  return TRUE;
+}
+
+void iprefetch_filter_insert(uns proc_id, Addr line_addr) {
+  if (!iprefetch_filter)
+    return;
+  line_addr &= ~(Addr)(ICACHE_LINE_SIZE - 1);
+  Iprefetch_Filter_Entry* entry = iprefetch_filter_entry(proc_id, line_addr);
+  entry->line_addr = line_addr;
+  entry->cycle = cycle_count;
+}
+
+Mem_Queue_Req_Result iprefetch_issue(uns proc_id, Iprefetch_Engine engine, Addr line_addr) {
+  if (iprefetch_filter_hit(proc_id, engine, line_addr))
+    return FAILED;
+  Mem_Queue_Req_Result result = (Mem_Queue_Req_Result)new_mem_req(MRT_IPRF, proc_id, line_addr, ICACHE_LINE_SIZE, 0,
+                                                                   NULL, instr_fill_line, unique_count, 0);
+  if (result != FAILED) {
+    STAT_EVENT(proc_id, IPREF_ISSUED_FDIP + engine);
+    iprefetch_filter_insert(proc_id, line_addr);
+  }
+  return result;
+}
@@ -0,0 +1,82 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : prefetcher/iprefetch.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Common front door for the instruction prefetchers (FDIP, EIP, D-JOLT,
+ *                FNL+MMA). The icache stage and the core loop talk only to this
+ *                interface; it broadcasts training events to the enabled engines and
+ *                dedups their candidate lines through one shared recently-requested
+ *                filter before they reach the memory system.
+ ***************************************************************************************/
+
+#ifndef __IPREFETCH_H__
+#define __IPREFETCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "globals/global_types.h"
+
+#include "memory/memory.h"
+
+#include "core_context.h"
+
+typedef enum Iprefetch_Engine_enum {
+  IPREF_FDIP,
+  IPREF_EIP,
+  IPREF_DJOLT,
+  IPREF_FNLMMA,
+  IPREF_NUM_ENGINES,
+} Iprefetch_Engine;
+
+/* Simulator API: forwarded to every instruction prefetcher */
+void alloc_mem_iprefetch(uns numProcs);
+void init_iprefetch(uns proc_id);
+void set_iprefetch(Core_Context* ctx);
+/* per-cycle update of the engines that run ahead of fetch; returns the host_prof tick of
+   its last lap so the caller can keep chaining host_prof_lap() */
+uns64 update_iprefetch(Core_Context* ctx, uns64 prof_t);
+
+/* Training broadcasts, each delivered once to every enabled engine */
+void iprefetch_train_icache_access(uns proc_id, Addr fetch_addr, Flag icache_hit, Flag off_path);
+void iprefetch_train_branch(uns proc_id, Addr branch_addr, uns8 cf_type, Addr target);
+void iprefetch_train_icache_fill(uns proc_id, Addr line_addr, Addr evicted_line_addr);
+/* a line fetched from the memory system replaced evicted_line_addr (0 if none) in the icache */
+void iprefetch_icache_evict(uns proc_id, Addr evicted_line_addr);
+
+/* Shared recently-requested filter (IPREF_FILTER_ENTRIES) */
+Flag iprefetch_filter_hit(uns proc_id, Iprefetch_Engine engine, Addr line_addr);
+void iprefetch_filter_insert(uns proc_id, Addr line_addr);
+
+/* Issue a MRT_IPRF request for line_addr on behalf of engine unless the line was requested
+   recently. Returns the Mem_Queue_Req_Result of new_mem_req (FAILED when filtered). */
+Mem_Queue_Req_Result iprefetch_issue(uns proc_id, Iprefetch_Engine engine, Addr line_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef __IPREFETCH_H__ */
@@ -61,7 +61,7 @@
 /* Global Variables */
 
 extern Memory* mem;
-extern Dcache_Stage* dc;
+extern CORE_LOCAL Dcache_Stage* dc;
 static Cache* l1_cache;
 
 /***************************************************************************************/
@@ -80,6 +80,7 @@ Counter last_hps_hit;
 void init_prefetch(void) {
   if (model->mem == MODEL_MEM) {
     ASSERTM(0, !PRIVATE_L1, "L2L1 Prefetcher assumes shared L1\n");
+    ASSERTM(0, L1_SLICES == 1, "L2L1 Prefetcher assumes an unsliced L1\n");
     l1_cache = &mem->uncores[0].l1->cache;
   }
 
@@ -102,8 +103,7 @@ void l2l1_init(void) {
 
 void l2l1pref_mem(Mem_Req* req) {
   Mem_Req_Info mem_req_info;
-  Op** op_p = (Op**)list_start_head_traversal(&req->op_ptrs);
-  Op* op = op_p ? *op_p : NULL;
+  Op* op = req->op_ptrs.count ? RING_AT(&req->op_ptrs, Op*, 0) : NULL;
   mem_req_info.addr = req->addr;
   mem_req_info.type = (Mem_Req_Type)req->type;  // FIXME !!
   mem_req_info.oldest_op_unique_num = req->oldest_op_unique_num;
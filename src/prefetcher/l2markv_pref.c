@@ -56,7 +56,7 @@
 /**************************************************************************************/
 /* Global Variables */
 
-extern Dcache_Stage* dc;
+extern CORE_LOCAL Dcache_Stage* dc;
 
 /***************************************************************************************/
 /* Local Prototypes */
@@ -108,7 +108,7 @@ int l2markv_pref_train(Mem_Req_Info* req) {
   Addr tag;
   Addr line_addr;
   Addr addr = req->addr;
-  Cache* cache = &mem->uncores[req->proc_id].l1->cache;
+  Cache* cache = &mem_l1(req->proc_id, addr)->cache;
 
   uns set = cache_index_l(cache, addr, &tag, &line_addr);
   uns ii;
@@ -338,7 +338,7 @@ void l2next_pref(Mem_Req_Info* req) {
       STAT_EVENT(0, L2NEXT_PREF_REQ);
     } else {
       uns bank = req_va >> dc->dcache.shift_bits & N_BIT_MASK(LOG2(DCACHE_BANKS));
-      Cache* l1_cache = &mem->uncores[req->proc_id].l1->cache;
+      Cache* l1_cache = &mem_l1(req->proc_id, req_va)->cache;
       L1_Data* l1_data = cache_access(l1_cache, req_va, &line_addr, FALSE);
 
       if (l1_data) {                                                                // hit l1 cache
@@ -57,7 +57,7 @@
 /* Global Variables */
 
 extern Memory* mem;
-extern Dcache_Stage* dc;
+extern CORE_LOCAL Dcache_Stage* dc;
 
 /***************************************************************************************/
 /* Local Prototypes */
@@ -91,6 +91,7 @@ void l2way_init(void) {
 
   if (model->mem == MODEL_MEM) {
     ASSERTM(0, !PRIVATE_L1, "L2 Way Prefetcher assumes shared L1\n");
+    ASSERTM(0, L1_SLICES == 1, "L2 Way Prefetcher assumes an unsliced L1\n");
     l1_cache = &mem->uncores[0].l1->cache;
   }
 }
@@ -0,0 +1,221 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : prefetcher/pref_bw_throttle.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Global bandwidth-aware throttling of all prefetchers from interval
+ *                samples of DRAM utilization, prefetch accuracy and demand latency
+ ***************************************************************************************/
+
+#include "prefetcher/pref_bw_throttle.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "core.param.h"
+#include "general.param.h"
+#include "prefetcher/pref.param.h"
+#include "ramulator.param.h"
+
+#include "freq.h"
+#include "stat_mon.h"
+#include "statistics.h"
+
+/*
+   Every PREF_BW_THROTTLE_INTERVAL cycles the controller looks at the whole chip at once:
+   DRAM utilization (data bursts over the channel time of the interval), the average
+   demand L1 miss latency, each core's share of the bursts and the accuracy of every
+   enabled prefetcher on every core. It then moves each (prefetcher, core) level in
+   dyn_degree_core one step, between 0 and PREF_MAX_DEGFB:
+
+     DRAM saturated      : inaccurate prefetchers step down, and so do the mediocre ones
+                           of cores that use more than their share of the bursts
+     DRAM lightly loaded : every prefetcher that is not inaccurate steps up
+     in between          : accurate ones step up, inaccurate ones step down
+
+   Prefetchers that read dyn_degree_core themselves (stream and GHB) map the level to
+   their own degree and distance tables. For all other prefetchers the request queues
+   admit (level + 1) of every PREF_MAX_DEGFB + 1 requests, so their levels start at
+   PREF_MAX_DEGFB, which admits everything.
+*/
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_PREF, ##args)
+
+/**************************************************************************************/
+/* Global variables */
+
+static Stat_Mon* bw_throttle_stat_mon;
+static Counter bw_throttle_last_cycle;
+static Counter bw_throttle_last_time;
+static Counter* bw_throttle_last_sent;    // [prefetcher id * NUM_CORES + proc_id]
+static Counter* bw_throttle_last_useful;  // [prefetcher id * NUM_CORES + proc_id]
+static uns* bw_throttle_admit_seq;        // [prefetcher id * NUM_CORES + proc_id]
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static void pref_bw_throttle_level(HWP_Info* hwp_info, uns8 proc_id, Flag saturated, Flag light, Flag hog);
+
+/**************************************************************************************/
+/* pref_bw_throttle_init: */
+
+void pref_bw_throttle_init(HWP* table, uns table_size) {
+  if (!PREF_BW_THROTTLE_ON)
+    return;
+  ASSERTM(0, PREF_BW_THROTTLE_INTERVAL > 0, "PREF_BW_THROTTLE_INTERVAL must be positive\n");
+
+  Stat_Enum monitored_stats[] = {
+      POWER_DRAM_READ,
+      POWER_DRAM_WRITE,
+      CORE_L1_DEMAND_FILL,
+      CORE_L1_MISS_LATENCY_DEMAND,
+  };
+  bw_throttle_stat_mon = stat_mon_create_from_array(monitored_stats, NUM_ELEMENTS(monitored_stats));
+  bw_throttle_last_cycle = cycle_count;
+  bw_throttle_last_time = freq_time();
+
+  bw_throttle_last_sent = (Counter*)calloc(table_size * NUM_CORES, sizeof(Counter));
+  bw_throttle_last_useful = (Counter*)calloc(table_size * NUM_CORES, sizeof(Counter));
+  bw_throttle_admit_seq = (uns*)calloc(table_size * NUM_CORES, sizeof(uns));
+
+  for (uns ii = 0; ii < table_size; ii++) {
+    HWP_Info* hwp_info = table[ii].hwp_info;
+    if (hwp_info->dyn_degree_user)
+      continue;
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      hwp_info->dyn_degree_core[proc_id] = PREF_MAX_DEGFB;
+  }
+}
+
+/**************************************************************************************/
+/* pref_bw_throttle_update: */
+
+void pref_bw_throttle_update(HWP* table, uns table_size) {
+  if (!PREF_BW_THROTTLE_ON || cycle_count - bw_throttle_last_cycle < PREF_BW_THROTTLE_INTERVAL)
+    return;
+
+  Counter now = freq_time();
+  Counter bursts[MAX_NUM_PROCS];
+  Counter total_bursts = 0, total_fills = 0, total_latency = 0;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    bursts[proc_id] = stat_mon_get_count(bw_throttle_stat_mon, proc_id, POWER_DRAM_READ) +
+                      stat_mon_get_count(bw_throttle_stat_mon, proc_id, POWER_DRAM_WRITE);
+    total_bursts += bursts[proc_id];
+    total_fills += stat_mon_get_count(bw_throttle_stat_mon, proc_id, CORE_L1_DEMAND_FILL);
+    total_latency += stat_mon_get_count(bw_throttle_stat_mon, proc_id, CORE_L1_MISS_LATENCY_DEMAND);
+  }
+
+  // a burst holds a channel's data bus for tBL DRAM clocks
+  double channel_time = (double)(now - bw_throttle_last_time) * RAMULATOR_CHANNELS;
+  double util = channel_time ? (double)total_bursts * RAMULATOR_TBL * RAMULATOR_TCK / channel_time : 0.0;
+  double latency = total_fills ? (double)total_latency / total_fills : 0.0;
+  Flag saturated = util > PREF_BW_THROTTLE_BW_HIGH || latency > PREF_BW_THROTTLE_LAT_HIGH;
+  Flag light = !saturated && util < PREF_BW_THROTTLE_BW_LOW;
+
+  STAT_EVENT(0, PREF_BW_THROTTLE_INTERVALS);
+  if (saturated)
+    STAT_EVENT(0, PREF_BW_THROTTLE_SATURATED);
+  DEBUG(0, "interval  util:%.3f  demand latency:%.1f  saturated:%d\n", util, latency, saturated);
+
+  for (uns ii = 0; ii < table_size; ii++) {
+    HWP_Info* hwp_info = table[ii].hwp_info;
+    if (!hwp_info->enabled)
+      continue;
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      Flag hog = total_bursts && bursts[proc_id] * NUM_CORES > total_bursts;
+      pref_bw_throttle_level(hwp_info, proc_id, saturated, light, hog);
+    }
+  }
+
+  stat_mon_reset(bw_throttle_stat_mon);
+  bw_throttle_last_cycle = cycle_count;
+  bw_throttle_last_time = now;
+}
+
+/**************************************************************************************/
+/* pref_bw_throttle_level: moves one prefetcher's level on one core by a step */
+
+static void pref_bw_throttle_level(HWP_Info* hwp_info, uns8 proc_id, Flag saturated, Flag light, Flag hog) {
+  uns idx = hwp_info->id * NUM_CORES + proc_id;
+  Counter sent = hwp_info->curr_sent_core[proc_id];
+  Counter useful = hwp_info->curr_useful_core[proc_id];
+  // pref_feed_back_info_update clears the curr_ counts every PREF_UPDATE_INTERVAL evictions
+  Counter d_sent = sent >= bw_throttle_last_sent[idx] ? sent - bw_throttle_last_sent[idx] : sent;
+  Counter d_useful = useful >= bw_throttle_last_useful[idx] ? useful - bw_throttle_last_useful[idx] : useful;
+  bw_throttle_last_sent[idx] = sent;
+  bw_throttle_last_useful[idx] = useful;
+
+  uns* level = &hwp_info->dyn_degree_core[proc_id];
+  Flag inc = FALSE, dec = FALSE;
+  if (d_sent < PREF_BW_THROTTLE_MIN_SENT) {
+    // too few prefetches to judge, and too few to matter for bandwidth
+    inc = !saturated;
+  } else {
+    float acc = (float)d_useful / d_sent;
+    if (saturated)
+      dec = acc < PREF_BW_THROTTLE_ACC_LOW || (hog && acc < PREF_BW_THROTTLE_ACC_HIGH);
+    else if (light)
+      inc = acc >= PREF_BW_THROTTLE_ACC_LOW;
+    else {
+      inc = acc >= PREF_BW_THROTTLE_ACC_HIGH;
+      dec = acc < PREF_BW_THROTTLE_ACC_LOW;
+    }
+  }
+
+  if (inc && *level < PREF_MAX_DEGFB) {
+    (*level)++;
+    STAT_EVENT(proc_id, PREF_BW_THROTTLE_INC);
+  } else if (dec && *level > 0) {
+    (*level)--;
+    STAT_EVENT(proc_id, PREF_BW_THROTTLE_DEC);
+  }
+  DEBUG(proc_id, "prefetcher:%u  sent:%s  useful:%s  hog:%d  level:%u\n", hwp_info->id, unsstr64(d_sent),
+        unsstr64(d_useful), hog, *level);
+}
+
+/**************************************************************************************/
+/* pref_bw_throttle_admit: */
+
+Flag pref_bw_throttle_admit(HWP_Info* hwp_info, uns8 proc_id) {
+  if (hwp_info->dyn_degree_user)
+    return TRUE;
+  uns* seq = &bw_throttle_admit_seq[hwp_info->id * NUM_CORES + proc_id];
+  uns slot = *seq;
+  *seq = (slot + 1) % (PREF_MAX_DEGFB + 1);
+  if (slot <= hwp_info->dyn_degree_core[proc_id])
+    return TRUE;
+  STAT_EVENT(proc_id, PREF_BW_THROTTLE_DROPPED);
+  return FALSE;
+}
@@ -0,0 +1,48 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : prefetcher/pref_bw_throttle.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Global bandwidth-aware throttling of all prefetchers from interval
+ *                samples of DRAM utilization, prefetch accuracy and demand latency
+ ***************************************************************************************/
+#ifndef __PREF_BW_THROTTLE_H__
+#define __PREF_BW_THROTTLE_H__
+
+#include "pref_common.h"
+
+/*************************************************************/
+/* Prototypes */
+
+/* Call once all prefetchers are initialized */
+void pref_bw_throttle_init(HWP* table, uns table_size);
+
+/* Called every pref_update; re-levels all prefetchers once per PREF_BW_THROTTLE_INTERVAL */
+void pref_bw_throttle_update(HWP* table, uns table_size);
+
+/* FALSE if a request of a prefetcher that does not read dyn_degree_core itself should be dropped */
+Flag pref_bw_throttle_admit(HWP_Info* hwp_info, uns8 proc_id);
+
+#endif /* #ifndef __PREF_BW_THROTTLE_H__ */
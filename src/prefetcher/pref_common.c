@@ -38,12 +38,14 @@
 #include "debug/debug.param.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/host_prof.h"
 
 #include "core.param.h"
 #include "general.param.h"
 #include "memory/memory.param.h"
 #include "prefetcher//stream.param.h"
 #include "prefetcher/pref.param.h"
+#include "prefetcher/pref_ppf.param.h"
 
 #include "libs/cache_lib.h"
 #include "libs/hash_lib.h"
@@ -54,13 +56,19 @@
 #include "prefetcher//pref_stridepc.h"
 #include "prefetcher/l2l1pref.h"
 #include "prefetcher/pref_2dc.h"
+#include "prefetcher/pref_bw_throttle.h"
 #include "prefetcher/pref_ghb.h"
 #include "prefetcher/pref_markov.h"
 #include "prefetcher/pref_phase.h"
+#include "prefetcher/pref_ppf.h"
+#include "prefetcher/pref_sms.h"
+#include "prefetcher/pref_triage.h"
 
 #include "cmp_model.h"
 #include "dcache_stage.h"
 #include "op.h"
+#include "optimizer2.h"
+#include "sim.h"
 #include "statistics.h"
 /**************************************************************************************
  * Usage Notes
@@ -73,6 +81,11 @@
 
 static int pref_table_size;
 
+/* PREF_OPT2: the prefetchers enabled at init; bit i of a config disables the i-th one */
+#define PREF_OPT2_MAX_HWPS 8
+static HWP_Info* pref_opt2_hwps[PREF_OPT2_MAX_HWPS];
+static uns pref_opt2_num_hwps;
+
 /**************************************************************************************/
 /* Macros */
 #define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_PREF, ##args)
@@ -81,7 +94,7 @@ static int pref_table_size;
 /* Global Variables */
 
 extern Memory* mem;
-extern Dcache_Stage* dc;
+extern CORE_LOCAL Dcache_Stage* dc;
 
 HWP_Common pref;
 
@@ -94,6 +107,10 @@ static void pref_update_core(uns proc_id);
 static void pref_polbv_update_on_evict(uns8 pref_proc_id, uns8 evicted_proc_id, Addr evicted_addr);
 static void pref_polbv_lookup_on_miss(uns8 proc_id, Addr addr);
 static void pref_polbv_update_on_repref(uns8 proc_id, Addr addr);
+static void pref_train(uns8 proc_id, Pref_Train_Type type, Addr line_addr, Addr load_PC, uns32 global_hist);
+static void pref_train_flush(void);
+static void pref_opt2_init(void);
+static void pref_opt2_set_config(int config);
 void pref_feed_back_info_update(uns8 prefetcher_id);
 /***************************************************************************************/
 /* supporting functions */
@@ -109,11 +126,59 @@ int pref_compare_prefloadhash(const void* const a, const void* const b) {
   return ((*dataB)->count - (*dataA)->count);
 }
 
+/***************************************************************************************/
+/* request queue line hash */
+
+/* Each queue slot is chained into the bucket of its line. Slots stay chained after
+   they are invalidated because the add filters also match invalid requests. */
+static void pref_queue_lines_init(Pref_Queue_Lines* lines, uns queue_size) {
+  uns buckets = 1 << (LOG2(2 * queue_size - 1) + 1);
+  lines->bucket_head = (int*)malloc(buckets * sizeof(int));
+  lines->next_slot = (int*)malloc(queue_size * sizeof(int));
+  for (uns ii = 0; ii < buckets; ii++)
+    lines->bucket_head[ii] = -1;
+  lines->mask = buckets - 1;
+}
+
+static inline uns pref_queue_lines_bucket(const Pref_Queue_Lines* lines, Addr line_index) {
+  return (line_index ^ (line_index >> 17) ^ (line_index >> 34)) & lines->mask;
+}
+
+/* returns the first slot holding line_index (only valid requests if valid_only), or
+   -1 when there is none, i.e. what a scan of the queue from slot 0 finds */
+static int pref_queue_find(const Pref_Queue_Lines* lines, const Pref_Mem_Req* queue, Addr line_index,
+                           Flag valid_only) {
+  int found = -1;
+  for (int slot = lines->bucket_head[pref_queue_lines_bucket(lines, line_index)]; slot >= 0;
+       slot = lines->next_slot[slot]) {
+    if (queue[slot].line_index == line_index && (queue[slot].valid || !valid_only) && (found < 0 || slot < found))
+      found = slot;
+  }
+  return found;
+}
+
+/* writes a new request into a queue slot and moves the slot to its new bucket */
+static void pref_queue_write(Pref_Queue_Lines* lines, Pref_Mem_Req* queue, int slot, const Pref_Mem_Req* new_req) {
+  if (queue[slot].line_index) {
+    int* link = &lines->bucket_head[pref_queue_lines_bucket(lines, queue[slot].line_index)];
+    while (*link != slot)
+      link = &lines->next_slot[*link];
+    *link = lines->next_slot[slot];
+  }
+  queue[slot] = *new_req;
+  uns bucket = pref_queue_lines_bucket(lines, new_req->line_index);
+  lines->next_slot[slot] = lines->bucket_head[bucket];
+  lines->bucket_head[bucket] = slot;
+}
+
 void pref_core_init(HWP_Core* pref_core) {
   // initialize queues
   pref_core->dl0req_queue = (Pref_Mem_Req*)calloc(PREF_DL0REQ_QUEUE_SIZE, sizeof(Pref_Mem_Req));
   pref_core->umlc_req_queue = (Pref_Mem_Req*)calloc(PREF_UMLC_REQ_QUEUE_SIZE, sizeof(Pref_Mem_Req));
   pref_core->ul1req_queue = (Pref_Mem_Req*)calloc(PREF_UL1REQ_QUEUE_SIZE, sizeof(Pref_Mem_Req));
+  pref_queue_lines_init(&pref_core->dl0req_queue_lines, PREF_DL0REQ_QUEUE_SIZE);
+  pref_queue_lines_init(&pref_core->umlc_req_queue_lines, PREF_UMLC_REQ_QUEUE_SIZE);
+  pref_queue_lines_init(&pref_core->ul1req_queue_lines, PREF_UL1REQ_QUEUE_SIZE);
 
   pref_core->dl0req_queue_req_pos = -1;
   pref_core->dl0req_queue_send_pos = 0;
@@ -147,7 +212,7 @@ void pref_init(void) {
   }
 
   for (ii = 0; ii < pref_table_size; ii++) {
-    uns8 proc_id;
+    uns proc_id;
 
     pref_table[ii].hwp_info = (HWP_Info*)malloc(sizeof(HWP_Info));
     pref_table[ii].hwp_info->id = ii;
@@ -171,13 +236,21 @@ void pref_init(void) {
       pref_table[ii].hwp_info->dyn_degree_core[proc_id] = 2;
     }
 
+    pref_table[ii].hwp_info->dyn_degree_user = FALSE;
+
     pref_table[ii].hwp_info->priority = 0;
     pref_table[ii].hwp_info->enabled = FALSE;
+    pref_table[ii].hwp_info->train_events = 0;
+    pref_table[ii].hwp_info->train_ticks = 0;
 
     if (pref_table[ii].init_func)
       pref_table[ii].init_func(&pref_table[ii]);
   }
   qsort(pref_table, pref_table_size, sizeof(HWP), pref_compare_hwp_priority);
+  pref_bw_throttle_init(pref_table, pref_table_size);
+  pref_ppf_init();
+  if (PREF_OPT2)
+    pref_opt2_init();
 
   if (PREF_TRACE_ON)
     PREF_TRACE_OUT = file_tag_fopen(NULL, pref_trace_filename, "w");
@@ -210,6 +283,9 @@ void pref_init(void) {
   }
 
   pref.phase = 0;
+
+  if (PREF_TRAIN_BATCH)
+    pref.train_events = (Pref_Train_Event*)calloc(PREF_TRAIN_BATCH, sizeof(Pref_Train_Event));
 }
 
 void pref_per_core_done(uns proc_id) {
@@ -242,6 +318,124 @@ void pref_done(void) {
       pref_table[ii].done_func();
     }
   }
+  if (HOST_PROF) {
+    fprintf(mystdout, "** Prefetcher host time (training)\n");
+    fprintf(mystdout, "   %-12s %12s %12s %10s\n", "prefetcher", "events", "ns/event", "seconds");
+    for (ii = 0; ii < pref_table_size; ii++) {
+      HWP_Info* info = pref_table[ii].hwp_info;
+      if (!info->enabled)
+        continue;
+      double ns = host_prof_ticks_to_ns(info->train_ticks);
+      fprintf(mystdout, "   %-12s %12s %12.1f %10.3f\n", pref_table[ii].name, unsstr64(info->train_events),
+              info->train_events ? ns / info->train_events : 0.0, ns / 1e9);
+    }
+  }
+}
+
+/***************************************************************************************/
+/* training */
+
+/* hands the events to one prefetcher (train_batch_func or one call per event) */
+/**************************************************************************************/
+/* pref_opt2_init: explore the subsets of the enabled prefetchers with optimizer2 */
+
+static void pref_opt2_init(void) {
+  pref_opt2_num_hwps = 0;
+  for (int ii = 0; ii < pref_table_size; ii++) {
+    if (!pref_table[ii].hwp_info->enabled)
+      continue;
+    ASSERTM(0, pref_opt2_num_hwps < PREF_OPT2_MAX_HWPS, "PREF_OPT2 supports at most %d prefetchers\n",
+            PREF_OPT2_MAX_HWPS);
+    pref_opt2_hwps[pref_opt2_num_hwps++] = pref_table[ii].hwp_info;
+  }
+  ASSERTM(0, pref_opt2_num_hwps > 0, "PREF_OPT2 needs at least one enabled prefetcher\n");
+
+  static Opt2_Client opt2_client = {"prefetcher", 0, &pref_opt2_set_config, NULL, NULL, NULL};
+  opt2_client.num_configs = 1 << pref_opt2_num_hwps;
+  opt2_client.start = PREF_OPT2_START;
+  opt2_client.period = PREF_OPT2_PERIOD;
+  opt2_client_init(&opt2_client);
+}
+
+/**************************************************************************************/
+/* pref_opt2_set_config: */
+
+static void pref_opt2_set_config(int config) {
+  for (uns ii = 0; ii < pref_opt2_num_hwps; ii++)
+    pref_opt2_hwps[ii]->enabled = !(config & (1 << ii));
+}
+
+static void pref_train_hwp(HWP* hwp, const Pref_Train_Event* events, uns num_events) {
+  uns64 prof_t = operating_mode == SIMULATION_MODE ? host_prof_now() : 0;
+
+  if (hwp->train_batch_func) {
+    hwp->train_batch_func(events, num_events);
+  } else {
+    for (uns ii = 0; ii < num_events; ii++) {
+      const Pref_Train_Event* e = &events[ii];
+      void (*func)(uns8, Addr, Addr, uns32) = NULL;
+      switch (e->type) {
+        case PREF_TRAIN_UMLC_MISS:
+          func = hwp->umlc_miss_func;
+          break;
+        case PREF_TRAIN_UMLC_HIT:
+          func = hwp->umlc_hit_func;
+          break;
+        case PREF_TRAIN_UMLC_PREF_HIT:
+          func = hwp->umlc_pref_hit;
+          break;
+        case PREF_TRAIN_UL1_MISS:
+          func = hwp->ul1_miss_func;
+          break;
+        case PREF_TRAIN_UL1_HIT:
+          func = hwp->ul1_hit_func;
+          break;
+        case PREF_TRAIN_UL1_PREF_HIT:
+          func = hwp->ul1_pref_hit;
+          break;
+      }
+      if (func) {
+        pref.train_line_addr = e->line_addr;
+        pref.train_load_PC = e->load_PC;
+        func(e->proc_id, e->line_addr, e->load_PC, e->global_hist);
+      }
+    }
+    pref.train_line_addr = 0;
+    pref.train_load_PC = 0;
+  }
+
+  if (HOST_PROF && operating_mode == SIMULATION_MODE) {
+    hwp->hwp_info->train_events += num_events;
+    hwp->hwp_info->train_ticks += host_prof_now() - prof_t;
+  }
+}
+
+/* With PREF_TRAIN_BATCH, simulation mode events wait for the next pref_update so that
+   each prefetcher runs through the whole batch at once. Warmup has no pref_update and
+   trains right away. */
+static void pref_train(uns8 proc_id, Pref_Train_Type type, Addr line_addr, Addr load_PC, uns32 global_hist) {
+  Pref_Train_Event event = {line_addr, load_PC, global_hist, proc_id, type};
+
+  if (PREF_TRAIN_BATCH && operating_mode == SIMULATION_MODE) {
+    pref.train_events[pref.num_train_events++] = event;
+    if (pref.num_train_events == PREF_TRAIN_BATCH)
+      pref_train_flush();
+    return;
+  }
+  for (uns ii = 0; ii < pref_table_size; ii++) {
+    if (pref_table[ii].hwp_info->enabled)
+      pref_train_hwp(&pref_table[ii], &event, 1);
+  }
+}
+
+static void pref_train_flush(void) {
+  if (!pref.num_train_events)
+    return;
+  for (uns ii = 0; ii < pref_table_size; ii++) {
+    if (pref_table[ii].hwp_info->enabled)
+      pref_train_hwp(&pref_table[ii], pref.train_events, pref.num_train_events);
+  }
+  pref.num_train_events = 0;
 }
 
 // FIXME LATER
@@ -290,7 +484,6 @@ void pref_dl0_pref_hit(Addr line_addr, Addr load_PC, uns8 prefetcher_id) {
 }
 
 void pref_umlc_miss(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist) {
-  int ii;
   if (!PREF_FRAMEWORK_ON)
     return;
   if (!PREF_UMLC_ON || !MLC_PRESENT)
@@ -306,15 +499,13 @@ void pref_umlc_miss(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_his
     pref_polbv_lookup_on_miss(proc_id, line_addr);
   }
 
-  for (ii = 0; ii < pref_table_size; ii++) {
-    if (pref_table[ii].hwp_info->enabled && pref_table[ii].umlc_miss_func) {
-      pref_table[ii].umlc_miss_func(proc_id, line_addr, load_PC, global_hist);
-    }
-  }
+  if (PREF_PPF_ON)
+    pref_ppf_train_miss(proc_id, line_addr);
+
+  pref_train(proc_id, PREF_TRAIN_UMLC_MISS, line_addr, load_PC, global_hist);
 }
 
 void pref_umlc_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist) {
-  int ii;
   if (!PREF_FRAMEWORK_ON)
     return;
   if (!PREF_UMLC_ON || !MLC_PRESENT)
@@ -323,11 +514,7 @@ void pref_umlc_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist
     fprintf(PREF_TRACE_OUT, "%s \t %s \t %s \t %s\n", hexstr64s(cycle_count), hexstr64s(0), hexstr64s(line_addr),
             "UMLC_HIT");
 
-  for (ii = 0; ii < pref_table_size; ii++) {
-    if (pref_table[ii].hwp_info->enabled && pref_table[ii].umlc_hit_func) {
-      pref_table[ii].umlc_hit_func(proc_id, line_addr, load_PC, global_hist);
-    }
-  }
+  pref_train(proc_id, PREF_TRAIN_UMLC_HIT, line_addr, load_PC, global_hist);
 }
 
 void pref_umlc_pref_hit_late(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist, uns8 prefetcher_id) {
@@ -344,7 +531,6 @@ void pref_umlc_pref_hit_late(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 g
 
 void pref_umlc_pref_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist, int lru_position,
                         uns8 prefetcher_id) {
-  int ii;
   if (prefetcher_id == 0)
     return;
 
@@ -359,15 +545,10 @@ void pref_umlc_pref_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global
 
   pref_table[prefetcher_id].hwp_info->curr_useful_core[proc_id]++;
 
-  for (ii = 0; ii < pref_table_size; ii++) {
-    if (pref_table[ii].hwp_info->enabled && pref_table[ii].umlc_pref_hit) {
-      pref_table[ii].umlc_pref_hit(proc_id, line_addr, load_PC, global_hist);
-    }
-  }
+  pref_train(proc_id, PREF_TRAIN_UMLC_PREF_HIT, line_addr, load_PC, global_hist);
 }
 
 void pref_ul1_miss(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist) {
-  int ii;
   if (!PREF_FRAMEWORK_ON)
     return;
   if (!PREF_UL1_ON)
@@ -388,15 +569,13 @@ void pref_ul1_miss(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist
     pref_polbv_lookup_on_miss(proc_id, line_addr);
   }
 
-  for (ii = 0; ii < pref_table_size; ii++) {
-    if (pref_table[ii].hwp_info->enabled && pref_table[ii].ul1_miss_func) {
-      pref_table[ii].ul1_miss_func(proc_id, line_addr, load_PC, global_hist);
-    }
-  }
+  if (PREF_PPF_ON)
+    pref_ppf_train_miss(proc_id, line_addr);
+
+  pref_train(proc_id, PREF_TRAIN_UL1_MISS, line_addr, load_PC, global_hist);
 }
 
 void pref_ul1_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist) {
-  int ii;
   if (!PREF_FRAMEWORK_ON)
     return;
   if (!PREF_UL1_ON)
@@ -407,11 +586,7 @@ void pref_ul1_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist)
     fprintf(PREF_TRACE_OUT, "%s \t %s \t %s \t %s\n", hexstr64s(cycle_count), hexstr64s(0), hexstr64s(line_addr),
             "UL1_HIT");
 
-  for (ii = 0; ii < pref_table_size; ii++) {
-    if (pref_table[ii].hwp_info->enabled && pref_table[ii].ul1_hit_func) {
-      pref_table[ii].ul1_hit_func(proc_id, line_addr, load_PC, global_hist);
-    }
-  }
+  pref_train(proc_id, PREF_TRAIN_UL1_HIT, line_addr, load_PC, global_hist);
 }
 
 void pref_ul1_pref_hit_late(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist, uns8 prefetcher_id) {
@@ -432,7 +607,6 @@ void pref_ul1_pref_hit_late(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 gl
 
 void pref_ul1_pref_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_hist, int lru_position,
                        uns8 prefetcher_id) {
-  int ii;
   if (prefetcher_id == 0)
     return;
 
@@ -447,11 +621,7 @@ void pref_ul1_pref_hit(uns8 proc_id, Addr line_addr, Addr load_PC, uns32 global_
 
   pref_table[prefetcher_id].hwp_info->curr_useful_core[proc_id]++;
 
-  for (ii = 0; ii < pref_table_size; ii++) {
-    if (pref_table[ii].hwp_info->enabled && pref_table[ii].ul1_pref_hit) {
-      pref_table[ii].ul1_pref_hit(proc_id, line_addr, load_PC, global_hist);
-    }
-  }
+  pref_train(proc_id, PREF_TRAIN_UL1_PREF_HIT, line_addr, load_PC, global_hist);
 }
 
 Flag pref_dl0req_queue_filter(Addr line_addr) {
@@ -459,15 +629,13 @@ Flag pref_dl0req_queue_filter(Addr line_addr) {
     return FALSE;
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
   Pref_Mem_Req* dl0req_queue = pref.cores[proc_id]->dl0req_queue;
-  for (uns ii = 0; ii < PREF_DL0REQ_QUEUE_SIZE; ii++) {
-    if (dl0req_queue[ii].valid &&
-        (dl0req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
-      dl0req_queue[ii].valid = FALSE;
-      STAT_EVENT(0, PREF_DL0REQ_QUEUE_HIT_BY_DEMAND);
-      return TRUE;
-    }
-  }
-  return FALSE;
+  int slot = pref_queue_find(&pref.cores[proc_id]->dl0req_queue_lines, dl0req_queue, line_addr >> LOG2(DCACHE_LINE_SIZE),
+                             TRUE);
+  if (slot < 0)
+    return FALSE;
+  dl0req_queue[slot].valid = FALSE;
+  STAT_EVENT(0, PREF_DL0REQ_QUEUE_HIT_BY_DEMAND);
+  return TRUE;
 }
 
 Flag pref_umlc_req_queue_filter(Addr line_addr) {
@@ -475,15 +643,13 @@ Flag pref_umlc_req_queue_filter(Addr line_addr) {
     return FALSE;
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
   Pref_Mem_Req* umlc_req_queue = pref.cores[proc_id]->umlc_req_queue;
-  for (uns ii = 0; ii < PREF_UMLC_REQ_QUEUE_SIZE; ii++) {
-    if (umlc_req_queue[ii].valid &&
-        (umlc_req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
-      umlc_req_queue[ii].valid = FALSE;
-      STAT_EVENT(0, PREF_UMLC_REQ_QUEUE_HIT_BY_DEMAND);
-      return TRUE;
-    }
-  }
-  return FALSE;
+  int slot = pref_queue_find(&pref.cores[proc_id]->umlc_req_queue_lines, umlc_req_queue, line_addr >> LOG2(DCACHE_LINE_SIZE),
+                             TRUE);
+  if (slot < 0)
+    return FALSE;
+  umlc_req_queue[slot].valid = FALSE;
+  STAT_EVENT(0, PREF_UMLC_REQ_QUEUE_HIT_BY_DEMAND);
+  return TRUE;
 }
 
 Flag pref_ul1req_queue_filter(Addr line_addr) {
@@ -491,43 +657,31 @@ Flag pref_ul1req_queue_filter(Addr line_addr) {
     return FALSE;
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
   Pref_Mem_Req* ul1req_queue = pref.cores[proc_id]->ul1req_queue;
-  for (uns ii = 0; ii < PREF_UL1REQ_QUEUE_SIZE; ii++) {
-    if (ul1req_queue[ii].valid &&
-        (ul1req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
-      ul1req_queue[ii].valid = FALSE;
-      STAT_EVENT(0, PREF_UL1REQ_QUEUE_HIT_BY_DEMAND);
-      return TRUE;
-    }
-  }
-  return FALSE;
+  int slot = pref_queue_find(&pref.cores[proc_id]->ul1req_queue_lines, ul1req_queue, line_addr >> LOG2(DCACHE_LINE_SIZE),
+                             TRUE);
+  if (slot < 0)
+    return FALSE;
+  ul1req_queue[slot].valid = FALSE;
+  STAT_EVENT(0, PREF_UL1REQ_QUEUE_HIT_BY_DEMAND);
+  return TRUE;
 }
 
 Flag pref_ul1req_queue_match(Addr line_addr) {
   uns proc_id = get_proc_id_from_cmp_addr(line_addr);
-  Pref_Mem_Req* ul1req_queue = pref.cores[proc_id]->ul1req_queue;
-  for (uns ii = 0; ii < PREF_UL1REQ_QUEUE_SIZE; ii++) {
-    if (ul1req_queue[ii].valid &&
-        (ul1req_queue[ii].line_addr >> LOG2(DCACHE_LINE_SIZE)) == (line_addr >> LOG2(DCACHE_LINE_SIZE))) {
-      return TRUE;
-    }
-  }
-  return FALSE;
+  return pref_queue_find(&pref.cores[proc_id]->ul1req_queue_lines, pref.cores[proc_id]->ul1req_queue,
+                         line_addr >> LOG2(DCACHE_LINE_SIZE), TRUE) >= 0;
 }
 
 Flag pref_addto_dl0req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id) {
-  int ii;
   Pref_Mem_Req new_req = {0};
   if (!line_index)  // addr = 0
     return TRUE;
   Pref_Mem_Req* dl0req_queue = pref.cores[proc_id]->dl0req_queue;
   int* dl0req_queue_req_pos = &pref.cores[proc_id]->dl0req_queue_req_pos;
-  if (PREF_DL0REQ_ADD_FILTER_ON) {
-    for (ii = 0; ii < PREF_DL0REQ_QUEUE_SIZE; ii++) {
-      if (dl0req_queue[ii].line_index == line_index) {
-        STAT_EVENT(0, PREF_DL0REQ_QUEUE_MATCHED_REQ);
-        return TRUE;  // Hit another request
-      }
-    }
+  Pref_Queue_Lines* lines = &pref.cores[proc_id]->dl0req_queue_lines;
+  if (PREF_DL0REQ_ADD_FILTER_ON && pref_queue_find(lines, dl0req_queue, line_index, FALSE) >= 0) {
+    STAT_EVENT(0, PREF_DL0REQ_QUEUE_MATCHED_REQ);
+    return TRUE;  // Hit another request
   }
   if (dl0req_queue[(*dl0req_queue_req_pos + 1) % PREF_DL0REQ_QUEUE_SIZE].valid) {
     STAT_EVENT_ALL(PREF_DL0REQ_QUEUE_FULL);
@@ -544,24 +698,24 @@ Flag pref_addto_dl0req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id)
 
   *dl0req_queue_req_pos = (*dl0req_queue_req_pos + 1) % PREF_DL0REQ_QUEUE_SIZE;
 
-  dl0req_queue[*dl0req_queue_req_pos] = new_req;
+  pref_queue_write(lines, dl0req_queue, *dl0req_queue_req_pos, &new_req);
   return TRUE;
 }
 
 Flag pref_addto_umlc_req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id) {
-  int ii;
   Pref_Mem_Req new_req = {0};
   if (!line_index)  // addr = 0
     return TRUE;
+  if (PREF_BW_THROTTLE_ON && !pref_bw_throttle_admit(pref_table[prefetcher_id].hwp_info, proc_id))
+    return TRUE;  // Throttled
+  if (PREF_PPF_ON && pref_ppf_filter(proc_id, line_index, prefetcher_id, pref.train_line_addr, pref.train_load_PC))
+    return TRUE;  // Filtered
   Pref_Mem_Req* umlc_req_queue = pref.cores[proc_id]->umlc_req_queue;
   int* umlc_req_queue_req_pos = &pref.cores[proc_id]->umlc_req_queue_req_pos;
-  if (PREF_UMLC_REQ_ADD_FILTER_ON) {
-    for (ii = 0; ii < PREF_UMLC_REQ_QUEUE_SIZE; ii++) {
-      if (umlc_req_queue[ii].line_index == line_index) {
-        STAT_EVENT(0, PREF_UMLC_REQ_QUEUE_MATCHED_REQ);
-        return TRUE;  // Hit another request
-      }
-    }
+  Pref_Queue_Lines* lines = &pref.cores[proc_id]->umlc_req_queue_lines;
+  if (PREF_UMLC_REQ_ADD_FILTER_ON && pref_queue_find(lines, umlc_req_queue, line_index, FALSE) >= 0) {
+    STAT_EVENT(0, PREF_UMLC_REQ_QUEUE_MATCHED_REQ);
+    return TRUE;  // Hit another request
   }
   if (umlc_req_queue[(*umlc_req_queue_req_pos + 1) % PREF_UMLC_REQ_QUEUE_SIZE].valid) {
     STAT_EVENT_ALL(PREF_UMLC_REQ_QUEUE_FULL);
@@ -580,7 +734,7 @@ Flag pref_addto_umlc_req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id
 
   *umlc_req_queue_req_pos = (*umlc_req_queue_req_pos + 1) % PREF_UMLC_REQ_QUEUE_SIZE;
 
-  umlc_req_queue[*umlc_req_queue_req_pos] = new_req;
+  pref_queue_write(lines, umlc_req_queue, *umlc_req_queue_req_pos, &new_req);
   return TRUE;
 }
 
@@ -590,11 +744,15 @@ Flag pref_addto_ul1req_queue(uns8 proc_id, Addr line_index, uns8 prefetcher_id)
 
 Flag pref_addto_ul1req_queue_set(uns8 proc_id, Addr line_index, uns8 prefetcher_id, uns distance, Addr loadPC,
                                  uns32 global_hist, Flag bw) {
-  int ii;
   Pref_Mem_Req new_req;
   Addr line_addr;
   if (!line_index)  // addr = 0
     return TRUE;
+  if (PREF_BW_THROTTLE_ON && !pref_bw_throttle_admit(pref_table[prefetcher_id].hwp_info, proc_id))
+    return TRUE;  // Throttled
+  if (PREF_PPF_ON && pref_ppf_filter(proc_id, line_index, prefetcher_id, pref.train_line_addr,
+                                     loadPC ? loadPC : pref.train_load_PC))
+    return TRUE;  // Filtered
 
   Pref_Mem_Req* ul1req_queue = pref.cores[proc_id]->ul1req_queue;
   int* ul1req_queue_req_pos = &pref.cores[proc_id]->ul1req_queue_req_pos;
@@ -603,13 +761,10 @@ Flag pref_addto_ul1req_queue_set(uns8 proc_id, Addr line_index, uns8 prefetcher_
 
   pref_feed_back_info_update(prefetcher_id);
 
-  if (PREF_UL1REQ_ADD_FILTER_ON) {
-    for (ii = 0; ii < PREF_UL1REQ_QUEUE_SIZE; ii++) {
-      if (ul1req_queue[ii].line_index == line_index) {
-        STAT_EVENT(0, PREF_UL1REQ_QUEUE_MATCHED_REQ);
-        return TRUE;  // Hit another request
-      }
-    }
+  Pref_Queue_Lines* lines = &pref.cores[proc_id]->ul1req_queue_lines;
+  if (PREF_UL1REQ_ADD_FILTER_ON && pref_queue_find(lines, ul1req_queue, line_index, FALSE) >= 0) {
+    STAT_EVENT(0, PREF_UL1REQ_QUEUE_MATCHED_REQ);
+    return TRUE;  // Hit another request
   }
   if (ul1req_queue[(*ul1req_queue_req_pos + 1) % PREF_UL1REQ_QUEUE_SIZE].valid) {
     STAT_EVENT_ALL(PREF_UL1REQ_QUEUE_FULL);
@@ -630,17 +785,28 @@ Flag pref_addto_ul1req_queue_set(uns8 proc_id, Addr line_index, uns8 prefetcher_
 
   *ul1req_queue_req_pos = (*ul1req_queue_req_pos + 1) % PREF_UL1REQ_QUEUE_SIZE;
 
-  ul1req_queue[*ul1req_queue_req_pos] = new_req;
+  pref_queue_write(lines, ul1req_queue, *ul1req_queue_req_pos, &new_req);
   return TRUE;
 }
 
+/* pref_set_dcache_stage: only the cmp model has dcache stages; the other models never
+   fill the dl0 request queue */
+static inline void pref_set_dcache_stage(uns proc_id) {
+  if (cmp_model.core_context)
+    set_dcache_stage(&cmp_model.core_context[proc_id]);
+}
+
 void pref_update(void) {
   if (!PREF_FRAMEWORK_ON)
     return;
 
+  pref_train_flush();
+
   if (PREF_HFILTER_ON && PREF_HFILTER_RESET_ENABLE && cycle_count % PREF_HFILTER_RESET_INTERVAL == 0)
     pref_hfilter_pht_reset();
 
+  pref_bw_throttle_update(pref_table, pref_table_size);
+
   if (PREF_SHARED_QUEUES) {
     pref_update_core(0);
   } else {
@@ -668,7 +834,7 @@ void pref_update_core(uns proc_id) {
   Pref_Mem_Req* ul1req_queue = pref.cores[proc_id]->ul1req_queue;
   int* ul1req_queue_send_pos = &pref.cores[proc_id]->ul1req_queue_send_pos;
 
-  set_dcache_stage(&cmp_model.dcache_stage[proc_id]);
+  pref_set_dcache_stage(proc_id);
 
   for (uns ii = 0; ii < PREF_DL0SCHEDULE_NUM; ii++) {
     int q_index = *dl0req_queue_send_pos;
@@ -678,9 +844,9 @@ void pref_update_core(uns proc_id) {
     Flag inc_send_pos = TRUE;
 
     if (dl0req_queue[q_index].valid) {
-      set_dcache_stage(&cmp_model.dcache_stage[proc_id]);
+      pref_set_dcache_stage(proc_id);
 
-      ASSERT(proc_id, proc_id == dl0req_queue[q_index].line_addr >> 58);
+      ASSERT(proc_id, proc_id == dl0req_queue[q_index].line_addr >> CMP_ADDR_PROC_ID_SHIFT);
 
       bank = dl0req_queue[q_index].line_addr >> dc->dcache.shift_bits & N_BIT_MASK(LOG2(DCACHE_BANKS));
 
@@ -717,8 +883,8 @@ void pref_update_core(uns proc_id) {
 
     if (umlc_req_queue[q_index].valid) {
       proc_id = umlc_req_queue[q_index].proc_id;
-      ASSERTM(proc_id, proc_id == umlc_req_queue[q_index].line_addr >> 58, "proc_id from addr: %llx\n",
-              umlc_req_queue[q_index].line_addr);
+      ASSERTM(proc_id, proc_id == umlc_req_queue[q_index].line_addr >> CMP_ADDR_PROC_ID_SHIFT,
+              "proc_id from addr: %llx\n", umlc_req_queue[q_index].line_addr);
 
       // now access the umlc
       Pref_Req_Info info;
@@ -731,7 +897,7 @@ void pref_update_core(uns proc_id) {
       info.dest = DEST_MLC;
 
       ASSERT(proc_id, proc_id == umlc_req_queue[q_index].proc_id);
-      ASSERT(proc_id, proc_id == umlc_req_queue[q_index].line_addr >> 58);
+      ASSERT(proc_id, proc_id == umlc_req_queue[q_index].line_addr >> CMP_ADDR_PROC_ID_SHIFT);
       // check if there is enough space in the mem req buffer
       if ((model->mem == MODEL_MEM) && ((MEM_REQ_BUFFER_ENTRIES - mem_get_req_count(proc_id)) <
                                         PREF_L1Q_DEMAND_RESERVE)) {  // really req buffer demand reserve
@@ -768,9 +934,9 @@ void pref_update_core(uns proc_id) {
 
     if (ul1req_queue[q_index].valid) {
       proc_id = ul1req_queue[q_index].proc_id;
-      set_dcache_stage(&cmp_model.dcache_stage[proc_id]);
-      ASSERTM(proc_id, proc_id == ul1req_queue[q_index].line_addr >> 58, "proc_id from addr: %llx\n",
-              ul1req_queue[q_index].line_addr);
+      pref_set_dcache_stage(proc_id);
+      ASSERTM(proc_id, proc_id == ul1req_queue[q_index].line_addr >> CMP_ADDR_PROC_ID_SHIFT,
+              "proc_id from addr: %llx\n", ul1req_queue[q_index].line_addr);
 
       // now access the ul1
       Pref_Req_Info info;
@@ -783,7 +949,7 @@ void pref_update_core(uns proc_id) {
       info.dest = DEST_L1;
 
       ASSERT(proc_id, proc_id == ul1req_queue[q_index].proc_id);
-      ASSERT(proc_id, proc_id == ul1req_queue[q_index].line_addr >> 58);
+      ASSERT(proc_id, proc_id == ul1req_queue[q_index].line_addr >> CMP_ADDR_PROC_ID_SHIFT);
       // check if there is enough space in the mem req buffer
       if ((model->mem == MODEL_MEM) &&
           ((MEM_REQ_BUFFER_ENTRIES - mem_get_req_count(proc_id)) < PREF_L1Q_DEMAND_RESERVE)) {
@@ -863,6 +1029,9 @@ inline void pref_evictline_used(uns8 proc_id, Addr addr, Addr loadPC, uns32 glob
   if (!PREF_FRAMEWORK_ON)
     return;
 
+  if (PREF_PPF_ON)
+    pref_ppf_train_evict(proc_id, addr, TRUE);
+
   if (PREF_HFILTER_ON) {
     uns32 cooked_hist = COOK_HIST_BITS(global_hist, PREF_HFILTER_INDEX_BITS, 0);
     uns32 cooked_addr = PREF_HFILTER_USE_PC ? COOK_ADDR_BITS(loadPC, PREF_HFILTER_INDEX_BITS, 0)
@@ -878,6 +1047,9 @@ inline void pref_evictline_notused(uns8 proc_id, Addr addr, Addr loadPC, uns32 g
     return;
   STAT_EVENT(proc_id, PREF_UNUSED_EVICT);
 
+  if (PREF_PPF_ON)
+    pref_ppf_train_evict(proc_id, addr, FALSE);
+
   if (PREF_HFILTER_ON) {
     uns32 cooked_hist = COOK_HIST_BITS(global_hist, PREF_HFILTER_INDEX_BITS, 0);
     uns32 cooked_addr = PREF_HFILTER_USE_PC ? COOK_ADDR_BITS(loadPC, PREF_HFILTER_INDEX_BITS, 0)
@@ -906,7 +1078,7 @@ inline Flag pref_hfilter_pred_useless(uns8 proc_id, Addr addr, Addr loadPC, uns3
 }
 
 void pref_hfilter_pht_reset(void) {
-  uns8 proc_id;
+  uns proc_id;
 
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     memset(pref.cores[proc_id]->pref_hfilter_pht, 0, sizeof(uns8) * (0x1 << PREF_HFILTER_INDEX_BITS));
@@ -944,7 +1116,7 @@ void pref_polbv_update_on_evict(uns8 pref_proc_id, uns8 evicted_proc_id, Addr ev
 void pref_polbv_lookup_on_miss(uns8 proc_id, Addr addr) {
   Addr line_index;
   uns index;
-  uns8 proc_id_tmp;
+  uns proc_id_tmp;
 
   ASSERT(proc_id, PREF_POLBV_ON);
   line_index = (addr >> LOG2(DCACHE_LINE_SIZE));
@@ -964,7 +1136,7 @@ void pref_polbv_lookup_on_miss(uns8 proc_id, Addr addr) {
 void pref_polbv_update_on_repref(uns8 proc_id, Addr addr) {
   Addr line_index;
   uns index;
-  uns8 proc_id_tmp;
+  uns proc_id_tmp;
 
   ASSERT(proc_id, PREF_POLBV_ON);
   line_index = (addr >> LOG2(DCACHE_LINE_SIZE));
@@ -982,7 +1154,7 @@ void pref_feed_back_info_update(uns8 prefetcher_id) {
 
   if (PREF_UPDATE_INTERVAL != 0 && (pref.num_ul1_evicted - prev_num_ul1_evicted >= PREF_UPDATE_INTERVAL)) {
     float acc, timely, pol;
-    uns8 proc_id;
+    uns proc_id;
 
     prev_num_ul1_evicted = pref.num_ul1_evicted;
 
@@ -70,6 +70,11 @@ struct HWP_Info_struct {
   Counter* curr_late_core;
 
   uns* dyn_degree_core;
+  Flag dyn_degree_user;  // maps dyn_degree_core to its own degree/distance (else pref_bw_throttle_admit)
+
+  // Host cost of training (counted with --host_prof in simulation mode)
+  Counter train_events;  // training events handed to this prefetcher
+  Counter train_ticks;   // host_prof_now() ticks spent in its training functions
 };
 
 typedef enum HWP_Type_enum {
@@ -78,6 +83,33 @@ typedef enum HWP_Type_enum {
   PREF_TO_DL0,
 } HWP_Type;
 
+/* UMLC and UL1 training events; with PREF_TRAIN_BATCH a cycle's worth of them is
+   collected and handed to each prefetcher at once */
+typedef enum Pref_Train_Type_enum {
+  PREF_TRAIN_UMLC_MISS,
+  PREF_TRAIN_UMLC_HIT,
+  PREF_TRAIN_UMLC_PREF_HIT,
+  PREF_TRAIN_UL1_MISS,
+  PREF_TRAIN_UL1_HIT,
+  PREF_TRAIN_UL1_PREF_HIT,
+} Pref_Train_Type;
+
+typedef struct Pref_Train_Event_struct {
+  Addr line_addr;
+  Addr load_PC;
+  uns32 global_hist;
+  uns8 proc_id;
+  uns8 type;  // Pref_Train_Type
+} Pref_Train_Event;
+
+/* Hash of the lines in a request queue, so that the filters look up a line without
+   scanning the whole queue */
+typedef struct Pref_Queue_Lines_struct {
+  int* bucket_head;  // first slot of each bucket (-1: empty)
+  int* next_slot;    // next slot in the same bucket, per queue slot
+  uns mask;
+} Pref_Queue_Lines;
+
 typedef enum HWP_DynAggr_enum {
   AGGR_DEC,
   AGGR_STAY,
@@ -121,6 +153,11 @@ struct HWP_struct {
                        uns32 global_hist);  // called when a ul1 access hits a
                                             // prefetched line for the first
                                             // time
+
+  void (*train_batch_func)(const Pref_Train_Event* events,
+                           uns num_events);  // (may be NULL) replaces the six
+                                             // umlc/ul1 functions above and
+                                             // gets all the events of a batch
 };
 
 /* Per core prefetching data */
@@ -129,6 +166,10 @@ typedef struct HWP_Core_struct {
   Pref_Mem_Req* umlc_req_queue;  // MLC req queue
   Pref_Mem_Req* ul1req_queue;    // L2 req queue
 
+  Pref_Queue_Lines dl0req_queue_lines;
+  Pref_Queue_Lines umlc_req_queue_lines;
+  Pref_Queue_Lines ul1req_queue_lines;
+
   int dl0req_queue_req_pos;
   int dl0req_queue_send_pos;
 
@@ -166,6 +207,14 @@ typedef struct HWP_Common_struct {
   Counter curr_num_ul1_misses;
 
   uns phase;
+
+  // training events waiting for pref_update (PREF_TRAIN_BATCH)
+  Pref_Train_Event* train_events;
+  uns num_train_events;
+
+  // event a prefetcher is being trained on one at a time (0 within a batch), for the PPF
+  Addr train_line_addr;
+  Addr train_load_PC;
 } HWP_Common;
 
 typedef enum {
@@ -55,6 +55,10 @@
 #include "op.h"
 #include "statistics.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /* ghb_prefetcher : Global History Buffer prefetcher
  * Based on the C/DC prefetcher described in the AC/DC paper
 
@@ -91,17 +95,20 @@ void pref_ghb_init(HWP* hwp) {
 
 void init_ghb_core(HWP* hwp, Pref_GHB* ghb_hwp_core) {
   int ii;
-  uns8 proc_id;
+  uns proc_id;
+  ASSERTM(0, PREF_GHB_MATCH_LEN >= 2, "PREF_GHB_MATCH_LEN must be at least 2\n");
+  ASSERTM(0, PREF_GHB_KEY == GHB_KEY_CZONE || PREF_GHB_KEY == GHB_KEY_PC, "Unknown PREF_GHB_KEY %u\n", PREF_GHB_KEY);
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     ghb_hwp_core[proc_id].hwp_info = hwp->hwp_info;
     ghb_hwp_core[proc_id].hwp_info->enabled = TRUE;
+    ghb_hwp_core[proc_id].hwp_info->dyn_degree_user = TRUE;
     ghb_hwp_core[proc_id].index_table =
         (GHB_Index_Table_Entry*)malloc(sizeof(GHB_Index_Table_Entry) * PREF_GHB_INDEX_N);
     ghb_hwp_core[proc_id].ghb_buffer = (GHB_Entry*)malloc(sizeof(GHB_Entry) * PREF_GHB_BUFFER_N);
 
     ghb_hwp_core[proc_id].ghb_head = -1;
     ghb_hwp_core[proc_id].ghb_tail = -1;
-    ghb_hwp_core[proc_id].deltab_size = PREF_GHB_MAX_DEGREE + 2;
+    ghb_hwp_core[proc_id].deltab_size = PREF_GHB_LOOKBACK;
 
     ghb_hwp_core[proc_id].delta_buffer = (int*)calloc(ghb_hwp_core[proc_id].deltab_size, sizeof(int));
     ghb_hwp_core[proc_id].pref_degree = PREF_GHB_DEGREE;
@@ -140,6 +147,41 @@ void pref_ghb_umlc_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_h
   pref_ghb_train(&ghb_prefetchers_array.ghb_hwp_core_umlc[proc_id], proc_id, lineAddr, loadPC, FALSE);
 }
 
+/* pref_ghb_find_match: smallest p > 0 with deltas[p, p + len) equal to deltas[0, len), or -1.
+   Candidates are filtered on the first two deltas four positions at a time. */
+static int pref_ghb_find_match(int const* deltas, int num, int len) {
+  int end = num - len + 1;  // candidate positions are [1, end)
+  int pp = 1;
+
+#ifdef __SSE2__
+  __m128i first = _mm_set1_epi32(deltas[0]);
+  __m128i second = _mm_set1_epi32(deltas[1]);
+  for (; pp + 4 <= end; pp += 4) {
+    __m128i eq = _mm_and_si128(_mm_cmpeq_epi32(_mm_loadu_si128((__m128i const*)&deltas[pp]), first),
+                               _mm_cmpeq_epi32(_mm_loadu_si128((__m128i const*)&deltas[pp + 1]), second));
+    for (int mask = _mm_movemask_ps(_mm_castsi128_ps(eq)); mask; mask &= mask - 1) {
+      int cand = pp + __builtin_ctz(mask);
+      if (!memcmp(&deltas[cand + 2], &deltas[2], sizeof(int) * (len - 2)))
+        return cand;
+    }
+  }
+#endif
+  for (; pp < end; pp++) {
+    if (deltas[pp] == deltas[0] && !memcmp(&deltas[pp + 1], &deltas[1], sizeof(int) * (len - 1)))
+      return pp;
+  }
+  return -1;
+}
+
+static inline void pref_ghb_send(Pref_GHB* ghb_hwp, uns8 proc_id, Addr lineIndex, Addr loadPC) {
+  ASSERT(proc_id, proc_id == (lineIndex >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE))));
+  if (ghb_hwp->type == UMLC)
+    pref_addto_umlc_req_queue(proc_id, lineIndex, ghb_hwp->hwp_info->id);
+  else
+    pref_addto_ul1req_queue_set(proc_id, lineIndex, ghb_hwp->hwp_info->id, 0, loadPC, 0, FALSE);  // FIXME
+  DEBUG(0, "Sent %llx\n", lineIndex);
+}
+
 void pref_ghb_train(Pref_GHB* ghb_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC, Flag is_hit) {
   // 1. adds address to ghb
   // 2. sends upto "degree" prefetches to the prefQ
@@ -148,16 +190,15 @@ void pref_ghb_train(Pref_GHB* ghb_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC,
   int old_ptr = -1;
 
   int ghb_idx = -1;
-  int delta1 = 0;
-  int delta2 = 0;
+  int* deltas = ghb_hwp->delta_buffer;
+  int num_deltas = 0;
+  int match_len = PREF_GHB_MATCH_LEN;
 
   int num_pref_sent = 0;
-  int deltab_head = -1;
-  int curr_deltab_size = 0;
 
   Addr lineIndex = lineAddr >> LOG2(DCACHE_LINE_SIZE);
   Addr currLineIndex = lineIndex;
-  Addr index_tag = CZONE_TAG(lineAddr);
+  Addr index_tag = PREF_GHB_KEY == GHB_KEY_PC ? loadPC : CZONE_TAG(lineAddr);
 
   for (ii = 0; ii < PREF_GHB_INDEX_N; ii++) {
     if (index_tag == ghb_hwp->index_table[ii].czone_tag && ghb_hwp->index_table[ii].valid) {
@@ -191,70 +232,48 @@ void pref_ghb_train(Pref_GHB* ghb_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC,
   if (PREF_THROTTLE_ON) {
     pref_ghb_throttle(ghb_hwp);
   }
-  if (PREF_THROTTLEFB_ON) {
+  if (PREF_THROTTLEFB_ON || PREF_BW_THROTTLE_ON) {
     pref_ghb_throttle_fb(ghb_hwp);
   }
 
   pref_ghb_create_newentry(ghb_hwp, czone_idx, lineAddr, index_tag, old_ptr);
 
-  for (ii = 0; ii < ghb_hwp->deltab_size; ii++)
-    ghb_hwp->delta_buffer[ii] = 0;
-
-  // Now ghb_tail points to the new entry. Work backwards to find a 2 delta
-  // match...
+  // Now ghb_tail points to the new entry. Work backwards collecting the deltas of the older entries...
   ghb_idx = ghb_hwp->ghb_buffer[ghb_hwp->ghb_tail].ghb_ptr;
   DEBUG(0, "hit:%d lineidx:%llx loadPC:%llx\n", is_hit, lineIndex, loadPC);
-  while (ghb_idx != -1 && num_pref_sent < ghb_hwp->pref_degree) {
+  while (ghb_idx != -1 && num_deltas < ghb_hwp->deltab_size) {
     int delta = currLineIndex - ghb_hwp->ghb_buffer[ghb_idx].miss_index;
     if (delta > 100 || delta < -100)
       break;
+    deltas[num_deltas++] = delta;
+    currLineIndex = ghb_hwp->ghb_buffer[ghb_idx].miss_index;
+    ghb_idx = ghb_hwp->ghb_buffer[ghb_idx].ghb_ptr;
+  }
 
-    // insert into delta buffer
-    deltab_head = (deltab_head + 1) % ghb_hwp->deltab_size;
-    ghb_hwp->delta_buffer[deltab_head] = delta;
-    curr_deltab_size++;
-    if (delta1 == 0) {
-      delta1 = delta;
-    } else if (delta2 == 0) {
-      delta2 = delta;
-    } else {
-      DEBUG(0, "delta1:%d, delta2:%d", delta1, delta2);
-      // Catch strides quickly
-      if (delta1 == delta2) {
-        for (; num_pref_sent < ghb_hwp->pref_degree; num_pref_sent++) {
-          lineIndex += delta1;
-          ASSERT(proc_id, proc_id == (lineIndex >> (58 - LOG2(DCACHE_LINE_SIZE))));
-          if (ghb_hwp->type == UMLC)
-            pref_addto_umlc_req_queue(proc_id, lineIndex, ghb_hwp->hwp_info->id);
-          else
-            pref_addto_ul1req_queue_set(proc_id, lineIndex, ghb_hwp->hwp_info->id, 0, loadPC, 0, FALSE);  // FIXME
-        }
-      } else {
-        if (delta1 == ghb_hwp->delta_buffer[(deltab_head - 1) % ghb_hwp->deltab_size] &&
-            delta2 == ghb_hwp->delta_buffer[deltab_head]) {
-          // found a match
-          // lets go for a walk
-          int deltab_idx = (deltab_head - 2) % ghb_hwp->deltab_size;
-          int deltab_start_idx = deltab_idx;
-          for (; num_pref_sent < ghb_hwp->pref_degree; num_pref_sent++) {
-            lineIndex += ghb_hwp->delta_buffer[deltab_idx];
-            ASSERT(proc_id, proc_id == (lineIndex >> (58 - LOG2(DCACHE_LINE_SIZE))));
-            if (ghb_hwp->type == UMLC)
-              pref_addto_umlc_req_queue(proc_id, lineIndex, ghb_hwp->hwp_info->id);
-            else
-              pref_addto_ul1req_queue_set(proc_id, lineIndex, ghb_hwp->hwp_info->id, 0, loadPC, 0, FALSE);  // FIXME
-            DEBUG(0, "Sent %llx\n", lineIndex);
-            deltab_idx = CIRC_DEC(deltab_idx, ghb_hwp->deltab_size);
-            if (deltab_idx > curr_deltab_size) {
-              deltab_idx = deltab_start_idx;
-            }
-          }
-          break;
-        }
+  // ...and look for an earlier occurrence of the newest match_len of them
+  if (num_deltas <= match_len)
+    return;
+
+  // Catch strides quickly
+  for (ii = 1; ii < match_len && deltas[ii] == deltas[0]; ii++)
+    ;
+  if (ii == match_len) {
+    for (; num_pref_sent < ghb_hwp->pref_degree; num_pref_sent++) {
+      lineIndex += deltas[0];
+      pref_ghb_send(ghb_hwp, proc_id, lineIndex, loadPC);
+    }
+  } else {
+    int match = pref_ghb_find_match(deltas, num_deltas, match_len);
+    if (match != -1) {
+      // found a match, replay the deltas that followed it
+      DEBUG(0, "match at delta %d\n", match);
+      int deltab_idx = match - 1;
+      for (; num_pref_sent < ghb_hwp->pref_degree; num_pref_sent++) {
+        lineIndex += deltas[deltab_idx];
+        pref_ghb_send(ghb_hwp, proc_id, lineIndex, loadPC);
+        deltab_idx = deltab_idx ? deltab_idx - 1 : match - 1;
       }
     }
-    currLineIndex = ghb_hwp->ghb_buffer[ghb_idx].miss_index;
-    ghb_idx = ghb_hwp->ghb_buffer[ghb_idx].ghb_ptr;
   }
   if (num_pref_sent) {
     DEBUG(0, "Num sent %d\n", num_pref_sent);
@@ -366,7 +385,8 @@ void pref_ghb_throttle(Pref_GHB* ghb_hwp) {
 }
 
 void pref_ghb_throttle_fb(Pref_GHB* ghb_hwp) {
-  pref_get_degfb(0, ghb_hwp->hwp_info->id);                                                             // FIXME
+  if (!PREF_BW_THROTTLE_ON)  // else pref_bw_throttle_update sets the level
+    pref_get_degfb(0, ghb_hwp->hwp_info->id);  // FIXME
   ASSERT(0, ghb_hwp->hwp_info->dyn_degree_core[0] >= 0 && ghb_hwp->hwp_info->dyn_degree_core[0] <= 4);  // FIXME
   ghb_hwp->pref_degree = ghb_hwp->pref_degree_vals[ghb_hwp->hwp_info->dyn_degree_core[0]];              // FIXME
 }
@@ -32,6 +32,11 @@
 
 #define CZONE_TAG(x) (x >> (PREF_GHB_CZONE_BITS))
 
+typedef enum GHB_Key_enum {
+  GHB_KEY_CZONE,
+  GHB_KEY_PC,
+} GHB_Key;
+
 typedef struct GHB_Index_Table_Entry_Struct {
   Addr czone_tag;
   Flag valid;
@@ -57,8 +62,8 @@ typedef struct Pref_GHB_Struct {
   int ghb_tail;
   int ghb_head;
 
-  int deltab_size;
-  int* delta_buffer;
+  int deltab_size;    // PREF_GHB_LOOKBACK
+  int* delta_buffer;  // deltas of the last search, newest first
 
   uns pref_degree;
 
@@ -0,0 +1,231 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : prefetcher/pref_ppf.cc
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Perceptron-based prefetch filter (PPF) in front of the UMLC and UL1
+ *                prefetch request queues
+ ***************************************************************************************/
+
+#include "prefetcher/pref_ppf.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "libs/perceptron.hpp"
+
+#include "statistics.h"
+
+extern "C" {
+#include "debug/debug.param.h"
+
+#include "core.param.h"
+#include "general.param.h"
+#include "memory/memory.param.h"
+#include "prefetcher/pref.param.h"
+#include "prefetcher/pref_ppf.param.h"
+
+#include "prefetcher/pref_common.h"
+}
+
+#include <vector>
+
+/*
+   Every candidate of every registered prefetcher goes through the filter before it is
+   written into a UMLC or UL1 request queue. Its features are packed into bits and fed to
+   a perceptron (libs/perceptron.hpp) whose weight row is picked by the trigger PC and the
+   prefetcher:
+
+     page offset : line within its 4KB page (6 bits)
+     delta       : candidate line - trigger line, clamped to 6 bits signed (0 in batches)
+     confidence  : the prefetcher's current accuracy on this core (3 bits)
+     prefetcher  : id of the prefetcher (4 bits)
+
+   Candidates whose sum is below PREF_PPF_THRESHOLD are dropped. The features of both the
+   accepted and the rejected candidates are kept in small direct-mapped tables per core:
+   an accepted line trains up when it is used before its eviction and down when it is not;
+   a rejected line trains up if a demand asks for it after all.
+*/
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_PREF_PPF, ##args)
+
+#define PPF_OFFSET_BITS 6
+#define PPF_DELTA_BITS 6
+#define PPF_CONF_BITS 3
+#define PPF_ID_BITS 4
+#define PPF_NUM_FEATURES (PPF_OFFSET_BITS + PPF_DELTA_BITS + PPF_CONF_BITS + PPF_ID_BITS)
+
+/**************************************************************************************/
+/* Types */
+
+/* weight row of the trigger PC and the prefetcher (passed as history) */
+struct PpfIndex {
+  static int get_index(Addr pc, int num_entries, uns history) {
+    return (int)(((pc >> 2) ^ (pc >> 14) ^ ((Addr)history << 7)) % num_entries);
+  }
+};
+
+typedef PerceptronTable<PpfIndex> Ppf_Perceptron;
+
+typedef struct Ppf_Record_struct {
+  Flag valid;
+  Addr line_index;
+  Addr pc;
+  uns8 prefetcher_id;
+  uns32 features;
+  double sum;
+} Ppf_Record;
+
+/**************************************************************************************/
+/* Global variables */
+
+static Ppf_Perceptron* ppf_perceptron;
+static std::vector<Ppf_Record> ppf_accepted;  // [proc_id * PREF_PPF_TABLE_SIZE + line % size]
+static std::vector<Ppf_Record> ppf_rejected;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static uns32 ppf_features(uns8 proc_id, Addr line_index, uns8 prefetcher_id, Addr trigger_line_addr);
+static void ppf_train(Ppf_Record* record, Flag useful);
+static Ppf_Record* ppf_record(std::vector<Ppf_Record>& table, uns8 proc_id, Addr line_index);
+
+/**************************************************************************************/
+/* pref_ppf_init: */
+
+void pref_ppf_init(void) {
+  if (!PREF_PPF_ON)
+    return;
+  ASSERTM(0, PREF_PPF_ENTRIES > 0 && PREF_PPF_TABLE_SIZE > 0, "PPF tables must not be empty\n");
+  ppf_perceptron = new Ppf_Perceptron(PPF_NUM_FEATURES, PREF_PPF_ENTRIES, PREF_PPF_LEARNING_RATE, PREF_PPF_THETA,
+                                      PREF_PPF_WEIGHT_BITS, PREF_PPF_THRESHOLD);
+  ppf_accepted.assign(NUM_CORES * PREF_PPF_TABLE_SIZE, Ppf_Record());
+  ppf_rejected.assign(NUM_CORES * PREF_PPF_TABLE_SIZE, Ppf_Record());
+}
+
+/**************************************************************************************/
+/* ppf_features: */
+
+static uns32 ppf_features(uns8 proc_id, Addr line_index, uns8 prefetcher_id, Addr trigger_line_addr) {
+  uns32 offset = line_index & N_BIT_MASK(PPF_OFFSET_BITS);
+
+  uns32 delta = 0;
+  if (trigger_line_addr) {
+    int64 d = (int64)line_index - (int64)(trigger_line_addr >> LOG2(DCACHE_LINE_SIZE));
+    int64 max = (1 << (PPF_DELTA_BITS - 1)) - 1;
+    d = d > max ? max : (d < -max - 1 ? -max - 1 : d);
+    delta = (uns32)d & N_BIT_MASK(PPF_DELTA_BITS);
+  }
+
+  float acc = pref_get_accuracy(proc_id, prefetcher_id);
+  uns32 conf = (uns32)(acc * N_BIT_MASK(PPF_CONF_BITS) + 0.5);
+  conf = MIN2(conf, N_BIT_MASK(PPF_CONF_BITS));
+
+  uns32 id = prefetcher_id & N_BIT_MASK(PPF_ID_BITS);
+
+  return offset | (delta << PPF_OFFSET_BITS) | (conf << (PPF_OFFSET_BITS + PPF_DELTA_BITS)) |
+         (id << (PPF_OFFSET_BITS + PPF_DELTA_BITS + PPF_CONF_BITS));
+}
+
+/**************************************************************************************/
+/* ppf_record: */
+
+static Ppf_Record* ppf_record(std::vector<Ppf_Record>& table, uns8 proc_id, Addr line_index) {
+  return &table[proc_id * PREF_PPF_TABLE_SIZE + line_index % PREF_PPF_TABLE_SIZE];
+}
+
+/**************************************************************************************/
+/* pref_ppf_filter: */
+
+Flag pref_ppf_filter(uns8 proc_id, Addr line_index, uns8 prefetcher_id, Addr trigger_line_addr, Addr load_PC) {
+  uns32 bits = ppf_features(proc_id, line_index, prefetcher_id, trigger_line_addr);
+  std::vector<double> features(PPF_NUM_FEATURES);
+  Ppf_Perceptron::extract_bipolar_features(bits, features.data(), PPF_NUM_FEATURES);
+
+  double sum;
+  bool accept;
+  ppf_perceptron->predict(features, sum, accept, load_PC, prefetcher_id);
+  STAT_EVENT(proc_id, PREF_PPF_CANDIDATE);
+
+  // a newer candidate for the same slot replaces an untrained one
+  Ppf_Record* record = ppf_record(accept ? ppf_accepted : ppf_rejected, proc_id, line_index);
+  record->valid = TRUE;
+  record->line_index = line_index;
+  record->pc = load_PC;
+  record->prefetcher_id = prefetcher_id;
+  record->features = bits;
+  record->sum = sum;
+
+  DEBUG(proc_id, "candidate  line:%s  prefetcher:%u  pc:%s  sum:%.1f  %s\n", hexstr64s(line_index), prefetcher_id,
+        hexstr64s(load_PC), sum, accept ? "accept" : "reject");
+  if (accept)
+    return FALSE;
+  STAT_EVENT(proc_id, PREF_PPF_REJECT);
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* ppf_train: */
+
+static void ppf_train(Ppf_Record* record, Flag useful) {
+  std::vector<double> features(PPF_NUM_FEATURES);
+  Ppf_Perceptron::extract_bipolar_features(record->features, features.data(), PPF_NUM_FEATURES);
+  ppf_perceptron->train(features, record->sum >= PREF_PPF_THRESHOLD, useful, record->sum, record->pc,
+                        record->prefetcher_id);
+  record->valid = FALSE;
+}
+
+/**************************************************************************************/
+/* pref_ppf_train_evict: */
+
+void pref_ppf_train_evict(uns8 proc_id, Addr line_addr, Flag used) {
+  Addr line_index = line_addr >> LOG2(DCACHE_LINE_SIZE);
+  Ppf_Record* record = ppf_record(ppf_accepted, proc_id, line_index);
+  if (!record->valid || record->line_index != line_index)
+    return;
+  STAT_EVENT(proc_id, used ? PREF_PPF_TRAIN_USED : PREF_PPF_TRAIN_NOTUSED);
+  ppf_train(record, used);
+}
+
+/**************************************************************************************/
+/* pref_ppf_train_miss: */
+
+void pref_ppf_train_miss(uns8 proc_id, Addr line_addr) {
+  Addr line_index = line_addr >> LOG2(DCACHE_LINE_SIZE);
+  Ppf_Record* record = ppf_record(ppf_rejected, proc_id, line_index);
+  if (!record->valid || record->line_index != line_index)
+    return;
+  STAT_EVENT(proc_id, PREF_PPF_TRAIN_MISSED);
+  ppf_train(record, TRUE);
+}
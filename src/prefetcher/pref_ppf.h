@@ -0,0 +1,59 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : prefetcher/pref_ppf.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Perceptron-based prefetch filter (PPF) in front of the UMLC and UL1
+ *                prefetch request queues
+ ***************************************************************************************/
+#ifndef __PREF_PPF_H__
+#define __PREF_PPF_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "globals/global_types.h"
+
+/*************************************************************/
+/* Prototypes */
+
+void pref_ppf_init(void);
+
+/* TRUE if the candidate of prefetcher_id should be dropped. trigger_line_addr and load_PC
+   are those of the access that caused the candidate, 0 if not known. */
+Flag pref_ppf_filter(uns8 proc_id, Addr line_index, uns8 prefetcher_id, Addr trigger_line_addr, Addr load_PC);
+
+/* A prefetched line left the cache, used or not */
+void pref_ppf_train_evict(uns8 proc_id, Addr line_addr, Flag used);
+
+/* A demand missed: a rejected candidate for this line should have been sent */
+void pref_ppf_train_miss(uns8 proc_id, Addr line_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef __PREF_PPF_H__ */
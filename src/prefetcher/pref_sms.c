@@ -0,0 +1,248 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : pref_sms.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Spatial region prefetcher (Spatial Memory Streaming)
+ ***************************************************************************************/
+
+#include "prefetcher/pref_sms.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "core.param.h"
+#include "general.param.h"
+#include "memory/memory.param.h"
+#include "prefetcher/pref.param.h"
+#include "prefetcher/pref_sms.param.h"
+
+#include "prefetcher/pref_common.h"
+
+#include "statistics.h"
+
+/*
+   SMS prefetcher : memory is split into PREF_SMS_REGION_SIZE regions. The first miss to a
+   region (the trigger) allocates it in the filter table; a second, different line moves it
+   to the accumulation table, which ORs every further access into the region's footprint.
+   When a region leaves the accumulation table its footprint is stored in the pattern
+   history table under the trigger PC and offset. The next trigger by the same PC and
+   offset sends out the whole stored footprint at once.
+
+   Footprints are one bit per line in an uns64, so a lookup is a single tag compare and a
+   burst is a walk over the set bits. A generation ends when the accumulation table needs
+   the slot (LRU) rather than on the eviction of one of the region's lines, since the
+   prefetcher hooks do not see cache evictions.
+*/
+
+/**************************************************************************************/
+/* Macros */
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_PREF_SMS, ##args)
+
+sms_prefetchers sms_prefetcher_array;
+
+static uns sms_region_bits;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static SMS_Region_Entry* sms_find_region(SMS_Region_Entry* table, uns entries, Addr region);
+static SMS_Region_Entry* sms_victim_region(SMS_Region_Entry* table, uns entries);
+static SMS_PHT_Entry* sms_pht_set(Pref_SMS* sms_hwp, Addr pc, uns offset, uns32* tag);
+static void sms_commit_pattern(Pref_SMS* sms_hwp, const SMS_Region_Entry* region);
+static void sms_issue_footprint(Pref_SMS* sms_hwp, uns8 proc_id, Addr region, uns trigger_offset, uns64 footprint);
+
+/**************************************************************************************/
+
+void pref_sms_init(HWP* hwp) {
+  if (!PREF_SMS_ON)
+    return;
+  hwp->hwp_info->enabled = TRUE;
+
+  ASSERTM(0, is_power_of_2(PREF_SMS_REGION_SIZE) && PREF_SMS_REGION_SIZE >= DCACHE_LINE_SIZE &&
+                 PREF_SMS_REGION_SIZE / DCACHE_LINE_SIZE <= 64,
+          "PREF_SMS_REGION_SIZE must be a power of two between one and 64 lines\n");
+  ASSERTM(0, is_power_of_2(PREF_SMS_PHT_SETS), "PREF_SMS_PHT_SETS must be a power of two\n");
+  sms_region_bits = LOG2(PREF_SMS_REGION_SIZE / DCACHE_LINE_SIZE);
+
+  if (PREF_UMLC_ON) {
+    sms_prefetcher_array.sms_hwp_core_umlc = (Pref_SMS*)malloc(sizeof(Pref_SMS) * NUM_CORES);
+    init_sms(hwp, sms_prefetcher_array.sms_hwp_core_umlc);
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      sms_prefetcher_array.sms_hwp_core_umlc[proc_id].type = UMLC;
+  }
+  if (PREF_UL1_ON) {
+    sms_prefetcher_array.sms_hwp_core_ul1 = (Pref_SMS*)malloc(sizeof(Pref_SMS) * NUM_CORES);
+    init_sms(hwp, sms_prefetcher_array.sms_hwp_core_ul1);
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      sms_prefetcher_array.sms_hwp_core_ul1[proc_id].type = UL1;
+  }
+}
+
+void init_sms(HWP* hwp, Pref_SMS* sms_hwp_core) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    sms_hwp_core[proc_id].hwp_info = hwp->hwp_info;
+    sms_hwp_core[proc_id].filter_table = (SMS_Region_Entry*)calloc(PREF_SMS_FT_ENTRIES, sizeof(SMS_Region_Entry));
+    sms_hwp_core[proc_id].accum_table = (SMS_Region_Entry*)calloc(PREF_SMS_AT_ENTRIES, sizeof(SMS_Region_Entry));
+    sms_hwp_core[proc_id].pht =
+        (SMS_PHT_Entry*)calloc(PREF_SMS_PHT_SETS * PREF_SMS_PHT_WAYS, sizeof(SMS_PHT_Entry));
+  }
+}
+
+void pref_sms_ul1_hit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_sms_train(&sms_prefetcher_array.sms_hwp_core_ul1[proc_id], proc_id, lineAddr, loadPC, TRUE);
+}
+
+void pref_sms_ul1_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_sms_train(&sms_prefetcher_array.sms_hwp_core_ul1[proc_id], proc_id, lineAddr, loadPC, FALSE);
+}
+
+void pref_sms_umlc_hit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_sms_train(&sms_prefetcher_array.sms_hwp_core_umlc[proc_id], proc_id, lineAddr, loadPC, TRUE);
+}
+
+void pref_sms_umlc_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_sms_train(&sms_prefetcher_array.sms_hwp_core_umlc[proc_id], proc_id, lineAddr, loadPC, FALSE);
+}
+
+void pref_sms_train(Pref_SMS* sms_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC, Flag is_hit) {
+  Addr line_index = lineAddr >> LOG2(DCACHE_LINE_SIZE);
+  Addr region = line_index >> sms_region_bits;
+  uns offset = line_index & N_BIT_MASK(sms_region_bits);
+  SMS_Region_Entry* entry;
+
+  entry = sms_find_region(sms_hwp->accum_table, PREF_SMS_AT_ENTRIES, region);
+  if (entry) {
+    entry->footprint |= 1ULL << offset;
+    entry->last_access = cycle_count;
+    return;
+  }
+
+  entry = sms_find_region(sms_hwp->filter_table, PREF_SMS_FT_ENTRIES, region);
+  if (entry) {
+    entry->last_access = cycle_count;
+    if (offset == entry->trigger_offset)
+      return;
+    // second distinct line: start accumulating, ending the oldest generation if needed
+    SMS_Region_Entry* accum = sms_victim_region(sms_hwp->accum_table, PREF_SMS_AT_ENTRIES);
+    if (accum->valid)
+      sms_commit_pattern(sms_hwp, accum);
+    *accum = *entry;
+    accum->footprint |= 1ULL << offset;
+    entry->valid = FALSE;
+    return;
+  }
+
+  // only a miss can trigger a new region
+  if (is_hit || loadPC == 0)
+    return;
+
+  STAT_EVENT(proc_id, PREF_SMS_TRIGGER);
+  entry = sms_victim_region(sms_hwp->filter_table, PREF_SMS_FT_ENTRIES);
+  entry->valid = TRUE;
+  entry->region = region;
+  entry->trigger_pc = loadPC;
+  entry->trigger_offset = offset;
+  entry->footprint = 1ULL << offset;
+  entry->last_access = cycle_count;
+
+  uns32 tag;
+  SMS_PHT_Entry* set = sms_pht_set(sms_hwp, loadPC, offset, &tag);
+  for (uns ii = 0; ii < PREF_SMS_PHT_WAYS; ii++) {
+    if (set[ii].valid && set[ii].tag == tag) {
+      STAT_EVENT(proc_id, PREF_SMS_PHT_HIT);
+      set[ii].last_access = cycle_count;
+      sms_issue_footprint(sms_hwp, proc_id, region, offset, set[ii].footprint);
+      break;
+    }
+  }
+}
+
+/* lookups are a linear tag scan; the tables are a few dozen entries */
+static SMS_Region_Entry* sms_find_region(SMS_Region_Entry* table, uns entries, Addr region) {
+  for (uns ii = 0; ii < entries; ii++) {
+    if (table[ii].valid && table[ii].region == region)
+      return &table[ii];
+  }
+  return NULL;
+}
+
+static SMS_Region_Entry* sms_victim_region(SMS_Region_Entry* table, uns entries) {
+  SMS_Region_Entry* victim = &table[0];
+  for (uns ii = 0; ii < entries; ii++) {
+    if (!table[ii].valid)
+      return &table[ii];
+    if (table[ii].last_access < victim->last_access)
+      victim = &table[ii];
+  }
+  return victim;
+}
+
+static SMS_PHT_Entry* sms_pht_set(Pref_SMS* sms_hwp, Addr pc, uns offset, uns32* tag) {
+  uns64 key = (pc << sms_region_bits) | offset;
+  key ^= key >> 29;
+  *tag = (uns32)(key >> LOG2(PREF_SMS_PHT_SETS));
+  return &sms_hwp->pht[(key & (PREF_SMS_PHT_SETS - 1)) * PREF_SMS_PHT_WAYS];
+}
+
+static void sms_commit_pattern(Pref_SMS* sms_hwp, const SMS_Region_Entry* region) {
+  uns32 tag;
+  SMS_PHT_Entry* set = sms_pht_set(sms_hwp, region->trigger_pc, region->trigger_offset, &tag);
+  SMS_PHT_Entry* victim = &set[0];
+  for (uns ii = 0; ii < PREF_SMS_PHT_WAYS; ii++) {
+    if (set[ii].valid && set[ii].tag == tag) {
+      victim = &set[ii];
+      break;
+    }
+    if (!set[ii].valid || (victim->valid && set[ii].last_access < victim->last_access))
+      victim = &set[ii];
+  }
+  victim->valid = TRUE;
+  victim->tag = tag;
+  victim->footprint = region->footprint;
+  victim->last_access = cycle_count;
+}
+
+static void sms_issue_footprint(Pref_SMS* sms_hwp, uns8 proc_id, Addr region, uns trigger_offset, uns64 footprint) {
+  uns64 lines = footprint & ~(1ULL << trigger_offset);
+  uns sent = 0;
+  while (lines && (!PREF_SMS_DEGREE || sent < PREF_SMS_DEGREE)) {
+    Addr pref_index = (region << sms_region_bits) + __builtin_ctzll(lines);
+    lines &= lines - 1;
+    Flag queued = sms_hwp->type == UMLC ? pref_addto_umlc_req_queue(proc_id, pref_index, sms_hwp->hwp_info->id)
+                                        : pref_addto_ul1req_queue(proc_id, pref_index, sms_hwp->hwp_info->id);
+    if (!queued)
+      break;  // q is full
+    DEBUG(proc_id, "SMS prefetch line index %llx\n", pref_index);
+    sent++;
+  }
+  INC_STAT_EVENT(proc_id, PREF_SMS_ISSUED, sent);
+}
@@ -0,0 +1,81 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : pref_sms.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Spatial region prefetcher (Spatial Memory Streaming): learns the
+ *                footprint of lines touched in a region and replays it on the next
+ *                trigger access by the same PC and offset
+ ***************************************************************************************/
+#ifndef __PREF_SMS_H__
+#define __PREF_SMS_H__
+
+#include "pref_common.h"
+
+/* A region that is being observed: in the filter table after its trigger access, in the
+   accumulation table once a second line of it is touched */
+typedef struct SMS_Region_Entry_Struct {
+  Flag valid;
+  Addr region;  // line index >> log2(lines per region)
+  Addr trigger_pc;
+  uns trigger_offset;
+  uns64 footprint;  // bit i set: line i of the region was touched
+  Counter last_access;
+} SMS_Region_Entry;
+
+typedef struct SMS_PHT_Entry_Struct {
+  Flag valid;
+  uns32 tag;
+  uns64 footprint;
+  Counter last_access;
+} SMS_PHT_Entry;
+
+typedef struct Pref_SMS_Struct {
+  HWP_Info* hwp_info;
+  SMS_Region_Entry* filter_table;
+  SMS_Region_Entry* accum_table;
+  SMS_PHT_Entry* pht;  // PREF_SMS_PHT_SETS x PREF_SMS_PHT_WAYS
+  CacheLevel type;
+} Pref_SMS;
+
+typedef struct {
+  Pref_SMS* sms_hwp_core_ul1;
+  Pref_SMS* sms_hwp_core_umlc;
+} sms_prefetchers;
+
+/*************************************************************/
+/* HWP Interface */
+void pref_sms_init(HWP* hwp);
+
+void pref_sms_ul1_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+void pref_sms_ul1_hit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+void pref_sms_umlc_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+void pref_sms_umlc_hit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+
+/*************************************************************/
+/* Internal Function */
+void init_sms(HWP* hwp, Pref_SMS* sms_hwp_core);
+void pref_sms_train(Pref_SMS* sms_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC, Flag is_hit);
+
+#endif /*  __PREF_SMS_H__*/
@@ -63,12 +63,17 @@
 /**************************************************************************************/
 /* Global Variables */
 
-extern Dcache_Stage* dc;
+extern CORE_LOCAL Dcache_Stage* dc;
 
 /***************************************************************************************/
 /* Local Prototypes */
 
 static void collect_stream_stats(const Stream_Buffer* stream);
+static Pref_Stream_Index* pref_stream_index_alloc(void);
+static void pref_stream_index_sync(Pref_Stream* pref_stream, int ii);
+static void pref_stream_index_lookup(Pref_Stream* pref_stream, Addr line_index, int extra_dis, int* trained_index,
+                                     int* training_index);
+static int pref_stream_index_victim(Pref_Stream* pref_stream);
 
 /**************************************************************************************/
 /* stream prefetcher  */
@@ -102,6 +107,7 @@ void pref_stream_init(HWP* hwp) {
           "buffers\n");
 
   hwp->hwp_info->enabled = TRUE;
+  hwp->hwp_info->dyn_degree_user = TRUE;
 
   if (PREF_UMLC_ON) {
     stream_prefetchers_array.pref_stream_core_umlc = (Pref_Stream*)malloc(sizeof(Pref_Stream) * NUM_CORES);
@@ -114,13 +120,14 @@ void pref_stream_init(HWP* hwp) {
 }
 
 void init_stream_core(HWP* hwp, Pref_Stream* pref_stream_core) {
-  uns8 proc_id;
+  uns proc_id;
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     pref_stream_core[proc_id].hwp_info = hwp->hwp_info;
 
     if (PREF_STREAM_PER_CORE_ENABLE) {
       pref_stream_core[proc_id].stream = (Stream_Buffer*)calloc(STREAM_BUFFER_N, sizeof(Stream_Buffer));
       memset(pref_stream_core[proc_id].stream, 0, STREAM_BUFFER_N * sizeof(Stream_Buffer));
+      pref_stream_core[proc_id].index = pref_stream_index_alloc();
       pref_stream_core[proc_id].train_filter = (Addr*)calloc(TRAIN_FILTER_SIZE, sizeof(Addr));
       memset(pref_stream_core[proc_id].train_filter, 0, TRAIN_FILTER_SIZE * sizeof(Addr));
       pref_stream_core[proc_id].train_filter_no = (int*)malloc(sizeof(int));
@@ -148,6 +155,7 @@ void init_stream_core(HWP* hwp, Pref_Stream* pref_stream_core) {
   if (!PREF_STREAM_PER_CORE_ENABLE) {
     pref_stream_core[0].stream = (Stream_Buffer*)calloc(STREAM_BUFFER_N, sizeof(Stream_Buffer));
     memset(pref_stream_core[0].stream, 0, STREAM_BUFFER_N * sizeof(Stream_Buffer));
+    pref_stream_core[0].index = pref_stream_index_alloc();
     pref_stream_core[0].train_filter = (Addr*)calloc(TRAIN_FILTER_SIZE, sizeof(Addr));
     memset(pref_stream_core[0].train_filter, 0, TRAIN_FILTER_SIZE * sizeof(Addr));
     pref_stream_core[0].train_filter_no = (int*)malloc(sizeof(int));
@@ -155,6 +163,7 @@ void init_stream_core(HWP* hwp, Pref_Stream* pref_stream_core) {
 
     for (proc_id = 1; proc_id < NUM_CORES; proc_id++) {
       pref_stream_core[proc_id].stream = pref_stream_core[0].stream;
+      pref_stream_core[proc_id].index = pref_stream_core[0].index;
       pref_stream_core[proc_id].train_filter = pref_stream_core[0].train_filter;
       pref_stream_core[proc_id].train_filter_no = pref_stream_core[0].train_filter_no;
     }
@@ -183,7 +192,7 @@ void pref_stream_train(Pref_Stream* pref_stream, uns8 proc_id, Addr line_addr, A
         pref_stream_throttle_streams(pref_stream, line_index);
     }
 
-    if (PREF_THROTTLEFB_ON) {
+    if (PREF_THROTTLEFB_ON || PREF_BW_THROTTLE_ON) {
       pref_stream_throttle_fb(pref_stream, proc_id);
     }
 
@@ -200,6 +209,7 @@ void pref_stream_train(Pref_Stream* pref_stream, uns8 proc_id, Addr line_addr, A
 
     if (stream->trained) {
       stream->lru = cycle_count;  // update lru
+      pref_stream_index_sync(pref_stream, hit_index);
       STAT_EVENT(0, HIT_TRAIN_STREAM);
       stream->pause = SAT_DEC(stream->pause, 0);
       if (stream->pause > 0)
@@ -219,11 +229,12 @@ void pref_stream_train(Pref_Stream* pref_stream, uns8 proc_id, Addr line_addr, A
           return;
         }
 
-        ASSERT(proc_id, proc_id == stream->ep >> (58 - LOG2(DCACHE_LINE_SIZE)));
+        ASSERT(proc_id, proc_id == stream->ep >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE)));
         // IBM traces: some wrap over becaseu of too small or too large
         // addresses
-        if (proc_id != (stream->ep + stream->dir) >> (58 - LOG2(DCACHE_LINE_SIZE))) {
+        if (proc_id != (stream->ep + stream->dir) >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE))) {
           stream->valid = FALSE;
+          pref_stream_index_sync(pref_stream, hit_index);
           return;
         }
 
@@ -251,6 +262,7 @@ void pref_stream_train(Pref_Stream* pref_stream, uns8 proc_id, Addr line_addr, A
           stream->buffer_full = TRUE;
           stream->sp = stream->sp + stream->dir;
         }
+        pref_stream_index_sync(pref_stream, hit_index);
 
         if (REMOVE_REDUNDANT_STREAM)
           pref_stream_remove_redundant_stream(pref_stream, hit_index);
@@ -296,61 +308,58 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
   int ii;
   int dir;
   int lru_index = -1;
+  int trained_index, training_index;
   Flag found_closeby = FALSE;
   Addr line_index = line_addr >> LOG2(DCACHE_LINE_SIZE);
 
   ASSERTM(proc_id, extra_dis == 0 || (!train && !create),
           "extra_dis should not be used when altering prefetcher state\n");
 
+  pref_stream_index_lookup(pref_stream, line_index, extra_dis, &trained_index, &training_index);
+
   // First check for a trained buffer
-  for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
-    Stream_Buffer* stream = &pref_stream->stream[ii];
-    if (stream->valid && stream->trained) {
-      if (((stream->sp <= line_index) && (stream->ep + extra_dis >= line_index) && (stream->dir == 1)) ||
-          ((stream->sp >= line_index) && (stream->ep - extra_dis <= line_index) && (stream->dir == -1))) {
-        // found a trained buffer
-        ASSERT(proc_id, proc_id == stream->proc_id);
-        if (train)
-          stream->train_hit++;
-        return ii;
-      }
-    }
+  if (trained_index != -1) {
+    Stream_Buffer* stream = &pref_stream->stream[trained_index];
+    // found a trained buffer
+    ASSERT(proc_id, proc_id == stream->proc_id);
+    if (train)
+      stream->train_hit++;
+    return trained_index;
   }
 
   if (train || create) {
-    for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
+    if (training_index != -1) {
+      ii = training_index;
       Stream_Buffer* stream = &pref_stream->stream[ii];
-      if (stream->valid && !stream->trained) {
-        if ((stream->sp <= (line_index + STREAM_TRAIN_LENGTH)) && (stream->sp >= (line_index - STREAM_TRAIN_LENGTH))) {
-          ASSERT(proc_id, proc_id == stream->proc_id);
-
-          if (train) {  // do these only if we are training
-            // decide the train dir
-            if (stream->sp > line_index)
-              dir = -1;
-            else
-              dir = 1;
-            stream->train_hit++;
-            if (stream->train_hit > pref_stream->train_num) {
-              stream->trained = TRUE;
-              stream->start_vline = stream->sp;
-              stream->ep = (dir > 0) ? line_index + STREAM_START_DIS : line_index - STREAM_START_DIS;  // BUG: 57
-              // check for address space overflow
-              if (get_proc_id_from_cmp_addr(stream->ep << LOG2(DCACHE_LINE_SIZE)) != proc_id) {
-                stream->valid = FALSE;
-                return -1;
-              }
-              stream->dir = dir;
-              DEBUG(proc_id,
-                    "stream  trained stream_index:%3d sp %7s ep %7s dir %2d "
-                    "miss_index %7d\n",
-                    ii, hexstr64(stream->sp), hexstr64(stream->ep), stream->dir, (int)line_index);
-            }
+      ASSERT(proc_id, proc_id == stream->proc_id);
+
+      if (train) {  // do these only if we are training
+        // decide the train dir
+        if (stream->sp > line_index)
+          dir = -1;
+        else
+          dir = 1;
+        stream->train_hit++;
+        if (stream->train_hit > pref_stream->train_num) {
+          stream->trained = TRUE;
+          stream->start_vline = stream->sp;
+          stream->ep = (dir > 0) ? line_index + STREAM_START_DIS : line_index - STREAM_START_DIS;  // BUG: 57
+          // check for address space overflow
+          if (get_proc_id_from_cmp_addr(stream->ep << LOG2(DCACHE_LINE_SIZE)) != proc_id) {
+            stream->valid = FALSE;
+            pref_stream_index_sync(pref_stream, ii);
+            return -1;
           }
-
-          return ii;
+          stream->dir = dir;
+          pref_stream_index_sync(pref_stream, ii);
+          DEBUG(proc_id,
+                "stream  trained stream_index:%3d sp %7s ep %7s dir %2d "
+                "miss_index %7d\n",
+                ii, hexstr64(stream->sp), hexstr64(stream->ep), stream->dir, (int)line_index);
         }
       }
+
+      return ii;
     }
 
     if (!create || found_closeby)
@@ -358,28 +367,14 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
   }
 
   if (create) {
-    // search for invalid buffer
-    for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
-      if (!pref_stream->stream[ii].valid) {
-        lru_index = ii;
-        break;
-      }
-    }
+    // an invalid buffer if there is one, else the oldest buffer
+    lru_index = pref_stream_index_victim(pref_stream);
 
-    // search for oldest buffer
-
-    if (lru_index == -1) {
-      lru_index = 0;
-
-      for (ii = 0; ii < STREAM_BUFFER_N; ii++) {
-        if (pref_stream->stream[ii].lru < pref_stream->stream[lru_index].lru) {
-          lru_index = ii;
-        }
-      }
+    if (pref_stream->stream[lru_index].valid) {
       STAT_EVENT(0, REPLACE_OLD_STREAM);
       collect_stream_stats(&pref_stream->stream[lru_index]);
       if (PREF_STREAM_PER_CORE_ENABLE) {
-        uns8 proc_id2 = pref_stream->stream[lru_index].sp >> (58 - LOG2(DCACHE_LINE_SIZE));
+        uns8 proc_id2 = pref_stream->stream[lru_index].sp >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE));
         ASSERT(proc_id, proc_id == proc_id2);
       }
     }
@@ -399,6 +394,7 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
     lru_stream->length = STREAM_LENGTH;
     lru_stream->pref_issued = 0;
     lru_stream->pref_useful = 0;
+    pref_stream_index_sync(pref_stream, lru_index);
 
     STAT_EVENT_ALL(STREAM_TRAIN_CREATE);
     STAT_EVENT(proc_id, CORE_STREAM_TRAIN_CREATE);
@@ -410,6 +406,219 @@ int pref_stream_train_create_stream_buffer(Pref_Stream* pref_stream, uns8 proc_i
   return -1;
 }
 
+/**************************************************************************************/
+/* Stream index: region hash from line to stream and lru order of the valid streams */
+
+static inline Flag pref_stream_trained_match(const Stream_Buffer* stream, Addr line_index, int extra_dis) {
+  return stream->valid && stream->trained &&
+         (((stream->sp <= line_index) && (stream->ep + extra_dis >= line_index) && (stream->dir == 1)) ||
+          ((stream->sp >= line_index) && (stream->ep - extra_dis <= line_index) && (stream->dir == -1)));
+}
+
+static inline Flag pref_stream_training_match(const Stream_Buffer* stream, Addr line_index) {
+  return stream->valid && !stream->trained && (stream->sp <= (line_index + STREAM_TRAIN_LENGTH)) &&
+         (stream->sp >= (line_index - STREAM_TRAIN_LENGTH));
+}
+
+/* lines a lookup can match the stream for, FALSE if there are none */
+static Flag pref_stream_window(const Stream_Buffer* stream, Addr* lo, Addr* hi) {
+  if (!stream->valid)
+    return FALSE;
+  if (!stream->trained) {
+    *lo = stream->sp >= STREAM_TRAIN_LENGTH ? stream->sp - STREAM_TRAIN_LENGTH : 0;
+    *hi = stream->sp + STREAM_TRAIN_LENGTH;
+    return TRUE;
+  }
+  if (stream->dir == 1 && stream->sp <= stream->ep) {
+    *lo = stream->sp;
+    *hi = stream->ep;
+    return TRUE;
+  }
+  if (stream->dir == -1 && stream->ep <= stream->sp) {
+    *lo = stream->ep;
+    *hi = stream->sp;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static inline uns pref_stream_index_bucket(Pref_Stream_Index* index, Addr region) {
+  uns64 hash = region * 0x9e3779b97f4a7c15ULL;
+  return (uns)(hash ^ (hash >> 32)) & index->bucket_mask;
+}
+
+static Pref_Stream_Index* pref_stream_index_alloc(void) {
+  Pref_Stream_Index* index = (Pref_Stream_Index*)calloc(1, sizeof(Pref_Stream_Index));
+  uns num_buckets = 1;
+  while (num_buckets < 2 * STREAM_BUFFER_N * PREF_STREAM_INDEX_SPAN)
+    num_buckets <<= 1;
+  index->bucket_heads = (int*)malloc(sizeof(int) * num_buckets);
+  for (uns ii = 0; ii < num_buckets; ii++)
+    index->bucket_heads[ii] = -1;
+  index->bucket_mask = num_buckets - 1;
+
+  index->slots = (Pref_Stream_Slot*)calloc(STREAM_BUFFER_N, sizeof(Pref_Stream_Slot));
+  index->num_words = (STREAM_BUFFER_N + 63) / 64;
+  index->wide_bits = (uns64*)calloc(index->num_words, sizeof(uns64));
+  index->invalid_bits = (uns64*)calloc(index->num_words, sizeof(uns64));
+  for (uns ii = 0; ii < STREAM_BUFFER_N; ii++) {
+    index->slots[ii].lru_prev = -1;
+    index->slots[ii].lru_next = -1;
+    index->slots[ii].lru_key = MAX_CTR;
+    index->invalid_bits[ii >> 6] |= 1ULL << (ii & 63);
+  }
+  index->lru_head = -1;
+  index->lru_tail = -1;
+  return index;
+}
+
+static void pref_stream_index_unlist(Pref_Stream_Index* index, int ii) {
+  Pref_Stream_Slot* slot = &index->slots[ii];
+  for (uns kk = 0; kk < slot->num_regions; kk++) {
+    int node = ii * PREF_STREAM_INDEX_SPAN + kk;
+    int* link = &index->bucket_heads[pref_stream_index_bucket(index, slot->first_region + kk)];
+    while (*link != node)
+      link = &index->slots[*link / PREF_STREAM_INDEX_SPAN].node_next[*link % PREF_STREAM_INDEX_SPAN];
+    *link = slot->node_next[kk];
+  }
+  slot->num_regions = 0;
+  slot->wide = FALSE;
+  index->wide_bits[ii >> 6] &= ~(1ULL << (ii & 63));
+}
+
+static void pref_stream_index_lru_unlink(Pref_Stream_Index* index, int ii) {
+  Pref_Stream_Slot* slot = &index->slots[ii];
+  if (slot->lru_prev != -1)
+    index->slots[slot->lru_prev].lru_next = slot->lru_next;
+  else
+    index->lru_head = slot->lru_next;
+  if (slot->lru_next != -1)
+    index->slots[slot->lru_next].lru_prev = slot->lru_prev;
+  else
+    index->lru_tail = slot->lru_prev;
+  slot->lru_prev = -1;
+  slot->lru_next = -1;
+  slot->lru_key = MAX_CTR;
+}
+
+/* lru values only move to the current cycle, so the walk from the tail is short */
+static void pref_stream_index_lru_place(Pref_Stream_Index* index, int ii, Counter key) {
+  Pref_Stream_Slot* slot = &index->slots[ii];
+  int prev = index->lru_tail;
+  while (prev != -1 && (index->slots[prev].lru_key > key || (index->slots[prev].lru_key == key && prev > ii)))
+    prev = index->slots[prev].lru_prev;
+
+  int next = prev == -1 ? index->lru_head : index->slots[prev].lru_next;
+  slot->lru_prev = prev;
+  slot->lru_next = next;
+  slot->lru_key = key;
+  if (prev != -1)
+    index->slots[prev].lru_next = ii;
+  else
+    index->lru_head = ii;
+  if (next != -1)
+    index->slots[next].lru_prev = ii;
+  else
+    index->lru_tail = ii;
+}
+
+/* bring the index up to date after stream ii's valid, trained, dir, sp, ep or lru changed */
+static void pref_stream_index_sync(Pref_Stream* pref_stream, int ii) {
+  Pref_Stream_Index* index = pref_stream->index;
+  Pref_Stream_Slot* slot = &index->slots[ii];
+  Stream_Buffer* stream = &pref_stream->stream[ii];
+  Addr lo, hi;
+  Addr first_region = 0;
+  uns num_regions = 0;
+  Flag wide = FALSE;
+
+  if (pref_stream_window(stream, &lo, &hi)) {
+    first_region = lo >> PREF_STREAM_INDEX_REGION_SHIFT;
+    Addr last_region = hi >> PREF_STREAM_INDEX_REGION_SHIFT;
+    if (last_region - first_region >= PREF_STREAM_INDEX_SPAN)
+      wide = TRUE;
+    else
+      num_regions = last_region - first_region + 1;
+  }
+
+  if (wide != slot->wide || num_regions != slot->num_regions || (num_regions && first_region != slot->first_region)) {
+    pref_stream_index_unlist(index, ii);
+    slot->first_region = first_region;
+    slot->num_regions = num_regions;
+    slot->wide = wide;
+    if (wide)
+      index->wide_bits[ii >> 6] |= 1ULL << (ii & 63);
+    for (uns kk = 0; kk < num_regions; kk++) {
+      int* head = &index->bucket_heads[pref_stream_index_bucket(index, first_region + kk)];
+      slot->node_next[kk] = *head;
+      *head = ii * PREF_STREAM_INDEX_SPAN + kk;
+    }
+  }
+
+  if (!stream->valid) {
+    index->invalid_bits[ii >> 6] |= 1ULL << (ii & 63);
+    if (slot->lru_key != MAX_CTR)
+      pref_stream_index_lru_unlink(index, ii);
+  } else {
+    index->invalid_bits[ii >> 6] &= ~(1ULL << (ii & 63));
+    if (slot->lru_key != stream->lru) {
+      if (slot->lru_key != MAX_CTR)
+        pref_stream_index_lru_unlink(index, ii);
+      pref_stream_index_lru_place(index, ii, stream->lru);
+    }
+  }
+}
+
+static inline void pref_stream_index_check(Pref_Stream* pref_stream, int ii, Addr line_index, int extra_dis,
+                                           int* trained_index, int* training_index) {
+  const Stream_Buffer* stream = &pref_stream->stream[ii];
+  if ((*trained_index == -1 || ii < *trained_index) && pref_stream_trained_match(stream, line_index, extra_dis))
+    *trained_index = ii;
+  else if ((*training_index == -1 || ii < *training_index) && pref_stream_training_match(stream, line_index))
+    *training_index = ii;
+}
+
+/* lowest numbered trained and training streams that line_index falls in, -1 if none */
+static void pref_stream_index_lookup(Pref_Stream* pref_stream, Addr line_index, int extra_dis, int* trained_index,
+                                     int* training_index) {
+  Pref_Stream_Index* index = pref_stream->index;
+  *trained_index = -1;
+  *training_index = -1;
+
+  // the windows are listed for extra_dis == 0 only
+  if (extra_dis) {
+    for (int ii = 0; ii < (int)STREAM_BUFFER_N; ii++)
+      pref_stream_index_check(pref_stream, ii, line_index, extra_dis, trained_index, training_index);
+    return;
+  }
+
+  Addr region = line_index >> PREF_STREAM_INDEX_REGION_SHIFT;
+  for (int node = index->bucket_heads[pref_stream_index_bucket(index, region)]; node != -1;) {
+    int ii = node / PREF_STREAM_INDEX_SPAN;
+    int kk = node % PREF_STREAM_INDEX_SPAN;
+    if (index->slots[ii].first_region + kk == region)
+      pref_stream_index_check(pref_stream, ii, line_index, 0, trained_index, training_index);
+    node = index->slots[ii].node_next[kk];
+  }
+
+  for (uns ww = 0; ww < index->num_words; ww++) {
+    for (uns64 bits = index->wide_bits[ww]; bits; bits &= bits - 1)
+      pref_stream_index_check(pref_stream, ww * 64 + __builtin_ctzll(bits), line_index, 0, trained_index,
+                              training_index);
+  }
+}
+
+/* lowest numbered invalid stream, else the least recently used one */
+static int pref_stream_index_victim(Pref_Stream* pref_stream) {
+  Pref_Stream_Index* index = pref_stream->index;
+  for (uns ww = 0; ww < index->num_words; ww++) {
+    if (index->invalid_bits[ww])
+      return ww * 64 + __builtin_ctzll(index->invalid_bits[ww]);
+  }
+  ASSERT(0, index->lru_head != -1);
+  return index->lru_head;
+}
+
 void collect_stream_stats(const Stream_Buffer* stream) {
   uns len;
   if (stream->dir == 0 || !stream->trained) {
@@ -421,7 +630,7 @@ void collect_stream_stats(const Stream_Buffer* stream) {
   }
 
   if (len != 0) {
-    uns8 proc_id = stream->sp >> (58 - LOG2(DCACHE_LINE_SIZE));
+    uns8 proc_id = stream->sp >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE));
     STAT_EVENT(proc_id, CORE_STREAM_LENGTH_0 + MIN2(len / 10, 10));
     INC_STAT_EVENT(proc_id, CORE_CUM_STREAM_LENGTH_0 + MIN2(len / 10, 10), len);
     STAT_EVENT(proc_id, CORE_STREAM_TRAIN_HITS_0 + MIN2(stream->train_hit / 10, 10));
@@ -497,6 +706,7 @@ void pref_stream_remove_redundant_stream(Pref_Stream* pref_stream, int hit_index
     if ((stream->ep < hit_stream->ep && stream->ep > hit_stream->sp) ||
         (stream->sp < hit_stream->ep && stream->sp > hit_stream->sp)) {
       stream->valid = FALSE;
+      pref_stream_index_sync(pref_stream, ii);
       STAT_EVENT(0, REMOVE_REDUNDANT_STREAM_STAT);
       DEBUG(0, "stream[%d] sp:0x%s ep:0x%s is removed by stream[%d] sp:0x%s ep:0x%s\n", ii, hexstr64(stream->sp),
             hexstr64(stream->ep), hit_index, hexstr64(hit_stream->sp), hexstr64(hit_stream->ep));
@@ -575,7 +785,7 @@ void pref_stream_per_core_done(uns proc_id) {
   if (PREF_UL1_ON) {
     for (uns ii = 0; ii < STREAM_BUFFER_N; ii++) {
       Stream_Buffer* stream = &stream_prefetchers_array.pref_stream_core_ul1[proc_id].stream[ii];
-      if (PREF_STREAM_PER_CORE_ENABLE || (stream->sp >> (58 - LOG2(DCACHE_LINE_SIZE))) == proc_id) {
+      if (PREF_STREAM_PER_CORE_ENABLE || (stream->sp >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE))) == proc_id) {
         collect_stream_stats(stream);
       }
     }
@@ -583,7 +793,7 @@ void pref_stream_per_core_done(uns proc_id) {
   if (PREF_UMLC_ON) {
     for (uns ii = 0; ii < STREAM_BUFFER_N; ii++) {
       Stream_Buffer* stream = &stream_prefetchers_array.pref_stream_core_umlc[proc_id].stream[ii];
-      if (PREF_STREAM_PER_CORE_ENABLE || (stream->sp >> (58 - LOG2(DCACHE_LINE_SIZE))) == proc_id) {
+      if (PREF_STREAM_PER_CORE_ENABLE || (stream->sp >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE))) == proc_id) {
         collect_stream_stats(stream);
       }
     }
@@ -594,7 +804,8 @@ void pref_stream_throttle_fb(Pref_Stream* pref_stream, uns8 proc_id) {
   if (PREF_DHAL) {  // on pref_dhal, we update the dyn_degree based on sent pref
     pref_stream->distance = pref_stream->hwp_info->dyn_degree_core[proc_id];
   } else {
-    pref_get_degfb(proc_id, pref_stream->hwp_info->id);
+    if (!PREF_BW_THROTTLE_ON)  // else pref_bw_throttle_update sets the level
+      pref_get_degfb(proc_id, pref_stream->hwp_info->id);
     ASSERTM(0,
             pref_stream->hwp_info->dyn_degree_core[proc_id] >= 0 &&
                 pref_stream->hwp_info->dyn_degree_core[proc_id] <= PREF_MAX_DEGFB,
@@ -50,7 +50,7 @@ struct Stream_Buffer_struct {
   Addr ep;
   Addr start_vline;
   int dir;
-  int lru;
+  Counter lru;
   Flag valid;
   Flag buffer_full;
   Flag trained;
@@ -62,6 +62,35 @@ struct Stream_Buffer_struct {
   uns pref_useful;
 };
 
+/* Lookup structures over a stream table. Each stream is listed under the
+ * regions of 2^PREF_STREAM_INDEX_REGION_SHIFT lines its matching window touches.
+ * The window is [sp, ep] for a trained stream and sp +- STREAM_TRAIN_LENGTH for
+ * a training one. A window wider than PREF_STREAM_INDEX_SPAN regions is marked
+ * wide and checked on every lookup instead. */
+#define PREF_STREAM_INDEX_REGION_SHIFT 6
+#define PREF_STREAM_INDEX_SPAN 4
+
+typedef struct Pref_Stream_Slot_struct {
+  Addr first_region; // first region the stream is listed under
+  uns num_regions;   // regions it is listed under, 0 if none
+  Flag wide;         // window too wide to list
+  int lru_prev;      // neighbours on the lru list, -1 at the ends
+  int lru_next;
+  Counter lru_key;   // lru value the stream is ordered by, MAX_CTR if it is not on the list
+  int node_next[PREF_STREAM_INDEX_SPAN]; // next region node in the same bucket, -1 at the end
+} Pref_Stream_Slot;
+
+typedef struct Pref_Stream_Index_struct {
+  Pref_Stream_Slot* slots; // [STREAM_BUFFER_N], region node n belongs to slot n / PREF_STREAM_INDEX_SPAN
+  int* bucket_heads;       // first region node of each hash bucket, -1 if empty
+  uns bucket_mask;
+  uns64* wide_bits;        // streams marked wide
+  uns64* invalid_bits;     // streams that are not valid
+  uns num_words;           // words in each bitvector
+  int lru_head;            // valid streams ordered by (lru, index), least recent first
+  int lru_tail;
+} Pref_Stream_Index;
+
 // stream HWP
 typedef struct Pref_Stream_struct {
   HWP_Info* hwp_info;
@@ -69,6 +98,7 @@ typedef struct Pref_Stream_struct {
   // WATCHOUT These are shared by cores or duplicated based on
   // PREF_STREAM_PER_CORE_ENABLE
   Stream_Buffer* stream;
+  Pref_Stream_Index* index;
   Addr* train_filter;
   int* train_filter_no;
   ////////////////////////////////////////////////
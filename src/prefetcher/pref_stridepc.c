@@ -85,7 +85,7 @@ void pref_stridepc_init(HWP* hwp) {
 }
 
 void init_stridepc(HWP* hwp, Pref_StridePC* stridepc_hwp_core) {
-  uns8 proc_id;
+  uns proc_id;
 
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     stridepc_hwp_core[proc_id].hwp_info = hwp->hwp_info;
@@ -110,6 +110,20 @@ void pref_stridepc_umlc_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 glo
   pref_stridepc_train(&stridepc_prefetche_array.stridepc_hwp_core_umlc[proc_id], proc_id, lineAddr, loadPC, FALSE);
 }
 
+void pref_stridepc_train_batch(const Pref_Train_Event* events, uns num_events) {
+  for (uns ii = 0; ii < num_events; ii++) {
+    const Pref_Train_Event* e = &events[ii];
+    Flag ul1 = e->type == PREF_TRAIN_UL1_MISS || e->type == PREF_TRAIN_UL1_HIT;
+    Flag umlc = e->type == PREF_TRAIN_UMLC_MISS || e->type == PREF_TRAIN_UMLC_HIT;
+    if (!ul1 && !umlc)
+      continue;  // no training on prefetch hits
+    Pref_StridePC* cores = ul1 ? stridepc_prefetche_array.stridepc_hwp_core_ul1
+                               : stridepc_prefetche_array.stridepc_hwp_core_umlc;
+    pref_stridepc_train(&cores[e->proc_id], e->proc_id, e->line_addr, e->load_PC,
+                        e->type == PREF_TRAIN_UL1_HIT || e->type == PREF_TRAIN_UMLC_HIT);
+  }
+}
+
 void pref_stridepc_train(Pref_StridePC* stridepc_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC, Flag is_hit) {
   int ii;
   int idx = -1;
@@ -186,7 +200,7 @@ void pref_stridepc_train(Pref_StridePC* stridepc_hwp, uns8 proc_id, Addr lineAdd
       for (ii = 0; (ii < PREF_STRIDEPC_DEGREE && entry->pref_sent < PREF_STRIDEPC_DISTANCE); ii++, entry->pref_sent++) {
         pref_index = entry->pref_last_index + entry->stride;
 
-        ASSERT(proc_id, proc_id == (pref_index >> (58 - LOG2(DCACHE_LINE_SIZE))));
+        ASSERT(proc_id, proc_id == (pref_index >> (CMP_ADDR_PROC_ID_SHIFT - LOG2(DCACHE_LINE_SIZE))));
 
         if (stridepc_hwp->type == UMLC) {
           if (!pref_addto_umlc_req_queue(
@@ -64,6 +64,7 @@ void pref_stridepc_ul1_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 glob
 void pref_stridepc_ul1_hit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
 void pref_stridepc_umlc_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
 void pref_stridepc_umlc_hit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+void pref_stridepc_train_batch(const Pref_Train_Event* events, uns num_events);
 
 /*************************************************************/
 /* Internal Function */
@@ -0,0 +1,234 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : pref_triage.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Temporal (Triage) prefetcher with its metadata in reserved L1 ways
+ ***************************************************************************************/
+
+#include "prefetcher/pref_triage.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "core.param.h"
+#include "general.param.h"
+#include "memory/memory.param.h"
+#include "prefetcher/pref.param.h"
+#include "prefetcher/pref_triage.param.h"
+
+#include "memory/memory.h"
+#include "prefetcher/pref_common.h"
+
+#include "statistics.h"
+
+/*
+   Triage prefetcher : a per-PC training unit remembers the last miss line of every load
+   PC. Each new miss of the same PC records the pair (previous line -> this line) in the
+   metadata store, and every miss (or prefetch hit) looks up its own line there to find the
+   successor to prefetch, chasing up to PREF_TRIAGE_DEGREE links.
+
+   The metadata store is the L1_META_WAYS ways that memory.c takes away from every L1 set,
+   split evenly among the cores, so metadata costs exactly the data capacity it occupies.
+   A 64B metadata line holds 16 compressed 4-byte entries (valid, NRU reference bit,
+   confidence bit, 8-bit partial tag, 21-bit signed line delta to the successor); a set
+   is fully associative over its META_WAYS lines. Every metadata read or update takes a
+   read or write port of the L1 bank in the same cycle as demand requests, and is dropped
+   when none is left.
+*/
+
+/**************************************************************************************/
+/* Macros */
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_PREF_TRIAGE, ##args)
+
+#define TRIAGE_VALID 0x80000000u
+#define TRIAGE_REF 0x40000000u
+#define TRIAGE_CONF 0x20000000u
+#define TRIAGE_TAG_SHIFT 21
+#define TRIAGE_TAG_BITS 8
+#define TRIAGE_DELTA_BITS 21
+#define TRIAGE_TAG(e) (((e) >> TRIAGE_TAG_SHIFT) & N_BIT_MASK(TRIAGE_TAG_BITS))
+#define TRIAGE_DELTA(e) ((int32)((e) << (32 - TRIAGE_DELTA_BITS)) >> (32 - TRIAGE_DELTA_BITS))
+#define TRIAGE_DELTA_FIELD(d) ((uns32)(d) & N_BIT_MASK(TRIAGE_DELTA_BITS))
+
+triage_prefetchers triage_prefetcher_array;
+
+static uns triage_meta_sets;
+static uns triage_meta_set_entries;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static uns32* triage_meta_set(Pref_Triage* triage_hwp, Addr line_index, uns32* tag);
+static uns32* triage_meta_find(uns32* set, uns32 tag);
+static void triage_meta_record(Pref_Triage* triage_hwp, uns8 proc_id, Addr line_index, Addr next_line_index);
+static void triage_prefetch(Pref_Triage* triage_hwp, uns8 proc_id, Addr line_index);
+
+/**************************************************************************************/
+
+void pref_triage_init(HWP* hwp) {
+  if (!PREF_TRIAGE_ON)
+    return;
+  hwp->hwp_info->enabled = TRUE;
+
+  ASSERTM(0, L1_META_WAYS, "PREF_TRIAGE_ON needs L1 ways reserved for its metadata (L1_META_WAYS)\n");
+  ASSERTM(0, is_power_of_2(PREF_TRIAGE_TU_ENTRIES), "PREF_TRIAGE_TU_ENTRIES must be a power of two\n");
+  triage_meta_sets = MAX2(1, L1_SIZE / L1_ASSOC / L1_LINE_SIZE / NUM_CORES);
+  triage_meta_set_entries = L1_META_WAYS * (L1_LINE_SIZE / sizeof(uns32));
+
+  if (PREF_UMLC_ON) {
+    triage_prefetcher_array.triage_hwp_core_umlc = (Pref_Triage*)malloc(sizeof(Pref_Triage) * NUM_CORES);
+    init_triage(hwp, triage_prefetcher_array.triage_hwp_core_umlc);
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      triage_prefetcher_array.triage_hwp_core_umlc[proc_id].type = UMLC;
+  }
+  if (PREF_UL1_ON) {
+    triage_prefetcher_array.triage_hwp_core_ul1 = (Pref_Triage*)malloc(sizeof(Pref_Triage) * NUM_CORES);
+    init_triage(hwp, triage_prefetcher_array.triage_hwp_core_ul1);
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      triage_prefetcher_array.triage_hwp_core_ul1[proc_id].type = UL1;
+  }
+}
+
+void init_triage(HWP* hwp, Pref_Triage* triage_hwp_core) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    triage_hwp_core[proc_id].hwp_info = hwp->hwp_info;
+    triage_hwp_core[proc_id].training_unit =
+        (Triage_TU_Entry*)calloc(PREF_TRIAGE_TU_ENTRIES, sizeof(Triage_TU_Entry));
+    triage_hwp_core[proc_id].meta = (uns32*)calloc(triage_meta_sets * triage_meta_set_entries, sizeof(uns32));
+    triage_hwp_core[proc_id].meta_hand = (uns*)calloc(triage_meta_sets, sizeof(uns));
+  }
+}
+
+void pref_triage_ul1_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_triage_train(&triage_prefetcher_array.triage_hwp_core_ul1[proc_id], proc_id, lineAddr, loadPC);
+}
+
+void pref_triage_ul1_prefhit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_triage_train(&triage_prefetcher_array.triage_hwp_core_ul1[proc_id], proc_id, lineAddr, loadPC);
+}
+
+void pref_triage_umlc_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_triage_train(&triage_prefetcher_array.triage_hwp_core_umlc[proc_id], proc_id, lineAddr, loadPC);
+}
+
+void pref_triage_umlc_prefhit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist) {
+  pref_triage_train(&triage_prefetcher_array.triage_hwp_core_umlc[proc_id], proc_id, lineAddr, loadPC);
+}
+
+void pref_triage_train(Pref_Triage* triage_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC) {
+  Addr line_index = lineAddr >> LOG2(DCACHE_LINE_SIZE);
+
+  if (loadPC) {
+    Triage_TU_Entry* tu = &triage_hwp->training_unit[(loadPC ^ (loadPC >> 12)) & (PREF_TRIAGE_TU_ENTRIES - 1)];
+    if (tu->load_pc == loadPC && tu->last_line_index != line_index)
+      triage_meta_record(triage_hwp, proc_id, tu->last_line_index, line_index);
+    tu->load_pc = loadPC;
+    tu->last_line_index = line_index;
+  }
+
+  triage_prefetch(triage_hwp, proc_id, line_index);
+}
+
+static uns32* triage_meta_set(Pref_Triage* triage_hwp, Addr line_index, uns32* tag) {
+  uns64 hash = line_index ^ (line_index >> 17) ^ (line_index >> 31);
+  *tag = (hash / triage_meta_sets) & N_BIT_MASK(TRIAGE_TAG_BITS);
+  return &triage_hwp->meta[(hash % triage_meta_sets) * triage_meta_set_entries];
+}
+
+static uns32* triage_meta_find(uns32* set, uns32 tag) {
+  for (uns ii = 0; ii < triage_meta_set_entries; ii++) {
+    if ((set[ii] & TRIAGE_VALID) && TRIAGE_TAG(set[ii]) == tag)
+      return &set[ii];
+  }
+  return NULL;
+}
+
+static void triage_meta_record(Pref_Triage* triage_hwp, uns8 proc_id, Addr line_index, Addr next_line_index) {
+  int64 delta = (int64)(next_line_index - line_index);
+  if (delta >= (1 << (TRIAGE_DELTA_BITS - 1)) || delta < -(1 << (TRIAGE_DELTA_BITS - 1))) {
+    STAT_EVENT(proc_id, PREF_TRIAGE_DELTA_OVERFLOW);
+    return;
+  }
+  if (!mem_l1_get_port(proc_id, line_index << LOG2(DCACHE_LINE_SIZE), TRUE)) {
+    STAT_EVENT(proc_id, PREF_TRIAGE_PORT_STALL);
+    return;
+  }
+  STAT_EVENT(proc_id, PREF_TRIAGE_UPDATE);
+
+  uns32 tag;
+  uns32* set = triage_meta_set(triage_hwp, line_index, &tag);
+  uns32* entry = triage_meta_find(set, tag);
+  if (entry) {
+    if (TRIAGE_DELTA(*entry) == delta)
+      *entry |= TRIAGE_CONF | TRIAGE_REF;
+    else if (*entry & TRIAGE_CONF)
+      *entry = (*entry & ~TRIAGE_CONF) | TRIAGE_REF;
+    else
+      *entry = TRIAGE_VALID | TRIAGE_REF | (tag << TRIAGE_TAG_SHIFT) | TRIAGE_DELTA_FIELD(delta);
+    return;
+  }
+
+  // NRU clock over the set
+  uns* hand = &triage_hwp->meta_hand[(set - triage_hwp->meta) / triage_meta_set_entries];
+  while ((set[*hand] & TRIAGE_VALID) && (set[*hand] & TRIAGE_REF)) {
+    set[*hand] &= ~TRIAGE_REF;
+    *hand = (*hand + 1) % triage_meta_set_entries;
+  }
+  set[*hand] = TRIAGE_VALID | (tag << TRIAGE_TAG_SHIFT) | TRIAGE_DELTA_FIELD(delta);
+  *hand = (*hand + 1) % triage_meta_set_entries;
+}
+
+static void triage_prefetch(Pref_Triage* triage_hwp, uns8 proc_id, Addr line_index) {
+  for (uns ii = 0; ii < PREF_TRIAGE_DEGREE; ii++) {
+    if (!mem_l1_get_port(proc_id, line_index << LOG2(DCACHE_LINE_SIZE), FALSE)) {
+      STAT_EVENT(proc_id, PREF_TRIAGE_PORT_STALL);
+      return;
+    }
+    STAT_EVENT(proc_id, PREF_TRIAGE_LOOKUP);
+
+    uns32 tag;
+    uns32* set = triage_meta_set(triage_hwp, line_index, &tag);
+    uns32* entry = triage_meta_find(set, tag);
+    if (!entry)
+      return;
+    STAT_EVENT(proc_id, PREF_TRIAGE_META_HIT);
+    *entry |= TRIAGE_REF;
+
+    line_index += TRIAGE_DELTA(*entry);
+    DEBUG(proc_id, "Triage prefetch line index %llx\n", line_index);
+    Flag queued = triage_hwp->type == UMLC ? pref_addto_umlc_req_queue(proc_id, line_index, triage_hwp->hwp_info->id)
+                                           : pref_addto_ul1req_queue(proc_id, line_index, triage_hwp->hwp_info->id);
+    if (!queued)
+      return;  // q is full
+    STAT_EVENT(proc_id, PREF_TRIAGE_ISSUED);
+  }
+}
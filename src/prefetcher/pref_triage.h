@@ -0,0 +1,69 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : pref_triage.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Temporal (Triage) prefetcher: per-PC successor pairs, compressed into
+ *                the L1 ways reserved with L1_META_WAYS
+ ***************************************************************************************/
+#ifndef __PREF_TRIAGE_H__
+#define __PREF_TRIAGE_H__
+
+#include "pref_common.h"
+
+typedef struct Triage_TU_Entry_Struct {
+  Addr load_pc;
+  Addr last_line_index;
+} Triage_TU_Entry;
+
+typedef struct Pref_Triage_Struct {
+  HWP_Info* hwp_info;
+  Triage_TU_Entry* training_unit;
+  /* meta_sets x meta_set_entries packed entries (valid, ref, conf, tag, delta), i.e. the
+     core's share of the L1 metadata ways */
+  uns32* meta;
+  uns* meta_hand;  // per-set NRU replacement hand
+  CacheLevel type;
+} Pref_Triage;
+
+typedef struct {
+  Pref_Triage* triage_hwp_core_ul1;
+  Pref_Triage* triage_hwp_core_umlc;
+} triage_prefetchers;
+
+/*************************************************************/
+/* HWP Interface */
+void pref_triage_init(HWP* hwp);
+
+void pref_triage_ul1_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+void pref_triage_ul1_prefhit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+void pref_triage_umlc_miss(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+void pref_triage_umlc_prefhit(uns8 proc_id, Addr lineAddr, Addr loadPC, uns32 global_hist);
+
+/*************************************************************/
+/* Internal Function */
+void init_triage(HWP* hwp, Pref_Triage* triage_hwp_core);
+void pref_triage_train(Pref_Triage* triage_hwp, uns8 proc_id, Addr lineAddr, Addr loadPC);
+
+#endif /*  __PREF_TRIAGE_H__*/
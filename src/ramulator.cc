@@ -26,10 +26,7 @@
  * Description  : Defines an interface to Ramulator
  ***************************************************************************************/
 
-#include <deque>
-#include <list>
-#include <map>
-#include <utility>
+#include <vector>
 
 #include "ramulator/Config.h"
 #include "ramulator/Request.h"
@@ -38,10 +35,13 @@
 extern "C" {
 #include "globals/assert.h"
 
+#include "debug/sim_probe.h"
+
 #include "general.param.h"
 #include "memory/memory.param.h"
 #include "ramulator.param.h"
 
+#include "memory/analytic_dram.h"
 #include "memory/memory.h"
 
 #include "ramulator.h"
@@ -65,13 +65,122 @@ void init_configs();
 bool try_completing_request(Mem_Req* req);
 void enqueue_response(Request& req);
 
-void stats_callback(int coreid, int type);
+void stats_callback(int coreid, int type, long count);
+
+/* Reads in flight in Ramulator, keyed by line address. The Scarab requests merged into a read (at most one
+ * instruction-side and one data-side request) are kept inline in an open-addressed table with linear probing and
+ * backward-shift deletion, so tracking a read does not allocate. */
+#define INFLIGHT_READ_MAX_REQS 2
+
+struct Inflight_Read {
+  long addr;
+  uns num_reqs;  // 0 marks a free slot
+  Mem_Req* reqs[INFLIGHT_READ_MAX_REQS];
+};
+
+std::vector<Inflight_Read> inflight_read_reqs;
+uns inflight_read_log2 = 0;
+uns inflight_read_count = 0;
+
+/* Completed reads that need to be sent back to Scarab. Ramulator completes them in the order they are due, so they
+ * sit in a ring buffer (grown by doubling when it fills up) and leave from its head. */
+struct Ramulator_Resp {
+  long addr;
+  Mem_Req* req;
+};
+
+std::vector<Ramulator_Resp> resp_queue;
+uns resp_queue_head = 0;
+uns resp_queue_count = 0;
+
+/* Memory cycles Ramulator has not been ticked for yet, and how many of them it can fall behind before a tick could
+ * change more than its clocks. The owed ticks are skipped in one step before the next real tick or request. */
+long owed_ticks = 0;
+long idle_ticks = 0;
+
+static uns inflight_read_hash(long addr, uns log2) {
+  return (uns)(((uns64)addr * 0x9E3779B97F4A7C15ULL) >> (64 - log2));
+}
+
+/* returns the slot of addr, or the free slot where it would go */
+static uns inflight_read_slot(long addr) {
+  uns mask = N_BIT_MASK(inflight_read_log2);
+  uns idx = inflight_read_hash(addr, inflight_read_log2);
+  while (inflight_read_reqs[idx].num_reqs && inflight_read_reqs[idx].addr != addr)
+    idx = (idx + 1) & mask;
+  return idx;
+}
+
+static Inflight_Read* inflight_read_find(long addr) {
+  Inflight_Read* entry = &inflight_read_reqs[inflight_read_slot(addr)];
+  return entry->num_reqs ? entry : NULL;
+}
+
+static void inflight_read_resize(uns log2) {
+  std::vector<Inflight_Read> old_reqs(std::move(inflight_read_reqs));
+  inflight_read_log2 = log2;
+  inflight_read_reqs.assign((size_t)1 << log2, Inflight_Read());
+  for (const Inflight_Read& entry : old_reqs) {
+    if (entry.num_reqs)
+      inflight_read_reqs[inflight_read_slot(entry.addr)] = entry;
+  }
+}
+
+static void inflight_read_add(long addr, Mem_Req* scarab_req) {
+  Inflight_Read* entry = &inflight_read_reqs[inflight_read_slot(addr)];
+  if (!entry->num_reqs) {
+    // keep the table at most half full
+    if (2 * (inflight_read_count + 1) > inflight_read_reqs.size()) {
+      inflight_read_resize(inflight_read_log2 + 1);
+      entry = &inflight_read_reqs[inflight_read_slot(addr)];
+    }
+    entry->addr = addr;
+    inflight_read_count++;
+  }
+  // Can have duplicate Ifetch and Dfetch requests, but only one of each
+  ASSERT(0, entry->num_reqs < INFLIGHT_READ_MAX_REQS);
+  entry->reqs[entry->num_reqs++] = scarab_req;
+}
+
+static void inflight_read_remove(Inflight_Read* entry) {
+  uns mask = N_BIT_MASK(inflight_read_log2);
+  uns hole = entry - inflight_read_reqs.data();
+  inflight_read_reqs[hole].num_reqs = 0;
+  inflight_read_count--;
+  // pull back any later entry of the cluster whose home slot does not lie in (hole, idx]
+  for (uns idx = (hole + 1) & mask; inflight_read_reqs[idx].num_reqs; idx = (idx + 1) & mask) {
+    uns home = inflight_read_hash(inflight_read_reqs[idx].addr, inflight_read_log2);
+    if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+      inflight_read_reqs[hole] = inflight_read_reqs[idx];
+      inflight_read_reqs[idx].num_reqs = 0;
+      hole = idx;
+    }
+  }
+}
+
+static Ramulator_Resp* resp_queue_at(uns pos) {
+  return &resp_queue[(resp_queue_head + pos) & (resp_queue.size() - 1)];
+}
 
-deque<pair<long, Mem_Req*>> resp_queue;  // completed read request that need to
-                                         // send back to Scarab
+static void resp_queue_push(long addr, Mem_Req* scarab_req) {
+  if (resp_queue_count == resp_queue.size()) {
+    std::vector<Ramulator_Resp> grown(2 * resp_queue.size());
+    for (uns pos = 0; pos < resp_queue_count; pos++)
+      grown[pos] = *resp_queue_at(pos);
+    resp_queue.swap(grown);
+    resp_queue_head = 0;
+  }
+  Ramulator_Resp* resp = resp_queue_at(resp_queue_count++);
+  resp->addr = addr;
+  resp->req = scarab_req;
+}
 
-map<long, list<Mem_Req*>> inflight_read_reqs;
-// map<long, Mem_Req*> inflight_read_reqs;
+static void catch_up_ticks() {
+  if (owed_ticks > 0) {
+    wrapper->skip(owed_ticks);
+    owed_ticks = 0;
+  }
+}
 
 void ramulator_init() {
   ASSERTM(0, ICACHE_LINE_SIZE == DCACHE_LINE_SIZE,
@@ -84,31 +193,51 @@ void ramulator_init() {
   configs = new Config();
   init_configs();
 
+  // room for every read the controllers can hold without growing
+  uns log2 = 1;
+  while (((uns)1 << log2) < 4 * RAMULATOR_CHANNELS * RAMULATOR_READQ_ENTRIES)
+    log2++;
+  inflight_read_resize(log2);
+  resp_queue.assign((size_t)1 << log2, Ramulator_Resp());
+
+  // the wrapper is built either way since the power model queries its DRAM organization
   wrapper = new ScarabWrapper(*configs, DCACHE_LINE_SIZE, &stats_callback);
+  if (RAMULATOR_ANALYTIC_MODEL)
+    analytic_dram_init();
 
   DPRINTF("Initialized Ramulator. \n");
 }
 
 void ramulator_finish() {
+  catch_up_ticks();
   wrapper->finish();
 
   delete wrapper;
   delete configs;
 }
 
-void stats_callback(int coreid, int type) {
+void stats_callback(int coreid, int type, long count) {
   switch (type) {
     case int(StatCallbackType::DRAM_ACT):
-      STAT_EVENT(coreid, POWER_DRAM_ACTIVATE);
+      INC_STAT_EVENT(coreid, POWER_DRAM_ACTIVATE, count);
       break;
     case int(StatCallbackType::DRAM_PRE):
-      STAT_EVENT(coreid, POWER_DRAM_PRECHARGE);
+      INC_STAT_EVENT(coreid, POWER_DRAM_PRECHARGE, count);
       break;
     case int(StatCallbackType::DRAM_READ):
-      STAT_EVENT(coreid, POWER_DRAM_READ);
+      INC_STAT_EVENT(coreid, POWER_DRAM_READ, count);
       break;
     case int(StatCallbackType::DRAM_WRITE):
-      STAT_EVENT(coreid, POWER_DRAM_WRITE);
+      INC_STAT_EVENT(coreid, POWER_DRAM_WRITE, count);
+      break;
+    case int(StatCallbackType::DRAM_ROW_HIT):
+      INC_STAT_EVENT(coreid, RAMULATOR_ROW_HIT, count);
+      break;
+    case int(StatCallbackType::DRAM_ROW_MISS):
+      INC_STAT_EVENT(coreid, RAMULATOR_ROW_MISS, count);
+      break;
+    case int(StatCallbackType::DRAM_ROW_CONFLICT):
+      INC_STAT_EVENT(coreid, RAMULATOR_ROW_CONFLICT, count);
       break;
   }
 }
@@ -139,8 +268,13 @@ void init_configs() {
   configs->add("record_cmd_trace", RAMULATOR_REC_CMD_TRACE);
   configs->add("print_cmd_trace", RAMULATOR_PRINT_CMD_TRACE);
   configs->add("use_rest_of_addr_as_row_addr", RAMULATOR_USE_REST_OF_ADDR_AS_ROW_ADDR);
+  configs->add("tick_threads", to_string(RAMULATOR_TICK_THREADS));
+  configs->add("controller", RAMULATOR_CONTROLLER);
 
   configs->add("scheduling_policy", RAMULATOR_SCHEDULING_POLICY);
+  configs->add("sched_quantum", to_string(RAMULATOR_SCHED_QUANTUM));
+  configs->add("sched_alpha", to_string(RAMULATOR_SCHED_ALPHA));
+  configs->add("sched_starvation", to_string(RAMULATOR_SCHED_STARVATION));
   configs->add("readq_entries", to_string(RAMULATOR_READQ_ENTRIES));
   configs->add("writeq_entries", to_string(RAMULATOR_WRITEQ_ENTRIES));
   configs->add("output_dir", OUTPUT_DIR);
@@ -170,39 +304,43 @@ void init_configs() {
 int ramulator_send(Mem_Req* scarab_req) {
   Request req;
 
+  SIM_PROBE2(ramulator_send_begin, scarab_req->proc_id, scarab_req->addr);
   to_ramulator_req(scarab_req, &req);
 
   // printf("Ramulator: Received a (%s) request to address %llu\n",
   // Mem_Req_Type_str(scarab_req->type), scarab_req->addr);
 
   // does inflight_read_reqs have the proc_id in the req?
-  auto it_scarab_req = inflight_read_reqs.find(req.addr);
-  if (it_scarab_req != inflight_read_reqs.end() && req.type == Request::Type::READ) {
+  if (req.type == Request::Type::READ && inflight_read_find(req.addr)) {
     DEBUG(scarab_req->proc_id, "Ramulator: Duplicate (%s) request to address %llx\n",
           Mem_Req_Type_str(scarab_req->type), scarab_req->addr);
-    // Can have duplicate Ifetch and Dfetch requests, but only one of each
-    ASSERT(0, it_scarab_req->second.size() <= 1);
 
     /* save it as an inflight request so later it will be moved to the resp_queue
      * at the same time with the older request */
-    if (req.type == Request::Type::READ)
-      inflight_read_reqs[req.addr].push_back(scarab_req);
+    inflight_read_add(req.addr, scarab_req);
 
     scarab_req->mem_queue_cycle = cycle_count;
+    SIM_PROBE2(ramulator_send_end, scarab_req->proc_id, 1);
     return true;  // a request to the same address is already issued
   }
 
-  bool is_sent = wrapper->send(req);
+  bool is_sent;
+  if (RAMULATOR_ANALYTIC_MODEL) {
+    is_sent = analytic_dram_send(req);
+  } else {
+    catch_up_ticks();
+    is_sent = wrapper->send(req);
+    idle_ticks = 0;  // the queues are no longer empty (or are full)
+  }
 
   if (is_sent) {
     STAT_EVENT(scarab_req->proc_id, POWER_MEMORY_CTRL_ACCESS);
 
     if (req.type == Request::Type::READ) {
-      ASSERTM(0, inflight_read_reqs.find(req.addr) == inflight_read_reqs.end(),
+      ASSERTM(0, !inflight_read_find(req.addr),
               "ERROR: A read request to the same address shouldn't be sent "
               "multiple times to Ramulator\n");
-      // inflight_read_reqs[req.addr] = scarab_req;
-      inflight_read_reqs[req.addr].push_back(scarab_req);
+      inflight_read_add(req.addr, scarab_req);
       STAT_EVENT(scarab_req->proc_id, POWER_MEMORY_CTRL_READ);
     } else if (req.type == Request::Type::WRITE) {
       STAT_EVENT(scarab_req->proc_id, POWER_MEMORY_CTRL_WRITE);
@@ -217,22 +355,32 @@ int ramulator_send(Mem_Req* scarab_req) {
     DEBUG(scarab_req->proc_id, "Ramulator: The request has been rejected. Queue full?\n");
   }
 
+  SIM_PROBE2(ramulator_send_end, scarab_req->proc_id, (int)is_sent);
   return (int)is_sent;
 }
 
+Flag ramulator_has_room(Addr phys_addr, Flag write) {
+  if (RAMULATOR_ANALYTIC_MODEL)
+    return TRUE;
+  // a read to a line already in flight is merged into it
+  if (!write && inflight_read_find(phys_addr))
+    return TRUE;
+  // skipped ticks are idle ones, so the queues are the same as after catching up
+  return wrapper->has_room(phys_addr, write ? Request::Type::WRITE : Request::Type::READ);
+}
+
 void enqueue_response(Request& req) {
   // This should only be called by READ requests
   ASSERTM(0, req.type == Request::Type::READ, "ERROR: Responses should be sent only for read requests! \n");
-  ASSERTM(0, inflight_read_reqs.find(req.addr) != inflight_read_reqs.end(),
+  Inflight_Read* entry = inflight_read_find(req.addr);
+  ASSERTM(0, entry,
           "ERROR: A corresponding Scarab request was not found for the "
           "Ramulator request that read address: %lu\n",
           req.addr);
 
-  auto it_scarab_req = inflight_read_reqs.find(req.addr);
-  for (auto req : it_scarab_req->second)
-    resp_queue.push_back(make_pair(it_scarab_req->first, req));
-  // resp_queue.push_back(make_pair(it_scarab_req->first, it_scarab_req->second));
-  inflight_read_reqs.erase(it_scarab_req);
+  for (uns ii = 0; ii < entry->num_reqs; ii++)
+    resp_queue_push(entry->addr, entry->reqs[ii]);
+  inflight_read_remove(entry);
 }
 
 bool try_completing_request(Mem_Req* req) {
@@ -285,11 +433,22 @@ void to_ramulator_req(const Mem_Req* scarab_req, Request* ramulator_req) {
 }
 
 void ramulator_tick() {
-  wrapper->tick();
+  if (RAMULATOR_ANALYTIC_MODEL) {
+    analytic_dram_tick();
+  } else if (owed_ticks < idle_ticks) {
+    owed_ticks++;
+  } else {
+    catch_up_ticks();
+    wrapper->tick();
+    if (RAMULATOR_SKIP_IDLE_TICKS)
+      idle_ticks = wrapper->idle_ticks();
+  }
 
-  if (resp_queue.size() > 0) {
-    if (try_completing_request(resp_queue.front().second))
-      resp_queue.pop_front();
+  if (resp_queue_count > 0) {
+    if (try_completing_request(resp_queue[resp_queue_head].req)) {
+      resp_queue_head = (resp_queue_head + 1) & (resp_queue.size() - 1);
+      resp_queue_count--;
+    }
   }
 }
 
@@ -309,17 +468,26 @@ int ramulator_get_chip_row_buffer_size() {
   return wrapper->get_chip_row_buffer_size();
 }
 
+int ramulator_bank_prof_num_banks() {
+  return wrapper->bank_prof_num_banks();
+}
+
+void ramulator_bank_prof_read(uns32* acts, uns32* conflicts) {
+  wrapper->bank_prof_read(acts, conflicts);
+}
+
 Mem_Req* ramulator_search_queue(long phys_addr, Mem_Req_Type type) {
   ASSERTM(0,
           (type == MRT_IFETCH) || (type == MRT_DFETCH) || (type == MRT_IPRF) || (type == MRT_DPRF) ||
               (type == MRT_DSTORE) || (type == MRT_MIN_PRIORITY) || (type == MRT_FDIPPRFON) ||
               (type == MRT_FDIPPRFOFF) || (type == MRT_UOCPRF),
           "Ramulator: Cannot search write requests in Ramulator request queue\n");
-  auto it_req = inflight_read_reqs.find(phys_addr);
+  Inflight_Read* entry = inflight_read_find(phys_addr);
 
   // Search request queue
-  if (it_req != inflight_read_reqs.end()) {
-    for (auto req : it_req->second) {
+  if (entry) {
+    for (uns ii = 0; ii < entry->num_reqs; ii++) {
+      Mem_Req* req = entry->reqs[ii];
       if ((req->type == MRT_IFETCH || req->type == MRT_IPRF || req->type == MRT_FDIPPRFON ||
            req->type == MRT_FDIPPRFOFF || req->type == MRT_UOCPRF) &&
           (type == MRT_IFETCH || type == MRT_IPRF || type == MRT_FDIPPRFON || type == MRT_FDIPPRFOFF ||
@@ -332,16 +500,17 @@ Mem_Req* ramulator_search_queue(long phys_addr, Mem_Req_Type type) {
   }
 
   // Search response queue
-  for (auto resp : resp_queue) {
-    if (resp.first == phys_addr) {
-      if ((resp.second->type == MRT_IFETCH || resp.second->type == MRT_IPRF || resp.second->type == MRT_FDIPPRFON ||
-           resp.second->type == MRT_FDIPPRFOFF || resp.second->type == MRT_UOCPRF) &&
+  for (uns pos = 0; pos < resp_queue_count; pos++) {
+    Ramulator_Resp* resp = resp_queue_at(pos);
+    if (resp->addr == phys_addr) {
+      if ((resp->req->type == MRT_IFETCH || resp->req->type == MRT_IPRF || resp->req->type == MRT_FDIPPRFON ||
+           resp->req->type == MRT_FDIPPRFOFF || resp->req->type == MRT_UOCPRF) &&
           (type == MRT_IFETCH || type == MRT_IPRF || type == MRT_FDIPPRFON || type == MRT_FDIPPRFOFF ||
            type == MRT_UOCPRF))
-        return resp.second;
-      else if ((resp.second->type == MRT_DFETCH || resp.second->type == MRT_DPRF || resp.second->type == MRT_DSTORE) &&
+        return resp->req;
+      else if ((resp->req->type == MRT_DFETCH || resp->req->type == MRT_DPRF || resp->req->type == MRT_DSTORE) &&
                (type == MRT_DFETCH || type == MRT_DPRF || type == MRT_DSTORE))
-        return resp.second;
+        return resp->req;
     }
   }
 
@@ -43,6 +43,9 @@ EXTERNC void ramulator_init();
 EXTERNC void ramulator_finish();
 
 EXTERNC int ramulator_send(Mem_Req* scarab_req);
+/* Whether ramulator_send() would take a request of this kind to phys_addr this
+   cycle, so callers can skip building a request that would be rejected */
+EXTERNC Flag ramulator_has_room(Addr phys_addr, Flag write);
 EXTERNC void ramulator_tick();
 
 EXTERNC int ramulator_get_chip_width();
@@ -50,6 +53,11 @@ EXTERNC int ramulator_get_chip_size();
 EXTERNC int ramulator_get_num_chips();
 EXTERNC int ramulator_get_chip_row_buffer_size();
 
+/* Bank contention profile (SET_PROF_DRAM): number of banks over all channels, and
+   their activations and row conflicts since the previous call */
+EXTERNC int ramulator_bank_prof_num_banks();
+EXTERNC void ramulator_bank_prof_read(uns32* acts, uns32* conflicts);
+
 EXTERNC Mem_Req* ramulator_search_queue(long phys_addr, Mem_Req_Type type);
 #undef EXTERNC
 
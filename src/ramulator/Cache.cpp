@@ -67,6 +67,15 @@ Cache::Cache(int size, int assoc, int block_size,
   index_offset = calc_log2(block_size);
   tag_offset = calc_log2(block_num) + index_offset;
 
+  cache_lines.resize(size_t(block_num) * assoc);
+
+  unsigned int mshr_size = 2;
+  while (mshr_size < 2 * this->mshr_entry_num) {
+    mshr_size *= 2;
+  }
+  mshr_table.assign(mshr_size, MSHREntry{0, nullptr, false});
+  mshr_mask = mshr_size - 1;
+
   debug("index_offset %d", index_offset);
   debug("index_mask 0x%x", index_mask);
   debug("tag_offset %d", tag_offset);
@@ -133,14 +142,13 @@ bool Cache::send(Request req) {
     assert(req.type == Request::Type::READ);
     cache_read_access++;
   }
-  // If there isn't a set, create it.
-  auto& lines = get_lines(req.addr);
-  std::list<Line>::iterator line;
-
-  if (is_hit(lines, req.addr, &line)) {
-    lines.push_back(Line(req.addr, get_tag(req.addr), false,
-        line->dirty || (req.type == Request::Type::WRITE)));
-    lines.erase(line);
+  Line* lines = get_set(req.addr);
+  Line* line;
+
+  if (is_hit(req.addr, &line)) {
+    line->addr = req.addr;
+    line->dirty = line->dirty || (req.type == Request::Type::WRITE);
+    touch(line);
     cachesys->hit_list.push_back(
         make_pair(cachesys->clk + latency[int(level)], req));
 
@@ -171,16 +179,16 @@ bool Cache::send(Request req) {
     // Look it up in MSHR entries
     assert(req.type == Request::Type::READ);
     auto mshr = hit_mshr(req.addr);
-    if (mshr != mshr_entries.end()) {
+    if (mshr != nullptr) {
       debug("hit mshr");
       cache_mshr_hit++;
-      mshr->second->dirty = dirty || mshr->second->dirty;
+      mshr->line->dirty = dirty || mshr->line->dirty;
       return true;
     }
 
     // All requests come to this stage will be READ, so they
     // should be recorded in MSHR entries.
-    if (mshr_entries.size() == mshr_entry_num) {
+    if (mshr_count == mshr_entry_num) {
       // When no MSHR entries available, the miss request
       // is stalling.
       cache_mshr_unavailable++;
@@ -195,14 +203,14 @@ bool Cache::send(Request req) {
     }
 
     auto newline = allocate_line(lines, req.addr);
-    if (newline == lines.end()) {
+    if (newline == nullptr) {
       return false;
     }
 
     newline->dirty = dirty;
 
     // Add to MSHR entries
-    mshr_entries.push_back(make_pair(req.addr, newline));
+    insert_mshr(req.addr, newline);
 
     // Send the request to next level;
     if (!is_last_level) {
@@ -217,38 +225,32 @@ bool Cache::send(Request req) {
 
 void Cache::evictline(long addr, bool dirty) {
 
-  auto it = cache_lines.find(get_index(addr));
-  assert(it != cache_lines.end()); // check inclusive cache
-  auto& lines = it->second;
-  auto line = find_if(lines.begin(), lines.end(),
-      [addr, this](Line l){return (l.tag == get_tag(addr));});
-
-  assert(line != lines.end());
+  Line* line = find_line(addr);
+  assert(line != nullptr); // check inclusive cache
   // Update LRU queue. The dirty bit will be set if the dirty
   // bit inherited from higher level(s) is set.
-  lines.push_back(Line(addr, get_tag(addr), false,
-      dirty || line->dirty));
-  lines.erase(line);
+  line->addr = addr;
+  line->lock = false;
+  line->dirty = dirty || line->dirty;
+  touch(line);
 }
 
 std::pair<long, bool> Cache::invalidate(long addr) {
   long delay = latency_each[int(level)];
   bool dirty = false;
 
-  auto& lines = get_lines(addr);
-  if (lines.size() == 0) {
+  if (num_valid(get_set(addr)) == 0) {
     // The line of this address doesn't exist.
     return make_pair(0, false);
   }
-  auto line = find_if(lines.begin(), lines.end(),
-      [addr, this](Line l){return (l.tag == get_tag(addr));});
+  Line* line = find_line(addr);
 
   // If the line is in this level cache, then erase it from
   // the buffer.
-  if (line != lines.end()) {
+  if (line != nullptr) {
     assert(!line->lock);
     debug("invalidate %lx @ level %d", addr, int(level));
-    lines.erase(line);
+    line->valid = false;
   } else {
     // If it's not in current level, then no need to go up.
     return make_pair(delay, false);
@@ -273,8 +275,7 @@ std::pair<long, bool> Cache::invalidate(long addr) {
 }
 
 
-void Cache::evict(std::list<Line>* lines,
-    std::list<Line>::iterator victim) {
+void Cache::evict(Line* victim) {
   debug("level %d miss evict victim %lx", int(level), victim->addr);
   cache_eviction++;
 
@@ -314,48 +315,61 @@ void Cache::evict(std::list<Line>* lines,
     }
   }
 
-  lines->erase(victim);
+  victim->valid = false;
 }
 
-std::list<Cache::Line>::iterator Cache::allocate_line(
-    std::list<Line>& lines, long addr) {
+Cache::Line* Cache::allocate_line(Line* set, long addr) {
   // See if an eviction is needed
-  if (need_eviction(lines, addr)) {
-    // Get victim.
-    // The first one might still be locked due to reorder in MC
-    auto victim = find_if(lines.begin(), lines.end(),
-        [this](Line line) {
-          bool check = !line.lock;
-          if (!is_first_level) {
-            for (auto hc : higher_cache) {
-              if(!check) {
-                return check;
-              }
-              check = check && hc->check_unlock(line.addr);
-            }
+  if (need_eviction(set, addr)) {
+    // Get victim: the least recently used line that is unlocked in
+    // each level. The LRU one might still be locked due to reorder
+    // in MC, so walk the lines from LRU to MRU.
+    Line* victim = nullptr;
+    long after = -1;
+    while (victim == nullptr) {
+      Line* next = nullptr;
+      for (unsigned int i = 0; i < assoc; i++) {
+        if (set[i].valid && set[i].lru > after &&
+            (next == nullptr || set[i].lru < next->lru)) {
+          next = &set[i];
+        }
+      }
+      if (next == nullptr) {
+        return nullptr;  // doesn't exist a line that's already unlocked in each level
+      }
+      after = next->lru;
+      bool check = !next->lock;
+      if (!is_first_level) {
+        for (auto hc : higher_cache) {
+          if (!check) {
+            break;
           }
-          return check;
-        });
-    if (victim == lines.end()) {
-      return victim;  // doesn't exist a line that's already unlocked in each level
+          check = check && hc->check_unlock(next->addr);
+        }
+      }
+      if (check) {
+        victim = next;
+      }
     }
-    assert(victim != lines.end());
-    evict(&lines, victim);
+    evict(victim);
   }
 
   // Allocate newline, with lock bit on and dirty bit off
-  lines.push_back(Line(addr, get_tag(addr)));
-  auto last_element = lines.end();
-  --last_element;
-  return last_element;
+  for (unsigned int i = 0; i < assoc; i++) {
+    if (!set[i].valid) {
+      set[i] = Line(addr, get_tag(addr));
+      touch(&set[i]);
+      return &set[i];
+    }
+  }
+  assert(false);
+  return nullptr;
 }
 
-bool Cache::is_hit(std::list<Line>& lines, long addr,
-    std::list<Line>::iterator* pos_ptr) {
-  auto pos = find_if(lines.begin(), lines.end(),
-      [addr, this](Line l){return (l.tag == get_tag(addr));});
+bool Cache::is_hit(long addr, Line** pos_ptr) {
+  Line* pos = find_line(addr);
   *pos_ptr = pos;
-  if (pos == lines.end()) {
+  if (pos == nullptr) {
     return false;
   }
   return !pos->lock;
@@ -367,33 +381,39 @@ void Cache::concatlower(Cache* lower) {
   lower->higher_cache.push_back(this);
 };
 
-bool Cache::need_eviction(const std::list<Line>& lines, long addr) {
-  if (find_if(lines.begin(), lines.end(),
-      [addr, this](Line l){
-        return (get_tag(addr) == l.tag);})
-      != lines.end()) {
+bool Cache::need_eviction(const Line* set, long addr) {
+  long tag = get_tag(addr);
+  for (unsigned int i = 0; i < assoc; i++) {
     // Due to MSHR, the program can't reach here. Just for checking
-    assert(false);
-  } else {
-    if (lines.size() < assoc) {
-      return false;
-    } else {
-      return true;
+    assert(!(set[i].valid && set[i].tag == tag));
+  }
+  return num_valid(set) == assoc;
+}
+
+void Cache::erase_mshr(MSHREntry* entry) {
+  unsigned int hole = entry - mshr_table.data();
+  mshr_count--;
+  // Shift back the following entries of the probe run that can move
+  // into the hole without passing their home slot.
+  for (unsigned int i = (hole + 1) & mshr_mask; mshr_table[i].used;
+       i = (i + 1) & mshr_mask) {
+    unsigned int home = mshr_slot(mshr_table[i].addr);
+    if (((i - home) & mshr_mask) >= ((i - hole) & mshr_mask)) {
+      mshr_table[hole] = mshr_table[i];
+      hole = i;
     }
   }
+  mshr_table[hole].used = false;
 }
 
 void Cache::callback(Request& req) {
   debug("level %d", int(level));
 
-  auto it = find_if(mshr_entries.begin(), mshr_entries.end(),
-      [&req, this](std::pair<long, std::list<Line>::iterator> mshr_entry) {
-        return (align(mshr_entry.first) == align(req.addr));
-      });
+  auto it = hit_mshr(req.addr);
 
-  if (it != mshr_entries.end()) {
-    it->second->lock = false;
-    mshr_entries.erase(it);
+  if (it != nullptr) {
+    it->line->lock = false;
+    erase_mshr(it);
   }
 
   if (higher_cache.size()) {
@@ -30,10 +30,9 @@
 #include <cassert>
 #include <functional>
 #include <list>
-#include <map>
 #include <memory>
 #include <queue>
-#include <list>
+#include <vector>
 
 namespace ramulator
 {
@@ -65,10 +64,13 @@ public:
     long tag;
     bool lock; // When the lock is on, the value is not valid yet.
     bool dirty;
+    bool valid;
+    long lru; // LRU stamp, higher is more recently used
+    Line(): addr(0), tag(0), lock(false), dirty(false), valid(false), lru(0) {}
     Line(long addr, long tag):
-        addr(addr), tag(tag), lock(true), dirty(false) {}
+        addr(addr), tag(tag), lock(true), dirty(false), valid(true), lru(0) {}
     Line(long addr, long tag, bool lock, bool dirty):
-        addr(addr), tag(tag), lock(lock), dirty(dirty) {}
+        addr(addr), tag(tag), lock(lock), dirty(dirty), valid(true), lru(0) {}
   };
 
   Cache(int size, int assoc, int block_size, int mshr_entry_num,
@@ -101,9 +103,23 @@ protected:
   unsigned int index_offset;
   unsigned int tag_offset;
   unsigned int mshr_entry_num;
-  std::vector<std::pair<long, std::list<Line>::iterator>> mshr_entries;
 
-  std::map<int, std::list<Line> > cache_lines;
+  // The lines of all sets, assoc ways per set. The ways of a set are kept
+  // in no particular order; the LRU order of its valid lines is given by
+  // their lru stamps.
+  std::vector<Line> cache_lines;
+  long lru_clock = 0;
+
+  // MSHR: open-addressed table of the lines being filled, keyed by the
+  // aligned address, with linear probing and backward-shift deletion.
+  struct MSHREntry {
+    long addr; // aligned address
+    Line* line;
+    bool used;
+  };
+  std::vector<MSHREntry> mshr_table;
+  unsigned int mshr_mask;
+  unsigned int mshr_count = 0;
 
   int calc_log2(int val) {
       int n = 0;
@@ -125,6 +141,36 @@ protected:
     return (addr & ~(block_size-1l));
   }
 
+  // First way of the set that holds addr.
+  Line* get_set(long addr) {
+    return &cache_lines[size_t(get_index(addr)) * assoc];
+  }
+
+  // Line of addr in its set (locked or not), or nullptr.
+  Line* find_line(long addr) {
+    Line* set = get_set(addr);
+    long tag = get_tag(addr);
+    for (unsigned int i = 0; i < assoc; i++) {
+      if (set[i].valid && set[i].tag == tag) {
+        return &set[i];
+      }
+    }
+    return nullptr;
+  }
+
+  unsigned int num_valid(const Line* set) const {
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < assoc; i++) {
+      n += set[i].valid;
+    }
+    return n;
+  }
+
+  // Make line the most recently used of its set.
+  void touch(Line* line) {
+    line->lru = ++lru_clock;
+  }
+
   // Evict the cache line from higher level to this level.
   // Pass the dirty bit and update LRU queue.
   void evictline(long addr, bool dirty);
@@ -138,30 +184,27 @@ protected:
   // Evict the victim from current set of lines.
   // First do invalidation, then call evictline(L1 or L2) or send
   // a write request to memory(L3) when dirty bit is on.
-  void evict(std::list<Line>* lines,
-      std::list<Line>::iterator victim);
+  void evict(Line* victim);
 
   // First test whether need eviction, if so, do eviction by
   // calling evict function. Then allocate a new line and return
-  // the iterator points to it.
-  std::list<Line>::iterator allocate_line(
-      std::list<Line>& lines, long addr);
+  // a pointer to it, or nullptr if no line can be evicted.
+  Line* allocate_line(Line* set, long addr);
 
   // Check whether the set to hold addr has space or eviction is
   // needed.
-  bool need_eviction(const std::list<Line>& lines, long addr);
+  bool need_eviction(const Line* set, long addr);
 
   // Check whether this addr is hit and fill in the pos_ptr with
-  // the iterator to the hit line or lines.end()
-  bool is_hit(std::list<Line>& lines, long addr,
-              std::list<Line>::iterator* pos_ptr);
+  // the hit line or nullptr
+  bool is_hit(long addr, Line** pos_ptr);
 
-  bool all_sets_locked(const std::list<Line>& lines) {
-    if (lines.size() < assoc) {
+  bool all_sets_locked(const Line* set) {
+    if (num_valid(set) < assoc) {
       return false;
     }
-    for (const auto& line : lines) {
-      if (!line.lock) {
+    for (unsigned int i = 0; i < assoc; i++) {
+      if (!set[i].lock) {
         return false;
       }
     }
@@ -169,50 +212,51 @@ protected:
   }
 
   bool check_unlock(long addr) {
-    auto it = cache_lines.find(get_index(addr));
-    if (it == cache_lines.end()) {
+    Line* line = find_line(addr);
+    if (line == nullptr) {
       return true;
-    } else {
-      auto& lines = it->second;
-      auto line = find_if(lines.begin(), lines.end(),
-          [addr, this](Line l){return (l.tag == get_tag(addr));});
-      if (line == lines.end()) {
-        return true;
-      } else {
-        bool check = !line->lock;
-        if (!is_first_level) {
-          for (auto hc : higher_cache) {
-            if (!check) {
-              return check;
-            }
-            check = check && hc->check_unlock(line->addr);
-          }
+    }
+    bool check = !line->lock;
+    if (!is_first_level) {
+      for (auto hc : higher_cache) {
+        if (!check) {
+          return check;
         }
-        return check;
+        check = check && hc->check_unlock(line->addr);
       }
     }
+    return check;
   }
 
-  std::vector<std::pair<long, std::list<Line>::iterator>>::iterator
-  hit_mshr(long addr) {
-    auto mshr_it =
-        find_if(mshr_entries.begin(), mshr_entries.end(),
-            [addr, this](std::pair<long, std::list<Line>::iterator>
-                   mshr_entry) {
-              return (align(mshr_entry.first) == align(addr));
-            });
-    return mshr_it;
+  unsigned int mshr_slot(long addr) {
+    unsigned long key = (unsigned long)align(addr) >> index_offset;
+    return (unsigned int)((key * 0x9E3779B97F4A7C15ul) >> 32) & mshr_mask;
+  }
+
+  // MSHR entry of the line of addr, or nullptr.
+  MSHREntry* hit_mshr(long addr) {
+    long line_addr = align(addr);
+    for (unsigned int i = mshr_slot(addr); mshr_table[i].used;
+         i = (i + 1) & mshr_mask) {
+      if (mshr_table[i].addr == line_addr) {
+        return &mshr_table[i];
+      }
+    }
+    return nullptr;
   }
 
-  std::list<Line>& get_lines(long addr) {
-    if (cache_lines.find(get_index(addr))
-        == cache_lines.end()) {
-      cache_lines.insert(make_pair(get_index(addr),
-          std::list<Line>()));
+  void insert_mshr(long addr, Line* line) {
+    unsigned int i = mshr_slot(addr);
+    while (mshr_table[i].used) {
+      i = (i + 1) & mshr_mask;
     }
-    return cache_lines[get_index(addr)];
+    mshr_table[i].addr = align(addr);
+    mshr_table[i].line = line;
+    mshr_table[i].used = true;
+    mshr_count++;
   }
 
+  void erase_mshr(MSHREntry* entry);
 };
 
 class CacheSystem {
@@ -38,6 +38,10 @@ namespace ramulator
         DRAM_PRE,
         DRAM_READ,
         DRAM_WRITE,
+        // counted per core on the hot path and reported once, at finish
+        DRAM_ROW_HIT,
+        DRAM_ROW_MISS,
+        DRAM_ROW_CONFLICT,
         MAX
     };
 
@@ -70,7 +74,9 @@ private:
         // Other
         {"record_cmd_trace", "off"},
         {"print_cmd_trace", "off"},
-        {"use_rest_of_addr_as_row_addr", "on"}
+        {"use_rest_of_addr_as_row_addr", "on"},
+        {"tick_threads", "0"},
+        {"controller", "Controller"}
     };
 
 	template<typename T>
@@ -145,6 +151,7 @@ public:
     int get_cpu_tick() const {return cpu_tick;}
     int get_mem_tick() const {return mem_tick;}
     int get_core_num() const {return core_num;}
+    int get_tick_threads() const {return get_int("tick_threads");}
     long get_expected_limit_insts() const {return expected_limit_insts;}
     long get_warmup_insts() const {return warmup_insts;}
 
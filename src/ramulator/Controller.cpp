@@ -47,7 +47,7 @@ static vector<int> get_offending_subarray(DRAM<SALP>* channel, vector<int> & add
 
 
 template <>
-vector<int> Controller<SALP>::get_addr_vec(SALP::Command cmd, list<Request>::iterator req){
+vector<int> Controller<SALP>::get_addr_vec(SALP::Command cmd, Controller<SALP>::Queue::iterator req){
     if (cmd == SALP::Command::PRE_OTHER)
         return get_offending_subarray(channel, req->addr_vec);
     else
@@ -56,7 +56,7 @@ vector<int> Controller<SALP>::get_addr_vec(SALP::Command cmd, list<Request>::ite
 
 
 template <>
-bool Controller<SALP>::is_ready(list<Request>::iterator req){
+bool Controller<SALP>::is_ready(Controller<SALP>::Queue::iterator req){
     SALP::Command cmd = get_first_cmd(req);
     if (cmd == SALP::Command::PRE_OTHER){
 
@@ -75,20 +75,20 @@ void Controller<ALDRAM>::update_temp(ALDRAM::Temp current_temperature){
 template <>
 void Controller<TLDRAM>::tick(){
     clk++;
-    req_queue_length_sum += readq.size() + writeq.size();
-    read_req_queue_length_sum += readq.size();
-    write_req_queue_length_sum += writeq.size();
+    hot.req_queue_length_sum += readq.size() + writeq.size();
+    hot.read_req_queue_length_sum += readq.size();
+    hot.write_req_queue_length_sum += writeq.size();
 
     /*** 1. Serve completed reads ***/
     if (pending.size()) {
         Request& req = pending[0];
         if (req.depart <= clk) {
           if (req.depart - req.arrive > 1) {
-                  read_latency_sum += req.depart - req.arrive;
+                  hot.read_latency_sum += req.depart - req.arrive;
                   channel->update_serving_requests(
                       req.addr_vec.data(), -1, clk);
           }
-            req.callback(req);
+            complete_read(req);
             pending.pop_front();
         }
     }
@@ -113,8 +113,8 @@ void Controller<TLDRAM>::tick(){
     if (otherq.size())
         queue = &otherq;  // "other" requests are rare, so we give them precedence over reads/writes
 
-    auto req = scheduler->get_head(queue->q);
-    if (req == queue->q.end() || !is_ready(req)) {
+    auto req = scheduler->get_head(*queue);
+    if (req == queue->end() || !is_ready(req)) {
         // we couldn't find a command to schedule -- let's try to be speculative
         auto cmd = TLDRAM::Command::PRE;
         vector<int> victim = rowpolicy->get_victim(cmd);
@@ -133,34 +133,36 @@ void Controller<TLDRAM>::tick(){
         int tx = (channel->spec->prefetch_size * channel->spec->channel_width / 8);
         if (req->type == Request::Type::READ) {
             if (is_row_hit(req)) {
-                ++read_row_hits[coreid];
-                ++row_hits;
+                ++hot.read_row_hits[coreid];
+                ++hot.row_hits;
             } else if (is_row_open(req)) {
-                ++read_row_conflicts[coreid];
-                ++row_conflicts;
+                ++hot.read_row_conflicts[coreid];
+                ++hot.row_conflicts;
+                ++bank_conflicts[bank_index(req->addr_vec)];
             } else {
-                ++read_row_misses[coreid];
-                ++row_misses;
+                ++hot.read_row_misses[coreid];
+                ++hot.row_misses;
             }
-          read_transaction_bytes += tx;
+          hot.read_transaction_bytes += tx;
         } else if (req->type == Request::Type::WRITE) {
           if (is_row_hit(req)) {
-              ++write_row_hits[coreid];
-              ++row_hits;
+              ++hot.write_row_hits[coreid];
+              ++hot.row_hits;
           } else if (is_row_open(req)) {
-              ++write_row_conflicts[coreid];
-              ++row_conflicts;
+              ++hot.write_row_conflicts[coreid];
+              ++hot.row_conflicts;
+              ++bank_conflicts[bank_index(req->addr_vec)];
           } else {
-              ++write_row_misses[coreid];
-              ++row_misses;
+              ++hot.write_row_misses[coreid];
+              ++hot.row_misses;
           }
-          write_transaction_bytes += tx;
+          hot.write_transaction_bytes += tx;
         }
     }
 
     /*** 5. Change a read request to a migration request ***/
     if (req->type == Request::Type::READ) {
-        req->type = Request::Type::EXTENSION;
+        queue->set_type(req, Request::Type::EXTENSION);
     }
 
     // issue command on behalf of request
@@ -181,7 +183,7 @@ void Controller<TLDRAM>::tick(){
     }
 
     // remove request from queue
-    queue->q.erase(req);
+    queue->erase(req);
 }
 
 template<>
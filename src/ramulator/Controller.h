@@ -28,12 +28,14 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "Config.h"
 #include "DRAM.h"
 #include "Refresh.h"
 #include "Request.h"
+#include "RequestQueue.h"
 #include "Scheduler.h"
 #include "Statistics.h"
 
@@ -96,11 +98,7 @@ public:
     RowTable<T>* rowtable;  // tracks metadata about rows (e.g., which are open and for how long)
     Refresh<T>* refresh;
 
-    struct Queue {
-        list<Request> q;
-        unsigned int max = 32;
-        unsigned int size() {return q.size();}
-    };
+    typedef RequestQueue Queue;
 
     Queue readq;  // queue for read requests
     Queue writeq;  // queue for write requests
@@ -125,11 +123,47 @@ public:
     bool print_cmd_trace = false;
 
     // callback function for passing stats to Scarab when an event occurs
-    void (*stats_callback)(int, int) = nullptr;
+    void (*stats_callback)(int, int, long) = nullptr;
+
+    /* Deferred callbacks: while Memory ticks the channels in parallel, completed reads and stat events are queued
+       here instead and replayed by Memory::tick() in channel order once every channel finished its cycle */
+    bool defer_callbacks = false;
+    vector<Request> deferred_reads;
+    vector<pair<int, int>> deferred_stats;
+
+    /* Plain counters bumped per request, command and tick in place of the stats above. fold_counters() adds them to
+       the stats and reports the row buffer outcomes to Scarab, at finish() and record_core() */
+    struct HotCounters {
+        long read_transaction_bytes = 0;
+        long write_transaction_bytes = 0;
+        long row_hits = 0;
+        long row_misses = 0;
+        long row_conflicts = 0;
+        long useless_activates = 0;
+        long read_latency_sum = 0;
+        long req_queue_length_sum = 0;
+        long read_req_queue_length_sum = 0;
+        long write_req_queue_length_sum = 0;
+        // per core
+        vector<long> read_row_hits, read_row_misses, read_row_conflicts;
+        vector<long> write_row_hits, write_row_misses, write_row_conflicts;
+
+        void reset(int num_cores) {
+            *this = HotCounters();
+            for (vector<long>* counts : {&read_row_hits, &read_row_misses, &read_row_conflicts,
+                                         &write_row_hits, &write_row_misses, &write_row_conflicts})
+                counts->assign(num_cores, 0);
+        }
+    } hot;
+
+    /* Bank contention profile (SET_PROF_DRAM): activations and row conflicts of each bank of the channel since the
+       last bank_prof_read, indexed by the flattened rank..bank address */
+    vector<uint32_t> bank_acts;
+    vector<uint32_t> bank_conflicts;
 
 
     /* Constructor */
-    Controller(const Config& configs, DRAM<T>* channel, void (*_stats_callback)(int,int)) :
+    Controller(const Config& configs, DRAM<T>* channel, void (*_stats_callback)(int,int,long)) :
         channel(channel),
         scheduler(new Scheduler<T>(this, configs)),
         rowpolicy(new RowPolicy<T>(this)),
@@ -152,6 +186,16 @@ public:
                 cmd_trace_files[i].open(prefix + to_string(i) + suffix);
         }
 
+        int num_banks = 1;
+        for (int lvl = 1; lvl <= int(T::Level::Bank); lvl++)
+            num_banks *= channel->spec->org_entry.count[lvl];
+        bank_acts.assign(num_banks, 0);
+        bank_conflicts.assign(num_banks, 0);
+
+        hot.reset(configs.get_core_num());
+
+        for (Queue* queue : {&readq, &writeq, &actq, &otherq})
+            queue->set_banks(channel->spec->org_entry.count, int(T::Level::Row), scheduler->ranks_cores());
         readq.max = (unsigned int) configs.get_int("readq_entries");
         writeq.max = (unsigned int) configs.get_int("writeq_entries");
 
@@ -323,6 +367,7 @@ public:
     }
 
     void finish(long read_req, long dram_cycles) {
+      fold_counters();
       read_latency_avg = read_latency_sum.value() / read_req;
       req_queue_length_avg = req_queue_length_sum.value() / dram_cycles;
       read_req_queue_length_avg = read_req_queue_length_sum.value() / dram_cycles;
@@ -349,35 +394,41 @@ public:
             return false;
 
         req.arrive = clk;
-        queue.q.push_back(req);
         // shortcut for read requests, if a write to same addr exists
         // necessary for coherence
-        if (req.type == Request::Type::READ && find_if(writeq.q.begin(), writeq.q.end(),
-                [req](Request& wreq){ return req.addr == wreq.addr;}) != writeq.q.end()){
+        if (req.type == Request::Type::READ && find_if(writeq.begin(), writeq.end(),
+                [&req](Request& wreq){ return req.addr == wreq.addr;}) != writeq.end()){
             req.depart = clk + 1;
             pending.push_back(req);
-            readq.q.pop_back();
+            return true;
         }
+        queue.push_back(req);
         return true;
     }
 
+    bool has_room(Request::Type type)
+    {
+        Queue& queue = get_queue(type);
+        return queue.size() < queue.max;
+    }
+
     void tick()
     {
         clk++;
-        req_queue_length_sum += readq.size() + writeq.size() + pending.size();
-        read_req_queue_length_sum += readq.size() + pending.size();
-        write_req_queue_length_sum += writeq.size();
+        hot.req_queue_length_sum += readq.size() + writeq.size() + pending.size();
+        hot.read_req_queue_length_sum += readq.size() + pending.size();
+        hot.write_req_queue_length_sum += writeq.size();
 
         /*** 1. Serve completed reads ***/
         if (pending.size()) {
             Request& req = pending[0];
             if (req.depart <= clk) {
                 if (req.depart - req.arrive > 1) { // this request really accessed a row
-                  read_latency_sum += req.depart - req.arrive;
+                  hot.read_latency_sum += req.depart - req.arrive;
                   channel->update_serving_requests(
                       req.addr_vec.data(), -1, clk);
                 }
-                req.callback(req);
+                complete_read(req);
                 pending.pop_front();
             }
         }
@@ -406,17 +457,17 @@ public:
         // are requests available to service in this cycle
         Queue* queue = &actq;
 
-        auto req = scheduler->get_head(queue->q);
-        if (req == queue->q.end() || !is_ready(req)) {
+        auto req = scheduler->get_head(*queue);
+        if (req == queue->end() || !is_ready(req)) {
             queue = !write_mode ? &readq : &writeq;
 
             if (otherq.size())
                 queue = &otherq;  // "other" requests are rare, so we give them precedence over reads/writes
 
-            req = scheduler->get_head(queue->q);
+            req = scheduler->get_head(*queue);
         }
 
-        if (req == queue->q.end() || !is_ready(req)) {
+        if (req == queue->end() || !is_ready(req)) {
             // we couldn't find a command to schedule -- let's try to be speculative
             auto cmd = T::Command::PRE;
             vector<int> victim = rowpolicy->get_victim(cmd);
@@ -435,42 +486,46 @@ public:
             int tx = (channel->spec->prefetch_size * channel->spec->channel_width / 8);
             if (req->type == Request::Type::READ) {
                 if (is_row_hit(req)) {
-                    ++read_row_hits[coreid];
-                    ++row_hits;
+                    ++hot.read_row_hits[coreid];
+                    ++hot.row_hits;
                 } else if (is_row_open(req)) {
-                    ++read_row_conflicts[coreid];
-                    ++row_conflicts;
+                    ++hot.read_row_conflicts[coreid];
+                    ++hot.row_conflicts;
+                    ++bank_conflicts[bank_index(req->addr_vec)];
                 } else {
-                    ++read_row_misses[coreid];
-                    ++row_misses;
+                    ++hot.read_row_misses[coreid];
+                    ++hot.row_misses;
                 }
-              read_transaction_bytes += tx;
+              hot.read_transaction_bytes += tx;
             } else if (req->type == Request::Type::WRITE) {
               if (is_row_hit(req)) {
-                  ++write_row_hits[coreid];
-                  ++row_hits;
+                  ++hot.write_row_hits[coreid];
+                  ++hot.row_hits;
               } else if (is_row_open(req)) {
-                  ++write_row_conflicts[coreid];
-                  ++row_conflicts;
+                  ++hot.write_row_conflicts[coreid];
+                  ++hot.row_conflicts;
+                  ++bank_conflicts[bank_index(req->addr_vec)];
               } else {
-                  ++write_row_misses[coreid];
-                  ++row_misses;
+                  ++hot.write_row_misses[coreid];
+                  ++hot.row_misses;
               }
-              write_transaction_bytes += tx;
+              hot.write_transaction_bytes += tx;
             }
         }
 
         // issue command on behalf of request
         auto cmd = get_first_cmd(req);
         issue_cmd(cmd, get_addr_vec(cmd, req), req->coreid);
+        if (scheduler->ranks_cores())
+            scheduler->serve(req->coreid);
 
         // check whether this is the last command (which finishes the request)
         //if (cmd != channel->spec->translate[int(req->type)]){
         if (!(channel->spec->is_accessing(cmd) || channel->spec->is_refreshing(cmd))) {
             if(channel->spec->is_opening(cmd)) {
                 // promote the request that caused issuing activation to actq
-                actq.q.push_back(*req);
-                queue->q.erase(req);
+                actq.push_back(*req);
+                queue->erase(req);
             }
 
             return;
@@ -487,10 +542,10 @@ public:
         }
 
         // remove request from queue
-        queue->q.erase(req);
+        queue->erase(req);
     }
 
-    bool is_ready(list<Request>::iterator req)
+    bool is_ready(Queue::iterator req)
     {
         typename T::Command cmd = get_first_cmd(req);
         return channel->check(cmd, req->addr_vec.data(), clk);
@@ -501,7 +556,7 @@ public:
         return channel->check(cmd, addr_vec.data(), clk);
     }
 
-    bool is_row_hit(list<Request>::iterator req)
+    bool is_row_hit(Queue::iterator req)
     {
         // cmd must be decided by the request type, not the first cmd
         typename T::Command cmd = channel->spec->translate[int(req->type)];
@@ -513,7 +568,7 @@ public:
         return channel->check_row_hit(cmd, addr_vec.data());
     }
 
-    bool is_row_open(list<Request>::iterator req)
+    bool is_row_open(Queue::iterator req)
     {
         // cmd must be decided by the request type, not the first cmd
         typename T::Command cmd = channel->spec->translate[int(req->type)];
@@ -534,6 +589,108 @@ public:
       return (channel->cur_serving_requests > 0);
     }
 
+    void complete_read(Request& req) {
+      if (defer_callbacks)
+        deferred_reads.push_back(req);
+      else
+        req.callback(req);
+    }
+
+    void report_stat(int coreid, int type) {
+      if (defer_callbacks)
+        deferred_stats.push_back(make_pair(coreid, type));
+      else
+        stats_callback(coreid, type, 1);
+    }
+
+    // Adds the hot-path counters to the stats and starts them over
+    void fold_counters() {
+      read_transaction_bytes += hot.read_transaction_bytes;
+      write_transaction_bytes += hot.write_transaction_bytes;
+      row_hits += hot.row_hits;
+      row_misses += hot.row_misses;
+      row_conflicts += hot.row_conflicts;
+      useless_activates += hot.useless_activates;
+      read_latency_sum += hot.read_latency_sum;
+      req_queue_length_sum += hot.req_queue_length_sum;
+      read_req_queue_length_sum += hot.read_req_queue_length_sum;
+      write_req_queue_length_sum += hot.write_req_queue_length_sum;
+      for (size_t coreid = 0; coreid < hot.read_row_hits.size(); coreid++) {
+        read_row_hits[coreid] += hot.read_row_hits[coreid];
+        read_row_misses[coreid] += hot.read_row_misses[coreid];
+        read_row_conflicts[coreid] += hot.read_row_conflicts[coreid];
+        write_row_hits[coreid] += hot.write_row_hits[coreid];
+        write_row_misses[coreid] += hot.write_row_misses[coreid];
+        write_row_conflicts[coreid] += hot.write_row_conflicts[coreid];
+        stats_callback(coreid, int(StatCallbackType::DRAM_ROW_HIT),
+                       hot.read_row_hits[coreid] + hot.write_row_hits[coreid]);
+        stats_callback(coreid, int(StatCallbackType::DRAM_ROW_MISS),
+                       hot.read_row_misses[coreid] + hot.write_row_misses[coreid]);
+        stats_callback(coreid, int(StatCallbackType::DRAM_ROW_CONFLICT),
+                       hot.read_row_conflicts[coreid] + hot.write_row_conflicts[coreid]);
+      }
+      hot.reset(hot.read_row_hits.size());
+    }
+
+    // Flattened index of the bank addr_vec falls in, rank-major
+    int bank_index(const vector<int>& addr_vec) const {
+        int index = 0;
+        for (int lvl = 1; lvl <= int(T::Level::Bank); lvl++)
+            index = index * channel->spec->org_entry.count[lvl] + addr_vec[lvl];
+        return index;
+    }
+
+    int bank_prof_num_banks() const {
+        return int(bank_acts.size());
+    }
+
+    // Copies the bank counters of this channel out and starts a new interval
+    void bank_prof_read(uint32_t* acts, uint32_t* conflicts) {
+        copy(bank_acts.begin(), bank_acts.end(), acts);
+        copy(bank_conflicts.begin(), bank_conflicts.end(), conflicts);
+        fill(bank_acts.begin(), bank_acts.end(), 0);
+        fill(bank_conflicts.begin(), bank_conflicts.end(), 0);
+    }
+
+    // Replays the callbacks queued during a parallel tick in the order the channel raised them
+    void replay_deferred() {
+      for (auto& req : deferred_reads)
+        req.callback(req);
+      for (auto& stat : deferred_stats)
+        stats_callback(stat.first, stat.second, 1);
+      deferred_reads.clear();
+      deferred_stats.clear();
+    }
+
+    // Number of upcoming ticks that change nothing but the clock and the queue length sums: ticks with nothing to
+    // schedule, before the first pending read departs and before the next refresh is due. The DSARP refresh scheduler
+    // and the TLDRAM tick are not covered, so those channels never report idle ticks
+    long idle_ticks() {
+      if (is_same<T, DSARP>::value || is_same<T, TLDRAM>::value)
+        return 0;
+      if (readq.size() || otherq.size() || actq.size())
+        return 0;
+      // outside write mode, writes wait until the write queue passes the high watermark, which the last tick checked
+      if (write_mode && writeq.size())
+        return 0;
+      // every policy but Opened may issue a speculative precharge while a row is open
+      if (rowpolicy->type != RowPolicy<T>::Type::Opened && rowtable->table.size())
+        return 0;
+      long next = refresh->refreshed + channel->spec->speed_entry.nREFI;
+      if (pending.size())
+        next = min(next, pending[0].depart);
+      return max(0L, next - clk - 1);
+    }
+
+    // Advances the clock over ticks counted by idle_ticks()
+    void skip(long ticks) {
+      clk += ticks;
+      refresh->clk += ticks;
+      hot.req_queue_length_sum += ticks * (writeq.size() + pending.size());
+      hot.read_req_queue_length_sum += ticks * pending.size();
+      hot.write_req_queue_length_sum += ticks * writeq.size();
+    }
+
     // For telling whether this channel is under refresh
     bool is_refresh() {
       return clk <= channel->end_of_refreshing;
@@ -548,6 +705,7 @@ public:
     }
 
     void record_core(int coreid) {
+      fold_counters();
 #ifndef INTEGRATED_WITH_GEM5
       record_read_hits[coreid] = read_row_hits[coreid];
       record_read_misses[coreid] = read_row_misses[coreid];
@@ -559,12 +717,25 @@ public:
     }
 
 private:
-    typename T::Command get_first_cmd(list<Request>::iterator req)
+    typename T::Command get_first_cmd(Queue::iterator req)
     {
         typename T::Command cmd = channel->spec->translate[int(req->type)];
         return channel->decode(cmd, req->addr_vec.data());
     }
 
+    // number of queued requests that hit in the open row addressed by addr_vec; all requests of a row bucket agree on
+    // whether they hit, so only the buckets of the target bank are looked at
+    int count_row_hits(Queue& queue, const vector<int>& addr_vec)
+    {
+        int num_row_hits = 0;
+        int row = addr_vec[int(T::Level::Row)];
+        for (int b = queue.first_bucket_of_bank(queue.bank_of(addr_vec)); b != -1; b = queue.next_bucket_of_bank(b)) {
+            if (queue.bucket(b).row == row && is_row_hit(queue.bucket_oldest(b)))
+                num_row_hits += queue.bucket(b).count;
+        }
+        return num_row_hits;
+    }
+
     // upgrade to an autoprecharge command
     void cmd_issue_autoprecharge(typename T::Command& cmd,
                                             const vector<int>& addr_vec) {
@@ -574,31 +745,10 @@ private:
             // check if it is the last request to the opened row
             Queue* queue = write_mode ? &writeq : &readq;
 
-            auto begin = addr_vec.begin();
-            vector<int> rowgroup(begin, begin + int(T::Level::Row) + 1);
-
-			int num_row_hits = 0;
+            int num_row_hits = count_row_hits(*queue, addr_vec);
 
-            for (auto itr = queue->q.begin(); itr != queue->q.end(); ++itr) {
-                if (is_row_hit(itr)) { 
-                    auto begin2 = itr->addr_vec.begin();
-                    vector<int> rowgroup2(begin2, begin2 + int(T::Level::Row) + 1);
-                    if(rowgroup == rowgroup2)
-                        num_row_hits++;
-                }
-            }
-
-            if(num_row_hits == 0) {
-                Queue* queue = &actq;
-                for (auto itr = queue->q.begin(); itr != queue->q.end(); ++itr) {
-                    if (is_row_hit(itr)) {
-                        auto begin2 = itr->addr_vec.begin();
-                        vector<int> rowgroup2(begin2, begin2 + int(T::Level::Row) + 1);
-                        if(rowgroup == rowgroup2)
-                            num_row_hits++;
-                    }
-                }
-            }
+            if(num_row_hits == 0)
+                num_row_hits = count_row_hits(actq, addr_vec);
 
             assert(num_row_hits > 0); // The current request should be a hit, 
                                       // so there should be at least one request 
@@ -621,22 +771,24 @@ private:
         assert(is_ready(cmd, addr_vec));
         channel->update(cmd, addr_vec.data(), clk);
 
-        if(channel->spec->is_opening(cmd))
-            stats_callback(coreid, int(StatCallbackType::DRAM_ACT));
+        if(channel->spec->is_opening(cmd)) {
+            report_stat(coreid, int(StatCallbackType::DRAM_ACT));
+            ++bank_acts[bank_index(addr_vec)];
+        }
 
         if(channel->spec->is_closing(cmd))
-            stats_callback(coreid, int(StatCallbackType::DRAM_PRE));
+            report_stat(coreid, int(StatCallbackType::DRAM_PRE));
         
         if(channel->spec->is_reading(cmd))
-            stats_callback(coreid, int(StatCallbackType::DRAM_READ));
+            report_stat(coreid, int(StatCallbackType::DRAM_READ));
 
         if(channel->spec->is_writing(cmd))
-            stats_callback(coreid, int(StatCallbackType::DRAM_WRITE));
+            report_stat(coreid, int(StatCallbackType::DRAM_WRITE));
 
 
         if(cmd == T::Command::PRE){
             if(rowtable->get_hits(addr_vec, true) == 0){
-                useless_activates++;
+                hot.useless_activates++;
             }
         }
  
@@ -663,17 +815,17 @@ private:
             printf("\n");
         }
     }
-    vector<int> get_addr_vec(typename T::Command cmd, list<Request>::iterator req){
+    vector<int> get_addr_vec(typename T::Command cmd, Queue::iterator req){
         return req->addr_vec;
     }
 };
 
 template <>
 vector<int> Controller<SALP>::get_addr_vec(
-    SALP::Command cmd, list<Request>::iterator req);
+    SALP::Command cmd, Queue::iterator req);
 
 template <>
-bool Controller<SALP>::is_ready(list<Request>::iterator req);
+bool Controller<SALP>::is_ready(Queue::iterator req);
 
 template <>
 void Controller<ALDRAM>::update_temp(ALDRAM::Temp current_temperature);
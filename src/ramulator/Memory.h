@@ -41,7 +41,10 @@
 #include <cmath>
 #include <cassert>
 #include <tuple>
+#include <thread>
+#include <type_traits>
 #include <limits.h>
+#include <pthread.h>
 
 using namespace std;
 
@@ -54,7 +57,10 @@ public:
     virtual ~MemoryBase() {}
     virtual double clk_ns() const = 0;
     virtual void tick() = 0;
+    virtual long idle_ticks() = 0;
+    virtual void skip(long ticks) = 0;
     virtual bool send(Request req) = 0;
+    virtual bool has_room(long addr, Request::Type type) = 0;
     virtual int pending_requests() = 0;
     virtual void finish(void) = 0;
     virtual long page_allocator(long addr, int coreid) = 0;
@@ -67,6 +73,10 @@ public:
     virtual int get_num_chips()  const = 0;
     virtual int get_chip_row_buffer_size() const = 0;
 
+    // Bank contention profile: banks over all channels, and their activations and row conflicts since the last read
+    virtual int bank_prof_num_banks() const = 0;
+    virtual void bank_prof_read(uint32_t* acts, uint32_t* conflicts) = 0;
+
     // virtual int get_tCK() = 0;
     // virtual int get_nCL() = 0;
     // virtual int get_nCCD() = 0;
@@ -135,6 +145,14 @@ public:
 
     vector<Controller<T>*> ctrls;
     T * spec;
+
+    /* Parallel channel ticking: channel i is ticked by thread i % tick_threads, the calling thread being thread 0.
+       Channels only interact through their callbacks, which are deferred and replayed in channel order */
+    int tick_threads = 1;
+    bool tick_stop = false;
+    vector<thread> tick_workers;
+    pthread_barrier_t tick_start;
+    pthread_barrier_t tick_end;
     vector<int> addr_bits;
 
     int tx_bits;
@@ -280,10 +298,30 @@ public:
             ;
 #endif
 
+        tick_threads = max(1, min(configs.get_tick_threads(), int(ctrls.size())));
+        // DSARP refreshes pick banks with rand() and the command trace goes to stdout, both in channel order
+        if (is_same<T, DSARP>::value || configs.print_cmd_trace())
+          tick_threads = 1;
+        if (tick_threads > 1) {
+          pthread_barrier_init(&tick_start, NULL, tick_threads);
+          pthread_barrier_init(&tick_end, NULL, tick_threads);
+          for (auto ctrl : ctrls)
+            ctrl->defer_callbacks = true;
+          for (int thread_id = 1; thread_id < tick_threads; thread_id++)
+            tick_workers.emplace_back(&Memory::tick_worker, this, thread_id);
+        }
     }
 
     ~Memory()
     {
+        if (tick_threads > 1) {
+          tick_stop = true;
+          pthread_barrier_wait(&tick_start);
+          for (auto& worker : tick_workers)
+            worker.join();
+          pthread_barrier_destroy(&tick_start);
+          pthread_barrier_destroy(&tick_end);
+        }
         for (auto ctrl: ctrls)
             delete ctrl;
         delete spec;
@@ -312,6 +350,21 @@ public:
       return spec->org_entry.count[int(T::Level::Column)] * spec->org_entry.dq;
     }
 
+    int bank_prof_num_banks() const {
+      int num_banks = 0;
+      for (auto ctrl : ctrls)
+        num_banks += ctrl->bank_prof_num_banks();
+      return num_banks;
+    }
+
+    void bank_prof_read(uint32_t* acts, uint32_t* conflicts) {
+      for (auto ctrl : ctrls) {
+        ctrl->bank_prof_read(acts, conflicts);
+        acts += ctrl->bank_prof_num_banks();
+        conflicts += ctrl->bank_prof_num_banks();
+      }
+    }
+
     void record_core(int coreid) {
 #ifndef INTEGRATED_WITH_GEM5
       record_read_requests[coreid] = num_read_requests[coreid];
@@ -340,13 +393,67 @@ public:
         bool is_active = false;
         for (auto ctrl : ctrls) {
           is_active = is_active || ctrl->is_active();
-          ctrl->tick();
+        }
+        if (tick_threads > 1) {
+          pthread_barrier_wait(&tick_start);
+          tick_channels(0);
+          pthread_barrier_wait(&tick_end);
+          for (auto ctrl : ctrls) {
+            ctrl->replay_deferred();
+          }
+        } else {
+          for (auto ctrl : ctrls) {
+            ctrl->tick();
+          }
         }
         if (is_active) {
           ramulator_active_cycles++;
         }
     }
 
+    // Number of upcoming ticks that leave every channel as it is, up to the next refresh or read completion
+    long idle_ticks()
+    {
+        long ticks = ctrls[0]->idle_ticks();
+        for (auto ctrl : ctrls)
+          ticks = min(ticks, ctrl->idle_ticks());
+        return ticks;
+    }
+
+    // Same as calling tick() for each of the given ticks, which must not exceed idle_ticks()
+    void skip(long ticks)
+    {
+        num_dram_cycles += ticks;
+        bool is_active = false;
+        for (auto ctrl : ctrls) {
+          in_queue_req_num_sum += ticks * (ctrl->writeq.size() + ctrl->pending.size());
+          in_queue_read_req_num_sum += ticks * ctrl->pending.size();
+          in_queue_write_req_num_sum += ticks * ctrl->writeq.size();
+          is_active = is_active || ctrl->is_active();
+          ctrl->skip(ticks);
+        }
+        if (is_active)
+          ramulator_active_cycles += ticks;
+    }
+
+    void tick_channels(int thread_id)
+    {
+        for (size_t i = thread_id; i < ctrls.size(); i += tick_threads) {
+          ctrls[i]->tick();
+        }
+    }
+
+    void tick_worker(int thread_id)
+    {
+        while (true) {
+          pthread_barrier_wait(&tick_start);
+          if (tick_stop)
+            break;
+          tick_channels(thread_id);
+          pthread_barrier_wait(&tick_end);
+        }
+    }
+
     bool send(Request req)
     {
         req.addr_vec.resize(addr_bits.size());
@@ -403,6 +510,13 @@ public:
         return false;
     }
 
+    // Whether send() would find room for a request of this type to addr, without decoding the rest of the address
+    bool has_room(long addr, Request::Type type)
+    {
+        clear_lower_bits(addr, tx_bits);
+        return ctrls[slice_lower_bits(addr, addr_bits[0])]->has_room(type);
+    }
+
     int pending_requests()
     {
         int reqs = 0;
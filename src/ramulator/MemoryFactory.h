@@ -36,6 +36,14 @@ using namespace std;
 
 namespace ramulator {
 
+// Standards SpeedyController can drive (ramulator_controller=SpeedyController)
+template <typename T> struct speedy_controller_supported : false_type {};
+template <> struct speedy_controller_supported<DDR3> : true_type {};
+template <> struct speedy_controller_supported<DDR4> : true_type {};
+template <> struct speedy_controller_supported<LPDDR4> : true_type {};
+template <> struct speedy_controller_supported<HBM> : true_type {};
+template <> struct speedy_controller_supported<GDDR5> : true_type {};
+
 template <typename T>
 class MemoryFactory {
  public:
@@ -58,23 +66,24 @@ class MemoryFactory {
     spec->channel_width *= gang_number;
   }
 
-  static Memory<T>* populate_memory(const Config& configs, T* spec,
-                                    int channels, int ranks,
-                                    void (*stats_callback)(int, int)) {
+  template <template <typename> class Ctrl = Controller>
+  static Memory<T, Ctrl>* populate_memory(const Config& configs, T* spec,
+                                          int channels, int ranks,
+                                          void (*stats_callback)(int, int, long)) {
     // int& default_ranks = spec->org_entry.count[int(T::Level::Rank)];
     // int& default_channels = spec->org_entry.count[int(T::Level::Channel)];
 
     // if (default_channels == 0) default_channels = channels;
     // if (default_ranks == 0) default_ranks = ranks;
 
-    vector<Controller<T>*> ctrls;
+    vector<Ctrl<T>*> ctrls;
     for(int c = 0; c < channels; c++) {
       DRAM<T>* channel = new DRAM<T>(spec, T::Level::Channel);
       channel->id      = c;
       channel->regStats("");
-      ctrls.push_back(new Controller<T>(configs, channel, stats_callback));
+      ctrls.push_back(new Ctrl<T>(configs, channel, stats_callback));
     }
-    return new Memory<T>(configs, ctrls);
+    return new Memory<T, Ctrl>(configs, ctrls);
   }
 
   static void validate(int channels, int ranks, const Config& configs) {
@@ -82,7 +91,7 @@ class MemoryFactory {
   }
 
   static MemoryBase* create(const Config& configs, int cacheline,
-                            void (*stats_callback)(int, int)) {
+                            void (*stats_callback)(int, int, long)) {
     int channels = stoi(configs["channels"], NULL, 0);
     int ranks    = stoi(configs["ranks"], NULL, 0);
 
@@ -96,6 +105,16 @@ class MemoryFactory {
 
     extend_channel_width(spec, cacheline);
 
+    if (configs["controller"] == "SpeedyController") {
+      if constexpr (speedy_controller_supported<T>::value)
+        return (MemoryBase*)populate_memory<SpeedyController>(
+          configs, spec, channels, ranks, stats_callback);
+      assert(false &&
+             "SpeedyController supports DDR3, DDR4, LPDDR4, HBM and GDDR5");
+    }
+    assert(configs["controller"] == "Controller" &&
+           "unrecognized controller name");
+
     return (MemoryBase*)populate_memory(configs, spec, channels, ranks,
                                         stats_callback);
   }
@@ -103,10 +122,10 @@ class MemoryFactory {
 
 template <>
 MemoryBase* MemoryFactory<WideIO2>::create(const Config& configs, int cacheline,
-                                           void (*stats_callback)(int, int));
+                                           void (*stats_callback)(int, int, long));
 template <>
 MemoryBase* MemoryFactory<SALP>::create(const Config& configs, int cacheline,
-                                        void (*stats_callback)(int, int));
+                                        void (*stats_callback)(int, int, long));
 
 } /*namespace ramulator*/
 
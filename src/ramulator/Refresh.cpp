@@ -73,7 +73,7 @@ void Refresh<DSARP>::early_inject_refresh() {
   Controller<DSARP>::Queue& rdq = ctrl->readq;
 
   // Figure out which banks are idle in order to refresh one of them
-  for (auto req: rdq.q)
+  for (auto req: rdq)
   {
     assert(req.addr_vec[level_chan] == ctrl->channel->id);
     int ridx = req.addr_vec[level_rank] * max_bank_count;
@@ -95,7 +95,7 @@ void Refresh<DSARP>::early_inject_refresh() {
 
       // Pending refresh
       bool pending_ref = false;
-      for (Request req : ctrl->otherq.q)
+      for (Request req : ctrl->otherq)
         if (req.type == Request::Type::REFRESH
             && req.addr_vec[level_chan] == ctrl->channel->id
             && req.addr_vec[level_rank] == r && req.addr_vec[level_bank] == bidx)
@@ -105,7 +105,7 @@ void Refresh<DSARP>::early_inject_refresh() {
 
       // Only pull in refreshes when we are almost running out of credits
       if ((*(bank_refresh_backlog[r]))[bidx] >= backlog_early_pull_threshold ||
-          ctrl->otherq.q.size() >= ctrl->otherq.max)
+          ctrl->otherq.size() >= ctrl->otherq.max)
         continue;
 
       // Refresh now
@@ -143,7 +143,7 @@ void Refresh<DSARP>::inject_refresh(bool b_ref_rank) {
         bool ref_now = false;
         // 1. Any pending refrehes?
         bool pending_ref = false;
-        for (Request req : ctrl->otherq.q) {
+        for (Request req : ctrl->otherq) {
           if (req.type == Request::Type::REFRESH) {
             pending_ref = true;
             break;
@@ -187,7 +187,7 @@ void Refresh<DSARP>::wrp() {
   {
     // Pending refresh in the rank?
     bool pending_ref = false;
-    for (Request req : ctrl->otherq.q) {
+    for (Request req : ctrl->otherq) {
       if (req.type == Request::Type::REFRESH && req.addr_vec[level_rank] == ref_rid) {
         pending_ref = true;
         break;
@@ -202,7 +202,7 @@ void Refresh<DSARP>::wrp() {
       sorted_bank_demand.push_back(wrq_idx(0,b));
     // Filter out all the writes to this rank
     int total_wr = 0;
-    for (auto req : ctrl->writeq.q) {
+    for (auto req : ctrl->writeq) {
       if (req.addr_vec[level_rank] == ref_rid) {
         sorted_bank_demand[req.addr_vec[level_bank]].first++;
         total_wr++;
@@ -213,7 +213,7 @@ void Refresh<DSARP>::wrp() {
       continue;
 
     // Add read
-    for (auto req : ctrl->readq.q)
+    for (auto req : ctrl->readq)
       if (req.addr_vec[level_rank] == ref_rid)
         sorted_bank_demand[req.addr_vec[level_bank]].first++;
 
@@ -235,7 +235,7 @@ void Refresh<DSARP>::wrp() {
 
     // Make sure we don't exceed the credit
     if ((*(bank_refresh_backlog[ref_rid]))[ref_bid] < backlog_max
-        && ctrl->otherq.q.size() < ctrl->otherq.max) {
+        && ctrl->otherq.size() < ctrl->otherq.max) {
       refresh_target(ctrl, ref_rid, ref_bid, subarray_ref_counters[ref_rid][ref_bid]);
       // Get 1 ref credit
       (*(bank_refresh_backlog[ref_rid]))[ref_bid]++;
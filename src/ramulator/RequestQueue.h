@@ -0,0 +1,318 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __REQUEST_QUEUE_H
+#define __REQUEST_QUEUE_H
+
+#include "Request.h"
+#include <vector>
+#include <iterator>
+#include <cassert>
+
+using namespace std;
+
+namespace ramulator
+{
+
+/* Request queue of a channel controller.
+ *
+ * Requests live in a pool of slots that are linked in arrival order and recycled through a free list, so pushing
+ * and erasing requests does not allocate once the pool has grown to the depth of the queue. Every request is also
+ * linked into the bucket of its row: requests of the same type whose addresses agree down to the row level decode
+ * to the same first command, so the scheduler and the row-hit searches look at a bucket once instead of at every
+ * request in it. Each bucket keeps track of its oldest request, and the buckets of a bank (all levels above the
+ * row) are chained together so that looking up a row only walks the buckets of its bank. The schedulers that rank
+ * the cores also split the buckets by core, so that all requests of a bucket have the same priority. */
+class RequestQueue
+{
+public:
+    unsigned int max = 32;
+
+    class iterator
+    {
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef Request value_type;
+        typedef ptrdiff_t difference_type;
+        typedef Request* pointer;
+        typedef Request& reference;
+
+        iterator() {}
+        iterator(RequestQueue* queue, int slot) : queue(queue), slot(slot) {}
+
+        Request& operator*() const {return queue->slots[slot].req;}
+        Request* operator->() const {return &queue->slots[slot].req;}
+        iterator& operator++() {slot = queue->slots[slot].next; return *this;}
+        iterator operator++(int) {iterator old = *this; ++*this; return old;}
+        bool operator==(const iterator& other) const {return slot == other.slot;}
+        bool operator!=(const iterator& other) const {return slot != other.slot;}
+
+        // arrival position in the queue, orders requests that arrived in the same cycle
+        long seq() const {return queue->slots[slot].seq;}
+
+        RequestQueue* queue = nullptr;
+        int slot = -1;
+    };
+
+    struct Bucket {
+        Request::Type type;
+        int bank;
+        int row;
+        int coreid;                // only set when the buckets are split by core
+        unsigned int count;
+        int head;                  // requests of the bucket
+        int oldest;                // and the oldest of them, by arrival cycle and then position
+        long oldest_arrive;
+        long oldest_seq;
+        int bank_prev, bank_next;  // buckets of the same bank
+        int prev, next;            // all non-empty buckets, by creation
+    };
+
+    // count[] holds the number of nodes at every level; the levels between the channel and row_level form the bank
+    void set_banks(const int* count, int row_level, bool by_core = false)
+    {
+        assert(!num_reqs);
+        this->row_level = row_level;
+        this->by_core = by_core;
+        bank_level_count.assign(count, count + row_level);
+        bank_stride.assign(row_level, 0);
+        int num_banks = 1;
+        for (int lev = row_level - 1; lev > 0; lev--) {
+            bank_stride[lev] = num_banks;
+            // one extra index per level for requests that leave the level out, e.g. rank-level refreshes
+            num_banks *= count[lev] + 1;
+        }
+        bank_heads.assign(num_banks, -1);
+    }
+
+    unsigned int size() const {return num_reqs;}
+    iterator begin() {return iterator(this, head);}
+    iterator end() {return iterator(this, -1);}
+
+    void push_back(const Request& req)
+    {
+        if (free_slots == -1) {
+            // growing the pool may move the request if it is queued here already
+            Request copy = req;
+            slots.emplace_back();
+            slots.back().req = move(copy);
+            take_slot(slots.size() - 1);
+            return;
+        }
+        int s = free_slots;
+        free_slots = slots[s].next;
+        slots[s].req = req;
+        take_slot(s);
+    }
+
+    void erase(iterator itr)
+    {
+        int s = itr.slot;
+        Slot& slot = slots[s];
+        unlink_row(s);
+        if (slot.prev != -1)
+            slots[slot.prev].next = slot.next;
+        else
+            head = slot.next;
+        if (slot.next != -1)
+            slots[slot.next].prev = slot.prev;
+        else
+            tail = slot.prev;
+        // keep the request in the slot so that reusing it does not reallocate its address vector
+        slot.next = free_slots;
+        free_slots = s;
+        num_reqs--;
+    }
+
+    // changing the type of a queued request moves it to the bucket of its new type
+    void set_type(iterator itr, Request::Type type)
+    {
+        unlink_row(itr.slot);
+        itr->type = type;
+        link_row(itr.slot);
+    }
+
+    int bank_of(const vector<int>& addr_vec) const
+    {
+        int bank = 0;
+        for (int lev = 1; lev < row_level; lev++)
+            bank += (addr_vec[lev] < 0 ? bank_level_count[lev] : addr_vec[lev]) * bank_stride[lev];
+        return bank;
+    }
+
+    /* Bucket traversal */
+    const Bucket& bucket(int b) const {return buckets[b];}
+    int first_bucket() const {return bucket_head;}
+    int next_bucket(int b) const {return buckets[b].next;}
+    int first_bucket_of_bank(int bank) const {return bank_heads[bank];}
+    int next_bucket_of_bank(int b) const {return buckets[b].bank_next;}
+    iterator bucket_oldest(int b) {return iterator(this, buckets[b].oldest);}
+
+private:
+    struct Slot {
+        Request req;
+        long seq;
+        int prev, next;          // arrival order, next also chains the free slots
+        int row_prev, row_next;  // requests of the same bucket
+        int bucket;
+    };
+
+    vector<Slot> slots;
+    int head = -1;
+    int tail = -1;
+    int free_slots = -1;
+    unsigned int num_reqs = 0;
+    long next_seq = 0;
+
+    vector<Bucket> buckets;
+    int bucket_head = -1;
+    int bucket_tail = -1;
+    int free_buckets = -1;
+
+    int row_level = 0;
+    bool by_core = false;
+    vector<int> bank_level_count;
+    vector<int> bank_stride;
+    vector<int> bank_heads;
+
+    void take_slot(int s)
+    {
+        Slot& slot = slots[s];
+        slot.seq = next_seq++;
+        slot.prev = tail;
+        slot.next = -1;
+        if (tail != -1)
+            slots[tail].next = s;
+        else
+            head = s;
+        tail = s;
+        link_row(s);
+        num_reqs++;
+    }
+
+    bool is_older(const Slot& slot, const Bucket& bucket) const
+    {
+        return slot.req.arrive < bucket.oldest_arrive
+            || (slot.req.arrive == bucket.oldest_arrive && slot.seq < bucket.oldest_seq);
+    }
+
+    void set_oldest(Bucket& bucket, int s)
+    {
+        bucket.oldest = s;
+        bucket.oldest_arrive = slots[s].req.arrive;
+        bucket.oldest_seq = slots[s].seq;
+    }
+
+    void link_row(int s)
+    {
+        Slot& slot = slots[s];
+        int bank = bank_of(slot.req.addr_vec);
+        int row = slot.req.addr_vec[row_level];
+        int coreid = by_core ? slot.req.coreid : 0;
+        int b = bank_heads[bank];
+        while (b != -1 && (buckets[b].type != slot.req.type || buckets[b].row != row || buckets[b].coreid != coreid))
+            b = buckets[b].bank_next;
+
+        if (b == -1) {
+            if (free_buckets == -1) {
+                buckets.emplace_back();
+                b = buckets.size() - 1;
+            } else {
+                b = free_buckets;
+                free_buckets = buckets[b].next;
+            }
+            Bucket& bucket = buckets[b];
+            bucket.type = slot.req.type;
+            bucket.bank = bank;
+            bucket.row = row;
+            bucket.coreid = coreid;
+            bucket.count = 0;
+            bucket.head = -1;
+            bucket.bank_prev = -1;
+            bucket.bank_next = bank_heads[bank];
+            if (bucket.bank_next != -1)
+                buckets[bucket.bank_next].bank_prev = b;
+            bank_heads[bank] = b;
+            bucket.prev = bucket_tail;
+            bucket.next = -1;
+            if (bucket_tail != -1)
+                buckets[bucket_tail].next = b;
+            else
+                bucket_head = b;
+            bucket_tail = b;
+        }
+
+        Bucket& bucket = buckets[b];
+        slot.bucket = b;
+        slot.row_prev = -1;
+        slot.row_next = bucket.head;
+        if (bucket.head != -1)
+            slots[bucket.head].row_prev = s;
+        bucket.head = s;
+        if (!bucket.count++ || is_older(slot, bucket))
+            set_oldest(bucket, s);
+    }
+
+    void unlink_row(int s)
+    {
+        Slot& slot = slots[s];
+        int b = slot.bucket;
+        Bucket& bucket = buckets[b];
+        if (slot.row_prev != -1)
+            slots[slot.row_prev].row_next = slot.row_next;
+        else
+            bucket.head = slot.row_next;
+        if (slot.row_next != -1)
+            slots[slot.row_next].row_prev = slot.row_prev;
+
+        if (--bucket.count) {
+            if (bucket.oldest == s) {
+                set_oldest(bucket, bucket.head);
+                for (int other = slots[bucket.head].row_next; other != -1; other = slots[other].row_next) {
+                    if (is_older(slots[other], bucket))
+                        set_oldest(bucket, other);
+                }
+            }
+            return;
+        }
+
+        if (bucket.bank_prev != -1)
+            buckets[bucket.bank_prev].bank_next = bucket.bank_next;
+        else
+            bank_heads[bucket.bank] = bucket.bank_next;
+        if (bucket.bank_next != -1)
+            buckets[bucket.bank_next].bank_prev = bucket.bank_prev;
+        if (bucket.prev != -1)
+            buckets[bucket.prev].next = bucket.next;
+        else
+            bucket_head = bucket.next;
+        if (bucket.next != -1)
+            buckets[bucket.next].prev = bucket.prev;
+        else
+            bucket_tail = bucket.prev;
+        bucket.next = free_buckets;
+        free_buckets = b;
+    }
+};
+
+} /*namespace ramulator*/
+
+#endif /*__REQUEST_QUEUE_H*/
@@ -38,7 +38,7 @@
 
 using namespace ramulator;
 
-static map<string, function<MemoryBase*(const Config&, int, void (*)(int, int))>>
+static map<string, function<MemoryBase*(const Config&, int, void (*)(int, int, long))>>
   name_to_func = {
     {"DDR3", &MemoryFactory<DDR3>::create},
     {"DDR4", &MemoryFactory<DDR4>::create},
@@ -56,7 +56,7 @@ static map<string, function<MemoryBase*(const Config&, int, void (*)(int, int))>
 
 ScarabWrapper::ScarabWrapper(const Config&      configs,
                              const unsigned int cacheline,
-                             void (*stats_callback)(int,int)) {
+                             void (*stats_callback)(int,int,long)) {
   const string& std_name = configs["standard"];
   assert(name_to_func.find(std_name) != name_to_func.end() &&
          "unrecognized standard name");
@@ -74,10 +74,22 @@ void ScarabWrapper::tick() {
   mem->tick();
 }
 
+long ScarabWrapper::idle_ticks() {
+  return mem->idle_ticks();
+}
+
+void ScarabWrapper::skip(long ticks) {
+  mem->skip(ticks);
+}
+
 bool ScarabWrapper::send(Request req) {
   return mem->send(req);
 }
 
+bool ScarabWrapper::has_room(long addr, Request::Type type) {
+  return mem->has_room(addr, type);
+}
+
 void ScarabWrapper::finish(void) {
   mem->finish();
   Stats::statlist.printall();
@@ -98,3 +110,11 @@ int ScarabWrapper::get_num_chips() const {
 int ScarabWrapper::get_chip_row_buffer_size() const {
   return mem->get_chip_row_buffer_size();
 }
+
+int ScarabWrapper::bank_prof_num_banks() const {
+  return mem->bank_prof_num_banks();
+}
+
+void ScarabWrapper::bank_prof_read(uint32_t* acts, uint32_t* conflicts) {
+  mem->bank_prof_read(acts, conflicts);
+}
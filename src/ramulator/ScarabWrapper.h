@@ -22,6 +22,7 @@
 #ifndef __SCARAB_WRAPPER_H
 #define __SCARAB_WRAPPER_H
 
+#include <cstdint>
 #include <string>
 
 #include "Config.h"
@@ -40,16 +41,22 @@ private:
     MemoryBase *mem;
 public:
     //double tCK;
-    ScarabWrapper(const Config& configs, const unsigned int cacheline, void (* stats_callback)(int, int));
+    ScarabWrapper(const Config& configs, const unsigned int cacheline, void (* stats_callback)(int, int, long));
     ~ScarabWrapper();
     void tick();
+    long idle_ticks();
+    void skip(long ticks);
     bool send(Request req);
+    bool has_room(long addr, Request::Type type);
     void finish(void);
 
     int get_chip_width() const;
     int get_chip_size()  const;
     int get_num_chips()  const;
     int get_chip_row_buffer_size() const;
+
+    int bank_prof_num_banks() const;
+    void bank_prof_read(uint32_t* acts, uint32_t* conflicts);
 };
 
 } /*namespace ramulator*/
@@ -24,12 +24,14 @@
 
 #include "DRAM.h"
 #include "Request.h"
+#include "RequestQueue.h"
 #include "Controller.h"
 #include <vector>
 #include <map>
 #include <list>
 #include <functional>
 #include <cassert>
+#include <algorithm>
 
 using namespace std;
 
@@ -46,11 +48,21 @@ public:
     Controller<T>* ctrl;
 
     enum class Policy {
-        FCFS, FRFCFS, FRFCFS_Cap, FRFCFS_PriorHit, MAX
+        FCFS, FRFCFS, FRFCFS_Cap, FRFCFS_PriorHit, ATLAS, FRFCFS_Rank, MAX
     } policy = Policy::FRFCFS_Cap;
 
     long cap = 16;
 
+    /* ATLAS and FRFCFS_Rank rank the cores by the service they attained from this channel: the commands issued
+       for each core in a quantum are folded into an exponential average at the end of the quantum, and the core
+       with the least attained service gets rank 0. A core that keeps many banks busy at once attains service
+       faster, so the ranking favors the cores with little memory-level parallelism. ATLAS prioritizes requests
+       waiting for more than starvation cycles, then the rank, then row hits and then age; FRFCFS_Rank
+       prioritizes row hits, then the rank and then age. Both only pick among ready requests when there are any. */
+    long quantum = 1000000;
+    double alpha = 0.875;
+    long starvation = 100000;
+
     Scheduler(Controller<T>* ctrl, const Config& configs) : ctrl(ctrl){ 
         string policy_str = configs["scheduling_policy"];
 
@@ -62,24 +74,79 @@ public:
             policy = Policy::FRFCFS_Cap;
         else if (policy_str == "FRFCFS_PriorHit")
             policy = Policy::FRFCFS_PriorHit;
+        else if (policy_str == "ATLAS")
+            policy = Policy::ATLAS;
+        else if (policy_str == "FRFCFS_Rank")
+            policy = Policy::FRFCFS_Rank;
         else
             assert(false && "Unknown memory request scheduler. Please make \
 sure to set RAMULATOR_SCHEDULING_POLICY to one of the \
 available policies: FCFS, FRFCFS, FRFCFS_Cap, \
-FRFCFS_PriorHit"); }
+FRFCFS_PriorHit, ATLAS, FRFCFS_Rank");
+
+        if (configs.contains("sched_quantum"))
+            quantum = configs.get_int("sched_quantum");
+        if (configs.contains("sched_alpha"))
+            alpha = stod(configs["sched_alpha"]);
+        if (configs.contains("sched_starvation"))
+            starvation = configs.get_int("sched_starvation");
+        next_quantum = quantum;
+    }
+
+    // whether the request queues split their buckets by core for this policy
+    bool ranks_cores() const {return policy == Policy::ATLAS || policy == Policy::FRFCFS_Rank;}
 
-    list<Request>::iterator get_head(list<Request>& q)
+    // called for every command issued on behalf of a request
+    void serve(int coreid)
     {
+        if (coreid >= int(served.size()))
+            served.resize(coreid + 1, 0);
+        served[coreid]++;
+    }
+
+    RequestQueue::iterator get_head(RequestQueue& q)
+    {
+      if (ranks_cores()) {
+        if (ctrl->clk >= next_quantum)
+            update_ranks();
+        if (!q.size())
+            return q.end();
+
+        // the buckets are split by core, so the oldest request of a bucket is its best one and the choice costs
+        // one priority key per bucket
+        int best = -1;
+        Rank_Key best_key;
+        for (int b = q.first_bucket(); b != -1; b = q.next_bucket(b)) {
+            Rank_Key key = rank_key(q, b);
+            if (best == -1 || is_higher(key, best_key, q.bucket(b), q.bucket(best))) {
+                best = b;
+                best_key = key;
+            }
+        }
+        return q.bucket_oldest(best);
+      }
+
       // TODO make the decision at compile time
       if (policy != Policy::FRFCFS_PriorHit) {
         if (!q.size())
             return q.end();
 
-        auto head = q.begin();
-        for (auto itr = next(q.begin(), 1); itr != q.end(); itr++)
-            head = compare[int(policy)](head, itr);
+        // The policies pick the oldest of the requests that are first ready, or the oldest request if none is.
+        // Whether a request is first ready only depends on its type and its address down to the row, so the
+        // oldest request of each row bucket stands for the whole bucket, and a bucket younger than a ready
+        // candidate does not need to be checked.
+        int oldest = -1;
+        int head = -1;
+        for (int b = q.first_bucket(); b != -1; b = q.next_bucket(b)) {
+            if (oldest == -1 || is_older(q.bucket(b), q.bucket(oldest)))
+                oldest = b;
+            if (head != -1 && !is_older(q.bucket(b), q.bucket(head)))
+                continue;
+            if (is_first_ready(q.bucket_oldest(b)))
+                head = b;
+        }
 
-        return head;
+        return q.bucket_oldest(head != -1 ? head : oldest);
       } else {
         if (!q.size())
             return q.end();
@@ -140,7 +207,85 @@ FRFCFS_PriorHit"); }
     }
 
 private:
-    typedef list<Request>::iterator ReqIter;
+    typedef RequestQueue::iterator ReqIter;
+
+    vector<long> served;     // commands issued for each core in the current quantum
+    vector<double> attained; // exponential average of the service of each core over the quanta
+    vector<int> rank;        // rank of each core, 0 is the highest priority
+    long next_quantum = 0;
+
+    struct Rank_Key {
+        bool ready;
+        bool starving;
+        int rank;
+        bool hit;
+    };
+
+    void update_ranks()
+    {
+        next_quantum = ctrl->clk + quantum;
+        attained.resize(served.size(), 0.0);
+        vector<int> order(served.size());
+        for (size_t c = 0; c < served.size(); c++) {
+            attained[c] = alpha * attained[c] + (1.0 - alpha) * served[c];
+            served[c] = 0;
+            order[c] = c;
+        }
+        stable_sort(order.begin(), order.end(), [this] (int c1, int c2) {return attained[c1] < attained[c2];});
+        rank.assign(order.size(), 0);
+        for (size_t r = 0; r < order.size(); r++)
+            rank[order[r]] = r;
+    }
+
+    Rank_Key rank_key(RequestQueue& q, int b)
+    {
+        ReqIter req = q.bucket_oldest(b);
+        const RequestQueue::Bucket& bucket = q.bucket(b);
+        Rank_Key key;
+        key.ready = this->ctrl->is_ready(req);
+        key.starving = policy == Policy::ATLAS && this->ctrl->clk - bucket.oldest_arrive >= starvation;
+        key.rank = bucket.coreid < int(rank.size()) ? rank[bucket.coreid] : 0;
+        key.hit = this->ctrl->is_row_hit(req);
+        return key;
+    }
+
+    // whether the oldest request of bucket1 goes before the one of bucket2
+    bool is_higher(const Rank_Key& key1, const Rank_Key& key2, const RequestQueue::Bucket& bucket1,
+                   const RequestQueue::Bucket& bucket2)
+    {
+        if (key1.ready != key2.ready)
+            return key1.ready;
+        if (key1.starving != key2.starving)
+            return key1.starving;
+        if (policy == Policy::ATLAS && key1.rank != key2.rank)
+            return key1.rank < key2.rank;
+        if (key1.hit != key2.hit)
+            return key1.hit;
+        if (key1.rank != key2.rank)
+            return key1.rank < key2.rank;
+        return is_older(bucket1, bucket2);
+    }
+
+    // arrival order of the oldest requests of two buckets; requests that arrived in the same cycle keep the order
+    // they were queued in
+    bool is_older(const RequestQueue::Bucket& bucket1, const RequestQueue::Bucket& bucket2)
+    {
+        return bucket1.oldest_arrive < bucket2.oldest_arrive
+            || (bucket1.oldest_arrive == bucket2.oldest_arrive && bucket1.oldest_seq < bucket2.oldest_seq);
+    }
+
+    bool is_first_ready(ReqIter req)
+    {
+        switch (policy) {
+            case Policy::FRFCFS:
+                return this->ctrl->is_ready(req);
+            case Policy::FRFCFS_Cap:
+                return this->ctrl->is_ready(req) && (this->ctrl->rowtable->get_hits(req->addr_vec) <= this->cap);
+            default:
+                return false;
+        }
+    }
+
     function<ReqIter(ReqIter, ReqIter)> compare[int(Policy::MAX)] = {
         // FCFS
         [this] (ReqIter req1, ReqIter req2) {
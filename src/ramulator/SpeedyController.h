@@ -44,10 +44,13 @@ template <typename T>
 class SpeedyController
 // A FR-FCFS Open Row Controller, optimized for simulation speed.
 // Not For SALP-2
+// Exposes the interface Memory expects from Controller, so Memory<T, SpeedyController> can stand in for Memory<T>
+// (ramulator_controller). Refreshes every rank each nREFI and drains writes between the same watermarks as Controller
 {
 protected:
   ScalarStat row_hits;
   ScalarStat row_misses;
+  ScalarStat row_conflicts;
 private:
     class compair_depart_clk{
     public:
@@ -63,12 +66,14 @@ public:
     /* Commands to stdout */
     bool print_cmd_trace = false;
     /* Member Variables */
-    const unsigned int queue_capacity = 32;
+    unsigned int readq_capacity = 32;
+    unsigned int writeq_capacity = 32;
+    unsigned int otherq_capacity = 32;
     long clk = 0;
     DRAM<T>* channel;
 
-    double write_hi = 0.875;
-    double write_low = 0.5;
+    float wr_high_watermark = 0.8f; // threshold for switching to write mode
+    float wr_low_watermark = 0.2f; // threshold for switching back to read mode
 
     // request, first command, earliest clk
     typedef tuple<Request, typename T::Command, long> request_info;
@@ -76,6 +81,7 @@ public:
     request_queue readq;   // queue for read requests
     request_queue writeq;  // queue for write requests
     request_queue otherq;  // queue for all "other" requests (e.g., refresh)
+    request_queue actq;    // always empty: requests stay in readq/writeq until their column command
 
     // read requests that are about to receive data from DRAM
     priority_queue<Request, vector<Request>, compair_depart_clk> pending;
@@ -83,21 +89,49 @@ public:
     bool write_mode = false;  // whether write requests should be prioritized over reads
     long refreshed = 0;  // last time refresh requests were generated
 
+    // callback function for passing stats to Scarab when an event occurs
+    void (*stats_callback)(int, int, long) = nullptr;
+
+    /* Deferred callbacks, as in Controller: queued while Memory ticks the channels in parallel */
+    bool defer_callbacks = false;
+    vector<Request> deferred_reads;
+    vector<pair<int, int>> deferred_stats;
+
+    /* Bank contention profile (SET_PROF_DRAM), as in Controller */
+    vector<uint32_t> bank_acts;
+    vector<uint32_t> bank_conflicts;
+
     /* Constructor */
-    SpeedyController(const Config& configs, DRAM<T>* channel) :
+    SpeedyController(const Config& configs, DRAM<T>* channel, void (*_stats_callback)(int,int,long)) :
         channel(channel)
     {
+        stats_callback = _stats_callback;
+
         record_cmd_trace = configs.record_cmd_trace();
         print_cmd_trace = configs.print_cmd_trace();
         if (record_cmd_trace){
+            if (configs["cmd_trace_prefix"] != "") {
+              cmd_trace_prefix = configs["cmd_trace_prefix"];
+            }
             string prefix = cmd_trace_prefix + "chan-" + to_string(channel->id) + "-rank-";
             string suffix = ".cmdtrace";
             for (unsigned int i = 0; i < channel->children.size(); i++)
                 cmd_trace_files.emplace_back(prefix + to_string(i) + suffix);
         }
-        readq.reserve(queue_capacity);
-        writeq.reserve(queue_capacity);
-        otherq.reserve(queue_capacity);
+
+        int num_banks = 1;
+        for (int lvl = 1; lvl <= int(T::Level::Bank); lvl++)
+            num_banks *= channel->spec->org_entry.count[lvl];
+        bank_acts.assign(num_banks, 0);
+        bank_conflicts.assign(num_banks, 0);
+
+        readq_capacity = (unsigned int) configs.get_int("readq_entries");
+        writeq_capacity = (unsigned int) configs.get_int("writeq_entries");
+        // one refresh per rank may still be waiting when the next round is injected
+        otherq_capacity = max(otherq_capacity, 2 * (unsigned int) channel->children.size());
+        readq.reserve(readq_capacity);
+        writeq.reserve(writeq_capacity);
+        otherq.reserve(otherq_capacity);
 
         // regStats
 
@@ -111,6 +145,11 @@ public:
             .desc("Number of row misses")
             .precision(0)
             ;
+        row_conflicts
+            .name("row_conflicts_channel_"+to_string(channel->id))
+            .desc("Number of row conflicts")
+            .precision(0)
+            ;
     }
 
     ~SpeedyController(){
@@ -121,7 +160,7 @@ public:
 
     /* Member Functions */
 
-    void finish(int read_req, int write_req, int dram_cycles) {
+    void finish(long read_req, long dram_cycles) {
       // call finish function of each channel
       channel->finish(dram_cycles);
     }
@@ -132,7 +171,11 @@ public:
             req.type == Request::Type::READ? readq:
             req.type == Request::Type::WRITE? writeq:
                                              otherq;
-        if (queue_capacity == q.size())
+        unsigned int capacity =
+            req.type == Request::Type::READ? readq_capacity:
+            req.type == Request::Type::WRITE? writeq_capacity:
+                                             otherq_capacity;
+        if (capacity == q.size())
             return false;
 
         req.arrive = clk;
@@ -151,6 +194,13 @@ public:
         return true;
     }
 
+    bool has_room(Request::Type type)
+    {
+        return type == Request::Type::READ? readq.size() < readq_capacity:
+               type == Request::Type::WRITE? writeq.size() < writeq_capacity:
+                                            otherq.size() < otherq_capacity;
+    }
+
     void tick()
     {
         clk++;
@@ -159,8 +209,10 @@ public:
         if (pending.size()) {
             Request req = pending.top();
             if (req.depart <= clk) {
+                if (req.depart - req.arrive > 1) // this request really accessed a row
+                    channel->update_serving_requests(req.addr_vec.data(), -1, clk);
                 req.depart = clk; // actual depart clk
-                req.callback(req);
+                complete_read(req);
                 pending.pop();
             }
         }
@@ -183,13 +235,13 @@ public:
 
         /*** 3. Should we schedule writes? ***/
         if (!write_mode) {
-            // yes -- write queue is almost full or read queue is empty
-            if (writeq.size() >= (unsigned int)(write_hi * queue_capacity) || readq.size() == 0)
+            // yes -- write queue is almost full. Like Controller, an empty read queue alone does not start a drain
+            if (writeq.size() > unsigned(wr_high_watermark * writeq_capacity))
                 write_mode = true;
         }
         else {
             // no -- write queue is almost empty and read queue is not empty
-            if (writeq.size() <= (unsigned int)(write_low * queue_capacity) && readq.size() != 0)
+            if (writeq.size() < unsigned(wr_low_watermark * writeq_capacity) && readq.size() != 0)
                 write_mode = false;
         }
 
@@ -201,10 +253,94 @@ public:
 
     bool is_row_hit(Request& req)
     {
-        typename T::Command cmd = get_first_cmd(req);
+        // cmd must be decided by the request type, not the first cmd
+        typename T::Command cmd = channel->spec->translate[int(req.type)];
         return channel->check_row_hit(cmd, req.addr_vec.data());
     }
 
+    bool is_row_open(Request& req)
+    {
+        // cmd must be decided by the request type, not the first cmd
+        typename T::Command cmd = channel->spec->translate[int(req.type)];
+        return channel->check_row_open(cmd, req.addr_vec.data());
+    }
+
+    // For telling whether this channel is busying in processing read or write
+    bool is_active() {
+      return (channel->cur_serving_requests > 0);
+    }
+
+    void complete_read(Request& req) {
+      if (defer_callbacks)
+        deferred_reads.push_back(req);
+      else
+        req.callback(req);
+    }
+
+    void report_stat(int coreid, int type) {
+      if (defer_callbacks)
+        deferred_stats.push_back(make_pair(coreid, type));
+      else
+        stats_callback(coreid, type, 1);
+    }
+
+    // Flattened index of the bank addr_vec falls in, rank-major
+    int bank_index(const int* addr_vec) const {
+        int index = 0;
+        for (int lvl = 1; lvl <= int(T::Level::Bank); lvl++)
+            index = index * channel->spec->org_entry.count[lvl] + addr_vec[lvl];
+        return index;
+    }
+
+    int bank_prof_num_banks() const {
+        return int(bank_acts.size());
+    }
+
+    void bank_prof_read(uint32_t* acts, uint32_t* conflicts) {
+        copy(bank_acts.begin(), bank_acts.end(), acts);
+        copy(bank_conflicts.begin(), bank_conflicts.end(), conflicts);
+        fill(bank_acts.begin(), bank_acts.end(), 0);
+        fill(bank_conflicts.begin(), bank_conflicts.end(), 0);
+    }
+
+    void replay_deferred() {
+      for (auto& req : deferred_reads)
+        req.callback(req);
+      for (auto& stat : deferred_stats)
+        stats_callback(stat.first, stat.second, 1);
+      deferred_reads.clear();
+      deferred_stats.clear();
+    }
+
+    // Ticks with no queued request and no write drain, before the first pending read departs and the next refresh
+    // is due. There is no speculative precharge, so open rows do not matter
+    long idle_ticks() {
+      if (readq.size() || otherq.size())
+        return 0;
+      if (write_mode && writeq.size())
+        return 0;
+      long next = refreshed + channel->spec->speed_entry.nREFI;
+      if (pending.size())
+        next = min(next, pending.top().depart);
+      return max(0L, next - clk - 1);
+    }
+
+    void skip(long ticks) {
+      clk += ticks;
+    }
+
+    void set_high_writeq_watermark(const float watermark) {
+       wr_high_watermark = watermark;
+    }
+
+    void set_low_writeq_watermark(const float watermark) {
+       wr_low_watermark = watermark;
+    }
+
+    // no per-core row buffer stats to record
+    void record_core(int coreid) {
+    }
+
 private:
 
     static bool compair_first_clk(const request_info& lhs, const request_info& rhs) {
@@ -259,20 +395,26 @@ private:
         if (req.is_first_command) {
             req.is_first_command = false;
             if (req.type == Request::Type::READ || req.type == Request::Type::WRITE) {
+                channel->update_serving_requests(req.addr_vec.data(), 1, clk);
                 if (is_row_hit(req))
                     ++row_hits;
-                else
+                else if (is_row_open(req)) {
+                    ++row_conflicts;
+                    ++bank_conflicts[bank_index(req.addr_vec.data())];
+                } else
                     ++row_misses;
             }
         }
 
-        issue_cmd(first_cmd, req.addr_vec.data());
+        issue_cmd(first_cmd, req.addr_vec.data(), req.coreid);
 
         if (first_cmd == channel->spec->translate[int(req.type)]){
             if (req.type == Request::Type::READ) {
                 req.depart = clk + channel->spec->read_latency;
                 pending.push(req);
             }
+            if (req.type == Request::Type::WRITE)
+                channel->update_serving_requests(req.addr_vec.data(), -1, clk);
             pop_heap(q.begin(), q.end(), compair_first_clk);
             q.pop_back();
         }
@@ -290,11 +432,22 @@ private:
         update(first_cmd, state_change, begin, end, otherq);
     }
 
-    void issue_cmd(typename T::Command cmd, int* addr_vec)
+    void issue_cmd(typename T::Command cmd, int* addr_vec, int coreid)
     {
         // assert(channel->check(cmd, addr_vec, clk));
         channel->update(cmd, addr_vec, clk);
 
+        if (channel->spec->is_opening(cmd)) {
+            report_stat(coreid, int(StatCallbackType::DRAM_ACT));
+            ++bank_acts[bank_index(addr_vec)];
+        }
+        if (channel->spec->is_closing(cmd))
+            report_stat(coreid, int(StatCallbackType::DRAM_PRE));
+        if (channel->spec->is_reading(cmd))
+            report_stat(coreid, int(StatCallbackType::DRAM_READ));
+        if (channel->spec->is_writing(cmd))
+            report_stat(coreid, int(StatCallbackType::DRAM_WRITE));
+
         if (record_cmd_trace){
             // select rank
             auto& file = cmd_trace_files[addr_vec[1]];
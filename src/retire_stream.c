@@ -0,0 +1,232 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : retire_stream.c
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Binary stream of the retired ops, for offline analysis
+ ***************************************************************************************/
+
+/* With RETIRE_STREAM_FILE set, every op retired by the cmp model is appended to
+   <file_tag><retire_stream_file>.<proc_id>.bin as a fixed-size Retire_Stream_Record.
+   The retiring core only copies the record into its ring; a background thread writes
+   the rings out (see bin/scarab_retirestream.py). Records are never dropped, so the
+   core waits for the thread if its ring is full. Every core has its own ring, so the
+   cores of PARALLEL_CORES retire without locking.
+
+   File format (native endianness):
+   header: char magic[8] "SCARRET", uns32 version, uns32 proc_id, uns32 record size
+   then one Retire_Stream_Record per retired op, in retire order */
+
+#include "retire_stream.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "general.param.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define RETIRE_STREAM_MAGIC "SCARRET"
+#define RETIRE_STREAM_VERSION 1
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Retire_Stream_Core_struct {
+  FILE* file;
+  Retire_Stream_Record* ring;
+  uns64 head; /* written by the retiring core */
+  uns64 tail; /* written by the writer thread */
+} Retire_Stream_Core;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Retire_Stream_Core* cores = NULL;
+static pthread_t writer_thread;
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_cond = PTHREAD_COND_INITIALIZER;
+static Flag writer_stop = FALSE;
+static Flag writer_running = FALSE;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static void* writer_loop(void*);
+static void flush_ring(Retire_Stream_Core* core);
+static void retire_stream_exit(void);
+
+/**************************************************************************************/
+/* retire_stream_init: */
+
+void retire_stream_init(void) {
+  if (!RETIRE_STREAM_FILE)
+    return;
+  ASSERTM(0, RETIRE_STREAM_RING_SIZE && !(RETIRE_STREAM_RING_SIZE & (RETIRE_STREAM_RING_SIZE - 1)),
+          "RETIRE_STREAM_RING_SIZE must be a power of 2\n");
+
+  cores = (Retire_Stream_Core*)calloc(NUM_CORES, sizeof(Retire_Stream_Core));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Retire_Stream_Core* core = &cores[proc_id];
+    char name[MAX_STR_LENGTH + 1];
+    snprintf(name, MAX_STR_LENGTH, "%s%s.%u.bin", FILE_TAG, RETIRE_STREAM_FILE, proc_id);
+    core->file = fopen(name, "wb");
+    ASSERTM(proc_id, core->file, "Could not open %s\n", name);
+    uns32 header[3] = {RETIRE_STREAM_VERSION, proc_id, sizeof(Retire_Stream_Record)};
+    fwrite(RETIRE_STREAM_MAGIC, 1, 8, core->file);
+    fwrite(header, sizeof(header), 1, core->file);
+    core->ring = (Retire_Stream_Record*)malloc(RETIRE_STREAM_RING_SIZE * sizeof(Retire_Stream_Record));
+  }
+
+  writer_running = !pthread_create(&writer_thread, NULL, writer_loop, NULL);
+  ASSERTM(0, writer_running, "Could not start the retire stream writer thread\n");
+  /* so that the ops leading up to an ASSERT still reach the files */
+  atexit(retire_stream_exit);
+}
+
+/**************************************************************************************/
+/* cycles_before_retire: */
+
+static inline uns32 cycles_before_retire(Counter retire_cycle, Counter cycle) {
+  return cycle <= retire_cycle ? (uns32)MIN2(retire_cycle - cycle, 0xffffffffULL) : 0xffffffff;
+}
+
+/**************************************************************************************/
+/* retire_stream_op: called by the retiring core right before the op is freed */
+
+void retire_stream_op(Op* op) {
+  if (!RETIRE_STREAM_FILE)
+    return;
+
+  Retire_Stream_Core* core = &cores[op->proc_id];
+  while (core->head - __atomic_load_n(&core->tail, __ATOMIC_ACQUIRE) == RETIRE_STREAM_RING_SIZE) {
+    pthread_cond_signal(&writer_cond);
+    sched_yield();
+  }
+
+  Retire_Stream_Record* rec = &core->ring[core->head & (RETIRE_STREAM_RING_SIZE - 1)];
+  Mem_Type mem_type = op->table_info->mem_type;
+  rec->pc = op->inst_info->addr;
+  rec->addr = mem_type != NOT_MEM ? op->oracle_info.va : op->table_info->cf_type ? op->oracle_info.npc : 0;
+  rec->retire_cycle = op->retire_cycle;
+  rec->fetch_lat = cycles_before_retire(op->retire_cycle, op->fetch_cycle);
+  rec->sched_lat = cycles_before_retire(op->retire_cycle, op->sched_cycle);
+  rec->done_lat = cycles_before_retire(op->retire_cycle, op->done_cycle);
+  rec->op_type = op->table_info->op_type;
+  rec->cf_type = op->table_info->cf_type;
+
+  uns miss_level = op->engine_info.l1_miss ? 3 : op->engine_info.mlc_miss ? 2 : op->engine_info.dcmiss ? 1 : 0;
+  rec->flags = (op->oracle_info.dir ? RETIRE_STREAM_DIR : 0) | (op->oracle_info.pred ? RETIRE_STREAM_PRED : 0) |
+               (op->oracle_info.mispred ? RETIRE_STREAM_MISPRED : 0) |
+               (op->oracle_info.misfetch ? RETIRE_STREAM_MISFETCH : 0) | (op->bom ? RETIRE_STREAM_BOM : 0) |
+               (op->eom ? RETIRE_STREAM_EOM : 0) | miss_level << RETIRE_STREAM_MISS_SHIFT |
+               mem_type << RETIRE_STREAM_MEM_SHIFT;
+
+  __atomic_store_n(&core->head, core->head + 1, __ATOMIC_RELEASE);
+  /* wake the writer only on the way through half full, not for every op */
+  if (core->head - __atomic_load_n(&core->tail, __ATOMIC_ACQUIRE) == RETIRE_STREAM_RING_SIZE / 2)
+    pthread_cond_signal(&writer_cond);
+}
+
+/**************************************************************************************/
+/* retire_stream_done: */
+
+void retire_stream_done(void) {
+  if (!RETIRE_STREAM_FILE)
+    return;
+  retire_stream_exit();
+}
+
+/**************************************************************************************/
+/* flush_ring: write the records between tail and head (writer thread only) */
+
+static void flush_ring(Retire_Stream_Core* core) {
+  uns64 head = __atomic_load_n(&core->head, __ATOMIC_ACQUIRE);
+  uns64 tail = core->tail;
+  while (tail != head) {
+    uns64 pos = tail & (RETIRE_STREAM_RING_SIZE - 1);
+    uns64 count = MIN2(head - tail, RETIRE_STREAM_RING_SIZE - pos);
+    fwrite(&core->ring[pos], sizeof(Retire_Stream_Record), count, core->file);
+    tail += count;
+    __atomic_store_n(&core->tail, tail, __ATOMIC_RELEASE);
+  }
+}
+
+/**************************************************************************************/
+/* writer_loop: */
+
+static void* writer_loop(void* arg) {
+  UNUSED(arg);
+  pthread_mutex_lock(&writer_lock);
+  while (TRUE) {
+    Flag stop = writer_stop;
+    pthread_mutex_unlock(&writer_lock);
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      flush_ring(&cores[proc_id]);
+    pthread_mutex_lock(&writer_lock);
+    if (stop)
+      break;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 10 * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    if (!writer_stop)
+      pthread_cond_timedwait(&writer_cond, &writer_lock, &deadline);
+  }
+  pthread_mutex_unlock(&writer_lock);
+  return NULL;
+}
+
+/**************************************************************************************/
+/* retire_stream_exit: stop the writer thread after it drained the rings */
+
+static void retire_stream_exit(void) {
+  if (!writer_running)
+    return;
+  pthread_mutex_lock(&writer_lock);
+  writer_stop = TRUE;
+  pthread_cond_signal(&writer_cond);
+  pthread_mutex_unlock(&writer_lock);
+  pthread_join(writer_thread, NULL);
+  writer_running = FALSE;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    fclose(cores[proc_id].file);
+    free(cores[proc_id].ring);
+  }
+}
@@ -0,0 +1,78 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : retire_stream.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Binary stream of the retired ops, for offline analysis
+ ***************************************************************************************/
+
+#ifndef __RETIRE_STREAM_H__
+#define __RETIRE_STREAM_H__
+
+#include "globals/global_types.h"
+
+#include "op.h"
+
+/**************************************************************************************/
+/* Types */
+
+/* One record per retired op (see retire_stream.c for the file format). The cycle
+   fields count back from retire_cycle and saturate at 0xffffffff for ops that never
+   went through the stage. */
+typedef struct Retire_Stream_Record_struct {
+  uns64 pc;            // inst_info->addr
+  uns64 addr;          // va of memory ops, true next pc of control flow ops, 0 otherwise
+  uns64 retire_cycle;  // cycle the op retired
+  uns32 fetch_lat;     // retire_cycle - fetch_cycle
+  uns32 sched_lat;     // retire_cycle - sched_cycle
+  uns32 done_lat;      // retire_cycle - done_cycle
+  uns8 op_type;        // Op_Type
+  uns8 cf_type;        // Cf_Type
+  uns16 flags;         // RETIRE_STREAM_* bits below
+} Retire_Stream_Record;
+
+#define RETIRE_STREAM_DIR 0x1        // oracle direction of a branch
+#define RETIRE_STREAM_PRED 0x2       // predicted direction of a branch
+#define RETIRE_STREAM_MISPRED 0x4    // direction mispredicted
+#define RETIRE_STREAM_MISFETCH 0x8   // only the target mispredicted
+#define RETIRE_STREAM_BOM 0x10       // first uop of the instruction
+#define RETIRE_STREAM_EOM 0x20       // last uop of the instruction
+#define RETIRE_STREAM_MISS_SHIFT 6   // 2 bits: 0 dcache hit or no access, 1 dcache miss,
+                                     // 2 MLC miss, 3 L1 miss
+#define RETIRE_STREAM_MEM_SHIFT 8    // 3 bits: Mem_Type
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Open the per-core files and start the writer thread */
+void retire_stream_init(void);
+
+/* Record a retired op */
+void retire_stream_op(Op* op);
+
+/* Drain the rings and close the files */
+void retire_stream_done(void);
+
+#endif  // __RETIRE_STREAM_H__
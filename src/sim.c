@@ -29,6 +29,7 @@
 #include "sim.h"
 
 #include <fcntl.h>
+#include <math.h>
 #include <signal.h>
 #include <stdio.h>
 #include <time.h>
@@ -40,16 +41,25 @@
 #include "globals/utils.h"
 
 #include "debug/debug.param.h"
+#include "debug/debug_log.h"
 #include "debug/debug_macros.h"
 #include "debug/debug_print.h"
+#include "debug/host_prof.h"
+#include "debug/live_stats.h"
 #include "debug/memview.h"
+#include "debug/pc_prof.h"
 #include "debug/pipeview.h"
+#include "debug/set_prof.h"
+#include "debug/state_hash.h"
 
 #include "bp/bp.param.h"
 #include "core.param.h"
 #include "general.param.h"
+#include "memory/memory.param.h"
 #include "prefetcher/pref.param.h"
 
+#include "bp/bp_shadow.h"
+#include "libs/table_alloc.h"
 #include "frontend/frontend.h"
 #include "frontend/frontend_intf.h"
 #include "frontend/pin_trace_fe.h"
@@ -57,17 +67,27 @@
 #include "prefetcher/eip.h"
 #include "prefetcher/fdip.h"
 
+#include "adaptive_warmup.h"
+#include "bp_only_model.h"
+#include "interval_model.h"
+#include "mem_replay_model.h"
 #include "cmp_model.h"
+#include "dataflow_model.h"
 #include "dumb_model.h"
+#include "fork_sweep.h"
+#include "host_placement.h"
+#include "online_phase.h"
 #include "freq.h"
 #include "model.h"
 #include "op_pool.h"
 #include "optimizer2.h"
 #include "ramulator.h"
+#include "retire_stream.h"
 #include "stat_trace.h"
 #include "statistics.h"
 #include "thread.h"
 #include "trigger.h"
+#include "warm_state.h"
 
 /**************************************************************************************/
 /* Macros */
@@ -79,6 +99,13 @@
 
 Trigger* sim_limit;
 Trigger* clear_stats;
+Trigger* dump_stats_trigger;
+static Trigger_Set sim_triggers; /* the triggers the full_sim loop polls */
+static Flag sim_limit_reached;
+static Flag full_sim_uarch_model; /* the model has a pipeline (see full_sim_begin) */
+static Flag full_sim_uncore_model;
+static Flag full_sim_all_done;
+static Flag full_sim_any_done;
 Counter* inst_limit;
 
 // Current version does not support more than 8 cores!
@@ -88,8 +115,8 @@ Counter* op_count;              /* the global op counter per core*/
 Counter* inst_count;            /* the global instruction counter - retired per core */
 Counter* inst_count_fetched;    /* the global FETCHED instruction counter - retired per core */
 Counter* uop_count;             /* the global uop counter - retired per core*/
-Counter cycle_count = 0;        /* the global cycle counter */
-Counter sim_time = 0;           /* the global time counter */
+CORE_LOCAL Counter cycle_count = 0;        /* the global cycle counter */
+CORE_LOCAL Counter sim_time = 0; /* the global time counter */
 Counter* pret_inst_count;       /* the global pseudo-retired instruction counter */
 Flag* trace_read_done;
 Flag* reached_exit;
@@ -114,6 +141,7 @@ Counter period_ID = 0;
 Flag* warmup_dump_done;
 
 time_t sim_start_time; /* the time that the simulator was started */
+static struct timespec fidelity_start_time; /* host time at init, for the FIDELITY report */
 
 FILE* mystdout;      /* default output (can be redirected via --stdout) */
 FILE* mystderr;      /* default error (can be redirected via --stderr) */
@@ -126,7 +154,7 @@ Model* model; /* pointer to the simulator model being used
        (points to an entry in the model_table array) */
 
 Thread_Data single_td;        /* cmp Only For single processor: backward compatibility issue*/
-Thread_Data* td = &single_td; /* array of tds for muti-core, all state
+CORE_LOCAL Thread_Data* td = &single_td; /* array of tds for muti-core, all state
                                  associated with the simulated thread */
 
 /**************************************************************************************/
@@ -143,13 +171,28 @@ static inline Counter check_forward_progress(uns8 proc_id);
 static inline double sim_progress(void);
 static inline void set_last_sim_param(uns8 proc_id);
 static inline void print_bogus_sim_param(uns8 proc_id);
+static void sample_cycle(uns proc_id);
+static void sample_report(void);
+static void region_chain_init(void);
+static void region_chain_cycle(uns proc_id);
+static void region_chain_report(void);
+static void fidelity_report(void);
+static void converge_init(void);
+static void converge_batch(void);
+static void trace_sched_cycle(uns proc_id);
+static inline void full_sim_cycle(void);
+static void uop_sim_warmup_fast(void);
+static void uop_sim_warmup_parallel(void);
+static void sim_limit_action(Trigger* trigger);
+static void clear_stats_action(Trigger* trigger);
+static void dump_stats_action(Trigger* trigger);
 
 /**************************************************************************************/
 /* handle_SIGINT: this handler is for exiting smoothly when a SIGINT is caught
  */
 
 void handle_SIGINT(int signum) {
-  uns8 proc_id;
+  uns proc_id;
 
   ASSERTU(0, signum == SIGINT);
 
@@ -225,6 +268,8 @@ static inline void check_heartbeat(uns8 proc_id, Flag final) {
     double progress_frac = 0.0;
     if (!final) {
       ASSERT(0, operating_mode == SIMULATION_MODE);
+      if (CONVERGE_REL_ERROR)
+        converge_batch();
       progress_frac = sim_progress();  // sim_progress() only works in
                                        // SIMULATION_MODE
       int heartbeat_idx = (int)(progress_frac * NUM_HEARTBEATS);
@@ -279,6 +324,8 @@ static inline void check_heartbeat(uns8 proc_id, Flag final) {
       }
       fprintf(mystdout, "} -- %.2f KIPS (%.2f KIPS)\n", int_khz, cum_khz);
       fflush(mystdout);
+      if (HOST_PROF)
+        host_prof_heartbeat();
       heartbeat_last_time = cur_time;
       heartbeat_last_cycle_count = cycle_count;
       heartbeat_last_inst_count = total_inst_count;
@@ -297,7 +344,7 @@ static inline Counter check_forward_progress(uns8 proc_id) {
   }
 
   if (!(cycle_count - last_forward_progress[proc_id] <= (Counter)FORWARD_PROGRESS_LIMIT)) {
-    uns8 proc_id2;
+    uns proc_id2;
     for (proc_id2 = 0; proc_id2 < NUM_CORES; proc_id2++) {
       if (!sim_done[proc_id2])
         dump_stats(proc_id2, TRUE, global_stat_array[proc_id2], NUM_GLOBAL_STATS);
@@ -390,6 +437,8 @@ static void init_output_streams() {
       exit(15);
     }
   }
+
+  debug_log_init();
 }
 
 /**************************************************************************************/
@@ -402,6 +451,7 @@ void close_output_streams(void) {
     fclose(mystderr);
   if (STATUS_FILE)
     fclose(mystatus);
+  debug_log_done();
 }
 
 /**************************************************************************************/
@@ -475,6 +525,34 @@ void process_params(void) {
       ASSERTM(0, cores_specified == NUM_CORES, "Invalid INST_LIMIT syntax: %s\n", INST_LIMIT);
     }
   }
+  if (SAMPLE_PERIOD) {
+    ASSERTM(0, NUM_CORES == 1 && SIM_MODEL == CMP_MODEL, "SAMPLE_PERIOD works only for a single cmp core\n");
+    ASSERTM(0, SAMPLE_SIZE && SAMPLE_DETAILED_WARMUP + SAMPLE_SIZE < SAMPLE_PERIOD,
+            "SAMPLE_DETAILED_WARMUP + SAMPLE_SIZE must be less than SAMPLE_PERIOD\n");
+  }
+  if (REGION_CHAIN) {
+    ASSERTM(0, NUM_CORES == 1 && SIM_MODEL == CMP_MODEL && !SAMPLE_PERIOD && !PHASE_INTERVAL,
+            "REGION_CHAIN works only for a single cmp core without SAMPLE_PERIOD or PHASE_INTERVAL\n");
+  }
+  if (PHASE_INTERVAL) {
+    ASSERTM(0, NUM_CORES == 1 && SIM_MODEL == CMP_MODEL && !SAMPLE_PERIOD,
+            "PHASE_INTERVAL works only for a single cmp core without SAMPLE_PERIOD\n");
+    ASSERTM(0, PHASE_DETAILED_SAMPLES, "PHASE_DETAILED_SAMPLES must be at least 1\n");
+  }
+
+  if (CONVERGE_REL_ERROR) {
+    ASSERTM(0, HEARTBEAT_INTERVAL && !SAMPLE_PERIOD, "CONVERGE_REL_ERROR needs HEARTBEAT_INTERVAL and no sampling\n");
+    ASSERTM(0, CONVERGE_MIN_BATCHES >= 2, "CONVERGE_MIN_BATCHES must be at least 2\n");
+  }
+
+  if (TRACE_SCHED_PROGRAMS) {
+    ASSERTM(0, FRONTEND == FE_TRACE && SIM_MODEL == CMP_MODEL && !SAMPLE_PERIOD,
+            "TRACE_SCHED_PROGRAMS works only for the cmp model with the trace frontend and without sampling\n");
+    ASSERTM(0, TRACE_SCHED_QUANTUM, "TRACE_SCHED_PROGRAMS needs a nonzero TRACE_SCHED_QUANTUM\n");
+  }
+
+  ASSERTM(0, !strcmp(STATS_FORMAT, "text") || !strcmp(STATS_FORMAT, "binary") || !strcmp(STATS_FORMAT, "both"),
+          "Unknown stats_format '%s' (expected text, binary or both)\n", STATS_FORMAT);
 }
 
 /**************************************************************************************/
@@ -490,13 +568,16 @@ void init_global(char* argv[], char* envp[]) {
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
     init_global_stats(proc_id);
   process_params();
+  host_placement_init();
   stat_trace_init();
-  if (SIM_MODEL != DUMB_MODEL)
+  retire_stream_init();
+  if (SIM_MODEL != DUMB_MODEL && SIM_MODEL != MEM_REPLAY_MODEL)
     frontend_init();
   power_intf_init();
   init_thread(td, argv, envp);  // Remove later may be? This is here for
                                 // execution driven version
   sim_start_time = time(NULL);
+  clock_gettime(CLOCK_MONOTONIC, &fidelity_start_time);
 }
 
 /**************************************************************************************/
@@ -532,6 +613,395 @@ static inline void print_bogus_sim_param(uns8 proc_id) {
           uop_count[proc_id] - sim_done_last_uop_count[proc_id], cycle_count - sim_done_last_cycle_count[proc_id], ipc);
 }
 
+/**************************************************************************************/
+/* Sampled simulation (SAMPLE_PERIOD): each period runs SAMPLE_DETAILED_WARMUP
+   instructions in detail to refill the pipeline, measures the CPI of the next
+   SAMPLE_SIZE, then stops fetch until the core drains and warms the caches and
+   predictors through model->warmup_func for the rest of the period. */
+
+typedef enum Sample_Phase_enum {
+  SAMPLE_PHASE_WARMUP,
+  SAMPLE_PHASE_MEASURE,
+  SAMPLE_PHASE_DRAIN,
+} Sample_Phase;
+
+static Sample_Phase sample_phase = SAMPLE_PHASE_WARMUP;
+static Counter sample_period_start; /* inst_count at the start of the period */
+static Counter sample_start_inst;   /* inst_count and cycle_count when measuring began */
+static Counter sample_start_cycle;
+static uns sample_count;
+static double sample_cpi_sum;
+static double sample_cpi_sq_sum;
+
+/* sample_cycle: advances the sampling phase of proc_id, called every cycle */
+static void sample_cycle(uns proc_id) {
+  if (sim_done[proc_id] || retired_exit[proc_id])
+    return;
+
+  switch (sample_phase) {
+    case SAMPLE_PHASE_WARMUP:
+      if (inst_count[proc_id] - sample_period_start >= SAMPLE_DETAILED_WARMUP) {
+        sample_start_inst = inst_count[proc_id];
+        sample_start_cycle = cycle_count;
+        sample_phase = SAMPLE_PHASE_MEASURE;
+      }
+      break;
+    case SAMPLE_PHASE_MEASURE:
+      if (inst_count[proc_id] - sample_start_inst >= SAMPLE_SIZE) {
+        double cpi = (double)(cycle_count - sample_start_cycle) / (inst_count[proc_id] - sample_start_inst);
+        sample_count++;
+        sample_cpi_sum += cpi;
+        sample_cpi_sq_sum += cpi * cpi;
+        decoupled_fe_stall_on_path(proc_id, TRUE);
+        sample_phase = SAMPLE_PHASE_DRAIN;
+      }
+      break;
+    case SAMPLE_PHASE_DRAIN:
+      if (cmp_is_drained(proc_id)) {
+        Counter done = inst_count[proc_id] - sample_period_start;
+        if (done < SAMPLE_PERIOD)
+          sim_functional_warm(proc_id, SAMPLE_PERIOD - done);
+        decoupled_fe_stall_on_path(proc_id, FALSE);
+        sample_period_start = inst_count[proc_id];
+        sample_phase = SAMPLE_PHASE_WARMUP;
+      }
+      break;
+  }
+}
+
+/* sim_functional_warm: fetches up to num_insts instructions of proc_id
+   (stopping at INST_LIMIT or the exit) and feeds them to model->warmup_func,
+   advancing time like uop_sim does so cache replacement keeps working */
+void sim_functional_warm(uns proc_id, Counter num_insts) {
+  Op op;
+  Table_Info table_info;
+  Inst_Info inst_info;
+  op.table_info = &table_info;
+  op.inst_info = &inst_info;
+  op.mbp7_info = NULL;
+
+  Counter stop = inst_count[proc_id] + num_insts;
+  if (INST_LIMIT)
+    stop = MIN2(stop, inst_limit[proc_id]);
+
+  stat_integrators_pause(TRUE);
+
+  while (inst_count[proc_id] < stop && !retired_exit[proc_id]) {
+    frontend_fetch_op(proc_id, &op);
+    op_count[proc_id]++;
+    if (op.exit)
+      retired_exit[proc_id] = TRUE;
+    model->warmup_func(&op);
+    if (PHASE_INTERVAL)
+      online_phase_op(&op);
+    if (op.eom) {
+      inst_count[proc_id]++;
+      inst_count_fetched[proc_id]++;
+      frontend_retire(op.proc_id, op.inst_uid);
+      do {
+        freq_advance_time();
+      } while (!freq_is_ready(FREQ_DOMAIN_L1));
+      sim_time = freq_time();
+    }
+  }
+  stat_integrators_pause(FALSE);
+}
+
+/* sample_report: prints the mean sampled CPI with its 95% confidence interval */
+static void sample_report(void) {
+  if (!sample_count) {
+    fprintf(mystdout, "** Sampling: no complete sample\n");
+    return;
+  }
+  double mean = sample_cpi_sum / sample_count;
+  double var = sample_count > 1 ? (sample_cpi_sq_sum - sample_count * mean * mean) / (sample_count - 1) : 0.0;
+  double half_width = 1.96 * sqrt(MAX2(var, 0.0) / sample_count);
+  fprintf(mystdout, "** Sampling: %u samples  CPI: %.4f +- %.4f (95%% confidence, +-%.2f%%)\n", sample_count, mean,
+          half_width, 100.0 * half_width / mean);
+}
+
+/* fidelity_report: prints the host speed of the run, and its speedup over the
+   accurate run when FIDELITY_REF_KIPS gives the speed of that */
+static void fidelity_report(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double secs = (now.tv_sec - fidelity_start_time.tv_sec) + (now.tv_nsec - fidelity_start_time.tv_nsec) * 1e-9;
+  Counter insts = 0;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    insts += inst_count[proc_id];
+  double kips = secs > 0 ? insts / secs / 1000 : 0.0;
+  fprintf(mystdout, "** Fidelity: %s  %.1f KIPS", FIDELITY, kips);
+  if (FIDELITY_REF_KIPS > 0)
+    fprintf(mystdout, "  speedup: %.2fx over %.1f KIPS", kips / FIDELITY_REF_KIPS, FIDELITY_REF_KIPS);
+  fprintf(mystdout, "\n");
+}
+
+/**************************************************************************************/
+/* Region chaining (REGION_CHAIN): the regions of the file are simulated in order in
+   one run. After each region the core drains, the gap up to
+   REGION_CHAIN_DETAILED_WARMUP instructions before the next region is warmed
+   functionally, and the rest is simulated in detail, so the caches and predictors
+   enter a region in the state the previous one and the gap left them in. */
+
+typedef enum Region_Phase_enum {
+  REGION_PHASE_WARMUP,
+  REGION_PHASE_MEASURE,
+  REGION_PHASE_DRAIN,
+} Region_Phase;
+
+typedef struct Region_struct {
+  Counter start;  /* inst_count at which the region begins */
+  Counter length; /* instructions in the region */
+  double weight;
+} Region;
+
+static Region* regions;
+static uns num_regions;
+static uns region_idx; /* region being warmed up, measured or drained after */
+static Region_Phase region_phase;
+static Counter region_start_cycle;
+static double region_cpi_sum; /* weighted */
+static double region_weight_sum;
+
+/* region_chain_init: reads the REGION_CHAIN file, one '<start> <length> [weight]'
+   line per region, and stalls fetch so the first gap is warmed functionally */
+static void region_chain_init(void) {
+  char line[MAX_STR_LENGTH + 1];
+  uns max_regions = 64;
+
+  FILE* file = fopen(REGION_CHAIN, "r");
+  ASSERTM(0, file, "Could not open the REGION_CHAIN file %s\n", REGION_CHAIN);
+  regions = (Region*)malloc(sizeof(Region) * max_regions);
+  while (fgets(line, sizeof(line), file)) {
+    unsigned long long start, length;
+    double weight = 1.0;
+    char* text = line + strspn(line, " \t");
+    if (*text == '#' || *text == '\n' || *text == '\0')
+      continue;
+    ASSERTM(0, sscanf(text, "%llu %llu %lf", &start, &length, &weight) >= 2, "Bad REGION_CHAIN line: %s", line);
+    ASSERTM(0, length, "REGION_CHAIN region %u is empty\n", num_regions);
+    ASSERTM(0, !num_regions || start >= regions[num_regions - 1].start + regions[num_regions - 1].length,
+            "REGION_CHAIN regions must be in trace order without overlaps (region %u)\n", num_regions);
+    if (num_regions == max_regions) {
+      max_regions *= 2;
+      regions = (Region*)realloc(regions, sizeof(Region) * max_regions);
+    }
+    regions[num_regions].start = start;
+    regions[num_regions].length = length;
+    regions[num_regions].weight = weight;
+    num_regions++;
+  }
+  fclose(file);
+  ASSERTM(0, num_regions, "REGION_CHAIN file %s has no regions\n", REGION_CHAIN);
+
+  decoupled_fe_stall_on_path(0, TRUE);
+  region_phase = REGION_PHASE_DRAIN;
+}
+
+/* region_chain_cycle: advances the region chain of proc_id, called every cycle */
+static void region_chain_cycle(uns proc_id) {
+  if (sim_done[proc_id] || retired_exit[proc_id])
+    return;
+
+  Region* region = &regions[region_idx];
+  switch (region_phase) {
+    case REGION_PHASE_WARMUP:
+      if (inst_count[proc_id] >= region->start) {
+        reset_stats(FALSE);  // drop the stats of the gap
+        region_start_cycle = cycle_count;
+        region->start = inst_count[proc_id];
+        region_phase = REGION_PHASE_MEASURE;
+      }
+      break;
+    case REGION_PHASE_MEASURE:
+      if (inst_count[proc_id] - region->start >= region->length) {
+        double cpi = (double)(cycle_count - region_start_cycle) / (inst_count[proc_id] - region->start);
+        char suffix[24];
+        fprintf(mystdout, "** Region %u: insts %llu-%llu  cycles: %llu  CPI: %.4f  weight: %.4f\n", region_idx,
+                region->start, inst_count[proc_id], cycle_count - region_start_cycle, cpi, region->weight);
+        snprintf(suffix, sizeof(suffix), ".region%u", region_idx);
+        stat_file_suffix = suffix;
+        dump_stats(proc_id, FALSE, global_stat_array[proc_id], NUM_GLOBAL_STATS);
+        stat_file_suffix = NULL;
+
+        region_cpi_sum += region->weight * cpi;
+        region_weight_sum += region->weight;
+        region_idx++;
+        decoupled_fe_stall_on_path(proc_id, TRUE);
+        region_phase = REGION_PHASE_DRAIN;
+      }
+      break;
+    case REGION_PHASE_DRAIN:
+      if (cmp_is_drained(proc_id)) {
+        if (region_idx == num_regions) {
+          reset_stats(FALSE);  // the final stats are the sum of the regions
+          sim_limit_reached = TRUE;
+          break;
+        }
+        Counter detailed_start = region->start > REGION_CHAIN_DETAILED_WARMUP
+                                   ? region->start - REGION_CHAIN_DETAILED_WARMUP
+                                   : 0;
+        if (inst_count[proc_id] < detailed_start)
+          sim_functional_warm(proc_id, detailed_start - inst_count[proc_id]);
+        decoupled_fe_stall_on_path(proc_id, FALSE);
+        region_phase = REGION_PHASE_WARMUP;
+      }
+      break;
+  }
+}
+
+/* region_chain_report: prints the weighted mean CPI of the simulated regions */
+static void region_chain_report(void) {
+  if (!region_weight_sum) {
+    fprintf(mystdout, "** Region chain: no complete region\n");
+    return;
+  }
+  fprintf(mystdout, "** Region chain: %u of %u regions  weighted CPI: %.4f\n", region_idx, num_regions,
+          region_cpi_sum / region_weight_sum);
+}
+
+/**************************************************************************************/
+/* Convergence stop (CONVERGE_REL_ERROR): each heartbeat interval of core 0 is a batch.
+   The batches all have HEARTBEAT_INTERVAL instructions, so the mean of their CPIs is the
+   CPI of the run, and the spread of the batch means gives its confidence interval. The
+   first batch, which starts from an empty pipeline, is left out. */
+
+#define CONVERGE_CPI 0
+#define CONVERGE_MPKI 1
+
+static int converge_stat = -1; /* CONVERGE_MPKI_STAT, or -1 */
+static Counter converge_last_inst;
+static Counter converge_last_cycle;
+static Counter converge_last_events;
+static Flag converge_started;
+static uns converge_batches;
+static double converge_sum[2];
+static double converge_sq_sum[2];
+
+/* converge_init: looks up the CONVERGE_MPKI_STAT stat */
+static void converge_init(void) {
+  if (!CONVERGE_MPKI_STAT)
+    return;
+  for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
+    if (!strcmp(global_stat_array[0][ii].name, CONVERGE_MPKI_STAT))
+      converge_stat = ii;
+  }
+  ASSERTM(0, converge_stat >= 0, "CONVERGE_MPKI_STAT: unknown stat %s\n", CONVERGE_MPKI_STAT);
+}
+
+/* converge_rel_error: the 95% confidence half-width of the mean of a metric over the
+   batches so far, relative to the mean */
+static double converge_rel_error(uns metric, double* mean) {
+  *mean = converge_sum[metric] / converge_batches;
+  double var = (converge_sq_sum[metric] - converge_batches * *mean * *mean) / (converge_batches - 1);
+  double half_width = 1.96 * sqrt(MAX2(var, 0.0) / converge_batches);
+  return *mean > 0.0 ? half_width / *mean : 0.0;
+}
+
+/* converge_set_value: sets a FLOAT stat of core 0, whatever periodic dumps folded into its total */
+static void converge_set_value(Stat_Enum stat, double value) {
+  RESET_STAT(0, stat);
+  INC_STAT_VALUE(0, stat, value - GET_TOTAL_STAT_VALUE(0, stat));
+}
+
+/* converge_batch: ends the current batch, called at every heartbeat of core 0 */
+static void converge_batch(void) {
+  Counter events = converge_stat >= 0 ? GET_TOTAL_STAT_EVENT(0, converge_stat) : 0;
+  Counter insts = inst_count[0] - converge_last_inst;
+  // the first batch, and a batch across a stats reset, only set the baseline
+  if (converge_started && insts && events >= converge_last_events) {
+    double cpi = (double)(cycle_count - converge_last_cycle) / insts;
+    double mpki = 1000.0 * (events - converge_last_events) / insts;
+    converge_batches++;
+    converge_sum[CONVERGE_CPI] += cpi;
+    converge_sq_sum[CONVERGE_CPI] += cpi * cpi;
+    converge_sum[CONVERGE_MPKI] += mpki;
+    converge_sq_sum[CONVERGE_MPKI] += mpki * mpki;
+  }
+  converge_started = TRUE;
+  converge_last_inst = inst_count[0];
+  converge_last_cycle = cycle_count;
+  converge_last_events = events;
+  if (converge_batches < 2)
+    return;
+
+  double cpi_mean, mpki_mean;
+  double cpi_error = converge_rel_error(CONVERGE_CPI, &cpi_mean);
+  double mpki_error = converge_rel_error(CONVERGE_MPKI, &mpki_mean);
+  RESET_STAT(0, CONVERGE_BATCHES);
+  INC_STAT_EVENT(0, CONVERGE_BATCHES, converge_batches - GET_TOTAL_STAT_EVENT(0, CONVERGE_BATCHES));
+  converge_set_value(CONVERGE_CPI_MEAN, cpi_mean);
+  converge_set_value(CONVERGE_CPI_REL_ERROR, cpi_error);
+  converge_set_value(CONVERGE_MPKI_MEAN, mpki_mean);
+  converge_set_value(CONVERGE_MPKI_REL_ERROR, mpki_error);
+
+  if (converge_batches < CONVERGE_MIN_BATCHES || cpi_error > CONVERGE_REL_ERROR || mpki_error > CONVERGE_REL_ERROR)
+    return;
+  STAT_EVENT(0, CONVERGE_STOPPED);
+  sim_limit_reached = TRUE;
+  fprintf(mystdout, "** Converged: %u batches  CPI: %.4f +- %.2f%%", converge_batches, cpi_mean, 100.0 * cpi_error);
+  if (converge_stat >= 0)
+    fprintf(mystdout, "  %s MPKI: %.4f +- %.2f%%", CONVERGE_MPKI_STAT, mpki_mean, 100.0 * mpki_error);
+  fprintf(mystdout, " (95%% confidence)\n");
+  fflush(mystdout);
+}
+
+#undef CONVERGE_CPI
+#undef CONVERGE_MPKI
+
+/**************************************************************************************/
+/* Trace scheduler (TRACE_SCHED_PROGRAMS): once a core has run its program for
+   TRACE_SCHED_QUANTUM cycles, fetch stops until the core drains and the core then
+   switches to the next waiting program. Predictor and cache state stay with the
+   core, as on a real context switch. */
+
+static Counter trace_sched_slice_start[MAX_NUM_PROCS]; /* cycle the running program got the core */
+static Flag trace_sched_draining[MAX_NUM_PROCS];
+
+/* trace_sched_cycle: advances the time slice of proc_id, called every cycle */
+static void trace_sched_cycle(uns proc_id) {
+  if (!trace_sched_draining[proc_id]) {
+    if (cycle_count - trace_sched_slice_start[proc_id] < TRACE_SCHED_QUANTUM || trace_read_done[proc_id])
+      return;
+    decoupled_fe_stall_on_path(proc_id, TRUE);
+    trace_sched_draining[proc_id] = TRUE;
+  }
+
+  STAT_EVENT(proc_id, TRACE_SCHED_DRAIN_CYCLES);
+  if (!cmp_is_core_drained(proc_id))
+    return;
+  // an exit fetched while draining restarts the program instead
+  if (!trace_read_done[proc_id]) {
+    trace_switch_program(proc_id);
+    STAT_EVENT(proc_id, TRACE_SCHED_SWITCHES);
+  }
+  decoupled_fe_stall_on_path(proc_id, FALSE);
+  trace_sched_draining[proc_id] = FALSE;
+  trace_sched_slice_start[proc_id] = cycle_count;
+}
+
+/**************************************************************************************/
+/* Actions of the full_sim triggers */
+
+static void sim_limit_action(Trigger* trigger) {
+  sim_limit_reached = TRUE;
+}
+
+static void clear_stats_action(Trigger* trigger) {
+  reset_stats(TRUE);
+}
+
+/* dump_stats_action: dumps the stats of every core to <stat file>.dump.<n> */
+static void dump_stats_action(Trigger* trigger) {
+  static Counter dump_id = 0;
+  char suffix[24];
+  snprintf(suffix, sizeof(suffix), ".dump.%llu", dump_id++);
+  stat_file_suffix = suffix;
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    dump_stats(proc_id, FALSE, global_stat_array[proc_id], NUM_GLOBAL_STATS);
+  stat_file_suffix = NULL;
+}
+
 /**************************************************************************************/
 /* uop_sim: This is the main loop for running in uop level simulation mode.*/
 
@@ -579,7 +1049,9 @@ void uop_sim() {
 
           switch (operating_mode) {
             case WARMUP_MODE:
-              model->warmup_func(&op);
+              /* with a warm state only the trace position needs to advance */
+              if (!LOAD_WARM_STATE)
+                model->warmup_func(&op);
               break;
             case SIMULATION_MODE:
               if (!sim_done[proc_id]) {
@@ -605,7 +1077,7 @@ void uop_sim() {
     }
     switch (operating_mode) {
       case WARMUP_MODE:
-        if (inst_count[0] == WARMUP || retired_exit[0]) {
+        if (inst_count[0] == WARMUP || retired_exit[0] || adaptive_warmup_converged()) {
           uop_sim_done = TRUE;
           check_heartbeat(0, TRUE);
         }
@@ -622,20 +1094,176 @@ void uop_sim() {
   }
 }
 
+/**************************************************************************************/
+/* uop_sim_warmup_fast: the WARMUP_MODE loop of uop_sim on instruction records from
+   frontend_fetch_warmup_batch instead of ops. Instructions are still consumed one
+   per core per time step so that cache replacement sees the same time order. The
+   batches never go past the last round of warmup, so no core reads ahead of the
+   instructions it warms with. */
+
+#define WARMUP_FAST_BATCH 256
+#define WARMUP_PARALLEL_CHUNK 4096
+
+static void uop_sim_warmup_fast(void) {
+  ASSERTM(0, SIM_MODEL == CMP_MODEL, "WARMUP_FAST_PATH works only with the cmp model\n");
+  if (PARALLEL_WARMUP) {
+    uop_sim_warmup_parallel();
+    return;
+  }
+  Warmup_Inst* batch = (Warmup_Inst*)malloc(sizeof(Warmup_Inst) * WARMUP_FAST_BATCH * NUM_CORES);
+  uns num[MAX_NUM_PROCS] = {0};
+  uns pos[MAX_NUM_PROCS] = {0};
+  Flag done = FALSE;
+
+  while (!done) {
+    Counter rounds_left = adaptive_warmup_next_end() - inst_count[0];
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      if ((DUMB_CORE_ON && DUMB_CORE == proc_id) || retired_exit[proc_id])
+        continue;
+      Warmup_Inst* core_batch = batch + proc_id * WARMUP_FAST_BATCH;
+      if (pos[proc_id] == num[proc_id]) {
+        uns max = MIN2(WARMUP_FAST_BATCH, rounds_left);
+        num[proc_id] = frontend_fetch_warmup_batch(proc_id, core_batch, max);
+        pos[proc_id] = 0;
+        ASSERT(proc_id, num[proc_id] > 0);
+      }
+      Warmup_Inst* inst = &core_batch[pos[proc_id]++];
+
+      op_count[proc_id]++;
+      inst_count[proc_id]++;
+      if (inst->exit)
+        retired_exit[proc_id] = TRUE;
+      ASSERTM(proc_id, !inst->exit, "Program ended before start of simulation\n");
+
+      /* with a warm state only the trace position needs to advance */
+      if (!LOAD_WARM_STATE)
+        cmp_warmup_inst(proc_id, inst);
+    }
+    if (inst_count[0] == WARMUP || retired_exit[0] || adaptive_warmup_converged()) {
+      done = TRUE;
+      check_heartbeat(0, TRUE);
+    }
+    // HACK that ensures that cache replacement works in warmup
+    do {
+      freq_advance_time();
+    } while (!freq_is_ready(FREQ_DOMAIN_L1));
+    sim_time = freq_time();
+  }
+  free(batch);
+}
+
+/**************************************************************************************/
+/* uop_sim_warmup_parallel: uop_sim_warmup_fast with the private structures of each
+   core warmed on its own thread (see cmp_warmup_parallel). The main thread reads a
+   chunk of rounds from every core, computes the sim_time of each round as the
+   sequential loop advances it, and lets the cmp model warm the chunk. */
+
+static void uop_sim_warmup_parallel(void) {
+  Warmup_Inst* batch = (Warmup_Inst*)malloc(sizeof(Warmup_Inst) * WARMUP_PARALLEL_CHUNK * NUM_CORES);
+  Warmup_Inst* insts[MAX_NUM_PROCS];
+  Counter round_time[WARMUP_PARALLEL_CHUNK];
+  Flag uses_warmup = !LOAD_WARM_STATE;
+
+  if (uses_warmup)
+    cmp_warmup_parallel_init();
+  while (inst_count[0] < WARMUP && !adaptive_warmup_converged()) {
+    uns num_rounds = MIN2(WARMUP_PARALLEL_CHUNK, adaptive_warmup_next_end() - inst_count[0]);
+    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+      insts[proc_id] = NULL;
+      if (DUMB_CORE_ON && DUMB_CORE == proc_id)
+        continue;
+      insts[proc_id] = batch + proc_id * WARMUP_PARALLEL_CHUNK;
+      uns num = 0;
+      while (num < num_rounds) {
+        uns got = frontend_fetch_warmup_batch(proc_id, insts[proc_id] + num, num_rounds - num);
+        ASSERT(proc_id, got > 0);
+        num += got;
+        ASSERTM(proc_id, !insts[proc_id][num - 1].exit, "Program ended before start of simulation\n");
+      }
+      op_count[proc_id] += num_rounds;
+      inst_count[proc_id] += num_rounds;
+    }
+    for (uns ii = 0; ii < num_rounds; ii++) {
+      round_time[ii] = sim_time;
+      // HACK that ensures that cache replacement works in warmup
+      do {
+        freq_advance_time();
+      } while (!freq_is_ready(FREQ_DOMAIN_L1));
+      sim_time = freq_time();
+    }
+    if (uses_warmup) {
+      Counter end_time = sim_time;
+      cmp_warmup_parallel(insts, num_rounds, round_time);
+      sim_time = end_time;
+    }
+  }
+  if (uses_warmup)
+    cmp_warmup_parallel_done();
+  check_heartbeat(0, TRUE);
+  free(batch);
+}
+
+/**************************************************************************************/
+/* full_sim_cycle: advances the models by one cycle */
+
+static inline void full_sim_cycle(void) {
+  freq_advance_time();
+  sim_time = freq_time();
+  model->cycle_func();
+  if (SIM_MODEL != DUMB_MODEL && DUMB_CORE_ON)
+    model_table[DUMB_MODEL].cycle_func();
+
+  if (DEBUG_MODEL && DEBUG_RANGE_COND(0) && ENABLE_GLOBAL_DEBUG_PRINT)
+    model->debug_func();
+
+  /* Avoid confusing any old global mechanisms (like check
+     forward progress) by using only core 0 cycles */
+  cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[0]);
+}
+
 /**************************************************************************************/
 /* full_sim: This is the main loop for running in full simulation mode.*/
 
 void full_sim() {
-  uns8 proc_id;
-  Flag all_sim_done = FALSE;
-  Flag any_sim_done = FALSE;
+  full_sim_begin();
+  full_sim_run(0);
+  full_sim_end();
+}
+
+/* full_sim_begin: initializes the models and runs the warmup */
+void full_sim_begin(void) {
+  /* the bp_only and dataflow models have no pipeline, memory system, prefetchers or bogus
+     runs; the interval and mem_replay models only have the memory system */
+  full_sim_uarch_model = SIM_MODEL != BP_ONLY_MODEL && SIM_MODEL != DATAFLOW_MODEL && SIM_MODEL != INTERVAL_MODEL &&
+                         SIM_MODEL != MEM_REPLAY_MODEL;
+  full_sim_uncore_model = SIM_MODEL != BP_ONLY_MODEL && SIM_MODEL != DATAFLOW_MODEL;
+  full_sim_all_done = FALSE;
+  full_sim_any_done = FALSE;
 
   /* perform initialization  */
   init_model(WARMUP_MODE);  // make sure this happens before init_op_pool
+  ASSERTM(0, WARMUP || (!SAVE_WARM_STATE && !LOAD_WARM_STATE), "SAVE_WARM_STATE and LOAD_WARM_STATE need a WARMUP\n");
+  ASSERTM(0, !PARALLEL_WARMUP || WARMUP_FAST_PATH, "PARALLEL_WARMUP needs WARMUP_FAST_PATH\n");
+  ASSERTM(0, !FRONTEND_WARMUP || (SIM_MODEL == CMP_MODEL && !WARMUP_FAST_PATH),
+          "FRONTEND_WARMUP needs the cmp model and the op warmup (no WARMUP_FAST_PATH)\n");
+  ASSERTM(0, !ADAPTIVE_WARMUP_INTERVAL || (WARMUP && SIM_MODEL == CMP_MODEL),
+          "ADAPTIVE_WARMUP_INTERVAL needs a WARMUP limit and the cmp model\n");
+  ASSERTM(0, !ADAPTIVE_WARMUP_INTERVAL || (!SAVE_WARM_STATE && !LOAD_WARM_STATE),
+          "Warm state files assume WARMUP instructions, not an ADAPTIVE_WARMUP_INTERVAL warmup\n");
+  ASSERTM(0, !FORK_SWEEP || (WARMUP && SIM_MODEL == CMP_MODEL), "FORK_SWEEP needs a WARMUP and the cmp model\n");
 
   if (WARMUP) {
     operating_mode = WARMUP_MODE;
-    uop_sim();
+    if (WARMUP_FAST_PATH && !DUMP_TRACE)
+      uop_sim_warmup_fast();
+    else
+      uop_sim();
+    if (ADAPTIVE_WARMUP_INTERVAL)
+      adaptive_warmup_end();
+    if (LOAD_WARM_STATE)
+      warm_state_load(LOAD_WARM_STATE);
+    if (SAVE_WARM_STATE)
+      warm_state_save(SAVE_WARM_STATE);
     reset_uop_mode_counters();
     reset_stats(FALSE);  // ignore stats accumulated during warmup
     /* The call below resets the cycle counts of all frequency
@@ -649,6 +1277,8 @@ void full_sim() {
          code is not memory-aware and assumes that the first
          simulation cycle is cycle zero). */
     freq_reset_cycle_counts();
+    if (FORK_SWEEP)
+      fork_sweep();
   }
 
   operating_mode = SIMULATION_MODE;
@@ -658,41 +1288,82 @@ void full_sim() {
     pipeview_init();
   if (MEMVIEW)
     memview_init();
+  if (HOST_PROF)
+    host_prof_init();
+  if (PC_PROF)
+    pc_prof_init();
+  if (SET_PROF_CACHES || SET_PROF_DRAM)
+    set_prof_init();
+  if (STATE_HASH_INTERVAL)
+    state_hash_init();
+  if (PHASE_INTERVAL)
+    online_phase_init();
+  if (REGION_CHAIN)
+    region_chain_init();
+  live_stats_init();
+  host_placement_pin_main();
 
   init_op_pool();
+  table_alloc_report(mystdout);
   unique_count = 1;
 
   sim_limit = trigger_create("SIM_LIMIT", SIM_LIMIT, TRIGGER_ONCE);
   clear_stats = trigger_create("CLEAR_STATS", CLEAR_STATS, TRIGGER_ONCE);
+  dump_stats_trigger = trigger_create("DUMP_STATS_TRIGGER", DUMP_STATS_TRIGGER, TRIGGER_REPEAT);
+  trigger_set_init(&sim_triggers);
+  trigger_set_add(&sim_triggers, sim_limit, sim_limit_action);
+  trigger_set_add(&sim_triggers, clear_stats, clear_stats_action);
+  trigger_set_add(&sim_triggers, dump_stats_trigger, dump_stats_action);
+  sim_limit_reached = FALSE;
+  if (CONVERGE_REL_ERROR)
+    converge_init();
+
+  trigger_set_poll(&sim_triggers, sim_time);
+}
 
-  /* main loop */
-  while (!trigger_fired(sim_limit)) {
-    // sim control
-    if ((EXIT_COND == LAST_DONE && all_sim_done) || (EXIT_COND == FIRST_DONE && any_sim_done))
-      break;
-    freq_advance_time();
-    sim_time = freq_time();
-    model->cycle_func();
-    if (SIM_MODEL != DUMB_MODEL && DUMB_CORE_ON)
-      model_table[DUMB_MODEL].cycle_func();
+/* full_sim_run: runs the main loop until the simulation ends or, with a nonzero
+   num_insts, until every core still running has retired num_insts more
+   instructions. Returns FALSE once the simulation has ended. */
+Flag full_sim_run(Counter num_insts) {
+  Flag uarch_model = full_sim_uarch_model;
+  Counter stop_inst[MAX_NUM_PROCS];
+  uns proc_id;
 
-    if (DEBUG_MODEL && DEBUG_RANGE_COND(0) && ENABLE_GLOBAL_DEBUG_PRINT)
-      model->debug_func();
+  for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    stop_inst[proc_id] = inst_count[proc_id] + num_insts;
 
-    /* Avoid confusing any old global mechanisms (like check
-       forward progress) by using only core 0 cycles */
-    cycle_count = freq_cycle_count(FREQ_DOMAIN_CORES[0]);
+  /* main loop */
+  while (!sim_limit_reached) {
+    // sim control
+    if ((EXIT_COND == LAST_DONE && full_sim_all_done) || (EXIT_COND == FIRST_DONE && full_sim_any_done))
+      return FALSE;
+    full_sim_cycle();
 
     // check_dump_stats();  This is not being used in general
     check_heartbeat(0, FALSE);
 
-    stat_trace_cycle();
-    if (trigger_fired(clear_stats)) {
-      reset_stats(TRUE);
+    if (SAMPLE_PERIOD)
+      sample_cycle(0);
+    if (PHASE_INTERVAL)
+      online_phase_cycle(0);
+    if (REGION_CHAIN)
+      region_chain_cycle(0);
+    if (TRACE_SCHED_PROGRAMS) {
+      for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
+        trace_sched_cycle(proc_id);
     }
 
-    all_sim_done = TRUE;
-    any_sim_done = FALSE;
+    stat_trace_cycle();
+    if (LIVE_STATS)
+      live_stats_cycle();
+    if (SET_PROF_CACHES || SET_PROF_DRAM)
+      set_prof_cycle();
+    if (STATE_HASH_INTERVAL)
+      state_hash_cycle();
+    trigger_set_poll(&sim_triggers, sim_time);
+
+    full_sim_all_done = TRUE;
+    full_sim_any_done = FALSE;
     for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
       Flag reachedInstLimit = (INST_LIMIT && (USE_FETCHED_COUNT ? inst_count_fetched[proc_id] >= inst_limit[proc_id]
                                                                 : inst_count[proc_id] >= inst_limit[proc_id]));
@@ -701,32 +1372,35 @@ void full_sim() {
       if (!sim_done[proc_id] && (retired_exit[proc_id] || reachedInstLimit)) {
         if (model->per_core_done_func)
           model->per_core_done_func(proc_id);
-        if (CONFIDENCE_ENABLE) {
+        if (uarch_model && CONFIDENCE_ENABLE) {
           decoupled_fe_print_conf_data();
         }
-        if (FDIP_ENABLE) {
+        if (uarch_model && FDIP_ENABLE) {
           if (FDIP_PRINT_CL_INFO)
             print_cl_info(proc_id);
           INC_STAT_EVENT(proc_id, FDIP_AVG_FTQ_OCCUPANCY_OPS, get_fdip_ftq_occupancy_ops(proc_id));
           INC_STAT_EVENT(proc_id, FDIP_AVG_FTQ_OCCUPANCY, get_fdip_ftq_occupancy(proc_id));
         }
-        if (EIP_ENABLE) {
+        if (uarch_model && EIP_ENABLE) {
           print_eip_stats(proc_id);
         }
         if (PERIODIC_DUMP == FALSE) {
           dump_stats(proc_id, TRUE, global_stat_array[proc_id], NUM_GLOBAL_STATS);
         }
         sim_done[proc_id] = TRUE;
-        any_sim_done = TRUE;
+        full_sim_any_done = TRUE;
         check_heartbeat(proc_id, TRUE);
 
-        if (retired_exit[proc_id] && FRONTEND == FE_TRACE) {
+        if (uarch_model && retired_exit[proc_id] && FRONTEND == FE_TRACE) {
           set_last_sim_param(proc_id);
-          // rerun the corresponding benchmark again.
+          // rerun the corresponding benchmark again, or replay its memory requests.
           // (reset retired_exit and reached_exit)
-          cmp_init_bogus_sim(proc_id);
+          if (BOGUS_REPLAY && SIM_MODEL == CMP_MODEL)
+            cmp_init_bogus_replay(proc_id);
+          else
+            cmp_init_bogus_sim(proc_id);
         }
-      } else if (sim_done[proc_id] && retired_exit[proc_id]) {
+      } else if (uarch_model && sim_done[proc_id] && retired_exit[proc_id]) {
         ASSERTM(proc_id, FRONTEND == FE_TRACE, "Unhandled case: benchmark finished in execution-driven mode\n");
         // rerun the corresponding benchmark again.
         if (FRONTEND == FE_TRACE) {
@@ -736,15 +1410,49 @@ void full_sim() {
         }
       }
 
-      all_sim_done &= sim_done[proc_id];
+      full_sim_all_done &= sim_done[proc_id];
     }
 
     if (cycle_count % FORWARD_PROGRESS_INTERVAL == 0) {  // for simulator performance check every 10000000 cycles.
       for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-        check_forward_progress(proc_id);
+        if ((uarch_model || !retired_exit[proc_id]) && !(BOGUS_REPLAY && bogus_replay_active(proc_id)))
+          check_forward_progress(proc_id);
       }
     }
+
+    if (num_insts) {
+      Flag reached = TRUE;
+      for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
+        reached &= sim_done[proc_id] || inst_count[proc_id] >= stop_inst[proc_id];
+      if (reached)
+        return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/* full_sim_drain: stops fetch and runs the cmp model until no core has an op or a
+   memory request in flight, so its caches and predictors can be saved or replaced */
+void full_sim_drain(void) {
+  uns proc_id;
+  ASSERTM(0, SIM_MODEL == CMP_MODEL, "Only the cmp model can be drained\n");
+
+  for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    decoupled_fe_stall_on_path(proc_id, TRUE);
+  for (Flag drained = FALSE; !drained;) {
+    full_sim_cycle();
+    drained = TRUE;
+    for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
+      drained &= cmp_is_core_drained(proc_id) && mem_get_req_count(proc_id) == 0;
   }
+  for (proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    decoupled_fe_stall_on_path(proc_id, FALSE);
+}
+
+/* full_sim_end: finishes the models and dumps the final stats */
+void full_sim_end(void) {
+  uns proc_id;
+
 
   if (model->done_func)
     model->done_func();
@@ -752,12 +1460,16 @@ void full_sim() {
     model_table[DUMB_MODEL].done_func();
 
   stat_trace_done();
+  retire_stream_done();
+  live_stats_done();
   if (PIPEVIEW)
     pipeview_done();
   memview_done();
   power_intf_done();
-  frontend_done(retired_exit);
-  ramulator_finish();
+  if (SIM_MODEL != MEM_REPLAY_MODEL)
+    frontend_done(retired_exit);
+  if (full_sim_uncore_model)
+    ramulator_finish();
 
   for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
     if (!sim_done[proc_id]) {
@@ -768,10 +1480,30 @@ void full_sim() {
     }
   }
 
+  if (SAMPLE_PERIOD)
+    sample_report();
+  if (REGION_CHAIN)
+    region_chain_report();
+  if (FIDELITY)
+    fidelity_report();
+  if (PHASE_INTERVAL)
+    online_phase_done();
+  if (HOST_PROF)
+    host_prof_done();
+  if (PC_PROF)
+    pc_prof_done();
+  if (SET_PROF_CACHES || SET_PROF_DRAM)
+    set_prof_done();
+  if (STATE_HASH_INTERVAL)
+    state_hash_done();
+  host_placement_done();
+  bp_shadow_done();
+
   // fdip_print_hash_tables();
 
   trigger_free(sim_limit);
   trigger_free(clear_stats);
+  trigger_free(dump_stats_trigger);
 }
 
 /**************************************************************************************/
@@ -780,4 +1512,9 @@ void full_sim() {
 void extract_basic_block_vectors() {
   frontend_extract_basic_block_vectors();
 }
+
+/* trace_sct: Runs through the trace once and writes it as a pre-decoded .sct trace.*/
+void write_sct_trace() {
+  frontend_write_sct_trace();
+}
 #endif
\ No newline at end of file
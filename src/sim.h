@@ -40,6 +40,7 @@ enum sim_mode_enum {
 #ifdef ENABLE_PT_MEMTRACE
   TRACE_BBV_MODE,
   TRACE_BBV_DISTRIBUTED_MODE,
+  TRACE_SCT_MODE,
 #endif
   NUM_SIM_MODES
 };
@@ -69,11 +70,17 @@ void uop_sim(void);
 void monitor_sim(void);
 void sampling_sim(void);
 void full_sim(void);
+void full_sim_begin(void);
+Flag full_sim_run(Counter);
+void full_sim_drain(void);
+void full_sim_end(void);
+void sim_functional_warm(uns proc_id, Counter num_insts);
 void handle_SIGINT(int);
 void close_output_streams(void);
 
 #ifdef ENABLE_PT_MEMTRACE
 void extract_basic_block_vectors(void);
+void write_sct_trace(void);
 #endif
 
 /**************************************************************************************/
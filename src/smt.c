@@ -0,0 +1,143 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : smt.c
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Simultaneous multithreading (SMT_THREADS): groups of cores run as the
+ *                hardware threads of one core, sharing its ROB and fetching by ICOUNT,
+ *                after Tullsen et al., "Exploiting Choice", ISCA 1996.
+ ***************************************************************************************/
+
+#include "smt.h"
+
+#include <stdlib.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+
+#include "cmp_model.h"
+#include "statistics.h"
+
+/*
+ * Cores g * SMT_THREADS .. (g + 1) * SMT_THREADS - 1 are the threads of SMT core g.
+ * Each thread is a full Scarab core, so its frontend, rename map and branch recovery
+ * are its own, and only the resources below are shared:
+ *   ROB    the node tables of the threads hold NODE_TABLE_SIZE ops between them, or
+ *          NODE_TABLE_SIZE / SMT_THREADS each with SMT_ROB_PARTITION
+ *   fetch  every cycle the SMT_FETCH_THREADS threads with the fewest ops fetched but
+ *          not yet in the ROB (the ICOUNT) fetch, ties going round-robin
+ * The grants are made once per cycle in smt_cycle, before any thread runs, so they do
+ * not depend on the order the threads are simulated in.
+ */
+
+static uns* smt_icount;        /* per thread: ops fetched and not yet in the ROB */
+static Flag* smt_fetch_grant;  /* per thread: may fetch this cycle */
+static uns smt_rotation;
+
+/**************************************************************************************/
+/* smt_init: */
+
+void smt_init(void) {
+  ASSERTM(0, SMT_THREADS > 0 && NUM_CORES % SMT_THREADS == 0, "NUM_CORES (%d) must be a multiple of SMT_THREADS (%d)\n",
+          NUM_CORES, SMT_THREADS);
+  ASSERTM(0, SMT_FETCH_THREADS > 0, "SMT_FETCH_THREADS must be at least 1\n");
+  ASSERTM(0, !SMT_ROB_PARTITION || NODE_TABLE_SIZE >= SMT_THREADS, "NODE_TABLE_SIZE is too small to partition\n");
+  /* the threads read each other's state, so they have to run in lockstep */
+  ASSERTM(0, !(PARALLEL_CORES && PARALLEL_SLACK), "SMT_THREADS does not work with PARALLEL_SLACK\n");
+  ASSERTM(0, !SKIP_STALLED_CYCLES, "SMT_THREADS does not work with SKIP_STALLED_CYCLES\n");
+
+  smt_icount = (uns*)calloc(NUM_CORES, sizeof(uns));
+  smt_fetch_grant = (Flag*)calloc(NUM_CORES, sizeof(Flag));
+  smt_rotation = 0;
+}
+
+/**************************************************************************************/
+/* smt_cycle: grants fetch to the SMT_FETCH_THREADS threads of each core with the lowest
+   ICOUNT */
+
+void smt_cycle(void) {
+  for (uns first = 0; first < NUM_CORES; first += SMT_THREADS) {
+    for (uns ii = 0; ii < SMT_THREADS; ii++) {
+      uns proc_id = first + ii;
+      uns prio = (ii + SMT_THREADS - smt_rotation) % SMT_THREADS;
+      uns ahead = 0; /* threads that win arbitration against proc_id */
+      for (uns jj = 0; jj < SMT_THREADS; jj++) {
+        uns other_prio = (jj + SMT_THREADS - smt_rotation) % SMT_THREADS;
+        uns other_icount = smt_icount[first + jj];
+        ahead += other_icount < smt_icount[proc_id] || (other_icount == smt_icount[proc_id] && other_prio < prio);
+      }
+      smt_fetch_grant[proc_id] = ahead < SMT_FETCH_THREADS;
+    }
+  }
+  smt_rotation = (smt_rotation + 1) % SMT_THREADS;
+}
+
+/**************************************************************************************/
+/* smt_fetch_granted: */
+
+Flag smt_fetch_granted(uns proc_id) {
+  if (!smt_fetch_grant[proc_id]) {
+    STAT_EVENT(proc_id, SMT_FETCH_DENIED_CYCLES);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* smt_rob_full: TRUE if the thread may not put another op into the ROB */
+
+Flag smt_rob_full(uns proc_id) {
+  if (SMT_ROB_PARTITION)
+    return cmp_model.node_stage[proc_id].node_count >= NODE_TABLE_SIZE / SMT_THREADS;
+
+  uns first = proc_id - proc_id % SMT_THREADS;
+  uns rob_ops = 0;
+  for (uns ii = first; ii < first + SMT_THREADS; ii++)
+    rob_ops += cmp_model.node_stage[ii].node_count;
+  return rob_ops >= NODE_TABLE_SIZE;
+}
+
+/**************************************************************************************/
+/* smt_op_fetched: counts op in the ICOUNT of its thread */
+
+void smt_op_fetched(Op* op) {
+  ASSERT(op->proc_id, !op->in_smt_icount);
+  op->in_smt_icount = TRUE;
+  smt_icount[op->proc_id]++;
+}
+
+/**************************************************************************************/
+/* smt_op_left_frontend: the op went into the ROB or was flushed before it got there */
+
+void smt_op_left_frontend(Op* op) {
+  if (!op->in_smt_icount)
+    return;
+  op->in_smt_icount = FALSE;
+  ASSERT(op->proc_id, smt_icount[op->proc_id] > 0);
+  smt_icount[op->proc_id]--;
+}
@@ -0,0 +1,45 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : smt.h
+ * Author       : HPS Research Group
+ * Date         : 10/15/2026
+ * Description  : Simultaneous multithreading (SMT_THREADS): groups of cores run as the
+ *                hardware threads of one core, sharing its ROB and fetching by ICOUNT,
+ *                after Tullsen et al., "Exploiting Choice", ISCA 1996.
+ ***************************************************************************************/
+
+#ifndef __SMT_H__
+#define __SMT_H__
+
+#include "globals/global_types.h"
+
+#include "op.h"
+
+void smt_init(void);
+void smt_cycle(void);
+Flag smt_fetch_granted(uns proc_id);
+Flag smt_rob_full(uns proc_id);
+void smt_op_fetched(Op* op);
+void smt_op_left_frontend(Op* op);
+
+#endif /* #ifndef __SMT_H__ */
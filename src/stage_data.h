@@ -57,6 +57,11 @@ typedef enum Rob_Stall_Reason_enum {
   ROB_STALL_WAIT_FOR_DC_MISS = 7,
 } Rob_Stall_Reason;
 
+/* Most stages keep their ops in a dense prefix (ops[0..op_count-1]). The stages
+   whose slots are indexed by functional unit (node, exec, dcache) or that are
+   drained by two consumers (icache by decode and the uop queue) leave holes;
+   scans that only look for ops stop once they visited op_count of them, so an
+   empty stage costs nothing. */
 typedef struct Stage_Data_struct {
   char* name;       /* name of the stage */
   int op_count;     /* number of ops in the stage */
@@ -101,7 +101,7 @@ Counter stat_mon_get_count(Stat_Mon* mon, uns proc_id, uns stat_idx) {
   Stat* stat = &global_stat_array[proc_id][stat_idx];
   ASSERT(proc_id, stat->type != FLOAT_TYPE_STAT);
   Stat_Info* info = find_stat_info(mon, stat_idx);
-  return stat->count + stat->total_count - info->last_data[proc_id].count;
+  return stat->current->count + stat->total_count - info->last_data[proc_id].count;
 }
 
 /**************************************************************************************/
@@ -113,7 +113,7 @@ double stat_mon_get_value(Stat_Mon* mon, uns proc_id, uns stat_idx) {
   Stat* stat = &global_stat_array[proc_id][stat_idx];
   ASSERT(proc_id, stat->type == FLOAT_TYPE_STAT);
   Stat_Info* info = find_stat_info(mon, stat_idx);
-  return stat->value + stat->total_value - info->last_data[proc_id].value;
+  return stat->current->value + stat->total_value - info->last_data[proc_id].value;
 }
 
 /**************************************************************************************/
@@ -130,9 +130,9 @@ void stat_mon_reset(Stat_Mon* mon) {
     for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
       Stat* stat = &global_stat_array[proc_id][info->stat_idx];
       if (stat->type == FLOAT_TYPE_STAT) {
-        info->last_data[proc_id].value = stat->value + stat->total_value;
+        info->last_data[proc_id].value = stat->current->value + stat->total_value;
       } else {
-        info->last_data[proc_id].count = stat->count + stat->total_count;
+        info->last_data[proc_id].count = stat->current->count + stat->total_count;
       }
     }
   }
@@ -169,6 +169,8 @@ static Stat_Info* find_stat_info(Stat_Mon* mon, uns stat_idx) {
 static void init_stat_info(Stat_Info* info, uns stat_idx) {
   ASSERT(0, stat_idx < NUM_GLOBAL_STATS);
   Stat* stat = &global_stat_array[0][stat_idx];
+  ASSERTM(0, stat_is_on(stat_idx), "Stat %s is monitored, but its stat group %s is off\n", stat->name,
+          stat_group_name(stat_idx));
   if (stat->noreset)
     WARNINGU_ONCE(0, "NORESET stats are treated as resettable by stat_mon\n");
   info->stat_idx = stat_idx;
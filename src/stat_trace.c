@@ -26,18 +26,51 @@
  * Description  : Statistic trace
  ***************************************************************************************/
 
+/* STATS_TO_TRACE is a list of stat names and globs over stat names ("DCACHE_*",
+   "L1_*_MISS"), separated by spaces or commas. A token starting with '-' removes the
+   stats it matches from the ones selected so far, e.g. "DCACHE_* -DCACHE_*_OFFPATH".
+   Globs skip LINE stats and stats whose group is off.
+
+   The text trace has one line per interval with the instruction count of core 0 and
+   the interval count of every stat on every core. With STAT_TRACE_BINARY the same
+   intervals go to <file_tag><stat_trace_file>.bin instead, delta and varint encoded,
+   and a background thread writes them out (see bin/scarab_stattrace.py).
+
+   Binary file format (native endianness):
+   header: char magic[8] "SCARSTR", uns32 version, uns32 num_cores, uns32 num_stats
+   per stat: uns32 type, uns32 name_len, name
+   per interval: varint instruction delta of core 0, varint cycle delta, then for every
+                 stat and core, the zigzag varint of (interval count - previous interval
+                 count); FLOAT stats store the varint of (bits of value ^ previous bits) */
+
 #include "stat_trace.h"
 
+#include <fnmatch.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 #include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
 
 #include "core.param.h"
+#include "general.param.h"
 
 #include "stat_mon.h"
 #include "statistics.h"
 #include "trigger.h"
 
+/**************************************************************************************/
+/* Macros */
+
+#define STAT_TRACE_BIN_MAGIC "SCARSTR"
+#define STAT_TRACE_BIN_VERSION 1
+#define VARINT_MAX_BYTES 10
+
 /**************************************************************************************/
 /* Types */
 
@@ -60,10 +93,29 @@ static Trigger* interval_trigger = NULL;
 static FILE* file;
 const char* DELIMITERS = " ,";
 
+/* binary trace */
+static uns8* ring;     /* encoded intervals waiting for the flush thread */
+static uns64 ring_head; /* written by the simulation thread */
+static uns64 ring_tail; /* written by the flush thread */
+static uns8* record;   /* the interval being encoded */
+static uns64* last_data; /* previous interval of every stat and core */
+static Counter last_inst_count;
+static Counter last_cycle_count;
+static pthread_t flush_thread;
+static pthread_mutex_t flush_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static Flag flush_stop = FALSE;
+static Flag flush_running = FALSE;
+
 /**************************************************************************************/
 /* Local Prototypes */
 
+static uns parse_stats_to_trace(void);
 static void trace_stats(void);
+static void trace_stats_binary(void);
+static void* flush_loop(void*);
+static void flush_ring(void);
+static void stat_trace_exit(void);
 
 /**************************************************************************************/
 /* stat_trace_init: */
@@ -72,32 +124,45 @@ void stat_trace_init(void) {
   if (!STATS_TO_TRACE)
     return;
 
+  /* parse the stats to trace */
+  num_stats = parse_stats_to_trace();
+  ASSERTM(0, num_stats > 0, "STATS_TO_TRACE '%s' selects no stats\n", STATS_TO_TRACE);
+
   /* open the trace file */
-  char stats_trace_file[100];
-  sprintf(stats_trace_file, "%s%s", FILE_TAG, STAT_TRACE_FILE);
-  file = fopen(stats_trace_file, "w");
-  ASSERTM(0, file, "Could not open %s", STAT_TRACE_FILE);
+  char stats_trace_file[MAX_STR_LENGTH + 1];
+  snprintf(stats_trace_file, MAX_STR_LENGTH, "%s%s%s", FILE_TAG, STAT_TRACE_FILE, STAT_TRACE_BINARY ? ".bin" : "");
+  file = fopen(stats_trace_file, STAT_TRACE_BINARY ? "wb" : "w");
+  ASSERTM(0, file, "Could not open %s", stats_trace_file);
 
-  /* parse the stats to trace */
-  num_stats = num_tokens(STATS_TO_TRACE, DELIMITERS);
-  stat_indices = malloc(num_stats * sizeof(Stat_Enum));
-  char* stats_str = strdup(STATS_TO_TRACE);
-  char* stat_name = strtok(stats_str, DELIMITERS);
-  uns ii = 0;
-  fprintf(file, "Instructions");
-  while (stat_name) {
-    Stat_Enum stat_idx = get_stat_idx(stat_name);
-    ASSERTM(0, stat_idx < NUM_GLOBAL_STATS, "Stat %s not found\n", stat_name);
-    stat_indices[ii] = stat_idx;
-    ii++;
-    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) {
-      fprintf(file, "\t%s[%d]", stat_name, proc_id);
+  if (STAT_TRACE_BINARY) {
+    ASSERTM(0, STAT_TRACE_RING_SIZE && !(STAT_TRACE_RING_SIZE & (STAT_TRACE_RING_SIZE - 1)),
+            "STAT_TRACE_RING_SIZE must be a power of 2\n");
+    uns record_size = (2 + num_stats * NUM_CORES) * VARINT_MAX_BYTES;
+    ASSERTM(0, record_size <= STAT_TRACE_RING_SIZE, "STAT_TRACE_RING_SIZE must fit an interval (%u bytes)\n",
+            record_size);
+    uns32 header[3] = {STAT_TRACE_BIN_VERSION, NUM_CORES, num_stats};
+    fwrite(STAT_TRACE_BIN_MAGIC, 1, 8, file);
+    fwrite(header, sizeof(header), 1, file);
+    for (uns ii = 0; ii < num_stats; ii++) {
+      const Stat* stat = &global_stat_array[0][stat_indices[ii]];
+      uns32 desc[2] = {stat->type, strlen(stat->name)};
+      fwrite(desc, sizeof(desc), 1, file);
+      fwrite(stat->name, 1, desc[1], file);
     }
-    stat_name = strtok(NULL, DELIMITERS);
+    ring = (uns8*)malloc(STAT_TRACE_RING_SIZE);
+    record = (uns8*)malloc(record_size);
+    last_data = (uns64*)calloc(num_stats * NUM_CORES, sizeof(uns64));
+    flush_running = !pthread_create(&flush_thread, NULL, flush_loop, NULL);
+    ASSERTM(0, flush_running, "Could not start the stat trace flush thread\n");
+    /* so that the intervals leading up to an ASSERT still reach the file */
+    atexit(stat_trace_exit);
+  } else {
+    fprintf(file, "Instructions");
+    for (uns ii = 0; ii < num_stats; ii++)
+      for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+        fprintf(file, "\t%s[%d]", global_stat_array[0][stat_indices[ii]].name, proc_id);
+    fprintf(file, "\n");
   }
-  fprintf(file, "\n");
-  ASSERT(0, ii == num_stats);
-  free(stats_str);
 
   stat_mon = stat_mon_create_from_array(stat_indices, num_stats);
 
@@ -107,6 +172,47 @@ void stat_trace_init(void) {
   interval_trigger = trigger_create("STAT_TRACE_INTERVAL", STAT_TRACE_INTERVAL, TRIGGER_REPEAT);
 }
 
+/**************************************************************************************/
+/* parse_stats_to_trace: fills stat_indices from STATS_TO_TRACE and returns the
+   number of stats selected */
+
+static uns parse_stats_to_trace(void) {
+  Flag* selected = (Flag*)calloc(NUM_GLOBAL_STATS, sizeof(Flag));
+  uns num_selected = 0;
+  stat_indices = malloc(NUM_GLOBAL_STATS * sizeof(Stat_Enum));
+
+  char* stats_str = strdup(STATS_TO_TRACE);
+  for (char* token = strtok(stats_str, DELIMITERS); token; token = strtok(NULL, DELIMITERS)) {
+    Flag exclude = token[0] == '-';
+    const char* pattern = exclude ? token + 1 : token;
+    if (!strpbrk(pattern, "*?[")) {
+      Stat_Enum stat_idx = get_stat_idx(pattern);
+      ASSERTM(0, stat_idx < NUM_GLOBAL_STATS, "Stat %s not found\n", pattern);
+      if (!exclude && !selected[stat_idx])
+        stat_indices[num_selected++] = stat_idx;
+      selected[stat_idx] = !exclude;
+      continue;
+    }
+    for (uns stat_idx = 0; stat_idx < NUM_GLOBAL_STATS; stat_idx++) {
+      const Stat* stat = &global_stat_array[0][stat_idx];
+      if (stat->type == LINE_TYPE_STAT || !stat_is_on(stat_idx) || fnmatch(pattern, stat->name, 0) != 0)
+        continue;
+      if (!exclude && !selected[stat_idx])
+        stat_indices[num_selected++] = stat_idx;
+      selected[stat_idx] = !exclude;
+    }
+  }
+  free(stats_str);
+
+  /* drop the stats excluded after they were selected */
+  uns num_kept = 0;
+  for (uns ii = 0; ii < num_selected; ii++)
+    if (selected[stat_indices[ii]])
+      stat_indices[num_kept++] = stat_indices[ii];
+  free(selected);
+  return num_kept;
+}
+
 /**************************************************************************************/
 /* stat_trace_cycle: */
 
@@ -129,7 +235,10 @@ void stat_trace_done(void) {
   /* trace the final stat values */
   trace_stats();
 
-  fclose(file);
+  if (STAT_TRACE_BINARY)
+    stat_trace_exit();
+  else
+    fclose(file);
   file = NULL;
 
   stat_mon_free(stat_mon);
@@ -155,6 +264,13 @@ uns num_tokens(const char* str, const char* delim) {
 /* trace_stats: */
 
 static void trace_stats(void) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    stat_integrator_flush(proc_id);
+  if (STAT_TRACE_BINARY) {
+    trace_stats_binary();
+    stat_mon_reset(stat_mon);
+    return;
+  }
   fprintf(file, "%lld", inst_count[0]);
   for (uns ii = 0; ii < num_stats; ++ii) {
     for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id) {
@@ -170,3 +286,123 @@ static void trace_stats(void) {
   fprintf(file, "\n");
   stat_mon_reset(stat_mon);
 }
+
+/**************************************************************************************/
+/* put_varint: LEB128, 7 bits per byte, low bits first */
+
+static inline uns8* put_varint(uns8* p, uns64 x) {
+  while (x >= 0x80) {
+    *p++ = (uns8)(x | 0x80);
+    x >>= 7;
+  }
+  *p++ = (uns8)x;
+  return p;
+}
+
+/**************************************************************************************/
+/* zigzag: maps small negative and positive deltas to small varints */
+
+static inline uns64 zigzag(int64 x) {
+  return ((uns64)x << 1) ^ (uns64)(x >> 63);
+}
+
+/**************************************************************************************/
+/* trace_stats_binary: encode the interval and copy it into the ring. Unlike pipeview
+   the record is never dropped (the deltas would not decode past it), so the
+   simulation waits for the flush thread if the ring is full. */
+
+static void trace_stats_binary(void) {
+  uns8* p = record;
+  p = put_varint(p, inst_count[0] - last_inst_count);
+  p = put_varint(p, cycle_count - last_cycle_count);
+  last_inst_count = inst_count[0];
+  last_cycle_count = cycle_count;
+
+  uns64* last = last_data;
+  for (uns ii = 0; ii < num_stats; ++ii) {
+    Stat_Enum stat_idx = stat_indices[ii];
+    Flag is_float = global_stat_array[0][stat_idx].type == FLOAT_TYPE_STAT;
+    for (uns proc_id = 0; proc_id < NUM_CORES; ++proc_id, ++last) {
+      uns64 data;
+      if (is_float) {
+        double value = stat_mon_get_value(stat_mon, proc_id, stat_idx);
+        memcpy(&data, &value, sizeof(data));
+        p = put_varint(p, data ^ *last);
+      } else {
+        data = stat_mon_get_count(stat_mon, proc_id, stat_idx);
+        p = put_varint(p, zigzag((int64)(data - *last)));
+      }
+      *last = data;
+    }
+  }
+
+  uns64 len = p - record;
+  while (STAT_TRACE_RING_SIZE - (ring_head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE)) < len) {
+    pthread_cond_signal(&flush_cond);
+    sched_yield();
+  }
+  uns64 pos = ring_head & (STAT_TRACE_RING_SIZE - 1);
+  uns64 first = MIN2(len, STAT_TRACE_RING_SIZE - pos);
+  memcpy(&ring[pos], record, first);
+  memcpy(ring, record + first, len - first);
+  __atomic_store_n(&ring_head, ring_head + len, __ATOMIC_RELEASE);
+  if (ring_head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) >= STAT_TRACE_RING_SIZE / 2)
+    pthread_cond_signal(&flush_cond);
+}
+
+/**************************************************************************************/
+/* flush_ring: write the bytes between tail and head (flush thread only) */
+
+static void flush_ring(void) {
+  uns64 head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+  uns64 tail = ring_tail;
+  while (tail != head) {
+    uns64 pos = tail & (STAT_TRACE_RING_SIZE - 1);
+    uns64 count = MIN2(head - tail, STAT_TRACE_RING_SIZE - pos);
+    fwrite(&ring[pos], 1, count, file);
+    tail += count;
+    __atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE);
+  }
+}
+
+/**************************************************************************************/
+/* flush_loop: */
+
+static void* flush_loop(void* arg) {
+  UNUSED(arg);
+  pthread_mutex_lock(&flush_lock);
+  while (TRUE) {
+    Flag stop = flush_stop;
+    pthread_mutex_unlock(&flush_lock);
+    flush_ring();
+    pthread_mutex_lock(&flush_lock);
+    if (stop)
+      break;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 10 * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    if (!flush_stop)
+      pthread_cond_timedwait(&flush_cond, &flush_lock, &deadline);
+  }
+  pthread_mutex_unlock(&flush_lock);
+  return NULL;
+}
+
+/**************************************************************************************/
+/* stat_trace_exit: stop the flush thread after it drained the ring */
+
+static void stat_trace_exit(void) {
+  if (!flush_running)
+    return;
+  pthread_mutex_lock(&flush_lock);
+  flush_stop = TRUE;
+  pthread_cond_signal(&flush_cond);
+  pthread_mutex_unlock(&flush_lock);
+  pthread_join(flush_thread, NULL);
+  flush_running = FALSE;
+  fclose(file);
+}
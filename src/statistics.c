@@ -41,20 +41,75 @@ working on this (ob).
 #include "core.param.h"
 #include "general.param.h"
 
+#include "debug/sim_probe.h"
+
+#include "crit_path.h"
+#include "frontend/trace_io.h"
+#include "memory/mem_req.h"
 #include "optimizer2.h"
+#include "topdown.h"
 
 /**************************************************************************************/
 /* Global Variables */
 
-#define DEF_STAT(name, type, ratio) {type##_TYPE_STAT, #name, {0}, {0}, ratio, __FILE__, FALSE},
+#define DEF_STAT(name, type, ratio) {type##_TYPE_STAT, #name, NULL, {0}, ratio, __FILE__, FALSE},
+#define DEF_STAT_GROUP(name, production)
 
 Stat global_stat_sample[] = {
 #include "stat_files.def"
 };
 
 #undef DEF_STAT
+#undef DEF_STAT_GROUP
+
+typedef struct Stat_Group_Info_struct {
+  const char* name;
+  Stat_Enum first;  // first stat of the group
+  Flag production;  // kept in STAT_PRODUCTION builds
+} Stat_Group_Info;
+
+#define DEF_STAT(name, type, ratio)
+#define DEF_STAT_GROUP(name, production) {#name, (Stat_Enum)STAT_GROUP_##name##_FIRST, production},
+
+static const Stat_Group_Info stat_groups[] = {
+#include "stat_files.def"
+};
+
+#undef DEF_STAT
+#undef DEF_STAT_GROUP
 
 Stat** global_stat_array;
+Stat_Value** global_stat_values;
+Flag global_stat_on[NUM_GLOBAL_STATS];
+char const* stat_file_suffix = NULL; /* appended to the stat file names when set */
+
+#define DEF_HIST(name, kind) {#name, HIST_##kind},
+
+static const struct {
+  const char* name;
+  Hist_Kind kind;
+} hist_info[] = {
+#include "memory/memory.hist.def"
+};
+
+#undef DEF_HIST
+
+static const char* const mem_queue_names[] = {"L1", "BUS_OUT", "MEM", "L1FILL", "MLC", "MLC_FILL", "CORE_FILL"};
+
+Hist** global_hists;
+uns global_hist_first[NUM_HISTS];
+static uns num_hist_instances;
+
+static Stat_Integrator* stat_integrators[MAX_NUM_PROCS];
+static Flag stat_integrators_paused = FALSE;
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static Stat_Group stat_group_of(Stat_Enum stat);
+static void init_stat_groups(void);
+static void init_latency_hists(void);
+static void dump_latency_hists(uns8 proc_id);
 
 /**************************************************************************************/
 // init_global_stats_array:
@@ -72,12 +127,98 @@ void init_global_stats_array() {
       stat->file_name = last_slash + 1;
   }
 
-  // Make a copy of stats array for each core
+  // Make a copy of stats array for each core. The interval counts of all cores
+  // live in one block, each core's row starting on its own cache line.
+  uns row_size = (NUM_GLOBAL_STATS * sizeof(Stat_Value) + 63) / 64 * 64;
+  char* values;
+  if (posix_memalign((void**)&values, 64, NUM_CORES * row_size) != 0)
+    FATAL_ERROR(0, "Could not allocate the stat counters\n");
+  memset(values, 0, NUM_CORES * row_size);
   global_stat_array = (Stat**)malloc(NUM_CORES * sizeof(Stat*));
+  global_stat_values = (Stat_Value**)malloc(NUM_CORES * sizeof(Stat_Value*));
   for (ii = 0; ii < NUM_CORES; ii++) {
     global_stat_array[ii] = (Stat*)malloc(NUM_GLOBAL_STATS * sizeof(Stat));
     memcpy(global_stat_array[ii], global_stat_sample, NUM_GLOBAL_STATS * sizeof(Stat));
+    global_stat_values[ii] = (Stat_Value*)(values + ii * row_size);
+    for (uns jj = 0; jj < NUM_GLOBAL_STATS; jj++)
+      global_stat_array[ii][jj].current = &global_stat_values[ii][jj];
+  }
+
+  init_stat_groups();
+  init_latency_hists();
+}
+
+/**************************************************************************************/
+/* hist_kind_instances: */
+
+static uns hist_kind_instances(Hist_Kind kind) {
+  switch (kind) {
+    case HIST_PER_MEM_REQ_TYPE:
+      return MRT_NUM_ELEMS;
+    case HIST_PER_MEM_QUEUE:
+      return sizeof(mem_queue_names) / sizeof(mem_queue_names[0]);
+    default:
+      return 1;
+  }
+}
+
+/**************************************************************************************/
+/* init_latency_hists: the instances of all histograms of a core are one array */
+
+static void init_latency_hists(void) {
+  num_hist_instances = 0;
+  for (uns hist = 0; hist < NUM_HISTS; hist++) {
+    global_hist_first[hist] = num_hist_instances;
+    num_hist_instances += hist_kind_instances(hist_info[hist].kind);
   }
+
+  if (!LATENCY_HISTS)
+    return;
+  global_hists = (Hist**)malloc(NUM_CORES * sizeof(Hist*));
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    global_hists[proc_id] = (Hist*)calloc(num_hist_instances, sizeof(Hist));
+}
+
+/**************************************************************************************/
+/* stat_group_of: */
+
+static Stat_Group stat_group_of(Stat_Enum stat) {
+  Stat_Group group = 0;
+  while (group + 1 < NUM_STAT_GROUPS && stat_groups[group + 1].first <= stat)
+    group++;
+  return group;
+}
+
+/**************************************************************************************/
+/* init_stat_groups: turns off the groups compiled out and the ones listed in
+   STAT_GROUPS_OFF */
+
+static void init_stat_groups(void) {
+  Flag group_on[NUM_STAT_GROUPS];
+  for (uns group = 0; group < NUM_STAT_GROUPS; group++) {
+#ifdef STAT_PRODUCTION
+    group_on[group] = stat_groups[group].production;
+#else
+    group_on[group] = TRUE;
+#endif
+  }
+
+  if (STAT_GROUPS_OFF) {
+    char names[MAX_STR_LENGTH + 1];
+    strncpy(names, STAT_GROUPS_OFF, MAX_STR_LENGTH);
+    names[MAX_STR_LENGTH] = '\0';
+    for (char* name = strtok(names, ", "); name; name = strtok(NULL, ", ")) {
+      uns group;
+      for (group = 0; group < NUM_STAT_GROUPS; group++)
+        if (!strcmp(stat_groups[group].name, name))
+          break;
+      ASSERTM(0, group < NUM_STAT_GROUPS, "Unknown stat group '%s' in STAT_GROUPS_OFF\n", name);
+      group_on[group] = FALSE;
+    }
+  }
+
+  for (uns ii = 0; ii < NUM_GLOBAL_STATS; ii++)
+    global_stat_on[ii] = group_on[stat_group_of(ii)];
 }
 
 /**************************************************************************************/
@@ -114,6 +255,8 @@ void gen_stat_output_file(char* buf, uns8 proc_id, Stat* stat, char csv) {
     sprintf(temp3, ".roi.%llu", roi_dump_ID);
     strncat(temp, temp3, 24);
   }
+  if (stat_file_suffix)
+    strncat(temp, stat_file_suffix, 24);
   strncpy(buf, OUTPUT_DIR, MAX_STR_LENGTH);
   strncat(buf, "/", MAX_STR_LENGTH);
   strncat(buf, FILE_TAG, MAX_STR_LENGTH);
@@ -145,6 +288,191 @@ void fprint_line(FILE* file) {
   fprintf(file, "##################################################\n");
 }
 
+/**************************************************************************************/
+/* Binary stats sink:
+
+   With STATS_FORMAT "binary" (or "both") each dump appends one fixed-size row
+   to <output_dir>/<file_tag>stats<proc_id>.bin instead of rewriting one .out and
+   one .csv file per stat group. The file stays open for the whole run.
+
+   Layout (native endianness, see bin/scarab_binstats.py):
+     header: char magic[8] "SCARSTAT", uns32 version, uns32 proc_id,
+             uns32 num_stats, uns32 num_row_fields
+     per stat: uns32 type, uns32 ratio_stat, uns32 name_len, name,
+               uns32 file_name_len, file_name
+     per row: uns64 fields[num_row_fields] (see Stat_Bin_Row_Field), then
+              uns64 count[num_stats], uns64 total_count[num_stats]
+   The values of FLOAT_TYPE_STAT stats are stored as the bits of a double. */
+
+#define STAT_BIN_MAGIC "SCARSTAT"
+#define STAT_BIN_VERSION 1
+
+typedef enum Stat_Bin_Row_Field_enum {
+  STAT_BIN_PERIOD_ID,
+  STAT_BIN_CYCLE_COUNT,
+  STAT_BIN_INST_COUNT,
+  STAT_BIN_PERIOD_CYCLES,
+  STAT_BIN_PERIOD_INSTS,
+  STAT_BIN_FLAGS,  // bit 0: warmup dump, bit 1: roi dump
+  STAT_BIN_ROI_ID,
+  STAT_BIN_NUM_ROW_FIELDS
+} Stat_Bin_Row_Field;
+
+static FILE** stat_bin_files = NULL;
+static uns64** stat_bin_rows = NULL;
+
+static Flag stats_format_is(const char* format) {
+  return !strcmp(STATS_FORMAT, format) || !strcmp(STATS_FORMAT, "both");
+}
+
+static void stat_bin_write_str(FILE* file, const char* str) {
+  uns32 len = strlen(str);
+  fwrite(&len, sizeof(len), 1, file);
+  fwrite(str, 1, len, file);
+}
+
+static FILE* stat_bin_open(uns8 proc_id, Stat stat_array[], uns num_stats) {
+  if (!stat_bin_files) {
+    stat_bin_files = (FILE**)calloc(NUM_CORES, sizeof(FILE*));
+    stat_bin_rows = (uns64**)calloc(NUM_CORES, sizeof(uns64*));
+  }
+  if (stat_bin_files[proc_id])
+    return stat_bin_files[proc_id];
+
+  char buf[MAX_STR_LENGTH + 1];
+  snprintf(buf, MAX_STR_LENGTH, "%s/%sstats%u.bin", OUTPUT_DIR, FILE_TAG, proc_id);
+  FILE* file = fopen(buf, "wb");
+  ASSERTUM(0, file, "Couldn't open statistic output file '%s'.\n", buf);
+
+  uns32 header[4] = {STAT_BIN_VERSION, proc_id, num_stats, STAT_BIN_NUM_ROW_FIELDS};
+  fwrite(STAT_BIN_MAGIC, 1, 8, file);
+  fwrite(header, sizeof(header), 1, file);
+  for (uns ii = 0; ii < num_stats; ii++) {
+    Stat* s = &stat_array[ii];
+    uns32 desc[2] = {s->type, s->ratio_stat};
+    fwrite(desc, sizeof(desc), 1, file);
+    stat_bin_write_str(file, s->name);
+    stat_bin_write_str(file, s->file_name);
+  }
+
+  stat_bin_rows[proc_id] = (uns64*)malloc((STAT_BIN_NUM_ROW_FIELDS + 2 * num_stats) * sizeof(uns64));
+  stat_bin_files[proc_id] = file;
+  return file;
+}
+
+static void dump_stats_binary(uns8 proc_id, Stat stat_array[], uns num_stats) {
+  FILE* file = stat_bin_open(proc_id, stat_array, num_stats);
+  uns64* row = stat_bin_rows[proc_id];
+  uns64* counts = row + STAT_BIN_NUM_ROW_FIELDS;
+  uns64* totals = counts + num_stats;
+
+  row[STAT_BIN_PERIOD_ID] = period_ID;
+  row[STAT_BIN_CYCLE_COUNT] = cycle_count;
+  row[STAT_BIN_INST_COUNT] = inst_count[proc_id];
+  row[STAT_BIN_PERIOD_CYCLES] = cycle_count - period_last_cycle_count;
+  row[STAT_BIN_PERIOD_INSTS] = inst_count[proc_id] - period_last_inst_count[proc_id];
+  row[STAT_BIN_FLAGS] = (FULL_WARMUP && !warmup_dump_done[proc_id]) | (roi_dump_began << 1);
+  row[STAT_BIN_ROI_ID] = roi_dump_ID;
+
+  for (uns ii = 0; ii < num_stats; ii++) {
+    Stat* s = &stat_array[ii];
+    Stat_Value* v = s->current;
+    if (s->type == FLOAT_TYPE_STAT) {
+      memcpy(&counts[ii], &v->value, sizeof(uns64));
+      memcpy(&totals[ii], &s->total_value, sizeof(uns64));
+    } else {
+      counts[ii] = v->count;
+      totals[ii] = s->total_count;
+    }
+  }
+
+  fwrite(row, sizeof(uns64), STAT_BIN_NUM_ROW_FIELDS + 2 * num_stats, file);
+  fflush(file);
+}
+
+/**************************************************************************************/
+/* hist_bucket_max: largest value that falls in bucket */
+
+static Counter hist_bucket_max(uns bucket) {
+  if (bucket < HIST_SUB_BUCKETS)
+    return bucket;
+  uns shift = (bucket >> HIST_SUB_BITS) - 1;
+  Counter min = (Counter)(HIST_SUB_BUCKETS + (bucket & (HIST_SUB_BUCKETS - 1))) << shift;
+  return min + (((Counter)1 << shift) - 1);
+}
+
+/**************************************************************************************/
+/* hist_percentile: smallest bucket bound that covers fraction of the values, capped by
+   the largest value seen */
+
+static Counter hist_percentile(const Hist* hist, double fraction) {
+  if (!hist->count)
+    return 0;
+  Counter rank = (Counter)ceil(fraction * hist->count);
+  Counter seen = 0;
+  for (uns bucket = 0; bucket < HIST_NUM_BUCKETS; bucket++) {
+    seen += hist->buckets[bucket];
+    if (seen >= rank)
+      return MIN2(hist_bucket_max(bucket), hist->max);
+  }
+  return hist->max;
+}
+
+/**************************************************************************************/
+/* dump_latency_hists: one line per histogram instance to latency.hist<proc_id>.out and
+   .csv. The histograms count from the last stat reset, like the Cumulative columns. */
+
+static void dump_latency_hists(uns8 proc_id) {
+  static const double fractions[] = {0.5, 0.9, 0.99, 0.999};
+  static const char* const fraction_names[] = {"p50", "p90", "p99", "p999"};
+  Stat file_stat = {.file_name = "latency.hist.def"};
+  char buf[MAX_STR_LENGTH + 2];
+  char csv_buf[MAX_STR_LENGTH + 2];
+
+  gen_stat_output_file(buf, proc_id, &file_stat, 0);
+  gen_stat_output_file(csv_buf, proc_id, &file_stat, 1);
+  FILE* file_stream = fopen(buf, "w");
+  ASSERTUM(0, file_stream, "Couldn't open statistic output file '%s'.\n", buf);
+  FILE* csv_file_stream = fopen(csv_buf, "w");
+  ASSERTUM(0, csv_file_stream, "Couldn't open statistic output file '%s'.\n", csv_buf);
+
+  fprintf(file_stream, "/* -*- Mode: c -*- */\n");
+  fprint_line(file_stream);
+  fprintf(file_stream, "Core %u  Cycles: %llu\n", proc_id, cycle_count);
+  fprint_line(file_stream);
+  fprintf(file_stream, "%-40s %13s %13s %13s %13s %13s %13s %13s\n", "", "count", "mean", "p50", "p90", "p99", "p999",
+          "max");
+
+  for (uns hist = 0; hist < NUM_HISTS; hist++) {
+    Hist_Kind kind = hist_info[hist].kind;
+    for (uns inst = 0; inst < hist_kind_instances(kind); inst++) {
+      const Hist* h = &global_hists[proc_id][global_hist_first[hist] + inst];
+      char name[MAX_STR_LENGTH + 1];
+      if (kind == HIST_PER_MEM_REQ_TYPE)
+        snprintf(name, MAX_STR_LENGTH, "%s_%s", hist_info[hist].name, Mem_Req_Type_str(inst));
+      else if (kind == HIST_PER_MEM_QUEUE)
+        snprintf(name, MAX_STR_LENGTH, "%s_%s", hist_info[hist].name, mem_queue_names[inst]);
+      else
+        snprintf(name, MAX_STR_LENGTH, "%s", hist_info[hist].name);
+
+      fprintf(file_stream, "%-40s %13s %13.2f", name, unsstr64(h->count), h->count ? (double)h->sum / h->count : 0.0);
+      fprintf(csv_file_stream, "%s_count, 0, %llu\n", name, h->count);
+      for (uns ii = 0; ii < sizeof(fractions) / sizeof(fractions[0]); ii++) {
+        Counter value = hist_percentile(h, fractions[ii]);
+        fprintf(file_stream, " %13s", unsstr64(value));
+        fprintf(csv_file_stream, "%s_%s, 0, %llu\n", name, fraction_names[ii], value);
+      }
+      fprintf(file_stream, " %13s\n", unsstr64(h->max));
+      fprintf(csv_file_stream, "%s_max, 0, %llu\n", name, h->max);
+    }
+  }
+
+  fprintf(file_stream, "\n\n");
+  fclose(file_stream);
+  fprintf(csv_file_stream, "\n\n");
+  fclose(csv_file_stream);
+}
+
 /**************************************************************************************/
 /* dump_stats: */
 
@@ -157,17 +485,36 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
 
   if (!DUMP_STATS)
     return;
+  SIM_PROBE2(dump_stats_begin, proc_id, final);
+
+  if (stat_array == global_stat_array[proc_id]) {
+    topdown_flush(proc_id);
+    crit_path_flush(proc_id);
+    stat_integrator_flush(proc_id);
+    trace_io_flush_stats(proc_id);
+    if (LATENCY_HISTS)
+      dump_latency_hists(proc_id);
+  }
+
+  /* stat_array is a range of global_stat_array[proc_id], so its interval counts are the
+     matching range of global_stat_values[proc_id] */
+  Stat_Value* values = stat_array[0].current;
 
   for (ii = 0; ii < num_stats; ii++) {
     Stat* s = &stat_array[ii];
+    Stat_Value* v = &values[ii];
 
     /* update the total counter for this interval */
     if (s->type == FLOAT_TYPE_STAT)
-      s->total_value += s->value;
+      s->total_value += v->value;
     else
-      s->total_count += s->count;
+      s->total_count += v->count;
   }
 
+  if (stats_format_is("binary"))
+    dump_stats_binary(proc_id, stat_array, num_stats);
+  Flag text = stats_format_is("text");
+
   const char* last_file_name = NULL;
   FILE* file_stream = NULL;
   FILE* csv_file_stream = NULL;
@@ -175,8 +522,9 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
   uns stat_groupname = 0;
   const static uns STATISTICS_CSV_NO_GROUP = 0;
 
-  for (ii = 0; ii < num_stats; ii++) {
+  for (ii = 0; text && ii < num_stats; ii++) {
     Stat* s = &stat_array[ii];
+    Stat_Value* v = &values[ii];
 
     if (!last_file_name || s->file_name != last_file_name) {
       if (last_file_name) {
@@ -244,26 +592,26 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
     switch (s->type) {
       case COUNT_TYPE_STAT:
         if (!in_dist) {
-          fprintf(file_stream, "%13s %13s    %13s %13s\n", unsstr64(s->count), "", unsstr64(s->total_count), "");
+          fprintf(file_stream, "%13s %13s    %13s %13s\n", unsstr64(v->count), "", unsstr64(s->total_count), "");
 
-          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(s->count));
+          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(v->count));
           fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP,
                   unsstr64(s->total_count));
         } else {
-          fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%", unsstr64(s->count), (double)s->count / dist_sum * 100,
+          fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%", unsstr64(v->count), (double)v->count / dist_sum * 100,
                   unsstr64(s->total_count), (double)s->total_count / total_dist_sum * 100);
 
           // Dist percentages calculation offloaded to python
-          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, stat_groupname, unsstr64(s->count));
+          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, stat_groupname, unsstr64(v->count));
           fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, stat_groupname, unsstr64(s->total_count));
         }
         break;
 
       case FLOAT_TYPE_STAT:
         ASSERTM(0, !in_dist, "Distributions not supported for float stats\n");
-        fprintf(file_stream, "%13lf %13s    %13lf %13s\n", s->value, "", s->total_value, "");
+        fprintf(file_stream, "%13lf %13s    %13lf %13s\n", v->value, "", s->total_value, "");
 
-        fprintf(csv_file_stream, "%s_value, %d, %13lf\n", s->name, STATISTICS_CSV_NO_GROUP, s->value);
+        fprintf(csv_file_stream, "%s_value, %d, %13lf\n", s->name, STATISTICS_CSV_NO_GROUP, v->value);
         fprintf(csv_file_stream, "%s_total_value, %d, %13lf\n", s->name, STATISTICS_CSV_NO_GROUP, s->total_value);
         break;
 
@@ -274,50 +622,50 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
           uns jj;
 
           in_dist = TRUE;
-          dist_sum = s->count;
+          dist_sum = v->count;
           total_dist_sum = s->total_count;
           dist_vtotal = 0;
           total_dist_vtotal = 0;
 
           for (jj = ii + 1; stat_array[jj].type != DIST_TYPE_STAT; jj++) {
-            dist_sum += stat_array[jj].count;
+            dist_sum += values[jj].count;
             total_dist_sum += stat_array[jj].total_count;
-            dist_vtotal += (jj - ii) * stat_array[jj].count;
+            dist_vtotal += (jj - ii) * values[jj].count;
             total_dist_vtotal += (jj - ii) * stat_array[jj].total_count;
           }
-          dist_sum += stat_array[jj].count;
+          dist_sum += values[jj].count;
           total_dist_sum += stat_array[jj].total_count;
-          dist_vtotal += (jj - ii) * stat_array[jj].count;
+          dist_vtotal += (jj - ii) * values[jj].count;
           total_dist_vtotal += (jj - ii) * stat_array[jj].total_count;
 
-          dist_variance = pow((0.0 - ((double)dist_vtotal / dist_sum)), 2) * stat_array[jj].count;
+          dist_variance = pow((0.0 - ((double)dist_vtotal / dist_sum)), 2) * values[jj].count;
           total_dist_variance =
               pow((0.0 - ((double)total_dist_vtotal / total_dist_sum)), 2) * stat_array[jj].total_count;
           for (jj = ii + 1; stat_array[jj].type != DIST_TYPE_STAT; jj++) {
-            dist_variance += pow((jj - ii - ((double)dist_vtotal / dist_sum)), 2) * stat_array[jj].count;
+            dist_variance += pow((jj - ii - ((double)dist_vtotal / dist_sum)), 2) * values[jj].count;
             total_dist_variance +=
                 pow((jj - ii - ((double)total_dist_vtotal / total_dist_sum)), 2) * stat_array[jj].total_count;
           }
-          dist_variance += pow((jj - ii - ((double)dist_vtotal / dist_sum)), 2) * stat_array[jj].count;
+          dist_variance += pow((jj - ii - ((double)dist_vtotal / dist_sum)), 2) * values[jj].count;
           total_dist_variance +=
               pow((jj - ii - ((double)total_dist_vtotal / total_dist_sum)), 2) * stat_array[jj].total_count;
           dist_variance /= dist_sum - 1;
           total_dist_variance /= total_dist_sum - 1;
 
-          fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%", unsstr64(s->count), (double)s->count / dist_sum * 100,
+          fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%", unsstr64(v->count), (double)v->count / dist_sum * 100,
                   unsstr64(s->total_count), (double)s->total_count / total_dist_sum * 100);
 
           // DIST pct offloaded to python
-          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, stat_groupname, unsstr64(s->count));
+          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, stat_groupname, unsstr64(v->count));
           fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, stat_groupname, unsstr64(s->total_count));
         } else {
           in_dist = FALSE;
-          fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%\n", unsstr64(s->count),
-                  (double)s->count / dist_sum * 100, unsstr64(s->total_count),
+          fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%\n", unsstr64(v->count),
+                  (double)v->count / dist_sum * 100, unsstr64(s->total_count),
                   (double)s->total_count / total_dist_sum * 100);
 
           // DIST pct offloaded to python
-          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, stat_groupname, unsstr64(s->count));
+          fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, stat_groupname, unsstr64(v->count));
           fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, stat_groupname, unsstr64(s->total_count));
 
           // print sum information
@@ -332,13 +680,13 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
         break;
 
       case PER_INST_TYPE_STAT:
-        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(s->count),
-                (double)s->count / (double)inst_count[proc_id], unsstr64(s->total_count),
+        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(v->count),
+                (double)v->count / (double)inst_count[proc_id], unsstr64(s->total_count),
                 (double)s->total_count / (double)inst_count[proc_id]);
 
-        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(s->count));
+        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(v->count));
         fprintf(csv_file_stream, "%s_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
-                (double)s->count / (double)inst_count[proc_id]);
+                (double)v->count / (double)inst_count[proc_id]);
         fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP,
                 unsstr64(s->total_count));
         fprintf(csv_file_stream, "%s_total_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
@@ -346,13 +694,13 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
         break;
 
       case PER_1000_INST_TYPE_STAT:
-        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(s->count),
-                (double)1000.0 * (double)s->count / (double)inst_count[proc_id], unsstr64(s->total_count),
+        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(v->count),
+                (double)1000.0 * (double)v->count / (double)inst_count[proc_id], unsstr64(s->total_count),
                 (double)1000.0 * (double)s->total_count / (double)inst_count[proc_id]);
 
-        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(s->count));
+        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(v->count));
         fprintf(csv_file_stream, "%s_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
-                (double)1000.0 * (double)s->count / (double)inst_count[proc_id]);
+                (double)1000.0 * (double)v->count / (double)inst_count[proc_id]);
         fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP,
                 unsstr64(s->total_count));
         fprintf(csv_file_stream, "%s_total_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
@@ -360,13 +708,13 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
         break;
 
       case PER_1000_PRET_INST_TYPE_STAT:
-        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(s->count),
-                (double)1000.0 * (double)s->count / (double)pret_inst_count[proc_id], unsstr64(s->total_count),
+        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(v->count),
+                (double)1000.0 * (double)v->count / (double)pret_inst_count[proc_id], unsstr64(s->total_count),
                 (double)1000.0 * (double)s->total_count / (double)pret_inst_count[0]);
 
-        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(s->count));
+        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(v->count));
         fprintf(csv_file_stream, "%s_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
-                (double)1000.0 * (double)s->count / (double)pret_inst_count[proc_id]);
+                (double)1000.0 * (double)v->count / (double)pret_inst_count[proc_id]);
         fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP,
                 unsstr64(s->total_count));
         fprintf(csv_file_stream, "%s_total_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
@@ -374,12 +722,12 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
         break;
 
       case PER_CYCLE_TYPE_STAT:
-        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(s->count), (double)s->count / (double)cycle_count,
+        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(v->count), (double)v->count / (double)cycle_count,
                 unsstr64(s->total_count), (double)s->total_count / (double)cycle_count);
 
-        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(s->count));
+        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(v->count));
         fprintf(csv_file_stream, "%s_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
-                (double)s->count / (double)cycle_count);
+                (double)v->count / (double)cycle_count);
         fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP,
                 unsstr64(s->total_count));
         fprintf(csv_file_stream, "%s_total_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
@@ -387,13 +735,13 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
         break;
 
       case RATIO_TYPE_STAT:
-        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(s->count),
-                (double)s->count / (double)(stat_array[s->ratio_stat].count), unsstr64(s->total_count),
+        fprintf(file_stream, "%13s %13.4f    %13s %13.4f\n", unsstr64(v->count),
+                (double)v->count / (double)(values[s->ratio_stat].count), unsstr64(s->total_count),
                 (double)s->total_count / (double)stat_array[s->ratio_stat].total_count);
 
-        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(s->count));
+        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(v->count));
         fprintf(csv_file_stream, "%s_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
-                (double)s->count / (double)(stat_array[s->ratio_stat].count));
+                (double)v->count / (double)(values[s->ratio_stat].count));
         fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP,
                 unsstr64(s->total_count));
         fprintf(csv_file_stream, "%s_total_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
@@ -401,13 +749,13 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
         break;
 
       case PERCENT_TYPE_STAT:
-        fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%\n", unsstr64(s->count),
-                (double)s->count * 100 / (double)(stat_array[s->ratio_stat].count), unsstr64(s->total_count),
+        fprintf(file_stream, "%13s %12.3f%%    %13s %12.3f%%\n", unsstr64(v->count),
+                (double)v->count * 100 / (double)(values[s->ratio_stat].count), unsstr64(s->total_count),
                 (double)s->total_count * 100 / (double)stat_array[s->ratio_stat].total_count);
 
-        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(s->count));
+        fprintf(csv_file_stream, "%s_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP, unsstr64(v->count));
         fprintf(csv_file_stream, "%s_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
-                (double)s->count * 100 / (double)(stat_array[s->ratio_stat].count));
+                (double)v->count * 100 / (double)(values[s->ratio_stat].count));
         fprintf(csv_file_stream, "%s_total_count, %d, %13s\n", s->name, STATISTICS_CSV_NO_GROUP,
                 unsstr64(s->total_count));
         fprintf(csv_file_stream, "%s_total_pct, %d, %12.3f\n", s->name, STATISTICS_CSV_NO_GROUP,
@@ -442,13 +790,8 @@ void dump_stats(uns8 proc_id, Flag final, Stat stat_array[], uns num_stats) {
   }
 
   /* reset the interval counters */
-  for (ii = 0; ii < num_stats; ii++) {
-    Stat* s = &stat_array[ii];
-    if (s->type == FLOAT_TYPE_STAT)
-      s->value = 0.0;
-    else
-      s->count = 0;
-  }
+  memset(values, 0, num_stats * sizeof(Stat_Value));
+  SIM_PROBE1(dump_stats_end, proc_id);
 }
 
 /**************************************************************************************/
@@ -464,19 +807,23 @@ void reset_stats(Flag keep_total) {
     fflush(mystdout);
   }
 
-  for (ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
-    for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+  for (proc_id = 0; proc_id < NUM_CORES; proc_id++) {
+    Stat_Value* values = global_stat_values[proc_id];
+    topdown_flush(proc_id);
+    crit_path_flush(proc_id);
+    stat_integrator_flush(proc_id);
+    for (ii = 0; ii < NUM_GLOBAL_STATS; ii++) {
       Stat* stat = &global_stat_array[proc_id][ii];
-      if (stat->type == FLOAT_TYPE_STAT) {
-        if (keep_total || stat->noreset)
-          stat->total_value += stat->value;
-        stat->value = 0.0;
-      } else {
-        if (keep_total || stat->noreset)
-          stat->total_count += stat->count;
-        stat->count = 0ULL;
+      if (keep_total || stat->noreset) {
+        if (stat->type == FLOAT_TYPE_STAT)
+          stat->total_value += values[ii].value;
+        else
+          stat->total_count += values[ii].count;
       }
     }
+    memset(values, 0, NUM_GLOBAL_STATS * sizeof(Stat_Value));
+    if (LATENCY_HISTS && !keep_total)
+      memset(global_hists[proc_id], 0, num_hist_instances * sizeof(Hist));
   }
 }
 
@@ -504,6 +851,23 @@ const Stat* get_stat(uns8 proc_id, const char* name) {
   return &global_stat_array[proc_id][idx];
 }
 
+/**************************************************************************************/
+/* stat_is_on: FALSE if the group of stat is compiled out or turned off, so that
+   the stat stays 0 */
+
+Flag stat_is_on(Stat_Enum stat) {
+  ASSERT(0, stat < NUM_GLOBAL_STATS);
+  return global_stat_on[stat];
+}
+
+/**************************************************************************************/
+/* stat_group_name: */
+
+const char* stat_group_name(Stat_Enum stat) {
+  ASSERT(0, stat < NUM_GLOBAL_STATS);
+  return stat_groups[stat_group_of(stat)].name;
+}
+
 /**************************************************************************************/
 /* get_stat: */
 
@@ -519,3 +883,56 @@ Counter get_accum_stat_event(Stat_Enum name) {
 
   return accum;
 }
+
+/**************************************************************************************/
+/* stat_integrator_init: */
+
+void stat_integrator_init(Stat_Integrator* integrator, uns8 proc_id, Freq_Domain_Id domain, Stat_Enum sum_stat,
+                          Stat_Enum dist_first, Stat_Enum dist_last, uns dist_div) {
+  ASSERT(proc_id, dist_first == NUM_GLOBAL_STATS || (dist_first <= dist_last && dist_div));
+  integrator->proc_id = proc_id;
+  integrator->domain = domain;
+  integrator->sum_stat = sum_stat;
+  integrator->dist_first = dist_first;
+  integrator->dist_last = dist_last;
+  integrator->dist_div = dist_div;
+  integrator->value = 0;
+  integrator->since = freq_cycle_count(domain);
+  integrator->next = stat_integrators[proc_id];
+  stat_integrators[proc_id] = integrator;
+}
+
+/**************************************************************************************/
+/* stat_integrator_settle: the cycle counts restart from 0 after warmup
+   (freq_reset_cycle_counts), so a clock behind since counts from 0 */
+
+void stat_integrator_settle(Stat_Integrator* integrator) {
+  Counter now = freq_cycle_count(integrator->domain);
+  Counter cycles = now >= integrator->since ? now - integrator->since : now;
+  integrator->since = now;
+  if (!cycles || stat_integrators_paused)
+    return;
+  if (integrator->sum_stat != NUM_GLOBAL_STATS)
+    INC_STAT_EVENT(integrator->proc_id, integrator->sum_stat, integrator->value * cycles);
+  if (integrator->dist_first != NUM_GLOBAL_STATS)
+    INC_STAT_EVENT(integrator->proc_id,
+                   MIN2(integrator->dist_first + integrator->value / integrator->dist_div, integrator->dist_last),
+                   cycles);
+}
+
+/**************************************************************************************/
+/* stat_integrator_flush: */
+
+void stat_integrator_flush(uns proc_id) {
+  for (Stat_Integrator* integrator = stat_integrators[proc_id]; integrator; integrator = integrator->next)
+    stat_integrator_settle(integrator);
+}
+
+/**************************************************************************************/
+/* stat_integrators_pause: */
+
+void stat_integrators_pause(Flag pause) {
+  for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++)
+    stat_integrator_flush(proc_id);
+  stat_integrators_paused = pause;
+}
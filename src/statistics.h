@@ -38,10 +38,13 @@
 
 #include "libs/list_lib.h"
 
+#include "freq.h"
+
 /**************************************************************************************/
 /* Type Declarations */
 
 #define DEF_STAT(name, type, ratio) name,
+#define DEF_STAT_GROUP(name, production)
 
 typedef enum Stat_Enum_enum {
 #include "stat_files.def"
@@ -49,6 +52,36 @@ typedef enum Stat_Enum_enum {
 } Stat_Enum;
 
 #undef DEF_STAT
+#undef DEF_STAT_GROUP
+
+/* Stat groups: DEF_STAT_GROUP(name, production) in a .stat.def file starts group
+   'name', which runs up to the next DEF_STAT_GROUP. A STAT_PRODUCTION build (make prd)
+   compiles the STAT_EVENTs of every group not marked production out of the code, and
+   the stat_groups_off parameter turns groups off at run time. The stats of a group
+   that is off stay 0. */
+
+#define DEF_STAT(name, type, ratio)
+#define DEF_STAT_GROUP(name, production) STAT_GROUP_##name,
+
+typedef enum Stat_Group_enum {
+#include "stat_files.def"
+  NUM_STAT_GROUPS
+} Stat_Group;
+
+#undef DEF_STAT
+#undef DEF_STAT_GROUP
+
+/* STAT_GROUP_<name>_FIRST is the first stat of each group: every stat restarts the count
+   at its own index, so a group marker gets the index of the stat after it */
+#define DEF_STAT(name, type, ratio) STAT_GROUP_POS_##name = name,
+#define DEF_STAT_GROUP(name, production) STAT_GROUP_##name##_FIRST,
+
+typedef enum Stat_Group_First_enum {
+#include "stat_files.def"
+} Stat_Group_First;
+
+#undef DEF_STAT
+#undef DEF_STAT_GROUP
 
 typedef enum Stat_Type_enum {
   COUNT_TYPE_STAT,  // stat is a simple counter
@@ -73,13 +106,17 @@ typedef enum Stat_Type_enum {
   NUM_STAT_TYPES,
 } Stat_Type;
 
+/* The counts of the current interval are what the STAT_EVENT macros touch, so they are
+   kept apart from the rest of the Stat, in one dense array per core (global_stat_values) */
+typedef union Stat_Value_union {
+  Counter count;  // count during the current stat interval
+  double value;   // value during the current stat interval
+} Stat_Value;
+
 typedef struct Stat_struct {
-  Stat_Type type;    // see types above
-  const char* name;  // name of stat
-  union {
-    Counter count;  // count during the current stat interval
-    double value;   // value during the current stat interval
-  };
+  Stat_Type type;       // see types above
+  const char* name;     // name of stat
+  Stat_Value* current;  // this stat's slot in global_stat_values
   union {
     Counter total_count;  // total count from beginning of run
     double total_value;   // total value from beginning of run
@@ -89,53 +126,137 @@ typedef struct Stat_struct {
   Flag noreset;           // this stat does not get reset (name has prefix "NORESET")
 } Stat;
 
+/* Latency histograms: DEF_HIST(name, kind) in memory/memory.hist.def. A histogram of
+   kind PER_MEM_REQ_TYPE or PER_MEM_QUEUE has one instance per request or queue type.
+   The buckets are log-linear: values below HIST_SUB_BUCKETS get a bucket each, every
+   larger power of two is split into HIST_SUB_BUCKETS equal buckets. */
+
+#define DEF_HIST(name, kind) HIST_##name,
+
+typedef enum Hist_Enum_enum {
+#include "memory/memory.hist.def"
+  NUM_HISTS
+} Hist_Enum;
+
+#undef DEF_HIST
+
+typedef enum Hist_Kind_enum {
+  HIST_ONE,
+  HIST_PER_MEM_REQ_TYPE,
+  HIST_PER_MEM_QUEUE,
+} Hist_Kind;
+
+#define HIST_SUB_BITS 4
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_NUM_BUCKETS ((64 - HIST_SUB_BITS + 1) << HIST_SUB_BITS)
+
+typedef struct Hist_struct {
+  Counter count;  // values recorded since the last stat reset
+  Counter sum;    // sum of the values
+  Counter max;    // largest value
+  Counter buckets[HIST_NUM_BUCKETS];
+} Hist;
+
+/* Occupancy integrators: rather than sampling an occupancy every cycle, its producer
+   reports it when it changes (stat_integrator_set). The integrator adds value x cycles
+   to sum_stat and the cycles to the DIST stat dist_first + value / dist_div (capped at
+   dist_last), as per-cycle sampling in its clock domain would. It does so lazily: at the
+   next change and when the stats are dumped or cleared. */
+typedef struct Stat_Integrator_struct {
+  uns8 proc_id;
+  Freq_Domain_Id domain;  // clock of the cycles
+  Stat_Enum sum_stat;     // NUM_GLOBAL_STATS: none
+  Stat_Enum dist_first;   // NUM_GLOBAL_STATS: none
+  Stat_Enum dist_last;
+  uns dist_div;
+  Counter value;
+  Counter since;  // cycle up to which value was counted
+  struct Stat_Integrator_struct* next;  // of the same core
+} Stat_Integrator;
+
 /**************************************************************************************/
 /* Macros */
 
 #ifndef NO_STAT
-#define STAT_EVENT(proc_id, stat)             \
-  do {                                        \
-    global_stat_array[proc_id][stat].count++; \
+
+#ifdef STAT_PRODUCTION
+/* Folds to a constant when stat is one, so the STAT_EVENTs of the groups that are not
+   production disappear from the code */
+static inline Flag stat_compiled(uns stat) {
+  Flag compiled = TRUE;
+#define DEF_STAT(name, type, ratio)
+#define DEF_STAT_GROUP(name, production)    \
+  if (stat >= (uns)STAT_GROUP_##name##_FIRST) \
+    compiled = production;
+#include "stat_files.def"
+#undef DEF_STAT
+#undef DEF_STAT_GROUP
+  return compiled;
+}
+#define STAT_COMPILED(stat) (__builtin_constant_p(stat) ? stat_compiled(stat) : TRUE)
+#else
+#define STAT_COMPILED(stat) TRUE
+#endif
+
+/* global_stat_on also covers the groups compiled out, for stats that are not constants */
+#define STAT_ON(stat) (STAT_COMPILED(stat) && global_stat_on[stat])
+
+#define STAT_EVENT(proc_id, stat)                \
+  do {                                           \
+    if (STAT_ON(stat))                           \
+      global_stat_values[proc_id][stat].count++; \
   } while (0)
 
-#define STAT_EVENT_ALL(stat)                              \
-  do {                                                    \
-    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) \
-      global_stat_array[proc_id][stat].count++;           \
+#define STAT_EVENT_ALL(stat)                                \
+  do {                                                      \
+    if (STAT_ON(stat))                                      \
+      for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) \
+        global_stat_values[proc_id][stat].count++;          \
   } while (0)
 
-#define INC_STAT_EVENT(proc_id, stat, inc)           \
-  do {                                               \
-    global_stat_array[proc_id][stat].count += (inc); \
+#define INC_STAT_EVENT(proc_id, stat, inc)              \
+  do {                                                  \
+    if (STAT_ON(stat))                                  \
+      global_stat_values[proc_id][stat].count += (inc); \
   } while (0)
 
-#define INC_STAT_EVENT_ALL(stat, inc)                     \
-  do {                                                    \
-    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) \
-      global_stat_array[proc_id][stat].count += (inc);    \
+#define INC_STAT_EVENT_ALL(stat, inc)                       \
+  do {                                                      \
+    if (STAT_ON(stat))                                      \
+      for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) \
+        global_stat_values[proc_id][stat].count += (inc);   \
   } while (0)
 
-#define INC_STAT_VALUE(proc_id, stat, inc)           \
-  do {                                               \
-    global_stat_array[proc_id][stat].value += (inc); \
+#define INC_STAT_VALUE(proc_id, stat, inc)              \
+  do {                                                  \
+    if (STAT_ON(stat))                                  \
+      global_stat_values[proc_id][stat].value += (inc); \
   } while (0)
 
-#define INC_STAT_VALUE_ALL(stat, inc)                     \
-  do {                                                    \
-    for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) \
-      global_stat_array[proc_id][stat].value += (inc);    \
+#define INC_STAT_VALUE_ALL(stat, inc)                       \
+  do {                                                      \
+    if (STAT_ON(stat))                                      \
+      for (uns proc_id = 0; proc_id < NUM_CORES; proc_id++) \
+        global_stat_values[proc_id][stat].value += (inc);   \
   } while (0)
 
-#define GET_STAT_EVENT(proc_id, stat) (global_stat_array[proc_id][stat].count)
+#define GET_STAT_EVENT(proc_id, stat) (global_stat_values[proc_id][stat].count)
 #define GET_TOTAL_STAT_EVENT(proc_id, stat) \
-  (global_stat_array[proc_id][stat].count + global_stat_array[proc_id][stat].total_count)
+  (global_stat_values[proc_id][stat].count + global_stat_array[proc_id][stat].total_count)
 #define GET_TOTAL_STAT_VALUE(proc_id, stat) \
-  (global_stat_array[proc_id][stat].value + global_stat_array[proc_id][stat].total_value)
+  (global_stat_values[proc_id][stat].value + global_stat_array[proc_id][stat].total_value)
 #define GET_ACCUM_STAT_EVENT(stat) get_accum_stat_event(stat)
-#define RESET_STAT(proc_id, stat) (global_stat_array[proc_id][stat].count = 0)
+#define RESET_STAT(proc_id, stat) (global_stat_values[proc_id][stat].count = 0)
 
 #define NO_RATIO NUM_GLOBAL_STATS
 
+/* instance is the request type or the queue type bit for the PER_ kinds, 0 otherwise */
+#define HIST_RECORD(proc_id, hist, instance, value)                                            \
+  do {                                                                                         \
+    if (LATENCY_HISTS)                                                                         \
+      hist_record(&global_hists[proc_id][global_hist_first[HIST_##hist] + (instance)], value); \
+  } while (0)
+
 #else
 
 #define STAT_EVENT(proc_id, stat)
@@ -150,6 +271,7 @@ typedef struct Stat_struct {
 #define GET_ACCUM_STAT_EVENT(stat)
 #define RESET_STAT(proc_id, stat)
 #define NO_RATIO
+#define HIST_RECORD(proc_id, hist, instance, value)
 
 #endif
 
@@ -158,6 +280,11 @@ typedef struct Stat_struct {
 
 #ifndef NO_STAT
 extern Stat** global_stat_array;
+extern Stat_Value** global_stat_values;
+extern Flag global_stat_on[NUM_GLOBAL_STATS];
+extern char const* stat_file_suffix;
+extern Hist** global_hists;
+extern uns global_hist_first[NUM_HISTS];
 #endif
 
 /**************************************************************************************/
@@ -175,6 +302,42 @@ void fprint_line(FILE*);
 Stat_Enum get_stat_idx(const char* name);
 const Stat* get_stat(uns8, const char*);
 Counter get_accum_stat_event(Stat_Enum name);
+Flag stat_is_on(Stat_Enum stat);
+const char* stat_group_name(Stat_Enum stat);
+
+void stat_integrator_init(Stat_Integrator* integrator, uns8 proc_id, Freq_Domain_Id domain, Stat_Enum sum_stat,
+                          Stat_Enum dist_first, Stat_Enum dist_last, uns dist_div);
+/* counts the cycles since the integrator was last settled at its current value */
+void stat_integrator_settle(Stat_Integrator* integrator);
+/* settles every integrator of proc_id, before its stats are read */
+void stat_integrator_flush(uns proc_id);
+/* while paused (functional warming, which advances time without simulating the
+   machine) the cycles are not counted */
+void stat_integrators_pause(Flag pause);
+
+static inline void stat_integrator_set(Stat_Integrator* integrator, Counter value) {
+  if (value == integrator->value)
+    return;
+  stat_integrator_settle(integrator);
+  integrator->value = value;
+}
+
+/* hist_bucket: bucket of value, exact below HIST_SUB_BUCKETS and within 1/HIST_SUB_BUCKETS
+   of the value above */
+static inline uns hist_bucket(Counter value) {
+  if (value < HIST_SUB_BUCKETS)
+    return value;
+  uns msb = 63 - __builtin_clzll(value);
+  return ((msb - HIST_SUB_BITS + 1) << HIST_SUB_BITS) + ((value >> (msb - HIST_SUB_BITS)) & (HIST_SUB_BUCKETS - 1));
+}
+
+static inline void hist_record(Hist* hist, Counter value) {
+  hist->count++;
+  hist->sum += value;
+  if (value > hist->max)
+    hist->max = value;
+  hist->buckets[hist_bucket(value)]++;
+}
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,175 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : store_set.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Store-set memory dependence predictor (Chrysos and Emer, ISCA 1998)
+ ***************************************************************************************/
+
+/* The store set identifier table (SSIT) maps the PC of a load or store to the store set
+   it belongs to, and the last fetched store table (LFST) holds the last mapped in-flight
+   store of each set. A load waits for the LFST store of its set instead of its oracle
+   producer. The sets are trained on the violations the LSQ reports, and the SSIT is
+   cleared every STORE_SET_CLEAR_INTERVAL cycles so that stale sets do not keep loads
+   waiting forever. */
+
+#include "store_set.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+#include "debug/debug_print.h"
+
+#include "core.param.h"
+#include "general.param.h"
+
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_MAP, ##args)
+
+#define SSIT_INVALID ((uns)-1)
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct LFST_Entry_struct {
+  Op* op;  // last mapped store of the set (NULL if none)
+  Counter unique_num;
+} LFST_Entry;
+
+typedef struct Store_Set_struct {
+  uns* ssit;  // [STORE_SET_SSIT_SIZE] store set of each PC (SSIT_INVALID if none)
+  LFST_Entry* lfst;
+  uns next_ssid;  // the next store set handed out, round-robin
+  Counter next_clear_cycle;
+} Store_Set;
+
+/**************************************************************************************/
+/* Global Variables */
+
+static Store_Set* store_sets = NULL;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static inline uns* ssit_entry(Store_Set* ss, Addr pc);
+static inline void store_set_clear(Store_Set* ss);
+
+/**************************************************************************************/
+/* ssit_entry */
+
+static inline uns* ssit_entry(Store_Set* ss, Addr pc) {
+  if (STORE_SET_CLEAR_INTERVAL && cycle_count >= ss->next_clear_cycle) {
+    store_set_clear(ss);
+    ss->next_clear_cycle = cycle_count + STORE_SET_CLEAR_INTERVAL;
+  }
+  return &ss->ssit[pc % STORE_SET_SSIT_SIZE];
+}
+
+/**************************************************************************************/
+/* store_set_clear */
+
+static inline void store_set_clear(Store_Set* ss) {
+  for (uns ii = 0; ii < STORE_SET_SSIT_SIZE; ii++)
+    ss->ssit[ii] = SSIT_INVALID;
+}
+
+/**************************************************************************************/
+/* init_store_set */
+
+void init_store_set(uns8 proc_id) {
+  ASSERTM(proc_id, STORE_SET_SSIT_SIZE && STORE_SET_LFST_SIZE, "Store sets need a non-empty SSIT and LFST\n");
+  if (!store_sets)
+    store_sets = (Store_Set*)calloc(NUM_CORES, sizeof(Store_Set));
+
+  Store_Set* ss = &store_sets[proc_id];
+  ss->ssit = (uns*)malloc(sizeof(uns) * STORE_SET_SSIT_SIZE);
+  ss->lfst = (LFST_Entry*)calloc(STORE_SET_LFST_SIZE, sizeof(LFST_Entry));
+  ss->next_ssid = 0;
+  ss->next_clear_cycle = STORE_SET_CLEAR_INTERVAL;
+  store_set_clear(ss);
+}
+
+/**************************************************************************************/
+/* store_set_predict_load: returns the in-flight store the load should wait for, NULL
+   if the load is predicted independent */
+
+Op* store_set_predict_load(Op* op) {
+  Store_Set* ss = &store_sets[op->proc_id];
+  uns ssid = *ssit_entry(ss, op->inst_info->addr);
+  if (ssid == SSIT_INVALID)
+    return NULL;
+
+  /* the store may have retired or been flushed since it was mapped */
+  LFST_Entry* entry = &ss->lfst[ssid];
+  if (!entry->op || !entry->op->op_pool_valid || entry->op->unique_num != entry->unique_num)
+    return NULL;
+  DEBUG(op->proc_id, "Store set %u  load op_num:%s waits for store op_num:%s\n", ssid, unsstr64(op->op_num),
+        unsstr64(entry->op->op_num));
+  return entry->op;
+}
+
+/**************************************************************************************/
+/* store_set_map_store: makes the store the last fetched store of its set */
+
+void store_set_map_store(Op* op) {
+  Store_Set* ss = &store_sets[op->proc_id];
+  uns ssid = *ssit_entry(ss, op->inst_info->addr);
+  if (ssid == SSIT_INVALID)
+    return;
+
+  ss->lfst[ssid].op = op;
+  ss->lfst[ssid].unique_num = op->unique_num;
+}
+
+/**************************************************************************************/
+/* store_set_train: the load issued before the older store it reads from, so both join
+   one store set (the smaller one when both already have a set) */
+
+void store_set_train(Op* load_op, Op* store_op) {
+  Store_Set* ss = &store_sets[load_op->proc_id];
+  uns* load_ssid = ssit_entry(ss, load_op->inst_info->addr);
+  uns* store_ssid = ssit_entry(ss, store_op->inst_info->addr);
+
+  if (*load_ssid == SSIT_INVALID && *store_ssid == SSIT_INVALID) {
+    *load_ssid = ss->next_ssid;
+    ss->next_ssid = (ss->next_ssid + 1) % STORE_SET_LFST_SIZE;
+    ss->lfst[*load_ssid].op = NULL;
+  } else if (*load_ssid == SSIT_INVALID) {
+    *load_ssid = *store_ssid;
+  } else if (*store_ssid != SSIT_INVALID) {
+    *load_ssid = MIN2(*load_ssid, *store_ssid);
+  }
+  *store_ssid = *load_ssid;
+  DEBUG(load_op->proc_id, "Store set %u  trained by load 0x%s and store 0x%s\n", *load_ssid,
+        hexstr64s(load_op->inst_info->addr), hexstr64s(store_op->inst_info->addr));
+}
@@ -0,0 +1,48 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : store_set.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Store-set memory dependence predictor (Chrysos and Emer, ISCA 1998)
+ ***************************************************************************************/
+
+#ifndef __STORE_SET_H__
+#define __STORE_SET_H__
+
+#include "globals/global_types.h"
+
+#include "op.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+void init_store_set(uns8 proc_id);
+Op* store_set_predict_load(Op* op);
+void store_set_map_store(Op* op);
+void store_set_train(Op* load_op, Op* store_op);
+
+/**************************************************************************************/
+
+#endif /* #ifndef __STORE_SET_H__ */
@@ -150,6 +150,7 @@ struct Table_Info_struct {
   Flag is_simd;         // Is it a SIMD opcode (even if it is a scalar operation like MOVSD)
   uns8 num_simd_lanes;  // Number of data parallel operations in the instruction. For non-SIMD instructions, this is 1.
   uns8 lane_width_bytes;  // Operand width of each SIMD lane. For non-SIMD instructions, this is still set.
+  uns64 fu_type;          // FU types that can execute it, get_fu_type(op_type, is_simd) computed once per uop
 
   uns mem_size;  // number of bytes read/written by a memory instruction
 
@@ -0,0 +1,393 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Microbenchmarks of the libs/ data structures (make libs_bench).  The cache benchmarks replay a
+   synthetic L1-like stream, and every --cache_accesses=<file> given on the command line adds a
+   replay of a stream recorded from a real run with CACHE_ACCESS_RECORD. */
+
+#include <benchmark/benchmark.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "globals/global_defs.h"
+#include "globals/global_types.h"
+#include "globals/global_vars.h"
+
+#include "core.param.h"
+#include "debug/debug.param.h"
+#include "general.param.h"
+#include "memory/memory.param.h"
+
+#include "libs/cache_lib.h"
+#include "libs/hash_lib.h"
+#include "libs/list_lib.h"
+#include "libs/malloc_lib.h"
+#include "libs/ring_lib.h"
+}
+
+#include "libs/bloom_filter.hpp"
+#include "libs/cpp_cache.h"
+
+/**************************************************************************************/
+/* The parameters and globals the libs use */
+
+extern "C" {
+uns NUM_CORES = 1;
+uns NODE_TABLE_SIZE = 256;
+Flag CACHE_TAG_STORE = TRUE;
+uns HUGE_PAGE_TABLES = 0;
+Flag L1_PART_ON = FALSE;
+Flag DEBUG_CPP_CACHE = FALSE;
+char* CACHE_ACCESS_RECORD = NULL;
+char* CACHE_OPT_RECORD = NULL;
+char* SET_PROF_CACHES = NULL;
+char* OUTPUT_DIR = (char*)".";
+char* FILE_TAG = (char*)"";
+
+FILE* mystdout = stdout;
+FILE* mystderr = stderr;
+FILE* mystatus = stdout;
+
+__thread Counter cycle_count = 0;
+__thread Counter sim_time = 0;
+Counter* op_count;
+Counter* inst_count;
+}
+
+/**************************************************************************************/
+/* Access streams */
+
+static const uns64 BENCH_SEED = 0x5ca7ab;
+
+static inline uns64 bench_rand(uns64* state) {
+  *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+  return *state >> 33;
+}
+
+/* The mix an L1 data cache sees: mostly a hot working set, a few sequential streams and some
+   accesses all over a large footprint */
+static std::vector<Addr> make_l1_stream(uns num) {
+  std::vector<Addr> addrs(num);
+  uns64 state = BENCH_SEED;
+  Addr stream = 0x10000000;
+  for (uns ii = 0; ii < num; ii++) {
+    uns64 r = bench_rand(&state);
+    if (r % 100 < 70)
+      addrs[ii] = 0x7f0000000000 + (bench_rand(&state) % 512) * 64;
+    else if (r % 100 < 90)
+      addrs[ii] = (stream += 8);
+    else
+      addrs[ii] = 0x20000000 + (bench_rand(&state) % (1 << 20)) * 64;
+  }
+  return addrs;
+}
+
+static std::vector<Cache_Record> make_l1_records(uns num) {
+  std::vector<Cache_Record> records;
+  for (Addr addr : make_l1_stream(num)) {
+    records.push_back({addr, CACHE_RECORD_ACCESS, 0, TRUE});
+    records.push_back({addr, CACHE_RECORD_INSERT, 0, INSERT_REPL_DEFAULT});
+  }
+  return records;
+}
+
+/**************************************************************************************/
+/* cache_lib */
+
+/* Replays records on cache.  With insert_on_miss an insert only happens if the preceding access
+   missed, as in the simulator, so that a synthetic stream can pair every access with an insert. */
+static void replay_cache_records(Cache* cache, const std::vector<Cache_Record>& records, Flag insert_on_miss) {
+  Addr line_addr, repl_line_addr;
+  Flag hit = FALSE;
+  for (const Cache_Record& record : records) {
+    switch (record.op) {
+      case CACHE_RECORD_ACCESS:
+        hit = cache_access(cache, record.addr, &line_addr, record.arg) != NULL;
+        break;
+      case CACHE_RECORD_INSERT:
+        if (!insert_on_miss || !hit)
+          cache_insert_replpos(cache, record.proc_id, record.addr, &line_addr, &repl_line_addr,
+                               (Cache_Insert_Repl)(record.arg & ~CACHE_RECORD_PREF),
+                               (record.arg & CACHE_RECORD_PREF) != 0);
+        hit = FALSE;
+        break;
+      default:
+        cache_invalidate(cache, record.addr, &line_addr);
+        break;
+    }
+  }
+}
+
+static void BM_cache_lib_l1(benchmark::State& state) {
+  static const std::vector<Cache_Record> records = make_l1_records(1 << 20);
+  Cache cache = {};
+  init_cache(&cache, "BENCH", 48 * 1024, state.range(0), 64, 8, (Repl_Policy)state.range(1));
+  for (auto _ : state)
+    replay_cache_records(&cache, records, TRUE);
+  state.SetItemsProcessed(state.iterations() * records.size() / 2);
+}
+BENCHMARK(BM_cache_lib_l1)
+    ->ArgNames({"assoc", "repl"})
+    ->Args({12, REPL_TRUE_LRU})
+    ->Args({16, REPL_TRUE_LRU})
+    ->Args({12, REPL_SRRIP})
+    ->Args({12, REPL_DRRIP});
+
+/* The L1 stream looked up width accesses at a time, as the dcache stage does for the loads of one
+   cycle, with the misses of a group inserted after its lookups */
+static void BM_cache_lib_l1_multi(benchmark::State& state) {
+  static const std::vector<Addr> addrs = make_l1_stream(1 << 20);
+  uns width = state.range(0);
+  Cache cache = {};
+  init_cache(&cache, "BENCH", 48 * 1024, 12, 64, 8, REPL_TRUE_LRU);
+  std::vector<Addr> line_addrs(width);
+  std::vector<void*> lines(width);
+  Addr line_addr, repl_line_addr;
+  for (auto _ : state) {
+    for (uns base = 0; base + width <= addrs.size(); base += width) {
+      cache_access_multi(&cache, width, &addrs[base], line_addrs.data(), lines.data(), TRUE);
+      for (uns ii = 0; ii < width; ii++)
+        if (!lines[ii] && !cache_access(&cache, addrs[base + ii], &line_addr, FALSE))
+          cache_insert(&cache, 0, addrs[base + ii], &line_addr, &repl_line_addr);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * addrs.size());
+}
+BENCHMARK(BM_cache_lib_l1_multi)->ArgName("width")->Arg(1)->Arg(4);
+
+static void BM_cache_lib_replay(benchmark::State& state, const std::string& file) {
+  FILE* fp = fopen(file.c_str(), "r");
+  Cache_Record_Header header;
+  if (!fp || fread(&header, sizeof(header), 1, fp) != 1 || header.magic != CACHE_RECORD_MAGIC) {
+    state.SkipWithError(("Not a CACHE_ACCESS_RECORD file: " + file).c_str());
+    if (fp)
+      fclose(fp);
+    return;
+  }
+  std::vector<Cache_Record> records;
+  Cache_Record record;
+  while (fread(&record, sizeof(record), 1, fp) == 1)
+    records.push_back(record);
+  fclose(fp);
+
+  Cache cache = {};
+  init_cache(&cache, "BENCH", header.cache_size, header.assoc, header.line_size, header.data_size,
+             (Repl_Policy)header.repl_policy);
+  for (auto _ : state)
+    replay_cache_records(&cache, records, FALSE);
+  state.SetItemsProcessed(state.iterations() * records.size());
+}
+
+/**************************************************************************************/
+/* cpp_cache */
+
+class Bench_Cpp_Cache : public Cpp_Cache<Addr, uns> {
+ public:
+  Bench_Cpp_Cache(uns lines, uns assoc, Repl_Policy repl) : Cpp_Cache<Addr, uns>(lines, assoc, 64, repl) {}
+
+ protected:
+  uns set_idx_hash(Addr key) override { return (key >> 6) % num_sets; }
+};
+
+static void BM_cpp_cache_l1(benchmark::State& state) {
+  static const std::vector<Addr> addrs = make_l1_stream(1 << 20);
+  Bench_Cpp_Cache cache(768, state.range(0), REPL_TRUE_LRU);
+  for (auto _ : state) {
+    for (Addr addr : addrs) {
+      cycle_count++;
+      Addr line = addr & ~(Addr)63;
+      if (!cache.access(line, true))
+        cache.insert(line, 0);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * addrs.size());
+}
+BENCHMARK(BM_cpp_cache_l1)->ArgName("assoc")->Arg(12)->Arg(16);
+
+/**************************************************************************************/
+/* hash_lib */
+
+/* Lookups of existing keys in a table of range(0) elements, like the inst_info and op tables */
+static void BM_hash_lib_access(benchmark::State& state) {
+  uns num = state.range(0);
+  Hash_Table table;
+  init_hash_table(&table, "BENCH", 64, sizeof(uns64));
+  std::vector<int64> keys(num);
+  uns64 rand_state = BENCH_SEED;
+  Flag new_entry;
+  for (uns ii = 0; ii < num; ii++) {
+    keys[ii] = 0x400000 + bench_rand(&rand_state) * 4;
+    hash_table_access_create(&table, keys[ii], &new_entry);
+  }
+  uns ii = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hash_table_access(&table, keys[ii]));
+    ii = ii + 1 == num ? 0 : ii + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_hash_lib_access)->RangeMultiplier(8)->Range(1 << 9, 1 << 18);
+
+/* A sliding window of range(0) live keys: every step creates the newest and deletes the oldest,
+   like the tables that track in-flight ops */
+static void BM_hash_lib_window(benchmark::State& state) {
+  int64 window = state.range(0);
+  Hash_Table table;
+  init_hash_table(&table, "BENCH", 64, sizeof(uns64));
+  Flag new_entry;
+  int64 key = 0;
+  for (; key < window; key++)
+    hash_table_access_create(&table, key * 64, &new_entry);
+  for (auto _ : state) {
+    hash_table_access_create(&table, key * 64, &new_entry);
+    hash_table_access_delete(&table, (key - window) * 64);
+    key++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_hash_lib_window)->RangeMultiplier(8)->Range(1 << 6, 1 << 12);
+
+/**************************************************************************************/
+/* list_lib */
+
+/* A FIFO of range(0) elements, like the request and op queues */
+static void BM_list_lib_fifo(benchmark::State& state) {
+  List list;
+  char name[] = "BENCH";
+  init_list(&list, name, sizeof(uns64), TRUE);
+  for (int ii = 0; ii < state.range(0); ii++)
+    *(uns64*)dl_list_add_tail(&list) = ii;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dl_list_remove_head(&list));
+    *(uns64*)dl_list_add_tail(&list) = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_list_lib_fifo)->Arg(16)->Arg(256);
+
+static void BM_list_lib_traverse(benchmark::State& state) {
+  List list;
+  char name[] = "BENCH";
+  init_list(&list, name, sizeof(uns64), TRUE);
+  for (int ii = 0; ii < state.range(0); ii++)
+    *(uns64*)dl_list_add_tail(&list) = ii;
+  for (auto _ : state) {
+    uns64 sum = 0;
+    for (uns64* data = (uns64*)list_start_head_traversal(&list); data; data = (uns64*)list_next_element(&list))
+      sum += *data;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_list_lib_traverse)->Arg(16)->Arg(256);
+
+/**************************************************************************************/
+/* ring_lib */
+
+static void BM_ring_lib_fifo(benchmark::State& state) {
+  Ring ring;
+  init_ring(&ring, "BENCH", sizeof(uns64), 16);
+  for (int ii = 0; ii < state.range(0); ii++)
+    *(uns64*)ring_add_tail(&ring) = ii;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ring_remove_head(&ring));
+    *(uns64*)ring_add_tail(&ring) = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ring_lib_fifo)->Arg(16)->Arg(256);
+
+static void BM_ring_lib_traverse(benchmark::State& state) {
+  Ring ring;
+  init_ring(&ring, "BENCH", sizeof(uns64), 16);
+  for (int ii = 0; ii < state.range(0); ii++)
+    *(uns64*)ring_add_tail(&ring) = ii;
+  for (auto _ : state) {
+    uns64 sum = 0;
+    for (int ii = 0; ii < ring.count; ii++)
+      sum += RING_AT(&ring, uns64, ii);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ring_lib_traverse)->Arg(16)->Arg(256);
+
+/**************************************************************************************/
+/* malloc_lib */
+
+static void BM_malloc_lib(benchmark::State& state) {
+  static const int sizes[] = {16, 24, 64, 96, 128, 256};
+  void* items[64];
+  for (auto _ : state) {
+    for (int ii = 0; ii < 64; ii++)
+      items[ii] = smalloc(sizes[ii % 6]);
+    for (int ii = 0; ii < 64; ii++)
+      sfree(sizes[ii % 6], items[ii]);
+  }
+  state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_malloc_lib);
+
+/**************************************************************************************/
+/* bloom_filter */
+
+static void BM_bloom_filter(benchmark::State& state) {
+  bloom_parameters parameters;
+  parameters.projected_element_count = state.range(0);
+  parameters.false_positive_probability = 0.005;
+  parameters.compute_optimal_parameters();
+  bloom_filter bloom(parameters);
+  std::vector<Addr> addrs = make_l1_stream(1 << 16);
+  uns ii = 0;
+  for (auto _ : state) {
+    Addr line = addrs[ii] >> 6;
+    if (!bloom.contains(line))
+      bloom.insert(line);
+    ii = (ii + 1) & ((1 << 16) - 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_bloom_filter)->Arg(1024)->Arg(16384);
+
+/**************************************************************************************/
+
+int main(int argc, char** argv) {
+  std::vector<char*> args;
+  for (int ii = 0; ii < argc; ii++) {
+    const char* prefix = "--cache_accesses=";
+    if (strncmp(argv[ii], prefix, strlen(prefix)))
+      args.push_back(argv[ii]);
+    else {
+      std::string file = argv[ii] + strlen(prefix);
+      benchmark::RegisterBenchmark(("BM_cache_lib_replay/" + file).c_str(), BM_cache_lib_replay, file);
+    }
+  }
+  int num_args = args.size();
+  benchmark::Initialize(&num_args, args.data());
+  if (benchmark::ReportUnrecognizedArguments(num_args, args.data()))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
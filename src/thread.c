@@ -66,7 +66,8 @@ void set_thread_data(Thread_Data* new_td) {
 void init_thread(Thread_Data* td, char* argv[], char* envp[]) {
   set_map_data(&td->map_data);
   init_map(0);
-  init_list(&td->seq_op_list, "SEQ_OP_LIST", sizeof(Op*), TRUE);
+  init_ring(&td->seq_op_list, "SEQ_OP_LIST", sizeof(Op*), 256);
+  td->seq_op_squash_count = 0;
 }
 
 /**************************************************************************************/
@@ -86,7 +87,7 @@ void add_to_seq_op_list(Thread_Data* td, Op* op) {
   ASSERT(td->proc_id, op);
   ASSERT(td->proc_id, td->proc_id == op->proc_id);
   ASSERT(td->proc_id, op->op_pool_valid);
-  op_p = dl_list_add_tail(&td->seq_op_list);
+  op_p = ring_add_tail(&td->seq_op_list);
   *op_p = op;
   DEBUG(td->proc_id, "Adding to seq op list  op:%s  count:%d\n", unsstr64(op->op_num), td->seq_op_list.count);
   ASSERT(td->proc_id, (td->seq_op_list.count < 8193));
@@ -96,7 +97,7 @@ void add_to_seq_op_list(Thread_Data* td, Op* op) {
 /* remove_from_seq_op_list: */
 
 void remove_from_seq_op_list(Thread_Data* td, Op* op) {
-  Op** op_p = dl_list_remove_head(&td->seq_op_list);
+  Op** op_p = ring_remove_head(&td->seq_op_list);
   ASSERT(td->proc_id, op_p);
   ASSERT(td->proc_id, td->proc_id == (*op_p)->proc_id);
   ASSERT(td->proc_id, *op_p);
@@ -111,26 +112,39 @@ void remove_from_seq_op_list(Thread_Data* td, Op* op) {
 /* recover_seq_op_list: */
 
 void recover_seq_op_list(Thread_Data* td, Counter op_num) {
-  // Traverse the sequential op list and remove everything younger than the
-  // recovering op
-  Op** op_p = (Op**)list_start_head_traversal(&td->seq_op_list);
-  if (op_p) {
-    ASSERT(td->proc_id, *op_p);
-    ASSERT(td->proc_id, td->proc_id == (*op_p)->proc_id);
-    if ((*op_p)->op_num > op_num) {
-      ASSERTM(td->proc_id, (*op_p)->op_num == op_num + 1, "Oldest in-flight op_num:%lld, recovery op_num:%lld\n",
-              (*op_p)->op_num, op_num + 1);
-      clear_list(&td->seq_op_list);
+  // Remove everything younger than the recovering op. The list is sorted by
+  // op_num, so the boundary is found by position instead of by a traversal;
+  // the removed ops stay readable through seq_op_list_squashed.
+  Ring* list = &td->seq_op_list;
+  int keep = 0;
+  if (list->count) {
+    Op* oldest = RING_AT(list, Op*, 0);
+    ASSERT(td->proc_id, oldest);
+    ASSERT(td->proc_id, td->proc_id == oldest->proc_id);
+    if (oldest->op_num > op_num) {
+      ASSERTM(td->proc_id, oldest->op_num == op_num + 1, "Oldest in-flight op_num:%lld, recovery op_num:%lld\n",
+              oldest->op_num, op_num + 1);
     } else {
-      for (; op_p; op_p = (Op**)list_next_element(&td->seq_op_list)) {
-        ASSERT(td->proc_id, (*op_p)->op_num <= op_num);
-        if ((*op_p)->op_num == op_num) {
-          clip_list_at_current(&td->seq_op_list);
-          break;
+      // op_nums are normally consecutive in the list, fall back to a binary search if not
+      Counter guess = op_num - oldest->op_num;
+      if (guess < list->count && RING_AT(list, Op*, guess)->op_num == op_num) {
+        keep = guess + 1;
+      } else {
+        int lo = 0, hi = list->count;
+        while (lo < hi) {
+          int mid = (lo + hi) / 2;
+          if (RING_AT(list, Op*, mid)->op_num <= op_num)
+            lo = mid + 1;
+          else
+            hi = mid;
         }
+        keep = lo;
       }
+      ASSERT(td->proc_id, RING_AT(list, Op*, keep - 1)->op_num == op_num);
     }
   }
+  td->seq_op_squash_count = list->count - keep;
+  ring_clip(list, keep);
 
   DEBUG(td->proc_id, "Recovering seq op list  op:%s  count:%d\n", unsstr64(op_num), td->seq_op_list.count);
 }
@@ -163,7 +177,7 @@ void thread_map_mem_dep(Op* op) {
 /* remove_next_from_seq_op_list: */
 
 Op* remove_next_from_seq_op_list(Thread_Data* td) {
-  Op** op_p = dl_list_remove_head(&td->seq_op_list);
+  Op** op_p = ring_remove_head(&td->seq_op_list);
   DEBUG(td->proc_id, "Removing op from seq op list  op:%s  count:%d\n", unsstr64((*op_p)->op_num),
         td->seq_op_list.count);
   return *op_p;
@@ -174,12 +188,13 @@ Op* remove_next_from_seq_op_list(Thread_Data* td) {
 
 void reset_seq_op_list(Thread_Data* td) {
   // Traverse the sequential op list and remove and free every op
-  Op** op_p = (Op**)list_start_head_traversal(&td->seq_op_list);
-  for (; op_p; op_p = (Op**)list_next_element(&td->seq_op_list)) {
-    ASSERT(td->proc_id, td->proc_id == (*op_p)->proc_id);
-    ft_free_op(*op_p);
+  for (int ii = 0; ii < td->seq_op_list.count; ii++) {
+    Op* op = RING_AT(&td->seq_op_list, Op*, ii);
+    ASSERT(td->proc_id, td->proc_id == op->proc_id);
+    ft_free_op(op);
   }
-  clear_list(&td->seq_op_list);
+  ring_clear(&td->seq_op_list);
+  td->seq_op_squash_count = 0;
 
   DEBUG(td->proc_id, "Reseting seq op list   count:%d\n", td->seq_op_list.count);
 }
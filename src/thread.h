@@ -32,6 +32,7 @@
 #include "globals/global_types.h"
 
 #include "libs/list_lib.h"
+#include "libs/ring_lib.h"
 
 #include "map.h"
 
@@ -57,7 +58,8 @@ typedef struct Thread_Info_struct {
 typedef struct Thread_struct {
   uns8 proc_id;
   Map_Data map_data;
-  List seq_op_list;
+  Ring seq_op_list;
+  int seq_op_squash_count; /* ops the last recover_seq_op_list removed, see seq_op_list_squashed */
   ///////////////////////////////////////////////////
   // Pipeline Gating
   Thread_Info td_info;
@@ -67,7 +69,7 @@ typedef struct Thread_struct {
 /**************************************************************************************/
 /* External variables */
 
-extern Thread_Data* td; /* here for now, variable declared in sim.c */
+extern CORE_LOCAL Thread_Data* td; /* here for now, variable declared in sim.c */
 /* if we ever go MT, this will turn into an array */
 
 /**************************************************************************************/
@@ -84,6 +86,12 @@ void recover_seq_op_list(Thread_Data*, Counter);
 Op* remove_next_from_seq_op_list(Thread_Data*);
 void reset_seq_op_list(Thread_Data*);
 
+/* seq_op_list_squashed: the ii-th oldest op the last recovery removed from the
+   seq op list (0 <= ii < seq_op_squash_count, valid until the next add) */
+static inline Op* seq_op_list_squashed(Thread_Data* td, int ii) {
+  return *(Op**)ring_at(&td->seq_op_list, td->seq_op_list.count + ii);
+}
+
 /**************************************************************************************/
 
 #endif /* #ifndef __THREAD_H__ */
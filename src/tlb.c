@@ -0,0 +1,356 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : tlb.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : L1 DTLB/ITLB, unified STLB, paging-structure caches and page walks
+ *                through the cache hierarchy (TLB_ON)
+ ***************************************************************************************/
+
+/* Every core has an L1 DTLB and ITLB with one array per page size, and a unified STLB
+   shared by all page sizes. Traces carry no page sizes, so each 1G (2M) region of the
+   address space is backed by a huge page with probability TLB_1G_PAGE_PCT
+   (TLB_2M_PAGE_PCT), decided by a hash of the region.
+
+   An STLB miss starts a walk of a four-level x86-64 page table. The paging-structure
+   caches hold PML4, PDPT and PD entries, so a walk starts at the deepest level they
+   cover. Every remaining level reads its entry through the dcache like a load, with a
+   new_mem_req() on a dcache miss. The page tables are laid out linearly per level in a
+   region of their own, so the entries of neighboring pages share cache lines.
+
+   An entry that is being filled is inserted right away with the cycle it becomes ready
+   (MAX_CTR while a walk is in flight), so the retries of an op that missed hit it and
+   do not count as misses again. */
+
+#include "tlb.h"
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "debug/debug.param.h"
+#include "debug/debug_macros.h"
+
+#include "core.param.h"
+#include "memory/memory.param.h"
+
+#include "libs/cache_lib.h"
+#include "memory/memory.h"
+#include "cmp_model.h"
+#include "dcache_stage.h"
+#include "statistics.h"
+
+/**************************************************************************************/
+/* Macros */
+
+#define DEBUG(proc_id, args...) _DEBUG(proc_id, DEBUG_ADDR_TRANS, ##args)
+
+#define TLB_NUM_PAGE_SIZES 3 /* 4K, 2M, 1G */
+#define TLB_NUM_LEVELS 4     /* PT, PD, PDPT, PML4 */
+#define TLB_KEY_BITS 3       /* the arrays index page numbers as 8-byte "lines" */
+/* virtual address bits covered by the page table */
+#define TLB_VA_BITS 48
+/* base of the region holding the page tables (the upper half of the 48-bit space), one
+   1TB window per level */
+#define TLB_PT_BASE (1ULL << 47)
+#define TLB_PT_LEVEL_SPAN_BITS 40
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Tlb_Entry_struct {
+  Counter rdy_cycle; /* MAX_CTR while the walk that fills it is in flight */
+} Tlb_Entry;
+
+typedef struct Tlb_Walk_struct {
+  Flag valid;
+  Flag issued;       /* the read of the current level has been sent */
+  Addr va;
+  uns page_size;     /* 0: 4K, 1: 2M, 2: 1G */
+  uns level;         /* level being read, 1 (PT) to 4 (PML4) */
+  Addr pte_line;     /* dcache line holding the entry being read */
+  Counter rdy_cycle; /* cycle the entry arrives, MAX_CTR while it is in memory */
+  Counter start_cycle;
+} Tlb_Walk;
+
+typedef struct Tlb_struct {
+  Cache dtlb[TLB_NUM_PAGE_SIZES];
+  Cache itlb[TLB_NUM_PAGE_SIZES];
+  Cache stlb;
+  Cache psc[TLB_NUM_LEVELS + 1]; /* [2..4]: PD, PDPT and PML4 entry caches */
+  Tlb_Walk* walks;               /* TLB_PAGE_WALKERS */
+} Tlb;
+
+/**************************************************************************************/
+/* Global variables */
+
+static Tlb* tlbs = NULL;
+
+static const uns tlb_page_bits[TLB_NUM_PAGE_SIZES] = {12, 21, 30};
+
+/**************************************************************************************/
+/* Local prototypes */
+
+static void tlb_init_array(Cache* cache, const char* name, uns8 proc_id, uns entries, uns assoc);
+static uns tlb_page_size(Addr va);
+static inline Addr tlb_key(Addr va, uns shift, uns page_size);
+static Addr tlb_pte_addr(uns8 proc_id, Addr va, uns level);
+static void tlb_fill(Cache* cache, uns8 proc_id, Addr key, Counter rdy_cycle);
+static void tlb_walk_start(uns8 proc_id, Tlb_Walk* walk, Addr va, uns page_size);
+static void tlb_walk_issue(uns8 proc_id, Tlb_Walk* walk);
+static void tlb_walk_done(uns8 proc_id, Tlb_Walk* walk);
+static Flag tlb_walk_fill_line(Mem_Req* req);
+
+/**************************************************************************************/
+/* tlb_init_array: */
+
+static void tlb_init_array(Cache* cache, const char* name, uns8 proc_id, uns entries, uns assoc) {
+  char buf[MAX_STR_LENGTH + 1];
+  ASSERTM(proc_id, entries > 0, "%s needs entries\n", name);
+  assoc = MIN2(assoc, entries);
+  snprintf(buf, MAX_STR_LENGTH, "%s_%u", name, proc_id);
+  init_cache(cache, buf, entries << TLB_KEY_BITS, assoc, 1 << TLB_KEY_BITS, sizeof(Tlb_Entry), REPL_TRUE_LRU);
+}
+
+/**************************************************************************************/
+/* init_tlb: */
+
+void init_tlb(uns8 proc_id) {
+  if (!TLB_ON)
+    return;
+  if (!tlbs)
+    tlbs = (Tlb*)calloc(NUM_CORES, sizeof(Tlb));
+  ASSERTM(proc_id, TLB_PAGE_WALKERS > 0, "TLB_PAGE_WALKERS must be positive\n");
+
+  Tlb* tlb = &tlbs[proc_id];
+  tlb_init_array(&tlb->dtlb[0], "DTLB_4K", proc_id, DTLB_4K_ENTRIES, DTLB_ASSOC);
+  tlb_init_array(&tlb->dtlb[1], "DTLB_2M", proc_id, DTLB_2M_ENTRIES, DTLB_ASSOC);
+  tlb_init_array(&tlb->dtlb[2], "DTLB_1G", proc_id, DTLB_1G_ENTRIES, DTLB_ASSOC);
+  tlb_init_array(&tlb->itlb[0], "ITLB_4K", proc_id, ITLB_4K_ENTRIES, ITLB_ASSOC);
+  tlb_init_array(&tlb->itlb[1], "ITLB_2M", proc_id, ITLB_2M_ENTRIES, ITLB_ASSOC);
+  tlb_init_array(&tlb->itlb[2], "ITLB_1G", proc_id, ITLB_1G_ENTRIES, ITLB_ASSOC);
+  tlb_init_array(&tlb->stlb, "STLB", proc_id, STLB_ENTRIES, STLB_ASSOC);
+  tlb_init_array(&tlb->psc[2], "PDE_CACHE", proc_id, TLB_PDE_CACHE_ENTRIES, TLB_PSC_ASSOC);
+  tlb_init_array(&tlb->psc[3], "PDPTE_CACHE", proc_id, TLB_PDPTE_CACHE_ENTRIES, TLB_PSC_ASSOC);
+  tlb_init_array(&tlb->psc[4], "PML4E_CACHE", proc_id, TLB_PML4E_CACHE_ENTRIES, TLB_PSC_ASSOC);
+  tlb->walks = (Tlb_Walk*)calloc(TLB_PAGE_WALKERS, sizeof(Tlb_Walk));
+}
+
+/**************************************************************************************/
+/* tlb_page_size: */
+
+static uns tlb_page_size(Addr va) {
+  Addr region = convert_to_cmp_addr(0, va);
+  if (TLB_1G_PAGE_PCT && (uns)(((region >> 30) * 0x9E3779B97F4A7C15ULL) >> 32) % 100 < TLB_1G_PAGE_PCT)
+    return 2;
+  if (TLB_2M_PAGE_PCT && (uns)(((region >> 21) * 0x9E3779B97F4A7C15ULL) >> 32) % 100 < TLB_2M_PAGE_PCT)
+    return 1;
+  return 0;
+}
+
+/**************************************************************************************/
+/* tlb_key: the arrays index va >> shift; the STLB also tags entries with their page size */
+
+static inline Addr tlb_key(Addr va, uns shift, uns page_size) {
+  return ((va >> shift) | ((Addr)page_size << (64 - TLB_KEY_BITS - 2))) << TLB_KEY_BITS;
+}
+
+/**************************************************************************************/
+/* tlb_pte_addr: address of the entry of va at level, in the address space of proc_id */
+
+static Addr tlb_pte_addr(uns8 proc_id, Addr va, uns level) {
+  Addr index = (va & N_BIT_MASK(TLB_VA_BITS)) >> (tlb_page_bits[0] + 9 * (level - 1));
+  Addr table = TLB_PT_BASE + ((Addr)(level - 1) << TLB_PT_LEVEL_SPAN_BITS);
+  return convert_to_cmp_addr(proc_id, table + index * 8);
+}
+
+/**************************************************************************************/
+/* tlb_fill: insert (or update) an entry */
+
+static void tlb_fill(Cache* cache, uns8 proc_id, Addr key, Counter rdy_cycle) {
+  Addr line_addr, repl_line_addr;
+  Tlb_Entry* entry = (Tlb_Entry*)cache_access(cache, key, &line_addr, FALSE);
+  if (!entry)
+    entry = (Tlb_Entry*)cache_insert(cache, proc_id, key, &line_addr, &repl_line_addr);
+  entry->rdy_cycle = rdy_cycle;
+}
+
+/**************************************************************************************/
+/* tlb_translate: */
+
+Flag tlb_translate(uns8 proc_id, Addr va, Flag inst) {
+  Tlb* tlb = &tlbs[proc_id];
+  uns page_size = tlb_page_size(va);
+  uns shift = tlb_page_bits[page_size];
+  Cache* l1_tlb = inst ? &tlb->itlb[page_size] : &tlb->dtlb[page_size];
+  Addr line_addr;
+
+  Tlb_Entry* entry = (Tlb_Entry*)cache_access(l1_tlb, tlb_key(va, shift, 0), &line_addr, TRUE);
+  if (entry)
+    return entry->rdy_cycle <= cycle_count;
+
+  Counter rdy_cycle;
+  Tlb_Entry* stlb_entry = (Tlb_Entry*)cache_access(&tlb->stlb, tlb_key(va, shift, page_size), &line_addr, TRUE);
+  if (stlb_entry) {
+    rdy_cycle = stlb_entry->rdy_cycle == MAX_CTR ? MAX_CTR : MAX2(stlb_entry->rdy_cycle, cycle_count + STLB_CYCLES);
+  } else {
+    Tlb_Walk* walk = NULL;
+    for (uns ii = 0; ii < TLB_PAGE_WALKERS && !walk; ii++)
+      if (!tlb->walks[ii].valid)
+        walk = &tlb->walks[ii];
+    if (!walk) {
+      STAT_EVENT(proc_id, TLB_WALKERS_FULL);
+      return FALSE;
+    }
+    STAT_EVENT(proc_id, STLB_MISS);
+    rdy_cycle = MAX_CTR;
+    tlb_fill(&tlb->stlb, proc_id, tlb_key(va, shift, page_size), MAX_CTR);
+    tlb_walk_start(proc_id, walk, va, page_size);
+  }
+
+  STAT_EVENT(proc_id, inst ? ITLB_MISS : DTLB_MISS);
+  STAT_EVENT(proc_id, inst ? POWER_ITLB_MISS : POWER_DTLB_MISS);
+  tlb_fill(l1_tlb, proc_id, tlb_key(va, shift, 0), rdy_cycle);
+  return FALSE;
+}
+
+/**************************************************************************************/
+/* tlb_walk_start: */
+
+static void tlb_walk_start(uns8 proc_id, Tlb_Walk* walk, Addr va, uns page_size) {
+  Tlb* tlb = &tlbs[proc_id];
+  Addr line_addr;
+
+  walk->valid = TRUE;
+  walk->va = va;
+  walk->page_size = page_size;
+  walk->start_cycle = cycle_count;
+  walk->level = TLB_NUM_LEVELS;
+  // the deepest paging-structure cache that covers va skips the levels above it
+  for (uns level = page_size + 2; level <= TLB_NUM_LEVELS; level++) {
+    uns shift = tlb_page_bits[0] + 9 * (level - 1);
+    if (cache_access(&tlb->psc[level], tlb_key(va, shift, 0), &line_addr, TRUE)) {
+      walk->level = level - 1;
+      STAT_EVENT(proc_id, TLB_PSC_HIT);
+      break;
+    }
+  }
+  DEBUG(proc_id, "Page walk  va:0x%s  page:%u  starts at level %u\n", hexstr64s(va), page_size, walk->level);
+  tlb_walk_issue(proc_id, walk);
+}
+
+/**************************************************************************************/
+/* tlb_walk_issue: read the entry of the current level through the dcache */
+
+static void tlb_walk_issue(uns8 proc_id, Tlb_Walk* walk) {
+  Cache* dcache = &cmp_model.dcache_stage[proc_id].dcache;
+  Addr pte_addr = tlb_pte_addr(proc_id, walk->va, walk->level);
+  Addr line_addr;
+
+  walk->pte_line = pte_addr & ~N_BIT_MASK(LOG2(DCACHE_LINE_SIZE));
+  if (cache_access(dcache, pte_addr, &line_addr, TRUE)) {
+    walk->issued = TRUE;
+    walk->rdy_cycle = cycle_count + DCACHE_CYCLES;
+  } else if (new_mem_req(MRT_DFETCH, proc_id, walk->pte_line, DCACHE_LINE_SIZE, 0, NULL, tlb_walk_fill_line,
+                         unique_count, 0)) {
+    walk->issued = TRUE;
+    walk->rdy_cycle = MAX_CTR;
+    STAT_EVENT(proc_id, TLB_WALK_DCACHE_MISS);
+  } else {
+    walk->issued = FALSE;
+  }
+  STAT_EVENT(proc_id, TLB_WALK_MEM_ACCESS);
+}
+
+/**************************************************************************************/
+/* tlb_walk_fill_line: done_func of the page-table reads */
+
+static Flag tlb_walk_fill_line(Mem_Req* req) {
+  if (!dcache_fill_line(req))
+    return FALSE;
+  Tlb* tlb = &tlbs[req->proc_id];
+  for (uns ii = 0; ii < TLB_PAGE_WALKERS; ii++) {
+    Tlb_Walk* walk = &tlb->walks[ii];
+    if (walk->valid && walk->issued && walk->rdy_cycle == MAX_CTR && walk->pte_line == req->addr)
+      walk->rdy_cycle = freq_cycle_count(FREQ_DOMAIN_CORES[req->proc_id]);
+  }
+  return TRUE;
+}
+
+/**************************************************************************************/
+/* tlb_walk_done: */
+
+static void tlb_walk_done(uns8 proc_id, Tlb_Walk* walk) {
+  Tlb* tlb = &tlbs[proc_id];
+  uns shift = tlb_page_bits[walk->page_size];
+  Addr line_addr;
+
+  tlb_fill(&tlb->stlb, proc_id, tlb_key(walk->va, shift, walk->page_size), cycle_count);
+  // wake the L1 entries still waiting for this walk
+  Tlb_Entry* entry = (Tlb_Entry*)cache_access(&tlb->dtlb[walk->page_size], tlb_key(walk->va, shift, 0), &line_addr,
+                                              FALSE);
+  if (entry && entry->rdy_cycle == MAX_CTR)
+    entry->rdy_cycle = cycle_count;
+  entry = (Tlb_Entry*)cache_access(&tlb->itlb[walk->page_size], tlb_key(walk->va, shift, 0), &line_addr, FALSE);
+  if (entry && entry->rdy_cycle == MAX_CTR)
+    entry->rdy_cycle = cycle_count;
+
+  INC_STAT_EVENT(proc_id, TLB_WALK_CYCLES, cycle_count - walk->start_cycle);
+  DEBUG(proc_id, "Page walk  va:0x%s  done after %s cycles\n", hexstr64s(walk->va),
+        unsstr64(cycle_count - walk->start_cycle));
+  walk->valid = FALSE;
+}
+
+/**************************************************************************************/
+/* update_tlb: */
+
+void update_tlb(uns8 proc_id) {
+  Tlb* tlb = &tlbs[proc_id];
+  Cache* dcache = &cmp_model.dcache_stage[proc_id].dcache;
+  Addr line_addr;
+
+  for (uns ii = 0; ii < TLB_PAGE_WALKERS; ii++) {
+    Tlb_Walk* walk = &tlb->walks[ii];
+    if (!walk->valid)
+      continue;
+    if (!walk->issued) {
+      tlb_walk_issue(proc_id, walk);
+      continue;
+    }
+    // a read merged into another request is filled by that request's done_func
+    if (walk->rdy_cycle == MAX_CTR && cache_access(dcache, walk->pte_line, &line_addr, FALSE))
+      walk->rdy_cycle = cycle_count;
+    if (walk->rdy_cycle > cycle_count)
+      continue;
+    if (walk->level == walk->page_size + 1) {
+      tlb_walk_done(proc_id, walk);
+      continue;
+    }
+    tlb_fill(&tlb->psc[walk->level], proc_id, tlb_key(walk->va, tlb_page_bits[0] + 9 * (walk->level - 1), 0),
+             cycle_count);
+    walk->level--;
+    tlb_walk_issue(proc_id, walk);
+  }
+}
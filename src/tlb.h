@@ -0,0 +1,49 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/***************************************************************************************
+ * File         : tlb.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : L1 DTLB/ITLB, unified STLB, paging-structure caches and page walks
+ *                through the cache hierarchy (TLB_ON)
+ ***************************************************************************************/
+
+#ifndef __TLB_H__
+#define __TLB_H__
+
+#include "globals/global_types.h"
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Build the TLBs of a core */
+void init_tlb(uns8 proc_id);
+
+/* Advance the page walks of a core (call every core cycle) */
+void update_tlb(uns8 proc_id);
+
+/* TRUE if the translation of va is available this cycle; otherwise an STLB lookup or a
+   page walk is started and the caller retries */
+Flag tlb_translate(uns8 proc_id, Addr va, Flag inst);
+
+#endif /* #ifndef __TLB_H__ */
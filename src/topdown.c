@@ -37,16 +37,112 @@
 #include "globals/global_vars.h"
 #include "globals/utils.h"
 
+#include "core.param.h"
+#include "general.param.h"
+
 #include "dcache_stage.h"
 #include "idq_stage.h"
 #include "lsq.h"
 #include "map_stage.h"
 #include "node_stage.h"
 #include "op.h"
+#include "statistics.h"
 
 const static uns64 TOPDOWN_SCALE_FACTOR = 10000;
 const static int TOPDOWN_RECOVERY_DEPTH = 2;
 
+#define TOPDOWN_NUM_EVENTS (TOPDOWN_MACHINE_CLEAR_CYCLES - TOPDOWN_TOTAL_SLOTS + 1)
+#define TOPDOWN_NUM_METRICS (TOPDOWN_MACHINE_CLEARS_BOUND - TOPDOWN_FRONTEND_BOUND + 1)
+#define TD_EV(stat) ((stat) - TOPDOWN_TOTAL_SLOTS)
+#define TD_MET(stat) ((stat) - TOPDOWN_FRONTEND_BOUND)
+
+#define TOPDOWN_BIN_MAGIC "SCARTDN"
+#define TOPDOWN_BIN_VERSION 1
+
+/*
+ * The stage hooks below run every cycle, so they only bump plain counters in a
+ * per-core record. The record is folded into the TOPDOWN stats (and into the
+ * current interval) lazily by topdown_flush, which runs before the stats are
+ * read, dumped or cleared and at every topdown_interval boundary.
+ */
+typedef struct Topdown_Data_struct {
+  uns64 pending[TOPDOWN_NUM_EVENTS];  /* events not yet folded into the stats */
+  uns64 interval[TOPDOWN_NUM_EVENTS]; /* events of the current interval */
+  uns64 pending_cycles;
+  uns64 interval_cycles;
+  Counter interval_start_inst;
+  FILE* file; /* per-interval dump, NULL when TOPDOWN_INTERVAL is 0 */
+} Topdown_Data;
+
+/* one per-interval record of the binary dump */
+typedef struct Topdown_Record_struct {
+  uns64 cycle; /* last core cycle of the interval */
+  uns64 insts; /* instructions retired in the interval */
+  uns64 slots; /* issue slots of the interval */
+  int32 metrics[TOPDOWN_NUM_METRICS]; /* TOPDOWN_FRONTEND_BOUND.. order, in 1/TOPDOWN_SCALE_FACTOR */
+} Topdown_Record;
+
+static Topdown_Data* topdown_data = NULL;
+
+static void topdown_reduce(const uns64* ev, uns64 cycles, uns64* metrics);
+static void topdown_end_interval(uns proc_id);
+
+/**************************************************************************************/
+/* Init / Flush */
+
+void topdown_init(uns proc_id) {
+  if (!topdown_data)
+    topdown_data = calloc(NUM_CORES, sizeof(Topdown_Data));
+  Topdown_Data* td = &topdown_data[proc_id];
+  memset(td, 0, sizeof(Topdown_Data));
+
+  if (TOPDOWN_INTERVAL) {
+    char name[MAX_STR_LENGTH + 1];
+    snprintf(name, MAX_STR_LENGTH, "%s%s.%u.bin", FILE_TAG, TOPDOWN_FILE, proc_id);
+    td->file = fopen(name, "wb");
+    ASSERTM(proc_id, td->file, "Could not open %s\n", name);
+    uns32 header[4] = {TOPDOWN_BIN_VERSION, proc_id, ISSUE_WIDTH, TOPDOWN_NUM_METRICS};
+    fwrite(TOPDOWN_BIN_MAGIC, 1, 8, td->file);
+    fwrite(header, sizeof(header), 1, td->file);
+  }
+}
+
+void topdown_flush(uns proc_id) {
+  if (!topdown_data)
+    return;
+  Topdown_Data* td = &topdown_data[proc_id];
+  for (uns ii = 0; ii < TOPDOWN_NUM_EVENTS; ii++) {
+    INC_STAT_EVENT(proc_id, TOPDOWN_TOTAL_SLOTS + ii, td->pending[ii]);
+    td->interval[ii] += td->pending[ii];
+  }
+  td->interval_cycles += td->pending_cycles;
+  memset(td->pending, 0, sizeof(td->pending));
+  td->pending_cycles = 0;
+}
+
+static void topdown_end_interval(uns proc_id) {
+  Topdown_Data* td = &topdown_data[proc_id];
+  topdown_flush(proc_id);
+  if (!td->interval_cycles)
+    return;
+
+  uns64 metrics[TOPDOWN_NUM_METRICS];
+  topdown_reduce(td->interval, td->interval_cycles, metrics);
+
+  Topdown_Record rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.cycle = cycle_count;
+  rec.insts = inst_count[proc_id] - td->interval_start_inst;
+  rec.slots = td->interval[TD_EV(TOPDOWN_TOTAL_SLOTS)];
+  for (uns ii = 0; ii < TOPDOWN_NUM_METRICS; ii++)
+    rec.metrics[ii] = (int32)(int64)metrics[ii];
+  fwrite(&rec, sizeof(rec), 1, td->file);
+
+  memset(td->interval, 0, sizeof(td->interval));
+  td->interval_cycles = 0;
+  td->interval_start_inst = inst_count[proc_id];
+}
+
 /**************************************************************************************/
 /* Events Update */
 
@@ -77,56 +173,63 @@ const static int TOPDOWN_RECOVERY_DEPTH = 2;
 
 void topdown_bp_recovery(uns proc_id, Op* op) {
   ASSERT(op->proc_id, op->table_info->cf_type);
+  uns64* ev = topdown_data[proc_id].pending;
 
-  STAT_EVENT(proc_id, TOPDOWN_MACHINE_CLEAR_CYCLES);
+  ev[TD_EV(TOPDOWN_MACHINE_CLEAR_CYCLES)]++;
   if (op->oracle_info.recover_at_exec) {
     ASSERT(op->proc_id, !op->off_path);
-    STAT_EVENT(proc_id, TOPDOWN_BR_MISPRED_RETIRED_CYCLES);
+    ev[TD_EV(TOPDOWN_BR_MISPRED_RETIRED_CYCLES)]++;
   }
 
   idq_stage_set_recovery_cycle(TOPDOWN_RECOVERY_DEPTH);
 }
 
 void topdown_idq_update(uns proc_id, int count_available, int count_issued, int count_issued_on_path) {
-  INC_STAT_EVENT(proc_id, TOPDOWN_TOTAL_SLOTS, ISSUE_WIDTH);
-  INC_STAT_EVENT(proc_id, TOPDOWN_ISSUED_SLOTS, count_issued);
-  INC_STAT_EVENT(proc_id, TOPDOWN_RETIRED_SLOTS, count_issued_on_path);
+  Topdown_Data* td = &topdown_data[proc_id];
+  if (td->file && td->interval_cycles + td->pending_cycles >= TOPDOWN_INTERVAL)
+    topdown_end_interval(proc_id);
+
+  uns64* ev = td->pending;
+  td->pending_cycles++;
+  ev[TD_EV(TOPDOWN_TOTAL_SLOTS)] += ISSUE_WIDTH;
+  ev[TD_EV(TOPDOWN_ISSUED_SLOTS)] += count_issued;
+  ev[TD_EV(TOPDOWN_RETIRED_SLOTS)] += count_issued_on_path;
 
   int recovery_cycle = idq_stage_get_recovery_cycle();
   if (recovery_cycle != 0) {
     ASSERT(proc_id, recovery_cycle > 0);
     idq_stage_set_recovery_cycle(recovery_cycle - 1);
-    INC_STAT_EVENT(proc_id, TOPDOWN_RECOVERY_BUBBLES_SLOTS, ISSUE_WIDTH - count_available);
+    ev[TD_EV(TOPDOWN_RECOVERY_BUBBLES_SLOTS)] += ISSUE_WIDTH - count_available;
     return;
   }
 
   // only increment frontend-stall when there is no backend-stall
   if (count_issued == 0 && idq_stage_get_stage_data()->op_count > 0) {
-    STAT_EVENT(proc_id, TOPDOWN_BACKEND_STALLS_CYCLES);
+    ev[TD_EV(TOPDOWN_BACKEND_STALLS_CYCLES)]++;
     if (lsq_get_in_flight_load_num() > 0) {
-      STAT_EVENT(proc_id, TOPDOWN_MEM_LOAD_STALLS_CYCLES);
+      ev[TD_EV(TOPDOWN_MEM_LOAD_STALLS_CYCLES)]++;
     } else if (!lsq_available(MEM_ST)) {
-      STAT_EVENT(proc_id, TOPDOWN_MEM_STORE_STALLS_CYCLES);
+      ev[TD_EV(TOPDOWN_MEM_STORE_STALLS_CYCLES)]++;
     }
     return;
   }
 
-  INC_STAT_EVENT(proc_id, TOPDOWN_FETCH_BUBBLES_SLOTS, ISSUE_WIDTH - count_available);
+  ev[TD_EV(TOPDOWN_FETCH_BUBBLES_SLOTS)] += ISSUE_WIDTH - count_available;
   if (count_available == 0)
-    STAT_EVENT(proc_id, TOPDOWN_FETCH_BUBBLES_GT_MIW_CYCLES);
+    ev[TD_EV(TOPDOWN_FETCH_BUBBLES_GT_MIW_CYCLES)]++;
 }
 
 void topdown_exec_update(uns proc_id, uns8 fus_busy) {
   if (fus_busy <= TOPDOWN_FU_EXEC_FEW && node->node_count != 0) {
-    STAT_EVENT(proc_id, TOPDOWN_EXEC_STALLS_CYCLES);
+    topdown_data[proc_id].pending[TD_EV(TOPDOWN_EXEC_STALLS_CYCLES)]++;
   }
 }
 
 /**************************************************************************************/
 /*
  * Metrics Update
- *  At the end of simulation, the events can be directly used to calculate the
- *  metrics using the following formulas.
+ *  At the end of simulation, and of every topdown_interval, the events can be
+ *  directly used to calculate the metrics using the following formulas.
  */
 
 /*
@@ -161,58 +264,69 @@ void topdown_exec_update(uns proc_id, uns8 fus_busy) {
  * MEM Latency          = (ExtMemOutstanding[≥ 1] / Clocks) - MEM Bandwidth
  */
 
-void topdown_done(uns proc_id) {
-  /* Top-Level Breakdown */
-  uns64 frontend_bound = GET_STAT_EVENT(proc_id, TOPDOWN_FETCH_BUBBLES_SLOTS) * TOPDOWN_SCALE_FACTOR /
-                         GET_STAT_EVENT(proc_id, TOPDOWN_TOTAL_SLOTS);
-  INC_STAT_EVENT(proc_id, TOPDOWN_FRONTEND_BOUND, frontend_bound);
-
-  uns64 bad_spec_slots = GET_STAT_EVENT(proc_id, TOPDOWN_ISSUED_SLOTS) -
-                         GET_STAT_EVENT(proc_id, TOPDOWN_RETIRED_SLOTS) +
-                         GET_STAT_EVENT(proc_id, TOPDOWN_RECOVERY_BUBBLES_SLOTS);
-  uns64 bad_spec_bound = bad_spec_slots * TOPDOWN_SCALE_FACTOR / GET_STAT_EVENT(proc_id, TOPDOWN_TOTAL_SLOTS);
-  INC_STAT_EVENT(proc_id, TOPDOWN_BAD_SPEC_BOUND, bad_spec_bound);
-
-  uns64 retiring_bound = GET_STAT_EVENT(proc_id, TOPDOWN_RETIRED_SLOTS) * TOPDOWN_SCALE_FACTOR /
-                         GET_STAT_EVENT(proc_id, TOPDOWN_TOTAL_SLOTS);
-  INC_STAT_EVENT(proc_id, TOPDOWN_RETIRING_BOUND, retiring_bound);
+static void topdown_reduce(const uns64* ev, uns64 cycles, uns64* metrics) {
+  uns64 total_slots = ev[TD_EV(TOPDOWN_TOTAL_SLOTS)];
+  ASSERT(0, total_slots != 0);
+  if (cycles == 0)
+    cycles = 1;
 
+  /* Top-Level Breakdown */
+  uns64 frontend_bound = ev[TD_EV(TOPDOWN_FETCH_BUBBLES_SLOTS)] * TOPDOWN_SCALE_FACTOR / total_slots;
+  uns64 bad_spec_slots = ev[TD_EV(TOPDOWN_ISSUED_SLOTS)] - ev[TD_EV(TOPDOWN_RETIRED_SLOTS)] +
+                         ev[TD_EV(TOPDOWN_RECOVERY_BUBBLES_SLOTS)];
+  uns64 bad_spec_bound = bad_spec_slots * TOPDOWN_SCALE_FACTOR / total_slots;
+  uns64 retiring_bound = ev[TD_EV(TOPDOWN_RETIRED_SLOTS)] * TOPDOWN_SCALE_FACTOR / total_slots;
   uns64 backend_bound = TOPDOWN_SCALE_FACTOR - frontend_bound - bad_spec_bound - retiring_bound;
-  INC_STAT_EVENT(proc_id, TOPDOWN_BACKEND_BOUND, backend_bound);
+  metrics[TD_MET(TOPDOWN_FRONTEND_BOUND)] = frontend_bound;
+  metrics[TD_MET(TOPDOWN_BAD_SPEC_BOUND)] = bad_spec_bound;
+  metrics[TD_MET(TOPDOWN_RETIRING_BOUND)] = retiring_bound;
+  metrics[TD_MET(TOPDOWN_BACKEND_BOUND)] = backend_bound;
 
   /* Backend Breakdown */
   // prevent division by zero
-  uns64 backend_stalls_cycles = GET_STAT_EVENT(proc_id, TOPDOWN_BACKEND_STALLS_CYCLES);
+  uns64 backend_stalls_cycles = ev[TD_EV(TOPDOWN_BACKEND_STALLS_CYCLES)];
   if (backend_stalls_cycles == 0) {
     backend_stalls_cycles++;
   }
 
-  uns64 mem_stalls_cycles = (GET_STAT_EVENT(proc_id, TOPDOWN_MEM_LOAD_STALLS_CYCLES) +
-                             GET_STAT_EVENT(proc_id, TOPDOWN_MEM_STORE_STALLS_CYCLES));
+  uns64 mem_stalls_cycles = ev[TD_EV(TOPDOWN_MEM_LOAD_STALLS_CYCLES)] + ev[TD_EV(TOPDOWN_MEM_STORE_STALLS_CYCLES)];
   uns64 mem_bound = backend_bound * mem_stalls_cycles / backend_stalls_cycles;
-  INC_STAT_EVENT(proc_id, TOPDOWN_MEM_BOUND, mem_bound);
-  INC_STAT_EVENT(proc_id, TOPDOWN_CORE_BOUND, backend_bound - mem_bound);
+  metrics[TD_MET(TOPDOWN_MEM_BOUND)] = mem_bound;
+  metrics[TD_MET(TOPDOWN_CORE_BOUND)] = backend_bound - mem_bound;
 
   /* Retiring Breakdown */
   // TODO: need more metadata from the simulation frontend to determine if an operand requires MicroSequencer
 
   /* Front-End Breakdown */
-  ASSERT(proc_id, GET_STAT_EVENT(proc_id, TOPDOWN_TOTAL_SLOTS) != 0);
-  uns64 latency_bound = GET_STAT_EVENT(proc_id, TOPDOWN_FETCH_BUBBLES_GT_MIW_CYCLES) * TOPDOWN_SCALE_FACTOR /
-                        GET_STAT_EVENT(proc_id, NODE_CYCLE);
-  INC_STAT_EVENT(proc_id, TOPDOWN_FETCH_LATENCY_BOUND, latency_bound);
-  INC_STAT_EVENT(proc_id, TOPDOWN_FETCH_BANDWIDTH_BOUND, frontend_bound - latency_bound);
+  uns64 latency_bound = ev[TD_EV(TOPDOWN_FETCH_BUBBLES_GT_MIW_CYCLES)] * TOPDOWN_SCALE_FACTOR / cycles;
+  metrics[TD_MET(TOPDOWN_FETCH_LATENCY_BOUND)] = latency_bound;
+  metrics[TD_MET(TOPDOWN_FETCH_BANDWIDTH_BOUND)] = frontend_bound - latency_bound;
 
   /* Bad Spec Breakdown */
   // prevent division by zero
-  uns64 bad_spec_cycles = GET_STAT_EVENT(proc_id, TOPDOWN_BR_MISPRED_RETIRED_CYCLES) +
-                          GET_STAT_EVENT(proc_id, TOPDOWN_MACHINE_CLEAR_CYCLES);
+  uns64 bad_spec_cycles = ev[TD_EV(TOPDOWN_BR_MISPRED_RETIRED_CYCLES)] + ev[TD_EV(TOPDOWN_MACHINE_CLEAR_CYCLES)];
   if (bad_spec_cycles == 0) {
     bad_spec_cycles++;
   }
 
-  INC_STAT_EVENT(proc_id, TOPDOWN_BR_MISPREDICTS_BOUND,
-                 bad_spec_bound * GET_STAT_EVENT(proc_id, TOPDOWN_BR_MISPRED_RETIRED_CYCLES) / bad_spec_cycles);
-  INC_STAT_EVENT(proc_id, TOPDOWN_MACHINE_CLEARS_BOUND,
-                 bad_spec_bound - GET_STAT_EVENT(proc_id, TOPDOWN_BR_MISPREDICTS_BOUND));
+  uns64 br_mispredicts_bound = bad_spec_bound * ev[TD_EV(TOPDOWN_BR_MISPRED_RETIRED_CYCLES)] / bad_spec_cycles;
+  metrics[TD_MET(TOPDOWN_BR_MISPREDICTS_BOUND)] = br_mispredicts_bound;
+  metrics[TD_MET(TOPDOWN_MACHINE_CLEARS_BOUND)] = bad_spec_bound - br_mispredicts_bound;
+}
+
+void topdown_done(uns proc_id) {
+  topdown_flush(proc_id);
+  if (topdown_data && topdown_data[proc_id].file) {
+    topdown_end_interval(proc_id);
+    fclose(topdown_data[proc_id].file);
+    topdown_data[proc_id].file = NULL;
+  }
+
+  uns64 ev[TOPDOWN_NUM_EVENTS];
+  uns64 metrics[TOPDOWN_NUM_METRICS];
+  for (uns ii = 0; ii < TOPDOWN_NUM_EVENTS; ii++)
+    ev[ii] = GET_STAT_EVENT(proc_id, TOPDOWN_TOTAL_SLOTS + ii);
+  topdown_reduce(ev, GET_STAT_EVENT(proc_id, NODE_CYCLE), metrics);
+  for (uns ii = 0; ii < TOPDOWN_NUM_METRICS; ii++)
+    INC_STAT_EVENT(proc_id, TOPDOWN_FRONTEND_BOUND + ii, metrics[ii]);
 }
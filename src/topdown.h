@@ -37,6 +37,8 @@
 
 #include "op.h"
 
+void topdown_init(uns proc_id);
+void topdown_flush(uns proc_id);
 void topdown_bp_recovery(uns proc_id, Op* op);
 void topdown_idq_update(uns proc_id, int count_available, int count_issued, int count_issued_on_path);
 void topdown_exec_update(uns proc_id, uns8 fus_busy);
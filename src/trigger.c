@@ -35,7 +35,9 @@
 #include "globals/assert.h"
 
 #include "core.param.h"
+#include "dvfs/dvfs.param.h"
 
+#include "freq.h"
 #include "statistics.h"
 
 /**************************************************************************************/
@@ -48,6 +50,8 @@ struct Trigger_struct {
   Trigger_Type type;
   Counter period;
   Counter next_threshold;
+  uns proc_id;
+  uns rate; /* most the stat grows in a cycle of core proc_id, 0 if unbounded */
 };
 
 /**************************************************************************************/
@@ -78,6 +82,7 @@ Trigger* trigger_create(const char* name, const char* spec, Trigger_Type type) {
   char* number_str = colon + 1;
 
   uns proc_id = 0;
+  trigger->rate = 0;
   char* open_bracket = strchr(stat_str, '[');
   if (open_bracket) {
     char* close_bracket = strchr(stat_str, ']');
@@ -96,6 +101,9 @@ Trigger* trigger_create(const char* name, const char* spec, Trigger_Type type) {
     case 'i':
       trigger->stat = &global_stat_array[proc_id][NODE_INST_COUNT];
       break;
+    case 'u':
+      trigger->stat = &global_stat_array[proc_id][NODE_UOP_COUNT];
+      break;
     case 'c':
       trigger->stat = &global_stat_array[proc_id][NODE_CYCLE];
       break;
@@ -105,12 +113,21 @@ Trigger* trigger_create(const char* name, const char* spec, Trigger_Type type) {
     default:
       trigger->stat = get_stat(proc_id, stat_str);
       ASSERTM(0, trigger->stat, "Stat '%s' for trigger '%s' not found\n", stat_str, name);
+      ASSERTM(0, stat_is_on(get_stat_idx(stat_str)), "Stat '%s' for trigger '%s' is in stat group %s, which is off\n",
+              stat_str, name, stat_group_name(get_stat_idx(stat_str)));
       ASSERTM(0, trigger->stat->type != FLOAT_TYPE_STAT,
               "Stat '%s' for trigger '%s' is a float (triggers support counter "
               "stats only)\n",
               stat_str, name);
   }
 
+  trigger->proc_id = proc_id;
+  if (trigger->stat == &global_stat_array[proc_id][NODE_CYCLE])
+    trigger->rate = 1;
+  else if (trigger->stat == &global_stat_array[proc_id][NODE_INST_COUNT] ||
+           trigger->stat == &global_stat_array[proc_id][NODE_UOP_COUNT])
+    trigger->rate = NODE_RET_WIDTH;
+
   trigger->period = atoll(number_str);
   if (trigger->period == 0 && trigger->type == TRIGGER_REPEAT) {
     FATAL_ERROR(0, "Repeat trigger '%s' has a zero period\n", name);
@@ -123,7 +140,7 @@ Trigger* trigger_create(const char* name, const char* spec, Trigger_Type type) {
 
 Flag trigger_fired(Trigger* trigger) {
   // common (false) case first
-  if (!trigger->armed || (trigger->stat->count + trigger->stat->total_count) < trigger->next_threshold) {
+  if (!trigger->armed || (trigger->stat->current->count + trigger->stat->total_count) < trigger->next_threshold) {
     return FALSE;
   }
 
@@ -133,7 +150,7 @@ Flag trigger_fired(Trigger* trigger) {
   } else {
     trigger->next_threshold += trigger->period;
     uns skipped = 0;
-    while (trigger->stat->count + trigger->stat->total_count >= trigger->next_threshold) {
+    while (trigger->stat->current->count + trigger->stat->total_count >= trigger->next_threshold) {
       trigger->next_threshold += trigger->period;
       skipped++;
     }
@@ -156,7 +173,7 @@ double trigger_progress(Trigger* trigger) {
     return 1.0;
 
   ASSERT(0, trigger->next_threshold >= trigger->period);
-  Counter stat_count = trigger->stat->count + trigger->stat->total_count;
+  Counter stat_count = trigger->stat->current->count + trigger->stat->total_count;
   ASSERT(0, stat_count >= trigger->next_threshold - trigger->period);
   if (stat_count >= trigger->next_threshold)
     return 1.0;
@@ -168,3 +185,47 @@ void trigger_free(Trigger* trigger) {
   free(trigger->name);
   free(trigger);
 }
+
+/**************************************************************************************/
+/* Trigger sets */
+
+/* trigger_earliest: a sim time before which trigger cannot fire. Cycle, instruction
+   and uop triggers grow by at most rate per cycle of their core, so they can skip
+   ahead. Other stats, and any trigger while DVFS can change the cycle time, are
+   checked every cycle. */
+static Counter trigger_earliest(Trigger* trigger, Counter now) {
+  if (!trigger->armed)
+    return MAX_CTR;
+  Counter value = trigger->stat->current->count + trigger->stat->total_count;
+  if (!trigger->rate || DVFS_ON || value >= trigger->next_threshold)
+    return now;
+  Counter cycles = (trigger->next_threshold - value + trigger->rate - 1) / trigger->rate;
+  return now + (cycles - 1) * freq_get_cycle_time(FREQ_DOMAIN_CORES[trigger->proc_id]);
+}
+
+void trigger_set_init(Trigger_Set* set) {
+  memset(set, 0, sizeof(Trigger_Set));
+  set->next_check = MAX_CTR;
+}
+
+void trigger_set_add(Trigger_Set* set, Trigger* trigger, Trigger_Action action) {
+  if (set->num == set->max) {
+    set->max = MAX2(2 * set->max, 4);
+    set->triggers = realloc(set->triggers, sizeof(Trigger*) * set->max);
+    set->actions = realloc(set->actions, sizeof(Trigger_Action) * set->max);
+  }
+  set->triggers[set->num] = trigger;
+  set->actions[set->num] = action;
+  set->num++;
+  set->next_check = 0;
+}
+
+void trigger_set_check(Trigger_Set* set, Counter now) {
+  set->next_check = MAX_CTR;
+  for (uns ii = 0; ii < set->num; ii++) {
+    Trigger* trigger = set->triggers[ii];
+    if (trigger_fired(trigger))
+      set->actions[ii](trigger);
+    set->next_check = MIN2(set->next_check, trigger_earliest(trigger, now));
+  }
+}
@@ -45,6 +45,18 @@ typedef enum Trigger_Type_enum {
 struct Trigger_struct;
 typedef struct Trigger_struct Trigger;
 
+typedef void (*Trigger_Action)(Trigger* trigger);
+
+/* A set of triggers checked together. next_check is a sim time before which none
+   of them can fire, so the caller only compares the time against it each cycle. */
+typedef struct Trigger_Set_struct {
+  Counter next_check;
+  uns num;
+  uns max;
+  Trigger** triggers;
+  Trigger_Action* actions;
+} Trigger_Set;
+
 /**************************************************************************************/
 /* Prototypes */
 
@@ -58,4 +70,14 @@ double trigger_progress(Trigger* trigger);
 
 void trigger_free(Trigger* trigger);
 
+void trigger_set_init(Trigger_Set* set);
+void trigger_set_add(Trigger_Set* set, Trigger* trigger, Trigger_Action action);
+void trigger_set_check(Trigger_Set* set, Counter now);
+
+/* trigger_set_poll: runs the actions of the triggers of set that fired, called every cycle */
+static inline void trigger_set_poll(Trigger_Set* set, Counter now) {
+  if (now >= set->next_check)
+    trigger_set_check(set, now);
+}
+
 #endif  // __TRIGGER_H__
@@ -52,9 +52,10 @@
 #include "bp/bp.h"
 #include "isa/isa_macros.h"
 #include "libs/cache_lib.h"
-#include "libs/cpp_cache.h"
+#include "libs/cpp_static_cache.h"
 #include "memory/memory.h"
 
+#include "core_context.h"
 #include "ft.h"
 #include "icache_stage.h"
 #include "op_pool.h"
@@ -70,13 +71,45 @@
 // Uop cache uses icache tag + icache offset as full TAG
 #define UOP_CACHE_LINE_SIZE ICACHE_LINE_SIZE
 
-typedef std::pair<Addr, FT_Info_Static> Uop_Cache_Key;
+/*
+ * A line is keyed by its start address plus its FT packed into one 64-bit word: the distance from the FT start to the
+ * line start, the FT length and the FT uop count. The FT start is recovered from the line start when evicting.
+ */
+#define UOP_CACHE_KEY_OFFSET_BITS 20
+#define UOP_CACHE_KEY_LENGTH_BITS 20
+#define UOP_CACHE_KEY_N_UOPS_BITS 24
+
+typedef struct Uop_Cache_Key_struct {
+  Addr line_start;
+  uns64 ft;
+} Uop_Cache_Key;
+
+static inline Uop_Cache_Key uop_cache_key(Addr line_start, const FT_Info_Static& ft) {
+  Addr offset = line_start - ft.start;
+  ASSERT(0, line_start >= ft.start && offset <= N_BIT_MASK(UOP_CACHE_KEY_OFFSET_BITS));
+  ASSERT(0, ft.length <= N_BIT_MASK(UOP_CACHE_KEY_LENGTH_BITS));
+  ASSERT(0, ft.n_uops >= 0 && (uns64)ft.n_uops <= N_BIT_MASK(UOP_CACHE_KEY_N_UOPS_BITS));
+  return {line_start, offset | ((uns64)ft.length << UOP_CACHE_KEY_OFFSET_BITS) |
+                          ((uns64)ft.n_uops << (UOP_CACHE_KEY_OFFSET_BITS + UOP_CACHE_KEY_LENGTH_BITS))};
+}
+
+static inline Addr uop_cache_key_ft_start(const Uop_Cache_Key& key) {
+  return key.line_start - (key.ft & N_BIT_MASK(UOP_CACHE_KEY_OFFSET_BITS));
+}
+
+static inline FT_Info_Static uop_cache_key_ft(const Uop_Cache_Key& key) {
+  FT_Info_Static ft;
+  ft.start = uop_cache_key_ft_start(key);
+  ft.length = (key.ft >> UOP_CACHE_KEY_OFFSET_BITS) & N_BIT_MASK(UOP_CACHE_KEY_LENGTH_BITS);
+  ft.n_uops = (int)(key.ft >> (UOP_CACHE_KEY_OFFSET_BITS + UOP_CACHE_KEY_LENGTH_BITS));
+  return ft;
+}
 
 /**************************************************************************************/
 /* Local Prototypes */
 
-class Uop_Cache : public Cpp_Cache<Uop_Cache_Key, Uop_Cache_Data> {
- protected:
+class Uop_Cache_Index {
+  uns num_sets;
   /*
    * 'offset_bits' specifies where the set index bits begin within the address.
    * These bits immediately follow the block offset, which is log2(line_bytes).
@@ -85,33 +118,56 @@ class Uop_Cache : public Cpp_Cache<Uop_Cache_Key, Uop_Cache_Data> {
   uns offset_bits;
 
  public:
-  uns set_idx_hash(Uop_Cache_Key key) override;
-  Uop_Cache(uns nl, uns asc, uns lb, Repl_Policy rp)
-      : Cpp_Cache<Uop_Cache_Key, Uop_Cache_Data>(nl, asc, lb, rp),
-        offset_bits(static_cast<uns>(std::log2(line_bytes))) {}
-};
+  Uop_Cache_Index(uns ns, uns lb) : num_sets(ns), offset_bits(static_cast<uns>(std::log2(lb))) {}
 
-uns Uop_Cache::set_idx_hash(Uop_Cache_Key key) {
   // use % instead of masking to support num_sets that is not a power of 2
-  return (key.first >> offset_bits) % num_sets;
-}
+  uns set(const Uop_Cache_Key& key) const { return (key.line_start >> offset_bits) % num_sets; }
+  // lines of one FT share the FT start as their SHiP signature
+  Addr signature(const Uop_Cache_Key& key) const { return uop_cache_key_ft_start(key); }
+};
+
+typedef Cpp_Cache_Intf<Uop_Cache_Key, Uop_Cache_Data> Uop_Cache;
+
+/* the inst of one uop of an FT, as uop_cache_split_FT sees it */
+typedef struct Uop_Cache_Uop_struct {
+  Addr addr;
+  uns8 inst_size;
+  Flag eom;
+} Uop_Cache_Uop;
 
 typedef struct Uop_Cache_Stage_Cpp_struct {
   Uop_Cache* uop_cache;
 
   /*
    * the lookup buffer stores the uop cache lines of an FT to be consumed by the icache stage.
-   * all lines are cleared when the entire FT has been consumed by the icache stage
+   * all lines are cleared when the entire FT has been consumed by the icache stage.
+   * an FT hits in at most UOP_CACHE_ASSOC lines, so the buffer is allocated once at that size
    */
-  std::vector<Uop_Cache_Data> lookup_buffer;
+  Uop_Cache_Data* lookup_buffer;
+  uns num_buffered_lines;
   uns num_looked_up_lines;
+
+  /*
+   * the lines of the last looked-up FT (none on a miss). A back-to-back lookup of the same FT reuses them without
+   * walking the cache again; any insertion or invalidation drops them
+   */
+  FT_Info_Static last_lookup_ft;
+  Uop_Cache_Data** last_lookup_lines;
+  uns last_lookup_count;
+  Flag last_lookup_valid;
+
+  // scratch space the FT being inserted is split into
+  Uop_Cache_Data* fill_lines;
+
+  // uops of the FT functional warmup is forming (FRONTEND_WARMUP)
+  std::vector<Uop_Cache_Uop> warmup_uops;
 } Uop_Cache_Stage_Cpp;
 
 /**************************************************************************************/
 /* Global Variables */
 
 static std::vector<Uop_Cache_Stage_Cpp> per_core_uc_stage;
-Uop_Cache_Stage* uc = NULL;
+CORE_LOCAL Uop_Cache_Stage* uc = NULL;
 
 /**************************************************************************************/
 /* Operator Overload */
@@ -121,7 +177,7 @@ inline bool operator==(const FT_Info_Static& lhs, const FT_Info_Static& rhs) {
 }
 
 inline bool operator==(const Uop_Cache_Key& lhs, const Uop_Cache_Key& rhs) {
-  return lhs.first == rhs.first && lhs.second == rhs.second;
+  return lhs.line_start == rhs.line_start && lhs.ft == rhs.ft;
 }
 
 inline bool operator==(const Uop_Cache_Data& lhs, const Uop_Cache_Data& rhs) {
@@ -139,12 +195,12 @@ void alloc_mem_uop_cache(uns num_cores) {
   per_core_uc_stage.resize(num_cores);
 }
 
-void set_uop_cache_stage(Uop_Cache_Stage* new_uc) {
+void set_uop_cache_stage(Core_Context* ctx) {
   if (!UOP_CACHE_ENABLE) {
     return;
   }
 
-  uc = new_uc;
+  uc = ctx->uc;
 }
 
 void init_uop_cache_stage(uns8 proc_id, const char* name) {
@@ -167,47 +223,68 @@ void init_uop_cache_stage(uns8 proc_id, const char* name) {
   uc->sd.ops = (Op**)calloc(UOPC_ISSUE_WIDTH, sizeof(Op*));
 
   // The cache library computes the number of entries from cache_size_bytes/cache_line_size_bytes
-  per_core_uc_stage[proc_id].uop_cache =
-      new Uop_Cache(UOP_CACHE_LINES, UOP_CACHE_ASSOC, UOP_CACHE_LINE_SIZE, (Repl_Policy)UOP_CACHE_REPL);
+  per_core_uc_stage[proc_id].uop_cache = new_cpp_static_cache<Uop_Cache_Key, Uop_Cache_Data, Uop_Cache_Index>(
+      UOP_CACHE_LINES, UOP_CACHE_ASSOC, UOP_CACHE_LINE_SIZE, (Repl_Policy)UOP_CACHE_REPL);
+  per_core_uc_stage[proc_id].lookup_buffer = (Uop_Cache_Data*)calloc(UOP_CACHE_ASSOC, sizeof(Uop_Cache_Data));
+  per_core_uc_stage[proc_id].last_lookup_lines = (Uop_Cache_Data**)calloc(UOP_CACHE_ASSOC, sizeof(Uop_Cache_Data*));
+  per_core_uc_stage[proc_id].fill_lines = (Uop_Cache_Data*)calloc(UOP_CACHE_ASSOC, sizeof(Uop_Cache_Data));
 }
 
 /**************************************************************************************/
 /* Uop Cache Lookup Buffer Func */
 
+/* walk the cache for the lines of an FT and remember them as the last lookup */
+static void uop_cache_lookup_ft_lines(Uop_Cache_Stage_Cpp* uc_cpp, FT_Info ft_info) {
+  uc_cpp->last_lookup_ft = ft_info.static_info;
+  uc_cpp->last_lookup_count = 0;
+  uc_cpp->last_lookup_valid = TRUE;
+
+  Uop_Cache_Data* uoc_data = NULL;
+  Addr lookup_addr = ft_info.static_info.start;
+  do {
+    uoc_data = uop_cache_lookup_line(lookup_addr, ft_info, TRUE);
+    if (!uoc_data) {
+      // FTs are inserted and evicted as a whole
+      ASSERT(uc->proc_id, uc_cpp->last_lookup_count == 0);
+      return;
+    }
+    ASSERT(uc->proc_id, uc_cpp->last_lookup_count < UOP_CACHE_ASSOC);
+    ASSERT(uc->proc_id, (uoc_data->offset == 0) == uoc_data->end_of_ft);
+    uc_cpp->last_lookup_lines[uc_cpp->last_lookup_count++] = uoc_data;
+    lookup_addr += uoc_data->offset;
+  } while (!uoc_data->end_of_ft);
+}
+
 Flag uop_cache_lookup_ft_and_fill_lookup_buffer(FT_Info ft_info, Flag offpath) {
   if (!UOP_CACHE_ENABLE) {
     return FALSE;
   }
 
   Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
-  ASSERT(uc->proc_id, uc_cpp->lookup_buffer.empty());
+  ASSERT(uc->proc_id, uc_cpp->num_buffered_lines == 0);
   ASSERT(uc->proc_id, uc_cpp->num_looked_up_lines == 0);
-  Uop_Cache_Data* uoc_data = NULL;
-  Addr lookup_addr = ft_info.static_info.start;
-  do {
-    uoc_data = uop_cache_lookup_line(lookup_addr, ft_info, TRUE);
-    if (uc_cpp->lookup_buffer.empty()) {
-      DEBUG(uc->proc_id, "UOC %s. ft_start=0x%llx, ft_length=%lld\n", uoc_data ? "hit" : "miss",
-            ft_info.static_info.start, ft_info.static_info.length);
-      if (!uoc_data) {
-        return FALSE;
-      }
-      if (!uoc_data->used && !offpath) {
-        STAT_EVENT(uc->proc_id, UOP_CACHE_FT_INSERTED_ONPATH_USED_ONPATH + uoc_data->ft_first_op_off_path);
-      }
-    }
+  if (!uc_cpp->last_lookup_valid || !(uc_cpp->last_lookup_ft == ft_info.static_info)) {
+    uop_cache_lookup_ft_lines(uc_cpp, ft_info);
+  }
 
-    ASSERT(uc->proc_id, uoc_data);
+  DEBUG(uc->proc_id, "UOC %s. ft_start=0x%llx, ft_length=%lld\n", uc_cpp->last_lookup_count ? "hit" : "miss",
+        ft_info.static_info.start, ft_info.static_info.length);
+  if (!uc_cpp->last_lookup_count) {
+    return FALSE;
+  }
+  const Uop_Cache_Data* first_line = uc_cpp->last_lookup_lines[0];
+  if (!first_line->used && !offpath) {
+    STAT_EVENT(uc->proc_id, UOP_CACHE_FT_INSERTED_ONPATH_USED_ONPATH + first_line->ft_first_op_off_path);
+  }
 
+  for (uns i = 0; i < uc_cpp->last_lookup_count; i++) {
+    Uop_Cache_Data* uoc_data = uc_cpp->last_lookup_lines[i];
     if (!uoc_data->used && !offpath) {
       STAT_EVENT(uc->proc_id, UOP_CACHE_LINE_INSERTED_ONPATH_USED_ONPATH + uoc_data->ft_first_op_off_path);
       uoc_data->used += 1;
     }
-
-    uc_cpp->lookup_buffer.emplace_back(*uoc_data);
-    ASSERT(uc->proc_id, (uoc_data->offset == 0) == uoc_data->end_of_ft);
-    lookup_addr += uoc_data->offset;
-  } while (!uoc_data->end_of_ft);
+    uc_cpp->lookup_buffer[uc_cpp->num_buffered_lines++] = *uoc_data;
+  }
 
   uc->lookups_per_cycle_count++;
   ASSERT(ic->proc_id, uc->lookups_per_cycle_count <= UOP_CACHE_READ_PORTS);
@@ -221,7 +298,8 @@ Flag uop_cache_lookup_ft_and_fill_lookup_buffer(FT_Info ft_info, Flag offpath) {
  */
 Uop_Cache_Data uop_cache_consume_uops_from_lookup_buffer(uns requested) {
   Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
-  Uop_Cache_Data* uop_cache_line = &uc_cpp->lookup_buffer.at(uc_cpp->num_looked_up_lines);
+  ASSERT(uc->proc_id, uc_cpp->num_looked_up_lines < uc_cpp->num_buffered_lines);
+  Uop_Cache_Data* uop_cache_line = &uc_cpp->lookup_buffer[uc_cpp->num_looked_up_lines];
   Uop_Cache_Data consumed_uop_cache_line = *uop_cache_line;
   if (uop_cache_line->n_uops > requested) {
     // the uopc line has more uops than requested; cannot fully consume it
@@ -238,13 +316,26 @@ Uop_Cache_Data uop_cache_consume_uops_from_lookup_buffer(uns requested) {
   return consumed_uop_cache_line;
 }
 
+/* an FT of a loop locked in the LSD is streamed as one line, without a uop cache lookup or read port */
+void uop_cache_fill_lookup_buffer_from_lsd(FT_Info ft_info) {
+  Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
+  ASSERT(uc->proc_id, uc_cpp->num_buffered_lines == 0);
+  ASSERT(uc->proc_id, ft_info.static_info.n_uops > 0);
+
+  Uop_Cache_Data* line = &uc_cpp->lookup_buffer[uc_cpp->num_buffered_lines++];
+  memset(line, 0, sizeof(Uop_Cache_Data));
+  line->line_start = ft_info.static_info.start;
+  line->n_uops = ft_info.static_info.n_uops;
+  line->end_of_ft = TRUE;
+}
+
 void uop_cache_clear_lookup_buffer() {
   if (!UOP_CACHE_ENABLE) {
     return;
   }
 
   Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
-  uc_cpp->lookup_buffer.clear();
+  uc_cpp->num_buffered_lines = 0;
   uc_cpp->num_looked_up_lines = 0;
 }
 
@@ -254,7 +345,8 @@ Uop_Cache_Data* uop_cache_lookup_line(Addr line_start, FT_Info ft_info, Flag upd
   }
 
   Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
-  Uop_Cache_Data* uoc_data = uc_cpp->uop_cache->access({line_start, ft_info.static_info}, update_repl == TRUE);
+  Uop_Cache_Key key = uop_cache_key(line_start, ft_info.static_info);
+  Uop_Cache_Data* uoc_data = uc_cpp->uop_cache->access(key, update_repl == TRUE);
   return uoc_data;
 }
 
@@ -268,7 +360,7 @@ const static int UOP_CACHE_STAT_OFFSET = 4;
  *   1. An instruction generates more uops than the uop cache line width.
  *   2. The FT spans more lines than the uop cache associativity.
  */
-Flag uop_cache_FT_if_insertable(const std::vector<Uop_Cache_Data> inserting_FT, FT_Info inserting_FT_info) {
+Flag uop_cache_FT_if_insertable(const Uop_Cache_FT_Lines* inserting_FT, FT_Info inserting_FT_info) {
   ASSERT(uc->proc_id, UOP_CACHE_ENABLE);
 
   Flag ft_off_path = inserting_FT_info.dynamic_info.first_op_off_path;
@@ -283,28 +375,25 @@ Flag uop_cache_FT_if_insertable(const std::vector<Uop_Cache_Data> inserting_FT,
    * consecutive lines might share the same start address (indicated by a zero offset).
    * It causes ambiguity and we do not insert the FT.
    */
-  for (const auto& it : inserting_FT) {
-    if (it.end_of_ft || it.offset != 0)
-      continue;
-
+  if (inserting_FT->inst_too_big) {
     Uop_Cache_Data* uop_cache_line =
         uop_cache_lookup_line(inserting_FT_info.static_info.start, inserting_FT_info, FALSE);
     ASSERT(uc->proc_id, !uop_cache_line);
     STAT_EVENT(uc->proc_id, UOP_CACHE_FT_INSERT_FAILED_INST_TOO_BIG_ON_PATH + ft_off_path * UOP_CACHE_STAT_OFFSET);
     INC_STAT_EVENT(uc->proc_id, UOP_CACHE_LINE_INSERT_FAILED_INST_TOO_BIG_ON_PATH + ft_off_path * UOP_CACHE_STAT_OFFSET,
-                   inserting_FT.size());
+                   inserting_FT->count);
 
     return FALSE;
   }
 
   /* if the FT is too big, do not insert */
-  if (inserting_FT.size() > UOP_CACHE_ASSOC) {
+  if (inserting_FT->count > UOP_CACHE_ASSOC) {
     Uop_Cache_Data* uop_cache_line =
         uop_cache_lookup_line(inserting_FT_info.static_info.start, inserting_FT_info, FALSE);
     ASSERT(uc->proc_id, !uop_cache_line);
     STAT_EVENT(uc->proc_id, UOP_CACHE_FT_INSERT_FAILED_FT_TOO_BIG_ON_PATH + ft_off_path * UOP_CACHE_STAT_OFFSET);
     INC_STAT_EVENT(uc->proc_id, UOP_CACHE_LINE_INSERT_FAILED_FT_TOO_BIG_ON_PATH + ft_off_path * UOP_CACHE_STAT_OFFSET,
-                   inserting_FT.size());
+                   inserting_FT->count);
 
     return FALSE;
   }
@@ -318,13 +407,13 @@ Flag uop_cache_FT_if_insertable(const std::vector<Uop_Cache_Data> inserting_FT,
  */
 void uop_cache_evict_FT(const Entry<Uop_Cache_Key, Uop_Cache_Data>& evicted_entry) {
   Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
-  FT_Info_Static evicted_ft_info_static = evicted_entry.key.second;
+  FT_Info_Static evicted_ft_info_static = uop_cache_key_ft(evicted_entry.key);
   Addr invalidate_addr = evicted_ft_info_static.start;
   Entry<Uop_Cache_Key, Uop_Cache_Data> invalidated_entry{};
 
   do {
-    invalidated_entry = uc_cpp->uop_cache->invalidate({invalidate_addr, evicted_ft_info_static});
-    if (invalidate_addr == evicted_entry.key.first) {
+    invalidated_entry = uc_cpp->uop_cache->invalidate(uop_cache_key(invalidate_addr, evicted_ft_info_static));
+    if (invalidate_addr == evicted_entry.key.line_start) {
       // this was the one evicted at first
       ASSERT(uc->proc_id, !invalidated_entry.valid);
       invalidated_entry = evicted_entry;
@@ -338,34 +427,36 @@ void uop_cache_evict_FT(const Entry<Uop_Cache_Key, Uop_Cache_Data>& evicted_entr
   } while (!invalidated_entry.data.end_of_ft);
 }
 
-void uop_cache_preallocate_space(const std::vector<Uop_Cache_Data>& inserting_FT, FT_Info inserting_FT_info) {
+void uop_cache_preallocate_space(const Uop_Cache_FT_Lines* inserting_FT, FT_Info inserting_FT_info) {
   Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
-  uns lines_needed = inserting_FT.size();
+  uns lines_needed = inserting_FT->count;
 
   ASSERT(uc->proc_id, lines_needed != 0);
 
-  Uop_Cache_Key uop_cache_key = {inserting_FT[0].line_start, inserting_FT_info.static_info};
+  Uop_Cache_Key first_key = uop_cache_key(inserting_FT->lines[0].line_start, inserting_FT_info.static_info);
 
-  uns free_space = uc_cpp->uop_cache->get_free_space(uop_cache_key);
+  uns free_space = uc_cpp->uop_cache->get_free_space(first_key);
 
   while (free_space < lines_needed) {
-    Entry<Uop_Cache_Key, Uop_Cache_Data> evicted_entry = uc_cpp->uop_cache->evict_one_line(uop_cache_key);
+    Entry<Uop_Cache_Key, Uop_Cache_Data> evicted_entry = uc_cpp->uop_cache->evict_one_line(first_key);
 
     if (evicted_entry.valid) {
       uop_cache_evict_FT(evicted_entry);
     }
-    ASSERT(uc->proc_id, uc_cpp->uop_cache->get_free_space(uop_cache_key) > free_space);
-    free_space = uc_cpp->uop_cache->get_free_space(uop_cache_key);
+    ASSERT(uc->proc_id, uc_cpp->uop_cache->get_free_space(first_key) > free_space);
+    free_space = uc_cpp->uop_cache->get_free_space(first_key);
   }
 }
 
-void uop_cache_insert_FT(const std::vector<Uop_Cache_Data> inserting_FT, FT_Info inserting_FT_info) {
+void uop_cache_insert_FT(const Uop_Cache_FT_Lines* inserting_FT, FT_Info inserting_FT_info) {
   ASSERT(uc->proc_id, UOP_CACHE_ENABLE);
   Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
   Flag off_path = inserting_FT_info.dynamic_info.first_op_off_path;
+  // lines may be invalidated or evicted below
+  uc_cpp->last_lookup_valid = FALSE;
 
   // Check if first line already exists
-  auto first_line = inserting_FT.begin();
+  const Uop_Cache_Data* first_line = &inserting_FT->lines[0];
   Uop_Cache_Data* first_lookup = uop_cache_lookup_line(first_line->line_start, inserting_FT_info, TRUE);
 
   bool lines_exist = first_lookup != nullptr;
@@ -378,7 +469,7 @@ void uop_cache_insert_FT(const std::vector<Uop_Cache_Data> inserting_FT, FT_Info
   // evict the uop cache entry with fake nop contained when the inserting FT has same start addr and length
   // so we can insert the new ft with valid ops
   if (lines_exist && first_lookup->contains_fake_nop) {
-    Uop_Cache_Key key = {first_line->line_start, inserting_FT_info.static_info};
+    Uop_Cache_Key key = uop_cache_key(first_line->line_start, inserting_FT_info.static_info);
     Entry<Uop_Cache_Key, Uop_Cache_Data> invalidated_entry;
     invalidated_entry = uc_cpp->uop_cache->invalidate(key);
     if (invalidated_entry.valid) {
@@ -393,7 +484,8 @@ void uop_cache_insert_FT(const std::vector<Uop_Cache_Data> inserting_FT, FT_Info
     uop_cache_preallocate_space(inserting_FT, inserting_FT_info);
   }
 
-  for (const auto& it : inserting_FT) {
+  for (uns i = 0; i < inserting_FT->count; i++) {
+    const Uop_Cache_Data& it = inserting_FT->lines[i];
     Uop_Cache_Data* uop_cache_line =
         (it == *first_line) ? first_lookup : uop_cache_lookup_line(it.line_start, inserting_FT_info, TRUE);
 
@@ -410,8 +502,8 @@ void uop_cache_insert_FT(const std::vector<Uop_Cache_Data> inserting_FT, FT_Info
     }
     ASSERT(uc->proc_id, !uop_cache_line);
 
-    Uop_Cache_Key uop_cache_key = {it.line_start, inserting_FT_info.static_info};
-    Entry<Uop_Cache_Key, Uop_Cache_Data> evicted_entry = uc_cpp->uop_cache->insert(uop_cache_key, it);
+    Entry<Uop_Cache_Key, Uop_Cache_Data> evicted_entry =
+        uc_cpp->uop_cache->insert(uop_cache_key(it.line_start, inserting_FT_info.static_info), it);
     DEBUG(uc->proc_id, "uop cache line inserted. off_path=%u, addr=0x%llx\n", off_path, it.line_start);
 
     if (evicted_entry.valid) {
@@ -421,10 +513,10 @@ void uop_cache_insert_FT(const std::vector<Uop_Cache_Data> inserting_FT, FT_Info
   }
 }
 
-void uop_cache_insert_FT_update_stat(const std::vector<Uop_Cache_Data> inserting_FT, FT_Info inserting_FT_info) {
+void uop_cache_insert_FT_update_stat(const Uop_Cache_FT_Lines* inserting_FT, FT_Info inserting_FT_info) {
   ASSERT(uc->proc_id, UOP_CACHE_ENABLE);
 
-  if (inserting_FT.size() > UOP_CACHE_FT_LINES_8_OFF_PATH - UOP_CACHE_FT_LINES_1_OFF_PATH + 1) {
+  if (inserting_FT->count > UOP_CACHE_FT_LINES_8_OFF_PATH - UOP_CACHE_FT_LINES_1_OFF_PATH + 1) {
     if (inserting_FT_info.dynamic_info.first_op_off_path) {
       STAT_EVENT(uc->proc_id, UOP_CACHE_FT_LINES_9_AND_MORE_OFF_PATH);
     } else {
@@ -432,34 +524,35 @@ void uop_cache_insert_FT_update_stat(const std::vector<Uop_Cache_Data> inserting
     }
   } else {
     if (inserting_FT_info.dynamic_info.first_op_off_path) {
-      STAT_EVENT(uc->proc_id, UOP_CACHE_FT_LINES_1_OFF_PATH + inserting_FT.size() - 1);
+      STAT_EVENT(uc->proc_id, UOP_CACHE_FT_LINES_1_OFF_PATH + inserting_FT->count - 1);
     } else {
-      STAT_EVENT(uc->proc_id, UOP_CACHE_FT_LINES_1_ON_PATH + inserting_FT.size() - 1);
+      STAT_EVENT(uc->proc_id, UOP_CACHE_FT_LINES_1_ON_PATH + inserting_FT->count - 1);
     }
   }
 }
 
 /*
- * Generate uop cache data for a given FT and fill `out`.
- * This is the moved implementation of the previous FT::generate_uop_cache_data().
+ * Split the num_uops uops of an FT, uop_at(i) being the i-th, into uop cache lines and fill `out`. Returns whether
+ * the last uop ends the FT.
  */
-void generate_uop_cache_data_from_FT(FT* ft, std::vector<Uop_Cache_Data>& out) {
-  out.clear();
+template <typename Uop_At>
+static bool uop_cache_split_FT(size_t num_uops, Uop_At uop_at, FT_Info ft_info, Uop_Cache_FT_Lines* out) {
+  out->count = 0;
+  out->inst_too_big = FALSE;
   // Initialize current line tracking
   Uop_Cache_Data current_line = {};
-  FT_Info ft_info = ft->get_ft_info();
   bool line_started = false;
   bool is_ft_end = false;
+  Addr ft_end_addr = ft_info.static_info.start + ft_info.static_info.length;
 
-  auto& ops = ft->ops;
-  for (size_t i = 0; i < ops.size(); ++i) {
-    Op* op = ops[i];
+  for (size_t i = 0; i < num_uops; ++i) {
+    Uop_Cache_Uop uop = uop_at(i);
 
     // Start a new line if needed
     if (!line_started) {
-      current_line.line_start = op->inst_info->addr;
-      current_line.ft_first_op_off_path = ft->get_first_op_off_path();
-      current_line.contains_fake_nop = ft->get_contains_fake_nop();
+      current_line.line_start = uop.addr;
+      current_line.ft_first_op_off_path = ft_info.dynamic_info.first_op_off_path;
+      current_line.contains_fake_nop = ft_info.dynamic_info.contains_fake_nop;
       current_line.n_uops = 0;
       current_line.end_of_ft = FALSE;
       current_line.used = 0;
@@ -469,22 +562,20 @@ void generate_uop_cache_data_from_FT(FT* ft, std::vector<Uop_Cache_Data>& out) {
     current_line.n_uops++;
 
     // Check for line termination conditions
-    Addr ft_end_addr = ft->get_start_addr() + ft_info.static_info.length;
-    Addr inst_end_addr = op->inst_info->addr + op->inst_info->trace_info.inst_size;
+    Addr inst_end_addr = uop.addr + uop.inst_size;
 
-    is_ft_end = op->eom && (inst_end_addr == ft_end_addr);
+    is_ft_end = uop.eom && (inst_end_addr == ft_end_addr);
     bool is_line_end = (current_line.n_uops == UOP_CACHE_WIDTH);
     ASSERT(uc->proc_id, current_line.n_uops <= UOP_CACHE_WIDTH);
 
     // Determine if this is the last op in the current line
-    if (is_ft_end || is_line_end || i == ops.size() - 1) {
+    if (is_ft_end || is_line_end || i == num_uops - 1) {
       if (is_ft_end) {
         current_line.end_of_ft = TRUE;
         current_line.offset = 0;  // No next line for FT end
-      } else if (i + 1 < ops.size()) {
+      } else if (i + 1 < num_uops) {
         // Calculate offset to next line start
-        Op* next_op = ops[i + 1];
-        Addr next_line_start = next_op->inst_info->addr;
+        Addr next_line_start = uop_at(i + 1).addr;
         current_line.offset = next_line_start - current_line.line_start;
         current_line.end_of_ft = FALSE;
       } else {
@@ -492,31 +583,56 @@ void generate_uop_cache_data_from_FT(FT* ft, std::vector<Uop_Cache_Data>& out) {
         current_line.offset = inst_end_addr - current_line.line_start;
         current_line.end_of_ft = TRUE;  // Assume end of FT if we're at the last op
       }
-      out.push_back(current_line);
+      // consecutive lines of an inst wider than a line share the same start address
+      if (!current_line.end_of_ft && current_line.offset == 0) {
+        out->inst_too_big = TRUE;
+      }
+      if (out->count < out->capacity) {
+        out->lines[out->count] = current_line;
+      }
+      out->count++;
       current_line = {};
       line_started = false;
     }
   }
+  ASSERT(uc->proc_id, !line_started);
+  return is_ft_end;
+}
+
+/*
+ * Generate uop cache data for a given FT and fill `out`.
+ * This is the moved implementation of the previous FT::generate_uop_cache_data().
+ */
+void generate_uop_cache_data_from_FT(FT* ft, Uop_Cache_FT_Lines* out) {
+  FT_Info ft_info = ft->get_ft_info();
+  auto& ops = ft->ops;
+  bool is_ft_end = uop_cache_split_FT(
+      ops.size(),
+      [&ops](size_t i) -> Uop_Cache_Uop {
+        return {ops[i]->inst_info->addr, ops[i]->inst_info->trace_info.inst_size, ops[i]->eom};
+      },
+      ft_info, out);
   ASSERT(uc->proc_id, ft->op_pos == ft->ops.size());
   ft->op_pos = 0;
   ft->generate_ft_info();
-  ASSERT(uc->proc_id, !line_started && is_ft_end);
+  ASSERT(uc->proc_id, is_ft_end);
 }
 
 void uop_cache_insert_FT(FT* ft) {
   ASSERT(uc->proc_id, ft);
-  std::vector<Uop_Cache_Data> buffer;
-  generate_uop_cache_data_from_FT(ft, buffer);
+  // an FT longer than the associativity is never inserted, so the lines past it are only counted
+  Uop_Cache_FT_Lines buffer = {per_core_uc_stage[uc->proc_id].fill_lines, UOP_CACHE_ASSOC, 0, FALSE};
+  generate_uop_cache_data_from_FT(ft, &buffer);
 
   auto ft_info = ft->get_ft_info();
   // the entire buffer is inserted into the uop cache when the FT has ended
-  Flag if_insertable = uop_cache_FT_if_insertable(buffer, ft_info);
+  Flag if_insertable = uop_cache_FT_if_insertable(&buffer, ft_info);
   if (if_insertable) {
     // inserting an FT entirely avoids corner cases, but is not the most accurate
-    uop_cache_insert_FT(buffer, ft_info);
+    uop_cache_insert_FT(&buffer, ft_info);
   }
 
-  uop_cache_insert_FT_update_stat(buffer, ft_info);
+  uop_cache_insert_FT_update_stat(&buffer, ft_info);
 }
 
 /*
@@ -533,4 +649,33 @@ void uop_cache_insert_op(Op* op) {
 
   if (!op->parent_FT_off_path && op == op->parent_FT->get_last_op())
     uop_cache_insert_FT(op->parent_FT);
-}
\ No newline at end of file
+}
+
+/*
+ * Functional warmup (FRONTEND_WARMUP): the on-path ops are gathered into the FTs the decoupled frontend would form
+ * and each FT is inserted once its last op is seen, like the detailed model does when the FT is decoded. An FT that
+ * is already cached only updates the replacement state of its lines.
+ */
+void uop_cache_warmup_op(Op* op) {
+  if (!UOP_CACHE_ENABLE)
+    return;
+  Uop_Cache_Stage_Cpp* uc_cpp = &per_core_uc_stage[uc->proc_id];
+  std::vector<Uop_Cache_Uop>& uops = uc_cpp->warmup_uops;
+
+  uops.push_back({op->inst_info->addr, op->inst_info->trace_info.inst_size, op->eom});
+  FT_Ended_By ended_by = ft_op_end_reason(op, op->oracle_info.dir == TAKEN);
+  if (ended_by == FT_NOT_ENDED)
+    return;
+
+  FT_Info ft_info = {};
+  ft_info.static_info.start = uops.front().addr;
+  ft_info.static_info.length = op->inst_info->addr + op->inst_info->trace_info.inst_size - ft_info.static_info.start;
+  ft_info.static_info.n_uops = uops.size();
+  ft_info.dynamic_info.ended_by = ended_by;
+
+  Uop_Cache_FT_Lines buffer = {uc_cpp->fill_lines, UOP_CACHE_ASSOC, 0, FALSE};
+  uop_cache_split_FT(uops.size(), [&uops](size_t i) { return uops[i]; }, ft_info, &buffer);
+  if (uop_cache_FT_if_insertable(&buffer, ft_info))
+    uop_cache_insert_FT(&buffer, ft_info);
+  uops.clear();
+}
@@ -35,6 +35,15 @@ typedef struct Uop_Cache_Data_struct {
   Flag priority;
 } Uop_Cache_Data;
 
+/* the lines one FT splits into, written to a caller-provided array; lines past the capacity are only counted */
+typedef struct Uop_Cache_FT_Lines_struct {
+  Uop_Cache_Data* lines;
+  uns capacity;
+  uns count;
+  // some inst needs more uops than a line holds (a zero offset before the end of the FT)
+  Flag inst_too_big;
+} Uop_Cache_FT_Lines;
+
 typedef struct Uop_Cache_Stage_struct {
   uns8 proc_id;
   Stage_Data sd;
@@ -45,21 +54,23 @@ typedef struct Uop_Cache_Stage_struct {
 /**************************************************************************************/
 /* External Variables */
 
-extern Uop_Cache_Stage* uc;
+extern CORE_LOCAL Uop_Cache_Stage* uc;
 
 /**************************************************************************************/
 /* Prototypes */
 
-void set_uop_cache_stage(Uop_Cache_Stage* new_uc);
+void set_uop_cache_stage(Core_Context* ctx);
 void init_uop_cache_stage(uns8 proc_id, const char* name);
 void alloc_mem_uop_cache(uns num_cores);
 
 Flag uop_cache_lookup_ft_and_fill_lookup_buffer(FT_Info ft_info, Flag offpath);
 Uop_Cache_Data uop_cache_consume_uops_from_lookup_buffer(uns requested);
 void uop_cache_clear_lookup_buffer(void);
+void uop_cache_fill_lookup_buffer_from_lsd(FT_Info ft_info);
 Uop_Cache_Data* uop_cache_lookup_line(Addr line_start, FT_Info ft_info, Flag update_repl);
 
 void uop_cache_insert_op(Op* op);
+void uop_cache_warmup_op(Op* op);
 
 #ifdef __cplusplus
 }
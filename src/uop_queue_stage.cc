@@ -32,7 +32,7 @@ extern "C" {
 // Uop Queue Variables
 std::deque<Stage_Data*> q{};
 std::deque<Stage_Data*> free_sds{};
-bool uopq_off_path;
+CORE_LOCAL bool uopq_off_path;
 
 void init_uop_queue_stage() {
   char tmp_name[MAX_STR_LENGTH + 1];
@@ -48,7 +48,8 @@ void init_uop_queue_stage() {
 }
 
 // Get ops from the uop cache.
-void update_uop_queue_stage(Stage_Data* src_sd) {
+void update_uop_queue_stage(Core_Context* ctx, Stage_Data* src_sd) {
+  UNUSED(ctx);
   if (!UOP_CACHE_ENABLE)
     return;
 
@@ -80,9 +81,11 @@ void update_uop_queue_stage(Stage_Data* src_sd) {
     if (!uopq_off_path) {
       STAT_EVENT(dec->proc_id, UOPQ_STAGE_NOT_STARVED);
     }
-    for (int i = 0; i < src_sd->max_op_count; i++) {
+    int left = src_sd->op_count;
+    for (int i = 0; left && i < src_sd->max_op_count; i++) {
       Op* src_op = src_sd->ops[i];
       if (src_op) {
+        left--;
         ASSERT(src_op->proc_id, src_op->fetched_from_uop_cache);
         new_sd->ops[new_sd->op_count] = src_op;
         src_sd->ops[i] = NULL;
@@ -15,7 +15,7 @@ extern "C" {
 #include "uop_cache.h"
 
 void init_uop_queue_stage(void);
-void update_uop_queue_stage(Stage_Data* src_sd);
+void update_uop_queue_stage(Core_Context* ctx, Stage_Data* src_sd);
 void recover_uop_queue_stage(void);
 Stage_Data* uop_queue_stage_get_latest_sd(void);
 // Returns length of queue in terms of number of stages
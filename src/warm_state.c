@@ -0,0 +1,339 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : warm_state.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Writer and mmap-based reader of warm state files.
+ ***************************************************************************************/
+
+#include "warm_state.h"
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "globals/assert.h"
+#include "globals/global_defs.h"
+#include "globals/global_vars.h"
+#include "globals/utils.h"
+
+#include "core.param.h"
+#include "general.param.h"
+
+#include "debug/state_hash.h"
+#include "model.h"
+
+/**************************************************************************************/
+/* Global Variables */
+
+/* file being written */
+static FILE* file;
+static uns64 file_pos;
+static Warm_State_Section* sections;
+static uns64 num_sections;
+static uns64 max_sections;
+static Flag in_section;
+
+/* sections being hashed instead (warm_state_hash) */
+static void (*hash_section_func)(const char* name, uns64 hash);
+static uns64 section_hash;
+
+/* file being read */
+static const uns8* map;
+static size_t map_size;
+static const Warm_State_Header* header;
+static const Warm_State_Section* dir;
+
+/**************************************************************************************/
+/* Local Prototypes */
+
+static void warm_state_fwrite(const void* data, uns64 size);
+static void warm_state_pad(void);
+static void warm_state_load_file(const char* path, Flag end_of_warmup);
+static void warm_state_format_name(char* name, const char* name_fmt, va_list args);
+
+/**************************************************************************************/
+/* warm_state_save: */
+
+void warm_state_save(const char* path) {
+  Warm_State_Header file_header;
+
+  ASSERTM(0, model->save_warm_state_func, "Model %s cannot save its warm state\n", model->name);
+
+  file = fopen(path, "wb");
+  if (!file)
+    FATAL_ERROR(0, "Could not open warm state file %s for writing\n", path);
+  file_pos = 0;
+  num_sections = 0;
+
+  memset(&file_header, 0, sizeof(file_header));
+  warm_state_fwrite(&file_header, sizeof(file_header));
+
+  model->save_warm_state_func();
+  ASSERT(0, !in_section);
+
+  warm_state_pad();
+  strncpy(file_header.magic, WARM_STATE_MAGIC, sizeof(file_header.magic));
+  file_header.version = WARM_STATE_VERSION;
+  file_header.num_cores = NUM_CORES;
+  file_header.warmup = WARMUP;
+  file_header.sim_time = sim_time;
+  file_header.num_sections = num_sections;
+  file_header.dir_offset = file_pos;
+  warm_state_fwrite(sections, sizeof(Warm_State_Section) * num_sections);
+
+  /* the header goes in last, so an interrupted save leaves no valid file */
+  fseek(file, 0, SEEK_SET);
+  warm_state_fwrite(&file_header, sizeof(file_header));
+  if (fclose(file))
+    FATAL_ERROR(0, "Could not write warm state file %s\n", path);
+  file = NULL;
+  free(sections);
+  sections = NULL;
+  max_sections = 0;
+
+  fprintf(mystdout, "** Warm state saved to %s (%llu sections)\n", path, num_sections);
+}
+
+/**************************************************************************************/
+/* warm_state_hash: runs the model's save_warm_state_func without a file, passing
+   the name and the hash of every section to section_func (STATE_HASH_INTERVAL) */
+
+void warm_state_hash(void (*section_func)(const char* name, uns64 hash)) {
+  ASSERTM(0, model->save_warm_state_func, "Model %s cannot save its warm state\n", model->name);
+  ASSERT(0, !file);
+
+  hash_section_func = section_func;
+  num_sections = 0;
+  model->save_warm_state_func();
+  ASSERT(0, !in_section);
+  hash_section_func = NULL;
+  num_sections = 0;
+}
+
+/**************************************************************************************/
+/* warm_state_load: */
+
+void warm_state_load(const char* path) {
+  warm_state_load_file(path, TRUE);
+}
+
+/**************************************************************************************/
+/* warm_state_restore: loads a state this run saved earlier, at any point of the
+   simulation (libscarab), so its time does not have to match the end of warmup */
+
+void warm_state_restore(const char* path) {
+  warm_state_load_file(path, FALSE);
+}
+
+/**************************************************************************************/
+/* warm_state_load_file: */
+
+static void warm_state_load_file(const char* path, Flag end_of_warmup) {
+  struct stat st;
+  uns64 ii;
+  int fd;
+
+  ASSERTM(0, model->load_warm_state_func, "Model %s cannot load a warm state\n", model->name);
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st))
+    FATAL_ERROR(0, "Could not open warm state file %s\n", path);
+  map_size = st.st_size;
+  if (map_size < sizeof(Warm_State_Header))
+    FATAL_ERROR(0, "%s is not a warm state file\n", path);
+  map = (const uns8*)mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    FATAL_ERROR(0, "Could not map warm state file %s\n", path);
+
+  header = (const Warm_State_Header*)map;
+  if (strncmp(header->magic, WARM_STATE_MAGIC, sizeof(header->magic)))
+    FATAL_ERROR(0, "%s is not a warm state file\n", path);
+  if (header->version != WARM_STATE_VERSION)
+    FATAL_ERROR(0, "Warm state file %s has version %u, expected %u\n", path, header->version, WARM_STATE_VERSION);
+  if (header->num_cores != NUM_CORES || header->warmup != WARMUP)
+    FATAL_ERROR(0, "Warm state file %s was saved with NUM_CORES %u and WARMUP %llu\n", path, header->num_cores,
+                header->warmup);
+  if (end_of_warmup && header->sim_time != sim_time)
+    FATAL_ERROR(0, "Warm state file %s ends warmup at time %llu, this run at %llu (different frequencies?)\n", path,
+                header->sim_time, sim_time);
+  if (header->dir_offset > map_size || header->num_sections > (map_size - header->dir_offset) / sizeof(*dir))
+    FATAL_ERROR(0, "Warm state file %s is truncated\n", path);
+  dir = (const Warm_State_Section*)(map + header->dir_offset);
+  for (ii = 0; ii < header->num_sections; ii++) {
+    if (dir[ii].offset > map_size || dir[ii].size > map_size - dir[ii].offset)
+      FATAL_ERROR(0, "Warm state file %s is truncated\n", path);
+  }
+
+  model->load_warm_state_func();
+
+  munmap((void*)map, map_size);
+  map = NULL;
+  header = NULL;
+  dir = NULL;
+
+  fprintf(mystdout, "** Warm state loaded from %s\n", path);
+}
+
+/**************************************************************************************/
+/* warm_state_begin: */
+
+void warm_state_begin(const char* name_fmt, ...) {
+  Warm_State_Section* section;
+  va_list args;
+
+  ASSERT(0, (file || hash_section_func) && !in_section);
+  if (num_sections == max_sections) {
+    max_sections = max_sections ? 2 * max_sections : 64;
+    sections = (Warm_State_Section*)realloc(sections, sizeof(Warm_State_Section) * max_sections);
+    ASSERT(0, sections);
+  }
+  if (file)
+    warm_state_pad();
+  section_hash = STATE_HASH_INIT;
+
+  section = &sections[num_sections];
+  memset(section, 0, sizeof(*section));
+  va_start(args, name_fmt);
+  warm_state_format_name(section->name, name_fmt, args);
+  va_end(args);
+  section->offset = file_pos;
+  in_section = TRUE;
+}
+
+/**************************************************************************************/
+/* warm_state_write: */
+
+void warm_state_write(const void* data, uns64 size) {
+  ASSERT(0, in_section);
+  if (hash_section_func)
+    section_hash = state_hash_bytes(section_hash, data, size);
+  else
+    warm_state_fwrite(data, size);
+  sections[num_sections].size += size;
+}
+
+/**************************************************************************************/
+/* warm_state_end: */
+
+void warm_state_end(void) {
+  ASSERT(0, in_section);
+  if (hash_section_func)
+    hash_section_func(sections[num_sections].name, section_hash);
+  num_sections++;
+  in_section = FALSE;
+}
+
+/**************************************************************************************/
+/* warm_state_save_cache: writes the cache_save_state image of the cache as its
+   own section */
+
+void warm_state_save_cache(Cache* cache, const char* name_fmt, ...) {
+  char name[WARM_STATE_NAME_LEN];
+  uns64 size = cache_state_size(cache);
+  void* buf = malloc(size);
+  va_list args;
+
+  ASSERT(0, buf);
+  cache_save_state(cache, buf);
+  va_start(args, name_fmt);
+  warm_state_format_name(name, name_fmt, args);
+  va_end(args);
+  warm_state_begin("%s", name);
+  warm_state_write(buf, size);
+  warm_state_end();
+  free(buf);
+}
+
+/**************************************************************************************/
+/* warm_state_find: */
+
+const void* warm_state_find(uns64* size, const char* name_fmt, ...) {
+  char name[WARM_STATE_NAME_LEN];
+  va_list args;
+  uns64 ii;
+
+  ASSERT(0, map);
+  va_start(args, name_fmt);
+  warm_state_format_name(name, name_fmt, args);
+  va_end(args);
+
+  for (ii = 0; ii < header->num_sections; ii++) {
+    if (!strncmp(dir[ii].name, name, WARM_STATE_NAME_LEN)) {
+      *size = dir[ii].size;
+      return map + dir[ii].offset;
+    }
+  }
+  return NULL;
+}
+
+/**************************************************************************************/
+/* warm_state_load_cache: */
+
+void warm_state_load_cache(Cache* cache, const char* name_fmt, ...) {
+  char name[WARM_STATE_NAME_LEN];
+  const void* data;
+  uns64 size;
+  va_list args;
+
+  va_start(args, name_fmt);
+  warm_state_format_name(name, name_fmt, args);
+  va_end(args);
+
+  data = warm_state_find(&size, "%s", name);
+  if (!data)
+    FATAL_ERROR(0, "Warm state file has no section %s\n", name);
+  if (!cache_load_state(cache, data, size))
+    FATAL_ERROR(0, "Warm state section %s does not match the geometry of cache %s\n", name, cache->name);
+}
+
+/**************************************************************************************/
+/* warm_state_fwrite: */
+
+static void warm_state_fwrite(const void* data, uns64 size) {
+  if (size && fwrite(data, 1, size, file) != size)
+    FATAL_ERROR(0, "Could not write warm state file\n");
+  file_pos += size;
+}
+
+/**************************************************************************************/
+/* warm_state_pad: moves the write position to the next WARM_STATE_ALIGN boundary */
+
+static void warm_state_pad(void) {
+  static const uns8 zeros[WARM_STATE_ALIGN];
+  uns64 pad = (WARM_STATE_ALIGN - file_pos % WARM_STATE_ALIGN) % WARM_STATE_ALIGN;
+  warm_state_fwrite(zeros, pad);
+}
+
+/**************************************************************************************/
+/* warm_state_format_name: */
+
+static void warm_state_format_name(char* name, const char* name_fmt, va_list args) {
+  int len = vsnprintf(name, WARM_STATE_NAME_LEN, name_fmt, args);
+  ASSERTM(0, len >= 0 && len < WARM_STATE_NAME_LEN, "Warm state section name %s is too long\n", name);
+}
@@ -0,0 +1,93 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : warm_state.h
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Checkpoints of the microarchitectural state trained during
+ *                warmup (SAVE_WARM_STATE and LOAD_WARM_STATE).
+ *
+ * A warm state file is a Warm_State_Header, the named sections written by the
+ * model, and the section directory.  Every section starts on a page boundary,
+ * so the loader maps the file read-only and the model restores its structures
+ * straight from the mapping.
+ ***************************************************************************************/
+
+#ifndef __WARM_STATE_H__
+#define __WARM_STATE_H__
+
+#include "globals/global_types.h"
+
+#include "libs/cache_lib.h"
+
+/**************************************************************************************/
+/* Defines */
+
+#define WARM_STATE_MAGIC "SCARWST"
+#define WARM_STATE_VERSION 2
+#define WARM_STATE_ALIGN 4096
+#define WARM_STATE_NAME_LEN 48
+
+/**************************************************************************************/
+/* Types */
+
+typedef struct Warm_State_Header_struct {
+  char magic[8];
+  uns32 version;
+  uns32 num_cores;
+  uns64 warmup;        /* WARMUP instructions the state was trained on */
+  uns64 sim_time;      /* sim_time at the end of warmup */
+  uns64 num_sections;
+  uns64 dir_offset;    /* offset of the Warm_State_Section array */
+} Warm_State_Header;
+
+typedef struct Warm_State_Section_struct {
+  char name[WARM_STATE_NAME_LEN];
+  uns64 offset;
+  uns64 size;
+} Warm_State_Section;
+
+/**************************************************************************************/
+/* Prototypes */
+
+/* Called by sim.c at the end of warmup; they run the model's
+   save_warm_state_func or load_warm_state_func */
+void warm_state_save(const char* path);
+void warm_state_load(const char* path);
+/* Loads a state saved later in the same run, e.g. by libscarab */
+void warm_state_restore(const char* path);
+/* Hashes every section instead of writing it, for the state hash checker */
+void warm_state_hash(void (*section_func)(const char* name, uns64 hash));
+
+/* For save_warm_state_func: each section is written between warm_state_begin
+   and warm_state_end */
+void warm_state_begin(const char* name_fmt, ...) __attribute__((format(printf, 1, 2)));
+void warm_state_write(const void* data, uns64 size);
+void warm_state_end(void);
+void warm_state_save_cache(Cache* cache, const char* name_fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/* For load_warm_state_func: warm_state_find returns NULL if the file does not
+   have the section, warm_state_load_cache stops the simulation */
+const void* warm_state_find(uns64* size, const char* name_fmt, ...) __attribute__((format(printf, 2, 3)));
+void warm_state_load_cache(Cache* cache, const char* name_fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#endif /* #ifndef __WARM_STATE_H__ */
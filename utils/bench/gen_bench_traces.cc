@@ -0,0 +1,302 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : utils/bench/gen_bench_traces.cc
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Writes the synthetic PIN traces of the simulator throughput benchmark
+ *                (make bench in src/): a branchy loop with data-dependent branches, a
+ *                memory-bound pointer chase and a vector-heavy FMA stream. The traces
+ *                are fully determined by the instruction count, so results from
+ *                different releases are comparable.
+ ***************************************************************************************/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <string>
+
+#include "isa/isa.h"
+
+#include "ctype_pin_inst.h"
+
+class Bench_Trace {
+ public:
+  Bench_Trace(const std::string& path, uint64_t num_insts) : num_insts(num_insts), count(0) {
+    std::string cmd = "bzip2 -c > '" + path + "'";
+    out = popen(cmd.c_str(), "w");
+    if (!out) {
+      fprintf(stderr, "Could not start bzip2 for %s\n", path.c_str());
+      exit(1);
+    }
+  }
+
+  ~Bench_Trace() {
+    if (pclose(out)) {
+      fprintf(stderr, "Writing a trace failed\n");
+      exit(1);
+    }
+  }
+
+  bool done() const { return count >= num_insts; }
+
+  /* Emits inst, which falls through unless it is a taken branch */
+  void emit(ctype_pin_inst* pi) {
+    pi->inst_uid = count++;
+    pi->instruction_next_addr = pi->actually_taken ? pi->branch_target : pi->instruction_addr + pi->size;
+    if (fwrite(pi, sizeof(*pi), 1, out) != 1) {
+      fprintf(stderr, "Writing a trace failed\n");
+      exit(1);
+    }
+  }
+
+ private:
+  FILE* out;
+  uint64_t num_insts;
+  uint64_t count;
+};
+
+static uint64_t lcg_state = 0x2545F4914F6CDD1DULL;
+
+static uint64_t lcg_next() {
+  lcg_state = lcg_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return lcg_state >> 17;
+}
+
+static ctype_pin_inst make_inst(uint64_t pc, uint8_t op_type, const char* iclass) {
+  ctype_pin_inst pi;
+  memset(&pi, 0, sizeof(pi));
+  pi.instruction_addr = pc;
+  pi.size = 4;
+  pi.inst_binary_lsb = pc;  // distinct per static instruction
+  pi.op_type = op_type;
+  pi.true_op_type = op_type;
+  pi.num_simd_lanes = 1;
+  pi.lane_width_bytes = 8;
+  strncpy(pi.pin_iclass, iclass, sizeof(pi.pin_iclass) - 1);
+  return pi;
+}
+
+static void add_src(ctype_pin_inst* pi, uint8_t reg) {
+  pi->src_regs[pi->num_src_regs++] = reg;
+}
+
+static void add_dst(ctype_pin_inst* pi, uint8_t reg) {
+  pi->dst_regs[pi->num_dst_regs++] = reg;
+}
+
+static void add_ld(ctype_pin_inst* pi, uint8_t addr_reg, uint64_t vaddr, uint8_t size) {
+  pi->ld1_addr_regs[pi->num_ld1_addr_regs++] = addr_reg;
+  pi->ld_vaddr[pi->num_ld++] = vaddr;
+  pi->ld_size = size;
+}
+
+static void add_st(ctype_pin_inst* pi, uint8_t addr_reg, uint64_t vaddr, uint8_t size) {
+  pi->st_addr_regs[pi->num_st_addr_regs++] = addr_reg;
+  pi->st_vaddr[pi->num_st++] = vaddr;
+  pi->st_size = size;
+}
+
+static void make_cbr(ctype_pin_inst* pi, uint64_t target, bool taken) {
+  pi->cf_type = CF_CBR;
+  pi->branch_target = target;
+  pi->actually_taken = taken;
+  add_src(pi, REG_ZPS);
+}
+
+/* Branchy: for each element, branch on a random bit and run one of two short paths */
+static void gen_branchy(Bench_Trace* trace) {
+  const uint64_t base = 0x400000, data = 0x10000000;
+  for (uint64_t i = 0; !trace->done(); i++) {
+    uint64_t value = lcg_next();
+    ctype_pin_inst pi = make_inst(base, OP_MOV, "MOV");
+    add_ld(&pi, REG_RSI, data + (i % 65536) * 8, 8);
+    add_dst(&pi, REG_RAX);
+    pi.is_move = 1;
+    trace->emit(&pi);
+
+    pi = make_inst(base + 4, OP_LOGIC, "TEST");
+    add_src(&pi, REG_RAX);
+    add_dst(&pi, REG_ZPS);
+    trace->emit(&pi);
+
+    bool taken = value & 1;
+    pi = make_inst(base + 8, OP_CF, "JNZ");
+    make_cbr(&pi, base + 28, taken);
+    trace->emit(&pi);
+
+    uint64_t path = taken ? base + 28 : base + 12;
+    for (uint64_t j = 0; j < 3; j++) {
+      pi = make_inst(path + j * 4, j == 1 ? OP_SHIFT : OP_IADD, j == 1 ? "SHL" : "ADD");
+      add_src(&pi, REG_RBX);
+      add_src(&pi, REG_RAX);
+      add_dst(&pi, REG_RBX);
+      trace->emit(&pi);
+    }
+    if (!taken) {  // the not-taken path jumps over the taken one
+      pi = make_inst(base + 24, OP_CF, "JMP");
+      pi.cf_type = CF_BR;
+      pi.branch_target = base + 40;
+      pi.actually_taken = 1;
+      trace->emit(&pi);
+    }
+
+    pi = make_inst(base + 40, OP_IADD, "ADD");
+    add_src(&pi, REG_RSI);
+    add_dst(&pi, REG_RSI);
+    add_dst(&pi, REG_ZPS);
+    trace->emit(&pi);
+
+    pi = make_inst(base + 44, OP_CF, "JNZ");
+    make_cbr(&pi, base, true);
+    trace->emit(&pi);
+  }
+}
+
+/* Memory-bound: a pointer chase over a 256MB footprint interleaved with a strided
+   read-modify-write stream */
+static void gen_memory(Bench_Trace* trace) {
+  const uint64_t base = 0x500000, heap = 0x100000000ULL, footprint = 256ULL << 20;
+  uint64_t node = heap;
+  for (uint64_t i = 0; !trace->done(); i++) {
+    uint64_t next = heap + (lcg_next() % (footprint / 64)) * 64;
+    ctype_pin_inst pi = make_inst(base, OP_MOV, "MOV");
+    add_ld(&pi, REG_RAX, node, 8);
+    add_dst(&pi, REG_RAX);
+    pi.is_move = 1;
+    trace->emit(&pi);
+    node = next;
+
+    uint64_t stream = heap + footprint + (i * 4160) % footprint;
+    pi = make_inst(base + 4, OP_IADD, "ADD");
+    add_ld(&pi, REG_RDI, stream, 8);
+    add_st(&pi, REG_RDI, stream, 8);
+    add_src(&pi, REG_RCX);
+    trace->emit(&pi);
+
+    pi = make_inst(base + 8, OP_IADD, "ADD");
+    add_src(&pi, REG_RDI);
+    add_dst(&pi, REG_RDI);
+    trace->emit(&pi);
+
+    pi = make_inst(base + 12, OP_IADD, "SUB");
+    add_src(&pi, REG_RDX);
+    add_dst(&pi, REG_RDX);
+    add_dst(&pi, REG_ZPS);
+    trace->emit(&pi);
+
+    pi = make_inst(base + 16, OP_CF, "JNZ");
+    make_cbr(&pi, base, true);
+    trace->emit(&pi);
+  }
+}
+
+/* Vector-heavy: c[i] = a[i] * b[i] + c[i] on 512-bit vectors of floats */
+static void gen_vector(Bench_Trace* trace) {
+  const uint64_t base = 0x600000, a = 0x20000000, b = 0x28000000, c = 0x30000000, len = 4ULL << 20;
+  for (uint64_t i = 0; !trace->done(); i++) {
+    uint64_t offset = (i * 64) % len;
+    ctype_pin_inst pi = make_inst(base, OP_MOV, "VMOVUPS");
+    add_ld(&pi, REG_RSI, a + offset, 64);
+    add_dst(&pi, REG_ZMM0);
+    pi.is_move = pi.is_simd = pi.is_fp = 1;
+    pi.num_simd_lanes = 16;
+    pi.lane_width_bytes = 4;
+    trace->emit(&pi);
+
+    pi = make_inst(base + 4, OP_MOV, "VMOVUPS");
+    add_ld(&pi, REG_RDI, c + offset, 64);
+    add_dst(&pi, REG_ZMM1);
+    pi.is_move = pi.is_simd = pi.is_fp = 1;
+    pi.num_simd_lanes = 16;
+    pi.lane_width_bytes = 4;
+    trace->emit(&pi);
+
+    pi = make_inst(base + 8, OP_FMA, "VFMADD231PS");
+    add_ld(&pi, REG_RDX, b + offset, 64);
+    add_src(&pi, REG_ZMM0);
+    add_src(&pi, REG_ZMM1);
+    add_dst(&pi, REG_ZMM1);
+    pi.is_simd = pi.is_fp = 1;
+    pi.num_simd_lanes = 16;
+    pi.lane_width_bytes = 4;
+    trace->emit(&pi);
+
+    pi = make_inst(base + 12, OP_MOV, "VMOVUPS");
+    add_st(&pi, REG_RDI, c + offset, 64);
+    add_src(&pi, REG_ZMM1);
+    pi.is_move = pi.is_simd = pi.is_fp = 1;
+    pi.num_simd_lanes = 16;
+    pi.lane_width_bytes = 4;
+    trace->emit(&pi);
+
+    pi = make_inst(base + 16, OP_IADD, "ADD");
+    add_src(&pi, REG_RSI);
+    add_dst(&pi, REG_RSI);
+    add_dst(&pi, REG_ZPS);
+    trace->emit(&pi);
+
+    pi = make_inst(base + 20, OP_CF, "JNZ");
+    make_cbr(&pi, base, true);
+    trace->emit(&pi);
+  }
+}
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s [-n insts] <output dir>\n"
+          "  -n  instructions per trace (default 2000000)\n"
+          "Writes branchy.trace.bz2, memory.trace.bz2 and vector.trace.bz2\n",
+          prog);
+  exit(1);
+}
+
+int main(int argc, char** argv) {
+  uint64_t num_insts = 2000000;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    if (opt == 'n')
+      num_insts = strtoull(optarg, NULL, 0);
+    else
+      usage(argv[0]);
+  }
+  if (optind != argc - 1)
+    usage(argv[0]);
+  std::string dir = argv[optind];
+
+  struct {
+    const char* name;
+    void (*gen)(Bench_Trace*);
+  } kernels[] = {{"branchy", gen_branchy}, {"memory", gen_memory}, {"vector", gen_vector}};
+  for (auto& kernel : kernels) {
+    lcg_state = 0x2545F4914F6CDD1DULL;
+    std::string path = dir + "/" + kernel.name + ".trace.bz2";
+    Bench_Trace trace(path, num_insts);
+    kernel.gen(&trace);
+    printf("%s: %llu instructions\n", path.c_str(), (unsigned long long)num_insts);
+  }
+  return 0;
+}
@@ -20,7 +20,9 @@
  */
 
 #include <asm/ldt.h>
+#include <deque>
 #include <dirent.h>
+#include <fcntl.h>
 #include <iostream>
 #include <linux/unistd.h>
 #include <signal.h>
@@ -29,6 +31,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <vector>
 #include <zlib.h>
 
 #include "../loader/cpuinfo.h"
@@ -42,6 +45,14 @@ using namespace CONTROLLER;
 KNOB<string> KnobOutputDir(KNOB_MODE_WRITEONCE, "pintool", "o", "checkpoint",
                            "Checkpoint dir name");
 KNOB<bool>   KnobDebug(KNOB_MODE_WRITEONCE, "pintool", "d", "0", "Debug mode");
+KNOB<string> KnobIcounts(KNOB_MODE_WRITEONCE, "pintool", "icounts", "",
+                         "Space separated, ascending instruction counts to "
+                         "checkpoint at, each into <o>/<icount>, in one run "
+                         "(replaces the controller). Checkpoints after the "
+                         "first only store the pages dirtied since the first");
+KNOB<UINT32> KnobCompressJobs(KNOB_MODE_WRITEONCE, "pintool", "compress_jobs",
+                              "4",
+                              "Memory regions compressed in parallel");
 
 #define DEBUG(...)                  \
   do {                              \
@@ -56,7 +67,14 @@ void syscallEntryHandler(THREADID tid, CONTEXT* ctxt, SYSCALL_STANDARD std,
                          VOID* v);
 void syscallExitHandler(THREADID tid, CONTEXT* ctxt, SYSCALL_STANDARD std,
                         VOID* v);
-void takeCheckpoint(CONTEXT* ctxt, THREADID tid);
+void takeCheckpoint(CONTEXT* ctxt, THREADID tid, const std::string& dir);
+
+/* Checkpoints at -icounts */
+std::vector<UINT64> checkpointIcounts;
+UINT32              nextCheckpoint       = 0;
+UINT64              retiredIcount        = 0;
+UINT64              nextCheckpointIcount = 0;
+void                instrumentTrace(TRACE trace, VOID* v);
 
 /* File descriptor dumping functions */
 void        dumpFDs(FILE* out, UINT pid);
@@ -78,10 +96,28 @@ void dumpExtReg(FILE* out, std::string name, UINT8* data, UINT size);
 void dumpFpState(FILE* out, CONTEXT* ctxt);
 
 /* Memory dumping functions */
-int  nextDataFileId = 0;
-void dumpMemory(FILE* out, UINT pid);
-void processMapsLine(FILE* out, const std::string& line);
-int  dumpMemoryData(const char* path, UINT8* start, UINT8* end);
+std::string checkpointDir;
+int         nextDataFileId = 0;
+void        dumpMemory(FILE* out, UINT pid);
+void        processMapsLine(FILE* out, const std::string& line);
+int         dumpMemoryData(const char* path, UINT8* start, UINT8* end,
+                           const std::vector<UINT64>* pages);
+void        finishCompressJobs();
+
+/* Incremental checkpoints: regions of the first -icounts checkpoint (the base)
+   and whether soft-dirty bits track the pages written since it was taken */
+const UINT64 DELTA_PAGE_SIZE = 4096;
+struct BaseRegion {
+  UINT64 start;
+  UINT64 end;
+  int    dataFileId;
+};
+std::vector<BaseRegion> baseRegions;
+std::string             baseDirName;
+bool                    dirtyTracking = false;
+void                    startDirtyTracking();
+bool getDirtyPages(UINT64 start, UINT64 end, const BaseRegion& base,
+                   std::vector<UINT64>& pages);
 
 /* Signal dumping functions */
 void dumpSignals(FILE* out);
@@ -137,7 +173,7 @@ void controlHandler(EVENT_TYPE ev, VOID* val, CONTEXT* ctxt, VOID* ip,
     case EVENT_START:
       std::cout << " event start\n";
       ASSERTX(ctxt);
-      takeCheckpoint(ctxt, tid);
+      takeCheckpoint(ctxt, tid, KnobOutputDir.Value());
       PIN_ExitApplication(0);
       break;
     case EVENT_STOP:
@@ -240,7 +276,7 @@ void dumpProcFileRawContent(FILE* out, std::string fileName, UINT pid) {
   std::string   relativeOutputDatFilePath = (fileName + ".dat");
   std::ofstream outputDatFileStream;
   outputDatFileStream.open(
-    (KnobOutputDir.Value() + "/" + relativeOutputDatFilePath).c_str());
+    (checkpointDir + "/" + relativeOutputDatFilePath).c_str());
 
   while(procFileInputStream.peek() != EOF) {
     std::string line;
@@ -368,9 +404,35 @@ void processMapsLine(FILE* out, const std::string& line) {
     return;
   }
 
-  if(dumpMemoryData(
-       (KnobOutputDir.Value() + "/" + dataIdSS.str() + ".dat").c_str(),
-       (UINT8*)addr1, (UINT8*)addr2)) {
+  // A region that starts where a base region did only stores its pages
+  // written since the base, as long as soft-dirty bits can tell which
+  const BaseRegion*   base = NULL;
+  std::vector<UINT64> dirtyPages;
+  for(const BaseRegion& baseRegion : baseRegions) {
+    if(dirtyTracking && baseRegion.start == addr1 &&
+       getDirtyPages(addr1, addr2, baseRegion, dirtyPages)) {
+      base = &baseRegion;
+      break;
+    }
+  }
+  std::string pagesFileName = dataIdSS.str() + ".pages";
+  if(base) {
+    FILE* pagesFile = fopen((checkpointDir + "/" + pagesFileName).c_str(), "w");
+    ASSERTX(pagesFile);
+    fwrite(dirtyPages.data(), sizeof(UINT64), dirtyPages.size(), pagesFile);
+    fclose(pagesFile);
+    std::cout << "dirty pages: " << std::dec << dirtyPages.size() << " of "
+              << (addr2 - addr1) / DELTA_PAGE_SIZE << std::endl;
+  }
+
+  int dumped = dumpMemoryData(
+    (checkpointDir + "/" + dataIdSS.str() + ".dat").c_str(), (UINT8*)addr1,
+    (UINT8*)addr2, base ? &dirtyPages : NULL);
+  if(permR == '-') {  // the program keeps running after -icounts checkpoints
+    int prot = (permW != '-' ? PROT_WRITE : 0) | (permX != '-' ? PROT_EXEC : 0);
+    mprotect(reinterpret_cast<void*>(addr1), addr2 - addr1, prot);
+  }
+  if(dumped) {
     startChild(out, "range");
     INLINE_CHILD(out, "start", "0x%lx", addr1);
     INLINE_CHILD(out, "end", "0x%lx", addr2);
@@ -391,6 +453,14 @@ void processMapsLine(FILE* out, const std::string& line) {
       endChild(out);
     }
     INLINE_CHILD(out, "data", "%d.dat", nextDataFileId);
+    if(base) {
+      INLINE_CHILD(out, "base_data", "../%s/%d.dat", baseDirName.c_str(),
+                   base->dataFileId);
+      INLINE_CHILD(out, "base_size", "0x%lx", base->end - base->start);
+      INLINE_CHILD(out, "pages", "%s", pagesFileName.c_str());
+    } else if(!checkpointIcounts.empty() && nextCheckpoint == 0) {
+      baseRegions.push_back({addr1, addr2, nextDataFileId});
+    }
     nextDataFileId++;
     endChild(out);
   } else {
@@ -398,16 +468,111 @@ void processMapsLine(FILE* out, const std::string& line) {
   }
 }
 
-int dumpMemoryData(const char* path, UINT8* start, UINT8* end) {
-  //    FILE * out = fopen(path, "w");
-  std::stringstream bzip_cmd;
-  bzip_cmd << "bzip2 > " << path;
-  FILE* out = popen(bzip_cmd.str().c_str(), "w");
+const UINT64 SOFT_DIRTY_BIT = 1ULL << 55;
+
+// Reads the /proc/self/pagemap entries of numPages pages from start
+bool readPagemap(UINT64 start, UINT64 numPages, std::vector<UINT64>& entries) {
+  int pagemap = open("/proc/self/pagemap", O_RDONLY);
+  if(pagemap < 0)
+    return false;
+  entries.resize(numPages);
+  size_t size    = numPages * sizeof(UINT64);
+  off_t  offset  = start / DELTA_PAGE_SIZE * sizeof(UINT64);
+  bool   readAll = pread(pagemap, entries.data(), size, offset) ==
+                 (ssize_t)size;
+  close(pagemap);
+  return readAll;
+}
+
+// Returns the pages of [start, end) that may have been written since the base
+// checkpoint: the soft-dirty ones and the ones past the end of the base region.
+bool getDirtyPages(UINT64 start, UINT64 end, const BaseRegion& base,
+                   std::vector<UINT64>& pages) {
+  UINT64              numPages = (end - start) / DELTA_PAGE_SIZE;
+  std::vector<UINT64> entries;
+  if(!readPagemap(start, numPages, entries))
+    return false;
+  pages.clear();
+  for(UINT64 page = 0; page < numPages; ++page) {
+    if((entries[page] & SOFT_DIRTY_BIT) ||
+       start + (page + 1) * DELTA_PAGE_SIZE > base.end) {
+      pages.push_back(page);
+    }
+  }
+  return true;
+}
+
+// Clears the soft-dirty bits after the base checkpoint and checks that the
+// kernel sets them again on a write (it needs CONFIG_MEM_SOFT_DIRTY).
+void startDirtyTracking() {
+  static char probe[2 * DELTA_PAGE_SIZE];
+  FILE*       clearRefs = fopen("/proc/self/clear_refs", "w");
+  if(clearRefs) {
+    fprintf(clearRefs, "4");
+    fclose(clearRefs);
+  }
+
+  UINT64 probePage = ((UINT64)probe + DELTA_PAGE_SIZE - 1) &
+                     ~(DELTA_PAGE_SIZE - 1);
+  *(volatile char*)probePage = 1;
+  std::vector<UINT64> entries;
+  dirtyTracking = clearRefs && readPagemap(probePage, 1, entries) &&
+                  (entries[0] & SOFT_DIRTY_BIT);
+  if(!dirtyTracking) {
+    std::cerr << "Warning: soft-dirty bits are not available, every "
+                 "checkpoint will store full memory images"
+              << std::endl;
+  }
+}
+
+// bzip2 runs on the raw region files in the background, with at most
+// -compress_jobs at a time, while the tool goes on copying regions
+std::deque<FILE*> compressJobs;
+
+void waitForCompressJob() {
+  FILE* job = compressJobs.front();
+  compressJobs.pop_front();
+  if(pclose(job)) {
+    std::cerr << "ERROR: Compressing a memory region failed!" << std::endl;
+    exit(1);
+  }
+}
+
+void finishCompressJobs() {
+  while(!compressJobs.empty())
+    waitForCompressJob();
+}
+
+void compressDataFile(const std::string& rawPath, const std::string& path) {
+  UINT32 maxJobs = KnobCompressJobs.Value() ? KnobCompressJobs.Value() : 1;
+  while(compressJobs.size() >= maxJobs)
+    waitForCompressJob();
+  std::string cmd = "bzip2 -c '" + rawPath + "' > '" + path + "' && rm '" +
+                    rawPath + "'";
+  FILE* job = popen(cmd.c_str(), "r");
+  ASSERTX(job);
+  compressJobs.push_back(job);
+}
+
+// Writes the region [start, end), or only its given pages, to path.raw and
+// hands it to a bzip2 job that produces path.
+int dumpMemoryData(const char* path, UINT8* start, UINT8* end,
+                   const std::vector<UINT64>* pages) {
+  std::string rawPath = std::string(path) + ".raw";
+  FILE*       out     = fopen(rawPath.c_str(), "w");
+  ASSERTX(out);
 
-  const UINT64 BUF_SIZE = 4096;
+  const UINT64 BUF_SIZE = DELTA_PAGE_SIZE;
   char         buf[BUF_SIZE];
   UINT64       total_bytes_written = 0;
-  for(UINT8* addr = start; addr < end; addr += BUF_SIZE) {
+  UINT64       expected_bytes      = (UINT64)(end - start);
+  UINT64       num_chunks = (expected_bytes + BUF_SIZE - 1) / BUF_SIZE;
+  if(pages) {
+    expected_bytes = pages->size() * BUF_SIZE;
+    num_chunks     = pages->size();
+  }
+  for(UINT64 chunk = 0; chunk < num_chunks; ++chunk) {
+    UINT8*         addr = start + (pages ? (*pages)[chunk] : chunk) * BUF_SIZE;
     UINT64         bytes_left = end - addr;
     UINT64         num_bytes  = bytes_left < BUF_SIZE ? bytes_left : BUF_SIZE;
     EXCEPTION_INFO ex;
@@ -415,7 +580,8 @@ int dumpMemoryData(const char* path, UINT8* start, UINT8* end) {
     if(bytes_copied != num_bytes) {
       std::cerr << "Could not copy data at " << start << ": "
                 << PIN_ExceptionToString(&ex) << std::endl;
-      pclose(out);
+      fclose(out);
+      unlink(rawPath.c_str());
       return 0;
     }
     UINT64 bytes_written = fwrite(buf, 1, num_bytes, out);
@@ -425,18 +591,18 @@ int dumpMemoryData(const char* path, UINT8* start, UINT8* end) {
     }
     total_bytes_written += bytes_written;
   }
-  UINT64 region_size = (UINT64)(end - start);
-  INT64  delta       = total_bytes_written - region_size;
+  INT64 delta = total_bytes_written - expected_bytes;
   if(delta != 0) {
     std::cerr << "ERROR: Saving the content of a region to file " << path
               << " failed!" << std::endl;
     std::cerr << "Bytes written: " << std::dec << total_bytes_written
-              << ", region size: " << region_size << ", delta: " << delta
+              << ", region size: " << expected_bytes << ", delta: " << delta
               << std::endl;
-    pclose(out);
+    fclose(out);
     exit(1);
   }
-  pclose(out);
+  fclose(out);
+  compressDataFile(rawPath, path);
   return 1;
 }
 
@@ -646,19 +812,59 @@ void dumpFpState(FILE* out, CONTEXT* ctxt) {
   endChild(out);
 }
 
-void takeCheckpoint(CONTEXT* ctxt, THREADID tid) {
+void takeCheckpoint(CONTEXT* ctxt, THREADID tid, const std::string& dir) {
   DEBUG("Taking checkpoint\n");
   ASSERTX(ctxt);
-  mkdir(KnobOutputDir.Value().c_str(), S_IRWXU);
-  FILE* out = fopen((KnobOutputDir.Value() + "/main").c_str(), "w");
+  checkpointDir  = dir;
+  nextDataFileId = 0;
+  mkdir(checkpointDir.c_str(), S_IRWXU);
+  FILE* out = fopen((checkpointDir + "/main").c_str(), "w");
   INLINE_CHILD(out, "generator", "pincpt");
   startChild(out, "processes");
   dumpProcessInfo(out, ctxt);
   endChild(out);
   fclose(out);
+  finishCompressJobs();
   // exit(0);
 }
 
+ADDRINT checkpointDue() {
+  return retiredIcount >= nextCheckpointIcount;
+}
+
+void takeScheduledCheckpoint(CONTEXT* ctxt, THREADID tid) {
+  std::stringstream dirNameSS;
+  dirNameSS << std::dec << checkpointIcounts[nextCheckpoint];
+  std::cout << "Checkpoint at instruction " << retiredIcount << std::endl;
+  mkdir(KnobOutputDir.Value().c_str(), S_IRWXU);
+  takeCheckpoint(ctxt, tid, KnobOutputDir.Value() + "/" + dirNameSS.str());
+  if(nextCheckpoint == 0) {
+    baseDirName = dirNameSS.str();
+    startDirtyTracking();
+  }
+  if(++nextCheckpoint == checkpointIcounts.size()) {
+    PIN_ExitApplication(0);
+  }
+  nextCheckpointIcount = checkpointIcounts[nextCheckpoint];
+}
+
+void countBbl(UINT32 numIns) {
+  retiredIcount += numIns;
+}
+
+// Checkpoints are taken at the first basic block boundary at or after each
+// instruction count
+void instrumentTrace(TRACE trace, VOID* v) {
+  for(BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
+    INS head = BBL_InsHead(bbl);
+    INS_InsertIfCall(head, IPOINT_BEFORE, (AFUNPTR)checkpointDue, IARG_END);
+    INS_InsertThenCall(head, IPOINT_BEFORE, (AFUNPTR)takeScheduledCheckpoint,
+                       IARG_CONTEXT, IARG_THREAD_ID, IARG_END);
+    BBL_InsertCall(bbl, IPOINT_BEFORE, (AFUNPTR)countBbl, IARG_UINT32,
+                   BBL_NumIns(bbl), IARG_END);
+  }
+}
+
 VOID Fini(INT32 code, VOID* v) {
   std::cout << "Fini\n";
 }
@@ -674,9 +880,21 @@ int main(int argc, char* argv[]) {
   PIN_AddSyscallEntryFunction(syscallEntryHandler, 0);
   PIN_AddSyscallExitFunction(syscallExitHandler, 0);
 
-  // Activate alarm, must be done before PIN_StartProgram
-  control.RegisterHandler(controlHandler, 0, TRUE);
-  control.Activate();
+  std::stringstream icountsSS(KnobIcounts.Value());
+  UINT64            icount;
+  while(icountsSS >> icount) {
+    ASSERTX(checkpointIcounts.empty() || icount > checkpointIcounts.back());
+    checkpointIcounts.push_back(icount);
+  }
+
+  if(!checkpointIcounts.empty()) {
+    nextCheckpointIcount = checkpointIcounts[0];
+    TRACE_AddInstrumentFunction(instrumentTrace, 0);
+  } else {
+    // Activate alarm, must be done before PIN_StartProgram
+    control.RegisterHandler(controlHandler, 0, TRUE);
+    control.Activate();
+  }
 
   PIN_AddFiniFunction(Fini, 0);
 
@@ -23,9 +23,12 @@
 
 #include <getopt.h>
 #include <iomanip>
+#include <poll.h>
 #include <set>
 #include <sstream>
 #include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/utsname.h>
 
 #include "checkpoint_reader.h"
@@ -36,7 +39,9 @@
 void execute_tracee(const char* application, char* const argv[],
                     char* const envp[], bool print_argv_envp);
 void execute_tracer(pid_t child_pid, bool running_with_pin,
-                    bool external_pintool);
+                    bool external_pintool, bool mmap_images);
+void run_restore_server(pid_t template_pid, bool running_with_pin,
+                        bool external_pintool);
 int  attach_pin_to_child(pid_t child_pid, bool external_pintool);
 void load_fp_state(pid_t pid);
 void jump_to_infinite_loop(pid_t pid);
@@ -44,7 +49,8 @@ void usage(const char* name_of_loader_exe, int longest_option_length);
 void parse_options(int argc, char* const argv[], int& run_natively_without_pin,
                    int& run_external_pintool, int& print_argv_envp,
                    int& force_even_if_wrong_kernel,
-                   int& force_even_if_wrong_cpu, int& longest_option_length);
+                   int& force_even_if_wrong_cpu, int& mmap_images,
+                   int& longest_option_length);
 void parse_positional_arguments(int argc, char* const argv[],
                                 int run_natively_without_pin,
                                 int run_external_pintool,
@@ -59,6 +65,12 @@ void                  check_os_info();
 void                  check_cpuinfo();
 
 
+static std::string socket_path;
+static std::string restore_server_path;
+static std::string pintool_path;
+static std::string pintool_args;
+static int         core_id;
+
 void execute_tracee(const char* application, char* const argv[],
                     char* const envp[], bool print_argv_envp) {
   debug("Inside tracee");
@@ -74,7 +86,7 @@ void execute_tracee(const char* application, char* const argv[],
 }
 
 void execute_tracer(pid_t child_pid, bool running_with_pin,
-                    bool external_pintool) {
+                    bool external_pintool, bool mmap_images) {
   debug("Inside tracer: child_pid=%d", child_pid);
 
   set_child_pid(child_pid);
@@ -84,11 +96,16 @@ void execute_tracer(pid_t child_pid, bool running_with_pin,
   assertm(WIFSTOPPED(status), "Child process did not stop\n");
 
   allocate_new_regions(child_pid);
-  write_data_to_regions(child_pid);
+  write_data_to_regions(child_pid, mmap_images);
   update_region_protections(child_pid);
   load_fp_state(child_pid);
   load_registers(child_pid);
 
+  if(!restore_server_path.empty()) {
+    run_restore_server(child_pid, running_with_pin, external_pintool);
+    return;
+  }
+
   if(running_with_pin) {
     jump_to_infinite_loop(child_pid);
   }
@@ -106,10 +123,123 @@ void execute_tracer(pid_t child_pid, bool running_with_pin,
   assertm(WIFEXITED(status), "Child process did not terminate normally\n");
 }
 
-static std::string socket_path;
-static std::string pintool_path;
-static std::string pintool_args;
-static int         core_id;
+// Reaps the restored processes (and pin launchers) that have finished. The
+// template itself never leaves its ptrace stop, so it only shows up here if it
+// was killed.
+static void reap_restored_processes(pid_t template_pid) {
+  int   status;
+  pid_t pid;
+  while((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    if(!WIFEXITED(status) && !WIFSIGNALED(status))
+      continue;
+    if(pid == template_pid)
+      vfatal("The restored template process died");
+    std::cout << "Restore server: process " << pid << " finished" << std::endl;
+  }
+}
+
+// Keeps the restored tracee stopped as a template and serves requests on the
+// unix socket restore_server_path. Each request is one line, optionally
+// holding "<socket_path> <core_id>" for the Scarab pintool; the template forks
+// a copy of itself, which is started (or attached by pin) and whose pid is
+// sent back. The line "quit" stops the server.
+void run_restore_server(pid_t template_pid, bool running_with_pin,
+                        bool external_pintool) {
+  void* loop_address = NULL;
+  if(running_with_pin) {
+    // Every copy waits for pin in the same infinite loop
+    loop_address = execute_mmap(template_pid, NULL, FPSTATE_SIZE,
+                                PROT_READ | PROT_EXEC,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(loop_address == (void*)-1) {
+      fatal_and_kill_child(template_pid, "Could not map the infinite loop");
+    }
+    char infinite_loop[8] = {(char)0xeb, (char)0xfe};  // jmp 0x-2
+    execute_memcpy(template_pid, loop_address, infinite_loop,
+                   sizeof(infinite_loop));
+  }
+
+  struct sockaddr_un server_addr;
+  memset(&server_addr, 0, sizeof(server_addr));
+  server_addr.sun_family = AF_UNIX;
+  if(restore_server_path.size() >= sizeof(server_addr.sun_path)) {
+    fatal_and_kill_child(template_pid, "Socket path is too long: %s",
+                         restore_server_path.c_str());
+  }
+  strcpy(server_addr.sun_path, restore_server_path.c_str());
+  unlink(restore_server_path.c_str());
+  int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(server_fd < 0 ||
+     bind(server_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) ||
+     listen(server_fd, 16)) {
+    fatal_and_kill_child(template_pid, "Could not listen on %s: %s",
+                         restore_server_path.c_str(), std::strerror(errno));
+  }
+  signal(SIGPIPE, SIG_IGN);
+  std::cout << "Restore server listening on " << restore_server_path
+            << std::endl;
+
+  while(1) {
+    reap_restored_processes(template_pid);
+    struct pollfd server_poll = {server_fd, POLLIN, 0};
+    if(poll(&server_poll, 1, 100) <= 0)
+      continue;
+    int conn_fd = accept(server_fd, NULL, NULL);
+    if(conn_fd < 0)
+      continue;
+
+    std::string request;
+    char        c;
+    while(read(conn_fd, &c, 1) == 1 && c != '\n')
+      request += c;
+    if(request == "quit") {
+      close(conn_fd);
+      break;
+    }
+    std::istringstream request_stream(request);
+    std::string        request_socket_path;
+    int                request_core_id;
+    if(request_stream >> request_socket_path >> request_core_id) {
+      socket_path = request_socket_path;
+      core_id     = request_core_id;
+    }
+
+    pid_t restored_pid = execute_clone_sibling(template_pid);
+    if(running_with_pin) {
+      struct user_regs_struct regs;
+      if(ptrace(PTRACE_GETREGS, restored_pid, NULL, &regs)) {
+        perror("PTRACE_GETREGS");
+        kill_and_exit(restored_pid);
+      }
+      regs.rip = (unsigned long long)loop_address;
+      if(ptrace(PTRACE_SETREGS, restored_pid, NULL, &regs)) {
+        perror("PTRACE_SETREGS");
+        kill_and_exit(restored_pid);
+      }
+    }
+    fflush(stdout);
+    fflush(stderr);
+    detach_process(restored_pid);
+
+    if(running_with_pin && fork() == 0) {
+      close(server_fd);
+      close(conn_fd);
+      attach_pin_to_child(restored_pid, external_pintool);
+      perror("execv pin");
+      _exit(EXIT_FAILURE);
+    }
+
+    std::string reply = std::to_string(restored_pid) + "\n";
+    if(write(conn_fd, reply.c_str(), reply.size()) < 0)
+      perror("Restore server reply");
+    close(conn_fd);
+  }
+
+  close(server_fd);
+  unlink(restore_server_path.c_str());
+  kill(template_pid, SIGKILL);
+  waitpid(template_pid, NULL, 0);
+}
 
 static const char* run_natively_without_pin_option = "run_natively_without_pin";
 static const char* run_external_pintool_option     = "run_external_pintool";
@@ -118,6 +248,8 @@ static const char* force_even_if_wrong_kernel_option =
   "force_even_if_wrong_kernel";
 static const char* force_even_if_wrong_cpu_option = "force_even_if_wrong_cpu";
 static const char* pintool_args_option            = "pintool_args";
+static const char* mmap_images_option             = "mmap_images";
+static const char* restore_server_option          = "restore_server";
 
 namespace {
 
@@ -214,6 +346,14 @@ void usage(const char* name_of_loader_exe, int longest_option_length) {
   std::cerr << std::left << std::setw(text_width)
             << option_prefix + pintool_args_option
             << "pass extra arguments to the pintool\n";
+  std::cerr << std::left << std::setw(text_width)
+            << option_prefix + mmap_images_option
+            << "map the memory regions MAP_PRIVATE from uncompressed images "
+               "cached in the checkpoint dir instead of copying them\n";
+  std::cerr << std::left << std::setw(text_width)
+            << option_prefix + restore_server_option + " <path>"
+            << "restore once, then fork a restored copy for every request on "
+               "the unix socket <path>\n";
   std::cerr << std::left << std::setw(text_width)
             << option_prefix + print_argv_envp_option
             << "print the contents of argv and envp that we pass to execve\n";
@@ -234,7 +374,8 @@ void usage(const char* name_of_loader_exe, int longest_option_length) {
 void parse_options(int argc, char* const argv[], int& run_natively_without_pin,
                    int& run_external_pintool, int& print_argv_envp,
                    int& force_even_if_wrong_kernel,
-                   int& force_even_if_wrong_cpu, int& longest_option_length) {
+                   int& force_even_if_wrong_cpu, int& mmap_images,
+                   int& longest_option_length) {
   static struct option long_options[] = {
     {run_natively_without_pin_option, no_argument, &run_natively_without_pin,
      true},
@@ -245,6 +386,8 @@ void parse_options(int argc, char* const argv[], int& run_natively_without_pin,
     {force_even_if_wrong_cpu_option, no_argument, &force_even_if_wrong_cpu,
      true},
     {pintool_args_option, required_argument, NULL, 'p'},
+    {mmap_images_option, no_argument, &mmap_images, true},
+    {restore_server_option, required_argument, NULL, 's'},
     {"help", no_argument, NULL, 'h'},
     {0, 0, 0, 0}};
 
@@ -265,6 +408,10 @@ void parse_options(int argc, char* const argv[], int& run_natively_without_pin,
 
       case 'p':
         pintool_args = optarg;
+        break;
+
+      case 's':
+        restore_server_path = optarg;
 
       case '?': /* unrecognized option, but moving onto next option anyways */
         break;
@@ -406,11 +553,12 @@ int main(int argc, char* const argv[], char* const envp[]) {
   int print_argv_envp            = false;
   int force_even_if_wrong_kernel = false;
   int force_even_if_wrong_cpu    = false;
+  int mmap_images                = false;
   int longest_option_length      = -1;
 
   parse_options(argc, argv, run_natively_without_pin, run_external_pintool,
                 print_argv_envp, force_even_if_wrong_kernel,
-                force_even_if_wrong_cpu, longest_option_length);
+                force_even_if_wrong_cpu, mmap_images, longest_option_length);
   parse_positional_arguments(argc, argv, run_natively_without_pin,
                              run_external_pintool, longest_option_length);
 
@@ -434,7 +582,8 @@ int main(int argc, char* const argv[], char* const envp[]) {
       checkpoint_envp_vector.empty() ? envp : checkpoint_envp_vector.data(),
       print_argv_envp);
   } else {
-    execute_tracer(fork_pid, !run_natively_without_pin, run_external_pintool);
+    execute_tracer(fork_pid, !run_natively_without_pin, run_external_pintool,
+                   mmap_images);
   }
 
   return 0;
@@ -24,6 +24,8 @@
 #include <cassert>
 #include <fcntl.h>
 #include <iostream>
+#include <limits.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <vector>
 
@@ -39,10 +41,18 @@ static pid_t child_pid = 0;
 
 char fpstate_buffer[FPSTATE_SIZE];
 
+// Pages of incremental checkpoints (see create_checkpoint -icounts)
+static const size_t DELTA_PAGE_SIZE = 4096;
+
 struct Checkpoint_Memory_Region {
   RegionInfo  region_info;
   bool        already_mapped;
   std::string data_file;
+  // Set for incremental regions: data_file then only holds the pages listed in
+  // pages_file, and the rest of the region comes from base_data_file
+  std::string base_data_file;
+  uint64_t    base_size;
+  std::string pages_file;
 };
 
 static Checkpoint_Memory_Region memory_regions[MAX_MEMORY_REGIONS];
@@ -266,6 +276,13 @@ static void read_memory_regions() {
 
     memory_regions[i].data_file = std::string(
       require_str(range_config, "data"));
+    const char* base_data = hconfig_value(range_config, "base_data");
+    if(base_data) {
+      memory_regions[i].base_data_file = std::string(base_data);
+      memory_regions[i].base_size = require_uint64(range_config, "base_size");
+      memory_regions[i].pages_file = std::string(
+        require_str(range_config, "pages"));
+    }
 
     num_valid_memory_regions += 1;
   }
@@ -735,7 +752,153 @@ void allocate_new_regions(pid_t child_pid) {
   }
 }
 
-void write_data_to_regions(pid_t child_pid) {
+// Decompresses the bzip2 file (relative to the checkpoint dir), which must hold
+// exactly size bytes, into buffer.
+static void read_compressed_file(pid_t child_pid, const std::string& file,
+                                 char* buffer, size_t size) {
+  std::string cmd = std::string("bzip2 -dc ") + checkpoint_dir + "/" + file;
+  DEBUG(cmd);
+  FILE* data_file = popen(cmd.c_str(), "r");
+  if(!data_file) {
+    fatal_and_kill_child(child_pid, "Error opening a dat file: %s",
+                         file.c_str());
+  }
+  size_t bytes_read = fread(buffer, 1, size, data_file);
+  if(bytes_read != size) {
+    fatal_and_kill_child(child_pid,
+                         "dat file did not have enough bytes: %s. "
+                         "bytes_read: %zu, expected: %zu",
+                         file.c_str(), bytes_read, size);
+  }
+
+  char temp_byte;
+  bytes_read = fread(&temp_byte, 1, 1, data_file);
+  if(bytes_read == 1 || !feof(data_file)) {
+    fatal_and_kill_child(child_pid, "dat file has too many bytes: %s",
+                         file.c_str());
+  }
+  pclose(data_file);
+}
+
+// Fills buffer with the contents of region i. An incremental region starts
+// from its region in the base checkpoint (zero filled past its end) and then
+// has the pages dirtied since the base written over it.
+static void read_region_data(pid_t child_pid, int i, char* buffer,
+                             size_t region_size) {
+  const Checkpoint_Memory_Region& region = memory_regions[i];
+  if(region.base_data_file.empty()) {
+    read_compressed_file(child_pid, region.data_file, buffer, region_size);
+    return;
+  }
+
+  if(region.base_size <= region_size) {
+    memset(buffer + region.base_size, 0, region_size - region.base_size);
+    read_compressed_file(child_pid, region.base_data_file, buffer,
+                         region.base_size);
+  } else {
+    std::vector<char> base(region.base_size);
+    read_compressed_file(child_pid, region.base_data_file, base.data(),
+                         region.base_size);
+    memcpy(buffer, base.data(), region_size);
+  }
+
+  std::string pages_path = checkpoint_dir + "/" + region.pages_file;
+  FILE*       pages_file = fopen(pages_path.c_str(), "r");
+  if(!pages_file) {
+    fatal_and_kill_child(child_pid, "Error opening a pages file: %s",
+                         region.pages_file.c_str());
+  }
+  std::vector<uint64_t> pages;
+  uint64_t              page;
+  while(fread(&page, sizeof(page), 1, pages_file) == 1) {
+    if((page + 1) * DELTA_PAGE_SIZE > region_size) {
+      fatal_and_kill_child(child_pid, "Page %" PRIu64 " is outside of %s",
+                           page, region.data_file.c_str());
+    }
+    pages.push_back(page);
+  }
+  fclose(pages_file);
+
+  std::vector<char> delta(pages.size() * DELTA_PAGE_SIZE);
+  read_compressed_file(child_pid, region.data_file, delta.data(),
+                       delta.size());
+  for(size_t j = 0; j < pages.size(); ++j) {
+    memcpy(buffer + pages[j] * DELTA_PAGE_SIZE, &delta[j * DELTA_PAGE_SIZE],
+           DELTA_PAGE_SIZE);
+  }
+}
+
+// Returns the absolute path of the uncompressed image of region i, creating it
+// next to the compressed data file the first time the checkpoint is loaded.
+static std::string get_region_image(pid_t child_pid, int i,
+                                    size_t region_size) {
+  char abs_dir[PATH_MAX];
+  if(!realpath(checkpoint_dir.c_str(), abs_dir)) {
+    fatal_and_kill_child(child_pid, "Could not resolve the checkpoint dir %s",
+                         checkpoint_dir.c_str());
+  }
+  std::string image_path = std::string(abs_dir) + "/" +
+                           memory_regions[i].data_file;
+  if(image_path.size() > 4 &&
+     !image_path.compare(image_path.size() - 4, 4, ".bz2")) {
+    image_path.resize(image_path.size() - 4);
+  }
+  image_path += ".img";
+
+  struct stat image_stat;
+  if(!stat(image_path.c_str(), &image_stat) &&
+     (size_t)image_stat.st_size == region_size) {
+    return image_path;
+  }
+
+  // Write to a temporary name so that concurrent loaders never map a
+  // partially written image
+  std::string temp_path = image_path + ".tmp" + std::to_string(getpid());
+  char*       temp_buffer = new char[region_size];
+  read_region_data(child_pid, i, temp_buffer, region_size);
+  FILE* image_file = fopen(temp_path.c_str(), "w");
+  bool  written    = image_file &&
+                  fwrite(temp_buffer, 1, region_size, image_file) == region_size;
+  delete[] temp_buffer;
+  if(image_file && fclose(image_file))
+    written = false;
+  if(!written || rename(temp_path.c_str(), image_path.c_str())) {
+    unlink(temp_path.c_str());
+    fatal_and_kill_child(child_pid,
+                         "Could not create the image of %s (region size %zu)",
+                         memory_regions[i].data_file.c_str(), region_size);
+  }
+  return image_path;
+}
+
+// Replaces region i of the child with a private mapping of its image, so that
+// pages are faulted in from the page cache on first use instead of being
+// copied up front.
+static void map_region_image(pid_t child_pid, int i, size_t region_size) {
+  const RegionInfo& checkpoint_region = memory_regions[i].region_info;
+  std::string       image_path = get_region_image(child_pid, i, region_size);
+  void* addr = (void*)checkpoint_region.range.inclusive_lower_bound;
+
+  int fd = execute_open(child_pid, image_path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    fatal_and_kill_child(child_pid, "open() failed in the child for %s",
+                         image_path.c_str());
+  }
+  void* mapped_addr = execute_mmap(child_pid, addr, region_size,
+                                   PROT_READ | PROT_WRITE | PROT_EXEC,
+                                   MAP_PRIVATE | MAP_FIXED, fd, 0);
+  if(mapped_addr != addr) {
+    std::cerr << "Checkpoint region: " << checkpoint_region << std::endl;
+    std::cerr << "mmap return value: " << mapped_addr << "\n";
+    fatal_and_kill_child(child_pid, "mmap() did not map the region image");
+  }
+  if(execute_close(child_pid, fd)) {
+    fatal_and_kill_child(child_pid, "close() failed after mapping %s",
+                         image_path.c_str());
+  }
+}
+
+void write_data_to_regions(pid_t child_pid, bool mmap_images) {
   std::cout << "Writing data to all regions ..." << std::endl;
   auto[sharedmem_tracer_addr, sharedmem_tracee_addr] = allocate_shared_memory(
     child_pid);
@@ -772,31 +935,14 @@ void write_data_to_regions(pid_t child_pid) {
       continue;
     }
 
-    char*       temp_buffer = new char[region_size];
-    std::string cmd         = std::string("bzip2 -dc ") + checkpoint_dir + "/" +
-                      memory_regions[i].data_file;
-    DEBUG(cmd);
-    FILE* data_file = popen(cmd.c_str(), "r");
-    if(!data_file) {
-      fatal_and_kill_child(child_pid, "Error opening a dat file: %s",
-                           memory_regions[i].data_file.c_str());
-    }
-    size_t bytes_read = fread(temp_buffer, 1, region_size, data_file);
-    if(bytes_read != region_size) {
-      fatal_and_kill_child(child_pid,
-                           "dat file did not have enough bytes: %s. "
-                           "bytes_read: %d, region_size: %d",
-                           memory_regions[i].data_file.c_str(), bytes_read,
-                           region_size);
+    if(mmap_images && i != heap_region_id && i != stack_region_id &&
+       i != vsyscall_region_id && i != vdso_region_id && i != vvar_region_id) {
+      map_region_image(child_pid, i, region_size);
+      continue;
     }
 
-    char temp_byte;
-    bytes_read = fread(&temp_byte, 1, 1, data_file);
-    if(bytes_read == 1 || !feof(data_file)) {
-      fatal_and_kill_child(child_pid, "dat file has too many bytes: %s",
-                           memory_regions[i].data_file.c_str());
-    }
-    fclose(data_file);
+    char* temp_buffer = new char[region_size];
+    read_region_data(child_pid, i, temp_buffer, region_size);
 
     if(i == vsyscall_region_id || i == vdso_region_id || i == vvar_region_id) {
       DEBUG("asserting regions are equal: start");
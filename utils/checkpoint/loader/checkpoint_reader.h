@@ -55,7 +55,10 @@ const char* get_checkpoint_exe_path();
 
 void allocate_new_regions(pid_t child_pid);
 
-void write_data_to_regions(pid_t child_pid);
+// With mmap_images, every region except the heap, the stack and the kernel
+// provided ones is mapped MAP_PRIVATE from an uncompressed image file cached
+// in the checkpoint dir instead of being copied through shared memory.
+void write_data_to_regions(pid_t child_pid, bool mmap_images);
 
 void update_region_protections(pid_t child_pid);
 
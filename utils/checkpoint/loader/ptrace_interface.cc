@@ -46,6 +46,7 @@
 #include "ptrace_interface.h"
 
 #include <cstdarg>
+#include <sched.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <unistd.h>
@@ -60,6 +61,7 @@
 #define BRK_SYSCALL 12
 #define MREMAP_SYSCALL 25
 #define SHMAT_SYSCALL 30
+#define CLONE_SYSCALL 56
 
 static constexpr int64_t SHARED_MEMORY_SIZE = 2 * 1024 * 1024;
 
@@ -394,6 +396,77 @@ void* execute_shmat(pid_t pid, int shmid, const void* shmaddr, int shmflg) {
     (unsigned long long int)shmaddr, (unsigned long long int)shmflg, 0, 0, 0);
 }
 
+// Make pid (stopped at a restored state) fork a copy of itself by injecting
+// clone(CLONE_PARENT | SIGCHLD) at its rip. CLONE_PARENT makes the copy a
+// sibling of pid, so the tracer reaps it instead of pid having to. The copy is
+// attached through PTRACE_O_TRACEFORK and both processes are left stopped with
+// the registers and text they had before the injection. Returns the pid of
+// the copy.
+pid_t execute_clone_sibling(pid_t pid) {
+  if(ptrace(PTRACE_SETOPTIONS, pid, NULL,
+            (void*)(PTRACE_O_TRACEFORK | PTRACE_O_EXITKILL))) {
+    perror("PTRACE_SETOPTIONS");
+    kill_and_exit(pid);
+  }
+
+  struct user_regs_struct oldregs;
+  if(ptrace(PTRACE_GETREGS, pid, NULL, &oldregs)) {
+    perror("PTRACE_GETREGS");
+    kill_and_exit(pid);
+  }
+
+  struct user_regs_struct newregs;
+  memmove(&newregs, &oldregs, sizeof(newregs));
+  newregs.rax = CLONE_SYSCALL;
+  newregs.rdi = CLONE_PARENT | SIGCHLD;
+  newregs.rsi = 0;  // keep the stack, like fork()
+  newregs.rdx = 0;
+  newregs.r10 = 0;
+  newregs.r8  = 0;
+
+  char old_word[8];
+  char new_word[8] = {0x0f, 0x05};  // SYSCALL
+  poke_text(pid, (char*)oldregs.rip, new_word, old_word, sizeof(new_word));
+  if(ptrace(PTRACE_SETREGS, pid, NULL, &newregs)) {
+    perror("PTRACE_SETREGS");
+    kill_and_exit(pid);
+  }
+
+  // The first stop is the fork event, the second one the end of the syscall
+  unsigned long new_pid = 0;
+  for(int stops = 0; stops < 2; ++stops) {
+    int status;
+    if(ptrace(PTRACE_SINGLESTEP, pid, NULL, NULL)) {
+      perror("PTRACE_SINGLESTEP");
+      kill_and_exit(pid);
+    }
+    if(waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status)) {
+      fatal_and_kill_child(pid, "clone() injection did not stop the process");
+    }
+    if(status >> 8 == (SIGTRAP | (PTRACE_EVENT_FORK << 8))) {
+      if(ptrace(PTRACE_GETEVENTMSG, pid, NULL, &new_pid)) {
+        perror("PTRACE_GETEVENTMSG");
+        kill_and_exit(pid);
+      }
+    } else {
+      break;
+    }
+  }
+  restore(pid, oldregs, old_word, sizeof(old_word));
+  if(!new_pid) {
+    fatal_and_kill_child(pid, "clone() did not create a new process");
+  }
+
+  // The copy starts in a SIGSTOP stop with the injected text in its memory
+  int status;
+  if(waitpid(new_pid, &status, __WALL) != (pid_t)new_pid ||
+     !WIFSTOPPED(status)) {
+    fatal_and_kill_child(new_pid, "The cloned process did not stop");
+  }
+  restore(new_pid, oldregs, old_word, sizeof(old_word));
+  return new_pid;
+}
+
 std::pair<void*, void*> allocate_shared_memory(pid_t pid) {
   int  USER_READ_WRITE  = 0600;
   auto shared_memory_id = shmget(IPC_PRIVATE, SHARED_MEMORY_SIZE,
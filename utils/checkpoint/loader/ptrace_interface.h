@@ -88,6 +88,7 @@ void poke_text(pid_t pid, char* where, const char* new_text, char* old_text,
 void restore(pid_t pid, struct user_regs_struct oldregs, char* old_word,
              size_t old_word_size);
 void detach_process(pid_t pid);
+pid_t execute_clone_sibling(pid_t pid);
 
 std::pair<void*, void*> allocate_shared_memory(pid_t child_pid);
 void shared_memory_memcpy(pid_t pid, void* dest, void* src, int64_t n,
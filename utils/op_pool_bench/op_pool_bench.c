@@ -0,0 +1,205 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : utils/op_pool_bench/op_pool_bench.c
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Microbenchmark for the layout of Op and the op pool slabs.  It
+ *                reports how many cache lines the node stage ready-list walk and
+ *                wake_up_ops touch per op, then times both walks over ops taken
+ *                from a shuffled free list, once with the pool's aligned slabs
+ *                and once with the old calloc'd chunks.  Only the layout of Op
+ *                is used, so it builds without the rest of the simulator.
+ ***************************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "op.h"
+
+#define SLAB_ENTRIES 128 /* matches OP_POOL_ENTRIES_INC */
+#define LINE_SIZE 64
+#define NUM_OPS (1 << 16)
+#define WALK_OPS 512 /* roughly a node table's worth of ops */
+#define WAKE_DEPS 4
+#define NUM_ROUNDS 20000
+
+typedef struct Field_struct {
+  const char* name;
+  size_t offset;
+  size_t size;
+} Field;
+
+#define FIELD(f) \
+  { #f, offsetof(Op, f), sizeof(((Op*)0)->f) }
+
+/* fields read by node_issue_queue's ready-list scan and by fill_rdy_list */
+static const Field rdy_fields[] = {
+    FIELD(next_rdy), FIELD(in_rdy_list), FIELD(state),      FIELD(proc_id),
+    FIELD(rdy_cycle), FIELD(rs_id),      FIELD(table_info), FIELD(srcs_not_rdy_vector),
+};
+
+/* fields read by wake_up_ops on the producer and on each dependent op */
+static const Field wake_fields[] = {
+    FIELD(wake_up_head), FIELD(wake_cycle), FIELD(unique_num), FIELD(op_pool_valid),
+    FIELD(proc_id),      FIELD(state),      FIELD(rdy_cycle),  FIELD(srcs_not_rdy_vector),
+};
+
+static unsigned lines_touched(const Field* fields, unsigned num, size_t base) {
+  uint64_t lines = 0;
+  unsigned ii, count = 0;
+
+  for (ii = 0; ii < num; ii++) {
+    size_t first = (base + fields[ii].offset) / LINE_SIZE;
+    size_t last = (base + fields[ii].offset + fields[ii].size - 1) / LINE_SIZE;
+    for (; first <= last; first++)
+      lines |= 1ULL << (first & 63);
+  }
+  for (ii = 0; ii < 64; ii++)
+    count += (lines >> ii) & 1;
+  return count;
+}
+
+/* worst case over the 16-byte offsets malloc may hand back */
+static unsigned worst_lines_touched(const Field* fields, unsigned num) {
+  unsigned worst = 0;
+  size_t base;
+
+  for (base = 0; base < LINE_SIZE; base += 16) {
+    unsigned lines = lines_touched(fields, num, base);
+    worst = lines > worst ? lines : worst;
+  }
+  return worst;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static Op** build_pool(int aligned) {
+  Op** ops = (Op**)malloc(NUM_OPS * sizeof(Op*));
+  unsigned ii, jj;
+
+  for (ii = 0; ii < NUM_OPS; ii += SLAB_ENTRIES) {
+    Op* slab;
+    if (aligned) {
+      if (posix_memalign((void**)&slab, LINE_SIZE, SLAB_ENTRIES * sizeof(Op)) != 0)
+        exit(1);
+      memset(slab, 0, SLAB_ENTRIES * sizeof(Op));
+    } else {
+      /* the old pool: calloc only promises 16-byte alignment, so offset the
+         chunk to model that */
+      char* raw = (char*)calloc(1, SLAB_ENTRIES * sizeof(Op) + LINE_SIZE);
+      slab = (Op*)(raw + 16);
+    }
+    for (jj = 0; jj < SLAB_ENTRIES; jj++)
+      ops[ii + jj] = &slab[jj];
+  }
+
+  /* a long-running simulation hands ops out in roughly random order */
+  srand(1);
+  for (ii = NUM_OPS - 1; ii > 0; ii--) {
+    unsigned pick = rand() % (ii + 1);
+    Op* tmp = ops[ii];
+    ops[ii] = ops[pick];
+    ops[pick] = tmp;
+  }
+  return ops;
+}
+
+static double time_rdy_walk(Op** ops) {
+  Counter sum = 0;
+  double start;
+  unsigned ii, round;
+
+  for (round = 0; round < NUM_ROUNDS; round++) {
+    Op** window = &ops[(round * WALK_OPS) % NUM_OPS];
+    for (ii = 0; ii < WALK_OPS - 1; ii++) {
+      window[ii]->next_rdy = window[ii + 1];
+      window[ii]->in_rdy_list = 1;
+    }
+    window[ii]->next_rdy = NULL;
+  }
+
+  start = now();
+  for (round = 0; round < NUM_ROUNDS; round++) {
+    Op* op = ops[(round * WALK_OPS) % NUM_OPS];
+    for (; op; op = op->next_rdy) {
+      if (op->in_rdy_list && op->state != OS_DONE && !op->srcs_not_rdy_vector)
+        sum += op->rdy_cycle + op->rs_id + op->proc_id + (Counter)(uintptr_t)op->table_info;
+    }
+  }
+  if (sum == 42)
+    printf(" ");
+  return (now() - start) * 1e9 / ((double)NUM_ROUNDS * WALK_OPS);
+}
+
+static double time_wake_walk(Op** ops) {
+  Counter sum = 0;
+  double start;
+  unsigned ii, jj, round;
+
+  start = now();
+  for (round = 0; round < NUM_ROUNDS; round++) {
+    unsigned first = (round * WALK_OPS * (WAKE_DEPS + 1)) % NUM_OPS;
+    for (ii = 0; ii < WALK_OPS; ii++) {
+      Op* src = ops[(first + ii * (WAKE_DEPS + 1)) % NUM_OPS];
+      sum += src->wake_cycle + (Counter)(uintptr_t)src->wake_up_head;
+      for (jj = 1; jj <= WAKE_DEPS; jj++) {
+        Op* dep = ops[(first + ii * (WAKE_DEPS + 1) + jj) % NUM_OPS];
+        if (!dep->op_pool_valid && dep->unique_num == 0 && dep->proc_id == 0) {
+          dep->srcs_not_rdy_vector &= ~(1U << jj);
+          if (dep->state != OS_DONE)
+            dep->rdy_cycle = sum;
+        }
+      }
+    }
+  }
+  if (sum == 42)
+    printf(" ");
+  return (now() - start) * 1e9 / ((double)NUM_ROUNDS * WALK_OPS);
+}
+
+int main(void) {
+  const unsigned num_rdy = sizeof(rdy_fields) / sizeof(rdy_fields[0]);
+  const unsigned num_wake = sizeof(wake_fields) / sizeof(wake_fields[0]);
+  int aligned;
+
+  printf("sizeof(Op): %zu  alignof(Op): %zu\n", sizeof(Op), (size_t)__alignof__(Op));
+  printf("ready-list walk lines/op: %u aligned, %u worst case\n", lines_touched(rdy_fields, num_rdy, 0),
+         worst_lines_touched(rdy_fields, num_rdy));
+  printf("wake up lines/op:         %u aligned, %u worst case\n", lines_touched(wake_fields, num_wake, 0),
+         worst_lines_touched(wake_fields, num_wake));
+
+  for (aligned = 1; aligned >= 0; aligned--) {
+    Op** ops = build_pool(aligned);
+    printf("%-14s ready-list walk: %6.2f ns/op  wake up: %6.2f ns/op\n", aligned ? "aligned slabs" : "calloc chunks",
+           time_rdy_walk(ops), time_wake_walk(ops));
+  }
+  return 0;
+}
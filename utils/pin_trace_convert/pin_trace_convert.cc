@@ -0,0 +1,173 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***************************************************************************************
+ * File         : utils/pin_trace_convert/pin_trace_convert.cc
+ * Author       : HPS Research Group
+ * Date         : 10/2026
+ * Description  : Re-encodes a PIN trace (any format frontend/pin_trace_stream
+ *                reads, e.g. .trace.bz2) as a sequence of independent zstd or
+ *                lz4 frames, each holding a whole number of instructions, so
+ *                that Scarab can decode the frames in parallel.
+ ***************************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef SCARAB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef SCARAB_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "frontend/pin_trace_stream.h"
+
+#include "ctype_pin_inst.h"
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s [-f zstd|lz4] [-l level] [-r insts_per_frame] [-j threads] <input trace> <output trace>\n"
+          "  -f  output format (default zstd)\n"
+          "  -l  compression level (default 3)\n"
+          "  -r  instructions per frame (default 65536)\n"
+          "  -j  frames compressed in parallel (default 4)\n",
+          prog);
+  exit(1);
+}
+
+static void compress_frame(const std::string& format, int level, const std::vector<char>* src, std::vector<char>* dst) {
+#ifdef SCARAB_HAVE_ZSTD
+  if (format == "zstd") {
+    dst->resize(ZSTD_compressBound(src->size()));
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    size_t n = ZSTD_compress2(cctx, dst->data(), dst->size(), src->data(), src->size());
+    ZSTD_freeCCtx(cctx);
+    if (ZSTD_isError(n)) {
+      fprintf(stderr, "zstd compression failed: %s\n", ZSTD_getErrorName(n));
+      exit(1);
+    }
+    dst->resize(n);
+    return;
+  }
+#endif
+#ifdef SCARAB_HAVE_LZ4
+  if (format == "lz4") {
+    LZ4F_preferences_t prefs;
+    memset(&prefs, 0, sizeof(prefs));
+    prefs.frameInfo.contentSize = src->size();
+    prefs.compressionLevel = level;
+    dst->resize(LZ4F_compressFrameBound(src->size(), &prefs));
+    size_t n = LZ4F_compressFrame(dst->data(), dst->size(), src->data(), src->size(), &prefs);
+    if (LZ4F_isError(n)) {
+      fprintf(stderr, "lz4 compression failed: %s\n", LZ4F_getErrorName(n));
+      exit(1);
+    }
+    dst->resize(n);
+    return;
+  }
+#endif
+  fprintf(stderr, "output format %s is not supported by this build\n", format.c_str());
+  exit(1);
+}
+
+int main(int argc, char** argv) {
+  std::string format = "zstd";
+  int level = 3;
+  size_t insts_per_frame = 65536;
+  unsigned num_threads = 4;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "f:l:r:j:")) != -1) {
+    switch (opt) {
+      case 'f':
+        format = optarg;
+        break;
+      case 'l':
+        level = atoi(optarg);
+        break;
+      case 'r':
+        insts_per_frame = strtoull(optarg, NULL, 0);
+        break;
+      case 'j':
+        num_threads = atoi(optarg);
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+  if (optind + 2 != argc || !insts_per_frame || !num_threads || (format != "zstd" && format != "lz4"))
+    usage(argv[0]);
+
+  Pin_Trace_Stream in(argv[optind], 1);
+  if (!in.ok()) {
+    fprintf(stderr, "Cannot open trace file: %s\n", argv[optind]);
+    return 1;
+  }
+  FILE* out = fopen(argv[optind + 1], "wb");
+  if (!out) {
+    fprintf(stderr, "Cannot create trace file: %s\n", argv[optind + 1]);
+    return 1;
+  }
+
+  std::vector<std::vector<char>> raw(num_threads);
+  std::vector<std::vector<char>> packed(num_threads);
+  uint64_t insts = 0;
+  bool more = true;
+  while (more) {
+    // fill up to one frame per thread
+    unsigned frames = 0;
+    for (; frames < num_threads && more; frames++) {
+      std::vector<char>& frame = raw[frames];
+      frame.resize(insts_per_frame * sizeof(ctype_pin_inst));
+      size_t count = 0;
+      while (count < insts_per_frame && in.read(frame.data() + count * sizeof(ctype_pin_inst), sizeof(ctype_pin_inst)))
+        count++;
+      frame.resize(count * sizeof(ctype_pin_inst));
+      insts += count;
+      more = count == insts_per_frame;
+      if (!count)
+        break;
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < frames; i++)
+      workers.emplace_back(compress_frame, format, level, &raw[i], &packed[i]);
+    for (unsigned i = 0; i < frames; i++) {
+      workers[i].join();
+      if (fwrite(packed[i].data(), 1, packed[i].size(), out) != packed[i].size()) {
+        fprintf(stderr, "Write to %s failed\n", argv[optind + 1]);
+        return 1;
+      }
+    }
+  }
+  fclose(out);
+
+  printf("Converted %llu instructions from %s (%s) to %s (%s)\n", (unsigned long long)insts, argv[optind], in.format(),
+         argv[optind + 1], format.c_str());
+  return 0;
+}
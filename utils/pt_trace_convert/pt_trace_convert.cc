@@ -0,0 +1,105 @@
+/* Copyright 2020 HPS/SAFARI Research Groups
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/***************************************************************************************
+ * File         : utils/pt_trace_convert/pt_trace_convert.cc
+ * Author       : HPS Research Group
+ * Date         : 10/14/2026
+ * Description  : Converts a text Intel PT trace (plain or compressed) to the binary format
+ *                of frontend/pt_memtrace/pt_trace_format.h, which the PT frontend
+ *                detects and reads directly. The output is gzipped if its name ends
+ *                in .gz and plain otherwise.
+ ***************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+#include <zlib.h>
+
+#include "frontend/pt_memtrace/pt_trace_format.h"
+
+struct PTBytes {
+  uint8_t size;
+  uint8_t bytes[16];
+};
+
+static uint8_t* put_varint(uint8_t* p, uint64_t x) {
+  while (x >= 0x80) {
+    *p++ = (uint8_t)(x | 0x80);
+    x >>= 7;
+  }
+  *p++ = (uint8_t)x;
+  return p;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <input PT trace> <output binary trace>\n", argv[0]);
+    return 1;
+  }
+
+  PTTextInput input;
+  if (!input.open(argv[1], 1)) {
+    fprintf(stderr, "Could not open %s\n", argv[1]);
+    return 1;
+  }
+  size_t out_len = strlen(argv[2]);
+  bool gzip = out_len > 3 && !strcmp(argv[2] + out_len - 3, ".gz");
+  gzFile out = gzopen(argv[2], gzip ? "wb6" : "wbT");
+  if (!out) {
+    fprintf(stderr, "Could not open %s\n", argv[2]);
+    return 1;
+  }
+  gzbuffer(out, PT_BLOCK_SIZE);
+
+  uint32_t version = PT_BIN_VERSION;
+  gzwrite(out, PT_BIN_MAGIC, 8);
+  gzwrite(out, &version, sizeof(version));
+
+  std::unordered_map<uint64_t, PTBytes> seen;
+  PTInst inst;
+  uint64_t next_pc = 0, num_insts = 0, num_new = 0;
+  uint8_t record[PT_MAX_RECORD];
+  while (input.next(inst)) {
+    int64_t delta = (int64_t)(inst.pc - next_pc);
+    uint8_t* p = put_varint(record, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    PTBytes& known = seen[inst.pc];
+    bool new_bytes = known.size != inst.size || memcmp(known.bytes, inst.inst_bytes, inst.size);
+    *p++ = inst.size | (new_bytes ? PT_BIN_NEW_BYTES : 0);
+    if (new_bytes) {
+      known.size = inst.size;
+      memcpy(known.bytes, inst.inst_bytes, inst.size);
+      memcpy(p, inst.inst_bytes, inst.size);
+      p += inst.size;
+      num_new++;
+    }
+    gzwrite(out, record, p - record);
+    next_pc = inst.pc + inst.size;
+    num_insts++;
+  }
+  gzclose(out);
+
+  printf("%llu instructions, %llu with their bytes, %zu distinct pcs\n", (unsigned long long)num_insts,
+         (unsigned long long)num_new, seen.size());
+  return 0;
+}